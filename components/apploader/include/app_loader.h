@@ -156,5 +156,43 @@ bool appImageFromMem(const void *address, appImageHandler_t *handler);
  */
 bool appImageFromFile(const char *fname, appImageHandler_t *handler);
 
+/**
+ * \brief section attribute for application lazy data
+ *
+ * Initialized data with this attribute are placed in lazy section of
+ * application image. For flash image, lazy section is not copied to RAM
+ * at \p appImageFromMem, and it is copied at the first
+ * \p appImageLazyLoad. It is useful for data of features not used at
+ * start, such as rarely used screens and protocol modules. Code of flash
+ * image is always executed in place.
+ *
+ * \code{.cpp}
+ * static APP_LAZY_DATA int gRareTable[] = {...};
+ *
+ * void rareFeatureOpen(void) {
+ *     appImageLazyLoad(gRareTable);
+ *     ...
+ * }
+ * \endcode
+ */
+#define APP_LAZY_DATA OSI_SECTION(.lazydata)
+
+/**
+ * \brief load application lazy section
+ *
+ * Copy the lazy section containing \p ptr to RAM, if it is not copied
+ * yet. It is safe to be called multiple times, and from multiple threads.
+ * It can't be called in ISR.
+ *
+ * It should be called before the first access of lazy data. Before that,
+ * the content of lazy data is undefined.
+ *
+ * \param ptr       address inside lazy section
+ * \return
+ *      - true if the lazy section is loaded
+ *      - false if \p ptr is not inside any lazy section
+ */
+bool appImageLazyLoad(const void *ptr);
+
 OSI_EXTERN_C_END
 #endif
@@ -32,6 +32,12 @@
 #define APP_SECTION_STUB 2
 #define APP_SECTION_CLEAR 3
 #define APP_SECTION_XIP 4
+#define APP_SECTION_LAZY 5
+
+#define APP_LAZY_MAX (4)
+#define APP_LAZY_PENDING 0
+#define APP_LAZY_LOADING 1
+#define APP_LAZY_LOADED 2
 
 #define MAJOR(version) ((version) >> 16)
 #define MINOR(version) ((version)&0xffff)
@@ -89,10 +95,75 @@ typedef struct
     uint32_t tag;
 } stubInsn_t;
 
+typedef struct
+{
+    const void *src;      // source in image, NULL for unused
+    uintptr_t lma;        // destination in RAM
+    uint32_t size;        // section size
+    volatile int state;   // APP_LAZY_PENDING/LOADING/LOADED
+} appLazySection_t;
+
+static appLazySection_t gAppLazySections[APP_LAZY_MAX];
+
 // These are implemented in core_export.o
 extern unsigned gCoreExportVersion;
 extern bool appImageLoadStub(const void *stub, void *dst, unsigned size);
 
+/**
+ * Register lazy section, it will be copied at \p appImageLazyLoad. When
+ * it is registered already (application is loaded again), it will be
+ * pending again.
+ */
+static bool prvLazyRegister(const void *src, uintptr_t lma, uint32_t size)
+{
+    bool ok = false;
+    uint32_t critical = osiEnterCritical();
+    for (int n = 0; n < APP_LAZY_MAX; n++)
+    {
+        appLazySection_t *p = &gAppLazySections[n];
+        if (p->src == NULL || p->lma == lma)
+        {
+            p->src = src;
+            p->lma = lma;
+            p->size = size;
+            p->state = APP_LAZY_PENDING;
+            ok = true;
+            break;
+        }
+    }
+    osiExitCritical(critical);
+    return ok;
+}
+
+bool appImageLazyLoad(const void *ptr)
+{
+    for (int n = 0; n < APP_LAZY_MAX; n++)
+    {
+        appLazySection_t *p = &gAppLazySections[n];
+        if (p->src == NULL || !OSI_IS_IN_REGION(uintptr_t, ptr, p->lma, p->size))
+            continue;
+
+        uint32_t critical = osiEnterCritical();
+        bool owner = (p->state == APP_LAZY_PENDING);
+        if (owner)
+            p->state = APP_LAZY_LOADING;
+        osiExitCritical(critical);
+
+        if (owner)
+        {
+            OSI_LOGI(0, "apploader lazy section 0x%x size/%d", p->lma, p->size);
+            memcpy((void *)p->lma, p->src, p->size);
+            p->state = APP_LAZY_LOADED;
+        }
+
+        // loading by another thread
+        while (p->state != APP_LAZY_LOADED)
+            osiThreadSleep(1);
+        return true;
+    }
+    return false;
+}
+
 bool appImageFromMem(const void *address, appImageHandler_t *handler)
 {
 #if (FLASHIMG_FLASH_SIZE == 0) || (FLASHIMG_RAM_SIZE == 0)
@@ -210,6 +281,20 @@ bool appImageFromMem(const void *address, appImageHandler_t *handler)
                    sect->size);
             break;
 
+        case APP_SECTION_LAZY:
+            // the same checks as copy section, and copied at first use
+            if (!OSI_REGION_INSIDE(uintptr_t, sect->lma, sect->size,
+                                   FLASHIMG_RAM_START, FLASHIMG_RAM_SIZE))
+                return false;
+
+            if (sect->offset + sect->size > header->image_size)
+                return false;
+
+            if (!prvLazyRegister((const char *)address + sect->offset,
+                                 sect->lma, sect->size))
+                return false;
+            break;
+
         case APP_SECTION_CLEAR:
             // check clear section destination inside reserved range
             if (!OSI_REGION_INSIDE(uintptr_t, sect->lma, sect->size,
@@ -364,6 +449,7 @@ bool appImageFromFile(const char *fname, appImageHandler_t *handler)
         switch (sect->type)
         {
         case APP_SECTION_COPY:
+        case APP_SECTION_LAZY: // file image is not kept, copy it now
             // check copy section destination inside reserved range
             if (!OSI_REGION_INSIDE(uintptr_t, sect->lma, sect->size,
                                    FILEIMG_RAM_START, FILEIMG_RAM_SIZE))
@@ -11,7 +11,9 @@
  */
 
 #include "osi_log.h"
+#include "osi_boot.h"
 #include "osi_sysnv.h"
+#include "osi_api_inside.h"
 #include "osi_trace.h"
 #include "app_config.h"
 #include "at_engine.h"
@@ -48,12 +50,15 @@
 #include "diag_runmode.h"
 #include "diag_auto_test.h"
 #include "srv_trace.h"
+#include "srv_snapshot.h"
+#include "srv_power_domain.h"
 #include "srv_rf_param.h"
 #include "fupdate.h"
 #include "srv_wdt.h"
 #include "app_loader.h"
 #include "mal_api.h"
 #include "audio_device.h"
+#include "audio_mixer.h"
 #include <stdlib.h>
 #include "connectivity_config.h"
 #ifdef CONFIG_TTS_SUPPORT
@@ -240,8 +245,92 @@ static void prvTraceInit(void)
 #endif
 }
 
+#ifdef CONFIG_FS_MOUNT_SDCARD
+static void prvMountSdcard(void *param)
+{
+    bool mount_sd = fsMountSdcard();
+    OSI_LOGI(0, "application mount sd card %d", mount_sd);
+}
+#endif
+
+static void prvAudioInit(void *param)
+{
+    audevInit();
+    auMixerInit();
+}
+
+#ifdef CONFIG_TTS_SUPPORT
+static void prvTtsInit(void *param)
+{
+    ttsPlayerInit();
+}
+#endif
+
+#ifdef CONFIG_NET_TCPIP_SUPPORT
+static void prvNetInit(void *param)
+{
+    net_init();
+#ifdef CONFIG_NET_NAT_SUPPORT
+    OSI_LOGE(0, "init nat to %d", gSysnvNATCfg);
+    extern void set_nat_enable(uint32_t natCfg);
+    set_nat_enable(gSysnvNATCfg);
+    extern void netif_setup_lwip_lanOnly();
+    netif_setup_lwip_lanOnly();
+#endif
+}
+#endif
+
+#ifdef CONFIG_AT_BT_APP_SUPPORT
+static void prvBtInit(void *param)
+{
+    bt_ap_init();
+}
+#endif
+
+/**
+ * Initializations independent each other, after CP is loaded. They are
+ * executed concurrently.
+ */
+static void prvParallelInit(bool mount_sd)
+{
+    enum
+    {
+        APP_INIT_SDCARD,
+        APP_INIT_AUDIO,
+        APP_INIT_TTS,
+        APP_INIT_NET,
+        APP_INIT_BT,
+        APP_INIT_COUNT
+    };
+
+    osiBootInit_t inits[APP_INIT_COUNT] = {
+        [APP_INIT_SDCARD] = {"sdcard"},
+        [APP_INIT_AUDIO] = {"audio", prvAudioInit},
+        [APP_INIT_TTS] = {"tts", NULL, NULL, (1 << APP_INIT_AUDIO)},
+        [APP_INIT_NET] = {"net"},
+        [APP_INIT_BT] = {"bt"},
+    };
+
+#ifdef CONFIG_FS_MOUNT_SDCARD
+    if (mount_sd)
+        inits[APP_INIT_SDCARD].init = prvMountSdcard;
+#endif
+#ifdef CONFIG_TTS_SUPPORT
+    inits[APP_INIT_TTS].init = prvTtsInit;
+#endif
+#ifdef CONFIG_NET_TCPIP_SUPPORT
+    inits[APP_INIT_NET].init = prvNetInit;
+#endif
+#ifdef CONFIG_AT_BT_APP_SUPPORT
+    inits[APP_INIT_BT].init = prvBtInit;
+#endif
+
+    osiBootInitRun(inits, APP_INIT_COUNT, 3);
+}
+
 static void prvPowerOn(void *arg)
 {
+    osiBootMark("power on");
     ipcInit();
     drvNvmIpcInit();
 
@@ -250,9 +339,14 @@ static void prvPowerOn(void *arg)
     ipc_at_init();
     drvPsPathInit();
 
-#ifdef CONFIG_FS_MOUNT_SDCARD
-    bool mount_sd = fsMountSdcard();
-    OSI_LOGI(0, "application mount sd card %d", mount_sd);
+    // sdcard is mounted early only when fstrace may write to it
+    bool mount_sd_late = true;
+#if defined(CONFIG_FS_MOUNT_SDCARD) && defined(CONFIG_FS_TRACE_ENABLE)
+    if (gSysnvFstraceMask != 0)
+    {
+        prvMountSdcard(NULL);
+        mount_sd_late = false;
+    }
 #endif
 
 #ifdef CONFIG_FS_TRACE_ENABLE
@@ -260,6 +354,10 @@ static void prvPowerOn(void *arg)
         srvFstraceInit(gSysnvFstraceMask);
 #endif
 
+#ifdef CONFIG_SRV_LOG_RING_ENABLE
+    srvLogRingInit();
+#endif
+
 #ifdef CONFIG_SRV_SIMLOCK_ENABLE
     srvSimlockInit();
 #endif
@@ -280,6 +378,7 @@ static void prvPowerOn(void *arg)
     }
 
     diagInit(diag_port);
+    osiBootMark("diag");
 
     if (osiGetBootMode() == OSI_BOOTMODE_CALIB)
     {
@@ -350,6 +449,7 @@ static void prvPowerOn(void *arg)
     // asynchrous worker, start before at task
     aworker_start();
     atEngineStart();
+    osiBootMark("at engine");
 #endif
 
     // zsp_uart & uart_3 are both for cp
@@ -370,23 +470,9 @@ static void prvPowerOn(void *arg)
 
     if (!halCpLoad())
         osiPanic();
+    osiBootMark("cp load");
 
-    audevInit();
-
-#ifdef CONFIG_TTS_SUPPORT
-    ttsPlayerInit();
-#endif
-
-#ifdef CONFIG_NET_TCPIP_SUPPORT
-    net_init();
-#ifdef CONFIG_NET_NAT_SUPPORT
-    OSI_LOGE(0, "init nat to %d", gSysnvNATCfg);
-    extern void set_nat_enable(uint32_t natCfg);
-    set_nat_enable(gSysnvNATCfg);
-    extern void netif_setup_lwip_lanOnly();
-    netif_setup_lwip_lanOnly();
-#endif
-#endif
+    prvParallelInit(mount_sd_late);
 
 #ifndef CONFIG_QUEC_PROJECT_FEATURE
 
@@ -409,9 +495,13 @@ static void prvPowerOn(void *arg)
 
 #endif
 
-#ifdef CONFIG_AT_BT_APP_SUPPORT
-    bt_ap_init();
-#endif
+    // components and applications are started, snapshot not used by
+    // now won't be used later
+    srvSnapshotRestoreDone();
+    srvSnapshotDump();
+
+    osiBootMark("app enter");
+    osiBootMarkDump();
 
     // HACK: Now CP will change hwp_debugUart->irq_mask. After CP is changed,
     // the followings should be removed.
@@ -424,6 +514,7 @@ static void prvPowerOn(void *arg)
 
 void osiAppStart(void)
 {
+    osiBootMark("app start");
     OSI_LOGXI(OSI_LOGPAR_S, 0, "application start (%s)", gBuildRevision);
 
 #ifdef CONFIG_SYS_WDT_ENABLE
@@ -447,6 +538,7 @@ void osiAppStart(void)
     mlInit();
     if (!fsMountAll())
         osiPanic();
+    osiBootMark("fs mount");
 
     osiBuffer_t bscore_buf = halGetBscoreBuf();
     if (bscore_buf.size > 0)
@@ -468,6 +560,7 @@ void osiAppStart(void)
     prvTraceInit();
     nvmInit();
     nvmMigration();
+    osiBootMark("nvm");
 
 #ifdef CONFIG_QUEC_PROJECT_FEATURE
 	bool wdtrst = quec_wdt_cfg_read();
@@ -497,6 +590,8 @@ void osiAppStart(void)
         osiPanic();
 
     osiPsmRestore();
+    srvSnapshotInit();
+    srvPowerDomainInit();
 
     drvGpioInit();
     drvPmicIntrInit();
@@ -513,6 +608,7 @@ void osiAppStart(void)
     // wait a while for PM source created
     osiThreadSleep(10);
     osiPmStart();
+    osiStackMonStart();
 	
 #ifdef CONFIG_QUEC_PROJECT_FEATURE
 	quec_startup();
@@ -1165,6 +1165,30 @@ void atCmdUrcFlush(atCmdEngine_t *th);
  */
 void atCmdWorkerCall(atCmdEngine_t *th, osiCallback_t call, void *ctx);
 
+/**
+ * @brief call function in per-channel execution context
+ *
+ * Calls of the same channel are executed one at a time, in the order of
+ * submission. Calls of different channels are executed concurrently by
+ * a small thread pool, and channels with pending calls are served round
+ * robin. So, a long synchronous operation on one channel won't delay
+ * command responses and URC of other channels.
+ *
+ * \p call is executed outside AT thread, so don't call AT response APIs
+ * in \p call. \p done, if not NULL, is executed in AT thread after
+ * \p call, and it can output the response.
+ *
+ * @param th        command mode engine, must be valid
+ * @param call      function to be executed in channel context
+ * @param done      function to be executed in AT thread, can be NULL
+ * @param ctx       context for \p call and \p done
+ * @return
+ *      - true on success
+ *      - false on invalid parameter, out of memory or too many channels
+ *        with pending calls
+ */
+bool atEngineChannelCall(atCmdEngine_t *th, osiCallback_t call, osiCallback_t done, void *ctx);
+
 /**
  * @brief create AT data mode engine
  *
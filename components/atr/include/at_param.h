@@ -752,6 +752,25 @@ uint32_t atParamUintByStrMap(atCmdParam_t *param, const osiValueStrMap_t *vsmap,
  */
 uint32_t atParamDefUintByStrMap(atCmdParam_t *param, uint32_t defval, const osiValueStrMap_t *vsmap, bool *paramok);
 
+/**
+ * extract string parameter and return mapped uint, by hashed index
+ *
+ * It is the same as \a atParamUintByStrMap, except the map is searched
+ * by hashed index. The \a icase of \a index should be true to match
+ * \a atParamUintByStrMap.
+ *
+ * @param param     parameter pointer
+ * @param index     string index of integer/string map
+ * @param paramok   in/out parameter parsing ok flag
+ * @return
+ *      - uint parameter
+ *      - NULL on failed
+ *          - \a *paramok is false at input
+ *          - \a param is empty
+ *          - \a param is not in map
+ */
+uint32_t atParamUintByStrIndex(atCmdParam_t *param, osiVsmapStrIndex_t *index, bool *paramok);
+
 /**
  * extract uint parameter by hex string
  *
@@ -556,6 +556,33 @@ void atCmdRespOutputText(atCmdEngine_t *engine, const char *text);
  */
 void atCmdRespOutputNText(atCmdEngine_t *engine, const char *text, size_t length);
 
+/**
+ * output data as hex text
+ *
+ * Each byte is output as 2 lower case hex characters. The hex text is
+ * encoded in small pieces and written to AT device directly, so there is
+ * no need to allocate buffer for the whole hex text. Similar to
+ * \p atCmdRespOutputNText, it can be used between
+ * \p atCmdRespInfoNTextBegin and \p atCmdRespInfoNTextEnd.
+ *
+ * @param engine    AT command engine, can't be NULL
+ * @param data      data to be output, can't be NULL if length is non zero
+ * @param length    data length in bytes
+ */
+void atCmdRespOutputHex(atCmdEngine_t *engine, const void *data, size_t length);
+
+/**
+ * encode data to lower case hex text
+ *
+ * The output won't be terminated with \c \0.
+ *
+ * @param dst       output buffer, at least 2 * size bytes
+ * @param src       data to be encoded
+ * @param size      data size in bytes
+ * @return  output hex text length, 2 * size
+ */
+size_t atEncodeHex(char *dst, const void *src, size_t size);
+
 /**
  * output prompt
  *
@@ -107,7 +107,7 @@ static bool atCfgStoreGlobal(atSetting_t *p)
         return false;
 
     int enc_size = atCfgGlobalEncode(p, buf, strm_size);
-    bool ok = (enc_size > 0 && vfs_sfile_write(file_name, buf, enc_size) == enc_size);
+    bool ok = (enc_size > 0 && vfs_sfile_write_behind(file_name, buf, enc_size) == enc_size);
     if (!ok)
         OSI_LOGE(0, "failed to save global cfg, strm size/%d enc size/%d", strm_size, enc_size);
 
@@ -152,7 +152,7 @@ static bool atCfgStoreProfile(atSetting_t *p, int profile)
 
     int enc_size = atCfgProfileEncode(p, buf, strm_size);
 
-    bool ok = (enc_size > 0 && vfs_sfile_write(file_name, buf, enc_size) == enc_size);
+    bool ok = (enc_size > 0 && vfs_sfile_write_behind(file_name, buf, enc_size) == enc_size);
     if (!ok)
     {
         OSI_LOGE(0, "failed to save profile %d cfg, strm size/%d enc size/%d",
@@ -195,7 +195,7 @@ static bool atCfgStoreAutoSave(atSetting_t *p)
         return false;
 
     int enc_size = atCfgAutoSaveEncode(p, buf, strm_size);
-    bool ok = (enc_size > 0 && vfs_sfile_write(file_name, buf, enc_size) == enc_size);
+    bool ok = (enc_size > 0 && vfs_sfile_write_behind(file_name, buf, enc_size) == enc_size);
     if (!ok)
         OSI_LOGE(0, "failed to save autosave cfg, strm size/%d enc size/%d", strm_size, enc_size);
 
@@ -289,7 +289,7 @@ bool atCfgSave(uint8_t profile, const atChannelSetting_t *chsetting)
 #else
     p->profile_size[profile] = atCfgProfileEncode(&gAtSettingSave, p->profile_data[profile], AT_PROFILE_SIZE);
 #endif
-    return vfs_sfile_write(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
+    return vfs_sfile_write_behind(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
 #else
 #ifndef CONFIG_QUEC_PROJECT_FEATURE
     return atCfgStoreProfile(&gAtSetting, profile); 
@@ -304,7 +304,7 @@ bool atCfgAutoSave(void)
 #ifdef CONFIG_ATR_CFG_IN_ONE_FILE
     atCfgCombined_t *p = &gAtCfgCombined;
     p->autosave_size = atCfgAutoSaveEncode(&gAtSetting, p->autosave_data, AT_AUTOSAVE_SIZE);
-    return vfs_sfile_write(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
+    return vfs_sfile_write_behind(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
 #else
     return atCfgStoreAutoSave(&gAtSetting);
 #endif
@@ -315,7 +315,7 @@ bool atCfgGlobalSave(void)
 #ifdef CONFIG_ATR_CFG_IN_ONE_FILE
     atCfgCombined_t *p = &gAtCfgCombined;
     p->global_size = atCfgGlobalEncode(&gAtSetting, p->global_data, AT_GLOBAL_SIZE);
-    return vfs_sfile_write(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
+    return vfs_sfile_write_behind(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
 #else
     return atCfgStoreGlobal(&gAtSetting);
 #endif
@@ -330,7 +330,7 @@ bool atCfgResetFactory(atChannelSetting_t *chsetting)
     memset(p->profile_data[0], 0, AT_PROFILE_SIZE);
     memset(p->profile_data[1], 0, AT_PROFILE_SIZE);
     memset(p->autosave_data, 0, AT_AUTOSAVE_SIZE);
-    return vfs_sfile_write(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
+    return vfs_sfile_write_behind(AT_CFGFN_COMBINED, p, sizeof(*p)) == sizeof(*p);
 #else
     atSetting_t *nset = (atSetting_t *)malloc(sizeof(atSetting_t));
     memcpy(nset, &gAtDefaultSetting, sizeof(atSetting_t));
@@ -15,6 +15,7 @@
 #include "osi_api.h"
 #include "at_engine_imp.h"
 #include "at_parse.h"
+#include "at_profile.h"
 #include "at_response.h"
 #include "at_cfg.h"
 #include "drv_uart.h"
@@ -54,6 +55,7 @@ extern bool quec_uart_setting_read();
 
 #define AT_ENGINE_THREAD_PRIORITY (OSI_PRIORITY_NORMAL)
 #define AT_ENGINE_STACK_SIZE (8192 * 4)
+#define AT_ENGINE_CHANNEL_THREAD_COUNT (3)
 #ifdef CONFIG_SOC_8910
 #define AT_ENGINE_EVENT_QUEUE_SIZE (64 * 4)
 #else
@@ -108,11 +110,25 @@ static atEngine_t gAtEngine = {
     .mem_recycler = NULL,
 };
 
+static void atEngineChannelWork(void *param);
+
 void atEngineInit(void)
 {
     gAtEngine.id_man = osiEventDispatchCreate(CONFIG_ATR_CFW_PENDING_UTI_COUNT);
-    gAtEngine.event_hub = osiEventHubCreate(CONFIG_ATR_EVENT_MAX_COUNT);
+    gAtEngine.event_hub = osiEventHubCreateHash(CONFIG_ATR_EVENT_MAX_COUNT);
     gAtEngine.mem_recycler = osiMemRecyclerCreate(CONFIG_ATR_MEM_FREE_LATER_COUNT);
+
+    gAtEngine.channel_wq = osiWorkQueueCreate("atch", AT_ENGINE_CHANNEL_THREAD_COUNT,
+                                              AT_ENGINE_THREAD_PRIORITY, CONFIG_ATR_CMD_WORKER_STACK_SIZE);
+    gAtEngine.channel_lock = osiMutexCreate();
+    for (unsigned n = 0; n < AT_ENGINE_CHANNEL_COUNT; n++)
+    {
+        atChannelCtx_t *ch = &gAtEngine.channels[n];
+        ch->engine = NULL;
+        ch->work = osiWorkCreate(atEngineChannelWork, NULL, ch);
+        ch->running = false;
+        TAILQ_INIT(&ch->calls);
+    }
 }
 
 void atCmdHandleAT(atCommand_t *cmd)
@@ -598,6 +614,86 @@ void atEngineCallback(osiCallback_t cb, void *ctx)
     osiThreadCallback(gAtEngine.thread_id, cb, ctx);
 }
 
+/**
+ * Execute one call of the channel. When there are more calls, the work is
+ * queued again to the tail of work queue. So, channels with pending calls
+ * are served round robin, and calls in a channel are serialized.
+ */
+static void atEngineChannelWork(void *param)
+{
+    atChannelCtx_t *ch = (atChannelCtx_t *)param;
+
+    osiMutexLock(gAtEngine.channel_lock);
+    atChannelCall_t *c = TAILQ_FIRST(&ch->calls);
+    if (c == NULL || ch->running)
+    {
+        osiMutexUnlock(gAtEngine.channel_lock);
+        return;
+    }
+    TAILQ_REMOVE(&ch->calls, c, iter);
+    ch->running = true;
+    osiMutexUnlock(gAtEngine.channel_lock);
+
+    c->call(c->ctx);
+    if (c->done != NULL)
+        atEngineCallback(c->done, c->ctx);
+    free(c);
+
+    osiMutexLock(gAtEngine.channel_lock);
+    ch->running = false;
+    if (!TAILQ_EMPTY(&ch->calls))
+        osiWorkEnqueue(ch->work, gAtEngine.channel_wq);
+    osiMutexUnlock(gAtEngine.channel_lock);
+}
+
+bool atEngineChannelCall(atCmdEngine_t *th, osiCallback_t call, osiCallback_t done, void *ctx)
+{
+    if (th == NULL || call == NULL || gAtEngine.channel_wq == NULL)
+        return false;
+
+    atChannelCall_t *c = (atChannelCall_t *)malloc(sizeof(atChannelCall_t));
+    if (c == NULL)
+        return false;
+
+    c->call = call;
+    c->done = done;
+    c->ctx = ctx;
+
+    osiMutexLock(gAtEngine.channel_lock);
+
+    // find the context of the channel, or bind an idle one
+    atChannelCtx_t *ch = NULL;
+    atChannelCtx_t *idle = NULL;
+    for (unsigned n = 0; n < AT_ENGINE_CHANNEL_COUNT; n++)
+    {
+        atChannelCtx_t *p = &gAtEngine.channels[n];
+        if (p->engine == th)
+        {
+            ch = p;
+            break;
+        }
+        if (idle == NULL && !p->running && TAILQ_EMPTY(&p->calls))
+            idle = p;
+    }
+
+    if (ch == NULL)
+        ch = idle;
+    if (ch == NULL || ch->work == NULL)
+    {
+        osiMutexUnlock(gAtEngine.channel_lock);
+        free(c);
+        OSI_LOGE(0, "AT channel call no context, engine/%p", th);
+        return false;
+    }
+
+    ch->engine = th;
+    TAILQ_INSERT_TAIL(&ch->calls, c, iter);
+    if (!ch->running)
+        osiWorkEnqueue(ch->work, gAtEngine.channel_wq);
+    osiMutexUnlock(gAtEngine.channel_lock);
+    return true;
+}
+
 bool atEventRegister(uint32_t id, osiEventHandler_t handler)
 {
     return osiEventHubRegister(gAtEngine.event_hub, id, handler);
@@ -614,6 +710,7 @@ bool atEventsRegister(uint32_t id, ...)
 
 bool atSetPendingIdCmd(atCommand_t *cmd, uint32_t id, atCommandAsyncCB_t handler)
 {
+    atProfileCmdAsync(cmd);
     return osiEventDispatchRegister(gAtEngine.id_man, id, (osiEventCallback_t)handler, cmd);
 }
 
@@ -648,6 +745,7 @@ void atEngineSetDeviceAutoSleep(bool enabled)
 
 bool atCommandCheckConstrains(atCommand_t *cmd)
 {
+    atProfileCmdExec(cmd);
     if (cmd->type == AT_CMD_TEST)
         return true;
 
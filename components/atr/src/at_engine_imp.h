@@ -49,12 +49,35 @@ static inline void atByteBuffClear(atByteBuff_t *p) { p->len = 0; }
 static inline bool atByteBuffIsFull(atByteBuff_t *p) { return p->len >= p->size; }
 static inline bool atByteBuffIsEmpty(atByteBuff_t *p) { return p->len == 0; }
 
+#define AT_ENGINE_CHANNEL_COUNT (8)
+
+typedef struct atChannelCall
+{
+    TAILQ_ENTRY(atChannelCall) iter;
+    osiCallback_t call;
+    osiCallback_t done;
+    void *ctx;
+} atChannelCall_t;
+
+typedef TAILQ_HEAD(atChannelCallHead, atChannelCall) atChannelCallHead_t;
+
+typedef struct
+{
+    atCmdEngine_t *engine;     // bound channel, NULL for unused
+    osiWork_t *work;           // executes one call each time
+    atChannelCallHead_t calls; // pending calls
+    bool running;              // a call is executing
+} atChannelCtx_t;
+
 struct atEngine
 {
     osiThread_t *thread_id;
     osiEventDispatch_t *id_man; // register by event ID
     osiEventHub_t *event_hub;   // static dispatch
     osiMemRecycler_t *mem_recycler;
+    osiWorkQueue_t *channel_wq; // shared by per-channel calls
+    osiMutex_t *channel_lock;
+    atChannelCtx_t channels[AT_ENGINE_CHANNEL_COUNT];
 };
 
 void atCmdCreateOutputLineCache(unsigned size);
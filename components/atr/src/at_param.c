@@ -479,6 +479,26 @@ failed:
     return 0;
 }
 
+uint32_t atParamUintByStrIndex(atCmdParam_t *param, osiVsmapStrIndex_t *index, bool *paramok)
+{
+    if (!*paramok)
+        goto failed;
+
+    const char *s = atParamStr(param, paramok);
+    if (!*paramok)
+        goto failed;
+
+    const osiValueStrMap_t *m = osiVsmapIndexFind(index, s);
+    if (m == NULL)
+        goto failed;
+
+    return m->value;
+
+failed:
+    *paramok = false;
+    return 0;
+}
+
 uint32_t atParamDefUintByStrMap(atCmdParam_t *param, uint32_t defval, const osiValueStrMap_t *svmap, bool *paramok)
 {
     if (atParamIsEmpty(param))
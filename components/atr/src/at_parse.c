@@ -12,17 +12,45 @@
 
 #include "atr_config.h"
 #include "cfw_config.h"
+#include "osi_api.h"
 #include "osi_log.h"
 #include "at_parse.h"
+#include "at_profile.h"
+#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Commands and short parameters are recycled in free lists, rather than
+// malloc/free for each command line.
+#define AT_PARSE_CMD_POOL_COUNT (8)
+#define AT_PARSE_PARAM_POOL_COUNT (32)
+#define AT_PARSE_PARAM_POOL_LEN (32)
+#define AT_PARSE_PARAM_POOL_SIZE (sizeof(atCmdParam_t) + AT_PARSE_PARAM_POOL_LEN)
+
+// Returned by simple parser, when the line should be parsed by scanner
+#define AT_PARSE_NOT_SIMPLE (-1)
+
 typedef struct
 {
     atCommandHead_t cmd_list;
     atCommand_t *curr_cmd;
 } atParseCtx_t;
 
+typedef struct atParsePoolNode
+{
+    struct atParsePoolNode *next;
+} atParsePoolNode_t;
+
+typedef struct
+{
+    atParsePoolNode_t *head;
+    unsigned count;
+    unsigned max;
+} atParsePool_t;
+
+static atParsePool_t gAtCmdPool = {NULL, 0, AT_PARSE_CMD_POOL_COUNT};
+static atParsePool_t gAtParamPool = {NULL, 0, AT_PARSE_PARAM_POOL_COUNT};
+
 enum
 {
     AT_PARSE_ERR_UNKNOWN_CMD = 2000,
@@ -32,14 +60,76 @@ enum
     AT_PARSE_ERR_TOO_MANY_PARAM
 };
 
+// =============================================================================
+// atParsePoolGet: get an object from free list, NULL on empty
+// =============================================================================
+static void *atParsePoolGet(atParsePool_t *pool)
+{
+    uint32_t critical = osiEnterCritical();
+    atParsePoolNode_t *node = pool->head;
+    if (node != NULL)
+    {
+        pool->head = node->next;
+        pool->count--;
+    }
+    osiExitCritical(critical);
+    return node;
+}
+
+// =============================================================================
+// atParsePoolPut: put an object to free list, or free it on full
+// =============================================================================
+static void atParsePoolPut(atParsePool_t *pool, void *ptr)
+{
+    atParsePoolNode_t *node = (atParsePoolNode_t *)ptr;
+    uint32_t critical = osiEnterCritical();
+    if (pool->count < pool->max)
+    {
+        node->next = pool->head;
+        pool->head = node;
+        pool->count++;
+        node = NULL;
+    }
+    osiExitCritical(critical);
+    free(node);
+}
+
+// =============================================================================
+// atParseParamAlloc: short parameters use fixed size from free list
+// =============================================================================
+static atCmdParam_t *atParseParamAlloc(unsigned leng)
+{
+    if (leng > AT_PARSE_PARAM_POOL_LEN)
+        return (atCmdParam_t *)malloc(sizeof(atCmdParam_t) + leng);
+
+    atCmdParam_t *param = (atCmdParam_t *)atParsePoolGet(&gAtParamPool);
+    if (param == NULL)
+        param = (atCmdParam_t *)malloc(AT_PARSE_PARAM_POOL_SIZE);
+    return param;
+}
+
+// =============================================================================
+// atParseParamFree
+// =============================================================================
+static void atParseParamFree(atCmdParam_t *param)
+{
+    // parameter length never grows after parsing, and short parameters
+    // are always allocated with fixed size
+    if (param != NULL && param->length <= AT_PARSE_PARAM_POOL_LEN)
+        atParsePoolPut(&gAtParamPool, param);
+    else
+        free(param);
+}
+
 void atCommandDestroy(atCommand_t *cmd)
 {
     if (cmd == NULL)
         return;
+    atProfileCmdDone(cmd);
     for (int n = 0; n < cmd->param_count; n++)
-        free(cmd->params[n]);
+        atParseParamFree(cmd->params[n]);
     cmd->param_count = 0;
-    free(cmd);
+    atParsePoolPut(&gAtCmdPool, cmd);
 }
 
 void atCommandDestroyAll(atCommandHead_t *cmd_list)
@@ -97,10 +187,14 @@ static int atParseStartCmdText(atParseCtx_t *ctx, char *text, unsigned length)
     if (desc == NULL)
         return AT_PARSE_ERR_UNKNOWN_CMD;
 
-    atCommand_t *cmd = (atCommand_t *)calloc(1, sizeof(*cmd));
+    atCommand_t *cmd = (atCommand_t *)atParsePoolGet(&gAtCmdPool);
+    if (cmd == NULL)
+        cmd = (atCommand_t *)malloc(sizeof(*cmd));
     if (cmd == NULL)
         return AT_PARSE_ERR_NOMEM;
 
+    memset(cmd, 0, sizeof(*cmd));
+
     cmd->desc = desc;
     cmd->engine = NULL;
     cmd->type = 0;
@@ -161,7 +255,10 @@ static int atParsePushParamText(atParseCtx_t *ctx, uint8_t type, char *text, uns
     if (text[leng - 1] == ';')
         leng--;
 
-    atCmdParam_t *param = (atCmdParam_t *)malloc(sizeof(*param) + leng);
+    atCmdParam_t *param = atParseParamAlloc(leng);
+    if (param == NULL)
+        return AT_PARSE_ERR_NOMEM;
+
     param->type = type;
     param->length = leng;
     memcpy(param->value, text, leng);
@@ -189,6 +286,119 @@ int atParsePushEmpty(void *scanner)
     return atParsePushParamText(ctx, AT_CMD_PARAM_TYPE_EMPTY, "", 0);
 }
 
+// =============================================================================
+// atParseSimpleLine: parse the most common command forms without scanner
+// -----------------------------------------------------------------------------
+/// The accepted forms are:
+/// - AT+<name>
+/// - AT+<name>?
+/// - AT+<name>=?
+/// - AT+<name>=<param>[,<param>...]
+///
+/// <name> is alphanumeric, and <param> is decimal digits, or double quoted
+/// printable characters without escape. All others, including unknown
+/// command name, are left to scanner to keep the same behavior.
+///
+/// @return 0 on success, AT_PARSE_NOT_SIMPLE or other errors
+// =============================================================================
+static int atParseSimpleLine(atParseCtx_t *ctx, const char *cmdline, unsigned length)
+{
+    if (length >= 2 && cmdline[length - 2] == '\r' && cmdline[length - 1] == '\n')
+        length -= 2;
+    else if (length >= 1 && cmdline[length - 1] == '\r')
+        length -= 1;
+    else
+        return AT_PARSE_NOT_SIMPLE;
+
+    if (length < 4 || toupper((int)cmdline[0]) != 'A' ||
+        toupper((int)cmdline[1]) != 'T' || cmdline[2] != '+')
+        return AT_PARSE_NOT_SIMPLE;
+
+    const char *end = cmdline + length;
+    const char *name = cmdline + 2;
+    const char *p = name + 1;
+    while (p < end && isalnum((int)*p))
+        p++;
+    if (p == name + 1)
+        return AT_PARSE_NOT_SIMPLE;
+
+    char name_buf[32];
+    unsigned name_len = p - name;
+    if (name_len >= sizeof(name_buf))
+        return AT_PARSE_NOT_SIMPLE;
+
+    uint8_t type;
+    if (p == end)
+        type = AT_CMD_EXE;
+    else if (p[0] == '?' && p + 1 == end)
+        type = AT_CMD_READ;
+    else if (p[0] == '=' && p[1] == '?' && p + 2 == end)
+        type = AT_CMD_TEST;
+    else if (p[0] == '=' && p + 1 < end)
+        type = AT_CMD_SET;
+    else
+        return AT_PARSE_NOT_SIMPLE;
+
+    const char *param_text[CONFIG_ATR_CMD_PARAM_MAX];
+    unsigned param_len[CONFIG_ATR_CMD_PARAM_MAX];
+    unsigned param_count = 0;
+    if (type == AT_CMD_SET)
+    {
+        const char *s = p + 1;
+        for (;;)
+        {
+            if (param_count >= CONFIG_ATR_CMD_PARAM_MAX)
+                return AT_PARSE_NOT_SIMPLE;
+
+            const char *q = s;
+            if (*q == '"')
+            {
+                for (q++; q < end && *q != '"'; q++)
+                {
+                    if (*q == '\\' || !isprint((int)*q))
+                        return AT_PARSE_NOT_SIMPLE;
+                }
+                if (q == end)
+                    return AT_PARSE_NOT_SIMPLE;
+                q++;
+            }
+            else
+            {
+                while (q < end && isdigit((int)*q))
+                    q++;
+                if (q == s)
+                    return AT_PARSE_NOT_SIMPLE;
+            }
+
+            param_text[param_count] = s;
+            param_len[param_count++] = q - s;
+            if (q == end)
+                break;
+            if (*q != ',' || q + 1 == end)
+                return AT_PARSE_NOT_SIMPLE;
+            s = q + 1;
+        }
+    }
+
+    memcpy(name_buf, name, name_len);
+    name_buf[name_len] = '\0';
+    if (atCommandSearchDesc(name_buf, name_len) == NULL)
+        return AT_PARSE_NOT_SIMPLE;
+
+    int result = atParseStartCmdText(ctx, name_buf, name_len);
+    if (result != 0)
+        return result;
+
+    ctx->curr_cmd->type = type;
+    for (unsigned n = 0; n < param_count; n++)
+    {
+        result = atParsePushParamText(ctx, AT_CMD_PARAM_TYPE_RAW, (char *)param_text[n], param_len[n]);
+        if (result != 0)
+            return result;
+    }
+    return 0;
+}
+
 // =============================================================================
 // at_ParseLine
 // =============================================================================
@@ -203,6 +413,11 @@ int atParseLine(const char *cmdline, unsigned length, atCommandHead_t *cmd_list)
     SLIST_INIT(&ctx.cmd_list);
     ctx.curr_cmd = NULL;
 
+    result = atParseSimpleLine(&ctx, cmdline, length);
+    if (result != AT_PARSE_NOT_SIMPLE)
+        goto destroy_exit;
+    result = 0;
+
     if (at_parse_lex_init_extra(&ctx, &scanner) != 0)
     {
         result = AT_PARSE_ERR_NOMEM;
@@ -228,10 +443,12 @@ destroy_exit:
     {
         SLIST_REMOVE_HEAD(&ctx.cmd_list, iter);
         SLIST_INSERT_HEAD(&rlist, cmd, iter);
+        atProfileCmdParsed(cmd);
     }
     SLIST_CONCAT(cmd_list, &rlist, atCommand, iter);
 
-    at_parse_lex_destroy(scanner);
+    if (scanner != NULL)
+        at_parse_lex_destroy(scanner);
     return result;
 }
 
@@ -0,0 +1,318 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "osi_api.h"
+#include "osi_log.h"
+#include "at_profile.h"
+#include "at_engine.h"
+#include "at_response.h"
+#include <stdio.h>
+#include <string.h>
+
+#define AT_PROF_INFLIGHT_MAX (32) // commands in flight to be tracked
+#define AT_PROF_CMD_MAX (32)      // distinct command names
+#define AT_PROF_CHANNEL_MAX (16)  // channels for pending depth
+#define AT_PROF_BUCKETS (20)      // histogram buckets
+#define AT_PROF_BUCKET_SHIFT (7)  // bucket 0 is [0, 128us)
+
+enum
+{
+    AT_PROF_PHASE_QUEUE,
+    AT_PROF_PHASE_EXEC,
+    AT_PROF_PHASE_ASYNC,
+    AT_PROF_PHASE_COUNT
+};
+
+typedef struct
+{
+    atCommand_t *cmd;
+    const atCmdDesc_t *desc;
+    int64_t parsed;
+    int64_t exec;
+    int64_t async;
+} atProfInflight_t;
+
+typedef struct
+{
+    uint32_t max;
+    uint16_t bucket[AT_PROF_BUCKETS];
+} atProfHist_t;
+
+typedef struct
+{
+    const atCmdDesc_t *desc; // NULL for unused
+    uint32_t count;
+    atProfHist_t phase[AT_PROF_PHASE_COUNT];
+} atProfCmd_t;
+
+typedef struct
+{
+    atProfInflight_t inflight[AT_PROF_INFLIGHT_MAX];
+    atProfCmd_t cmds[AT_PROF_CMD_MAX];
+    atProfCmd_t other; // commands not fit in cmds
+    uint8_t depth_max[AT_PROF_CHANNEL_MAX];
+} atProfile_t;
+
+static atProfile_t gAtProfile;
+
+static atProfInflight_t *atProfFind(atCommand_t *cmd)
+{
+    for (unsigned n = 0; n < AT_PROF_INFLIGHT_MAX; n++)
+    {
+        if (gAtProfile.inflight[n].cmd == cmd)
+            return &gAtProfile.inflight[n];
+    }
+    return NULL;
+}
+
+static atProfCmd_t *atProfCmdStat(const atCmdDesc_t *desc)
+{
+    for (unsigned n = 0; n < AT_PROF_CMD_MAX; n++)
+    {
+        atProfCmd_t *p = &gAtProfile.cmds[n];
+        if (p->desc == desc)
+            return p;
+        if (p->desc == NULL)
+        {
+            p->desc = desc;
+            return p;
+        }
+    }
+    return &gAtProfile.other;
+}
+
+static void atProfHistAdd(atProfHist_t *h, int64_t us)
+{
+    uint32_t val = (us < 0) ? 0 : (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+    unsigned b = 0;
+    for (uint32_t v = val >> AT_PROF_BUCKET_SHIFT; v != 0 && b < AT_PROF_BUCKETS - 1; v >>= 1)
+        b++;
+
+    if (h->bucket[b] < UINT16_MAX)
+        h->bucket[b]++;
+    if (val > h->max)
+        h->max = val;
+}
+
+/**
+ * Percentile from histogram, it is the upper bound of the bucket. So, it
+ * is an estimation no less than the real value, and no more than maximum.
+ */
+static uint32_t atProfHistPercentile(const atProfHist_t *h, unsigned percent)
+{
+    uint32_t total = 0;
+    for (unsigned n = 0; n < AT_PROF_BUCKETS; n++)
+        total += h->bucket[n];
+    if (total == 0)
+        return 0;
+
+    uint32_t target = (total * percent + 99) / 100;
+    uint32_t sum = 0;
+    for (unsigned n = 0; n < AT_PROF_BUCKETS - 1; n++)
+    {
+        sum += h->bucket[n];
+        if (sum >= target)
+            return OSI_MIN(uint32_t, (1u << (n + AT_PROF_BUCKET_SHIFT)) - 1, h->max);
+    }
+    return h->max;
+}
+
+void atProfileCmdParsed(atCommand_t *cmd)
+{
+    uint32_t critical = osiEnterCritical();
+    atProfInflight_t *p = atProfFind(NULL);
+    if (p != NULL)
+    {
+        p->cmd = cmd;
+        p->desc = cmd->desc;
+        p->parsed = osiUpTimeUS();
+        p->exec = 0;
+        p->async = 0;
+    }
+    osiExitCritical(critical);
+}
+
+void atProfileCmdExec(atCommand_t *cmd)
+{
+    uint32_t critical = osiEnterCritical();
+    atProfInflight_t *p = atProfFind(cmd);
+    if (p != NULL && p->exec == 0)
+        p->exec = osiUpTimeUS();
+
+    // commands of the channel in flight, including this one
+    unsigned channel = (cmd->engine == NULL) ? AT_PROF_CHANNEL_MAX : atCmdChannelIndex(cmd->engine);
+    if (channel < AT_PROF_CHANNEL_MAX)
+    {
+        unsigned depth = 0;
+        for (unsigned n = 0; n < AT_PROF_INFLIGHT_MAX; n++)
+        {
+            atCommand_t *c = gAtProfile.inflight[n].cmd;
+            if (c != NULL && c->engine == cmd->engine)
+                depth++;
+        }
+        if (depth > gAtProfile.depth_max[channel])
+            gAtProfile.depth_max[channel] = OSI_MIN(unsigned, depth, UINT8_MAX);
+    }
+    osiExitCritical(critical);
+}
+
+void atProfileCmdAsync(atCommand_t *cmd)
+{
+    uint32_t critical = osiEnterCritical();
+    atProfInflight_t *p = atProfFind(cmd);
+    if (p != NULL && p->exec != 0 && p->async == 0)
+        p->async = osiUpTimeUS();
+    osiExitCritical(critical);
+}
+
+void atProfileCmdDone(atCommand_t *cmd)
+{
+    int64_t now = osiUpTimeUS();
+    uint32_t critical = osiEnterCritical();
+    atProfInflight_t *p = atProfFind(cmd);
+    if (p != NULL)
+    {
+        // commands not executed (such as after error in command line) are
+        // not counted
+        if (p->exec != 0)
+        {
+            atProfCmd_t *s = atProfCmdStat(p->desc);
+            int64_t exec_end = (p->async != 0) ? p->async : now;
+            s->count++;
+            atProfHistAdd(&s->phase[AT_PROF_PHASE_QUEUE], p->exec - p->parsed);
+            atProfHistAdd(&s->phase[AT_PROF_PHASE_EXEC], exec_end - p->exec);
+            if (p->async != 0)
+                atProfHistAdd(&s->phase[AT_PROF_PHASE_ASYNC], now - p->async);
+        }
+        p->cmd = NULL;
+    }
+    osiExitCritical(critical);
+}
+
+/**
+ * Format profile of one command, the time unit is us.
+ * <name>,<count>,(<p50>,<p99>,<max>) of queue, exec and async
+ */
+static int atProfFormat(char *s, const atProfCmd_t *p)
+{
+    const char *name = (p->desc == NULL) ? "OTHER" : p->desc->name;
+    int len = sprintf(s, "\"%s\",%lu", name, (unsigned long)p->count);
+    for (unsigned n = 0; n < AT_PROF_PHASE_COUNT; n++)
+    {
+        const atProfHist_t *h = &p->phase[n];
+        len += sprintf(s + len, ",%lu,%lu,%lu",
+                       (unsigned long)atProfHistPercentile(h, 50),
+                       (unsigned long)atProfHistPercentile(h, 99),
+                       (unsigned long)h->max);
+    }
+    return len;
+}
+
+static void atProfSnapshot(atProfile_t *p)
+{
+    uint32_t critical = osiEnterCritical();
+    memcpy(p->cmds, gAtProfile.cmds, sizeof(p->cmds));
+    p->other = gAtProfile.other;
+    memcpy(p->depth_max, gAtProfile.depth_max, sizeof(p->depth_max));
+    osiExitCritical(critical);
+}
+
+static void atProfReset(void)
+{
+    uint32_t critical = osiEnterCritical();
+    memset(gAtProfile.cmds, 0, sizeof(gAtProfile.cmds));
+    memset(&gAtProfile.other, 0, sizeof(gAtProfile.other));
+    memset(gAtProfile.depth_max, 0, sizeof(gAtProfile.depth_max));
+    osiExitCritical(critical);
+}
+
+void atProfileDump(void)
+{
+    static atProfile_t snapshot;
+    atProfSnapshot(&snapshot);
+
+    char s[160];
+    for (unsigned n = 0; n < AT_PROF_CMD_MAX + 1; n++)
+    {
+        const atProfCmd_t *p = (n < AT_PROF_CMD_MAX) ? &snapshot.cmds[n] : &snapshot.other;
+        if (p->count == 0)
+            continue;
+        atProfFormat(s, p);
+        OSI_LOGXI(OSI_LOGPAR_S, 0, "AT profile %s", s);
+    }
+    for (unsigned n = 0; n < AT_PROF_CHANNEL_MAX; n++)
+    {
+        if (snapshot.depth_max[n] == 0)
+            continue;
+        OSI_LOGI(0, "AT profile channel %d max depth %d", n, snapshot.depth_max[n]);
+    }
+}
+
+// =============================================================================
+// AT+CMDPROF: AT command profile
+// -----------------------------------------------------------------------------
+// AT+CMDPROF?  output profile of each command and channel
+// AT+CMDPROF=0 reset profile
+// =============================================================================
+void atCmdHandleCMDPROF(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_SET)
+    {
+        bool paramok = true;
+        atParamUintInRange(cmd->params[0], 0, 0, &paramok);
+        if (!paramok || cmd->param_count != 1)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        atProfReset();
+        RETURN_OK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_READ)
+    {
+        // +CMDPROF: <name>,<count>,<queue p50>,<queue p99>,<queue max>,
+        //           <exec p50>,<exec p99>,<exec max>,
+        //           <async p50>,<async p99>,<async max>
+        // +CMDPROF: "CH<n>",<max depth>
+        static atProfile_t snapshot;
+        atProfSnapshot(&snapshot);
+        atProfileDump();
+
+        char rsp[192];
+        for (unsigned n = 0; n < AT_PROF_CMD_MAX + 1; n++)
+        {
+            const atProfCmd_t *p = (n < AT_PROF_CMD_MAX) ? &snapshot.cmds[n] : &snapshot.other;
+            if (p->count == 0)
+                continue;
+            int len = sprintf(rsp, "%s: ", cmd->desc->name);
+            atProfFormat(rsp + len, p);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+        for (unsigned n = 0; n < AT_PROF_CHANNEL_MAX; n++)
+        {
+            if (snapshot.depth_max[n] == 0)
+                continue;
+            sprintf(rsp, "%s: \"CH%u\",%u", cmd->desc->name, n, snapshot.depth_max[n]);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+        RETURN_OK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[32];
+        sprintf(rsp, "%s: (0)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        RETURN_OK(cmd->engine);
+    }
+    else
+    {
+        RETURN_CME_ERR(cmd->engine, ERR_AT_CME_OPTION_NOT_SURPORT);
+    }
+}
@@ -0,0 +1,52 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _AT_PROFILE_H_
+#define _AT_PROFILE_H_
+
+#include "at_command.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// AT command profile
+// -----------------------------------------------------------------------------
+/// Each command is profiled in 3 phases:
+/// - queue: from command line parsed to handler called
+/// - exec: from handler called to the first pending async event, or end
+/// - async: from the first pending async event to end
+///
+/// Statistics are collected by command name, and the maximum commands in
+/// flight are collected by channel.
+// =============================================================================
+
+/// Command is parsed from command line
+void atProfileCmdParsed(atCommand_t *cmd);
+
+/// Command handler is to be called
+void atProfileCmdExec(atCommand_t *cmd);
+
+/// Command starts to wait async event
+void atProfileCmdAsync(atCommand_t *cmd);
+
+/// Command is finished and to be destroyed
+void atProfileCmdDone(atCommand_t *cmd);
+
+/// Output profile to log
+void atProfileDump(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
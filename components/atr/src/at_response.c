@@ -254,6 +254,11 @@ static const char *_getCodeText(int code, const osiValueStrMap_t *info, unsigned
     sprintf(text, "%d", code);
     return text;
 }
+// Maximum channels for URC fan-out, and formatted URC up to the size is
+// on stack
+#define AT_URC_FANOUT_MAX (32)
+#define AT_URC_FANOUT_STACK_SIZE (256)
+
 static bool existSameSimIDChannel(uint8_t sim)
 {
     osiSlistHead_t *list = atDispatchGetList();
@@ -324,7 +329,7 @@ void atCmdRespInfoText(atCmdEngine_t *engine, const char *text)
 
 void atCmdRespInfoNTextBegin(atCmdEngine_t *engine, const char *text, size_t length)
 {
-    if (text == NULL)
+    if (text != NULL)
         OSI_LOGXI(OSI_LOGPAR_IIS, 0x10005281, "AT CMD%d info text begin len=%d: %s",
                   atCmdChannelIndex(engine), length, text);
     else
@@ -349,7 +354,7 @@ void atCmdRespInfoTextBegin(atCmdEngine_t *engine, const char *text)
 
 void atCmdRespInfoNTextEnd(atCmdEngine_t *engine, const char *text, size_t length)
 {
-    if (text == NULL)
+    if (text != NULL)
         OSI_LOGXI(OSI_LOGPAR_IIS, 0x10005283, "AT CMD%d info text end len=%d: %s",
                   atCmdChannelIndex(engine), length, text);
     else
@@ -638,16 +643,117 @@ void atCmdRespDefUrcCode(int code)
     }
 }
 
-void atCmdRespDefUrcNText(const char *text, size_t length)
+// =============================================================================
+// atCmdUrcFanout: output the same URC text to multiple channels
+// -----------------------------------------------------------------------------
+/// The URC is formatted once with line ending, and the line ending is
+/// patched only when it is different among channels. Each channel gets
+/// one write, and there is no per-channel log.
+// =============================================================================
+static void atCmdUrcFanout(atCmdEngine_t **engines, unsigned count, const char *text, size_t length)
 {
+#if defined(CONFIG_QUEC_PROJECT_FEATURE) || (defined(AT_CMUX_SUPPORT) && defined(AT_URC_2_ALL_MUX_CHANNEL))
+    for (unsigned n = 0; n < count; n++)
+        atCmdRespUrcNText(engines[n], text, length);
+#else
+    if (count == 0)
+        return;
+
+    if (text == NULL)
+        length = 0;
+    if (length > 0)
+    {
+        OSI_LOGXI(OSI_LOGPAR_IIS, 0, "AT urc fanout channels=%d len=%d: %s",
+                  count, length, text);
+    }
+
+    char stack_buf[AT_URC_FANOUT_STACK_SIZE];
+    size_t total = length + 4;
+    char *buf = (total <= sizeof(stack_buf)) ? stack_buf : (char *)malloc(total);
+    if (buf == NULL)
+    {
+        for (unsigned n = 0; n < count; n++)
+            atCmdRespUrcNText(engines[n], text, length);
+        return;
+    }
+
+    if (length > 0)
+        memcpy(buf + 2, text, length);
+
+    for (unsigned n = 0; n < count; n++)
+    {
+        atCmdEngine_t *engine = engines[n];
+        if (!atCmdEngineIsValid(engine))
+            continue;
+
+        atChannelSetting_t *chsetting = atCmdChannelSetting(engine);
+        if (chsetting->atq != 0)
+            continue;
+
+        buf[0] = buf[length + 2] = chsetting->s3;
+        buf[1] = buf[length + 3] = chsetting->s4;
+
+        atCmdUrcStart(engine);
+        atCmdUrcWrite(engine, buf, total);
+        atCmdUrcStop(engine);
+    }
+
+    if (buf != stack_buf)
+        free(buf);
+#endif
+}
+
+// =============================================================================
+// atCmdUrcCollect: collect channels for URC in one pass of channel list
+// -----------------------------------------------------------------------------
+/// Channels in command mode are collected. When \p check_ready is true,
+/// the device of channel should be ready. When \p sim is valid, and there
+/// are channels bound to \p sim, only these channels are kept.
+// =============================================================================
+static unsigned atCmdUrcCollect(atCmdEngine_t **engines, bool check_ready, int sim)
+{
+    unsigned count = 0;
+    uint32_t sim_mask = 0;
+
     osiSlistHead_t *list = atDispatchGetList();
     osiSlistItem_t *item;
     SLIST_FOREACH(item, list, iter)
     {
         atDispatch_t *dispatch = (atDispatch_t *)item;
-        if (dispatch != NULL && atDispatchIsCmdMode(dispatch))
-            atCmdRespUrcNText(atDispatchGetCmdEngine(dispatch), text, length);
+        if (dispatch == NULL || !atDispatchIsCmdMode(dispatch))
+            continue;
+        if (check_ready && !atDispatchGetDeviceReadyStatus(dispatch))
+            continue;
+
+        if (count >= AT_URC_FANOUT_MAX)
+        {
+            OSI_LOGE(0, "AT urc fanout too many channels");
+            break;
+        }
+
+        atCmdEngine_t *engine = atDispatchGetCmdEngine(dispatch);
+        if (sim >= 0 && atCmdGetSim(engine) == sim)
+            sim_mask |= (1u << count);
+        engines[count++] = engine;
     }
+
+    if (sim_mask == 0)
+        return count;
+
+    unsigned kept = 0;
+    for (unsigned n = 0; n < count; n++)
+    {
+        if (sim_mask & (1u << n))
+            engines[kept++] = engines[n];
+    }
+    return kept;
+}
+
+void atCmdRespDefUrcNText(const char *text, size_t length)
+{
+    atCmdEngine_t *engines[AT_URC_FANOUT_MAX];
+    unsigned count = atCmdUrcCollect(engines, false, -1);
+    atCmdUrcFanout(engines, count, text, length);
 }
 
 void atCmdRespDefUrcText(const char *text)
@@ -674,20 +780,9 @@ void atCmdRespSimUrcCode(uint8_t sim, int code)
 
 void atCmdRespSimUrcNText(uint8_t sim, const char *text, size_t length)
 {
-    bool bCheckSim = existSameSimIDChannel(sim);
-
-    osiSlistHead_t *list = atDispatchGetList();
-    osiSlistItem_t *item;
-    SLIST_FOREACH(item, list, iter)
-    {
-        atDispatch_t *dispatch = (atDispatch_t *)item;
-        if (dispatch != NULL && atDispatchIsCmdMode(dispatch) && atDispatchGetDeviceReadyStatus(dispatch))
-        {
-            if (bCheckSim && (sim != atCmdGetSim(atDispatchGetCmdEngine(dispatch))))
-                continue;
-            atCmdRespUrcNText(atDispatchGetCmdEngine(dispatch), text, length);
-        }
-    }
+    atCmdEngine_t *engines[AT_URC_FANOUT_MAX];
+    unsigned count = atCmdUrcCollect(engines, true, sim);
+    atCmdUrcFanout(engines, count, text, length);
 }
 
 void atCmdRespSimUrcText(uint8_t sim, const char *text)
@@ -816,6 +911,51 @@ void atCmdRespOutputNText(atCmdEngine_t *engine, const char *text, size_t length
     atCmdWriteFlush(engine);
 }
 
+// =============================================================================
+// atEncodeHex
+// =============================================================================
+#define HEX_PAIR16(h) h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7" \
+                      h "8" h "9" h "a" h "b" h "c" h "d" h "e" h "f"
+
+// lower case hex text of each byte value, 2 characters per byte
+static const char gHexPairs[512 + 1] =
+    HEX_PAIR16("0") HEX_PAIR16("1") HEX_PAIR16("2") HEX_PAIR16("3")
+    HEX_PAIR16("4") HEX_PAIR16("5") HEX_PAIR16("6") HEX_PAIR16("7")
+    HEX_PAIR16("8") HEX_PAIR16("9") HEX_PAIR16("a") HEX_PAIR16("b")
+    HEX_PAIR16("c") HEX_PAIR16("d") HEX_PAIR16("e") HEX_PAIR16("f");
+
+size_t atEncodeHex(char *dst, const void *src, size_t size)
+{
+    const uint8_t *s = (const uint8_t *)src;
+    for (size_t n = 0; n < size; n++)
+        memcpy(&dst[2 * n], &gHexPairs[2 * s[n]], 2);
+    return 2 * size;
+}
+
+// =============================================================================
+// atCmdRespOutputHex
+// =============================================================================
+#define AT_OUTPUT_HEX_CHUNK (128)
+
+void atCmdRespOutputHex(atCmdEngine_t *engine, const void *data, size_t length)
+{
+    if (data == NULL || length == 0)
+        return;
+
+    OSI_LOGI(0, "AT CMD%d output hex length %d", atCmdChannelIndex(engine), length);
+
+    char hex[AT_OUTPUT_HEX_CHUNK * 2];
+    const uint8_t *p = (const uint8_t *)data;
+    while (length > 0)
+    {
+        size_t n = (length < AT_OUTPUT_HEX_CHUNK) ? length : AT_OUTPUT_HEX_CHUNK;
+        atCmdWrite(engine, hex, atEncodeHex(hex, p, n));
+        p += n;
+        length -= n;
+    }
+    atCmdWriteFlush(engine);
+}
+
 // =============================================================================
 // atCmdRespOutputPrompt
 // =============================================================================
@@ -23,6 +23,7 @@
 #include "audio_player.h"
 #include "audio_recorder.h"
 #include "audio_encoder.h"
+#include "audio_metrics.h"
 #include "audio_tonegen.h"
 #include "cfw_chset.h"
 #include "vfs.h"
@@ -750,6 +751,77 @@ void atCmdHandleCANXP(atCommand_t *pParam)
     return;
 }
 
+static void prvMetricsHistResp(atCommand_t *cmd, const char *name, const auMetricsHist_t *h)
+{
+    char rsp[320];
+    unsigned avg = (h->count == 0) ? 0 : (unsigned)(h->sum / h->count);
+    int len = sprintf(rsp, "%s: \"%s\",%u,%u,%u,%u,\"", cmd->desc->name, name,
+                      h->count, h->min, h->max, avg);
+    for (unsigned n = 0; n < AUMETRICS_HIST_BUCKETS; n++)
+        len += sprintf(rsp + len, (n == 0) ? "%u" : ",%u", h->bucket[n]);
+    sprintf(rsp + len, "\"");
+    atCmdRespInfoText(cmd->engine, rsp);
+}
+
+void atCmdHandleCAUDSTAT(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_SET)
+    {
+        // RESET:   AT+CAUDSTAT=0
+        bool paramok = true;
+        atParamUintInRange(cmd->params[0], 0, 0, &paramok);
+        if (!paramok || cmd->param_count != 1)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        auMetricsReset();
+        RETURN_OK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_READ)
+    {
+        // +CAUDSTAT: "play",<requests>,<underruns>
+        // +CAUDSTAT: "rec",<requests>,<overruns>,<drops>
+        // +CAUDSTAT: "voice",<starts>,<prepared starts>,<prepare timeouts>
+        // +CAUDSTAT: <name>,<count>,<min>,<max>,<avg>,<buckets>
+        static const char *decoder_names[AUMETRICS_DECODER_COUNT] = {
+            "dec-unknown", "dec-pcm", "dec-wav", "dec-mp3", "dec-amrnb", "dec-amrwb", "dec-sbc"};
+
+        auMetrics_t m;
+        auMetricsGet(&m);
+        auMetricsDump();
+
+        char rsp[64];
+        sprintf(rsp, "%s: \"play\",%u,%u", cmd->desc->name, m.play_requests, m.play_underruns);
+        atCmdRespInfoText(cmd->engine, rsp);
+        sprintf(rsp, "%s: \"rec\",%u,%u,%u", cmd->desc->name, m.rec_requests, m.rec_overruns, m.rec_drops);
+        atCmdRespInfoText(cmd->engine, rsp);
+        prvMetricsHistResp(cmd, "play-fill", &m.play_fill);
+        prvMetricsHistResp(cmd, "play-latency", &m.play_latency);
+        prvMetricsHistResp(cmd, "rec-fill", &m.rec_fill);
+        sprintf(rsp, "%s: \"voice\",%u,%u,%u", cmd->desc->name, m.voice_starts,
+                m.voice_prepared_starts, m.voice_prepare_timeouts);
+        atCmdRespInfoText(cmd->engine, rsp);
+        prvMetricsHistResp(cmd, "voice-prepare", &m.voice_prepare_us);
+        prvMetricsHistResp(cmd, "voice-setup", &m.voice_setup_us);
+        for (unsigned n = 0; n < AUMETRICS_DECODER_COUNT; n++)
+        {
+            if (m.decode_us[n].count != 0)
+                prvMetricsHistResp(cmd, decoder_names[n], &m.decode_us[n]);
+        }
+        RETURN_OK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[32];
+        sprintf(rsp, "%s: (0)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        RETURN_OK(cmd->engine);
+    }
+    else
+    {
+        RETURN_CME_ERR(cmd->engine, ERR_AT_CME_OPTION_NOT_SURPORT);
+    }
+}
+
 typedef uint32_t (*PFN_AT_CC_CB)(const osiEvent_t *event);
 
 extern PFN_AT_CC_CB pAT_CC_SPEECH_CALL_IND_CB;
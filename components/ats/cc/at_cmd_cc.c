@@ -51,6 +51,7 @@
 #define AT_GPRS_DIALSTR6 "*99"
 
 #define AT_RING_ELAPSE_MS 6000
+#define AT_VOICE_PREPARE_TIMEOUT_MS (2 * AT_RING_ELAPSE_MS)
 #define ATD_EXTENSION_FIRST_DELAY_MS 2000
 #define ATD_EXTENSION_INTERVAL_MS 100
 
@@ -415,6 +416,7 @@ static void _ringTimeout(void *param)
             osiTimerStart(gAtCfwCtx.sim[sim].ring_timer, AT_RING_ELAPSE_MS);
             atCmdRingInd(sim);
 #ifdef CONFIG_SOC_8910
+            audevPrepareVoice(AT_VOICE_PREPARE_TIMEOUT_MS);
             if (gAtSetting.callmode == 0)
             {
                 audevPlayTone(AUDEV_TONE_DIAL, 500);
@@ -553,6 +555,10 @@ static void _onEV_CFW_CC_SPEECH_CALL_IND(const osiEvent_t *event)
     if (cfw_event->nType != 0)
         return; // shouldn't exist
 
+#ifdef CONFIG_SOC_8910
+    // load voice config before answer, the ring tone shares it
+    audevPrepareVoice(AT_VOICE_PREPARE_TIMEOUT_MS);
+#endif
     audevPlayTone(AUDEV_TONE_DIAL, 500);
 
     uint8_t sim = cfw_event->nFlag;
@@ -62,6 +62,7 @@ static const osiValueStrMap_t gCharSetVSMap[] = {
     {cs_ira, "IRA"},
     {0, NULL},
 };
+static osiVsmapStrIndex_t gCharSetIndex = OSI_VSMAP_STR_INDEX_INIT(gCharSetVSMap, true);
 
 extern void AT_Audio_Init(void);
 
@@ -661,7 +662,7 @@ void atCmdHandleCSCS(atCommand_t *cmd)
         if (!paramok || cmd->param_count > 1)
             RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
 
-        const osiValueStrMap_t *chset_vs = osiVsmapFindByIStr(gCharSetVSMap, chset_str);
+        const osiValueStrMap_t *chset_vs = osiVsmapIndexFind(&gCharSetIndex, chset_str);
         if (chset_vs == NULL)
             RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
 
@@ -55,6 +55,10 @@ typedef enum
     LPA_FUNC_APP_URL,
 } LPA_FUNC_E;
 
+// Download stages run inside the LPA library, only the whole download
+// time can be measured here.
+static int64_t gLpaDownloadStart;
+
 static uint8_t _GetFuncIndex(const char *pFuncName)
 {
     char upperName[32] = {
@@ -145,7 +149,8 @@ static uint8_t _GetFuncIndex(const char *pFuncName)
 
 static void _handleLpaAppDownload(void *ctx, uint8_t nStatus, void *pData, CFW_SIM_ID nSimId)
 {
-    OSI_LOGI(0, "_handleLpaAppDownload, nStatus:%d", nStatus);
+    OSI_LOGI(0, "_handleLpaAppDownload, nStatus:%d, time:%u ms", nStatus,
+             (unsigned)(osiUpTime() - gLpaDownloadStart));
     atCommand_t *cmd = (atCommand_t *)ctx;
     LPA_DOWNLOADD_RESULT_T *pResult = (LPA_DOWNLOADD_RESULT_T *)pData;
     OSI_LOGI(0, "pResult->nStatus:%d", pResult->nStatus);
@@ -461,6 +466,7 @@ void atCmdHandleLPA(atCommand_t *cmd)
         {
         case LPA_FUNC_DOWLOAD:
         {
+            gLpaDownloadStart = osiUpTime();
             if (lpa_app_download((void *)cmd, "esim.wo.cn", _handleLpaAppDownload, nSim) == LPA_SUCCESS)
                 RETURN_FOR_ASYNC();
             else
@@ -12,8 +12,12 @@
 
 #include "osi_log.h"
 #include "osi_mem.h"
+#include "osi_slab.h"
 #include "osi_sysnv.h"
 #include "osi_trace.h"
+#include "osi_profile.h"
+#include "osi_boot.h"
+#include "osi_api_inside.h"
 #include "at_cfw.h"
 #include "at_cfg.h"
 #include "at_engine.h"
@@ -24,6 +28,7 @@
 #include "hal_chip.h"
 #include "drv_md_ipc.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include "hal_config.h"
@@ -166,6 +171,579 @@ void atCmdHandleHEAPINFO(atCommand_t *cmd)
         sprintf(rsp, "%s: %p,%ld,%ld,%ld", cmd->desc->name,
                 stat.start, stat.size, stat.avail_size, stat.max_block_size);
         atCmdRespInfoText(cmd->engine, rsp);
+
+        // slab classes: block size, pages, used, peak, fallback to heap
+        for (unsigned n = 0; n < osiSlabClassCount(); n++)
+        {
+            osiSlabClassStat_t cstat;
+            if (!osiSlabClassStat(n, &cstat))
+                break;
+
+            sprintf(rsp, "%s: slab,%lu,%lu,%lu,%lu,%lu", cmd->desc->name,
+                    cstat.block_size, cstat.page_count, cstat.used_count,
+                    cstat.peak_count, cstat.fallback);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+void atCmdHandleTHREADSTAT(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[64];
+        sprintf(rsp, "%s: (0,1)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_SET)
+    {
+        // ^THREADSTAT[=reset]
+        bool paramok = true;
+        bool reset = false;
+        if (cmd->type == AT_CMD_SET)
+        {
+            reset = atParamUintInRange(cmd->params[0], 0, 1, &paramok);
+            if (!paramok || cmd->param_count > 1)
+                RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+        }
+
+        unsigned count = osiThreadCount();
+        osiThreadStatus_t *status = (osiThreadStatus_t *)malloc(count * sizeof(osiThreadStatus_t));
+        if (status == NULL)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_NO_MEMORY);
+
+        int num = osiThreadGetAllStatus(status, count);
+        int shown = 0;
+
+        // thread number, name, run time (ms), switch count, max wakeup latency (us)
+        char rsp[128];
+        for (int n = 0; n < num; n++)
+        {
+            osiThreadCpuStat_t stat;
+            if (!osiThreadCpuStat(status[n].thread_number, &stat, reset))
+                continue;
+
+            snprintf(rsp, sizeof(rsp), "%s: %u,\"%s\",%lu,%lu,%lu", cmd->desc->name,
+                     stat.id, status[n].name, (unsigned long)(stat.run_time_us / 1000),
+                     (unsigned long)stat.switch_count, (unsigned long)stat.max_latency_us);
+            atCmdRespInfoText(cmd->engine, rsp);
+            shown++;
+        }
+        free(status);
+
+        // statistics not enabled
+        if (shown == 0)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_EXE_FAIL);
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+static inline char prvTagChar(uint32_t tag, unsigned n)
+{
+    char c = (tag >> (n * 8)) & 0xff;
+    return (c >= 0x20 && c < 0x7f && c != '"') ? c : '?';
+}
+
+void atCmdHandlePMSTAT(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[64];
+        sprintf(rsp, "%s: (0,1)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_SET)
+    {
+        // ^PMSTAT[=reset]
+        bool paramok = true;
+        bool reset = false;
+        if (cmd->type == AT_CMD_SET)
+        {
+            reset = atParamUintInRange(cmd->params[0], 0, 1, &paramok);
+            if (!paramok || cmd->param_count > 1)
+                RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+        }
+
+        int count = osiPmSourceStat(NULL, 0, false);
+        osiPmSourceStat_t *sources = (osiPmSourceStat_t *)malloc(count * sizeof(osiPmSourceStat_t) + 1);
+        osiPmSleepStat_t *sleep = (osiPmSleepStat_t *)malloc(sizeof(osiPmSleepStat_t));
+        if (sources == NULL || sleep == NULL)
+        {
+            free(sources);
+            free(sleep);
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_NO_MEMORY);
+        }
+
+        count = osiPmSourceStat(sources, count, reset);
+        osiPmSleepStat(sleep, reset);
+
+        // PM source: tag, active, wake lock count, sleep blocked count, hold time (ms)
+        char rsp[128];
+        for (int n = 0; n < count; n++)
+        {
+            osiPmSourceStat_t *s = &sources[n];
+            sprintf(rsp, "%s: src,\"%c%c%c%c\",%d,%lu,%lu,%lu", cmd->desc->name,
+                    prvTagChar(s->tag, 0), prvTagChar(s->tag, 1),
+                    prvTagChar(s->tag, 2), prvTagChar(s->tag, 3), s->active ? 1 : 0,
+                    s->lock_count, s->blocked_count, s->hold_ms);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        // sleep blocked by: source, prepare, sysclk, chip, short, data lock
+        sprintf(rsp, "%s: blocked,%lu,%lu,%lu,%lu,%lu,%lu", cmd->desc->name,
+                sleep->blocked[OSI_PM_BLOCK_SOURCE], sleep->blocked[OSI_PM_BLOCK_PREPARE],
+                sleep->blocked[OSI_PM_BLOCK_SYSCLK], sleep->blocked[OSI_PM_BLOCK_CHIP],
+                sleep->blocked[OSI_PM_BLOCK_SHORT], sleep->blocked[OSI_PM_BLOCK_DATA_LOCK]);
+        atCmdRespInfoText(cmd->engine, rsp);
+
+        sprintf(rsp, "%s: suspend,%lu", cmd->desc->name, sleep->suspend_count);
+        atCmdRespInfoText(cmd->engine, rsp);
+
+        // wakeup source: bit, count
+        for (unsigned n = 0; n < OSI_ARRAY_SIZE(sleep->wake_source); n++)
+        {
+            if (sleep->wake_source[n] == 0)
+                continue;
+
+            sprintf(rsp, "%s: wake,%u,%lu", cmd->desc->name, n, sleep->wake_source[n]);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        // latest cycles: suspend up time (ms), sleep time (ms), wakeup source, 32K sleep
+        for (unsigned n = 0; n < sleep->cycle_count; n++)
+        {
+            osiPmCycle_t *c = &sleep->cycles[n];
+            sprintf(rsp, "%s: cycle,%lld,%lu,0x%08lx,%d", cmd->desc->name,
+                    c->suspend_time, c->sleep_ms, c->source, c->sleep32k ? 1 : 0);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        free(sources);
+        free(sleep);
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+static int prvIrqOffCompare(const void *a, const void *b)
+{
+    const osiIrqOffStat_t *sa = (const osiIrqOffStat_t *)a;
+    const osiIrqOffStat_t *sb = (const osiIrqOffStat_t *)b;
+    return (sa->max_us < sb->max_us) ? 1 : (sa->max_us > sb->max_us) ? -1 : 0;
+}
+
+void atCmdHandleIRQOFF(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[64];
+        sprintf(rsp, "%s: (0,1)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_SET)
+    {
+        // ^IRQOFF[=reset]
+        bool paramok = true;
+        bool reset = false;
+        if (cmd->type == AT_CMD_SET)
+        {
+            reset = atParamUintInRange(cmd->params[0], 0, 1, &paramok);
+            if (!paramok || cmd->param_count > 1)
+                RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+        }
+
+        int count = osiIrqOffStat(NULL, 0, false);
+        osiIrqOffStat_t *stats = (osiIrqOffStat_t *)malloc(count * sizeof(osiIrqOffStat_t) + 1);
+        if (stats == NULL)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_NO_MEMORY);
+
+        count = osiIrqOffStat(stats, count, reset);
+        qsort(stats, count, sizeof(osiIrqOffStat_t), prvIrqOffCompare);
+
+        // caller, count, maximum (us), total (us), histogram from <4us
+        char rsp[160];
+        for (int n = 0; n < count; n++)
+        {
+            osiIrqOffStat_t *s = &stats[n];
+            char *p = rsp;
+            p += sprintf(p, "%s: 0x%08x,%lu,%lu,%llu", cmd->desc->name,
+                         (unsigned)s->caller, s->count, s->max_us, s->total_us);
+            for (unsigned b = 0; b < OSI_IRQ_OFF_BUCKET_COUNT; b++)
+                p += sprintf(p, ",%lu", s->hist[b]);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        free(stats);
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+void atCmdHandleIRQSTAT(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[64];
+        sprintf(rsp, "%s: (0,1)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_SET)
+    {
+        // ^IRQSTAT[=reset]
+        bool paramok = true;
+        bool reset = false;
+        if (cmd->type == AT_CMD_SET)
+        {
+            reset = atParamUintInRange(cmd->params[0], 0, 1, &paramok);
+            if (!paramok || cmd->param_count > 1)
+                RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+        }
+
+        int count = osiIrqStat(NULL, 0, false);
+        osiIrqStat_t *stats = (osiIrqStat_t *)malloc(count * sizeof(osiIrqStat_t) + 1);
+        if (stats == NULL)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_NO_MEMORY);
+
+        // irqn, count, maximum (us), total (us), maximum nesting depth
+        char rsp[96];
+        count = osiIrqStat(stats, count, reset);
+        for (int n = 0; n < count; n++)
+        {
+            osiIrqStat_t *s = &stats[n];
+            sprintf(rsp, "%s: %lu,%lu,%lu,%llu,%lu", cmd->desc->name,
+                    s->irqn, s->count, s->max_us, s->total_us, s->max_nest);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        free(stats);
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+void atCmdHandleSTACKMON(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[64];
+        sprintf(rsp, "%s: (0,1)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_SET)
+    {
+        // ^STACKMON=0 to clear records, ^STACKMON=1 to sample and save now
+        bool paramok = true;
+        unsigned mode = atParamUintInRange(cmd->params[0], 0, 1, &paramok);
+        if (!paramok || cmd->param_count > 1)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        if (mode == 0)
+        {
+            osiStackMonClear();
+        }
+        else
+        {
+            osiStackMonSample();
+            if (!osiStackMonSave())
+                RETURN_CME_ERR(cmd->engine, ERR_AT_CME_EXE_FAIL);
+        }
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE)
+    {
+        int count = osiStackMonGet(NULL, 0);
+        osiStackMonRecord_t *records = (osiStackMonRecord_t *)malloc(count * sizeof(osiStackMonRecord_t) + 1);
+        if (records == NULL)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_NO_MEMORY);
+
+        // "name", stack size, maximum used, recommended size
+        char rsp[96];
+        count = osiStackMonGet(records, count);
+        for (int n = 0; n < count; n++)
+        {
+            osiStackMonRecord_t *r = &records[n];
+            sprintf(rsp, "%s: \"%s\",%lu,%lu,%lu", cmd->desc->name,
+                    r->name, r->alloc_size, r->max_used, r->recommended);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        free(records);
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+void atCmdHandleBOOTPROF(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_EXE)
+    {
+        unsigned count = osiBootMarkGet(NULL, 0);
+        osiBootMark_t *marks = (osiBootMark_t *)malloc(count * sizeof(osiBootMark_t) + 1);
+        if (marks == NULL)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_NO_MEMORY);
+
+        // "name", start time in us, duration in us
+        char rsp[96];
+        count = osiBootMarkGet(marks, count);
+        for (unsigned n = 0; n < count; n++)
+        {
+            osiBootMark_t *m = &marks[n];
+            snprintf(rsp, sizeof(rsp), "%s: \"%s\",%lu,%lu", cmd->desc->name,
+                     m->name, m->start, m->end - m->start);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        free(marks);
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+static inline char prvLogTagChar(unsigned tag, unsigned n)
+{
+    char c = (tag >> (n * 7)) & 0x7f;
+    return (c >= 0x20 && c < 0x7f && c != '"') ? c : '?';
+}
+
+void atCmdHandleLOGTAG(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[64];
+        sprintf(rsp, "%s: \"tag\",(0-5),(0-65535),(0-65535)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_SET)
+    {
+        // ^LOGTAG=<tag>[,<level>[,<rate>[,<burst>]]], remove the runtime
+        // level without <level>, and remove the budget when <rate> is 0
+        bool paramok = true;
+        const char *name = atParamStr(cmd->params[0], &paramok);
+        unsigned level = atParamDefUintInRange(cmd->params[1], OSI_LOG_LEVEL_VERBOSE, OSI_LOG_LEVEL_NEVER,
+                                               OSI_LOG_LEVEL_VERBOSE, &paramok);
+        unsigned rate = atParamDefUintInRange(cmd->params[2], 0, 0, 65535, &paramok);
+        unsigned burst = atParamDefUintInRange(cmd->params[3], 0, 0, 65535, &paramok);
+        if (!paramok || cmd->param_count > 4 || strlen(name) == 0 || strlen(name) > 4)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        char c[4] = {' ', ' ', ' ', ' '};
+        memcpy(c, name, strlen(name));
+        unsigned tag = OSI_MAKE_LOG_TAG(c[0], c[1], c[2], c[3]);
+        if (cmd->param_count < 2)
+            osiLogRemoveTagLevel(tag);
+        else if (!osiLogSetTagLevel(tag, level))
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_EXE_FAIL);
+        else if (cmd->param_count > 2 && !osiLogSetTagBudget(tag, rate, burst))
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_EXE_FAIL);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_READ || cmd->type == AT_CMD_EXE)
+    {
+        // ^LOGTAG: <tag>,<level>,<emitted>,<dropped>,<throttled>, and reset
+        // counters by EXE
+        unsigned count = osiLogTagStat(NULL, 0, false);
+        osiLogTagStat_t *stat = (osiLogTagStat_t *)malloc(count * sizeof(osiLogTagStat_t) + 1);
+        if (stat == NULL)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_NO_MEMORY);
+
+        count = osiLogTagStat(stat, count, cmd->type == AT_CMD_EXE);
+
+        char rsp[64];
+        for (unsigned n = 0; n < count; n++)
+        {
+            osiLogTagStat_t *s = &stat[n];
+            sprintf(rsp, "%s: \"%c%c%c%c\",%u,%lu,%lu,%lu", cmd->desc->name,
+                    prvLogTagChar(s->tag, 0), prvLogTagChar(s->tag, 1),
+                    prvLogTagChar(s->tag, 2), prvLogTagChar(s->tag, 3),
+                    s->level, s->emitted, s->dropped, s->throttled);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        free(stat);
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+void atCmdHandleMEMTRACK(atCommand_t *cmd)
+{
+    char rsp[96];
+    if (cmd->type == AT_CMD_TEST)
+    {
+        sprintf(rsp, "%s: (0-65535)", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_SET)
+    {
+        // ^MEMTRACK=<rate>, 0 to disable
+        bool paramok = true;
+        unsigned rate = atParamUintInRange(cmd->params[0], 0, 65535, &paramok);
+        if (!paramok || cmd->param_count > 1)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        osiMemTrackSetRate(rate);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_READ)
+    {
+        sprintf(rsp, "%s: %u", cmd->desc->name, osiMemTrackRate());
+        atCmdRespInfoText(cmd->engine, rsp);
+        if (cmd->type == AT_CMD_READ)
+            RETURN_OK(cmd->engine);
+
+        // top allocation sites: caller, bytes, blocks
+        osiMemTrackSite_t sites[16];
+        unsigned count = osiMemTrackTopSites(sites, OSI_ARRAY_SIZE(sites));
+        for (unsigned n = 0; n < count; n++)
+        {
+            sprintf(rsp, "%s: site,0x%08lx,%lu,%lu", cmd->desc->name,
+                    sites[n].caller, sites[n].size, sites[n].count);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        // heap: available size, largest free block
+        osiMemPoolStat_t stat;
+        if (osiMemPoolStat(NULL, &stat))
+        {
+            sprintf(rsp, "%s: heap,%lu,%lu", cmd->desc->name,
+                    stat.avail_size, stat.max_block_size);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+
+        // free blocks by size: block size, free blocks
+        for (unsigned n = 0; n < osiSlabClassCount(); n++)
+        {
+            osiSlabClassStat_t cstat;
+            if (!osiSlabClassStat(n, &cstat))
+                break;
+
+            sprintf(rsp, "%s: free,%lu,%lu", cmd->desc->name,
+                    cstat.block_size, cstat.free_count);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+void atCmdHandleMEMBUDGET(atCommand_t *cmd)
+{
+    char rsp[96];
+    if (cmd->type == AT_CMD_TEST)
+    {
+        sprintf(rsp, "%s: (0-%d),<soft>,<hard>", cmd->desc->name, OSI_MEM_BUDGET_COUNT - 1);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_SET)
+    {
+        // ^MEMBUDGET=<id>,<soft>,<hard>, 0 for no limit
+        bool paramok = true;
+        unsigned id = atParamUintInRange(cmd->params[0], 0, OSI_MEM_BUDGET_COUNT - 1, &paramok);
+        uint32_t soft = atParamUint(cmd->params[1], &paramok);
+        uint32_t hard = atParamUint(cmd->params[2], &paramok);
+        if (!paramok || cmd->param_count > 3 || (hard != 0 && soft > hard))
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        if (!osiMemBudgetSetLimit((osiMemBudgetId_t)id, soft, hard))
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_READ)
+    {
+        // ^MEMBUDGET: <id>,<used>,<peak>,<count>,<soft>,<hard>,<pressure>,<fail>,
+        // and reset peak to current by EXE
+        for (unsigned id = 0; id < OSI_MEM_BUDGET_COUNT; id++)
+        {
+            osiMemBudgetStat_t stat;
+            if (!osiMemBudgetStat((osiMemBudgetId_t)id, &stat))
+                RETURN_CME_ERR(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+
+            sprintf(rsp, "%s: %u,%lu,%lu,%lu,%lu,%lu,%lu,%lu", cmd->desc->name, id,
+                    stat.used, stat.peak, stat.count, stat.soft_limit, stat.hard_limit,
+                    stat.pressure_count, stat.fail_count);
+            atCmdRespInfoText(cmd->engine, rsp);
+            if (cmd->type == AT_CMD_EXE)
+                osiMemBudgetResetPeak((osiMemBudgetId_t)id);
+        }
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
+void atCmdHandleMEMREPORT(atCommand_t *cmd)
+{
+    char rsp[96];
+    if (cmd->type == AT_CMD_TEST)
+    {
+        sprintf(rsp, "%s: <low_avail>,<low_block>", cmd->desc->name);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_SET)
+    {
+        // ^MEMREPORT=<low_avail>,<low_block>, thresholds of memory pressure, 0 to disable
+        bool paramok = true;
+        uint32_t avail = atParamUint(cmd->params[0], &paramok);
+        uint32_t block = atParamUint(cmd->params[1], &paramok);
+        if (!paramok || cmd->param_count > 2)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        osiMemPressureSetThreshold(avail, block);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_READ)
+    {
+        // ^MEMREPORT: <name>,<used>,<peak>,<pool>,<avail>,<max_block>,<frag>
+        osiMemReportEntry_t entries[OSI_MEM_BUDGET_COUNT + 1];
+        unsigned count = osiMemReport(entries, OSI_ARRAY_SIZE(entries));
+        for (unsigned n = 0; n < count; n++)
+        {
+            sprintf(rsp, "%s: %s,%lu,%lu,%lu,%lu,%lu,%lu", cmd->desc->name, entries[n].name,
+                    entries[n].used, entries[n].peak, entries[n].pool_size,
+                    entries[n].avail_size, entries[n].max_block_size, entries[n].frag);
+            atCmdRespInfoText(cmd->engine, rsp);
+        }
         atCmdRespOK(cmd->engine);
     }
     else
@@ -28,6 +28,7 @@
 #endif
 #include "nvm.h"
 #include "netmain.h"
+#include "net_time_sync.h"
 #include "ppp_interface.h"
 
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_NW
@@ -537,8 +538,13 @@ static void _onEV_CFW_NW_NETWORKINFO_IND(const osiEvent_t *event)
         if (gAtSetting.ctzu)
 #endif
         {
-            osiSetEpochTime(mktime(&tm) * 1000LL);
-            drvRtcUpdateTime();
+            // time service decides whether NITZ is better than current time
+            if (!netTimeSyncFeed(NET_TIME_SOURCE_NITZ, mktime(&tm) * 1000LL,
+                                 osiUpTime(), NET_TIME_SYNC_NITZ_ERROR))
+            {
+                osiSetEpochTime(mktime(&tm) * 1000LL);
+                drvRtcUpdateTime();
+            }
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_NW
 			time_t nw_time = mktime(&tm);
 			quec_save_nw_sync_time(nw_time);
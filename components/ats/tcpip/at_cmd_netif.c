@@ -19,6 +19,8 @@
 #include "at_engine.h"
 #include "at_command.h"
 #include "sockets.h"
+#include "net_iperf.h"
+#include <stdlib.h>
 
 extern void _dnsAddressToStr(const CFW_GPRS_PDPCONT_INFO_V2 *pdp_cont, char *str);
 
@@ -139,4 +141,121 @@ void AT_NET_CmdFunc_NetInfo(atCommand_t *pParam)
     }
 }
 
+static atCmdEngine_t *gIperfEngine = NULL;
+
+static void prvIperfUrc(const char *text)
+{
+    if (atCmdEngineIsValid(gIperfEngine))
+        atCmdRespUrcText(gIperfEngine, text);
+    else
+        atCmdRespDefUrcText(text);
+}
+
+static void prvIperfReportOut(void *param)
+{
+    netIperfReport_t *r = (netIperfReport_t *)param;
+    char rsp[160];
+
+    // event, error, duration (ms), bytes, kbps, TCP/IP thread CPU and
+    // system CPU (permille), retransmit, lwip heap used and peak, and UDP
+    // datagrams, lost, out of order and jitter (us)
+    snprintf(rsp, sizeof(rsp), "^IPERF: %d,%d,%lu,%llu,%lu,%d,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+             r->event, r->error, (unsigned long)r->duration_ms, (unsigned long long)r->bytes,
+             (unsigned long)r->kbps, r->net_cpu_permille, r->cpu_permille,
+             (unsigned long)r->rexmit, (unsigned long)r->mem_used, (unsigned long)r->mem_peak,
+             (unsigned long)r->datagrams, (unsigned long)r->lost,
+             (unsigned long)r->outorder, (unsigned long)r->jitter_us);
+    prvIperfUrc(rsp);
+
+    // uplink and downlink bytes of lwip, PPP and RNDIS path, idle netif
+    // is not shown
+    for (unsigned n = 0; n < r->netif_count; n++)
+    {
+        const netIperfNetifStat_t *s = &r->netif[n];
+        uint32_t total = 0;
+        for (unsigned p = 0; p < NET_IPERF_PATH_COUNT; p++)
+            total |= s->ul[p] | s->dl[p];
+        if (total == 0)
+            continue;
+
+        snprintf(rsp, sizeof(rsp), "^IPERFNETIF: \"%s\",%lu,%lu,%lu,%lu,%lu,%lu", s->name,
+                 (unsigned long)s->ul[NET_IPERF_PATH_LWIP], (unsigned long)s->dl[NET_IPERF_PATH_LWIP],
+                 (unsigned long)s->ul[NET_IPERF_PATH_PPP], (unsigned long)s->dl[NET_IPERF_PATH_PPP],
+                 (unsigned long)s->ul[NET_IPERF_PATH_RNDIS], (unsigned long)s->dl[NET_IPERF_PATH_RNDIS]);
+        prvIperfUrc(rsp);
+    }
+    free(r);
+}
+
+static void prvIperfReport(void *ctx, const netIperfReport_t *report)
+{
+    // called with TCP/IP core locked, output in AT thread
+    netIperfReport_t *r = (netIperfReport_t *)malloc(sizeof(netIperfReport_t));
+    if (r == NULL)
+        return;
+
+    *r = *report;
+    atEngineCallback(prvIperfReportOut, r);
+}
+
+void atCmdHandleIPERF(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_SET)
+    {
+        // ^IPERF=<mode>[,<duration>[,<interval>[,<port>[,<host>[,<kbps>[,<length>]]]]]]
+        // ^IPERF=0 to stop
+        bool paramok = true;
+        netIperfConfig_t cfg = {};
+        unsigned mode = atParamUintInRange(cmd->params[0], 0, NET_IPERF_MONITOR, &paramok);
+        uint32_t duration = atParamDefUintInRange(cmd->params[1], 10, 0, 86400, &paramok);
+        uint32_t interval = atParamDefUintInRange(cmd->params[2], 1, 0, 3600, &paramok);
+        cfg.port = atParamDefUintInRange(cmd->params[3], NET_IPERF_PORT_DEFAULT, 1, 65535, &paramok);
+        const char *host = atParamDefStr(cmd->params[4], "", &paramok);
+        cfg.rate_kbps = atParamDefUintInRange(cmd->params[5], 1000, 1, 1000000, &paramok);
+        cfg.length = atParamDefUintInRange(cmd->params[6], 0, 0, NET_IPERF_LEN_MAX, &paramok);
+        if (!paramok || cmd->param_count > 7)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        if (mode == 0)
+        {
+            netIperfStop();
+            RETURN_OK(cmd->engine);
+        }
+
+        cfg.mode = (netIperfMode_t)mode;
+        cfg.duration_ms = duration * 1000;
+        cfg.interval_ms = interval * 1000;
+        if ((mode == NET_IPERF_TCP_CLIENT || mode == NET_IPERF_UDP_CLIENT) &&
+            ipaddr_aton(host, &cfg.remote) == 0)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        if (netIperfIsRunning())
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_OPERATION_NOT_ALLOWED);
+
+        gIperfEngine = cmd->engine;
+        if (!netIperfStart(&cfg, prvIperfReport, NULL))
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_EXE_FAIL);
+        RETURN_OK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_READ)
+    {
+        char rsp[32];
+        sprintf(rsp, "%s: %d", cmd->desc->name, netIperfIsRunning() ? 1 : 0);
+        atCmdRespInfoText(cmd->engine, rsp);
+        RETURN_OK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_TEST)
+    {
+        char rsp[96];
+        sprintf(rsp, "%s: (0-%d),(0-86400),(0-3600),(1-65535),<host>,(1-1000000),(0-%d)",
+                cmd->desc->name, NET_IPERF_MONITOR, NET_IPERF_LEN_MAX);
+        atCmdRespInfoText(cmd->engine, rsp);
+        RETURN_OK(cmd->engine);
+    }
+    else
+    {
+        RETURN_CME_ERR(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
+}
+
 #endif
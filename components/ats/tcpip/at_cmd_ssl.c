@@ -292,6 +292,11 @@ void AT_TCPIP_CmdFunc_SSLSTART(atCommand_t *pParam)
         //const char *mode = atParamStr(pParam->params[0], &paramok);
         char *host = (char *)atParamStr(pParam->params[0], &paramok);
         uPort = atParamUintInRange(pParam->params[1], 0, 65535, &paramok);
+        // optional max fragment length to negotiate, 0 to not negotiate
+        static const uint32_t frag_list[] = {0, 512, 1024, 2048, 4096};
+        uint32_t uFragLen = 4096;
+        if (pParam->param_count > 2)
+            uFragLen = atParamDefUintInList(pParam->params[2], 4096, frag_list, OSI_ARRAY_SIZE(frag_list), &paramok);
 
         if (!paramok)
             AT_CMD_RETURN(atCmdRespCmeError(pParam->engine, ERR_AT_CME_PARAM_INVALID));
@@ -400,6 +405,14 @@ void AT_TCPIP_CmdFunc_SSLSTART(atCommand_t *pParam)
             AT_CMD_RETURN(atCmdRespErrorText(pParam->engine, aucBuffer));
         }
 
+        iResult = mbedtlsSocket_Cfg(s_sslSocket, TLSSOCK_CFG_TYPE_MAX_FRAG_LEN, uFragLen);
+        if (iResult != 0)
+        {
+            sprintf(aucBuffer, "SSL CONNECT FAIL");
+            useEngine = NULL;
+            AT_CMD_RETURN(atCmdRespErrorText(pParam->engine, aucBuffer));
+        }
+
         mbedtlsSocket_SetSimCid(s_sslSocket, nSim, nCid);
         iResult = mbedtlsSocket_Connect(s_sslSocket, nAddr, uPort);
         if (iResult != 0)
@@ -417,7 +430,7 @@ void AT_TCPIP_CmdFunc_SSLSTART(atCommand_t *pParam)
             AT_CMD_RETURN(atCmdRespCmeError(pParam->engine, ERR_AT_CME_NO_MEMORY));
 
         memset(pRstStr, 0, 85);
-        strcpy(pRstStr, "+SSLSTART:(\"(0-255).(0-255).(0-255).(0-255)\"), (0-65535)");
+        strcpy(pRstStr, "+SSLSTART:(\"(0-255).(0-255).(0-255).(0-255)\"), (0-65535), (0,512,1024,2048,4096)");
 
         atCmdRespInfoText(pParam->engine, pRstStr);
         atCmdRespOK(pParam->engine);
@@ -70,12 +70,24 @@ typedef enum
     BEARER_MAX_NUM,
 } CIP_BEARER_T;
 
+#define RECV_BUF_UNIT_LEN 1024
+#define RECV_BUF_MAX_UNITS 32  // buffered data limit of each socket, the rest is left in socket
+#define RECV_BUF_POOL_UNITS 8  // free units kept for reuse
+
+typedef struct cmRecvUnit
+{
+    struct cmRecvUnit *next;
+    uint16_t start; // read offset
+    uint16_t end;   // write offset
+    uint8_t data[RECV_BUF_UNIT_LEN];
+} CM_RECV_UNIT_T;
+
 typedef struct
 {
-    uint8_t *recvBuf;
-    uint32_t readnum;
+    CM_RECV_UNIT_T *head;
+    CM_RECV_UNIT_T *tail;
     uint32_t recvBufLen;
-    uint32_t recvBufMaxSize;
+    uint32_t unitCount;
 } CM_RECV_BUF_T;
 
 typedef struct _stAT_Tcpip_Paras
@@ -251,18 +263,170 @@ void cipSettings_Init()
 #define cipDPDP_timer gCIPSettings.cipDPDP_timer         // 1 < timer <= 10
 #define cipSHOWTP_dispTP gCIPSettings.cipSHOWTP_dispTP   // 0: disabled 1: enabled
 
-#define RECV_BUF_UNIT_LEN 1024
+static CM_RECV_UNIT_T *gRecvUnitPool = NULL;
+static uint32_t gRecvUnitPoolCount = 0;
+
+static CM_RECV_UNIT_T *recvUnitAlloc(void)
+{
+    CM_RECV_UNIT_T *unit = gRecvUnitPool;
+    if (unit != NULL)
+    {
+        gRecvUnitPool = unit->next;
+        gRecvUnitPoolCount--;
+    }
+    else
+    {
+        unit = (CM_RECV_UNIT_T *)malloc(sizeof(CM_RECV_UNIT_T));
+        if (unit == NULL)
+            return NULL;
+    }
+    unit->next = NULL;
+    unit->start = 0;
+    unit->end = 0;
+    return unit;
+}
+
+static void recvUnitFree(CM_RECV_UNIT_T *unit)
+{
+    if (gRecvUnitPoolCount < RECV_BUF_POOL_UNITS)
+    {
+        unit->next = gRecvUnitPool;
+        gRecvUnitPool = unit;
+        gRecvUnitPoolCount++;
+    }
+    else
+    {
+        free(unit);
+    }
+}
+
+static uint32_t recvBufSpace(CM_RECV_BUF_T *rb)
+{
+    uint32_t space = (RECV_BUF_MAX_UNITS - rb->unitCount) * RECV_BUF_UNIT_LEN;
+    if (rb->tail != NULL)
+        space += RECV_BUF_UNIT_LEN - rb->tail->end;
+    return space;
+}
+
+// tail unit with free space, NULL when the limit is reached or out of memory
+static CM_RECV_UNIT_T *recvBufTail(CM_RECV_BUF_T *rb)
+{
+    if (rb->tail != NULL && rb->tail->end < RECV_BUF_UNIT_LEN)
+        return rb->tail;
+    if (rb->unitCount >= RECV_BUF_MAX_UNITS)
+        return NULL;
+
+    CM_RECV_UNIT_T *unit = recvUnitAlloc();
+    if (unit == NULL)
+        return NULL;
+    if (rb->tail == NULL)
+        rb->head = unit;
+    else
+        rb->tail->next = unit;
+    rb->tail = unit;
+    rb->unitCount++;
+    return unit;
+}
+
+static bool recvBufAppend(CM_RECV_BUF_T *rb, const uint8_t *data, uint32_t len)
+{
+    if (len > recvBufSpace(rb))
+        return false;
+
+    while (len > 0)
+    {
+        CM_RECV_UNIT_T *unit = recvBufTail(rb);
+        if (unit == NULL)
+            return false;
+        uint32_t n = min(len, (uint32_t)(RECV_BUF_UNIT_LEN - unit->end));
+        memcpy(unit->data + unit->end, data, n);
+        unit->end += n;
+        rb->recvBufLen += n;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Read from TCP socket directly into receive buffer. When the limit is
+// reached, the rest is left in socket, and TCP window will be closed
+// until host reads.
+static int recvBufFill(CM_RECV_BUF_T *rb, uint8_t uSocket)
+{
+    uint32_t avail = CFW_TcpipGetRecvAvailable(uSocket);
+    while (avail > 0)
+    {
+        CM_RECV_UNIT_T *unit = recvBufTail(rb);
+        if (unit == NULL)
+        {
+            OSI_LOGI(0, "recvBufFill, buffer full, %d left in socket %d", avail, uSocket);
+            break;
+        }
+        int n = CFW_TcpipSocketRecv(uSocket, unit->data + unit->end, min(avail, (uint32_t)(RECV_BUF_UNIT_LEN - unit->end)), 0);
+        if (n == SOCKET_ERROR)
+            return -1;
+        if (n == 0)
+            break;
+        unit->end += n;
+        rb->recvBufLen += n;
+        avail -= n;
+    }
+    return 0;
+}
+
+// contiguous data at head of receive buffer, 0 when empty
+static uint32_t recvBufPeek(CM_RECV_BUF_T *rb, const uint8_t **data)
+{
+    CM_RECV_UNIT_T *unit = rb->head;
+    if (unit == NULL)
+        return 0;
+    *data = unit->data + unit->start;
+    return unit->end - unit->start;
+}
+
+// drop data at head, \p len should be no more than recvBufPeek returned
+static void recvBufConsume(CM_RECV_BUF_T *rb, uint32_t len)
+{
+    CM_RECV_UNIT_T *unit = rb->head;
+    unit->start += len;
+    rb->recvBufLen -= len;
+    if (unit->start == unit->end)
+    {
+        rb->head = unit->next;
+        if (rb->head == NULL)
+            rb->tail = NULL;
+        rb->unitCount--;
+        recvUnitFree(unit);
+    }
+}
+
+static void recvBufClear(CM_RECV_BUF_T *rb)
+{
+    while (rb->head != NULL)
+    {
+        CM_RECV_UNIT_T *unit = rb->head;
+        rb->head = unit->next;
+        recvUnitFree(unit);
+    }
+    rb->tail = NULL;
+    rb->recvBufLen = 0;
+    rb->unitCount = 0;
+}
 
 // uint8_t g_uATTcpipValid;
 const char g_strATTcpipStatus[10][32] = {"IP INITIAL", "IP START", "IP CONFIG", "IP GPRSACT",
                                          "IP STATUS", "IP PROCESSING", "CONNECT OK", "IP CLOSING",
                                          "CLOSED", "IP PDPDEACT"};
 
+#define BYPASS_BUF_SIZE (32 * 1024) // uplink buffer of transparent mode, power of 2
+
 typedef struct
 {
-    uint8_t *buff;     // buffer, shared by all mode
-    uint32_t buffLen;  // existed buffer data byte count
+    uint8_t *buff;     // ring buffer, shared by all mode
+    uint32_t rd;       // read position, free running
+    uint32_t wr;       // write position, free running
     uint32_t buffSize; // buffer size
+    bool stalled;      // input is refused due to buffer full
     osiMutex_t *mutex;
 } BYPASS_BUFFER_T;
 
@@ -273,14 +437,16 @@ BYPASS_BUFFER_T *at_TCPIPBufCreate()
     BYPASS_BUFFER_T *bypass_buff = (BYPASS_BUFFER_T *)malloc(sizeof(*bypass_buff));
     if (bypass_buff == NULL)
         return NULL;
-    bypass_buff->buff = (uint8_t *)malloc(AT_CMD_LINE_BUFF_LEN);
+    bypass_buff->buff = (uint8_t *)malloc(BYPASS_BUF_SIZE);
     if (bypass_buff->buff == NULL)
     {
         free(bypass_buff);
         return NULL;
     }
-    bypass_buff->buffLen = 0;
-    bypass_buff->buffSize = AT_CMD_LINE_BUFF_LEN;
+    bypass_buff->rd = 0;
+    bypass_buff->wr = 0;
+    bypass_buff->buffSize = BYPASS_BUF_SIZE;
+    bypass_buff->stalled = false;
     bypass_buff->mutex = osiMutexCreate();
     return bypass_buff;
 }
@@ -309,6 +475,39 @@ void at_delayAsync(void *param)
 #endif
 
 static int sBypassDataSendAll = 0;
+
+// Send buffered data to socket directly from the ring buffer. Unless
+// \p all is true, the tail less than cipCCFG_SendSz is left for timer.
+static void bypassBufSend(atDispatch_t *dispatch, bool all)
+{
+    stAT_Tcpip_Paras *tcpipParas = &(g_uCipContexts.nTcpipParas[0]);
+    BYPASS_BUFFER_T *b = g_bypass_buf;
+    for (;;)
+    {
+        uint32_t len = b->wr - b->rd;
+        if (len == 0 || (!all && len < cipCCFG_SendSz))
+            break;
+
+        uint32_t offset = b->rd & (b->buffSize - 1);
+        uint32_t n = min(len, b->buffSize - offset);
+        n = min(n, (uint32_t)CIPSEND_MAXSIZE);
+        if (CFW_TcpipSocketSend(tcpipParas->uSocket, b->buff + offset, n, 0) == SOCKET_ERROR)
+        {
+            OSI_LOGI(0x10003f2c, "TCPIP send socket data error");
+        }
+        osiMutexLock(b->mutex);
+        b->rd += n;
+        osiMutexUnlock(b->mutex);
+    }
+
+    // input refused before can be accepted now
+    if (b->stalled && b->wr - b->rd < b->buffSize)
+    {
+        b->stalled = false;
+        atDispatchReadLater(dispatch);
+    }
+}
+
 void bypassDataSend(void *param)
 {
     atDispatch_t *dispatch = (atDispatch_t *)param;
@@ -323,76 +522,77 @@ void bypassDataSend(void *param)
         OSI_LOGI(0x10003f29, "bypassDataSend error,g_bypass_buf == null");
         goto restart;
     }
-    if (g_bypass_buf->buffLen < cipCCFG_SendSz && g_bypass_buf->buffLen != 0)
+    uint32_t buffLen = g_bypass_buf->wr - g_bypass_buf->rd;
+    if (buffLen < cipCCFG_SendSz && buffLen != 0)
     {
         sBypassDataSendAll++;
     }
-    if (g_bypass_buf->buffLen < cipCCFG_SendSz && sBypassDataSendAll < 2)
+    if (buffLen < cipCCFG_SendSz && sBypassDataSendAll < 2)
     {
-        OSI_LOGI(0x10003f2a, "bypassDataSend do nothing buffLen=%d", g_bypass_buf->buffLen);
+        OSI_LOGI(0x10003f2a, "bypassDataSend do nothing buffLen=%d", buffLen);
         goto restart;
     }
     else
     {
-        uint16_t sendLen = cipCCFG_SendSz > g_bypass_buf->buffLen ? g_bypass_buf->buffLen : cipCCFG_SendSz;
-        uint8_t *data = malloc(sendLen);
-        if (data == NULL)
-        {
-            OSI_LOGI(0x10003f2b, "bypassDataSend MALLOC FAILS cipCCFG_SendSz=%d", sendLen);
-            return;
-        }
-        memset(data, 0, sendLen);
-        memcpy(data, g_bypass_buf->buff, sendLen);
-        osiMutexLock(g_bypass_buf->mutex);
-        memmove(g_bypass_buf->buff, g_bypass_buf->buff + sendLen, g_bypass_buf->buffLen - sendLen);
-        g_bypass_buf->buffLen -= sendLen;
-        osiMutexUnlock(g_bypass_buf->mutex);
-        if (CFW_TcpipSocketSend(tcpipParas->uSocket, data, sendLen, 0) == SOCKET_ERROR)
-        {
-            OSI_LOGI(0x10003f2c, "TCPIP send socket data error");
-        }
-        free(data);
+        bypassBufSend(dispatch, true);
         sBypassDataSendAll = 0;
     }
 restart:
     osiTimerStart(tcpipParas->transpSendTimer, cipCCFG_WaitTm * 100);
 }
 
+// Input data are copied to ring buffer in bulk, and full packets are sent
+// at once rather than one packet at each timer. When the ring buffer is
+// full, the rest is not consumed, and AT device flow control will hold
+// the host until buffer space is available.
 static int _transparentBypassDataRecv(void *param, const void *data, size_t length)
 {
+    atCmdEngine_t *engine = (atCmdEngine_t *)param;
     OSI_LOGI(0x10003f2d, "bypassDataRecv,length=%d ", length);
     if (g_bypass_buf == NULL)
         g_bypass_buf = at_TCPIPBufCreate();
     if (g_bypass_buf == NULL)
         return 0;
-    osiMutexLock(g_bypass_buf->mutex);
-    uint8_t *data_u8 = (uint8_t *)data;
-    size_t length_input = length;
-    while (length > 0)
+
+    BYPASS_BUFFER_T *b = g_bypass_buf;
+    const uint8_t *data_u8 = (const uint8_t *)data;
+    size_t consumed = 0;
+    osiMutexLock(b->mutex);
+    while (consumed < length)
     {
-        uint8_t c = *data_u8++;
-        length--;
+        const uint8_t *s = data_u8 + consumed;
+        size_t n = length - consumed;
+        const uint8_t *bs = (const uint8_t *)memchr(s, CHAR_BACKSPACE, n);
 
         // Remove previous byte for BACKSPACE
-
-        if (c == CHAR_BACKSPACE)
+        if (bs == s)
         {
-            if (g_bypass_buf->buffLen > 0)
-                --g_bypass_buf->buffLen;
+            if (b->wr != b->rd)
+                b->wr--;
+            consumed++;
             continue;
         }
-        // Drop whole buffer at overflow, maybe caused by data error
-        // or buffer too small
-        if (g_bypass_buf->buffLen >= g_bypass_buf->buffSize)
-        {
-            OSI_LOGI(0x10003f2e, "bypassDataRecv bypass mode overflow, drop all");
-            g_bypass_buf->buffLen = 0;
-        }
-        g_bypass_buf->buff[g_bypass_buf->buffLen++] = c;
+        if (bs != NULL)
+            n = bs - s;
+
+        uint32_t space = b->buffSize - (b->wr - b->rd);
+        if (space == 0)
+            break;
+        n = min(n, space);
+
+        uint32_t offset = b->wr & (b->buffSize - 1);
+        uint32_t first = min(n, b->buffSize - offset);
+        memcpy(b->buff + offset, s, first);
+        memcpy(b->buff, s + first, n - first);
+        b->wr += n;
+        consumed += n;
     }
-    osiMutexUnlock(g_bypass_buf->mutex);
+    b->stalled = (consumed < length);
+    osiMutexUnlock(b->mutex);
 
-    return length_input;
+    if (b->wr - b->rd >= cipCCFG_SendSz)
+        bypassBufSend(atCmdGetDispatch(engine), false);
+    return consumed;
 }
 
 static uint8_t *i8tostring(uint8_t value)
@@ -708,6 +908,7 @@ static void _cipstartGprsActRsp(atCommand_t *cmd, const osiEvent_t *event)
                 stAT_Tcpip_Paras *tcpipParas = &(g_uCipContexts.nTcpipParas[i]);
                 if (tcpipParas->uConnectBearer == gCipBearer)
                 {
+                    recvBufClear(&tcpipParas->uRecvBuf);
                     memset(tcpipParas, 0, sizeof(stAT_Tcpip_Paras));
                 }
             }
@@ -936,24 +1137,139 @@ void writeInfoNText(atCmdEngine_t *engine, const char *text, unsigned length)
     }
 }
 
+// Data of one info text line can be output in pieces by writeInfoBegin,
+// writeInfoData and writeInfoEnd, without combining them in one buffer.
+static void writeInfoBegin(atCmdEngine_t *engine, const char *text, unsigned length)
+{
+    atDispatch_t *dispatch = atCmdGetDispatch(engine);
+    if (atDispatchIsDataMode(dispatch) && atDispatchGetDataEngine(dispatch) != NULL)
+    {
+        if (length > 0)
+            atDataWrite(atDispatchGetDataEngine(dispatch), text, length);
+    }
+    else
+    {
+        atCmdRespInfoNTextBegin(engine, text, length);
+    }
+}
+
+static void writeInfoData(atCmdEngine_t *engine, const uint8_t *data, unsigned length, bool hex)
+{
+    atDispatch_t *dispatch = atCmdGetDispatch(engine);
+    if (atDispatchIsDataMode(dispatch) && atDispatchGetDataEngine(dispatch) != NULL)
+    {
+        atDataEngine_t *dataEngine = atDispatchGetDataEngine(dispatch);
+        if (!hex)
+        {
+            atDataWrite(dataEngine, data, length);
+            return;
+        }
+
+        char hexText[256];
+        while (length > 0)
+        {
+            unsigned n = min(length, sizeof(hexText) / 2);
+            atDataWrite(dataEngine, hexText, atEncodeHex(hexText, data, n));
+            data += n;
+            length -= n;
+        }
+    }
+    else if (hex)
+    {
+        atCmdRespOutputHex(engine, data, length);
+    }
+    else
+    {
+        atCmdRespOutputNText(engine, (const char *)data, length);
+    }
+}
+
+static void writeInfoEnd(atCmdEngine_t *engine)
+{
+    atDispatch_t *dispatch = atCmdGetDispatch(engine);
+    if (!atDispatchIsDataMode(dispatch) || atDispatchGetDataEngine(dispatch) == NULL)
+        atCmdRespInfoNTextEnd(engine, "", 0);
+}
+
+// Output at most len bytes from receive buffer as one info text line,
+// directly from the buffer units.
+static uint32_t recvBufOutput(atCmdEngine_t *engine, CM_RECV_BUF_T *rb, uint32_t len,
+                              const char *head, unsigned headLen, bool hex)
+{
+    const uint8_t *data;
+    uint32_t total = 0;
+    if (len == 0 || rb->recvBufLen == 0)
+        return 0;
+
+    writeInfoBegin(engine, head, headLen);
+    while (total < len)
+    {
+        uint32_t n = recvBufPeek(rb, &data);
+        if (n == 0)
+            break;
+        n = min(n, len - total);
+        writeInfoData(engine, data, n, hex);
+        recvBufConsume(rb, n);
+        total += n;
+    }
+    writeInfoEnd(engine);
+    return total;
+}
+
+// Output TCP data in socket as one info text line, through a receive unit
+// rather than a buffer for the whole data.
+static int recvSocketOutput(atCmdEngine_t *engine, uint8_t uSocket, uint32_t len,
+                            const char *head, unsigned headLen)
+{
+    CM_RECV_UNIT_T *unit = recvUnitAlloc();
+    if (unit == NULL)
+        return -1;
+
+    uint32_t total = 0;
+    while (total < len)
+    {
+        int n = CFW_TcpipSocketRecv(uSocket, unit->data, min(len - total, (uint32_t)RECV_BUF_UNIT_LEN), 0);
+        if (n == SOCKET_ERROR && total == 0)
+        {
+            recvUnitFree(unit);
+            return -1;
+        }
+        if (n <= 0)
+            break;
+        if (total == 0)
+            writeInfoBegin(engine, head, headLen);
+        writeInfoData(engine, unit->data, n, false);
+        total += n;
+    }
+    if (total > 0)
+        writeInfoEnd(engine);
+    recvUnitFree(unit);
+    return total;
+}
+
 static int recv_data(uint8_t uSocket, uint32_t uDataSize, atCmdEngine_t *engine, uint8_t nMuxIndex, uint8_t mode)
 {
     int iResult = 0;
     uint16_t uIPHlen = 0;
-    char *pData = NULL;
+    uint8_t *pData = NULL;
+    char uaIPHead[40] = {
+        0,
+    };
     char uaRspStr[128] = {
         0,
     };
     stAT_Tcpip_Paras *tcpipParas = &(g_uCipContexts.nTcpipParas[nMuxIndex]);
-    pData = malloc(uDataSize + 25);
-    if (NULL == pData)
+    bool isUdp = (tcpipParas->uProtocol == CFW_TCPIP_IPPROTO_UDP);
+    if (mode == 0 && !isUdp)
     {
-        OSI_LOGI(0x10003f47, "EV_CFW_TCPIP_REV_DATA_IND, memory error");
-        //atCmdRespCmeError(engine, ERR_AT_CME_NO_MEMORY);
-        return -1;
+        // data may be read already by previous indication
+        uint32_t avail = CFW_TcpipGetRecvAvailable(uSocket);
+        if (avail == 0)
+            return 0;
+        if (uDataSize > avail)
+            uDataSize = avail;
     }
-    memset(pData, 0, uDataSize + 25);
-    if (mode == 0 && cipSRIP_showIPPort && (tcpipParas->uProtocol != CFW_TCPIP_IPPROTO_UDP))
+    if (mode == 0 && cipSRIP_showIPPort && !isUdp)
     {
         if (!cipMux_multiIp)
         {
@@ -974,119 +1290,98 @@ static int recv_data(uint8_t uSocket, uint32_t uDataSize, atCmdEngine_t *engine,
                 if (cipSHOWTP_dispTP)
                 {
                     char *tp = tcpipParas->uProtocol == CFW_TCPIP_IPPROTO_TCP ? "TCP" : "UDP";
-                    sprintf(pData, "+IPD,%ld,%s:", uDataSize, tp);
+                    sprintf(uaIPHead, "+IPD,%ld,%s:", uDataSize, tp);
                 }
                 else
                 {
-                    sprintf(pData, "+IPD,%ld:", uDataSize);
+                    sprintf(uaIPHead, "+IPD,%ld:", uDataSize);
                 }
-                uIPHlen = strlen(pData);
+                uIPHlen = strlen(uaIPHead);
             }
             else
             {
-                sprintf(pData, "+RECEIVE,%d,%ld:", nMuxIndex, uDataSize);
-                uIPHlen = strlen(pData);
+                sprintf(uaIPHead, "+RECEIVE,%d,%ld:", nMuxIndex, uDataSize);
+                uIPHlen = strlen(uaIPHead);
             }
         }
         union sockaddr_aligned from_addr = {
             0,
         };
-        if (mode <= 1)
+        // datagram can only be received as a whole, TCP data is output or
+        // buffered directly from socket
+        if (isUdp && (mode == 0 || mode == 1))
         {
             OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND,tcpipParas->uProtocol=%d ", tcpipParas->uProtocol);
-            if (tcpipParas->uProtocol != CFW_TCPIP_IPPROTO_UDP)
+            pData = (uint8_t *)malloc(uDataSize + 1);
+            if (NULL == pData)
+            {
+                OSI_LOGI(0x10003f47, "EV_CFW_TCPIP_REV_DATA_IND, memory error");
+                //atCmdRespCmeError(engine, ERR_AT_CME_NO_MEMORY);
+                return -1;
+            }
+            int fromLen = sizeof(from_addr); //union sockaddr_aligned addr;
+            int udp_total_len = 0;
+            int udp_want_len = uDataSize;
+            while (udp_total_len < uDataSize)
             {
-                iResult = CFW_TcpipSocketRecv(uSocket, (uint8_t *)(pData + uIPHlen), uDataSize, 0);
+                iResult = CFW_TcpipSocketRecvfrom(uSocket, pData + udp_total_len, udp_want_len, 0, (CFW_TCPIP_SOCKET_ADDR *)&from_addr, &fromLen);
+                OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, CFW_TcpipSocketRecvfrom eiResult %d udp_want_len %d", iResult, udp_want_len);
                 if (SOCKET_ERROR == iResult)
                 {
                     OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, CFW_TcpipSocketRecv error");
-                    //atCmdRespCmeError(engine, ERR_AT_CME_EXE_FAIL);
                     free(pData);
                     return -1;
                 }
+                if (0 == iResult)
+                    break;
+                udp_total_len += iResult;
+                udp_want_len -= iResult;
             }
-            else
+            iResult = udp_total_len;
+
+            if (cipSRIP_showIPPort)
             {
-                int fromLen = sizeof(from_addr); //union sockaddr_aligned addr;
-                int udp_total_len = 0;
-                int udp_want_len = uDataSize;
-                while (udp_total_len < uDataSize)
+                ip_addr_t from_addr_t;
+                u16_t from_port;
+                SOCKADDR_TO_IPADDR_PORT(((const struct sockaddr *)&from_addr), &from_addr_t, from_port);
+                if (!cipMux_multiIp)
                 {
-                    iResult = CFW_TcpipSocketRecvfrom(uSocket, (uint8_t *)(pData + uIPHlen + udp_total_len), udp_want_len, 0, (CFW_TCPIP_SOCKET_ADDR *)&from_addr, &fromLen);
-                    OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, CFW_TcpipSocketRecvfrom eiResult %d udp_want_len %d", iResult, udp_want_len);
-                    if (SOCKET_ERROR == iResult)
-                    {
-                        OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, CFW_TcpipSocketRecv error");
-                        free(pData);
-                        return -1;
-                    }
-                    if (0 == iResult)
-                        break;
-                    udp_total_len += iResult;
-                    udp_want_len -= iResult;
+                    sprintf(uaRspStr, "+RECV FROM:%s:%hu", ipaddr_ntoa(&from_addr_t), from_port);
                 }
-                iResult = udp_total_len;
-
-                if (cipSRIP_showIPPort)
+                else
                 {
-                    ip_addr_t from_addr_t;
-                    u16_t from_port;
-                    SOCKADDR_TO_IPADDR_PORT(((const struct sockaddr *)&from_addr), &from_addr_t, from_port);
-                    if (!cipMux_multiIp)
-                    {
-                        sprintf(uaRspStr, "+RECV FROM:%s:%hu", ipaddr_ntoa(&from_addr_t), from_port);
-                    }
-                    else
-                    {
-                        sprintf(uaRspStr, "+RECEIVE,%d,%ld,%s:%hu", nMuxIndex, uDataSize, ipaddr_ntoa(&from_addr_t), from_port);
-                    }
-                    writeInfoNText(engine, uaRspStr, strlen(uaRspStr));
+                    sprintf(uaRspStr, "+RECEIVE,%d,%ld,%s:%hu", nMuxIndex, uDataSize, ipaddr_ntoa(&from_addr_t), from_port);
                 }
+                writeInfoNText(engine, uaRspStr, strlen(uaRspStr));
             }
         }
         if (mode == 1)
         {
-            if (tcpipParas->uRecvBuf.recvBuf == NULL)
+            if (!isUdp)
             {
-                tcpipParas->uRecvBuf.recvBuf = malloc(RECV_BUF_UNIT_LEN);
-                if (tcpipParas->uRecvBuf.recvBuf == NULL)
+                if (recvBufFill(&tcpipParas->uRecvBuf, uSocket) < 0)
                 {
-                    OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, CFW_TcpipSocketRecv malloc error");
+                    OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, CFW_TcpipSocketRecv error");
                     return -1;
                 }
-                memset(tcpipParas->uRecvBuf.recvBuf, 0, RECV_BUF_UNIT_LEN);
-                tcpipParas->uRecvBuf.readnum = 0;
-                tcpipParas->uRecvBuf.recvBufLen = 0;
-                tcpipParas->uRecvBuf.recvBufMaxSize = RECV_BUF_UNIT_LEN;
             }
-            OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, udp cache mode tcpipParas->uRecvBuf.recvBufMaxSize=%d", tcpipParas->uRecvBuf.recvBufMaxSize);
-            if ((tcpipParas->uRecvBuf.readnum + tcpipParas->uRecvBuf.recvBufLen + iResult) <= tcpipParas->uRecvBuf.recvBufMaxSize)
+            else if (recvBufAppend(&tcpipParas->uRecvBuf, pData, iResult))
             {
-
-                memcpy(tcpipParas->uRecvBuf.recvBuf + tcpipParas->uRecvBuf.readnum + tcpipParas->uRecvBuf.recvBufLen, pData + uIPHlen, iResult);
-                tcpipParas->uRecvBuf.recvBufLen += iResult;
                 tcpipParas->from_addr = from_addr;
             }
             else
             {
-                uint8_t *recvBufndi = malloc(tcpipParas->uRecvBuf.recvBufLen + iResult);
-                if (recvBufndi == NULL)
-                {
-                    OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND,CFW_TcpipSocketRecv recvBufndi malloc error");
-                    return -1;
-                }
-                memcpy(recvBufndi, tcpipParas->uRecvBuf.recvBuf + tcpipParas->uRecvBuf.readnum, tcpipParas->uRecvBuf.recvBufLen);
-                memcpy(recvBufndi + tcpipParas->uRecvBuf.recvBufLen, pData + uIPHlen, iResult);
-                tcpipParas->from_addr = from_addr;
-                free(tcpipParas->uRecvBuf.recvBuf);
-                tcpipParas->uRecvBuf.recvBuf = recvBufndi;
-                tcpipParas->uRecvBuf.readnum = 0;
-                tcpipParas->uRecvBuf.recvBufMaxSize = tcpipParas->uRecvBuf.recvBufLen + iResult;
-                tcpipParas->uRecvBuf.recvBufLen = tcpipParas->uRecvBuf.recvBufMaxSize;
+                OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, receive buffer full, drop udp data %d", iResult);
             }
+            OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, buffered %d", tcpipParas->uRecvBuf.recvBufLen);
             //AT_Sprintf(uaRspStr, "+READ:%d,%d,%d", nMuxIndex,iResult,tcpipParas->uRecvBuf.recvBufLen);
             //at_CmdRespUrcText(engine, uaRspStr);
         }
+        if ((mode == 2 || mode == 3) && !isUdp)
+        {
+            // pick up data left in socket when buffer was full
+            recvBufFill(&tcpipParas->uRecvBuf, uSocket);
+        }
         if (mode == 2 || mode == 3)
         {
             char uaIpStr[30] = {
@@ -1112,115 +1407,39 @@ static int recv_data(uint8_t uSocket, uint32_t uDataSize, atCmdEngine_t *engine,
         if (mode == 0)
         {
             OSI_LOGI(0, "mode=%d", mode);
-            writeInfoNText(engine, pData, uIPHlen + iResult);
-        }
-        if (mode == 2)
-        {
-            int readlen = 0;
-            // writeInfoNText(engine, pData, uIPHlen + iResult);
-            if (tcpipParas->uRecvBuf.recvBuf != NULL)
+            if (isUdp)
             {
-                OSI_LOGI(0, "AT_CMIOT_TCPIP_CmdFunc_CMRD, len = %d,tcpipParas->uRecvBuf.recvBufLen=%d", uDataSize, tcpipParas->uRecvBuf.recvBufLen);
-                if (uDataSize < tcpipParas->uRecvBuf.recvBufLen)
-                {
-                    readlen = uDataSize;
-                }
-                else
-                {
-                    readlen = tcpipParas->uRecvBuf.recvBufLen;
-                }
-                writeInfoNText(engine, pData, uIPHlen);
-                writeInfoNText(engine, (const char *)(tcpipParas->uRecvBuf.recvBuf + tcpipParas->uRecvBuf.readnum), readlen);
-                tcpipParas->uRecvBuf.readnum += readlen;
-                tcpipParas->uRecvBuf.recvBufLen -= readlen;
-
-                if (tcpipParas->uRecvBuf.recvBufLen == 0)
-                {
-                    OSI_LOGI(0, "AT_CMIOT_TCPIP_CmdFunc_CMRD, len = %d,tcpipParas->uRecvBuf.recvBufLen=%d", readlen, tcpipParas->uRecvBuf.recvBufLen);
-                    free(tcpipParas->uRecvBuf.recvBuf);
-
-                    tcpipParas->uRecvBuf.recvBuf = NULL;
-                    tcpipParas->uRecvBuf.readnum = 0;
-                    //tcpipParas->uRecvBuf.recvBufLen = 0;
-                    tcpipParas->uRecvBuf.recvBufMaxSize = 0;
-                }
-                else
-                {
-                    OSI_LOGI(0, "AT_CMIOT_TCPIP_CmdFunc_CMRD, null");
-                }
-                //}
+                writeInfoBegin(engine, uaIPHead, uIPHlen);
+                writeInfoData(engine, pData, iResult, false);
+                writeInfoEnd(engine);
             }
-            else
+            else if (recvSocketOutput(engine, uSocket, uDataSize, uaIPHead, uIPHlen) < 0)
             {
-                OSI_LOGI(0, "recv_data,there is no data in buff");
-                //at_CmdRespOK(engine);
+                OSI_LOGI(0, "EV_CFW_TCPIP_REV_DATA_IND, CFW_TcpipSocketRecv error");
+                //atCmdRespCmeError(engine, ERR_AT_CME_EXE_FAIL);
+                return -1;
             }
         }
-        else if (mode == 3)
+        if (mode == 2 || mode == 3)
         {
-            int readlen = 0;
-            if (tcpipParas->uRecvBuf.recvBuf != NULL)
-            {
-                OSI_LOGI(0, "AT_CMIOT_TCPIP_CmdFunc_CMRD, len = %d,tcpipParas->uRecvBuf.recvBufLen=%d", uDataSize, tcpipParas->uRecvBuf.recvBufLen);
-                if (uDataSize < tcpipParas->uRecvBuf.recvBufLen)
-                {
-                    readlen = uDataSize;
-                }
-                else
-                {
-                    readlen = tcpipParas->uRecvBuf.recvBufLen;
-                }
-                //if (uDataSize < tcpipParas->uRecvBuf.recvBufLen){
-                char *pHexData = malloc(2 * readlen + 25);
-                if (pHexData == NULL)
-                {
-                    OSI_LOGI(0, "recv_data malloc fails for hex data");
-                    //atCmdRespCmeError(engine, ERR_AT_CME_EXE_FAIL);
-                    free(pData);
-                    return -1;
-                }
-                memset(pHexData, 0, 2 * readlen + 25);
-                memcpy(pHexData, pData, uIPHlen);
-                for (int i = 0; i < readlen; i++)
-                {
-                    uint8_t tmp[3] = {0};
-                    sprintf((char *)tmp, "%02x", (tcpipParas->uRecvBuf.recvBuf + tcpipParas->uRecvBuf.readnum)[i]);
-                    strcat(pHexData, (char *)tmp);
-                }
-                writeInfoNText(engine, (const char *)pHexData, uIPHlen + 2 * readlen);
-                free(pHexData);
-                tcpipParas->uRecvBuf.readnum += readlen;
-                tcpipParas->uRecvBuf.recvBufLen -= readlen;
-                //at_CmdRespOK(engine);
-
-                if (tcpipParas->uRecvBuf.recvBufLen == 0)
-                {
-                    OSI_LOGI(0, "AT_CMIOT_TCPIP_CmdFunc_CMRD, len = %d,tcpipParas->uRecvBuf.recvBufLen=%d", uDataSize, tcpipParas->uRecvBuf.recvBufLen);
-                    if (tcpipParas->uRecvBuf.recvBuf)
-                    {
-                        free(tcpipParas->uRecvBuf.recvBuf);
-
-                        tcpipParas->uRecvBuf.recvBuf = NULL;
-                    }
-                    tcpipParas->uRecvBuf.readnum = 0;
-
-                    tcpipParas->uRecvBuf.recvBufMaxSize = 0;
-                }
-                else
-                {
-                    OSI_LOGI(0, "AT_CMIOT_TCPIP_CmdFunc_CMRD,there have data left");
-                }
-            }
-            else
+            OSI_LOGI(0, "AT_CMIOT_TCPIP_CmdFunc_CMRD, len = %d,tcpipParas->uRecvBuf.recvBufLen=%d", uDataSize, tcpipParas->uRecvBuf.recvBufLen);
+            // mode 3 is hex, encoded while output
+            if (recvBufOutput(engine, &tcpipParas->uRecvBuf, uDataSize, uaIPHead, uIPHlen, mode == 3) == 0)
             {
                 OSI_LOGI(0, "recv_data,there is no data in buff");
                 //at_CmdRespOK(engine);
             }
         }
+        if ((mode == 2 || mode == 3) && !isUdp)
+        {
+            // space is freed, reopen TCP window
+            recvBufFill(&tcpipParas->uRecvBuf, uSocket);
+        }
     }
     else
     {
-        //iResult = CFW_TcpipGetRecvAvailable(uSocket);
+        if (!isUdp)
+            recvBufFill(&tcpipParas->uRecvBuf, uSocket);
         if (!cipMux_multiIp)
         {
             sprintf(uaRspStr, "+CIPRXGET:%d,%ld", mode, tcpipParas->uRecvBuf.recvBufLen);
@@ -1371,13 +1590,9 @@ static void tcpip_rsp(void *param)
     case EV_CFW_TCPIP_SOCKET_CLOSE_RSP:
     {
         OSI_LOGI(0x10003f4d, "RECEIVED EV_CFW_TCPIP_SOCKET_CLOSE_RSP ...");
-        if (0xff != nMuxIndex && tcpipParas->uRecvBuf.recvBuf != NULL)
+        if (0xff != nMuxIndex)
         {
-            free(tcpipParas->uRecvBuf.recvBuf);
-            tcpipParas->uRecvBuf.recvBuf = NULL;
-            tcpipParas->uRecvBuf.readnum = 0;
-            tcpipParas->uRecvBuf.recvBufLen = 0;
-            tcpipParas->uRecvBuf.recvBufMaxSize = 0;
+            recvBufClear(&tcpipParas->uRecvBuf);
         }
         if (0xff != nMuxIndex && tcpipParas->autoSendTimer != NULL)
         {
@@ -1563,6 +1778,7 @@ void AT_TCPIP_CmdFunc_CIPMUX(atCommand_t *cmd)
             {
                 for (int i = 0; i < MEMP_NUM_NETCONN; i++)
                 {
+                    recvBufClear(&g_uCipContexts.nTcpipParas[i].uRecvBuf);
                     memset(&(g_uCipContexts.nTcpipParas[i]), 0, sizeof(stAT_Tcpip_Paras));
                 }
                 if ((mode == 1) && (cipMODE_transParent == 1))
@@ -67,6 +67,7 @@ void atCmdHandleWifiClose(atCommand_t *cmd)
             return;
         }
 
+        drvWifiScanMgrStop();
         drvWifiClose(gDrvWifi);
         gDrvWifi = NULL;
         atCmdRespOK(cmd->engine);
@@ -173,6 +174,7 @@ void atCmdHandleWifiScan(atCommand_t *cmd)
 
     if (r)
     {
+        drvWifiScanMgrUpdate(req.aps, req.found);
         qsort(&req.aps[0], req.found, sizeof(wifiApInfo_t), prvWifiApInfoCompare);
         char resp[64];
         for (uint32_t i = 0; i < req.found; ++i)
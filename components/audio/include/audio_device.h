@@ -429,6 +429,34 @@ bool audevStartVoice(void);
  */
 bool audevStopVoice(void);
 
+/**
+ * \brief prepare voice for incoming call
+ *
+ * It is called at incoming ring, to save the time to start voice at
+ * answer. Audio clock is requested, and voice configuration is loaded
+ * into CP. Voice stream isn't started, so the codec is silent. Then
+ * \p audevStartVoice will only start the stream, unless the settings
+ * are changed or other users are started before it.
+ *
+ * Prepare is cancelled by \p audevStartVoice, \p audevStopVoice,
+ * \p audevCancelPrepareVoice, or timeout. It can be called again to
+ * restart the timeout.
+ *
+ * \param timeout  timeout in milliseconds, 0 for no timeout
+ * \return
+ *      - true on success, or voice is already started
+ *      - false on failed, or other users are working
+ */
+bool audevPrepareVoice(unsigned timeout);
+
+/**
+ * \brief cancel voice prepare for incoming call
+ *
+ * It is called when the incoming call is rejected or released before
+ * answer. It does nothing when voice isn't prepared.
+ */
+void audevCancelPrepareVoice(void);
+
 /**
  * \brief restart voice call
  *
@@ -536,6 +564,86 @@ bool audevStartPlayV2(audevPlayType_t type, const audevPlayOps_t *play_ops, void
  */
 bool audevStopPlay(void);
 
+/**
+ * \brief low latency PCM output configuration
+ *
+ * In low latency mode, PCM data are written by client directly into the
+ * input buffer shared with audio DSP, by \p audevPlayWriteReserve and
+ * \p audevPlayWriteCommit. The queued data in input buffer is limited by
+ * \p buffer_ms, rather than the whole input buffer.
+ */
+typedef struct
+{
+    /**
+     * output period, the half size of output ping-pong buffer, in
+     * milliseconds. The default output path is 20ms.
+     */
+    unsigned period_ms;
+    /**
+     * maximum queued time in input buffer, in milliseconds
+     */
+    unsigned buffer_ms;
+    /**
+     * \p refill will be called when queued time is less than it, in
+     * milliseconds
+     */
+    unsigned watermark_ms;
+    /**
+     * \brief refill callback
+     *
+     * It is called in audio device work queue, after audio DSP consumed
+     * data. \p audevPlayWriteReserve and \p audevPlayWriteCommit can be
+     * called inside, or the callee can notify other thread to write.
+     *
+     * \param param     \p param in this configuration
+     * \param space     byte count can be written till \p buffer_ms
+     */
+    void (*refill)(void *param, unsigned space);
+    /**
+     * refill callback context
+     */
+    void *param;
+} audevPlayLowLatencyConfig_t;
+
+/**
+ * \brief start low latency PCM output
+ *
+ * Only stream information in \p frame will be used. It is only supported
+ * for local play, and it should be stopped by \p audevStopPlay.
+ *
+ * \param frame         audio frame, only stream information will be used
+ * \param cfg           low latency configuration
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, or failed
+ */
+bool audevStartPlayLowLatency(const auFrame_t *frame, const audevPlayLowLatencyConfig_t *cfg);
+
+/**
+ * \brief reserve space in input buffer for low latency PCM output
+ *
+ * The returned space is contiguous in input buffer, and is aligned to
+ * sample frame. When the space wraps around at the end of input buffer,
+ * the returned size is the part before the end, and the remaining can be
+ * reserved after commit.
+ *
+ * \param size          output reserved byte count
+ * \return
+ *      - the pointer to be written by client
+ *      - NULL if no space, or not in low latency PCM output
+ */
+void *audevPlayWriteReserve(unsigned *size);
+
+/**
+ * \brief commit data written into the reserved space
+ *
+ * \param size          written byte count, not larger than reserved
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, or not in low latency PCM output
+ */
+bool audevPlayWriteCommit(unsigned size);
+
 /**
  * \brief sustainable time of audio output buffer
  *
@@ -0,0 +1,113 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _AUDIO_METRICS_H_
+#define _AUDIO_METRICS_H_
+
+#include "osi_compiler.h"
+#include "audio_types.h"
+
+OSI_EXTERN_C_BEGIN
+
+/**
+ * Audio path metrics
+ *
+ * Counters and histograms of audio path are collected always, and can
+ * be read out by \p auMetricsGet, or printed by \p auMetricsDump. They
+ * are cumulative until \p auMetricsReset.
+ *
+ * Histogram buckets are power of 2. Bucket 0 counts value 0, and bucket
+ * n counts value in [2^(n-1), 2^n). The last bucket counts all larger
+ * values.
+ */
+
+/**
+ * \brief bucket count of histogram
+ */
+#define AUMETRICS_HIST_BUCKETS (16)
+
+/**
+ * \brief decoder count in metrics, indexed by \p auStreamFormat_t
+ */
+#define AUMETRICS_DECODER_COUNT (AUSTREAM_FORMAT_SBC + 1)
+
+/**
+ * \brief histogram
+ */
+typedef struct
+{
+    unsigned count;                          ///< sample count
+    unsigned min;                            ///< minimum value
+    unsigned max;                            ///< maximum value
+    uint64_t sum;                            ///< sum of values
+    unsigned bucket[AUMETRICS_HIST_BUCKETS]; ///< power of 2 buckets
+} auMetricsHist_t;
+
+/**
+ * \brief audio path metrics
+ */
+typedef struct
+{
+    unsigned play_requests;       ///< ZSP play data requests
+    unsigned play_underruns;      ///< play requests with empty input buffer
+    auMetricsHist_t play_fill;    ///< input buffer bytes at ZSP play request
+    auMetricsHist_t play_latency; ///< us from PCM into input buffer to DAC
+    unsigned rec_requests;        ///< ZSP record data requests
+    unsigned rec_overruns;        ///< record requests with full buffer
+    unsigned rec_drops;           ///< record frames rejected by recorder
+    auMetricsHist_t rec_fill;     ///< buffer bytes at ZSP record request
+    unsigned voice_starts;            ///< voice call starts
+    unsigned voice_prepared_starts;   ///< voice call starts with config loaded at ring
+    unsigned voice_prepare_timeouts;  ///< voice prepares neither answered nor released
+    auMetricsHist_t voice_prepare_us; ///< us to load voice config at ring
+    auMetricsHist_t voice_setup_us;   ///< us from voice start request to voice running
+    /** decode time of each frame in us, indexed by \p auStreamFormat_t */
+    auMetricsHist_t decode_us[AUMETRICS_DECODER_COUNT];
+} auMetrics_t;
+
+/**
+ * \brief add a value to histogram
+ *
+ * \param h         histogram
+ * \param val       value
+ */
+void auMetricsHistAdd(auMetricsHist_t *h, unsigned val);
+
+/**
+ * \brief get the global audio metrics instance
+ *
+ * It is for audio modules to update metrics. Readers should use
+ * \p auMetricsGet for consistent snapshot.
+ *
+ * \return  global audio metrics
+ */
+auMetrics_t *auMetricsInstance(void);
+
+/**
+ * \brief get a snapshot of audio metrics
+ *
+ * \param m         output metrics
+ */
+void auMetricsGet(auMetrics_t *m);
+
+/**
+ * \brief reset audio metrics
+ */
+void auMetricsReset(void);
+
+/**
+ * \brief print audio metrics to log
+ */
+void auMetricsDump(void);
+
+OSI_EXTERN_C_END
+#endif
@@ -0,0 +1,161 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _AUDIO_MIXER_H_
+#define _AUDIO_MIXER_H_
+
+#include "audio_types.h"
+#include "audio_device.h"
+
+OSI_EXTERN_C_BEGIN
+
+/**
+ * Software audio mixer
+ *
+ * Audio device has only one play stream. Audio mixer owns the play
+ * stream, and mixes multiple input streams into it. So, a prompt or
+ * tone can be played over music without stopping the music pipeline.
+ *
+ * Input streams use the same \p audevPlayOps_t as audio device, and the
+ * sources for \p audevStartPlay can be attached to audio mixer without
+ * change. Each input stream has its own sample rate and channel count,
+ * and it will be converted to output format by linear interpolation.
+ *
+ * Samples are mixed in blocks of 10ms, with saturation.
+ *
+ * The output play stream is started at the first input stream, and
+ * stopped after the last input stream is stopped or finished.
+ */
+
+/**
+ * \brief unity gain of audio mixer, gain is in Q15
+ */
+#define AUMIXER_GAIN_UNITY (0x8000)
+
+/**
+ * \brief role of input stream
+ *
+ * Role decides ducking. When there are active streams with higher role,
+ * streams with lower role will be ducked according to ducking policy.
+ */
+typedef enum
+{
+    AUMIXER_ROLE_MUSIC,  ///< music, long term background playback
+    AUMIXER_ROLE_PROMPT, ///< prompt, such as TTS
+    AUMIXER_ROLE_ALERT,  ///< alert, such as notification tone
+    AUMIXER_ROLE_COUNT,
+} auMixerRole_t;
+
+/**
+ * \brief ducking policy
+ */
+typedef enum
+{
+    AUMIXER_DUCK_NONE,      ///< mix without ducking
+    AUMIXER_DUCK_ATTENUATE, ///< lower role streams are attenuated
+    AUMIXER_DUCK_PAUSE,     ///< lower role streams are paused, not pulled
+} auMixerDuckPolicy_t;
+
+/**
+ * \brief ducking configuration
+ */
+typedef struct
+{
+    auMixerDuckPolicy_t policy; ///< ducking policy
+    unsigned duck_gain;         ///< gain of ducked streams for attenuate, in Q15
+    unsigned ramp_ms;           ///< time of gain change from 0 to unity, in ms
+} auMixerDuckConfig_t;
+
+/**
+ * \brief opaque data structure of audio mixer input stream
+ */
+typedef struct auMixerStream auMixerStream_t;
+
+/**
+ * \brief initialize audio mixer
+ *
+ * It should be called once after \p audevInit.
+ */
+void auMixerInit(void);
+
+/**
+ * \brief set output format of audio mixer
+ *
+ * When \p sample_rate is 0, the output format will follow the first
+ * input stream. Otherwise, the output format is fixed. The setting will
+ * take effect at the next start of output play stream.
+ *
+ * \param sample_rate   output sample rate, 0 for following input
+ * \param channel_count output channel count, 1 or 2
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool auMixerSetOutputFormat(unsigned sample_rate, unsigned channel_count);
+
+/**
+ * \brief set ducking configuration
+ *
+ * The default policy is \p AUMIXER_DUCK_ATTENUATE, with gain of -12dB
+ * and ramp of 100ms. The setting will take effect at the next block.
+ *
+ * \param cfg           ducking configuration
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool auMixerSetDuckConfig(const auMixerDuckConfig_t *cfg);
+
+/**
+ * \brief start an input stream
+ *
+ * \p play_ops and \p play_ctx are the same as \p audevStartPlay, and
+ * \p frame provides sample rate and channel count of the input stream.
+ * \p get_frame and \p data_consumed are called in audio device thread.
+ *
+ * \p AUDEV_PLAY_EVENT_FINISH will be sent by \p handle_event after the
+ * last samples of the input stream are mixed. After that, the input
+ * stream is detached from mixer, and it should still be deleted by
+ * \p auMixerStreamStop.
+ *
+ * \param role          role of the input stream
+ * \param play_ops      input operations
+ * \param play_ctx      input operations context
+ * \param frame         audio frame for sample rate and channel count
+ * \return
+ *      - input stream instance
+ *      - NULL on invalid parameter, out of memory or fail to start output
+ */
+auMixerStream_t *auMixerStreamStart(auMixerRole_t role, const audevPlayOps_t *play_ops,
+                                    void *play_ctx, const auFrame_t *frame);
+
+/**
+ * \brief stop and delete an input stream
+ *
+ * It is permitted to call this in \p handle_event of the input stream.
+ *
+ * \param s             input stream instance
+ */
+void auMixerStreamStop(auMixerStream_t *s);
+
+/**
+ * \brief set gain of an input stream
+ *
+ * Gain change will be ramped.
+ *
+ * \param s             input stream instance
+ * \param gain          gain in Q15, [0, AUMIXER_GAIN_UNITY]
+ */
+void auMixerStreamSetGain(auMixerStream_t *s, unsigned gain);
+
+OSI_EXTERN_C_END
+#endif
@@ -0,0 +1,186 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _AUDIO_PLAYLIST_H_
+#define _AUDIO_PLAYLIST_H_
+
+#include "osi_compiler.h"
+#include "audio_types.h"
+#include "audio_decoder.h"
+
+OSI_EXTERN_C_BEGIN
+
+/**
+ * Gapless playlist
+ *
+ * Audio playlist plays a queue of items (file, memory or reader) one
+ * after another. When an item starts to play, the next item is opened
+ * and the first frame is decoded in background. So, at the end of an
+ * item, the next item continues without gap.
+ *
+ * When the sample format of the next item is the same as the current,
+ * the play stream of audio device is continued. Otherwise, the play
+ * stream is restarted after the current item is drained, with the new
+ * sample format. The next item is already decoded at that time.
+ *
+ * Items can be added during playback.
+ */
+
+/**
+ * \brief forward declaration
+ */
+struct auReader;
+
+/**
+ * \brief audio playlist event
+ */
+typedef enum
+{
+    /**
+     * An item is decoded completely, and deleted. Its last samples are
+     * still to be played by audio device.
+     */
+    AUPLAYLIST_EVENT_ITEM_FINISHED = 1,
+    /**
+     * All items are played, and play stream of audio device is stopped.
+     */
+    AUPLAYLIST_EVENT_FINISHED,
+} auPlaylistEvent_t;
+
+/**
+ * \brief opaque data structure of audio playlist
+ */
+typedef struct auPlaylist auPlaylist_t;
+
+/**
+ * \brief audio playlist callback prototype
+ *
+ * The callback will be invoked in audio thread or system work queue.
+ * <em>Don't call audio playlist APIs inside the callback.</em>
+ *
+ * \param param         audio playlist callback context
+ * \param event         audio playlist event
+ */
+typedef void (*auPlaylistEventCallback_t)(void *param, auPlaylistEvent_t event);
+
+/**
+ * \brief create an audio playlist
+ *
+ * \return
+ *      - audio playlist
+ *      - NULL if out of memory
+ */
+auPlaylist_t *auPlaylistCreate(void);
+
+/**
+ * \brief delete the audio playlist
+ *
+ * Playback will be stopped, and all items are deleted.
+ *
+ * \param d             audio playlist
+ */
+void auPlaylistDelete(auPlaylist_t *d);
+
+/**
+ * \brief set audio playlist event callback
+ *
+ * \param d             audio playlist
+ * \param cb            event callback
+ * \param cb_ctx        event callback context
+ */
+void auPlaylistSetEventCallback(auPlaylist_t *d, auPlaylistEventCallback_t cb, void *cb_ctx);
+
+/**
+ * \brief add a file item to the end of playlist
+ *
+ * \p pcm is the sample format of \p AUSTREAM_FORMAT_PCM stream, and it
+ * will be set to decoder by \p AU_DEC_PARAM_FORMAT. It is ignored for
+ * other stream formats.
+ *
+ * \param d             audio playlist
+ * \param format        stream format
+ * \param pcm           sample format of raw PCM, can be NULL
+ * \param fname         file name
+ * \return
+ *      - true on success
+ *      - false on invalid parameter or out of memory
+ */
+bool auPlaylistAddFile(auPlaylist_t *d, auStreamFormat_t format, const auFrame_t *pcm, const char *fname);
+
+/**
+ * \brief add a memory item to the end of playlist
+ *
+ * The memory should be valid until the item is finished.
+ *
+ * \param d             audio playlist
+ * \param format        stream format
+ * \param pcm           sample format of raw PCM, can be NULL
+ * \param buf           memory to be played
+ * \param size          memory size
+ * \return
+ *      - true on success
+ *      - false on invalid parameter or out of memory
+ */
+bool auPlaylistAddMem(auPlaylist_t *d, auStreamFormat_t format, const auFrame_t *pcm,
+                      const void *buf, unsigned size);
+
+/**
+ * \brief add an external audio reader item to the end of playlist
+ *
+ * Playlist will just use \p reader, and the life-cycle should be handled
+ * externally. It should be valid until the item is finished.
+ *
+ * \param d             audio playlist
+ * \param format        stream format
+ * \param pcm           sample format of raw PCM, can be NULL
+ * \param reader        audio stream reader
+ * \return
+ *      - true on success
+ *      - false on invalid parameter or out of memory
+ */
+bool auPlaylistAddReader(auPlaylist_t *d, auStreamFormat_t format, const auFrame_t *pcm,
+                         struct auReader *reader);
+
+/**
+ * \brief start playback of audio playlist
+ *
+ * The first item is opened and decoded before the play stream of audio
+ * device is started.
+ *
+ * It will return true if it is already started.
+ *
+ * \param d             audio playlist
+ * \return
+ *      - true on success
+ *      - false on empty playlist, or fail to start audio device
+ */
+bool auPlaylistStart(auPlaylist_t *d);
+
+/**
+ * \brief stop playback of audio playlist
+ *
+ * All items, including the playing item, are deleted.
+ *
+ * \param d             audio playlist
+ */
+void auPlaylistStop(auPlaylist_t *d);
+
+/**
+ * \brief item count in audio playlist, including the playing item
+ *
+ * \param d             audio playlist
+ * \return  item count
+ */
+unsigned auPlaylistCount(auPlaylist_t *d);
+
+OSI_EXTERN_C_END
+#endif
@@ -148,6 +148,10 @@ typedef struct auFileReader auFileReader_t;
 /**
  * \brief create a file based audio reader
  *
+ * When \p CONFIG_AUDIO_FILE_READER_PREFETCH_SIZE is defined, the reader
+ * is created with prefetch of this size. Refer to
+ * \p auFileReaderCreateWithPrefetch.
+ *
  * \param fname     file name
  * \return
  *      - the created audio reader
@@ -155,6 +159,45 @@ typedef struct auFileReader auFileReader_t;
  */
 auFileReader_t *auFileReaderCreate(const char *fname);
 
+/**
+ * \brief create a file based audio reader with prefetch
+ *
+ * File data are read ahead into a ring buffer of \p size bytes by a
+ * background work, and read and seek are served from the ring buffer.
+ * So, the caller won't be blocked by slow storage, such as sdcard with
+ * write in flight, as long as the ring buffer isn't drained.
+ *
+ * Refill is triggered when the free space is larger than the refill
+ * size. The refill size grows with the largest read size, such as the
+ * size of \p auReadBufFetch, up to half of the ring buffer. So, one
+ * fetch can always be served by data already in the ring buffer.
+ *
+ * Data already read are kept in the ring buffer until overwritten by
+ * refill, and short backward seek won't cause read from file.
+ *
+ * When \p size is 0, it is the same as file reader without prefetch.
+ *
+ * \param fname     file name
+ * \param size      ring buffer size
+ * \return
+ *      - the created audio reader
+ *      - NULL if invalid parameter, or out of memory
+ */
+auFileReader_t *auFileReaderCreateWithPrefetch(const char *fname, unsigned size);
+
+/**
+ * \brief set wait timeout for audio file reader with prefetch
+ *
+ * When the ring buffer is drained, read will wait for refill. By default,
+ * it will wait until the requested data are read, just as reading file.
+ * When \p timeout is 0, read will return the available data without wait,
+ * and \p auReaderIsEof can tell whether it is end of file.
+ *
+ * \param d         the audio file reader
+ * \param timeout   wait timeout
+ */
+void auFileReaderSetWait(auFileReader_t *d, unsigned timeout);
+
 /**
  * \brief opaque data structure of meory based audio reader
  */
@@ -0,0 +1,163 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _AUDIO_REC_PIPELINE_H_
+#define _AUDIO_REC_PIPELINE_H_
+
+#include "osi_compiler.h"
+#include "audio_types.h"
+#include "audio_encoder.h"
+
+OSI_EXTERN_C_BEGIN
+
+/**
+ * Recording pipeline to file
+ *
+ * Recording is split into 3 stages, and each stage is decoupled by
+ * buffer:
+ * - capture: in audio thread, PCM from audio device is copied into a
+ *   ring buffer. It never blocks. When the ring buffer is full, the
+ *   whole audio frame is dropped and counted.
+ * - encode: in a dedicated work queue, PCM in the ring buffer is encoded.
+ * - output: encoded data are collected into output blocks, and full
+ *   blocks are written by \p vfs_aio_write in file write work queue.
+ *   Encode will wait when all output blocks are in writing.
+ *
+ * So, a stall of file system is absorbed by output blocks and the PCM
+ * ring buffer. When it is too long, the dropped PCM is whole audio
+ * frames, and the encoded file is still valid.
+ */
+
+/**
+ * \brief audio recording pipeline configuration
+ *
+ * Zero fields will use the default values.
+ */
+typedef struct
+{
+    unsigned ring_size;   ///< PCM ring buffer size, default 64KB
+    unsigned block_size;  ///< output block size, default 4KB
+    unsigned block_count; ///< output block count, default 4
+} auRecPipelineConfig_t;
+
+/**
+ * \brief audio recording pipeline statistics
+ */
+typedef struct
+{
+    unsigned captured_bytes;  ///< PCM bytes put into ring buffer
+    unsigned dropped_bytes;   ///< PCM bytes dropped for ring buffer full
+    unsigned dropped_frames;  ///< audio frames dropped for ring buffer full
+    unsigned ring_peak_bytes; ///< peak PCM bytes in ring buffer
+    unsigned encoded_bytes;   ///< encoded bytes from encoder
+    unsigned written_bytes;   ///< bytes written to file
+    unsigned write_stalls;    ///< encode waited for free output block
+    bool write_error;         ///< file write failed
+} auRecPipelineStat_t;
+
+/**
+ * \brief audio recording pipeline event
+ */
+typedef enum
+{
+    /**
+     * Recording is finished by audio device, or file write failed.
+     * \p auRecPipelineStop should be called.
+     */
+    AURECPIPE_EVENT_FINISHED = 1,
+} auRecPipelineEvent_t;
+
+/**
+ * \brief audio recording pipeline callback prototype
+ *
+ * The callback will be invoked in audio thread or file write work queue.
+ * <em>Don't call audio recording pipeline APIs inside the callback.</em>
+ *
+ * \param param         callback context
+ * \param event         event
+ */
+typedef void (*auRecPipelineEventCallback_t)(void *param, auRecPipelineEvent_t event);
+
+/**
+ * \brief opaque data structure of audio recording pipeline
+ */
+typedef struct auRecPipeline auRecPipeline_t;
+
+/**
+ * \brief create an audio recording pipeline
+ *
+ * \param cfg           configuration, NULL for default
+ * \return
+ *      - audio recording pipeline
+ *      - NULL if out of memory
+ */
+auRecPipeline_t *auRecPipelineCreate(const auRecPipelineConfig_t *cfg);
+
+/**
+ * \brief delete the audio recording pipeline
+ *
+ * Recording will be stopped if it is started.
+ *
+ * \param d             audio recording pipeline
+ */
+void auRecPipelineDelete(auRecPipeline_t *d);
+
+/**
+ * \brief set event callback
+ *
+ * \param d             audio recording pipeline
+ * \param cb            event callback
+ * \param cb_ctx        event callback context
+ */
+void auRecPipelineSetEventCallback(auRecPipeline_t *d, auRecPipelineEventCallback_t cb, void *cb_ctx);
+
+/**
+ * \brief start recording to file
+ *
+ * When \p fname exists, it will be truncated.
+ *
+ * \param d             audio recording pipeline
+ * \param type          audio recording type
+ * \param format        stream format, such as AMR-NB, AMR-WB or WAV
+ * \param params        encoder parameters, can be NULL
+ * \param fname         file name
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, file or encoder error, or fail to
+ *        start audio device
+ */
+bool auRecPipelineStartFile(auRecPipeline_t *d, audevRecordType_t type, auStreamFormat_t format,
+                            const auEncoderParamSet_t *params, const char *fname);
+
+/**
+ * \brief stop recording
+ *
+ * PCM already captured will be encoded, and all data are written to
+ * file before return.
+ *
+ * \param d             audio recording pipeline
+ * \return
+ *      - true on success
+ *      - false on file write error
+ */
+bool auRecPipelineStop(auRecPipeline_t *d);
+
+/**
+ * \brief get statistics of the current or last recording
+ *
+ * \param d             audio recording pipeline
+ * \param stat          statistics output
+ */
+void auRecPipelineGetStat(auRecPipeline_t *d, auRecPipelineStat_t *stat);
+
+OSI_EXTERN_C_END
+#endif
@@ -113,6 +113,10 @@ typedef struct auFileWriter auFileWriter_t;
  * When \p fname doesn't exist, it will be created. When \p fname exists,
  * the file will be truncated to zero length.
  *
+ * File write is performed in file write work queue, by double buffered
+ * \p vfs_aio_stream_t. So, the caller won't be blocked by slow file
+ * system. Seek will wait buffered data written.
+ *
  * \param fname     file name
  * \return
  *      - the created audio writer
@@ -11,6 +11,7 @@
  */
 
 #include "audio_device.h"
+#include "audio_metrics.h"
 #include "audio_player.h"
 #include "audio_recorder.h"
 #include "osi_api.h"
@@ -212,6 +213,11 @@ typedef struct
         unsigned total_bytes;
         audevPlayOps_t ops;
         void *ops_ctx;
+        bool lowlat_en;             // low latency mode, client writes audInPara directly
+        unsigned lowlat_limit;      // maximum queued bytes in audInPara
+        unsigned lowlat_watermark;  // refill when queued bytes below it
+        unsigned lowlat_reserved;   // reserved bytes by client, not committed
+        audevPlayLowLatencyConfig_t lowlat;
         AUD_LEVEL_T level;
         osiElapsedTimer_t time;
     } play;
@@ -231,6 +237,17 @@ typedef struct
         audevOutput_t outdev;
     } bbat;
 
+    struct
+    {
+        bool prepared;            // audio clock requested before answer
+        bool cfg_valid;           // voice config loaded by prepare is still in CP
+        audevSetting_t cfg;       // settings of the loaded voice config
+        bool uplink_mute;         // uplink mute of the loaded voice config
+        SND_BT_WORK_MODE_T btworkmode;
+        osiWork_t *timeout_work;
+        osiTimer_t *timeout_timer;
+    } voice_prep;
+
     struct
     {
         audevOutput_t outdev;
@@ -332,19 +349,43 @@ static inline bool prvIsInputValid(audevInput_t dev)
 }
 
 /**
- * Enable (request) audio clock
+ * Request audio clock from hal
  */
-static inline void prvEnableAudioClk(audevClkUser_t user)
+static inline void prvRequestAudioClk(void)
 {
-    audevContext_t *d = &gAudevCtx;
-    if (d->clk_users == 0)
-    {
 #ifdef CONFIG_CAMA_CLK_FOR_AUDIO
-        halCameraClockRequest(CLK_CAMA_USER_AUDIO, CAMA_CLK_OUT_FREQ_26M);
+    halCameraClockRequest(CLK_CAMA_USER_AUDIO, CAMA_CLK_OUT_FREQ_26M);
 #else
-        halClock26MRequest(CLK_26M_USER_AUDIO);
+    halClock26MRequest(CLK_26M_USER_AUDIO);
 #endif
-    }
+}
+
+/**
+ * Release audio clock to hal
+ */
+static inline void prvReleaseAudioClk(void)
+{
+#ifdef CONFIG_CAMA_CLK_FOR_AUDIO
+    halCameraClockRelease(CLK_CAMA_USER_AUDIO);
+#else
+    halClock26MRelease(CLK_26M_USER_AUDIO);
+#endif
+}
+
+/**
+ * Enable (request) audio clock
+ *
+ * Voice prepare holds the clock without being a user. Other users except
+ * tone will load their own configuration, and the prepared voice config
+ * is invalid after that.
+ */
+static inline void prvEnableAudioClk(audevClkUser_t user)
+{
+    audevContext_t *d = &gAudevCtx;
+    if (d->clk_users == 0 && !d->voice_prep.prepared)
+        prvRequestAudioClk();
+    if (user != AUDEV_CLK_USER_VOICE && user != AUDEV_CLK_USER_TONE)
+        d->voice_prep.cfg_valid = false;
     d->clk_users |= user;
 }
 
@@ -355,14 +396,8 @@ static inline void prvDisableAudioClk(audevClkUser_t user)
 {
     audevContext_t *d = &gAudevCtx;
     d->clk_users &= ~user;
-    if (d->clk_users == 0)
-    {
-#ifdef CONFIG_CAMA_CLK_FOR_AUDIO
-        halCameraClockRelease(CLK_CAMA_USER_AUDIO);
-#else
-        halClock26MRelease(CLK_26M_USER_AUDIO);
-#endif
-    }
+    if (d->clk_users == 0 && !d->voice_prep.prepared)
+        prvReleaseAudioClk();
 }
 
 /**
@@ -471,6 +506,56 @@ static bool prvSetVoiceConfig(void)
     return true;
 }
 
+/**
+ * Whether voice config loaded by prepare matches current settings
+ */
+static bool prvVoicePrepareCfgMatch(void)
+{
+    audevContext_t *d = &gAudevCtx;
+    const audevSetting_t *cfg = &d->voice_prep.cfg;
+
+    return d->voice_prep.cfg_valid &&
+           cfg->indev == d->cfg.indev &&
+           cfg->outdev == d->cfg.outdev &&
+           cfg->voice_vol == d->cfg.voice_vol &&
+           cfg->out_mute == d->cfg.out_mute &&
+           d->voice_prep.uplink_mute == d->voice_uplink_mute &&
+           d->voice_prep.btworkmode == d->btworkmode;
+}
+
+/**
+ * Leave voice prepare state, and release the clock held by it
+ */
+static void prvVoicePrepareCancelLocked(void)
+{
+    audevContext_t *d = &gAudevCtx;
+
+    osiTimerStop(d->voice_prep.timeout_timer);
+    if (!d->voice_prep.prepared)
+        return;
+
+    d->voice_prep.prepared = false;
+    if (d->clk_users == 0)
+        prvReleaseAudioClk();
+}
+
+/**
+ * Voice prepare timeout, the call is neither answered nor released
+ */
+static void prvVoicePrepareTimeoutWork(void *param)
+{
+    audevContext_t *d = &gAudevCtx;
+
+    osiMutexLock(d->lock);
+    if (d->voice_prep.prepared && !osiTimerIsRunning(d->voice_prep.timeout_timer))
+    {
+        OSI_LOGI(0, "audio voice prepare timeout");
+        auMetricsInstance()->voice_prepare_timeouts++;
+        prvVoicePrepareCancelLocked();
+    }
+    osiMutexUnlock(d->lock);
+}
+
 /**
  * Set configuration for play
  */
@@ -734,6 +819,48 @@ OSI_UNUSED static unsigned prvAudioPocInGet(AUD_ZSP_SHAREMEM_T *p, void *buf, un
     return size;
 }
 
+/**
+ * Estimated time from audInPara to DAC of new data, in us
+ */
+static unsigned prvPlayLatencyUs(unsigned queued_bytes)
+{
+    audevContext_t *d = &gAudevCtx;
+    unsigned byte_rate = d->play.sample_rate * d->play.channel_count * sizeof(int16_t);
+    if (byte_rate == 0)
+        return 0;
+
+    return (uint64_t)(queued_bytes + AUDEV_PLAY_HIDDEN_BUF_SIZE) * 1000000 / byte_rate;
+}
+
+/**
+ * Update metrics at ZSP play request
+ */
+static void prvPlayMetricsLocked(void)
+{
+    audevContext_t *d = &gAudevCtx;
+    auMetrics_t *m = auMetricsInstance();
+
+    unsigned bytes = prvAudioInBytes(d->shmem);
+    m->play_requests++;
+    auMetricsHistAdd(&m->play_fill, bytes);
+    if (bytes == 0 && !d->play.eos_error)
+        m->play_underruns++;
+}
+
+/**
+ * Update metrics at ZSP record request
+ */
+static void prvRecMetricsLocked(void)
+{
+    audevContext_t *d = &gAudevCtx;
+    auMetrics_t *m = auMetricsInstance();
+
+    m->rec_requests++;
+    auMetricsHistAdd(&m->rec_fill, prvAudioInBytes(d->shmem));
+    if (prvAudioInIsFull(d->shmem))
+        m->rec_overruns++;
+}
+
 /**
  * Get audio frame from player, and put yto audInPara.
  */
@@ -762,8 +889,11 @@ static bool prvPlayGetFramesLocked(void)
             if ((frame.bytes == 0) && ((frame.flags & AUFRAME_FLAG_END) == 0))
                 return true;
 
+            unsigned queued = prvAudioInBytes(d->shmem);
             unsigned bytes = prvAudioInPut(d->shmem, (void *)frame.data, frame.bytes);
             d->play.ops.data_consumed(d->play.ops_ctx, bytes);
+            if (bytes > 0)
+                auMetricsHistAdd(&auMetricsInstance()->play_latency, prvPlayLatencyUs(queued));
 
             d->play.total_bytes += bytes;
             if (frame.flags & AUFRAME_FLAG_END)
@@ -772,7 +902,7 @@ static bool prvPlayGetFramesLocked(void)
                 d->shmem->audInPara.fileEndFlag = 1;
             }
 
-            OSI_LOGI(0, "audio play space/%d frame/%d put/%d total/%d flags/%d", space,
+            OSI_LOGV(0, "audio play space/%d frame/%d put/%d total/%d flags/%d", space,
                      frame.bytes, bytes, d->play.total_bytes, frame.flags);
         }
 
@@ -781,12 +911,27 @@ static bool prvPlayGetFramesLocked(void)
             unsigned bytes = prvAudioInBytes(d->shmem);
             unsigned ms = auFrameByteToTime(&frame, bytes + AUDEV_PLAY_HIDDEN_BUF_SIZE);
             osiTimerStart(d->finish_timer, ms);
+            OSI_LOGI(0, "audio play eos, total/%d remain/%d ms", d->play.total_bytes, ms);
         }
     }
 
     return true;
 }
 
+/**
+ * Low latency play, call client to refill audInPara when below watermark.
+ */
+static void prvPlayRefillLocked(void)
+{
+    audevContext_t *d = &gAudevCtx;
+
+    unsigned bytes = prvAudioInBytes(d->shmem);
+    if (bytes >= d->play.lowlat_watermark)
+        return;
+
+    d->play.lowlat.refill(d->play.lowlat.param, d->play.lowlat_limit - bytes);
+}
+
 /**
  * Get from audInPara, and send the data to recorder.
  */
@@ -807,7 +952,11 @@ static void prvRecPutFramesLocked(void)
 
         // We shouldn't break even put_frame failed, to avoid overflow
         // just send finsh event to notify recorder app to stop
-        if (!d->record.enc_error)
+        if (d->record.enc_error)
+        {
+            auMetricsInstance()->rec_drops++;
+        }
+        else
         {
             d->record.enc_error = !d->record.ops.put_frame(d->record.ops_ctx, &d->record.frame);
             if (d->record.enc_error)
@@ -832,11 +981,18 @@ static void prvIpcWork(void *param)
 
     if (d->clk_users & AUDEV_CLK_USER_PLAY)
     {
-        prvPlayGetFramesLocked();
+        prvPlayMetricsLocked();
+        if (d->play.lowlat_en)
+            prvPlayRefillLocked();
+        else
+            prvPlayGetFramesLocked();
         prvSetPlayConfig();
     }
     if (d->clk_users & AUDEV_CLK_USER_RECORD)
+    {
+        prvRecMetricsLocked();
         prvRecPutFramesLocked();
+    }
 
     if (d->clk_users & AUDEV_CLK_USER_POC)
     {
@@ -1738,6 +1894,8 @@ void audevInit(void)
     d->simu_toneend_timer = osiTimerCreate(OSI_TIMER_IN_SERVICE, prvToneStopEndTimeout, NULL);
     d->cptoneend_sema = osiSemaphoreCreate(1, 0);
     d->cpstatus_sema = osiSemaphoreCreate(1, 0);
+    d->voice_prep.timeout_work = osiWorkCreate(prvVoicePrepareTimeoutWork, NULL, NULL);
+    d->voice_prep.timeout_timer = osiTimerCreateWork(d->voice_prep.timeout_work, d->wq);
 #ifdef CONFIG_AUDIO_EXT_I2S_ENABLE
     d->i2s_play_work = osiWorkCreate(prvExtI2sOutputWork, NULL, NULL);
     d->i2s_record_work = osiWorkCreate(prvExtI2sInputWork, NULL, NULL);
@@ -1750,6 +1908,8 @@ void audevInit(void)
     d->voice_uplink_mute = false;
     d->btworkmode = SND_BT_WORK_MODE_NO;
     d->clk_users = 0;
+    d->voice_prep.prepared = false;
+    d->voice_prep.cfg_valid = false;
     d->record.frame.data = (uintptr_t)d->record.buf;
     ipc_register_audio_notify(prvIpcNotify);
     prvSetDeviceExt();
@@ -2306,6 +2466,8 @@ bool audevStartVoice(void)
     audevContext_t *d = &gAudevCtx;
     OSI_LOGI(0, "audio start voice, user/0x%x", d->clk_users);
 
+    osiElapsedTimer_t time;
+    osiElapsedTimerStart(&time);
     osiMutexLock(d->lock);
 
     if ((d->clk_users & ~AUDEV_CLK_USER_VOICE) != 0) // disable when any other users is working
@@ -2314,8 +2476,11 @@ bool audevStartVoice(void)
     if (d->clk_users & AUDEV_CLK_USER_VOICE)
         goto success;
 
+    // voice config loaded at ring can be reused, only the stream is started
+    bool prepared = d->voice_prep.prepared && prvVoicePrepareCfgMatch();
     prvEnableAudioClk(AUDEV_CLK_USER_VOICE);
-    if (!prvSetVoiceConfig())
+    prvVoicePrepareCancelLocked();
+    if (!prepared && !prvSetVoiceConfig())
         goto failed_disable_clk;
 
     if (DM_StartAudioEx() != 0)
@@ -2324,6 +2489,14 @@ bool audevStartVoice(void)
     if (!prvWaitStatus(CODEC_VOIS_START_DONE))
         goto failed_disable_clk;
 
+    auMetrics_t *m = auMetricsInstance();
+    unsigned setup_us = osiElapsedTimeUS(&time);
+    m->voice_starts++;
+    if (prepared)
+        m->voice_prepared_starts++;
+    auMetricsHistAdd(&m->voice_setup_us, setup_us);
+    OSI_LOGI(0, "audio start voice, prepared/%d setup/%dus", prepared, setup_us);
+
 success:
     osiMutexUnlock(d->lock);
     return true;
@@ -2346,6 +2519,7 @@ bool audevStopVoice(void)
 
     osiMutexLock(d->lock);
 
+    prvVoicePrepareCancelLocked();
     if ((d->clk_users & AUDEV_CLK_USER_VOICE) == 0)
         goto success;
 
@@ -2367,6 +2541,75 @@ failed:
     return false;
 }
 
+/**
+ * Prepare voice call at incoming ring
+ */
+bool audevPrepareVoice(unsigned timeout)
+{
+    audevContext_t *d = &gAudevCtx;
+    OSI_LOGI(0, "audio prepare voice, timeout/%d user/0x%x", timeout, d->clk_users);
+
+    osiMutexLock(d->lock);
+
+    if (d->clk_users & AUDEV_CLK_USER_VOICE) // call waiting, voice is running
+        goto success;
+
+    if ((d->clk_users & ~AUDEV_CLK_USER_TONE) != 0) // disable when any other users is working
+        goto failed;
+
+    if (!d->voice_prep.prepared)
+    {
+        if (d->clk_users == 0)
+            prvRequestAudioClk();
+        d->voice_prep.prepared = true;
+    }
+
+    if (!prvVoicePrepareCfgMatch())
+    {
+        osiElapsedTimer_t time;
+        osiElapsedTimerStart(&time);
+        if (!prvSetVoiceConfig())
+        {
+            d->voice_prep.cfg_valid = false;
+            prvVoicePrepareCancelLocked();
+            goto failed;
+        }
+
+        d->voice_prep.cfg = d->cfg;
+        d->voice_prep.uplink_mute = d->voice_uplink_mute;
+        d->voice_prep.btworkmode = d->btworkmode;
+        d->voice_prep.cfg_valid = true;
+        auMetricsHistAdd(&auMetricsInstance()->voice_prepare_us, osiElapsedTimeUS(&time));
+    }
+
+    if (timeout != 0)
+        osiTimerStart(d->voice_prep.timeout_timer, timeout);
+    else
+        osiTimerStop(d->voice_prep.timeout_timer);
+
+success:
+    osiMutexUnlock(d->lock);
+    return true;
+
+failed:
+    osiMutexUnlock(d->lock);
+    OSI_LOGE(0, "audio prepare voice failed");
+    return false;
+}
+
+/**
+ * Cancel voice call prepare
+ */
+void audevCancelPrepareVoice(void)
+{
+    audevContext_t *d = &gAudevCtx;
+    OSI_LOGI(0, "audio cancel prepare voice, prepared/%d", d->voice_prep.prepared);
+
+    osiMutexLock(d->lock);
+    prvVoicePrepareCancelLocked();
+    osiMutexUnlock(d->lock);
+}
+
 /**
  * Restart voice call
  */
@@ -2766,14 +3009,13 @@ bool audevPocModeSwitch(uint8_t mode)
 }
 
 /**
- * Start play
+ * Start play, \p lowlat is only for local play, and \p play_ops is
+ * ignored in low latency mode.
  */
-bool audevStartPlayV2(audevPlayType_t type, const audevPlayOps_t *play_ops, void *play_ctx,
-                      const auFrame_t *frame)
+static bool prvStartPlay(audevPlayType_t type, const audevPlayOps_t *play_ops, void *play_ctx,
+                         const auFrame_t *frame, const audevPlayLowLatencyConfig_t *lowlat)
 {
     audevContext_t *d = &gAudevCtx;
-    if (play_ops == NULL || play_ops->get_frame == NULL || play_ops->data_consumed == NULL)
-        return false;
     if (frame == NULL)
         return false;
 
@@ -2792,6 +3034,9 @@ bool audevStartPlayV2(audevPlayType_t type, const audevPlayOps_t *play_ops, void
         return false;
 
     osiMutexLock(d->lock);
+    if (lowlat != NULL && type != AUDEV_PLAY_TYPE_LOCAL)
+        goto failed;
+
     d->play.type = type;
     if (type == AUDEV_PLAY_TYPE_LOCAL)
     {
@@ -2802,18 +3047,40 @@ bool audevStartPlayV2(audevPlayType_t type, const audevPlayOps_t *play_ops, void
         d->play.sample_rate = frame->sample_rate;
         d->play.total_bytes = 0;
         d->play.eos_error = false;
-        d->play.ops = *play_ops;
-        d->play.ops_ctx = play_ctx;
+        d->play.lowlat_en = false;
+        if (lowlat != NULL)
+        {
+            unsigned frame_bytes = frame->channel_count * sizeof(int16_t);
+            unsigned bytes_per_ms = frame_bytes * frame->sample_rate / 1000;
+            unsigned limit = OSI_ALIGN_DOWN(bytes_per_ms * lowlat->buffer_ms, frame_bytes);
+
+            // audInPara can't be full filled
+            d->play.lowlat_limit = OSI_MIN(unsigned, limit, AUDIO_INPUT_BUF_SIZE - 4 - frame_bytes);
+            d->play.lowlat_watermark = OSI_MIN(unsigned, bytes_per_ms * lowlat->watermark_ms,
+                                               d->play.lowlat_limit);
+            d->play.lowlat_reserved = 0;
+            d->play.lowlat = *lowlat;
+            d->play.lowlat_en = true;
+            memset(&d->play.ops, 0, sizeof(d->play.ops));
+            d->play.ops_ctx = NULL;
+        }
+        else
+        {
+            d->play.ops = *play_ops;
+            d->play.ops_ctx = play_ctx;
+        }
 
-        // 1. half buffer size is determined by channel count and sample rate, for 20ms
+        // 1. half buffer size is determined by channel count and sample rate, for 20ms,
+        //    or the period of low latency mode
         // 2. half buffer size should be 32 bytes aligned
         // 3. 2x half buffer can't exceed AUDIO_OUTPUT_BUF_SIZE
         // 4. set a minimal value, based on 8000Hz mono
         // 5. the unit of audOutPara.length is word (2 bytes)
-        unsigned half_buffer_bytes = (frame->channel_count * frame->sample_rate * 2 / 50);
+        unsigned period_ms = (lowlat != NULL) ? lowlat->period_ms : 20;
+        unsigned half_buffer_bytes = (frame->channel_count * frame->sample_rate * 2 * period_ms / 1000);
         half_buffer_bytes = OSI_ALIGN_UP(half_buffer_bytes, 32);
         half_buffer_bytes = OSI_MIN(unsigned, AUDIO_OUTPUT_BUF_SIZE / 2, half_buffer_bytes);
-        half_buffer_bytes = OSI_MAX(unsigned, 320, half_buffer_bytes);
+        half_buffer_bytes = OSI_MAX(unsigned, OSI_ALIGN_UP(8000 * 2 * period_ms / 1000, 32), half_buffer_bytes);
         unsigned half_buffer_words = half_buffer_bytes / 2;
 
         HAL_AIF_STREAM_T stream = {
@@ -3021,11 +3288,24 @@ failed_disable_clk:
 #endif
     prvDisableAudioClk(AUDEV_CLK_USER_PLAY);
 failed:
+    d->play.lowlat_en = false;
     osiMutexUnlock(d->lock);
     OSI_LOGE(0, "audio start play failed");
     return false;
 }
 
+/**
+ * Start play
+ */
+bool audevStartPlayV2(audevPlayType_t type, const audevPlayOps_t *play_ops, void *play_ctx,
+                      const auFrame_t *frame)
+{
+    if (play_ops == NULL || play_ops->get_frame == NULL || play_ops->data_consumed == NULL)
+        return false;
+
+    return prvStartPlay(type, play_ops, play_ctx, frame, NULL);
+}
+
 /**
  * Start play
  */
@@ -3101,6 +3381,7 @@ bool audevStopPlayV2(void)
     }
 
 success:
+    d->play.lowlat_en = false;
     osiMutexUnlock(d->lock);
     return true;
 
@@ -3118,6 +3399,97 @@ bool audevStopPlay(void)
     return (audevStopPlayV2());
 }
 
+/**
+ * Start low latency play
+ */
+bool audevStartPlayLowLatency(const auFrame_t *frame, const audevPlayLowLatencyConfig_t *cfg)
+{
+    if (cfg == NULL || cfg->refill == NULL)
+        return false;
+    if (cfg->period_ms < 5 || cfg->period_ms > 20)
+        return false;
+    if (cfg->buffer_ms < cfg->period_ms || cfg->watermark_ms > cfg->buffer_ms)
+        return false;
+
+#ifdef CONFIG_AUDIO_EXT_I2S_ENABLE
+    // external I2S output has its own buffering
+    if (gAudevCtx.cfg.ext_i2s_en)
+        return false;
+#endif
+
+    OSI_LOGI(0, "audio start low latency play, period/%d buffer/%d watermark/%d",
+             cfg->period_ms, cfg->buffer_ms, cfg->watermark_ms);
+    return prvStartPlay(AUDEV_PLAY_TYPE_LOCAL, NULL, NULL, frame, cfg);
+}
+
+/**
+ * Reserve space in audInPara for low latency play
+ */
+void *audevPlayWriteReserve(unsigned *size)
+{
+    audevContext_t *d = &gAudevCtx;
+    if (size == NULL)
+        return NULL;
+
+    osiMutexLock(d->lock);
+    *size = 0;
+    if (!d->play.lowlat_en || (d->clk_users & AUDEV_CLK_USER_PLAY) == 0)
+    {
+        osiMutexUnlock(d->lock);
+        return NULL;
+    }
+
+    AUD_ZSP_SHAREMEM_T *p = d->shmem;
+    uint16_t readOffset = *(volatile uint16_t *)&p->audInPara.readOffset;
+    uint16_t writeOffset = *(volatile uint16_t *)&p->audInPara.writeOffset;
+    uint16_t inLenth = *(volatile uint16_t *)&p->audInPara.inLenth;
+    OSI_BARRIER();
+
+    unsigned bytes = AUDIOIN_BYTES;
+    unsigned space = AUDIOIN_SPACE;
+    unsigned frame_bytes = d->play.channel_count * sizeof(int16_t);
+    unsigned avail = (bytes >= d->play.lowlat_limit) ? 0 : d->play.lowlat_limit - bytes;
+    avail = OSI_MIN(unsigned, avail, space);
+    avail = OSI_MIN(unsigned, avail, inLenth - writeOffset);
+    avail = OSI_ALIGN_DOWN(avail, frame_bytes);
+
+    d->play.lowlat_reserved = avail;
+    *size = avail;
+    void *ptr = (avail == 0) ? NULL : (char *)&p->audInput[0] + writeOffset;
+    osiMutexUnlock(d->lock);
+    return ptr;
+}
+
+/**
+ * Commit written data in audInPara for low latency play
+ */
+bool audevPlayWriteCommit(unsigned size)
+{
+    audevContext_t *d = &gAudevCtx;
+
+    osiMutexLock(d->lock);
+    if (!d->play.lowlat_en || size > d->play.lowlat_reserved)
+    {
+        osiMutexUnlock(d->lock);
+        return false;
+    }
+
+    AUD_ZSP_SHAREMEM_T *p = d->shmem;
+    if (size > 0)
+        auMetricsHistAdd(&auMetricsInstance()->play_latency, prvPlayLatencyUs(prvAudioInBytes(p)));
+
+    uint16_t writeOffset = *(volatile uint16_t *)&p->audInPara.writeOffset;
+    uint16_t inLenth = *(volatile uint16_t *)&p->audInPara.inLenth;
+
+    // data shall be visible before write offset
+    OSI_BARRIER();
+    *(volatile uint16_t *)&p->audInPara.writeOffset = (writeOffset + size) % inLenth;
+    d->play.lowlat_reserved = 0;
+    d->play.total_bytes += size;
+    osiMutexUnlock(d->lock);
+    return true;
+}
+
 /**
  * Start record
  */
@@ -12,8 +12,29 @@
 
 #include "audio_decoder.h"
 #include "audio_reader.h"
+#include "audio_metrics.h"
+#include "osi_api.h"
 #include "osi_log.h"
 
+typedef int (*auDecoderDecodeFn_t)(struct auDecoder *d, auFrame_t *frame);
+
+// decode function of each stream format, to find format in decode metrics
+static auDecoderDecodeFn_t gAuDecoderDecodeFn[AUMETRICS_DECODER_COUNT];
+
+/**
+ * Find stream format by decode function. Decoders are prebuilt, and
+ * there is no room to store stream format in decoder.
+ */
+static unsigned prvDecoderFormat(auDecoder_t *d)
+{
+    for (unsigned n = 1; n < AUMETRICS_DECODER_COUNT; n++)
+    {
+        if (gAuDecoderDecodeFn[n] == d->ops.decode)
+            return n;
+    }
+    return AUSTREAM_FORMAT_UNKNOWN;
+}
+
 void auDecoderDelete(auDecoder_t *d)
 {
     if (d != NULL && d->ops.destroy != NULL)
@@ -22,9 +43,14 @@ void auDecoderDelete(auDecoder_t *d)
 
 int auDecoderDecode(auDecoder_t *d, auFrame_t *frame)
 {
-    if (d != NULL && d->ops.decode != NULL)
-        return d->ops.decode(d, frame);
-    return -1;
+    if (d == NULL || d->ops.decode == NULL)
+        return -1;
+
+    int64_t start = osiUpTimeUS();
+    int res = d->ops.decode(d, frame);
+    unsigned us = osiUpTimeUS() - start;
+    auMetricsHistAdd(&auMetricsInstance()->decode_us[prvDecoderFormat(d)], us);
+    return res;
 }
 
 bool auDecoderSeek(auDecoder_t *d, unsigned ms)
@@ -64,36 +90,47 @@ bool auDecoderGetParam(auDecoder_t *d, int param_id, void *val)
 
 auDecoder_t *auDecoderCreate(auReader_t *r, auStreamFormat_t format)
 {
+    auDecoder_t *d = NULL;
     switch (format)
     {
     case AUSTREAM_FORMAT_PCM:
-        return (auDecoder_t *)auPcmDecoderCreate(r);
+        d = (auDecoder_t *)auPcmDecoderCreate(r);
+        break;
 
     case AUSTREAM_FORMAT_WAVPCM:
-        return (auDecoder_t *)auWavDecoderCreate(r);
+        d = (auDecoder_t *)auWavDecoderCreate(r);
+        break;
 
 #ifdef CONFIG_AUDIO_MP3_DEC_ENABLE
     case AUSTREAM_FORMAT_MP3:
-        return (auDecoder_t *)auMp3DecoderCreate(r);
+        d = (auDecoder_t *)auMp3DecoderCreate(r);
+        break;
 #endif
 
 #ifdef CONFIG_AUDIO_AMRNB_DEC_ENABLE
     case AUSTREAM_FORMAT_AMRNB:
-        return (auDecoder_t *)auAmrnbDecoderCreate(r);
+        d = (auDecoder_t *)auAmrnbDecoderCreate(r);
+        break;
 #endif
 
 #ifdef CONFIG_AUDIO_AMRWB_DEC_ENABLE
     case AUSTREAM_FORMAT_AMRWB:
-        return (auDecoder_t *)auAmrwbDecoderCreate(r);
+        d = (auDecoder_t *)auAmrwbDecoderCreate(r);
+        break;
 #endif
 
 #ifdef CONFIG_AUDIO_SBC_DEC_ENABLE
     case AUSTREAM_FORMAT_SBC:
-        return (auDecoder_t *)auSbcDecoderCreate(r);
+        d = (auDecoder_t *)auSbcDecoderCreate(r);
+        break;
 #endif
 
     default:
         OSI_LOGE(0, "audio decoder unknown fotmat/%d", format);
         return NULL;
     }
+
+    if (d != NULL)
+        gAuDecoderDecodeFn[format] = d->ops.decode;
+    return d;
 }
@@ -0,0 +1,109 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "audio_metrics.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <string.h>
+
+static auMetrics_t gAuMetrics;
+
+/**
+ * Power of 2 bucket index of value
+ */
+static inline unsigned prvHistBucket(unsigned val)
+{
+    if (val == 0)
+        return 0;
+
+    unsigned n = 32 - __builtin_clz(val);
+    return OSI_MIN(unsigned, n, AUMETRICS_HIST_BUCKETS - 1);
+}
+
+static void prvHistDump(const char *name, const auMetricsHist_t *h)
+{
+    if (h->count == 0)
+        return;
+
+    OSI_LOGXI(OSI_LOGPAR_SIII, 0, "audio metrics %s count/%d min/%d max/%d",
+              name, h->count, h->min, h->max);
+    OSI_LOGXI(OSI_LOGPAR_SI, 0, "audio metrics %s avg/%d", name, (unsigned)(h->sum / h->count));
+    for (unsigned n = 0; n < AUMETRICS_HIST_BUCKETS; n++)
+    {
+        if (h->bucket[n] != 0)
+            OSI_LOGXI(OSI_LOGPAR_SII, 0, "audio metrics %s bucket/%d count/%d",
+                      name, n, h->bucket[n]);
+    }
+}
+
+void auMetricsHistAdd(auMetricsHist_t *h, unsigned val)
+{
+    unsigned critical = osiEnterCritical();
+    if (h->count == 0 || val < h->min)
+        h->min = val;
+    if (val > h->max)
+        h->max = val;
+    h->count++;
+    h->sum += val;
+    h->bucket[prvHistBucket(val)]++;
+    osiExitCritical(critical);
+}
+
+auMetrics_t *auMetricsInstance(void)
+{
+    return &gAuMetrics;
+}
+
+void auMetricsGet(auMetrics_t *m)
+{
+    if (m == NULL)
+        return;
+
+    unsigned critical = osiEnterCritical();
+    *m = gAuMetrics;
+    osiExitCritical(critical);
+}
+
+void auMetricsReset(void)
+{
+    unsigned critical = osiEnterCritical();
+    memset(&gAuMetrics, 0, sizeof(gAuMetrics));
+    osiExitCritical(critical);
+}
+
+void auMetricsDump(void)
+{
+    static const char *decoder_names[AUMETRICS_DECODER_COUNT] = {
+        [AUSTREAM_FORMAT_UNKNOWN] = "dec-unknown",
+        [AUSTREAM_FORMAT_PCM] = "dec-pcm",
+        [AUSTREAM_FORMAT_WAVPCM] = "dec-wav",
+        [AUSTREAM_FORMAT_MP3] = "dec-mp3",
+        [AUSTREAM_FORMAT_AMRNB] = "dec-amrnb",
+        [AUSTREAM_FORMAT_AMRWB] = "dec-amrwb",
+        [AUSTREAM_FORMAT_SBC] = "dec-sbc",
+    };
+
+    auMetrics_t m;
+    auMetricsGet(&m);
+
+    OSI_LOGI(0, "audio metrics play requests/%d underruns/%d, record requests/%d overruns/%d drops/%d",
+             m.play_requests, m.play_underruns, m.rec_requests, m.rec_overruns, m.rec_drops);
+    prvHistDump("play-fill", &m.play_fill);
+    prvHistDump("play-latency", &m.play_latency);
+    prvHistDump("rec-fill", &m.rec_fill);
+    OSI_LOGI(0, "audio metrics voice starts/%d prepared/%d prepare timeouts/%d",
+             m.voice_starts, m.voice_prepared_starts, m.voice_prepare_timeouts);
+    prvHistDump("voice-prepare", &m.voice_prepare_us);
+    prvHistDump("voice-setup", &m.voice_setup_us);
+    for (unsigned n = 0; n < AUMETRICS_DECODER_COUNT; n++)
+        prvHistDump(decoder_names[n], &m.decode_us[n]);
+}
@@ -0,0 +1,659 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "audio_mixer.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define AUMIXER_BLOCK_MS (10)
+#define AUMIXER_RATE_MAX (48000)
+#define AUMIXER_BLOCK_FRAMES_MAX (AUMIXER_RATE_MAX * AUMIXER_BLOCK_MS / 1000)
+#define AUMIXER_DEFAULT_DUCK_GAIN (0x2000) // -12dB
+#define AUMIXER_DEFAULT_RAMP_MS (100)
+#define AUMIXER_STEP_ONE (1 << 16)
+
+enum
+{
+    AUMIXER_OUT_IDLE,
+    AUMIXER_OUT_PLAYING,
+    AUMIXER_OUT_STOPPING,
+};
+
+struct auMixerStream
+{
+    auMixerStream_t *next;
+    audevPlayOps_t ops;
+    void *ops_ctx;
+    auMixerRole_t role;
+    bool attached;  // in stream list
+    bool started;   // cur_gain is valid
+    bool eos;       // end of stream or error
+    uint8_t channel_count;
+    unsigned sample_rate;
+    unsigned gain;     // gain set by application
+    unsigned cur_gain; // gain applied, ramped to target
+    uint32_t step;     // input samples per output sample, Q16
+    uint32_t frac;     // position between s0 and s1, Q16
+    int16_t s0[2];
+    int16_t s1[2];
+};
+
+typedef struct
+{
+    osiMutex_t *lock;
+    osiWork_t *stop_work;
+    int out_state;
+    bool out_eos;
+    unsigned out_rate;
+    unsigned out_channels;
+    unsigned cfg_rate;
+    unsigned cfg_channels;
+    auMixerDuckConfig_t duck;
+    auMixerStream_t *streams;
+    unsigned pending_pos;
+    unsigned pending_bytes;
+    int16_t mix[AUMIXER_BLOCK_FRAMES_MAX * 2];
+    int16_t scratch[AUMIXER_BLOCK_FRAMES_MAX * 2];
+} auMixer_t;
+
+static auMixer_t gAuMixer;
+
+static inline int16_t prvSat16(int v)
+{
+    if (v > INT16_MAX)
+        return INT16_MAX;
+    if (v < INT16_MIN)
+        return INT16_MIN;
+    return v;
+}
+
+/**
+ * Mix src into mix with saturation, gain ramped from g0 to g1.
+ */
+static void prvMixSamples(int16_t *mix, const int16_t *src, unsigned count, unsigned g0, unsigned g1)
+{
+    unsigned n = 0;
+
+    if (g0 != g1)
+    {
+        int gq = g0 << 15;
+        int inc = ((int)g1 - (int)g0) * (1 << 15) / (int)OSI_MAX(unsigned, count, 1);
+        for (; n < count; n++, gq += inc)
+            mix[n] = prvSat16(mix[n] + ((src[n] * (gq >> 15) + 0x4000) >> 15));
+        return;
+    }
+
+    if (g0 == 0)
+        return;
+
+#if defined(__ARM_NEON)
+    unsigned count8 = count & ~7;
+    if (g0 >= AUMIXER_GAIN_UNITY)
+    {
+        for (; n < count8; n += 8)
+            vst1q_s16(&mix[n], vqaddq_s16(vld1q_s16(&mix[n]), vld1q_s16(&src[n])));
+    }
+    else
+    {
+        // vqrdmulh: (2 * a * b + 0x8000) >> 16, the same as scalar
+        int16x8_t vg = vdupq_n_s16(g0);
+        for (; n < count8; n += 8)
+            vst1q_s16(&mix[n], vqaddq_s16(vld1q_s16(&mix[n]),
+                                          vqrdmulhq_s16(vld1q_s16(&src[n]), vg)));
+    }
+#endif
+
+    if (g0 >= AUMIXER_GAIN_UNITY)
+    {
+        for (; n < count; n++)
+            mix[n] = prvSat16(mix[n] + src[n]);
+    }
+    else
+    {
+        for (; n < count; n++)
+            mix[n] = prvSat16(mix[n] + ((src[n] * (int)g0 + 0x4000) >> 15));
+    }
+}
+
+/**
+ * Read one input block, and convert to output channel count.
+ */
+static inline void prvReadBlock(const int16_t *in, unsigned in_ch, unsigned out_ch, int16_t *out)
+{
+    if (in_ch == out_ch)
+    {
+        out[0] = in[0];
+        if (out_ch == 2)
+            out[1] = in[1];
+    }
+    else if (out_ch == 2)
+    {
+        out[0] = out[1] = in[0];
+    }
+    else
+    {
+        out[0] = (in[0] + in[1]) >> 1;
+    }
+}
+
+/**
+ * Convert input blocks to output format. Return output block count, and
+ * input block count used.
+ */
+static unsigned prvConvert(auMixerStream_t *s, unsigned out_ch, const int16_t *in, unsigned in_blocks,
+                           int16_t *out, unsigned out_blocks, unsigned *used)
+{
+    unsigned in_ch = s->channel_count;
+
+    if (s->step == AUMIXER_STEP_ONE)
+    {
+        unsigned n = OSI_MIN(unsigned, in_blocks, out_blocks);
+        if (in_ch == out_ch)
+        {
+            memcpy(out, in, n * out_ch * sizeof(int16_t));
+        }
+        else
+        {
+            for (unsigned i = 0; i < n; i++)
+                prvReadBlock(&in[i * in_ch], in_ch, out_ch, &out[i * out_ch]);
+        }
+        *used = n;
+        return n;
+    }
+
+    // linear interpolation between s0 and s1
+    unsigned produced = 0;
+    unsigned consumed = 0;
+    while (produced < out_blocks)
+    {
+        while (s->frac >= AUMIXER_STEP_ONE)
+        {
+            if (consumed >= in_blocks)
+                goto done;
+
+            s->s0[0] = s->s1[0];
+            s->s0[1] = s->s1[1];
+            prvReadBlock(&in[consumed * in_ch], in_ch, out_ch, s->s1);
+            consumed++;
+            s->frac -= AUMIXER_STEP_ONE;
+        }
+
+        for (unsigned c = 0; c < out_ch; c++)
+            out[produced * out_ch + c] = s->s0[c] + (((s->s1[c] - s->s0[c]) * (int)(s->frac >> 1)) >> 15);
+        s->frac += s->step;
+        produced++;
+    }
+
+done:
+    *used = consumed;
+    return produced;
+}
+
+/**
+ * Pull samples from input stream, and convert to output format.
+ */
+static unsigned prvStreamRender(auMixer_t *m, auMixerStream_t *s, int16_t *out, unsigned blocks)
+{
+    unsigned done = 0;
+    unsigned in_block_bytes = s->channel_count * sizeof(int16_t);
+
+    while (done < blocks && !s->eos)
+    {
+        auFrame_t frame = {
+            .sample_format = AUSAMPLE_FORMAT_S16,
+            .channel_count = s->channel_count,
+            .sample_rate = s->sample_rate,
+        };
+
+        if (!s->ops.get_frame(s->ops_ctx, &frame))
+        {
+            OSI_LOGE(0, "audio mixer stream %p get frame failed", s);
+            s->eos = true;
+            break;
+        }
+
+        unsigned in_blocks = frame.bytes / in_block_bytes;
+        if (in_blocks == 0)
+        {
+            if (frame.flags & AUFRAME_FLAG_END)
+                s->eos = true;
+            break;
+        }
+
+        unsigned used = 0;
+        done += prvConvert(s, m->out_channels, (const int16_t *)frame.data, in_blocks,
+                           &out[done * m->out_channels], blocks - done, &used);
+        s->ops.data_consumed(s->ops_ctx, used * in_block_bytes);
+
+        if (used == in_blocks && (frame.flags & AUFRAME_FLAG_END))
+            s->eos = true;
+    }
+    return done;
+}
+
+/**
+ * Highest role of attached streams.
+ */
+static auMixerRole_t prvTopRole(auMixer_t *m)
+{
+    auMixerRole_t top = AUMIXER_ROLE_MUSIC;
+    for (auMixerStream_t *s = m->streams; s != NULL; s = s->next)
+    {
+        if (!s->eos && s->role > top)
+            top = s->role;
+    }
+    return top;
+}
+
+/**
+ * Gain of stream after ducking.
+ */
+static unsigned prvTargetGain(auMixer_t *m, auMixerStream_t *s, auMixerRole_t top)
+{
+    if (s->role >= top || m->duck.policy == AUMIXER_DUCK_NONE)
+        return s->gain;
+    if (m->duck.policy == AUMIXER_DUCK_PAUSE)
+        return 0;
+    return (s->gain * m->duck.duck_gain) >> 15;
+}
+
+/**
+ * Gain at the end of next block, ramped to target.
+ */
+static unsigned prvRampGain(auMixer_t *m, unsigned cur, unsigned target)
+{
+    if (m->duck.ramp_ms == 0)
+        return target;
+
+    unsigned step = OSI_MAX(unsigned, AUMIXER_GAIN_UNITY * AUMIXER_BLOCK_MS / m->duck.ramp_ms, 1);
+    if (cur < target)
+        return OSI_MIN(unsigned, cur + step, target);
+    if (cur > target + step)
+        return cur - step;
+    return target;
+}
+
+/**
+ * Mix one block of all input streams into mix buffer. Return the output
+ * block count, and it is 0 when all input streams have no data.
+ */
+static unsigned prvMixBlock(auMixer_t *m)
+{
+    unsigned blocks = m->out_rate * AUMIXER_BLOCK_MS / 1000;
+    unsigned mixed = 0;
+    auMixerRole_t top = prvTopRole(m);
+
+    memset(m->mix, 0, blocks * m->out_channels * sizeof(int16_t));
+    for (auMixerStream_t *s = m->streams; s != NULL; s = s->next)
+    {
+        unsigned target = prvTargetGain(m, s, top);
+        if (!s->started)
+        {
+            s->cur_gain = target;
+            s->started = true;
+        }
+
+        // paused stream isn't pulled, after it is ramped to 0
+        if (m->duck.policy == AUMIXER_DUCK_PAUSE && s->role < top && s->cur_gain == 0)
+            continue;
+
+        unsigned done = prvStreamRender(m, s, m->scratch, blocks);
+        unsigned gain = prvRampGain(m, s->cur_gain, target);
+        prvMixSamples(m->mix, m->scratch, done * m->out_channels, s->cur_gain, gain);
+        s->cur_gain = gain;
+        mixed = OSI_MAX(unsigned, mixed, done);
+    }
+    return mixed;
+}
+
+/**
+ * Remove stream from stream list.
+ */
+static void prvStreamRemove(auMixer_t *m, auMixerStream_t *s)
+{
+    for (auMixerStream_t **p = &m->streams; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == s)
+        {
+            *p = s->next;
+            break;
+        }
+    }
+    s->next = NULL;
+    s->attached = false;
+}
+
+/**
+ * Set conversion parameters for output format.
+ */
+static void prvStreamSetup(auMixer_t *m, auMixerStream_t *s)
+{
+    s->step = ((uint64_t)s->sample_rate << 16) / m->out_rate;
+    s->frac = 2 * AUMIXER_STEP_ONE; // load s0 and s1 at the first sample
+    memset(s->s0, 0, sizeof(s->s0));
+    memset(s->s1, 0, sizeof(s->s1));
+}
+
+/**
+ * Detach finished streams and send finish event. Callback may change
+ * stream list, so search from the head after each callback.
+ */
+static void prvNotifyFinished(auMixer_t *m)
+{
+    for (;;)
+    {
+        auMixerStream_t *s = m->streams;
+        while (s != NULL && !s->eos)
+            s = s->next;
+        if (s == NULL)
+            break;
+
+        OSI_LOGI(0, "audio mixer stream %p finished", s);
+        prvStreamRemove(m, s);
+        if (s->ops.handle_event != NULL)
+            s->ops.handle_event(s->ops_ctx, AUDEV_PLAY_EVENT_FINISH);
+    }
+}
+
+/**
+ * Detach all streams on output failure, except the one to be deleted
+ * by caller.
+ */
+static void prvOutputFail(auMixer_t *m, auMixerStream_t *except)
+{
+    for (;;)
+    {
+        auMixerStream_t *s = m->streams;
+        if (s == NULL)
+            break;
+
+        prvStreamRemove(m, s);
+        if (s != except && s->ops.handle_event != NULL)
+            s->ops.handle_event(s->ops_ctx, AUDEV_PLAY_EVENT_FINISH);
+    }
+}
+
+/**
+ * Audio device get_frame of output stream.
+ */
+static bool prvOutGetFrame(void *param, auFrame_t *frame)
+{
+    auMixer_t *m = (auMixer_t *)param;
+    osiMutexLock(m->lock);
+
+    frame->sample_format = AUSAMPLE_FORMAT_S16;
+    frame->channel_count = m->out_channels;
+    frame->sample_rate = m->out_rate;
+    frame->flags = 0;
+    frame->bytes = 0;
+
+    if (m->out_state != AUMIXER_OUT_PLAYING)
+    {
+        osiMutexUnlock(m->lock);
+        return true;
+    }
+
+    if (m->pending_pos >= m->pending_bytes)
+    {
+        unsigned blocks = prvMixBlock(m);
+        m->pending_pos = 0;
+        m->pending_bytes = blocks * m->out_channels * sizeof(int16_t);
+        prvNotifyFinished(m);
+    }
+
+    frame->data = (uintptr_t)m->mix + m->pending_pos;
+    frame->bytes = m->pending_bytes - m->pending_pos;
+    if (frame->bytes == 0 && m->streams == NULL)
+    {
+        frame->flags = AUFRAME_FLAG_END;
+        m->out_eos = true;
+    }
+
+    osiMutexUnlock(m->lock);
+    return true;
+}
+
+/**
+ * Audio device data_consumed of output stream.
+ */
+static void prvOutDataConsumed(void *param, unsigned bytes)
+{
+    auMixer_t *m = (auMixer_t *)param;
+    osiMutexLock(m->lock);
+    m->pending_pos = OSI_MIN(unsigned, m->pending_pos + bytes, m->pending_bytes);
+    osiMutexUnlock(m->lock);
+}
+
+/**
+ * Audio device handle_event of output stream.
+ */
+static void prvOutHandleEvent(void *param, audevPlayEvent_t event)
+{
+    auMixer_t *m = (auMixer_t *)param;
+    if (event == AUDEV_PLAY_EVENT_FINISH)
+        osiWorkEnqueue(m->stop_work, osiSysWorkQueueLowPriority());
+}
+
+static const audevPlayOps_t gAuMixerOps = {
+    .get_frame = prvOutGetFrame,
+    .data_consumed = prvOutDataConsumed,
+    .handle_event = prvOutHandleEvent,
+};
+
+/**
+ * Start output play stream, when it is idle and there are streams.
+ * It can't be called with lock, due to lock order with audio device.
+ */
+static bool prvOutputStart(auMixer_t *m)
+{
+    osiMutexLock(m->lock);
+    if (m->out_state != AUMIXER_OUT_IDLE || m->streams == NULL)
+    {
+        osiMutexUnlock(m->lock);
+        return true;
+    }
+
+    if (m->cfg_rate != 0)
+    {
+        m->out_rate = m->cfg_rate;
+        m->out_channels = m->cfg_channels;
+    }
+    else
+    {
+        m->out_rate = m->streams->sample_rate;
+        m->out_channels = m->streams->channel_count;
+    }
+
+    for (auMixerStream_t *s = m->streams; s != NULL; s = s->next)
+        prvStreamSetup(m, s);
+
+    m->pending_pos = 0;
+    m->pending_bytes = 0;
+    m->out_eos = false;
+    m->out_state = AUMIXER_OUT_PLAYING;
+
+    auFrame_t frame = {
+        .sample_format = AUSAMPLE_FORMAT_S16,
+        .channel_count = m->out_channels,
+        .sample_rate = m->out_rate,
+    };
+    osiMutexUnlock(m->lock);
+
+    OSI_LOGI(0, "audio mixer output start, rate/%d channels/%d", m->out_rate, m->out_channels);
+    if (audevStartPlay(&gAuMixerOps, m, &frame))
+        return true;
+
+    OSI_LOGE(0, "audio mixer output start failed");
+    osiMutexLock(m->lock);
+    m->out_state = AUMIXER_OUT_IDLE;
+    osiMutexUnlock(m->lock);
+    return false;
+}
+
+/**
+ * Stop output play stream after all streams are finished or stopped,
+ * and restart it if there are new streams during stop.
+ */
+static void prvStopWork(void *param)
+{
+    auMixer_t *m = (auMixer_t *)param;
+
+    osiMutexLock(m->lock);
+    if (m->out_state != AUMIXER_OUT_PLAYING || (m->streams != NULL && !m->out_eos))
+    {
+        osiMutexUnlock(m->lock);
+        return;
+    }
+    m->out_state = AUMIXER_OUT_STOPPING;
+    osiMutexUnlock(m->lock);
+
+    OSI_LOGI(0, "audio mixer output stop");
+    audevStopPlay();
+
+    osiMutexLock(m->lock);
+    m->out_state = AUMIXER_OUT_IDLE;
+    osiMutexUnlock(m->lock);
+
+    if (!prvOutputStart(m))
+    {
+        osiMutexLock(m->lock);
+        prvOutputFail(m, NULL);
+        osiMutexUnlock(m->lock);
+    }
+}
+
+void auMixerInit(void)
+{
+    auMixer_t *m = &gAuMixer;
+    m->lock = osiMutexCreate();
+    m->stop_work = osiWorkCreate(prvStopWork, NULL, m);
+    m->out_state = AUMIXER_OUT_IDLE;
+    m->duck.policy = AUMIXER_DUCK_ATTENUATE;
+    m->duck.duck_gain = AUMIXER_DEFAULT_DUCK_GAIN;
+    m->duck.ramp_ms = AUMIXER_DEFAULT_RAMP_MS;
+}
+
+bool auMixerSetOutputFormat(unsigned sample_rate, unsigned channel_count)
+{
+    auMixer_t *m = &gAuMixer;
+    if (sample_rate > AUMIXER_RATE_MAX || (sample_rate != 0 && sample_rate < 1000 / AUMIXER_BLOCK_MS))
+        return false;
+    if (sample_rate != 0 && channel_count != 1 && channel_count != 2)
+        return false;
+
+    osiMutexLock(m->lock);
+    m->cfg_rate = sample_rate;
+    m->cfg_channels = channel_count;
+    osiMutexUnlock(m->lock);
+    return true;
+}
+
+bool auMixerSetDuckConfig(const auMixerDuckConfig_t *cfg)
+{
+    auMixer_t *m = &gAuMixer;
+    if (cfg == NULL || cfg->policy > AUMIXER_DUCK_PAUSE || cfg->duck_gain > AUMIXER_GAIN_UNITY)
+        return false;
+
+    osiMutexLock(m->lock);
+    m->duck = *cfg;
+    osiMutexUnlock(m->lock);
+    return true;
+}
+
+auMixerStream_t *auMixerStreamStart(auMixerRole_t role, const audevPlayOps_t *play_ops,
+                                    void *play_ctx, const auFrame_t *frame)
+{
+    auMixer_t *m = &gAuMixer;
+    if (m->lock == NULL || role >= AUMIXER_ROLE_COUNT)
+        return NULL;
+    if (play_ops == NULL || play_ops->get_frame == NULL || play_ops->data_consumed == NULL)
+        return NULL;
+    if (frame == NULL || frame->sample_format != AUSAMPLE_FORMAT_S16 ||
+        (frame->channel_count != 1 && frame->channel_count != 2) ||
+        frame->sample_rate < 1000 / AUMIXER_BLOCK_MS || frame->sample_rate > AUMIXER_RATE_MAX)
+        return NULL;
+
+    auMixerStream_t *s = (auMixerStream_t *)calloc(1, sizeof(auMixerStream_t));
+    if (s == NULL)
+        return NULL;
+
+    s->ops = *play_ops;
+    s->ops_ctx = play_ctx;
+    s->role = role;
+    s->channel_count = frame->channel_count;
+    s->sample_rate = frame->sample_rate;
+    s->gain = AUMIXER_GAIN_UNITY;
+
+    // append to tail, the head is the oldest stream
+    osiMutexLock(m->lock);
+    auMixerStream_t **p = &m->streams;
+    while (*p != NULL)
+        p = &(*p)->next;
+    *p = s;
+    s->attached = true;
+    if (m->out_state != AUMIXER_OUT_IDLE)
+        prvStreamSetup(m, s);
+    osiMutexUnlock(m->lock);
+
+    OSI_LOGI(0, "audio mixer stream %p start, role/%d rate/%d channels/%d",
+             s, role, s->sample_rate, s->channel_count);
+
+    if (!prvOutputStart(m))
+    {
+        osiMutexLock(m->lock);
+        prvOutputFail(m, s);
+        osiMutexUnlock(m->lock);
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+void auMixerStreamStop(auMixerStream_t *s)
+{
+    auMixer_t *m = &gAuMixer;
+    if (s == NULL)
+        return;
+
+    OSI_LOGI(0, "audio mixer stream %p stop", s);
+
+    // when the last attached stream is stopped, stop output immediately
+    // rather than draining
+    osiMutexLock(m->lock);
+    bool stop_output = false;
+    if (s->attached)
+    {
+        prvStreamRemove(m, s);
+        stop_output = (m->streams == NULL && m->out_state == AUMIXER_OUT_PLAYING);
+    }
+    osiMutexUnlock(m->lock);
+
+    free(s);
+    if (stop_output)
+        osiWorkEnqueue(m->stop_work, osiSysWorkQueueLowPriority());
+}
+
+void auMixerStreamSetGain(auMixerStream_t *s, unsigned gain)
+{
+    auMixer_t *m = &gAuMixer;
+    if (s == NULL)
+        return;
+
+    osiMutexLock(m->lock);
+    s->gain = OSI_MIN(unsigned, gain, AUMIXER_GAIN_UNITY);
+    osiMutexUnlock(m->lock);
+}
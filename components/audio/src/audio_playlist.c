@@ -0,0 +1,535 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "audio_playlist.h"
+#include "audio_reader.h"
+#include "audio_device.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum
+{
+    ITEM_SOURCE_FILE,
+    ITEM_SOURCE_MEM,
+    ITEM_SOURCE_READER,
+};
+
+enum
+{
+    ITEM_STATE_PENDING, // not opened
+    ITEM_STATE_PRIMING, // opening and decoding the first frame
+    ITEM_STATE_PRIMED,  // the first frame is decoded
+};
+
+typedef struct auPlaylistItem
+{
+    struct auPlaylistItem *next;
+    int source;
+    int state;
+    auStreamFormat_t format;
+    bool pcm_valid;
+    auFrame_t pcm;
+    const void *buf;
+    unsigned size;
+    auReader_t *reader;
+    bool reader_owned;
+    auDecoder_t *decoder;
+    bool eos;
+    auFrame_t frame; // decoded frame, format is valid after primed
+    unsigned frame_pos;
+    char fname[];
+} auPlaylistItem_t;
+
+struct auPlaylist
+{
+    osiMutex_t *lock;
+    osiWork_t *prime_work;
+    osiWork_t *restart_work;
+    auPlaylistEventCallback_t cb;
+    void *cb_ctx;
+    auPlaylistItem_t *cur;   // playing item
+    auPlaylistItem_t *queue; // items after the playing item
+    bool started;
+    bool out_eos;
+    auFrame_t out_format;
+};
+
+static void prvEvent(auPlaylist_t *d, auPlaylistEvent_t event)
+{
+    if (d->cb != NULL)
+        d->cb(d->cb_ctx, event);
+}
+
+static void prvItemDelete(auPlaylistItem_t *it)
+{
+    if (it == NULL)
+        return;
+
+    auDecoderDelete(it->decoder);
+    if (it->reader_owned)
+        auReaderDelete(it->reader);
+    free(it);
+}
+
+/**
+ * Decode the next frame of item
+ */
+static void prvItemDecode(auPlaylistItem_t *it)
+{
+    it->frame_pos = 0;
+    int bytes = auDecoderDecode(it->decoder, &it->frame);
+    if (bytes < 0)
+    {
+        OSI_LOGE(0, "audio playlist item %p decode failed", it);
+        it->frame.bytes = 0;
+        it->eos = true;
+    }
+    else if (it->frame.flags & AUFRAME_FLAG_END)
+    {
+        it->eos = true;
+    }
+    else if (bytes == 0 && auReaderIsEof(it->reader))
+    {
+        it->frame.bytes = 0;
+        it->eos = true;
+    }
+}
+
+/**
+ * Open reader and decoder, and decode the first frame. It is called
+ * without lock, and only the item is touched.
+ */
+static void prvItemPrime(auPlaylistItem_t *it)
+{
+    if (it->source == ITEM_SOURCE_FILE)
+        it->reader = (auReader_t *)auFileReaderCreate(it->fname);
+    else if (it->source == ITEM_SOURCE_MEM)
+        it->reader = (auReader_t *)auMemReaderCreate(it->buf, it->size);
+    if (it->source != ITEM_SOURCE_READER)
+        it->reader_owned = true;
+
+    if (it->reader != NULL)
+        it->decoder = auDecoderCreate(it->reader, it->format);
+
+    if (it->decoder == NULL)
+    {
+        OSI_LOGE(0, "audio playlist item %p open failed", it);
+        it->eos = true;
+        return;
+    }
+
+    if (it->pcm_valid)
+        auDecoderSetParam(it->decoder, AU_DEC_PARAM_FORMAT, &it->pcm);
+
+    prvItemDecode(it);
+
+    // format isn't known from empty frame, ask decoder
+    if (it->frame.bytes == 0)
+        auDecoderGetParam(it->decoder, AU_DEC_PARAM_FORMAT, &it->frame);
+}
+
+/**
+ * Make sure the item is primed, called with lock
+ */
+static void prvItemPrimeSync(auPlaylist_t *d, auPlaylistItem_t *it)
+{
+    while (it->state == ITEM_STATE_PRIMING)
+    {
+        osiMutexUnlock(d->lock);
+        osiWorkWaitFinish(d->prime_work, OSI_WAIT_FOREVER);
+        osiMutexLock(d->lock);
+    }
+
+    if (it->state == ITEM_STATE_PENDING)
+    {
+        it->state = ITEM_STATE_PRIMING;
+        prvItemPrime(it);
+        it->state = ITEM_STATE_PRIMED;
+    }
+}
+
+/**
+ * Prime the first item in queue in background
+ */
+static void prvPrimeWork(void *param)
+{
+    auPlaylist_t *d = (auPlaylist_t *)param;
+
+    osiMutexLock(d->lock);
+    auPlaylistItem_t *it = d->queue;
+    if (it == NULL || it->state != ITEM_STATE_PENDING)
+    {
+        osiMutexUnlock(d->lock);
+        return;
+    }
+    it->state = ITEM_STATE_PRIMING;
+    osiMutexUnlock(d->lock);
+
+    prvItemPrime(it);
+
+    osiMutexLock(d->lock);
+    it->state = ITEM_STATE_PRIMED;
+    osiMutexUnlock(d->lock);
+}
+
+/**
+ * Whether the primed item can continue the current play stream
+ */
+static bool prvFormatCompatible(auPlaylist_t *d, auPlaylistItem_t *it)
+{
+    if (it->frame.sample_rate == 0 || it->frame.channel_count == 0)
+        return true;
+    return auSampleFormatMatch(&d->out_format, &it->frame);
+}
+
+/**
+ * Audio device get_frame
+ */
+static bool prvGetFrame(void *param, auFrame_t *frame)
+{
+    auPlaylist_t *d = (auPlaylist_t *)param;
+    osiMutexLock(d->lock);
+
+    auSampleFormatCopy(frame, &d->out_format);
+    frame->flags = 0;
+    frame->bytes = 0;
+
+    while (d->started)
+    {
+        auPlaylistItem_t *it = d->cur;
+        if (it == NULL)
+        {
+            it = d->queue;
+            if (it != NULL)
+                prvItemPrimeSync(d, it);
+
+            if (it == NULL || !prvFormatCompatible(d, it))
+            {
+                // the play stream will be stopped, and restarted with
+                // the format of next item
+                frame->flags = AUFRAME_FLAG_END;
+                d->out_eos = true;
+                break;
+            }
+
+            d->queue = it->next;
+            it->next = NULL;
+            d->cur = it;
+            if (d->queue != NULL)
+                osiWorkEnqueue(d->prime_work, osiSysWorkQueueLowPriority());
+        }
+
+        if (it->frame_pos < it->frame.bytes)
+        {
+            frame->data = it->frame.data + it->frame_pos;
+            frame->bytes = it->frame.bytes - it->frame_pos;
+            break;
+        }
+
+        if (it->eos)
+        {
+            OSI_LOGI(0, "audio playlist item %p finished", it);
+            d->cur = NULL;
+            prvItemDelete(it);
+            prvEvent(d, AUPLAYLIST_EVENT_ITEM_FINISHED);
+            continue;
+        }
+
+        prvItemDecode(it);
+        if (it->frame.bytes == 0 && !it->eos)
+            break; // no data now, try later
+    }
+
+    osiMutexUnlock(d->lock);
+    return true;
+}
+
+/**
+ * Audio device data_consumed
+ */
+static void prvDataConsumed(void *param, unsigned bytes)
+{
+    auPlaylist_t *d = (auPlaylist_t *)param;
+    osiMutexLock(d->lock);
+    if (d->cur != NULL)
+        d->cur->frame_pos = OSI_MIN(unsigned, d->cur->frame_pos + bytes, d->cur->frame.bytes);
+    osiMutexUnlock(d->lock);
+}
+
+/**
+ * Audio device handle_event
+ */
+static void prvHandleEvent(void *param, audevPlayEvent_t event)
+{
+    auPlaylist_t *d = (auPlaylist_t *)param;
+    if (event == AUDEV_PLAY_EVENT_FINISH)
+        osiWorkEnqueue(d->restart_work, osiSysWorkQueueLowPriority());
+}
+
+static const audevPlayOps_t gPlaylistOps = {
+    .get_frame = prvGetFrame,
+    .data_consumed = prvDataConsumed,
+    .handle_event = prvHandleEvent,
+};
+
+/**
+ * Start play stream of audio device with the format of the first item.
+ * It can't be called with lock, due to lock order with audio device.
+ */
+static bool prvStartPlay(auPlaylist_t *d)
+{
+    osiMutexLock(d->lock);
+    auPlaylistItem_t *it = (d->cur != NULL) ? d->cur : d->queue;
+    if (it == NULL)
+    {
+        d->started = false;
+        osiMutexUnlock(d->lock);
+        return false;
+    }
+
+    prvItemPrimeSync(d, it);
+    if (it->frame.sample_rate != 0 && it->frame.channel_count != 0)
+        auSampleFormatCopy(&d->out_format, &it->frame);
+    d->out_eos = false;
+    d->started = true;
+
+    auFrame_t frame = d->out_format;
+    osiMutexUnlock(d->lock);
+
+    OSI_LOGI(0, "audio playlist start play, rate/%d channels/%d",
+             (unsigned)frame.sample_rate, frame.channel_count);
+    if (audevStartPlay(&gPlaylistOps, d, &frame))
+        return true;
+
+    OSI_LOGE(0, "audio playlist start play failed");
+    osiMutexLock(d->lock);
+    d->started = false;
+    osiMutexUnlock(d->lock);
+    return false;
+}
+
+/**
+ * Play stream finished, restart it for remaining items with different
+ * format, or finish playlist.
+ */
+static void prvRestartWork(void *param)
+{
+    auPlaylist_t *d = (auPlaylist_t *)param;
+
+    osiMutexLock(d->lock);
+    if (!d->started || !d->out_eos)
+    {
+        osiMutexUnlock(d->lock);
+        return;
+    }
+    bool more = (d->cur != NULL || d->queue != NULL);
+    osiMutexUnlock(d->lock);
+
+    audevStopPlay();
+    if (more && prvStartPlay(d))
+        return;
+
+    osiMutexLock(d->lock);
+    d->started = false;
+    prvEvent(d, AUPLAYLIST_EVENT_FINISHED);
+    osiMutexUnlock(d->lock);
+}
+
+static auPlaylistItem_t *prvItemCreate(auStreamFormat_t format, const auFrame_t *pcm, const char *fname)
+{
+    unsigned name_size = (fname == NULL) ? 0 : strlen(fname) + 1;
+    auPlaylistItem_t *it = (auPlaylistItem_t *)calloc(1, sizeof(auPlaylistItem_t) + name_size);
+    if (it == NULL)
+        return NULL;
+
+    it->format = format;
+    it->state = ITEM_STATE_PENDING;
+    if (format == AUSTREAM_FORMAT_PCM && pcm != NULL)
+    {
+        it->pcm_valid = true;
+        it->pcm = *pcm;
+    }
+    if (fname != NULL)
+        memcpy(it->fname, fname, name_size);
+    return it;
+}
+
+static bool prvItemAdd(auPlaylist_t *d, auPlaylistItem_t *it)
+{
+    if (it == NULL)
+        return false;
+
+    osiMutexLock(d->lock);
+    auPlaylistItem_t **p = &d->queue;
+    while (*p != NULL)
+        p = &(*p)->next;
+    *p = it;
+
+    // prime in background when it is the next to be played
+    if (d->queue == it && d->started)
+        osiWorkEnqueue(d->prime_work, osiSysWorkQueueLowPriority());
+    osiMutexUnlock(d->lock);
+    return true;
+}
+
+auPlaylist_t *auPlaylistCreate(void)
+{
+    auPlaylist_t *d = (auPlaylist_t *)calloc(1, sizeof(auPlaylist_t));
+    if (d == NULL)
+        return NULL;
+
+    d->lock = osiMutexCreate();
+    d->prime_work = osiWorkCreate(prvPrimeWork, NULL, d);
+    d->restart_work = osiWorkCreate(prvRestartWork, NULL, d);
+    if (d->lock == NULL || d->prime_work == NULL || d->restart_work == NULL)
+    {
+        auPlaylistDelete(d);
+        return NULL;
+    }
+
+    auInitSampleFormat(&d->out_format);
+    OSI_LOGI(0, "audio playlist create %p", d);
+    return d;
+}
+
+void auPlaylistDelete(auPlaylist_t *d)
+{
+    if (d == NULL)
+        return;
+
+    OSI_LOGI(0, "audio playlist delete %p", d);
+    if (d->lock != NULL && d->prime_work != NULL && d->restart_work != NULL)
+        auPlaylistStop(d);
+
+    if (d->prime_work != NULL)
+        osiWorkDelete(d->prime_work);
+    if (d->restart_work != NULL)
+        osiWorkDelete(d->restart_work);
+    osiMutexDelete(d->lock);
+    free(d);
+}
+
+void auPlaylistSetEventCallback(auPlaylist_t *d, auPlaylistEventCallback_t cb, void *cb_ctx)
+{
+    osiMutexLock(d->lock);
+    d->cb = cb;
+    d->cb_ctx = cb_ctx;
+    osiMutexUnlock(d->lock);
+}
+
+bool auPlaylistAddFile(auPlaylist_t *d, auStreamFormat_t format, const auFrame_t *pcm, const char *fname)
+{
+    if (d == NULL || fname == NULL)
+        return false;
+
+    auPlaylistItem_t *it = prvItemCreate(format, pcm, fname);
+    if (it != NULL)
+        it->source = ITEM_SOURCE_FILE;
+    return prvItemAdd(d, it);
+}
+
+bool auPlaylistAddMem(auPlaylist_t *d, auStreamFormat_t format, const auFrame_t *pcm,
+                      const void *buf, unsigned size)
+{
+    if (d == NULL || (size > 0 && buf == NULL))
+        return false;
+
+    auPlaylistItem_t *it = prvItemCreate(format, pcm, NULL);
+    if (it != NULL)
+    {
+        it->source = ITEM_SOURCE_MEM;
+        it->buf = buf;
+        it->size = size;
+    }
+    return prvItemAdd(d, it);
+}
+
+bool auPlaylistAddReader(auPlaylist_t *d, auStreamFormat_t format, const auFrame_t *pcm,
+                         struct auReader *reader)
+{
+    if (d == NULL || reader == NULL)
+        return false;
+
+    auPlaylistItem_t *it = prvItemCreate(format, pcm, NULL);
+    if (it != NULL)
+    {
+        it->source = ITEM_SOURCE_READER;
+        it->reader = reader;
+    }
+    return prvItemAdd(d, it);
+}
+
+bool auPlaylistStart(auPlaylist_t *d)
+{
+    if (d == NULL)
+        return false;
+
+    osiMutexLock(d->lock);
+    bool started = d->started;
+    osiMutexUnlock(d->lock);
+    if (started)
+        return true;
+
+    if (!prvStartPlay(d))
+        return false;
+
+    osiMutexLock(d->lock);
+    if (d->queue != NULL)
+        osiWorkEnqueue(d->prime_work, osiSysWorkQueueLowPriority());
+    osiMutexUnlock(d->lock);
+    return true;
+}
+
+void auPlaylistStop(auPlaylist_t *d)
+{
+    if (d == NULL)
+        return;
+
+    osiMutexLock(d->lock);
+    bool started = d->started;
+    d->started = false;
+    osiMutexUnlock(d->lock);
+
+    osiWorkCancel(d->restart_work);
+    osiWorkWaitFinish(d->restart_work, OSI_WAIT_FOREVER);
+    if (started)
+        audevStopPlay();
+
+    osiWorkCancel(d->prime_work);
+    osiWorkWaitFinish(d->prime_work, OSI_WAIT_FOREVER);
+
+    osiMutexLock(d->lock);
+    prvItemDelete(d->cur);
+    d->cur = NULL;
+    while (d->queue != NULL)
+    {
+        auPlaylistItem_t *it = d->queue;
+        d->queue = it->next;
+        prvItemDelete(it);
+    }
+    osiMutexUnlock(d->lock);
+}
+
+unsigned auPlaylistCount(auPlaylist_t *d)
+{
+    if (d == NULL)
+        return 0;
+
+    osiMutexLock(d->lock);
+    unsigned count = (d->cur != NULL) ? 1 : 0;
+    for (auPlaylistItem_t *it = d->queue; it != NULL; it = it->next)
+        count++;
+    osiMutexUnlock(d->lock);
+    return count;
+}
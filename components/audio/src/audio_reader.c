@@ -14,6 +14,7 @@
 #include "vfs.h"
 #include "osi_log.h"
 #include "osi_pipe.h"
+#include "osi_api.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -81,19 +82,143 @@ bool auReaderIsEof(auReader_t *d)
 /**
  * file reader
  */
+#define FILE_PREFETCH_CHUNK (4096)
+#define FILE_PREFETCH_WQ_PRIO (OSI_PRIORITY_ABOVE_NORMAL)
+#define FILE_PREFETCH_WQ_STACK_SIZE (4096)
+
 struct auFileReader
 {
     auReaderOps_t ops;
     int fd;
+    unsigned file_size;
+
+    // prefetch, buf is NULL when prefetch isn't enabled
+    uint8_t *buf;
+    unsigned size;  // ring buffer size
+    unsigned chunk; // refill size
+    unsigned start; // file offset of the oldest data in ring buffer
+    unsigned pos;   // file offset of read position
+    unsigned end;   // file offset of the end of data in ring buffer
+    unsigned gen;   // increased when ring buffer is reset
+    unsigned timeout;
+    unsigned underrun;
+    bool eof;
+    bool error;
+    bool closing;
+    osiMutex_t *lock;
+    osiSemaphore_t *sema;
+    osiWork_t *work;
 };
 
+static osiWorkQueue_t *gFilePrefetchWq = NULL;
+
+/**
+ * Work queue for prefetch is shared by all file readers, and created at
+ * the first usage.
+ */
+static osiWorkQueue_t *prvFilePrefetchWq(void)
+{
+    if (gFilePrefetchWq != NULL)
+        return gFilePrefetchWq;
+
+    osiWorkQueue_t *wq = osiWorkQueueCreate("aureader", 1, FILE_PREFETCH_WQ_PRIO, FILE_PREFETCH_WQ_STACK_SIZE);
+    if (wq == NULL)
+        return NULL;
+
+    uint32_t critical = osiEnterCritical();
+    bool exist = (gFilePrefetchWq != NULL);
+    if (!exist)
+        gFilePrefetchWq = wq;
+    osiExitCritical(critical);
+
+    if (exist)
+        osiWorkQueueDelete(wq);
+    return gFilePrefetchWq;
+}
+
+/**
+ * Trigger refill when there are enough free space, called with lock
+ */
+static void prvFilePrefetchStart(auFileReader_t *p)
+{
+    if (p->eof || p->error || p->closing)
+        return;
+
+    unsigned space = p->size - (p->end - p->pos);
+    if (space >= p->chunk || p->end == p->pos)
+        osiWorkEnqueue(p->work, gFilePrefetchWq);
+}
+
+/**
+ * Refill work, file is only accessed here after creation
+ */
+static void prvFilePrefetchWork(void *param)
+{
+    auFileReader_t *p = (auFileReader_t *)param;
+
+    for (;;)
+    {
+        osiMutexLock(p->lock);
+        unsigned space = p->size - (p->end - p->pos);
+        if (p->eof || p->error || p->closing || space == 0)
+        {
+            osiMutexUnlock(p->lock);
+            break;
+        }
+
+        // reads end at chunk boundary in file, and don't cross ring end
+        unsigned offset = p->end;
+        unsigned index = offset % p->size;
+        unsigned bytes = p->chunk - (offset % p->chunk);
+        bytes = OSI_MIN(unsigned, bytes, space);
+        bytes = OSI_MIN(unsigned, bytes, p->size - index);
+
+        // history to be overwritten is dropped before read
+        if (offset + bytes - p->start > p->size)
+            p->start = offset + bytes - p->size;
+
+        unsigned gen = p->gen;
+        osiMutexUnlock(p->lock);
+
+        int rbytes = -1;
+        if (vfs_lseek(p->fd, offset, SEEK_SET) == (long)offset)
+            rbytes = vfs_read(p->fd, &p->buf[index], bytes);
+
+        osiMutexLock(p->lock);
+        if (gen == p->gen)
+        {
+            if (rbytes < 0)
+                p->error = true;
+            else if (rbytes == 0)
+                p->eof = true;
+            else
+                p->end += rbytes;
+        }
+        osiMutexUnlock(p->lock);
+        osiSemaphoreRelease(p->sema);
+    }
+}
+
 static void prvFileDelete(auReader_t *d)
 {
     auFileReader_t *p = (auFileReader_t *)d;
     if (p == NULL)
         return;
 
-    OSI_LOGI(0, "audio file reader delete");
+    OSI_LOGI(0, "audio file reader delete, underrun/%d", p->underrun);
+    if (p->buf != NULL)
+    {
+        osiMutexLock(p->lock);
+        p->closing = true;
+        osiMutexUnlock(p->lock);
+
+        osiWorkCancel(p->work);
+        osiWorkWaitFinish(p->work, OSI_WAIT_FOREVER);
+        osiWorkDelete(p->work);
+        osiSemaphoreDelete(p->sema);
+        osiMutexDelete(p->lock);
+    }
+
     vfs_close(p->fd);
     free(p);
 }
@@ -101,19 +226,112 @@ static void prvFileDelete(auReader_t *d)
 static int prvFileRead(auReader_t *d, void *buf, unsigned size)
 {
     auFileReader_t *p = (auFileReader_t *)d;
-    return vfs_read(p->fd, buf, size);
+    if (p->buf == NULL)
+        return vfs_read(p->fd, buf, size);
+
+    if (size > 0 && buf == NULL)
+        return -1;
+
+    osiMutexLock(p->lock);
+
+    // refill size follows the largest read, to serve it without wait
+    if (size > p->chunk)
+        p->chunk = OSI_MIN(unsigned, OSI_ALIGN_UP(size, FILE_PREFETCH_CHUNK), p->size / 2);
+
+    unsigned done = 0;
+    while (done < size)
+    {
+        unsigned avail = p->end - p->pos;
+        if (avail > 0)
+        {
+            unsigned index = p->pos % p->size;
+            unsigned bytes = OSI_MIN(unsigned, size - done, avail);
+            bytes = OSI_MIN(unsigned, bytes, p->size - index);
+            memcpy((uint8_t *)buf + done, &p->buf[index], bytes);
+            done += bytes;
+            p->pos += bytes;
+            continue;
+        }
+
+        if (p->eof || p->error || p->timeout == 0)
+            break;
+
+        p->underrun++;
+        prvFilePrefetchStart(p);
+        osiMutexUnlock(p->lock);
+        bool waited = osiSemaphoreTryAcquire(p->sema, p->timeout);
+        osiMutexLock(p->lock);
+        if (!waited)
+            break;
+    }
+
+    prvFilePrefetchStart(p);
+    int result = (done == 0 && p->error) ? -1 : (int)done;
+    osiMutexUnlock(p->lock);
+    return result;
 }
 
 static int prvFileSeek(auReader_t *d, int offset, int whence)
 {
     auFileReader_t *p = (auFileReader_t *)d;
-    return vfs_lseek(p->fd, offset, whence);
+    if (p->buf == NULL)
+        return vfs_lseek(p->fd, offset, whence);
+
+    osiMutexLock(p->lock);
+
+    long pos;
+    switch (whence)
+    {
+    case SEEK_SET:
+        pos = offset;
+        break;
+    case SEEK_CUR:
+        pos = (long)p->pos + offset;
+        break;
+    case SEEK_END:
+        pos = (long)p->file_size + offset;
+        break;
+    default:
+        pos = -1;
+        break;
+    }
+
+    if (pos < 0)
+    {
+        osiMutexUnlock(p->lock);
+        return -1;
+    }
+
+    if (pos >= p->start && pos <= p->end)
+    {
+        p->pos = pos;
+    }
+    else
+    {
+        // out of ring buffer, data in refill will be discarded
+        p->gen++;
+        p->start = p->pos = p->end = pos;
+        p->eof = false;
+        p->error = false;
+    }
+
+    prvFilePrefetchStart(p);
+    osiMutexUnlock(p->lock);
+    return pos;
 }
 
 static bool prvFileEof(auReader_t *d)
 {
     auFileReader_t *p = (auFileReader_t *)d;
 
+    if (p->buf != NULL)
+    {
+        osiMutexLock(p->lock);
+        bool eof = (p->pos >= p->end) && (p->eof || p->error || p->pos >= p->file_size);
+        osiMutexUnlock(p->lock);
+        return eof;
+    }
+
     struct stat st;
     if (vfs_fstat(p->fd, &st) < 0)
         return true;
@@ -127,22 +345,74 @@ static bool prvFileEof(auReader_t *d)
 
 auFileReader_t *auFileReaderCreate(const char *fname)
 {
-    OSI_LOGI(0, "audio file reader create");
+#ifdef CONFIG_AUDIO_FILE_READER_PREFETCH_SIZE
+    return auFileReaderCreateWithPrefetch(fname, CONFIG_AUDIO_FILE_READER_PREFETCH_SIZE);
+#else
+    return auFileReaderCreateWithPrefetch(fname, 0);
+#endif
+}
+
+auFileReader_t *auFileReaderCreateWithPrefetch(const char *fname, unsigned size)
+{
+    OSI_LOGI(0, "audio file reader create, prefetch/%d", size);
 
     int fd = vfs_open(fname, O_RDONLY);
     if (fd < 0)
         return NULL;
 
-    auFileReader_t *d = (auFileReader_t *)calloc(1, sizeof(auFileReader_t));
+    auFileReader_t *d = (auFileReader_t *)calloc(1, sizeof(auFileReader_t) + size);
     if (d == NULL)
-        return NULL;
+        goto failed;
 
     d->ops.destroy = prvFileDelete;
     d->ops.read = prvFileRead;
     d->ops.seek = prvFileSeek;
     d->ops.is_eof = prvFileEof;
     d->fd = fd;
+    if (size == 0)
+        return d;
+
+    struct stat st;
+    if (vfs_fstat(fd, &st) < 0)
+        goto failed;
+
+    d->file_size = st.st_size;
+    d->buf = (uint8_t *)d + sizeof(auFileReader_t);
+    d->size = size;
+    d->chunk = OSI_MIN(unsigned, FILE_PREFETCH_CHUNK, size / 2);
+    d->timeout = OSI_WAIT_FOREVER;
+    d->lock = osiMutexCreate();
+    d->sema = osiSemaphoreCreate(1, 0);
+    d->work = osiWorkCreate(prvFilePrefetchWork, NULL, d);
+    if (d->chunk == 0 || d->lock == NULL || d->sema == NULL ||
+        d->work == NULL || prvFilePrefetchWq() == NULL)
+        goto failed;
+
+    osiWorkEnqueue(d->work, gFilePrefetchWq);
     return d;
+
+failed:
+    if (d != NULL)
+    {
+        if (d->work != NULL)
+            osiWorkDelete(d->work);
+        if (d->sema != NULL)
+            osiSemaphoreDelete(d->sema);
+        osiMutexDelete(d->lock);
+        free(d);
+    }
+    vfs_close(fd);
+    return NULL;
+}
+
+void auFileReaderSetWait(auFileReader_t *d, unsigned timeout)
+{
+    if (d == NULL || d->buf == NULL)
+        return;
+
+    osiMutexLock(d->lock);
+    d->timeout = timeout;
+    osiMutexUnlock(d->lock);
 }
 
 /**
@@ -0,0 +1,424 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "audio_rec_pipeline.h"
+#include "audio_device.h"
+#include "audio_writer.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "vfs.h"
+#include "vfs_aio.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AURECPIPE_RING_SIZE (64 * 1024)
+#define AURECPIPE_BLOCK_SIZE (4 * 1024)
+#define AURECPIPE_BLOCK_COUNT (4)
+#define AURECPIPE_ENCODE_CHUNK (2048)
+#define AURECPIPE_WQ_PRIO (OSI_PRIORITY_NORMAL)
+
+typedef struct
+{
+    auWriterOps_t ops;
+    struct auRecPipeline *owner;
+} auRecPipelineWriter_t;
+
+struct auRecPipeline
+{
+    auRecPipelineConfig_t cfg;
+    osiWorkQueue_t *wq;
+    osiWork_t *encode_work;
+    osiSemaphore_t *block_sema;
+    auRecPipelineEventCallback_t cb;
+    void *cb_ctx;
+
+    bool started;
+    int fd;
+    auEncoder_t *encoder;
+    auRecPipelineWriter_t writer;
+
+    // capture ring, single producer (audio thread), single consumer
+    uint8_t *ring;
+    volatile unsigned ring_wr;
+    volatile unsigned ring_rd;
+    auFrame_t format; // valid after the first captured frame
+
+    // output blocks, written in submission order
+    uint8_t *blocks;
+    unsigned *block_sizes;
+    int block_cur; // -1 for no block in filling
+    unsigned block_fill;
+    unsigned block_next;
+    unsigned block_done; // only in file write work queue
+
+    auRecPipelineStat_t stat;
+    uint8_t chunk[AURECPIPE_ENCODE_CHUNK];
+};
+
+static void prvEvent(auRecPipeline_t *d)
+{
+    if (d->cb != NULL)
+        d->cb(d->cb_ctx, AURECPIPE_EVENT_FINISHED);
+}
+
+/**
+ * Output block write finished, in file write work queue
+ */
+static void prvBlockDone(void *ctx, ssize_t result)
+{
+    auRecPipeline_t *d = (auRecPipeline_t *)ctx;
+    unsigned size = d->block_sizes[d->block_done];
+    d->block_done = (d->block_done + 1) % d->cfg.block_count;
+
+    if (result == (ssize_t)size)
+    {
+        d->stat.written_bytes += size;
+    }
+    else if (!d->stat.write_error)
+    {
+        OSI_LOGE(0, "audio rec pipeline write failed, size/%d result/%d", size, result);
+        d->stat.write_error = true;
+        prvEvent(d);
+    }
+    osiSemaphoreRelease(d->block_sema);
+}
+
+/**
+ * Submit the block in filling
+ */
+static void prvBlockSubmit(auRecPipeline_t *d)
+{
+    if (d->block_cur < 0)
+        return;
+
+    unsigned index = d->block_cur;
+    d->block_cur = -1;
+    d->block_sizes[index] = d->block_fill;
+    if (d->block_fill > 0 &&
+        vfs_aio_write(d->fd, &d->blocks[index * d->cfg.block_size], d->block_fill, prvBlockDone, d) >= 0)
+        return;
+
+    if (d->block_fill > 0 && !d->stat.write_error)
+    {
+        OSI_LOGE(0, "audio rec pipeline submit failed, size/%d", d->block_fill);
+        d->stat.write_error = true;
+        prvEvent(d);
+    }
+
+    // not submitted, it is the last got block and just return it
+    d->block_next = index;
+    osiSemaphoreRelease(d->block_sema);
+}
+
+/**
+ * Get a free block for filling, wait when all blocks are in writing
+ */
+static void prvBlockGet(auRecPipeline_t *d)
+{
+    if (d->block_cur >= 0)
+        return;
+
+    if (!osiSemaphoreTryAcquire(d->block_sema, 0))
+    {
+        d->stat.write_stalls++;
+        osiSemaphoreAcquire(d->block_sema);
+    }
+    d->block_cur = d->block_next;
+    d->block_next = (d->block_next + 1) % d->cfg.block_count;
+    d->block_fill = 0;
+}
+
+/**
+ * Wait all submitted blocks written
+ */
+static void prvBlockFlush(auRecPipeline_t *d)
+{
+    prvBlockSubmit(d);
+    vfs_aio_wait(d->fd);
+}
+
+static void prvWriterDelete(auWriter_t *w)
+{
+}
+
+/**
+ * Writer of encoder, encoded data are collected into output blocks
+ */
+static int prvWriterWrite(auWriter_t *w, const void *buf, unsigned size)
+{
+    auRecPipeline_t *d = ((auRecPipelineWriter_t *)w)->owner;
+    if (d->stat.write_error)
+        return -1;
+
+    const uint8_t *data = (const uint8_t *)buf;
+    unsigned left = size;
+    while (left > 0)
+    {
+        prvBlockGet(d);
+
+        unsigned bytes = OSI_MIN(unsigned, left, d->cfg.block_size - d->block_fill);
+        memcpy(&d->blocks[d->block_cur * d->cfg.block_size + d->block_fill], data, bytes);
+        d->block_fill += bytes;
+        data += bytes;
+        left -= bytes;
+
+        if (d->block_fill >= d->cfg.block_size)
+            prvBlockSubmit(d);
+    }
+
+    d->stat.encoded_bytes += size;
+    return size;
+}
+
+/**
+ * Seek is used by encoders to update header, all blocks should be
+ * written before seek.
+ */
+static int prvWriterSeek(auWriter_t *w, int offset, int whence)
+{
+    auRecPipeline_t *d = ((auRecPipelineWriter_t *)w)->owner;
+    prvBlockFlush(d);
+    return vfs_lseek(d->fd, offset, whence);
+}
+
+/**
+ * Encode work, drain PCM ring buffer
+ */
+static void prvEncodeWork(void *param)
+{
+    auRecPipeline_t *d = (auRecPipeline_t *)param;
+    unsigned block_bytes = AUFRAME_BYTE_PER_BLOCK(&d->format);
+    if (block_bytes == 0)
+        return;
+
+    for (;;)
+    {
+        unsigned wr = d->ring_wr;
+        OSI_BARRIER();
+        unsigned avail = wr - d->ring_rd;
+        unsigned bytes = OSI_MIN(unsigned, avail, AURECPIPE_ENCODE_CHUNK);
+        bytes -= bytes % block_bytes;
+        if (bytes == 0)
+            break;
+
+        // copy out of ring buffer, so ring space is released before encode
+        unsigned index = d->ring_rd % d->cfg.ring_size;
+        unsigned tail = OSI_MIN(unsigned, bytes, d->cfg.ring_size - index);
+        memcpy(d->chunk, &d->ring[index], tail);
+        memcpy(d->chunk + tail, &d->ring[0], bytes - tail);
+        OSI_BARRIER();
+        d->ring_rd += bytes;
+
+        auFrame_t frame = d->format;
+        frame.data = (uintptr_t)d->chunk;
+        frame.bytes = bytes;
+        if (auEncoderEncode(d->encoder, &frame) < 0 && !d->stat.write_error)
+        {
+            OSI_LOGE(0, "audio rec pipeline encode failed");
+        }
+    }
+}
+
+/**
+ * Audio device put_frame, in audio thread. It never blocks.
+ */
+static bool prvPutFrame(void *param, const auFrame_t *frame)
+{
+    auRecPipeline_t *d = (auRecPipeline_t *)param;
+    if (frame->bytes == 0)
+        return true;
+
+    if (d->stat.captured_bytes == 0 && d->stat.dropped_bytes == 0)
+        auSampleFormatCopy(&d->format, frame);
+
+    unsigned rd = d->ring_rd;
+    unsigned used = d->ring_wr - rd;
+    if (frame->bytes > d->cfg.ring_size - used)
+    {
+        d->stat.dropped_bytes += frame->bytes;
+        d->stat.dropped_frames++;
+        return !d->stat.write_error;
+    }
+
+    unsigned index = d->ring_wr % d->cfg.ring_size;
+    unsigned tail = OSI_MIN(unsigned, frame->bytes, d->cfg.ring_size - index);
+    memcpy(&d->ring[index], (const void *)frame->data, tail);
+    memcpy(&d->ring[0], (const uint8_t *)frame->data + tail, frame->bytes - tail);
+    OSI_BARRIER();
+    d->ring_wr += frame->bytes;
+
+    d->stat.captured_bytes += frame->bytes;
+    d->stat.ring_peak_bytes = OSI_MAX(unsigned, d->stat.ring_peak_bytes, used + frame->bytes);
+    osiWorkEnqueue(d->encode_work, d->wq);
+    return !d->stat.write_error;
+}
+
+/**
+ * Audio device handle_event
+ */
+static void prvHandleEvent(void *param, audevRecordEvent_t event)
+{
+    auRecPipeline_t *d = (auRecPipeline_t *)param;
+    if (event == AUDEV_RECORD_EVENT_FINISH)
+        prvEvent(d);
+}
+
+static const audevRecordOps_t gRecPipelineOps = {
+    .put_frame = prvPutFrame,
+    .handle_event = prvHandleEvent,
+};
+
+auRecPipeline_t *auRecPipelineCreate(const auRecPipelineConfig_t *cfg)
+{
+    auRecPipelineConfig_t c = {};
+    if (cfg != NULL)
+        c = *cfg;
+    if (c.ring_size == 0)
+        c.ring_size = AURECPIPE_RING_SIZE;
+    if (c.block_size == 0)
+        c.block_size = AURECPIPE_BLOCK_SIZE;
+    if (c.block_count == 0)
+        c.block_count = AURECPIPE_BLOCK_COUNT;
+
+    auRecPipeline_t *d = (auRecPipeline_t *)calloc(1, sizeof(auRecPipeline_t));
+    if (d == NULL)
+        return NULL;
+
+    d->cfg = c;
+    d->fd = -1;
+    d->block_cur = -1;
+    d->writer.ops.destroy = prvWriterDelete;
+    d->writer.ops.write = prvWriterWrite;
+    d->writer.ops.seek = prvWriterSeek;
+    d->writer.owner = d;
+
+    d->ring = (uint8_t *)malloc(c.ring_size);
+    d->blocks = (uint8_t *)malloc(c.block_size * c.block_count);
+    d->block_sizes = (unsigned *)calloc(c.block_count, sizeof(unsigned));
+    d->wq = osiWorkQueueCreate("aurec", 1, AURECPIPE_WQ_PRIO, CONFIG_AUDIO_WQ_STACK_SIZE);
+    d->encode_work = osiWorkCreate(prvEncodeWork, NULL, d);
+    d->block_sema = osiSemaphoreCreate(c.block_count, c.block_count);
+    if (d->ring == NULL || d->blocks == NULL || d->block_sizes == NULL ||
+        d->wq == NULL || d->encode_work == NULL || d->block_sema == NULL)
+    {
+        auRecPipelineDelete(d);
+        return NULL;
+    }
+
+    OSI_LOGI(0, "audio rec pipeline create, ring/%d block/%d*%d",
+             c.ring_size, c.block_size, c.block_count);
+    return d;
+}
+
+void auRecPipelineDelete(auRecPipeline_t *d)
+{
+    if (d == NULL)
+        return;
+
+    auRecPipelineStop(d);
+    if (d->encode_work != NULL)
+        osiWorkDelete(d->encode_work);
+    if (d->wq != NULL)
+        osiWorkQueueDelete(d->wq);
+    if (d->block_sema != NULL)
+        osiSemaphoreDelete(d->block_sema);
+    free(d->block_sizes);
+    free(d->blocks);
+    free(d->ring);
+    free(d);
+}
+
+void auRecPipelineSetEventCallback(auRecPipeline_t *d, auRecPipelineEventCallback_t cb, void *cb_ctx)
+{
+    d->cb = cb;
+    d->cb_ctx = cb_ctx;
+}
+
+bool auRecPipelineStartFile(auRecPipeline_t *d, audevRecordType_t type, auStreamFormat_t format,
+                            const auEncoderParamSet_t *params, const char *fname)
+{
+    if (d == NULL || fname == NULL || d->started)
+        return false;
+
+    d->fd = vfs_open(fname, O_RDWR | O_CREAT | O_TRUNC);
+    if (d->fd < 0)
+        return false;
+
+    d->encoder = auEncoderCreate((auWriter_t *)&d->writer, format);
+    if (d->encoder == NULL)
+        goto failed;
+
+    if (params != NULL && !auEncoderSetMultiParams(d->encoder, params))
+        goto failed;
+
+    memset(&d->stat, 0, sizeof(d->stat));
+    d->ring_wr = 0;
+    d->ring_rd = 0;
+    d->block_cur = -1;
+    d->block_next = 0;
+    d->block_done = 0;
+    auInitSampleFormat(&d->format);
+
+    d->started = true;
+    if (!audevStartRecord(type, &gRecPipelineOps, d))
+    {
+        d->started = false;
+        goto failed;
+    }
+
+    OSI_LOGI(0, "audio rec pipeline start, type/%d format/%d", type, format);
+    return true;
+
+failed:
+    OSI_LOGE(0, "audio rec pipeline start failed");
+    auEncoderDelete(d->encoder);
+    d->encoder = NULL;
+    vfs_close(d->fd);
+    d->fd = -1;
+    return false;
+}
+
+bool auRecPipelineStop(auRecPipeline_t *d)
+{
+    if (d == NULL || !d->started)
+        return true;
+
+    audevStopRecord();
+
+    // drain PCM in ring buffer
+    while (d->ring_rd != d->ring_wr)
+    {
+        osiWorkEnqueue(d->encode_work, d->wq);
+        osiWorkWaitFinish(d->encode_work, OSI_WAIT_FOREVER);
+    }
+
+    // encoder may update header at delete
+    auEncoderDelete(d->encoder);
+    d->encoder = NULL;
+    prvBlockFlush(d);
+    vfs_close(d->fd);
+    d->fd = -1;
+    d->started = false;
+
+    OSI_LOGI(0, "audio rec pipeline stop, captured/%d dropped/%d/%d peak/%d written/%d stalls/%d",
+             d->stat.captured_bytes, d->stat.dropped_frames, d->stat.dropped_bytes,
+             d->stat.ring_peak_bytes, d->stat.written_bytes, d->stat.write_stalls);
+    return !d->stat.write_error;
+}
+
+void auRecPipelineGetStat(auRecPipeline_t *d, auRecPipelineStat_t *stat)
+{
+    if (d == NULL || stat == NULL)
+        return;
+
+    *stat = d->stat;
+}
@@ -12,6 +12,7 @@
 
 #include "audio_writer.h"
 #include "vfs.h"
+#include "vfs_aio.h"
 #include "osi_pipe.h"
 #include "osi_log.h"
 #include <stdlib.h>
@@ -46,10 +47,13 @@ int auWriterSeek(auWriter_t *d, int offset, int whence)
 /**
  * File writer
  */
+#define AU_FILE_WRITER_BUF_SIZE (4096)
+
 struct auFileWriter
 {
     auWriterOps_t ops;
     int fd;
+    vfs_aio_stream_t *stream; // NULL for synchronous write
 };
 
 static void prvFileWriterDelete(auWriter_t *d)
@@ -59,6 +63,7 @@ static void prvFileWriterDelete(auWriter_t *d)
         return;
 
     OSI_LOGI(0, "audio file writer deleted");
+    vfs_aio_stream_delete(p->stream);
     vfs_close(p->fd);
     free(p);
 }
@@ -66,12 +71,16 @@ static void prvFileWriterDelete(auWriter_t *d)
 static int prvFileWriterWrite(auWriter_t *d, const void *buf, unsigned size)
 {
     auFileWriter_t *p = (auFileWriter_t *)d;
+    if (p->stream != NULL)
+        return vfs_aio_stream_write(p->stream, buf, size);
     return vfs_write(p->fd, buf, size);
 }
 
 static int prvFileWriterSeek(auWriter_t *d, int offset, int whence)
 {
     auFileWriter_t *p = (auFileWriter_t *)d;
+    if (p->stream != NULL && vfs_aio_stream_flush(p->stream) < 0)
+        return -1;
     return vfs_lseek(p->fd, offset, whence);
 }
 
@@ -85,12 +94,18 @@ auFileWriter_t *auFileWriterCreate(const char *fname)
 
     auFileWriter_t *d = (auFileWriter_t *)calloc(1, sizeof(auFileWriter_t));
     if (d == NULL)
+    {
+        vfs_close(fd);
         return NULL;
+    }
 
     d->ops.destroy = prvFileWriterDelete;
     d->ops.write = prvFileWriterWrite;
     d->ops.seek = prvFileWriterSeek;
     d->fd = fd;
+
+    // it is fine to write synchronously when out of memory
+    d->stream = vfs_aio_stream_create(fd, AU_FILE_WRITER_BUF_SIZE);
     return d;
 }
 
@@ -32,6 +32,14 @@ struct aworker_request
 };
 
 bool aworker_start();
+/**
+*   bind handler to worker thread, requests with the handler will run on it.
+*   worker should be less than CONFIG_AWORKER_THREAD_COUNT, and handlers
+*   without affinity run on worker 0. It is suggested to bind slow
+*   handlers (such as file I/O) to other workers, and not to block
+*   latency sensitive handlers.
+*/
+bool aworker_set_affinity(AWORKER_HANDLER handler, uint8_t worker);
 bool aworker_timer_callback(osiCallback_t tm_cb, uint32_t delay_ms, void *arg);
 bool aworker_task_callback(osiCallback_t tcb, void *arg);
 bool aworker_post_req_delay(AWORKER_REQ *req, uint32_t delay_ms, bool *result);
@@ -1,5 +1,6 @@
 #include "osi_log.h"
 #include "async_worker.h"
+#include "aworker_config.h"
 #include "string.h"
 #include "stdio.h"
 
@@ -17,24 +18,50 @@ typedef enum aworker_task_state
     AWTS_STARTED,
 } AWORKER_STATE;
 
+#ifndef CONFIG_AWORKER_THREAD_COUNT
+#define CONFIG_AWORKER_THREAD_COUNT 1
+#endif
+
+#ifndef CONFIG_AWORKER_POOL_COUNT
+#define CONFIG_AWORKER_POOL_COUNT 16
+#endif
+
+// maximum parameters of one request
+#define AWORKER_PARAM_MAX 16
+// parameters are stored in request at first, and heap buffer is only
+// allocated when they can't be held
+#define AWORKER_INLINE_BUFFER_LEN 64
+#define AWORKER_AFFINITY_COUNT 8
+
+typedef struct aworker_affinity
+{
+    AWORKER_HANDLER handler;
+    uint8_t worker;
+} AWORKER_AFFINITY;
+
 typedef struct aworker_ctx
 {
-    osiThread_t *tid;
+    osiThread_t *tid; // worker 0
+    osiThread_t *tids[CONFIG_AWORKER_THREAD_COUNT];
     bool runnable;
     uint8_t state;
     osiTimer_t *timerID;
-    osiTimer_t *postDelayTimerID;
+    uint32_t pool_free; // bit mask of free pool requests
+    AWORKER_AFFINITY affinity[AWORKER_AFFINITY_COUNT];
 } AWORKER_CTX;
 
 typedef struct aworker_req_int
 {
     AWORKER_REQ req;
+    osiTimer_t *timer; // delay timer
     uint8_t *buffer;
-    uint32_t buffer_len;
+    uint32_t buffer_len;   // current buffer size
+    uint32_t buffer_limit; // buffer size requested at create
     uint32_t buffer_used;
-    uint16_t param_count;
-    uint8_t last_index;
-    uint8_t *last_ptr;
+    uint8_t param_count;
+    bool pooled;
+    uint16_t offsets[AWORKER_PARAM_MAX]; // parameter offsets in buffer
+    uint32_t inline_buffer[AWORKER_INLINE_BUFFER_LEN / 4];
 } AWORKER_REQ_INT;
 
 typedef enum aworker_param_type
@@ -67,11 +94,17 @@ typedef struct aworker_param_format
 #define AWORKER_PRIORITY (OSI_PRIORITY_BELOW_NORMAL)
 #define AWORKER_EVENT_QUEUE_SIZE (32)
 
+#if CONFIG_AWORKER_POOL_COUNT > 32
+#error "aworker pool count shall be no more than 32"
+#endif
+
 static AWORKER_CTX s_aworker_ctx = {0};
+static AWORKER_REQ_INT s_aworker_pool[CONFIG_AWORKER_POOL_COUNT];
 
 static void aworker_init()
 {
     memset(&s_aworker_ctx, 0, sizeof(AWORKER_CTX));
+    s_aworker_ctx.pool_free = (CONFIG_AWORKER_POOL_COUNT == 32) ? 0xffffffff : ((1u << CONFIG_AWORKER_POOL_COUNT) - 1);
 }
 
 static void aworker_deinit()
@@ -80,9 +113,104 @@ static void aworker_deinit()
     s_aworker_ctx.state = AWTS_STOPPED;
 }
 
+static AWORKER_REQ_INT *aworker_alloc_request(void)
+{
+    AWORKER_REQ_INT *req = NULL;
+    uint32_t critical = osiEnterCritical();
+    if (s_aworker_ctx.pool_free != 0)
+    {
+        unsigned index = __builtin_ctz(s_aworker_ctx.pool_free);
+        s_aworker_ctx.pool_free &= ~(1u << index);
+        req = &s_aworker_pool[index];
+    }
+    osiExitCritical(critical);
+
+    if (req != NULL)
+    {
+        memset(req, 0, OSI_OFFSETOF(AWORKER_REQ_INT, inline_buffer));
+        req->pooled = true;
+        return req;
+    }
+
+    // fallback to heap when pool is exhausted
+    req = (AWORKER_REQ_INT *)malloc(sizeof(AWORKER_REQ_INT));
+    if (req != NULL)
+        memset(req, 0, OSI_OFFSETOF(AWORKER_REQ_INT, inline_buffer));
+    return req;
+}
+
 void aworker_dismiss_request(AWORKER_REQ *req)
 {
-    free(req);
+    AWORKER_REQ_INT *req_int = (AWORKER_REQ_INT *)req;
+    if (req_int == NULL)
+    {
+        return;
+    }
+    if (req_int->timer != NULL)
+    {
+        osiTimerDelete(req_int->timer);
+    }
+    if (req_int->buffer != (uint8_t *)req_int->inline_buffer)
+    {
+        free(req_int->buffer);
+    }
+    if (req_int->pooled)
+    {
+        unsigned index = req_int - s_aworker_pool;
+        uint32_t critical = osiEnterCritical();
+        s_aworker_ctx.pool_free |= (1u << index);
+        osiExitCritical(critical);
+    }
+    else
+    {
+        free(req_int);
+    }
+}
+
+static osiThread_t *aworker_get_thread(AWORKER_HANDLER handler)
+{
+    for (unsigned n = 0; n < AWORKER_AFFINITY_COUNT; n++)
+    {
+        if (handler != NULL && s_aworker_ctx.affinity[n].handler == handler)
+            return s_aworker_ctx.tids[s_aworker_ctx.affinity[n].worker];
+    }
+    return s_aworker_ctx.tids[0];
+}
+
+bool aworker_set_affinity(AWORKER_HANDLER handler, uint8_t worker)
+{
+    AWORKER_AFFINITY *empty = NULL;
+    bool ret = false;
+    if (handler == NULL || worker >= CONFIG_AWORKER_THREAD_COUNT)
+    {
+        AWORKLOG("aworker_set_affinity invalid worker:%d", worker);
+        return false;
+    }
+
+    uint32_t critical = osiEnterCritical();
+    for (unsigned n = 0; n < AWORKER_AFFINITY_COUNT; n++)
+    {
+        AWORKER_AFFINITY *aff = &s_aworker_ctx.affinity[n];
+        if (aff->handler == handler)
+        {
+            aff->worker = worker;
+            ret = true;
+            break;
+        }
+        if (aff->handler == NULL && empty == NULL)
+            empty = aff;
+    }
+    if (!ret && empty != NULL)
+    {
+        empty->handler = handler;
+        empty->worker = worker;
+        ret = true;
+    }
+    osiExitCritical(critical);
+
+    if (!ret)
+        AWORKLOG("aworker_set_affinity no room for handler");
+    return ret;
 }
 
 static void aworker_handle_request(AWORKER_REQ *req)
@@ -184,19 +312,20 @@ bool aworker_post_req_delay(AWORKER_REQ *req, uint32_t delay_ms, bool *result)
         ret = false;
         goto out;
     }
-    if (delay_ms > 0)
+    osiThread_t *worker = aworker_get_thread(req != NULL ? req->handler : NULL);
+    if (delay_ms > 0 && req != NULL)
     {
-        if (s_aworker_ctx.postDelayTimerID != 0)
+        // each request has its own timer, deleted at dismiss
+        AWORKER_REQ_INT *req_int = (AWORKER_REQ_INT *)req;
+        if (req_int->timer == NULL)
         {
-            osiTimerStop(s_aworker_ctx.postDelayTimerID);
-            osiTimerDelete(s_aworker_ctx.postDelayTimerID);
+            req_int->timer = osiTimerCreate(worker, aworker_dispatch_request, (void *)req);
         }
-        s_aworker_ctx.postDelayTimerID = osiTimerCreate(s_aworker_ctx.tid, aworker_dispatch_request, (void *)req);
-        ret = osiTimerStart(s_aworker_ctx.postDelayTimerID, delay_ms);
+        ret = (req_int->timer != NULL) && osiTimerStart(req_int->timer, delay_ms);
     }
     else
     {
-        ret = osiThreadCallback(s_aworker_ctx.tid, aworker_dispatch_request, (void *)req);
+        ret = osiThreadCallback(worker, aworker_dispatch_request, (void *)req);
     }
 out:
     if (!ret)
@@ -213,14 +342,13 @@ out:
 
 bool aworker_post_handler(AWORKER_HANDLER handler, void *param, uint32_t delay_ms)
 {
-    AWORKER_REQ *req = (AWORKER_REQ *)malloc(sizeof(AWORKER_REQ));
+    AWORKER_REQ *req = (AWORKER_REQ *)aworker_alloc_request();
     bool ret = true;
     if (req == NULL)
     {
         AWORKLOG("aworker_post_handler malloc for req fail");
         return false;
     }
-    memset(req, 0, sizeof(AWORKER_REQ));
     req->handler = handler;
     req->param = param;
     return aworker_post_req_delay(req, delay_ms, &ret);
@@ -229,10 +357,8 @@ bool aworker_post_handler(AWORKER_HANDLER handler, void *param, uint32_t delay_m
 static void aworker_task_main(void *arg)
 {
     osiEvent_t event;
+    osiThread_t *tid = osiThreadCurrent();
     AWORKLOG("Enter aworker_task_main...");
-    s_aworker_ctx.runnable = true;
-    s_aworker_ctx.state = AWTS_STARTED;
-    s_aworker_ctx.tid = osiThreadCurrent();
     while (true)
     {
         if (!s_aworker_ctx.runnable)
@@ -240,7 +366,7 @@ static void aworker_task_main(void *arg)
             AWORKLOG("aworker_task_main exit message loop");
             break;
         }
-        if (osiEventWait(s_aworker_ctx.tid, &event) == true)
+        if (osiEventWait(tid, &event) == true)
         {
             AWORKLOG("aworker_dispatch_event...");
             aworker_dispatch_event(&event);
@@ -281,30 +407,49 @@ AWORKER_REQ *aworker_create_request(osiThread_t *sender, AWORKER_HANDLER handler
     {
         bufflen = AWORKER_DEF_BUFFER_LEN;
     }
-    req = (AWORKER_REQ_INT *)malloc(sizeof(AWORKER_REQ_INT) + bufflen);
+    req = aworker_alloc_request();
     if (req == NULL)
     {
         AWORKLOG("aworker_create_request Malloc REQ fail");
         return NULL;
     }
-    memset(req, 0, sizeof(AWORKER_REQ_INT));
     req->req.sender = sender;
     req->req.handler = handler;
     req->req.callback = callback;
     req->req.event = event;
     req->req.param = param;
-    req->buffer_len = bufflen;
-    req->buffer = (uint8_t *)(req + 1);
+    req->buffer_limit = bufflen;
+    req->buffer_len = OSI_MIN(uint32_t, bufflen, AWORKER_INLINE_BUFFER_LEN);
+    req->buffer = (uint8_t *)req->inline_buffer;
     return (AWORKER_REQ *)req;
 }
 
 static inline bool aworker_buffer_is_enough(AWORKER_REQ_INT *req, uint32_t len)
 {
-    if (req->buffer_used < req->buffer_len && req->buffer_len - req->buffer_used >= len)
+    if (req->param_count >= AWORKER_PARAM_MAX)
+    {
+        AWORKLOG("aworker too many parameters");
+        return false;
+    }
+    if (req->buffer_used <= req->buffer_len && req->buffer_len - req->buffer_used >= len)
     {
         return true;
     }
-    return false;
+    if (req->buffer_used > req->buffer_limit || req->buffer_limit - req->buffer_used < len)
+    {
+        return false;
+    }
+
+    // move from inline buffer to heap buffer of requested size
+    uint8_t *buffer = (uint8_t *)malloc(req->buffer_limit);
+    if (buffer == NULL)
+    {
+        return false;
+    }
+    memcpy(buffer, req->buffer, req->buffer_used);
+    req->buffer = buffer;
+    req->buffer_len = req->buffer_limit;
+    return true;
 }
 
 static inline void *aworker_align_address(void *address)
@@ -323,6 +468,13 @@ static inline void aworker_append_buffer(AWORKER_REQ_INT *req, void *buffer, uin
     next_start = aworker_align_address(curr_ptr + len);
     req->buffer_used += next_start - curr_ptr;
 }
+
+static inline void aworker_append_param(AWORKER_REQ_INT *req, AWORKER_PARAM_FORMAT *format, void *buffer)
+{
+    req->offsets[req->param_count++] = req->buffer_used;
+    aworker_append_buffer(req, format, sizeof(AWORKER_PARAM_FORMAT));
+    aworker_append_buffer(req, buffer, format->len);
+}
 void aworker_param_putu32(AWORKER_REQ *req, uint32_t val, bool *result)
 {
     AWORKER_REQ_INT *req_int = (AWORKER_REQ_INT *)req;
@@ -336,9 +488,7 @@ void aworker_param_putu32(AWORKER_REQ *req, uint32_t val, bool *result)
     {
         format.type = AWPT_UINT32;
         format.len = len;
-        aworker_append_buffer(req_int, &format, sizeof(format));
-        aworker_append_buffer(req_int, &val, format.len);
-        req_int->param_count++;
+        aworker_append_param(req_int, &format, &val);
         *result = true;
     }
     else
@@ -360,9 +510,7 @@ void aworker_param_putbytes(AWORKER_REQ *req, uint8_t *barray, uint16_t len, boo
     {
         format.type = AWPT_BYTES;
         format.len = len;
-        aworker_append_buffer(req_int, &format, sizeof(format));
-        aworker_append_buffer(req_int, barray, format.len);
-        req_int->param_count++;
+        aworker_append_param(req_int, &format, barray);
         *result = true;
     }
     else
@@ -385,9 +533,7 @@ void aworker_param_putstr(AWORKER_REQ *req, char *str, bool *result)
     {
         format.type = AWPT_STRING;
         format.len = len;
-        aworker_append_buffer(req_int, &format, sizeof(format));
-        aworker_append_buffer(req_int, str, format.len);
-        req_int->param_count++;
+        aworker_append_param(req_int, &format, str);
         *result = true;
     }
     else
@@ -399,34 +545,12 @@ void aworker_param_putstr(AWORKER_REQ *req, char *str, bool *result)
 
 static uint8_t *aworker_get_param_ptr(AWORKER_REQ_INT *req, uint8_t index)
 {
-    uint8_t *ptr = req->buffer;
-    uint8_t i = 0;
-    AWORKER_PARAM_FORMAT *format;
-    if (index > req->param_count - 1)
+    if (index >= req->param_count)
     {
         return NULL;
     }
-    if (req->last_index <= index && req->last_ptr)
-    {
-        i = req->last_index;
-        ptr = req->last_ptr;
-    }
-    AWORKDBG("aworker_get_param_ptr index:%d i:%d ptr:%x buffer:%x, bufflen:%d", index, i, ptr, req->buffer, req->buffer_len);
-    while (i < index && ptr < req->buffer + req->buffer_len)
-    {
-        format = (AWORKER_PARAM_FORMAT *)ptr;
-        ptr += sizeof(AWORKER_PARAM_FORMAT) + format->len;
-        ptr = aworker_align_address(ptr);
-        i++;
-    }
-    AWORKDBG("aworker_get_param_ptr after found i:%d ptr:%x", i, ptr);
-    if (i == index && ptr < req->buffer + req->buffer_len)
-    {
-        req->last_index = index;
-        req->last_ptr = ptr;
-        return ptr;
-    }
-    return NULL;
+    AWORKDBG("aworker_get_param_ptr index:%d offset:%d", index, req->offsets[index]);
+    return req->buffer + req->offsets[index];
 }
 
 uint32_t aworker_param_getu32(AWORKER_REQ *req, uint8_t index, bool *result)
@@ -562,12 +686,24 @@ bool aworker_task_callback(osiCallback_t tcb, void *arg)
 bool aworker_start()
 {
     aworker_init();
-    s_aworker_ctx.tid = osiThreadCreate("[Async Worker]",
-                                        aworker_task_main,
-                                        NULL,
-                                        AWORKER_PRIORITY,
-                                        AWORKER_STACK_SIZE,
-                                        AWORKER_EVENT_QUEUE_SIZE);
+    s_aworker_ctx.runnable = true;
+    for (unsigned n = 0; n < CONFIG_AWORKER_THREAD_COUNT; n++)
+    {
+        static const char *names[] = {"[Async Worker]", "[Async Worker1]", "[Async Worker2]", "[Async Worker3]"};
+        s_aworker_ctx.tids[n] = osiThreadCreate(names[OSI_MIN(unsigned, n, OSI_ARRAY_SIZE(names) - 1)],
+                                                aworker_task_main,
+                                                NULL,
+                                                AWORKER_PRIORITY,
+                                                AWORKER_STACK_SIZE,
+                                                AWORKER_EVENT_QUEUE_SIZE);
+        if (s_aworker_ctx.tids[n] == NULL)
+        {
+            AWORKLOG("aworker_start create worker %d fail", n);
+            return false;
+        }
+    }
+    s_aworker_ctx.tid = s_aworker_ctx.tids[0];
+    s_aworker_ctx.state = AWTS_STARTED;
     return true;
 }
 
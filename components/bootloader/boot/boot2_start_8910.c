@@ -32,6 +32,7 @@
 #include "boot_pdl.h"
 #include "hal_adi_bus.h"
 #include "hal_spi_flash.h"
+#include "hal_lzma.h"
 #include "flash_block_device.h"
 #include "fupdate.h"
 #include "fs_mount.h"
@@ -119,6 +120,52 @@ static const image_header_t *prvAppUimageHeader(void)
     return (const image_header_t *)CONFIG_APP_FLASH_ADDRESS;
 }
 
+/**
+ * Decompress application image to its load address, when the uimage
+ * data is LZMA block stream. The block streams are read from flash into
+ * 2 staging buffers, overlapped with hardware decompress.
+ */
+static bool prvAppUimageDecompress(const image_header_t *header)
+{
+    if (header->ih_comp == IH_COMP_NONE)
+        return true;
+    if (header->ih_comp != IH_COMP_LZMA)
+        return false;
+
+    const void *stream = (const void *)&header[1];
+    void *dest = (void *)__ntohl(header->ih_load);
+    int data_size = halLzmaDataSize(stream);
+    int block_max = halLzmaMaxBlockStreamSize(stream, __ntohl(header->ih_size));
+    if (data_size <= 0 || block_max <= 0)
+        return false;
+
+    // Prefer internal RAM, external RAM is only used when it won't be
+    // overwritten by the decompressed image.
+    unsigned buf_size = OSI_ALIGN_UP(block_max, 8) * 2;
+    void *buf = bootIramMalloc(buf_size + 8);
+    if (buf == NULL)
+    {
+        buf = bootExtRamMalloc(buf_size + 8);
+        if (buf != NULL && (uintptr_t)buf < (uintptr_t)dest + data_size + 32 &&
+            (uintptr_t)buf + buf_size + 8 > (uintptr_t)dest)
+        {
+            bootFree(buf);
+            buf = NULL;
+        }
+    }
+    if (buf == NULL)
+        return false;
+
+    osiElapsedTimer_t elapsed;
+    osiElapsedTimerStart(&elapsed);
+    int size = halLzmaDecompressFileStaged(stream, dest, (void *)OSI_ALIGN_UP((uintptr_t)buf, 8), buf_size);
+    bootFree(buf);
+
+    OSI_LOGI(0, "app image decompressed %d/%d, %d ms", size, data_size,
+             (int)osiElapsedTime(&elapsed));
+    return size == data_size;
+}
+
 static void prvSetFlashWriteProhibit(void)
 {
     // ATTENTION: This will set write prohibit for bootloader
@@ -310,6 +357,12 @@ void bootStart(uint32_t param)
 
     if (__ntohl(header->ih_magic) == IH_MAGIC && bootSecureUimageSigCheck((void *)header))
     {
+        if (!prvAppUimageDecompress(header))
+        {
+            OSI_LOGE(0, "BOOT fail, app image decompress failed");
+            osiPanic();
+        }
+
 #ifdef CONFIG_BOOT_TIMER_IRQ_ENABLE
         bootDisableTimer();
         bootDisableInterrupt();
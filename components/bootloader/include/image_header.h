@@ -22,6 +22,9 @@
 #define IH_MAGIC 0x27051956 /* Image Magic Number */
 #define IH_NMLEN 32         /* Image Name Length */
 
+#define IH_COMP_NONE 0 /* No Compression Used */
+#define IH_COMP_LZMA 3 /* LZMA block stream, decompressed to ih_load */
+
 typedef struct image_header
 {
     uint32_t ih_magic;         /* Image Header Magic Number */
@@ -375,6 +375,11 @@ int bootVfsSfileWrite(const char *path, const void *data, size_t size)
     CHECK_RESULT_RETURN(res);
 }
 
+int bootVfsSfileFlush(const char *path)
+{
+    return 0;
+}
+
 int bootVfsMkPath(const char *path, mode_t mode)
 {
     bootFileInfo_t fi = _getFileByPath(path);
@@ -548,6 +553,8 @@ OSI_DECL_STRONG_ALIAS(bootVfsFileRead, int vfs_sfile_read(const char *path, void
 OSI_DECL_STRONG_ALIAS(bootVfsFileWrite, int vfs_file_write(const char *path, const void *data, size_t size));
 OSI_DECL_STRONG_ALIAS(bootVfsSfileInit, int vfs_sfile_init(const char *path));
 OSI_DECL_STRONG_ALIAS(bootVfsSfileWrite, int vfs_sfile_write(const char *path, const void *data, size_t size));
+OSI_DECL_STRONG_ALIAS(bootVfsSfileWrite, int vfs_sfile_write_behind(const char *path, const void *data, size_t size));
+OSI_DECL_STRONG_ALIAS(bootVfsSfileFlush, int vfs_sfile_flush(const char *path));
 OSI_DECL_STRONG_ALIAS(bootVfsMkPath, int vfs_mkpath(const char *path, mode_t mode));
 OSI_DECL_STRONG_ALIAS(bootVfsMkFilePath, int vfs_mkfilepath(const char *path, mode_t mode));
 OSI_DECL_STRONG_ALIAS(bootVfsRmChildren, int vfs_rmchildren(const char *path));
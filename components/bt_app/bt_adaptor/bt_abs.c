@@ -1495,6 +1495,71 @@ bt_status_t ble_connect_para_update(gatt_connect_param_t* param)
     return BT_FAIL;
 }
 
+/**
+* @brief   Request ATT MTU exchange
+* @details This function is to request a larger ATT MTU on the connection,the result will be
+*    reported by mtu_exchange_result_cb,if the bt_gatt_server_interface has not been
+*    registered before,this function will return BT_FAIL
+* @param [in] acl_handle The acl handle of the connection
+* @param [in] mtu_size The requested ATT MTU
+* @return The status of ble_mtu_exchange_req
+* @retval BT_SUCCESS It means the request has been sent
+* @retval BT_FAIL The bt_gatt_server_interface has not been registered before
+*/
+bt_status_t ble_mtu_exchange_req(uint16 acl_handle, uint16 mtu_size)
+{
+    if(bt_gatt_server_interface != NULL)
+    {
+        return bt_gatt_server_interface->exchange_mtu_req(acl_handle, mtu_size);
+    }
+    return BT_FAIL;
+}
+
+/**
+* @brief   Set LE data length
+* @details This function is to enable LE data length extension on the connection,the result
+*    will be reported by le_data_length_result_cb,if the bt_gatt_server_interface has not
+*    been registered before,this function will return BT_FAIL
+* @param [in] acl_handle The acl handle of the connection
+* @param [in] tx_octets The preferred maximum payload octets of link layer packet, 27~251
+* @param [in] tx_time The preferred maximum transmission time in microseconds, 328~17040
+* @return The status of ble_data_length_set
+* @retval BT_SUCCESS It means the request has been sent
+* @retval BT_FAIL The bt_gatt_server_interface has not been registered before
+*/
+bt_status_t ble_data_length_set(uint16 acl_handle, uint16 tx_octets, uint16 tx_time)
+{
+    if(bt_gatt_server_interface != NULL)
+    {
+        return bt_gatt_server_interface->set_le_data_length(acl_handle, tx_octets, tx_time);
+    }
+    return BT_FAIL;
+}
+
+/**
+* @brief   Set LE PHY
+* @details This function is to request the PHY of the connection,the result will be reported
+*    by le_phy_update_result_cb. The controller may keep the current PHY when the requested
+*    PHY is not supported by either side,if the bt_gatt_server_interface has not been
+*    registered before,this function will return BT_FAIL
+* @param [in] acl_handle The acl handle of the connection
+* @param [in] all_phys Bit 0:no tx preference, bit 1:no rx preference
+* @param [in] tx_phys Bit 0:LE 1M, bit 1:LE 2M, bit 2:LE coded
+* @param [in] rx_phys Bit 0:LE 1M, bit 1:LE 2M, bit 2:LE coded
+* @param [in] phy_options The preferred coding for LE coded PHY
+* @return The status of ble_phy_set
+* @retval BT_SUCCESS It means the request has been sent
+* @retval BT_FAIL The bt_gatt_server_interface has not been registered before
+*/
+bt_status_t ble_phy_set(uint16 acl_handle, uint8 all_phys, uint8 tx_phys, uint8 rx_phys, uint16 phy_options)
+{
+    if(bt_gatt_server_interface != NULL)
+    {
+        return bt_gatt_server_interface->set_le_phy(acl_handle, all_phys, tx_phys, rx_phys, phy_options);
+    }
+    return BT_FAIL;
+}
+
 /**
 * @brief   Ble send notification to another address
 * @details This function is to send notification by ble,if the bt_gatt_server_interface has
@@ -17,4 +17,58 @@ void Gatt_server_demo_function(void);
 void bt_8910_ble_SendTpData(uint16 datalen, uint8 *data);
 void example_ble_server_info_get(btgatt_server_callbacks_t **p_server_callbacks);
 
+/* throughput profile, 0 for default of each field */
+typedef struct
+{
+    UINT16 mtu;          /* ATT MTU, 247 by default */
+    UINT16 tx_octets;    /* LE data length, 251 by default */
+    UINT16 tx_time;      /* LE data length time in us, 2120 by default */
+    UINT8 phy;           /* bit mask of preferred PHY, LE 2M by default */
+    UINT16 interval_min; /* connection interval in 1.25ms, 12 by default */
+    UINT16 interval_max; /* connection interval in 1.25ms, 24 by default */
+} bt_8910_ble_tp_profile_t;
+
+typedef struct
+{
+    UINT32 bytes;       /* payload bytes sent since start */
+    UINT32 elapsed_ms;  /* time since start */
+    UINT32 bytes_per_s; /* throughput of last report period */
+    UINT16 mtu;
+    UINT16 tx_octets;
+    UINT8 tx_phy;
+    UINT16 interval; /* connection interval in 1.25ms */
+} bt_8910_ble_tp_report_t;
+
+typedef void (*bt_8910_ble_tp_report_cb_t)(const bt_8910_ble_tp_report_t *report);
+
+/*
+ * enter throughput mode on current connection
+ *
+ * Larger ATT MTU, LE data length extension, 2M PHY and shorter
+ * connection interval are requested. Each one may be rejected by
+ * controller or peer, and the negotiated values are in report.
+ * The report callback is called about every second during sending,
+ * and at stop.
+ */
+bt_status_t bt_8910_ble_tp_start(const bt_8910_ble_tp_profile_t *profile, bt_8910_ble_tp_report_cb_t cb);
+
+/* leave throughput mode, queued data are discarded */
+void bt_8910_ble_tp_stop(void);
+
+/*
+ * queue data to be sent by notification of feedback char
+ *
+ * Data are split into (mtu - 3) bytes notifications, and sent until
+ * controller buffers are full, so there are multiple notifications in
+ * one connection event. Return queued bytes, which may be less than
+ * datalen when the queue is full.
+ */
+UINT32 bt_8910_ble_tp_send(const UINT8 *data, UINT32 datalen);
+
+/* negotiation results, called by btgatt_callback_t */
+void bt_8910_ble_tp_mtu_changed(UINT16 handle, UINT16 mtu);
+void bt_8910_ble_tp_data_length_changed(UINT16 handle, UINT16 max_tx_octets);
+void bt_8910_ble_tp_phy_changed(UINT16 handle, UINT8 status, UINT8 tx_phy);
+void bt_8910_ble_tp_conn_param_changed(UINT8 status, gatt_connect_param_t *param);
+
 #endif
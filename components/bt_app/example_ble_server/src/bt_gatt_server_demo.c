@@ -20,6 +20,8 @@
 #include "bt_app.h"
 #include "bt_gatt_server_demo.h"
 #include "ddb.h"
+#include "osi_api.h"
+#include "osi_fifo.h"
 
 
 #define BT_8910_TP_UUID 0x18FE
@@ -78,6 +80,36 @@ UINT8 bt_8910_feedback_write_cb(void *param);
 
 gatt_le_data_info_t notify_data;
 
+#define BT_8910_TP_QUEUE_SIZE (8 * 1024) //power of 2
+#define BT_8910_TP_REPORT_PERIOD (1000)
+#define BT_8910_TP_ATT_HDR_LEN (3)
+#define BT_8910_TP_DEFAULT_MTU (23)
+#define BT_8910_TP_MAX_MTU (247)
+#define BT_8910_TP_PHY_2M (0x02)
+
+typedef struct
+{
+    BOOL enabled;
+    BOOL busy;
+    UINT16 mtu;
+    UINT16 tx_octets;
+    UINT8 tx_phy;
+    UINT16 interval;
+    bt_8910_ble_tp_report_cb_t cb;
+    osiFifo_t fifo;
+    UINT32 bytes;
+    UINT32 period_bytes;
+    int64_t start_time;
+    int64_t period_time;
+} bt_8910_ble_tp_t;
+
+static BOOL bt_8910_ble_connected = FALSE;
+static bt_8910_ble_tp_t bt_8910_ble_tp;
+static UINT8 bt_8910_ble_tp_queue[BT_8910_TP_QUEUE_SIZE];
+static UINT8 bt_8910_ble_tp_frame[BT_8910_TP_MAX_MTU - BT_8910_TP_ATT_HDR_LEN];
+
+static void bt_8910_ble_tp_pump(void);
+
 static gatt_element_t bt_8910_ble_service[] =
     {
         //primary service declaration
@@ -189,9 +221,15 @@ bt_status_t app_gatt_connection_callback(int conn_id, int connected, bdaddr_t *a
     OSI_LOGI(0, "[BLE_server]app_gatt_connection_callback conn_id:%d connected:%d", conn_id, connected);
 
     notify_data.acl_handle = conn_id;
+    bt_8910_ble_connected = (TRUE == connected);
 
     if (TRUE == connected)
     {
+        //values before negotiation
+        bt_8910_ble_tp.mtu = BT_8910_TP_DEFAULT_MTU;
+        bt_8910_ble_tp.tx_octets = 27;
+        bt_8910_ble_tp.tx_phy = 1;
+        bt_8910_ble_tp.interval = 0;
         //set_bt_protocol_state(BT_GATT_POS, BT_PROTOCOL_CONNECTED);
         if (gatt_client_role == FALSE)
         {
@@ -204,6 +242,7 @@ bt_status_t app_gatt_connection_callback(int conn_id, int connected, bdaddr_t *a
     }
     else
     {
+        bt_8910_ble_tp_stop();
         if (gatt_client_role == FALSE)
         {
         /*it's only for encrypted adv(ownaddrtype is 2 or 3, peer_addr_type and peer_addr are valid value).
@@ -238,14 +277,17 @@ bt_status_t app_gatt_connection_callback(int conn_id, int connected, bdaddr_t *a
 
 bt_status_t app_gatt_notification_send_cb(UINT16 length)
 {
-    OSI_LOGI(0, "[BLE_server]app_gatt_notification_send_cb length:%d", length);
+    OSI_LOGD(0, "[BLE_server]app_gatt_notification_send_cb length:%d", length);
 
+    bt_8910_ble_tp_pump();
     return BT_SUCCESS;
 }
 
 void app_gatt_packets_complete_cb(UINT8 current_buffer_num, UINT8 complete_buffer_num)
 {
     //printf("\n sum_num: %d,complete_num:%d\n", current_buffer_num,complete_buffer_num);
+    //controller buffers are freed, continue the queued notifications
+    bt_8910_ble_tp_pump();
 }
 
 #if BLE_SMP_SUPPORT
@@ -523,3 +565,193 @@ void bt_8910_ble_Send_Indication(uint16 datalen, uint8 *data)
 
     ble_send_indication(&le_data_info);
 }
+
+static void bt_8910_ble_tp_report(BOOL final)
+{
+    bt_8910_ble_tp_t *tp = &bt_8910_ble_tp;
+    bt_8910_ble_tp_report_t report;
+    int64_t now = osiUpTime();
+    int64_t period = now - tp->period_time;
+
+    if (tp->cb == NULL || (!final && period < BT_8910_TP_REPORT_PERIOD))
+        return;
+
+    report.bytes = tp->bytes;
+    report.elapsed_ms = (UINT32)(now - tp->start_time);
+    report.bytes_per_s = (period > 0) ? (UINT32)((int64_t)tp->period_bytes * 1000 / period) : 0;
+    report.mtu = tp->mtu;
+    report.tx_octets = tp->tx_octets;
+    report.tx_phy = tp->tx_phy;
+    report.interval = tp->interval;
+    tp->period_bytes = 0;
+    tp->period_time = now;
+
+    OSI_LOGI(0, "[BLE_server]tp bytes=%d rate=%d mtu=%d phy=%d", report.bytes,
+             report.bytes_per_s, report.mtu, report.tx_phy);
+    tp->cb(&report);
+}
+
+//send queued data until controller buffers are full
+static void bt_8910_ble_tp_pump(void)
+{
+    bt_8910_ble_tp_t *tp = &bt_8910_ble_tp;
+    gatt_le_data_info_t le_data_info;
+    BOOL stalled = FALSE;
+    BOOL again;
+    uint32_t critical;
+
+    critical = osiEnterCritical();
+    if (!tp->enabled || tp->busy)
+    {
+        osiExitCritical(critical);
+        return;
+    }
+    tp->busy = TRUE;
+    osiExitCritical(critical);
+
+    le_data_info.acl_handle = notify_data.acl_handle;
+    le_data_info.att_handle = ((bt_8910_feedback_char.value[2] << 8) | bt_8910_feedback_char.value[1]);
+    le_data_info.uuid.uuid_s = ATT_UUID_CHAR;
+    le_data_info.uuid_type = 0;
+    le_data_info.data = bt_8910_ble_tp_frame;
+
+    do
+    {
+        while (tp->enabled)
+        {
+            int len = osiFifoPeek(&tp->fifo, bt_8910_ble_tp_frame, tp->mtu - BT_8910_TP_ATT_HDR_LEN);
+            if (len <= 0)
+                break;
+
+            le_data_info.length = len;
+            if (ble_send_notification(&le_data_info) != BT_SUCCESS)
+            {
+                //resume at num_of_complete_cb
+                stalled = TRUE;
+                break;
+            }
+            osiFifoSkipBytes(&tp->fifo, len);
+            tp->bytes += len;
+            tp->period_bytes += len;
+        }
+
+        //data may be queued after the loop and before clear busy
+        critical = osiEnterCritical();
+        again = !stalled && tp->enabled && !osiFifoIsEmpty(&tp->fifo);
+        if (!again)
+            tp->busy = FALSE;
+        osiExitCritical(critical);
+    } while (again);
+
+    bt_8910_ble_tp_report(FALSE);
+}
+
+bt_status_t bt_8910_ble_tp_start(const bt_8910_ble_tp_profile_t *profile, bt_8910_ble_tp_report_cb_t cb)
+{
+    bt_8910_ble_tp_t *tp = &bt_8910_ble_tp;
+    bt_8910_ble_tp_profile_t prof = {0};
+    gatt_connect_param_t param;
+    UINT16 handle = notify_data.acl_handle;
+    bt_status_t status;
+
+    if (!bt_8910_ble_connected)
+        return BT_DISCONNECTED;
+
+    if (profile != NULL)
+        prof = *profile;
+    if (prof.mtu == 0 || prof.mtu > BT_8910_TP_MAX_MTU)
+        prof.mtu = BT_8910_TP_MAX_MTU;
+    if (prof.tx_octets == 0)
+        prof.tx_octets = 251;
+    if (prof.tx_time == 0)
+        prof.tx_time = 2120;
+    if (prof.phy == 0)
+        prof.phy = BT_8910_TP_PHY_2M;
+    if (prof.interval_min == 0)
+        prof.interval_min = 12;
+    if (prof.interval_max < prof.interval_min)
+        prof.interval_max = (prof.interval_min > 24) ? prof.interval_min : 24;
+
+    bt_8910_ble_tp_stop();
+    osiFifoInit(&tp->fifo, bt_8910_ble_tp_queue, sizeof(bt_8910_ble_tp_queue));
+    tp->cb = cb;
+    tp->bytes = 0;
+    tp->period_bytes = 0;
+    tp->start_time = osiUpTime();
+    tp->period_time = tp->start_time;
+    if (tp->mtu == 0)
+        tp->mtu = BT_8910_TP_DEFAULT_MTU;
+    tp->enabled = TRUE;
+
+    //each request may be rejected, and the current value is kept
+    status = ble_mtu_exchange_req(handle, prof.mtu);
+    OSI_LOGI(0, "[BLE_server]tp mtu request %d status %d", prof.mtu, status);
+    status = ble_data_length_set(handle, prof.tx_octets, prof.tx_time);
+    OSI_LOGI(0, "[BLE_server]tp data length request %d status %d", prof.tx_octets, status);
+    status = ble_phy_set(handle, 0, prof.phy, prof.phy, 0);
+    OSI_LOGI(0, "[BLE_server]tp phy request %d status %d", prof.phy, status);
+
+    param.connect_handle = handle;
+    param.connect_interval_min = prof.interval_min;
+    param.connect_interval_max = prof.interval_max;
+    param.slave_latency = 0;
+    param.super_timeout = 500;
+    param.min_ce_len = 0;
+    param.max_ce_len = prof.interval_max * 2;
+    status = ble_connect_para_update(&param);
+    OSI_LOGI(0, "[BLE_server]tp interval request %d-%d status %d", prof.interval_min, prof.interval_max, status);
+
+    return BT_SUCCESS;
+}
+
+void bt_8910_ble_tp_stop(void)
+{
+    bt_8910_ble_tp_t *tp = &bt_8910_ble_tp;
+
+    if (!tp->enabled)
+        return;
+
+    tp->enabled = FALSE;
+    osiFifoReset(&tp->fifo);
+    bt_8910_ble_tp_report(TRUE);
+    tp->cb = NULL;
+}
+
+UINT32 bt_8910_ble_tp_send(const UINT8 *data, UINT32 datalen)
+{
+    bt_8910_ble_tp_t *tp = &bt_8910_ble_tp;
+    int len;
+
+    if (!tp->enabled || data == NULL)
+        return 0;
+
+    len = osiFifoPut(&tp->fifo, data, datalen);
+    bt_8910_ble_tp_pump();
+    return (len > 0) ? len : 0;
+}
+
+void bt_8910_ble_tp_mtu_changed(UINT16 handle, UINT16 mtu)
+{
+    if (mtu > BT_8910_TP_MAX_MTU)
+        mtu = BT_8910_TP_MAX_MTU;
+    if (mtu > BT_8910_TP_ATT_HDR_LEN)
+        bt_8910_ble_tp.mtu = mtu;
+}
+
+void bt_8910_ble_tp_data_length_changed(UINT16 handle, UINT16 max_tx_octets)
+{
+    bt_8910_ble_tp.tx_octets = max_tx_octets;
+}
+
+void bt_8910_ble_tp_phy_changed(UINT16 handle, UINT8 status, UINT8 tx_phy)
+{
+    //not supported by controller or peer, 1M is kept
+    if (status == 0)
+        bt_8910_ble_tp.tx_phy = tx_phy;
+}
+
+void bt_8910_ble_tp_conn_param_changed(UINT8 status, gatt_connect_param_t *param)
+{
+    if (status == 0 && param != NULL)
+        bt_8910_ble_tp.interval = param->connect_interval_max;
+}
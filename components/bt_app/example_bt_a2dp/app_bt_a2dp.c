@@ -6,6 +6,7 @@
 #include "sci_types.h"
 #include "ddb.h"
 #include "bt_drv.h"
+#include "osi_api.h"
 #include "osi_log.h"
 #include "audio_player.h"
 #include "audio_types.h"
@@ -19,6 +20,7 @@
 #define PIPEPLAYER_WRITE_PIPE_TMEOUT (100) //(500)
 #define PIPEPLAYER_AUSTREAM_FORMAT_PCM_SRATE 16000
 #define AG_FEATURE_IN_BAND_RING (1 << 3)
+#define A2DP_BATCH_SIZE (PIPEPLAYER_PIPE_SIZE)
 
 
 uint32_t bt_protocol_connect_state = 0x0000;
@@ -49,6 +51,36 @@ a2dp_player_ctrl_t a2dp_player_cb = {
 
 bdaddr_t a2dp_addr;
 
+/**
+ * Media packets from BT host are batched, and all packets arrived
+ * before bt audio task runs are written to pipe at once. There is
+ * only one message in flight, and no allocation per packet.
+ */
+typedef struct
+{
+    osiMutex_t *lock;
+    uint8_t buf[2][A2DP_BATCH_SIZE];
+    unsigned size[2];
+    unsigned fill;    // index of buffer for new packets
+    unsigned packets; // packets in fill buffer
+    unsigned dropped; // packets dropped for fill buffer full
+    bool pending;     // message is sent and not handled
+} a2dp_batch_t;
+
+static a2dp_batch_t s_a2dp_batch;
+
+static void bt_app_a2dp_batch_reset(void)
+{
+    a2dp_batch_t *b = &s_a2dp_batch;
+    osiMutexLock(b->lock);
+    if (b->dropped != 0)
+        OSI_LOGI(0, "BT A2DP batch dropped packets/%d", b->dropped);
+    b->size[b->fill] = 0;
+    b->packets = 0;
+    b->dropped = 0;
+    osiMutexUnlock(b->lock);
+}
+
 bta2dp_connection_state_t app_bt_a2dp_connection_state_get(void)
 {
     return s_bt_a2dp_connection_state;
@@ -61,8 +93,7 @@ static bool bt_app_a2dp_player_init_write_data(auPipePlayerContext_t *d, const v
     if (d->pipe == NULL)
         return false;
     int written = osiPipeWriteAll(d->pipe, data, size, PIPEPLAYER_WRITE_PIPE_TMEOUT);
-    // OSI_LOGD(0, "a2dp player sbc write size/%d written/%d", size, written);
-    OSI_LOGI(0, "BT A2DP player_written=%d,size=%d", written, size);
+    OSI_LOGD(0, "BT A2DP player_written=%d,size=%d", written, size);
     return (written == size);
 }
 
@@ -149,28 +180,38 @@ uint8_t get_bt_specific_protocol_state(uint8_t pos)
     }
 }
 
-typedef struct bt_a2dp_audio_info_tag
-{
-    uint16    seq_num;
-    uint16    reserved;
-    UINT32   length;
-    uint8*    data;
-}bt_a2dp_audio_info_t;
-
 extern bool bt_send_msg_btAud_task(uint16 msg_id, void *data_ptr);
 
 UINT8 bt_app_a2dp_audio_stream_callback(UINT16 seq_num, hci_data_t *p_buf, UINT32 length)
 {
-    OSI_LOGI(0,"BT A2DP bt_app_a2dp_audio_stream_callback a2dp_player_cb.state %d",a2dp_player_cb.state);
-    if (BT_AVRCP_START == a2dp_player_cb.state)
+    if (BT_AVRCP_START != a2dp_player_cb.state)
+        return 1;
+
+    a2dp_batch_t *b = &s_a2dp_batch;
+    bool notify = false;
+
+    osiMutexLock(b->lock);
+    unsigned size = b->size[b->fill];
+    if (length > A2DP_BATCH_SIZE - size)
     {
-        bt_a2dp_audio_info_t* bt_a2dp_audio_info = (bt_a2dp_audio_info_t*)calloc(1,sizeof(bt_a2dp_audio_info_t)); 
-        bt_a2dp_audio_info->seq_num = seq_num;
-        bt_a2dp_audio_info->data = (uint8*)calloc(1,length);
-        memcpy(bt_a2dp_audio_info->data, p_buf->data, length);
-        bt_a2dp_audio_info->length = length;
-        bt_send_msg_btAud_task(BT_AUD_A2DP_MSG, bt_a2dp_audio_info);
+        b->dropped++;
+    }
+    else
+    {
+        memcpy(&b->buf[b->fill][size], p_buf->data, length);
+        b->size[b->fill] = size + length;
+        b->packets++;
+        notify = !b->pending;
+        b->pending = true;
+    }
+    osiMutexUnlock(b->lock);
 
+    // message data is NULL, packets are taken from batch buffer
+    if (notify && !bt_send_msg_btAud_task(BT_AUD_A2DP_MSG, NULL))
+    {
+        osiMutexLock(b->lock);
+        b->pending = false;
+        osiMutexUnlock(b->lock);
     }
     return 1;
 }
@@ -198,6 +239,7 @@ void bt_app_a2dp_audio_state_callback(bta2dp_audio_state_t state, bdaddr_t *addr
             //create pipe player
             audevStopTone();
             audevBtVoiceStop();
+            bt_app_a2dp_batch_reset();
             a2dp_player_cb.d = auPipePlayerCreate(AUSTREAM_FORMAT_SBC); //should be sbc
             if (a2dp_player_cb.d == NULL)
             {
@@ -285,6 +327,8 @@ bta2dp_callbacks_t bta2dp_callbacks = {
 
 void app_bt_a2dp_init(void)
 {
+  if (s_a2dp_batch.lock == NULL)
+      s_a2dp_batch.lock = osiMutexCreate();
   bt_a2dp_callback_register(&bta2dp_callbacks);
 
   bt_protocol_connect_state = 0x0000;
@@ -328,9 +372,25 @@ bool app_bt_a2dp_disconnect_req(void)
 void bt_a2dp_msg_handle(void* msg_data)
 {
      bool error_code;
-     bt_a2dp_audio_info_t* bt_a2dp_audio_info = (bt_a2dp_audio_info_t*)msg_data;
+     a2dp_batch_t *b = &s_a2dp_batch;
+
+        // take all batched packets, new packets go to the other buffer
+        osiMutexLock(b->lock);
+        unsigned drain = b->fill;
+        unsigned packets = b->packets;
+        b->fill = 1 - drain;
+        b->size[b->fill] = 0;
+        b->packets = 0;
+        b->pending = false;
+        osiMutexUnlock(b->lock);
+
+        if (b->size[drain] == 0 || a2dp_player_cb.d == NULL)
+            return;
+
+        OSI_LOGD(0, "BT A2DP batch packets/%d size/%d", packets, b->size[drain]);
+
         //write pipe
-        error_code = bt_app_a2dp_player_init_write_data(a2dp_player_cb.d, (void *)bt_a2dp_audio_info->data, (unsigned)bt_a2dp_audio_info->length); // length = ? bits
+        error_code = bt_app_a2dp_player_init_write_data(a2dp_player_cb.d, b->buf[drain], b->size[drain]);
         if (false == error_code)
         {
             if (BT_AVRCP_PAUSE != a2dp_player_cb.state)
@@ -344,7 +404,5 @@ void bt_a2dp_msg_handle(void* msg_data)
             }
             OSI_LOGI(0, "audio_stream data failed");
         }
-
-        free(bt_a2dp_audio_info->data);
  }
 
@@ -8,11 +8,33 @@
 #include "bt_drv.h"
 #include "osi_log.h"
 #include "bt_app.h"
+#include "osi_api.h"
+#include "osi_fifo.h"
+#include "app_bt_spp.h"
 
 extern void app_msg_to_at(unsigned int msg_id, char status, void *data_ptr);
 
+typedef struct
+{
+    bool opened;
+    bool tx_busy;    /* tx pump is running */
+    bool tx_blocked; /* write is short, credit_ind is needed */
+    uint32 flow;
+    const app_bt_spp_channel_cb_t *cb;
+    void *ctx;
+    osiFifo_t rx_fifo;
+    osiFifo_t tx_fifo;
+    uint32 rx_dropped;
+} app_bt_spp_channel_t;
+
 static uint32 s_bt_spp_state = BTSPP_CONNECTION_STATE_DISCONNECTED;
 static bdaddr_t s_spp_peer_addr;
+static uint16 s_spp_frame_size = APP_BT_SPP_DEFAULT_FRAME_SIZE;
+static app_bt_spp_channel_t s_spp_channel;
+static uint8 s_spp_rx_ring[APP_BT_SPP_RX_RING_SIZE];
+static uint8 s_spp_tx_ring[APP_BT_SPP_TX_RING_SIZE];
+
+static void bt_app_spp_tx_pump(void);
 
 static void bt_app_spp_connection_state_callback(btspp_connection_state_t state, bdaddr_t *addr)
 {
@@ -27,6 +49,16 @@ static void bt_app_spp_connection_state_callback(btspp_connection_state_t state,
     }
 
     s_bt_spp_state = state;
+    if (BTSPP_CONNECTION_STATE_CONNECTED == state)
+    {
+        s_spp_channel.flow = SPP_FLOW_GO;
+        bt_app_spp_tx_pump();
+    }
+    else if (BTSPP_CONNECTION_STATE_DISCONNECTED == state)
+    {
+        s_spp_frame_size = APP_BT_SPP_DEFAULT_FRAME_SIZE;
+        osiFifoReset(&s_spp_channel.tx_fifo);
+    }
     
     return;
 }
@@ -54,9 +86,22 @@ static UINT8 bt_app_spp_data_recv_callback(UINT16 port, UINT8 *data, UINT16 leng
 {
     BT_AT_SPP_DATA *pAtSppData = NULL;
 
-    OSI_LOGI(0, "[BT] enter bt_app_spp_data_recv_callback");
+    OSI_LOGD(0, "[BT] enter bt_app_spp_data_recv_callback");
 
-    if (data)
+    if (data && s_spp_channel.opened)
+    {
+        app_bt_spp_channel_t *ch = &s_spp_channel;
+        bool was_empty = osiFifoIsEmpty(&ch->rx_fifo);
+        int put = osiFifoPut(&ch->rx_fifo, data, length);
+        if (put < length)
+        {
+            ch->rx_dropped += length - put;
+            OSI_LOGW(0, "[BT] spp rx ring full, drop %d/%d", length - put, ch->rx_dropped);
+        }
+        if (was_empty && put > 0 && ch->cb->data_ind != NULL)
+            ch->cb->data_ind(ch->ctx);
+    }
+    else if (data)
     {
         if (bt_spp_data_memory_alloc(&pAtSppData, length))
         {
@@ -76,6 +121,20 @@ static UINT8 bt_app_spp_flowctrl_ind_callback(UINT32 result)
 {
     OSI_LOGI(0, "[BT] enter bt_app_spp_flowctrl_ind_callback result=%d", result);
 
+    app_bt_spp_channel_t *ch = &s_spp_channel;
+    ch->flow = result;
+    if (!ch->opened)
+        return 0;
+
+    if (ch->cb->flow_ind != NULL)
+        ch->cb->flow_ind(result, ch->ctx);
+
+    if (result == SPP_FLOW_GO)
+    {
+        /* credit_ind will be called after pump */
+        ch->tx_blocked = true;
+        bt_app_spp_tx_pump();
+    }
     return 0;
 }
 
@@ -83,6 +142,8 @@ static UINT8 bt_app_spp_mtu_result_callback(UINT16 frame_size)
 {
     OSI_LOGI(0, "[BT] enter bt_app_spp_mtu_result_callback frame_size=%d", frame_size);
 
+    if (frame_size != 0)
+        s_spp_frame_size = frame_size;
     return 0;
 }
 
@@ -139,3 +200,138 @@ bool app_bt_spp_data_send_req(const uint8 *src_buf, uint32 data_len)
 
     return false;
 }
+
+static void bt_app_spp_tx_pump(void)
+{
+    app_bt_spp_channel_t *ch = &s_spp_channel;
+
+    uint32 critical = osiEnterCritical();
+    bool busy = ch->tx_busy;
+    ch->tx_busy = true;
+    osiExitCritical(critical);
+    if (busy)
+        return;
+
+    bool stalled = false;
+    for (;;)
+    {
+        while (s_bt_spp_state == BTSPP_CONNECTION_STATE_CONNECTED &&
+               ch->flow == SPP_FLOW_GO && !osiFifoIsEmpty(&ch->tx_fifo))
+        {
+            /* send continuous data in tx ring directly, one frame each */
+            osiFifo_t *fifo = &ch->tx_fifo;
+            size_t offset = fifo->rd % fifo->size;
+            size_t len = osiFifoBytes(fifo);
+            if (len > fifo->size - offset)
+                len = fifo->size - offset;
+            if (len > s_spp_frame_size)
+                len = s_spp_frame_size;
+
+            if (bt_spp_data_send(&s_spp_peer_addr, (uint8 *)fifo->data + offset, len) != BT_SUCCESS)
+            {
+                /* retry at next write or flow go */
+                stalled = true;
+                break;
+            }
+            osiFifoSkipBytes(fifo, len);
+        }
+
+        /* data may be written after the loop and before clear busy */
+        critical = osiEnterCritical();
+        bool again = !stalled && ch->flow == SPP_FLOW_GO &&
+                     s_bt_spp_state == BTSPP_CONNECTION_STATE_CONNECTED &&
+                     !osiFifoIsEmpty(&ch->tx_fifo);
+        if (!again)
+            ch->tx_busy = false;
+        osiExitCritical(critical);
+        if (!again)
+            break;
+    }
+
+    if (ch->opened && ch->tx_blocked && !osiFifoIsFull(&ch->tx_fifo))
+    {
+        ch->tx_blocked = false;
+        if (ch->cb->credit_ind != NULL)
+            ch->cb->credit_ind(osiFifoSpace(&ch->tx_fifo), ch->ctx);
+    }
+}
+
+bool app_bt_spp_channel_open(const app_bt_spp_channel_cb_t *cb, void *ctx)
+{
+    app_bt_spp_channel_t *ch = &s_spp_channel;
+    if (cb == NULL || ch->opened)
+        return false;
+
+    osiFifoInit(&ch->rx_fifo, s_spp_rx_ring, sizeof(s_spp_rx_ring));
+    osiFifoInit(&ch->tx_fifo, s_spp_tx_ring, sizeof(s_spp_tx_ring));
+    ch->cb = cb;
+    ch->ctx = ctx;
+    ch->tx_blocked = false;
+    ch->rx_dropped = 0;
+    ch->opened = true;
+    return true;
+}
+
+void app_bt_spp_channel_close(void)
+{
+    app_bt_spp_channel_t *ch = &s_spp_channel;
+    ch->opened = false;
+    osiFifoReset(&ch->rx_fifo);
+    osiFifoReset(&ch->tx_fifo);
+}
+
+uint32 app_bt_spp_channel_peek(app_bt_spp_span_t spans[2])
+{
+    osiFifo_t *fifo = &s_spp_channel.rx_fifo;
+    if (!s_spp_channel.opened || spans == NULL)
+        return 0;
+
+    uint32 critical = osiEnterCritical();
+    size_t offset = fifo->rd % fifo->size;
+    size_t bytes = osiFifoBytes(fifo);
+    osiExitCritical(critical);
+    if (bytes == 0)
+        return 0;
+
+    size_t tail = fifo->size - offset;
+    spans[0].data = (const uint8 *)fifo->data + offset;
+    spans[0].len = (bytes > tail) ? tail : bytes;
+    if (bytes <= tail)
+        return 1;
+
+    spans[1].data = (const uint8 *)fifo->data;
+    spans[1].len = bytes - tail;
+    return 2;
+}
+
+void app_bt_spp_channel_consume(uint32 len)
+{
+    if (s_spp_channel.opened)
+        osiFifoSkipBytes(&s_spp_channel.rx_fifo, len);
+}
+
+uint32 app_bt_spp_channel_write(const uint8 *data, uint32 len)
+{
+    app_bt_spp_channel_t *ch = &s_spp_channel;
+    if (!ch->opened || data == NULL || s_bt_spp_state != BTSPP_CONNECTION_STATE_CONNECTED)
+        return 0;
+
+    int put = osiFifoPut(&ch->tx_fifo, data, len);
+    if ((uint32)put < len)
+        ch->tx_blocked = true;
+
+    bt_app_spp_tx_pump();
+    return put;
+}
+
+uint32 app_bt_spp_channel_credits(void)
+{
+    if (!s_spp_channel.opened)
+        return 0;
+    return osiFifoSpace(&s_spp_channel.tx_fifo);
+}
+
+uint16 app_bt_spp_channel_frame_size(void)
+{
+    return s_spp_frame_size;
+}
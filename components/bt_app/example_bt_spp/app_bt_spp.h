@@ -0,0 +1,81 @@
+#ifndef APP_BT_SPP_H
+#define APP_BT_SPP_H
+
+#include "sci_types.h"
+
+/* ring buffer size of SPP channel, power of 2 */
+#define APP_BT_SPP_RX_RING_SIZE (8 * 1024)
+#define APP_BT_SPP_TX_RING_SIZE (8 * 1024)
+
+/* RFCOMM default frame size, before it is negotiated */
+#define APP_BT_SPP_DEFAULT_FRAME_SIZE (127)
+
+/* continuous received data inside rx ring */
+typedef struct
+{
+    const uint8 *data;
+    uint32 len;
+} app_bt_spp_span_t;
+
+/*
+ * SPP channel callbacks, called in bt task. They shouldn't wait.
+ * credit_ind may also be called inside app_bt_spp_channel_write, when
+ * the short written data are sent immediately.
+ *
+ * data_ind: rx ring changed from empty to non-empty. The application
+ *     should read until the ring is empty, and no more indication will
+ *     come before that.
+ * credit_ind: tx ring space is available after it was full, or peer
+ *     flow control changed to go. credits is the bytes can be written.
+ * flow_ind: peer flow control, SPP_FLOW_STOP or SPP_FLOW_GO.
+ */
+typedef struct
+{
+    void (*data_ind)(void *ctx);
+    void (*credit_ind)(uint32 credits, void *ctx);
+    void (*flow_ind)(uint32 flow, void *ctx);
+} app_bt_spp_channel_cb_t;
+
+/*
+ * open SPP channel
+ *
+ * After open, received data are put into rx ring instead of
+ * ID_STATUS_SPP_DATA_RECIEVE_IND messages, without memory allocation.
+ * Data will be dropped when rx ring is full.
+ */
+bool app_bt_spp_channel_open(const app_bt_spp_channel_cb_t *cb, void *ctx);
+
+/* close SPP channel, and data in rings are discarded */
+void app_bt_spp_channel_close(void);
+
+/*
+ * get received data inside rx ring without copy
+ *
+ * Data may wrap around the ring end, so there are at most 2 spans.
+ * The spans are valid until app_bt_spp_channel_consume.
+ *
+ * Return span count, 0 for empty.
+ */
+uint32 app_bt_spp_channel_peek(app_bt_spp_span_t spans[2]);
+
+/* release read data in rx ring */
+void app_bt_spp_channel_consume(uint32 len);
+
+/*
+ * write data to tx ring
+ *
+ * Data are sent in segments of negotiated RFCOMM frame size, when peer
+ * flow control is go. Returned size may be less than len when tx ring
+ * is full, and credit_ind will be called when there are space.
+ *
+ * Return written bytes.
+ */
+uint32 app_bt_spp_channel_write(const uint8 *data, uint32 len);
+
+/* bytes can be written to tx ring now */
+uint32 app_bt_spp_channel_credits(void);
+
+/* negotiated RFCOMM frame size */
+uint16 app_bt_spp_channel_frame_size(void);
+
+#endif
@@ -202,6 +202,12 @@ bt_status_t ble_disconnect(uint16 conn_handle);
 
 bt_status_t ble_connect_para_update(gatt_connect_param_t *param);
 
+bt_status_t ble_mtu_exchange_req(uint16 acl_handle, uint16 mtu_size);
+
+bt_status_t ble_data_length_set(uint16 acl_handle, uint16 tx_octets, uint16 tx_time);
+
+bt_status_t ble_phy_set(uint16 acl_handle, uint8 all_phys, uint8 tx_phys, uint8 rx_phys, uint16 phy_options);
+
 bt_status_t ble_adv_param_set(gatt_adv_param_t *adv_param, uint8 ownAddrType);
 
 bt_status_t ble_adv_data_set(uint8 *data, uint32 len);
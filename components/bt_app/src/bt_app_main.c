@@ -30,11 +30,26 @@
 void app_ble_mtu_exchange_result_cb(UINT16 handle, UINT16 mtu)
 {
     SCI_TRACE_LOW("[BLE_client]mtu_exchange - MTU = 0x%x", mtu);
+    bt_8910_ble_tp_mtu_changed(handle, mtu);
 }
 
 bt_status_t app_ble_conn_param_update_cb(UINT8 status, gatt_connect_param_t *param)
 {
     OSI_LOGI(0, "app_ble_conn_param_update_cb enter");
+    bt_8910_ble_tp_conn_param_changed(status, param);
+    return BT_SUCCESS;
+}
+
+void app_ble_data_length_result_cb(UINT16 handle, UINT16 max_tx_octets, UINT16 max_tx_time, UINT16 max_rx_octets, UINT16 max_rx_time)
+{
+    OSI_LOGI(0, "app_ble_data_length_result_cb tx_octets=%d rx_octets=%d", max_tx_octets, max_rx_octets);
+    bt_8910_ble_tp_data_length_changed(handle, max_tx_octets);
+}
+
+bt_status_t app_ble_phy_update_result_cb(UINT16 handle, UINT8 status, UINT8 tx_phy, UINT8 rx_phy)
+{
+    OSI_LOGI(0, "app_ble_phy_update_result_cb status=%d tx_phy=%d rx_phy=%d", status, tx_phy, rx_phy);
+    bt_8910_ble_tp_phy_changed(handle, status, tx_phy);
     return BT_SUCCESS;
 }
 
@@ -42,6 +57,8 @@ btgatt_callback_t btgatt_callback =
     {
         .conn_param_update_result_cb = app_ble_conn_param_update_cb,
         .mtu_exchange_result_cb = app_ble_mtu_exchange_result_cb,
+        .le_data_length_result_cb = app_ble_data_length_result_cb,
+        .le_phy_update_result_cb = app_ble_phy_update_result_cb,
 };
 
 /**
@@ -173,6 +173,30 @@ bool diagOutputPacket2(const diagMsgHead_t *cmd, const void *data, unsigned size
  */
 bool diagOutputPacket3(const diagMsgHead_t *cmd, const void *sub_header, unsigned sub_header_size, const void *data, unsigned size);
 
+/**
+ * @brief maximum buffer count of \p diagOutputPacketMulti
+ */
+#define DIAG_OUTPUT_BUF_MAX (8)
+
+/**
+ * @brief output diag packet, header followed by multiple pieces of data
+ *
+ * It is the generic form of \p diagOutputPacket2 and \p diagOutputPacket3.
+ * The pieces are hdlc encoded directly into output buffer, and large
+ * packet (such as memory dump) is not needed to be assembled in heap.
+ *
+ * \p len in the header will be changed to \p sizeof(diagMsgHead_t) plus
+ * the total size of \p bufs.
+ *
+ * @param cmd       diag command header, must be valid
+ * @param bufs      data pieces following header
+ * @param count     data piece count, can't be larger than \p DIAG_OUTPUT_BUF_MAX
+ * @return
+ *      - true on success
+ *      - false if \p head is NULL, or too many pieces
+ */
+bool diagOutputPacketMulti(const diagMsgHead_t *cmd, const osiBuffer_t *bufs, unsigned count);
+
 /**
  * @brief output response for bad command
  *
@@ -195,7 +195,8 @@ typedef enum
     ARM_LOG_ENABLE,
     ARM_LOG_DISABLE,
     DSP_LOG_ENABLE,
-    DSP_LOG_DISABLE
+    DSP_LOG_DISABLE,
+    LOG_READ_RING // read on-device log ring
 } log_cmd_set_enum_type;
 
 /* PS related command sets  */
@@ -20,6 +20,7 @@
 #include "osi_log.h"
 #include "osi_sysnv.h"
 #include "osi_hdlc.h"
+#include "osi_trace.h"
 #ifndef CONFIG_QUEC_PROJECT_FEATURE
 typedef uint8_t uint8;
 typedef uint16_t uint16;
@@ -29,6 +30,10 @@ typedef uint32_t uint32;
 #include <stdlib.h>
 #include <string.h>
 
+// Buffer for hdlc encoded output packet. Larger packets are streamed in
+// pieces of this size when possible.
+#define DIAG_TX_BUF_SIZE (2048)
+
 typedef struct diag_handle
 {
     diagCmdHandle_t cb;
@@ -44,6 +49,8 @@ typedef struct diagContext
     unsigned prebuf_size;
     void *dyn_mem;
     void *prebuf;
+    osiMutex_t *tx_lock;
+    void *tx_buf;
 } diagContext_t;
 
 static diagContext_t *gDiagCtx;
@@ -86,21 +93,72 @@ void diagBadCommand(const diagMsgHead_t *cmd)
     diagOutputPacket(&head, sizeof(head));
 }
 
-static bool prvDiagSendMulti(const osiBuffer_t *bufs, unsigned count, unsigned size)
+/**
+ * Send large packet in pieces, encoded into tx buffer piece by piece.
+ * It is only valid when the packet won't be mixed with trace.
+ */
+static bool prvDiagSendStream(diagContext_t *d, const osiBuffer_t *bufs, unsigned count)
+{
+    osiHdlcEncodeStream_t enc;
+    osiHdlcEncodeStreamInit(&enc, bufs, count);
+    for (;;)
+    {
+        int enc_size = osiHdlcEncodeStreamPart(&enc, d->tx_buf, DIAG_TX_BUF_SIZE);
+        if (enc_size <= 0)
+            return true;
+        if (!drvDebugPortSendPacket(d->port, d->tx_buf, enc_size))
+            return false;
+    }
+}
+
+/**
+ * Send large packet mixed with trace, the whole encoded packet is needed.
+ */
+static bool prvDiagSendWhole(diagContext_t *d, const osiBuffer_t *bufs, unsigned count)
 {
-    diagContext_t *d = gDiagCtx;
     int enc_size = osiHdlcEncodeMultiLen(bufs, count);
     if (enc_size < 0)
         return false;
 
     void *enc_buf = malloc(enc_size);
-    if (enc_buf != NULL)
-    {
-        enc_size = osiHdlcEncodeMulti(enc_buf, bufs, count);
-        drvDebugPortSendPacket(d->port, enc_buf, enc_size);
-        free(enc_buf);
-    }
-    return true;
+    if (enc_buf == NULL)
+        return false;
+
+    enc_size = osiHdlcEncodeMulti(enc_buf, bufs, count);
+    bool ok = drvDebugPortSendPacket(d->port, enc_buf, enc_size);
+    free(enc_buf);
+    return ok;
+}
+
+static bool prvDiagSendMulti(const osiBuffer_t *bufs, unsigned count, unsigned size)
+{
+    diagContext_t *d = gDiagCtx;
+    if (d == NULL || d->port == NULL)
+        return false;
+
+    unsigned worst_size = size * 2 + 2;
+    bool trace_enable = d->port->mode.trace_enable;
+
+#ifdef CONFIG_KERNEL_DIAG_TRACE
+    // When packet will be mixed with trace, encode it into trace buffer
+    // directly. It is not needed to wait the transfer.
+    if (trace_enable && !osiIsPanic() && worst_size <= CONFIG_KERNEL_TRACE_BUF_SIZE &&
+        osiTraceBufPutMulti(bufs, count, size))
+        return true;
+#endif
+
+    osiMutexLock(d->tx_lock);
+
+    bool ok;
+    if (worst_size <= DIAG_TX_BUF_SIZE)
+        ok = drvDebugPortSendPacket(d->port, d->tx_buf, osiHdlcEncodeMulti(d->tx_buf, bufs, count));
+    else if (!trace_enable)
+        ok = prvDiagSendStream(d, bufs, count);
+    else
+        ok = prvDiagSendWhole(d, bufs, count);
+
+    osiMutexUnlock(d->tx_lock);
+    return ok;
 }
 
 bool diagOutputPacket(const void *data, unsigned size)
@@ -109,7 +167,8 @@ bool diagOutputPacket(const void *data, unsigned size)
         return false;
 
     osiBuffer_t bufs[1] = {{(uintptr_t)data, size}};
-    return prvDiagSendMulti(bufs, 1, size);
+    prvDiagSendMulti(bufs, 1, size);
+    return true;
 }
 
 bool diagOutputPacket2(const diagMsgHead_t *cmd, const void *data, unsigned size)
@@ -124,7 +183,8 @@ bool diagOutputPacket2(const diagMsgHead_t *cmd, const void *data, unsigned size
         {(uintptr_t)&head, sizeof(diagMsgHead_t)},
         {(uintptr_t)data, size},
     };
-    return prvDiagSendMulti(bufs, 2, head.len);
+    prvDiagSendMulti(bufs, 2, head.len);
+    return true;
 }
 
 bool diagOutputPacket3(const diagMsgHead_t *cmd, const void *sub_header, unsigned sub_header_size,
@@ -141,7 +201,28 @@ bool diagOutputPacket3(const diagMsgHead_t *cmd, const void *sub_header, unsigne
         {(uintptr_t)sub_header, sub_header_size},
         {(uintptr_t)data, size},
     };
-    return prvDiagSendMulti(bufs, 3, head.len);
+    prvDiagSendMulti(bufs, 3, head.len);
+    return true;
+}
+
+bool diagOutputPacketMulti(const diagMsgHead_t *cmd, const osiBuffer_t *bufs, unsigned count)
+{
+    if (cmd == NULL || count > DIAG_OUTPUT_BUF_MAX || (count > 0 && bufs == NULL))
+        return false;
+
+    diagMsgHead_t head = *cmd;
+    head.len = sizeof(diagMsgHead_t);
+
+    osiBuffer_t pkt[DIAG_OUTPUT_BUF_MAX + 1];
+    pkt[0].ptr = (uintptr_t)&head;
+    pkt[0].size = sizeof(diagMsgHead_t);
+    for (unsigned n = 0; n < count; n++)
+    {
+        pkt[n + 1] = bufs[n];
+        head.len += bufs[n].size;
+    }
+    prvDiagSendMulti(pkt, count + 1, head.len);
+    return true;
 }
 
 static void prvResponseSendOk(const diagMsgHead_t *cmd)
@@ -233,11 +314,14 @@ static void _diagDataCB(void *param)
 void diagInit(drvDebugPort_t *port)
 {
     unsigned prebuf_size = (osiGetBootMode() == OSI_BOOTMODE_NORMAL) ? CONFIG_DIAG_NORMAL_MODE_BUF_SIZE : CONFIG_DIAG_CALIB_MODE_BUF_SIZE;
-    uintptr_t mem = (uintptr_t)calloc(1, sizeof(diagContext_t) + prebuf_size);
+    prebuf_size = OSI_ALIGN_UP(prebuf_size, 4);
+    uintptr_t mem = (uintptr_t)calloc(1, OSI_ALIGN_UP(sizeof(diagContext_t), 4) + prebuf_size + DIAG_TX_BUF_SIZE);
 
-    gDiagCtx = (diagContext_t *)OSI_PTR_INCR_POST(mem, sizeof(diagContext_t));
+    gDiagCtx = (diagContext_t *)OSI_PTR_INCR_POST(mem, OSI_ALIGN_UP(sizeof(diagContext_t), 4));
     gDiagCtx->prebuf = (void *)OSI_PTR_INCR_POST(mem, prebuf_size);
     gDiagCtx->prebuf_size = prebuf_size;
+    gDiagCtx->tx_buf = (void *)OSI_PTR_INCR_POST(mem, DIAG_TX_BUF_SIZE);
+    gDiagCtx->tx_lock = osiMutexCreate();
     diagContext_t *d = (diagContext_t *)gDiagCtx;
 
     for (unsigned n = 0; n < REQ_MAX_F; n++)
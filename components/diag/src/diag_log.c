@@ -17,6 +17,8 @@
 #include "osi_api.h"
 #include "osi_log.h"
 #include "drv_uart.h"
+#include "srv_config.h"
+#include "srv_trace.h"
 typedef uint8_t uint8;
 typedef uint16_t uint16;
 typedef uint32_t uint32;
@@ -24,6 +26,38 @@ typedef uint32_t uint32;
 #include <stdlib.h>
 #include <string.h>
 
+#define LOG_RING_READ_MAX (2048)
+
+#ifdef CONFIG_SRV_LOG_RING_ENABLE
+/**
+ * Read on-device log ring. Request is offset and size (both uint32_t),
+ * and response is offset followed by data. Pending traces are committed
+ * at reading from offset 0.
+ */
+static void _readLogRing(const diagMsgHead_t *cmd)
+{
+    uint32_t req[2];
+    if (diagCmdDataSize(cmd) < sizeof(req))
+    {
+        diagBadCommand(cmd);
+        return;
+    }
+
+    memcpy(req, diagCmdData(cmd), sizeof(req));
+    if (req[0] == 0)
+        srvLogRingFlush();
+
+    unsigned size = OSI_MIN(unsigned, req[1], LOG_RING_READ_MAX);
+    void *data = malloc(size);
+    int bytes = (data == NULL) ? -1 : srvLogRingRead(req[0], data, size);
+    if (bytes < 0)
+        diagBadCommand(cmd);
+    else
+        diagOutputPacket3(cmd, &req[0], sizeof(uint32_t), data, bytes);
+    free(data);
+}
+#endif
+
 static bool _handleLog(const diagMsgHead_t *cmd, void *ctx)
 {
     switch (cmd->subtype)
@@ -48,6 +82,12 @@ static bool _handleLog(const diagMsgHead_t *cmd, void *ctx)
         diagOutputPacket2(cmd, NULL, 0);
         break;
 
+#ifdef CONFIG_SRV_LOG_RING_ENABLE
+    case LOG_READ_RING:
+        _readLogRing(cmd);
+        break;
+#endif
+
     default:
         diagBadCommand(cmd);
         break;
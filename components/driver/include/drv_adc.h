@@ -103,4 +103,82 @@ int32_t drvAdcGetRawValue(uint32_t channel, int32_t scale);
 
 int32_t drvAdcGetHMicChannelVolt(int32_t scale, int32_t con_mode);
 
+/**
+ * @brief maximum number of ADC samplers
+ */
+#define DRV_ADC_SAMPLER_COUNT (8)
+
+/**
+ * @brief maximum filter depth of ADC sampler
+ */
+#define DRV_ADC_SAMPLER_DEPTH_MAX (16)
+
+/**
+ * @brief filter of ADC sampler
+ */
+typedef enum
+{
+    DRV_ADC_FILTER_AVERAGE, ///< moving average of the latest samples
+    DRV_ADC_FILTER_MEDIAN,  ///< median of the latest samples
+} drvAdcFilter_t;
+
+/**
+ * @brief opaque data structure of ADC sampler
+ */
+typedef struct drvAdcSampler drvAdcSampler_t;
+
+/**
+ * @brief create an ADC sampler
+ *
+ * The channel is sampled periodically in system low priority work queue,
+ * and the latest \p depth raw values are kept. All samplers due at the
+ * same time are converted in one batch, and the timer is relaxed to be
+ * waken up together with other timers.
+ *
+ * The first sample is taken before return, so the filtered value can be
+ * read immediately.
+ *
+ * @param channel   the channel to sample
+ * @param scale     the scale of the channel
+ * @param period_ms sample period in milliseconds
+ * @param depth     filter depth, 1 ~ DRV_ADC_SAMPLER_DEPTH_MAX
+ * @param filter    filter of the latest samples
+ * @return
+ *      - the ADC sampler
+ *      - NULL on invalid parameter, too many samplers, or first sample failed
+ */
+drvAdcSampler_t *drvAdcSamplerCreate(uint32_t channel, int32_t scale, uint32_t period_ms,
+                                     unsigned depth, drvAdcFilter_t filter);
+
+/**
+ * @brief delete the ADC sampler
+ *
+ * @param s     the ADC sampler, NULL is ignored
+ */
+void drvAdcSamplerDelete(drvAdcSampler_t *s);
+
+/**
+ * @brief return the filtered raw value of the ADC sampler
+ *
+ * It won't start conversion, and won't block.
+ *
+ * @param s     the ADC sampler
+ * @return
+ *      -1 failure
+ *      the filtered raw value.
+ */
+int32_t drvAdcSamplerGetRaw(drvAdcSampler_t *s);
+
+/**
+ * @brief return the filtered volt of the ADC sampler in mV
+ *
+ * It won't start conversion, and won't block.
+ *
+ * @param s     the ADC sampler
+ * @return
+ *      -1 failure
+ *      the volt vlaue.
+ */
+int32_t drvAdcSamplerGetVolt(drvAdcSampler_t *s);
+
 #endif /*__RDA_ADC_H__*/
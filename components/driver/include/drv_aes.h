@@ -14,6 +14,8 @@
 #define _DRV_AES_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +33,59 @@ extern "C" {
  */
 void aesEncryptObj(void *buf, uint32_t len, void *key);
 
+/**
+ * @brief AES-128 ECB encrypt or decrypt by hw engine
+ *
+ * Hardware engine is used only for large buffers. When hw engine isn't
+ * available, is used by another caller, or \p size is too small to
+ * gain from DMA, it will return false without touching \p output, and
+ * caller should fall back to software.
+ *
+ * @param key       16 bytes key
+ * @param decrypt   true for decryption, false for encryption
+ * @param input     input data
+ * @param output    output data, can be the same as \p input
+ * @param size      data size, should be multiple of 16
+ * @return
+ *      - true      done by hw engine
+ *      - false     caller should fall back to software
+ */
+bool drvAesCryptEcb(const uint8_t *key, bool decrypt, const void *input, void *output, size_t size);
+
+/**
+ * @brief AES-128 CBC decrypt by hw engine
+ *
+ * Only decryption is supported, CBC encryption is serial and can't
+ * gain from DMA. \p iv will be updated for the next call.
+ *
+ * @param key       16 bytes key
+ * @param iv        16 bytes initial vector
+ * @param input     input data
+ * @param output    output data, can be the same as \p input
+ * @param size      data size, should be multiple of 16
+ * @return
+ *      - true      done by hw engine
+ *      - false     caller should fall back to software
+ */
+bool drvAesCryptCbcDecrypt(const uint8_t *key, uint8_t *iv, const void *input, void *output, size_t size);
+
+/**
+ * @brief AES-128 CTR encrypt or decrypt by hw engine
+ *
+ * The counter block is increased as 128 bits big endian integer for
+ * each block. \p counter will be updated for the next call.
+ *
+ * @param key       16 bytes key
+ * @param counter   16 bytes counter block
+ * @param input     input data
+ * @param output    output data, can be the same as \p input
+ * @param size      data size, should be multiple of 16
+ * @return
+ *      - true      done by hw engine
+ *      - false     caller should fall back to software
+ */
+bool drvAesCryptCtr(const uint8_t *key, uint8_t *counter, const void *input, void *output, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
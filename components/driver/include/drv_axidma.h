@@ -179,4 +179,64 @@ void drvAxidmaChRegisterIsr(drvAxidmaCh_t *ch, drvAxidmaIsr_t isr, void *param);
  */
 void drvAxidmaStopAll(void);
 
+/**
+ * @brief copy memory by AXIDMA
+ *
+ * It will wait the copy done before return. The calling thread will be
+ * blocked, rather than busy loop, during copy. So, it can't be called in
+ * ISR.
+ *
+ * Small copies, or when there are no free AXIDMA channels, will be
+ * performed by CPU.
+ *
+ * Dcache clean for \p src and dcache clean and invalidate for \p dst will
+ * be performed inside.
+ *
+ * @param dst   destination address
+ * @param src   source address
+ * @param size  copy size in byte
+ */
+void drvAxidmaMemcpy(void *dst, const void *src, size_t size);
+
+/**
+ * @brief copy memory by AXIDMA without waiting
+ *
+ * \p cb will be called when the copy is done. It may be called in AXIDMA
+ * ISR, or before return in case the copy is performed by CPU. So, \p cb
+ * should be ISR safe.
+ *
+ * Caller shouldn't access \p dst and \p src before \p cb is called.
+ *
+ * @param dst   destination address
+ * @param src   source address
+ * @param size  copy size in byte
+ * @param cb    callback when the copy is done
+ * @param cb_ctx    callback context
+ */
+void drvAxidmaMemcpyAsync(void *dst, const void *src, size_t size, osiCallback_t cb, void *cb_ctx);
+
+/**
+ * @brief set memory by AXIDMA
+ *
+ * It is the same as \p drvAxidmaMemcpy, except it is \p memset.
+ *
+ * @param dst   destination address
+ * @param c     the value to be set, only the lowest byte is used
+ * @param size  set size in byte
+ */
+void drvAxidmaMemset(void *dst, int c, size_t size);
+
+/**
+ * @brief set memory by AXIDMA without waiting
+ *
+ * It is the same as \p drvAxidmaMemcpyAsync, except it is \p memset.
+ *
+ * @param dst   destination address
+ * @param c     the value to be set, only the lowest byte is used
+ * @param size  set size in byte
+ * @param cb    callback when the set is done
+ * @param cb_ctx    callback context
+ */
+void drvAxidmaMemsetAsync(void *dst, int c, size_t size, osiCallback_t cb, void *cb_ctx);
+
 #endif /* __AXIDMA_H__ */
@@ -20,6 +20,16 @@ OSI_EXTERN_C_BEGIN
 #include <stdint.h>
 #include <stdbool.h>
 
+/**
+ * \brief curve of backlight fade
+ */
+typedef enum
+{
+    DRV_BACKLIGHT_CURVE_LINEAR,   ///< level changes linearly
+    DRV_BACKLIGHT_CURVE_EASE_IN,  ///< slow at start, quadratic
+    DRV_BACKLIGHT_CURVE_EASE_OUT, ///< slow at end, quadratic
+} drvBackLightCurve_t;
+
 /**
  * \brief open backlight
  *
@@ -37,6 +47,34 @@ bool drvBackLightOpen(uint32_t light_level);
  */
 bool drvBackLightClose();
 
+/**
+ * \brief fade backlight to the level
+ *
+ * The fade is performed in timer service thread, and the caller won't be
+ * blocked. Each step changes the level by at least one, and steps are
+ * no faster than 16ms. So, the number of timer wakeups is no more than
+ * the level difference.
+ *
+ * Backlight should be opened. The running fade will be replaced by the
+ * new one, started from the current level. \p drvBackLightOpen and
+ * \p drvBackLightClose will stop the running fade.
+ *
+ * \param light_level  target level, from 0 to 255
+ * \param duration_ms  fade duration, 0 to set the level immediately
+ * \param curve        fade curve
+ * \return
+ *      - true on succeed else fail
+ */
+bool drvBackLightFade(uint32_t light_level, uint32_t duration_ms, drvBackLightCurve_t curve);
+
+/**
+ * \brief get current backlight level
+ *
+ * \return
+ *      - current level, from 0 to 255
+ */
+uint32_t drvBackLightGetLevel(void);
+
 OSI_EXTERN_C_END
 
 #endif //_DRV_BACKLIGHT_
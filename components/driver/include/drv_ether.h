@@ -83,6 +83,8 @@ typedef struct
     void (*set_event_cb)(drvEther_t *ether, drvEthEventCB_t cb, void *priv);
     void (*set_uldata_cb)(drvEther_t *ether, drvEthULDataCB_t cb, void *priv);
     void (*set_host_mac)(drvEther_t *ether, uint8_t host_mac[ETH_ALEN]);
+    void *(*rx_hold)(drvEther_t *ether, drvEthPacket_t *pkt);
+    void (*rx_release)(drvEther_t *ether, void *hold);
 } drvEthImpl_t;
 
 struct drv_ether
@@ -197,6 +199,37 @@ static inline void drvEtherSetHostMac(drvEther_t *eth, uint8_t host_mac[ETH_ALEN
         eth->impl.set_host_mac(eth, host_mac);
 }
 
+/**
+ * \brief hold the buffer of uplink data packet
+ *
+ * It can only be called inside uplink data callback. After that, the
+ * packet buffer is valid until \p drvEtherRxRelease, and the caller can
+ * use the packet without copy. The number of held buffers is limited by
+ * net device, and it will fail when there are too many held buffers.
+ *
+ * \param eth   the net device
+ * \param pkt   the packet in uplink data callback
+ * \return
+ *      - the hold handle for \p drvEtherRxRelease
+ *      - NULL on fail, and the packet should be copied
+ */
+static inline void *drvEtherRxHold(drvEther_t *eth, drvEthPacket_t *pkt)
+{
+    return ((eth && eth->impl.rx_hold) ? eth->impl.rx_hold(eth, pkt) : NULL);
+}
+
+/**
+ * \brief release the buffer held by \p drvEtherRxHold
+ *
+ * \param eth   the net device
+ * \param hold  the hold handle
+ */
+static inline void drvEtherRxRelease(drvEther_t *eth, void *hold)
+{
+    if (eth && hold && eth->impl.rx_release)
+        eth->impl.rx_release(eth, hold);
+}
+
 OSI_EXTERN_C_END
 
 #endif
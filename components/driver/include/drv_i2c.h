@@ -118,6 +118,100 @@ bool drvI2cWriteRawByte(drvI2cMaster_t *i2c, uint8_t data, uint32_t cmd_mask);
  */
 bool drvI2cReadRawByte(drvI2cMaster_t *i2c, uint8_t *data, uint32_t cmd_mask);
 
+/**
+ * @brief i2c message flags
+ */
+enum
+{
+    DRV_I2C_MSG_READ = (1 << 0),    ///< read from slave, otherwise write to slave
+    DRV_I2C_MSG_NOSTART = (1 << 1), ///< continue previous write message, no start and address
+};
+
+/**
+ * @brief i2c message, one segment of a transaction
+ *
+ * Each message starts with start (repeated start when it is not the
+ * first one) and slave address, except \p DRV_I2C_MSG_NOSTART is set.
+ * Stop is sent after the last message of the transaction.
+ */
+typedef struct
+{
+    uint8_t addr;  ///< 7 bits slave address
+    uint8_t flags; ///< DRV_I2C_MSG_READ, DRV_I2C_MSG_NOSTART
+    uint16_t len;  ///< data length, can be 0 only for write
+    uint8_t *buf;  ///< data buffer
+} drvI2cMsg_t;
+
+struct drvI2cXfer;
+
+/**
+ * @brief function type to notify transaction done, called in ISR
+ */
+typedef void (*drvI2cXferCB_t)(struct drvI2cXfer *xfer, bool ok);
+
+/**
+ * @brief i2c transaction
+ *
+ * The transaction and messages are owned by caller, and shall be kept
+ * valid until the done callback.
+ */
+typedef struct drvI2cXfer
+{
+    const drvI2cMsg_t *msgs; ///< message list
+    uint32_t count;          ///< message count
+    drvI2cXferCB_t cb;       ///< done callback
+    void *cb_ctx;            ///< done callback context
+    struct drvI2cXfer *next; ///< (internal) queue link
+} drvI2cXfer_t;
+
+/**
+ * @brief queue an i2c transaction
+ *
+ * Transactions of the same i2c master are queued and executed in
+ * order. The transfer is driven by interrupt, caller won't be blocked,
+ * and the result is notified by the done callback in ISR.
+ *
+ * Typical usage is write register address and then read with repeated
+ * start, or write register address and burst data with
+ * \p DRV_I2C_MSG_NOSTART.
+ *
+ * @param i2c           the i2c master
+ * @param xfer          the transaction
+ * @return
+ *      - true          transaction is queued
+ *      - false         invalid parameter
+ */
+bool drvI2cXferSubmit(drvI2cMaster_t *i2c, drvI2cXfer_t *xfer);
+
+/**
+ * @brief cancel a queued i2c transaction
+ *
+ * When the transaction is in progress, stop will be sent. The done
+ * callback won't be called for canceled transaction.
+ *
+ * @param i2c           the i2c master
+ * @param xfer          the transaction
+ * @return
+ *      - true          transaction is canceled
+ *      - false         transaction is not in queue, maybe done already
+ */
+bool drvI2cXferCancel(drvI2cMaster_t *i2c, drvI2cXfer_t *xfer);
+
+/**
+ * @brief execute i2c messages, and wait done
+ *
+ * Caller thread will sleep rather than polling during transfer.
+ *
+ * @param i2c           the i2c master
+ * @param msgs          message list
+ * @param count         message count
+ * @param timeout       wait timeout in milliseconds
+ * @return
+ *      - true          success
+ *      - false         fail, slave no ack or timeout
+ */
+bool drvI2cXferRun(drvI2cMaster_t *i2c, const drvI2cMsg_t *msgs, uint32_t count, uint32_t timeout);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,7 +13,7 @@
 #ifndef _DRV_LCD_V2_H_
 #define _DRV_LCD_V2_H_
 
-#include "osi_compiler.h"
+#include "osi_api.h"
 
 OSI_EXTERN_C_BEGIN
 
@@ -374,6 +374,35 @@ bool drvLcdSleep(drvLcd_t *d);
  */
 bool drvLcdWakeup(drvLcd_t *d);
 
+/**
+ * \brief LCD enter low power mode
+ *
+ * The panel is kept on and shows its frame memory, and GOUDA is closed,
+ * so system can sleep. When supported by the panel, only rows of
+ * \p partial are scanned in 8 colors. Otherwise the whole panel is
+ * shown as before.
+ *
+ * \p drvLcdFlush can still be called in low power mode, GOUDA is opened
+ * for the transfer only, and the transfer is always synchronous.
+ *
+ * \param d         LCD driver instance
+ * \param partial   rows to be shown in partial mode, NULL for whole panel
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, or LCD isn't opened
+ */
+bool drvLcdEnterLowPower(drvLcd_t *d, const drvLcdArea_t *partial);
+
+/**
+ * \brief LCD exit low power mode
+ *
+ * \param d         LCD driver instance
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, or LCD isn't in low power mode
+ */
+bool drvLcdExitLowPower(drvLcd_t *d);
+
 /**
  * \brief turn on or off back light of LCD
  *
@@ -426,6 +455,26 @@ void drvLcdSetDirection(drvLcd_t *d, drvLcdDirection_t dir);
  */
 bool drvLcdFlush(drvLcd_t *lcd, const drvLcdLayers_t *layers, bool sync);
 
+/**
+ * \brief flush LCD display, and notify at data transfer done
+ *
+ * It is the same as \p drvLcdFlush with \p sync as false. Additionally,
+ * \p done_cb will be called when the data transfer is finished.
+ *
+ * \p done_cb is called in ISR, and it should be short. It won't be called
+ * when false is returned. The buffers of layers shouldn't be changed until
+ * \p done_cb is called.
+ *
+ * \param d         LCD driver instance
+ * \param layers    layers definition
+ * \param done_cb   callback at data transfer done, can be NULL
+ * \param done_cb_ctx   callback context
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool drvLcdFlushAsync(drvLcd_t *lcd, const drvLcdLayers_t *layers, osiCallback_t done_cb, void *done_cb_ctx);
+
 /**
  * \brief fill solid color in screen ROI
  *
@@ -450,9 +499,9 @@ bool drvLcdFill(drvLcd_t *lcd, uint16_t color, const drvLcdArea_t *screen_roi, b
  * There is only "sync" version, that it, it will always wait data transfer
  * done before return.
  *
- * Dcache clean for layer buffers and dcache invalidate for outptu will be
- * performed inside. Caller should take care alignment of \p buf, to avoid
- * invalidate other varaiables.
+ * Dcache clean for layer buffers and dcache clean and invalidate for output
+ * lines will be performed inside. So, pixels outside of \p screen_roi in
+ * the output lines are kept.
  *
  * The output format is fixed to RGB565. \p buf should point to the original
  * pixel of blended layer ROI. The unit of \p stride is pixel, not bytes.
@@ -472,5 +521,29 @@ bool drvLcdBlend(const drvLcdLayers_t *layers, void *buf, unsigned stride);
  */
 void drvLcdWaitTransferDone(void);
 
+/**
+ * \brief whether GOUDA is working
+ *
+ * It can be used to avoid waiting on-going LCD flush or blend, and fall back
+ * to other methods.
+ *
+ * \return
+ *      - true if GOUDA is working
+ *      - false if GOUDA is idle
+ */
+bool drvLcdIsBusy(void);
+
+/**
+ * \brief accumulated time blocked in waiting GOUDA
+ *
+ * It is the sum of the time that callers are blocked till the on-going
+ * flush or blend is finished. The value will wrap around, and the
+ * difference of two calls is the blocked time between them.
+ *
+ * \return
+ *      - accumulated blocked time in microseconds
+ */
+uint32_t drvLcdGetWaitTime(void);
+
 OSI_EXTERN_C_END
 #endif
@@ -28,6 +28,25 @@ OSI_EXTERN_C_BEGIN
  */
 bool drvRngGenerate(void *buf, unsigned len);
 
+/**
+ * \brief generate random data from the shared DRBG
+ *
+ * It is CTR-DRBG of NIST SP 800-90A (AES-128, without derivation
+ * function), instantiated and reseeded by \p drvRngGenerate. It is much
+ * faster than \p drvRngGenerate, which takes hundreds of microseconds
+ * for each 8 bytes, and it is suitable for keys, nonces, seeds of other
+ * DRBG and protocol random numbers.
+ *
+ * It is thread safe, and can't be called in ISR.
+ *
+ * \param buf   buffer to store random data
+ * \param len   buffer length
+ * \return
+ *      - true on success
+ *      - false if hardware random isn't available
+ */
+bool drvRngRandom(void *buf, unsigned len);
+
 OSI_EXTERN_C_END
 
 #endif
\ No newline at end of file
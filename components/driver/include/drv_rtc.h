@@ -187,6 +187,34 @@ bool drvRtcAlarmOwnerSetCB(uint32_t owner, void *context, drvRtcAlarmCB_t cb);
  */
 void drvRtcUpdateTime(void);
 
+/**
+ * @brief store calibrated drift of RTC and system time
+ *
+ * The drift is measured by time service, and stored in RTC NV. So the
+ * drift compensation can be continued after reboot, including the time
+ * when the system is powered off.
+ *
+ * @param drift_ppb     drift in ppb, positive for slow clock
+ * @param error_ppb     error of the drift, 0 for not calibrated
+ */
+void drvRtcSetDrift(int32_t drift_ppb, uint32_t error_ppb);
+
+/**
+ * @brief get calibrated drift of RTC and system time
+ *
+ * \p update_time is the epoch second of the last \p drvRtcUpdateTime,
+ * that is the last time when RTC is set to the compensated time. 0 for
+ * unknown.
+ *
+ * @param drift_ppb     output drift in ppb, can be NULL
+ * @param error_ppb     output error of the drift, can be NULL
+ * @param update_time   output epoch second of last RTC update, can be NULL
+ * @return
+ *      - true if the drift is calibrated
+ *      - false if not calibrated
+ */
+bool drvRtcGetDrift(int32_t *drift_ppb, uint32_t *error_ppb, int64_t *update_time);
+
 /**
  * @brief get wakeup alarm in epoch time
  *
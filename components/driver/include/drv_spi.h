@@ -172,6 +172,60 @@ bool drvSpiWrite(drvSpiMaster_t *d, drvSpiCsSel cs, uint8_t *sendaddr, uint32_t
  */
 bool drvSpiRead(drvSpiMaster_t *d, drvSpiCsSel cs, uint8_t *sendaddr, uint8_t *readaddr, uint32_t len);
 
+struct drvSpiTransfer;
+
+/**
+ * @brief callback of asynchronous spi transfer, called in ISR
+ */
+typedef void (*drvSpiTransferCallback_t)(void *ctx, struct drvSpiTransfer *xfer);
+
+/**
+ * @brief asynchronous spi transfer
+ *
+ * The memory is owned by the driver after submit, until the callback
+ * is called. \p next is used by the driver.
+ */
+typedef struct drvSpiTransfer
+{
+    drvSpiCsSel cs;              ///< cs choice of spi
+    const uint8_t *tx;           ///< data to be transmitted, must be valid
+    uint8_t *rx;                 ///< received data, NULL for transmit only
+    uint32_t len;                ///< data len
+    drvSpiTransferCallback_t cb; ///< completion callback, can be NULL
+    void *cb_ctx;                ///< completion callback context
+    struct drvSpiTransfer *next; ///< queue link, used by driver
+} drvSpiTransfer_t;
+
+/**
+ * @brief queue transfers to be executed back-to-back by DMA
+ *
+ * It is only supported in \p SPI_DMA_IRQ mode. The transfers are
+ * executed in order, and the callback of each transfer is called in ISR
+ * after the transfer is finished. The next transfer is started before
+ * the callback, and it is permitted to submit more transfers in the
+ * callback.
+ *
+ * For transmit only transfer, the last bytes in FIFO are waited in ISR.
+ *
+ * @param d : point to spi instance
+ * @param xfers : transfers to be queued
+ * @param count : transfer count
+ * @return
+ *      - (false)    invalid parameter, or not in \p SPI_DMA_IRQ mode
+ *      - (true)     success
+ */
+bool drvSpiTransferSubmit(drvSpiMaster_t *d, drvSpiTransfer_t *xfers, unsigned count);
+
+/**
+ * @brief whether there are queued transfers unfinished
+ *
+ * @param d : point to spi instance
+ * @return
+ *      - (true)     there are unfinished transfers
+ *      - (false)    all transfers are finished
+ */
+bool drvSpiTransferBusy(drvSpiMaster_t *d);
+
 /**
  * @brief config irq of the SPI peripheral
  * @param d : point to spi instance
@@ -27,6 +27,21 @@ extern "C" {
  */
 typedef struct drvSpiFlash drvSpiFlash_t;
 
+/**
+ * \brief priority class of flash reader
+ *
+ * Erase and program are background operations. Pending readers with class
+ * higher than background will suspend in progress erase or program, and
+ * erase or program will wait them (with bounded time) before resume.
+ */
+typedef enum
+{
+    DRV_SPI_FLASH_PRIO_BACKGROUND, ///< no preemption of erase and program
+    DRV_SPI_FLASH_PRIO_UI,         ///< UI assets
+    DRV_SPI_FLASH_PRIO_AUDIO,      ///< audio data or codes
+    DRV_SPI_FLASH_PRIO_COUNT
+} drvSpiFlashPriority_t;
+
 /**
  * \brief open SPI flash
  *
@@ -87,6 +102,35 @@ bool drvSpiFlashSetXipEnabled(drvSpiFlash_t *d, bool enable);
  */
 bool drvSpiFlashSetSuspendEnabled(drvSpiFlash_t *d, bool enable);
 
+/**
+ * \brief start latency critical read
+ *
+ * Between \p drvSpiFlashReadBegin and \p drvSpiFlashReadEnd, the reader
+ * is pending. Flash erase or program will be suspended when it is
+ * resumed, and the erase or program thread will sleep up to 10ms to let
+ * the reader run. Also, erase and program will wait pending readers
+ * between each erase unit or page.
+ *
+ * It is for readers where latency is more important than erase or program
+ * throughput, such as audio decoding and UI asset loading. The range
+ * between begin and end should be short (one buffer, one asset), and
+ * begin/end must be paired with the same \p prio.
+ *
+ * It can't be called in ISR.
+ *
+ * \param d SPI flash instance pointer, must be valid
+ * \param prio reader priority class
+ */
+void drvSpiFlashReadBegin(drvSpiFlash_t *d, drvSpiFlashPriority_t prio);
+
+/**
+ * \brief end latency critical read
+ *
+ * \param d SPI flash instance pointer, must be valid
+ * \param prio reader priority class, the same as begin
+ */
+void drvSpiFlashReadEnd(drvSpiFlash_t *d, drvSpiFlashPriority_t prio);
+
 /**
  * \brief prohibit flash erase/program for a certain range
  *
@@ -187,6 +231,9 @@ const void *drvSpiFlashMapAddress(drvSpiFlash_t *d, uint32_t offset);
 /**
  * \brief read data from flash
  *
+ * Data are copied from the XIP mapped window. For large read, the
+ * following cache lines are preloaded during copy.
+ *
  * \param d SPI flash instance pointer, must be valid
  * \param offset flash offset
  * \param data memory for read
@@ -197,6 +244,44 @@ const void *drvSpiFlashMapAddress(drvSpiFlash_t *d, uint32_t offset);
  */
 bool drvSpiFlashRead(drvSpiFlash_t *d, uint32_t offset, void *data, uint32_t size);
 
+/**
+ * \brief read data from flash by DMA
+ *
+ * It is for large sequential read, such as loading assets. The calling
+ * thread is blocked rather than busy loop during DMA, and it can't be
+ * called in ISR.
+ *
+ * When there is flash program or erase in progress (including suspended),
+ * or the size is small, it is the same as \p drvSpiFlashRead.
+ *
+ * \param d SPI flash instance pointer, must be valid
+ * \param offset flash offset
+ * \param data memory for read
+ * \param size read size
+ * \return
+ *      - true on success
+ *      - false on error, invalid parameters
+ */
+bool drvSpiFlashReadDma(drvSpiFlash_t *d, uint32_t offset, void *data, uint32_t size);
+
+/**
+ * \brief read data from flash with priority class
+ *
+ * It is the same as \p drvSpiFlashRead inside \p drvSpiFlashReadBegin
+ * and \p drvSpiFlashReadEnd.
+ *
+ * \param d SPI flash instance pointer, must be valid
+ * \param offset flash offset
+ * \param data memory for read
+ * \param size read size
+ * \param prio reader priority class
+ * \return
+ *      - true on success
+ *      - false on error, invalid parameters
+ */
+bool drvSpiFlashReadPriority(drvSpiFlash_t *d, uint32_t offset, void *data,
+                             uint32_t size, drvSpiFlashPriority_t prio);
+
 /**
  * \brief read data from flash, and check with provided data
  *
@@ -211,6 +211,36 @@ int drvUartReceive(drvUart_t *uart, void *buf, size_t size);
  */
 int drvUartReadAvail(drvUart_t *uart);
 
+/**
+ * @brief peek contiguous received data in rx buffer without copy
+ *
+ * rx buffer is a ring buffer, and the returned region may be only part
+ * of the available data when it wraps around. After the data are
+ * consumed, \p drvUartReadSkip should be called, and then call this
+ * again for the remained data.
+ *
+ * In DMA mode, RX DMA writes to rx buffer directly, and the returned
+ * region won't be overwritten before \p drvUartReadSkip.
+ *
+ * @param uart  the UART driver
+ * @param data  output pointer of the contiguous data
+ * @return
+ *      - (-1) Parameter error
+ *      - OTHERS (>=0) size of the contiguous data
+ */
+int drvUartReadPeek(drvUart_t *uart, const void **data);
+
+/**
+ * @brief drop data in rx buffer, after \p drvUartReadPeek
+ *
+ * @param uart  the UART driver
+ * @param size  size to be dropped
+ * @return
+ *      - (-1) Parameter error
+ *      - OTHERS (>=0) dropped size in byte
+ */
+int drvUartReadSkip(drvUart_t *uart, size_t size);
+
 /**
  * @brief inquire avalable space in tx buffer
  *
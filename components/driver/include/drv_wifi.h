@@ -107,6 +107,65 @@ bool drvWifiScanAsyncStart(drvWifi_t *d, uint32_t ch, wifiScanAsyncCb_t cb, void
  */
 void drvWifiScanAsyncStop(drvWifi_t *d);
 
+/**
+ * \brief start background scan of wifi scan manager
+ *
+ * Scan manager keeps a deduplicated table of found APs. Background scan
+ * is a periodic relaxed timer in system low priority work queue, and a
+ * few channels are scanned at each run in round robin. With \p relax_ms
+ * of \p OSI_DELAY_MAX, background scan won't wakeup system from sleep,
+ * and it will be performed when system is waken up by other reasons,
+ * such as paging.
+ *
+ * Background scan will be skipped silently when \p d is busy in other
+ * scan. \p d should be kept valid until \p drvWifiScanMgrStop.
+ *
+ * \param d         wifi context
+ * \param period_ms background scan period
+ * \param relax_ms  relaxed timeout of background scan timer
+ * \return
+ *      - true on success else fail
+ */
+bool drvWifiScanMgrStart(drvWifi_t *d, uint32_t period_ms, uint32_t relax_ms);
+
+/**
+ * \brief stop background scan of wifi scan manager
+ *
+ * When background scan is running, it will wait the current run finished.
+ * The AP table is kept.
+ */
+void drvWifiScanMgrStop(void);
+
+/**
+ * \brief merge scan result into wifi scan manager AP table
+ *
+ * On demand scan result can be merged, to make it available for later
+ * queries.
+ *
+ * \param aps       found APs
+ * \param count     found AP count
+ */
+void drvWifiScanMgrUpdate(const wifiApInfo_t *aps, uint32_t count);
+
+/**
+ * \brief get APs from wifi scan manager AP table
+ *
+ * It won't start scan, and won't block. APs are sorted by signal strength,
+ * strongest first.
+ *
+ * \param aps       room for APs
+ * \param max       room count
+ * \param max_age_ms  APs not seen in this time are ignored
+ * \return
+ *      - AP count
+ */
+uint32_t drvWifiScanMgrGetAps(wifiApInfo_t *aps, uint32_t max, uint32_t max_age_ms);
+
+/**
+ * \brief clear wifi scan manager AP table
+ */
+void drvWifiScanMgrClear(void);
+
 OSI_EXTERN_C_END
 
 #endif
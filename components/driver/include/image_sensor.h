@@ -19,6 +19,9 @@ OSI_EXTERN_C_BEGIN
 
 #include "drv_camera.h"
 #include "drv_config.h"
+#ifdef CONFIG_LCD_SUPPORT
+#include "drv_lcd_v2.h"
+#endif
 
 typedef struct
 {
@@ -55,6 +58,22 @@ typedef struct image_dev_tag
     uint16_t *pFramebuffer[SENSOR_FRAMEBUFFER_NUM];
 } IMAGE_DEV_T, *IMAGE_DEV_T_PTR;
 
+/**
+ * \brief camera stream frame
+ */
+typedef struct
+{
+    uint16_t *buf;     ///< frame buffer, valid only inside frame callback
+    uint32_t size;     ///< frame size in bytes
+    uint32_t seq;      ///< frame sequence number, start from 0
+    int64_t timestamp; ///< up time in microseconds when the frame is got
+} drvCamFrame_t;
+
+/**
+ * \brief camera stream frame callback, called in camera stream thread
+ */
+typedef void (*drvCamFrameCB_t)(const drvCamFrame_t *frame, void *ctx);
+
 typedef struct cam_dev_tag
 {
     char *pNamestr;
@@ -74,6 +93,43 @@ bool drvCamCaptureImage(uint16_t **pFrameBuf);
 bool drvCamGePrevStatus(void);
 void drvCamClose(void);
 
+/**
+ * \brief start camera stream
+ *
+ * Frames are captured by camera DMA into the preview frame buffers in
+ * turn. Each frame is delivered to \p cb with sequence number and
+ * timestamp, and then sent to LCD preview when configured. The frame
+ * buffer is given back to camera after LCD preview is done, without copy.
+ *
+ * \param cb    frame callback, can be NULL for LCD preview only
+ * \param ctx   frame callback context
+ * \return
+ *      - true on success
+ *      - false if camera isn't powered on, or stream is started
+ */
+bool drvCamStartStream(drvCamFrameCB_t cb, void *ctx);
+
+/**
+ * \brief stop camera stream
+ *
+ * It will wait the last frame callback and LCD preview to be finished.
+ */
+void drvCamStopStream(void);
+
+#ifdef CONFIG_LCD_SUPPORT
+/**
+ * \brief set LCD preview of camera stream
+ *
+ * The frame buffer will be set to \p buf of the video layer, and other
+ * fields of the video layer should be set by caller. It should be called
+ * before \p drvCamStartStream.
+ *
+ * \param lcd   LCD driver instance, NULL to disable LCD preview
+ * \param vl    video layer for preview
+ */
+void drvCamSetStreamPreview(drvLcd_t *lcd, const drvLcdVideoLayer_t *vl);
+#endif
+
 
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_CAMERA
 SensorOps_t *prvCamLoad(void);
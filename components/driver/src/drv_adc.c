@@ -22,6 +22,7 @@
 #include "hal_chip.h"
 #include "drv_pmic_intr.h"
 #include "drv_efuse_pmic.h"
+#include <string.h>
 
 #define ADC_RESULT_NUM 7
 
@@ -38,6 +39,29 @@
 static osiSemaphore_t *adclock = NULL;
 static uint32_t anaChipId;
 
+struct drvAdcSampler
+{
+    bool used;
+    uint8_t channel;
+    uint8_t scale;
+    uint8_t filter;
+    uint8_t depth;
+    uint8_t count;
+    uint8_t pos;
+    uint32_t period_ms;
+    int64_t next_due;
+    uint16_t raw[DRV_ADC_SAMPLER_DEPTH_MAX];
+};
+
+typedef struct
+{
+    osiWork_t *work;
+    osiTimer_t *timer;
+    drvAdcSampler_t samplers[DRV_ADC_SAMPLER_COUNT];
+} drvAdcSamplerContext_t;
+
+static drvAdcSamplerContext_t gAdcSamplerCtx;
+
 /**
  * @sample_speed:   0:quick mode, 1: slow mode
  * @scale:      0:little scale, 1:big scale
@@ -933,11 +957,12 @@ static int32_t _drvGetAdcAverage(uint32_t channel, int32_t scale)
     return adc_result[ADC_RESULT_NUM / 2];
 }
 
-int32_t drvAdcGetRawValue(uint32_t channel, int32_t scale)
+/**
+ * Single conversion, caller should hold the lock and open 26M clock
+ */
+static int32_t _adcConvert(uint32_t channel, int32_t scale)
 {
     struct adc_sample_data adc;
-    ADC_LOCK(adclock);
-    _adcOpenPmic26MclkAdc();
     adc.channel_id = channel;
     adc.channel_type = 0;
     adc.hw_channel_delay = 0;
@@ -947,19 +972,25 @@ int32_t drvAdcGetRawValue(uint32_t channel, int32_t scale)
     if (_adcGetValue(&adc) == false)
     {
         OSI_LOGE(0, "adc: Get raw value, timeout ");
-
-        ADC_UNLOCK(adclock);
-        _adcClosePmic26MclkAdc();
-
         return -1;
     }
 
     OSI_LOGD(0, "adc:  channel = %d,raw = %d", channel, adc.result);
+    return adc.result;
+}
+
+int32_t drvAdcGetRawValue(uint32_t channel, int32_t scale)
+{
+    int32_t raw;
+    ADC_LOCK(adclock);
+    _adcOpenPmic26MclkAdc();
+
+    raw = _adcConvert(channel, scale);
 
     ADC_UNLOCK(adclock);
     _adcClosePmic26MclkAdc();
 
-    return adc.result;
+    return raw;
 }
 
 int32_t drvAdcGetChannelVolt(uint32_t channel, int32_t scale)
@@ -993,3 +1024,211 @@ int32_t drvAdcGetHMicChannelVolt(int32_t scale, int32_t con_mode)
     OSI_LOGD(0, "hmic adc: con_mode= %d,vol= %dmv", con_mode, value);
     return value;
 }
+
+/**
+ * Push a sample to the ring of sampler, sampler fields are read by
+ * \p drvAdcSamplerGetRaw without lock.
+ */
+static void _adcSamplerPush(drvAdcSampler_t *s, int32_t raw)
+{
+    uint32_t critical = osiEnterCritical();
+    s->raw[s->pos] = raw;
+    s->pos = (s->pos + 1) % s->depth;
+    if (s->count < s->depth)
+        s->count++;
+    osiExitCritical(critical);
+}
+
+/**
+ * Restart the timer at the earliest due sampler, caller should hold the lock.
+ * The timer can be delayed a quarter period, to be waken up together with
+ * other timers.
+ */
+static void _adcSamplerSchedule(int64_t now)
+{
+    drvAdcSamplerContext_t *d = &gAdcSamplerCtx;
+    int64_t due = INT64_MAX;
+    uint32_t relax_ms = 0;
+
+    for (unsigned n = 0; n < DRV_ADC_SAMPLER_COUNT; n++)
+    {
+        drvAdcSampler_t *s = &d->samplers[n];
+        if (s->used && s->next_due < due)
+        {
+            due = s->next_due;
+            relax_ms = s->period_ms / 4;
+        }
+    }
+
+    if (due == INT64_MAX)
+    {
+        osiTimerStop(d->timer);
+        return;
+    }
+
+    int64_t ms = due - now;
+    osiTimerStartRelaxed(d->timer, (ms > 0) ? (uint32_t)ms : 0, relax_ms);
+}
+
+/**
+ * Sampler timer work, convert all due samplers with 26M clock opened once.
+ * Samplers due within a quarter period are converted in this batch also.
+ */
+static void _adcSamplerWork(void *param)
+{
+    drvAdcSamplerContext_t *d = &gAdcSamplerCtx;
+    bool opened = false;
+
+    ADC_LOCK(adclock);
+
+    int64_t now = osiUpTime();
+    for (unsigned n = 0; n < DRV_ADC_SAMPLER_COUNT; n++)
+    {
+        drvAdcSampler_t *s = &d->samplers[n];
+        if (!s->used || s->next_due > now + s->period_ms / 4)
+            continue;
+
+        if (!opened)
+        {
+            _adcOpenPmic26MclkAdc();
+            opened = true;
+        }
+
+        int32_t raw = _adcConvert(s->channel, s->scale);
+        if (raw >= 0)
+            _adcSamplerPush(s, raw);
+
+        s->next_due = OSI_MAX(int64_t, s->next_due + s->period_ms, now);
+    }
+
+    if (opened)
+        _adcClosePmic26MclkAdc();
+
+    _adcSamplerSchedule(osiUpTime());
+    ADC_UNLOCK(adclock);
+}
+
+drvAdcSampler_t *drvAdcSamplerCreate(uint32_t channel, int32_t scale, uint32_t period_ms,
+                                     unsigned depth, drvAdcFilter_t filter)
+{
+    drvAdcSamplerContext_t *d = &gAdcSamplerCtx;
+    drvAdcSampler_t *s = NULL;
+
+    if (channel > ADC_CHANNEL_MAX || scale < 0 || scale > ADC_SCALE_MAX)
+        return NULL;
+    if (period_ms == 0 || depth == 0 || depth > DRV_ADC_SAMPLER_DEPTH_MAX)
+        return NULL;
+    if (filter != DRV_ADC_FILTER_AVERAGE && filter != DRV_ADC_FILTER_MEDIAN)
+        return NULL;
+
+    ADC_LOCK(adclock);
+
+    if (d->timer == NULL)
+    {
+        d->work = osiWorkCreate(_adcSamplerWork, NULL, NULL);
+        if (d->work != NULL)
+            d->timer = osiTimerCreateWork(d->work, osiSysWorkQueueLowPriority());
+        if (d->timer == NULL)
+        {
+            osiWorkDelete(d->work);
+            d->work = NULL;
+            goto failed;
+        }
+    }
+
+    for (unsigned n = 0; n < DRV_ADC_SAMPLER_COUNT; n++)
+    {
+        if (!d->samplers[n].used)
+        {
+            s = &d->samplers[n];
+            break;
+        }
+    }
+    if (s == NULL)
+        goto failed;
+
+    _adcOpenPmic26MclkAdc();
+    int32_t raw = _adcConvert(channel, scale);
+    _adcClosePmic26MclkAdc();
+    if (raw < 0)
+    {
+        s = NULL;
+        goto failed;
+    }
+
+    memset(s, 0, sizeof(*s));
+    s->channel = channel;
+    s->scale = scale;
+    s->filter = filter;
+    s->depth = depth;
+    s->period_ms = period_ms;
+    s->next_due = osiUpTime() + period_ms;
+    _adcSamplerPush(s, raw);
+    s->used = true;
+
+    _adcSamplerSchedule(osiUpTime());
+    ADC_UNLOCK(adclock);
+
+    OSI_LOGI(0, "adc: sampler channel %d period %d depth %d", channel, period_ms, depth);
+    return s;
+
+failed:
+    ADC_UNLOCK(adclock);
+    OSI_LOGE(0, "adc: failed to create sampler, channel %d", channel);
+    return NULL;
+}
+
+void drvAdcSamplerDelete(drvAdcSampler_t *s)
+{
+    if (s == NULL)
+        return;
+
+    ADC_LOCK(adclock);
+    s->used = false;
+    _adcSamplerSchedule(osiUpTime());
+    ADC_UNLOCK(adclock);
+}
+
+int32_t drvAdcSamplerGetRaw(drvAdcSampler_t *s)
+{
+    uint16_t raw[DRV_ADC_SAMPLER_DEPTH_MAX];
+    unsigned count;
+
+    if (s == NULL)
+        return -1;
+
+    uint32_t critical = osiEnterCritical();
+    count = s->used ? s->count : 0;
+    memcpy(raw, s->raw, count * sizeof(raw[0]));
+    osiExitCritical(critical);
+
+    if (count == 0)
+        return -1;
+
+    if (s->filter == DRV_ADC_FILTER_AVERAGE)
+    {
+        uint32_t sum = 0;
+        for (unsigned n = 0; n < count; n++)
+            sum += raw[n];
+        return (sum + count / 2) / count;
+    }
+
+    for (unsigned i = 1; i < count; i++)
+    {
+        uint16_t v = raw[i];
+        unsigned j = i;
+        for (; j > 0 && raw[j - 1] > v; j--)
+            raw[j] = raw[j - 1];
+        raw[j] = v;
+    }
+    return raw[count / 2];
+}
+
+int32_t drvAdcSamplerGetVolt(drvAdcSampler_t *s)
+{
+    int32_t adc = drvAdcSamplerGetRaw(s);
+    if (adc == -1)
+        return -1;
+
+    return _adcChangAdcToVol(s->channel, s->scale, 0, adc);
+}
@@ -14,6 +14,10 @@
 #include <stddef.h>
 #include <string.h>
 #include "drv_aes.h"
+#include "hal_config.h"
+#include "hal_chip.h"
+#include "osi_api.h"
+#include "osi_log.h"
 
 enum
 {
@@ -310,3 +314,270 @@ void aesEncryptObj(void *buf, uint32_t len, void *key)
         dst += AES_KEY_LENGTH;
     }
 }
+
+#ifdef CONFIG_SOC_8910
+
+// smaller buffer is faster by software, due to DMA setup and copy
+#define AES_HW_MIN_SIZE (256)
+#define AES_HW_CHUNK_SIZE (2048)
+#define AES_HW_TIMEOUT_US (5000)
+
+typedef enum
+{
+    AES_HW_UNKNOWN,
+    AES_HW_READY,
+    AES_HW_FAILED,
+} aesHwState_t;
+
+typedef struct
+{
+    osiMutex_t *lock;
+    aesHwState_t state;
+    bool key_valid;
+    bool key_decrypt;
+    uint32_t key[4];
+    uint8_t buf[AES_HW_CHUNK_SIZE] OSI_CACHE_LINE_ALIGNED;
+} drvAesHw_t;
+
+static drvAesHw_t gDrvAesHw;
+
+static bool _aesHwRun(drvAesHw_t *d, const uint8_t *key, bool decrypt, size_t size)
+{
+    if (!d->key_valid || d->key_decrypt != decrypt || memcmp(d->key, key, AES_KEY_LENGTH) != 0)
+    {
+        memcpy(d->key, key, AES_KEY_LENGTH);
+        d->key_decrypt = decrypt;
+        d->key_valid = true;
+        halAesCryptSetKey((const uint8_t *)d->key, decrypt);
+    }
+
+    osiDCacheClean(d->buf, size);
+    halAesCryptStart(d->buf, d->buf, size);
+
+    osiElapsedTimer_t elapsed;
+    osiElapsedTimerStart(&elapsed);
+    while (!halAesCheckCryptComplete())
+    {
+        if (osiElapsedTimeUS(&elapsed) > AES_HW_TIMEOUT_US)
+        {
+            // the engine is unknown state, don't use it any more
+            OSI_LOGE(0, "AES hw crypt timeout, size/%u", size);
+            d->state = AES_HW_FAILED;
+            return false;
+        }
+    }
+    osiDCacheInvalidate(d->buf, size);
+    return true;
+}
+
+/**
+ * Check the engine with FIPS-197 example vector at the first use. The
+ * software implementation will always be used if it fails.
+ */
+static bool _aesHwSelfTest(drvAesHw_t *d)
+{
+    static const uint8_t key[16] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    static const uint8_t plain[16] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    static const uint8_t cipher[16] = {
+        0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+        0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+    halAesCryptInit();
+    memcpy(d->buf, plain, 16);
+    if (!_aesHwRun(d, key, false, 16) || memcmp(d->buf, cipher, 16) != 0)
+        return false;
+
+    if (!_aesHwRun(d, key, true, 16) || memcmp(d->buf, plain, 16) != 0)
+        return false;
+
+    return true;
+}
+
+static drvAesHw_t *_aesHwAcquire(size_t size)
+{
+    drvAesHw_t *d = &gDrvAesHw;
+    if (size < AES_HW_MIN_SIZE || (size % AES_KEY_LENGTH) != 0 || d->state == AES_HW_FAILED)
+        return NULL;
+
+    if (d->lock == NULL)
+    {
+        osiMutex_t *lock = osiMutexCreate();
+        uint32_t critical = osiEnterCritical();
+        if (d->lock == NULL)
+        {
+            d->lock = lock;
+            lock = NULL;
+        }
+        osiExitCritical(critical);
+        if (lock != NULL)
+            osiMutexDelete(lock);
+        if (d->lock == NULL)
+            return NULL;
+    }
+
+    // concurrent callers fall back to software, rather than waiting
+    if (!osiMutexTryLock(d->lock, 0))
+        return NULL;
+
+    if (d->state == AES_HW_UNKNOWN)
+    {
+        d->state = _aesHwSelfTest(d) ? AES_HW_READY : AES_HW_FAILED;
+        d->key_valid = false;
+        OSI_LOGI(0, "AES hw self test %d", d->state);
+    }
+
+    if (d->state != AES_HW_READY)
+    {
+        osiMutexUnlock(d->lock);
+        return NULL;
+    }
+
+    // the clock may be changed by TRNG
+    halAesCryptInit();
+    return d;
+}
+
+static void _aesHwRelease(drvAesHw_t *d)
+{
+    osiMutexUnlock(d->lock);
+}
+
+static void _aesXor(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t size)
+{
+    for (size_t n = 0; n < size; n++)
+        out[n] = a[n] ^ b[n];
+}
+
+static void _aesCounterInc(uint8_t *counter)
+{
+    for (int n = AES_KEY_LENGTH; n > 0; n--)
+    {
+        if (++counter[n - 1] != 0)
+            break;
+    }
+}
+
+bool drvAesCryptEcb(const uint8_t *key, bool decrypt, const void *input, void *output, size_t size)
+{
+    drvAesHw_t *d = _aesHwAcquire(size);
+    if (d == NULL)
+        return false;
+
+    const uint8_t *in = (const uint8_t *)input;
+    uint8_t *out = (uint8_t *)output;
+    while (size > 0)
+    {
+        size_t chunk = OSI_MIN(size_t, size, AES_HW_CHUNK_SIZE);
+        memcpy(d->buf, in, chunk);
+        if (!_aesHwRun(d, key, decrypt, chunk))
+            break;
+
+        memcpy(out, d->buf, chunk);
+        in += chunk;
+        out += chunk;
+        size -= chunk;
+    }
+
+    _aesHwRelease(d);
+    return size == 0;
+}
+
+bool drvAesCryptCbcDecrypt(const uint8_t *key, uint8_t *iv, const void *input, void *output, size_t size)
+{
+    drvAesHw_t *d = _aesHwAcquire(size);
+    if (d == NULL)
+        return false;
+
+    const uint8_t *in = (const uint8_t *)input;
+    uint8_t *out = (uint8_t *)output;
+    uint8_t prev[AES_KEY_LENGTH];
+    memcpy(prev, iv, AES_KEY_LENGTH);
+    while (size > 0)
+    {
+        size_t chunk = OSI_MIN(size_t, size, AES_HW_CHUNK_SIZE);
+        memcpy(d->buf, in, chunk);
+        if (!_aesHwRun(d, key, true, chunk))
+            break;
+
+        // output may overlap input, keep the last cipher block before xor
+        uint8_t last[AES_KEY_LENGTH];
+        memcpy(last, in + chunk - AES_KEY_LENGTH, AES_KEY_LENGTH);
+        for (size_t n = chunk; n > AES_KEY_LENGTH; n -= AES_KEY_LENGTH)
+            _aesXor(out + n - AES_KEY_LENGTH, d->buf + n - AES_KEY_LENGTH,
+                    in + n - 2 * AES_KEY_LENGTH, AES_KEY_LENGTH);
+        _aesXor(out, d->buf, prev, AES_KEY_LENGTH);
+        memcpy(prev, last, AES_KEY_LENGTH);
+
+        in += chunk;
+        out += chunk;
+        size -= chunk;
+    }
+
+    _aesHwRelease(d);
+    if (size != 0)
+        return false;
+
+    memcpy(iv, prev, AES_KEY_LENGTH);
+    return true;
+}
+
+bool drvAesCryptCtr(const uint8_t *key, uint8_t *counter, const void *input, void *output, size_t size)
+{
+    drvAesHw_t *d = _aesHwAcquire(size);
+    if (d == NULL)
+        return false;
+
+    const uint8_t *in = (const uint8_t *)input;
+    uint8_t *out = (uint8_t *)output;
+    uint8_t ctr[AES_KEY_LENGTH];
+    memcpy(ctr, counter, AES_KEY_LENGTH);
+    while (size > 0)
+    {
+        size_t chunk = OSI_MIN(size_t, size, AES_HW_CHUNK_SIZE);
+        uint8_t chunk_ctr[AES_KEY_LENGTH];
+        memcpy(chunk_ctr, ctr, AES_KEY_LENGTH);
+        for (size_t n = 0; n < chunk; n += AES_KEY_LENGTH)
+        {
+            memcpy(d->buf + n, ctr, AES_KEY_LENGTH);
+            _aesCounterInc(ctr);
+        }
+
+        if (!_aesHwRun(d, key, false, chunk))
+            break;
+
+        _aesXor(out, in, d->buf, chunk);
+        in += chunk;
+        out += chunk;
+        size -= chunk;
+    }
+
+    _aesHwRelease(d);
+    if (size != 0)
+        return false;
+
+    memcpy(counter, ctr, AES_KEY_LENGTH);
+    return true;
+}
+
+#else
+
+bool drvAesCryptEcb(const uint8_t *key, bool decrypt, const void *input, void *output, size_t size)
+{
+    return false;
+}
+
+bool drvAesCryptCbcDecrypt(const uint8_t *key, uint8_t *iv, const void *input, void *output, size_t size)
+{
+    return false;
+}
+
+bool drvAesCryptCtr(const uint8_t *key, uint8_t *counter, const void *input, void *output, size_t size)
+{
+    return false;
+}
+
+#endif
@@ -17,6 +17,7 @@
 #include "osi_api.h"
 #include "osi_log.h"
 #include <stdint.h>
+#include <string.h>
 #include <hwregs.h>
 #include <assert.h>
 
@@ -25,6 +26,12 @@
 #define REG_WORDS_PER_CH (0x40 / 4)
 #define CHANNEL_REG(reg, n) (*(&(reg) + (n)*REG_WORDS_PER_CH))
 
+// Memory copy smaller than this will be performed by CPU, the overhead of
+// channel setup and interrupt is larger than CPU copy.
+#define AXIDMA_COPY_MIN_SIZE (4096)
+// Memory copy larger than this will be performed by CPU, count is 24 bits.
+#define AXIDMA_COPY_MAX_SIZE (0xfffffc)
+
 typedef REG_ARM_AXIDMA_AXIDMA_C0_CONF_T axidmaHwChConf_t;
 typedef REG_ARM_AXIDMA_AXIDMA_C0_MAP_T axidmaHwChMap_t;
 typedef REG_ARM_AXIDMA_AXIDMA_C0_COUNT_T axidmaHwChCount_t;
@@ -63,10 +70,20 @@ struct drv_axidma_channel
     void *param;
 };
 
+typedef struct
+{
+    osiCallback_t cb;     // callback of async copy
+    void *cb_ctx;         // callback context of async copy
+    osiSemaphore_t *sema; // semaphore of sync copy, created on first use
+    bool sync;            // sync copy, channel is released by caller
+    uint32_t pattern;     // source of memset
+} drvAxidmaCopy_t;
+
 typedef struct drv_axidma_context
 {
     drvAxidmaCh_t axidma_channels[AXIDMA_APCH_COUNT];
     uint32_t channel_count;
+    drvAxidmaCopy_t copies[AXIDMA_APCH_COUNT];
 
     // for suspend resume
     osiPmSource_t *pm_source;
@@ -297,6 +314,172 @@ void drvAxidmaChRegisterIsr(drvAxidmaCh_t *ch, drvAxidmaIsr_t isr, void *param)
     osiExitCritical(sc);
 }
 
+static void _axidmaCopyIsr(drvAxidmaIrqEvent_t evt, void *param)
+{
+    drvAxidmaCh_t *ch = (drvAxidmaCh_t *)param;
+    drvAxidmaCopy_t *copy = &gAxidmaCtx.copies[ch->id];
+
+    if ((evt & AD_EVT_FINISH) == 0)
+        return;
+
+    if (copy->sync)
+    {
+        osiSemaphoreRelease(copy->sema);
+        return;
+    }
+
+    osiCallback_t cb = copy->cb;
+    void *cb_ctx = copy->cb_ctx;
+    drvAxidmaChRelease(ch);
+    if (cb != NULL)
+        cb(cb_ctx);
+}
+
+static drvAxidmaCh_t *_axidmaCopyChAllocate(bool sync)
+{
+    drvAxidmaCh_t *ch = drvAxidmaChAllocate();
+    if (ch == NULL)
+        return NULL;
+
+    drvAxidmaCopy_t *copy = &gAxidmaCtx.copies[ch->id];
+    if (sync && copy->sema == NULL)
+        copy->sema = osiSemaphoreCreate(1, 0);
+
+    if (sync && copy->sema == NULL)
+    {
+        drvAxidmaChRelease(ch);
+        return NULL;
+    }
+
+    // no peripheral request, the same as the initial map
+    drvAxidmaChSetDmamap(ch, 0x1f, 0x1f);
+    drvAxidmaChRegisterIsr(ch, _axidmaCopyIsr, ch);
+    return ch;
+}
+
+static void _axidmaCopyStart(drvAxidmaCh_t *ch, drvAxidmaCfg_t *cfg, bool sync,
+                             osiCallback_t cb, void *cb_ctx)
+{
+    drvAxidmaCopy_t *copy = &gAxidmaCtx.copies[ch->id];
+    copy->cb = cb;
+    copy->cb_ctx = cb_ctx;
+    copy->sync = sync;
+
+    // Clean is needed for the partial cache lines at both ends of
+    // destination, which may be dirty.
+    osiDCacheCleanInvalidate((void *)cfg->dst_addr, cfg->data_size);
+
+    cfg->part_trans_size = OSI_MIN(uint32_t, cfg->data_size, 0xffff);
+    cfg->force_trans = 1;
+    cfg->mask = AD_EVT_FINISH;
+    drvAxidmaChStart(ch, cfg);
+
+    if (sync)
+    {
+        osiSemaphoreAcquire(copy->sema);
+        drvAxidmaChRelease(ch);
+    }
+}
+
+static bool _axidmaMemcpy(void *dst, const void *src, size_t size, bool sync,
+                          osiCallback_t cb, void *cb_ctx)
+{
+    if (size < AXIDMA_COPY_MIN_SIZE || size > AXIDMA_COPY_MAX_SIZE)
+        return false;
+
+    drvAxidmaCh_t *ch = _axidmaCopyChAllocate(sync);
+    if (ch == NULL)
+        return false;
+
+    drvAxidmaCfg_t cfg = {};
+    cfg.data_type = AD_DATA_8BIT;
+    if (OSI_IS_ALIGNED((uintptr_t)dst ^ (uintptr_t)src, 4))
+    {
+        // unaligned head and tail are copied by CPU, and the rest is
+        // transfered in 32 bits.
+        size_t head = OSI_ALIGN_UP(dst, 4) - (uintptr_t)dst;
+        size_t tail = (size - head) & 3;
+
+        memcpy(dst, src, head);
+        memcpy((char *)dst + size - tail, (const char *)src + size - tail, tail);
+        dst = (char *)dst + head;
+        src = (const char *)src + head;
+        size -= head + tail;
+        cfg.data_type = AD_DATA_32BIT;
+    }
+
+    osiDCacheClean(src, size);
+    cfg.src_addr = (uint32_t)src;
+    cfg.dst_addr = (uint32_t)dst;
+    cfg.data_size = size;
+    _axidmaCopyStart(ch, &cfg, sync, cb, cb_ctx);
+    return true;
+}
+
+static bool _axidmaMemset(void *dst, int c, size_t size, bool sync,
+                          osiCallback_t cb, void *cb_ctx)
+{
+    if (size < AXIDMA_COPY_MIN_SIZE || size > AXIDMA_COPY_MAX_SIZE)
+        return false;
+
+    drvAxidmaCh_t *ch = _axidmaCopyChAllocate(sync);
+    if (ch == NULL)
+        return false;
+
+    size_t head = OSI_ALIGN_UP(dst, 4) - (uintptr_t)dst;
+    size_t tail = (size - head) & 3;
+
+    memset(dst, c, head);
+    memset((char *)dst + size - tail, c, tail);
+    dst = (char *)dst + head;
+    size -= head + tail;
+
+    drvAxidmaCopy_t *copy = &gAxidmaCtx.copies[ch->id];
+    copy->pattern = (c & 0xff) * 0x01010101;
+    osiDCacheClean(&copy->pattern, sizeof(copy->pattern));
+
+    drvAxidmaCfg_t cfg = {};
+    cfg.src_addr = (uint32_t)&copy->pattern;
+    cfg.dst_addr = (uint32_t)dst;
+    cfg.data_size = size;
+    cfg.data_type = AD_DATA_32BIT;
+    cfg.src_addr_fix = 1;
+    _axidmaCopyStart(ch, &cfg, sync, cb, cb_ctx);
+    return true;
+}
+
+void drvAxidmaMemcpy(void *dst, const void *src, size_t size)
+{
+    if (!_axidmaMemcpy(dst, src, size, true, NULL, NULL))
+        memcpy(dst, src, size);
+}
+
+void drvAxidmaMemcpyAsync(void *dst, const void *src, size_t size, osiCallback_t cb, void *cb_ctx)
+{
+    if (_axidmaMemcpy(dst, src, size, false, cb, cb_ctx))
+        return;
+
+    memcpy(dst, src, size);
+    if (cb != NULL)
+        cb(cb_ctx);
+}
+
+void drvAxidmaMemset(void *dst, int c, size_t size)
+{
+    if (!_axidmaMemset(dst, c, size, true, NULL, NULL))
+        memset(dst, c, size);
+}
+
+void drvAxidmaMemsetAsync(void *dst, int c, size_t size, osiCallback_t cb, void *cb_ctx)
+{
+    if (_axidmaMemset(dst, c, size, false, cb, cb_ctx))
+        return;
+
+    memset(dst, c, size);
+    if (cb != NULL)
+        cb(cb_ctx);
+}
+
 static void _axidmaSuspend(void *ctx, osiSuspendMode_t mode)
 {
     drvAxidmaCtx_t *p = &gAxidmaCtx;
@@ -19,6 +19,20 @@
 #include "hal_chip.h"
 
 #define BACK_LIGHT_LEVEL_MAX (255)
+#define BACK_LIGHT_FADE_STEP_MIN_MS (16)
+
+typedef struct
+{
+    osiTimer_t *fade_timer;    // timer of fade steps
+    uint32_t level;            // current level
+    uint32_t fade_from;        // fade start level
+    uint32_t fade_to;          // fade target level
+    uint32_t fade_ms;          // fade duration
+    int64_t fade_start;        // fade start uptime
+    drvBackLightCurve_t curve; // fade curve
+} drvBackLightContext_t;
+
+static drvBackLightContext_t gBackLightCtx;
 
 static void prvSetBackLightLevel(uint32_t light_level)
 {
@@ -71,16 +85,121 @@ static void prvSetBackLightLevel(uint32_t light_level)
     return;
 }
 
+/**
+ * Fade progress in Q16, by curve
+ */
+static uint32_t prvFadeProgress(drvBackLightCurve_t curve, uint32_t elapsed, uint32_t duration)
+{
+    uint32_t f = ((uint64_t)elapsed << 16) / duration;
+    if (curve == DRV_BACKLIGHT_CURVE_EASE_IN)
+        return (f * f) >> 16;
+    if (curve == DRV_BACKLIGHT_CURVE_EASE_OUT)
+        return 0x10000 - (((0x10000 - f) * (0x10000 - f)) >> 16);
+    return f;
+}
+
+static void prvFadeStep(void *param)
+{
+    drvBackLightContext_t *d = &gBackLightCtx;
+
+    uint32_t critical = osiEnterCritical();
+    uint32_t from = d->fade_from;
+    uint32_t to = d->fade_to;
+    uint32_t duration = d->fade_ms;
+    drvBackLightCurve_t curve = d->curve;
+    int64_t elapsed = osiUpTime() - d->fade_start;
+    osiExitCritical(critical);
+
+    uint32_t level = to;
+    bool done = (elapsed >= duration);
+    if (!done)
+    {
+        int32_t delta = (int32_t)to - (int32_t)from;
+        uint32_t f = prvFadeProgress(curve, (uint32_t)elapsed, duration);
+        level = from + (delta * (int32_t)f) / 0x10000;
+    }
+
+    if (level != d->level)
+    {
+        prvSetBackLightLevel(level);
+        d->level = level;
+    }
+
+    if (done)
+        osiTimerStop(d->fade_timer);
+}
+
+static void prvFadeStop(void)
+{
+    drvBackLightContext_t *d = &gBackLightCtx;
+    if (d->fade_timer != NULL)
+        osiTimerStop(d->fade_timer);
+}
+
 bool drvBackLightOpen(uint32_t light_level)
 {
+    drvBackLightContext_t *d = &gBackLightCtx;
+
+    if (light_level > BACK_LIGHT_LEVEL_MAX)
+        light_level = BACK_LIGHT_LEVEL_MAX;
+
+    prvFadeStop();
     halPmuSwitchPower(HAL_POWER_BACK_LIGHT, true, false);
     prvSetBackLightLevel(light_level);
+    d->level = light_level;
     return true;
 }
 
 bool drvBackLightClose()
 {
+    drvBackLightContext_t *d = &gBackLightCtx;
+
+    prvFadeStop();
     halPmuSwitchPower(HAL_POWER_BACK_LIGHT, false, false);
+    d->level = 0;
 
     return true;
 }
+
+bool drvBackLightFade(uint32_t light_level, uint32_t duration_ms, drvBackLightCurve_t curve)
+{
+    drvBackLightContext_t *d = &gBackLightCtx;
+
+    if (light_level > BACK_LIGHT_LEVEL_MAX)
+        light_level = BACK_LIGHT_LEVEL_MAX;
+
+    prvFadeStop();
+
+    uint32_t diff = (light_level > d->level) ? light_level - d->level : d->level - light_level;
+    if (diff == 0 || duration_ms == 0)
+    {
+        prvSetBackLightLevel(light_level);
+        d->level = light_level;
+        return true;
+    }
+
+    if (d->fade_timer == NULL)
+    {
+        d->fade_timer = osiTimerCreate(NULL, prvFadeStep, NULL);
+        if (d->fade_timer == NULL)
+            return false;
+    }
+
+    uint32_t step_ms = OSI_MAX(uint32_t, duration_ms / diff, BACK_LIGHT_FADE_STEP_MIN_MS);
+
+    uint32_t critical = osiEnterCritical();
+    d->fade_from = d->level;
+    d->fade_to = light_level;
+    d->fade_ms = duration_ms;
+    d->fade_start = osiUpTime();
+    d->curve = curve;
+    osiExitCritical(critical);
+
+    osiTimerStartPeriodic(d->fade_timer, step_ms);
+    return true;
+}
+
+uint32_t drvBackLightGetLevel(void)
+{
+    return gBackLightCtx.level;
+}
@@ -21,13 +21,14 @@ typedef struct
 {
     HWP_I2C_MASTER_T *hwp;
     uint32_t irqn;
+    uint32_t irq_priority;
 } i2cMasterHw_t;
 
 #if defined(CONFIG_SOC_8910)
 static i2cMasterHw_t hw_masters[] = {
-    {.hwp = hwp_i2cMaster1, .irqn = HAL_SYSIRQ_NUM(SYS_IRQ_ID_I2C_M1)},
-    {.hwp = hwp_i2cMaster2, .irqn = HAL_SYSIRQ_NUM(SYS_IRQ_ID_I2C_M2)},
-    {.hwp = hwp_i2cMaster3, .irqn = HAL_SYSIRQ_NUM(SYS_IRQ_ID_I2C_M3)},
+    {.hwp = hwp_i2cMaster1, .irqn = HAL_SYSIRQ_NUM(SYS_IRQ_ID_I2C_M1), .irq_priority = SYS_IRQ_PRIO_I2C_M1},
+    {.hwp = hwp_i2cMaster2, .irqn = HAL_SYSIRQ_NUM(SYS_IRQ_ID_I2C_M2), .irq_priority = SYS_IRQ_PRIO_I2C_M2},
+    {.hwp = hwp_i2cMaster3, .irqn = HAL_SYSIRQ_NUM(SYS_IRQ_ID_I2C_M3), .irq_priority = SYS_IRQ_PRIO_I2C_M3},
 };
 #elif defined(CONFIG_SOC_8909)
 static i2cMasterHw_t hw_masters[] = {
@@ -54,6 +55,13 @@ struct drvI2cMaster
     drvI2cBps_t clk_mode;
     osiMutex_t *access_lock;
     osiPmSource_t *pm_source;
+    osiSemaphore_t *sync_sema;
+    drvI2cXfer_t *xfer_head; // head is the transaction in progress
+    drvI2cXfer_t *xfer_tail;
+    uint32_t msg_idx;
+    int byte_idx; // -1 for slave address
+    bool xfer_aborting;
+    bool raw_busy;
 };
 
 static drvI2cMaster_t gI2cMaster[I2C_MASTER_COUNT] = {};
@@ -61,6 +69,9 @@ static drvI2cMaster_t gI2cMaster[I2C_MASTER_COUNT] = {};
 /// Max i2c OPERATE TIME 10ms
 #define HAL_I2C_OPERATE_US 10000
 
+/// Wait timeout of each byte for synchronous transfer
+#define I2C_SYNC_BYTE_TIMEOUT_MS (HAL_I2C_OPERATE_US / 1000)
+
 static inline void _i2cSetClock(drvI2cMaster_t *d)
 {
 #if defined(CONFIG_SOC_8910) // TODO 8909/8955
@@ -105,118 +116,224 @@ static inline void _i2cClearIrqStatus(drvI2cMaster_t *d)
     d->hwp->irq_clr = irq_clr.v;
 }
 
+static inline void _i2cIrqEnable(drvI2cMaster_t *d, bool en)
+{
+    REG_I2C_MASTER_CTRL_T ctrl_reg = {d->hwp->ctrl};
+    ctrl_reg.b.irq_mask = en ? 1 : 0;
+    d->hwp->ctrl = ctrl_reg.v;
+}
+
 static inline bool _busyCheck(drvI2cMaster_t *d)
 {
     REG_I2C_MASTER_STATUS_T status = {d->hwp->status};
     return (status.b.tip || status.b.busy);
 }
 
-static bool _i2cSendByte(drvI2cMaster_t *d, uint8_t data, int start, int stop)
+static inline void _i2cCmdWrite(REG_I2C_MASTER_CMD_T *cmd)
 {
-    REG_I2C_MASTER_CMD_T master_cmd = {};
-
 #if defined(CONFIG_SOC_8910)
-    master_cmd.b.rw = 1;
-#elif defined(CONFIG_SOC_8955) || defined(CONFIG_SOC_8910)
-    master_cmd.b.wr = 1;
+    cmd->b.rw = 1;
+#elif defined(CONFIG_SOC_8955) || defined(CONFIG_SOC_8909)
+    cmd->b.wr = 1;
 #endif
+}
 
-    if (start)
-        master_cmd.b.sta = 1;
-    if (stop)
-        master_cmd.b.sto = 1;
+static void _i2cXferIssue(drvI2cMaster_t *d)
+{
+    drvI2cXfer_t *x = d->xfer_head;
+    const drvI2cMsg_t *m = &x->msgs[d->msg_idx];
+    bool last_msg = (d->msg_idx + 1 == x->count);
+    bool read = (m->flags & DRV_I2C_MSG_READ) != 0;
+    REG_I2C_MASTER_CMD_T cmd = {};
 
-    uint32_t sc = osiEnterCritical();
-    d->hwp->txrx_buffer = (REG32)data;
-    d->hwp->cmd = master_cmd.v;
-    osiExitCritical(sc);
+    if (d->byte_idx < 0)
+    {
+        // start (or repeated start) with slave address
+        d->hwp->txrx_buffer = (REG32)((m->addr << 1) | (read ? 1 : 0));
+        _i2cCmdWrite(&cmd);
+        cmd.b.sta = 1;
+        if (m->len == 0 && last_msg)
+            cmd.b.sto = 1;
+    }
+    else if (read)
+    {
+        cmd.b.rd = 1;
+        if (d->byte_idx + 1 == m->len)
+        {
+            cmd.b.ack = 1; // no ack for the last byte
+            if (last_msg)
+                cmd.b.sto = 1;
+        }
+    }
+    else
+    {
+        d->hwp->txrx_buffer = (REG32)m->buf[d->byte_idx];
+        _i2cCmdWrite(&cmd);
+        if (d->byte_idx + 1 == m->len && last_msg)
+            cmd.b.sto = 1;
+    }
+    d->hwp->cmd = cmd.v;
+}
 
-    OSI_LOGD(0, "DRV %4c data = 0x%08x, CMD = 0x%08x\n", d->name, data, master_cmd.v);
+static void _i2cXferStartLocked(drvI2cMaster_t *d)
+{
+    drvI2cXfer_t *x = d->xfer_head;
+    if (x == NULL || d->raw_busy)
+        return;
+
+    d->msg_idx = 0;
+    d->byte_idx = -1;
+    d->xfer_aborting = false;
+    _i2cClearIrqStatus(d);
+    _i2cIrqEnable(d, true);
+    _i2cXferIssue(d);
+}
 
-    uint32_t first_time = osiUpTimeUS(), second_time;
+static drvI2cXfer_t *_i2cXferPopLocked(drvI2cMaster_t *d)
+{
+    drvI2cXfer_t *x = d->xfer_head;
+    d->xfer_head = x->next;
+    if (d->xfer_head == NULL)
+        d->xfer_tail = NULL;
+    x->next = NULL;
+    return x;
+}
+
+static void _i2cXferFinishLocked(drvI2cMaster_t *d, bool ok)
+{
+    drvI2cXfer_t *x = _i2cXferPopLocked(d);
+    if (d->xfer_head != NULL)
+        _i2cXferStartLocked(d);
+    else
+        _i2cIrqEnable(d, false);
+
+    if (x->cb != NULL)
+        x->cb(x, ok);
+}
+
+static void _i2cAbortStop(drvI2cMaster_t *d)
+{
+    REG_I2C_MASTER_CMD_T cmd = {};
+    cmd.b.sto = 1;
+    d->hwp->cmd = cmd.v;
+}
+
+static void _i2cAbortStopWait(drvI2cMaster_t *d)
+{
+    _i2cAbortStop(d);
+
+    uint32_t first_time = osiUpTimeUS();
     REG_I2C_MASTER_STATUS_T status = {d->hwp->status};
-    while (!status.b.irq_status)
+    while (status.b.tip && osiUpTimeUS() - first_time < HAL_I2C_OPERATE_US)
+        status.v = d->hwp->status;
+    _i2cClearIrqStatus(d);
+}
+
+static void _i2cISR(void *ctx)
+{
+    drvI2cMaster_t *d = (drvI2cMaster_t *)ctx;
+    REG_I2C_MASTER_STATUS_T status = {d->hwp->status};
+    _i2cClearIrqStatus(d);
+
+    drvI2cXfer_t *x = d->xfer_head;
+    if (x == NULL || d->raw_busy)
+        return;
+
+    if (d->xfer_aborting)
     {
-        second_time = osiUpTimeUS();
-        if (second_time - first_time > HAL_I2C_OPERATE_US)
+        _i2cXferFinishLocked(d, false);
+        return;
+    }
+
+    const drvI2cMsg_t *m = &x->msgs[d->msg_idx];
+    bool read = (m->flags & DRV_I2C_MSG_READ) != 0;
+    bool last_msg = (d->msg_idx + 1 == x->count);
+    if ((d->byte_idx < 0 || !read) && status.b.rxack)
+    {
+        OSI_LOGE(0, "I2C master[%4c] slave 0x%x no ack", d->name, m->addr);
+        bool stopped = last_msg && (d->byte_idx + 1 == m->len || (d->byte_idx < 0 && m->len == 0));
+        if (stopped)
         {
-            if (!stop)
-            {
-                master_cmd.b.sto = 1;
-                d->hwp->cmd = master_cmd.v;
-            }
-            OSI_LOGE(0, "i2c_send(0x%x) TIMEOUT for not I2C_MASTER_IRQ_STATUS!\n", data);
-            return false;
+            _i2cXferFinishLocked(d, false);
         }
-        osiDelayUS(100);
-        status.v = d->hwp->status;
-    };
+        else
+        {
+            d->xfer_aborting = true;
+            _i2cAbortStop(d);
+        }
+        return;
+    }
 
-    _i2cClearIrqStatus(d);
+    if (d->byte_idx >= 0 && read)
+        m->buf[d->byte_idx] = (uint8_t)d->hwp->txrx_buffer;
 
-    // Check RxACK
-    status.v = d->hwp->status;
-    if (status.b.rxack)
+    d->byte_idx++;
+    if (d->byte_idx >= (int)m->len)
     {
-        if (!stop)
+        d->msg_idx++;
+        if (d->msg_idx >= x->count)
         {
-            // Abort the transfert
-            master_cmd.b.sto = 1;
-            d->hwp->cmd = master_cmd.v;
-            status.v = d->hwp->status;
-            while (status.b.rxack)
-            {
-                second_time = osiUpTimeUS();
-                if (second_time - first_time > HAL_I2C_OPERATE_US)
-                {
-                    OSI_LOGE(0, "i2c_send(0x%x) TIMEOUT for I2C_MASTER_RXACK!\n", data);
-                    return false;
-                }
-                osiDelayUS(100);
-                status.v = d->hwp->status;
-            };
-            _i2cClearIrqStatus(d);
+            _i2cXferFinishLocked(d, true);
+            return;
         }
+
+        d->byte_idx = (x->msgs[d->msg_idx].flags & DRV_I2C_MSG_NOSTART) ? 0 : -1;
     }
-    return true;
+    _i2cXferIssue(d);
 }
 
-static int _i2cGetByte(drvI2cMaster_t *d, int start, int stop, uint8_t *data)
+static bool _i2cXferValid(const drvI2cXfer_t *x)
 {
-    uint32_t second_time, first_time;
-    REG_I2C_MASTER_CMD_T cmd_reg = {};
-    cmd_reg.b.rd = 1;
-    if (start)
-        cmd_reg.b.sta = 1;
-    if (stop)
+    if (x->msgs == NULL || x->count == 0)
+        return false;
+
+    for (uint32_t n = 0; n < x->count; n++)
     {
-        cmd_reg.b.ack = 1;
-        cmd_reg.b.sto = 1;
+        const drvI2cMsg_t *m = &x->msgs[n];
+        bool read = (m->flags & DRV_I2C_MSG_READ) != 0;
+        if (m->len != 0 && m->buf == NULL)
+            return false;
+        if (read && m->len == 0)
+            return false;
+        if ((m->flags & DRV_I2C_MSG_NOSTART) &&
+            (n == 0 || read || m->len == 0 || (x->msgs[n - 1].flags & DRV_I2C_MSG_READ)))
+            return false;
     }
-    d->hwp->cmd = cmd_reg.v;
-
-    OSI_LOGD(0, "DRV %4c CMD  = 0x%08x\n", d->name, cmd_reg);
+    return true;
+}
 
-    first_time = osiUpTimeUS();
-    REG_I2C_MASTER_STATUS_T status = {d->hwp->status};
-    while (!status.b.irq_status)
+/**
+ * Raw byte APIs drive the controller directly. Wait the queued
+ * transactions done, and hold the queue until raw access done.
+ */
+static void _i2cRawBegin(drvI2cMaster_t *d)
+{
+    for (;;)
     {
-        second_time = osiUpTimeUS();
-        if (second_time - first_time > HAL_I2C_OPERATE_US)
+        uint32_t critical = osiEnterCritical();
+        if (d->xfer_head == NULL)
         {
-            OSI_LOGE(0, "i2c_send(0x%x, 0x%x) TIMEOUT for not I2C_MASTER_IRQ_STATUS!\n", data, cmd_reg);
-            return false;
+            d->raw_busy = true;
+            osiExitCritical(critical);
+            return;
         }
-        osiDelayUS(100);
-        status.v = d->hwp->status;
-    };
-
-    _i2cClearIrqStatus(d);
+        osiExitCritical(critical);
+        osiThreadSleep(1);
+    }
+}
 
-    if (NULL != data)
-        *data = (uint8_t)d->hwp->txrx_buffer;
+static void _i2cRawEnd(drvI2cMaster_t *d)
+{
+    // raw write doesn't wait the byte done
+    uint32_t first_time = osiUpTimeUS();
+    REG_I2C_MASTER_STATUS_T status = {d->hwp->status};
+    while (status.b.tip && osiUpTimeUS() - first_time < HAL_I2C_OPERATE_US)
+        status.v = d->hwp->status;
 
-    return true;
+    uint32_t critical = osiEnterCritical();
+    d->raw_busy = false;
+    _i2cXferStartLocked(d);
+    osiExitCritical(critical);
 }
 
 static void _i2cSuspend(void *ctx, osiSuspendMode_t mode)
@@ -287,7 +404,13 @@ static drvI2cMaster_t *_i2cMasterInitGet(uint32_t name, drvI2cBps_t bps)
         d->clk_mode = bps;
         d->access_lock = osiMutexCreate();
         d->pm_source = osiPmSourceCreate(name, &_i2cPmOps, d);
-        OSI_ASSERT(d->access_lock && d->pm_source, "I2C master init fail");
+        d->sync_sema = osiSemaphoreCreate(1, 0);
+        OSI_ASSERT(d->access_lock && d->pm_source && d->sync_sema, "I2C master init fail");
+
+        osiIrqSetHandler(d->irqn, _i2cISR, d);
+        if (hw_masters[devnum].irq_priority != 0)
+            osiIrqSetPriority(d->irqn, hw_masters[devnum].irq_priority);
+        osiIrqEnable(d->irqn);
     }
     osiExitCritical(sc);
 
@@ -332,128 +455,169 @@ void drvI2cMasterRelease(drvI2cMaster_t *d)
     }
 }
 
-static bool _i2cSetAddress(drvI2cMaster_t *d, const drvI2cSlave_t *slave, bool read)
+bool drvI2cXferSubmit(drvI2cMaster_t *d, drvI2cXfer_t *xfer)
 {
-    if (!_i2cSendByte(d, (slave->addr_device << 1), 1, 0))
-        return false;
-
-    if (!_i2cSendByte(d, slave->addr_data, 0, 0))
+    if (d == NULL || xfer == NULL || !_i2cXferValid(xfer))
         return false;
 
-    if (slave->reg_16bit)
+    xfer->next = NULL;
+    uint32_t critical = osiEnterCritical();
+    if (d->xfer_tail == NULL)
     {
-        if (!_i2cSendByte(d, slave->addr_data_low, 0, 0))
-            return false;
+        d->xfer_head = d->xfer_tail = xfer;
+        _i2cXferStartLocked(d);
     }
-    if (read)
+    else
     {
-        if (!_i2cSendByte(d, ((slave->addr_device << 1) | 0x1), 1, 0))
-            return false;
+        d->xfer_tail->next = xfer;
+        d->xfer_tail = xfer;
     }
-
+    osiExitCritical(critical);
     return true;
 }
 
-bool drvI2cWrite(drvI2cMaster_t *d, const drvI2cSlave_t *slave, const uint8_t *data, uint32_t length)
+bool drvI2cXferCancel(drvI2cMaster_t *d, drvI2cXfer_t *xfer)
 {
-    if (d == NULL || slave == NULL)
+    if (d == NULL || xfer == NULL)
         return false;
 
-    if (length == 0 || data == NULL)
-        return true;
-
-    if (_busyCheck(d))
+    bool found = false;
+    uint32_t critical = osiEnterCritical();
+    if (d->xfer_head == xfer)
     {
-        OSI_LOGE(0, "I2C master[%4c] send fail, busy", d->name);
-        return false;
+        found = true;
+        _i2cXferPopLocked(d);
+        if (!d->raw_busy)
+        {
+            _i2cIrqEnable(d, false);
+            _i2cAbortStopWait(d);
+        }
+        _i2cXferStartLocked(d);
+    }
+    else
+    {
+        for (drvI2cXfer_t *p = d->xfer_head; p != NULL; p = p->next)
+        {
+            if (p->next == xfer)
+            {
+                found = true;
+                p->next = xfer->next;
+                if (d->xfer_tail == xfer)
+                    d->xfer_tail = p;
+                xfer->next = NULL;
+                break;
+            }
+        }
     }
+    osiExitCritical(critical);
+    return found;
+}
 
-    bool result = false;
-    osiMutexLock(d->access_lock);
+typedef struct
+{
+    osiSemaphore_t *sema;
+    bool ok;
+} i2cSyncCtx_t;
 
-    // clear status bit in case previous transfer (Raw) hasn't cleared it.
-    _i2cClearIrqStatus(d);
+static void _i2cSyncDone(drvI2cXfer_t *xfer, bool ok)
+{
+    i2cSyncCtx_t *ctx = (i2cSyncCtx_t *)xfer->cb_ctx;
+    ctx->ok = ok;
+    osiSemaphoreRelease(ctx->sema);
+}
+
+bool drvI2cXferRun(drvI2cMaster_t *d, const drvI2cMsg_t *msgs, uint32_t count, uint32_t timeout)
+{
+    if (d == NULL)
+        return false;
 
-    if (!_i2cSetAddress(d, slave, false))
+    i2cSyncCtx_t ctx = {.sema = d->sync_sema, .ok = false};
+    drvI2cXfer_t xfer = {
+        .msgs = msgs,
+        .count = count,
+        .cb = _i2cSyncDone,
+        .cb_ctx = &ctx,
+    };
+
+    // sync_sema is shared by synchronous callers
+    osiMutexLock(d->access_lock);
+    if (!drvI2cXferSubmit(d, &xfer))
     {
-        OSI_LOGE(0, "I2C master[%4c] send fail, set address", d->name);
-        goto end;
+        osiMutexUnlock(d->access_lock);
+        return false;
     }
 
-    // write data before last one.
-    for (uint32_t c = 0; c < length - 1; c++)
+    if (!osiSemaphoreTryAcquire(d->sync_sema, timeout))
     {
-        if (!_i2cSendByte(d, data[c], 0, 0))
+        if (drvI2cXferCancel(d, &xfer))
         {
-            OSI_LOGE(0, "I2C master[%4c] send fail, send data fail", d->name);
-            goto end;
+            OSI_LOGE(0, "I2C master[%4c] transfer timeout", d->name);
+            ctx.ok = false;
+        }
+        else
+        {
+            // done just after timeout, consume the release
+            osiSemaphoreAcquire(d->sync_sema);
         }
     }
+    osiMutexUnlock(d->access_lock);
+    return ctx.ok;
+}
 
-    // Send last byte with stop condition
-    if (!_i2cSendByte(d, data[length - 1], 0, 1))
-    {
-        OSI_LOGE(0, "I2C master[%4c] send last byte fail", d->name);
-        goto end;
-    }
-
-    result = true;
+static uint32_t _i2cSetAddress(const drvI2cSlave_t *slave, uint8_t *reg)
+{
+    reg[0] = slave->addr_data;
+    if (!slave->reg_16bit)
+        return 1;
 
-end:
-    osiMutexUnlock(d->access_lock);
-    return result;
+    reg[1] = slave->addr_data_low;
+    return 2;
 }
 
-bool drvI2cRead(drvI2cMaster_t *d, const drvI2cSlave_t *slave, uint8_t *buf, uint32_t length)
+bool drvI2cWrite(drvI2cMaster_t *d, const drvI2cSlave_t *slave, const uint8_t *data, uint32_t length)
 {
     if (d == NULL || slave == NULL)
         return false;
 
-    if (buf == NULL || length == 0)
+    if (length == 0 || data == NULL)
         return true;
 
-    if (_busyCheck(d))
+    uint8_t reg[2];
+    drvI2cMsg_t msgs[2] = {
+        {.addr = slave->addr_device, .flags = 0, .buf = reg},
+        {.addr = slave->addr_device, .flags = DRV_I2C_MSG_NOSTART, .len = length, .buf = (uint8_t *)data},
+    };
+    msgs[0].len = _i2cSetAddress(slave, reg);
+
+    if (!drvI2cXferRun(d, msgs, 2, (length + 3) * I2C_SYNC_BYTE_TIMEOUT_MS))
     {
-        OSI_LOGE(0, "I2C master[%4c] read fail, busy", d->name);
+        OSI_LOGE(0, "I2C master[%4c] send fail", d->name);
         return false;
     }
+    return true;
+}
 
-    bool result = false;
-    osiMutexLock(d->access_lock);
-
-    // clear status bit in case previous transfer (Raw) hasn't cleared it.
-    _i2cClearIrqStatus(d);
+bool drvI2cRead(drvI2cMaster_t *d, const drvI2cSlave_t *slave, uint8_t *buf, uint32_t length)
+{
+    if (d == NULL || slave == NULL)
+        return false;
 
-    // write slave address (write mode, to write memory address)
-    if (!_i2cSetAddress(d, slave, true))
-    {
-        OSI_LOGE(0, "I2C master[%4c] read fail, send address", d->name);
-        goto end;
-    }
+    if (buf == NULL || length == 0)
+        return true;
 
-    // read all values but the last one
-    for (uint32_t c = 0; c < length - 1; c++)
-    {
-        // Read value
-        if (!_i2cGetByte(d, 0, 0, &buf[c]))
-        {
-            OSI_LOGE(0, "I2C master[%4c] read fail, read data fail", d->name);
-            goto end;
-        }
-    }
+    uint8_t reg[2];
+    drvI2cMsg_t msgs[2] = {
+        {.addr = slave->addr_device, .flags = 0, .buf = reg},
+        {.addr = slave->addr_device, .flags = DRV_I2C_MSG_READ, .len = length, .buf = buf},
+    };
+    msgs[0].len = _i2cSetAddress(slave, reg);
 
-    // Read last value - send no acknowledge - send stop condition/bit
-    if (!_i2cGetByte(d, 0, 1, &buf[length - 1]))
+    if (!drvI2cXferRun(d, msgs, 2, (length + 4) * I2C_SYNC_BYTE_TIMEOUT_MS))
     {
-        OSI_LOGE(0, "I2C master[%4c] read fail, read last byte fail", d->name);
-        goto end;
+        OSI_LOGE(0, "I2C master[%4c] read fail", d->name);
+        return false;
     }
-
-    result = true;
-
-end:
-    osiMutexUnlock(d->access_lock);
-    return result;
+    return true;
 }
 
 bool drvI2cWriteRawByte(drvI2cMaster_t *d, uint8_t send_byte, uint32_t cmd_mask)
@@ -461,16 +625,17 @@ bool drvI2cWriteRawByte(drvI2cMaster_t *d, uint8_t send_byte, uint32_t cmd_mask)
     if (d == NULL)
         return false;
 
+    bool result = false;
+    uint32_t second_time, first_time;
+    osiMutexLock(d->access_lock);
+    _i2cRawBegin(d);
+
     if (_busyCheck(d))
     {
         OSI_LOGE(0, "I2C master[%4c] write raw fail, busy", d->name);
-        return false;
+        goto end;
     }
 
-    bool result = false;
-    uint32_t second_time, first_time;
-    osiMutexLock(d->access_lock);
-
     first_time = osiUpTimeUS();
     REG_I2C_MASTER_STATUS_T status = {d->hwp->status};
 
@@ -491,6 +656,7 @@ bool drvI2cWriteRawByte(drvI2cMaster_t *d, uint8_t send_byte, uint32_t cmd_mask)
     result = true;
 
 end:
+    _i2cRawEnd(d);
     osiMutexUnlock(d->access_lock);
     return result;
 }
@@ -500,16 +666,17 @@ bool drvI2cReadRawByte(drvI2cMaster_t *d, uint8_t *data, uint32_t cmd_mask)
     if (d == NULL || data == NULL)
         return false;
 
+    bool result = false;
+    uint32_t second_time, first_time;
+    osiMutexLock(d->access_lock);
+    _i2cRawBegin(d);
+
     if (_busyCheck(d))
     {
         OSI_LOGE(0, "I2C master[%4c] read raw fail, busy", d->name);
-        return false;
+        goto end;
     }
 
-    bool result = false;
-    uint32_t second_time, first_time;
-    osiMutexLock(d->access_lock);
-
     first_time = osiUpTimeUS();
     REG_I2C_MASTER_STATUS_T status = {d->hwp->status};
     while (status.b.tip)
@@ -546,6 +713,7 @@ bool drvI2cReadRawByte(drvI2cMaster_t *d, uint8_t *data, uint32_t cmd_mask)
     result = true;
 
 end:
+    _i2cRawEnd(d);
     osiMutexUnlock(d->access_lock);
     return result;
 }
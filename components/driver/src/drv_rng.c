@@ -14,17 +14,35 @@
 
 #include "hal_config.h"
 #include "hal_chip.h"
+#include "drv_rng.h"
+#include "drv_aes.h"
 #include "osi_api.h"
 #include "osi_log.h"
 #include <string.h>
 #include <stdlib.h>
 
+#define DRBG_BLOCK_SIZE (16)
+#define DRBG_SEED_SIZE (32) // key + V
+#define DRBG_RESEED_INTERVAL (1024)
+#define DRBG_MAX_REQUEST (1024) // update key and V after each chunk
+
 typedef struct
 {
     bool (*rng_gen)(void *buf, unsigned len);
     osiMutex_t *lock;
 } drvRng_t;
 
+typedef struct
+{
+    osiMutex_t *lock;
+    bool seeded;
+    uint32_t reseed_counter;
+    uint8_t key[DRBG_BLOCK_SIZE];
+    uint8_t v[DRBG_BLOCK_SIZE];
+} drvRngDrbg_t;
+
+static drvRngDrbg_t gDrvRngDrbg;
+
 static bool drvRngGenerateInit(void *buf, unsigned len);
 static bool drvRngGenerate_(void *buf, unsigned len);
 
@@ -137,4 +155,135 @@ static bool drvRngGenerate_(void *buf, unsigned len)
 bool drvRngGenerate(void *buf, unsigned len)
 {
     return gDrvRng.rng_gen(buf, len);
+}
+
+static void prvDrbgIncrement(uint8_t *v)
+{
+    for (int n = DRBG_BLOCK_SIZE - 1; n >= 0; n--)
+    {
+        if (++v[n] != 0)
+            break;
+    }
+}
+
+/**
+ * CTR_DRBG_Update: key || V = E(key, V + 1) || E(key, V + 2) ^ data
+ */
+static void prvDrbgUpdate(drvRngDrbg_t *d, const uint8_t *data)
+{
+    uint8_t tmp[DRBG_SEED_SIZE];
+
+    prvDrbgIncrement(d->v);
+    memcpy(&tmp[0], d->v, DRBG_BLOCK_SIZE);
+    prvDrbgIncrement(d->v);
+    memcpy(&tmp[DRBG_BLOCK_SIZE], d->v, DRBG_BLOCK_SIZE);
+    aesEncryptObj(tmp, DRBG_SEED_SIZE, d->key);
+
+    if (data != NULL)
+    {
+        for (unsigned n = 0; n < DRBG_SEED_SIZE; n++)
+            tmp[n] ^= data[n];
+    }
+
+    memcpy(d->key, &tmp[0], DRBG_BLOCK_SIZE);
+    memcpy(d->v, &tmp[DRBG_BLOCK_SIZE], DRBG_BLOCK_SIZE);
+    memset(tmp, 0, sizeof(tmp));
+}
+
+/**
+ * Instantiate and reseed are the same without derivation function, just
+ * the initial key and V are zero at instantiate.
+ */
+static bool prvDrbgReseed(drvRngDrbg_t *d)
+{
+    uint8_t seed[DRBG_SEED_SIZE];
+    if (!drvRngGenerate(seed, DRBG_SEED_SIZE))
+        return false;
+
+    if (!d->seeded)
+    {
+        memset(d->key, 0, DRBG_BLOCK_SIZE);
+        memset(d->v, 0, DRBG_BLOCK_SIZE);
+    }
+
+    prvDrbgUpdate(d, seed);
+    memset(seed, 0, sizeof(seed));
+    d->reseed_counter = 1;
+    d->seeded = true;
+    return true;
+}
+
+static void prvDrbgGenerate(drvRngDrbg_t *d, uint8_t *out, unsigned len)
+{
+    // Counter blocks are filled in output buffer, and encrypted in place.
+    unsigned blocks = len / DRBG_BLOCK_SIZE;
+    for (unsigned n = 0; n < blocks; n++)
+    {
+        prvDrbgIncrement(d->v);
+        memcpy(out + n * DRBG_BLOCK_SIZE, d->v, DRBG_BLOCK_SIZE);
+    }
+    if (blocks > 0)
+        aesEncryptObj(out, blocks * DRBG_BLOCK_SIZE, d->key);
+
+    unsigned tail = len % DRBG_BLOCK_SIZE;
+    if (tail != 0)
+    {
+        uint8_t tmp[DRBG_BLOCK_SIZE];
+        prvDrbgIncrement(d->v);
+        memcpy(tmp, d->v, DRBG_BLOCK_SIZE);
+        aesEncryptObj(tmp, DRBG_BLOCK_SIZE, d->key);
+        memcpy(out + blocks * DRBG_BLOCK_SIZE, tmp, tail);
+        memset(tmp, 0, sizeof(tmp));
+    }
+
+    // backtracking resistance
+    prvDrbgUpdate(d, NULL);
+    d->reseed_counter++;
+}
+
+bool drvRngRandom(void *buf, unsigned len)
+{
+    drvRngDrbg_t *d = &gDrvRngDrbg;
+    uint8_t *out = (uint8_t *)buf;
+
+    if (d->lock == NULL)
+    {
+        osiMutex_t *lock = osiMutexCreate();
+        if (lock == NULL)
+            return false;
+
+        uint32_t critical = osiEnterCritical();
+        if (d->lock == NULL)
+        {
+            d->lock = lock;
+            lock = NULL;
+        }
+        osiExitCritical(critical);
+
+        if (lock != NULL)
+            osiMutexDelete(lock);
+    }
+
+    osiMutexLock(d->lock);
+    while (len > 0)
+    {
+        if (!d->seeded || d->reseed_counter > DRBG_RESEED_INTERVAL)
+        {
+            // Keep the old state if reseed failed, till the limit.
+            if (!prvDrbgReseed(d) &&
+                (!d->seeded || d->reseed_counter > 2 * DRBG_RESEED_INTERVAL))
+            {
+                OSI_LOGE(0, "DRBG reseed failed");
+                osiMutexUnlock(d->lock);
+                return false;
+            }
+        }
+
+        unsigned chunk = OSI_MIN(unsigned, len, DRBG_MAX_REQUEST);
+        prvDrbgGenerate(d, out, chunk);
+        out += chunk;
+        len -= chunk;
+    }
+    osiMutexUnlock(d->lock);
+    return true;
 }
\ No newline at end of file
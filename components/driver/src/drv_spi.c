@@ -76,6 +76,9 @@ struct drvSpiMaster
     void (*callback)(drvSpiIrq cause);
     osiMutex_t *access_lock;
     osiPmSource_t *pm_source;
+    osiSemaphore_t *done_sema;    // blocking transfer in SPI_DMA_IRQ mode
+    drvSpiTransfer_t *xfer_head;  // running transfer
+    drvSpiTransfer_t *xfer_tail;
 };
 
 static drvSpiMaster_t gSpiMaster[SPI_MASTER_COUNT] = {};
@@ -177,7 +180,10 @@ static drvSpiMaster_t *_drvSpiInitGet(drvSpiConfig_t cfg)
     drvIfcRequestChannel(&d->tx_ifc);
     drvIfcRequestChannel(&d->rx_ifc);
     d->pm_source = osiPmSourceCreate(d->config.name, &_spiPmOps, d);
-    OSI_ASSERT(d->access_lock && d->pm_source, "spi init fail");
+    d->done_sema = osiSemaphoreCreate(1, 0);
+    d->xfer_head = NULL;
+    d->xfer_tail = NULL;
+    OSI_ASSERT(d->access_lock && d->pm_source && d->done_sema, "spi init fail");
     osiExitCritical(sc);
     return d;
 }
@@ -322,6 +328,141 @@ static uint8_t _drvSpiSend(drvSpiMaster_t *d, uint8_t *sendaddr, uint32_t len)
     return 0;
 }
 
+/**
+ * Start DMA of the transfer, called in ISR or critical section
+ */
+static void _drvSpiXferStart(drvSpiMaster_t *d, drvSpiTransfer_t *x)
+{
+    _drvSpiFlushFifos(d);
+    _drvClearTxDmaDone(d);
+    _drvClearRxDmaDone(d);
+    _setCsSet(d, x->cs);
+    drvIfcFlush(&d->tx_ifc);
+    if (x->rx != NULL)
+    {
+        drvIfcFlush(&d->rx_ifc);
+        drvIfcStart(&d->rx_ifc, x->rx, x->len);
+    }
+    drvIfcStart(&d->tx_ifc, x->tx, x->len);
+}
+
+/**
+ * Check whether the running transfer is finished. When finished, start
+ * the next one before the callback to keep the bus busy. Called in ISR.
+ */
+static void _drvSpiXferCheck(drvSpiMaster_t *d, drvSpiIrq cause)
+{
+    drvSpiTransfer_t *x = d->xfer_head;
+    if (x == NULL)
+        return;
+
+    if (x->rx != NULL)
+    {
+        if (!cause.rxDmaDone || drvIfcGetTC(&d->rx_ifc) != 0)
+            return;
+        osiDCacheInvalidate(x->rx, x->len);
+    }
+    else
+    {
+        if (!cause.txDmaDone || drvIfcGetTC(&d->tx_ifc) != 0)
+            return;
+        // DMA done only means the data are in FIFO, wait the FIFO tail
+        while (!_drvWaitTxFinish(d))
+            ;
+    }
+
+    d->xfer_head = x->next;
+    if (d->xfer_head == NULL)
+        d->xfer_tail = NULL;
+    else
+        _drvSpiXferStart(d, d->xfer_head);
+
+    x->next = NULL;
+    if (x->cb != NULL)
+        x->cb(x->cb_ctx, x);
+}
+
+bool drvSpiTransferSubmit(drvSpiMaster_t *d, drvSpiTransfer_t *xfers, unsigned count)
+{
+    if (d == NULL || xfers == NULL || count == 0)
+        return false;
+    if (d->config.transmode != SPI_DMA_IRQ)
+        return false;
+
+    for (unsigned n = 0; n < count; n++)
+    {
+        drvSpiTransfer_t *x = &xfers[n];
+        if (!IS_SPI_CS(x->cs) || x->tx == NULL || x->len == 0)
+            return false;
+
+        osiDCacheClean(x->tx, x->len);
+        if (x->rx != NULL)
+            osiDCacheCleanInvalidate(x->rx, x->len);
+        x->next = (n + 1 < count) ? &xfers[n + 1] : NULL;
+    }
+
+    uint32_t critical = osiEnterCritical();
+    if (d->xfer_head == NULL)
+    {
+        d->xfer_head = xfers;
+        d->xfer_tail = &xfers[count - 1];
+        _drvSpiXferStart(d, xfers);
+    }
+    else
+    {
+        d->xfer_tail->next = xfers;
+        d->xfer_tail = &xfers[count - 1];
+    }
+    osiExitCritical(critical);
+    return true;
+}
+
+bool drvSpiTransferBusy(drvSpiMaster_t *d)
+{
+    return d->xfer_head != NULL;
+}
+
+static void _drvSpiXferWaitDone(void *ctx, drvSpiTransfer_t *xfer)
+{
+    osiSemaphoreRelease((osiSemaphore_t *)ctx);
+}
+
+/**
+ * Blocking transfer in SPI_DMA_IRQ mode, the thread waits on semaphore
+ * rather than polling
+ */
+static bool _drvSpiXferBlocking(drvSpiMaster_t *d, drvSpiCsSel cs, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    drvSpiTransfer_t xfer = {
+        .cs = cs,
+        .tx = tx,
+        .rx = rx,
+        .len = len,
+        .cb = _drvSpiXferWaitDone,
+        .cb_ctx = d->done_sema,
+    };
+
+    osiMutexLock(d->access_lock);
+    bool ok = drvSpiTransferSubmit(d, &xfer, 1);
+    if (ok)
+        osiSemaphoreAcquire(d->done_sema);
+    osiMutexUnlock(d->access_lock);
+    return ok;
+}
+
+/**
+ * In SPI_DMA_IRQ mode, DMA done interrupts are always enabled for
+ * transfer queue
+ */
+static void _drvSpiIrqMaskDma(drvSpiMaster_t *d, REG_SPI_IRQ_T *irq)
+{
+    if (d->config.transmode == SPI_DMA_IRQ)
+    {
+        irq->b.mask_tx_dma_irq = 1;
+        irq->b.mask_rx_dma_irq = 1;
+    }
+}
+
 static void _drvSpiIrqHandle(void *ctx)
 {
     drvSpiMaster_t *d = (drvSpiMaster_t *)ctx;
@@ -341,6 +482,7 @@ static void _drvSpiIrqHandle(void *ctx)
     if (status.b.cause_rx_dma_irq)
         cause.rxDmaDone = 1;
     d->hwp->status = status.v;
+    _drvSpiXferCheck(d, cause);
     if (d->callback)
         d->callback(cause);
 }
@@ -371,7 +513,11 @@ static uint8_t _drvSpiRead(drvSpiMaster_t *d, uint8_t *sendaddr, uint8_t *readad
 bool drvSpiWrite(drvSpiMaster_t *d, drvSpiCsSel cs, uint8_t *sendaddr, uint32_t len)
 {
     OSI_ASSERT(IS_SPI_CS(cs), "SPI CS ERROR");
-    if (d != NULL && sendaddr != NULL && len > 0)
+    if (d != NULL && sendaddr != NULL && len > 0 && d->config.transmode == SPI_DMA_IRQ)
+    {
+        return _drvSpiXferBlocking(d, cs, sendaddr, NULL, len);
+    }
+    else if (d != NULL && sendaddr != NULL && len > 0)
     {
         osiMutexLock(d->access_lock);
         _drvSpiFlushFifos(d);
@@ -387,10 +533,10 @@ bool drvSpiWrite(drvSpiMaster_t *d, drvSpiCsSel cs, uint8_t *sendaddr, uint32_t
             }
             while (!_drvWaitTxFinish(d))
                 ;
-            osiMutexLock(d->access_lock);
+            osiMutexUnlock(d->access_lock);
             return true;
         }
-        else if (d->config.transmode == SPI_DMA_POLLING || d->config.transmode == SPI_DMA_IRQ)
+        else if (d->config.transmode == SPI_DMA_POLLING)
         {
             osiDCacheClean(sendaddr, len);
             drvIfcFlush(&d->tx_ifc);
@@ -415,7 +561,11 @@ bool drvSpiWrite(drvSpiMaster_t *d, drvSpiCsSel cs, uint8_t *sendaddr, uint32_t
 bool drvSpiRead(drvSpiMaster_t *d, drvSpiCsSel cs, uint8_t *sendaddr, uint8_t *readaddr, uint32_t len)
 {
     OSI_ASSERT(IS_SPI_CS(cs), "SPI CS ERROR");
-    if (d != NULL && readaddr != NULL && len > 0)
+    if (d != NULL && readaddr != NULL && len > 0 && d->config.transmode == SPI_DMA_IRQ)
+    {
+        return _drvSpiXferBlocking(d, cs, sendaddr, readaddr, len);
+    }
+    else if (d != NULL && readaddr != NULL && len > 0)
     {
         osiMutexLock(d->access_lock);
         _drvSpiFlushFifos(d);
@@ -430,10 +580,10 @@ bool drvSpiRead(drvSpiMaster_t *d, drvSpiCsSel cs, uint8_t *sendaddr, uint8_t *r
                 sendaddr += readlen;
                 len -= readlen;
             }
-            osiMutexLock(d->access_lock);
+            osiMutexUnlock(d->access_lock);
             return true;
         }
-        else if (d->config.transmode == SPI_DMA_POLLING || d->config.transmode == SPI_DMA_IRQ)
+        else if (d->config.transmode == SPI_DMA_POLLING)
         {
             osiDCacheClean(sendaddr, len);
             osiDCacheClean(readaddr, len);
@@ -504,6 +654,17 @@ drvSpiMaster_t *drvSpiMasterAcquire(drvSpiConfig_t cfg)
 
         d->hwp->ctrl = spi_ctrl.v;
         d->hwp->cfg = spi_cfg.v;
+
+        if (d->config.transmode == SPI_DMA_IRQ)
+        {
+            REG_SPI_IRQ_T irq = {};
+            _drvSpiIrqMaskDma(d, &irq);
+            d->hwp->irq = irq.v;
+            osiIrqDisable(d->irqn);
+            osiIrqSetHandler(d->irqn, _drvSpiIrqHandle, d);
+            osiIrqSetPriority(d->irqn, d->prio);
+            osiIrqEnable(d->irqn);
+        }
         return d;
     }
     return NULL;
@@ -519,6 +680,7 @@ void drvSpiSetIrq(drvSpiMaster_t *d, drvSpiIrq *mask, callback callfunc)
     irq.b.mask_rx_dma_irq = mask->rxDmaDone;
     irq.b.tx_threshold = mask->Tx_Rthreshold;
     irq.b.rx_threshold = mask->Rx_Tthreshold;
+    _drvSpiIrqMaskDma(d, &irq);
     d->hwp->irq = irq.v;
     d->callback = callfunc;
     osiIrqDisable(d->irqn);
@@ -531,13 +693,18 @@ void drvSpiClrIrq(drvSpiMaster_t *d)
 {
     REG_SPI_IRQ_T irq;
     irq.v = 0;
+    _drvSpiIrqMaskDma(d, &irq);
     d->hwp->irq = irq.v;
     d->callback = NULL;
-    osiIrqDisable(d->irqn);
+    if (d->config.transmode != SPI_DMA_IRQ)
+        osiIrqDisable(d->irqn);
 }
 
 void drvSpiMasterRelease(drvSpiMaster_t *d)
 {
+    osiIrqDisable(d->irqn);
+    d->xfer_head = NULL;
+    d->xfer_tail = NULL;
     d->irqn = 0;
     d->hwp->ctrl = d->hwp_default.ctrl;
     d->hwp->cfg = d->hwp_default.cfg;
@@ -546,6 +713,7 @@ void drvSpiMasterRelease(drvSpiMaster_t *d)
     d->hwp->pin_control = d->hwp_default.pin_control;
     d->hwp->irq = d->hwp_default.irq;
     osiMutexDelete(d->access_lock);
+    osiSemaphoreDelete(d->done_sema);
     drvIfcReleaseChannel(&d->rx_ifc);
     drvIfcReleaseChannel(&d->tx_ifc);
     osiPmSourceDelete(d->pm_source);
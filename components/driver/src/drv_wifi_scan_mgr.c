@@ -0,0 +1,192 @@
+/* Copyright (C) 2019 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "drv_wifi.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define WIFI_SCAN_MGR_AP_MAX (32)
+#define WIFI_SCAN_MGR_RUN_AP_MAX (16)
+#define WIFI_SCAN_MGR_CHANNELS_PER_RUN (3)
+#define WIFI_SCAN_MGR_CHANNEL_TIME (120)
+
+typedef struct
+{
+    wifiApInfo_t info;
+    int64_t seen; ///< uptime in ms of last seen, 0 for empty entry
+} wifiScanMgrAp_t;
+
+typedef struct
+{
+    drvWifi_t *d;
+    osiWork_t *work;
+    osiTimer_t *timer;
+    uint8_t next_ch;
+    wifiScanMgrAp_t aps[WIFI_SCAN_MGR_AP_MAX];
+} wifiScanMgr_t;
+
+static wifiScanMgr_t gWifiScanMgr;
+
+/**
+ * Merge one AP into table. Existed AP will be updated, or the entry not
+ * seen for the longest time is replaced.
+ */
+static void prvMergeAp(const wifiApInfo_t *info, int64_t now)
+{
+    wifiScanMgr_t *p = &gWifiScanMgr;
+    wifiScanMgrAp_t *victim = &p->aps[0];
+
+    uint32_t critical = osiEnterCritical();
+    for (unsigned n = 0; n < WIFI_SCAN_MGR_AP_MAX; n++)
+    {
+        wifiScanMgrAp_t *ap = &p->aps[n];
+        if (ap->seen != 0 &&
+            ap->info.bssid_low == info->bssid_low &&
+            ap->info.bssid_high == info->bssid_high)
+        {
+            victim = ap;
+            break;
+        }
+
+        if (ap->seen < victim->seen)
+            victim = ap;
+    }
+
+    victim->info = *info;
+    victim->seen = now;
+    osiExitCritical(critical);
+}
+
+static void prvScanRun(void *param)
+{
+    wifiScanMgr_t *p = &gWifiScanMgr;
+    drvWifi_t *d = p->d;
+    if (d == NULL)
+        return;
+
+    wifiApInfo_t aps[WIFI_SCAN_MGR_RUN_AP_MAX];
+    wifiScanRequest_t req = {
+        .max = WIFI_SCAN_MGR_RUN_AP_MAX,
+        .maxtimeout = WIFI_SCAN_MGR_CHANNEL_TIME,
+        .aps = aps,
+    };
+
+    for (unsigned n = 0; n < WIFI_SCAN_MGR_CHANNELS_PER_RUN; n++)
+    {
+        req.found = 0;
+        if (!drvWifiScanChannel(d, &req, p->next_ch))
+        {
+            OSI_LOGD(0, "wifi scan mgr busy, skip channel %d", p->next_ch);
+            return;
+        }
+
+        drvWifiScanMgrUpdate(aps, req.found);
+        p->next_ch = (p->next_ch >= WIFI_CHANNEL_MAX) ? 1 : p->next_ch + 1;
+    }
+}
+
+bool drvWifiScanMgrStart(drvWifi_t *d, uint32_t period_ms, uint32_t relax_ms)
+{
+    wifiScanMgr_t *p = &gWifiScanMgr;
+    if (d == NULL || period_ms == 0)
+        return false;
+
+    drvWifiScanMgrStop();
+
+    if (p->work == NULL)
+    {
+        p->work = osiWorkCreate(prvScanRun, NULL, NULL);
+        if (p->work == NULL)
+            return false;
+    }
+
+    if (p->timer == NULL)
+    {
+        p->timer = osiTimerCreateWork(p->work, osiSysWorkQueueLowPriority());
+        if (p->timer == NULL)
+            return false;
+    }
+
+    if (p->next_ch == 0)
+        p->next_ch = 1;
+    p->d = d;
+    osiTimerStartPeriodicRelaxed(p->timer, period_ms, relax_ms);
+    OSI_LOGI(0, "wifi scan mgr start, period %u relax %u", period_ms, relax_ms);
+    return true;
+}
+
+void drvWifiScanMgrStop(void)
+{
+    wifiScanMgr_t *p = &gWifiScanMgr;
+    if (p->d == NULL)
+        return;
+
+    p->d = NULL;
+    osiTimerStop(p->timer);
+    osiWorkCancel(p->work);
+    osiWorkWaitFinish(p->work, OSI_WAIT_FOREVER);
+    OSI_LOGI(0, "wifi scan mgr stop");
+}
+
+void drvWifiScanMgrUpdate(const wifiApInfo_t *aps, uint32_t count)
+{
+    if (aps == NULL)
+        return;
+
+    int64_t now = osiUpTime();
+    for (uint32_t n = 0; n < count; n++)
+        prvMergeAp(&aps[n], now);
+}
+
+static int prvApRssiCompare(const void *ctx1, const void *ctx2)
+{
+    const wifiApInfo_t *w1 = (const wifiApInfo_t *)ctx1;
+    const wifiApInfo_t *w2 = (const wifiApInfo_t *)ctx2;
+    return (w2->rssival - w1->rssival);
+}
+
+uint32_t drvWifiScanMgrGetAps(wifiApInfo_t *aps, uint32_t max, uint32_t max_age_ms)
+{
+    wifiScanMgr_t *p = &gWifiScanMgr;
+    wifiApInfo_t found[WIFI_SCAN_MGR_AP_MAX];
+    uint32_t count = 0;
+
+    if (aps == NULL || max == 0)
+        return 0;
+
+    int64_t now = osiUpTime();
+    uint32_t critical = osiEnterCritical();
+    for (unsigned n = 0; n < WIFI_SCAN_MGR_AP_MAX; n++)
+    {
+        wifiScanMgrAp_t *ap = &p->aps[n];
+        if (ap->seen != 0 && now - ap->seen <= max_age_ms)
+            found[count++] = ap->info;
+    }
+    osiExitCritical(critical);
+
+    qsort(found, count, sizeof(wifiApInfo_t), prvApRssiCompare);
+    if (count > max)
+        count = max;
+    memcpy(aps, found, count * sizeof(wifiApInfo_t));
+    return count;
+}
+
+void drvWifiScanMgrClear(void)
+{
+    wifiScanMgr_t *p = &gWifiScanMgr;
+
+    uint32_t critical = osiEnterCritical();
+    memset(p->aps, 0, sizeof(p->aps));
+    osiExitCritical(critical);
+}
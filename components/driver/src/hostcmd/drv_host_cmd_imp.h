@@ -55,6 +55,13 @@ enum
     HOST_SYSCMD_SXTIMERINFO = 0x1b,
     HOST_SYSCMD_LISTPARTION = 0x1c,
     HOST_SYSCMD_PROFILEMODE = 0x1d,
+    HOST_SYSCMD_THREADCPUINFO = 0x1e,
+    HOST_SYSCMD_PROFILESTREAM = 0x1f,
+    HOST_SYSCMD_MEMTRACK = 0x20,
+    HOST_SYSCMD_PMSTATINFO = 0x21,
+    HOST_SYSCMD_IRQOFFSTAT = 0x22,
+    HOST_SYSCMD_IRQSTAT = 0x23,
+    HOST_SYSCMD_MEMREPORT = 0x24,
     HOST_SYSCMD_INVALID = 0xff,
 };
 
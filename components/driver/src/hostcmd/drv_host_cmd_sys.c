@@ -505,6 +505,101 @@ void drvHostSyscmdHandler(drvHostCmdEngine_t *cmd, uint8_t *packet, unsigned pac
         osiProfileSetMode(mode);
         drvHostCmdSendResultCode(cmd, packet, 0);
     }
+    else if (cmd_code == HOST_SYSCMD_PROFILESTREAM)
+    {
+        // payload: streaming interval in milliseconds (LE16), 0 to stop
+        unsigned interval = osiBytesGetLe16(payload);
+        bool ok = true;
+        if (interval == 0)
+            osiProfileStreamStop();
+        else
+            ok = osiProfileStreamStart(interval);
+        drvHostCmdSendResultCode(cmd, packet, ok ? 0 : 0xffff);
+    }
+    else if (cmd_code == HOST_SYSCMD_IRQOFFSTAT)
+    {
+        // payload: non-zero byte to reset, or empty to dump
+        if (packet_len >= PACKET_OVERHEAD + 1 && payload[0] != 0)
+        {
+            osiIrqOffStat(NULL, 0, true);
+            drvHostCmdSendResultCode(cmd, packet, 0);
+        }
+        else
+        {
+            int size = osiIrqOffStatDump(payload, PAYLOAD_MAX);
+            if (size <= 0)
+                drvHostCmdSendResultCode(cmd, packet, 0xffff);
+            else
+                drvHostCmdSendResponse(cmd, packet, PACKET_OVERHEAD + size);
+        }
+    }
+    else if (cmd_code == HOST_SYSCMD_IRQSTAT)
+    {
+        // payload: non-zero byte to reset, or empty to dump
+        if (packet_len >= PACKET_OVERHEAD + 1 && payload[0] != 0)
+        {
+            osiIrqStat(NULL, 0, true);
+            drvHostCmdSendResultCode(cmd, packet, 0);
+        }
+        else
+        {
+            int size = osiIrqStatDump(payload, PAYLOAD_MAX);
+            if (size <= 0)
+                drvHostCmdSendResultCode(cmd, packet, 0xffff);
+            else
+                drvHostCmdSendResponse(cmd, packet, PACKET_OVERHEAD + size);
+        }
+    }
+    else if (cmd_code == HOST_SYSCMD_PMSTATINFO)
+    {
+        int size = osiPmStatDump(payload, PAYLOAD_MAX);
+        if (size <= 0)
+            drvHostCmdSendResultCode(cmd, packet, 0xffff);
+        else
+            drvHostCmdSendResponse(cmd, packet, PACKET_OVERHEAD + size);
+    }
+    else if (cmd_code == HOST_SYSCMD_MEMTRACK)
+    {
+        // payload: sampling rate (LE16) to be set, or empty to dump
+        if (packet_len >= PACKET_OVERHEAD + 2)
+        {
+            osiMemTrackSetRate(osiBytesGetLe16(payload));
+            drvHostCmdSendResultCode(cmd, packet, 0);
+        }
+        else
+        {
+            int size = osiMemTrackDump(payload, PAYLOAD_MAX);
+            if (size <= 0)
+                drvHostCmdSendResultCode(cmd, packet, 0xffff);
+            else
+                drvHostCmdSendResponse(cmd, packet, PACKET_OVERHEAD + size);
+        }
+    }
+    else if (cmd_code == HOST_SYSCMD_MEMREPORT)
+    {
+        // payload: low available size and low block size (LE32) to be set, or empty to dump
+        if (packet_len >= PACKET_OVERHEAD + 8)
+        {
+            osiMemPressureSetThreshold(osiBytesGetLe32(payload), osiBytesGetLe32(payload + 4));
+            drvHostCmdSendResultCode(cmd, packet, 0);
+        }
+        else
+        {
+            int size = osiMemReportDump(payload, PAYLOAD_MAX);
+            if (size <= 0)
+                drvHostCmdSendResultCode(cmd, packet, 0xffff);
+            else
+                drvHostCmdSendResponse(cmd, packet, PACKET_OVERHEAD + size);
+        }
+    }
+    else if (cmd_code == HOST_SYSCMD_THREADCPUINFO)
+    {
+        int size = osiThreadCpuStatDump(payload, PAYLOAD_MAX);
+        if (size <= 0)
+            drvHostCmdSendResultCode(cmd, packet, 0xffff);
+        else
+            drvHostCmdSendResponse(cmd, packet, PACKET_OVERHEAD + size);
+    }
     else
     {
         drvHostInvalidCmd(cmd, packet, packet_len);
@@ -19,7 +19,26 @@
 #include "image_sensor.h"
 #include "drv_camera.h"
 
+#define CAM_STREAM_THREAD_PRIORITY (OSI_PRIORITY_ABOVE_NORMAL)
+#define CAM_STREAM_STACK_SIZE (2048)
+
+typedef struct
+{
+    osiThread_t *thread;
+    osiSemaphore_t *exit_sema;
+    drvCamFrameCB_t cb;
+    void *cb_ctx;
+    uint32_t seq;
+    volatile bool running;
+#ifdef CONFIG_LCD_SUPPORT
+    drvLcd_t *lcd;
+    drvLcdVideoLayer_t vl;
+    osiSemaphore_t *lcd_done_sema;
+#endif
+} camStream_t;
+
 static IMAGE_DEV_T ImageSensor;
+static camStream_t gCamStream;
 static SensorOps_t SensorOpsApi = {
     0,
 };
@@ -105,6 +124,7 @@ static bool prvCamSetFrameBuffer(uint16_t *FrameBuf[], uint8_t nBufcounts)
 
 void drvCamClose(void)
 {
+    drvCamStopStream();
     if (ImageSensor.poweron_flag)
     {
         ImageSensor.poweron_flag = false;
@@ -295,6 +315,133 @@ bool drvCamInit(void)
         return false;
 }
 
+#ifdef CONFIG_LCD_SUPPORT
+static void prvCamStreamLcdDone(void *param)
+{
+    drvCamPreviewQBUF((uint16_t *)param);
+    osiSemaphoreRelease(gCamStream.lcd_done_sema);
+}
+
+static bool prvCamStreamPreview(camStream_t *st, uint16_t *buf)
+{
+    if (st->lcd == NULL)
+        return false;
+
+    // wait previous preview done, and GOUDA will read the frame buffer
+    // directly, the buffer is given back to camera at GOUDA done.
+    osiSemaphoreAcquire(st->lcd_done_sema);
+    st->vl.buf = buf;
+    drvLcdLayers_t layers = {
+        .vl = &st->vl,
+        .layer_roi = st->vl.out,
+        .screen_roi = st->vl.out,
+    };
+    if (!drvLcdFlushAsync(st->lcd, &layers, prvCamStreamLcdDone, buf))
+    {
+        osiSemaphoreRelease(st->lcd_done_sema);
+        return false;
+    }
+    return true;
+}
+
+void drvCamSetStreamPreview(drvLcd_t *lcd, const drvLcdVideoLayer_t *vl)
+{
+    if (gCamStream.running)
+        return;
+
+    gCamStream.lcd = lcd;
+    if (lcd != NULL)
+        gCamStream.vl = *vl;
+}
+#endif
+
+static void prvCamStreamThread(void *param)
+{
+    camStream_t *st = (camStream_t *)param;
+    while (st->running)
+    {
+        uint16_t *buf = drvCamPreviewDQBUF();
+        if (!st->running)
+            break;
+
+        drvCamFrame_t frame = {
+            .buf = buf,
+            .size = ImageSensor.nPixcels,
+            .seq = st->seq++,
+            .timestamp = osiUpTimeUS(),
+        };
+        if (st->cb != NULL)
+            st->cb(&frame, st->cb_ctx);
+
+#ifdef CONFIG_LCD_SUPPORT
+        if (prvCamStreamPreview(st, buf))
+            continue;
+#endif
+        drvCamPreviewQBUF(buf);
+    }
+
+#ifdef CONFIG_LCD_SUPPORT
+    if (st->lcd != NULL)
+        osiSemaphoreAcquire(st->lcd_done_sema);
+#endif
+    osiSemaphoreRelease(st->exit_sema);
+    osiThreadExit();
+}
+
+bool drvCamStartStream(drvCamFrameCB_t cb, void *ctx)
+{
+    camStream_t *st = &gCamStream;
+    OSI_LOGI(0, "cam: drvCamStartStream");
+    if (!ImageSensor.poweron_flag || st->running)
+        return false;
+
+    if (st->exit_sema == NULL)
+        st->exit_sema = osiSemaphoreCreate(1, 0);
+#ifdef CONFIG_LCD_SUPPORT
+    if (st->lcd_done_sema == NULL)
+        st->lcd_done_sema = osiSemaphoreCreate(1, 1);
+    if (st->lcd_done_sema == NULL)
+        return false;
+#endif
+    if (st->exit_sema == NULL)
+        return false;
+
+    st->cb = cb;
+    st->cb_ctx = ctx;
+    st->seq = 0;
+    st->running = true;
+    if (!drvCamStartPreview())
+    {
+        st->running = false;
+        return false;
+    }
+
+    st->thread = osiThreadCreate("cam_stream", prvCamStreamThread, st,
+                                 CAM_STREAM_THREAD_PRIORITY, CAM_STREAM_STACK_SIZE, 0);
+    if (st->thread == NULL)
+    {
+        st->running = false;
+        drvCamStopPreview();
+        return false;
+    }
+    return true;
+}
+
+void drvCamStopStream(void)
+{
+    camStream_t *st = &gCamStream;
+    OSI_LOGI(0, "cam: drvCamStopStream");
+    if (!st->running)
+        return;
+
+    st->running = false;
+    drvCamStopPreview();
+    // wake up stream thread, which may wait for frame
+    osiSemaphoreRelease(ImageSensor.pSensorInfo->cam_sem_preview);
+    osiSemaphoreAcquire(st->exit_sema);
+    st->thread = NULL;
+}
+
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_CAMERA
 
 IMAGE_DEV_T *quec_getImageSensor()
@@ -64,11 +64,25 @@ typedef struct
      * \param roi       region of interest
      */
     void (*blit_prepare)(drvLcd_t *d, drvLcdDirection_t dir, const drvLcdArea_t *roi);
+    /**
+     * \brief enter or leave partial and idle mode
+     *
+     * In partial mode, only rows of \p partial are scanned, and in idle
+     * mode, the panel shows 8 colors (MSB of each component).
+     *
+     * \param d         LCD instance
+     * \param partial   rows in panel normal direction, NULL to leave
+     * \return
+     *      - true on success
+     *      - false if not supported by the panel
+     */
+    bool (*low_power)(drvLcd_t *d, const drvLcdArea_t *partial);
 } drvLcdPanelOps_t;
 
 bool drvLcdDummyProbe(drvLcd_t *d);
 void drvLcdDummyInit(drvLcd_t *d);
 void drvLcdDummyBlitPrepare(drvLcd_t *d, drvLcdDirection_t dir, const drvLcdArea_t *roi);
+bool drvLcdDummyLowPower(drvLcd_t *d, const drvLcdArea_t *partial);
 
 /**
  * \brief panel configurations
@@ -122,6 +136,32 @@ void drvLcdSetDesc(drvLcd_t *d, const drvLcdPanelDesc_t *desc);
  */
 const drvLcdPanelDesc_t *drvLcdGetDesc(drvLcd_t *d);
 
+/**
+ * \brief start batching commands and data
+ *
+ * Following \p drvLcdWriteCmd and \p drvLcdWriteData are stored in GOUDA
+ * command memory, rather than sent one by one by single access. They are
+ * sent in one GOUDA transfer at \p drvLcdCmdBatchEnd. When the command
+ * memory is full, the batched ones are sent in advance.
+ *
+ * \p blit_prepare and \p low_power are called inside batch, and the
+ * commands of \p blit_prepare are sent just before pixel data in the
+ * same transfer. So, don't read data from panel in these operations.
+ *
+ * This should be called only in panel driver, caller will ensure it is
+ * called inside lock.
+ *
+ * \param d         LCD instance
+ */
+void drvLcdCmdBatchBegin(drvLcd_t *d);
+
+/**
+ * \brief send batched commands and data, and stop batching
+ *
+ * \param d         LCD instance
+ */
+void drvLcdCmdBatchEnd(drvLcd_t *d);
+
 /**
  * \brief write command to panel
  *
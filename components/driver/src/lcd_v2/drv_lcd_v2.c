@@ -20,6 +20,7 @@
 #include "osi_api.h"
 #include "osi_api_inside.h"
 #include "osi_log.h"
+#include "osi_profile.h"
 #include <string.h>
 
 #undef WAIT_GOUDA_BY_TIMER
@@ -30,10 +31,17 @@
 #define LCD_CS1_POLARITY (0)
 #define LCD_LOW_FREQ (800000)
 
+// GOUDA command memory can be written only, and nb_command is 6 bits
+#define LCD_CMD_BATCH_MAX (GD_NB_LCD_CMD_WORDS - 1)
+
+// When layer buffers are larger than this, clean the whole D-cache
+#define LCD_DCACHE_CLEAN_ALL_SIZE (32 * 1024)
+
 #define LCD_STATE_CLOSED (0)
 #define LCD_STATE_PROBE_FAILD (1)
 #define LCD_STATE_OPENED (2)
 #define LCD_STATE_SLEEP (3)
+#define LCD_STATE_LOW_POWER (4)
 
 #define GOUDA_STATE_UNINIT (0)
 #define GOUDA_STATE_OPEN (1)
@@ -47,6 +55,8 @@ struct drvLcd
     REG_GOUDA_GD_LCD_CTRL_T lcd_ctrl;        // GOUDA lcd_ctrl
     REG_GOUDA_GD_SPILCD_CONFIG_T spi_config; // GOUDA spi_config
     unsigned mem_address;                    // GOUDA mem_address
+    bool cmd_batch;                          // commands are batched
+    uint8_t cmd_count;                       // batched command count
 };
 
 typedef struct
@@ -56,6 +66,9 @@ typedef struct
     osiMutex_t *lock;         // API lock
     osiPmSource_t *pm_source; // PM source
     osiClockConstrainRegistry_t clk_constrain;
+    osiCallback_t done_cb; // callback at transfer done, called in ISR
+    void *done_cb_ctx;     // callback context
+    uint32_t wait_us;      // accumulated time blocked in waiting GOUDA
 } drvLcdGoudaContext_t;
 
 static drvLcd_t gLcd1;
@@ -70,6 +83,12 @@ static void prvSetPowerEnable(bool enabled)
 
 static void prvWaitGouda(void)
 {
+    if ((hwp_gouda->gd_status & (GOUDA_IA_BUSY | GOUDA_LCD_BUSY)) == 0)
+        return;
+
+    osiProfileEnter(PROFCODE_LCD_WAIT);
+    int64_t start = osiUpTimeUS();
+
 #ifdef WAIT_GOUDA_BY_TIMER
     while ((hwp_gouda->gd_status & (/*GOUDA_IA_BUSY | */ GOUDA_LCD_BUSY)) != 0)
         osiThreadSleepUS(1000);
@@ -84,6 +103,9 @@ static void prvWaitGouda(void)
     }
     osiExitCritical(critical);
 #endif
+
+    gGoudaCtx.wait_us += (uint32_t)(osiUpTimeUS() - start);
+    osiProfileExit(PROFCODE_LCD_WAIT);
 }
 
 static void prvGoudaISR(void *param)
@@ -94,8 +116,15 @@ static void prvGoudaISR(void *param)
     // interrupt is diabled by default
     hwp_gouda->gd_eof_irq_mask = 0;
 
+    osiCallback_t done_cb = gGoudaCtx.done_cb;
+    void *done_cb_ctx = gGoudaCtx.done_cb_ctx;
+    gGoudaCtx.done_cb = NULL;
+
     osiSemaphoreRelease(gGoudaCtx.sema);
     osiReleaseClk(&gGoudaCtx.clk_constrain);
+
+    if (done_cb != NULL)
+        done_cb(done_cb_ctx);
 }
 
 static void prvGoudaInit(void)
@@ -136,6 +165,17 @@ static void prvGoudaDeinit(void)
     osiPmWakeUnlock(gGoudaCtx.pm_source);
 }
 
+/**
+ * open GOUDA without panel reset, for transfers in low power mode
+ */
+static void prvGoudaResume(drvLcd_t *d)
+{
+    prvGoudaInit();
+    hwp_gouda->gd_lcd_ctrl = d->lcd_ctrl.v;
+    hwp_gouda->gd_spilcd_config = d->spi_config.v;
+    hwp_gouda->gd_lcd_mem_address = d->mem_address;
+}
+
 static void prvPanelConfig(drvLcd_t *d)
 {
     d->lcd_ctrl.b.lcd_resetb = 0;
@@ -182,7 +222,7 @@ drvLcd_t *drvLcdGetByname(unsigned name)
 
 bool drvLcdGetPanelInfo(drvLcd_t *d, drvLcdPanelInfo_t *info)
 {
-    if (d == NULL || (d->state != LCD_STATE_OPENED && d->state != LCD_STATE_SLEEP))
+    if (d == NULL || d->state < LCD_STATE_OPENED)
         return false;
 
     unsigned spi_freq = CONFIG_DEFAULT_SYSAHB_FREQ / d->spi_config.b.spi_clk_divider;
@@ -281,9 +321,10 @@ void drvLcdCloseV2(drvLcd_t *d)
     osiMutexLock(gGoudaCtx.lock);
     OSI_LOGI(0, "lcd close");
 
-    if (d->state == LCD_STATE_OPENED || d->state == LCD_STATE_SLEEP)
+    if (d->state >= LCD_STATE_OPENED)
     {
-        prvGoudaDeinit();
+        if (gGoudaCtx.state == GOUDA_STATE_OPEN)
+            prvGoudaDeinit();
         prvSetPowerEnable(false);
         memset(d, 0, sizeof(drvLcd_t));
     }
@@ -299,11 +340,15 @@ bool drvLcdSleep(drvLcd_t *d)
     osiMutexLock(gGoudaCtx.lock);
     OSI_LOGI(0, "lcd sleep");
 
-    if (d->state != LCD_STATE_OPENED)
+    if (d->state != LCD_STATE_OPENED && d->state != LCD_STATE_LOW_POWER)
         goto fail_unlock;
 
-    prvWaitGouda();
-    prvGoudaDeinit();
+    // GOUDA is already closed in low power mode
+    if (d->state == LCD_STATE_OPENED)
+    {
+        prvWaitGouda();
+        prvGoudaDeinit();
+    }
     prvSetPowerEnable(false);
     d->state = LCD_STATE_SLEEP;
 
@@ -340,6 +385,61 @@ fail_unlock:
     return false;
 }
 
+bool drvLcdEnterLowPower(drvLcd_t *d, const drvLcdArea_t *partial)
+{
+    if (d == NULL)
+        return false;
+
+    osiMutexLock(gGoudaCtx.lock);
+    OSI_LOGI(0, "lcd enter low power");
+
+    if (d->state != LCD_STATE_OPENED)
+        goto fail_unlock;
+
+    prvWaitGouda();
+    drvLcdCmdBatchBegin(d);
+    if (partial != NULL && !d->desc->ops.low_power(d, partial))
+        OSI_LOGI(0, "lcd partial mode not supported");
+    drvLcdCmdBatchEnd(d);
+
+    // Panel keeps showing its frame memory, and GOUDA is opened only
+    // during the following transfers.
+    prvGoudaDeinit();
+    d->state = LCD_STATE_LOW_POWER;
+
+    osiMutexUnlock(gGoudaCtx.lock);
+    return true;
+
+fail_unlock:
+    osiMutexUnlock(gGoudaCtx.lock);
+    return false;
+}
+
+bool drvLcdExitLowPower(drvLcd_t *d)
+{
+    if (d == NULL)
+        return false;
+
+    osiMutexLock(gGoudaCtx.lock);
+    OSI_LOGI(0, "lcd exit low power");
+
+    if (d->state != LCD_STATE_LOW_POWER)
+        goto fail_unlock;
+
+    prvGoudaResume(d);
+    drvLcdCmdBatchBegin(d);
+    d->desc->ops.low_power(d, NULL);
+    drvLcdCmdBatchEnd(d);
+    d->state = LCD_STATE_OPENED;
+
+    osiMutexUnlock(gGoudaCtx.lock);
+    return true;
+
+fail_unlock:
+    osiMutexUnlock(gGoudaCtx.lock);
+    return false;
+}
+
 void drvLcdSetDirection(drvLcd_t *d, drvLcdDirection_t dir)
 {
     if (d == NULL)
@@ -358,6 +458,16 @@ void drvLcdWaitTransferDone(void)
     prvWaitGouda();
 }
 
+bool drvLcdIsBusy(void)
+{
+    return (hwp_gouda->gd_status & (GOUDA_IA_BUSY | GOUDA_LCD_BUSY)) != 0;
+}
+
+uint32_t drvLcdGetWaitTime(void)
+{
+    return gGoudaCtx.wait_us;
+}
+
 static int prvToVlInputFmt(uint8_t in_fmt)
 {
     if (in_fmt == DRV_LCD_IN_FMT_RGB565)
@@ -462,6 +572,90 @@ static bool prvSetVideoLayer(const drvLcdVideoLayer_t *vl)
     return true;
 }
 
+static unsigned prvFrameBpp(uint8_t in_fmt)
+{
+    return (in_fmt == DRV_LCD_IN_FMT_ARGB8888) ? 4 : 2;
+}
+
+static unsigned prvVideoLayerCacheSize(const drvLcdVideoLayer_t *vl)
+{
+    if (vl == NULL || !vl->enabled)
+        return 0;
+
+    if (vl->in_fmt == DRV_LCD_IN_FMT_IYUV)
+        return vl->stride * vl->buf_height * 3 / 2;
+    return vl->stride * vl->buf_height * 2;
+}
+
+static void prvVideoLayerCacheClean(const drvLcdVideoLayer_t *vl)
+{
+    if (vl == NULL || !vl->enabled)
+        return;
+
+    if (vl->in_fmt == DRV_LCD_IN_FMT_IYUV)
+    {
+        unsigned uv_size = (vl->stride / 2) * (vl->buf_height / 2);
+        osiDCacheClean(vl->buf, vl->stride * vl->buf_height);
+        if (vl->buf_u != NULL)
+            osiDCacheClean(vl->buf_u, uv_size);
+        if (vl->buf_v != NULL)
+            osiDCacheClean(vl->buf_v, uv_size);
+    }
+    else
+    {
+        osiDCacheClean(vl->buf, vl->stride * vl->buf_height * 2);
+    }
+}
+
+/**
+ * Get the overlay buffer range to be read by GOUDA. Only the lines inside
+ * layer ROI are considered.
+ */
+static unsigned prvOverlayCacheRange(const drvLcdOverlay_t *ovl, const drvLcdArea_t *roi, uintptr_t *start)
+{
+    if (ovl == NULL || !ovl->enabled || drvLcdAreaIsNul(&ovl->out))
+        return 0;
+
+    unsigned y1 = OSI_MAX(unsigned, ovl->out.y, roi->y);
+    unsigned y2 = OSI_MIN(unsigned, drvLcdAreaEndY(&ovl->out), drvLcdAreaEndY(roi));
+    if (y1 > y2)
+        return 0;
+
+    unsigned bpp = prvFrameBpp(ovl->in_fmt);
+    unsigned line_size = ovl->stride * bpp;
+    *start = (uintptr_t)ovl->buf + (y1 - ovl->out.y) * line_size;
+    return (y2 - y1) * line_size + ovl->out.w * bpp;
+}
+
+/**
+ * Clean D-cache of layer buffers. Only the memory to be read by GOUDA
+ * will be cleaned, unless it is larger than the whole D-cache.
+ */
+static void prvLayersCacheClean(const drvLcdLayers_t *cfg)
+{
+    uintptr_t ovl_start[DRV_LCD_OVERLAY_COUNT];
+    unsigned ovl_size[DRV_LCD_OVERLAY_COUNT];
+    unsigned total = prvVideoLayerCacheSize(cfg->vl);
+    for (unsigned n = 0; n < DRV_LCD_OVERLAY_COUNT; n++)
+    {
+        ovl_size[n] = prvOverlayCacheRange(cfg->ovl[n], &cfg->layer_roi, &ovl_start[n]);
+        total += ovl_size[n];
+    }
+
+    if (total > LCD_DCACHE_CLEAN_ALL_SIZE)
+    {
+        osiDCacheCleanAll();
+        return;
+    }
+
+    prvVideoLayerCacheClean(cfg->vl);
+    for (unsigned n = 0; n < DRV_LCD_OVERLAY_COUNT; n++)
+    {
+        if (ovl_size[n] != 0)
+            osiDCacheClean((void *)ovl_start[n], ovl_size[n]);
+    }
+}
+
 static bool prvSetOverlay(unsigned n, const drvLcdOverlay_t *ovl)
 {
     if (ovl == NULL || !ovl->enabled)
@@ -499,7 +693,8 @@ static bool prvSetOverlay(unsigned n, const drvLcdOverlay_t *ovl)
     return true;
 }
 
-bool drvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync)
+static bool prvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync,
+                        osiCallback_t done_cb, void *done_cb_ctx)
 {
     if (d == NULL || cfg == NULL)
         return false;
@@ -508,7 +703,9 @@ bool drvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync)
 
     unsigned tick1 = osiUpHWTick32();
 
-    if (d->state != LCD_STATE_OPENED)
+    // In low power mode, GOUDA is opened for this transfer only
+    bool low_power = (d->state == LCD_STATE_LOW_POWER);
+    if (d->state != LCD_STATE_OPENED && !low_power)
         goto fail_unlock;
 
     if (drvLcdAreaIsNul(&cfg->layer_roi))
@@ -516,6 +713,12 @@ bool drvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync)
     if (!drvLcdAreaShapeEqual(&cfg->layer_roi, &cfg->screen_roi))
         goto fail_unlock;
 
+    if (low_power)
+    {
+        prvGoudaResume(d);
+        sync = true;
+    }
+
     prvWaitGouda();
     unsigned tick2 = osiUpHWTick32() - tick1;
 
@@ -528,7 +731,17 @@ bool drvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync)
             goto fail_unlock;
     }
 
-    hwp_gouda->gd_lcd_ctrl = d->lcd_ctrl.v;
+    // Window commands of blit_prepare are batched, and sent by GOUDA
+    // just before pixel data in the same transfer.
+    drvLcdDirection_t dir = drvLcdDirCombine(d->app_dir, d->desc->dir);
+    drvLcdCmdBatchBegin(d);
+    d->desc->ops.blit_prepare(d, dir, &cfg->screen_roi);
+    REG_GOUDA_GD_LCD_CTRL_T lcd_ctrl = {d->lcd_ctrl.v};
+    lcd_ctrl.b.nb_command = d->cmd_count;
+    d->cmd_batch = false;
+    d->cmd_count = 0;
+
+    hwp_gouda->gd_lcd_ctrl = lcd_ctrl.v;
     hwp_gouda->gd_lcd_mem_address = d->mem_address;
     hwp_gouda->gd_spilcd_config = d->spi_config.v;
     hwp_gouda->gd_roi_tl_ppos =
@@ -539,10 +752,12 @@ bool drvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync)
         GOUDA_Y0(drvLcdAreaEndY(&cfg->layer_roi));
     hwp_gouda->gd_roi_bg_color = cfg->bg_color;
 
-    drvLcdDirection_t dir = drvLcdDirCombine(d->app_dir, d->desc->dir);
-    d->desc->ops.blit_prepare(d, dir, &cfg->screen_roi);
+    unsigned tick_clean = osiUpHWTick32();
+    prvLayersCacheClean(cfg);
+    tick_clean = osiUpHWTick32() - tick_clean;
 
-    osiDCacheCleanAll(); // it is simpler than clean needed
+    gGoudaCtx.done_cb = done_cb;
+    gGoudaCtx.done_cb_ctx = done_cb_ctx;
     hwp_gouda->gd_eof_irq_mask = GOUDA_EOF_MASK;
     hwp_gouda->gd_command = GOUDA_START;
     osiRequestSysClkActive(&gGoudaCtx.clk_constrain);
@@ -550,17 +765,31 @@ bool drvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync)
     unsigned tick3 = osiUpHWTick32() - tick1;
     if (sync)
         prvWaitGouda();
+    if (low_power)
+        prvGoudaDeinit();
 
     unsigned tick4 = osiUpHWTick32() - tick1;
-    OSI_LOGD(0, "lcd flush ticks: %d %d %d", tick2, tick3, tick4);
+    OSI_LOGD(0, "lcd flush ticks: %d %d %d, cache clean %d", tick2, tick3, tick4, tick_clean);
     osiMutexUnlock(gGoudaCtx.lock);
     return true;
 
 fail_unlock:
+    if (low_power && gGoudaCtx.state == GOUDA_STATE_OPEN)
+        prvGoudaDeinit();
     osiMutexUnlock(gGoudaCtx.lock);
     return false;
 }
 
+bool drvLcdFlush(drvLcd_t *d, const drvLcdLayers_t *cfg, bool sync)
+{
+    return prvLcdFlush(d, cfg, sync, NULL, NULL);
+}
+
+bool drvLcdFlushAsync(drvLcd_t *d, const drvLcdLayers_t *cfg, osiCallback_t done_cb, void *done_cb_ctx)
+{
+    return prvLcdFlush(d, cfg, false, done_cb, done_cb_ctx);
+}
+
 bool drvLcdFill(drvLcd_t *d, uint16_t color, const drvLcdArea_t *screen_roi, bool sync)
 {
     if (d == NULL || d->desc == NULL)
@@ -642,8 +871,10 @@ bool drvLcdBlend(const drvLcdLayers_t *cfg, void *buf, unsigned stride)
     unsigned outline_start = (uint32_t)buf + cfg->screen_roi.y * stride * sizeof(uint16_t);
     unsigned outline_size = cfg->screen_roi.h * stride * sizeof(uint16_t);
 
-    osiDCacheCleanAll(); // it is simpler than clean needed
-    osiDCacheInvalidate((void *)outline_start, outline_size);
+    // Pixels outside screen_roi share cache lines with the output, and
+    // they may be still dirty. Clean them before invalidation.
+    prvLayersCacheClean(cfg);
+    osiDCacheCleanInvalidate((void *)outline_start, outline_size);
 
     hwp_gouda->gd_eof_irq_mask = GOUDA_EOF_MASK;
     hwp_gouda->gd_command = GOUDA_START;
@@ -669,8 +900,63 @@ const drvLcdPanelDesc_t *drvLcdGetDesc(drvLcd_t *d)
     return d->desc;
 }
 
+/**
+ * Send batched commands without pixel data
+ */
+static void prvCmdBatchSend(drvLcd_t *d)
+{
+    if (d->cmd_count == 0)
+        return;
+
+    REG_GOUDA_GD_LCD_CTRL_T lcd_ctrl = {d->lcd_ctrl.v};
+    lcd_ctrl.b.nb_command = d->cmd_count;
+    lcd_ctrl.b.start_command = 1;
+
+    OSI_LOOP_WAIT((hwp_gouda->gd_status & GOUDA_LCD_BUSY) == 0);
+    hwp_gouda->gd_lcd_mem_address = d->mem_address;
+    hwp_gouda->gd_lcd_ctrl = lcd_ctrl.v;
+    OSI_LOOP_WAIT((hwp_gouda->gd_status & GOUDA_LCD_BUSY) == 0);
+    d->cmd_count = 0;
+}
+
+/**
+ * Append a command or data to batch. The command memory is addressed by
+ * sequence index, and the area tells command or data.
+ */
+static void prvCmdBatchAppend(drvLcd_t *d, bool is_data, uint16_t value)
+{
+    if (d->cmd_count >= LCD_CMD_BATCH_MAX)
+        prvCmdBatchSend(d);
+
+    volatile uint16_t *cmds = (volatile uint16_t *)hwp_goudaSram;
+    unsigned index = GD_NB_WORKBUF_WORDS + d->cmd_count;
+    if (is_data)
+        index += GD_NB_LCD_CMD_WORDS;
+
+    cmds[index] = value;
+    d->cmd_count++;
+}
+
+void drvLcdCmdBatchBegin(drvLcd_t *d)
+{
+    d->cmd_batch = true;
+    d->cmd_count = 0;
+}
+
+void drvLcdCmdBatchEnd(drvLcd_t *d)
+{
+    prvCmdBatchSend(d);
+    d->cmd_batch = false;
+}
+
 void drvLcdWriteCmd(drvLcd_t *d, uint16_t cmd)
 {
+    if (d->cmd_batch)
+    {
+        prvCmdBatchAppend(d, false, cmd);
+        return;
+    }
+
     OSI_LOOP_WAIT((hwp_gouda->gd_status & GOUDA_LCD_BUSY) == 0);
     hwp_gouda->gd_lcd_ctrl = d->lcd_ctrl.v;
     hwp_gouda->gd_lcd_mem_address = d->mem_address;
@@ -680,6 +966,12 @@ void drvLcdWriteCmd(drvLcd_t *d, uint16_t cmd)
 
 void drvLcdWriteData(drvLcd_t *d, uint16_t data)
 {
+    if (d->cmd_batch)
+    {
+        prvCmdBatchAppend(d, true, data);
+        return;
+    }
+
     OSI_LOOP_WAIT((hwp_gouda->gd_status & GOUDA_LCD_BUSY) == 0);
     hwp_gouda->gd_lcd_ctrl = d->lcd_ctrl.v;
     hwp_gouda->gd_lcd_mem_address = d->mem_address;
@@ -736,3 +1028,4 @@ void drvLcdReadData(drvLcd_t *d, uint16_t cmd, uint8_t *data, unsigned len)
 bool drvLcdDummyProbe(drvLcd_t *d) { return false; }
 void drvLcdDummyInit(drvLcd_t *d) {}
 void drvLcdDummyBlitPrepare(drvLcd_t *d, drvLcdDirection_t dir, const drvLcdArea_t *roi) {}
+bool drvLcdDummyLowPower(drvLcd_t *d, const drvLcdArea_t *partial) { return false; }
@@ -13,6 +13,7 @@
 // #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
 
 #include "drv_lcd_panel.h"
+#include "drv_config.h"
 #include "osi_api.h"
 #include "osi_log.h"
 #include "hwregs.h"
@@ -209,6 +210,29 @@ static void prvGc9305BlitPrepare(drvLcd_t *d, drvLcdDirection_t dir, const drvLc
     drvLcdWriteCmd(d, 0x2c); // recover memory write mode
 }
 
+static bool prvGc9305LowPower(drvLcd_t *d, const drvLcdArea_t *partial)
+{
+    if (partial == NULL)
+    {
+        drvLcdWriteCmd(d, 0x38); // idle mode off
+        drvLcdWriteCmd(d, 0x13); // normal display mode on
+        return true;
+    }
+
+    uint16_t top = partial->y;
+    uint16_t bot = drvLcdAreaEndY(partial);
+
+    drvLcdWriteCmd(d, 0x30);               // partial area, start/end row
+    drvLcdWriteData(d, (top >> 8) & 0xff); // top high 8 b
+    drvLcdWriteData(d, top & 0xff);        // top low 8 b
+    drvLcdWriteData(d, (bot >> 8) & 0xff); // bot high 8 b
+    drvLcdWriteData(d, bot & 0xff);        // bot low 8 b
+
+    drvLcdWriteCmd(d, 0x12); // partial display mode on
+    drvLcdWriteCmd(d, 0x39); // idle mode on, 8 colors
+    return true;
+}
+
 static uint32_t prvGc9305ReadId(drvLcd_t *d)
 {
     uint8_t id[4];
@@ -232,6 +256,7 @@ const drvLcdPanelDesc_t gLcdGc9305Desc = {
         .probe = prvGc9305Probe,
         .init = prvGc9305Init,
         .blit_prepare = prvGc9305BlitPrepare,
+        .low_power = prvGc9305LowPower,
     },
     .name = "GC9305",
     .dev_id = 0x009305,
@@ -242,7 +267,11 @@ const drvLcdPanelDesc_t gLcdGc9305Desc = {
     .out_fmt = DRV_LCD_OUT_FMT_16BIT_RGB565,
     .dir = DRV_LCD_DIR_XINV,
     .line_mode = DRV_LCD_SPI_4WIRE,
+#ifdef CONFIG_LCD_FMARK_SUPPORT
+    .fmark_enabled = true,
+#else
     .fmark_enabled = false,
+#endif
     .fmark_delay = 0x2a000,
     .freq = 50 * 1000000,
     .frame_us = (unsigned)(1000000 / 28.0),
@@ -13,6 +13,7 @@
 // #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
 
 #include "drv_lcd_panel.h"
+#include "drv_config.h"
 #include "osi_api.h"
 #include "osi_log.h"
 #include "hwregs.h"
@@ -149,10 +150,39 @@ static void prvSt7789Init(drvLcd_t *d)
         drvLcdWriteData(d,0x2D);
     
         drvLcdWriteCmd(d,0x21);
+
+        if (desc->fmark_enabled)
+        {
+            drvLcdWriteCmd(d, 0x35); // tearing effect line on, v-blanking only
+            drvLcdWriteData(d, 0x0);
+        }
     
         drvLcdWriteCmd(d,0x29);    //Display on
 }
 
+static bool prvSt7789LowPower(drvLcd_t *d, const drvLcdArea_t *partial)
+{
+    if (partial == NULL)
+    {
+        drvLcdWriteCmd(d, 0x38); // idle mode off
+        drvLcdWriteCmd(d, 0x13); // normal display mode on
+        return true;
+    }
+
+    uint16_t top = partial->y;
+    uint16_t bot = drvLcdAreaEndY(partial);
+
+    drvLcdWriteCmd(d, 0x30);               // partial area, start/end row
+    drvLcdWriteData(d, (top >> 8) & 0xff); // top high 8 b
+    drvLcdWriteData(d, top & 0xff);        // top low 8 b
+    drvLcdWriteData(d, (bot >> 8) & 0xff); // bot high 8 b
+    drvLcdWriteData(d, bot & 0xff);        // bot low 8 b
+
+    drvLcdWriteCmd(d, 0x12); // partial display mode on
+    drvLcdWriteCmd(d, 0x39); // idle mode on, 8 colors
+    return true;
+}
+
 static bool prvSt7789Probe(drvLcd_t *d)
 {
     const drvLcdPanelDesc_t *desc = drvLcdGetDesc(d);
@@ -165,6 +195,7 @@ const drvLcdPanelDesc_t gLcdSt7789Desc = {
         .probe = prvSt7789Probe,
         .init = prvSt7789Init,
         .blit_prepare = prvSt7789BlitPrepare,
+        .low_power = prvSt7789LowPower,
     },
     .name = "ST7789v",
     .dev_id = 0x858552,
@@ -175,7 +206,11 @@ const drvLcdPanelDesc_t gLcdSt7789Desc = {
     .out_fmt = DRV_LCD_OUT_FMT_16BIT_RGB565,
     .dir = DRV_LCD_DIR_NORMAL,
     .line_mode = DRV_LCD_SPI_4WIRE,
+#ifdef CONFIG_LCD_FMARK_SUPPORT
+    .fmark_enabled = true,
+#else
     .fmark_enabled = false,
+#endif
     .fmark_delay = 0x2a000,
     .freq = 50 * 1000000,
     .frame_us = (unsigned)(1000000 / 28.0),
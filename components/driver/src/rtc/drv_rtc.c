@@ -61,6 +61,9 @@ typedef struct drvRtcAlarmItem
 typedef struct
 {
     uint64_t last_time;
+    int32_t drift_ppb;                // calibrated drift, set by time service
+    uint32_t drift_error_ppb;         // 0 for not calibrated
+    uint64_t update_time;             // epoch second of the last drvRtcUpdateTime
     drvRtcAlarmHead_t alarms;         // active alarms
     drvRtcAlarmHead_t expired_alarms; // expired alarms without owners
     drvRtcAlarmOwnerHead_t owners;
@@ -192,6 +195,9 @@ static bool prvNvDecode(drvRtcContext_t *setting, uint8_t *buffer, unsigned leng
         return false;
 
     PB_DEC_ASSIGN(setting->last_time, last_time);
+    PB_OPT_DEC_ASSIGN(setting->drift_ppb, drift_ppb);
+    PB_OPT_DEC_ASSIGN(setting->drift_error_ppb, drift_error_ppb);
+    PB_OPT_DEC_ASSIGN(setting->update_time, update_time);
     return true;
 }
 
@@ -203,6 +209,15 @@ static int prvNvEncode(const drvRtcContext_t *setting, void *buffer, unsigned le
 
     PB_ENC_CB(alarms, prvRtcAlarmEncode, (void *)setting);
     PB_ENC_ASSIGN(setting->last_time, last_time);
+    if (setting->drift_error_ppb != 0)
+    {
+        PB_OPT_ENC_ASSIGN(setting->drift_ppb, drift_ppb);
+        PB_OPT_ENC_ASSIGN(setting->drift_error_ppb, drift_error_ppb);
+    }
+    if (setting->update_time != 0)
+    {
+        PB_OPT_ENC_ASSIGN(setting->update_time, update_time);
+    }
     return pbEncodeToMem(pbDrvRtc_fields, pbs, buffer, length);
 }
 
@@ -406,6 +421,9 @@ static void prvHandleAlarm(void *ctx)
 static void prvInitCtx(drvRtcContext_t *d)
 {
     d->last_time = 0;
+    d->drift_ppb = 0;
+    d->drift_error_ppb = 0;
+    d->update_time = 0;
     TAILQ_INIT(&d->alarms);
     TAILQ_INIT(&d->expired_alarms);
     TAILQ_INIT(&d->owners);
@@ -438,6 +456,9 @@ void drvRtcInit(void)
     if (prvLoadnv(&setting))
     {
         d->last_time = setting.last_time;
+        d->drift_ppb = setting.drift_ppb;
+        d->drift_error_ppb = setting.drift_error_ppb;
+        d->update_time = setting.update_time;
         TAILQ_SWAP(&d->alarms, &setting.alarms, drvRtcAlarmItem, iter);
     }
     else
@@ -732,6 +753,7 @@ void drvRtcUpdateTime(void)
     RTC_LOCK(d->lock);
 
     int64_t curr = osiEpochSecond();
+    d->update_time = curr;
     d->last_alarm = 0;
     d->storenv_needed = true;
     drvRtcHalUnsetAlarm(&d->hal);
@@ -772,6 +794,32 @@ void drvRtcUpdateTime(void)
     drvRtcHandleAlarm();
 }
 
+void drvRtcSetDrift(int32_t drift_ppb, uint32_t error_ppb)
+{
+    drvRtcContext_t *d = &gDrvRtcCtx;
+    RTC_LOCK(d->lock);
+    d->drift_ppb = drift_ppb;
+    d->drift_error_ppb = error_ppb;
+    d->storenv_needed = true;
+    RTC_UNLOCK(d->lock);
+    drvRtcHandleAlarm();
+}
+
+bool drvRtcGetDrift(int32_t *drift_ppb, uint32_t *error_ppb, int64_t *update_time)
+{
+    drvRtcContext_t *d = &gDrvRtcCtx;
+    RTC_LOCK(d->lock);
+    bool valid = (d->drift_error_ppb != 0);
+    if (drift_ppb != NULL)
+        *drift_ppb = d->drift_ppb;
+    if (error_ppb != NULL)
+        *error_ppb = d->drift_error_ppb;
+    if (update_time != NULL)
+        *update_time = d->update_time;
+    RTC_UNLOCK(d->lock);
+    return valid;
+}
+
 int64_t drvRtcGetWakeupTime(void)
 {
     drvRtcContext_t *d = &gDrvRtcCtx;
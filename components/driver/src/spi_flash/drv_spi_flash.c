@@ -19,6 +19,7 @@
 #include "osi_log.h"
 #include "osi_profile.h"
 #include "osi_byte_buf.h"
+#include "drv_axidma.h"
 #ifdef CONFIG_CPU_ARM
 #include "cmsis_core.h"
 #endif
@@ -37,6 +38,17 @@
 // doesn't exist soo many interrupt, it is needed to avoid worst case.
 #define MIN_ERASE_PROGRAM_TIME (100) // us
 
+// cache lines preloaded ahead of copy from XIP window
+#define XIP_PRELOAD_LINES (4)
+
+// minimal size to read by DMA
+#define DMA_READ_MIN_SIZE (8 * 1024)
+
+// Maximum time to keep erase/program suspended, or to hold program/erase
+// between chunks, for pending latency critical readers. It is a bound to
+// avoid erase/program starvation.
+#define URGENT_READER_WAIT_MAX (10) // ms
+
 enum
 {
     FLASH_NO_ERASE_PROGRAM,
@@ -55,6 +67,7 @@ struct drvSpiFlash
     halSpiFlash_t flash;
     uintptr_t base_address;
     osiMutex_t *lock;           // suspend will cause thread switch
+    uint8_t reader_pending[DRV_SPI_FLASH_PRIO_COUNT]; // readers inside read begin/end
     uint32_t block_prohibit[8]; // 16M/64K/32bit_per_word
 };
 
@@ -186,6 +199,45 @@ FLASHRAM_CODE static bool prvIsRangeWriteProhibit(drvSpiFlash_t *d, uint32_t add
     return false;
 }
 
+/**
+ * Whether there are pending readers with higher priority than background
+ * erase/program. It is called with interrupt disabled.
+ */
+OSI_FORCE_INLINE static bool prvIsUrgentReaderPending(drvSpiFlash_t *d)
+{
+    return (d->reader_pending[DRV_SPI_FLASH_PRIO_UI] |
+            d->reader_pending[DRV_SPI_FLASH_PRIO_AUDIO]) != 0;
+}
+
+/**
+ * Wait pending latency critical readers, with maximum wait time. It can
+ * only be called in thread context, and with erase/program suspended or
+ * between erase/program chunks.
+ */
+FLASHRAM_CODE static void prvWaitUrgentReader(drvSpiFlash_t *d)
+{
+    for (unsigned ms = 0; ms < URGENT_READER_WAIT_MAX; ms++)
+    {
+        if (!prvIsUrgentReaderPending(d))
+            break;
+        osiThreadSleep(1);
+    }
+}
+
+/**
+ * Yield to pending latency critical readers between erase/program chunks.
+ * Called with lock, and lock will be released during waiting.
+ */
+FLASHRAM_CODE static void prvYieldUrgentReader(drvSpiFlash_t *d)
+{
+    if (!prvIsUrgentReaderPending(d) || osiIsPanic())
+        return;
+
+    osiMutexUnlock(d->lock);
+    prvWaitUrgentReader(d);
+    osiMutexLock(d->lock);
+}
+
 /**
  * Disable AHB read of flash controller
  */
@@ -258,7 +310,9 @@ FLASHRAM_CODE static void prvPageProgram(
             return;
         }
 
-        if (d->flash.suspend_en && !d->suspend_disable && osiIrqPending() && !osiIsPanic())
+        bool urgent = prvIsUrgentReaderPending(d);
+        if (d->flash.suspend_en && !d->suspend_disable &&
+            (osiIrqPending() || urgent) && !osiIsPanic())
         {
             halSpiFlashProgramSuspend(&d->flash);
 
@@ -268,6 +322,8 @@ FLASHRAM_CODE static void prvPageProgram(
             osiExitCritical(critical);
 
             osiDelayUS(5); // avoid CPU can't take interrupt
+            if (urgent)
+                prvWaitUrgentReader(d);
 
             critical = osiEnterCritical();
 
@@ -304,7 +360,9 @@ FLASHRAM_CODE static void prvErase(drvSpiFlash_t *d, uint32_t offset, size_t siz
             return;
         }
 
-        if (d->flash.suspend_en && !d->suspend_disable && osiIrqPending() && !osiIsPanic())
+        bool urgent = prvIsUrgentReaderPending(d);
+        if (d->flash.suspend_en && !d->suspend_disable &&
+            (osiIrqPending() || urgent) && !osiIsPanic())
         {
             halSpiFlashEraseSuspend(&d->flash);
 
@@ -314,6 +372,8 @@ FLASHRAM_CODE static void prvErase(drvSpiFlash_t *d, uint32_t offset, size_t siz
             osiExitCritical(critical);
 
             osiDelayUS(5); // avoid CPU can't take interrupt
+            if (urgent)
+                prvWaitUrgentReader(d);
 
             critical = osiEnterCritical();
 
@@ -398,6 +458,33 @@ bool drvSpiFlashSetSuspendEnabled(drvSpiFlash_t *d, bool enable)
     return true;
 }
 
+/**
+ * Start latency critical read
+ */
+void drvSpiFlashReadBegin(drvSpiFlash_t *d, drvSpiFlashPriority_t prio)
+{
+    if (d == NULL || (unsigned)prio >= DRV_SPI_FLASH_PRIO_COUNT)
+        return;
+
+    uint32_t critical = osiEnterCritical();
+    d->reader_pending[prio]++;
+    osiExitCritical(critical);
+}
+
+/**
+ * End latency critical read
+ */
+void drvSpiFlashReadEnd(drvSpiFlash_t *d, drvSpiFlashPriority_t prio)
+{
+    if (d == NULL || (unsigned)prio >= DRV_SPI_FLASH_PRIO_COUNT)
+        return;
+
+    uint32_t critical = osiEnterCritical();
+    if (d->reader_pending[prio] > 0)
+        d->reader_pending[prio]--;
+    osiExitCritical(critical);
+}
+
 /**
  * Set range of soft write protection
  */
@@ -452,6 +539,39 @@ const void *drvSpiFlashMapAddress(drvSpiFlash_t *d, uint32_t offset)
     return (const void *)REG_ACCESS_ADDRESS((uintptr_t)d->base_address + offset);
 }
 
+/**
+ * Copy from XIP window. Cache line fill from flash is slow, and the
+ * following lines are preloaded to overlap line fill with copy.
+ */
+static void prvXipCopy(void *data, const void *fl, uint32_t size)
+{
+#ifdef CONFIG_CPU_ARM
+    const uint32_t chunk = XIP_PRELOAD_LINES * CONFIG_CACHE_LINE_SIZE;
+    uintptr_t src = (uintptr_t)fl;
+    uintptr_t end = src + size;
+    if (size <= chunk)
+    {
+        memcpy(data, fl, size);
+        return;
+    }
+
+    // copy chunk by chunk, and preload the next chunk before copy
+    while (src < end)
+    {
+        uintptr_t next = OSI_ALIGN_DOWN(src + chunk, CONFIG_CACHE_LINE_SIZE);
+        for (uintptr_t p = next; p < next + chunk && p < end; p += CONFIG_CACHE_LINE_SIZE)
+            __builtin_prefetch((const void *)p);
+
+        uint32_t bsize = OSI_MIN(uint32_t, next, end) - src;
+        memcpy(data, (const void *)src, bsize);
+        data = (char *)data + bsize;
+        src += bsize;
+    }
+#else
+    memcpy(data, fl, size);
+#endif
+}
+
 /**
  * Read data from flash
  */
@@ -463,10 +583,45 @@ bool drvSpiFlashRead(drvSpiFlash_t *d, uint32_t offset, void *data, uint32_t siz
         return false;
 
     const void *fl = (const void *)REG_ACCESS_ADDRESS((uintptr_t)d->base_address + offset);
-    memcpy(data, fl, size);
+    prvXipCopy(data, fl, size);
     return true;
 }
 
+/**
+ * Read data from flash by DMA
+ */
+bool drvSpiFlashReadDma(drvSpiFlash_t *d, uint32_t offset, void *data, uint32_t size)
+{
+    if (size == 0)
+        return true;
+    if (d == NULL || data == NULL || offset + size > d->flash.capacity)
+        return false;
+
+    // DMA can't access flash during program or erase, even when it is
+    // suspended. The lock is held by program and erase, and when it is
+    // held, this thread is only running at suspend.
+    if (size < DMA_READ_MIN_SIZE || osiIsPanic() || d->lock == NULL ||
+        !osiMutexTryLock(d->lock, 0))
+        return drvSpiFlashRead(d, offset, data, size);
+
+    const void *fl = (const void *)REG_ACCESS_ADDRESS((uintptr_t)d->base_address + offset);
+    drvAxidmaMemcpy(data, fl, size);
+    osiMutexUnlock(d->lock);
+    return true;
+}
+
+/**
+ * Read data from flash, with priority class
+ */
+bool drvSpiFlashReadPriority(drvSpiFlash_t *d, uint32_t offset, void *data,
+                             uint32_t size, drvSpiFlashPriority_t prio)
+{
+    drvSpiFlashReadBegin(d, prio);
+    bool ok = drvSpiFlashRead(d, offset, data, size);
+    drvSpiFlashReadEnd(d, prio);
+    return ok;
+}
+
 /**
  * Read data from flash, and check with provided data
  */
@@ -504,6 +659,7 @@ FLASHRAM_API bool drvSpiFlashWrite(drvSpiFlash_t *d, uint32_t offset, const void
     {
         while (size > 0)
         {
+            prvYieldUrgentReader(d);
             uint32_t next_page = OSI_ALIGN_DOWN(offset + PAGE_SIZE, PAGE_SIZE);
             uint32_t bsize = OSI_MIN(unsigned, next_page - offset, size);
 
@@ -517,6 +673,7 @@ FLASHRAM_API bool drvSpiFlashWrite(drvSpiFlash_t *d, uint32_t offset, const void
     {
         while (size > 0)
         {
+            prvYieldUrgentReader(d);
             uint32_t next_page = OSI_ALIGN_DOWN(offset + PAGE_SIZE, PAGE_SIZE);
             uint32_t bsize = OSI_MIN(unsigned, next_page - offset, size);
 
@@ -613,6 +770,7 @@ FLASHRAM_API bool drvSpiFlashErase(drvSpiFlash_t *d, uint32_t offset, size_t siz
     {
         while (size > 0)
         {
+            prvYieldUrgentReader(d);
             if (OSI_IS_ALIGNED(offset, SIZE_64K) && size >= SIZE_64K)
             {
                 prvErase(d, offset, SIZE_64K);
@@ -637,6 +795,7 @@ FLASHRAM_API bool drvSpiFlashErase(drvSpiFlash_t *d, uint32_t offset, size_t siz
     {
         while (size > 0)
         {
+            prvYieldUrgentReader(d);
             if (OSI_IS_ALIGNED(offset, SIZE_64K) && size >= SIZE_64K)
             {
                 prvEraseNoXipLocked(d, offset, SIZE_64K);
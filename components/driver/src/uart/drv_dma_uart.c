@@ -74,9 +74,10 @@ struct drvUart
     bool tx_complete_needed;
     drvAxidmaCh_t *rx_dma_ch;
     drvAxidmaCh_t *tx_dma_ch;
-    uint32_t rx_dma_size;
+    uint32_t rx_dma_offset; // RX DMA start offset in rx fifo buffer
+    uint32_t rx_dma_size;   // RX DMA size, contiguous space of rx fifo
+    uint32_t rx_dma_done;   // RX DMA size already put into rx fifo
     uint32_t tx_dma_size;
-    uint8_t *rx_dma_buf;
     uint8_t *tx_dma_buf;
 
     drvUartCfg_t cfg;
@@ -265,6 +266,39 @@ static void _uartTxDmaIsr(drvAxidmaIrqEvent_t devt, void *p)
     }
 }
 
+// RX DMA writes to rx fifo buffer directly. The transfered bytes are put
+// into rx fifo at each part finish, DMA finish and timeout, and DMA won't
+// be stopped at part finish. Called in critical section, and "remained"
+// is the remained DMA count.
+static uint32_t _uartRxDmaCommit(drvUart_t *d, unsigned remained)
+{
+    uint32_t done = d->rx_dma_size - remained;
+    if (done <= d->rx_dma_done)
+        return 0;
+
+    uint32_t recv = done - d->rx_dma_done;
+    uint8_t *data = (uint8_t *)d->rx_fifo.data + d->rx_dma_offset + d->rx_dma_done;
+    osiDCacheInvalidate(data, recv);
+    d->rx_fifo.wr += recv;
+    d->rx_dma_done = done;
+    return recv;
+}
+
+// Put bytes read by CPU into rx fifo, with RX DMA stopped. The written
+// range is cleaned, and the following cache invalidate of DMA won't
+// discard them.
+static int _uartRxFifoPut(drvUart_t *d, const void *data, size_t size)
+{
+    osiFifo_t *fifo = &d->rx_fifo;
+    size_t offset = fifo->wr % fifo->size;
+    int trans = osiFifoPut(fifo, data, size);
+    size_t tail = OSI_MIN(size_t, trans, fifo->size - offset);
+    osiDCacheClean((uint8_t *)fifo->data + offset, tail);
+    if (tail < (size_t)trans)
+        osiDCacheClean(fifo->data, trans - tail);
+    return trans;
+}
+
 static void _uartRxDmaIsr(drvAxidmaIrqEvent_t devt, void *p_)
 {
     uint32_t event = 0;
@@ -274,28 +308,21 @@ static void _uartRxDmaIsr(drvAxidmaIrqEvent_t devt, void *p_)
 
     OSI_LOGD(0, "DRV %4c RX DMA event 0x%x", d->name, devt);
 
-    if (devt & (AD_EVT_FINISH | AD_EVT_PART_FINISH))
+    if (devt & AD_EVT_FINISH)
     {
-        unsigned count = drvAxidmaChStop(d->rx_dma_ch);
-        uint32_t recv = d->rx_dma_size - count;
-        if (recv != 0)
-        {
+        // contiguous space is full, restart from the next space
+        if (_uartRxDmaCommit(d, drvAxidmaChStop(d->rx_dma_ch)) != 0)
             event |= DRV_UART_EVENT_RX_ARRIVED;
-            osiDCacheInvalidate(d->rx_dma_buf, d->rx_dma_size);
-            int trans = osiFifoPut(&d->rx_fifo, d->rx_dma_buf, recv);
-            if ((uint32_t)trans != recv)
-            {
-                event |= DRV_UART_EVENT_RX_OVERFLOW;
-            }
-        }
-        if (osiFifoSpace(&d->rx_fifo) >= UART_RXFIFO_SIZE)
-        {
-            _uartStartRxDma(d);
-        }
-        else
-        {
+
+        if (osiFifoSpace(&d->rx_fifo) == 0)
             OSI_LOGI(0, "DRV %4c stop Rx Dma in DMA ISR", d->name);
-        }
+        _uartStartRxDma(d);
+        _startSleepTimer(d);
+    }
+    else if (devt & AD_EVT_PART_FINISH)
+    {
+        if (_uartRxDmaCommit(d, drvAxidmaChCount(d->rx_dma_ch)) != 0)
+            event |= DRV_UART_EVENT_RX_ARRIVED;
         _startSleepTimer(d);
     }
 
@@ -422,12 +449,22 @@ static inline size_t _rxBytes(drvUart_t *d)
     return uart_rxfifo_stat.b.rx_fifo_cnt;
 }
 
+// Start RX DMA to contiguous space of rx fifo. When rx fifo is full, DMA
+// won't be started, and it will be started after data are read.
 static bool _uartStartRxDma(drvUart_t *d)
 {
-    osiDCacheInvalidate(d->rx_dma_buf, d->rx_dma_size);
+    osiFifo_t *fifo = &d->rx_fifo;
+    d->rx_dma_offset = fifo->wr % fifo->size;
+    d->rx_dma_size = OSI_MIN(uint32_t, osiFifoSpace(fifo), fifo->size - d->rx_dma_offset);
+    d->rx_dma_done = 0;
+    if (d->rx_dma_size == 0)
+        return true;
+
+    uint8_t *dma_buf = (uint8_t *)fifo->data + d->rx_dma_offset;
+    osiDCacheInvalidate(dma_buf, d->rx_dma_size);
     drvAxidmaCfg_t cfg = {};
     cfg.src_addr = (uint32_t)&d->hwp->uart_rx;
-    cfg.dst_addr = (uint32_t)d->rx_dma_buf;
+    cfg.dst_addr = (uint32_t)dma_buf;
     cfg.data_size = d->rx_dma_size;
     cfg.part_trans_size = UART_RX_TRIG_DMA_MODE;
     cfg.data_type = AD_DATA_8BIT;
@@ -613,20 +650,10 @@ static void drvUartISR(void *ctx)
         if (at_status.b.auto_baud_locked == 0)
         {
             evt |= DRV_UART_EVENT_RX_ARRIVED;
+            // Timeout is line idle after DMA trigger. DMA is stopped only
+            // here to read the remained bytes in HW fifo.
             if (d->rx_use_dma && drvAxidmaChBusy(d->rx_dma_ch))
-            {
-                unsigned count = drvAxidmaChStop(d->rx_dma_ch);
-                uint32_t dma_recv = d->rx_dma_size - count;
-                if (dma_recv != 0)
-                {
-                    osiDCacheInvalidate(d->rx_dma_buf, d->rx_dma_size);
-                    int dma_trans = osiFifoPut(&d->rx_fifo, d->rx_dma_buf, dma_recv);
-                    if ((uint32_t)dma_trans != dma_recv)
-                    {
-                        evt |= DRV_UART_EVENT_RX_OVERFLOW;
-                    }
-                }
-            }
+                _uartRxDmaCommit(d, drvAxidmaChStop(d->rx_dma_ch));
 
             size_t rx_remained = osiFifoSpace(&d->rx_fifo);
             size_t rx_bytes = _rxBytes(d);
@@ -643,7 +670,9 @@ static void drvUartISR(void *ctx)
                     d->isr_data[n] = d->hwp->uart_rx;
                 }
 
-                int trans = osiFifoPut(&d->rx_fifo, d->isr_data, rx_bytes);
+                int trans = d->rx_use_dma
+                                ? _uartRxFifoPut(d, d->isr_data, rx_bytes)
+                                : osiFifoPut(&d->rx_fifo, d->isr_data, rx_bytes);
                 if (trans != rx_bytes)
                 {
                     evt |= DRV_UART_EVENT_RX_OVERFLOW;
@@ -681,7 +710,7 @@ static void drvUartISR(void *ctx)
         }
         if (d->rx_use_dma)
         {
-            if (osiFifoSpace(&d->rx_fifo) >= UART_RXFIFO_SIZE)
+            if (!drvAxidmaChBusy(d->rx_dma_ch))
                 _uartStartRxDma(d);
             _startSleepTimer(d);
         }
@@ -776,11 +805,7 @@ static inline int _recvDmaMode(drvUart_t *d, uint8_t *data, size_t size)
             recv += rx_bytes;
         }
 
-        size_t space = osiFifoSpace(&d->rx_fifo);
-        if (space > UART_RXFIFO_SIZE)
-        {
-            _uartStartRxDma(d);
-        }
+        _uartStartRxDma(d);
     }
 
     osiIrqEnable(d->irqn);
@@ -821,6 +846,38 @@ int drvUartReceive(drvUart_t *d, void *data, size_t size)
     return len;
 }
 
+int drvUartReadPeek(drvUart_t *d, const void **data)
+{
+    if (d == NULL || data == NULL)
+        return -1;
+
+    uint32_t sc = osiEnterCritical();
+    osiFifo_t *fifo = &d->rx_fifo;
+    size_t offset = fifo->rd % fifo->size;
+    int len = OSI_MIN(size_t, osiFifoBytes(fifo), fifo->size - offset);
+    *data = (const uint8_t *)fifo->data + offset;
+    osiExitCritical(sc);
+    return len;
+}
+
+int drvUartReadSkip(drvUart_t *d, size_t size)
+{
+    if (d == NULL)
+        return -1;
+
+    uint32_t sc = osiEnterCritical();
+    osiIrqDisable(d->irqn);
+
+    int len = OSI_MIN(size_t, osiFifoBytes(&d->rx_fifo), size);
+    osiFifoSkipBytes(&d->rx_fifo, len);
+    if (d->rx_use_dma && d->opened && !drvAxidmaChBusy(d->rx_dma_ch))
+        _uartStartRxDma(d);
+
+    osiIrqEnable(d->irqn);
+    osiExitCritical(sc);
+    return len;
+}
+
 static void _sendTimeout(void *param)
 {
     drvUart_t *d = (drvUart_t *)param;
@@ -997,10 +1054,9 @@ static void _uartSuspend(void *ctx, osiSuspendMode_t mode)
 
     if (mode == OSI_SUSPEND_PM1 && d->name == DRV_NAME_UART1 && d->rx_use_dma)
     {
-        unsigned count = drvAxidmaChStop(d->rx_dma_ch);
-        uint32_t recv = d->rx_dma_size - count;
+        uint32_t recv = _uartRxDmaCommit(d, drvAxidmaChStop(d->rx_dma_ch));
         if (recv != 0)
-            OSI_LOGE(0, "DRV %4c suspend with dma data %u", d->name, recv);
+            OSI_LOGI(0, "DRV %4c suspend with dma data %u", d->name, recv);
     }
     osiExitCritical(critical);
 }
@@ -1014,10 +1070,9 @@ drvUart_t *drvUartCreate(uint32_t name, drvUartCfg_t *cfg)
 {
     drvAxidmaCh_t *rx_dma_ch = FORCE_RX_FIFO_MODE ? NULL : drvAxidmaChAllocate();
     drvAxidmaCh_t *tx_dma_ch = FORCE_TX_FIFO_MODE ? NULL : drvAxidmaChAllocate();
-    uint32_t rx_dma_size = (rx_dma_ch == NULL) ? 0 : (2 * UART_RXFIFO_SIZE);
     uint32_t tx_dma_size = (tx_dma_ch == NULL) ? 0 : OSI_ALIGN_UP(cfg->tx_buf_size / 2 + 4, CONFIG_CACHE_LINE_SIZE);
-    uint32_t alloc_buf_size = cfg->rx_buf_size + cfg->tx_buf_size +
-                              CONFIG_CACHE_LINE_SIZE + rx_dma_size + tx_dma_size;
+    uint32_t alloc_buf_size = OSI_ALIGN_UP(cfg->rx_buf_size, CONFIG_CACHE_LINE_SIZE) +
+                              cfg->tx_buf_size + CONFIG_CACHE_LINE_SIZE + tx_dma_size;
 
     drvUart_t *d = (drvUart_t *)calloc(1, sizeof(drvUart_t));
     if (d == NULL)
@@ -1030,12 +1085,12 @@ drvUart_t *drvUartCreate(uint32_t name, drvUartCfg_t *cfg)
         return NULL;
     }
 
+    // rx fifo buffer is the RX DMA buffer, it should be cache line aligned
     d->alloc_buf = (void *)pextra;
-    uintptr_t rx_buf = OSI_PTR_INCR_POST(pextra, cfg->rx_buf_size);
-    uintptr_t tx_buf = OSI_PTR_INCR_POST(pextra, cfg->tx_buf_size);
     pextra = OSI_ALIGN_UP(pextra, CONFIG_CACHE_LINE_SIZE);
-    uintptr_t rx_dma_buf = OSI_PTR_INCR_POST(pextra, rx_dma_size);
+    uintptr_t rx_buf = OSI_PTR_INCR_POST(pextra, OSI_ALIGN_UP(cfg->rx_buf_size, CONFIG_CACHE_LINE_SIZE));
     uintptr_t tx_dma_buf = OSI_PTR_INCR_POST(pextra, tx_dma_size);
+    uintptr_t tx_buf = OSI_PTR_INCR_POST(pextra, cfg->tx_buf_size);
 
     d->name = name;
     d->cfg = *cfg;
@@ -1050,8 +1105,6 @@ drvUart_t *drvUartCreate(uint32_t name, drvUartCfg_t *cfg)
     d->tx_use_dma = (tx_dma_ch != NULL);
 
     d->rx_dma_ch = rx_dma_ch;
-    d->rx_dma_size = rx_dma_size;
-    d->rx_dma_buf = (uint8_t *)rx_dma_buf;
     d->rx_use_dma = (rx_dma_ch != NULL);
 
     d->send_sema = osiSemaphoreCreate(1, 1);
@@ -1130,10 +1183,9 @@ bool drvUartReconfig(drvUart_t *d, drvUartCfg_t *cfg)
     if (d->cfg.tx_buf_size != cfg->tx_buf_size ||
         d->cfg.rx_buf_size != cfg->rx_buf_size)
     {
-        uint32_t rx_dma_size = d->rx_dma_size;
         uint32_t tx_dma_size = d->tx_use_dma ? OSI_ALIGN_UP(cfg->tx_buf_size / 2 + 4, CONFIG_CACHE_LINE_SIZE) : 0;
-        uint32_t alloc_size = cfg->tx_buf_size + cfg->rx_buf_size +
-                              CONFIG_CACHE_LINE_SIZE + tx_dma_size + rx_dma_size;
+        uint32_t alloc_size = OSI_ALIGN_UP(cfg->rx_buf_size, CONFIG_CACHE_LINE_SIZE) +
+                              cfg->tx_buf_size + CONFIG_CACHE_LINE_SIZE + tx_dma_size;
 
         uintptr_t pextra = (uintptr_t)malloc(alloc_size);
         if (pextra == 0)
@@ -1142,17 +1194,14 @@ bool drvUartReconfig(drvUart_t *d, drvUartCfg_t *cfg)
         free(d->alloc_buf);
         d->alloc_buf = (void *)pextra;
 
-        uintptr_t rx_buf = OSI_PTR_INCR_POST(pextra, cfg->rx_buf_size);
-        uintptr_t tx_buf = OSI_PTR_INCR_POST(pextra, cfg->tx_buf_size);
         pextra = OSI_ALIGN_UP(pextra, CONFIG_CACHE_LINE_SIZE);
-        uintptr_t rx_dma_buf = OSI_PTR_INCR_POST(pextra, rx_dma_size);
+        uintptr_t rx_buf = OSI_PTR_INCR_POST(pextra, OSI_ALIGN_UP(cfg->rx_buf_size, CONFIG_CACHE_LINE_SIZE));
         uintptr_t tx_dma_buf = OSI_PTR_INCR_POST(pextra, tx_dma_size);
+        uintptr_t tx_buf = OSI_PTR_INCR_POST(pextra, cfg->tx_buf_size);
         osiFifoInit(&d->rx_fifo, (void *)rx_buf, cfg->rx_buf_size);
         osiFifoInit(&d->tx_fifo, (void *)tx_buf, cfg->tx_buf_size);
         d->tx_dma_size = tx_dma_size;
         d->tx_dma_buf = (uint8_t *)tx_dma_buf;
-        d->rx_dma_size = rx_dma_size;
-        d->rx_dma_buf = (uint8_t *)rx_dma_buf;
     }
 
     d->cfg = *cfg;
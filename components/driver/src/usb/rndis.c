@@ -545,14 +545,15 @@ static int rndis_init_response(struct rndis_params *params, rndis_init_msg_type
     resp->MinorVersion = cpu_to_le32(RNDIS_MINOR_VERSION);
     resp->DeviceFlags = cpu_to_le32(RNDIS_DF_CONNECTIONLESS);
     resp->Medium = cpu_to_le32(RNDIS_MEDIUM_802_3);
-    resp->MaxPacketsPerTransfer = cpu_to_le32(1);
-    resp->MaxTransferSize = cpu_to_le32(
-        1500 //params->dev->mtu
-        + sizeof(struct ethhdr) + sizeof(struct rndis_packet_msg_type) + 22);
-    resp->PacketAlignmentFactor = cpu_to_le32(0);
+    resp->MaxPacketsPerTransfer = cpu_to_le32(RNDIS_RX_MAX_PACKETS);
+    resp->MaxTransferSize = cpu_to_le32(RNDIS_RX_XFER_SIZE);
+    resp->PacketAlignmentFactor = cpu_to_le32(2); // 4 bytes aligned
     resp->AFListOffset = cpu_to_le32(0);
     resp->AFListSize = cpu_to_le32(0);
 
+    usbEtherSetTxAggregation(params->ether->usbe, le32_to_cpu(buf->MaxTransferSize),
+                             RNDIS_TX_MAX_PACKETS);
+
     rndis_notify_response_available(params, r);
     return 0;
 }
@@ -76,17 +76,31 @@ static void prvRndisAddHead(usbEther_t *usbe, const drvEthReq_t *req, uint8_t *b
     head->DataLength = cpu_to_le32(req->actual_size);
 }
 
-static bool prvRndisRemoveHead(usbEther_t *usbe, uint8_t *buf, uint32_t size, drvEthReq_t *req)
+static int prvRndisRemoveHead(usbEther_t *usbe, uint8_t *buf, uint32_t size, drvEthReq_t *req)
 {
+    // host may append one byte to avoid zero length packet
+    if (size < sizeof(struct rndis_packet_msg_type))
+        return 0;
+
     struct rndis_packet_msg_type *head = (struct rndis_packet_msg_type *)buf;
     if (head->MessageType != cpu_to_le32(RNDIS_MSG_PACKET))
     {
         OSI_LOGE(0, "Invalid RNDIS data packet 0x%x", head->MessageType);
-        return false;
+        return -1;
+    }
+
+    uint32_t msg_len = le32_to_cpu(head->MessageLength);
+    uint32_t data_offset = le32_to_cpu(head->DataOffset) + 8;
+    uint32_t data_len = le32_to_cpu(head->DataLength);
+    if (msg_len > size || data_offset + data_len > msg_len)
+    {
+        OSI_LOGE(0, "Invalid RNDIS data packet length %u/%u/%u", msg_len, data_len, size);
+        return -1;
     }
-    req->payload = (drvEthPacket_t *)(buf + head->DataOffset + 8);
-    req->actual_size = size - sizeof(*head);
-    return true;
+
+    req->payload = (drvEthPacket_t *)(buf + data_offset);
+    req->actual_size = data_len;
+    return msg_len;
 }
 
 static rndisPriv_t *prvRndisPrivCreate(rndisData_t *rnd)
@@ -120,6 +134,8 @@ static rndisPriv_t *prvRndisPrivCreate(rndisData_t *rnd)
     p->cfg.udc = udc;
     p->cfg.payload_max_size = 2048;
     p->cfg.dev_proto_head_len = sizeof(struct rndis_packet_msg_type);
+    p->cfg.rx_xfer_size = RNDIS_RX_XFER_SIZE;
+    p->cfg.tx_aggr_size = RNDIS_TX_AGGR_SIZE;
 
     return p;
 
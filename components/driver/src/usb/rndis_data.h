@@ -25,6 +25,13 @@
 
 OSI_EXTERN_C_BEGIN
 
+// host may pack multiple RNDIS packets into one transfer
+#define RNDIS_RX_XFER_SIZE (4096)
+#define RNDIS_RX_MAX_PACKETS (8)
+// RNDIS packets packed into one transfer to host, when tx is busy
+#define RNDIS_TX_AGGR_SIZE (8192)
+#define RNDIS_TX_MAX_PACKETS (10)
+
 /**
  * @brief struct of cdc ethernet
  */
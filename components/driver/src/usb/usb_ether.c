@@ -29,6 +29,9 @@
 
 #define USBE_TX_QUEUE_COUNT 64
 #define USBE_RX_QUEUE_COUNT 16
+#define USBE_RX_HOLD_MAX (USBE_RX_QUEUE_COUNT / 2)
+#define USBE_TX_AGGR_COUNT 4
+#define USBE_TX_AGGR_INFLIGHT 2
 #define USBE_THREAD_STACK_SIZE 4096
 
 typedef struct usb_ether_request usbEtherReq_t;
@@ -42,6 +45,10 @@ struct usb_ether_request
     usbEther_t *usbe;
     usbXfer_t *xfer;
     usbEtherReqIter_t iter;
+    uint16_t hold;    // rx buffer hold count by consumer
+    uint16_t packets; // usbe packets in tx aggregation transfer
+    bool processing;  // rx request is processing in rx work
+    bool aggr;        // tx aggregation request
 #ifdef USBE_DEBUG_RECORD_RESOURCE
     uint32_t _ra;
 #define USBE_REQ_SET_RA(uereq) uereq->_ra = (uint32_t)__builtin_return_address(0)
@@ -68,10 +75,23 @@ struct usb_ether
     usbEtherReqHead_t rx_idle;
     // rx frames, link the requests carried data
     usbEtherReqHead_t rx_frame;
+    // rx held, link the processed requests still held by consumer
+    usbEtherReqHead_t rx_held;
     // tx idle, link all idle requests can be allocated
     usbEtherReqHead_t tx_idle;
     // tx busy, link the tx request had been allocated
     usbEtherReqHead_t tx_busy;
+    // tx aggregation idle, link the idle tx aggregation requests
+    usbEtherReqHead_t tx_aggr_idle;
+    // tx aggregation request in filling, not queued yet
+    usbEtherReq_t *tx_aggr;
+    uint32_t tx_aggr_max_size;
+    uint32_t tx_aggr_max_packets;
+    unsigned tx_inflight;
+
+    // rx request in processing, and the count of requests held by consumer
+    usbEtherReq_t *rx_current;
+    unsigned rx_held_count;
 
     drvEthEventCB_t event_cb;
     drvEthULDataCB_t uldata_cb;
@@ -125,6 +145,84 @@ static inline void _txCancelAll(usbEther_t *usbe)
     udcEpDequeueAll(usbe->config.udc, usbe->config.tx_ep);
 }
 
+static inline void _txGivebackLocked(usbEther_t *usbe, usbEtherReq_t *req)
+{
+    if (req->aggr)
+        TAILQ_INSERT_TAIL(&usbe->tx_aggr_idle, req, iter);
+    else
+        TAILQ_INSERT_TAIL(&usbe->tx_idle, req, iter);
+}
+
+static int _txQueueLocked(usbEther_t *usbe, usbEtherReq_t *req)
+{
+    int result = udcEpQueue(usbe->config.udc, usbe->config.tx_ep, req->xfer);
+    if (result < 0)
+    {
+        usbe->ether.stats.tx_dropped += req->aggr ? req->packets : 1;
+        _txGivebackLocked(usbe, req);
+        OSI_LOGE(0, "usbe submit tx fail, %d", result);
+        return result;
+    }
+
+    usbe->tx_inflight++;
+    return result;
+}
+
+static void _txAggrFlushLocked(usbEther_t *usbe)
+{
+    usbEtherReq_t *aggr = usbe->tx_aggr;
+    if (aggr != NULL)
+    {
+        usbe->tx_aggr = NULL;
+        _txQueueLocked(usbe, aggr);
+    }
+}
+
+/**
+ * When there are enough transfers in endpoint, pack the usbe packet
+ * into the tx aggregation request, and it will be queued at the next
+ * tx complete. Return true if the request is packed and given back.
+ */
+static bool _txAggregateLocked(usbEther_t *usbe, usbEtherReq_t *req)
+{
+    if (usbe->tx_aggr_max_packets <= 1)
+        return false;
+
+    if (usbe->tx_aggr == NULL && usbe->tx_inflight < USBE_TX_AGGR_INFLIGHT)
+        return false;
+
+    uint32_t length = req->xfer->length;
+    usbEtherReq_t *aggr = usbe->tx_aggr;
+    if (aggr != NULL && (aggr->packets >= usbe->tx_aggr_max_packets ||
+                         aggr->xfer->length + length > usbe->tx_aggr_max_size))
+    {
+        _txAggrFlushLocked(usbe);
+        aggr = NULL;
+    }
+
+    if (length > usbe->tx_aggr_max_size)
+        return false;
+
+    if (aggr == NULL)
+    {
+        aggr = TAILQ_FIRST(&usbe->tx_aggr_idle);
+        if (aggr == NULL)
+            return false;
+
+        TAILQ_REMOVE(&usbe->tx_aggr_idle, aggr, iter);
+        aggr->xfer->status = 0;
+        aggr->xfer->length = 0;
+        aggr->packets = 0;
+        usbe->tx_aggr = aggr;
+    }
+
+    memcpy((uint8_t *)aggr->xfer->buf + aggr->xfer->length, req->xfer->buf, length);
+    aggr->xfer->length += length;
+    aggr->packets++;
+    TAILQ_INSERT_TAIL(&usbe->tx_idle, req, iter);
+    return true;
+}
+
 static bool _etherApiNetup(drvEther_t *ether)
 {
     OSI_LOGI(0, "usbe netup");
@@ -183,7 +281,14 @@ static void _etherApiNetdown(drvEther_t *ether)
     _txCancelAll(usbe);
 
     critical = osiEnterCritical();
-    usbEtherReq_t *r;
+    usbEtherReq_t *r = usbe->tx_aggr;
+    if (r != NULL)
+    {
+        usbe->tx_aggr = NULL;
+        usbe->ether.stats.tx_dropped += r->packets;
+        TAILQ_INSERT_TAIL(&usbe->tx_aggr_idle, r, iter);
+    }
+
     while ((r = TAILQ_FIRST(&usbe->rx_frame)) != NULL)
     {
         TAILQ_REMOVE(&usbe->rx_frame, r, iter);
@@ -279,18 +384,16 @@ static bool _etherApiSubmitTxReq(drvEther_t *ether, drvEthReq_t *req_, size_t si
     TAILQ_REMOVE(&usbe->tx_busy, req, iter);
     USBE_REQ_CLR_RA(req);
 
-    result = udcEpQueue(usbe->config.udc, usbe->config.tx_ep, req->xfer);
-    if (result < 0)
+    // the copy is short, and it is in critical section to keep order
+    if (_txAggregateLocked(usbe, req))
     {
-        usbe->ether.stats.tx_dropped++;
-        TAILQ_INSERT_TAIL(&usbe->tx_idle, req, iter);
         osiExitCritical(critical);
-        OSI_LOGE(0, "usbe submit tx fail, %d", result);
-        return false;
+        return true;
     }
 
+    result = _txQueueLocked(usbe, req);
     osiExitCritical(critical);
-    return true;
+    return (result >= 0);
 
 fail:
     usbe->ether.stats.tx_dropped++;
@@ -316,6 +419,60 @@ static void _etherApiSetUldataCb(drvEther_t *ether, drvEthULDataCB_t cb, void *p
     osiExitCritical(critical);
 }
 
+static void *_etherApiRxHold(drvEther_t *ether, drvEthPacket_t *pkt)
+{
+    uint32_t critical = osiEnterCritical();
+    usbEther_t *usbe = E2UE(ether);
+    usbEtherReq_t *req = usbe->rx_current;
+    uint8_t *buf = (req != NULL) ? (uint8_t *)req->xfer->buf : NULL;
+    if (req == NULL || (uint8_t *)pkt < buf || (uint8_t *)pkt >= buf + req->xfer->actual)
+    {
+        osiExitCritical(critical);
+        return NULL;
+    }
+
+    if (req->hold == 0)
+    {
+        if (usbe->rx_held_count >= USBE_RX_HOLD_MAX)
+        {
+            osiExitCritical(critical);
+            return NULL;
+        }
+        usbe->rx_held_count++;
+    }
+    req->hold++;
+    osiExitCritical(critical);
+    return req;
+}
+
+static void _etherApiRxRelease(drvEther_t *ether, void *hold)
+{
+    uint32_t critical = osiEnterCritical();
+    usbEther_t *usbe = E2UE(ether);
+    usbEtherReq_t *req = (usbEtherReq_t *)hold;
+    if (--req->hold != 0)
+    {
+        osiExitCritical(critical);
+        return;
+    }
+
+    usbe->rx_held_count--;
+    if (req->processing)
+    {
+        // rx work will give it back after processed
+        osiExitCritical(critical);
+        return;
+    }
+
+    TAILQ_REMOVE(&usbe->rx_held, req, iter);
+    TAILQ_INSERT_TAIL(&usbe->rx_idle, req, iter);
+    bool restart = usbe->dev_online && usbe->net_link_on;
+    osiExitCritical(critical);
+
+    if (restart)
+        _rxStart(usbe);
+}
+
 static OSI_UNUSED void _resetTxReqDestMacLocked(usbEther_t *usbe, const uint8_t *mac)
 {
     ethHdr_t *ehdr;
@@ -374,48 +531,80 @@ static void _usbeStopWork(void *param)
         usbe->event_cb(DRV_ETHER_EVENT_DISCONNECT, usbe->event_cb_priv);
 }
 
-static void _usbeRxWork(void *param)
+static void _usbeRxProcess(usbEther_t *usbe, usbEtherReq_t *req)
 {
-    usbEther_t *usbe = (usbEther_t *)param;
-    bool result = true;
-    usbEtherReq_t *req;
-    uint32_t critical = osiEnterCritical();
-    usbe->rx_processing = true;
+    uint8_t *buf = (uint8_t *)req->xfer->buf;
+    uint32_t remain = req->xfer->actual;
+    unsigned packets = 0;
+    uint32_t critical;
 
-critical_rx_continue:
-    while ((req = TAILQ_FIRST(&usbe->rx_frame)) != NULL)
+    // an usb transfer may carry multiple usbe packets
+    while (remain > 0)
     {
-        TAILQ_REMOVE(&usbe->rx_frame, req, iter);
-        osiExitCritical(critical);
+        int size;
         if (usbe->config.dev_proto_head_len == 0)
         {
-            req->req.payload = req->xfer->buf;
-            req->req.actual_size = req->xfer->actual;
+            req->req.payload = (drvEthPacket_t *)buf;
+            req->req.actual_size = remain;
+            size = remain;
         }
         else
         {
-            result = usbe->config.ops.unwrap(usbe, req->xfer->buf, req->xfer->actual, &req->req);
+            size = usbe->config.ops.unwrap(usbe, buf, remain, &req->req);
         }
-        critical = osiEnterCritical();
-        if (result)
-        {
-            usbe->ether.stats.rx_packets++;
-            usbe->ether.stats.rx_bytes += req->xfer->actual;
-            osiExitCritical(critical);
 
-            if (usbe->uldata_cb)
-                usbe->uldata_cb(req->req.payload, req->req.actual_size, usbe->uldata_cb_priv);
-
-            critical = osiEnterCritical();
-        }
-        else
+        if (size < 0 || (size == 0 && packets == 0))
         {
+            critical = osiEnterCritical();
             usbe->ether.stats.rx_errors++;
             usbe->ether.stats.rx_length_errors++;
+            osiExitCritical(critical);
             OSI_LOGE(0, "unwrap ether packet fail");
+            break;
         }
 
-        TAILQ_INSERT_TAIL(&usbe->rx_idle, req, iter);
+        if (size == 0)
+            break;
+
+        critical = osiEnterCritical();
+        usbe->ether.stats.rx_packets++;
+        usbe->ether.stats.rx_bytes += size;
+        osiExitCritical(critical);
+
+        if (usbe->uldata_cb)
+            usbe->uldata_cb(req->req.payload, req->req.actual_size, usbe->uldata_cb_priv);
+
+        packets++;
+        buf += size;
+        remain -= size;
+    }
+}
+
+static void _usbeRxWork(void *param)
+{
+    usbEther_t *usbe = (usbEther_t *)param;
+    usbEtherReq_t *req;
+    uint32_t critical = osiEnterCritical();
+    usbe->rx_processing = true;
+
+critical_rx_continue:
+    while ((req = TAILQ_FIRST(&usbe->rx_frame)) != NULL)
+    {
+        TAILQ_REMOVE(&usbe->rx_frame, req, iter);
+        req->processing = true;
+        usbe->rx_current = req;
+        osiExitCritical(critical);
+
+        _usbeRxProcess(usbe, req);
+
+        critical = osiEnterCritical();
+        usbe->rx_current = NULL;
+        req->processing = false;
+        if (req->hold != 0)
+            TAILQ_INSERT_TAIL(&usbe->rx_held, req, iter);
+        else
+            TAILQ_INSERT_TAIL(&usbe->rx_idle, req, iter);
+
         if (usbe->dev_online && usbe->net_link_on)
         {
             osiExitCritical(critical);
@@ -475,26 +664,32 @@ static void _txComplete(usbEp_t *ep, usbXfer_t *xfer)
     uint32_t critical = osiEnterCritical();
     usbEtherReq_t *req = (usbEtherReq_t *)xfer->param;
     usbEther_t *usbe = req->usbe;
-    TAILQ_INSERT_TAIL(&usbe->tx_idle, req, iter);
-    usbe->ether.stats.tx_packets++;
+    unsigned packets = req->aggr ? req->packets : 1;
+    if (usbe->tx_inflight > 0)
+        usbe->tx_inflight--;
+    _txGivebackLocked(usbe, req);
+    usbe->ether.stats.tx_packets += packets;
     if (xfer->status == 0)
     {
         usbe->ether.stats.tx_bytes += xfer->actual;
     }
     else
     {
-        usbe->ether.stats.tx_errors++;
+        usbe->ether.stats.tx_errors += packets;
         OSI_LOGE(0, "usb ether tx done fail. %d/%u", xfer->status, usbe->ether.stats.tx_errors);
     }
+
+    if (xfer->status != -ECANCELED && usbe->net_link_on)
+        _txAggrFlushLocked(usbe);
     osiExitCritical(critical);
 }
 
-static bool _usbeReqInit(usbEther_t *usbe, uintptr_t *mem, usbEtherReq_t *r, const usbEtherConfig_t *config)
+static bool _usbeReqInit(usbEther_t *usbe, uintptr_t *mem, uint32_t size, usbEtherReq_t *r, const usbEtherConfig_t *config)
 {
     r->xfer = udcXferAlloc(config->udc);
     if (r->xfer == NULL)
         return false;
-    r->xfer->buf = (void *)OSI_PTR_INCR_POST(*mem, config->payload_max_size);
+    r->xfer->buf = (void *)OSI_PTR_INCR_POST(*mem, size);
     r->xfer->param = (void *)r;
     r->usbe = usbe;
     return true;
@@ -519,10 +714,17 @@ usbEther_t *usbEtherCreate(const usbEtherConfig_t *config)
     OSI_DEBUG_ASSERT(config->dev_proto_head_len == 0 || (config->ops.unwrap && config->ops.wrap));
     OSI_DEBUG_ASSERT(config->payload_max_size > config->dev_proto_head_len &&
                      OSI_IS_ALIGNED(config->payload_max_size, CONFIG_CACHE_LINE_SIZE));
+    OSI_DEBUG_ASSERT(OSI_IS_ALIGNED(config->rx_xfer_size, CONFIG_CACHE_LINE_SIZE) &&
+                     OSI_IS_ALIGNED(config->tx_aggr_size, CONFIG_CACHE_LINE_SIZE));
 
-    const unsigned req_cnt = USBE_RX_QUEUE_COUNT + USBE_TX_QUEUE_COUNT;
+    const uint32_t rx_xfer_size = (config->rx_xfer_size != 0) ? config->rx_xfer_size : config->payload_max_size;
+    const unsigned tx_aggr_cnt = (config->tx_aggr_size != 0) ? USBE_TX_AGGR_COUNT : 0;
+    const unsigned req_cnt = USBE_RX_QUEUE_COUNT + USBE_TX_QUEUE_COUNT + tx_aggr_cnt;
     const unsigned alloc_size = sizeof(usbEther_t) + CONFIG_CACHE_LINE_SIZE +
-                                req_cnt * (sizeof(usbEtherReq_t) + config->payload_max_size);
+                                req_cnt * sizeof(usbEtherReq_t) +
+                                USBE_RX_QUEUE_COUNT * rx_xfer_size +
+                                USBE_TX_QUEUE_COUNT * config->payload_max_size +
+                                tx_aggr_cnt * config->tx_aggr_size;
     uintptr_t mem = (uintptr_t)malloc(alloc_size);
     if (mem == (uintptr_t)NULL)
     {
@@ -563,8 +765,10 @@ usbEther_t *usbEtherCreate(const usbEtherConfig_t *config)
 
     TAILQ_INIT(&usbe->rx_idle);
     TAILQ_INIT(&usbe->rx_frame);
+    TAILQ_INIT(&usbe->rx_held);
     TAILQ_INIT(&usbe->tx_idle);
     TAILQ_INIT(&usbe->tx_busy);
+    TAILQ_INIT(&usbe->tx_aggr_idle);
 
     init_result = false;
     usbEtherReq_t *reqs = (usbEtherReq_t *)OSI_PTR_INCR_POST(mem, req_cnt * sizeof(usbEtherReq_t));
@@ -576,9 +780,9 @@ usbEther_t *usbEtherCreate(const usbEtherConfig_t *config)
         for (unsigned i = 0; i < USBE_RX_QUEUE_COUNT; ++i)
         {
             r = reqs++;
-            if (!_usbeReqInit(usbe, &mem, r, config))
+            if (!_usbeReqInit(usbe, &mem, rx_xfer_size, r, config))
                 goto req_alloc_end;
-            r->xfer->length = config->payload_max_size;
+            r->xfer->length = rx_xfer_size;
             r->xfer->complete = _rxComplete;
             TAILQ_INSERT_TAIL(&usbe->rx_idle, r, iter);
         }
@@ -586,7 +790,7 @@ usbEther_t *usbEtherCreate(const usbEtherConfig_t *config)
         for (unsigned i = 0; i < USBE_TX_QUEUE_COUNT; ++i)
         {
             r = reqs++;
-            if (!_usbeReqInit(usbe, &mem, r, config))
+            if (!_usbeReqInit(usbe, &mem, config->payload_max_size, r, config))
                 goto req_alloc_end;
             r->xfer->zlp = 1;
             r->xfer->complete = _txComplete;
@@ -598,6 +802,17 @@ usbEther_t *usbEtherCreate(const usbEtherConfig_t *config)
             TAILQ_INSERT_TAIL(&usbe->tx_idle, r, iter);
         }
 
+        for (unsigned i = 0; i < tx_aggr_cnt; ++i)
+        {
+            r = reqs++;
+            if (!_usbeReqInit(usbe, &mem, config->tx_aggr_size, r, config))
+                goto req_alloc_end;
+            r->xfer->zlp = 1;
+            r->xfer->complete = _txComplete;
+            r->aggr = true;
+            TAILQ_INSERT_TAIL(&usbe->tx_aggr_idle, r, iter);
+        }
+
         init_result = true;
 
     } while (0);
@@ -617,11 +832,14 @@ req_alloc_end:
     usbe->ether.impl.set_event_cb = _etherApiSetEventCb;
     usbe->ether.impl.set_uldata_cb = _etherApiSetUldataCb;
     usbe->ether.impl.set_host_mac = _etherApiSetHostMac;
+    usbe->ether.impl.rx_hold = _etherApiRxHold;
+    usbe->ether.impl.rx_release = _etherApiRxRelease;
     return usbe;
 
 init_req_fail:
     _usbeFreeReqList(&usbe->rx_idle, config->udc);
     _usbeFreeReqList(&usbe->tx_idle, config->udc);
+    _usbeFreeReqList(&usbe->tx_aggr_idle, config->udc);
 
 init_param_fail:
     osiWorkDelete(usbe->start_work);
@@ -657,6 +875,18 @@ void usbEtherStop(usbEther_t *usbe)
     osiWorkEnqueueLast(usbe->stop_work, usbe->wq);
 }
 
+void usbEtherSetTxAggregation(usbEther_t *usbe, uint32_t max_size, uint32_t max_packets)
+{
+    if (usbe == NULL)
+        return;
+
+    uint32_t critical = osiEnterCritical();
+    usbe->tx_aggr_max_size = OSI_MIN(uint32_t, max_size, usbe->config.tx_aggr_size);
+    usbe->tx_aggr_max_packets = (usbe->config.tx_aggr_size != 0) ? max_packets : 0;
+    osiExitCritical(critical);
+    OSI_LOGI(0, "usbe tx aggregation %u/%u", usbe->tx_aggr_max_size, usbe->tx_aggr_max_packets);
+}
+
 void usbEtherDestroy(usbEther_t *usbe)
 {
     if (usbe == NULL)
@@ -665,8 +895,12 @@ void usbEtherDestroy(usbEther_t *usbe)
     usbEtherStop(usbe);
     _usbeFreeReqList(&usbe->rx_idle, usbe->config.udc);
     _usbeFreeReqList(&usbe->rx_frame, usbe->config.udc);
+    if (!TAILQ_EMPTY(&usbe->rx_held))
+        OSI_LOGW(0, "usbe destroy with %u rx held", usbe->rx_held_count);
+    _usbeFreeReqList(&usbe->rx_held, usbe->config.udc);
     _usbeFreeReqList(&usbe->tx_idle, usbe->config.udc);
     _usbeFreeReqList(&usbe->tx_busy, usbe->config.udc);
+    _usbeFreeReqList(&usbe->tx_aggr_idle, usbe->config.udc);
 
     osiWorkDelete(usbe->start_work);
     osiWorkDelete(usbe->stop_work);
@@ -56,10 +56,12 @@ typedef struct
      * \param[in]   valid_size  valid data size in raw buffer
      * \param[out]  req         set proper payload data address and payload size
      * \return
-     *      - true if succeed
-     *      - false if the usbe packet not valid
+     *      - (positive) size of the usbe packet in raw buffer. An usb
+     *        transfer may carry more usbe packets following it.
+     *      - 0 if there are no more usbe packets, such as padding
+     *      - (negative) if the usbe packet not valid
      */
-    bool (*unwrap)(usbEther_t *usbe, uint8_t *raw_buf, uint32_t valid_size, drvEthReq_t *req);
+    int (*unwrap)(usbEther_t *usbe, uint8_t *raw_buf, uint32_t valid_size, drvEthReq_t *req);
 
     /**
      * \brief pre-set immutable usbe packet head members for quick wrap
@@ -79,6 +81,8 @@ typedef struct
     usbEp_t *rx_ep;
     uint32_t payload_max_size;
     uint32_t dev_proto_head_len;
+    uint32_t rx_xfer_size;  ///< rx transfer size, 0 for payload_max_size
+    uint32_t tx_aggr_size;  ///< tx aggregation transfer size, 0 for not support
     const uint8_t *host_mac;
     const uint8_t *dev_mac;
     void *dev_priv;
@@ -127,6 +131,21 @@ bool usbEtherStart(usbEther_t *usb_ether);
  */
 void usbEtherStop(usbEther_t *usb_ether);
 
+/**
+ * \brief set tx aggregation parameters
+ *
+ * When tx transfers are pending in the endpoint, the following usbe
+ * packets will be packed into one usb transfer, rather than one
+ * transfer for each usbe packet. The parameters are from host, and
+ * it only works when `tx_aggr_size` in config isn't 0.
+ *
+ * \param usb_ether    usb ether
+ * \param max_size     maximum usb transfer size accepted by host
+ * \param max_packets  maximum usbe packets in one transfer, 0 or 1 to
+ *                     disable tx aggregation
+ */
+void usbEtherSetTxAggregation(usbEther_t *usb_ether, uint32_t max_size, uint32_t max_packets);
+
 /**
  * \brief destroy the usb ether
  *
@@ -136,4 +155,4 @@ void usbEtherDestroy(usbEther_t *usb_ether);
 
 OSI_EXTERN_C_END
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -37,12 +37,37 @@
 
 #define TX_TIMEOUT_THRESHOLD (1000) // ms
 
+// Transfers queued to each endpoint. When there are more than one, the
+// next transfer is already queued at transfer done, and host won't
+// see NAK between transfers.
+#ifdef CONFIG_USB_SERIAL_RX_XFER_COUNT
+#define RX_XFER_COUNT CONFIG_USB_SERIAL_RX_XFER_COUNT
+#else
+#define RX_XFER_COUNT (2)
+#endif
+
+#ifdef CONFIG_USB_SERIAL_TX_XFER_COUNT
+#define TX_XFER_COUNT CONFIG_USB_SERIAL_TX_XFER_COUNT
+#else
+#define TX_XFER_COUNT (2)
+#endif
+
+typedef struct
+{
+    usbXfer_t *xfer; ///< usb transfer
+    void *buf;       ///< DMA buffer, allocated on open
+    unsigned size;   ///< RX received size
+    unsigned rpos;   ///< RX size already put into fifo
+    bool filled;     ///< RX done, and not put into fifo completely
+} usbSerialReq_t;
+
 typedef struct
 {
     drvSerialImpl_t port;
     usbSerial_t *cdc;
-    usbXfer_t *tx_xfer;
-    usbXfer_t *rx_xfer;
+    usbSerialReq_t tx_reqs[TX_XFER_COUNT];
+    usbSerialReq_t rx_reqs[RX_XFER_COUNT];
+    unsigned rx_head; ///< the oldest RX request, in queue order
     usbEp_t *tx_ep;
     usbEp_t *rx_ep;
     osiWorkQueue_t *work_queue;
@@ -55,7 +80,6 @@ typedef struct
     osiSemaphore_t *tx_avail_sem;  ///< sema to notify fifo avail
     osiSemaphore_t *tx_finish_sem; ///< sema to nitify all done
     uint64_t tx_timestamp;         ///< time stamp for the last TX transfer
-    const void *tx_buf_in_trans;   ///< buffer from TX fifo in transfer
     osiBlockedFifo_t *tx_fifo;     ///< blocked fifo for TX, it can be NULL
     uint32_t pending_event;        ///< not notified event
     void *allocated;               ///< dynamic allocated buffer on open, release on close
@@ -72,6 +96,7 @@ static inline usbSerialPriv_t *PORT_PRIV(drvSerialImpl_t *port) { return (usbSer
 static inline uint32_t PORT_NAME(drvSerialImpl_t *port) { return port->info ? port->info->name : 0x30303030; }
 static inline const drvSerialCfg_t *PORT_CFG(drvSerialImpl_t *port) { return &port->info->cfg; } // caller make sure port info non-null
 static bool prvIsTxFinishedLocked(usbSerialPriv_t *priv);
+static bool prvTxPollLocked(usbSerialPriv_t *priv);
 
 static inline void prvSemaTryAcquireLocked(usbSerialPriv_t *priv,
                                            osiSemaphore_t *sema,
@@ -101,10 +126,87 @@ static void prvNotifyPendingEvent(usbSerialPriv_t *priv)
     }
 }
 
+static void prvRxDoneCb(usbEp_t *ep, usbXfer_t *xfer);
+
+static usbSerialReq_t *prvRxReqByXfer(usbSerialPriv_t *priv, usbXfer_t *xfer)
+{
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+    {
+        if (priv->rx_reqs[n].xfer == xfer)
+            return &priv->rx_reqs[n];
+    }
+    return NULL;
+}
+
+static void prvRxQueueLocked(usbSerialPriv_t *priv, usbSerialReq_t *req)
+{
+    drvSerialImpl_t *port = &priv->port;
+    usbXfer_t *x = req->xfer;
+    x->buf = req->buf;
+    x->length = PORT_CFG(port)->rx_dma_size;
+    x->param = priv;
+    x->complete = prvRxDoneCb;
+    req->size = 0;
+    req->rpos = 0;
+    req->filled = false;
+
+    int ret = udcEpQueue(priv->cdc->func->controller, priv->rx_ep, x);
+    OSI_LOGD(0x100056c1, "CDC serial %4c rx start 0x%08x/%d return/%d",
+             PORT_NAME(port), x->buf, x->length, ret);
+
+    if (ret < 0)
+    {
+        OSI_LOGE(0x10005652, "CDC serial %4c rx start failed. enqueue xfer return (%d)",
+                 PORT_NAME(port), ret);
+
+        // failure except disconnected are not permitted
+        if (ret != -ENOENT)
+            osiPanic();
+    }
+}
+
+/**
+ * Put filled requests into fifo in queue order, and queue them again.
+ * When fifo is full, it will stop at the first request not put into
+ * fifo completely, and host will see NAK until fifo is read.
+ */
+static void prvRxDrainLocked(usbSerialPriv_t *priv)
+{
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+    {
+        usbSerialReq_t *req = &priv->rx_reqs[priv->rx_head];
+        if (!req->filled)
+            break;
+
+        if (req->rpos < req->size)
+        {
+            int bytes = osiBlockedFifoPut(priv->rx_fifo, (char *)req->buf + req->rpos,
+                                          req->size - req->rpos);
+            req->rpos += bytes;
+            if (req->rpos < req->size)
+                break;
+        }
+
+        priv->rx_head = (priv->rx_head + 1) % RX_XFER_COUNT;
+        prvRxQueueLocked(priv, req);
+    }
+}
+
+static void prvRxStartLocked(usbSerialPriv_t *priv)
+{
+    priv->rx_head = 0;
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+        prvRxQueueLocked(priv, &priv->rx_reqs[n]);
+}
+
 static void prvRxDoneCb(usbEp_t *ep, usbXfer_t *xfer)
 {
     usbSerialPriv_t *priv = (usbSerialPriv_t *)xfer->param;
     drvSerialImpl_t *port = &priv->port;
+    usbSerialReq_t *req = prvRxReqByXfer(priv, xfer);
+    if (req == NULL)
+        return;
+
     if (xfer->status != 0)
     {
         OSI_LOGW(0x100056c3, "CDC serial %4c rx fail, status/%d, size/%d",
@@ -117,57 +219,36 @@ static void prvRxDoneCb(usbEp_t *ep, usbXfer_t *xfer)
         OSI_LOGD(0x100056c4, "CDC serial %4c rx done, status/%d, size/%d",
                  PORT_NAME(port), xfer->status, xfer->actual);
         priv->pending_event |= DRV_SERIAL_EVENT_RX_ARRIVED;
-        if (priv->rx_fifo != NULL)
-            osiBlockedFifoPutDone(priv->rx_fifo, xfer->actual);
 
         // In case host doesn't send UCDC_SET_CONTROL_LINE_STATE,
         // "open" should be set forcedly to enabled write.
         priv->open = true;
-
-        // In case someone is waiting rx avail
-        osiSemaphoreRelease(priv->rx_avail_sem);
-    }
-
-    osiWorkEnqueue(priv->work_rx, priv->work_queue);
-}
-
-static void prvRxStartLocked(usbSerialPriv_t *priv)
-{
-    drvSerialImpl_t *port = &priv->port;
-    void *data = osiBlockedFifoPutRequest(priv->rx_fifo, true);
-    if (data == NULL)
-    {
-        OSI_LOGE(0, "serial %4c rx no enough space", PORT_NAME(port));
-        return;
     }
 
-    usbXfer_t *x = priv->rx_xfer;
-    x->buf = data;
-    x->length = PORT_CFG(port)->rx_dma_size;
-    x->param = priv;
-    x->complete = prvRxDoneCb;
-
-    int ret = udcEpQueue(priv->cdc->func->controller, priv->rx_ep, x);
-    OSI_LOGD(0x100056c1, "CDC serial %4c rx start 0x%08x/%d return/%d",
-             PORT_NAME(port), data, x->length, ret);
+    // Failed transfer is regarded as empty, to keep the queue order.
+    // The request is queued again here rather than in work, and the
+    // other queued requests will receive before the work is run.
+    uint32_t critical = osiEnterCritical();
+    req->size = (xfer->status == 0) ? xfer->actual : 0;
+    req->rpos = 0;
+    req->filled = true;
+    if (SERIAL_RUNNING(priv) && priv->rx_fifo != NULL)
+        prvRxDrainLocked(priv);
+    osiExitCritical(critical);
 
-    if (ret < 0)
-    {
-        OSI_LOGE(0x10005652, "CDC serial %4c rx start failed. enqueue xfer return (%d)",
-                 PORT_NAME(port), ret);
+    // In case someone is waiting rx avail
+    if (xfer->status == 0)
+        osiSemaphoreRelease(priv->rx_avail_sem);
 
-        // failure except disconnected are not permitted
-        if (ret != -ENOENT)
-            osiPanic();
-    }
+    osiWorkEnqueue(priv->work_rx, priv->work_queue);
 }
 
 static void prvRxDoneWork(void *param)
 {
     uint32_t critical = osiEnterCritical();
     usbSerialPriv_t *priv = (usbSerialPriv_t *)param;
-    if (SERIAL_RUNNING(priv))
-        prvRxStartLocked(priv);
+    if (SERIAL_RUNNING(priv) && priv->rx_fifo != NULL)
+        prvRxDrainLocked(priv);
     osiExitCritical(critical);
     prvNotifyPendingEvent(priv);
 }
@@ -191,19 +272,11 @@ static void prvTxDoneCb(usbEp_t *ep, usbXfer_t *xfer)
 #ifdef CONFIG_QUEC_PROJECT_FEATURE	
 	priv->pending_event |= DRV_SERIAL_EVENT_TX_COMPLETE;
 #endif
-    if (priv->tx_fifo != NULL)
-    {
-        if (xfer->buf == priv->tx_buf_in_trans)
-        {
-            osiBlockedFifoGetBlockDone(priv->tx_fifo);
-            priv->tx_buf_in_trans = NULL;
-
-            osiSemaphoreRelease(priv->tx_avail_sem);
-        }
-    }
-
     if (priv->tx_fifo && xfer->status != -ECANCELED)
     {
+        // queue the next transfer now, not to wait the work
+        if (SERIAL_RUNNING(priv))
+            prvTxPollLocked(priv);
         osiWorkEnqueue(priv->work_tx, priv->work_queue);
     }
     else
@@ -214,12 +287,12 @@ static void prvTxDoneCb(usbEp_t *ep, usbXfer_t *xfer)
     osiExitCritical(critical);
 }
 
-static void prvTxTransBlockLocked_(usbSerialPriv_t *priv, const void *data, unsigned size, bool cached)
+static void prvTxTransBlockLocked_(usbSerialPriv_t *priv, usbXfer_t *x, const void *data,
+                                   unsigned size, bool cached, bool zlp)
 {
     drvSerialImpl_t *port = &priv->port;
-    usbXfer_t *x = priv->tx_xfer;
     x->buf = (void *)data;
-    x->zlp = 1;
+    x->zlp = zlp ? 1 : 0;
     x->length = size;
     x->param = priv;
     x->status = 0; // though it will set to -EINPROGRESS at queue
@@ -242,37 +315,52 @@ static void prvTxTransBlockLocked_(usbSerialPriv_t *priv, const void *data, unsi
     }
 }
 
-static void prvTxTransBlockLocked(usbSerialPriv_t *priv, const void *data, unsigned size)
+static usbSerialReq_t *prvTxIdleReqLocked(usbSerialPriv_t *priv)
 {
-    return prvTxTransBlockLocked_(priv, data, size, true);
+    for (unsigned n = 0; n < TX_XFER_COUNT; n++)
+    {
+        usbSerialReq_t *req = &priv->tx_reqs[n];
+        if (req->xfer->status != -EINPROGRESS)
+            return req;
+    }
+    return NULL;
 }
 
 static bool prvTxPollLocked(usbSerialPriv_t *priv)
 {
-    usbXfer_t *x = priv->tx_xfer;
-    if (x->status == -EINPROGRESS) // only one xfer for tx ep
+    if (priv->tx_fifo == NULL)
         return false;
 
-    if (priv->tx_fifo != NULL)
+    unsigned dma_size = PORT_CFG(&priv->port)->tx_dma_size;
+    bool started = false;
+    usbSerialReq_t *req;
+    while (!osiBlockedFifoIsEmpty(priv->tx_fifo) &&
+           (req = prvTxIdleReqLocked(priv)) != NULL)
     {
-        unsigned size = 0;
-        const void *data = osiBlockedFifoGetRequest(priv->tx_fifo, &size);
-        if (data != NULL && size > 0)
-        {
-            priv->tx_buf_in_trans = data;
-            prvTxTransBlockLocked(priv, data, size);
-            return true;
-        }
+        // Small writes in fifo are aggregated into one transfer. When
+        // there are remaining data, the transfer is full and the next
+        // one follows, so ZLP is only needed at the end of data.
+        int size = osiBlockedFifoGet(priv->tx_fifo, req->buf, dma_size);
+        if (size <= 0)
+            break;
+
+        bool zlp = osiBlockedFifoIsEmpty(priv->tx_fifo);
+        prvTxTransBlockLocked_(priv, req->xfer, req->buf, size, true, zlp);
+        started = true;
     }
 
-    return false;
+    if (started)
+        osiSemaphoreRelease(priv->tx_avail_sem);
+    return started;
 }
 
 static bool prvIsTxFinishedLocked(usbSerialPriv_t *priv)
 {
-    usbXfer_t *xfer = priv->tx_xfer;
-    if (xfer->status == -EINPROGRESS)
-        return false;
+    for (unsigned n = 0; n < TX_XFER_COUNT; n++)
+    {
+        if (priv->tx_reqs[n].xfer->status == -EINPROGRESS)
+            return false;
+    }
 
     if (priv->tx_fifo != NULL && !osiBlockedFifoIsEmpty(priv->tx_fifo))
         return false;
@@ -284,17 +372,9 @@ static void prvTxDoneWork(void *priv_)
 {
     uint32_t critical = osiEnterCritical();
     usbSerialPriv_t *priv = (usbSerialPriv_t *)priv_;
-    if (priv->tx_fifo != NULL)
-    {
-        // try to send more
-        unsigned size = 0;
-        const void *data = osiBlockedFifoGetRequest(priv->tx_fifo, &size);
-        if (data != NULL && size > 0)
-        {
-            priv->tx_buf_in_trans = data;
-            prvTxTransBlockLocked(priv, data, size);
-        }
-    }
+    // try to send more
+    if (SERIAL_RUNNING(priv))
+        prvTxPollLocked(priv);
 
     if (prvIsTxFinishedLocked(priv))
         osiSemaphoreRelease(priv->tx_finish_sem);
@@ -398,7 +478,6 @@ static int prvSerialStartLocked(usbSerialPriv_t *priv)
         osiBlockedFifoReset(priv->rx_fifo);
     if (priv->tx_fifo)
         osiBlockedFifoReset(priv->tx_fifo);
-    priv->tx_buf_in_trans = NULL;
     OSI_ASSERT(priv->rx_fifo != NULL, "usb serial open rxfifo null");
     prvRxStartLocked(priv);
 
@@ -408,8 +487,13 @@ static int prvSerialStartLocked(usbSerialPriv_t *priv)
 static void prvSerialStopLocked(usbSerialPriv_t *priv)
 {
     udc_t *udc = priv->cdc->func->controller;
-    udcEpDequeue(udc, priv->rx_ep, priv->rx_xfer);
-    udcEpDequeue(udc, priv->tx_ep, priv->tx_xfer);
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+    {
+        udcEpDequeue(udc, priv->rx_ep, priv->rx_reqs[n].xfer);
+        priv->rx_reqs[n].filled = false;
+    }
+    for (unsigned n = 0; n < TX_XFER_COUNT; n++)
+        udcEpDequeue(udc, priv->tx_ep, priv->tx_reqs[n].xfer);
 }
 
 static int prvOpen(drvSerialImpl_t *port)
@@ -438,7 +522,12 @@ static int prvOpen(drvSerialImpl_t *port)
     void *ptr = NULL;
     osiBlockedFifo_t *rx_fifo = NULL;
     osiBlockedFifo_t *tx_fifo = NULL;
-    unsigned allocate_size = kcfg->rx_buf_size + kcfg->tx_buf_size;
+    void *rx_bufs[RX_XFER_COUNT] = {};
+    void *tx_bufs[TX_XFER_COUNT] = {};
+    unsigned tx_dma_count = (kcfg->tx_buf_size != 0) ? TX_XFER_COUNT : 0;
+    unsigned allocate_size = kcfg->rx_buf_size + kcfg->tx_buf_size +
+                             RX_XFER_COUNT * kcfg->rx_dma_size +
+                             tx_dma_count * kcfg->tx_dma_size;
     if (allocate_size != 0)
     {
         allocate_size += CONFIG_CACHE_LINE_SIZE;
@@ -447,6 +536,11 @@ static int prvOpen(drvSerialImpl_t *port)
             return -ENOMEM;
 
         uintptr_t pextra = OSI_ALIGN_UP(ptr, CONFIG_CACHE_LINE_SIZE);
+        for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+            rx_bufs[n] = (void *)OSI_PTR_INCR_POST(pextra, kcfg->rx_dma_size);
+        for (unsigned n = 0; n < tx_dma_count; n++)
+            tx_bufs[n] = (void *)OSI_PTR_INCR_POST(pextra, kcfg->tx_dma_size);
+
         if (kcfg->rx_buf_size)
         {
             uint8_t *rxbuf = (uint8_t *)OSI_PTR_INCR_POST(pextra, kcfg->rx_buf_size);
@@ -481,6 +575,10 @@ static int prvOpen(drvSerialImpl_t *port)
     prv->allocated = ptr;
     prv->tx_fifo = tx_fifo;
     prv->rx_fifo = rx_fifo;
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+        prv->rx_reqs[n].buf = rx_bufs[n];
+    for (unsigned n = 0; n < TX_XFER_COUNT; n++)
+        prv->tx_reqs[n].buf = tx_bufs[n];
     prv->inited = true;
     if (prv->ready)
         prvSerialStartLocked(prv);
@@ -504,6 +602,10 @@ static void prvClose(drvSerialImpl_t *port)
     prv->rx_fifo = NULL;
     prv->tx_fifo = NULL;
     prv->allocated = NULL;
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+        prv->rx_reqs[n].buf = NULL;
+    for (unsigned n = 0; n < TX_XFER_COUNT; n++)
+        prv->tx_reqs[n].buf = NULL;
     osiExitCritical(critical);
 
     if (rx_fifo)
@@ -547,10 +649,11 @@ static bool prvWriteDirect(drvSerialImpl_t *port, const void *data, size_t size,
     bool sent_done = false;
     uint32_t critical = osiEnterCritical();
     usbSerialPriv_t *priv = PORT_PRIV(port);
-    usbXfer_t *x = priv->tx_xfer;
-    if (x->status != -EINPROGRESS && SERIAL_RUNNING(priv) && priv->open)
+    usbSerialReq_t *req = SERIAL_RUNNING(priv) ? prvTxIdleReqLocked(priv) : NULL;
+    if (req != NULL && priv->open)
     {
-        prvTxTransBlockLocked_(priv, data, size, !(flags & DRV_SERIAL_FLAG_TXBUF_UNCACHED));
+        prvTxTransBlockLocked_(priv, req->xfer, data, size,
+                               !(flags & DRV_SERIAL_FLAG_TXBUF_UNCACHED), true);
         sent_done = prvWaitWriteFinishLocked(priv, toms);
     }
 
@@ -571,7 +674,12 @@ static int prvRead(drvSerialImpl_t *port, void *buffer, size_t size)
     if (!buffer || size == 0)
         return 0;
 
-    return osiBlockedFifoGet(priv->rx_fifo, buffer, size);
+    int bytes = osiBlockedFifoGet(priv->rx_fifo, buffer, size);
+
+    // RX is stopped at fifo full, restart it after fifo space is released
+    if (bytes > 0 && priv->rx_reqs[priv->rx_head].filled)
+        osiWorkEnqueue(priv->work_rx, priv->work_queue);
+    return bytes;
 }
 
 static int prvReadAvail(drvSerialImpl_t *port)
@@ -625,8 +733,10 @@ static void prvFreePrivLocked(usbSerialPriv_t *priv, udc_t *controller, bool asy
     // NULL pointers can be handled
     osiWorkDelete(priv->work_rx);
     osiWorkDelete(priv->work_tx);
-    udcXferFree(controller, priv->tx_xfer);
-    udcXferFree(controller, priv->rx_xfer);
+    for (unsigned n = 0; n < TX_XFER_COUNT; n++)
+        udcXferFree(controller, priv->tx_reqs[n].xfer);
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+        udcXferFree(controller, priv->rx_reqs[n].xfer);
     udcEpFree(controller, priv->tx_ep);
     udcEpFree(controller, priv->rx_ep);
     if (priv->tx_fifo)
@@ -645,8 +755,8 @@ static void prvFreePrivLocked(usbSerialPriv_t *priv, udc_t *controller, bool asy
     // clear all free member if priv still not release
     priv->work_rx = NULL;
     priv->work_tx = NULL;
-    priv->tx_xfer = NULL;
-    priv->rx_xfer = NULL;
+    memset(priv->tx_reqs, 0, sizeof(priv->tx_reqs));
+    memset(priv->rx_reqs, 0, sizeof(priv->rx_reqs));
     priv->tx_ep = NULL;
     priv->rx_ep = NULL;
     priv->tx_fifo = NULL;
@@ -688,13 +798,19 @@ int usbSerialBind(uint32_t name, usbSerial_t *cdc)
         goto failed;
     }
 
-    priv->tx_xfer = udcXferAlloc(controller);
-    if (priv->tx_xfer == NULL)
-        goto failed;
+    for (unsigned n = 0; n < TX_XFER_COUNT; n++)
+    {
+        priv->tx_reqs[n].xfer = udcXferAlloc(controller);
+        if (priv->tx_reqs[n].xfer == NULL)
+            goto failed;
+    }
 
-    priv->rx_xfer = udcXferAlloc(controller);
-    if (priv->rx_xfer == NULL)
-        goto failed;
+    for (unsigned n = 0; n < RX_XFER_COUNT; n++)
+    {
+        priv->rx_reqs[n].xfer = udcXferAlloc(controller);
+        if (priv->rx_reqs[n].xfer == NULL)
+            goto failed;
+    }
 
     priv->tx_avail_sem = osiSemaphoreCreate(1, 1);
     if (priv->tx_avail_sem == NULL)
@@ -719,7 +835,6 @@ int usbSerialBind(uint32_t name, usbSerial_t *cdc)
 
     priv->cdc = cdc;
     priv->tx_timestamp = 0;
-    priv->tx_buf_in_trans = NULL;
     priv->tx_fifo = NULL;
 
     priv->port.ops.open = prvOpen;
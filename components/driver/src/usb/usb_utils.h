@@ -28,4 +28,8 @@
 #define le16_to_cpu(x) (x)
 #endif
 
+#ifndef le32_to_cpu
+#define le32_to_cpu(x) (x)
+#endif
+
 #endif // _USB__UTILS_H_
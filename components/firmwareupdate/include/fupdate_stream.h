@@ -0,0 +1,177 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _FUPDATE_STREAM_H_
+#define _FUPDATE_STREAM_H_
+
+#include "osi_compiler.h"
+#include "fupdate_config.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+OSI_EXTERN_C_BEGIN
+
+/**
+ * Streaming firmware update package
+ *
+ * Instead of downloading the whole compressed package and then unpacking
+ * it, the package is received as a stream of LZMA compressed chunks. Each
+ * chunk is verified and decompressed into the pack file as soon as it
+ * arrives, so only one chunk is staged in RAM, and download overlaps
+ * with decompress.
+ *
+ * Stream layout, all integers are little endian:
+ * - \p fupdateStreamHeader_t
+ * - chunk digests, \p chunk_count * \p digest_size bytes
+ * - signature, \p sig_size bytes, signed over header and chunk digests
+ * - chunks, each is \p fupdateStreamChunkHeader_t followed by
+ *   \p stream_size bytes LZMA stream. The chunk digest is calculated
+ *   over chunk header and LZMA stream.
+ *
+ * After each chunk is written to pack file, a checkpoint is saved. After
+ * power failure or broken download, \p fupdateStreamCreate will resume
+ * from the last checkpoint, and the stream should be fed from
+ * \p fupdateStreamOffset, for example by HTTP Range request.
+ */
+
+#define FUPDATE_STREAM_MAGIC 0x54535546 // "FUST"
+#define FUPDATE_STREAM_VERSION 1
+#define FUPDATE_STREAM_DIGEST_MAX 32
+#define FUPDATE_STREAM_BLOCK_MAX (64 * 1024)
+#define FUPDATE_STREAM_MANIFEST_MAX (16 * 1024)
+
+/**
+ * \brief stream header
+ */
+typedef struct
+{
+    uint32_t magic;        ///< FUPDATE_STREAM_MAGIC
+    uint16_t version;      ///< FUPDATE_STREAM_VERSION
+    uint16_t digest_size;  ///< bytes of each chunk digest
+    uint32_t chunk_count;  ///< chunk count
+    uint32_t pack_size;    ///< decompressed pack size
+    uint32_t block_size;   ///< maximum decompressed size of chunk
+    uint32_t dict_size;    ///< LZMA dictionary size
+    uint32_t sig_size;     ///< signature size
+    uint32_t reserved;     ///< reserved, 0
+} fupdateStreamHeader_t;
+
+/**
+ * \brief chunk header
+ */
+typedef struct
+{
+    uint32_t stream_size; ///< LZMA stream size
+    uint32_t data_size;   ///< decompressed size
+    uint32_t data_crc;    ///< CRC by LZMA hardware of decompressed data
+    uint32_t reserved;    ///< reserved, 0
+} fupdateStreamChunkHeader_t;
+
+/**
+ * \brief cryptographic hooks of streaming update
+ *
+ * Signature scheme and digest algorithm are decided by application,
+ * usually with mbedtls.
+ */
+typedef struct
+{
+    /**
+     * verify the signature of header and chunk digests
+     */
+    bool (*verify)(void *ctx, const void *data, size_t size, const void *sig, size_t sig_size);
+    /**
+     * calculate chunk digest, \p digest_size bytes to be written
+     */
+    bool (*digest)(void *ctx, const void *data, size_t size, void *digest, size_t digest_size);
+    /**
+     * context of above callbacks
+     */
+    void *ctx;
+} fupdateStreamOps_t;
+
+/**
+ * \brief opaque data structure of streaming update
+ */
+typedef struct fupdateStream fupdateStream_t;
+
+/**
+ * \brief create streaming update
+ *
+ * When there is a valid checkpoint, it will resume from the checkpoint.
+ * Otherwise, previous pack file will be removed.
+ *
+ * \param ops       cryptographic hooks, must be valid during the life
+ * \return
+ *      - streaming update instance
+ *      - NULL on invalid parameter or out of memory
+ */
+fupdateStream_t *fupdateStreamCreate(const fupdateStreamOps_t *ops);
+
+/**
+ * \brief delete streaming update
+ *
+ * The checkpoint is kept, and the next \p fupdateStreamCreate can
+ * resume from it.
+ *
+ * \param s         streaming update instance
+ */
+void fupdateStreamDelete(fupdateStream_t *s);
+
+/**
+ * \brief stream offset to continue
+ *
+ * The data before the offset are not needed any more. When resumed from
+ * checkpoint, it is the end of the last finished chunk.
+ *
+ * \param s         streaming update instance
+ * \return  offset in stream
+ */
+uint32_t fupdateStreamOffset(fupdateStream_t *s);
+
+/**
+ * \brief feed stream data
+ *
+ * Data can be fed in any size. Chunks are processed when completely
+ * received.
+ *
+ * \param s         streaming update instance
+ * \param data      stream data
+ * \param size      stream data size
+ * \return
+ *      - \p size on success
+ *      - -1 on invalid stream, verify or write error
+ */
+int fupdateStreamWrite(fupdateStream_t *s, const void *data, size_t size);
+
+/**
+ * \brief whether the whole pack is received
+ *
+ * When finished, the checkpoint is removed, and the pack file is ready
+ * for \p fupdateSetReady.
+ *
+ * \param s         streaming update instance
+ * \return
+ *      - true if all chunks are written to pack file
+ *      - false if not
+ */
+bool fupdateStreamIsFinished(fupdateStream_t *s);
+
+/**
+ * \brief discard streaming update progress
+ *
+ * The checkpoint, manifest and pack file are removed.
+ */
+void fupdateStreamDiscard(void);
+
+OSI_EXTERN_C_END
+#endif
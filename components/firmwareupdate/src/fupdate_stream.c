@@ -0,0 +1,424 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "fupdate_stream.h"
+#include "fupdate.h"
+#include "hal_lzma.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "vfs.h"
+#include <fcntl.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FUPDATE_STREAM_CHECKPOINT_FILE_NAME CONFIG_FS_FOTA_DATA_DIR "/fupdate_stream.ckpt"
+#define FUPDATE_STREAM_MANIFEST_FILE_NAME CONFIG_FS_FOTA_DATA_DIR "/fupdate_stream.mf"
+
+// LZMA stream won't be larger than this, even for incompressible data
+#define FUPDATE_STREAM_SIZE_MAX(block_size) ((block_size) + (block_size) / 2 + 64)
+
+typedef enum
+{
+    FUPDATE_STREAM_STATE_HEADER,
+    FUPDATE_STREAM_STATE_MANIFEST,
+    FUPDATE_STREAM_STATE_CHUNK,
+    FUPDATE_STREAM_STATE_FINISHED,
+    FUPDATE_STREAM_STATE_ERROR,
+} fupdateStreamState_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t offset;        // stream offset after the last finished chunk
+    uint32_t chunk_index;   // next chunk
+    uint32_t pack_written;  // pack file size after the last finished chunk
+    uint32_t manifest_size; // size of manifest file
+} fupdateStreamCheckpoint_t;
+
+struct fupdateStream
+{
+    const fupdateStreamOps_t *ops;
+    fupdateStreamState_t state;
+    uint32_t offset;
+    uint8_t *manifest; // header, digests and signature
+    uint32_t manifest_size;
+    uint32_t received; // received bytes of manifest or current chunk
+    uint32_t chunk_index;
+    uint32_t pack_written;
+    uint8_t *chunk; // chunk header followed by LZMA stream, 8 bytes aligned
+    uint32_t chunk_capacity;
+    uint8_t *data; // decompressed data, 32 bytes aligned
+    int fd;
+};
+
+static inline const fupdateStreamHeader_t *prvHeader(fupdateStream_t *s)
+{
+    return (const fupdateStreamHeader_t *)s->manifest;
+}
+
+static uint32_t prvManifestSize(const fupdateStreamHeader_t *h)
+{
+    return sizeof(fupdateStreamHeader_t) + h->chunk_count * h->digest_size + h->sig_size;
+}
+
+static bool prvHeaderValid(const fupdateStreamHeader_t *h)
+{
+    if (h->magic != FUPDATE_STREAM_MAGIC ||
+        h->version != FUPDATE_STREAM_VERSION ||
+        h->reserved != 0)
+        return false;
+
+    if (h->digest_size == 0 || h->digest_size > FUPDATE_STREAM_DIGEST_MAX ||
+        h->block_size == 0 || h->block_size > FUPDATE_STREAM_BLOCK_MAX ||
+        h->chunk_count == 0 || h->chunk_count > FUPDATE_STREAM_MANIFEST_MAX ||
+        h->sig_size > FUPDATE_STREAM_MANIFEST_MAX)
+        return false;
+
+    if (prvManifestSize(h) > FUPDATE_STREAM_MANIFEST_MAX)
+        return false;
+
+    // each chunk should have data, and not more than block size
+    return h->pack_size >= h->chunk_count &&
+           h->pack_size <= (uint64_t)h->chunk_count * h->block_size;
+}
+
+static bool prvManifestVerify(fupdateStream_t *s)
+{
+    const fupdateStreamHeader_t *h = prvHeader(s);
+    uint32_t signed_size = s->manifest_size - h->sig_size;
+    return s->ops->verify(s->ops->ctx, s->manifest, signed_size,
+                          s->manifest + signed_size, h->sig_size);
+}
+
+/**
+ * Allocate decompress buffer after manifest is available.
+ */
+static bool prvBuffersAlloc(fupdateStream_t *s)
+{
+    const fupdateStreamHeader_t *h = prvHeader(s);
+
+    // hardware may write up to 32 bytes aligned
+    s->data = (uint8_t *)memalign(32, OSI_ALIGN_UP(h->block_size, 32));
+    s->chunk_capacity = sizeof(fupdateStreamChunkHeader_t) + FUPDATE_STREAM_SIZE_MAX(h->block_size);
+    s->chunk = (uint8_t *)memalign(8, s->chunk_capacity);
+    return s->data != NULL && s->chunk != NULL;
+}
+
+/**
+ * Save checkpoint. It is called after chunk data are synced to pack
+ * file, and safe file replace is atomic on power failure.
+ */
+static bool prvCheckpointSave(fupdateStream_t *s)
+{
+    fupdateStreamCheckpoint_t ckpt = {
+        .magic = FUPDATE_STREAM_MAGIC,
+        .offset = s->offset,
+        .chunk_index = s->chunk_index,
+        .pack_written = s->pack_written,
+        .manifest_size = s->manifest_size,
+    };
+    return vfs_sfile_write(FUPDATE_STREAM_CHECKPOINT_FILE_NAME, &ckpt, sizeof(ckpt)) == sizeof(ckpt);
+}
+
+/**
+ * Try to resume from checkpoint. The manifest is verified again, and the
+ * pack file is truncated to drop data of unfinished chunk.
+ */
+static bool prvResume(fupdateStream_t *s)
+{
+    fupdateStreamCheckpoint_t ckpt;
+    if (vfs_sfile_read(FUPDATE_STREAM_CHECKPOINT_FILE_NAME, &ckpt, sizeof(ckpt)) != sizeof(ckpt) ||
+        ckpt.magic != FUPDATE_STREAM_MAGIC ||
+        ckpt.manifest_size < sizeof(fupdateStreamHeader_t) ||
+        ckpt.manifest_size > FUPDATE_STREAM_MANIFEST_MAX)
+        return false;
+
+    s->manifest = (uint8_t *)malloc(ckpt.manifest_size);
+    if (s->manifest == NULL)
+        return false;
+
+    s->manifest_size = ckpt.manifest_size;
+    if (vfs_file_read(FUPDATE_STREAM_MANIFEST_FILE_NAME, s->manifest, s->manifest_size) != (ssize_t)s->manifest_size)
+        return false;
+
+    const fupdateStreamHeader_t *h = prvHeader(s);
+    if (!prvHeaderValid(h) || prvManifestSize(h) != s->manifest_size ||
+        ckpt.chunk_index >= h->chunk_count || ckpt.pack_written >= h->pack_size)
+        return false;
+
+    if (!prvManifestVerify(s))
+    {
+        OSI_LOGE(0, "fupdate stream resume, manifest verify failed");
+        return false;
+    }
+
+    if (vfs_file_size(gFupdatePackFileName) < (ssize_t)ckpt.pack_written ||
+        vfs_truncate(gFupdatePackFileName, ckpt.pack_written) < 0)
+        return false;
+
+    s->fd = vfs_open(gFupdatePackFileName, O_RDWR);
+    if (s->fd < 0 || vfs_lseek(s->fd, ckpt.pack_written, SEEK_SET) < 0)
+        return false;
+
+    if (!prvBuffersAlloc(s))
+        return false;
+
+    s->offset = ckpt.offset;
+    s->chunk_index = ckpt.chunk_index;
+    s->pack_written = ckpt.pack_written;
+    s->state = FUPDATE_STREAM_STATE_CHUNK;
+    OSI_LOGI(0, "fupdate stream resume at chunk %u/%u, offset %u",
+             s->chunk_index, h->chunk_count, s->offset);
+    return true;
+}
+
+static void prvReset(fupdateStream_t *s)
+{
+    if (s->fd >= 0)
+        vfs_close(s->fd);
+    free(s->manifest);
+    free(s->chunk);
+    free(s->data);
+
+    const fupdateStreamOps_t *ops = s->ops;
+    memset(s, 0, sizeof(*s));
+    s->ops = ops;
+    s->fd = -1;
+    s->state = FUPDATE_STREAM_STATE_HEADER;
+}
+
+fupdateStream_t *fupdateStreamCreate(const fupdateStreamOps_t *ops)
+{
+    if (ops == NULL || ops->verify == NULL || ops->digest == NULL)
+        return NULL;
+
+    fupdateStream_t *s = (fupdateStream_t *)calloc(1, sizeof(fupdateStream_t));
+    if (s == NULL)
+        return NULL;
+
+    s->ops = ops;
+    s->fd = -1;
+    if (!prvResume(s))
+    {
+        prvReset(s);
+        fupdateStreamDiscard();
+    }
+    return s;
+}
+
+void fupdateStreamDelete(fupdateStream_t *s)
+{
+    if (s == NULL)
+        return;
+
+    if (s->fd >= 0)
+        vfs_close(s->fd);
+    free(s->manifest);
+    free(s->chunk);
+    free(s->data);
+    free(s);
+}
+
+uint32_t fupdateStreamOffset(fupdateStream_t *s)
+{
+    if (s == NULL)
+        return 0;
+
+    // partial data of current chunk or manifest will be received again
+    return s->offset - s->received;
+}
+
+bool fupdateStreamIsFinished(fupdateStream_t *s)
+{
+    return s != NULL && s->state == FUPDATE_STREAM_STATE_FINISHED;
+}
+
+void fupdateStreamDiscard(void)
+{
+    vfs_unlink(FUPDATE_STREAM_CHECKPOINT_FILE_NAME);
+    vfs_unlink(FUPDATE_STREAM_MANIFEST_FILE_NAME);
+    vfs_unlink(gFupdatePackFileName);
+}
+
+static bool prvManifestReceived(fupdateStream_t *s)
+{
+    if (!prvManifestVerify(s))
+    {
+        OSI_LOGE(0, "fupdate stream manifest verify failed");
+        return false;
+    }
+
+    if (!prvBuffersAlloc(s))
+        return false;
+
+    vfs_mkdir(CONFIG_FS_FOTA_DATA_DIR, 0);
+    if (vfs_file_write(FUPDATE_STREAM_MANIFEST_FILE_NAME, s->manifest, s->manifest_size) != (ssize_t)s->manifest_size)
+        return false;
+
+    s->fd = vfs_open(gFupdatePackFileName, O_RDWR | O_CREAT | O_TRUNC, 0);
+    if (s->fd < 0)
+        return false;
+
+    s->received = 0;
+    s->state = FUPDATE_STREAM_STATE_CHUNK;
+    return prvCheckpointSave(s);
+}
+
+static bool prvChunkReceived(fupdateStream_t *s)
+{
+    const fupdateStreamHeader_t *h = prvHeader(s);
+    const fupdateStreamChunkHeader_t *ch = (const fupdateStreamChunkHeader_t *)s->chunk;
+    const uint8_t *expected = s->manifest + sizeof(fupdateStreamHeader_t) + s->chunk_index * h->digest_size;
+    uint8_t digest[FUPDATE_STREAM_DIGEST_MAX];
+    uint32_t crc = 0;
+
+    if (!s->ops->digest(s->ops->ctx, s->chunk, s->received, digest, h->digest_size) ||
+        memcmp(digest, expected, h->digest_size) != 0)
+    {
+        OSI_LOGE(0, "fupdate stream chunk %u digest mismatch", s->chunk_index);
+        return false;
+    }
+
+    if (!halLzmaDecompressBlock(ch + 1, ch->stream_size, s->data, ch->data_size, h->dict_size, &crc) ||
+        crc != ch->data_crc)
+    {
+        OSI_LOGE(0, "fupdate stream chunk %u decompress failed", s->chunk_index);
+        return false;
+    }
+
+    if (vfs_write(s->fd, s->data, ch->data_size) != (ssize_t)ch->data_size || vfs_fsync(s->fd) < 0)
+        return false;
+
+    s->pack_written += ch->data_size;
+    s->chunk_index++;
+    s->received = 0;
+    OSI_LOGD(0, "fupdate stream chunk %u/%u done", s->chunk_index, h->chunk_count);
+
+    if (s->chunk_index < h->chunk_count)
+        return prvCheckpointSave(s);
+
+    if (s->pack_written != h->pack_size)
+        return false;
+
+    vfs_close(s->fd);
+    s->fd = -1;
+    vfs_unlink(FUPDATE_STREAM_CHECKPOINT_FILE_NAME);
+    vfs_unlink(FUPDATE_STREAM_MANIFEST_FILE_NAME);
+    s->state = FUPDATE_STREAM_STATE_FINISHED;
+    OSI_LOGI(0, "fupdate stream finished, pack size %u", s->pack_written);
+    return true;
+}
+
+/**
+ * Check chunk header when it is received.
+ */
+static bool prvChunkHeaderValid(fupdateStream_t *s)
+{
+    const fupdateStreamHeader_t *h = prvHeader(s);
+    const fupdateStreamChunkHeader_t *ch = (const fupdateStreamChunkHeader_t *)s->chunk;
+    uint32_t remained = h->pack_size - s->pack_written;
+
+    if (ch->stream_size == 0 || ch->reserved != 0 ||
+        sizeof(fupdateStreamChunkHeader_t) + ch->stream_size > s->chunk_capacity)
+        return false;
+
+    // all chunks except the last one should be full
+    if (s->chunk_index == h->chunk_count - 1)
+        return ch->data_size == remained;
+    return ch->data_size == h->block_size && ch->data_size < remained;
+}
+
+int fupdateStreamWrite(fupdateStream_t *s, const void *data, size_t size)
+{
+    if (s == NULL || (data == NULL && size > 0))
+        return -1;
+
+    const uint8_t *p = (const uint8_t *)data;
+    size_t remained = size;
+    while (remained > 0)
+    {
+        uint32_t need, len;
+        uint8_t *dest;
+
+        if (s->state == FUPDATE_STREAM_STATE_HEADER || s->state == FUPDATE_STREAM_STATE_MANIFEST)
+        {
+            if (s->manifest == NULL)
+            {
+                s->manifest = (uint8_t *)malloc(sizeof(fupdateStreamHeader_t));
+                if (s->manifest == NULL)
+                    goto failed;
+                s->manifest_size = sizeof(fupdateStreamHeader_t);
+            }
+            need = s->manifest_size;
+            dest = s->manifest;
+        }
+        else if (s->state == FUPDATE_STREAM_STATE_CHUNK)
+        {
+            need = sizeof(fupdateStreamChunkHeader_t);
+            if (s->received >= need)
+                need += ((const fupdateStreamChunkHeader_t *)s->chunk)->stream_size;
+            dest = s->chunk;
+        }
+        else
+        {
+            // no more data is expected after finished
+            goto failed;
+        }
+
+        len = OSI_MIN(uint32_t, need - s->received, remained);
+        memcpy(dest + s->received, p, len);
+        s->received += len;
+        s->offset += len;
+        p += len;
+        remained -= len;
+        if (s->received < need)
+            break;
+
+        if (s->state == FUPDATE_STREAM_STATE_HEADER)
+        {
+            if (!prvHeaderValid(prvHeader(s)))
+                goto failed;
+
+            uint32_t manifest_size = prvManifestSize(prvHeader(s));
+            uint8_t *manifest = (uint8_t *)realloc(s->manifest, manifest_size);
+            if (manifest == NULL)
+                goto failed;
+            s->manifest = manifest;
+            s->manifest_size = manifest_size;
+            s->state = FUPDATE_STREAM_STATE_MANIFEST;
+        }
+        else if (s->state == FUPDATE_STREAM_STATE_MANIFEST)
+        {
+            if (!prvManifestReceived(s))
+                goto failed;
+        }
+        else if (need == sizeof(fupdateStreamChunkHeader_t))
+        {
+            if (!prvChunkHeaderValid(s))
+                goto failed;
+        }
+        else
+        {
+            if (!prvChunkReceived(s))
+                goto failed;
+        }
+    }
+    return size;
+
+failed:
+    OSI_LOGE(0, "fupdate stream failed at offset %u, state %d", s->offset, s->state);
+    s->state = FUPDATE_STREAM_STATE_ERROR;
+    return -1;
+}
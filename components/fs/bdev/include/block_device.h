@@ -36,6 +36,7 @@ typedef struct
     int (*read)(blockDevice_t *dev, uint64_t nr, int count, void *buf);
     int (*write)(blockDevice_t *dev, uint64_t nr, int count, const void *data);
     int (*erase)(blockDevice_t *dev, uint64_t nr, int count);
+    int (*flush)(blockDevice_t *dev);
     void (*stat)(blockDevice_t *dev, blockDeviceStat_t *stat);
     void (*destroy)(blockDevice_t *dev);
 } blockDeviceOps_t;
@@ -51,6 +52,7 @@ struct blockDevice
 int blockDeviceRead(blockDevice_t *dev, uint64_t nr, int count, void *buf);
 int blockDeviceWrite(blockDevice_t *dev, uint64_t nr, int count, const void *data);
 int blockDeviceErase(blockDevice_t *dev, uint64_t nr, int count);
+int blockDeviceFlush(blockDevice_t *dev);
 void blockDeviceStat(blockDevice_t *dev, blockDeviceStat_t *stat);
 void blockDeviceDestroy(blockDevice_t *dev);
 
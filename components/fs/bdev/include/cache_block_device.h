@@ -0,0 +1,79 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _CACHE_BLOCK_DEVICE_H_
+#define _CACHE_BLOCK_DEVICE_H_
+
+#include "block_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * statistics of cache block device
+ */
+typedef struct
+{
+    unsigned read_hit;     ///< single block read hit
+    unsigned read_miss;    ///< single block read miss
+    unsigned write_hit;    ///< single block write to cached block
+    unsigned write_miss;   ///< single block write to uncached block
+    unsigned bypass_read;  ///< multiple blocks read bypass cache
+    unsigned bypass_write; ///< multiple blocks write through
+    unsigned flush_count;  ///< flush rounds
+    unsigned flush_blocks; ///< dirty blocks written back
+    unsigned flush_writes; ///< write commands of write back
+    unsigned dirty_count;  ///< current dirty blocks
+} cacheBlockDeviceStat_t;
+
+/**
+ * \brief create write back block cache on block device
+ *
+ * Single block reads and writes, typically FAT table, directory and
+ * partial sector updates, are cached in LRU order. Multiple blocks
+ * accesses bypass the cache, with cached blocks kept coherent. Dirty
+ * blocks are written back:
+ * - by \p blockDeviceFlush, FAT calls it at sync
+ * - \p flush_ms after the first block is dirty
+ * - at system shutdown
+ * - when a dirty block is evicted, and then all dirty blocks in the
+ *   same erase group are written together
+ *
+ * Contiguous dirty blocks are written back by one multiple blocks write.
+ *
+ * The cache device owns \p parent, and \p parent will be destroyed
+ * at destroy.
+ *
+ * \param parent        the block device to be cached
+ * \param cache_count   cached block count
+ * \param flush_ms      delay to write back dirty blocks
+ * \return
+ *      - the cache block device
+ *      - NULL on invalid parameter or out of memory
+ */
+blockDevice_t *cacheBlockDeviceCreate(blockDevice_t *parent, unsigned cache_count, unsigned flush_ms);
+
+/**
+ * \brief get statistics of cache block device
+ *
+ * \param dev       cache block device, must be created by
+ *                  \p cacheBlockDeviceCreate
+ * \param stat      output statistics
+ */
+void cacheBlockDeviceGetStat(blockDevice_t *dev, cacheBlockDeviceStat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,6 +34,13 @@ int blockDeviceErase(blockDevice_t *dev, uint64_t nr, int count)
     return dev->ops.erase(dev, nr, count);
 }
 
+int blockDeviceFlush(blockDevice_t *dev)
+{
+    if (dev->ops.flush == NULL)
+        return 0;
+    return dev->ops.flush(dev);
+}
+
 void blockDeviceDestroy(blockDevice_t *dev)
 {
     if (dev->ops.destroy == NULL)
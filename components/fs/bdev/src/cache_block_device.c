@@ -0,0 +1,418 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#define OSI_LOCAL_LOG_TAG OSI_MAKE_LOG_TAG('C', 'B', 'L', 'K')
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "cache_block_device.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "hal_config.h"
+#include <stdlib.h>
+#include <string.h>
+
+// dirty blocks in the same group are written back together at eviction
+#define CACHE_ERASE_GROUP_BLOCKS (128)
+// maximum blocks of one write back command
+#define CACHE_FLUSH_MAX_BLOCKS (16)
+
+typedef struct
+{
+    uint64_t nr;
+    uint32_t lru; // access sequence, the smallest is the least recently used
+    bool valid;
+    bool dirty;
+} cacheEntry_t;
+
+typedef struct
+{
+    blockDevice_t bdev;
+    blockDevice_t *parent;
+    osiMutex_t *lock;
+    osiWork_t *flush_work;
+    osiTimer_t *flush_timer;
+    unsigned flush_ms;
+    unsigned count;
+    uint32_t seq;
+    cacheEntry_t *entries;
+    uint8_t *data;       // cache_count blocks, aligned to cache line
+    uint8_t *flush_buf;  // CACHE_FLUSH_MAX_BLOCKS blocks, aligned to cache line
+    unsigned *flush_idx; // temporal of entry index at write back
+    cacheBlockDeviceStat_t stat;
+} cacheBdev_t;
+
+static cacheBdev_t *prvBdevToCache(blockDevice_t *bdev)
+{
+    return (cacheBdev_t *)bdev->priv;
+}
+
+static inline uint8_t *prvEntryData(cacheBdev_t *d, unsigned idx)
+{
+    return d->data + idx * d->bdev.block_size;
+}
+
+static int prvFindEntry(cacheBdev_t *d, uint64_t nr)
+{
+    for (unsigned n = 0; n < d->count; n++)
+    {
+        if (d->entries[n].valid && d->entries[n].nr == nr)
+            return n;
+    }
+    return -1;
+}
+
+/**
+ * Write back dirty blocks inside [start, end), called with lock.
+ */
+static bool prvFlushRange(cacheBdev_t *d, uint64_t start, uint64_t end)
+{
+    unsigned count = 0;
+    for (unsigned n = 0; n < d->count; n++)
+    {
+        cacheEntry_t *e = &d->entries[n];
+        if (!e->valid || !e->dirty || e->nr < start || e->nr >= end)
+            continue;
+
+        // insertion sort by block number
+        unsigned pos = count++;
+        while (pos > 0 && d->entries[d->flush_idx[pos - 1]].nr > e->nr)
+        {
+            d->flush_idx[pos] = d->flush_idx[pos - 1];
+            pos--;
+        }
+        d->flush_idx[pos] = n;
+    }
+
+    if (count == 0)
+        return true;
+
+    d->stat.flush_count++;
+    size_t bsize = d->bdev.block_size;
+    bool ok = true;
+    for (unsigned n = 0; n < count;)
+    {
+        // merge contiguous blocks into one write
+        uint64_t nr = d->entries[d->flush_idx[n]].nr;
+        unsigned run = 1;
+        while (n + run < count && run < CACHE_FLUSH_MAX_BLOCKS &&
+               d->entries[d->flush_idx[n + run]].nr == nr + run)
+            run++;
+
+        const void *wdata = prvEntryData(d, d->flush_idx[n]);
+        if (run > 1)
+        {
+            for (unsigned i = 0; i < run; i++)
+                memcpy(d->flush_buf + i * bsize, prvEntryData(d, d->flush_idx[n + i]), bsize);
+            wdata = d->flush_buf;
+        }
+
+        if (blockDeviceWrite(d->parent, nr, run, wdata) != run)
+        {
+            OSI_LOGE(0, "cache write back failed, nr/%u count/%u", (unsigned)nr, run);
+            ok = false;
+        }
+        else
+        {
+            for (unsigned i = 0; i < run; i++)
+                d->entries[d->flush_idx[n + i]].dirty = false;
+            d->stat.dirty_count -= run;
+            d->stat.flush_blocks += run;
+            d->stat.flush_writes++;
+        }
+        n += run;
+    }
+    return ok;
+}
+
+/**
+ * Get an entry for new block, called with lock. When the least recently
+ * used entry is dirty, the dirty blocks in its erase group are written
+ * back together.
+ */
+static int prvAllocEntry(cacheBdev_t *d)
+{
+    int victim = -1;
+    for (unsigned n = 0; n < d->count; n++)
+    {
+        cacheEntry_t *e = &d->entries[n];
+        if (!e->valid)
+            return n;
+        if (victim < 0 || (int32_t)(e->lru - d->entries[victim].lru) < 0)
+            victim = n;
+    }
+
+    cacheEntry_t *e = &d->entries[victim];
+    if (e->dirty)
+    {
+        uint64_t start = e->nr - (e->nr % CACHE_ERASE_GROUP_BLOCKS);
+        if (!prvFlushRange(d, start, start + CACHE_ERASE_GROUP_BLOCKS) || e->dirty)
+            return -1;
+    }
+
+    e->valid = false;
+    return victim;
+}
+
+static void prvTouchEntry(cacheBdev_t *d, unsigned idx)
+{
+    d->entries[idx].lru = ++d->seq;
+}
+
+static void prvMarkDirty(cacheBdev_t *d, unsigned idx)
+{
+    if (d->entries[idx].dirty)
+        return;
+
+    d->entries[idx].dirty = true;
+    if (d->stat.dirty_count++ == 0)
+        osiTimerStartRelaxed(d->flush_timer, d->flush_ms, d->flush_ms);
+}
+
+static int prvCacheRead(blockDevice_t *dev, uint64_t nr, int count, void *buf)
+{
+    cacheBdev_t *d = prvBdevToCache(dev);
+    size_t bsize = dev->block_size;
+
+    if (count <= 0)
+        return count;
+
+    osiMutexLock(d->lock);
+    if (count > 1)
+    {
+        // read directly, and overlay newer data in dirty blocks
+        d->stat.bypass_read++;
+        int rcount = blockDeviceRead(d->parent, nr, count, buf);
+        if (rcount == count && d->stat.dirty_count > 0)
+        {
+            for (unsigned n = 0; n < d->count; n++)
+            {
+                cacheEntry_t *e = &d->entries[n];
+                if (e->valid && e->dirty && e->nr >= nr && e->nr < nr + count)
+                    memcpy((uint8_t *)buf + (e->nr - nr) * bsize, prvEntryData(d, n), bsize);
+            }
+        }
+        osiMutexUnlock(d->lock);
+        return rcount;
+    }
+
+    int idx = prvFindEntry(d, nr);
+    if (idx >= 0)
+    {
+        d->stat.read_hit++;
+    }
+    else
+    {
+        d->stat.read_miss++;
+        idx = prvAllocEntry(d);
+        if (idx < 0 || blockDeviceRead(d->parent, nr, 1, prvEntryData(d, idx)) != 1)
+        {
+            osiMutexUnlock(d->lock);
+            return -1;
+        }
+        d->entries[idx].nr = nr;
+        d->entries[idx].valid = true;
+        d->entries[idx].dirty = false;
+    }
+
+    prvTouchEntry(d, idx);
+    memcpy(buf, prvEntryData(d, idx), bsize);
+    osiMutexUnlock(d->lock);
+    return 1;
+}
+
+static int prvCacheWrite(blockDevice_t *dev, uint64_t nr, int count, const void *data)
+{
+    cacheBdev_t *d = prvBdevToCache(dev);
+    size_t bsize = dev->block_size;
+
+    if (count <= 0)
+        return count;
+
+    osiMutexLock(d->lock);
+    if (count > 1)
+    {
+        // write through, and cached blocks get the same data
+        d->stat.bypass_write++;
+        int wcount = blockDeviceWrite(d->parent, nr, count, data);
+        if (wcount == count)
+        {
+            for (unsigned n = 0; n < d->count; n++)
+            {
+                cacheEntry_t *e = &d->entries[n];
+                if (!e->valid || e->nr < nr || e->nr >= nr + count)
+                    continue;
+
+                memcpy(prvEntryData(d, n), (const uint8_t *)data + (e->nr - nr) * bsize, bsize);
+                if (e->dirty)
+                {
+                    e->dirty = false;
+                    d->stat.dirty_count--;
+                }
+            }
+        }
+        osiMutexUnlock(d->lock);
+        return wcount;
+    }
+
+    int idx = prvFindEntry(d, nr);
+    if (idx >= 0)
+    {
+        d->stat.write_hit++;
+    }
+    else
+    {
+        d->stat.write_miss++;
+        idx = prvAllocEntry(d);
+        if (idx < 0)
+        {
+            osiMutexUnlock(d->lock);
+            return -1;
+        }
+        d->entries[idx].nr = nr;
+        d->entries[idx].valid = true;
+        d->entries[idx].dirty = false;
+    }
+
+    prvTouchEntry(d, idx);
+    memcpy(prvEntryData(d, idx), data, bsize);
+    prvMarkDirty(d, idx);
+    osiMutexUnlock(d->lock);
+    return 1;
+}
+
+static int prvCacheErase(blockDevice_t *dev, uint64_t nr, int count)
+{
+    cacheBdev_t *d = prvBdevToCache(dev);
+
+    // erased blocks needn't be written back
+    osiMutexLock(d->lock);
+    for (unsigned n = 0; n < d->count; n++)
+    {
+        cacheEntry_t *e = &d->entries[n];
+        if (!e->valid || e->nr < nr || e->nr >= nr + count)
+            continue;
+
+        if (e->dirty)
+            d->stat.dirty_count--;
+        e->valid = false;
+        e->dirty = false;
+    }
+    int res = blockDeviceErase(d->parent, nr, count);
+    osiMutexUnlock(d->lock);
+    return res;
+}
+
+static int prvCacheFlush(blockDevice_t *dev)
+{
+    cacheBdev_t *d = prvBdevToCache(dev);
+
+    osiMutexLock(d->lock);
+    bool ok = prvFlushRange(d, 0, UINT64_MAX);
+    if (d->stat.dirty_count == 0)
+        osiTimerStop(d->flush_timer);
+    osiMutexUnlock(d->lock);
+
+    int res = blockDeviceFlush(d->parent);
+    return ok ? res : -1;
+}
+
+static void prvCacheStat(blockDevice_t *dev, blockDeviceStat_t *stat)
+{
+    cacheBdev_t *d = prvBdevToCache(dev);
+    blockDeviceStat(d->parent, stat);
+}
+
+static void prvFlushWork(void *param)
+{
+    cacheBdev_t *d = (cacheBdev_t *)param;
+    prvCacheFlush(&d->bdev);
+}
+
+static void prvShutdownCallback(void *ctx, osiShutdownMode_t mode)
+{
+    cacheBdev_t *d = (cacheBdev_t *)ctx;
+    prvCacheFlush(&d->bdev);
+}
+
+static void prvCacheDestroy(blockDevice_t *dev)
+{
+    cacheBdev_t *d = prvBdevToCache(dev);
+
+    prvCacheFlush(dev);
+    osiUnregisterShutdownCallback(prvShutdownCallback, d);
+    osiTimerDelete(d->flush_timer);
+    osiWorkDelete(d->flush_work);
+    osiMutexDelete(d->lock);
+    blockDeviceDestroy(d->parent);
+    free(d);
+}
+
+void cacheBlockDeviceGetStat(blockDevice_t *dev, cacheBlockDeviceStat_t *stat)
+{
+    cacheBdev_t *d = prvBdevToCache(dev);
+
+    osiMutexLock(d->lock);
+    *stat = d->stat;
+    osiMutexUnlock(d->lock);
+}
+
+blockDevice_t *cacheBlockDeviceCreate(blockDevice_t *parent, unsigned cache_count, unsigned flush_ms)
+{
+    if (parent == NULL || cache_count == 0 || parent->block_size == 0)
+        return NULL;
+
+    size_t bsize = parent->block_size;
+    unsigned alloc_len = sizeof(cacheBdev_t) +
+                         cache_count * sizeof(cacheEntry_t) +
+                         cache_count * sizeof(unsigned) +
+                         (cache_count + CACHE_FLUSH_MAX_BLOCKS) * bsize +
+                         CONFIG_CACHE_LINE_SIZE;
+    uintptr_t mem = (uintptr_t)calloc(1, alloc_len);
+    if (mem == 0)
+        return NULL;
+
+    cacheBdev_t *d = (cacheBdev_t *)OSI_PTR_INCR_POST(mem, sizeof(cacheBdev_t));
+    d->entries = (cacheEntry_t *)OSI_PTR_INCR_POST(mem, cache_count * sizeof(cacheEntry_t));
+    d->flush_idx = (unsigned *)OSI_PTR_INCR_POST(mem, cache_count * sizeof(unsigned));
+    mem = OSI_ALIGN_UP(mem, CONFIG_CACHE_LINE_SIZE);
+    d->data = (uint8_t *)OSI_PTR_INCR_POST(mem, cache_count * bsize);
+    d->flush_buf = (uint8_t *)mem;
+
+    d->parent = parent;
+    d->count = cache_count;
+    d->flush_ms = flush_ms;
+    d->lock = osiMutexCreate();
+    d->flush_work = osiWorkCreate(prvFlushWork, NULL, d);
+    d->flush_timer = osiTimerCreateWork(d->flush_work, osiSysWorkQueueFileWrite());
+    if (d->lock == NULL || d->flush_work == NULL || d->flush_timer == NULL)
+        goto fail;
+
+    osiRegisterShutdownCallback(prvShutdownCallback, d);
+
+    d->bdev.block_count = parent->block_count;
+    d->bdev.block_size = bsize;
+    d->bdev.ops.read = prvCacheRead;
+    d->bdev.ops.write = prvCacheWrite;
+    d->bdev.ops.erase = prvCacheErase;
+    d->bdev.ops.flush = prvCacheFlush;
+    d->bdev.ops.stat = prvCacheStat;
+    d->bdev.ops.destroy = prvCacheDestroy;
+    d->bdev.priv = d;
+    return &d->bdev;
+
+fail:
+    osiTimerDelete(d->flush_timer);
+    osiWorkDelete(d->flush_work);
+    osiMutexDelete(d->lock);
+    free(d);
+    return NULL;
+}
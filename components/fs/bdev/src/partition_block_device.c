@@ -44,6 +44,12 @@ static int _erase(blockDevice_t *dev, uint64_t nr, int count)
     return blockDeviceErase(p->parent, nr + p->offset, count);
 }
 
+static int _flush(blockDevice_t *dev)
+{
+    partBlockDevicePriv_t *p = (partBlockDevicePriv_t *)dev->priv;
+    return blockDeviceFlush(p->parent);
+}
+
 static void _destroy(blockDevice_t *dev)
 {
     free(dev);
@@ -53,6 +59,7 @@ static const blockDeviceOps_t _ops = {
     .read = _read,
     .write = _write,
     .erase = _erase,
+    .flush = _flush,
     .destroy = _destroy,
 };
 
@@ -42,6 +42,34 @@ static tfBdev_t *prvBdevToTf(blockDevice_t *bdev)
     return (tfBdev_t *)bdev->priv;
 }
 
+/**
+ * Read to buffer which is DMA capable, but not aligned to cache line.
+ *
+ * Cache lines partly outside of the buffer can't be invalidated. So,
+ * only the first and the last sectors are read through bounce buffer,
+ * and the middle sectors are read directly by one command. The partial
+ * cache lines of the middle part are inside the first and the last
+ * sectors, and they are filled after the middle part is read.
+ */
+static bool prvTflashReadSplit(tfBdev_t *d, uint64_t nr, int count, void *data)
+{
+    char *head = (char *)d->buf;
+    char *tail = head + TCARD_SECTOR_SIZE;
+    char *last = (char *)data + (count - 1) * TCARD_SECTOR_SIZE;
+
+    if (!drvSdmmcRead(d->sdmmc, (uint32_t)nr, head, TCARD_SECTOR_SIZE))
+        return false;
+    if (!drvSdmmcRead(d->sdmmc, (uint32_t)(nr + count - 1), tail, TCARD_SECTOR_SIZE))
+        return false;
+    if (!drvSdmmcRead(d->sdmmc, (uint32_t)(nr + 1), (char *)data + TCARD_SECTOR_SIZE,
+                      (count - 2) * TCARD_SECTOR_SIZE))
+        return false;
+
+    memcpy(data, head, TCARD_SECTOR_SIZE);
+    memcpy(last, tail, TCARD_SECTOR_SIZE);
+    return true;
+}
+
 static int prvTflashRead(blockDevice_t *dev, uint64_t nr, int count, void *data)
 {
     OSI_LOGD(0, "read (0x%x) nr/%u count/%d", data, (unsigned)nr, count);
@@ -61,6 +89,14 @@ static int prvTflashRead(blockDevice_t *dev, uint64_t nr, int count, void *data)
     unsigned total_count = count;
     osiMutexLock(d->lock);
 
+    // bounce buffer is only used for the first and the last sectors
+    if (OSI_IS_ALIGNED(data, 4) && count > 2)
+    {
+        bool ok = prvTflashReadSplit(d, nr, count, data);
+        osiMutexUnlock(d->lock);
+        return ok ? total_count : -1;
+    }
+
     while (count > 0)
     {
         int rcount = OSI_MIN(unsigned, count, TCARD_CACHE_SECTOR_COUNT);
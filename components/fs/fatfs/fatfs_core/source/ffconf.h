@@ -4,6 +4,8 @@
 
 #define FFCONF_DEF	86606	/* Revision ID */
 
+#include "fs_config.h"
+
 /*---------------------------------------------------------------------------/
 / Function Configurations
 /---------------------------------------------------------------------------*/
@@ -42,7 +44,7 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_FASTSEEK	0
+#define FF_USE_FASTSEEK	1
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
@@ -229,7 +231,11 @@
 /  buffer in the filesystem object (FATFS) is used for the file data transfer. */
 
 
+#ifdef CONFIG_FS_FATFS_EXFAT
+#define FF_FS_EXFAT		1
+#else
 #define FF_FS_EXFAT		0
+#endif
 /* This option switches support for exFAT filesystem. (0:Disable or 1:Enable)
 /  To enable exFAT, also LFN needs to be enabled. (FF_USE_LFN >= 1)
 /  Note that enabling exFAT discards ANSI C (C89) compatibility. */
@@ -106,7 +106,8 @@ DRESULT fat_disk_ioctl(BYTE idx, BYTE cmd, void *buff)
     switch (cmd)
     {
     case CTRL_SYNC:
-        //TODO
+        if (blockDeviceFlush(s_block_device[idx]) < 0)
+            return RES_ERROR;
         return RES_OK;
 
     case CTRL_TRIM:
@@ -44,6 +44,18 @@
 #define CHECK_FRESULT_RETURN(fr) OSI_DO_WHILE0(if ((fr) != FR_OK) {errno = prvFatResToErrno(fr); return -1; } else return 0;)
 #define FD_MIN (3)
 
+// files not smaller than this get cluster link map at seek
+#define FASTSEEK_MIN_SIZE (64 * 1024)
+// initial items of cluster link map, 15 fragments
+#define FASTSEEK_TBL_INIT (32)
+// maximum items of cluster link map of a file
+#define FASTSEEK_TBL_MAX (256)
+// maximum total size of cluster link maps of a volume
+#define FASTSEEK_MEM_MAX (8 * 1024)
+
+// work buffer size of mkfs, FAT and bitmap are written in this unit
+#define MKFS_WORK_SIZE (32 * 1024)
+
 typedef SLIST_ENTRY(fatfsFile) fatfsFileIter_t;
 typedef SLIST_HEAD(, fatfsFile) fatfsFileHead_t;
 typedef struct fatfsFile
@@ -51,6 +63,7 @@ typedef struct fatfsFile
     fatfsFileIter_t iter;
     FIL fil;
     uint16_t fd;
+    bool no_fastseek; // cluster link map is too large
 } fatfsFile_t;
 
 typedef struct
@@ -69,6 +82,7 @@ typedef struct
     bool read_only;
     fatfsFileHead_t fils;
     osiMutex_t *lock;
+    size_t cltbl_mem; // total size of cluster link maps
 } fatfsContext_t;
 
 /**
@@ -183,6 +197,71 @@ static uint16_t prvFatFindNewFd(fatfsContext_t *fs)
     return 0; // never reach
 }
 
+/**
+ * Free cluster link map of the file (inside lock). It should be called
+ * before the cluster chain is changed.
+ */
+static void prvFatFastSeekDrop(fatfsContext_t *fs, fatfsFile_t *fil)
+{
+    DWORD *tbl = fil->fil.cltbl;
+    if (tbl == NULL)
+        return;
+
+    fil->fil.cltbl = NULL;
+    fs->cltbl_mem -= tbl[-1] * sizeof(DWORD);
+    free(tbl - 1);
+}
+
+/**
+ * Create cluster link map of the file, if not exist (inside lock). The
+ * map is created at the first seek of large file, and seek and read
+ * won't follow the FAT chain after that. On failure, seek falls back
+ * to normal mode silently.
+ *
+ * The allocated item count is stored just before the map.
+ */
+static void prvFatFastSeekPrepare(fatfsContext_t *fs, fatfsFile_t *fil)
+{
+    if (fil->fil.cltbl != NULL || fil->no_fastseek ||
+        f_size(&fil->fil) < FASTSEEK_MIN_SIZE)
+        return;
+
+    DWORD count = FASTSEEK_TBL_INIT;
+    for (;;)
+    {
+        size_t size = count * sizeof(DWORD);
+        if (fs->cltbl_mem + size > FASTSEEK_MEM_MAX)
+            return;
+
+        DWORD *tbl = (DWORD *)malloc(size + sizeof(DWORD));
+        if (tbl == NULL)
+            return;
+
+        tbl[0] = count;
+        tbl[1] = count;
+        fil->fil.cltbl = &tbl[1];
+        fs->cltbl_mem += size;
+
+        FRESULT fr = f_lseek(&fil->fil, CREATE_LINKMAP);
+        if (fr == FR_OK)
+        {
+            OSI_LOGD(0, "fatfs fd %d fast seek, %d items", fil->fd, tbl[1]);
+            return;
+        }
+
+        DWORD needed = tbl[1];
+        prvFatFastSeekDrop(fs, fil);
+        if (fr != FR_NOT_ENOUGH_CORE || needed > FASTSEEK_TBL_MAX)
+        {
+            OSI_LOGD(0, "fatfs fd %d no fast seek, %d/%d", fil->fd, fr, needed);
+            fil->no_fastseek = true;
+            return;
+        }
+
+        count = needed;
+    }
+}
+
 /**
  * open API
  */
@@ -205,6 +284,7 @@ static int prvFatOpen(void *ctx, const char *path, int flags, int mode)
     osiMutexLock(fs->lock);
 
     fil->fd = prvFatFindNewFd(fs);
+    fil->no_fastseek = false;
 
     int m_mode = prvFatModeConv(flags);
     prvFatNameWithId(fs, fs->fat_path1, path);
@@ -234,6 +314,8 @@ static int prvFatCloseLocked(fatfsContext_t *fs, int fd)
     if (fr != FR_OK)
         return -prvFatResToErrno(fr);
 
+    prvFatFastSeekDrop(fs, fil);
+
     SLIST_REMOVE(&fs->fils, fil, fatfsFile, iter);
     free(fil);
     return 0;
@@ -296,6 +378,10 @@ static ssize_t prvFatWriteLocked(fatfsContext_t *fs, int fd, const void *data, s
     if (fil == NULL)
         return -ENOENT;
 
+    // cluster link map can't cover new clusters
+    if (f_tell(&fil->fil) + size > f_size(&fil->fil))
+        prvFatFastSeekDrop(fs, fil);
+
     UINT write_len = 0;
     FRESULT fr = f_write(&fil->fil, data, size, &write_len);
     return (fr == FR_OK) ? write_len : -prvFatResToErrno(fr);
@@ -347,6 +433,7 @@ static long prvFatLseekLocked(fatfsContext_t *fs, int fd, long offset, int mode)
     if (off > f_size(&fil->fil))
         off = f_size(&fil->fil);
 
+    prvFatFastSeekPrepare(fs, fil);
     FRESULT fr = f_lseek(&fil->fil, (FSIZE_t)off);
     return (fr == FR_OK) ? f_tell(&fil->fil) : -prvFatResToErrno(fr);
 }
@@ -483,6 +570,7 @@ static int prvFatFtruncateLocked(fatfsContext_t *fs, int fd, long length)
     if (length == size)
         return 0;
 
+    prvFatFastSeekDrop(fs, fil);
     if (length < size)
     {
         FRESULT fr = f_lseek(&fil->fil, length);
@@ -920,14 +1008,27 @@ failed:
 
 int fatfs_vfs_mkfs(blockDevice_t *bdev)
 {
-    BYTE work[FF_MAX_SS];
+    BYTE sector[FF_MAX_SS];
 
     if (bdev == NULL)
         ERR_RETURN(EINVAL, -1);
 
+    // larger work buffer makes format of large volume much faster
+    UINT work_size = MKFS_WORK_SIZE;
+    BYTE *work = (BYTE *)malloc(work_size);
+    if (work == NULL)
+    {
+        work = sector;
+        work_size = sizeof(sector);
+    }
+
     BYTE idx = fat_disk_register_device(bdev);
     if (idx >= FF_VOLUMES)
+    {
+        if (work != sector)
+            free(work);
         ERR_RETURN(EXDEV, -1);
+    }
 
     fatfsContext_t fs;
 
@@ -935,17 +1036,26 @@ int fatfs_vfs_mkfs(blockDevice_t *bdev)
     SLIST_INIT(&fs.fils);
     fs.fs_dev_no = idx;
 
+    // FatFs selects FAT16 for small volume, FAT32 for 128MB or more, and
+    // exFAT for 32GB or more. Auto cluster size follows SD card file
+    // system specification, such as 32KB for FAT32 and 128KB for exFAT.
     MKFS_PARM opt = {
-        .fmt = FM_FAT,
+#if FF_FS_EXFAT
+        .fmt = FM_ANY,
+#else
+        .fmt = FM_FAT | FM_FAT32,
+#endif
         .n_fat = 2,
         .align = 4096,
         .n_root = 0,  // use default
         .au_size = 0, // auto selection
     };
     prvFatNameWithId(&fs, fs.fat_path1, "");
-    FRESULT fr = f_mkfs(fs.fat_path1, &opt, work, sizeof(work));
+    FRESULT fr = f_mkfs(fs.fat_path1, &opt, work, work_size);
 
     fat_disk_unregister_device(fs.fs_dev_no);
+    if (work != sector)
+        free(work);
     CHECK_FRESULT_RETURN(fr);
 }
 
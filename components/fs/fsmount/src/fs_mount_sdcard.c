@@ -15,6 +15,7 @@
 
 #include <stdbool.h>
 #include "tflash_block_device.h"
+#include "cache_block_device.h"
 #include "drv_names.h"
 #include "fatfs_vfs.h"
 #include "vfs.h"
@@ -24,6 +25,9 @@
 
 blockDevice_t *gSdBdev = NULL;
 
+// delay to write back dirty blocks of sdcard cache
+#define SDCARD_CACHE_FLUSH_MS (2000)
+
 static bool prvMountSdcard(bool format_on_fail)
 {
     blockDevice_t *bdev = tflash_device_create(DRV_NAME_SDMMC1);
@@ -33,6 +37,17 @@ static bool prvMountSdcard(bool format_on_fail)
         return false;
     }
 
+#ifdef CONFIG_FS_SDCARD_CACHE_COUNT
+    blockDevice_t *cache = cacheBlockDeviceCreate(bdev, CONFIG_FS_SDCARD_CACHE_COUNT, SDCARD_CACHE_FLUSH_MS);
+    if (cache == NULL)
+    {
+        OSI_LOGE(0, "fail to create sdcard cache");
+        blockDeviceDestroy(bdev);
+        return false;
+    }
+    bdev = cache;
+#endif
+
     int r = fatfs_vfs_mount(CONFIG_FS_SDCARD_MOUNT_POINT, bdev);
     if (r != 0 && format_on_fail)
     {
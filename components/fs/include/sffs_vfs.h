@@ -21,6 +21,24 @@ extern "C" {
 
 struct blockDevice;
 
+/**
+ * statistics of mounted SFFS
+ */
+typedef struct
+{
+    unsigned block_size;        ///< logical block size
+    unsigned block_count;       ///< total logical block count
+    unsigned free_count;        ///< free logical block count
+    unsigned sfile_reserved;    ///< logical blocks reserved for safe file write
+    unsigned avail_count;       ///< free logical blocks excluding reserved
+    unsigned block_write_count; ///< logical block write count
+    unsigned erase_block_count; ///< erase count of block device
+    unsigned min_erase_count;   ///< minimal erase count of erase blocks
+    unsigned max_erase_count;   ///< maximal erase count of erase blocks
+    unsigned idle_count;        ///< idle time maintenance count
+    bool idle_pending;          ///< modified after last idle time maintenance
+} sffsVfsStat_t;
+
 /**
  * mount SFFS to VFS
  *
@@ -49,6 +67,48 @@ int sffsVfsMount(const char *base_path,
  */
 int sffsVfsMkfs(struct blockDevice *bdev);
 
+/**
+ * enable or disable idle time maintenance of mounted SFFS
+ *
+ * It is enabled by default for read write mount. After modification,
+ * when system is idle and going to suspend, pending safe file writes,
+ * SFFS cached blocks and metadata will be written, and block device
+ * will be flushed. So, later writes are less likely to trigger them
+ * in write path. Suspend is postponed till the maintenance is done.
+ *
+ * @param base_path mount point in VFS
+ * @param enable    true to enable idle time maintenance
+ * @return
+ *      - 0 on success
+ *      - -1 if \p base_path is not mounted SFFS
+ */
+int sffsVfsSetIdleMaintenance(const char *base_path, bool enable);
+
+/**
+ * get statistics of mounted SFFS
+ *
+ * @param base_path mount point in VFS
+ * @param st        output statistics
+ * @return
+ *      - 0 on success
+ *      - -1 on fail
+ */
+int sffsVfsGetStat(const char *base_path, sffsVfsStat_t *st);
+
+/**
+ * estimate logical block count needed for specified file size
+ *
+ * Together with \p avail_count of \p sffsVfsGetStat, it can be
+ * predicted whether a file write will fail due to no space.
+ *
+ * @param base_path mount point in VFS
+ * @param size      file size to be estimated
+ * @return
+ *      - needed logical block count
+ *      - -1 on fail
+ */
+int sffsVfsBlockNeeded(const char *base_path, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -649,6 +649,74 @@ ssize_t vfs_sfile_read(const char *path, void *buf, size_t count);
  */
 ssize_t vfs_sfile_write(const char *path, const void *buf, size_t count);
 
+/**
+ * write safe file, behind the caller
+ *
+ * The content is copied, and written later in file write work queue.
+ * Repeated writes to the same file before it is written are coalesced,
+ * and only the last content is written.
+ *
+ * Pending writes are written at shutdown, and before other access to
+ * the file or its parent directories, such as \p vfs_sfile_read,
+ * \p vfs_open and \p vfs_opendir. So, the behavior of access is the
+ * same as \p vfs_sfile_write. \p vfs_sfile_write will drop the pending
+ * write of the same file. The file write itself is the same as
+ * \p vfs_sfile_write, the file will either be the original content or
+ * the new content on power failure.
+ *
+ * Error during the delayed write can't be returned to caller. When
+ * memory is not enough, or the content is too large, it will fall back
+ * to \p vfs_sfile_write.
+ *
+ * \param [in] path     file path
+ * \param [in] buf      buf for write
+ * \param [in] count    byte count
+ * \return
+ *      - \p count on success
+ *      - -1 on error
+ */
+ssize_t vfs_sfile_write_behind(const char *path, const void *buf, size_t count);
+
+/**
+ * write pending safe file writes
+ *
+ * \param [in] path     file or directory path, NULL for all
+ * \return
+ *      - 0 on success
+ *      - -1 on invalid path
+ */
+int vfs_sfile_flush(const char *path);
+
+/**
+ * drop cached path lookup results
+ *
+ * Results of \p vfs_stat, and non-existed paths of \p vfs_open and
+ * \p vfs_opendir are cached. The cache is invalidated by changes through
+ * vfs. It should be called when the file system is changed by others,
+ * such as the block device is exported to USB host.
+ *
+ * \param [in] path     file or directory path, NULL for all
+ */
+void vfs_dentry_invalidate(const char *path);
+
+/**
+ * map file content for read
+ *
+ * It is only supported by file systems with contiguous files in memory
+ * mapped region, such as XIPFS. The returned pointer is valid till the
+ * file system is unmounted, and the content is read only.
+ *
+ * For other file systems, such as SFFS and FAT, it will return NULL and
+ * errno is ENOSYS. Caller should fall back to read the file to RAM.
+ *
+ * \param [in] path     file path
+ * \param [out] size    file size, can be NULL
+ * \return
+ *      - pointer of file content on success
+ *      - NULL on error
+ */
+const void *vfs_mmap(const char *path, size_t *size);
+
 /**
  * delete files and subdirectories under a directory
  *
@@ -0,0 +1,156 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _VFS_AIO_H_
+#define _VFS_AIO_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Asynchronous file access
+ *
+ * Requests are executed in file write work queue, in the order of
+ * submission. Read and write are performed at the current file position
+ * when the request is executed, the same as \p vfs_read and \p vfs_write.
+ *
+ * Caller should call \p vfs_aio_wait before \p vfs_close, \p vfs_lseek
+ * and other synchronous access of the file.
+ */
+
+/**
+ * \brief asynchronous request completion callback
+ *
+ * It is called in file write work queue. It can submit new requests,
+ * and it can't call \p vfs_aio_wait.
+ *
+ * \param ctx       callback context
+ * \param result    return value of \p vfs_read or \p vfs_write
+ */
+typedef void (*vfs_aio_callback_t)(void *ctx, ssize_t result);
+
+/**
+ * \brief opaque data structure of double buffered streaming writer
+ */
+typedef struct vfs_aio_stream vfs_aio_stream_t;
+
+/**
+ * \brief submit asynchronous read
+ *
+ * \p buf should be valid till the callback is called.
+ *
+ * \param fd        file descriptor
+ * \param buf       buffer for read
+ * \param size      read size
+ * \param cb        completion callback, can be NULL
+ * \param ctx       callback context
+ * \return
+ *      - 0 on success
+ *      - -1 on error
+ */
+int vfs_aio_read(int fd, void *buf, size_t size, vfs_aio_callback_t cb, void *ctx);
+
+/**
+ * \brief submit asynchronous write
+ *
+ * When \p cb is not NULL, \p buf should be valid till the callback is
+ * called.
+ *
+ * When \p cb is NULL, data will be copied and \p buf can be reused after
+ * return. Sequential writes of the same file without callback will be
+ * merged, to reduce small writes to flash. Error of these writes will
+ * be returned by \p vfs_aio_wait.
+ *
+ * \param fd        file descriptor
+ * \param buf       data to be written
+ * \param size      write size
+ * \param cb        completion callback, can be NULL
+ * \param ctx       callback context
+ * \return
+ *      - 0 on success
+ *      - -1 on error
+ */
+int vfs_aio_write(int fd, const void *buf, size_t size, vfs_aio_callback_t cb, void *ctx);
+
+/**
+ * \brief wait all submitted requests of the file finished
+ *
+ * It can't be called in file write work queue, including completion
+ * callback.
+ *
+ * \param fd        file descriptor, -1 for all files
+ * \return
+ *      - 0 on success
+ *      - -1 if any write without callback failed
+ */
+int vfs_aio_wait(int fd);
+
+/**
+ * \brief create double buffered streaming writer
+ *
+ * Data are written to one buffer, and the full buffer is written to file
+ * asynchronously. \p vfs_aio_stream_write will block only when the other
+ * buffer is still being written.
+ *
+ * It won't take the ownership of \p fd.
+ *
+ * \param fd        file descriptor
+ * \param buf_size  size of each buffer
+ * \return
+ *      - streaming writer
+ *      - NULL on invalid parameter or out of memory
+ */
+vfs_aio_stream_t *vfs_aio_stream_create(int fd, size_t buf_size);
+
+/**
+ * \brief write data to streaming writer
+ *
+ * \param s         streaming writer
+ * \param data      data to be written
+ * \param size      write size
+ * \return
+ *      - \p size on success
+ *      - -1 on error, including error of previous buffer write
+ */
+ssize_t vfs_aio_stream_write(vfs_aio_stream_t *s, const void *data, size_t size);
+
+/**
+ * \brief write buffered data, and wait finish
+ *
+ * \param s         streaming writer
+ * \return
+ *      - 0 on success
+ *      - -1 on error
+ */
+int vfs_aio_stream_flush(vfs_aio_stream_t *s);
+
+/**
+ * \brief flush and delete streaming writer
+ *
+ * The file descriptor is not closed.
+ *
+ * \param s         streaming writer
+ * \return
+ *      - 0 on success
+ *      - -1 on flush error
+ */
+int vfs_aio_stream_delete(vfs_aio_stream_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
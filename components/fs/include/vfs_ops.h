@@ -56,6 +56,7 @@ typedef struct
     ssize_t (*sfile_write)(void *fs, const char *path, const void *data, size_t size);
     ssize_t (*sfile_size)(void *fs, const char *path);
     ssize_t (*file_write)(void *fs, const char *path, const void *data, size_t size);
+    const void *(*mmap)(void *fs, const char *path, size_t *size);
 } vfs_ops_t;
 
 int vfs_register(const char *base_path, const vfs_ops_t *ops, void *fs);
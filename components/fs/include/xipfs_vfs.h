@@ -0,0 +1,86 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _XIPFS_VFS_H_
+#define _XIPFS_VFS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * XIPFS is a read only file system in a memory mapped region, typically
+ * a flash region accessed through XIP. Each file is contiguous, so the
+ * content can be used in place by \p vfs_mmap without copy to RAM.
+ *
+ * The image is generated by "tools/xipfs_gen.py" at build or install
+ * time, little endian:
+ *
+ *   xipfsHeader_t
+ *   xipfsEntry_t[count], sorted by name with strcmp
+ *   file contents, each starts at XIPFS_ALIGN
+ *
+ * Names are relative path to mount point, such as "fonts/cn16.bin".
+ * Directories are implicit by the names.
+ *
+ * File content can be LZMA compressed, with XIPFS_FLAG_LZMA in the low
+ * bits of offset. The content is the output of "dtools lzmare2", that is
+ * independent blocks can be decompressed by hardware. Blocks are
+ * decompressed on read into a small block cache, and \p vfs_mmap isn't
+ * supported for compressed files. The size in entry is the decompressed
+ * size.
+ */
+#define XIPFS_MAGIC (0x46504958) // "XIPF"
+#define XIPFS_VERSION (1)
+#define XIPFS_ALIGN (32) // cache line size
+#define XIPFS_NAME_MAX (56)
+#define XIPFS_FLAG_LZMA (1 << 0)
+#define XIPFS_FLAG_MASK (XIPFS_ALIGN - 1)
+
+typedef struct
+{
+    uint32_t magic;   ///< XIPFS_MAGIC
+    uint32_t version; ///< XIPFS_VERSION
+    uint32_t count;   ///< file count
+    uint32_t size;    ///< whole image size, including header
+} xipfsHeader_t;
+
+typedef struct
+{
+    char name[XIPFS_NAME_MAX]; ///< file name, null terminated
+    uint32_t offset;           ///< content offset from the start of image, and flags
+    uint32_t size;             ///< content size, decompressed size for LZMA
+} xipfsEntry_t;
+
+/**
+ * mount XIPFS image to VFS
+ *
+ * \p base should be kept valid and unchanged till umount. For image in
+ * flash, it is the address returned by \p drvSpiFlashMapAddress.
+ *
+ * @param base_path mount point in VFS
+ * @param base      image address
+ * @param size      region size, image size can't exceed it
+ * @return
+ *      - 0 on success
+ *      - -1 on fail, invalid image or out of memory
+ */
+int xipfsVfsMount(const char *base_path, const void *base, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
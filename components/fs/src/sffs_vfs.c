@@ -23,9 +23,101 @@
 #include "sffs.h"
 #include "sffs_vfs.h"
 
+#define SFFS_VFS_MOUNT_MAX (4)
+
 #define CHECK_RESULT(res) OSI_DO_WHILE0(if ((res) < 0) {errno = -(res); return -1; })
 #define CHECK_RESULT_RETURN(res) OSI_DO_WHILE0(if ((res) < 0) {errno = -(res); return -1; } else return (res);)
 
+/**
+ * Mounted SFFS, for idle time maintenance and statistics.
+ *
+ * After modification, the PM source is locked with prepare callback.
+ * At suspend check, that is the system is idle, the maintenance work
+ * is queued and suspend is postponed. The maintenance work writes
+ * pending safe files, SFFS cached blocks and metadata, and flushes
+ * block device. So, they won't be written in later write path.
+ */
+typedef struct
+{
+    sffsFs_t *fs;
+    blockDevice_t *bdev;
+    size_t sfile_reserved;
+    osiPmSource_t *pm;
+    osiWork_t *idle_work;
+    bool idle_enabled;
+    bool dirty;
+    unsigned idle_count;
+    char base_path[VFS_PREFIX_MAX];
+} sffsVfsMount_t;
+
+static sffsVfsMount_t g_sffs_mounts[SFFS_VFS_MOUNT_MAX];
+
+static sffsVfsMount_t *_findMount(sffsFs_t *fs)
+{
+    for (unsigned n = 0; n < SFFS_VFS_MOUNT_MAX; n++)
+    {
+        if (g_sffs_mounts[n].fs == fs)
+            return &g_sffs_mounts[n];
+    }
+    return NULL;
+}
+
+static void _markDirty(sffsFs_t *fs)
+{
+    sffsVfsMount_t *m = _findMount(fs);
+    if (m == NULL || !m->idle_enabled)
+        return;
+
+    m->dirty = true;
+    osiPmWakeLock(m->pm);
+}
+
+static bool _idlePrepare(void *ctx)
+{
+    sffsVfsMount_t *m = (sffsVfsMount_t *)ctx;
+    if (!m->dirty)
+        return true;
+
+    osiWorkEnqueue(m->idle_work, osiSysWorkQueueFileWrite());
+    return false;
+}
+
+static void _idleWork(void *param)
+{
+    sffsVfsMount_t *m = (sffsVfsMount_t *)param;
+
+    vfs_sfile_flush(m->base_path);
+    m->dirty = false;
+    sffsSync(m->fs);
+    blockDeviceFlush(m->bdev);
+    m->idle_count++;
+
+    uint32_t critical = osiEnterCritical();
+    if (!m->dirty)
+        osiPmWakeUnlock(m->pm);
+    osiExitCritical(critical);
+}
+
+static const osiPmSourceOps_t g_sffs_pm_ops = {
+    .prepare = _idlePrepare,
+};
+
+static void _releaseMount(sffsFs_t *fs)
+{
+    sffsVfsMount_t *m = _findMount(fs);
+    if (m == NULL)
+        return;
+
+    osiPmSourceDelete(m->pm);
+    if (m->idle_work != NULL)
+    {
+        osiWorkCancel(m->idle_work);
+        osiWorkWaitFinish(m->idle_work, OSI_WAIT_FOREVER);
+        osiWorkDelete(m->idle_work);
+    }
+    memset(m, 0, sizeof(*m));
+}
+
 static int _open(void *ctx, const char *path, int flags, int mode)
 {
     sffsFs_t *fs = (sffsFs_t *)ctx;
@@ -59,6 +151,7 @@ static ssize_t _write(void *ctx, int fd, const void *data, size_t size)
     ssize_t res = sffsWrite(fs, fd, data, size);
     if (res < 0)
         OSI_LOGD(0, "SFFS write error: %d", res);
+    _markDirty(fs);
     CHECK_RESULT_RETURN(res);
 }
 
@@ -105,6 +198,7 @@ static int _ftruncate(void *ctx, int fd, off_t length)
     int res = sffsFtruncate(fs, fd, length);
     if (res < 0)
         OSI_LOGD(0, "SFFS ftruncate error: %d", res);
+    _markDirty(fs);
     CHECK_RESULT_RETURN(res);
 }
 
@@ -115,6 +209,7 @@ static int _truncate(void *ctx, const char *path, long length)
     CHECK_RESULT(fd);
     int res = sffsFtruncate(fs, fd, length);
     sffsClose(fs, fd);
+    _markDirty(fs);
     CHECK_RESULT_RETURN(res);
 }
 
@@ -124,6 +219,7 @@ static int _unlink(void *ctx, const char *path)
     int res = sffsUnlink(fs, path);
     if (res < 0)
         OSI_LOGD(0, "SFFS unlink error: %d", res);
+    _markDirty(fs);
     CHECK_RESULT_RETURN(res);
 }
 
@@ -133,6 +229,7 @@ static int _rename(void *ctx, const char *src, const char *dst)
     int res = sffsRename(fs, src, dst);
     if (res < 0)
         OSI_LOGD(0, "SFFS rename error: %d", res);
+    _markDirty(fs);
     CHECK_RESULT_RETURN(res);
 }
 
@@ -204,6 +301,7 @@ static int _statvfs(void *ctx, struct statvfs *buf)
 static int _umount(void *ctx)
 {
     sffsFs_t *fs = (sffsFs_t *)ctx;
+    _releaseMount(fs);
     int res = sffsUnmount(fs);
     CHECK_RESULT_RETURN(res);
 }
@@ -219,6 +317,7 @@ static ssize_t _sfile_write(void *ctx, const char *path, const void *data, size_
 {
     sffsFs_t *fs = (sffsFs_t *)ctx;
     int res = sffsSfileWrite(fs, path, data, size);
+    _markDirty(fs);
     CHECK_RESULT_RETURN(res);
 }
 
@@ -226,6 +325,7 @@ static ssize_t _file_write(void *ctx, const char *path, const void *data, size_t
 {
     sffsFs_t *fs = (sffsFs_t *)ctx;
     int res = sffsFileWrite(fs, path, data, size);
+    _markDirty(fs);
     CHECK_RESULT_RETURN(res);
 }
 
@@ -278,9 +378,77 @@ int sffsVfsMount(const char *base_path, blockDevice_t *bdev,
     if (sfile_reserved_lb != 0)
         sffsSetSfileReserveCount(fs, sfile_reserved_lb);
 
+    sffsVfsMount_t *m = _findMount(NULL);
+    if (m != NULL)
+    {
+        unsigned idx = m - g_sffs_mounts;
+        m->fs = fs;
+        m->bdev = bdev;
+        m->sfile_reserved = sfile_reserved_lb;
+        strncpy(m->base_path, base_path, VFS_PREFIX_MAX - 1);
+        m->idle_work = osiWorkCreate(_idleWork, NULL, m);
+        m->pm = osiPmSourceCreate(OSI_MAKE_TAG('S', 'F', 'S', '0' + idx), &g_sffs_pm_ops, m);
+        m->idle_enabled = !read_only && m->idle_work != NULL && m->pm != NULL;
+    }
+
+    return 0;
+}
+
+int sffsVfsSetIdleMaintenance(const char *base_path, bool enable)
+{
+    sffsFs_t *fs = (sffsFs_t *)vfs_mount_handle(base_path);
+    sffsVfsMount_t *m = (fs == NULL) ? NULL : _findMount(fs);
+    if (m == NULL || m->idle_work == NULL || m->pm == NULL)
+        return -1;
+
+    m->idle_enabled = enable;
+    if (!enable)
+    {
+        m->dirty = false;
+        osiPmWakeUnlock(m->pm);
+    }
     return 0;
 }
 
+int sffsVfsGetStat(const char *base_path, sffsVfsStat_t *st)
+{
+    sffsFs_t *fs = (sffsFs_t *)vfs_mount_handle(base_path);
+    sffsVfsMount_t *m = (fs == NULL) ? NULL : _findMount(fs);
+    if (m == NULL || st == NULL)
+        return -1;
+
+    struct statvfs sv;
+    int res = sffsStatVfs(fs, &sv);
+    CHECK_RESULT(res);
+
+    blockDeviceStat_t bst = {};
+    blockDeviceStat(m->bdev, &bst);
+
+    memset(st, 0, sizeof(*st));
+    st->block_size = sv.f_bsize;
+    st->block_count = sv.f_blocks;
+    st->free_count = sv.f_bfree;
+    st->sfile_reserved = m->sfile_reserved;
+    st->avail_count = (sv.f_bfree > m->sfile_reserved) ? sv.f_bfree - m->sfile_reserved : 0;
+    st->block_write_count = sffsBlockWriteCount(fs);
+    st->erase_block_count = bst.erase_block_count;
+    st->min_erase_count = bst.min_erase_count;
+    st->max_erase_count = bst.max_erase_count;
+    st->idle_count = m->idle_count;
+    st->idle_pending = m->dirty;
+    return 0;
+}
+
+int sffsVfsBlockNeeded(const char *base_path, size_t size)
+{
+    sffsFs_t *fs = (sffsFs_t *)vfs_mount_handle(base_path);
+    if (fs == NULL || _findMount(fs) == NULL)
+        return -1;
+
+    int res = sffsFileBlockNeeded(fs, size);
+    CHECK_RESULT_RETURN(res);
+}
+
 int sffsVfsMkfs(blockDevice_t *bdev)
 {
     int res = sffsMakeFs(bdev);
@@ -12,6 +12,7 @@
 
 #include "vfs.h"
 #include "vfs_ops.h"
+#include "osi_api.h"
 #include "osi_log.h"
 #include "osi_compiler.h"
 #include <errno.h>
@@ -26,6 +27,9 @@
 #define VFS_INDEX_POS (10)
 #define VFS_INDEX_MASK (0x7c00)
 #define VFS_COUNT_MAX (31)
+#define VFS_WRITE_BEHIND_DELAY (2000)
+#define VFS_WRITE_BEHIND_SIZE_MAX (32 * 1024)
+#define VFS_DENTRY_COUNT_MAX (32)
 
 #define SET_ERRNO(err) OSI_DO_WHILE0(errno = err;)
 #define ERR_RETURN(err, ret) OSI_DO_WHILE0(SET_ERRNO(err); return (ret);)
@@ -42,10 +46,148 @@ typedef struct vfs_entry_s
     int index; // index in g_vfs
 } vfs_entry_t;
 
+// Mount point trie node, one node for each path component of prefixes.
+// Node 0 is root ('/'). Names point to prefix in vfs_entry_t, and the
+// trie is rebuilt at register/unregister.
+typedef struct
+{
+    const char *name;
+    uint8_t name_len;
+    uint8_t child;   // first child node, 0 for none
+    uint8_t sibling; // next sibling node, 0 for none
+    uint8_t vfs;     // index in g_vfs plus 1, 0 for not mount point
+} vfs_trie_node_t;
+
+// Pending safe file write, data is followed by the canonical path.
+typedef struct vfs_wb_item_s
+{
+    struct vfs_wb_item_s *next;
+    const char *path;
+    size_t size;
+    uint8_t data[];
+} vfs_wb_item_t;
+
+// Write behind of safe files. Pending writes are written in order in
+// file write work queue, and at shutdown. Access to pending files and
+// directories will write them synchronously.
+typedef struct
+{
+    osiMutex_t *lock;
+    osiWork_t *work;
+    osiTimer_t *timer;
+    vfs_wb_item_t *head;
+    size_t total;
+} vfs_wb_t;
+
+// Cached path lookup result, path is canonical.
+typedef struct vfs_dentry_s
+{
+    struct vfs_dentry_s *next;
+    uint32_t hash;
+    int fs_index;  // index in vfs_entry_t
+    bool negative; // path doesn't exist
+    struct stat st;
+    char path[];
+} vfs_dentry_t;
+
+// Directory entry cache of stat and non-existed paths, in LRU order.
+// It is invalidated by changes through vfs. Changes of regular files
+// through fd will drop cached regular files of the mount.
+//
+// The generation is increased at each invalidation. Result of file
+// system is only inserted when the generation is unchanged, to avoid
+// insert stale result when there is concurrent change.
+typedef struct
+{
+    osiMutex_t *lock;
+    vfs_dentry_t *head;
+    unsigned count;
+    uint32_t file_mask; // mounts with cached regular files
+    volatile uint32_t gen;
+} vfs_dcache_t;
+
 static vfs_entry_t *g_vfs[VFS_COUNT_MAX] = {};
+static vfs_wb_t g_vfs_wb;
+static vfs_dcache_t g_vfs_dcache;
+
+static void vfs_wb_sync(const char *real_path);
+static void vfs_wb_drop(const char *real_path);
+static int vfs_dcache_lookup(const char *real_path, struct stat *st);
+static void vfs_dcache_insert(const vfs_entry_t *fs, const char *real_path, uint32_t gen, const struct stat *st);
+static void vfs_dcache_invalidate(const char *real_path);
+static void vfs_dcache_file_changed(const vfs_entry_t *fs);
+static vfs_trie_node_t *g_vfs_trie = NULL;
+static vfs_trie_node_t *g_vfs_trie_prev = NULL;
 static char g_vfs_curr_dir[VFS_PATH_MAX] = "/";
 static vfs_stdio_callback_t g_stdio_cb;
 
+// Rebuild mount point trie from g_vfs
+//
+// The previous trie is kept till next rebuild, for lookup in progress
+// with the old trie. When memory is not enough, trie is cleared and
+// lookup will fall back to scan all entries.
+static void vfs_mount_trie_rebuild(void)
+{
+    size_t count = 1;
+    for (int n = 0; n < VFS_COUNT_MAX; ++n)
+    {
+        const vfs_entry_t *fs = g_vfs[n];
+        if (fs == NULL || fs->prefix_len <= 1)
+            continue;
+        for (size_t i = 0; i < fs->prefix_len; i++)
+            count += (fs->prefix[i] == '/') ? 1 : 0;
+    }
+
+    vfs_trie_node_t *nodes = (vfs_trie_node_t *)calloc(count, sizeof(vfs_trie_node_t));
+    if (nodes != NULL)
+    {
+        size_t used = 1;
+        for (int n = 0; n < VFS_COUNT_MAX; ++n)
+        {
+            const vfs_entry_t *fs = g_vfs[n];
+            if (fs == NULL)
+                continue;
+
+            vfs_trie_node_t *node = &nodes[0];
+            const char *name = fs->prefix + 1;
+            while (*name != '\0')
+            {
+                const char *slash = strchr(name, '/');
+                size_t len = (slash == NULL) ? strlen(name) : slash - name;
+
+                vfs_trie_node_t *child = NULL;
+                for (uint8_t c = node->child; c != 0; c = nodes[c].sibling)
+                {
+                    if (nodes[c].name_len == len && memcmp(nodes[c].name, name, len) == 0)
+                    {
+                        child = &nodes[c];
+                        break;
+                    }
+                }
+
+                if (child == NULL)
+                {
+                    child = &nodes[used];
+                    child->name = name;
+                    child->name_len = len;
+                    child->sibling = node->child;
+                    node->child = used++;
+                }
+
+                node = child;
+                if (slash == NULL)
+                    break;
+                name = slash + 1;
+            }
+            node->vfs = n + 1;
+        }
+    }
+
+    free(g_vfs_trie_prev);
+    g_vfs_trie_prev = g_vfs_trie;
+    g_vfs_trie = nodes;
+}
+
 // Register (mounted) file system to base_path
 //
 // @param base_path     mount point, must be absolute path
@@ -99,6 +241,8 @@ int vfs_register(const char *base_path, const vfs_ops_t *ops, void *ctx)
     g_vfs[index]->prefix[len] = '\0';
     g_vfs[index]->prefix_len = len;
     g_vfs[index]->index = index + 1; // avoid stdin/out/err conflict
+    vfs_mount_trie_rebuild();
+    vfs_dcache_invalidate(NULL);
     return 0;
 }
 
@@ -128,8 +272,10 @@ int vfs_unregister(const char *base_path)
         if (fs != NULL && len == fs->prefix_len &&
             memcmp(real_path, fs->prefix, len) == 0)
         {
-            free(fs);
             g_vfs[n] = NULL;
+            vfs_mount_trie_rebuild();
+            vfs_dcache_invalidate(NULL);
+            free(fs);
             return 0;
         }
     }
@@ -209,6 +355,30 @@ static int vfs_resolve_add_path(char *real_path, size_t pos, const char *path)
     return 0; // never reach
 }
 
+// Length of absolute path when it is already canonical: no empty, "."
+// or ".." components, and no trailing '/' except root. Return 0 when
+// the path should be resolved.
+static size_t vfs_canonical_len(const char *path)
+{
+    const char *p = path; // always points to '/'
+    for (;;)
+    {
+        const char *name = p + 1;
+        if (name[0] == '\0')
+            return (p == path) ? 1 : 0;
+        if (name[0] == '/')
+            return 0;
+        if (name[0] == '.' && (name[1] == '/' || name[1] == '\0'))
+            return 0;
+        if (name[0] == '.' && name[1] == '.' && (name[2] == '/' || name[2] == '\0'))
+            return 0;
+
+        p = strchr(name, '/');
+        if (p == NULL)
+            return name + strlen(name) - path;
+    }
+}
+
 // return the canonicalized absolute pathname
 char *vfs_realpath(const char *path, char *resolved_path)
 {
@@ -220,6 +390,16 @@ char *vfs_realpath(const char *path, char *resolved_path)
 
     if (path[0] == '/')
     {
+        // fast path, most paths from applications are already canonical
+        size_t len = vfs_canonical_len(path);
+        if (len > 0)
+        {
+            if (len >= VFS_PATH_MAX)
+                ERR_RETURN(ENAMETOOLONG, NULL);
+            memcpy(resolved_path, path, len + 1);
+            return resolved_path;
+        }
+
         resolved_path[0] = '/';
         resolved_path[1] = '\0';
         if (vfs_resolve_add_path(resolved_path, 1, path + 1) < 0)
@@ -303,8 +483,8 @@ static int vfs_get_local_fd(int fd)
     return (fd & VFS_FD_MASK) >> VFS_FD_POS;
 }
 
-// return fs and path inside fs by canonical path
-static const vfs_entry_t *vfs_get_fs_by_path(const char *path, const char **local_path)
+// return fs and path inside fs by canonical path, by scan all entries
+static const vfs_entry_t *vfs_get_fs_by_path_scan(const char *path, const char **local_path)
 {
     const vfs_entry_t *best_match = NULL;
     size_t best_match_len = 0;
@@ -342,12 +522,65 @@ static const vfs_entry_t *vfs_get_fs_by_path(const char *path, const char **loca
     return best_match;
 }
 
+// return fs and path inside fs by canonical path
+static const vfs_entry_t *vfs_get_fs_by_path(const char *path, const char **local_path)
+{
+    const vfs_trie_node_t *nodes = g_vfs_trie;
+    if (nodes == NULL)
+        return vfs_get_fs_by_path_scan(path, local_path);
+
+    // walk path components, the deepest mount point is the longest match
+    uint8_t best_match = nodes[0].vfs;
+    size_t best_match_len = 1;
+    const uint8_t *node = &nodes[0].child;
+    const char *name = path + 1;
+    while (*name != '\0')
+    {
+        const char *slash = strchr(name, '/');
+        size_t len = (slash == NULL) ? strlen(name) : slash - name;
+
+        uint8_t c = *node;
+        while (c != 0 && !(nodes[c].name_len == len && memcmp(nodes[c].name, name, len) == 0))
+            c = nodes[c].sibling;
+        if (c == 0)
+            break;
+
+        if (nodes[c].vfs != 0)
+        {
+            best_match = nodes[c].vfs;
+            best_match_len = name + len - path;
+        }
+
+        if (slash == NULL)
+            break;
+        node = &nodes[c].child;
+        name = slash + 1;
+    }
+
+    const vfs_entry_t *vfs = (best_match == 0) ? NULL : g_vfs[best_match - 1];
+    if (vfs == NULL)
+        return NULL;
+
+    if (vfs->ops.flags & VFS_NEED_REAL_PATH)
+    {
+        *local_path = path;
+    }
+    else
+    {
+        *local_path = path + best_match_len;
+        if (**local_path == '/')
+            *local_path += 1;
+    }
+    return vfs;
+}
+
 // unmount filesystem
 int vfs_umount(const char *path)
 {
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
@@ -409,11 +642,23 @@ int vfs_open(const char *path, int flags, ...)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
     CHECK_VFS(fs, ENOENT, -1);
-    return vfs_open_local_path(fs, local_path, flags, mode);
+
+    bool create = (flags & O_CREAT) != 0;
+    if (!create && vfs_dcache_lookup(real_path, NULL) == 0)
+        ERR_RETURN(ENOENT, -1);
+
+    uint32_t gen = g_vfs_dcache.gen;
+    int fd = vfs_open_local_path(fs, local_path, flags, mode);
+    if (fd < 0 && !create && errno == ENOENT)
+        vfs_dcache_insert(fs, real_path, gen, NULL);
+    else if (fd >= 0 && (create || (flags & O_TRUNC) != 0))
+        vfs_dcache_invalidate(real_path);
+    return fd;
 }
 
 // open and possibly create a file
@@ -430,7 +675,9 @@ int vfs_close(int fd)
     CHECK_API(fs, close, ENOSYS, -1);
 
     int local_fd = vfs_get_local_fd(fd);
-    return fs->ops.close(fs->fs, local_fd);
+    int res = fs->ops.close(fs->fs, local_fd);
+    vfs_dcache_file_changed(fs); // size may be updated at close
+    return res;
 }
 
 // read from a file descriptor
@@ -460,7 +707,9 @@ ssize_t vfs_write(int fd, const void *data, size_t size)
     CHECK_API(fs, write, ENOSYS, -1);
 
     int local_fd = vfs_get_local_fd(fd);
-    return fs->ops.write(fs->fs, local_fd, data, size);
+    ssize_t res = fs->ops.write(fs->fs, local_fd, data, size);
+    vfs_dcache_file_changed(fs);
+    return res;
 }
 
 // reposition read/write file offset
@@ -491,12 +740,26 @@ int vfs_stat(const char *path, struct stat *st)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
     CHECK_VFS(fs, ENOENT, -1);
     CHECK_API(fs, stat, ENOSYS, -1);
-    return fs->ops.stat(fs->fs, local_path, st);
+
+    int cached = vfs_dcache_lookup(real_path, st);
+    if (cached == 0)
+        ERR_RETURN(ENOENT, -1);
+    if (cached > 0)
+        return 0;
+
+    uint32_t gen = g_vfs_dcache.gen;
+    int res = fs->ops.stat(fs->fs, local_path, st);
+    if (res == 0)
+        vfs_dcache_insert(fs, real_path, gen, st);
+    else if (errno == ENOENT)
+        vfs_dcache_insert(fs, real_path, gen, NULL);
+    return res;
 }
 
 //truncate a file to a specified length
@@ -505,12 +768,15 @@ int vfs_truncate(const char *path, long length)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
     CHECK_VFS(fs, ENOENT, -1);
     CHECK_API(fs, truncate, ENOSYS, -1);
-    return fs->ops.truncate(fs->fs, local_path, length);
+    int res = fs->ops.truncate(fs->fs, local_path, length);
+    vfs_dcache_invalidate(real_path);
+    return res;
 }
 
 //truncate a file to a specified length
@@ -521,7 +787,9 @@ int vfs_ftruncate(int fd, long length)
     CHECK_API(fs, ftruncate, ENOSYS, -1);
 
     int local_fd = vfs_get_local_fd(fd);
-    return fs->ops.ftruncate(fs->fs, local_fd, length);
+    int res = fs->ops.ftruncate(fs->fs, local_fd, length);
+    vfs_dcache_file_changed(fs);
+    return res;
 }
 
 // make a new name for a file
@@ -536,12 +804,15 @@ int vfs_unlink(const char *path)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
     CHECK_VFS(fs, ENOENT, -1);
     CHECK_API(fs, unlink, ENOSYS, -1);
-    return fs->ops.unlink(fs->fs, local_path);
+    int res = fs->ops.unlink(fs->fs, local_path);
+    vfs_dcache_invalidate(real_path);
+    return res;
 }
 
 // change the name of a file
@@ -554,6 +825,8 @@ int vfs_rename(const char *src, const char *dst)
     char real_dst[VFS_PATH_MAX];
     if (vfs_realpath(dst, real_dst) == NULL)
         return -1;
+    vfs_wb_sync(real_src);
+    vfs_wb_drop(real_dst);
 
     const char *local_src = NULL;
     const vfs_entry_t *fs_src = vfs_get_fs_by_path(real_src, &local_src);
@@ -566,7 +839,10 @@ int vfs_rename(const char *src, const char *dst)
         ERR_RETURN(EXDEV, -1);
 
     CHECK_API(fs_src, rename, ENOSYS, -1);
-    return fs_src->ops.rename(fs_src->fs, local_src, local_dst);
+    int res = fs_src->ops.rename(fs_src->fs, local_src, local_dst);
+    vfs_dcache_invalidate(real_src);
+    vfs_dcache_invalidate(real_dst);
+    return res;
 }
 
 // open a directory
@@ -575,11 +851,15 @@ DIR *vfs_opendir(const char *name)
     char real_name[VFS_PATH_MAX];
     if (vfs_realpath(name, real_name) == NULL)
         return NULL;
+    vfs_wb_sync(real_name);
 
     const char *local_name = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_name, &local_name);
     CHECK_VFS(fs, ENOENT, NULL);
     CHECK_API(fs, opendir, ENOSYS, NULL);
+    if (vfs_dcache_lookup(real_name, NULL) == 0)
+        ERR_RETURN(ENOENT, NULL);
+
     DIR *dir = fs->ops.opendir(fs->fs, local_name);
     if (dir != NULL)
         dir->fs_index = fs->index << VFS_INDEX_POS;
@@ -665,7 +945,9 @@ int vfs_mkdir(const char *name, mode_t mode)
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_name, &local_name);
     CHECK_VFS(fs, ENOENT, -1);
     CHECK_API(fs, mkdir, ENOSYS, -1);
-    return fs->ops.mkdir(fs->fs, local_name, mode);
+    int res = fs->ops.mkdir(fs->fs, local_name, mode);
+    vfs_dcache_invalidate(real_name);
+    return res;
 }
 
 // delete a directory
@@ -674,12 +956,15 @@ int vfs_rmdir(const char *name)
     char real_name[VFS_PATH_MAX];
     if (vfs_realpath(name, real_name) == NULL)
         return -1;
+    vfs_wb_sync(real_name);
 
     const char *local_name = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_name, &local_name);
     CHECK_VFS(fs, ENOENT, -1);
     CHECK_API(fs, rmdir, ENOSYS, -1);
-    return fs->ops.rmdir(fs->fs, local_name);
+    int res = fs->ops.rmdir(fs->fs, local_name);
+    vfs_dcache_invalidate(real_name);
+    return res;
 }
 
 // synchronize a file's in-core state with storage device
@@ -690,7 +975,9 @@ int vfs_fsync(int fd)
     CHECK_API(fs, fsync, ENOSYS, -1);
 
     int local_fd = vfs_get_local_fd(fd);
-    return fs->ops.fsync(fs->fs, local_fd);
+    int res = fs->ops.fsync(fs->fs, local_fd);
+    vfs_dcache_file_changed(fs);
+    return res;
 }
 
 int vfs_fcntl(int fd, int cmd, ...)
@@ -731,6 +1018,7 @@ int vfs_sfile_init(const char *path)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
@@ -747,7 +1035,9 @@ int vfs_sfile_init(const char *path)
         return (res < 0) ? -1 : 0;
     }
 
-    return fs->ops.sfile_init(fs->fs, local_path);
+    int res = fs->ops.sfile_init(fs->fs, local_path);
+    vfs_dcache_invalidate(real_path);
+    return res;
 }
 
 ssize_t vfs_sfile_read(const char *path, void *dst, size_t size)
@@ -755,6 +1045,7 @@ ssize_t vfs_sfile_read(const char *path, void *dst, size_t size)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
@@ -772,12 +1063,8 @@ ssize_t vfs_sfile_read(const char *path, void *dst, size_t size)
     return fs->ops.sfile_read(fs->fs, local_path, dst, size);
 }
 
-ssize_t vfs_sfile_write(const char *path, const void *data, size_t size)
+static ssize_t vfs_sfile_write_real_path(const char *real_path, const void *data, size_t size)
 {
-    char real_path[VFS_PATH_MAX];
-    if (vfs_realpath(path, real_path) == NULL)
-        return -1;
-
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
     CHECK_VFS(fs, ENOENT, -1);
@@ -789,10 +1076,401 @@ ssize_t vfs_sfile_write(const char *path, const void *data, size_t size)
 
         ssize_t write_len = vfs_write(fd, data, size);
         vfs_close(fd);
+        vfs_dcache_invalidate(real_path);
         return write_len;
     }
 
-    return fs->ops.sfile_write(fs->fs, local_path, data, size);
+    ssize_t res = fs->ops.sfile_write(fs->fs, local_path, data, size);
+    vfs_dcache_invalidate(real_path);
+    return res;
+}
+
+ssize_t vfs_sfile_write(const char *path, const void *data, size_t size)
+{
+    char real_path[VFS_PATH_MAX];
+    if (vfs_realpath(path, real_path) == NULL)
+        return -1;
+
+    // pending write is superseded
+    vfs_wb_drop(real_path);
+    return vfs_sfile_write_real_path(real_path, data, size);
+}
+
+// whether pending write path is path itself, or under directory path
+static bool vfs_wb_match(const vfs_wb_item_t *item, const char *path, size_t len)
+{
+    if (path == NULL)
+        return true;
+    if (len == 1) // root
+        return true;
+    return memcmp(item->path, path, len) == 0 &&
+           (item->path[len] == '\0' || item->path[len] == '/');
+}
+
+// write or drop pending writes. Caller should hold the lock.
+static void vfs_wb_flush_locked(const char *path, bool drop)
+{
+    vfs_wb_t *wb = &g_vfs_wb;
+    size_t len = (path == NULL) ? 0 : strlen(path);
+
+    vfs_wb_item_t **pitem = &wb->head;
+    while (*pitem != NULL)
+    {
+        vfs_wb_item_t *item = *pitem;
+        if (!vfs_wb_match(item, path, len))
+        {
+            pitem = &item->next;
+            continue;
+        }
+
+        *pitem = item->next;
+        wb->total -= item->size;
+        if (!drop && vfs_sfile_write_real_path(item->path, item->data, item->size) != item->size)
+            OSI_LOGE(0, "vfs write behind failed, size/%d", item->size);
+        free(item);
+    }
+}
+
+static void vfs_wb_sync(const char *real_path)
+{
+    vfs_wb_t *wb = &g_vfs_wb;
+    if (wb->head == NULL)
+        return;
+
+    osiMutexLock(wb->lock);
+    vfs_wb_flush_locked(real_path, false);
+    osiMutexUnlock(wb->lock);
+}
+
+static void vfs_wb_drop(const char *real_path)
+{
+    vfs_wb_t *wb = &g_vfs_wb;
+    if (wb->head == NULL)
+        return;
+
+    osiMutexLock(wb->lock);
+    vfs_wb_flush_locked(real_path, true);
+    osiMutexUnlock(wb->lock);
+}
+
+static void vfs_wb_work(void *param)
+{
+    vfs_wb_sync(NULL);
+}
+
+static void vfs_wb_shutdown(void *ctx, osiShutdownMode_t mode)
+{
+    vfs_wb_sync(NULL);
+}
+
+static bool vfs_wb_init(void)
+{
+    vfs_wb_t *wb = &g_vfs_wb;
+    if (wb->timer != NULL)
+        return true;
+
+    osiMutex_t *lock = osiMutexCreate();
+    osiWork_t *work = osiWorkCreate(vfs_wb_work, NULL, NULL);
+    osiTimer_t *timer = osiTimerCreateWork(work, osiSysWorkQueueFileWrite());
+    if (lock == NULL || work == NULL || timer == NULL)
+        goto failed;
+
+    uint32_t critical = osiEnterCritical();
+    bool inited = (wb->timer != NULL);
+    if (!inited)
+    {
+        wb->lock = lock;
+        wb->work = work;
+        wb->timer = timer;
+    }
+    osiExitCritical(critical);
+
+    if (inited)
+        goto failed;
+
+    osiRegisterShutdownCallback(vfs_wb_shutdown, NULL);
+    return true;
+
+failed:
+    osiTimerDelete(timer);
+    osiWorkDelete(work);
+    osiMutexDelete(lock);
+    return wb->timer != NULL;
+}
+
+ssize_t vfs_sfile_write_behind(const char *path, const void *data, size_t size)
+{
+    vfs_wb_t *wb = &g_vfs_wb;
+    if (data == NULL)
+        ERR_RETURN(EINVAL, -1);
+
+    if (size > VFS_WRITE_BEHIND_SIZE_MAX || !vfs_wb_init())
+        return vfs_sfile_write(path, data, size);
+
+    char real_path[VFS_PATH_MAX];
+    if (vfs_realpath(path, real_path) == NULL)
+        return -1;
+
+    const char *local_path = NULL;
+    const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
+    CHECK_VFS(fs, ENOENT, -1);
+
+    osiMutexLock(wb->lock);
+
+    vfs_wb_item_t **pitem = &wb->head;
+    while (*pitem != NULL && strcmp((*pitem)->path, real_path) != 0)
+        pitem = &(*pitem)->next;
+
+    vfs_wb_item_t *item = *pitem;
+    if (item == NULL || item->size != size)
+    {
+        // replace the existed pending write at the same position
+        size_t path_len = strlen(real_path);
+        vfs_wb_item_t *nitem = (vfs_wb_item_t *)malloc(sizeof(vfs_wb_item_t) + size + path_len + 1);
+        if (nitem == NULL)
+        {
+            osiMutexUnlock(wb->lock);
+            return vfs_sfile_write(path, data, size);
+        }
+
+        char *npath = (char *)nitem->data + size;
+        memcpy(npath, real_path, path_len + 1);
+        nitem->path = npath;
+        nitem->size = size;
+        nitem->next = (item == NULL) ? NULL : item->next;
+        *pitem = nitem;
+        wb->total += size;
+
+        if (item != NULL)
+        {
+            wb->total -= item->size;
+            free(item);
+        }
+        item = nitem;
+    }
+    memcpy(item->data, data, size);
+
+    if (wb->total > VFS_WRITE_BEHIND_SIZE_MAX)
+        vfs_wb_flush_locked(NULL, false);
+    else if (!osiTimerIsRunning(wb->timer))
+        osiTimerStart(wb->timer, VFS_WRITE_BEHIND_DELAY);
+
+    osiMutexUnlock(wb->lock);
+    return size;
+}
+
+int vfs_sfile_flush(const char *path)
+{
+    if (path == NULL)
+    {
+        vfs_wb_sync(NULL);
+        return 0;
+    }
+
+    char real_path[VFS_PATH_MAX];
+    if (vfs_realpath(path, real_path) == NULL)
+        return -1;
+
+    vfs_wb_sync(real_path);
+    return 0;
+}
+
+static uint32_t vfs_dcache_hash(const char *path)
+{
+    uint32_t hash = 2166136261u; // FNV-1a
+    while (*path != '\0')
+        hash = (hash ^ (uint8_t)*path++) * 16777619u;
+    return hash;
+}
+
+static bool vfs_dcache_init(void)
+{
+    vfs_dcache_t *dc = &g_vfs_dcache;
+    if (dc->lock != NULL)
+        return true;
+
+    osiMutex_t *lock = osiMutexCreate();
+    if (lock == NULL)
+        return false;
+
+    uint32_t critical = osiEnterCritical();
+    bool inited = (dc->lock != NULL);
+    if (!inited)
+        dc->lock = lock;
+    osiExitCritical(critical);
+
+    if (inited)
+        osiMutexDelete(lock);
+    return true;
+}
+
+// Return 1 for cached existed path, 0 for cached non-existed path,
+// and -1 for not cached. \p st can be NULL.
+static int vfs_dcache_lookup(const char *real_path, struct stat *st)
+{
+    vfs_dcache_t *dc = &g_vfs_dcache;
+    if (dc->head == NULL)
+        return -1;
+
+    uint32_t hash = vfs_dcache_hash(real_path);
+    int res = -1;
+
+    osiMutexLock(dc->lock);
+    vfs_dentry_t **pd = &dc->head;
+    for (; *pd != NULL; pd = &(*pd)->next)
+    {
+        vfs_dentry_t *d = *pd;
+        if (d->hash != hash || strcmp(d->path, real_path) != 0)
+            continue;
+
+        // move to head
+        *pd = d->next;
+        d->next = dc->head;
+        dc->head = d;
+
+        if (!d->negative && st != NULL)
+            *st = d->st;
+        res = d->negative ? 0 : 1;
+        break;
+    }
+    osiMutexUnlock(dc->lock);
+    return res;
+}
+
+// Insert lookup result, \p st is NULL for non-existed path. It will be
+// ignored when there are changes after \p gen is read.
+static void vfs_dcache_insert(const vfs_entry_t *fs, const char *real_path, uint32_t gen, const struct stat *st)
+{
+    vfs_dcache_t *dc = &g_vfs_dcache;
+    if (!vfs_dcache_init())
+        return;
+
+    size_t len = strlen(real_path);
+    vfs_dentry_t *d = (vfs_dentry_t *)malloc(sizeof(vfs_dentry_t) + len + 1);
+    if (d == NULL)
+        return;
+
+    d->hash = vfs_dcache_hash(real_path);
+    d->fs_index = fs->index;
+    d->negative = (st == NULL);
+    if (st != NULL)
+        d->st = *st;
+    memcpy(d->path, real_path, len + 1);
+
+    osiMutexLock(dc->lock);
+    if (dc->gen != gen)
+    {
+        osiMutexUnlock(dc->lock);
+        free(d);
+        return;
+    }
+
+    // remove the existed one, and the least recently used one when full
+    vfs_dentry_t **pd = &dc->head;
+    while (*pd != NULL)
+    {
+        vfs_dentry_t *p = *pd;
+        bool last = (p->next == NULL);
+        if ((p->hash == d->hash && strcmp(p->path, d->path) == 0) ||
+            (last && dc->count >= VFS_DENTRY_COUNT_MAX))
+        {
+            *pd = p->next;
+            dc->count--;
+            free(p);
+            continue;
+        }
+        pd = &p->next;
+    }
+
+    d->next = dc->head;
+    dc->head = d;
+    dc->count++;
+    if (!d->negative && S_ISREG(d->st.st_mode))
+        dc->file_mask |= (1u << d->fs_index);
+    osiMutexUnlock(dc->lock);
+}
+
+// Drop cached path, paths under it and its parent directory. NULL for all.
+static void vfs_dcache_invalidate(const char *real_path)
+{
+    vfs_dcache_t *dc = &g_vfs_dcache;
+    if (dc->lock == NULL)
+        return;
+
+    size_t len = (real_path == NULL) ? 0 : strlen(real_path);
+    size_t parent_len = 0;
+    for (size_t n = 1; n < len; n++)
+    {
+        if (real_path[n] == '/')
+            parent_len = n;
+    }
+    if (parent_len == 0)
+        parent_len = 1; // root
+
+    osiMutexLock(dc->lock);
+    dc->gen++;
+
+    vfs_dentry_t **pd = &dc->head;
+    while (*pd != NULL)
+    {
+        vfs_dentry_t *d = *pd;
+        bool drop = (real_path == NULL) || (len == 1) ||
+                    (memcmp(d->path, real_path, len) == 0 &&
+                     (d->path[len] == '\0' || d->path[len] == '/')) ||
+                    (memcmp(d->path, real_path, parent_len) == 0 && d->path[parent_len] == '\0');
+        if (drop)
+        {
+            *pd = d->next;
+            dc->count--;
+            free(d);
+            continue;
+        }
+        pd = &d->next;
+    }
+    if (real_path == NULL)
+        dc->file_mask = 0;
+    osiMutexUnlock(dc->lock);
+}
+
+// Drop cached regular files of the mount, for file changes through fd.
+static void vfs_dcache_file_changed(const vfs_entry_t *fs)
+{
+    vfs_dcache_t *dc = &g_vfs_dcache;
+    dc->gen++;
+    if ((dc->file_mask & (1u << fs->index)) == 0)
+        return;
+
+    osiMutexLock(dc->lock);
+    dc->gen++;
+
+    vfs_dentry_t **pd = &dc->head;
+    while (*pd != NULL)
+    {
+        vfs_dentry_t *d = *pd;
+        if (d->fs_index == fs->index && !d->negative && S_ISREG(d->st.st_mode))
+        {
+            *pd = d->next;
+            dc->count--;
+            free(d);
+            continue;
+        }
+        pd = &d->next;
+    }
+    dc->file_mask &= ~(1u << fs->index);
+    osiMutexUnlock(dc->lock);
+}
+
+void vfs_dentry_invalidate(const char *path)
+{
+    if (path == NULL)
+    {
+        vfs_dcache_invalidate(NULL);
+        return;
+    }
+
+    char real_path[VFS_PATH_MAX];
+    if (vfs_realpath(path, real_path) != NULL)
+        vfs_dcache_invalidate(real_path);
 }
 
 ssize_t vfs_sfile_size(const char *path)
@@ -800,6 +1478,7 @@ ssize_t vfs_sfile_size(const char *path)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_sync(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
@@ -819,6 +1498,19 @@ ssize_t vfs_sfile_size(const char *path)
     return fs->ops.sfile_size(fs->fs, local_path);
 }
 
+const void *vfs_mmap(const char *path, size_t *size)
+{
+    char real_path[VFS_PATH_MAX];
+    if (vfs_realpath(path, real_path) == NULL)
+        return NULL;
+
+    const char *local_path = NULL;
+    const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
+    CHECK_VFS(fs, ENOENT, NULL);
+    CHECK_API(fs, mmap, ENOSYS, NULL);
+    return fs->ops.mmap(fs->fs, local_path, size);
+}
+
 ssize_t vfs_file_read(const char *path, void *dst, size_t size)
 {
     int fd = vfs_open(path, O_RDONLY);
@@ -835,6 +1527,7 @@ ssize_t vfs_file_write(const char *path, const void *data, size_t size)
     char real_path[VFS_PATH_MAX];
     if (vfs_realpath(path, real_path) == NULL)
         return -1;
+    vfs_wb_drop(real_path);
 
     const char *local_path = NULL;
     const vfs_entry_t *fs = vfs_get_fs_by_path(real_path, &local_path);
@@ -847,10 +1540,13 @@ ssize_t vfs_file_write(const char *path, const void *data, size_t size)
 
         ssize_t write_len = vfs_write(fd, data, size);
         vfs_close(fd);
+        vfs_dcache_invalidate(real_path);
         return write_len;
     }
 
-    return fs->ops.file_write(fs->fs, local_path, data, size);
+    ssize_t res = fs->ops.file_write(fs->fs, local_path, data, size);
+    vfs_dcache_invalidate(real_path);
+    return res;
 }
 
 ssize_t vfs_file_size(const char *path)
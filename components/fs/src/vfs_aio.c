@@ -0,0 +1,382 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "vfs_aio.h"
+#include "vfs.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define VFS_AIO_MERGE_SIZE (4 * 1024)
+
+#define ERR_RETURN(err, ret) OSI_DO_WHILE0(errno = (err); return (ret);)
+
+typedef enum
+{
+    VFS_AIO_READ,
+    VFS_AIO_WRITE,
+    VFS_AIO_WRITE_COPY, // data is copied to the request, can be merged
+} vfs_aio_op_t;
+
+typedef struct vfs_aio_req_s
+{
+    struct vfs_aio_req_s *next;
+    int fd;
+    vfs_aio_op_t op;
+    void *buf;
+    size_t size;
+    size_t capacity; // only for VFS_AIO_WRITE_COPY
+    vfs_aio_callback_t cb;
+    void *ctx;
+    uint8_t data[];
+} vfs_aio_req_t;
+
+// All requests are executed by one work in order, though file write
+// work queue may have more than one thread.
+typedef struct
+{
+    osiMutex_t *lock;
+    osiWork_t *work;
+    vfs_aio_req_t *head;
+    vfs_aio_req_t *tail;
+    int running_fd; // fd of the request in execution, -1 for none
+    int err_fd;     // fd of last failed write without callback, -1 for none
+    int err;
+} vfs_aio_t;
+
+struct vfs_aio_stream
+{
+    int fd;
+    size_t buf_size;
+    size_t used;
+    unsigned curr;
+    size_t pending_size;
+    bool pending; // the other buffer is being written
+    bool failed;
+    osiSemaphore_t *done_sema;
+    uint8_t *bufs[2];
+    uint8_t data[];
+};
+
+static vfs_aio_t g_vfs_aio = {.running_fd = -1, .err_fd = -1};
+
+static void vfs_aio_work(void *param)
+{
+    vfs_aio_t *aio = &g_vfs_aio;
+
+    for (;;)
+    {
+        osiMutexLock(aio->lock);
+        vfs_aio_req_t *req = aio->head;
+        if (req != NULL)
+        {
+            aio->head = req->next;
+            if (aio->head == NULL)
+                aio->tail = NULL;
+            aio->running_fd = req->fd;
+        }
+        osiMutexUnlock(aio->lock);
+
+        if (req == NULL)
+            break;
+
+        ssize_t result = (req->op == VFS_AIO_READ)
+                             ? vfs_read(req->fd, req->buf, req->size)
+                             : vfs_write(req->fd, req->buf, req->size);
+
+        if (req->cb != NULL)
+        {
+            req->cb(req->ctx, result);
+        }
+        else if (req->op == VFS_AIO_WRITE_COPY && result != req->size)
+        {
+            OSI_LOGE(0, "vfs aio write failed, fd/%d size/%d result/%d", req->fd, req->size, result);
+            osiMutexLock(aio->lock);
+            aio->err_fd = req->fd;
+            aio->err = (result < 0) ? errno : ENOSPC;
+            osiMutexUnlock(aio->lock);
+        }
+
+        osiMutexLock(aio->lock);
+        aio->running_fd = -1;
+        osiMutexUnlock(aio->lock);
+        free(req);
+    }
+}
+
+static bool vfs_aio_init(void)
+{
+    vfs_aio_t *aio = &g_vfs_aio;
+    if (aio->work != NULL)
+        return true;
+
+    osiMutex_t *lock = osiMutexCreate();
+    osiWork_t *work = osiWorkCreate(vfs_aio_work, NULL, NULL);
+    if (lock == NULL || work == NULL)
+        goto failed;
+
+    uint32_t critical = osiEnterCritical();
+    bool inited = (aio->work != NULL);
+    if (!inited)
+    {
+        aio->lock = lock;
+        aio->work = work;
+    }
+    osiExitCritical(critical);
+
+    if (inited)
+        goto failed;
+    return true;
+
+failed:
+    osiWorkDelete(work);
+    osiMutexDelete(lock);
+    return aio->work != NULL;
+}
+
+// Append request, caller should hold the lock
+static void vfs_aio_append_locked(vfs_aio_req_t *req)
+{
+    vfs_aio_t *aio = &g_vfs_aio;
+
+    req->next = NULL;
+    if (aio->tail == NULL)
+        aio->head = req;
+    else
+        aio->tail->next = req;
+    aio->tail = req;
+}
+
+static int vfs_aio_submit(int fd, vfs_aio_op_t op, void *buf, size_t size,
+                          vfs_aio_callback_t cb, void *ctx)
+{
+    vfs_aio_t *aio = &g_vfs_aio;
+    if (fd < 0 || (buf == NULL && size != 0))
+        ERR_RETURN(EINVAL, -1);
+
+    if (!vfs_aio_init())
+        ERR_RETURN(ENOMEM, -1);
+
+    vfs_aio_req_t *req = NULL;
+    if (op == VFS_AIO_WRITE_COPY)
+    {
+        osiMutexLock(aio->lock);
+
+        // append to the last pending copied write of the same file
+        vfs_aio_req_t *tail = aio->tail;
+        if (tail != NULL && tail->fd == fd && tail->op == VFS_AIO_WRITE_COPY &&
+            tail->capacity - tail->size >= size)
+        {
+            memcpy(tail->data + tail->size, buf, size);
+            tail->size += size;
+            osiMutexUnlock(aio->lock);
+            return 0;
+        }
+        osiMutexUnlock(aio->lock);
+
+        size_t capacity = OSI_MAX(size_t, size, VFS_AIO_MERGE_SIZE);
+        req = (vfs_aio_req_t *)malloc(sizeof(vfs_aio_req_t) + capacity);
+        if (req == NULL)
+            ERR_RETURN(ENOMEM, -1);
+
+        memcpy(req->data, buf, size);
+        req->buf = req->data;
+        req->capacity = capacity;
+    }
+    else
+    {
+        req = (vfs_aio_req_t *)malloc(sizeof(vfs_aio_req_t));
+        if (req == NULL)
+            ERR_RETURN(ENOMEM, -1);
+
+        req->buf = buf;
+        req->capacity = 0;
+    }
+
+    req->fd = fd;
+    req->op = op;
+    req->size = size;
+    req->cb = cb;
+    req->ctx = ctx;
+
+    osiMutexLock(aio->lock);
+    vfs_aio_append_locked(req);
+    osiWorkEnqueue(aio->work, osiSysWorkQueueFileWrite());
+    osiMutexUnlock(aio->lock);
+    return 0;
+}
+
+int vfs_aio_read(int fd, void *buf, size_t size, vfs_aio_callback_t cb, void *ctx)
+{
+    return vfs_aio_submit(fd, VFS_AIO_READ, buf, size, cb, ctx);
+}
+
+int vfs_aio_write(int fd, const void *buf, size_t size, vfs_aio_callback_t cb, void *ctx)
+{
+    return vfs_aio_submit(fd, (cb == NULL) ? VFS_AIO_WRITE_COPY : VFS_AIO_WRITE,
+                          (void *)buf, size, cb, ctx);
+}
+
+// whether there are requests of the file not finished, caller should hold the lock
+static bool vfs_aio_pending_locked(int fd)
+{
+    vfs_aio_t *aio = &g_vfs_aio;
+    if (fd < 0)
+        return aio->head != NULL || aio->running_fd >= 0;
+
+    if (aio->running_fd == fd)
+        return true;
+
+    for (vfs_aio_req_t *req = aio->head; req != NULL; req = req->next)
+    {
+        if (req->fd == fd)
+            return true;
+    }
+    return false;
+}
+
+int vfs_aio_wait(int fd)
+{
+    vfs_aio_t *aio = &g_vfs_aio;
+    if (aio->work == NULL)
+        return 0;
+
+    for (;;)
+    {
+        osiMutexLock(aio->lock);
+        bool pending = vfs_aio_pending_locked(fd);
+        if (!pending && aio->err_fd >= 0 && (fd < 0 || aio->err_fd == fd))
+        {
+            int err = aio->err;
+            aio->err_fd = -1;
+            osiMutexUnlock(aio->lock);
+            ERR_RETURN(err, -1);
+        }
+        osiMutexUnlock(aio->lock);
+
+        if (!pending)
+            return 0;
+
+        // the work will run till all requests are finished
+        osiWorkWaitFinish(aio->work, OSI_WAIT_FOREVER);
+    }
+}
+
+static void vfs_aio_stream_done(void *ctx, ssize_t result)
+{
+    vfs_aio_stream_t *s = (vfs_aio_stream_t *)ctx;
+    if (result != s->pending_size)
+        s->failed = true;
+    osiSemaphoreRelease(s->done_sema);
+}
+
+// wait the other buffer written
+static void vfs_aio_stream_wait(vfs_aio_stream_t *s)
+{
+    if (s->pending)
+    {
+        osiSemaphoreAcquire(s->done_sema);
+        s->pending = false;
+    }
+}
+
+// submit current buffer, and switch to the other buffer
+static int vfs_aio_stream_submit(vfs_aio_stream_t *s)
+{
+    vfs_aio_stream_wait(s);
+    if (s->failed)
+        ERR_RETURN(EIO, -1);
+
+    s->pending_size = s->used;
+    if (vfs_aio_write(s->fd, s->bufs[s->curr], s->used, vfs_aio_stream_done, s) < 0)
+        return -1;
+
+    s->pending = true;
+    s->curr ^= 1;
+    s->used = 0;
+    return 0;
+}
+
+vfs_aio_stream_t *vfs_aio_stream_create(int fd, size_t buf_size)
+{
+    if (fd < 0 || buf_size == 0)
+        ERR_RETURN(EINVAL, NULL);
+
+    vfs_aio_stream_t *s = (vfs_aio_stream_t *)calloc(1, sizeof(vfs_aio_stream_t) + buf_size * 2);
+    if (s == NULL)
+        ERR_RETURN(ENOMEM, NULL);
+
+    s->done_sema = osiSemaphoreCreate(1, 0);
+    if (s->done_sema == NULL)
+    {
+        free(s);
+        ERR_RETURN(ENOMEM, NULL);
+    }
+
+    s->fd = fd;
+    s->buf_size = buf_size;
+    s->bufs[0] = s->data;
+    s->bufs[1] = s->data + buf_size;
+    return s;
+}
+
+ssize_t vfs_aio_stream_write(vfs_aio_stream_t *s, const void *data, size_t size)
+{
+    if (s == NULL || (data == NULL && size != 0))
+        ERR_RETURN(EINVAL, -1);
+
+    if (s->failed)
+        ERR_RETURN(EIO, -1);
+
+    const uint8_t *pdata = (const uint8_t *)data;
+    size_t left = size;
+    while (left > 0)
+    {
+        size_t len = OSI_MIN(size_t, left, s->buf_size - s->used);
+        memcpy(s->bufs[s->curr] + s->used, pdata, len);
+        s->used += len;
+        pdata += len;
+        left -= len;
+
+        if (s->used == s->buf_size && vfs_aio_stream_submit(s) < 0)
+            return -1;
+    }
+    return size;
+}
+
+int vfs_aio_stream_flush(vfs_aio_stream_t *s)
+{
+    if (s == NULL)
+        ERR_RETURN(EINVAL, -1);
+
+    if (s->used > 0 && vfs_aio_stream_submit(s) < 0)
+        return -1;
+
+    vfs_aio_stream_wait(s);
+    if (s->failed)
+        ERR_RETURN(EIO, -1);
+    return 0;
+}
+
+int vfs_aio_stream_delete(vfs_aio_stream_t *s)
+{
+    if (s == NULL)
+        return 0;
+
+    int res = vfs_aio_stream_flush(s);
+    vfs_aio_stream_wait(s); // flush may fail before waiting
+    osiSemaphoreDelete(s->done_sema);
+    free(s);
+    return res;
+}
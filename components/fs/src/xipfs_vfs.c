@@ -0,0 +1,619 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "osi_api.h"
+#include "osi_log.h"
+#include "vfs.h"
+#include "vfs_ops.h"
+#include "sys/errno.h"
+#include "xipfs_vfs.h"
+#include "hal_lzma.h"
+
+#define XIPFS_FD_MAX (16)
+#define XIPFS_LZMA_CACHE_COUNT (2)
+#define XIPFS_LZMA_BLOCK_MAX (64 * 1024)
+
+#define ENTRY_OFFSET(e) ((e)->offset & ~XIPFS_FLAG_MASK)
+#define ENTRY_IS_LZMA(e) (((e)->offset & XIPFS_FLAG_LZMA) != 0)
+
+#define ERR_RETURN(err, ret) OSI_DO_WHILE0(errno = (err); return (ret);)
+
+// LZMA stream header, the same as hal_lzma.c
+typedef struct
+{
+    uint32_t data_size;  // size in bytes
+    uint16_t block_size; // size in 1KB bytes
+    uint8_t dict_size;   // size in 1KB bytes
+    uint8_t prop;        // the property byte
+} xipfsLzmaHeader_t;
+
+// LZMA block header, followed by stream padded to 8 bytes
+typedef struct
+{
+    uint32_t stream_size;
+    uint32_t data_crc;
+} xipfsLzmaBlockHeader_t;
+
+typedef struct
+{
+    bool used;
+    uint16_t entry;
+    uint32_t pos;
+    uint32_t block_size; // LZMA only
+    uint32_t dict_size;  // LZMA only
+    uint32_t *blocks;    // LZMA only, block header offsets in image
+} xipfsFile_t;
+
+// Decompressed block cache, shared by all mounts. Hardware LZMA can
+// only access RAM, so the stream is copied to RAM before decompress.
+typedef struct
+{
+    const xipfsEntry_t *entry; // NULL for empty
+    unsigned index;
+    unsigned size;
+    unsigned capacity;
+    uint8_t *data; // 32 bytes aligned, required by hardware
+    uint32_t stamp;
+} xipfsLzmaBlock_t;
+
+typedef struct
+{
+    osiMutex_t *lock;
+    uint32_t stamp;
+    unsigned stream_capacity;
+    uint8_t *stream; // 8 bytes aligned, required by hardware
+    xipfsLzmaBlock_t blocks[XIPFS_LZMA_CACHE_COUNT];
+} xipfsLzmaCache_t;
+
+typedef struct
+{
+    DIR v_dir;
+    unsigned pos;
+    size_t prefix_len; // "dir/" in names, 0 for root
+    char prefix[XIPFS_NAME_MAX];
+    char last_dir[XIPFS_NAME_MAX]; // last returned sub-directory
+    struct dirent e;
+} xipfsDir_t;
+
+typedef struct
+{
+    const uint8_t *base;
+    const xipfsEntry_t *entries;
+    unsigned count;
+    size_t size;
+    xipfsFile_t files[XIPFS_FD_MAX];
+} xipfsContext_t;
+
+static xipfsLzmaCache_t g_xipfs_lzma;
+
+static int _entryCompare(const void *key, const void *entry)
+{
+    return strcmp((const char *)key, ((const xipfsEntry_t *)entry)->name);
+}
+
+static const xipfsEntry_t *_findEntry(xipfsContext_t *d, const char *path)
+{
+    return (const xipfsEntry_t *)bsearch(path, d->entries, d->count,
+                                         sizeof(xipfsEntry_t), _entryCompare);
+}
+
+// whether path is a directory, root or prefix of any name
+static bool _isDir(xipfsContext_t *d, const char *path)
+{
+    size_t len = strlen(path);
+    if (len == 0)
+        return true;
+
+    for (unsigned n = 0; n < d->count; n++)
+    {
+        const char *name = d->entries[n].name;
+        if (memcmp(name, path, len) == 0 && name[len] == '/')
+            return true;
+    }
+    return false;
+}
+
+static xipfsFile_t *_getFile(xipfsContext_t *d, int fd)
+{
+    if (fd < 0 || fd >= XIPFS_FD_MAX || !d->files[fd].used)
+        return NULL;
+    return &d->files[fd];
+}
+
+// Drop all cached blocks. Caller should hold the lock.
+static void _lzmaCacheClear(void)
+{
+    xipfsLzmaCache_t *c = &g_xipfs_lzma;
+    for (unsigned n = 0; n < XIPFS_LZMA_CACHE_COUNT; n++)
+    {
+        free(c->blocks[n].data);
+        c->blocks[n].data = NULL;
+        c->blocks[n].capacity = 0;
+        c->blocks[n].entry = NULL;
+    }
+
+    free(c->stream);
+    c->stream = NULL;
+    c->stream_capacity = 0;
+}
+
+// Create block offset table, by walking block headers
+static bool _lzmaOpen(xipfsContext_t *d, const xipfsEntry_t *e, xipfsFile_t *f)
+{
+    uint32_t offset = ENTRY_OFFSET(e);
+    if (d->size - offset < sizeof(xipfsLzmaHeader_t))
+        return false;
+
+    const xipfsLzmaHeader_t *hdr = (const xipfsLzmaHeader_t *)(d->base + offset);
+    unsigned block_size = hdr->block_size << 10;
+    if (hdr->data_size != e->size || block_size == 0 || block_size > XIPFS_LZMA_BLOCK_MAX)
+        return false;
+
+    unsigned count = OSI_DIV_ROUND_UP(e->size, block_size);
+    uint32_t *blocks = (uint32_t *)calloc(count + 1, sizeof(uint32_t)); // not NULL for empty file
+    if (blocks == NULL)
+        return false;
+
+    offset += sizeof(xipfsLzmaHeader_t);
+    for (unsigned n = 0; n < count; n++)
+    {
+        if (d->size - offset < sizeof(xipfsLzmaBlockHeader_t))
+            goto failed;
+
+        const xipfsLzmaBlockHeader_t *bh = (const xipfsLzmaBlockHeader_t *)(d->base + offset);
+        uint32_t stream_size = OSI_ALIGN_UP(bh->stream_size, 8);
+        if (bh->stream_size == 0 || stream_size > d->size - offset - sizeof(xipfsLzmaBlockHeader_t))
+            goto failed;
+
+        blocks[n] = offset;
+        offset += sizeof(xipfsLzmaBlockHeader_t) + stream_size;
+    }
+
+    f->block_size = block_size;
+    f->dict_size = hdr->dict_size << 10;
+    f->blocks = blocks;
+    return true;
+
+failed:
+    OSI_LOGE(0, "XIPFS invalid lzma stream at 0x%x", ENTRY_OFFSET(e));
+    free(blocks);
+    return false;
+}
+
+// Get decompressed block, from cache or decompress. Caller should hold the lock.
+static xipfsLzmaBlock_t *_lzmaGetBlock(xipfsContext_t *d, const xipfsEntry_t *e, xipfsFile_t *f, unsigned index)
+{
+    xipfsLzmaCache_t *c = &g_xipfs_lzma;
+    xipfsLzmaBlock_t *victim = &c->blocks[0];
+    for (unsigned n = 0; n < XIPFS_LZMA_CACHE_COUNT; n++)
+    {
+        xipfsLzmaBlock_t *b = &c->blocks[n];
+        if (b->entry == e && b->index == index)
+        {
+            b->stamp = ++c->stamp;
+            return b;
+        }
+
+        if (b->entry == NULL || (victim->entry != NULL && b->stamp < victim->stamp))
+            victim = b;
+    }
+
+    const xipfsLzmaBlockHeader_t *bh = (const xipfsLzmaBlockHeader_t *)(d->base + f->blocks[index]);
+    unsigned stream_size = bh->stream_size;
+    unsigned size = OSI_MIN(unsigned, f->block_size, e->size - index * f->block_size);
+
+    // hardware may write up to 32 bytes aligned
+    unsigned capacity = OSI_ALIGN_UP(f->block_size, 32);
+    if (victim->capacity < capacity)
+    {
+        free(victim->data);
+        victim->entry = NULL;
+        victim->capacity = 0;
+        victim->data = (uint8_t *)memalign(32, capacity);
+        if (victim->data == NULL)
+            return NULL;
+        victim->capacity = capacity;
+    }
+
+    if (c->stream_capacity < stream_size)
+    {
+        unsigned stream_capacity = OSI_ALIGN_UP(stream_size, 1024);
+        free(c->stream);
+        c->stream_capacity = 0;
+        c->stream = (uint8_t *)memalign(8, stream_capacity);
+        if (c->stream == NULL)
+            return NULL;
+        c->stream_capacity = stream_capacity;
+    }
+
+    memcpy(c->stream, bh + 1, stream_size);
+
+    uint32_t crc = 0;
+    victim->entry = NULL;
+    if (!halLzmaDecompressBlock(c->stream, stream_size, victim->data, size, f->dict_size, &crc) ||
+        crc != bh->data_crc)
+    {
+        OSI_LOGE(0, "XIPFS lzma block %d decompress failed", index);
+        return NULL;
+    }
+
+    victim->entry = e;
+    victim->index = index;
+    victim->size = size;
+    victim->stamp = ++c->stamp;
+    return victim;
+}
+
+static ssize_t _lzmaRead(xipfsContext_t *d, xipfsFile_t *f, void *data, size_t size)
+{
+    xipfsLzmaCache_t *c = &g_xipfs_lzma;
+    const xipfsEntry_t *e = &d->entries[f->entry];
+    uint8_t *pdata = (uint8_t *)data;
+    size_t total = 0;
+
+    size = OSI_MIN(size_t, size, e->size - f->pos);
+    osiMutexLock(c->lock);
+    while (total < size)
+    {
+        unsigned index = f->pos / f->block_size;
+        xipfsLzmaBlock_t *b = _lzmaGetBlock(d, e, f, index);
+        if (b == NULL)
+        {
+            osiMutexUnlock(c->lock);
+            if (total > 0)
+                return total;
+            ERR_RETURN(EIO, -1);
+        }
+
+        unsigned offset = f->pos - index * f->block_size;
+        size_t len = OSI_MIN(size_t, size - total, b->size - offset);
+        memcpy(pdata + total, b->data + offset, len);
+        total += len;
+        f->pos += len;
+    }
+    osiMutexUnlock(c->lock);
+    return total;
+}
+
+static int _umount(void *ctx)
+{
+    xipfsLzmaCache_t *c = &g_xipfs_lzma;
+    osiMutexLock(c->lock);
+    _lzmaCacheClear();
+    osiMutexUnlock(c->lock);
+
+    free(ctx);
+    return 0;
+}
+
+static int _open(void *ctx, const char *path, int flags, int mode)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    if ((flags & O_ACCMODE) != O_RDONLY || (flags & (O_CREAT | O_TRUNC)) != 0)
+        ERR_RETURN(EROFS, -1);
+
+    const xipfsEntry_t *e = _findEntry(d, path);
+    if (e == NULL)
+        ERR_RETURN(_isDir(d, path) ? EISDIR : ENOENT, -1);
+
+    xipfsFile_t lzma = {};
+    if (ENTRY_IS_LZMA(e) && !_lzmaOpen(d, e, &lzma))
+        ERR_RETURN(EIO, -1);
+
+    uint32_t critical = osiEnterCritical();
+    for (int fd = 0; fd < XIPFS_FD_MAX; fd++)
+    {
+        xipfsFile_t *f = &d->files[fd];
+        if (!f->used)
+        {
+            f->used = true;
+            f->entry = e - d->entries;
+            f->pos = 0;
+            f->block_size = lzma.block_size;
+            f->dict_size = lzma.dict_size;
+            f->blocks = lzma.blocks;
+            osiExitCritical(critical);
+            return fd;
+        }
+    }
+    osiExitCritical(critical);
+    free(lzma.blocks);
+    ERR_RETURN(ENFILE, -1);
+}
+
+static int _close(void *ctx, int fd)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    xipfsFile_t *f = _getFile(d, fd);
+    if (f == NULL)
+        ERR_RETURN(EBADF, -1);
+
+    free(f->blocks);
+    f->blocks = NULL;
+    f->used = false;
+    return 0;
+}
+
+static ssize_t _read(void *ctx, int fd, void *data, size_t size)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    xipfsFile_t *f = _getFile(d, fd);
+    if (f == NULL)
+        ERR_RETURN(EBADF, -1);
+
+    if (f->blocks != NULL)
+        return _lzmaRead(d, f, data, size);
+
+    const xipfsEntry_t *e = &d->entries[f->entry];
+    size_t len = OSI_MIN(size_t, size, e->size - f->pos);
+    memcpy(data, d->base + ENTRY_OFFSET(e) + f->pos, len);
+    f->pos += len;
+    return len;
+}
+
+static ssize_t _write(void *ctx, int fd, const void *data, size_t size)
+{
+    ERR_RETURN(EROFS, -1);
+}
+
+static long _lseek(void *ctx, int fd, long offset, int mode)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    xipfsFile_t *f = _getFile(d, fd);
+    if (f == NULL)
+        ERR_RETURN(EBADF, -1);
+
+    const xipfsEntry_t *e = &d->entries[f->entry];
+    long pos;
+    if (mode == SEEK_SET)
+        pos = offset;
+    else if (mode == SEEK_CUR)
+        pos = (long)f->pos + offset;
+    else if (mode == SEEK_END)
+        pos = (long)e->size + offset;
+    else
+        ERR_RETURN(EINVAL, -1);
+
+    if (pos < 0)
+        ERR_RETURN(EINVAL, -1);
+
+    f->pos = OSI_MIN(long, pos, e->size);
+    return f->pos;
+}
+
+static void _fillStat(const xipfsEntry_t *e, struct stat *st)
+{
+    memset(st, 0, sizeof(*st));
+    if (e == NULL)
+    {
+        st->st_mode = S_IRUSR | S_IRGRP | S_IROTH | S_IXUSR | S_IXGRP | S_IXOTH | S_IFDIR;
+    }
+    else
+    {
+        st->st_mode = S_IRUSR | S_IRGRP | S_IROTH | S_IFREG;
+        st->st_size = e->size;
+    }
+}
+
+static int _fstat(void *ctx, int fd, struct stat *st)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    xipfsFile_t *f = _getFile(d, fd);
+    if (f == NULL)
+        ERR_RETURN(EBADF, -1);
+
+    _fillStat(&d->entries[f->entry], st);
+    return 0;
+}
+
+static int _stat(void *ctx, const char *path, struct stat *st)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    const xipfsEntry_t *e = _findEntry(d, path);
+    if (e == NULL && !_isDir(d, path))
+        ERR_RETURN(ENOENT, -1);
+
+    _fillStat(e, st);
+    return 0;
+}
+
+static DIR *_opendir(void *ctx, const char *path)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    size_t len = strlen(path);
+    if (len + 1 >= XIPFS_NAME_MAX || !_isDir(d, path))
+        ERR_RETURN(ENOENT, NULL);
+
+    xipfsDir_t *dir = (xipfsDir_t *)calloc(1, sizeof(xipfsDir_t));
+    if (dir == NULL)
+        ERR_RETURN(ENOMEM, NULL);
+
+    if (len > 0)
+    {
+        memcpy(dir->prefix, path, len);
+        dir->prefix[len] = '/';
+        dir->prefix_len = len + 1;
+    }
+    return &dir->v_dir;
+}
+
+static int _readdir_r(void *ctx, DIR *pdir, struct dirent *entry, struct dirent **out_dirent)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    xipfsDir_t *dir = (xipfsDir_t *)pdir;
+
+    // names are sorted, and names under the same sub-directory are adjacent
+    *out_dirent = NULL;
+    for (; dir->pos < d->count; dir->pos++)
+    {
+        const char *name = d->entries[dir->pos].name;
+        if (memcmp(name, dir->prefix, dir->prefix_len) != 0)
+            continue;
+
+        const char *child = name + dir->prefix_len;
+        const char *slash = strchr(child, '/');
+        size_t len = (slash == NULL) ? strlen(child) : slash - child;
+        if (slash != NULL)
+        {
+            if (memcmp(dir->last_dir, child, len) == 0 && dir->last_dir[len] == '\0')
+                continue; // sub-directory already returned
+
+            memcpy(dir->last_dir, child, len);
+            dir->last_dir[len] = '\0';
+        }
+
+        memcpy(entry->d_name, child, len);
+        entry->d_name[len] = '\0';
+        entry->d_type = (slash == NULL) ? DT_REG : DT_DIR;
+        entry->d_ino = dir->pos;
+        dir->pos++;
+        *out_dirent = entry;
+        return 0;
+    }
+    return 0;
+}
+
+static struct dirent *_readdir(void *ctx, DIR *pdir)
+{
+    xipfsDir_t *dir = (xipfsDir_t *)pdir;
+    struct dirent *out = NULL;
+    _readdir_r(ctx, pdir, &dir->e, &out);
+    return out;
+}
+
+static int _closedir(void *ctx, DIR *pdir)
+{
+    free(pdir);
+    return 0;
+}
+
+static int _statvfs(void *ctx, struct statvfs *buf)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    memset(buf, 0, sizeof(*buf));
+    buf->f_bsize = XIPFS_ALIGN;
+    buf->f_frsize = XIPFS_ALIGN;
+    buf->f_blocks = d->size / XIPFS_ALIGN;
+    buf->f_files = d->count;
+    buf->f_flag = MS_RDONLY;
+    buf->f_namemax = XIPFS_NAME_MAX - 1;
+    return 0;
+}
+
+static const void *_mmap(void *ctx, const char *path, size_t *size)
+{
+    xipfsContext_t *d = (xipfsContext_t *)ctx;
+    const xipfsEntry_t *e = _findEntry(d, path);
+    if (e == NULL)
+        ERR_RETURN(ENOENT, NULL);
+
+    // compressed file can't be accessed in place
+    if (ENTRY_IS_LZMA(e))
+        ERR_RETURN(ENOSYS, NULL);
+
+    if (size != NULL)
+        *size = e->size;
+    return d->base + ENTRY_OFFSET(e);
+}
+
+static const vfs_ops_t g_xipfs_vfs_ops = {
+    .umount = _umount,
+    .open = _open,
+    .close = _close,
+    .read = _read,
+    .write = _write,
+    .lseek = _lseek,
+    .fstat = _fstat,
+    .stat = _stat,
+    .opendir = _opendir,
+    .readdir = _readdir,
+    .readdir_r = _readdir_r,
+    .closedir = _closedir,
+    .statvfs = _statvfs,
+    .mmap = _mmap,
+};
+
+static bool _checkImage(const void *base, size_t size)
+{
+    const xipfsHeader_t *hdr = (const xipfsHeader_t *)base;
+    if (size < sizeof(xipfsHeader_t) || hdr->magic != XIPFS_MAGIC ||
+        hdr->version != XIPFS_VERSION || hdr->size > size ||
+        hdr->count > (hdr->size - sizeof(xipfsHeader_t)) / sizeof(xipfsEntry_t))
+        return false;
+
+    const xipfsEntry_t *entries = (const xipfsEntry_t *)(hdr + 1);
+    for (unsigned n = 0; n < hdr->count; n++)
+    {
+        const xipfsEntry_t *e = &entries[n];
+        // size of compressed file is checked at open
+        uint32_t offset = ENTRY_OFFSET(e);
+        if (memchr(e->name, '\0', XIPFS_NAME_MAX) == NULL || offset > hdr->size ||
+            (!ENTRY_IS_LZMA(e) && e->size > hdr->size - offset))
+            return false;
+
+        // bsearch depends on the order
+        if (n > 0 && strcmp(entries[n - 1].name, e->name) >= 0)
+            return false;
+    }
+    return true;
+}
+
+int xipfsVfsMount(const char *base_path, const void *base, size_t size)
+{
+    if (base_path == NULL || base == NULL)
+        return -1;
+
+    if (!_checkImage(base, size))
+    {
+        OSI_LOGE(0, "XIPFS invalid image at %p", base);
+        return -1;
+    }
+
+    xipfsLzmaCache_t *c = &g_xipfs_lzma;
+    if (c->lock == NULL)
+    {
+        osiMutex_t *lock = osiMutexCreate();
+        if (lock == NULL)
+            return -1;
+
+        uint32_t critical = osiEnterCritical();
+        bool inited = (c->lock != NULL);
+        if (!inited)
+            c->lock = lock;
+        osiExitCritical(critical);
+
+        if (inited)
+            osiMutexDelete(lock);
+    }
+
+    xipfsContext_t *d = (xipfsContext_t *)calloc(1, sizeof(xipfsContext_t));
+    if (d == NULL)
+        return -1;
+
+    const xipfsHeader_t *hdr = (const xipfsHeader_t *)base;
+    d->base = (const uint8_t *)base;
+    d->entries = (const xipfsEntry_t *)(hdr + 1);
+    d->count = hdr->count;
+    d->size = hdr->size;
+
+    if (vfs_register(base_path, &g_xipfs_vfs_ops, d) < 0)
+    {
+        free(d);
+        return -1;
+    }
+
+    OSI_LOGI(0, "XIPFS mounted, %d files %d bytes", d->count, d->size);
+    return 0;
+}
@@ -208,6 +208,38 @@ void halAesTrngGetValue(uint32_t *v0, uint32_t *v1);
  */
 bool halAesCheckTrngComplete();
 
+/**
+ * \brief enable hw aes engine clock
+ */
+void halAesCryptInit(void);
+
+/**
+ * \brief set AES-128 key of hw aes engine
+ *
+ * \param key      16 bytes key, word aligned
+ * \param decrypt  true for decryption, and false for encryption
+ */
+void halAesCryptSetKey(const uint8_t *key, bool decrypt);
+
+/**
+ * \brief start hw aes engine DMA in ECB mode
+ *
+ * Both \p src and \p dst should be word aligned, and \p size should
+ * be multiple of 16. Cache coherence should be handled by caller.
+ *
+ * \param src      source address
+ * \param dst      destination address, can be the same as \p src
+ * \param size     size in bytes
+ */
+void halAesCryptStart(const void *src, void *dst, uint32_t size);
+
+/**
+ * \brief check hw aes engine DMA done
+ * \return
+ *      - true if done else false
+ */
+bool halAesCheckCryptComplete(void);
+
 /**
  * \brief read 2720 RTC and convert to second
  *
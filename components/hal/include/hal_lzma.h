@@ -109,6 +109,38 @@ bool halLzmaDecompressBlock(const void *src, uint32_t src_size,
                             void *dest, uint32_t dest_size,
                             uint32_t dict_size, uint32_t *crc);
 
+/**
+ * start to decompress LZMA stream
+ *
+ * It is the same as \p halLzmaDecompressBlock, except it will return
+ * after hardware is started. CPU can do other things, such as to prepare
+ * the next block, and then \p halLzmaDecompressBlockWait should be called.
+ *
+ * \p src shouldn't be changed before \p halLzmaDecompressBlockWait.
+ *
+ * \param [in] src          LZMA stream
+ * \param [in] src_size     LZMA stream size
+ * \param [in] dest         decompressed buffer
+ * \param [in] dest_size    decompressed data size
+ * \param [in] dict_size    dictionary size
+ * \return
+ *      - true if hardware is started
+ *      - false on invalid parameter
+ */
+bool halLzmaDecompressBlockStart(const void *src, uint32_t src_size,
+                                 void *dest, uint32_t dest_size,
+                                 uint32_t dict_size);
+
+/**
+ * wait the decompress started by \p halLzmaDecompressBlockStart
+ *
+ * \param [out] crc         decompressed data CRC, can be NULL
+ * \return
+ *      - true on success
+ *      - false on error
+ */
+bool halLzmaDecompressBlockWait(uint32_t *crc);
+
 /**
  * decompress LZMA file stream
  *
@@ -128,6 +160,33 @@ bool halLzmaDecompressBlock(const void *src, uint32_t src_size,
  */
 int halLzmaDecompressFile(const void *stream, void *dest);
 
+/**
+ * decompress LZMA file stream through staging buffers
+ *
+ * It is similar to \p halLzmaDecompressFile, except \p stream can be
+ * located anywhere readable by CPU, such as memory mapped flash. The
+ * block streams are copied into staging buffers, and the copy of the next
+ * block is overlapped with hardware decompress of the current block.
+ *
+ * \p buf is split into 2 staging buffers, and each should be large enough
+ * for the maximum block stream size, see \p halLzmaMaxBlockStreamSize.
+ *
+ * Limitations:
+ * - \p buf must be 8 bytes aligned
+ * - \p dest must be 32 bytes aligned
+ * - \p buf and \p dest must be PSRAM/DDR address
+ * - Hardware may overwrite destination buffer up to 32 bytes aligned.
+ *
+ * \param [in] stream   LZMA file stream
+ * \param [in] dest     decompressed buffer
+ * \param [in] buf      staging buffer
+ * \param [in] buf_size staging buffer size
+ * \return
+ *      - decompressed data size
+ *      - -1 on error
+ */
+int halLzmaDecompressFileStaged(const void *stream, void *dest, void *buf, uint32_t buf_size);
+
 #ifdef __cplusplus
 }
 #endif
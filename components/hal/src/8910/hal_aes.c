@@ -19,9 +19,16 @@
 #include "osi_api.h"
 #include "osi_log.h"
 
+// crc_ce_ctrl of dma_ctrl, data path through AES engine
+#define AES_CE_CTRL_AES (1)
+// int_out of dma_int_out, DMA done
+#define AES_INT_DMA_DONE (1 << 0)
+
 void halAesTrngInit()
 {
-    REG_AES_DMA_FUNC_CTRL_T dma_func_ctrl = {.b.trng_cgen = 1};
+    // keep AES engine clock, it may be used by crypt
+    REG_AES_DMA_FUNC_CTRL_T dma_func_ctrl = {hwp_aes->dma_func_ctrl};
+    dma_func_ctrl.b.trng_cgen = 1;
     hwp_aes->dma_func_ctrl = dma_func_ctrl.v;
 }
 
@@ -55,3 +62,46 @@ bool halAesCheckTrngComplete()
 {
     return (hwp_aes->dma_int_out & 0x10);
 }
+
+void halAesCryptInit(void)
+{
+    REG_AES_DMA_FUNC_CTRL_T dma_func_ctrl = {hwp_aes->dma_func_ctrl};
+    dma_func_ctrl.b.aes_eng_cgen = 1;
+    dma_func_ctrl.b.aes_keygen_cgen = 1;
+    hwp_aes->dma_func_ctrl = dma_func_ctrl.v;
+    hwp_aes->dma_int_mask = 0;
+}
+
+void halAesCryptSetKey(const uint8_t *key, bool decrypt)
+{
+    hwp_aes->aes_key0 = OSI_FROM_BE32(*(const uint32_t *)&key[0]);
+    hwp_aes->aes_key1 = OSI_FROM_BE32(*(const uint32_t *)&key[4]);
+    hwp_aes->aes_key2 = OSI_FROM_BE32(*(const uint32_t *)&key[8]);
+    hwp_aes->aes_key3 = OSI_FROM_BE32(*(const uint32_t *)&key[12]);
+
+    REG_AES_AES_MODE_T aes_mode = {
+        .b.mode = decrypt ? 1 : 0,
+        .b.key_start = 1,
+    };
+    hwp_aes->aes_mode = aes_mode.v;
+}
+
+void halAesCryptStart(const void *src, void *dst, uint32_t size)
+{
+    REG_AES_DMA_CTRL_T dma_ctrl = {
+        .b.hsizem = 2, // word
+        .b.crc_ce_ctrl = AES_CE_CTRL_AES,
+    };
+    REG_AES_DMA_LEN_T dma_len = {.b.length = size};
+
+    hwp_aes->dma_int_out = AES_INT_DMA_DONE;
+    hwp_aes->dma_src = (uint32_t)src;
+    hwp_aes->dma_dst = (uint32_t)dst;
+    hwp_aes->dma_ctrl = dma_ctrl.v;
+    hwp_aes->dma_len = dma_len.v; // start
+}
+
+bool halAesCheckCryptComplete(void)
+{
+    return (hwp_aes->dma_int_out & AES_INT_DMA_DONE);
+}
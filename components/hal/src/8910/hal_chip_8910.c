@@ -10,12 +10,17 @@
  * without further testing or modification.
  */
 
+#include "kernel_config.h"
 #include "osi_api.h"
+#include "osi_api_inside.h"
+#include "osi_byte_buf.h"
 #include "hwregs.h"
 #include "hal_chip.h"
 #include "hal_iomux.h"
 #include "cmsis_core.h"
 #include "osi_log.h"
+#include <assert.h>
+#include <string.h>
 
 #include "quec_proj_config.h"
 
@@ -308,6 +313,174 @@ void osiICacheSyncAll(void)
     __ISB();
 }
 
+#ifdef CONFIG_KERNEL_IRQ_OFF_STAT_COUNT
+#define IRQ_OFF_CPSR_I (1 << 7)
+#define IRQ_OFF_PROBE_MAX (8)
+#define IRQ_OFF_US_TICKS(us) ((uint32_t)((uint64_t)(us)*CONFIG_KERNEL_HWTICK_FREQ / 1000000))
+
+static_assert(OSI_IS_POW2(CONFIG_KERNEL_IRQ_OFF_STAT_COUNT),
+              "CONFIG_KERNEL_IRQ_OFF_STAT_COUNT must be power of 2");
+
+typedef struct
+{
+    uintptr_t caller;
+    uint32_t count;
+    uint32_t max_ticks;
+    uint64_t total_ticks;
+    uint32_t hist[OSI_IRQ_OFF_BUCKET_COUNT];
+} halIrqOffSite_t;
+
+typedef struct
+{
+    bool opened;      // interrupt disabled by the outermost osiIrqSave
+    uint32_t start;   // tick of the outermost osiIrqSave
+    uintptr_t caller; // caller of the outermost osiIrqSave
+    halIrqOffSite_t sites[CONFIG_KERNEL_IRQ_OFF_STAT_COUNT];
+    halIrqOffSite_t others; // call sites out of table
+} halIrqOffContext_t;
+
+// It is accessed with interrupt disabled, maybe when external RAM is
+// not accessible.
+static halIrqOffContext_t gIrqOffCtx OSI_SECTION_SRAM_BSS;
+
+/**
+ * Find or insert the call site, called with interrupt disabled
+ */
+static OSI_FORCE_INLINE halIrqOffSite_t *prvIrqOffSite(uintptr_t caller)
+{
+    halIrqOffContext_t *d = &gIrqOffCtx;
+    unsigned index = (caller >> 2) * 0x9e3779b1;
+    for (unsigned n = 0; n < IRQ_OFF_PROBE_MAX; n++, index++)
+    {
+        halIrqOffSite_t *s = &d->sites[index & (CONFIG_KERNEL_IRQ_OFF_STAT_COUNT - 1)];
+        if (s->caller == caller)
+            return s;
+
+        if (s->caller == 0)
+        {
+            s->caller = caller;
+            return s;
+        }
+    }
+    return &d->others;
+}
+
+/**
+ * Accumulate interrupt disabled time, called with interrupt disabled
+ */
+static OSI_FORCE_INLINE void prvIrqOffClose(void)
+{
+    halIrqOffContext_t *d = &gIrqOffCtx;
+    uint32_t ticks = HAL_TIMER_CURVAL_LO - d->start;
+    halIrqOffSite_t *s = prvIrqOffSite(d->caller);
+
+    unsigned bucket = 0;
+    while (bucket < OSI_IRQ_OFF_BUCKET_COUNT - 1 && ticks >= (IRQ_OFF_US_TICKS(4) << bucket))
+        bucket++;
+
+    s->count++;
+    s->total_ticks += ticks;
+    s->hist[bucket]++;
+    if (ticks > s->max_ticks)
+        s->max_ticks = ticks;
+    d->opened = false;
+}
+
+void OSI_SECTION_SRAM_TEXT osiIrqOffStatSwitch(void)
+{
+    if (gIrqOffCtx.opened)
+        prvIrqOffClose();
+}
+
+/**
+ * Get one call site, with short interrupt disabled
+ */
+static bool prvIrqOffSiteGet(unsigned index, osiIrqOffStat_t *stat, bool reset)
+{
+    halIrqOffContext_t *d = &gIrqOffCtx;
+    halIrqOffSite_t *s = (index < CONFIG_KERNEL_IRQ_OFF_STAT_COUNT) ? &d->sites[index] : &d->others;
+    halIrqOffSite_t site;
+
+    uint32_t critical = osiEnterCritical();
+    site = *s;
+    if (reset)
+    {
+        uintptr_t caller = s->caller;
+        memset(s, 0, sizeof(*s));
+        s->caller = caller;
+    }
+    osiExitCritical(critical);
+
+    if (site.count == 0)
+        return false;
+
+    stat->caller = site.caller;
+    stat->count = site.count;
+    stat->max_us = (uint64_t)site.max_ticks * 1000000 / CONFIG_KERNEL_HWTICK_FREQ;
+    stat->total_us = site.total_ticks * 1000000 / CONFIG_KERNEL_HWTICK_FREQ;
+    memcpy(stat->hist, site.hist, sizeof(stat->hist));
+    return true;
+}
+
+int osiIrqOffStat(osiIrqOffStat_t *stats, unsigned count, bool reset)
+{
+    osiIrqOffStat_t stat;
+    unsigned n = 0;
+    for (unsigned index = 0; index <= CONFIG_KERNEL_IRQ_OFF_STAT_COUNT; index++)
+    {
+        if (stats != NULL && n >= count)
+            break;
+
+        if (!prvIrqOffSiteGet(index, stats != NULL ? &stats[n] : &stat, reset))
+            continue;
+
+        n++;
+    }
+    return (int)n;
+}
+
+int osiIrqOffStatDump(void *mem, unsigned size)
+{
+    osiIrqOffStat_t stat;
+    unsigned site_size = 20 + 4 * OSI_IRQ_OFF_BUCKET_COUNT;
+    unsigned count = osiIrqOffStat(NULL, 0, false);
+    unsigned total = 3 + count * site_size;
+    if (mem == NULL)
+        return total;
+    if (total > size)
+        return -1;
+
+    uint8_t *pmem = (uint8_t *)mem;
+    uint8_t *pcount;
+    OSI_STRM_W8(pmem, OSI_IRQ_OFF_BUCKET_COUNT);
+    pcount = pmem;
+    OSI_STRM_WLE16(pmem, 0);
+
+    // call sites may be added after counted
+    unsigned n = 0;
+    for (unsigned index = 0; index <= CONFIG_KERNEL_IRQ_OFF_STAT_COUNT && n < count; index++)
+    {
+        if (!prvIrqOffSiteGet(index, &stat, false))
+            continue;
+
+        OSI_STRM_WLE32(pmem, stat.caller);
+        OSI_STRM_WLE32(pmem, stat.count);
+        OSI_STRM_WLE32(pmem, stat.max_us);
+        OSI_STRM_WLE64(pmem, stat.total_us);
+        for (unsigned b = 0; b < OSI_IRQ_OFF_BUCKET_COUNT; b++)
+            OSI_STRM_WLE32(pmem, stat.hist[b]);
+        n++;
+    }
+
+    osiBytesPutLe16(pcount, n);
+    return 3 + n * site_size;
+}
+#else
+int osiIrqOffStat(osiIrqOffStat_t *stats, unsigned count, bool reset) { return 0; }
+int osiIrqOffStatDump(void *mem, unsigned size) { return -1; }
+void osiIrqOffStatSwitch(void) {}
+#endif
+
 uint32_t OSI_SECTION_SRAM_TEXT osiIrqSave(void)
 {
     uint32_t flags;
@@ -319,11 +492,25 @@ uint32_t OSI_SECTION_SRAM_TEXT osiIrqSave(void)
         : "=r"(flags)
         :
         : "memory", "cc");
+
+#ifdef CONFIG_KERNEL_IRQ_OFF_STAT_COUNT
+    if ((flags & IRQ_OFF_CPSR_I) == 0)
+    {
+        gIrqOffCtx.opened = true;
+        gIrqOffCtx.caller = (uintptr_t)__builtin_return_address(0);
+        gIrqOffCtx.start = HAL_TIMER_CURVAL_LO;
+    }
+#endif
     return flags;
 }
 
 void OSI_SECTION_SRAM_TEXT osiIrqRestore(uint32_t flags)
 {
+#ifdef CONFIG_KERNEL_IRQ_OFF_STAT_COUNT
+    if ((flags & IRQ_OFF_CPSR_I) == 0 && gIrqOffCtx.opened)
+        prvIrqOffClose();
+#endif
+
     asm volatile(
         " msr   cpsr_c, %0\n"
         " dsb\n"
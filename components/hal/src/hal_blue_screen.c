@@ -33,6 +33,12 @@
 #define BLUE_SCREEN_INFO_STRLEN (96 - 1)
 static char gBlueScreenInfo[BLUE_SCREEN_INFO_STRLEN + 1];
 
+#ifdef CONFIG_BSCORE_FLIGHT_SIZE
+#define BSCORE_FLIGHT_USED_SIZE (sizeof(halBscoreSectHeader_t) + CONFIG_BSCORE_FLIGHT_SIZE)
+#else
+#define BSCORE_FLIGHT_USED_SIZE (0)
+#endif
+
 #ifdef CONFIG_SOC_8910
 #define CP_CONTEXT_ADDR (0x80002800)
 uint32_t gGdbCtxType OSI_SECTION_RW_KEEP = 1;
@@ -47,6 +53,7 @@ uint32_t *gGdbRegAddress OSI_SECTION_RW_KEEP = NULL;
                           sizeof(halBscoreSectArmv7aCpReg_t) +                    \
                           sizeof(halBscoreSectMem_t) + CONFIG_BSCORE_STACK_SIZE + \
                           sizeof(halBscoreSectMem_t) + CONFIG_BSCORE_STACK_SIZE + \
+                          BSCORE_FLIGHT_USED_SIZE +                               \
                           sizeof(halBscoreSectHeader_t) + CONFIG_BSCORE_PROFILE_SIZE)
 #endif
 
@@ -57,6 +64,7 @@ uint32_t *gGdbRegAddress OSI_SECTION_RW_KEEP = NULL;
                           sizeof(halBscoreSectHeader_t) + 96 /*apexec*/ +         \
                           sizeof(halBscoreSectArmv8mReg_t) +                      \
                           sizeof(halBscoreSectMem_t) + CONFIG_BSCORE_STACK_SIZE + \
+                          BSCORE_FLIGHT_USED_SIZE +                               \
                           sizeof(halBscoreSectHeader_t) + CONFIG_BSCORE_PROFILE_SIZE)
 #endif
 
@@ -513,6 +521,19 @@ void halBscoreBufSave(void *ctx)
         header->size += OSI_ALIGN_UP(profile->size, 4);
     }
 
+#ifdef CONFIG_BSCORE_FLIGHT_SIZE
+    // Insert flight recorder
+    halBscoreSectHeader_t *flight = (halBscoreSectHeader_t *)core_ptr;
+    unsigned flight_size = osiFlightGetLatest(flight->payload, CONFIG_BSCORE_FLIGHT_SIZE);
+    if (flight_size > 0)
+    {
+        flight->type = HAL_BSCORE_SECT_FLIGHT;
+        flight->size = sizeof(halBscoreSectHeader_t) + flight_size;
+        core_ptr += OSI_ALIGN_UP(flight->size, 4);
+        header->size += OSI_ALIGN_UP(flight->size, 4);
+    }
+#endif
+
 #ifdef CONFIG_SOC_8910
     // Insert registers
     halBscoreSectArmv7aReg_t *regs = (halBscoreSectArmv7aReg_t *)core_ptr;
@@ -27,6 +27,7 @@ enum
     HAL_BSCORE_SECT_PROFILE,
     HAL_BSCORE_SECT_EXEC,
     HAL_BSCORE_SECT_8910CP_EXEC,
+    HAL_BSCORE_SECT_FLIGHT,
     HAL_BSCORE_SECT_REG_8910AP = 0x40,
     HAL_BSCORE_SECT_REG_8910CP,
     HAL_BSCORE_SECT_REG_8811,
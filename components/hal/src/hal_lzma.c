@@ -37,6 +37,14 @@ typedef struct
     uint32_t data_crc;
 } lzmaBlockHeader_t;
 
+typedef struct
+{
+    void *dest;
+    uint32_t dest_size;
+} lzmaContext_t;
+
+static lzmaContext_t gLzmaCtx;
+
 int halLzmaDataSize(const void *stream)
 {
     if (stream == NULL)
@@ -55,13 +63,13 @@ int halLzmaMaxBlockStreamSize(const void *stream, uint32_t size)
     const char *p = (const char *)stream;
     const char *pend = p + size;
     p += sizeof(lzmaFileHeader_t);
-    while (p < pend)
+    while (p + sizeof(lzmaBlockHeader_t) <= pend)
     {
-        lzmaBlockHeader_t *bh = (lzmaBlockHeader_t *)p;
-        uint32_t ss = bh->stream_size;
-        if (ss > st_size)
-            st_size = ss;
-        p += 4 + ss;
+        lzmaBlockHeader_t bh;
+        memcpy(&bh, p, sizeof(bh));
+        if ((int)bh.stream_size > st_size)
+            st_size = bh.stream_size;
+        p += sizeof(lzmaBlockHeader_t) + OSI_ALIGN_UP(bh.stream_size, 8);
     }
     return st_size;
 }
@@ -116,21 +124,104 @@ int halLzmaDecompressFile(const void *stream, void *dest)
     return data_size;
 }
 
+int halLzmaDecompressFileStaged(const void *stream, void *dest, void *buf, uint32_t buf_size)
+{
+    OSI_LOGD(0, "lzma: staged src/%p dest/%p buf/%p/%u", stream, dest, buf, buf_size);
+
+    if (stream == NULL || dest == NULL || buf == NULL)
+        return -1;
+
+    if (!OSI_IS_ALIGNED(dest, 32) || !OSI_IS_ALIGNED(buf, 8))
+        return -1;
+
+    if (!ISRAM(buf) || !ISRAM(dest))
+        return -1;
+
+    lzmaFileHeader_t fheader;
+    memcpy(&fheader, stream, sizeof(fheader));
+    unsigned data_size = fheader.data_size;
+    unsigned block_size = fheader.block_size << 10;
+    unsigned dict_size = fheader.dict_size << 10;
+    if (block_size == 0)
+        return -1;
+
+    // Two staging buffers. Block N+1 is copied into one, when block N in
+    // the other is decompressed by hardware.
+    unsigned stage_size = OSI_ALIGN_DOWN(buf_size / 2, 8);
+    char *stage[2] = {(char *)buf, (char *)buf + stage_size};
+
+    unsigned count = (data_size + block_size - 1) / block_size;
+    const char *ps = (const char *)stream + sizeof(lzmaFileHeader_t);
+    char *pd = (char *)dest;
+
+    lzmaBlockHeader_t bheader[2];
+    memcpy(&bheader[0], ps, sizeof(lzmaBlockHeader_t));
+    if (bheader[0].stream_size > stage_size)
+        return -1;
+    memcpy(stage[0], ps + sizeof(lzmaBlockHeader_t), bheader[0].stream_size);
+    ps += sizeof(lzmaBlockHeader_t) + OSI_ALIGN_UP(bheader[0].stream_size, 8);
+
+    unsigned remained = data_size;
+    for (unsigned n = 0; n < count; n++)
+    {
+        lzmaBlockHeader_t *bh = &bheader[n & 1];
+        unsigned dest_size = (remained > block_size) ? block_size : remained;
+        if (!halLzmaDecompressBlockStart(stage[n & 1], bh->stream_size,
+                                         pd, dest_size, dict_size))
+            return -1;
+
+        bool prefetch_ok = true;
+        if (n + 1 < count)
+        {
+            lzmaBlockHeader_t *bnext = &bheader[(n + 1) & 1];
+            memcpy(bnext, ps, sizeof(lzmaBlockHeader_t));
+            prefetch_ok = (bnext->stream_size <= stage_size);
+            if (prefetch_ok)
+                memcpy(stage[(n + 1) & 1], ps + sizeof(lzmaBlockHeader_t), bnext->stream_size);
+            ps += sizeof(lzmaBlockHeader_t) + OSI_ALIGN_UP(bnext->stream_size, 8);
+        }
+
+        uint32_t crc = 0;
+        if (!halLzmaDecompressBlockWait(&crc) || !prefetch_ok)
+            return -1;
+
+        if (crc != bh->data_crc)
+        {
+            OSI_LOGD(0, "lzma: crc mismatch");
+            return -1;
+        }
+
+        remained -= dest_size;
+        pd += dest_size;
+    }
+
+    return data_size;
+}
+
 bool halLzmaDecompressBlock(const void *src, uint32_t src_size,
                             void *dest, uint32_t dest_size,
                             uint32_t dict_size, uint32_t *crc)
+{
+    if (!halLzmaDecompressBlockStart(src, src_size, dest, dest_size, dict_size))
+        return false;
+    return halLzmaDecompressBlockWait(crc);
+}
+
+bool halLzmaDecompressBlockStart(const void *src, uint32_t src_size,
+                                 void *dest, uint32_t dest_size,
+                                 uint32_t dict_size)
 {
     OSI_LOGD(0, "lzma: src/%p size/%u dest/%p size/%u dict/%u",
              src, src_size, dest, dest_size, dict_size);
 
     if (src == NULL || dest == NULL)
-        return -1;
+        return false;
 
     if (!OSI_IS_ALIGNED(dest, 32) || !OSI_IS_ALIGNED(src, 8))
-        return -1;
+        return false;
 
     if (!ISRAM(src) || !ISRAM(dest))
-        return -1;
+        return false;
 
     halLzmaEnable();
 
@@ -163,7 +254,16 @@ bool halLzmaDecompressBlock(const void *src, uint32_t src_size,
     osiDCacheClean(src, src_size);
     osiDCacheInvalidate(dest, dest_size);
 
+    gLzmaCtx.dest = dest;
+    gLzmaCtx.dest_size = dest_size;
     hwp_lzma->lzma_cmd_reg = 1;
+    return true;
+}
+
+bool halLzmaDecompressBlockWait(uint32_t *crc)
+{
+    void *dest = gLzmaCtx.dest;
+    uint32_t dest_size = gLzmaCtx.dest_size;
 
     REG_WAIT_COND(hwp_lzma->lzma_status_reg != 0);
     REG_LZMA_LZMA_STATUS_REG_T status = {hwp_lzma->lzma_status_reg};
@@ -222,7 +222,9 @@ static void prvHeapInit(void)
  */
 OSI_NO_RETURN void osiBootStart(uint32_t param)
 {
-    // I cache is enabled, and D cache is disabled
+    // I cache is enabled, and D cache is disabled. FPU is enabled first,
+    // memcpy and memset may use NEON.
+    __FPU_Enable();
     OSI_LOAD_SECTION(sramboottext);
     OSI_LOAD_SECTION(sramtext);
     OSI_LOAD_SECTION(sramdata);
@@ -244,7 +246,6 @@ OSI_NO_RETURN void osiBootStart(uint32_t param)
     __DSB();
     __ISB();
 
-    __FPU_Enable();
     AP_WAKEUP_JUMP_MAGIC_REG = 0;
     _impure_ptr = _GLOBAL_REENT;
 
@@ -275,9 +276,9 @@ OSI_NO_RETURN void osiWakePm1(void)
     // now: I cache is enabled, D cache is disabled, only function
     //      on flash can be executed.
 
+    __FPU_Enable();
     halRamWakeInit();
     prvMmuWakeInit();
-    __FPU_Enable();
 
     prvSramRestore();
 
@@ -298,6 +299,7 @@ OSI_NO_RETURN void osiWakePm1(void)
 OSI_NO_RETURN void osiWakePm2(void)
 {
     // now: I cache is enabled, D cache is disabled
+    __FPU_Enable();
     OSI_LOAD_SECTION(sramboottext);
 
     // sync cache after code copy
@@ -306,7 +308,6 @@ OSI_NO_RETURN void osiWakePm2(void)
     halClockInit();
     halRamWakeInit();
     prvMmuWakeInit();
-    __FPU_Enable();
 
     prvSramRestore();
 
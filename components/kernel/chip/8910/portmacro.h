@@ -118,8 +118,10 @@ macros is used. */
 
 extern void osiProfileThreadEnter(unsigned id);
 extern void osiProfileThreadExit(unsigned id);
+extern void osiProfileThreadReady(unsigned id);
 #define traceTASK_SWITCHED_OUT()    osiProfileThreadExit(pxCurrentTCB->uxTCBNumber)
 #define traceTASK_SWITCHED_IN()     osiProfileThreadEnter(pxCurrentTCB->uxTCBNumber)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)   osiProfileThreadReady((pxTCB)->uxTCBNumber)
 
 /* Tickless idle/low power functionality. */
 #ifndef portSUPPRESS_TICKS_AND_SLEEP
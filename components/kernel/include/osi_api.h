@@ -105,6 +105,20 @@ typedef struct osiWork osiWork_t;
  */
 typedef struct osiWorkQueue osiWorkQueue_t;
 
+/**
+ * \brief work queue statistics
+ *
+ * Time is measured with microsecond up time, and then a measurement can't
+ * exceed about 71 minutes.
+ */
+typedef struct
+{
+    uint32_t enqueued;       ///< count of works queued to the work queue
+    uint32_t executed;       ///< count of executed works
+    uint32_t max_latency_us; ///< maximum time from queue to start of execution
+    uint32_t max_run_us;     ///< maximum time of \p run and \p complete
+} osiWorkQueueStat_t;
+
 /**
  * opaque data structure for thread notify
  */
@@ -260,6 +274,8 @@ typedef enum osiPsmDataOwner
     OSI_PSMDATA_OWNER_KERNEL,     ///< kernel
     OSI_PSMDATA_OWNER_STACK,      ///< stack
     OSI_PSMDATA_OWNER_AT,         ///< AT engine
+    OSI_PSMDATA_OWNER_TLS,        ///< TLS client session cache
+    OSI_PSMDATA_OWNER_SNAPSHOT,   ///< component state snapshot service
     OSI_PSMDATA_OWNER_USER = 100, ///< start owner for user application
 } osiPsmDataOwner_t;
 
@@ -1038,6 +1054,25 @@ uint32_t osiEventSpaceCount(osiThread_t *thread);
  */
 bool osiThreadCallback(osiThread_t *thread, osiCallback_t cb, void *cb_ctx);
 
+/**
+ * execute callback on thread, and wait the callback return
+ *
+ * It is the same as \p osiThreadCallback, and the caller is woken up by
+ * task notification after the callback. No kernel object is created and
+ * no memory is allocated.
+ *
+ * When called in \p thread, the callback will be executed directly. It
+ * can't be called in ISR.
+ *
+ * \param thread    thread pointer, can't be NULL
+ * \param cb        callback to be executed
+ * \param cb_ctx    callback context
+ * \return
+ *      - true after the callback is executed
+ *      - false on invalid parameter, or called in ISR
+ */
+bool osiThreadCallbackSync(osiThread_t *thread, osiCallback_t cb, void *cb_ctx);
+
 /**
  * \brief create a work
  *
@@ -1173,6 +1208,10 @@ void osiWorkCancel(osiWork_t *work);
  * is \p OSI_WAIT_FOREVER, it will wait infinitely until the work is
  * finished.
  *
+ * Cancelled or deleted work is regarded as finished. The waiter is only
+ * woken up by the finish of \p work, not by other works in the same work
+ * queue. It shouldn't be called in the callbacks of \p work itself.
+ *
  * \param work      the work pointer, must be valid
  * \param timeout   wait timeout
  * \return
@@ -1194,6 +1233,9 @@ bool osiWorkWaitFinish(osiWork_t *work, unsigned timeout);
  *
  * The created threads have the same priority and stack size.
  *
+ * With multiple threads, different works may be executed concurrently and
+ * out of queue order. The same work won't be executed concurrently.
+ *
  * The work queue thread entry function can't be customized
  *
  * \param name      work queue name
@@ -1218,6 +1260,21 @@ osiWorkQueue_t *osiWorkQueueCreate(const char *name, size_t thread_count, uint32
  */
 void osiWorkQueueDelete(osiWorkQueue_t *wq);
 
+/**
+ * \brief get work queue statistics
+ *
+ * It can be used to find the needed thread count and stack size of work
+ * queues, and works blocking a work queue for long time.
+ *
+ * \param wq    work queue, must be valid
+ * \param stat  output statistics
+ * \param reset true to clear the statistics after get
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool osiWorkQueueGetStat(osiWorkQueue_t *wq, osiWorkQueueStat_t *stat, bool reset);
+
 /**
  * \brief get the system high priority work queue
  *
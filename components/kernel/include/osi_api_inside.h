@@ -224,6 +224,104 @@ uint32_t osiHWTick16K(void);
  */
 int osiPmSourceDump(void *mem, unsigned size);
 
+/**
+ * count of latest suspend/resume cycles kept in PM statistics
+ */
+#define OSI_PM_CYCLE_COUNT (16)
+
+/**
+ * reasons of sleep blocked in PM statistics
+ */
+typedef enum
+{
+    OSI_PM_BLOCK_SOURCE,    ///< PM source wake locked
+    OSI_PM_BLOCK_PREPARE,   ///< PM source prepare failed
+    OSI_PM_BLOCK_SYSCLK,    ///< slow system clock not allowed
+    OSI_PM_BLOCK_CHIP,      ///< chip not permitted, such as wakeup too close
+    OSI_PM_BLOCK_SHORT,     ///< sleep time too short
+    OSI_PM_BLOCK_DATA_LOCK, ///< sleep delayed after data wakeup
+    OSI_PM_BLOCK_COUNT,
+} osiPmBlockReason_t;
+
+/**
+ * PM source statistics
+ */
+typedef struct
+{
+    uint32_t tag;           ///< PM source tag
+    bool active;            ///< wake locked now
+    uint32_t lock_count;    ///< count of wake lock
+    uint32_t blocked_count; ///< count of sleep blocked by the source
+    uint32_t hold_ms;       ///< total wake locked time, including current lock
+} osiPmSourceStat_t;
+
+/**
+ * suspend/resume cycle in PM statistics
+ */
+typedef struct
+{
+    int64_t suspend_time; ///< up time at suspend in milliseconds
+    uint32_t sleep_ms;    ///< time from suspend to resume in milliseconds
+    uint32_t source;      ///< wakeup source
+    bool sleep32k;        ///< 32K sleep, or suspend
+} osiPmCycle_t;
+
+/**
+ * sleep statistics
+ */
+typedef struct
+{
+    uint32_t blocked[OSI_PM_BLOCK_COUNT];    ///< count of sleep blocked by each reason
+    uint32_t suspend_count;                  ///< count of suspend and 32K sleep
+    uint32_t wake_source[32];                ///< count of each wakeup source bit
+    unsigned cycle_count;                    ///< valid cycles
+    osiPmCycle_t cycles[OSI_PM_CYCLE_COUNT]; ///< latest cycles, the latest first
+} osiPmSleepStat_t;
+
+/**
+ * \brief get PM source statistics
+ *
+ * Statistics are accumulated since PM source creation or last reset.
+ * Sleep blocked is counted at each sleep attempt of idle thread, for all
+ * wake locked PM sources or the PM source failed to prepare.
+ *
+ * \param stats     output PM source statistics, can be NULL to get count
+ * \param count     maximum PM source count
+ * \param reset     reset statistics after get
+ * \return  PM source count, not more than \p count if \p stats is not NULL
+ */
+int osiPmSourceStat(osiPmSourceStat_t *stats, unsigned count, bool reset);
+
+/**
+ * \brief get sleep statistics
+ *
+ * \param stat      output sleep statistics
+ * \param reset     reset statistics after get
+ */
+void osiPmSleepStat(osiPmSleepStat_t *stat, bool reset);
+
+/**
+ * \brief dump PM statistics to memory
+ *
+ * It is for debug only. The dump format, all in little endian:
+ * - (2) PM source count
+ * - (17 each) tag, lock count, blocked count, hold time (4 each), active (1)
+ * - (1) blocked reason count, (4 each) blocked count
+ * - (4) suspend count
+ * - (4 * 32) count of each wakeup source bit
+ * - (1) cycle count
+ * - (17 each) suspend time (8), sleep time, source (4 each), 32K sleep (1)
+ *
+ * When \p mem is NULL, it will return the estimated dump size.
+ *
+ * \param mem       memory for PM statistics dump
+ * \param size      provided memory size
+ * \return
+ *      - dump memory size
+ *      - -1 if memory size of not enough
+ */
+int osiPmStatDump(void *mem, unsigned size);
+
 /**
  * \brief dump interrupt information to memory
  *
@@ -239,6 +337,120 @@ int osiPmSourceDump(void *mem, unsigned size);
  */
 int osiIrqDump(void *mem, unsigned size);
 
+/**
+ * histogram bucket count of interrupt disabled time statistics
+ */
+#define OSI_IRQ_OFF_BUCKET_COUNT (10)
+
+/**
+ * interrupt disabled time statistics of a call site
+ */
+typedef struct
+{
+    uintptr_t caller;                        ///< caller of osiIrqSave, 0 for call sites out of table
+    uint32_t count;                          ///< count of interrupt disabled
+    uint32_t max_us;                         ///< maximum interrupt disabled time
+    uint64_t total_us;                       ///< total interrupt disabled time
+    uint32_t hist[OSI_IRQ_OFF_BUCKET_COUNT]; ///< histogram, bucket n is less than (4 << n) us
+} osiIrqOffStat_t;
+
+/**
+ * \brief get interrupt disabled time statistics
+ *
+ * It is only available when \p CONFIG_KERNEL_IRQ_OFF_STAT_COUNT is
+ * defined. Then the time from \p osiIrqSave (and \p osiEnterCritical)
+ * with interrupt enabled, to the matching \p osiIrqRestore is measured
+ * by hardware tick, and accumulated by the caller of \p osiIrqSave.
+ * Nested calls are counted in the outermost one. When there is a thread
+ * switch with interrupt disabled, the time is counted till the switch.
+ * Interrupt handlers are not measured.
+ *
+ * The last histogram bucket is for all longer time. When the call site
+ * table is full, the time is accumulated in the statistics with \p caller
+ * of 0.
+ *
+ * Statistics are got one call site after another, for not to disable
+ * interrupt too long. So, they are not a strict snapshot.
+ *
+ * \param stats     output statistics, can be NULL to get count
+ * \param count     maximum statistics count
+ * \param reset     reset statistics after get
+ * \return  call site count, not more than \p count if \p stats is not NULL
+ */
+int osiIrqOffStat(osiIrqOffStat_t *stats, unsigned count, bool reset);
+
+/**
+ * \brief dump interrupt disabled time statistics to memory
+ *
+ * It is for debug only. The dump format, all in little endian:
+ * - (1) bucket count
+ * - (2) call site count
+ * - (20 + 4 * bucket count each) caller, count, maximum time (4 each),
+ *   total time (8), histogram (4 each bucket)
+ *
+ * Time is in microseconds. When \p mem is NULL, it will return the
+ * estimated dump size.
+ *
+ * \param mem       memory for statistics dump
+ * \param size      provided memory size
+ * \return
+ *      - dump memory size
+ *      - -1 if memory size of not enough, or not available
+ */
+int osiIrqOffStatDump(void *mem, unsigned size);
+
+/**
+ * \brief close interrupt disabled time measurement at thread switch
+ *
+ * It is called in context switch, with interrupt disabled.
+ */
+void osiIrqOffStatSwitch(void);
+
+/**
+ * interrupt handler statistics of an interrupt
+ */
+typedef struct
+{
+    uint32_t irqn;     ///< interrupt number
+    uint32_t count;    ///< count of handler called
+    uint32_t max_us;   ///< maximum handler time
+    uint64_t total_us; ///< total handler time
+    uint32_t max_nest; ///< maximum interrupt nesting depth at entry, 1 for not nested
+} osiIrqStat_t;
+
+/**
+ * \brief get interrupt handler statistics
+ *
+ * It is only available when \p CONFIG_KERNEL_IRQ_STAT is defined. The
+ * time of each handler is measured by hardware tick, excluding the time
+ * of nested interrupts. Only interrupts called at least once are output.
+ *
+ * \param stats     output statistics, can be NULL to get count
+ * \param count     maximum statistics count
+ * \param reset     reset statistics after get
+ * \return  interrupt count, not more than \p count if \p stats is not NULL
+ */
+int osiIrqStat(osiIrqStat_t *stats, unsigned count, bool reset);
+
+/**
+ * \brief dump interrupt handler statistics to memory
+ *
+ * It is for debug only. The dump format, all in little endian:
+ * - (2) interrupt count
+ * - (22 each) interrupt number (2), count, maximum time (4 each), total
+ *   time (8), maximum nesting depth (4)
+ *
+ * Time is in microseconds. When \p mem is NULL, it will return the
+ * estimated dump size.
+ *
+ * \param mem       memory for statistics dump
+ * \param size      provided memory size
+ * \return
+ *      - dump memory size
+ *      - -1 if memory size of not enough, or not available
+ */
+int osiIrqStatDump(void *mem, unsigned size);
+
 /**
  * get current thread count
  *
@@ -257,6 +469,71 @@ uint32_t osiThreadCount(void);
  */
 int osiThreadGetAllStatus(osiThreadStatus_t *status, uint32_t count);
 
+/**
+ * thread name length in stack watermark record, including terminating null
+ */
+#define OSI_STACK_MON_NAME_LEN (16)
+
+/**
+ * stack watermark record of a thread
+ */
+typedef struct
+{
+    char name[OSI_STACK_MON_NAME_LEN]; ///< thread name, may be truncated
+    uint32_t alloc_size;               ///< stack allocation size at the last sample
+    uint32_t max_used;                 ///< maximum used stack size, kept across reboots
+    uint32_t recommended;              ///< recommended stack size, with margin
+} osiStackMonRecord_t;
+
+/**
+ * \brief start stack watermark monitor
+ *
+ * It is only available when \p CONFIG_KERNEL_STACK_MON_COUNT is defined.
+ * Records are loaded from NV, and the minimal unused stack of all threads
+ * is sampled periodically in low priority work queue. The sample timer
+ * won't wake up system. Records are keyed by thread name, and threads
+ * with the same name share one record. Changed records are saved to NV
+ * at most every 10 minutes.
+ *
+ * It should be called after file system is mounted.
+ *
+ * \return
+ *      - true on success
+ *      - false on out of memory, or not available
+ */
+bool osiStackMonStart(void);
+
+/**
+ * \brief sample stack watermark of all threads now
+ */
+void osiStackMonSample(void);
+
+/**
+ * \brief save stack watermark records to NV now
+ *
+ * \return
+ *      - true on success
+ *      - false on failure, or not available
+ */
+bool osiStackMonSave(void);
+
+/**
+ * \brief clear stack watermark records, both in memory and NV
+ */
+void osiStackMonClear(void);
+
+/**
+ * \brief get stack watermark records
+ *
+ * Recommended size is the maximum used size with 25% margin, at least
+ * 256 bytes, and rounded up to 256 bytes.
+ *
+ * \param records   output records, can be NULL to get count
+ * \param count     maximum record count
+ * \return  record count, not more than \p count if \p records is not NULL
+ */
+int osiStackMonGet(osiStackMonRecord_t *records, unsigned count);
+
 #ifdef __cplusplus
 }
 #endif
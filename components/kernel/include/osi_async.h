@@ -0,0 +1,316 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _OSI_ASYNC_H_
+#define _OSI_ASYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "kernel_config.h"
+#include "osi_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief stackless async task
+ *
+ * Async task is a coroutine without its own stack. It is executed as
+ * a work in the specified work queue, and many async tasks can share
+ * the thread of a work queue. At each wait point, the task entry returns,
+ * and it will be invoked again from the wait point at wakeup.
+ *
+ * As the entry returns at each wait point, local variables are **not**
+ * kept across wait points. All states should be kept in the context.
+ * Also, there should be at most one wait point in one source line, and
+ * wait points can't be inside \p switch statement of the task entry.
+ *
+ * \code{.cpp}
+ * static osiAsyncStatus_t prvSession(osiAsyncTask_t *task, void *param)
+ * {
+ *     session_t *s = (session_t *)param;
+ *     OSI_ASYNC_BEGIN(task);
+ *
+ *     s->uti = cfwRequestUTI(osiAsyncTaskEventCallback, task);
+ *     CFW_xxxReq(..., s->uti);
+ *     OSI_ASYNC_AWAIT_EVENT(task, &s->event);
+ *
+ *     // socket readiness is polled, with zero timeout select
+ *     OSI_ASYNC_AWAIT_POLL(task, prvSocketReadable(s), 50);
+ *
+ *     OSI_ASYNC_SLEEP(task, 1000);
+ *     OSI_ASYNC_END(task);
+ * }
+ *
+ * task = osiAsyncTaskCreate(wq, prvSession, prvSessionDone, s);
+ * osiAsyncTaskStart(task);
+ * \endcode
+ *
+ * Wakeup sources:
+ * - \p osiAsyncTaskWake, it can be called in any thread or ISR.
+ * - \p osiAsyncTaskPostEvent, the event is queued inside the task. And
+ *   \p osiAsyncTaskEventCallback can be used as \p osiEventCallback_t,
+ *   such as callback of CFW UTI or \p osiEventDispatch.
+ * - timeout set by \p osiAsyncTaskSetTimeout.
+ *
+ * Wakeup of running task is not lost, the task entry will be invoked
+ * again after it returns.
+ */
+
+/**
+ * event queue depth inside async task
+ */
+#define OSI_ASYNC_EVENT_DEPTH (4)
+
+/**
+ * opaque data structure of async task
+ */
+typedef struct osiAsyncTask osiAsyncTask_t;
+
+/**
+ * return value of async task entry
+ */
+typedef enum
+{
+    OSI_ASYNC_WAIT, ///< wait for wakeup
+    OSI_ASYNC_DONE, ///< finished
+} osiAsyncStatus_t;
+
+/**
+ * function type of async task entry
+ */
+typedef osiAsyncStatus_t (*osiAsyncEntry_t)(osiAsyncTask_t *task, void *ctx);
+
+/**
+ * @brief create an async task
+ *
+ * After create, the task isn't started.
+ *
+ * @param wq        work queue to execute the task, must be valid
+ * @param entry     task entry, must be valid
+ * @param done      callback after the task is finished, can be NULL
+ * @param ctx       context of \p entry and \p done
+ * @return
+ *      - the created async task
+ *      - NULL on invalid parameter or out of memory
+ */
+osiAsyncTask_t *osiAsyncTaskCreate(osiWorkQueue_t *wq, osiAsyncEntry_t entry, osiCallback_t done, void *ctx);
+
+/**
+ * @brief delete the async task
+ *
+ * It can be called in \p done callback, or task entry. Then the task will
+ * be deleted after the entry returns. Otherwise, it should be called in
+ * the work queue thread, or when the task isn't running.
+ *
+ * When \p task is NULL, nothing will be done.
+ *
+ * @param task      the async task
+ */
+void osiAsyncTaskDelete(osiAsyncTask_t *task);
+
+/**
+ * @brief start the async task from the beginning
+ *
+ * Pending events and timeout are cleared. It shouldn't be called when
+ * the task is running.
+ *
+ * @param task      the async task, must be valid
+ * @return
+ *      - true on success
+ *      - false on fail
+ */
+bool osiAsyncTaskStart(osiAsyncTask_t *task);
+
+/**
+ * @brief wake up the async task
+ *
+ * The task entry will be invoked in work queue, and the wait condition
+ * will be checked. Nothing will be done for finished task. It can be
+ * called in ISR.
+ *
+ * @param task      the async task, must be valid
+ */
+void osiAsyncTaskWake(osiAsyncTask_t *task);
+
+/**
+ * @brief whether the async task is finished
+ *
+ * @param task      the async task, must be valid
+ * @return
+ *      - true if the task entry returns \p OSI_ASYNC_DONE
+ */
+bool osiAsyncTaskIsFinished(osiAsyncTask_t *task);
+
+/**
+ * @brief post an event to the async task, and wake up the task
+ *
+ * It can be called in ISR.
+ *
+ * @param task      the async task, must be valid
+ * @param event     the event, must be valid
+ * @return
+ *      - true on success
+ *      - false if the event queue of the task is full
+ */
+bool osiAsyncTaskPostEvent(osiAsyncTask_t *task, const osiEvent_t *event);
+
+/**
+ * @brief event callback to post event to async task
+ *
+ * It can be used as \p osiEventCallback_t, and \p ctx is the async task.
+ *
+ * @param ctx       the async task
+ * @param event     the event
+ */
+void osiAsyncTaskEventCallback(void *ctx, const osiEvent_t *event);
+
+/**
+ * @brief get the first event posted to the async task
+ *
+ * @param task      the async task, must be valid
+ * @param event     output event, must be valid
+ * @return
+ *      - true if there are event
+ *      - false if there are no event
+ */
+bool osiAsyncTaskGetEvent(osiAsyncTask_t *task, osiEvent_t *event);
+
+/**
+ * @brief set timeout of the async task
+ *
+ * The task will be woken up after \p ms. Previous timeout is replaced.
+ *
+ * @param task      the async task, must be valid
+ * @param ms        timeout in milliseconds
+ * @return
+ *      - true on success
+ *      - false on fail
+ */
+bool osiAsyncTaskSetTimeout(osiAsyncTask_t *task, uint32_t ms);
+
+/**
+ * @brief stop timeout of the async task
+ *
+ * @param task      the async task, must be valid
+ */
+void osiAsyncTaskStopTimeout(osiAsyncTask_t *task);
+
+/**
+ * @brief whether the timeout of the async task is expired
+ *
+ * @param task      the async task, must be valid
+ * @return
+ *      - true if the last timeout is expired
+ */
+bool osiAsyncTaskIsTimeout(osiAsyncTask_t *task);
+
+/**
+ * @brief get resume point of the async task, only for macros
+ */
+unsigned osiAsyncTaskGetLine(osiAsyncTask_t *task);
+
+/**
+ * @brief set resume point of the async task, only for macros
+ */
+void osiAsyncTaskSetLine(osiAsyncTask_t *task, unsigned line);
+
+/**
+ * start of async task entry
+ */
+#define OSI_ASYNC_BEGIN(task)          \
+    switch (osiAsyncTaskGetLine(task)) \
+    {                                  \
+    case 0:
+
+/**
+ * end of async task entry, the task will be finished
+ */
+#define OSI_ASYNC_END(task) \
+    }                       \
+    return OSI_ASYNC_DONE
+
+/**
+ * finish the async task in the middle
+ */
+#define OSI_ASYNC_EXIT(task) return OSI_ASYNC_DONE
+
+/**
+ * wait until \p cond is true, \p cond is checked at each wakeup
+ */
+#define OSI_ASYNC_AWAIT(task, cond)          \
+    do                                       \
+    {                                        \
+        osiAsyncTaskSetLine(task, __LINE__); \
+    case __LINE__:                           \
+        if (!(cond))                         \
+            return OSI_ASYNC_WAIT;           \
+    } while (0)
+
+/**
+ * give up the work queue thread, and continue later
+ */
+#define OSI_ASYNC_YIELD(task)                \
+    do                                       \
+    {                                        \
+        osiAsyncTaskSetLine(task, __LINE__); \
+        osiAsyncTaskWake(task);              \
+        return OSI_ASYNC_WAIT;               \
+    case __LINE__:;                          \
+    } while (0)
+
+/**
+ * wait an event posted to the async task
+ */
+#define OSI_ASYNC_AWAIT_EVENT(task, event) OSI_ASYNC_AWAIT(task, osiAsyncTaskGetEvent(task, event))
+
+/**
+ * wait for \p ms milliseconds
+ */
+#define OSI_ASYNC_SLEEP(task, ms)                           \
+    do                                                      \
+    {                                                       \
+        osiAsyncTaskSetTimeout(task, ms);                   \
+        OSI_ASYNC_AWAIT(task, osiAsyncTaskIsTimeout(task)); \
+    } while (0)
+
+/**
+ * wait until \p cond is true, or timeout
+ *
+ * After wait, \p osiAsyncTaskIsTimeout can tell the reason.
+ */
+#define OSI_ASYNC_AWAIT_TIMEOUT(task, cond, ms)                       \
+    do                                                                \
+    {                                                                 \
+        osiAsyncTaskSetTimeout(task, ms);                             \
+        OSI_ASYNC_AWAIT(task, (cond) || osiAsyncTaskIsTimeout(task)); \
+        osiAsyncTaskStopTimeout(task);                                \
+    } while (0)
+
+/**
+ * wait until \p cond is true, \p cond is checked every \p interval
+ * milliseconds. It is for conditions without wakeup notification, such
+ * as socket readiness by select with zero timeout.
+ */
+#define OSI_ASYNC_AWAIT_POLL(task, cond, interval) \
+    do                                             \
+    {                                              \
+        while (!(cond))                            \
+            OSI_ASYNC_SLEEP(task, interval);       \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,151 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _OSI_BOOT_H_
+#define _OSI_BOOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "osi_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief boot markers
+ *
+ * Boot markers record the time of boot stages, by the hardware up time
+ * in microseconds. The hardware timer starts at power on, so the first
+ * marker includes the time of ROM and bootloader.
+ *
+ * A marker can be a point, by \p osiBootMark, or a span by
+ * \p osiBootMarkBegin and \p osiBootMarkEnd. At most
+ * \p OSI_BOOT_MARK_COUNT markers are recorded, and later ones are ignored.
+ *
+ * The name of marker is not copied, it should be a constant string.
+ */
+
+/** maximum recorded boot markers */
+#define OSI_BOOT_MARK_COUNT (64)
+
+/**
+ * \brief boot marker
+ */
+typedef struct
+{
+    const char *name; ///< marker name
+    uint32_t start;   ///< start up time in us
+    uint32_t end;     ///< end up time in us, the same as start for point
+} osiBootMark_t;
+
+/**
+ * \brief record a point boot marker
+ *
+ * \param name      marker name, constant string
+ */
+void osiBootMark(const char *name);
+
+/**
+ * \brief begin a span boot marker
+ *
+ * \param name      marker name, constant string
+ * \return
+ *      - marker index, for \p osiBootMarkEnd
+ *      - -1 if there are no room
+ */
+int osiBootMarkBegin(const char *name);
+
+/**
+ * \brief end a span boot marker
+ *
+ * \param index     marker index returned by \p osiBootMarkBegin
+ */
+void osiBootMarkEnd(int index);
+
+/**
+ * \brief get recorded boot markers
+ *
+ * \param marks     output markers, can be NULL to get the count
+ * \param count     maximum count of \p marks
+ * \return
+ *      - count of recorded markers, or filled in \p marks
+ */
+unsigned osiBootMarkGet(osiBootMark_t *marks, unsigned count);
+
+/**
+ * \brief output recorded boot markers to trace
+ */
+void osiBootMarkDump(void);
+
+/**
+ * @brief parallel boot initialization
+ *
+ * Independent initializations can be executed concurrently, to shorten
+ * boot time. The initializations are described as an array, and the
+ * dependencies are bit mask of indices in the array. An initialization
+ * is started after all of its dependencies are finished.
+ *
+ * \code{.cpp}
+ * enum { INIT_SDCARD, INIT_AUDIO, INIT_TTS, INIT_COUNT };
+ * static const osiBootInit_t inits[INIT_COUNT] = {
+ *     [INIT_SDCARD] = {"sdcard", prvMountSdcard},
+ *     [INIT_AUDIO] = {"audio", prvAudioInit},
+ *     [INIT_TTS] = {"tts", prvTtsInit, NULL, (1 << INIT_AUDIO)},
+ * };
+ * osiBootInitRun(inits, INIT_COUNT, 2);
+ * \endcode
+ *
+ * Each initialization is recorded as span boot marker.
+ */
+
+/** maximum initializations in one run */
+#define OSI_BOOT_INIT_COUNT (32)
+
+/**
+ * \brief boot initialization descriptor
+ */
+typedef struct
+{
+    const char *name;   ///< name, also used as boot marker name
+    osiCallback_t init; ///< initialization function, NULL for nothing
+    void *param;        ///< parameter of \p init
+    uint32_t deps;      ///< bit mask of indices of dependencies
+} osiBootInit_t;
+
+/**
+ * \brief run boot initializations
+ *
+ * The initializations are executed in a temporal work queue with
+ * \p thread_count threads, and it will return after all of them are
+ * finished.
+ *
+ * When the dependencies are invalid, such as cyclic dependencies or
+ * indices out of range, nothing will be executed and return false.
+ * When the work queue can't be created, the initializations will be
+ * executed in caller thread, in dependency order.
+ *
+ * \param inits         initialization descriptor array
+ * \param count         initialization count, not larger than
+ *                      \p OSI_BOOT_INIT_COUNT
+ * \param thread_count  concurrent initialization count
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool osiBootInitRun(const osiBootInit_t *inits, unsigned count, unsigned thread_count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -70,6 +70,15 @@
                                    : "memory")
 #endif
 
+// host build, for running portable modules on PC
+#if !defined(__arm__) && !defined(__mips__)
+#define OSI_NO_MIPS16
+#define OSI_NAKED
+#define OSI_DMB() __sync_synchronize()
+#define OSI_DSB() __sync_synchronize()
+#define OSI_ISB() __sync_synchronize()
+#endif
+
 // macro maybe helpful for compiler optimization
 #define OSI_LIKELY(x) __builtin_expect(!!(x), 1)
 #define OSI_UNLIKELY(x) __builtin_expect(!!(x), 0)
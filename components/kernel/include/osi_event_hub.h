@@ -60,6 +60,22 @@ typedef void (*osiEventCallback_t)(void *ctx, const osiEvent_t *event);
  */
 osiEventHub_t *osiEventHubCreate(size_t depth);
 
+/**
+ * @brief create an event hub with hash table
+ *
+ * It is the same as \p osiEventHubCreate, except registrations are kept
+ * in an open addressing hash table rather than sorted array. Register and
+ * dispatch time won't increase with registry count, and the memory is
+ * about 2 times of \p depth. It is suitable for hubs with lots of
+ * registrations.
+ *
+ * @param depth     maximum registry count
+ * @return
+ *      - event hub pointer
+ *      - NULL if out of memory
+ */
+osiEventHub_t *osiEventHubCreateHash(size_t depth);
+
 /**
  * @brief delete the event hub
  *
@@ -92,6 +108,10 @@ bool osiEventHubRegister(osiEventHub_t *p, uint32_t id, osiEventHandler_t handle
  * The variadic parameters are pairs of (id, handler), and ended
  * with id of zero.
  *
+ * The registry is sorted once after all pairs are registered. So, it is
+ * faster than calling \p osiEventHubRegister one by one. When it fails
+ * in the middle, the pairs before are registered.
+ *
  * @param p         the event hub, must be valid
  * @param id        registered event ID
  * @return
@@ -129,6 +149,25 @@ bool osiEventHubVBatchRegister(osiEventHub_t *p, uint32_t id, va_list args);
  */
 bool osiEventHubRun(osiEventHub_t *p, const osiEvent_t *event);
 
+/**
+ * @brief dispatch all pending events of the thread
+ *
+ * Events already in the event queue of \p thread are taken out, and
+ * dispatched one after another. It won't wait for new events. Events not
+ * registered in the hub are passed to
+ * \p unhandled. System events (ID 0 after processed) are ignored.
+ *
+ * It is typically called by the thread itself, after the first event is
+ * processed, to handle burst of events in one pass.
+ *
+ * @param p         the event hub, must be valid
+ * @param thread    thread of the event queue, can't be NULL
+ * @param unhandled handler of unregistered events, can be NULL
+ * @return
+ *      - count of events taken from the event queue
+ */
+unsigned osiEventHubRunBatch(osiEventHub_t *p, osiThread_t *thread, osiEventHandler_t unhandled);
+
 /**
  * @brief create an event hdispatch
  *
@@ -57,6 +57,20 @@ typedef struct
     //! @endcond
 } osiHdlcDecode_t;
 
+/**
+ * \brief hdlc streaming encoding data struct
+ */
+typedef struct
+{
+    //! @cond Doxygen_Suppress
+    const osiBuffer_t *bufs;
+    unsigned count;
+    unsigned index;
+    unsigned offset;
+    unsigned state;
+    //! @endcond
+} osiHdlcEncodeStream_t;
+
 /**
  * \brief initialize hdlc decoding
  *
@@ -176,5 +190,37 @@ int osiHdlcEncodeMultiLen(const osiBuffer_t *bufs, unsigned count);
  */
 int osiHdlcEncodeMulti(void *dst, const osiBuffer_t *bufs, unsigned count);
 
+/**
+ * \brief initialize hdlc streaming encoding
+ *
+ * Streaming encoding outputs the same stream as \p osiHdlcEncodeMulti,
+ * but in pieces of limited size. It is for large packet, which is not
+ * needed to be encoded into one large buffer.
+ *
+ * \p bufs will be accessed in \p osiHdlcEncodeStreamPart, and they should
+ * be valid until the whole stream is encoded.
+ *
+ * \param s hdlc streaming encoder, must be valid
+ * \param bufs buffer array
+ * \param count buffer count
+ */
+void osiHdlcEncodeStreamInit(osiHdlcEncodeStream_t *s, const osiBuffer_t *bufs, unsigned count);
+
+/**
+ * \brief hdlc encoding the next piece of stream
+ *
+ * Escaped byte pair won't be split, so the output size may be less than
+ * \p size by 1 byte even the stream is not finished.
+ *
+ * \param s hdlc streaming encoder, must be valid
+ * \param dst output buffer, must be valid
+ * \param size output buffer size, must be at least 2
+ * \return
+ *      - encoded size of this piece
+ *      - 0 when the whole stream is encoded
+ *      - -1 on error, invalid parameter
+ */
+int osiHdlcEncodeStreamPart(osiHdlcEncodeStream_t *s, void *dst, unsigned size);
+
 OSI_EXTERN_C_END
 #endif
@@ -216,6 +216,116 @@ enum
  */
 void osiTraceVprintf(unsigned tag, const char *fmt, va_list ap);
 
+/**
+ * \brief trace statistics of a tag with runtime level
+ */
+typedef struct
+{
+    unsigned tag;       ///< trace tag, without level
+    unsigned level;     ///< runtime level of the tag
+    uint32_t emitted;   ///< count of traces passed the runtime level
+    uint32_t dropped;   ///< count of traces dropped by the runtime level
+    uint32_t throttled; ///< count of traces dropped by the budget sampling
+} osiLogTagStat_t;
+
+/**
+ * \brief set runtime trace level of a tag
+ *
+ * Traces of the tag with level larger than \p level will be dropped,
+ * before the arguments are evaluated. Also traces of the tag are counted,
+ * and the counters can be got by \p osiLogTagStat. To count the traces
+ * of a tag only, \p OSI_LOG_LEVEL_VERBOSE can be used.
+ *
+ * Runtime level can't enable traces disabled by \p OSI_LOCAL_LOG_LEVEL, for
+ * they are removed at compile time.
+ *
+ * When the level of the tag is already set, the level is changed and the
+ * counters are kept. Tags without runtime level aren't affected.
+ *
+ * It is only available when \p CONFIG_KERNEL_LOG_TAG_FILTER_COUNT is
+ * defined.
+ *
+ * @param tag       trace tag, such as \p LOG_TAG_NET
+ * @param level     maximum trace level to be output
+ * @return
+ *      - true on success
+ *      - false on invalid parameter, or there are no room for more tags
+ */
+bool osiLogSetTagLevel(unsigned tag, unsigned level);
+
+/**
+ * \brief remove runtime trace level of a tag
+ *
+ * @param tag       trace tag
+ */
+void osiLogRemoveTagLevel(unsigned tag);
+
+/**
+ * \brief set trace budget of a tag
+ *
+ * Traces of the tag passed the runtime level are limited by a token
+ * bucket, refilled at \p rate traces per second up to \p burst. When the
+ * tag exceeds the budget, 1 in N traces are kept. N starts from 2, and is
+ * doubled (up to 64) after each second over budget, and halved after each
+ * second within budget. Once per second, the count of dropped traces is
+ * output in-band, as a warning trace of the tag itself.
+ *
+ * When the tag hasn't runtime level, \p OSI_LOG_LEVEL_VERBOSE is set. The
+ * budget is removed when \p rate is 0, and the runtime level is kept.
+ *
+ * It is only available when \p CONFIG_KERNEL_LOG_TAG_FILTER_COUNT is
+ * defined.
+ *
+ * @param tag       trace tag, such as \p LOG_TAG_NET
+ * @param rate      traces per second, 0 to remove the budget
+ * @param burst     maximum traces in burst, 0 for the same as \p rate
+ * @return
+ *      - true on success
+ *      - false on invalid parameter, or there are no room for more tags
+ */
+bool osiLogSetTagBudget(unsigned tag, unsigned rate, unsigned burst);
+
+/**
+ * \brief get trace statistics of tags with runtime level
+ *
+ * @param stat      statistics output, can be NULL to get the count
+ * @param count     maximum count of \p stat
+ * @param reset     clear the counters after they are got
+ * @return
+ *      - count of tags with runtime level, or filled in \p stat
+ */
+unsigned osiLogTagStat(osiLogTagStat_t *stat, unsigned count, bool reset);
+
+/**
+ * \brief application trace sink
+ *
+ * \p tag is packed trace tag and trace level. Bit 31 of \p tag is set when
+ * the trace uses format ID, and then the first 4 bytes of data is format
+ * ID. Otherwise, the data starts with the 4 bytes aligned format string.
+ * Parameters follow, in the same layout as trace output.
+ *
+ * @param param     sink parameter
+ * @param tag       packed trace tag and trace level, with format ID flag
+ * @param bufs      trace data pieces, after trace header
+ * @param count     trace data piece count
+ */
+typedef void (*osiTraceSink_t)(void *param, unsigned tag, const osiBuffer_t *bufs, unsigned count);
+
+/**
+ * \brief set application trace sink
+ *
+ * Besides trace output, each application trace will be delivered to the
+ * sink, such as on-device log storage. The sink is called inside critical
+ * section, and maybe in ISR. So, it should only copy the data and return
+ * quickly.
+ *
+ * Only one sink is supported, and NULL \p sink will remove the sink.
+ *
+ * @param sink      trace sink, NULL to remove sink
+ * @param param     sink parameter
+ */
+void osiTraceSetSink(osiTraceSink_t sink, void *param);
+
 #include "osi_log_imp.h"
 
 OSI_EXTERN_C_END
@@ -93,10 +93,22 @@ extern int printf(const char *format, ...);
 #else
 #define __OSI_LOG_DISABLE_ID 0
 #endif
+
+// Checked at call site, before arguments are evaluated. Tags with
+// runtime level are checked only when there are any.
+extern bool gTraceEnabled;
+#ifdef CONFIG_KERNEL_LOG_TAG_FILTER_COUNT
+extern unsigned gLogTagFilterCount;
+bool osiLogTagFilter(unsigned tag);
+#define __OSI_LOG_RUNTIME_EN(tag) (gTraceEnabled && (gLogTagFilterCount == 0 || osiLogTagFilter(tag)))
+#else
+#define __OSI_LOG_RUNTIME_EN(tag) (gTraceEnabled)
+#endif
+
 #define __OSI_LOGB(level, fmtid, fmt, ...)                                                                             \
     do                                                                                                                 \
     {                                                                                                                  \
-        if (OSI_LOCAL_LOG_LEVEL >= level)                                                                              \
+        if (OSI_LOCAL_LOG_LEVEL >= level && __OSI_LOG_RUNTIME_EN((level << 28) | (OSI_LOCAL_LOG_TAG)))                 \
         {                                                                                                              \
             if ((fmtid) == 0 || __OSI_LOG_DISABLE_ID)                                                                  \
                 __OSI_LOGB_IMP((level << 28) | (OSI_LOCAL_LOG_TAG), OSI_VA_NARGS(__VA_ARGS__), fmt, ##__VA_ARGS__);    \
@@ -108,7 +120,8 @@ extern int printf(const char *format, ...);
 #define __OSI_LOGX(level, partype, fmtid, fmt, ...)                                                  \
     do                                                                                               \
     {                                                                                                \
-        if (OSI_LOCAL_LOG_LEVEL >= level)                                                            \
+        if (OSI_LOCAL_LOG_LEVEL >= level &&                                                          \
+            __OSI_LOG_RUNTIME_EN((level << 28) | (OSI_LOCAL_LOG_TAG)))                               \
         {                                                                                            \
             if ((fmtid) == 0 || __OSI_LOG_DISABLE_ID)                                                \
                 __OSI_LOGX_IMP((level << 28) | (OSI_LOCAL_LOG_TAG), partype, fmt, ##__VA_ARGS__);    \
@@ -119,7 +132,8 @@ extern int printf(const char *format, ...);
 #define __OSI_PRINTF(level, fmt, ...)                                                \
     do                                                                               \
     {                                                                                \
-        if (OSI_LOCAL_LOG_LEVEL >= level)                                            \
+        if (OSI_LOCAL_LOG_LEVEL >= level &&                                          \
+            __OSI_LOG_RUNTIME_EN((level << 28) | (OSI_LOCAL_LOG_TAG)))               \
             osiTracePrintf((level << 28) | (OSI_LOCAL_LOG_TAG), fmt, ##__VA_ARGS__); \
     } while (0)
 
@@ -306,6 +306,364 @@ void osiFree(void *ptr);
  */
 bool osiMemPoolStat(osiMemPool_t *pool, osiMemPoolStat_t *stat);
 
+/**
+ * allocation site of memory tracker
+ */
+typedef struct
+{
+    uint32_t caller; ///< caller address, 0 for sites not distinguished
+    uint32_t size;   ///< total size of sampled live blocks
+    uint32_t count;  ///< count of sampled live blocks
+} osiMemTrackSite_t;
+
+/**
+ * set sampling rate of memory tracker
+ *
+ * Memory tracker records caller and size of live blocks, to find which
+ * callers hold the most memory. One of every \p rate allocations is
+ * sampled. Tracked allocations are \p osiSlabMalloc and \p osiSlabCalloc,
+ * and memory allocators may call \p osiMemTrackAlloc and
+ * \p osiMemTrackFree directly.
+ *
+ * Records are cleared at setting. It takes effect only when
+ * CONFIG_KERNEL_MEM_TRACK_COUNT is defined, which is the record count.
+ * When the records are full, samples are dropped.
+ *
+ * @param rate      sampling rate, 0 to disable
+ */
+void osiMemTrackSetRate(unsigned rate);
+
+/**
+ * get sampling rate of memory tracker
+ *
+ * @return  sampling rate, 0 for disabled
+ */
+unsigned osiMemTrackRate(void);
+
+/**
+ * record an allocation in memory tracker
+ *
+ * It can be called in ISR.
+ *
+ * @param ptr       allocated pointer, NULL is ignored
+ * @param size      requested size
+ * @param caller    caller address
+ */
+void osiMemTrackAlloc(const void *ptr, size_t size, const void *caller);
+
+/**
+ * remove an allocation from memory tracker
+ *
+ * It can be called in ISR. Pointers not sampled are ignored.
+ *
+ * @param ptr       pointer to be freed
+ */
+void osiMemTrackFree(const void *ptr);
+
+/**
+ * get allocation sites holding the most memory
+ *
+ * Records are scanned in pieces with interrupt disabled, so the result is
+ * an approximate snapshot.
+ *
+ * @param sites     output allocation sites, sorted by size
+ * @param count     maximum site count
+ * @return  site count
+ */
+unsigned osiMemTrackTopSites(osiMemTrackSite_t *sites, unsigned count);
+
+/**
+ * dump memory tracker and free memory information
+ *
+ * The dump format, all in little endian:
+ * - (2) sampling rate
+ * - (2) site count, at most 16
+ * - (12 each) site caller, size and count, sorted by size
+ * - (4) available size of default pool
+ * - (4) maximum allocatable block size of default pool
+ * - (2) slab class count
+ * - (8 each) slab class block size and free block count
+ *
+ * When \p mem is NULL, return the needed memory size.
+ *
+ * @param mem       memory for dump
+ * @param size      memory size
+ * @return
+ *      - dump size
+ *      - -1 if memory size is not enough
+ */
+int osiMemTrackDump(void *mem, unsigned size);
+
+/**
+ * memory budget components
+ *
+ * Allocations of a component are accounted to its budget, by
+ * \p osiMemBudgetMalloc or \p osiMemBudgetCharge of the component wrapper.
+ */
+typedef enum
+{
+    OSI_MEM_BUDGET_OTHER, ///< not belonging to other components
+    OSI_MEM_BUDGET_LVGL,  ///< littlevgl
+    OSI_MEM_BUDGET_LWIP,  ///< lwip heap, including pbuf
+    OSI_MEM_BUDGET_TLS,   ///< mbedtls
+    OSI_MEM_BUDGET_AUDIO, ///< audio pipes and codecs
+    OSI_MEM_BUDGET_APP,   ///< application threads
+    OSI_MEM_BUDGET_COUNT, ///< count of components
+} osiMemBudgetId_t;
+
+/**
+ * memory budget statistics of a component
+ */
+typedef struct
+{
+    uint32_t used;           ///< accounted size
+    uint32_t peak;           ///< high water mark of accounted size
+    uint32_t count;          ///< accounted block count
+    uint32_t soft_limit;     ///< soft limit, 0 for no limit
+    uint32_t hard_limit;     ///< hard limit, 0 for no limit
+    uint32_t pressure_count; ///< times of pressure callback
+    uint32_t fail_count;     ///< allocations failed by hard limit
+} osiMemBudgetStat_t;
+
+/**
+ * pressure callback of memory budget
+ *
+ * It is called in the context of allocation, which may be other thread
+ * or ISR. So, it should only notify the owner to release memory, such as
+ * \p osiThreadCallback.
+ *
+ * @param ctx       context of the callback
+ * @param id        the component
+ * @param need      size over the limit
+ */
+typedef void (*osiMemBudgetCallback_t)(void *ctx, osiMemBudgetId_t id, size_t need);
+
+/**
+ * set limits of memory budget
+ *
+ * When accounted size crosses soft limit, pressure callback is called once,
+ * and again after the size drops below soft limit. Allocation over hard
+ * limit will fail. Before failure, pressure callback is called, and
+ * allocation is retried once, for callbacks which can release memory
+ * directly.
+ *
+ * It takes effect only when CONFIG_KERNEL_MEM_BUDGET is defined.
+ *
+ * @param id        the component
+ * @param soft      soft limit in bytes, 0 for no limit
+ * @param hard      hard limit in bytes, 0 for no limit
+ * @return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool osiMemBudgetSetLimit(osiMemBudgetId_t id, uint32_t soft, uint32_t hard);
+
+/**
+ * set pressure callback of memory budget
+ *
+ * @param id        the component
+ * @param cb        pressure callback, NULL to remove
+ * @param ctx       context of the callback
+ * @return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool osiMemBudgetSetCallback(osiMemBudgetId_t id, osiMemBudgetCallback_t cb, void *ctx);
+
+/**
+ * account a block to memory budget
+ *
+ * It is for component allocators, which know the size at free. Invalid
+ * \p id is regarded as \p OSI_MEM_BUDGET_OTHER.
+ *
+ * @param id        the component
+ * @param size      block size
+ * @return
+ *      - true on success
+ *      - false if hard limit will be exceeded
+ */
+bool osiMemBudgetCharge(osiMemBudgetId_t id, size_t size);
+
+/**
+ * remove a block from memory budget
+ *
+ * @param id        the component
+ * @param size      block size, the same as \p osiMemBudgetCharge
+ */
+void osiMemBudgetUncharge(osiMemBudgetId_t id, size_t size);
+
+/**
+ * allocate memory accounted to memory budget
+ *
+ * Memory is allocated by \p osiSlabMalloc, and the allocated size is
+ * accounted. The memory must be freed by \p osiMemBudgetFree with the
+ * same \p id.
+ *
+ * @param id        the component
+ * @param size      size to be allocated
+ * @return
+ *      - allocated memory pointer on success
+ *      - NULL at failure, or hard limit will be exceeded
+ */
+void *osiMemBudgetMalloc(osiMemBudgetId_t id, size_t size);
+
+/**
+ * allocate memory accounted to memory budget, and clear to zero
+ *
+ * @param id        the component
+ * @param nmemb     member count to be allocated
+ * @param size      size of each member
+ * @return
+ *      - allocated memory pointer on success
+ *      - NULL at failure, or hard limit will be exceeded
+ */
+void *osiMemBudgetCalloc(osiMemBudgetId_t id, size_t nmemb, size_t size);
+
+/**
+ * free memory allocated by \p osiMemBudgetMalloc
+ *
+ * @param id        the component
+ * @param ptr       pointer to be freed, NULL is ignored
+ */
+void osiMemBudgetFree(osiMemBudgetId_t id, void *ptr);
+
+/**
+ * get memory budget statistics
+ *
+ * @param id        the component
+ * @param stat      output statistics
+ * @return
+ *      - true on success
+ *      - false on invalid parameter, or memory budget isn't enabled
+ */
+bool osiMemBudgetStat(osiMemBudgetId_t id, osiMemBudgetStat_t *stat);
+
+/**
+ * reset high water mark of memory budget to current size
+ *
+ * @param id        the component
+ */
+void osiMemBudgetResetPeak(osiMemBudgetId_t id);
+
+/**
+ * memory report entry
+ *
+ * The first entry is the default pool, and the others are memory budget
+ * components in order of \p osiMemBudgetId_t. For the default pool,
+ * \p used is the size not available, and \p peak is the maximum of
+ * sampled \p used, sampled at report and by pressure monitor.
+ *
+ * Pool fields are for components with their own pool, set by
+ * \p osiMemReportSetPool. Fragmentation index is the percentage of
+ * available size can't be allocated in one block, that is
+ * `100 - max_block_size * 100 / avail_size`.
+ */
+typedef struct
+{
+    const char *name;        ///< entry name
+    uint32_t used;           ///< size in use
+    uint32_t peak;           ///< high water mark of size in use
+    uint32_t pool_size;      ///< pool total size, 0 for no own pool
+    uint32_t avail_size;     ///< available size of the pool
+    uint32_t max_block_size; ///< maximum allocatable block size of the pool
+    uint32_t frag;           ///< fragmentation index in percent
+} osiMemReportEntry_t;
+
+/**
+ * set the own pool of memory budget component for memory report
+ *
+ * @param id        the component
+ * @param pool      the pool, NULL to remove
+ * @return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool osiMemReportSetPool(osiMemBudgetId_t id, osiMemPool_t *pool);
+
+/**
+ * get memory report
+ *
+ * @param entries   output entries
+ * @param count     maximum entry count, OSI_MEM_BUDGET_COUNT + 1 for all
+ * @return  entry count
+ */
+unsigned osiMemReport(osiMemReportEntry_t *entries, unsigned count);
+
+/**
+ * dump memory report
+ *
+ * The dump format, all in little endian:
+ * - (4) low available size threshold of pressure monitor
+ * - (4) low block size threshold of pressure monitor
+ * - (4) pressure count
+ * - (2) entry count
+ * - (32 each) entry name in 8 bytes padded with zero, used, peak,
+ *   pool size, available size, maximum block size and fragmentation
+ *   index
+ *
+ * When \p mem is NULL, return the needed memory size.
+ *
+ * @param mem       memory for dump
+ * @param size      memory size
+ * @return
+ *      - dump size
+ *      - -1 if memory size is not enough
+ */
+int osiMemReportDump(void *mem, unsigned size);
+
+/**
+ * memory pressure callback
+ *
+ * It is called in low priority system work queue. Caches should drop
+ * their contents, or notify the owner thread to drop.
+ *
+ * @param ctx       context of the callback
+ */
+typedef void (*osiMemPressureCallback_t)(void *ctx);
+
+/**
+ * register memory pressure callback
+ *
+ * Pressure monitor checks the default pool periodically, without waking
+ * up the system. When available size or maximum block size drops below
+ * the threshold, callbacks are called once, and again after it recovers
+ * and drops again. Callbacks are also called on allocation failure, see
+ * \p osiMemPressureNotify.
+ *
+ * The monitor is started at the first registration.
+ *
+ * @param cb        pressure callback, can't be NULL
+ * @param ctx       context of the callback
+ * @return
+ *      - true on success
+ *      - false if already registered, or no room
+ */
+bool osiMemPressureRegister(osiMemPressureCallback_t cb, void *ctx);
+
+/**
+ * unregister memory pressure callback
+ *
+ * @param cb        pressure callback
+ * @param ctx       context of the callback
+ */
+void osiMemPressureUnregister(osiMemPressureCallback_t cb, void *ctx);
+
+/**
+ * set thresholds of memory pressure monitor
+ *
+ * @param avail     low threshold of available size, 0 to disable
+ * @param block     low threshold of maximum block size, 0 to disable
+ */
+void osiMemPressureSetThreshold(uint32_t avail, uint32_t block);
+
+/**
+ * notify memory pressure
+ *
+ * It is for allocators at allocation failure. Callbacks will be called
+ * later in work queue. It can be called in ISR.
+ */
+void osiMemPressureNotify(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -161,6 +161,68 @@ int osiPipeRead(osiPipe_t *pipe, void *buf, unsigned size);
  */
 int osiPipeWrite(osiPipe_t *pipe, const void *buf, unsigned size);
 
+/**
+ * \brief get contiguous data in pipe for read without copy
+ *
+ * The returned region starts from the read position, and ends at the
+ * available data or the buffer end. The read position isn't updated, and
+ * \p osiPipeReadConsume should be called after the data are used. When
+ * data wraps around, peek again after consume to get the remaining.
+ *
+ * There should be only one reader between peek and consume.
+ *
+ * \param pipe      the pipe, must be valid
+ * \param buf       output the start of the region
+ * \return
+ *      - the number of contiguous bytes available for read
+ *      - -1 on invalid parameter, or pipe is stopped
+ */
+int osiPipeReadPeek(osiPipe_t *pipe, const void **buf);
+
+/**
+ * \brief release data got by \p osiPipeReadPeek
+ *
+ * Callbacks and wake up are the same as \p osiPipeRead.
+ *
+ * \param pipe      the pipe, must be valid
+ * \param size      the number of bytes used
+ * \return
+ *      - the number of bytes actually released
+ *      - -1 on invalid parameter, or pipe is stopped
+ */
+int osiPipeReadConsume(osiPipe_t *pipe, unsigned size);
+
+/**
+ * \brief get contiguous space in pipe for write without copy
+ *
+ * The returned region starts from the write position, and ends at the
+ * available space or the buffer end. The write position isn't updated,
+ * and \p osiPipeWriteCommit should be called after the data are written.
+ * When space wraps around, reserve again after commit to get the remaining.
+ *
+ * There should be only one writer between reserve and commit.
+ *
+ * \param pipe      the pipe, must be valid
+ * \param buf       output the start of the region
+ * \return
+ *      - the number of contiguous bytes available for write
+ *      - -1 on invalid parameter, or pipe is stopped or eof
+ */
+int osiPipeWriteReserve(osiPipe_t *pipe, void **buf);
+
+/**
+ * \brief commit data written to space got by \p osiPipeWriteReserve
+ *
+ * Callbacks and wake up are the same as \p osiPipeWrite.
+ *
+ * \param pipe      the pipe, must be valid
+ * \param size      the number of bytes written
+ * \return
+ *      - the number of bytes actually committed
+ *      - -1 on invalid parameter, or pipe is stopped or eof
+ */
+int osiPipeWriteCommit(osiPipe_t *pipe, unsigned size);
+
 /**
  * \brief read data from pipe, and wait with timeout
  *
@@ -41,6 +41,24 @@ extern "C" {
 /** profile code for enter/exit WCN sleep */
 #define PROFCODE_WCN_SLEEP 0x3707
 
+/** profile code for waiting GOUDA (LCD) idle */
+#define PROFCODE_LCD_WAIT 0x3708
+
+/** profile code for LittlevGL display refresh */
+#define PROFCODE_GUI_REFR 0x3709
+
+/** profile code for LittlevGL rectangle drawing */
+#define PROFCODE_GUI_DRAW_RECT 0x370a
+
+/** profile code for LittlevGL image drawing */
+#define PROFCODE_GUI_DRAW_IMG 0x370b
+
+/** profile code for LittlevGL label drawing */
+#define PROFCODE_GUI_DRAW_LABEL 0x370c
+
+/** profile code for LittlevGL arc drawing */
+#define PROFCODE_GUI_DRAW_ARC 0x370d
+
 /** flag to indicate exit event */
 #define PROFCODE_EXIT_FLAG 0x8000
 
@@ -134,6 +152,15 @@ void osiProfileThreadEnter(unsigned id);
  */
 void osiProfileThreadExit(unsigned id);
 
+/**
+ * \brief thread is made ready to run
+ *
+ * It is called by FreeRTOS trace hook, for wakeup latency statistics.
+ *
+ * \param id thread id
+ */
+void osiProfileThreadReady(unsigned id);
+
 /**
  * \brief insert a profile ISR entering event
  *
@@ -169,6 +196,125 @@ osiBuffer_t osiProfileLinearBuf(uint32_t pos);
  */
 unsigned osiProfileGetLastest(uint32_t *mem, unsigned size);
 
+/**
+ * \brief start streaming profile data to trace
+ *
+ * New profile data will be put to trace periodically, in host packets of
+ * a dedicated flow ID. Then profile can be captured continuously, and the
+ * host tool \p tools/profile_stream.py converts the capture to Chrome
+ * trace JSON. Profile data overwritten before put to trace are lost, and
+ * the host tool can detect it.
+ *
+ * It is only available with host trace. When it is already started, only
+ * the interval is changed.
+ *
+ * \param interval  streaming interval in milliseconds
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, or not supported
+ */
+bool osiProfileStreamStart(unsigned interval);
+
+/**
+ * \brief stop streaming profile data to trace
+ */
+void osiProfileStreamStop(void);
+
+/**
+ * \brief thread CPU statistics
+ */
+typedef struct
+{
+    unsigned id;             ///< thread number, the same as \p thread_number of osiThreadStatus_t
+    uint64_t run_time_us;    ///< accumulated run time
+    uint32_t switch_count;   ///< count of switched in
+    uint32_t max_latency_us; ///< maximum time from made ready to running
+} osiThreadCpuStat_t;
+
+/**
+ * \brief get thread CPU statistics
+ *
+ * Statistics are accumulated by context switch hooks, with profile tick.
+ * It is only available when \p CONFIG_KERNEL_THREAD_CPU_STAT is enabled.
+ *
+ * \param id       thread number
+ * \param stat     output statistics
+ * \param reset    reset the statistics after get
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, no statistics of the thread, or
+ *        statistics not enabled
+ */
+bool osiThreadCpuStat(unsigned id, osiThreadCpuStat_t *stat, bool reset);
+
+/**
+ * \brief dump thread CPU statistics to memory
+ *
+ * It is for debug only. The data format of the dump is not stable, and
+ * may change. When \p mem is NULL, it will return the estimated dump size.
+ *
+ * \param mem       memory for thread CPU statistics dump
+ * \param size      provided memory size
+ * \return
+ *      - dump memory size
+ *      - -1 if memory size of not enough
+ */
+int osiThreadCpuStatDump(void *mem, unsigned size);
+
+/**
+ * flight recorder event types
+ */
+typedef enum
+{
+    OSI_FLIGHT_NONE,         ///< unused record
+    OSI_FLIGHT_THREAD,       ///< thread switched in, arg0 is thread number
+    OSI_FLIGHT_IRQ_ENTER,    ///< ISR enter, arg0 is interrupt id
+    OSI_FLIGHT_IRQ_EXIT,     ///< ISR exit, arg0 is interrupt id
+    OSI_FLIGHT_WORK,         ///< work run, arg1 is the work run callback
+    OSI_FLIGHT_TIMER,        ///< timer fired, arg1 is the timer callback
+    OSI_FLIGHT_PANIC,        ///< blue screen, arg1 is the caller
+    OSI_FLIGHT_MARK = 0x80,  ///< user marker, arg0 is marker id, arg1 is value
+} osiFlightType_t;
+
+/**
+ * \brief insert a flight recorder event
+ *
+ * Flight recorder is a fixed size ring of binary events, which is always
+ * on and cheap enough to be left in thread switch and ISR paths. Each
+ * record is 3 words: profile tick, (\p type << 24) | (\p arg0 & 0xffffff),
+ * and \p arg1. The latest records are saved in blue screen core, and
+ * \p tools/flight_decode.py can decode them.
+ *
+ * It can be called in ISR. It is only available when
+ * \p CONFIG_KERNEL_FLIGHT_REC_COUNT is defined.
+ *
+ * \param type     event type, \p osiFlightType_t
+ * \param arg0     the first argument, lower 24 bits are recorded
+ * \param arg1     the second argument
+ */
+void osiFlightRecord(unsigned type, uint32_t arg0, uint32_t arg1);
+
+/**
+ * \brief insert a flight recorder user marker
+ *
+ * \param id       marker id, lower 24 bits are recorded
+ * \param value    marker value
+ */
+#define osiFlightMark(id, value) osiFlightRecord(OSI_FLIGHT_MARK, (id), (uint32_t)(value))
+
+/**
+ * \brief get the latest flight recorder records
+ *
+ * The output starts with profile tick frequency (LE32) and total event
+ * count ever recorded (LE32), followed by records from oldest to newest.
+ * Only whole records fitting in \p size are copied.
+ *
+ * \param mem      memory for output
+ * \param size     maximum output size
+ * \return output size, 0 if flight recorder is not available
+ */
+unsigned osiFlightGetLatest(void *mem, unsigned size);
+
 #ifdef __cplusplus
 }
 #endif
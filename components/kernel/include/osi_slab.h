@@ -0,0 +1,127 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _OSI_SLAB_H_
+#define _OSI_SLAB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "kernel_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief size class allocator for small blocks
+ *
+ * Small blocks, up to 512 bytes, are allocated from pages of a static pool
+ * (CONFIG_KERNEL_SLAB_POOL_SIZE). Each page holds blocks of one size class,
+ * and a page is returned to the pool when all its blocks are freed, so any
+ * class can reuse it. Larger blocks, or blocks when the pool is exhausted,
+ * are allocated by \p osiMalloc.
+ *
+ * Small blocks won't fragment the default heap, and the allocation is
+ * a short critical section without heap lock. It can be called in ISR.
+ *
+ * When CONFIG_KERNEL_SLAB_POOL_SIZE isn't defined, all blocks are
+ * allocated by \p osiMalloc.
+ *
+ * Allocations are recorded in memory tracker, see \p osiMemTrackSetRate.
+ */
+
+/**
+ * slab size class statistics
+ */
+typedef struct
+{
+    uint32_t block_size;  ///< block size of the class
+    uint32_t page_count;  ///< pages used by the class
+    uint32_t used_count;  ///< allocated blocks
+    uint32_t peak_count;  ///< peak of allocated blocks
+    uint32_t free_count;  ///< free blocks in pages of the class
+    uint32_t fallback;    ///< allocations by osiMalloc due to pool exhausted
+} osiSlabClassStat_t;
+
+/**
+ * \brief allocate memory
+ *
+ * Refer to malloc(3). The memory must be freed by \p osiSlabFree.
+ *
+ * \param size      size to be allocated
+ * \return
+ *      - allocated memory pointer on success
+ *      - NULL at failure
+ */
+void *osiSlabMalloc(size_t size);
+
+/**
+ * \brief allocate memory and clear to zero
+ *
+ * Refer to calloc(3). The memory must be freed by \p osiSlabFree.
+ *
+ * \param nmemb     member count to be allocated
+ * \param size      size of each member
+ * \return
+ *      - allocated memory pointer on success
+ *      - NULL at failure
+ */
+void *osiSlabCalloc(size_t nmemb, size_t size);
+
+/**
+ * \brief free memory
+ *
+ * Memory not inside slab pool will be freed by \p osiFree. So, it is
+ * safe to free memory allocated by \p osiMalloc.
+ *
+ * \param ptr       pointer to be freed, NULL is ignored
+ */
+void osiSlabFree(void *ptr);
+
+/**
+ * \brief get the allocated size
+ *
+ * For blocks inside slab pool, it is the block size of the class.
+ * Otherwise, it is \p osiMemAllocSize.
+ *
+ * \param ptr       pointer allocated by \p osiSlabMalloc
+ * \return
+ *      - allocated block size
+ *      - 0 if \p ptr is NULL or invalid
+ */
+size_t osiSlabAllocSize(void *ptr);
+
+/**
+ * \brief size class count
+ *
+ * \return
+ *      - size class count
+ *      - 0 if slab pool isn't enabled
+ */
+unsigned osiSlabClassCount(void);
+
+/**
+ * \brief get size class statistics
+ *
+ * \param index     size class index, [0, osiSlabClassCount())
+ * \param stat      output statistics
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool osiSlabClassStat(unsigned index, osiSlabClassStat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,170 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+
+#ifndef _OSI_SPSC_RING_H_
+#define _OSI_SPSC_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "osi_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 单生产者单消费者环形缓冲区
+ *
+ * 只有一个写入方（如中断）和一个读取方（如线程）时，不需要临界区：
+ * 写指针只由写入方更新，读指针只由读取方更新，用 acquire/release
+ * 顺序读写指针即可保证数据可见。
+ *
+ * - 缓冲区大小必须是 2 的幂，偏移用掩码计算
+ * - `rd` 和 `wr` 是逻辑位置，自然回绕
+ * - 可以直接访问连续的数据区域（peek/commit），避免额外拷贝
+ *
+ * @note 多个写入方或多个读取方时，调用者需要自行加锁
+ */
+typedef struct osiSpscRing
+{
+    uint8_t *data;         ///< 缓冲区首地址（调用者分配）
+    uint32_t size;         ///< 缓冲区大小（2 的幂，单位：字节）
+    uint32_t rd;           ///< 读取位置（逻辑位置，只由读取方更新）
+    uint32_t wr;           ///< 写入位置（逻辑位置，只由写入方更新）
+    osiCallback_t notify;  ///< 写入数据后在写入方调用，可以为 NULL
+    void *notify_ctx;      ///< notify 的上下文
+} osiSpscRing_t;
+
+/**
+ * \brief initialize SPSC ring
+ *
+ * \param ring      the ring pointer
+ * \param data      ring buffer
+ * \param size      ring buffer size, must be power of 2
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool osiSpscRingInit(osiSpscRing_t *ring, void *data, size_t size);
+
+/**
+ * \brief set the notify hook of SPSC ring
+ *
+ * The hook is called in producer context each time data are committed,
+ * such as releasing a semaphore to wake up the consumer. It may be called
+ * in ISR, and should be short.
+ *
+ * \param ring      the ring pointer
+ * \param notify    hook, NULL to disable
+ * \param ctx       hook context
+ */
+void osiSpscRingSetNotify(osiSpscRing_t *ring, osiCallback_t notify, void *ctx);
+
+/**
+ * \brief reset SPSC ring
+ *
+ * It should be called when neither producer nor consumer is accessing
+ * the ring.
+ *
+ * \param ring      the ring pointer
+ */
+void osiSpscRingReset(osiSpscRing_t *ring);
+
+/**
+ * \brief byte count in SPSC ring
+ *
+ * \param ring      the ring pointer
+ * \return      the byte count of the ring
+ */
+static inline size_t osiSpscRingBytes(osiSpscRing_t *ring)
+{
+    return __atomic_load_n(&ring->wr, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->rd, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * \brief available space in SPSC ring
+ *
+ * \param ring      the ring pointer
+ * \return      the available space byte count of the ring
+ */
+static inline size_t osiSpscRingSpace(osiSpscRing_t *ring) { return ring->size - osiSpscRingBytes(ring); }
+
+/**
+ * \brief get contiguous space for write, producer only
+ *
+ * The returned region is at most the space to the buffer end. After the
+ * data are written, \p osiSpscRingWriteCommit should be called.
+ *
+ * \param ring      the ring pointer
+ * \param len       output the byte count of the region
+ * \return      the region for write, NULL when the ring is full
+ */
+void *osiSpscRingWritePeek(osiSpscRing_t *ring, size_t *len);
+
+/**
+ * \brief commit written data, producer only
+ *
+ * \param ring      the ring pointer
+ * \param len       byte count written, not larger than the peeked length
+ */
+void osiSpscRingWriteCommit(osiSpscRing_t *ring, size_t len);
+
+/**
+ * \brief get contiguous data for read, consumer only
+ *
+ * The returned region is at most the data to the buffer end. After the
+ * data are used, \p osiSpscRingReadCommit should be called.
+ *
+ * \param ring      the ring pointer
+ * \param len       output the byte count of the region
+ * \return      the region for read, NULL when the ring is empty
+ */
+const void *osiSpscRingReadPeek(osiSpscRing_t *ring, size_t *len);
+
+/**
+ * \brief release read data, consumer only
+ *
+ * \param ring      the ring pointer
+ * \param len       byte count read, not larger than the peeked length
+ */
+void osiSpscRingReadCommit(osiSpscRing_t *ring, size_t len);
+
+/**
+ * \brief put data into SPSC ring, producer only
+ *
+ * The returned actual put size may be less than \a size.
+ *
+ * \param ring      the ring pointer
+ * \param data      data to be put into ring
+ * \param size      data size
+ * \return      actually put size
+ */
+size_t osiSpscRingPut(osiSpscRing_t *ring, const void *data, size_t size);
+
+/**
+ * \brief get data from SPSC ring, consumer only
+ *
+ * The returned actual get size may be less than \a size.
+ *
+ * \param ring      the ring pointer
+ * \param data      data buffer for get
+ * \param size      data buffer size
+ * \return      actually get size
+ */
+size_t osiSpscRingGet(osiSpscRing_t *ring, void *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -240,6 +240,65 @@ uint32_t osiVsmalFindVal(const osiValueStrMap_t *vsmap, const char *str, uint32_
  */
 uint32_t osiVsmalFindIVal(const osiValueStrMap_t *vsmap, const char *str, uint32_t defval);
 
+/**
+ * hashed string index of value-string map
+ *
+ * \p osiVsmapFindByStr and \p osiVsmapFindByIStr search the map
+ * linearly. For maps searched by string frequently, an index can be
+ * declared together with the map, and hash table will be built at the
+ * first search:
+ *
+ * \code{.cpp}
+ * static const osiValueStrMap_t gMap[] = {..., {0, NULL}};
+ * static osiVsmapStrIndex_t gMapIndex = OSI_VSMAP_STR_INDEX_INIT(gMap, true);
+ * \endcode
+ *
+ * The map is not changed, and should be constant after the index is
+ * used. When the hash table can't be allocated, it will fallback to
+ * linear search. When there are duplicated strings, the first one is
+ * found, the same as linear search.
+ */
+typedef struct
+{
+    const osiValueStrMap_t *vsmap; ///< map, ended by NULL of \a str
+    bool icase;                    ///< case insensitive
+    uint16_t *slots;               ///< (internal) hash table
+} osiVsmapStrIndex_t;
+
+/**
+ * static initializer of \p osiVsmapStrIndex_t
+ */
+#define OSI_VSMAP_STR_INDEX_INIT(map, case_insensitive) \
+    {                                                   \
+        .vsmap = (map), .icase = (case_insensitive),    \
+        .slots = NULL,                                  \
+    }
+
+/**
+ * @brief find value by string with hashed index
+ *
+ * It is thread safe, and the hash table can be built in any thread.
+ *
+ * @param index     string index
+ * @param str       string value
+ * @return
+ *      - a map item if found
+ *      - NULL if not found
+ */
+const osiValueStrMap_t *osiVsmapIndexFind(osiVsmapStrIndex_t *index, const char *str);
+
+/**
+ * @brief find value by string with hashed index, with default value
+ *
+ * @param index     string index
+ * @param str       string value
+ * @param defval    default integer value at not found
+ * @return
+ *      - found value
+ *      - \p defval if not found
+ */
+uint32_t osiVsmapIndexFindVal(osiVsmapStrIndex_t *index, const char *str, uint32_t defval);
+
 /**
  * little helper to check wether an unsigned integer in list
  *
@@ -0,0 +1,211 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "osi_async.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <string.h>
+#include <stdlib.h>
+
+struct osiAsyncTask
+{
+    osiWorkQueue_t *wq;
+    osiWork_t *work;
+    osiTimer_t *timer;
+    osiAsyncEntry_t entry;
+    osiCallback_t done;
+    void *ctx;
+    unsigned line;     // resume point
+    bool running;      // in task entry or done callback
+    bool finished;     // task entry returned OSI_ASYNC_DONE
+    bool delete_later; // deleted in task entry or done callback
+    bool timeout;      // the last timeout is expired
+    unsigned ev_rd;
+    unsigned ev_wr;
+    osiEvent_t events[OSI_ASYNC_EVENT_DEPTH];
+};
+
+static void prvAsyncFree(osiAsyncTask_t *task)
+{
+    osiTimerDelete(task->timer);
+    osiWorkDelete(task->work);
+    free(task);
+}
+
+/**
+ * Work of the async task, invoke task entry
+ */
+static void prvAsyncRun(void *param)
+{
+    osiAsyncTask_t *task = (osiAsyncTask_t *)param;
+    if (task->finished)
+        return;
+
+    task->running = true;
+    osiAsyncStatus_t status = task->entry(task, task->ctx);
+    if (status == OSI_ASYNC_DONE && !task->delete_later)
+    {
+        OSI_LOGD(0, "async task %p finished", task);
+        task->finished = true;
+        osiTimerStop(task->timer);
+        if (task->done != NULL)
+            task->done(task->ctx);
+    }
+    task->running = false;
+
+    if (task->delete_later)
+        prvAsyncFree(task);
+}
+
+/**
+ * Timer callback, in timer service thread
+ */
+static void prvAsyncTimeout(void *param)
+{
+    osiAsyncTask_t *task = (osiAsyncTask_t *)param;
+    task->timeout = true;
+    osiAsyncTaskWake(task);
+}
+
+osiAsyncTask_t *osiAsyncTaskCreate(osiWorkQueue_t *wq, osiAsyncEntry_t entry, osiCallback_t done, void *ctx)
+{
+    if (wq == NULL || entry == NULL)
+        return NULL;
+
+    osiAsyncTask_t *task = (osiAsyncTask_t *)calloc(1, sizeof(osiAsyncTask_t));
+    if (task == NULL)
+        return NULL;
+
+    task->work = osiWorkCreate(prvAsyncRun, NULL, task);
+    task->timer = osiTimerCreate(OSI_TIMER_IN_SERVICE, prvAsyncTimeout, task);
+    if (task->work == NULL || task->timer == NULL)
+    {
+        prvAsyncFree(task);
+        return NULL;
+    }
+
+    task->wq = wq;
+    task->entry = entry;
+    task->done = done;
+    task->ctx = ctx;
+    task->finished = true; // not started
+    return task;
+}
+
+void osiAsyncTaskDelete(osiAsyncTask_t *task)
+{
+    if (task == NULL)
+        return;
+
+    if (task->running)
+    {
+        task->delete_later = true;
+        return;
+    }
+
+    prvAsyncFree(task);
+}
+
+bool osiAsyncTaskStart(osiAsyncTask_t *task)
+{
+    if (task->running)
+        return false;
+
+    osiTimerStop(task->timer);
+    uint32_t critical = osiEnterCritical();
+    task->line = 0;
+    task->timeout = false;
+    task->ev_rd = 0;
+    task->ev_wr = 0;
+    task->finished = false;
+    osiExitCritical(critical);
+
+    return osiWorkEnqueue(task->work, task->wq);
+}
+
+void osiAsyncTaskWake(osiAsyncTask_t *task)
+{
+    if (!task->finished)
+        osiWorkEnqueue(task->work, task->wq);
+}
+
+bool osiAsyncTaskIsFinished(osiAsyncTask_t *task)
+{
+    return task->finished;
+}
+
+bool osiAsyncTaskPostEvent(osiAsyncTask_t *task, const osiEvent_t *event)
+{
+    uint32_t critical = osiEnterCritical();
+    if (task->ev_wr - task->ev_rd >= OSI_ASYNC_EVENT_DEPTH)
+    {
+        osiExitCritical(critical);
+        OSI_LOGW(0, "async task %p event queue full, drop event %d", task, event->id);
+        return false;
+    }
+
+    task->events[task->ev_wr % OSI_ASYNC_EVENT_DEPTH] = *event;
+    task->ev_wr++;
+    osiExitCritical(critical);
+
+    osiAsyncTaskWake(task);
+    return true;
+}
+
+void osiAsyncTaskEventCallback(void *ctx, const osiEvent_t *event)
+{
+    osiAsyncTaskPostEvent((osiAsyncTask_t *)ctx, event);
+}
+
+bool osiAsyncTaskGetEvent(osiAsyncTask_t *task, osiEvent_t *event)
+{
+    uint32_t critical = osiEnterCritical();
+    if (task->ev_wr == task->ev_rd)
+    {
+        osiExitCritical(critical);
+        return false;
+    }
+
+    *event = task->events[task->ev_rd % OSI_ASYNC_EVENT_DEPTH];
+    task->ev_rd++;
+    osiExitCritical(critical);
+    return true;
+}
+
+bool osiAsyncTaskSetTimeout(osiAsyncTask_t *task, uint32_t ms)
+{
+    osiTimerStop(task->timer);
+    task->timeout = false;
+    return osiTimerStart(task->timer, ms);
+}
+
+void osiAsyncTaskStopTimeout(osiAsyncTask_t *task)
+{
+    osiTimerStop(task->timer);
+}
+
+bool osiAsyncTaskIsTimeout(osiAsyncTask_t *task)
+{
+    return task->timeout;
+}
+
+unsigned osiAsyncTaskGetLine(osiAsyncTask_t *task)
+{
+    return task->line;
+}
+
+void osiAsyncTaskSetLine(osiAsyncTask_t *task, unsigned line)
+{
+    task->line = line;
+}
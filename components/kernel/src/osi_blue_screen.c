@@ -70,6 +70,9 @@ OSI_NO_RETURN void osiBlueScreen(void *regs)
         ipc_notify_cp_assert();
 #endif
 
+#ifdef CONFIG_KERNEL_FLIGHT_REC_COUNT
+        osiFlightRecord(OSI_FLIGHT_PANIC, 0, (uint32_t)__builtin_return_address(0));
+#endif
         halBlueScreenSaveContext(regs);
         halBlueScreenSaveInfo(regs);
         halBscoreBufSave(regs);
@@ -0,0 +1,271 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "osi_boot.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BOOT_INIT_STACK_SIZE (8192)
+
+typedef struct
+{
+    unsigned count;
+    osiBootMark_t marks[OSI_BOOT_MARK_COUNT];
+} osiBootMarkContext_t;
+
+typedef struct osiBootInitContext osiBootInitContext_t;
+
+typedef struct
+{
+    osiBootInitContext_t *ctx;
+    unsigned index;
+    osiWork_t *work;
+} osiBootInitItem_t;
+
+struct osiBootInitContext
+{
+    const osiBootInit_t *inits;
+    unsigned count;
+    uint32_t started;  // bit mask of started
+    uint32_t finished; // bit mask of finished
+    osiWorkQueue_t *wq;
+    osiSemaphore_t *done_sema;
+    osiBootInitItem_t items[OSI_BOOT_INIT_COUNT];
+};
+
+static osiBootMarkContext_t gBootMarks;
+
+static inline uint32_t prvBootMarkTime(void)
+{
+    return (uint32_t)osiUpTimeUS();
+}
+
+int osiBootMarkBegin(const char *name)
+{
+    uint32_t now = prvBootMarkTime();
+    int index = -1;
+
+    uint32_t critical = osiEnterCritical();
+    if (gBootMarks.count < OSI_BOOT_MARK_COUNT)
+    {
+        index = gBootMarks.count++;
+        osiBootMark_t *m = &gBootMarks.marks[index];
+        m->name = name;
+        m->start = now;
+        m->end = now;
+    }
+    osiExitCritical(critical);
+    return index;
+}
+
+void osiBootMarkEnd(int index)
+{
+    if (index < 0 || index >= OSI_BOOT_MARK_COUNT)
+        return;
+
+    uint32_t now = prvBootMarkTime();
+    uint32_t critical = osiEnterCritical();
+    if ((unsigned)index < gBootMarks.count)
+        gBootMarks.marks[index].end = now;
+    osiExitCritical(critical);
+}
+
+void osiBootMark(const char *name)
+{
+    osiBootMarkBegin(name);
+}
+
+unsigned osiBootMarkGet(osiBootMark_t *marks, unsigned count)
+{
+    if (marks == NULL)
+        return gBootMarks.count;
+
+    uint32_t critical = osiEnterCritical();
+    count = OSI_MIN(unsigned, count, gBootMarks.count);
+    memcpy(marks, gBootMarks.marks, count * sizeof(osiBootMark_t));
+    osiExitCritical(critical);
+    return count;
+}
+
+void osiBootMarkDump(void)
+{
+    static osiBootMark_t marks[OSI_BOOT_MARK_COUNT];
+    unsigned count = osiBootMarkGet(marks, OSI_BOOT_MARK_COUNT);
+    for (unsigned n = 0; n < count; n++)
+    {
+        osiBootMark_t *m = &marks[n];
+        OSI_LOGXI(OSI_LOGPAR_SII, 0, "boot mark %s start/%u duration/%u",
+                  m->name, m->start, m->end - m->start);
+    }
+}
+
+/**
+ * Whether dependencies are valid, by simulating execution in dependency
+ * order. Cyclic dependencies will never be ready.
+ */
+static bool prvBootInitCheck(const osiBootInit_t *inits, unsigned count)
+{
+    uint32_t all = (count == 32) ? 0xffffffff : ((1u << count) - 1);
+    uint32_t finished = 0;
+    for (unsigned n = 0; n < count; n++)
+    {
+        if ((inits[n].deps & ~all) != 0 || (inits[n].deps & (1u << n)) != 0)
+            return false;
+    }
+
+    while (finished != all)
+    {
+        uint32_t ready = 0;
+        for (unsigned n = 0; n < count; n++)
+        {
+            if ((finished & (1u << n)) == 0 && (inits[n].deps & ~finished) == 0)
+                ready |= (1u << n);
+        }
+        if (ready == 0)
+            return false;
+        finished |= ready;
+    }
+    return true;
+}
+
+static void prvBootInitExec(const osiBootInit_t *init)
+{
+    int mark = osiBootMarkBegin(init->name);
+    if (init->init != NULL)
+        init->init(init->param);
+    osiBootMarkEnd(mark);
+}
+
+/**
+ * Start initializations with all dependencies finished.
+ */
+static void prvBootInitStartReady(osiBootInitContext_t *ctx)
+{
+    uint32_t ready = 0;
+    uint32_t critical = osiEnterCritical();
+    for (unsigned n = 0; n < ctx->count; n++)
+    {
+        uint32_t mask = (1u << n);
+        if ((ctx->started & mask) == 0 && (ctx->inits[n].deps & ~ctx->finished) == 0)
+            ready |= mask;
+    }
+    ctx->started |= ready;
+    osiExitCritical(critical);
+
+    for (unsigned n = 0; n < ctx->count; n++)
+    {
+        if (ready & (1u << n))
+            osiWorkEnqueue(ctx->items[n].work, ctx->wq);
+    }
+}
+
+static void prvBootInitWork(void *param)
+{
+    osiBootInitItem_t *item = (osiBootInitItem_t *)param;
+    osiBootInitContext_t *ctx = item->ctx;
+
+    prvBootInitExec(&ctx->inits[item->index]);
+
+    uint32_t all = (ctx->count == 32) ? 0xffffffff : ((1u << ctx->count) - 1);
+    uint32_t critical = osiEnterCritical();
+    ctx->finished |= (1u << item->index);
+    bool done = (ctx->finished == all);
+    osiExitCritical(critical);
+
+    if (done)
+        osiSemaphoreRelease(ctx->done_sema);
+    else
+        prvBootInitStartReady(ctx);
+}
+
+/**
+ * Execute in caller thread, in dependency order.
+ */
+static void prvBootInitRunSerial(const osiBootInit_t *inits, unsigned count)
+{
+    uint32_t finished = 0;
+    for (unsigned round = 0; round < count; round++)
+    {
+        for (unsigned n = 0; n < count; n++)
+        {
+            uint32_t mask = (1u << n);
+            if ((finished & mask) == 0 && (inits[n].deps & ~finished) == 0)
+            {
+                prvBootInitExec(&inits[n]);
+                finished |= mask;
+            }
+        }
+    }
+}
+
+bool osiBootInitRun(const osiBootInit_t *inits, unsigned count, unsigned thread_count)
+{
+    if (inits == NULL || count > OSI_BOOT_INIT_COUNT)
+        return false;
+    if (count == 0)
+        return true;
+    if (!prvBootInitCheck(inits, count))
+    {
+        OSI_LOGE(0, "boot init invalid dependencies");
+        return false;
+    }
+
+    osiBootInitContext_t *ctx = (osiBootInitContext_t *)calloc(1, sizeof(osiBootInitContext_t));
+    if (ctx == NULL)
+        goto serial;
+
+    ctx->inits = inits;
+    ctx->count = count;
+    ctx->done_sema = osiSemaphoreCreate(1, 0);
+    if (ctx->done_sema == NULL)
+        goto failed;
+
+    for (unsigned n = 0; n < count; n++)
+    {
+        osiBootInitItem_t *item = &ctx->items[n];
+        item->ctx = ctx;
+        item->index = n;
+        item->work = osiWorkCreate(prvBootInitWork, NULL, item);
+        if (item->work == NULL)
+            goto failed;
+    }
+
+    ctx->wq = osiWorkQueueCreate("bootinit", OSI_MAX(unsigned, thread_count, 1),
+                                 OSI_PRIORITY_NORMAL, BOOT_INIT_STACK_SIZE);
+    if (ctx->wq == NULL)
+        goto failed;
+
+    prvBootInitStartReady(ctx);
+    osiSemaphoreAcquire(ctx->done_sema);
+
+    // The last work may be still running after semaphore is released,
+    // and it will be deleted after it is finished.
+    osiWorkQueueDelete(ctx->wq);
+    for (unsigned n = 0; n < count; n++)
+        osiWorkDelete(ctx->items[n].work);
+    osiSemaphoreDelete(ctx->done_sema);
+    free(ctx);
+    return true;
+
+failed:
+    for (unsigned n = 0; n < count; n++)
+        osiWorkDelete(ctx->items[n].work);
+    osiSemaphoreDelete(ctx->done_sema);
+    free(ctx);
+
+serial:
+    OSI_LOGW(0, "boot init run in caller thread");
+    prvBootInitRunSerial(inits, count);
+    return true;
+}
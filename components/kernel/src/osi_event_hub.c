@@ -37,6 +37,7 @@ struct osiEventHub
     size_t size;
     size_t count;
     size_t max_count;
+    unsigned hash_bits; // 0 for sorted array, or log2 of hash table size
     osiEventHandlerReg_t *regs;
 };
 
@@ -48,21 +49,82 @@ struct osiEventDispatch
     osiEventCallbackReg_t *regs;
 };
 
-osiEventHub_t *osiEventHubCreate(size_t depth)
+#define HUB_ID_INVALID (0xffffffff)
+
+/**
+ * Find the first registration not less than id in sorted array. The
+ * first member of registration is the id.
+ */
+static size_t _lowerBound(const void *regs, size_t size, size_t count, uint32_t id)
+{
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (*(const uint32_t *)((const char *)regs + mid * size) < id)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static inline unsigned _hashIndex(osiEventHub_t *p, uint32_t id)
+{
+    return (id * 0x9e3779b1U) >> (32 - p->hash_bits);
+}
+
+/**
+ * Find registration in hash table, or the empty one for the id
+ */
+static osiEventHandlerReg_t *_hashSlot(osiEventHub_t *p, uint32_t id)
+{
+    unsigned mask = (1U << p->hash_bits) - 1;
+    for (unsigned index = _hashIndex(p, id);; index = (index + 1) & mask)
+    {
+        osiEventHandlerReg_t *reg = &p->regs[index];
+        if (reg->id == id || reg->id == HUB_ID_INVALID)
+            return reg;
+    }
+}
+
+static osiEventHub_t *_hubCreate(size_t depth, unsigned hash_bits)
 {
-    size_t mem_size = sizeof(osiEventHub_t) + depth * sizeof(osiEventHandlerReg_t);
+    size_t reg_count = (hash_bits == 0) ? depth : (1U << hash_bits);
+    size_t mem_size = sizeof(osiEventHub_t) + reg_count * sizeof(osiEventHandlerReg_t);
     uintptr_t mem = (uintptr_t)calloc(1, mem_size);
     if ((void *)mem == NULL)
         return NULL;
 
     osiEventHub_t *p = (osiEventHub_t *)OSI_PTR_INCR_POST(mem, sizeof(osiEventHub_t));
-    p->regs = (osiEventHandlerReg_t *)OSI_PTR_INCR_POST(mem, depth * sizeof(osiEventHandlerReg_t));
+    p->regs = (osiEventHandlerReg_t *)OSI_PTR_INCR_POST(mem, reg_count * sizeof(osiEventHandlerReg_t));
     p->count = 0;
     p->max_count = 0;
     p->size = depth;
+    p->hash_bits = hash_bits;
+    if (hash_bits != 0)
+    {
+        for (size_t n = 0; n < reg_count; n++)
+            p->regs[n].id = HUB_ID_INVALID;
+    }
     return p;
 }
 
+osiEventHub_t *osiEventHubCreate(size_t depth)
+{
+    return _hubCreate(depth, 0);
+}
+
+osiEventHub_t *osiEventHubCreateHash(size_t depth)
+{
+    // hash table is at most half full
+    unsigned hash_bits = 2;
+    while ((1U << hash_bits) < depth * 2)
+        hash_bits++;
+    return _hubCreate(depth, hash_bits);
+}
+
 void osiEventHubDelete(osiEventHub_t *p)
 {
     free(p);
@@ -72,28 +134,60 @@ static osiEventHandlerReg_t *_findHandler(osiEventHub_t *p, uint32_t id)
 {
     if (p->count == 0)
         return NULL;
+
+    if (p->hash_bits != 0)
+    {
+        osiEventHandlerReg_t *reg = _hashSlot(p, id);
+        return (reg->id == id) ? reg : NULL;
+    }
+
     return (osiEventHandlerReg_t *)bsearch(&id, p->regs, p->count, sizeof(p->regs[0]), osiUintIdCompare);
 }
 
+static bool _hashRegister(osiEventHub_t *p, uint32_t id, osiEventHandler_t handler)
+{
+    osiEventHandlerReg_t *reg = _hashSlot(p, id);
+    if (reg->id != id)
+    {
+        if (p->count >= p->size)
+            return false;
+
+        reg->id = id;
+        p->count++;
+    }
+    reg->handler = handler;
+    return true;
+}
+
 bool osiEventHubRegister(osiEventHub_t *p, uint32_t id, osiEventHandler_t handler)
 {
-    if (p->count >= p->size || id == 0xffffffff)
+    if (id == HUB_ID_INVALID)
         return false;
 
-    osiEventHandlerReg_t *reg = _findHandler(p, id);
-    if (reg != NULL)
+    if (p->hash_bits != 0)
     {
+        if (!_hashRegister(p, id, handler))
+            return false;
+    }
+    else
+    {
+        size_t pos = _lowerBound(p->regs, sizeof(p->regs[0]), p->count, id);
+        osiEventHandlerReg_t *reg = &p->regs[pos];
+        if (pos >= p->count || reg->id != id)
+        {
+            if (p->count >= p->size)
+                return false;
+
+            memmove(reg + 1, reg, (p->count - pos) * sizeof(p->regs[0]));
+            reg->id = id;
+            p->count++;
+        }
         reg->handler = handler;
-        return true;
     }
 
-    p->regs[p->count].id = id;
-    p->regs[p->count].handler = handler;
-    p->count++;
     if (p->count > p->max_count)
         p->max_count = p->count;
 
-    qsort(p->regs, p->count, sizeof(p->regs[0]), osiUintIdCompare);
     OSI_LOGD(0, "ID HUB REG: %d count/%d", id, p->count);
     return true;
 }
@@ -107,28 +201,87 @@ bool osiEventHubBatchRegister(osiEventHub_t *p, uint32_t id, ...)
     return ok;
 }
 
+/**
+ * Merge registrations appended after sorted ones
+ */
+static void _mergeAppended(osiEventHub_t *p, size_t sorted)
+{
+    size_t appended = p->count - sorted;
+    if (appended == 0)
+        return;
+
+    osiEventHandlerReg_t *tail = &p->regs[sorted];
+    qsort(tail, appended, sizeof(p->regs[0]), osiUintIdCompare);
+    if (sorted == 0 || p->regs[sorted - 1].id < tail[0].id)
+        return;
+
+    osiEventHandlerReg_t *tmp = (osiEventHandlerReg_t *)malloc(appended * sizeof(p->regs[0]));
+    if (tmp == NULL)
+    {
+        qsort(p->regs, p->count, sizeof(p->regs[0]), osiUintIdCompare);
+        return;
+    }
+
+    // merge from the end, the appended ones are moved out
+    memcpy(tmp, tail, appended * sizeof(p->regs[0]));
+    size_t i = sorted;
+    size_t j = appended;
+    size_t w = p->count;
+    while (j > 0)
+    {
+        if (i > 0 && p->regs[i - 1].id > tmp[j - 1].id)
+            p->regs[--w] = p->regs[--i];
+        else
+            p->regs[--w] = tmp[--j];
+    }
+    free(tmp);
+}
+
 bool osiEventHubVBatchRegister(osiEventHub_t *p, uint32_t id, va_list ap)
 {
     bool ok = true;
+    size_t sorted = p->count;
     while (id != 0)
     {
-        if (p->count >= p->size || id == 0xffffffff)
+        osiEventHandler_t handler = va_arg(ap, osiEventHandler_t);
+        if (id == HUB_ID_INVALID)
         {
             ok = false;
             break;
         }
 
-        osiEventHandler_t handler = va_arg(ap, osiEventHandler_t);
-        osiEventHandlerReg_t *reg = _findHandler(p, id);
-        if (reg != NULL)
+        if (p->hash_bits != 0)
         {
-            reg->handler = handler;
+            if (!_hashRegister(p, id, handler))
+            {
+                ok = false;
+                break;
+            }
         }
         else
         {
-            p->regs[p->count].id = id;
-            p->regs[p->count].handler = handler;
-            p->count++;
+            // the appended ones are not sorted till the end
+            osiEventHandlerReg_t *reg = NULL;
+            if (sorted > 0)
+                reg = (osiEventHandlerReg_t *)bsearch(&id, p->regs, sorted, sizeof(p->regs[0]), osiUintIdCompare);
+            for (size_t n = sorted; reg == NULL && n < p->count; n++)
+            {
+                if (p->regs[n].id == id)
+                    reg = &p->regs[n];
+            }
+
+            if (reg == NULL)
+            {
+                if (p->count >= p->size)
+                {
+                    ok = false;
+                    break;
+                }
+
+                reg = &p->regs[p->count++];
+                reg->id = id;
+            }
+            reg->handler = handler;
         }
 
         id = va_arg(ap, uint32_t);
@@ -137,7 +290,8 @@ bool osiEventHubVBatchRegister(osiEventHub_t *p, uint32_t id, va_list ap)
     if (p->count > p->max_count)
         p->max_count = p->count;
 
-    qsort(p->regs, p->count, sizeof(p->regs[0]), osiUintIdCompare);
+    if (p->hash_bits == 0)
+        _mergeAppended(p, sorted);
     OSI_LOGD(0, "ID HUB BATCH REG: count/%d", p->count);
     return ok;
 }
@@ -156,6 +310,23 @@ bool osiEventHubRun(osiEventHub_t *p, const osiEvent_t *event)
     return true;
 }
 
+unsigned osiEventHubRunBatch(osiEventHub_t *p, osiThread_t *thread, osiEventHandler_t unhandled)
+{
+    // Only the events already in the queue are taken, so it won't wait.
+    unsigned count = osiEventPendingCount(thread);
+    for (unsigned n = 0; n < count; n++)
+    {
+        osiEvent_t event = {};
+        osiEventWait(thread, &event);
+        if (event.id == 0)
+            continue;
+
+        if (!osiEventHubRun(p, &event) && unhandled != NULL)
+            unhandled(&event);
+    }
+    return count;
+}
+
 osiEventDispatch_t *osiEventDispatchCreate(size_t depth)
 {
     size_t mem_size = sizeof(osiEventDispatch_t) + depth * sizeof(osiEventCallbackReg_t);
@@ -188,18 +359,19 @@ bool osiEventDispatchRegister(osiEventDispatch_t *p, uint32_t id, osiEventCallba
     if (p->count >= p->size || cb == NULL)
         return false;
 
-    osiEventCallbackReg_t *reg = _findCallback(p, id);
-    if (reg != NULL)
+    size_t pos = _lowerBound(p->regs, sizeof(p->regs[0]), p->count, id);
+    osiEventCallbackReg_t *reg = &p->regs[pos];
+    if (pos < p->count && reg->id == id)
         return false;
 
-    p->regs[p->count].id = id;
-    p->regs[p->count].cb = cb;
-    p->regs[p->count].cb_ctx = cb_ctx;
+    memmove(reg + 1, reg, (p->count - pos) * sizeof(p->regs[0]));
+    reg->id = id;
+    reg->cb = cb;
+    reg->cb_ctx = cb_ctx;
     p->count++;
     if (p->count > p->max_count)
         p->max_count = p->count;
 
-    qsort(p->regs, p->count, sizeof(p->regs[0]), osiUintIdCompare);
     OSI_LOGD(0, "ID REG: %d count/%d", id, p->count);
     return true;
 }
@@ -214,9 +386,8 @@ bool osiEventDispatchRun(osiEventDispatch_t *p, const osiEvent_t *event)
         return false;
 
     osiEventCallbackReg_t found = *reg;
-    reg->id = 0xffffffff; // set to maximum value to sort it to the last one
-    qsort(p->regs, p->count, sizeof(p->regs[0]), osiUintIdCompare);
     p->count--;
+    memmove(reg, reg + 1, (&p->regs[p->count] - reg) * sizeof(p->regs[0]));
 
     if (found.cb != NULL)
         found.cb(found.cb_ctx, event);
@@ -0,0 +1,84 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "osi_api.h"
+#include "osi_profile.h"
+#include "osi_internal.h"
+#include "osi_chip.h"
+#include "osi_byte_buf.h"
+#include "hwregs.h"
+#include <assert.h>
+#include <string.h>
+
+#ifdef CONFIG_KERNEL_FLIGHT_REC_COUNT
+
+#define FLIGHT_WORDS (3)
+#define FLIGHT_HEADER_SIZE (8)
+
+static_assert((CONFIG_KERNEL_FLIGHT_REC_COUNT & (CONFIG_KERNEL_FLIGHT_REC_COUNT - 1)) == 0,
+              "CONFIG_KERNEL_FLIGHT_REC_COUNT must be power of 2");
+
+typedef struct
+{
+    uint32_t total; // records ever written, the next position is (total % count)
+    uint32_t records[CONFIG_KERNEL_FLIGHT_REC_COUNT][FLIGHT_WORDS];
+} osiFlightContext_t;
+
+static osiFlightContext_t gFlightCtx;
+
+/**
+ * It is called in thread switch and ISR path, located in SRAM and
+ * without loop or division.
+ */
+void OSI_SECTION_SRAM_TEXT osiFlightRecord(unsigned type, uint32_t arg0, uint32_t arg1)
+{
+    osiFlightContext_t *d = &gFlightCtx;
+    uint32_t flags = osiIrqSave();
+    uint32_t *r = d->records[d->total++ & (CONFIG_KERNEL_FLIGHT_REC_COUNT - 1)];
+    r[0] = HAL_TIMER_CURVAL_LO + (uint32_t)gOsiUpTimeOffset;
+    r[1] = (type << 24) | (arg0 & 0xffffff);
+    r[2] = arg1;
+    osiIrqRestore(flags);
+}
+
+unsigned osiFlightGetLatest(void *mem, unsigned size)
+{
+    if (mem == NULL || size < FLIGHT_HEADER_SIZE)
+        return 0;
+
+    osiFlightContext_t *d = &gFlightCtx;
+    unsigned max_count = (size - FLIGHT_HEADER_SIZE) / (FLIGHT_WORDS * 4);
+
+    uint32_t flags = osiIrqSave();
+    uint32_t total = d->total;
+    unsigned count = OSI_MIN(unsigned, total, CONFIG_KERNEL_FLIGHT_REC_COUNT);
+    count = OSI_MIN(unsigned, count, max_count);
+
+    uint8_t *p = (uint8_t *)mem;
+    OSI_STRM_WLE32(p, CONFIG_KERNEL_HWTICK_FREQ);
+    OSI_STRM_WLE32(p, total);
+    for (uint32_t n = total - count; n != total; n++)
+    {
+        uint32_t *r = d->records[n & (CONFIG_KERNEL_FLIGHT_REC_COUNT - 1)];
+        for (unsigned w = 0; w < FLIGHT_WORDS; w++)
+            OSI_STRM_WLE32(p, r[w]);
+    }
+    osiIrqRestore(flags);
+    return p - (uint8_t *)mem;
+}
+
+#else
+
+void osiFlightRecord(unsigned type, uint32_t arg0, uint32_t arg1) {}
+unsigned osiFlightGetLatest(void *mem, unsigned size) { return 0; }
+
+#endif
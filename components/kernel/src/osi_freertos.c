@@ -16,6 +16,7 @@
 #include "osi_api.h"
 #include "osi_api_inside.h"
 #include "osi_mem.h"
+#include "osi_boot.h"
 #include "osi_internal.h"
 #include "cmsis_core.h"
 #include "FreeRTOS.h"
@@ -55,6 +56,7 @@ uint32_t osiMsToOSTick(uint32_t ms)
 
 OSI_NO_RETURN void osiKernelStart(void)
 {
+    osiBootMark("kernel start");
     osiIrqInit();
     osiTimerInit();
     osiSysWorkQueueInit();
@@ -579,6 +581,9 @@ bool osiEventTryWait(osiThread_t *thread, osiEvent_t *event, uint32_t timeout)
             osiCallback_t cb = (osiCallback_t)event->param1;
             if (cb != NULL)
                 cb((void *)event->param2);  // 调用传入的回调函数，参数为 param2
+            // 同步回调：param3 为等待线程，用任务通知唤醒它
+            if (event->param3 != 0)
+                xTaskNotifyGive((TaskHandle_t)event->param3);
             event->id = OSI_EVENT_ID_NONE;  // 标记事件已处理
         }
         else if (event->id == OSI_EVENT_ID_NOTIFY)
@@ -718,6 +723,46 @@ bool osiThreadCallback(osiThread_t *thread, osiCallback_t cb, void *cb_ctx)
     return osiEventSend(thread, &event);
 }
 
+/**
+ * @brief 在指定线程中执行回调，并等待回调返回
+ *
+ * 回调事件的 param3 为调用线程，目标线程执行回调后用任务通知唤醒它。
+ * 不创建信号量等内核对象，也不分配内存。任务通知在 OSI 中没有其它用途。
+ *
+ * 在目标线程中调用时直接执行回调；不能在中断中调用。
+ *
+ * @param thread 目标线程
+ * @param cb     回调函数
+ * @param cb_ctx 回调函数的上下文
+ *
+ * @return true 表示回调已执行；false 表示参数错误或在中断中调用
+ */
+bool osiThreadCallbackSync(osiThread_t *thread, osiCallback_t cb, void *cb_ctx)
+{
+    if (thread == NULL || cb == NULL || IS_IRQ())
+        return false;
+
+    // 在目标线程中，直接执行，避免等待自己
+    if (thread == osiThreadCurrent())
+    {
+        cb(cb_ctx);
+        return true;
+    }
+
+    osiEvent_t event = {
+        .id     = OSI_EVENT_ID_CALLBACK,
+        .param1 = (uint32_t)cb,
+        .param2 = (uint32_t)cb_ctx,
+        .param3 = (uint32_t)osiThreadCurrent(),
+    };
+
+    if (!osiEventSend(thread, &event))
+        return false;
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return true;
+}
+
 
 osiMutex_t *osiMutexCreate(void)
 {
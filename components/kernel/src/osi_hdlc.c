@@ -22,6 +22,11 @@
 #define OSI_HDLC_DEC_ST_FEED_DATA (0x11)
 #define OSI_HDLC_DEC_ST_ESCAPED (0x12)
 
+#define HDLC_ENC_ST_HEAD (0)
+#define HDLC_ENC_ST_DATA (1)
+#define HDLC_ENC_ST_TAIL (2)
+#define HDLC_ENC_ST_DONE (3)
+
 #define PUSH_BYTE_MASK(ch)          \
     do                              \
     {                               \
@@ -50,19 +55,82 @@
         pos = (pos + 1);   \
     } while (0)
 
-#define PUSH_BYTE_CHECK(ch)                       \
-    do                                            \
-    {                                             \
-        if (ch == HDLC_FLAG || ch == HDLC_ESCAPE) \
-        {                                         \
-            PUSH_BYTE(HDLC_ESCAPE);               \
-            PUSH_BYTE(ch ^ HDLC_ESCAPE_MASK);     \
-        }                                         \
-        else                                      \
-        {                                         \
-            PUSH_BYTE(ch);                        \
-        }                                         \
-    } while (0)
+#define SWAR_ONES (0x01010101U)
+#define SWAR_HIGHS (0x80808080U)
+#define SWAR_HAS_ZERO(w) (((w)-SWAR_ONES) & ~(w)&SWAR_HIGHS)
+#define SWAR_HAS_BYTE(w, ch) SWAR_HAS_ZERO((w) ^ ((ch)*SWAR_ONES))
+
+typedef uint32_t __attribute__((__may_alias__)) hdlcWord_t;
+
+static inline bool prvHdlcIsSpecial(uint8_t ch)
+{
+    return ch == HDLC_FLAG || ch == HDLC_ESCAPE;
+}
+
+/**
+ * count of leading bytes which are neither flag nor escape
+ *
+ * Most of the data is clean, check a word at a time, and the clean
+ * runs can be copied in bulk.
+ */
+OSI_FORCE_INLINE static unsigned prvHdlcCleanLen(const uint8_t *p, unsigned size)
+{
+    const uint8_t *start = p;
+    const uint8_t *end = p + size;
+
+    while (p < end && ((uintptr_t)p & 3) != 0)
+    {
+        if (prvHdlcIsSpecial(*p))
+            return p - start;
+        p++;
+    }
+
+    while (p + 4 <= end)
+    {
+        uint32_t w = *(const hdlcWord_t *)p;
+        if (SWAR_HAS_BYTE(w, HDLC_FLAG) | SWAR_HAS_BYTE(w, HDLC_ESCAPE))
+            break;
+        p += 4;
+    }
+
+    while (p < end && !prvHdlcIsSpecial(*p))
+        p++;
+    return p - start;
+}
+
+OSI_FORCE_INLINE static unsigned prvHdlcEncodeLen(const uint8_t *p, unsigned size)
+{
+    const uint8_t *end = p + size;
+    unsigned enc_size = size;
+    for (;;)
+    {
+        p += prvHdlcCleanLen(p, end - p);
+        if (p >= end)
+            break;
+
+        enc_size++; // escaped
+        p++;
+    }
+    return enc_size;
+}
+
+OSI_FORCE_INLINE static char *prvHdlcEncodeData(char *buf, const uint8_t *p, unsigned size)
+{
+    const uint8_t *end = p + size;
+    for (;;)
+    {
+        unsigned run = prvHdlcCleanLen(p, end - p);
+        memcpy(buf, p, run);
+        buf += run;
+        p += run;
+        if (p >= end)
+            break;
+
+        *buf++ = HDLC_ESCAPE;
+        *buf++ = *p++ ^ HDLC_ESCAPE_MASK;
+    }
+    return buf;
+}
 
 bool osiHdlcDecodeInit(osiHdlcDecode_t *d, void *buf, unsigned size, uint16_t flags)
 {
@@ -94,6 +162,7 @@ bool osiHdlcDecodeChangeBuf(osiHdlcDecode_t *d, void *buf, unsigned size)
     return true;
 }
 
+OSI_ATTRIBUTE_OPTIMIZE(3)
 int osiHdlcDecodePush(osiHdlcDecode_t *d, const void *data, unsigned size)
 {
     if (data == NULL)
@@ -107,8 +176,39 @@ int osiHdlcDecodePush(osiHdlcDecode_t *d, const void *data, unsigned size)
         return 0;
 
     const char *psdata = (const char *)data;
-    for (unsigned n = 0; n < size; n++)
+    const char *pedata = psdata + size;
+    while (psdata < pedata)
     {
+        if (d->state == OSI_HDLC_DEC_ST_FEED_DATA)
+        {
+            // copy clean run in bulk, limited by buffer space. And stop at
+            // diag header, to check the length in diag header.
+            unsigned limit = OSI_MIN(unsigned, pedata - psdata, d->size - d->len);
+            if ((d->flags & OSI_HDLC_DEC_CHECK_DIAG_TOO_LARGE) &&
+                d->len < sizeof(osiDiagPacketHeader_t))
+                limit = OSI_MIN(unsigned, limit, sizeof(osiDiagPacketHeader_t) - d->len);
+
+            unsigned run = prvHdlcCleanLen((const uint8_t *)psdata, limit);
+            if (run > 0)
+            {
+                memcpy(d->buf + d->len, psdata, run);
+                d->len += run;
+                psdata += run;
+
+                if ((d->flags & OSI_HDLC_DEC_CHECK_DIAG_TOO_LARGE) &&
+                    d->len == sizeof(osiDiagPacketHeader_t))
+                {
+                    osiDiagPacketHeader_t *cmd = (osiDiagPacketHeader_t *)d->buf;
+                    if (cmd->len > d->size)
+                    {
+                        d->state = OSI_HDLC_DEC_ST_DIAG_TOO_LARGE;
+                        break;
+                    }
+                }
+                continue;
+            }
+        }
+
         char ch = *psdata++;
         if (d->state == OSI_HDLC_DEC_ST_SEEK_FLAG)
         {
@@ -228,15 +328,7 @@ int osiHdlcEncodeMultiLen(const osiBuffer_t *bufs, unsigned count)
 
     unsigned enc_size = 1;
     for (unsigned n = 0; n < count; n++, bufs++)
-    {
-        uint8_t *pstart = (uint8_t *)bufs->ptr;
-        uint8_t *pend = pstart + bufs->size;
-        while (pstart < pend)
-        {
-            uint8_t ch = *pstart++;
-            enc_size += (ch == HDLC_FLAG || ch == HDLC_ESCAPE) ? 2 : 1;
-        }
-    }
+        enc_size += prvHdlcEncodeLen((const uint8_t *)bufs->ptr, bufs->size);
 
     enc_size++;
     return enc_size;
@@ -253,18 +345,75 @@ int osiHdlcEncodeMulti(void *dst, const osiBuffer_t *bufs, unsigned count)
 
     PUSH_BYTE(HDLC_FLAG);
     for (unsigned n = 0; n < count; n++, bufs++)
+        pos = prvHdlcEncodeData(buf + pos, (const uint8_t *)bufs->ptr, bufs->size) - buf;
+
+    PUSH_BYTE(HDLC_FLAG);
+    return pos;
+}
+
+void osiHdlcEncodeStreamInit(osiHdlcEncodeStream_t *s, const osiBuffer_t *bufs, unsigned count)
+{
+    s->bufs = bufs;
+    s->count = count;
+    s->index = 0;
+    s->offset = 0;
+    s->state = HDLC_ENC_ST_HEAD;
+}
+
+OSI_ATTRIBUTE_OPTIMIZE(3)
+int osiHdlcEncodeStreamPart(osiHdlcEncodeStream_t *s, void *dst, unsigned size)
+{
+    if (s == NULL || dst == NULL || size < 2)
+        return -1;
+
+    char *buf = dst;
+    char *end = buf + size;
+
+    if (s->state == HDLC_ENC_ST_HEAD)
     {
-        const char *psdata = (const char *)bufs->ptr;
-        const char *pedata = psdata + bufs->size;
-        while (psdata < pedata)
+        *buf++ = HDLC_FLAG;
+        s->state = HDLC_ENC_ST_DATA;
+    }
+
+    while (s->state == HDLC_ENC_ST_DATA && buf < end)
+    {
+        if (s->index >= s->count)
         {
-            char ch = *psdata++;
-            PUSH_BYTE_CHECK(ch);
+            s->state = HDLC_ENC_ST_TAIL;
+            break;
+        }
+
+        const osiBuffer_t *b = &s->bufs[s->index];
+        const uint8_t *p = (const uint8_t *)b->ptr + s->offset;
+        unsigned remained = b->size - s->offset;
+        if (remained == 0)
+        {
+            s->index++;
+            s->offset = 0;
+            continue;
+        }
+
+        unsigned run = prvHdlcCleanLen(p, OSI_MIN(unsigned, remained, end - buf));
+        memcpy(buf, p, run);
+        buf += run;
+        s->offset += run;
+        if (run < remained && prvHdlcIsSpecial(p[run]))
+        {
+            if (end - buf < 2)
+                break;
+
+            *buf++ = HDLC_ESCAPE;
+            *buf++ = p[run] ^ HDLC_ESCAPE_MASK;
+            s->offset++;
         }
     }
 
-    PUSH_BYTE(HDLC_FLAG);
-    return pos;
+    if (s->state == HDLC_ENC_ST_TAIL && buf < end)
+    {
+        *buf++ = HDLC_FLAG;
+        s->state = HDLC_ENC_ST_DONE;
+    }
+    return buf - (char *)dst;
 }
 
 OSI_ATTRIBUTE_OPTIMIZE(3)
@@ -273,15 +422,7 @@ int osiHdlcEncodeLen(const void *data, unsigned size)
     if (data == NULL)
         return -1;
 
-    unsigned enc_size = 1;
-    const uint8_t *pstart = (const uint8_t *)data;
-    const uint8_t *pend = pstart + size;
-    while (pstart < pend)
-    {
-        uint8_t ch = *pstart++;
-        enc_size += (ch == HDLC_FLAG || ch == HDLC_ESCAPE) ? 2 : 1;
-    }
-
+    unsigned enc_size = 1 + prvHdlcEncodeLen((const uint8_t *)data, size);
     enc_size++;
     return enc_size;
 }
@@ -296,14 +437,7 @@ int osiHdlcEncode(void *dst, const void *data, unsigned size)
     unsigned pos = 0;
 
     PUSH_BYTE(HDLC_FLAG);
-    const char *psdata = (const char *)data;
-    const char *pedata = psdata + size;
-    while (psdata < pedata)
-    {
-        char ch = *psdata++;
-        PUSH_BYTE_CHECK(ch);
-    }
-
+    pos = prvHdlcEncodeData(buf + pos, (const uint8_t *)data, size) - buf;
     PUSH_BYTE(HDLC_FLAG);
     return pos;
 }
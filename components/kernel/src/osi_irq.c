@@ -11,12 +11,16 @@
  */
 
 #include "osi_api.h"
+#include "osi_api_inside.h"
 #include "osi_log.h"
 #include "osi_profile.h"
+#include "osi_chip.h"
+#include "osi_byte_buf.h"
 #include "hal_config.h"
 #include "cmsis_core.h"
 #include "hwregs.h"
 #include <stddef.h>
+#include <string.h>
 
 #define GICD_GROUP_REG_COUNT OSI_DIV_ROUND_UP(IRQ_GIC_LINE_COUNT, 32)
 #define GICD_ENABLE_REG_COUNT OSI_DIV_ROUND_UP(IRQ_GIC_LINE_COUNT, 32)
@@ -43,7 +47,30 @@ typedef struct
 
 static osiIrqContext_t gOsiIrqCtx;
 
-static struct osiIrqHandlerBody gOsiIrqBody[IRQ_GIC_LINE_COUNT] = {};
+// Handlers are looked up in each interrupt, keep it in SRAM with the dispatcher
+static struct osiIrqHandlerBody gOsiIrqBody[IRQ_GIC_LINE_COUNT] OSI_SECTION_SRAM_BSS;
+
+#ifdef CONFIG_KERNEL_IRQ_STAT
+#define IRQ_STAT_NEST_MAX (8)
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_ticks;
+    uint64_t total_ticks;
+    uint32_t max_nest;
+} osiIrqStatEntry_t;
+
+typedef struct
+{
+    // ticks of nested handlers, by nesting depth
+    uint32_t nested_ticks[IRQ_STAT_NEST_MAX + 1];
+    osiIrqStatEntry_t irqs[IRQ_GIC_LINE_COUNT];
+} osiIrqStatContext_t;
+
+static osiIrqStatContext_t gOsiIrqStat;
+extern volatile uint32_t ulPortInterruptNesting;
+#endif
 
 static void prvGicEnable(void)
 {
@@ -205,21 +232,151 @@ bool OSI_SECTION_SRAM_TEXT osiIrqPending(void)
     return (isr & (CPSR_I_Msk | CPSR_F_Msk | CPSR_A_Msk)) != 0;
 }
 
-void vApplicationIRQHandler(uint32_t ulICCIAR)
+#ifdef CONFIG_KERNEL_IRQ_STAT
+/**
+ * account handler time, called with interrupt disabled
+ */
+static OSI_FORCE_INLINE void prvIrqStatExit(uint32_t irqn, unsigned nest, uint32_t start)
+{
+    osiIrqStatContext_t *d = &gOsiIrqStat;
+    uint32_t ticks = HAL_TIMER_CURVAL_LO - start;
+    uint32_t self = ticks - d->nested_ticks[nest];
+    if (nest > 1)
+        d->nested_ticks[nest - 1] += ticks;
+
+    osiIrqStatEntry_t *s = &d->irqs[irqn];
+    s->count++;
+    s->total_ticks += self;
+    if (self > s->max_ticks)
+        s->max_ticks = self;
+    if (nest > s->max_nest)
+        s->max_nest = nest;
+}
+
+static bool prvIrqStatGet(unsigned irqn, osiIrqStat_t *stat, bool reset)
+{
+    osiIrqStatEntry_t *s = &gOsiIrqStat.irqs[irqn];
+    osiIrqStatEntry_t entry;
+
+    uint32_t critical = osiEnterCritical();
+    entry = *s;
+    if (reset)
+        memset(s, 0, sizeof(*s));
+    osiExitCritical(critical);
+
+    if (entry.count == 0)
+        return false;
+
+    stat->irqn = irqn;
+    stat->count = entry.count;
+    stat->max_us = (uint64_t)entry.max_ticks * 1000000 / CONFIG_KERNEL_HWTICK_FREQ;
+    stat->total_us = entry.total_ticks * 1000000 / CONFIG_KERNEL_HWTICK_FREQ;
+    stat->max_nest = entry.max_nest;
+    return true;
+}
+
+int osiIrqStat(osiIrqStat_t *stats, unsigned count, bool reset)
+{
+    osiIrqStat_t stat;
+    unsigned n = 0;
+    for (unsigned irqn = 0; irqn < IRQ_GIC_LINE_COUNT; irqn++)
+    {
+        if (stats != NULL && n >= count)
+            break;
+
+        if (!prvIrqStatGet(irqn, stats != NULL ? &stats[n] : &stat, reset))
+            continue;
+
+        n++;
+    }
+    return (int)n;
+}
+
+int osiIrqStatDump(void *mem, unsigned size)
+{
+    osiIrqStat_t stat;
+    unsigned count = osiIrqStat(NULL, 0, false);
+    unsigned total = 2 + count * 22;
+    if (mem == NULL)
+        return total;
+    if (total > size)
+        return -1;
+
+    uint8_t *pmem = (uint8_t *)mem;
+    uint8_t *pcount = pmem;
+    OSI_STRM_WLE16(pmem, 0);
+
+    // interrupts may be called after counted
+    unsigned n = 0;
+    for (unsigned irqn = 0; irqn < IRQ_GIC_LINE_COUNT && n < count; irqn++)
+    {
+        if (!prvIrqStatGet(irqn, &stat, false))
+            continue;
+
+        OSI_STRM_WLE16(pmem, stat.irqn);
+        OSI_STRM_WLE32(pmem, stat.count);
+        OSI_STRM_WLE32(pmem, stat.max_us);
+        OSI_STRM_WLE64(pmem, stat.total_us);
+        OSI_STRM_WLE32(pmem, stat.max_nest);
+        n++;
+    }
+
+    osiBytesPutLe16(pcount, n);
+    return 2 + n * 22;
+}
+#else
+int osiIrqStat(osiIrqStat_t *stats, unsigned count, bool reset) { return 0; }
+int osiIrqStatDump(void *mem, unsigned size) { return -1; }
+#endif
+
+/**
+ * Interrupt dispatcher, called by IRQ_Handler with interrupt disabled.
+ *
+ * It is located in SRAM, and profile hooks are only called when profile
+ * is enabled. So, there are no flash accesses before the handler.
+ */
+void OSI_SECTION_SRAM_TEXT vApplicationIRQHandler(uint32_t ulICCIAR)
 {
     uint32_t irqn = ulICCIAR & 0x3FFUL;
     if (irqn >= IRQ_GIC_LINE_COUNT)
     {
+#if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0)
         osiProfileIrqEnter(IRQ_GIC_LINE_COUNT);
         osiProfileIrqExit(IRQ_GIC_LINE_COUNT);
+#endif
         return;
     }
 
+#if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0)
     osiProfileIrqEnter(irqn);
+#endif
+
+#ifdef CONFIG_KERNEL_FLIGHT_REC_COUNT
+    osiFlightRecord(OSI_FLIGHT_IRQ_ENTER, irqn, 0);
+#endif
+
+#ifdef CONFIG_KERNEL_IRQ_STAT
+    unsigned nest = OSI_MIN(unsigned, ulPortInterruptNesting, IRQ_STAT_NEST_MAX);
+    gOsiIrqStat.nested_ticks[nest] = 0;
+    uint32_t start = HAL_TIMER_CURVAL_LO;
+#endif
+
+    struct osiIrqHandlerBody *body = &gOsiIrqBody[irqn];
     __enable_irq();
 
-    if (gOsiIrqBody[irqn].handler != NULL)
-        gOsiIrqBody[irqn].handler(gOsiIrqBody[irqn].ctx);
+    if (body->handler != NULL)
+        body->handler(body->ctx);
+
+#ifdef CONFIG_KERNEL_IRQ_STAT
+    __disable_irq();
+    prvIrqStatExit(irqn, nest, start);
+#endif
+
+#ifdef CONFIG_KERNEL_FLIGHT_REC_COUNT
+    osiFlightRecord(OSI_FLIGHT_IRQ_EXIT, irqn, 0);
+#endif
 
+#if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0)
     osiProfileIrqExit(irqn);
+#endif
 }
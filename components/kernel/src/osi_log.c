@@ -147,9 +147,37 @@ typedef struct
     unsigned bufsize;
 } osiTraceParamInfo_t;
 
+#define LOG_TAG_MASK (0x0fffffff)
+#define LOG_LEVEL_GET(tag) ((tag) >> 28)
+#define LOG_BUDGET_TICK_HZ (16384)    // frequency of prvTraceTick
+#define LOG_BUDGET_TICK_MASK (0x7fffffff)
+#define LOG_BUDGET_SAMPLE_MAX (64)    // maximum N of sampling 1 in N
+
+#ifdef CONFIG_KERNEL_LOG_TAG_FILTER_COUNT
+typedef struct
+{
+    osiLogTagStat_t stat;
+    uint16_t rate;          // budget of traces per second, 0 for no budget
+    uint16_t burst;         // maximum traces in burst
+    uint32_t tokens;        // in unit of 1/LOG_BUDGET_TICK_HZ trace
+    uint32_t refill_tick;   // tick of last refill
+    uint32_t window_tick;   // start tick of current 1 second window
+    uint32_t window_over;   // traces over budget in current window
+    uint32_t window_drop;   // traces dropped by sampling in current window
+    uint16_t sample;        // keep 1 in sample when over budget
+    uint16_t sample_count;  // traces over budget since last kept one
+} osiLogTagFilter_t;
+#endif
+
 static const char *gLogNullString = "(null)";
+#ifdef CONFIG_KERNEL_LOG_TAG_FILTER_COUNT
+static osiLogTagFilter_t gLogTagFilter[CONFIG_KERNEL_LOG_TAG_FILTER_COUNT];
+unsigned gLogTagFilterCount = 0;
+#endif
 bool gTraceEnabled = false;
 uint32_t gTraceSequence;
+static osiTraceSink_t gTraceSink = NULL;
+static void *gTraceSinkParam = NULL;
 sxs_IoCtx_t sxs_IoCtx;
 uint32_t v_tra_pubModuleControl;
 uint32_t v_tra_lteModuleControl;
@@ -417,6 +445,26 @@ static unsigned prvStrParamBuf(const char *fmt, osiBuffer_t *bufs, uint32_t *buf
     return dlen;
 }
 
+/**
+ * Deliver application trace data to sink, called inside critical section
+ */
+LOG_RAMCODE static inline void prvTraceSink(unsigned tag, const osiBuffer_t *bufs, unsigned count)
+{
+    if (gTraceSink != NULL)
+        gTraceSink(gTraceSinkParam, tag, bufs, count);
+}
+
+/**
+ * Set application trace sink
+ */
+void osiTraceSetSink(osiTraceSink_t sink, void *param)
+{
+    unsigned critical = osiEnterCritical();
+    gTraceSink = sink;
+    gTraceSinkParam = param;
+    osiExitCritical(critical);
+}
+
 /**
  * Application basic trace
  */
@@ -441,6 +489,7 @@ LOG_RAMCODE static void prvTraceBasic(unsigned tag, unsigned nargs, const char *
     gTraceSequence++;
     prvFillTraceHeader(&header, tag, tlen);
     osiTraceBufPutMulti(bufs, 3, tlen);
+    prvTraceSink(tag, &bufs[1], 2);
     osiExitCritical(critical);
 }
 
@@ -461,6 +510,8 @@ LOG_RAMCODE static void prvTraceIdBasic(unsigned tag, unsigned nargs, unsigned f
     gTraceSequence++;
     prvFillTraceHeader((osiTraceHeader_t *)p, tag | TRACE_TDB_FLAG, tlen);
     osiTraceBufPut(p, tlen);
+    osiBuffer_t data = {(uintptr_t)(p + sizeof(osiTraceHeader_t) / 4), dlen};
+    prvTraceSink(tag | TRACE_TDB_FLAG, &data, 1);
     osiExitCritical(critical);
 }
 
@@ -486,6 +537,7 @@ static void prvTraceEx(unsigned tag, unsigned partype, const char *fmt, va_list
     gTraceSequence++;
     prvFillTraceHeader(&header, tag, tlen);
     osiTraceBufPutMulti(bufs, pari.count + 2, tlen);
+    prvTraceSink(tag, &bufs[1], pari.count + 1);
     osiExitCritical(critical);
 }
 
@@ -509,6 +561,7 @@ static void prvTraceIdEx(unsigned tag, unsigned partype, unsigned fmtid, va_list
     gTraceSequence++;
     prvFillTraceHeader(&header, tag | TRACE_TDB_FLAG, tlen);
     osiTraceBufPutMulti(bufs, pari.count + 2, tlen);
+    prvTraceSink(tag | TRACE_TDB_FLAG, &bufs[1], pari.count + 1);
     osiExitCritical(critical);
 }
 
@@ -593,6 +646,7 @@ void osiTraceVprintf(unsigned tag, const char *fmt, va_list ap)
     gTraceSequence++;
     prvFillTraceHeader(&header, tag, tlen);
     osiTraceBufPutMulti(bufs, pari.count + 2, tlen);
+    prvTraceSink(tag, &bufs[1], pari.count + 1);
     osiExitCritical(critical);
 }
 
@@ -610,6 +664,233 @@ void osiTracePrintf(unsigned tag, const char *fmt, ...)
     va_end(ap);
 }
 
+#ifdef CONFIG_KERNEL_LOG_TAG_FILTER_COUNT
+/**
+ * Check budget of the tag, for trace passed runtime level. It should be
+ * called inside critical section.
+ *
+ * Tokens are refilled at \p rate, and each trace consumes one token. When
+ * tokens are exhausted, 1 in \p sample traces are kept. At the end of each
+ * 1 second window, \p sample is doubled when there are traces over budget,
+ * and halved otherwise. The count of dropped traces in the window is
+ * returned by \p report, to be output in-band.
+ */
+LOG_RAMCODE static bool prvLogTagBudget(osiLogTagFilter_t *f, uint32_t *report)
+{
+    uint32_t tick = prvTraceTick();
+    uint32_t elapsed = (tick - f->refill_tick) & LOG_BUDGET_TICK_MASK;
+    uint32_t capacity = (uint32_t)f->burst * LOG_BUDGET_TICK_HZ;
+
+    f->refill_tick = tick;
+    if (elapsed > LOG_BUDGET_TICK_HZ)
+        elapsed = LOG_BUDGET_TICK_HZ;
+    f->tokens += elapsed * f->rate;
+    if (f->tokens > capacity)
+        f->tokens = capacity;
+
+    if (((tick - f->window_tick) & LOG_BUDGET_TICK_MASK) >= LOG_BUDGET_TICK_HZ)
+    {
+        *report = f->window_drop;
+        if (f->window_over != 0)
+            f->sample = OSI_MIN(unsigned, f->sample * 2, LOG_BUDGET_SAMPLE_MAX);
+        else if (f->sample > 2)
+            f->sample /= 2;
+        f->window_tick = tick;
+        f->window_over = 0;
+        f->window_drop = 0;
+    }
+
+    if (f->tokens >= LOG_BUDGET_TICK_HZ)
+    {
+        f->tokens -= LOG_BUDGET_TICK_HZ;
+        return true;
+    }
+
+    f->window_over++;
+    if (++f->sample_count >= f->sample)
+    {
+        f->sample_count = 0;
+        return true;
+    }
+
+    f->window_drop++;
+    f->stat.throttled++;
+    return false;
+}
+
+/**
+ * Check runtime level and budget of the tag, called in trace macros.
+ * Traces of tags without runtime level are passed, and not counted.
+ */
+LOG_RAMCODE bool osiLogTagFilter(unsigned tag)
+{
+    unsigned level = LOG_LEVEL_GET(tag);
+    bool passed = true;
+    uint32_t report = 0;
+    unsigned sample = 0;
+
+    tag &= LOG_TAG_MASK;
+    unsigned critical = osiEnterCritical();
+    for (unsigned n = 0; n < gLogTagFilterCount; n++)
+    {
+        osiLogTagFilter_t *f = &gLogTagFilter[n];
+        if (f->stat.tag == tag)
+        {
+            passed = (level <= f->stat.level);
+            if (passed && f->rate != 0)
+            {
+                passed = prvLogTagBudget(f, &report);
+                sample = f->sample;
+            }
+
+            if (passed)
+                f->stat.emitted++;
+            else if (level > f->stat.level)
+                f->stat.dropped++;
+            break;
+        }
+    }
+    osiExitCritical(critical);
+
+    // Output directly rather than by trace macros, to bypass the filter.
+    if (report != 0)
+        osiTraceBasic((OSI_LOG_LEVEL_WARN << 28) | tag, 2,
+                      "trace budget dropped %d, sample 1/%d", report, sample);
+    return passed;
+}
+
+/**
+ * Set runtime level of the tag
+ */
+bool osiLogSetTagLevel(unsigned tag, unsigned level)
+{
+    if (level > OSI_LOG_LEVEL_VERBOSE)
+        return false;
+
+    tag &= LOG_TAG_MASK;
+    bool ok = false;
+    unsigned critical = osiEnterCritical();
+    for (unsigned n = 0; n < gLogTagFilterCount; n++)
+    {
+        if (gLogTagFilter[n].stat.tag == tag)
+        {
+            gLogTagFilter[n].stat.level = level;
+            ok = true;
+            break;
+        }
+    }
+
+    if (!ok && gLogTagFilterCount < CONFIG_KERNEL_LOG_TAG_FILTER_COUNT)
+    {
+        osiLogTagFilter_t *f = &gLogTagFilter[gLogTagFilterCount];
+        memset(f, 0, sizeof(*f));
+        f->stat.tag = tag;
+        f->stat.level = level;
+        gLogTagFilterCount++;
+        ok = true;
+    }
+    osiExitCritical(critical);
+    return ok;
+}
+
+/**
+ * Set trace budget of the tag
+ */
+bool osiLogSetTagBudget(unsigned tag, unsigned rate, unsigned burst)
+{
+    if (rate > UINT16_MAX || burst > UINT16_MAX)
+        return false;
+
+    tag &= LOG_TAG_MASK;
+    osiLogTagFilter_t *f = NULL;
+    unsigned critical = osiEnterCritical();
+    for (unsigned n = 0; n < gLogTagFilterCount; n++)
+    {
+        if (gLogTagFilter[n].stat.tag == tag)
+        {
+            f = &gLogTagFilter[n];
+            break;
+        }
+    }
+
+    if (f == NULL && rate != 0 && gLogTagFilterCount < CONFIG_KERNEL_LOG_TAG_FILTER_COUNT)
+    {
+        f = &gLogTagFilter[gLogTagFilterCount];
+        memset(f, 0, sizeof(*f));
+        f->stat.tag = tag;
+        f->stat.level = OSI_LOG_LEVEL_VERBOSE;
+        gLogTagFilterCount++;
+    }
+
+    if (f != NULL)
+    {
+        if (burst == 0)
+            burst = rate;
+        f->rate = rate;
+        f->burst = burst;
+        f->tokens = (uint32_t)burst * LOG_BUDGET_TICK_HZ;
+        f->refill_tick = prvTraceTick();
+        f->window_tick = f->refill_tick;
+        f->window_over = 0;
+        f->window_drop = 0;
+        f->sample = 2;
+        f->sample_count = 0;
+    }
+    osiExitCritical(critical);
+    return f != NULL || rate == 0;
+}
+
+/**
+ * Remove runtime level of the tag
+ */
+void osiLogRemoveTagLevel(unsigned tag)
+{
+    tag &= LOG_TAG_MASK;
+    unsigned critical = osiEnterCritical();
+    for (unsigned n = 0; n < gLogTagFilterCount; n++)
+    {
+        if (gLogTagFilter[n].stat.tag == tag)
+        {
+            gLogTagFilterCount--;
+            gLogTagFilter[n] = gLogTagFilter[gLogTagFilterCount];
+            break;
+        }
+    }
+    osiExitCritical(critical);
+}
+
+/**
+ * Get statistics of tags with runtime level
+ */
+unsigned osiLogTagStat(osiLogTagStat_t *stat, unsigned count, bool reset)
+{
+    if (stat == NULL)
+        return gLogTagFilterCount;
+
+    unsigned critical = osiEnterCritical();
+    if (count > gLogTagFilterCount)
+        count = gLogTagFilterCount;
+    for (unsigned n = 0; n < count; n++)
+        stat[n] = gLogTagFilter[n].stat;
+    if (reset)
+    {
+        for (unsigned n = 0; n < gLogTagFilterCount; n++)
+        {
+            gLogTagFilter[n].stat.emitted = 0;
+            gLogTagFilter[n].stat.dropped = 0;
+            gLogTagFilter[n].stat.throttled = 0;
+        }
+    }
+    osiExitCritical(critical);
+    return count;
+}
+#else
+bool osiLogSetTagLevel(unsigned tag, unsigned level) { return false; }
+bool osiLogSetTagBudget(unsigned tag, unsigned rate, unsigned burst) { return false; }
+void osiLogRemoveTagLevel(unsigned tag) {}
+unsigned osiLogTagStat(osiLogTagStat_t *stat, unsigned count, bool reset) { return 0; }
+#endif
+
 /**
  * tra basic trace
  */
@@ -0,0 +1,214 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "osi_mem.h"
+#include "osi_api.h"
+#include "osi_slab.h"
+#include "osi_log.h"
+#include <string.h>
+
+#ifdef CONFIG_KERNEL_MEM_BUDGET
+
+typedef struct
+{
+    osiMemBudgetStat_t stat;
+    bool pressure; // 超过软限制，已经调用过回调
+    osiMemBudgetCallback_t cb;
+    void *cb_ctx;
+} memBudget_t;
+
+static memBudget_t gMemBudget[OSI_MEM_BUDGET_COUNT];
+
+static inline memBudget_t *prvMemBudget(osiMemBudgetId_t id)
+{
+    return &gMemBudget[((unsigned)id < OSI_MEM_BUDGET_COUNT) ? id : OSI_MEM_BUDGET_OTHER];
+}
+
+bool osiMemBudgetSetLimit(osiMemBudgetId_t id, uint32_t soft, uint32_t hard)
+{
+    if ((unsigned)id >= OSI_MEM_BUDGET_COUNT)
+        return false;
+
+    memBudget_t *d = &gMemBudget[id];
+    uint32_t critical = osiEnterCritical();
+    d->stat.soft_limit = soft;
+    d->stat.hard_limit = hard;
+    d->pressure = (soft != 0 && d->stat.used > soft);
+    osiExitCritical(critical);
+    return true;
+}
+
+bool osiMemBudgetSetCallback(osiMemBudgetId_t id, osiMemBudgetCallback_t cb, void *ctx)
+{
+    if ((unsigned)id >= OSI_MEM_BUDGET_COUNT)
+        return false;
+
+    memBudget_t *d = &gMemBudget[id];
+    uint32_t critical = osiEnterCritical();
+    d->cb = cb;
+    d->cb_ctx = ctx;
+    osiExitCritical(critical);
+    return true;
+}
+
+/**
+ * account size without limit check, called in critical section
+ */
+static void prvMemBudgetAdd(memBudget_t *d, uint32_t size)
+{
+    d->stat.used += size;
+    if (d->stat.used > d->stat.peak)
+        d->stat.peak = d->stat.used;
+}
+
+bool osiMemBudgetCharge(osiMemBudgetId_t id, size_t size)
+{
+    memBudget_t *d = prvMemBudget(id);
+
+    for (unsigned retry = 0;; retry++)
+    {
+        uint32_t critical = osiEnterCritical();
+        uint32_t used = d->stat.used + size;
+        osiMemBudgetCallback_t cb = d->cb;
+        void *cb_ctx = d->cb_ctx;
+
+        if (d->stat.hard_limit == 0 || used <= d->stat.hard_limit)
+        {
+            prvMemBudgetAdd(d, size);
+            d->stat.count++;
+
+            // 只在越过软限制时通知一次，回落后再次越过时再通知
+            uint32_t soft = d->stat.soft_limit;
+            bool notify = (soft != 0 && used > soft && !d->pressure);
+            if (notify)
+            {
+                d->pressure = true;
+                d->stat.pressure_count++;
+            }
+            osiExitCritical(critical);
+
+            if (notify && cb != NULL)
+                cb(cb_ctx, id, used - soft);
+            return true;
+        }
+
+        // 超过硬限制：先回调，回调可能直接释放内存，然后重试一次
+        uint32_t need = used - d->stat.hard_limit;
+        if (retry > 0 || cb == NULL)
+        {
+            d->stat.fail_count++;
+            osiExitCritical(critical);
+            OSI_LOGD(0, "mem budget %d over hard limit, size/%d", id, size);
+            return false;
+        }
+
+        d->stat.pressure_count++;
+        osiExitCritical(critical);
+        cb(cb_ctx, id, need);
+    }
+}
+
+void osiMemBudgetUncharge(osiMemBudgetId_t id, size_t size)
+{
+    memBudget_t *d = prvMemBudget(id);
+
+    uint32_t critical = osiEnterCritical();
+    d->stat.used = (d->stat.used > size) ? d->stat.used - size : 0;
+    if (d->stat.count > 0)
+        d->stat.count--;
+    if (d->pressure && d->stat.used <= d->stat.soft_limit)
+        d->pressure = false;
+    osiExitCritical(critical);
+}
+
+void *osiMemBudgetMalloc(osiMemBudgetId_t id, size_t size)
+{
+    if (!osiMemBudgetCharge(id, size))
+        return NULL;
+
+    void *ptr = osiSlabMalloc(size);
+    if (ptr == NULL)
+    {
+        osiMemBudgetUncharge(id, size);
+        return NULL;
+    }
+
+    // 按实际分配的大小记账，释放时才能对得上
+    size_t alloc_size = osiSlabAllocSize(ptr);
+    if (alloc_size > size)
+    {
+        memBudget_t *d = prvMemBudget(id);
+        uint32_t critical = osiEnterCritical();
+        prvMemBudgetAdd(d, alloc_size - size);
+        osiExitCritical(critical);
+    }
+    return ptr;
+}
+
+void *osiMemBudgetCalloc(osiMemBudgetId_t id, size_t nmemb, size_t size)
+{
+    size_t total;
+    if (__builtin_mul_overflow(nmemb, size, &total))
+        return NULL;
+
+    void *ptr = osiMemBudgetMalloc(id, total);
+    if (ptr != NULL)
+        memset(ptr, 0, total);
+    return ptr;
+}
+
+void osiMemBudgetFree(osiMemBudgetId_t id, void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    osiMemBudgetUncharge(id, osiSlabAllocSize(ptr));
+    osiSlabFree(ptr);
+}
+
+bool osiMemBudgetStat(osiMemBudgetId_t id, osiMemBudgetStat_t *stat)
+{
+    if ((unsigned)id >= OSI_MEM_BUDGET_COUNT || stat == NULL)
+        return false;
+
+    uint32_t critical = osiEnterCritical();
+    *stat = gMemBudget[id].stat;
+    osiExitCritical(critical);
+    return true;
+}
+
+void osiMemBudgetResetPeak(osiMemBudgetId_t id)
+{
+    if ((unsigned)id >= OSI_MEM_BUDGET_COUNT)
+        return;
+
+    memBudget_t *d = &gMemBudget[id];
+    uint32_t critical = osiEnterCritical();
+    d->stat.peak = d->stat.used;
+    osiExitCritical(critical);
+}
+
+#else
+
+bool osiMemBudgetSetLimit(osiMemBudgetId_t id, uint32_t soft, uint32_t hard) { return false; }
+bool osiMemBudgetSetCallback(osiMemBudgetId_t id, osiMemBudgetCallback_t cb, void *ctx) { return false; }
+bool osiMemBudgetCharge(osiMemBudgetId_t id, size_t size) { return true; }
+void osiMemBudgetUncharge(osiMemBudgetId_t id, size_t size) {}
+void *osiMemBudgetMalloc(osiMemBudgetId_t id, size_t size) { return osiSlabMalloc(size); }
+void *osiMemBudgetCalloc(osiMemBudgetId_t id, size_t nmemb, size_t size) { return osiSlabCalloc(nmemb, size); }
+void osiMemBudgetFree(osiMemBudgetId_t id, void *ptr) { osiSlabFree(ptr); }
+bool osiMemBudgetStat(osiMemBudgetId_t id, osiMemBudgetStat_t *stat) { return false; }
+void osiMemBudgetResetPeak(osiMemBudgetId_t id) {}
+
+#endif
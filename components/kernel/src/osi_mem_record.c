@@ -15,7 +15,246 @@
 #include "osi_mem.h"
 #include "osi_api.h"
 #include "osi_internal.h"
+#include "osi_slab.h"
+#include "osi_byte_buf.h"
+#include "osi_compiler.h"
+#include <string.h>
 
 const unsigned gOsiMemRecordCount = CONFIG_KERNEL_MEM_RECORD_COUNT;
 unsigned gOsiMemRecordPos = 0;
 osiMemRecord_t gOsiMemRecords[CONFIG_KERNEL_MEM_RECORD_COUNT];
+
+// 诊断输出的调用地址数
+#define MEM_TRACK_DUMP_SITES (16)
+
+#ifdef CONFIG_KERNEL_MEM_TRACK_COUNT
+
+// 逐项扫描时每次关中断处理的表项数，避免长时间关中断
+#define MEM_TRACK_SCAN_CHUNK (32)
+// 汇总时最多区分的调用地址数
+#define MEM_TRACK_SITES_MAX (64)
+
+typedef struct
+{
+    uint32_t ptr; // 0 表示空表项
+    uint32_t caller;
+    uint32_t size;
+} memTrackEntry_t;
+
+typedef struct
+{
+    unsigned rate;    // 采样间隔，0 表示关闭
+    unsigned sample;  // 采样计数
+    unsigned used;    // 已用表项数
+    unsigned dropped; // 表满丢弃的采样数
+    memTrackEntry_t entries[CONFIG_KERNEL_MEM_TRACK_COUNT];
+} memTrackContext_t;
+
+static memTrackContext_t gMemTrack;
+
+static inline unsigned prvMemTrackHash(uint32_t ptr)
+{
+    return ((ptr >> 3) * 2654435761U) % CONFIG_KERNEL_MEM_TRACK_COUNT;
+}
+
+void osiMemTrackSetRate(unsigned rate)
+{
+    memTrackContext_t *d = &gMemTrack;
+
+    uint32_t critical = osiEnterCritical();
+    d->rate = rate;
+    d->sample = 0;
+    d->used = 0;
+    d->dropped = 0;
+    memset(d->entries, 0, sizeof(d->entries));
+    osiExitCritical(critical);
+}
+
+unsigned osiMemTrackRate(void)
+{
+    return gMemTrack.rate;
+}
+
+void osiMemTrackAlloc(const void *ptr, size_t size, const void *caller)
+{
+    memTrackContext_t *d = &gMemTrack;
+    if (d->rate == 0 || ptr == NULL)
+        return;
+
+    uint32_t critical = osiEnterCritical();
+    if (d->rate == 0 || ++d->sample < d->rate)
+    {
+        osiExitCritical(critical);
+        return;
+    }
+
+    d->sample = 0;
+    if (d->used >= CONFIG_KERNEL_MEM_TRACK_COUNT - 1)
+    {
+        // 保留一个空表项，查找才能终止
+        d->dropped++;
+        osiExitCritical(critical);
+        return;
+    }
+
+    unsigned n = prvMemTrackHash((uint32_t)ptr);
+    while (d->entries[n].ptr != 0)
+        n = (n + 1) % CONFIG_KERNEL_MEM_TRACK_COUNT;
+
+    d->entries[n].ptr = (uint32_t)ptr;
+    d->entries[n].caller = (uint32_t)caller;
+    d->entries[n].size = size;
+    d->used++;
+    osiExitCritical(critical);
+}
+
+void osiMemTrackFree(const void *ptr)
+{
+    memTrackContext_t *d = &gMemTrack;
+    if (d->used == 0 || ptr == NULL)
+        return;
+
+    uint32_t critical = osiEnterCritical();
+    unsigned n = prvMemTrackHash((uint32_t)ptr);
+    while (d->entries[n].ptr != 0 && d->entries[n].ptr != (uint32_t)ptr)
+        n = (n + 1) % CONFIG_KERNEL_MEM_TRACK_COUNT;
+
+    if (d->entries[n].ptr == 0)
+    {
+        osiExitCritical(critical);
+        return;
+    }
+
+    // 线性探测的删除：把后面可以前移的表项移到空位，不需要删除标记
+    unsigned hole = n;
+    for (;;)
+    {
+        n = (n + 1) % CONFIG_KERNEL_MEM_TRACK_COUNT;
+        if (d->entries[n].ptr == 0)
+            break;
+
+        unsigned home = prvMemTrackHash(d->entries[n].ptr);
+        bool movable = (hole <= n) ? (home <= hole || home > n) : (home <= hole && home > n);
+        if (movable)
+        {
+            d->entries[hole] = d->entries[n];
+            hole = n;
+        }
+    }
+    d->entries[hole].ptr = 0;
+    d->used--;
+    osiExitCritical(critical);
+}
+
+unsigned osiMemTrackTopSites(osiMemTrackSite_t *sites, unsigned count)
+{
+    memTrackContext_t *d = &gMemTrack;
+    osiMemTrackSite_t all[MEM_TRACK_SITES_MAX];
+    unsigned all_count = 0;
+
+    if (sites == NULL || count == 0)
+        return 0;
+
+    // 分段关中断汇总，结果是近似的快照。调用地址太多时，剩下的计入地址 0
+    for (unsigned start = 0; start < CONFIG_KERNEL_MEM_TRACK_COUNT; start += MEM_TRACK_SCAN_CHUNK)
+    {
+        unsigned end = OSI_MIN(unsigned, start + MEM_TRACK_SCAN_CHUNK, CONFIG_KERNEL_MEM_TRACK_COUNT);
+        uint32_t critical = osiEnterCritical();
+        for (unsigned n = start; n < end; n++)
+        {
+            memTrackEntry_t *e = &d->entries[n];
+            if (e->ptr == 0)
+                continue;
+
+            uint32_t caller = e->caller;
+            unsigned m = 0;
+            while (m < all_count && all[m].caller != caller)
+                m++;
+            if (m == all_count)
+            {
+                if (all_count >= MEM_TRACK_SITES_MAX - 1)
+                {
+                    caller = 0;
+                    for (m = 0; m < all_count && all[m].caller != 0; m++)
+                        ;
+                }
+                if (m == all_count)
+                {
+                    all[m].caller = caller;
+                    all[m].size = 0;
+                    all[m].count = 0;
+                    all_count++;
+                }
+            }
+            all[m].size += e->size;
+            all[m].count++;
+        }
+        osiExitCritical(critical);
+    }
+
+    // 按字节数选出最大的几个
+    unsigned out = 0;
+    for (; out < count && out < all_count; out++)
+    {
+        unsigned max = out;
+        for (unsigned m = out + 1; m < all_count; m++)
+        {
+            if (all[m].size > all[max].size)
+                max = m;
+        }
+
+        osiMemTrackSite_t tmp = all[out];
+        all[out] = all[max];
+        all[max] = tmp;
+        sites[out] = all[out];
+    }
+    return out;
+}
+
+#else
+
+void osiMemTrackSetRate(unsigned rate) {}
+unsigned osiMemTrackRate(void) { return 0; }
+void osiMemTrackAlloc(const void *ptr, size_t size, const void *caller) {}
+void osiMemTrackFree(const void *ptr) {}
+unsigned osiMemTrackTopSites(osiMemTrackSite_t *sites, unsigned count) { return 0; }
+
+#endif
+
+int osiMemTrackDump(void *mem, unsigned size)
+{
+    osiMemTrackSite_t sites[MEM_TRACK_DUMP_SITES];
+    unsigned site_count = osiMemTrackTopSites(sites, MEM_TRACK_DUMP_SITES);
+    unsigned class_count = osiSlabClassCount();
+
+    int total = 4 + site_count * 12 + 8 + 2 + class_count * 8;
+    if (mem == NULL)
+        return total;
+    if (total > size)
+        return -1;
+
+    uint8_t *pmem = (uint8_t *)mem;
+    OSI_STRM_WLE16(pmem, osiMemTrackRate());
+    OSI_STRM_WLE16(pmem, site_count);
+    for (unsigned n = 0; n < site_count; n++)
+    {
+        OSI_STRM_WLE32(pmem, sites[n].caller);
+        OSI_STRM_WLE32(pmem, sites[n].size);
+        OSI_STRM_WLE32(pmem, sites[n].count);
+    }
+
+    osiMemPoolStat_t stat = {};
+    osiMemPoolStat(NULL, &stat);
+    OSI_STRM_WLE32(pmem, stat.avail_size);
+    OSI_STRM_WLE32(pmem, stat.max_block_size);
+
+    OSI_STRM_WLE16(pmem, class_count);
+    for (unsigned n = 0; n < class_count; n++)
+    {
+        osiSlabClassStat_t cstat = {};
+        osiSlabClassStat(n, &cstat);
+        OSI_STRM_WLE32(pmem, cstat.block_size);
+        OSI_STRM_WLE32(pmem, cstat.free_count);
+    }
+    return total;
+}
@@ -0,0 +1,330 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "kernel_config.h"
+#include "osi_mem.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "osi_byte_buf.h"
+#include <string.h>
+
+#ifndef CONFIG_KERNEL_MEM_PRESSURE_AVAIL
+#define CONFIG_KERNEL_MEM_PRESSURE_AVAIL (64 * 1024)
+#endif
+
+#ifndef CONFIG_KERNEL_MEM_PRESSURE_BLOCK
+#define CONFIG_KERNEL_MEM_PRESSURE_BLOCK (16 * 1024)
+#endif
+
+#define MEM_PRESSURE_CB_COUNT (8)
+#define MEM_PRESSURE_PERIOD (1000)
+#define MEM_REPORT_NAME_LEN (8)
+
+typedef struct
+{
+    osiMemPressureCallback_t cb;
+    void *ctx;
+} memPressureCb_t;
+
+typedef struct
+{
+    osiMemPool_t *pools[OSI_MEM_BUDGET_COUNT];
+    uint32_t heap_peak;
+    uint32_t low_avail;
+    uint32_t low_block;
+    uint32_t pressure_count;
+    bool pressure; // below threshold, and callbacks are called
+    bool forced;   // allocation failure, call callbacks anyway
+    osiWork_t *work;
+    osiTimer_t *timer;
+    memPressureCb_t cbs[MEM_PRESSURE_CB_COUNT];
+} memReportContext_t;
+
+static memReportContext_t gMemReportCtx = {
+    .low_avail = CONFIG_KERNEL_MEM_PRESSURE_AVAIL,
+    .low_block = CONFIG_KERNEL_MEM_PRESSURE_BLOCK,
+};
+
+static const char *gMemBudgetNames[OSI_MEM_BUDGET_COUNT] = {
+    [OSI_MEM_BUDGET_OTHER] = "other",
+    [OSI_MEM_BUDGET_LVGL] = "lvgl",
+    [OSI_MEM_BUDGET_LWIP] = "lwip",
+    [OSI_MEM_BUDGET_TLS] = "tls",
+    [OSI_MEM_BUDGET_AUDIO] = "audio",
+    [OSI_MEM_BUDGET_APP] = "app",
+};
+
+static uint32_t prvFragIndex(const osiMemPoolStat_t *stat)
+{
+    if (stat->avail_size == 0 || stat->max_block_size >= stat->avail_size)
+        return 0;
+    return 100 - (uint64_t)stat->max_block_size * 100 / stat->avail_size;
+}
+
+static void prvPoolEntry(osiMemReportEntry_t *entry, osiMemPool_t *pool)
+{
+    osiMemPoolStat_t stat = {};
+    if (!osiMemPoolStat(pool, &stat))
+        return;
+
+    entry->pool_size = stat.size;
+    entry->avail_size = stat.avail_size;
+    entry->max_block_size = stat.max_block_size;
+    entry->frag = prvFragIndex(&stat);
+}
+
+/**
+ * Sample the default pool, and update the high water mark
+ */
+static bool prvHeapSample(osiMemPoolStat_t *stat)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    if (!osiMemPoolStat(NULL, stat))
+        return false;
+
+    uint32_t used = stat->size - stat->avail_size;
+    uint32_t critical = osiEnterCritical();
+    if (used > d->heap_peak)
+        d->heap_peak = used;
+    osiExitCritical(critical);
+    return true;
+}
+
+bool osiMemReportSetPool(osiMemBudgetId_t id, osiMemPool_t *pool)
+{
+    if ((unsigned)id >= OSI_MEM_BUDGET_COUNT)
+        return false;
+
+    gMemReportCtx.pools[id] = pool;
+    return true;
+}
+
+unsigned osiMemReport(osiMemReportEntry_t *entries, unsigned count)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    if (entries == NULL || count == 0)
+        return 0;
+
+    osiMemReportEntry_t *entry = &entries[0];
+    memset(entry, 0, sizeof(*entry));
+    entry->name = "heap";
+
+    osiMemPoolStat_t stat;
+    if (prvHeapSample(&stat))
+    {
+        entry->used = stat.size - stat.avail_size;
+        entry->peak = d->heap_peak;
+        entry->pool_size = stat.size;
+        entry->avail_size = stat.avail_size;
+        entry->max_block_size = stat.max_block_size;
+        entry->frag = prvFragIndex(&stat);
+    }
+
+    unsigned n = 1;
+    for (unsigned id = 0; id < OSI_MEM_BUDGET_COUNT && n < count; id++, n++)
+    {
+        entry = &entries[n];
+        memset(entry, 0, sizeof(*entry));
+        entry->name = gMemBudgetNames[id];
+
+        // budget isn't enabled, only pool is reported
+        osiMemBudgetStat_t bstat;
+        if (osiMemBudgetStat((osiMemBudgetId_t)id, &bstat))
+        {
+            entry->used = bstat.used;
+            entry->peak = bstat.peak;
+        }
+
+        if (d->pools[id] != NULL)
+            prvPoolEntry(entry, d->pools[id]);
+    }
+    return n;
+}
+
+int osiMemReportDump(void *mem, unsigned size)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    osiMemReportEntry_t entries[OSI_MEM_BUDGET_COUNT + 1];
+    unsigned count = osiMemReport(entries, OSI_ARRAY_SIZE(entries));
+
+    int total = 12 + 2 + count * (MEM_REPORT_NAME_LEN + 24);
+    if (mem == NULL)
+        return total;
+    if (total > size)
+        return -1;
+
+    uint8_t *pmem = (uint8_t *)mem;
+    OSI_STRM_WLE32(pmem, d->low_avail);
+    OSI_STRM_WLE32(pmem, d->low_block);
+    OSI_STRM_WLE32(pmem, d->pressure_count);
+    OSI_STRM_WLE16(pmem, count);
+    for (unsigned n = 0; n < count; n++)
+    {
+        memset(pmem, 0, MEM_REPORT_NAME_LEN);
+        strncpy((char *)pmem, entries[n].name, MEM_REPORT_NAME_LEN);
+        pmem += MEM_REPORT_NAME_LEN;
+        OSI_STRM_WLE32(pmem, entries[n].used);
+        OSI_STRM_WLE32(pmem, entries[n].peak);
+        OSI_STRM_WLE32(pmem, entries[n].pool_size);
+        OSI_STRM_WLE32(pmem, entries[n].avail_size);
+        OSI_STRM_WLE32(pmem, entries[n].max_block_size);
+        OSI_STRM_WLE32(pmem, entries[n].frag);
+    }
+    return total;
+}
+
+/**
+ * Pressure monitor, in low priority system work queue
+ */
+static void prvMemPressureCheck(void *param)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    osiMemPoolStat_t stat;
+    if (!prvHeapSample(&stat))
+        return;
+
+    bool low = (d->low_avail != 0 && stat.avail_size < d->low_avail) ||
+               (d->low_block != 0 && stat.max_block_size < d->low_block);
+
+    uint32_t critical = osiEnterCritical();
+    bool forced = d->forced;
+    bool notify = forced || (low && !d->pressure);
+    d->forced = false;
+    d->pressure = low;
+    if (notify)
+        d->pressure_count++;
+
+    memPressureCb_t cbs[MEM_PRESSURE_CB_COUNT];
+    memcpy(cbs, d->cbs, sizeof(cbs));
+    osiExitCritical(critical);
+
+    if (!notify)
+        return;
+
+    OSI_LOGW(0, "memory pressure, avail/%d max block/%d forced/%d",
+             stat.avail_size, stat.max_block_size, forced);
+
+    for (unsigned n = 0; n < MEM_PRESSURE_CB_COUNT; n++)
+    {
+        if (cbs[n].cb != NULL)
+            cbs[n].cb(cbs[n].ctx);
+    }
+}
+
+/**
+ * Start pressure monitor, it is never stopped
+ */
+static bool prvMemPressureStart(void)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    if (d->work != NULL)
+        return true;
+
+    osiWork_t *work = osiWorkCreate(prvMemPressureCheck, NULL, NULL);
+    if (work == NULL)
+        return false;
+
+    osiTimer_t *timer = osiTimerCreateWork(work, osiSysWorkQueueLowPriority());
+    if (timer == NULL)
+    {
+        osiWorkDelete(work);
+        return false;
+    }
+
+    // registration may be called in multiple threads, the first wins
+    uint32_t critical = osiEnterCritical();
+    bool first = (d->work == NULL);
+    if (first)
+    {
+        d->timer = timer;
+        d->work = work;
+    }
+    osiExitCritical(critical);
+
+    if (!first)
+    {
+        osiTimerDelete(timer);
+        osiWorkDelete(work);
+        return true;
+    }
+
+    // relaxed timer won't wake up system, memory won't change in sleep
+    osiTimerStartPeriodicRelaxed(timer, MEM_PRESSURE_PERIOD, OSI_WAIT_FOREVER);
+    return true;
+}
+
+bool osiMemPressureRegister(osiMemPressureCallback_t cb, void *ctx)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    if (cb == NULL || !prvMemPressureStart())
+        return false;
+
+    uint32_t critical = osiEnterCritical();
+    memPressureCb_t *empty = NULL;
+    for (unsigned n = 0; n < MEM_PRESSURE_CB_COUNT; n++)
+    {
+        memPressureCb_t *c = &d->cbs[n];
+        if (c->cb == cb && c->ctx == ctx)
+        {
+            osiExitCritical(critical);
+            return false;
+        }
+        if (c->cb == NULL && empty == NULL)
+            empty = c;
+    }
+
+    if (empty != NULL)
+    {
+        empty->cb = cb;
+        empty->ctx = ctx;
+    }
+    osiExitCritical(critical);
+    return empty != NULL;
+}
+
+void osiMemPressureUnregister(osiMemPressureCallback_t cb, void *ctx)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    uint32_t critical = osiEnterCritical();
+    for (unsigned n = 0; n < MEM_PRESSURE_CB_COUNT; n++)
+    {
+        memPressureCb_t *c = &d->cbs[n];
+        if (c->cb == cb && c->ctx == ctx)
+        {
+            c->cb = NULL;
+            c->ctx = NULL;
+        }
+    }
+    osiExitCritical(critical);
+}
+
+void osiMemPressureSetThreshold(uint32_t avail, uint32_t block)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    uint32_t critical = osiEnterCritical();
+    d->low_avail = avail;
+    d->low_block = block;
+    d->pressure = false;
+    osiExitCritical(critical);
+}
+
+void osiMemPressureNotify(void)
+{
+    memReportContext_t *d = &gMemReportCtx;
+    if (d->work == NULL)
+        return;
+
+    d->forced = true;
+    osiWorkEnqueue(d->work, osiSysWorkQueueLowPriority());
+}
@@ -193,6 +193,35 @@ void osiPipeSetReaderCallback(osiPipe_t *pipe, unsigned mask, osiPipeEventCallba
     pipe->rd_cb = cb;
     pipe->rd_cb_ctx = ctx;
 }
+
+/**
+ * @brief 读取后的通知：读光数据时触发写完成回调，并唤醒写端
+ *
+ * @param pipe  管道对象指针
+ * @param all   是否读完了所有已写入的数据
+ */
+static void prvPipeReadDone(osiPipe_t *pipe, bool all)
+{
+    if (all)
+    {
+        if (pipe->wr_cb != NULL && (pipe->wr_cb_mask & OSI_PIPE_EVENT_TX_COMPLETE))
+            pipe->wr_cb(pipe->wr_cb_ctx, OSI_PIPE_EVENT_TX_COMPLETE);
+    }
+    osiSemaphoreRelease(pipe->wr_avail_sema);
+}
+
+/**
+ * @brief 写入后的通知：触发数据到达回调，并唤醒读端
+ *
+ * @param pipe  管道对象指针
+ */
+static void prvPipeWriteDone(osiPipe_t *pipe)
+{
+    if (pipe->rd_cb != NULL && (pipe->rd_cb_mask & OSI_PIPE_EVENT_RX_ARRIVED))
+        pipe->rd_cb(pipe->rd_cb_ctx, OSI_PIPE_EVENT_RX_ARRIVED);
+    osiSemaphoreRelease(pipe->rd_avail_sema);
+}
+
 /*
  * Function Name  : osiPipeRead
  * Description    : 从 osiPipe 管道中读取指定大小的数据，支持环形缓冲区管理、并发同步、EOF 检测、读回调通知等功能。
@@ -263,14 +292,9 @@ int osiPipeRead(osiPipe_t *pipe, void *buf, unsigned size)
     pipe->rd += len;
      // 退出临界区，允许其他线程访问管道
     osiExitCritical(critical);
-    // 如果这次读完了所有写入的数据（即读光了），触发写完成回调
-    if (len == bytes)
-    {
-        if (pipe->wr_cb != NULL && (pipe->wr_cb_mask & OSI_PIPE_EVENT_TX_COMPLETE))
-            pipe->wr_cb(pipe->wr_cb_ctx, OSI_PIPE_EVENT_TX_COMPLETE);
-    }
-    // 通知写端有空余空间可写（对应 wr_avail_sema）
-    osiSemaphoreRelease(pipe->wr_avail_sema);
+    // 如果这次读完了所有写入的数据（即读光了），触发写完成回调；
+    // 并通知写端有空余空间可写（对应 wr_avail_sema）
+    prvPipeReadDone(pipe, len == bytes);
     // 返回成功读取的字节数
     return len;
 }
@@ -348,16 +372,161 @@ int osiPipeWrite(osiPipe_t *pipe, const void *buf, unsigned size)
      * 2. 回调用于事件驱动式读取（异步/通知模型）
      */
 
-    // 如果有写入成功
+    // 若已注册读端回调，且回调事件包含“数据到达”，触发回调；
+    // 并通知读端有新数据可读
+    prvPipeWriteDone(pipe);
+    // 返回实际写入的长度
+    return len;
+}
+
+/**
+ * @brief       获取管道中可直接读取的连续数据区域（零拷贝读）
+ *
+ * @details
+ * 返回从读指针开始、到缓冲区末尾为止的连续数据，读指针不更新。
+ * 数据使用完后调用 osiPipeReadConsume() 释放。
+ * 数据环绕时，释放第一段后再次调用可以得到开头的第二段。
+ *
+ * 在 peek 和 consume 之间，只能有一个读者访问管道。
+ *
+ * @param pipe  管道对象指针
+ * @param buf   输出连续数据区域的首地址
+ * @return      连续数据的字节数，无数据返回 0，管道已关闭或参数非法返回 -1
+ */
+int osiPipeReadPeek(osiPipe_t *pipe, const void **buf)
+{
+    if (pipe == NULL || buf == NULL)
+        return -1;
+
+    uint32_t critical = osiEnterCritical();
+    unsigned bytes = pipe->wr - pipe->rd;
+    unsigned offset = pipe->rd % pipe->size;
+
+    if (!pipe->running)
+    {
+        osiExitCritical(critical);
+        return -1;
+    }
+
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_AUDIO
+    // 与 osiPipeRead 相同：已标记 data_done 且没有数据时，触发 EOF
+    if (pipe->data_done == 1 && bytes == 0)
+    {
+        osiExitCritical(critical);
+        osiPipeSetEof(pipe);
+        return -1;
+    }
+#endif
+    osiExitCritical(critical);
+
+    // 写端只会在读指针之前追加数据，区域在释放前不会被覆盖
+    *buf = &pipe->data[offset];
+    return OSI_MIN(unsigned, bytes, pipe->size - offset);
+}
+
+/**
+ * @brief       释放 osiPipeReadPeek() 得到的已读数据
+ *
+ * @details
+ * 更新读指针，并与 osiPipeRead() 相同地触发写端回调和唤醒写端。
+ *
+ * @param pipe  管道对象指针
+ * @param size  已读的字节数，超过可读数据时只释放可读部分
+ * @return      实际释放的字节数，管道已关闭或参数非法返回 -1
+ */
+int osiPipeReadConsume(osiPipe_t *pipe, unsigned size)
+{
+    if (pipe == NULL)
+        return -1;
+    if (size == 0)
+        return 0;
+
+    uint32_t critical = osiEnterCritical();
+    unsigned bytes = pipe->wr - pipe->rd;
+    unsigned len = OSI_MIN(unsigned, size, bytes);
+
+    if (!pipe->running)
+    {
+        osiExitCritical(critical);
+        return -1;
+    }
+
+    pipe->rd += len;
+    osiExitCritical(critical);
+
     if (len > 0)
+        prvPipeReadDone(pipe, len == bytes);
+    return len;
+}
+
+/**
+ * @brief       获取管道中可直接写入的连续空间（零拷贝写）
+ *
+ * @details
+ * 返回从写指针开始、到缓冲区末尾为止的连续空闲空间，写指针不更新。
+ * 数据写入后调用 osiPipeWriteCommit() 提交。
+ * 空间环绕时，提交第一段后再次调用可以得到开头的第二段。
+ *
+ * 在 reserve 和 commit 之间，只能有一个写者访问管道。
+ *
+ * @param pipe  管道对象指针
+ * @param buf   输出连续空闲空间的首地址
+ * @return      连续空闲空间的字节数，管道已满返回 0，
+ *              管道已关闭、已 EOF 或参数非法返回 -1
+ */
+int osiPipeWriteReserve(osiPipe_t *pipe, void **buf)
+{
+    if (pipe == NULL || buf == NULL)
+        return -1;
+
+    uint32_t critical = osiEnterCritical();
+    unsigned space = pipe->size - (pipe->wr - pipe->rd);
+    unsigned offset = pipe->wr % pipe->size;
+
+    if (!pipe->running || pipe->eof)
     {
-        // 若已注册读端回调，且回调事件包含“数据到达”
-        if (pipe->rd_cb != NULL && (pipe->rd_cb_mask & OSI_PIPE_EVENT_RX_ARRIVED))
-            pipe->rd_cb(pipe->rd_cb_ctx, OSI_PIPE_EVENT_RX_ARRIVED);
+        osiExitCritical(critical);
+        return -1;
     }
-    // 通知读端有新数据可读
-    osiSemaphoreRelease(pipe->rd_avail_sema);
-    // 返回实际写入的长度
+    osiExitCritical(critical);
+
+    // 读端只会释放写指针之前的数据，空间在提交前不会被读取
+    *buf = &pipe->data[offset];
+    return OSI_MIN(unsigned, space, pipe->size - offset);
+}
+
+/**
+ * @brief       提交 osiPipeWriteReserve() 得到的空间中已写入的数据
+ *
+ * @details
+ * 更新写指针，并与 osiPipeWrite() 相同地触发读端回调和唤醒读端。
+ *
+ * @param pipe  管道对象指针
+ * @param size  已写入的字节数，超过空闲空间时只提交空闲部分
+ * @return      实际提交的字节数，管道已关闭、已 EOF 或参数非法返回 -1
+ */
+int osiPipeWriteCommit(osiPipe_t *pipe, unsigned size)
+{
+    if (pipe == NULL)
+        return -1;
+    if (size == 0)
+        return 0;
+
+    uint32_t critical = osiEnterCritical();
+    unsigned space = pipe->size - (pipe->wr - pipe->rd);
+    unsigned len = OSI_MIN(unsigned, size, space);
+
+    if (!pipe->running || pipe->eof)
+    {
+        osiExitCritical(critical);
+        return -1;
+    }
+
+    pipe->wr += len;
+    osiExitCritical(critical);
+
+    if (len > 0)
+        prvPipeWriteDone(pipe);
     return len;
 }
 
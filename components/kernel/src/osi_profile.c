@@ -13,9 +13,13 @@
 #include "osi_api.h"
 #include "osi_profile.h"
 #include "osi_internal.h"
+#include "osi_api_inside.h"
 #include "osi_chip.h"
 #include "hwregs.h"
+#include "osi_byte_buf.h"
+#include "osi_trace.h"
 #include <assert.h>
+#include <string.h>
 
 static_assert(OSI_IS_ALIGNED(CONFIG_KERNEL_PROFILE_BUF_SIZE, 4),
               "CONFIG_KERNEL_PROFILE_BUF_SIZE should be 4 aligned");
@@ -27,13 +31,41 @@ typedef struct
     uint16_t pos;            // profile next write position, in word
     uint16_t size;           // profile buffer size, in word
     uint32_t freq;           // profile tick frequency
+    uint32_t total;          // profile words ever written, position is total % size
+#ifdef CONFIG_KERNEL_HOST_TRACE
+    osiTimer_t *stream_timer; // streaming timer, NULL when not streaming
+    uint32_t stream_rd;       // next profile word to be streamed, in total
+#endif
 } osiProfileContext_t;
 
+// host packet flow ID of profile streaming
+#define PROFILE_STREAM_FLOWID (0x71)
+// maximum profile words in one streaming packet
+#define PROFILE_STREAM_CHUNK_WORDS (256)
+
 #if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0)
 static uint32_t gProfileBuf[CONFIG_KERNEL_PROFILE_BUF_SIZE / 4];
 static osiProfileContext_t gProfileCtx;
 #endif
 
+#ifdef CONFIG_KERNEL_THREAD_CPU_STAT
+#define THREAD_STAT_COUNT (64) // the same as maximum thread count
+
+typedef struct
+{
+    unsigned id;          // thread number, 0 for unused
+    bool ready;           // made ready, and not running yet
+    uint32_t ready_tick;  // tick when made ready
+    uint32_t enter_tick;  // tick when switched in
+    uint64_t run_ticks;   // accumulated run ticks
+    uint32_t switch_count;
+    uint32_t max_latency; // maximum ticks from ready to running
+} osiThreadStatSlot_t;
+
+static osiThreadStatSlot_t gThreadStat[THREAD_STAT_COUNT];
+static unsigned gThreadStatCurrent; // thread number of running thread
+#endif
+
 /**
  * Tick value for profile
  */
@@ -64,6 +96,7 @@ void osiProfileInit(void)
     p->pos = 0;
     p->size = CONFIG_KERNEL_PROFILE_BUF_SIZE / 4;
     p->freq = prvProfileTickFreq();
+    p->total = 0;
 #endif
 }
 
@@ -76,6 +109,11 @@ void osiProfileSetMode(osiProfileMode_t mode)
     {
         p->mode = mode;
         p->pos = 0;
+        // keep position matching total, discarded words won't be streamed
+        p->total += (p->size - p->total % p->size) % p->size;
+#ifdef CONFIG_KERNEL_HOST_TRACE
+        p->stream_rd = p->total;
+#endif
     }
     osiExitCritical(critical);
 #endif
@@ -105,11 +143,13 @@ void osiProfileCode(unsigned code)
     if (tick_delta_hi > 1)
     {
         p->start_address[p->pos++] = (tick_delta_hi << 16) | 0;
+        p->total++;
         if (p->pos >= p->size)
             p->pos = 0;
     }
 
     p->start_address[p->pos++] = pcode;
+    p->total++;
     if (p->pos >= p->size)
         p->pos = 0;
 
@@ -131,14 +171,55 @@ void osiProfileExit(unsigned code)
 #endif
 }
 
+#ifdef CONFIG_KERNEL_THREAD_CPU_STAT
+/**
+ * Slot of thread statistics. Thread number isn't reused, and the slot
+ * of a deleted thread is taken over by the new thread.
+ */
+static osiThreadStatSlot_t *prvThreadStatSlot(unsigned id)
+{
+    osiThreadStatSlot_t *s = &gThreadStat[id % THREAD_STAT_COUNT];
+    if (s->id != id)
+    {
+        memset(s, 0, sizeof(*s));
+        s->id = id;
+    }
+    return s;
+}
+#endif
+
 void osiProfileThreadEnter(unsigned id)
 {
+#ifdef CONFIG_KERNEL_FLIGHT_REC_COUNT
+    osiFlightRecord(OSI_FLIGHT_THREAD, id, 0);
+#endif
+
 #if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0)
     unsigned code = id + PROFCODE_THREAD_START;
     if (code > PROFCODE_THREAD_END)
         code = PROFCODE_THREAD_END;
     osiProfileCode(code);
 #endif
+
+#ifdef CONFIG_KERNEL_IRQ_OFF_STAT_COUNT
+    osiIrqOffStatSwitch();
+#endif
+
+#ifdef CONFIG_KERNEL_THREAD_CPU_STAT
+    // called in context switch, interrupt is already disabled
+    osiThreadStatSlot_t *s = prvThreadStatSlot(id);
+    uint32_t tick = prvProfileTick();
+    s->enter_tick = tick;
+    s->switch_count++;
+    gThreadStatCurrent = id;
+    if (s->ready)
+    {
+        uint32_t latency = tick - s->ready_tick;
+        if (latency > s->max_latency)
+            s->max_latency = latency;
+        s->ready = false;
+    }
+#endif
 }
 
 void osiProfileThreadExit(unsigned id)
@@ -146,6 +227,115 @@ void osiProfileThreadExit(unsigned id)
     // coolprofile doen't need the event of thread exit
     // If thread exit event is inserted, coolprofile will show double
     // events at thread switch.
+
+#ifdef CONFIG_KERNEL_THREAD_CPU_STAT
+    osiThreadStatSlot_t *s = prvThreadStatSlot(id);
+    s->run_ticks += (uint32_t)(prvProfileTick() - s->enter_tick);
+#endif
+}
+
+void osiProfileThreadReady(unsigned id)
+{
+#ifdef CONFIG_KERNEL_THREAD_CPU_STAT
+    // called in scheduler critical section, or ISR
+    osiThreadStatSlot_t *s = prvThreadStatSlot(id);
+    if (!s->ready)
+    {
+        s->ready = true;
+        s->ready_tick = prvProfileTick();
+    }
+#endif
+}
+
+bool osiThreadCpuStat(unsigned id, osiThreadCpuStat_t *stat, bool reset)
+{
+#ifdef CONFIG_KERNEL_THREAD_CPU_STAT
+    if (stat == NULL || id == 0)
+        return false;
+
+    unsigned critical = osiEnterCritical();
+    osiThreadStatSlot_t *s = &gThreadStat[id % THREAD_STAT_COUNT];
+    if (s->id != id)
+    {
+        osiExitCritical(critical);
+        return false;
+    }
+
+    // run time of current thread is accumulated till now
+    uint64_t run_ticks = s->run_ticks;
+    uint32_t max_latency = s->max_latency;
+    if (id == gThreadStatCurrent)
+    {
+        uint32_t tick = prvProfileTick();
+        run_ticks += (uint32_t)(tick - s->enter_tick);
+        if (reset)
+            s->enter_tick = tick;
+    }
+
+    stat->id = id;
+    stat->switch_count = s->switch_count;
+    if (reset)
+    {
+        s->run_ticks = 0;
+        s->switch_count = 0;
+        s->max_latency = 0;
+    }
+    osiExitCritical(critical);
+
+    uint32_t freq = prvProfileTickFreq();
+    stat->run_time_us = run_ticks * 1000000 / freq;
+    stat->max_latency_us = (uint64_t)max_latency * 1000000 / freq;
+    return true;
+#else
+    return false;
+#endif
+}
+
+int osiThreadCpuStatDump(void *mem, unsigned size)
+{
+#ifdef CONFIG_KERNEL_THREAD_CPU_STAT
+    int count = 0;
+    for (unsigned n = 0; n < THREAD_STAT_COUNT; n++)
+    {
+        if (gThreadStat[n].id != 0)
+            count++;
+    }
+
+    int total = 2 + count * 20;
+    if (mem == NULL)
+        return total;
+    if (total > size)
+        return -1;
+
+    uint8_t *pmem = (uint8_t *)mem;
+    uint8_t *pcount = pmem;
+    OSI_STRM_WLE16(pmem, 0);
+
+    count = 0;
+    for (unsigned n = 0; n < THREAD_STAT_COUNT; n++)
+    {
+        osiThreadCpuStat_t stat;
+        if (gThreadStat[n].id == 0 || !osiThreadCpuStat(gThreadStat[n].id, &stat, false))
+            continue;
+
+        OSI_STRM_WLE32(pmem, stat.id);
+        OSI_STRM_WLE64(pmem, stat.run_time_us);
+        OSI_STRM_WLE32(pmem, stat.switch_count);
+        OSI_STRM_WLE32(pmem, stat.max_latency_us);
+        if (++count * 20 + 2 >= total)
+            break;
+    }
+
+    osiBytesPutLe16(pcount, count);
+    return 2 + count * 20;
+#else
+    if (mem == NULL)
+        return 2;
+    if (size < 2)
+        return -1;
+    osiBytesPutLe16(mem, 0);
+    return 2;
+#endif
 }
 
 void osiProfileIrqEnter(unsigned id)
@@ -212,3 +402,99 @@ unsigned osiProfileGetLastest(uint32_t *mem, unsigned size)
     return 0;
 #endif
 }
+
+#if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0) && defined(CONFIG_KERNEL_HOST_TRACE)
+/**
+ * Put new profile words to trace, in host packets of flow ID
+ * \p PROFILE_STREAM_FLOWID. Packet payload:
+ * - start word in total (LE32), host tool can find lost words by it
+ * - profile tick frequency (LE32)
+ * - profile words
+ *
+ * Words are put inside critical section, so they won't be overwritten
+ * during copy. When the trace buffer is full, the remaining will be put
+ * at next time. Words overwritten before put are lost.
+ */
+static void prvProfileStreamOutput(void *param)
+{
+    osiProfileContext_t *p = &gProfileCtx;
+    for (;;)
+    {
+        unsigned critical = osiEnterCritical();
+        if (p->stream_timer == NULL)
+        {
+            osiExitCritical(critical);
+            break;
+        }
+
+        if (p->total - p->stream_rd > p->size)
+            p->stream_rd = p->total - p->size;
+
+        unsigned offset = p->stream_rd % p->size;
+        unsigned count = p->total - p->stream_rd;
+        count = OSI_MIN(unsigned, count, p->size - offset);
+        count = OSI_MIN(unsigned, count, PROFILE_STREAM_CHUNK_WORDS);
+        if (count == 0)
+        {
+            osiExitCritical(critical);
+            break;
+        }
+
+        osiHostPacketHeader_t header;
+        uint32_t info[2] = {p->stream_rd, p->freq};
+        osiBuffer_t bufs[3] = {
+            {(uintptr_t)&header, sizeof(header)},
+            {(uintptr_t)info, sizeof(info)},
+            {(uintptr_t)(p->start_address + offset), count * 4},
+        };
+        unsigned tlen = sizeof(header) + sizeof(info) + count * 4;
+        osiFillHostHeader(&header, PROFILE_STREAM_FLOWID, tlen - sizeof(header));
+
+        bool ok = osiTraceBufPutMulti(bufs, 3, tlen);
+        if (ok)
+            p->stream_rd += count;
+        osiExitCritical(critical);
+
+        if (!ok)
+            break;
+    }
+}
+#endif
+
+bool osiProfileStreamStart(unsigned interval)
+{
+#if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0) && defined(CONFIG_KERNEL_HOST_TRACE)
+    osiProfileContext_t *p = &gProfileCtx;
+    if (interval == 0 || p->start_address == NULL)
+        return false;
+
+    if (p->stream_timer == NULL)
+    {
+        osiTimer_t *timer = osiTimerCreate(OSI_TIMER_IN_SERVICE, prvProfileStreamOutput, NULL);
+        if (timer == NULL)
+            return false;
+
+        unsigned critical = osiEnterCritical();
+        p->stream_rd = p->total;
+        p->stream_timer = timer;
+        osiExitCritical(critical);
+    }
+    return osiTimerStartPeriodic(p->stream_timer, interval);
+#else
+    return false;
+#endif
+}
+
+void osiProfileStreamStop(void)
+{
+#if (CONFIG_KERNEL_PROFILE_BUF_SIZE > 0) && defined(CONFIG_KERNEL_HOST_TRACE)
+    osiProfileContext_t *p = &gProfileCtx;
+    unsigned critical = osiEnterCritical();
+    osiTimer_t *timer = p->stream_timer;
+    p->stream_timer = NULL;
+    osiExitCritical(critical);
+
+    if (timer != NULL)
+        osiTimerDelete(timer);
+#endif
+}
@@ -0,0 +1,275 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "osi_slab.h"
+#include "osi_api.h"
+#include "osi_mem.h"
+#include "osi_compiler.h"
+#include <sys/queue.h>
+#include <string.h>
+
+static inline size_t prvHeapAllocSize(void *ptr)
+{
+    int size = osiMemAllocSize(ptr);
+    return (size > 0) ? size : 0;
+}
+
+#if defined(CONFIG_KERNEL_SLAB_POOL_SIZE) && (CONFIG_KERNEL_SLAB_POOL_SIZE > 0)
+
+// 2KB 页可以让各个尺寸的浪费都不超过 1/8，384 字节一页 5 块
+#define SLAB_PAGE_SIZE (2048)
+#define SLAB_PAGE_COUNT (CONFIG_KERNEL_SLAB_POOL_SIZE / SLAB_PAGE_SIZE)
+#define SLAB_CLASS_NONE (0xff)
+
+static const uint16_t gSlabBlockSize[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+
+typedef struct slabBlock
+{
+    struct slabBlock *next;
+} slabBlock_t;
+
+typedef TAILQ_ENTRY(slabPage) slabPageIter_t;
+typedef TAILQ_HEAD(slabPageHead, slabPage) slabPageHead_t;
+typedef struct slabPage
+{
+    slabPageIter_t iter; // 在分类的非满页队列，或空闲页队列中
+    slabBlock_t *free;   // 页内空闲块
+    uint8_t cls;         // 所属分类，SLAB_CLASS_NONE 表示空闲页
+    uint8_t reserved;
+    uint16_t used;       // 页内已分配块数
+} slabPage_t;
+
+typedef struct
+{
+    slabPageHead_t partial; // 有空闲块的页，队首优先分配
+    uint32_t page_count;
+    uint32_t used_count;
+    uint32_t peak_count;
+    uint32_t fallback;
+} slabClass_t;
+
+typedef struct
+{
+    bool inited;
+    unsigned brk;          // 从未使用过的页的起始，避免初始化时遍历所有页
+    slabPageHead_t free_pages;
+    slabClass_t cls[OSI_ARRAY_SIZE(gSlabBlockSize)];
+    slabPage_t pages[SLAB_PAGE_COUNT];
+} slabContext_t;
+
+static slabContext_t gSlabCtx;
+static uint8_t gSlabMem[SLAB_PAGE_COUNT * SLAB_PAGE_SIZE] OSI_ALIGNED(16);
+
+static int prvSlabClassIndex(size_t size)
+{
+    for (unsigned n = 0; n < OSI_ARRAY_SIZE(gSlabBlockSize); n++)
+    {
+        if (size <= gSlabBlockSize[n])
+            return n;
+    }
+    return -1;
+}
+
+static inline uint8_t *prvSlabPageMem(slabPage_t *page)
+{
+    return &gSlabMem[(page - &gSlabCtx.pages[0]) * SLAB_PAGE_SIZE];
+}
+
+/**
+ * get a free page and split to blocks, called in critical section
+ */
+static slabPage_t *prvSlabPageAlloc(slabContext_t *d, unsigned cls)
+{
+    slabPage_t *page = TAILQ_FIRST(&d->free_pages);
+    if (page != NULL)
+        TAILQ_REMOVE(&d->free_pages, page, iter);
+    else if (d->brk < SLAB_PAGE_COUNT)
+        page = &d->pages[d->brk++];
+    else
+        return NULL;
+
+    unsigned bsize = gSlabBlockSize[cls];
+    uint8_t *mem = prvSlabPageMem(page);
+    slabBlock_t **pnext = &page->free;
+    for (unsigned offset = 0; offset + bsize <= SLAB_PAGE_SIZE; offset += bsize)
+    {
+        slabBlock_t *block = (slabBlock_t *)(mem + offset);
+        *pnext = block;
+        pnext = &block->next;
+    }
+    *pnext = NULL;
+
+    page->cls = cls;
+    page->used = 0;
+    TAILQ_INSERT_HEAD(&d->cls[cls].partial, page, iter);
+    d->cls[cls].page_count++;
+    return page;
+}
+
+static void *prvSlabMalloc(size_t size)
+{
+    slabContext_t *d = &gSlabCtx;
+    int cls = prvSlabClassIndex(size);
+    if (cls < 0)
+        return osiMalloc(size);
+
+    uint32_t critical = osiEnterCritical();
+    if (!d->inited)
+    {
+        for (unsigned n = 0; n < OSI_ARRAY_SIZE(d->cls); n++)
+            TAILQ_INIT(&d->cls[n].partial);
+        TAILQ_INIT(&d->free_pages);
+        d->inited = true;
+    }
+
+    slabClass_t *c = &d->cls[cls];
+    slabPage_t *page = TAILQ_FIRST(&c->partial);
+    if (page == NULL)
+        page = prvSlabPageAlloc(d, cls);
+
+    if (page == NULL)
+    {
+        c->fallback++;
+        osiExitCritical(critical);
+        return osiMalloc(size);
+    }
+
+    slabBlock_t *block = page->free;
+    page->free = block->next;
+    page->used++;
+    if (page->free == NULL)
+        TAILQ_REMOVE(&c->partial, page, iter);
+
+    c->used_count++;
+    if (c->used_count > c->peak_count)
+        c->peak_count = c->used_count;
+    osiExitCritical(critical);
+    return block;
+}
+
+static size_t prvSlabAllocSize(void *ptr)
+{
+    uint8_t *p = (uint8_t *)ptr;
+    if (p < &gSlabMem[0] || p >= &gSlabMem[sizeof(gSlabMem)])
+        return prvHeapAllocSize(ptr);
+
+    slabPage_t *page = &gSlabCtx.pages[(p - &gSlabMem[0]) / SLAB_PAGE_SIZE];
+    return (page->cls == SLAB_CLASS_NONE) ? 0 : gSlabBlockSize[page->cls];
+}
+
+static void prvSlabFree(void *ptr)
+{
+    slabContext_t *d = &gSlabCtx;
+    uint8_t *p = (uint8_t *)ptr;
+    if (p < &gSlabMem[0] || p >= &gSlabMem[sizeof(gSlabMem)])
+    {
+        osiFree(ptr);
+        return;
+    }
+
+    uint32_t critical = osiEnterCritical();
+    slabPage_t *page = &d->pages[(p - &gSlabMem[0]) / SLAB_PAGE_SIZE];
+    if (page->cls == SLAB_CLASS_NONE || page->used == 0 ||
+        (p - prvSlabPageMem(page)) % gSlabBlockSize[page->cls] != 0)
+        osiPanic(); // 不是分配出去的块，或者重复释放
+
+    slabClass_t *c = &d->cls[page->cls];
+    slabBlock_t *block = (slabBlock_t *)p;
+    if (page->free == NULL)
+        TAILQ_INSERT_HEAD(&c->partial, page, iter);
+    block->next = page->free;
+    page->free = block;
+    page->used--;
+    c->used_count--;
+
+    // 空页还给页池，但保留分类的最后一个页，避免单个块反复申请释放时重复切页
+    if (page->used == 0 && (TAILQ_FIRST(&c->partial) != page || TAILQ_NEXT(page, iter) != NULL))
+    {
+        TAILQ_REMOVE(&c->partial, page, iter);
+        TAILQ_INSERT_HEAD(&d->free_pages, page, iter);
+        page->cls = SLAB_CLASS_NONE;
+        c->page_count--;
+    }
+    osiExitCritical(critical);
+}
+
+unsigned osiSlabClassCount(void)
+{
+    return OSI_ARRAY_SIZE(gSlabBlockSize);
+}
+
+bool osiSlabClassStat(unsigned index, osiSlabClassStat_t *stat)
+{
+    if (index >= OSI_ARRAY_SIZE(gSlabBlockSize) || stat == NULL)
+        return false;
+
+    uint32_t critical = osiEnterCritical();
+    slabClass_t *c = &gSlabCtx.cls[index];
+    stat->block_size = gSlabBlockSize[index];
+    stat->page_count = c->page_count;
+    stat->used_count = c->used_count;
+    stat->peak_count = c->peak_count;
+    stat->free_count = c->page_count * (SLAB_PAGE_SIZE / gSlabBlockSize[index]) - c->used_count;
+    stat->fallback = c->fallback;
+    osiExitCritical(critical);
+    return true;
+}
+
+#else
+
+static inline void *prvSlabMalloc(size_t size) { return osiMalloc(size); }
+static inline void prvSlabFree(void *ptr) { osiFree(ptr); }
+static inline size_t prvSlabAllocSize(void *ptr) { return prvHeapAllocSize(ptr); }
+unsigned osiSlabClassCount(void) { return 0; }
+bool osiSlabClassStat(unsigned index, osiSlabClassStat_t *stat) { return false; }
+
+#endif
+
+void *osiSlabMalloc(size_t size)
+{
+    void *ptr = prvSlabMalloc(size);
+    if (ptr == NULL && size > 0)
+        osiMemPressureNotify();
+    osiMemTrackAlloc(ptr, size, __builtin_return_address(0));
+    return ptr;
+}
+
+void *osiSlabCalloc(size_t nmemb, size_t size)
+{
+    size_t total;
+    if (__builtin_mul_overflow(nmemb, size, &total))
+        return NULL;
+
+    void *ptr = prvSlabMalloc(total);
+    if (ptr != NULL)
+        memset(ptr, 0, total);
+    else if (total > 0)
+        osiMemPressureNotify();
+    osiMemTrackAlloc(ptr, total, __builtin_return_address(0));
+    return ptr;
+}
+
+void osiSlabFree(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    osiMemTrackFree(ptr);
+    prvSlabFree(ptr);
+}
+
+size_t osiSlabAllocSize(void *ptr)
+{
+    if (ptr == NULL)
+        return 0;
+    return prvSlabAllocSize(ptr);
+}
@@ -16,6 +16,7 @@
 #include "osi_api.h"
 #include "osi_profile.h"
 #include "osi_internal.h"
+#include "osi_api_inside.h"
 #include "osi_chip.h"
 #include "osi_sysnv.h"
 #include "osi_byte_buf.h"
@@ -70,6 +71,11 @@ struct osiPmSource
     void *cb_ctx;
     bool active;
     osiPmSourceOps_t ops;
+
+    uint32_t lock_count;    // 唤醒锁次数
+    uint32_t blocked_count; // 阻止睡眠的次数
+    int64_t lock_time;      // 最近一次唤醒锁的时间
+    int64_t hold_ms;        // 累计持锁时间，不含当前这次
 };
 
 typedef SLIST_ENTRY(osiShutdownReg) osiShutdownRegIter_t;
@@ -93,6 +99,14 @@ typedef struct
 
     uint32_t boot_causes;
     uint32_t sleep32k_flags;
+
+    // 睡眠统计，回答“为什么没睡下去”
+    uint32_t blocked[OSI_PM_BLOCK_COUNT];
+    uint32_t suspend_count;
+    uint32_t wake_source[32];
+    unsigned cycle_pos;
+    unsigned cycle_count;
+    osiPmCycle_t cycles[OSI_PM_CYCLE_COUNT];
 } osiPmContext_t;
 
 static osiPmContext_t gOsiPmCtx;
@@ -232,6 +246,8 @@ void osiPmWakeLock(osiPmSource_t *ps)
     {
         TAILQ_REMOVE(&d->inactive_list, ps, state_iter);
         ps->active = true;
+        ps->lock_count++;
+        ps->lock_time = osiUpTime();
         if (ps->ops.prepare != NULL)
             TAILQ_INSERT_TAIL(&d->prepare_list, ps, state_iter);
         else
@@ -256,6 +272,7 @@ void osiPmWakeUnlock(osiPmSource_t *ps)
         else
             TAILQ_REMOVE(&d->active_list, ps, state_iter);
         ps->active = false;
+        ps->hold_ms += osiUpTime() - ps->lock_time;
         TAILQ_INSERT_TAIL(&d->inactive_list, ps, state_iter);
     }
 
@@ -386,21 +403,197 @@ int osiPmSourceDump(void *mem, unsigned size)
     return total;
 }
 
+/**
+ * get statistics of PM source, called in critical section
+ */
+static void prvSourceStatGet(osiPmSource_t *p, osiPmSourceStat_t *stat, int64_t now)
+{
+    stat->tag = p->tag;
+    stat->active = p->active;
+    stat->lock_count = p->lock_count;
+    stat->blocked_count = p->blocked_count;
+    stat->hold_ms = p->hold_ms + (p->active ? now - p->lock_time : 0);
+}
+
+int osiPmSourceStat(osiPmSourceStat_t *stats, unsigned count, bool reset)
+{
+    uint32_t critical = osiEnterCritical();
+    osiPmContext_t *d = &gOsiPmCtx;
+    osiPmSourceHead_t *lists[] = {&d->prepare_list, &d->active_list, &d->inactive_list};
+    int64_t now = osiUpTime();
+    int num = 0;
+
+    for (unsigned n = 0; n < OSI_ARRAY_SIZE(lists); n++)
+    {
+        osiPmSource_t *p;
+        TAILQ_FOREACH(p, lists[n], state_iter)
+        {
+            if (stats == NULL)
+                num++;
+            else if (num < count)
+                prvSourceStatGet(p, &stats[num++], now);
+
+            if (reset)
+            {
+                p->lock_count = 0;
+                p->blocked_count = 0;
+                p->hold_ms = 0;
+                p->lock_time = now;
+            }
+        }
+    }
+
+    osiExitCritical(critical);
+    return num;
+}
+
+void osiPmSleepStat(osiPmSleepStat_t *stat, bool reset)
+{
+    uint32_t critical = osiEnterCritical();
+    osiPmContext_t *d = &gOsiPmCtx;
+
+    memcpy(stat->blocked, d->blocked, sizeof(stat->blocked));
+    stat->suspend_count = d->suspend_count;
+    memcpy(stat->wake_source, d->wake_source, sizeof(stat->wake_source));
+    stat->cycle_count = d->cycle_count;
+    for (unsigned n = 0; n < d->cycle_count; n++)
+        stat->cycles[n] = d->cycles[(d->cycle_pos + OSI_PM_CYCLE_COUNT - 1 - n) % OSI_PM_CYCLE_COUNT];
+
+    if (reset)
+    {
+        memset(d->blocked, 0, sizeof(d->blocked));
+        d->suspend_count = 0;
+        memset(d->wake_source, 0, sizeof(d->wake_source));
+        d->cycle_pos = 0;
+        d->cycle_count = 0;
+    }
+    osiExitCritical(critical);
+}
+
+int osiPmStatDump(void *mem, unsigned size)
+{
+    uint32_t critical = osiEnterCritical();
+    osiPmContext_t *d = &gOsiPmCtx;
+    osiPmSourceHead_t *lists[] = {&d->prepare_list, &d->active_list, &d->inactive_list};
+
+    int source_count = 0;
+    osiPmSource_t *p;
+    for (unsigned n = 0; n < OSI_ARRAY_SIZE(lists); n++)
+    {
+        TAILQ_FOREACH(p, lists[n], state_iter)
+        {
+            source_count++;
+        }
+    }
+
+    int total = 2 + source_count * 17 + 1 + OSI_PM_BLOCK_COUNT * 4 + 4 +
+                OSI_ARRAY_SIZE(d->wake_source) * 4 + 1 + d->cycle_count * 17;
+    if (mem == NULL)
+    {
+        osiExitCritical(critical);
+        return total;
+    }
+    if (total > size)
+    {
+        osiExitCritical(critical);
+        return -1;
+    }
+
+    int64_t now = osiUpTime();
+    uint8_t *pmem = (uint8_t *)mem;
+    OSI_STRM_WLE16(pmem, source_count);
+    for (unsigned n = 0; n < OSI_ARRAY_SIZE(lists); n++)
+    {
+        TAILQ_FOREACH(p, lists[n], state_iter)
+        {
+            osiPmSourceStat_t stat;
+            prvSourceStatGet(p, &stat, now);
+            OSI_STRM_WLE32(pmem, stat.tag);
+            OSI_STRM_WLE32(pmem, stat.lock_count);
+            OSI_STRM_WLE32(pmem, stat.blocked_count);
+            OSI_STRM_WLE32(pmem, stat.hold_ms);
+            OSI_STRM_W8(pmem, stat.active ? 1 : 0);
+        }
+    }
+
+    OSI_STRM_W8(pmem, OSI_PM_BLOCK_COUNT);
+    for (unsigned n = 0; n < OSI_PM_BLOCK_COUNT; n++)
+        OSI_STRM_WLE32(pmem, d->blocked[n]);
+
+    OSI_STRM_WLE32(pmem, d->suspend_count);
+    for (unsigned n = 0; n < OSI_ARRAY_SIZE(d->wake_source); n++)
+        OSI_STRM_WLE32(pmem, d->wake_source[n]);
+
+    OSI_STRM_W8(pmem, d->cycle_count);
+    for (unsigned n = 0; n < d->cycle_count; n++)
+    {
+        osiPmCycle_t *c = &d->cycles[(d->cycle_pos + OSI_PM_CYCLE_COUNT - 1 - n) % OSI_PM_CYCLE_COUNT];
+        OSI_STRM_WLE64(pmem, c->suspend_time);
+        OSI_STRM_WLE32(pmem, c->sleep_ms);
+        OSI_STRM_WLE32(pmem, c->source);
+        OSI_STRM_W8(pmem, c->sleep32k ? 1 : 0);
+    }
+
+    osiExitCritical(critical);
+    return total;
+}
+
+/**
+ * account sleep blocked by wake locked PM sources
+ */
+static void prvSourceBlocked(osiPmContext_t *d)
+{
+    osiPmSource_t *p;
+    TAILQ_FOREACH(p, &d->active_list, state_iter)
+    {
+        p->blocked_count++;
+    }
+    d->blocked[OSI_PM_BLOCK_SOURCE]++;
+}
+
+/**
+ * account a suspend/resume cycle
+ */
+static void prvSleepCycle(osiPmContext_t *d, bool sleep32k, int64_t suspend_time, uint32_t source)
+{
+    osiPmCycle_t *c = &d->cycles[d->cycle_pos];
+    c->suspend_time = suspend_time;
+    c->sleep_ms = osiUpTime() - suspend_time;
+    c->source = source;
+    c->sleep32k = sleep32k;
+    d->cycle_pos = (d->cycle_pos + 1) % OSI_PM_CYCLE_COUNT;
+    if (d->cycle_count < OSI_PM_CYCLE_COUNT)
+        d->cycle_count++;
+
+    d->suspend_count++;
+    for (uint32_t bits = source; bits != 0; bits &= bits - 1)
+        d->wake_source[__builtin_ctz(bits)]++;
+}
+
 static bool prvSuspendPermitted(osiPmContext_t *d)
 {
     if (!d->started)
         return false;
 
     if (!TAILQ_EMPTY(&d->active_list))
+    {
+        prvSourceBlocked(d);
         return false;
+    }
 
 #ifndef CONFIG_QUEC_PROJECT_FEATURE_SLEEP
     if (!osiIsSlowSysClkAllowed())
+    {
+        d->blocked[OSI_PM_BLOCK_SYSCLK]++;
         return false;
+    }
 #endif
 
     if (!osiChipSuspendPermitted())
+    {
+        d->blocked[OSI_PM_BLOCK_CHIP]++;
         return false;
+    }
 
     bool prepare_ok = true;
     osiPmSource_t *p;
@@ -412,6 +605,8 @@ static bool prvSuspendPermitted(osiPmContext_t *d)
         if (!p->ops.prepare(p->cb_ctx))
         {
             OSI_LOGD(0, "prepare cb %4c failed", p->tag);
+            p->blocked_count++;
+            d->blocked[OSI_PM_BLOCK_PREPARE]++;
             prepare_ok = false;
             break;
         }
@@ -455,10 +650,16 @@ static bool prv32KSleepPermitted(osiPmContext_t *d)
         return false;
     // 活跃任务队列非空，表示还有模块未准备好，不允许进入睡眠
     if (!TAILQ_EMPTY(&d->active_list))
+    {
+        prvSourceBlocked(d);
         return false;
+    }
     // 芯片级别不允许 suspend，例如当前有外设阻止睡眠
     if (!osiChipSuspendPermitted())
+    {
+        d->blocked[OSI_PM_BLOCK_CHIP]++;
         return false;
+    }
     // 所有条件满足，可以进入 32K 低功耗睡眠
     return true;
 }
@@ -484,6 +685,7 @@ static void prvSuspend(osiPmContext_t *d, osiSuspendMode_t mode, int64_t sleep_m
         }
     }
 
+    int64_t suspend_time = osiUpTime();
     osiProfileEnter(PROFCODE_DEEP_SLEEP);
     WDT_ENTER_DEEPSLEEP(OSI_MIN(int64_t, osiCpDeepSleepTime(), sleep_ms) + SUSPEND_WDT_MARGIN_TIME);
     halSysWdtStop();
@@ -494,6 +696,7 @@ static void prvSuspend(osiPmContext_t *d, osiSuspendMode_t mode, int64_t sleep_m
     OSI_LOGI(0, "suspend resume source 0x%08x", source);
 
     osiChipResume(mode, source);
+    prvSleepCycle(d, false, suspend_time, source);
 
     halSysWdtStart();
     WDT_EXIT_DEEPSLEEP();
@@ -526,12 +729,14 @@ static void prv32KSleep(osiPmContext_t *d, int64_t sleep_ms)
 	quec_enter_sleep_cb();
 #endif
 
+    int64_t suspend_time = osiUpTime();
     osiProfileEnter(PROFCODE_DEEP_SLEEP);
     halSysWdtStop();
 
     WDT_ENTER_DEEPSLEEP(OSI_MIN(int64_t, osiCpDeepSleepTime(), sleep_ms) + SUSPEND_WDT_MARGIN_TIME);
     uint32_t source = osiChip32KSleep(sleep_ms);
     OSI_LOGI(0, "suspend resume source 0x%08x", source);
+    prvSleepCycle(d, true, suspend_time, source);
 
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_SLEEP
 	//ql_data_lock_timer_start(source);
@@ -575,6 +780,7 @@ static void prvSleepLocked(uint32_t idle_tick)
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_SLEEP
             	if(FALSE == ql_is_data_lock_allow_sleep())
             	{
+                    d->blocked[OSI_PM_BLOCK_DATA_LOCK]++;
                     ql_enter_sleep_delay_timer_start();   
             		prvLightSleep(d, idle_tick);        
             		return;
@@ -583,6 +789,7 @@ static void prvSleepLocked(uint32_t idle_tick)
                 prv32KSleep(d, deep_sleep_ms);
                 return;
             }
+            d->blocked[OSI_PM_BLOCK_SHORT]++;
         }
     }
     else
@@ -596,6 +803,7 @@ static void prvSleepLocked(uint32_t idle_tick)
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_SLEEP
             	if(FALSE == ql_is_data_lock_allow_sleep())
             	{
+                    d->blocked[OSI_PM_BLOCK_DATA_LOCK]++;
                     ql_enter_sleep_delay_timer_start();   
             		prvLightSleep(d, idle_tick);        
             		return;
@@ -604,6 +812,7 @@ static void prvSleepLocked(uint32_t idle_tick)
                 prvSuspend(d, mode, deep_sleep_ms);
                 return;
             }
+            d->blocked[OSI_PM_BLOCK_SHORT]++;
         }
     }
 
@@ -0,0 +1,138 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+
+#include "osi_spsc_ring.h"
+#include "osi_compiler.h"
+#include <string.h>
+
+bool osiSpscRingInit(osiSpscRing_t *ring, void *data, size_t size)
+{
+    // 大小必须是 2 的幂，偏移才能用掩码计算，逻辑位置才能自然回绕
+    if (ring == NULL || data == NULL || size == 0 || !OSI_IS_POW2(size))
+        return false;
+
+    ring->data = (uint8_t *)data;
+    ring->size = size;
+    ring->rd = 0;
+    ring->wr = 0;
+    ring->notify = NULL;
+    ring->notify_ctx = NULL;
+    return true;
+}
+
+void osiSpscRingSetNotify(osiSpscRing_t *ring, osiCallback_t notify, void *ctx)
+{
+    ring->notify = notify;
+    ring->notify_ctx = ctx;
+}
+
+void osiSpscRingReset(osiSpscRing_t *ring)
+{
+    ring->rd = 0;
+    ring->wr = 0;
+}
+
+void *osiSpscRingWritePeek(osiSpscRing_t *ring, size_t *len)
+{
+    // 写指针只由自己更新；读指针用 acquire，保证读取方读完的数据才被覆盖
+    uint32_t wr = ring->wr;
+    uint32_t space = ring->size - (wr - __atomic_load_n(&ring->rd, __ATOMIC_ACQUIRE));
+    uint32_t offset = wr & (ring->size - 1);
+    uint32_t tail = ring->size - offset;
+
+    *len = OSI_MIN(uint32_t, space, tail);
+    return (*len == 0) ? NULL : ring->data + offset;
+}
+
+void osiSpscRingWriteCommit(osiSpscRing_t *ring, size_t len)
+{
+    if (len == 0)
+        return;
+
+    // release：数据写入在写指针更新之前对读取方可见
+    __atomic_store_n(&ring->wr, ring->wr + len, __ATOMIC_RELEASE);
+    if (ring->notify != NULL)
+        ring->notify(ring->notify_ctx);
+}
+
+const void *osiSpscRingReadPeek(osiSpscRing_t *ring, size_t *len)
+{
+    // 读指针只由自己更新；写指针用 acquire，保证看到写入方已写的数据
+    uint32_t rd = ring->rd;
+    uint32_t bytes = __atomic_load_n(&ring->wr, __ATOMIC_ACQUIRE) - rd;
+    uint32_t offset = rd & (ring->size - 1);
+    uint32_t tail = ring->size - offset;
+
+    *len = OSI_MIN(uint32_t, bytes, tail);
+    return (*len == 0) ? NULL : ring->data + offset;
+}
+
+void osiSpscRingReadCommit(osiSpscRing_t *ring, size_t len)
+{
+    // release：数据读取完成后，写入方才能覆盖
+    if (len != 0)
+        __atomic_store_n(&ring->rd, ring->rd + len, __ATOMIC_RELEASE);
+}
+
+size_t osiSpscRingPut(osiSpscRing_t *ring, const void *data, size_t size)
+{
+    if (data == NULL || size == 0)
+        return 0;
+
+    uint32_t wr = ring->wr;
+    size_t len = ring->size - (wr - __atomic_load_n(&ring->rd, __ATOMIC_ACQUIRE));
+    if (len > size)
+        len = size;
+
+    // 需要回绕时分两段写入，合并为一次提交，只通知一次
+    uint32_t offset = wr & (ring->size - 1);
+    size_t tail = ring->size - offset;
+    if (tail >= len)
+    {
+        memcpy(ring->data + offset, data, len);
+    }
+    else
+    {
+        memcpy(ring->data + offset, data, tail);
+        memcpy(ring->data, (const uint8_t *)data + tail, len - tail);
+    }
+
+    osiSpscRingWriteCommit(ring, len);
+    return len;
+}
+
+size_t osiSpscRingGet(osiSpscRing_t *ring, void *data, size_t size)
+{
+    if (data == NULL || size == 0)
+        return 0;
+
+    uint32_t rd = ring->rd;
+    size_t len = __atomic_load_n(&ring->wr, __ATOMIC_ACQUIRE) - rd;
+    if (len > size)
+        len = size;
+
+    uint32_t offset = rd & (ring->size - 1);
+    size_t tail = ring->size - offset;
+    if (tail >= len)
+    {
+        memcpy(data, ring->data + offset, len);
+    }
+    else
+    {
+        memcpy(data, ring->data + offset, tail);
+        memcpy((uint8_t *)data + tail, ring->data, len - tail);
+    }
+
+    osiSpscRingReadCommit(ring, len);
+    return len;
+}
@@ -0,0 +1,272 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "osi_api.h"
+#include "osi_api_inside.h"
+#include "osi_log.h"
+#include "osi_byte_buf.h"
+#include "vfs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CONFIG_KERNEL_STACK_MON_COUNT
+
+#define STACK_MON_FNAME CONFIG_FS_AP_NVM_DIR "/stack_mon.nv"
+#define STACK_MON_MAGIC (0x4d4b5453) // STKM
+#define STACK_MON_VERSION (1)
+#define STACK_MON_HEADER_SIZE (8)
+#define STACK_MON_RECORD_SIZE (OSI_STACK_MON_NAME_LEN + 8)
+#define STACK_MON_INTERVAL (60 * 1000)
+#define STACK_MON_SAVE_SAMPLES (10)
+
+typedef struct
+{
+    char name[OSI_STACK_MON_NAME_LEN];
+    uint32_t alloc_size;
+    uint32_t max_used;
+} stackMonRecord_t;
+
+typedef struct
+{
+    osiMutex_t *lock;
+    osiWork_t *work;
+    osiTimer_t *timer;
+    bool dirty;       // records changed after last save
+    unsigned samples; // samples after last save
+    unsigned count;
+    stackMonRecord_t records[CONFIG_KERNEL_STACK_MON_COUNT];
+} stackMonContext_t;
+
+static stackMonContext_t gStackMon;
+
+static uint32_t prvStackMonRecommend(uint32_t max_used)
+{
+    return OSI_ALIGN_UP(max_used + OSI_MAX(uint32_t, max_used / 4, 256), 256);
+}
+
+/**
+ * find record by name, or create it. Called with lock.
+ */
+static stackMonRecord_t *prvStackMonRecord(stackMonContext_t *d, const char *name)
+{
+    for (unsigned n = 0; n < d->count; n++)
+    {
+        if (strncmp(d->records[n].name, name, OSI_STACK_MON_NAME_LEN - 1) == 0)
+            return &d->records[n];
+    }
+
+    if (d->count >= CONFIG_KERNEL_STACK_MON_COUNT)
+        return NULL;
+
+    stackMonRecord_t *r = &d->records[d->count++];
+    memset(r, 0, sizeof(*r));
+    strncpy(r->name, name, OSI_STACK_MON_NAME_LEN - 1);
+    return r;
+}
+
+static void prvStackMonLoad(stackMonContext_t *d)
+{
+    vfs_sfile_init(STACK_MON_FNAME);
+    int file_size = vfs_sfile_size(STACK_MON_FNAME);
+    if (file_size < STACK_MON_HEADER_SIZE)
+        return;
+
+    uint8_t *buf = (uint8_t *)calloc(1, file_size);
+    if (buf == NULL)
+        return;
+
+    if (vfs_sfile_read(STACK_MON_FNAME, buf, file_size) != file_size)
+        goto done;
+
+    const uint8_t *p = buf;
+    uint32_t magic = OSI_STRM_RLE32(p);
+    unsigned version = OSI_STRM_RLE16(p);
+    unsigned count = OSI_STRM_RLE16(p);
+    if (magic != STACK_MON_MAGIC || version != STACK_MON_VERSION ||
+        file_size < STACK_MON_HEADER_SIZE + count * STACK_MON_RECORD_SIZE)
+    {
+        OSI_LOGE(0, "stack mon nv invalid, size/%d", file_size);
+        goto done;
+    }
+
+    d->count = 0;
+    for (unsigned n = 0; n < count && n < CONFIG_KERNEL_STACK_MON_COUNT; n++)
+    {
+        stackMonRecord_t *r = &d->records[d->count++];
+        memcpy(r->name, p, OSI_STACK_MON_NAME_LEN);
+        r->name[OSI_STACK_MON_NAME_LEN - 1] = '\0';
+        p += OSI_STACK_MON_NAME_LEN;
+        r->alloc_size = OSI_STRM_RLE32(p);
+        r->max_used = OSI_STRM_RLE32(p);
+    }
+    OSI_LOGI(0, "stack mon nv loaded, count/%d", d->count);
+
+done:
+    free(buf);
+}
+
+bool osiStackMonSave(void)
+{
+    stackMonContext_t *d = &gStackMon;
+    if (d->lock == NULL)
+        return false;
+
+    unsigned size = STACK_MON_HEADER_SIZE + CONFIG_KERNEL_STACK_MON_COUNT * STACK_MON_RECORD_SIZE;
+    uint8_t *buf = (uint8_t *)calloc(1, size);
+    if (buf == NULL)
+        return false;
+
+    osiMutexLock(d->lock);
+    uint8_t *p = buf;
+    OSI_STRM_WLE32(p, STACK_MON_MAGIC);
+    OSI_STRM_WLE16(p, STACK_MON_VERSION);
+    OSI_STRM_WLE16(p, d->count);
+    for (unsigned n = 0; n < d->count; n++)
+    {
+        stackMonRecord_t *r = &d->records[n];
+        memcpy(p, r->name, OSI_STACK_MON_NAME_LEN);
+        p += OSI_STACK_MON_NAME_LEN;
+        OSI_STRM_WLE32(p, r->alloc_size);
+        OSI_STRM_WLE32(p, r->max_used);
+    }
+    d->dirty = false;
+    d->samples = 0;
+    osiMutexUnlock(d->lock);
+
+    int len = p - buf;
+    bool ok = (vfs_sfile_write(STACK_MON_FNAME, buf, len) == len);
+    if (!ok)
+        OSI_LOGE(0, "stack mon nv save failed");
+    free(buf);
+    return ok;
+}
+
+void osiStackMonSample(void)
+{
+    stackMonContext_t *d = &gStackMon;
+    if (d->lock == NULL)
+        return;
+
+    // threads may be created after counted
+    unsigned count = osiThreadCount() + 4;
+    osiThreadStatus_t *status = (osiThreadStatus_t *)malloc(count * sizeof(osiThreadStatus_t));
+    if (status == NULL)
+        return;
+
+    count = osiThreadGetAllStatus(status, count);
+
+    osiMutexLock(d->lock);
+    for (unsigned n = 0; n < count; n++)
+    {
+        osiThreadStatus_t *s = &status[n];
+        if (s->name == NULL || s->stack_alloc_size == 0)
+            continue;
+
+        stackMonRecord_t *r = prvStackMonRecord(d, s->name);
+        if (r == NULL)
+            continue;
+
+        uint32_t used = s->stack_alloc_size - s->stack_min_remained;
+        r->alloc_size = s->stack_alloc_size;
+        if (used > r->max_used)
+        {
+            OSI_LOGD(0, "stack mon %d used/%d size/%d", n, used, s->stack_alloc_size);
+            r->max_used = used;
+            d->dirty = true;
+        }
+    }
+    bool save = d->dirty && (++d->samples >= STACK_MON_SAVE_SAMPLES);
+    osiMutexUnlock(d->lock);
+    free(status);
+
+    if (save)
+        osiStackMonSave();
+}
+
+static void prvStackMonRun(void *param)
+{
+    osiStackMonSample();
+}
+
+bool osiStackMonStart(void)
+{
+    stackMonContext_t *d = &gStackMon;
+    if (d->lock != NULL)
+        return true;
+
+    d->lock = osiMutexCreate();
+    d->work = osiWorkCreate(prvStackMonRun, NULL, NULL);
+    d->timer = osiTimerCreateWork(d->work, osiSysWorkQueueLowPriority());
+    if (d->lock == NULL || d->work == NULL || d->timer == NULL)
+    {
+        osiTimerDelete(d->timer);
+        osiWorkDelete(d->work);
+        osiMutexDelete(d->lock);
+        d->lock = NULL;
+        return false;
+    }
+
+    prvStackMonLoad(d);
+    osiTimerStartPeriodicRelaxed(d->timer, STACK_MON_INTERVAL, OSI_DELAY_MAX);
+    osiWorkEnqueue(d->work, osiSysWorkQueueLowPriority());
+    return true;
+}
+
+void osiStackMonClear(void)
+{
+    stackMonContext_t *d = &gStackMon;
+    if (d->lock == NULL)
+        return;
+
+    osiMutexLock(d->lock);
+    d->count = 0;
+    d->dirty = false;
+    d->samples = 0;
+    vfs_unlink(STACK_MON_FNAME);
+    osiMutexUnlock(d->lock);
+}
+
+int osiStackMonGet(osiStackMonRecord_t *records, unsigned count)
+{
+    stackMonContext_t *d = &gStackMon;
+    if (d->lock == NULL)
+        return 0;
+
+    osiMutexLock(d->lock);
+    unsigned n = d->count;
+    if (records != NULL)
+    {
+        n = OSI_MIN(unsigned, n, count);
+        for (unsigned i = 0; i < n; i++)
+        {
+            stackMonRecord_t *r = &d->records[i];
+            memcpy(records[i].name, r->name, OSI_STACK_MON_NAME_LEN);
+            records[i].alloc_size = r->alloc_size;
+            records[i].max_used = r->max_used;
+            records[i].recommended = prvStackMonRecommend(r->max_used);
+        }
+    }
+    osiMutexUnlock(d->lock);
+    return (int)n;
+}
+
+#else
+
+bool osiStackMonStart(void) { return false; }
+void osiStackMonSample(void) {}
+bool osiStackMonSave(void) { return false; }
+void osiStackMonClear(void) {}
+int osiStackMonGet(osiStackMonRecord_t *records, unsigned count) { return 0; }
+
+#endif
@@ -0,0 +1,317 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "kernel_config.h"
+#include "osi_compiler.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(CONFIG_KERNEL_NEON_STRING) && defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+/**
+ * NEON memcpy, memmove, memset and memcmp, replacing the generic ones
+ * in newlib. The application link forces these symbols undefined, so
+ * they are taken from this library rather than libc.
+ *
+ * - Less than \p STR_SMALL bytes are handled by bytes, without setup.
+ * - Destination is aligned to 16 bytes by a byte prologue, and source
+ *   is loaded unaligned.
+ * - Main loop handles \p STR_BLOCK bytes, and prefetches source
+ *   \p STR_PLD_AHEAD bytes ahead with one PLD per cache line.
+ *
+ * Only byte element loads and stores are used, so unaligned source is
+ * safe even before MMU is enabled. FPU is enabled at the beginning of
+ * boot and wakeup, before any of these can be called. NEON registers
+ * used here are caller saved, and they are saved by IRQ entry.
+ */
+
+#ifndef CONFIG_CACHE_LINE_SIZE
+#define CONFIG_CACHE_LINE_SIZE (32)
+#endif
+
+#define STR_SMALL (16)
+#define STR_BLOCK (64)
+#define STR_PLD_AHEAD (4 * CONFIG_CACHE_LINE_SIZE)
+
+#define STR_PREFETCH(p)                                                     \
+    do                                                                      \
+    {                                                                       \
+        for (unsigned _n = 0; _n < STR_BLOCK; _n += CONFIG_CACHE_LINE_SIZE) \
+            __builtin_prefetch((const uint8_t *)(p) + _n);                  \
+    } while (0)
+
+static inline void prvCopyBytes(uint8_t *d, const uint8_t *s, size_t n)
+{
+    while (n-- > 0)
+        *d++ = *s++;
+}
+
+static inline void prvCopyBytesBackward(uint8_t *d, const uint8_t *s, size_t n)
+{
+    d += n;
+    s += n;
+    while (n-- > 0)
+        *--d = *--s;
+}
+
+static inline size_t prvAlignHead(const void *p)
+{
+    return (-(uintptr_t)p) & 15;
+}
+
+/**
+ * Forward copy. It is safe for overlapped buffers with \p d < \p s,
+ * due to each block is loaded before stored.
+ */
+static void prvCopyForward(uint8_t *d, const uint8_t *s, size_t n)
+{
+    if (n < STR_SMALL)
+    {
+        prvCopyBytes(d, s, n);
+        return;
+    }
+
+    size_t head = prvAlignHead(d);
+    prvCopyBytes(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    for (; n >= STR_BLOCK; n -= STR_BLOCK)
+    {
+        STR_PREFETCH(s + STR_PLD_AHEAD);
+        uint8x16_t v0 = vld1q_u8(s);
+        uint8x16_t v1 = vld1q_u8(s + 16);
+        uint8x16_t v2 = vld1q_u8(s + 32);
+        uint8x16_t v3 = vld1q_u8(s + 48);
+        vst1q_u8(d, v0);
+        vst1q_u8(d + 16, v1);
+        vst1q_u8(d + 32, v2);
+        vst1q_u8(d + 48, v3);
+        d += STR_BLOCK;
+        s += STR_BLOCK;
+    }
+
+    for (; n >= 16; n -= 16)
+    {
+        vst1q_u8(d, vld1q_u8(s));
+        d += 16;
+        s += 16;
+    }
+
+    prvCopyBytes(d, s, n);
+}
+
+/**
+ * Backward copy, for overlapped buffers with \p d > \p s. It is the
+ * mirror of \p prvCopyForward, and the end of destination is aligned.
+ */
+static void prvCopyBackward(uint8_t *d, const uint8_t *s, size_t n)
+{
+    if (n < STR_SMALL)
+    {
+        prvCopyBytesBackward(d, s, n);
+        return;
+    }
+
+    d += n;
+    s += n;
+    size_t tail = (uintptr_t)d & 15;
+    d -= tail;
+    s -= tail;
+    n -= tail;
+    prvCopyBytesBackward(d, s, tail);
+
+    for (; n >= STR_BLOCK; n -= STR_BLOCK)
+    {
+        d -= STR_BLOCK;
+        s -= STR_BLOCK;
+        STR_PREFETCH(s - STR_PLD_AHEAD);
+        uint8x16_t v0 = vld1q_u8(s);
+        uint8x16_t v1 = vld1q_u8(s + 16);
+        uint8x16_t v2 = vld1q_u8(s + 32);
+        uint8x16_t v3 = vld1q_u8(s + 48);
+        vst1q_u8(d + 48, v3);
+        vst1q_u8(d + 32, v2);
+        vst1q_u8(d + 16, v1);
+        vst1q_u8(d, v0);
+    }
+
+    for (; n >= 16; n -= 16)
+    {
+        d -= 16;
+        s -= 16;
+        vst1q_u8(d, vld1q_u8(s));
+    }
+
+    prvCopyBytesBackward(d - n, s - n, n);
+}
+
+static void prvFill(uint8_t *d, uint8_t c, size_t n)
+{
+    if (n < STR_SMALL)
+    {
+        while (n-- > 0)
+            *d++ = c;
+        return;
+    }
+
+    size_t head = prvAlignHead(d);
+    n -= head;
+    while (head-- > 0)
+        *d++ = c;
+
+    // No PLD for destination, stores don't allocate cache lines
+    uint8x16_t v = vdupq_n_u8(c);
+    for (; n >= STR_BLOCK; n -= STR_BLOCK)
+    {
+        vst1q_u8(d, v);
+        vst1q_u8(d + 16, v);
+        vst1q_u8(d + 32, v);
+        vst1q_u8(d + 48, v);
+        d += STR_BLOCK;
+    }
+
+    for (; n >= 16; n -= 16)
+    {
+        vst1q_u8(d, v);
+        d += 16;
+    }
+
+    while (n-- > 0)
+        *d++ = c;
+}
+
+static inline int prvCompareBytes(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    for (; n > 0; n--, a++, b++)
+    {
+        if (*a != *b)
+            return *a - *b;
+    }
+    return 0;
+}
+
+/**
+ * Whether any byte is not zero
+ */
+static inline bool prvAnyNonZero(uint8x16_t v)
+{
+    uint32x2_t t = vreinterpret_u32_u8(vorr_u8(vget_low_u8(v), vget_high_u8(v)));
+    return (vget_lane_u32(t, 0) | vget_lane_u32(t, 1)) != 0;
+}
+
+/**
+ * Blocks are compared by XOR, and the first different byte is located
+ * by bytes inside the different block only.
+ */
+static int prvCompare(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    if (n < STR_SMALL)
+        return prvCompareBytes(a, b, n);
+
+    for (; n >= STR_BLOCK; n -= STR_BLOCK)
+    {
+        STR_PREFETCH(a + STR_PLD_AHEAD);
+        STR_PREFETCH(b + STR_PLD_AHEAD);
+        uint8x16_t x0 = veorq_u8(vld1q_u8(a), vld1q_u8(b));
+        uint8x16_t x1 = veorq_u8(vld1q_u8(a + 16), vld1q_u8(b + 16));
+        uint8x16_t x2 = veorq_u8(vld1q_u8(a + 32), vld1q_u8(b + 32));
+        uint8x16_t x3 = veorq_u8(vld1q_u8(a + 48), vld1q_u8(b + 48));
+        if (prvAnyNonZero(vorrq_u8(vorrq_u8(x0, x1), vorrq_u8(x2, x3))))
+            return prvCompareBytes(a, b, STR_BLOCK);
+        a += STR_BLOCK;
+        b += STR_BLOCK;
+    }
+
+    for (; n >= 16; n -= 16)
+    {
+        if (prvAnyNonZero(veorq_u8(vld1q_u8(a), vld1q_u8(b))))
+            return prvCompareBytes(a, b, 16);
+        a += 16;
+        b += 16;
+    }
+
+    return prvCompareBytes(a, b, n);
+}
+
+void *memcpy(void *dest, const void *src, size_t n)
+{
+    prvCopyForward((uint8_t *)dest, (const uint8_t *)src, n);
+    return dest;
+}
+
+void *memmove(void *dest, const void *src, size_t n)
+{
+    uint8_t *d = (uint8_t *)dest;
+    const uint8_t *s = (const uint8_t *)src;
+
+    if (d == s || n == 0)
+        return dest;
+
+    // unsigned distance also covers d < s, forward copy is safe for it
+    if ((uintptr_t)d - (uintptr_t)s >= n)
+        prvCopyForward(d, s, n);
+    else
+        prvCopyBackward(d, s, n);
+    return dest;
+}
+
+void *memset(void *dest, int c, size_t n)
+{
+    prvFill((uint8_t *)dest, (uint8_t)c, n);
+    return dest;
+}
+
+int memcmp(const void *a, const void *b, size_t n)
+{
+    return prvCompare((const uint8_t *)a, (const uint8_t *)b, n);
+}
+
+/**
+ * ARM EABI helpers, the compiler calls them for structure copy and
+ * initialization. Alignment variants are the same.
+ */
+void __aeabi_memcpy(void *dest, const void *src, size_t n)
+{
+    prvCopyForward((uint8_t *)dest, (const uint8_t *)src, n);
+}
+
+void __aeabi_memmove(void *dest, const void *src, size_t n)
+{
+    memmove(dest, src, n);
+}
+
+void __aeabi_memset(void *dest, size_t n, int c)
+{
+    prvFill((uint8_t *)dest, (uint8_t)c, n);
+}
+
+void __aeabi_memclr(void *dest, size_t n)
+{
+    prvFill((uint8_t *)dest, 0, n);
+}
+
+OSI_DECL_STRONG_ALIAS(__aeabi_memcpy, void __aeabi_memcpy4(void *dest, const void *src, size_t n));
+OSI_DECL_STRONG_ALIAS(__aeabi_memcpy, void __aeabi_memcpy8(void *dest, const void *src, size_t n));
+OSI_DECL_STRONG_ALIAS(__aeabi_memmove, void __aeabi_memmove4(void *dest, const void *src, size_t n));
+OSI_DECL_STRONG_ALIAS(__aeabi_memmove, void __aeabi_memmove8(void *dest, const void *src, size_t n));
+OSI_DECL_STRONG_ALIAS(__aeabi_memset, void __aeabi_memset4(void *dest, size_t n, int c));
+OSI_DECL_STRONG_ALIAS(__aeabi_memset, void __aeabi_memset8(void *dest, size_t n, int c));
+OSI_DECL_STRONG_ALIAS(__aeabi_memclr, void __aeabi_memclr4(void *dest, size_t n));
+OSI_DECL_STRONG_ALIAS(__aeabi_memclr, void __aeabi_memclr8(void *dest, size_t n));
+
+#endif
@@ -98,7 +98,7 @@ bool osiSysnvSave(void)
 
     void *buf = alloca(nv_size);
     if (osiSysnvEncode(buf, nv_size) < 0 ||
-        vfs_sfile_write(SYSNV_FNAME, buf, nv_size) != nv_size)
+        vfs_sfile_write_behind(SYSNV_FNAME, buf, nv_size) != nv_size)
         return false;
 
     return true;
@@ -15,6 +15,7 @@
 #include "osi_log.h"
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 int osiUintIdCompare(const void *key, const void *p)
 {
@@ -153,6 +154,117 @@ uint32_t osiVsmalFindIVal(const osiValueStrMap_t *vsmap, const char *str, uint32
     return (vs == NULL) ? defval : vs->value;
 }
 
+static uint32_t prvStrHash(const char *str, bool icase)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const uint8_t *p = (const uint8_t *)str; *p != '\0'; p++)
+    {
+        uint8_t c = icase ? tolower(*p) : *p;
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+static inline bool prvStrEqual(const char *a, const char *b, bool icase)
+{
+    return icase ? (strcasecmp(a, b) == 0) : (strcmp(a, b) == 0);
+}
+
+/**
+ * Hash table is linear probed. slots[0] is the mask, and each slot is
+ * map index plus 1, 0 for empty. It is less than half full.
+ */
+static uint16_t *prvVsmapIndexBuild(const osiValueStrMap_t *vsmap, bool icase)
+{
+    unsigned count = 0;
+    while (vsmap[count].str != NULL)
+        count++;
+
+    unsigned size = 4;
+    while (size < count * 2)
+        size *= 2;
+    if (count == 0 || size > 0x8000)
+        return NULL;
+
+    uint16_t *slots = (uint16_t *)calloc(size + 1, sizeof(uint16_t));
+    if (slots == NULL)
+        return NULL;
+
+    unsigned mask = size - 1;
+    slots[0] = mask;
+    for (unsigned n = 0; n < count; n++)
+    {
+        unsigned pos = prvStrHash(vsmap[n].str, icase) & mask;
+        for (;;)
+        {
+            unsigned idx = slots[pos + 1];
+            if (idx == 0)
+            {
+                slots[pos + 1] = n + 1;
+                break;
+            }
+
+            // the first one is kept for duplicated string
+            if (prvStrEqual(vsmap[idx - 1].str, vsmap[n].str, icase))
+                break;
+            pos = (pos + 1) & mask;
+        }
+    }
+    return slots;
+}
+
+const osiValueStrMap_t *osiVsmapIndexFind(osiVsmapStrIndex_t *index, const char *str)
+{
+    if (index == NULL || index->vsmap == NULL || str == NULL)
+        return NULL;
+
+    uint16_t *slots = index->slots;
+    if (slots == NULL)
+    {
+        slots = prvVsmapIndexBuild(index->vsmap, index->icase);
+        if (slots == NULL)
+        {
+            return index->icase ? osiVsmapFindByIStr(index->vsmap, str)
+                                : osiVsmapFindByStr(index->vsmap, str);
+        }
+
+        // it may be built in another thread at the same time
+        uint32_t critical = osiEnterCritical();
+        if (index->slots == NULL)
+        {
+            index->slots = slots;
+        }
+        else
+        {
+            free(slots);
+            slots = index->slots;
+        }
+        osiExitCritical(critical);
+    }
+
+    unsigned mask = slots[0];
+    unsigned pos = prvStrHash(str, index->icase) & mask;
+    for (;;)
+    {
+        unsigned idx = slots[pos + 1];
+        if (idx == 0)
+            return NULL;
+
+        const osiValueStrMap_t *vs = &index->vsmap[idx - 1];
+        if (prvStrEqual(vs->str, str, index->icase))
+            return vs;
+        pos = (pos + 1) & mask;
+    }
+    return NULL; // never reach
+}
+
+uint32_t osiVsmapIndexFindVal(osiVsmapStrIndex_t *index, const char *str, uint32_t defval)
+{
+    const osiValueStrMap_t *vs = osiVsmapIndexFind(index, str);
+    return (vs == NULL) ? defval : vs->value;
+}
+
 bool osiIsUintInList(uint32_t value, const uint32_t *varlist, unsigned count)
 {
     for (unsigned n = 0; n < count; n++)
@@ -25,13 +25,40 @@
 #include "osi_api.h"
 #include "osi_log.h"
 #include "osi_internal.h"
+#include "osi_api_inside.h"
 #include <string.h>
 #include <stdlib.h>
 #include <sys/queue.h>
 
+#ifndef CONFIG_KERNEL_HIGH_PRIO_WQ_THREADS
+#define CONFIG_KERNEL_HIGH_PRIO_WQ_THREADS 2
+#endif
+#ifndef CONFIG_KERNEL_LOW_PRIO_WQ_THREADS
+#define CONFIG_KERNEL_LOW_PRIO_WQ_THREADS 1
+#endif
+#ifndef CONFIG_KERNEL_FILE_WRITE_WQ_THREADS
+#define CONFIG_KERNEL_FILE_WRITE_WQ_THREADS 2
+#endif
+
+#define WQ_THREAD_COUNT_MAX (8)      ///< 每个工作队列的最大线程数
+#define WQ_SEMA_COUNT_MAX (0x7fff)   ///< 唤醒信号量的最大计数
+
 typedef TAILQ_ENTRY(osiWork) osiWorkEntry_t;
 typedef TAILQ_HEAD(osiWorkHead, osiWork) osiWorkHead_t;
 
+/**
+ * @brief 等待工作项完成的线程，节点在等待线程的栈上
+ */
+typedef struct osiWorkWaiter
+{
+    SLIST_ENTRY(osiWorkWaiter) iter; ///< 链表节点，挂载在工作项上
+    osiSemaphore_t *sema;            ///< 等待线程的信号量，只在工作项完成时释放
+    bool done;                       ///< 工作项已完成（或被取消、删除）
+} osiWorkWaiter_t;
+
+typedef SLIST_HEAD(osiWorkWaiterHead, osiWorkWaiter) osiWorkWaiterHead_t;
+typedef struct osiWorkThread osiWorkThread_t;
+
 /**
  * 整理后：
  * /**
@@ -63,6 +90,22 @@ struct osiWork
     void *cb_ctx;              ///< 回调函数的上下文参数
 
     osiWorkQueue_t *wq;        ///< 所属的工作队列（用于完成通知、状态检查等）
+    osiWorkThread_t *runner;   ///< 正在执行该工作项的线程，未执行时为 NULL
+
+    uint32_t enqueue_time;     ///< 入队时间（微秒，只用于统计等待延迟）
+
+    osiWorkWaiterHead_t waiters; ///< 等待该工作项完成的线程
+};
+
+/**
+ * @brief 工作队列中的一个线程
+ */
+struct osiWorkThread
+{
+    osiWorkQueue_t *wq;        ///< 所属的工作队列
+    osiThread_t *thread;       ///< 线程对象
+    osiWork_t *current;        ///< 正在执行的工作项，同一工作项不会在两个线程中同时执行
+                               ///< 工作项在执行中被删除时清为 NULL，执行后不会再访问它
 };
 
 
@@ -70,12 +113,15 @@ struct osiWorkQueue
 {
     volatile bool running;         ///< 标志工作队列是否仍在运行（用于线程退出判断）
 
-    osiThread_t *thread;           ///< 工作队列使用的后台线程对象（自动处理工作项）
-
-    osiSemaphore_t *work_sema;     ///< 工作同步信号量（有新工作到来时释放，用于唤醒线程）
-    osiSemaphore_t *finish_sema;   ///< 完成同步信号量（工作执行完成时用于通知等待者）
+    osiSemaphore_t *work_sema;     ///< 工作同步信号量（每个新工作释放一次，用于唤醒线程）
 
     osiWorkHead_t work_list;       ///< 挂载所有工作项的链表队列
+
+    osiWorkQueueStat_t stat;       ///< 统计信息
+
+    size_t thread_count;           ///< 线程数
+    size_t thread_alive;           ///< 未退出的线程数，最后退出的线程释放工作队列
+    osiWorkThread_t threads[];     ///< 工作队列的线程
 };
 
 
@@ -83,6 +129,24 @@ static osiWorkQueue_t *gHighWq = NULL;  ///< 高优先级工作队列（例如 U
 static osiWorkQueue_t *gLowWq = NULL;   ///< 低优先级工作队列（例如日志、异步写入等）
 static osiWorkQueue_t *gFsWq = NULL;    ///< 文件系统相关工作队列
 
+/**
+ * @brief 工作项已完成、被取消或删除，唤醒等待它的线程。需在临界区中调用。
+ *
+ * 只唤醒该工作项的等待者，其它工作项完成时不会唤醒它们。
+ *
+ * @param work 工作项
+ */
+static void prvWorkNotifyWaiters(osiWork_t *work)
+{
+    osiWorkWaiter_t *waiter;
+    while ((waiter = SLIST_FIRST(&work->waiters)) != NULL)
+    {
+        SLIST_REMOVE_HEAD(&work->waiters, iter);
+        waiter->done = true;
+        osiSemaphoreRelease(waiter->sema);
+    }
+}
+
 /**************************************************************
  * @brief 创建一个工作项对象，用于异步任务调度系统（如工作队列）。
  *
@@ -116,6 +180,8 @@ osiWork_t *osiWorkCreate(osiCallback_t run, osiCallback_t complete, void *ctx)
     // 初始化工作项所属的工作队列指针为 NULL
     // 后续通过调度系统将该工作项插入某个队列时会赋值
     work->wq = NULL;
+    work->runner = NULL;
+    SLIST_INIT(&work->waiters);
     // 所有字段初始化完成，返回工作项对象指针
     return work;
 }
@@ -147,6 +213,13 @@ void osiWorkDelete(osiWork_t *work)
         work->wq = NULL;
     }
 
+    // 正在执行时，执行线程不再访问它
+    if (work->runner != NULL)
+        work->runner->current = NULL;
+
+    // 唤醒等待该任务的线程
+    prvWorkNotifyWaiters(work);
+
     // 释放该任务对象占用的内存
     free(work);
 
@@ -219,6 +292,8 @@ bool osiWorkEnqueue(osiWork_t *work, osiWorkQueue_t *wq)
         TAILQ_INSERT_TAIL(&wq->work_list, work, iter);
         // 更新工作项的队列指针，指向新队列
         work->wq = wq;
+        work->enqueue_time = (uint32_t)osiUpTimeUS();
+        wq->stat.enqueued++;
         // 释放信号量，通知工作线程：有新任务到达
         osiSemaphoreRelease(wq->work_sema);
     }
@@ -250,6 +325,12 @@ bool osiWorkEnqueueLast(osiWork_t *work, osiWorkQueue_t *wq)
     uint32_t critical = osiEnterCritical();
 
     // 若任务已存在于其他队列中，先移除
+    // 已在同一队列中时只移到尾部，保留原入队时间
+    if (work->wq != wq)
+    {
+        work->enqueue_time = (uint32_t)osiUpTimeUS();
+        wq->stat.enqueued++;
+    }
     if (work->wq != NULL)
         TAILQ_REMOVE(&work->wq->work_list, work, iter);
 
@@ -292,6 +373,10 @@ void osiWorkCancel(osiWork_t *work)
 
         // 清空队列引用，标记为未挂载
         work->wq = NULL;
+
+        // 未在执行时即已完成，唤醒等待该任务的线程
+        if (work->runner == NULL)
+            prvWorkNotifyWaiters(work);
     }
 
     // 退出临界区
@@ -302,7 +387,11 @@ void osiWorkCancel(osiWork_t *work)
  * @brief 等待一个工作任务完成
  *
  * 此函数用于阻塞当前线程，直到指定的工作项执行完成，或等待超时。
- * 工作完成的依据是该工作从其所属的工作队列中被移除（`work->wq == NULL`）。
+ * 工作完成的依据是该工作已不在队列中（`work->wq == NULL`），且没有线程
+ * 正在执行它。取消、删除工作项，以及删除工作队列时丢弃的工作项，也视为完成。
+ *
+ * 每个等待者在工作项上挂一个自己的信号量，只在该工作项完成时被唤醒，
+ * 队列中其它工作项的完成不会唤醒它。
  *
  * @param work    待等待的工作项指针
  * @param timeout 等待超时时间（毫秒），可以是 OSI_WAIT_FOREVER 表示永久等待
@@ -310,7 +399,7 @@ void osiWorkCancel(osiWork_t *work)
  *         false 表示超时或参数非法
  *
  * @note 当设置为永久等待时，若任务永不完成，会导致阻塞。
- *       本函数线程安全，可被多个线程调用。
+ *       本函数线程安全，可被多个线程调用。不可在该工作项自己的回调中调用。
  */
 
 bool osiWorkWaitFinish(osiWork_t *work, unsigned timeout)
@@ -319,52 +408,41 @@ bool osiWorkWaitFinish(osiWork_t *work, unsigned timeout)
     if (work == NULL)
         return false;
 
-    // 定义并启动一个计时器，用于计算超时时间
-    osiElapsedTimer_t timer;
-    osiElapsedTimerStart(&timer);
-
-    // 进入临界区，防止并发修改 work->wq
+    // 任务已经完成，或不等待时，直接返回
     uint32_t critical = osiEnterCritical();
+    bool done = (work->wq == NULL && work->runner == NULL);
+    osiExitCritical(critical);
+    if (done || timeout == 0)
+        return done;
 
-    // 无限循环，直到任务完成或超时
-    for (;;)
-    {
-        // 如果任务已经完成（即已从工作队列中移除）
-        if (work->wq == NULL)
-        {
-            osiExitCritical(critical);
-            return true; // 成功等待完成
-        }
+    // 等待者的信号量在栈上，只由该任务完成时释放
+    osiSemaphoreStatic_t *buf_sema = alloca(osiSemaphoreSize());
+    osiWorkWaiter_t waiter = {.sema = osiSemaphoreCreateStatic(buf_sema, 1, 0), .done = false};
 
-        // timeout=0，表示立即返回，不等待
-        if (timeout == 0)
-        {
-            osiExitCritical(critical);
-            return false; // 任务未完成
-        }
+    // 检查之后任务可能已完成，再检查一次后挂上等待者
+    critical = osiEnterCritical();
+    if (work->wq == NULL && work->runner == NULL)
+        waiter.done = true;
+    else
+        SLIST_INSERT_HEAD(&work->waiters, &waiter, iter);
+    osiExitCritical(critical);
 
-        // 永久等待模式
+    if (!waiter.done)
+    {
         if (timeout == OSI_WAIT_FOREVER)
-        {
-            // 阻塞式等待“完成信号量”，等待任何一个任务完成
-            osiSemaphoreAcquire(work->wq->finish_sema);
-            // 继续检查 work->wq 是否已清除（有可能不是当前任务完成）
-            continue;
-        }
-
-        // 否则进入有限时间等待，计算剩余时间
-        int wait = timeout - osiElapsedTime(&timer);
-        if (wait < 0 || !osiSemaphoreTryAcquire(work->wq->finish_sema, wait))
-        {
-            osiExitCritical(critical);
-            return false; // 超时或等待失败
-        }
+            osiSemaphoreAcquire(waiter.sema);
+        else
+            osiSemaphoreTryAcquire(waiter.sema, timeout);
 
-        // 若拿到信号量，继续循环检查任务是否完成
+        // 超时时等待者还挂在任务上，需要摘除（被唤醒时已经摘除）
+        critical = osiEnterCritical();
+        if (!waiter.done)
+            SLIST_REMOVE(&work->waiters, &waiter, osiWorkWaiter, iter);
+        osiExitCritical(critical);
     }
 
-    // 理论上不可达：循环要么返回 true，要么返回 false
-    // return false;
+    osiSemaphoreDelete(waiter.sema);
+    return waiter.done;
 }
 
 osiCallback_t osiWorkFunction(osiWork_t *work)
@@ -376,33 +454,60 @@ void *osiWorkContext(osiWork_t *work)
 {
     return (work != NULL) ? work->cb_ctx : NULL;
 }
+/**
+ * @brief 从工作队列中取出下一个可执行的工作项
+ *
+ * 跳过正在其它线程中执行的工作项，同一工作项不会同时在两个线程中执行。
+ * 被跳过的工作项由执行它的线程完成后再取出。需在临界区中调用。
+ *
+ * @param wq 工作队列
+ * @return 可执行的工作项，没有时返回 NULL
+ */
+static osiWork_t *prvWqTakeWork(osiWorkQueue_t *wq)
+{
+    osiWork_t *work;
+    TAILQ_FOREACH(work, &wq->work_list, iter)
+    {
+        size_t n;
+        for (n = 0; n < wq->thread_count; n++)
+        {
+            if (wq->threads[n].current == work)
+                break;
+        }
+        if (n == wq->thread_count)
+            return work;
+    }
+    return NULL;
+}
+
 /**
  * @brief 工作队列线程的主入口函数（work queue worker thread）。
  *
- * 该函数由 `osiWorkQueueCreate()` 创建的线程执行，
+ * 该函数由 `osiWorkQueueCreate()` 创建的每个线程执行，
  * 用于处理挂到工作队列上的所有任务（`osiWork_t`）。
  *
  * 工作流程：
  * - 线程初始化后进入循环
  * - 每次从队列中取出一个任务执行
- * - 调用任务的 run 回调、然后是 complete 回调
+ * - 调用任务的 run 回调、然后是 complete 回调，并更新统计信息
  * - 使用信号量机制控制线程阻塞与唤醒
- * - 线程退出前清理队列中未执行的任务并释放资源
+ * - 最后退出的线程清理队列中未执行的任务并释放资源
  */
 
 static void _wqThreadEntry(void *argument)
 {
      // 打印日志：工作队列线程启动
-    OSI_LOGD(0, "work queue %p started", argument);
+    OSI_LOGD(0, "work queue thread %p started", argument);
 
     uint32_t critical;
     osiWork_t *work;
-    // 将传入的参数转换为工作队列结构体指针
-    osiWorkQueue_t *wq = (osiWorkQueue_t *)argument;
+    // 传入的参数是工作队列中的线程
+    osiWorkThread_t *wth = (osiWorkThread_t *)argument;
+    osiWorkQueue_t *wq = wth->wq;
     // 记录当前线程指针（通常在线程内部调用 osiThreadCurrent）
-    wq->thread = osiThreadCurrent();
+    wth->thread = osiThreadCurrent();
 
-    OSI_LOGD(0, "work queue thread %p", wq->thread);
+    OSI_LOGD(0, "work queue thread %p", wth->thread);
     // 主循环，只要工作队列处于“运行”状态就不断检查任务列表
     /*wq->running 变为 false 是由其他线程主动调用某个释放函数（比如 osiWorkQueueDelete()）设置的
     *为什么要这样设计？
@@ -414,8 +519,8 @@ static void _wqThreadEntry(void *argument)
     {
         // 进入临界区，保护 work_list 链表访问
         critical = osiEnterCritical();
-        // 取出工作队列中的第一个待处理任务
-        work = TAILQ_FIRST(&wq->work_list);
+        // 取出工作队列中的第一个可执行的任务
+        work = prvWqTakeWork(wq);
         OSI_LOGD(0, "work run, work/%p wq/%p", work, wq);
         // 如果当前没有任务可执行
         if (work == NULL)
@@ -430,33 +535,65 @@ static void _wqThreadEntry(void *argument)
         TAILQ_REMOVE(&wq->work_list, work, iter);
         // 清空该任务的工作队列指针（表示不再挂靠在队列上）
         work->wq = NULL;
+        // 记录正在执行的任务，执行后不再访问 work（回调中可能删除它）
+        wth->current = work;
+        work->runner = wth;
 
         // keep the values before exit critical section
         // 在临界区中读取任务数据后退出临界区（防止阻塞其它操作）
         osiCallback_t run = work->run;
         osiCallback_t complete = work->complete;
         void *ctx = work->cb_ctx;
+        uint32_t start = (uint32_t)osiUpTimeUS();
+        uint32_t latency = start - work->enqueue_time;
         osiExitCritical(critical);
+#ifdef CONFIG_KERNEL_FLIGHT_REC_COUNT
+        osiFlightRecord(OSI_FLIGHT_WORK, 0, (uint32_t)run);
+#endif
         // 如果任务定义了 run 回调函数，调用它（执行任务主逻辑）
         if (run != NULL)
             run(ctx);
         // 如果任务定义了 complete 回调函数，调用它（处理收尾逻辑）
         if (complete != NULL)
             complete(ctx);
-        // 通知任务完成，可以释放资源或等待 finish 信号
-        osiSemaphoreRelease(wq->finish_sema);
+        uint32_t run_time = (uint32_t)osiUpTimeUS() - start;
+
+        critical = osiEnterCritical();
+        // 回调中没有删除该任务时，通知等待者（执行中重新入队的等下一次完成）
+        work = wth->current;
+        wth->current = NULL;
+        if (work != NULL)
+        {
+            work->runner = NULL;
+            if (work->wq == NULL)
+                prvWorkNotifyWaiters(work);
+        }
+        wq->stat.executed++;
+        if (latency > wq->stat.max_latency_us)
+            wq->stat.max_latency_us = latency;
+        if (run_time > wq->stat.max_run_us)
+            wq->stat.max_run_us = run_time;
+        osiExitCritical(critical);
     }
+
+    // 只有最后退出的线程释放资源
+    critical = osiEnterCritical();
+    bool last = (--wq->thread_alive == 0);
+    osiExitCritical(critical);
+    if (!last)
+        osiThreadExit();
+
      // 线程即将退出，清理队列中尚未执行的任务（防止泄露）
     critical = osiEnterCritical();
     while ((work = TAILQ_FIRST(&wq->work_list)) != NULL)
     {
         TAILQ_REMOVE(&wq->work_list, work, iter);
         work->wq = NULL;
+        prvWorkNotifyWaiters(work);
     }
     osiExitCritical(critical);
-    // 删除工作队列的两个信号量（防止内存泄漏）
+    // 删除工作队列的信号量（防止内存泄漏）
     osiSemaphoreDelete(wq->work_sema);
-    osiSemaphoreDelete(wq->finish_sema);
     // 释放工作队列结构体本身
     free(wq);
     // 正常退出线程
@@ -465,11 +602,13 @@ static void _wqThreadEntry(void *argument)
 /**
  * @brief 创建一个工作队列对象（带工作线程和调度机制）
  *
- * 工作队列用于在独立线程中顺序执行异步任务（如回调函数、耗时操作等），
- * 它包含一个工作项链表、一个调度线程以及两个用于同步的信号量。
+ * 工作队列用于在独立线程中执行异步任务（如回调函数、耗时操作等），
+ * 它包含一个工作项链表、一个或多个调度线程以及两个用于同步的信号量。
+ * 多个线程时，一个任务阻塞不会延迟队列中的其它任务，但不同任务的执行
+ * 可能并发或乱序；同一任务不会并发执行。
  *
  * @param name         工作线程名（便于调试）
- * @param thread_count 保留参数（当前仅支持 1）
+ * @param thread_count 工作线程数（1 到 WQ_THREAD_COUNT_MAX，0 按 1 处理）
  * @param priority     工作线程的优先级
  * @param stack_size   工作线程的栈大小（字节）
  * @return 成功时返回工作队列对象指针，失败时返回 NULL
@@ -479,8 +618,13 @@ static void _wqThreadEntry(void *argument)
 
 osiWorkQueue_t *osiWorkQueueCreate(const char *name, size_t thread_count, uint32_t priority, uint32_t stack_size)
 {
-    // 分配工作队列对象的内存，并清零
-    osiWorkQueue_t *wq = calloc(1, sizeof(*wq));
+    if (thread_count == 0)
+        thread_count = 1;
+    if (thread_count > WQ_THREAD_COUNT_MAX)
+        thread_count = WQ_THREAD_COUNT_MAX;
+
+    // 分配工作队列对象和线程的内存，并清零
+    osiWorkQueue_t *wq = calloc(1, sizeof(*wq) + thread_count * sizeof(osiWorkThread_t));
     if (wq == NULL)
         return NULL;
 
@@ -490,20 +634,39 @@ osiWorkQueue_t *osiWorkQueueCreate(const char *name, size_t thread_count, uint32
     // 标记该工作队列处于运行状态
     wq->running = true;
 
-    // 创建用于工作线程唤醒的信号量，初始值为 1（允许进入）
-    wq->work_sema = osiSemaphoreCreate(1, 1);
-    // 创建用于等待所有任务完成的信号量，初始为 0（阻塞）
-    wq->finish_sema = osiSemaphoreCreate(1, 0);
+    // 创建用于工作线程唤醒的计数信号量，每个新任务唤醒一个线程
+    wq->work_sema = osiSemaphoreCreate(WQ_SEMA_COUNT_MAX, 0);
     // 创建信号量失败，跳转至清理逻辑
-    if (wq->work_sema == NULL || wq->finish_sema == NULL)
+    if (wq->work_sema == NULL)
         goto failed;
 
-    // 创建专用的工作线程，线程入口函数为 _wqThreadEntry，参数为当前工作队列对象
-    wq->thread = osiThreadCreate(name, _wqThreadEntry, wq, priority, stack_size, 0);
-    OSI_LOGD(0, "work queue create thread %p", wq->thread);
-    // 创建线程失败，跳转至清理逻辑
-    if (wq->thread == NULL)
-        goto failed;
+    // 创建工作线程，线程入口函数为 _wqThreadEntry，参数为线程对象
+    for (size_t n = 0; n < thread_count; n++)
+    {
+        osiWorkThread_t *wth = &wq->threads[n];
+        wth->wq = wq;
+
+        uint32_t critical = osiEnterCritical();
+        wq->thread_count = n + 1;
+        wq->thread_alive = n + 1;
+        osiExitCritical(critical);
+
+        osiThread_t *thread = osiThreadCreate(name, _wqThreadEntry, wth, priority, stack_size, 0);
+        OSI_LOGD(0, "work queue create thread %p", thread);
+        if (thread != NULL)
+            continue;
+
+        // 创建线程失败：没有线程时直接清理，否则让已创建的线程退出并释放
+        critical = osiEnterCritical();
+        wq->thread_count = n;
+        wq->thread_alive = n;
+        osiExitCritical(critical);
+        if (n == 0)
+            goto failed;
+
+        osiWorkQueueDelete(wq);
+        return NULL;
+    }
 
     // 所有资源初始化成功，返回工作队列指针
     return wq;
@@ -511,7 +674,6 @@ osiWorkQueue_t *osiWorkQueueCreate(const char *name, size_t thread_count, uint32
 failed:
     // 清理已分配的信号量资源
     osiSemaphoreDelete(wq->work_sema);
-    osiSemaphoreDelete(wq->finish_sema);
     // 释放工作队列结构体内存
     free(wq);
     return NULL;
@@ -526,8 +688,22 @@ void osiWorkQueueDelete(osiWorkQueue_t *wq)
     // is set to false.
     unsigned critical = osiEnterCritical();
     wq->running = false;
-    osiSemaphoreRelease(wq->work_sema);
+    for (size_t n = 0; n < wq->thread_count; n++)
+        osiSemaphoreRelease(wq->work_sema);
+    osiExitCritical(critical);
+}
+
+bool osiWorkQueueGetStat(osiWorkQueue_t *wq, osiWorkQueueStat_t *stat, bool reset)
+{
+    if (wq == NULL || stat == NULL)
+        return false;
+
+    uint32_t critical = osiEnterCritical();
+    *stat = wq->stat;
+    if (reset)
+        memset(&wq->stat, 0, sizeof(wq->stat));
     osiExitCritical(critical);
+    return true;
 }
 
 osiWorkQueue_t *osiSysWorkQueueHighPriority(void) { return gHighWq; }
@@ -538,13 +714,13 @@ void osiSysWorkQueueInit(void)
 {
     if (gHighWq == NULL)
         gHighWq = osiWorkQueueCreate(
-            "wq_hi", 1, OSI_PRIORITY_HIGH, CONFIG_KERNEL_HIGH_PRIO_WQ_STACKSIZE);
+            "wq_hi", CONFIG_KERNEL_HIGH_PRIO_WQ_THREADS, OSI_PRIORITY_HIGH, CONFIG_KERNEL_HIGH_PRIO_WQ_STACKSIZE);
     if (gLowWq == NULL)
         gLowWq = osiWorkQueueCreate(
-            "wq_lo", 1, OSI_PRIORITY_LOW, CONFIG_KERNEL_LOW_PRIO_WQ_STACKSIZE);
+            "wq_lo", CONFIG_KERNEL_LOW_PRIO_WQ_THREADS, OSI_PRIORITY_LOW, CONFIG_KERNEL_LOW_PRIO_WQ_STACKSIZE);
     if (gFsWq == NULL)
         gFsWq = osiWorkQueueCreate(
-            "wq_fs", 1, OSI_PRIORITY_BELOW_NORMAL, CONFIG_KERNEL_FILE_WRITE_WQ_STACKSIZE);
+            "wq_fs", CONFIG_KERNEL_FILE_WRITE_WQ_THREADS, OSI_PRIORITY_BELOW_NORMAL, CONFIG_KERNEL_FILE_WRITE_WQ_STACKSIZE);
 }
 
 /*
@@ -66,6 +66,87 @@ void malInit(void);
  */
 unsigned malSimGetState(int sim, malSimState_t *state, unsigned *remaintries);
 
+/**
+ * \brief IMSI buffer size, including null terminator
+ */
+#define MAL_IMSI_SIZE (16)
+
+/**
+ * \brief SIM information by \p malSimGetInfo
+ */
+typedef struct
+{
+    malSimState_t state;      ///< SIM state
+    unsigned remaintries;     ///< remain tries
+    unsigned imsi_errcode;    ///< error code of IMSI, 0 on success
+    char imsi[MAL_IMSI_SIZE]; ///< IMSI string
+} malSimInfo_t;
+
+/**
+ * \brief (+CIMI)
+ *
+ * IMSI is cached for \p CONFIG_MAL_CACHE_TTL milliseconds.
+ *
+ * \param sim       SIM index, ignored in single SIM version
+ * \param imsi      output IMSI string
+ * \return
+ *      - 0 on success
+ *      - error code on fail
+ */
+unsigned malSimGetImsi(int sim, char imsi[MAL_IMSI_SIZE]);
+
+/**
+ * \brief get SIM state and IMSI together
+ *
+ * The requests are issued together, and waited once. It is faster than
+ * calling \p malSimGetState and \p malSimGetImsi one by one.
+ *
+ * \param sim       SIM index, ignored in single SIM version
+ * \param info      output SIM information
+ * \return
+ *      - 0 on success of SIM state, IMSI error is in \p imsi_errcode
+ *      - error code on fail
+ */
+unsigned malSimGetInfo(int sim, malSimInfo_t *info);
+
+/**
+ * \brief (+CSQ)
+ *
+ * Signal quality is cached for \p CONFIG_MAL_CACHE_TTL milliseconds.
+ *
+ * \param sim       SIM index, ignored in single SIM version
+ * \param rssi      output signal level, 99 for unknown
+ * \param ber       output bit error rate, 99 for unknown
+ * \return
+ *      - 0 on success
+ *      - error code on fail
+ */
+unsigned malNwGetSignalQuality(int sim, uint8_t *rssi, uint8_t *ber);
+
+/**
+ * \brief (+COPS?)
+ *
+ * Current operator is cached for \p CONFIG_MAL_CACHE_TTL milliseconds.
+ *
+ * \param sim       SIM index, ignored in single SIM version
+ * \param oper_id   output operator id, MCC in [0-2], MNC in [3-5]
+ * \param mode      output operator selection mode
+ * \return
+ *      - 0 on success
+ *      - error code on fail
+ */
+unsigned malNwGetCurrentOperator(int sim, uint8_t oper_id[6], uint8_t *mode);
+
+/**
+ * \brief invalidate cached query results
+ *
+ * It should be called when the cached values are known to be changed,
+ * such as SIM hot plug.
+ *
+ * \param sim       SIM index, -1 for all SIMs
+ */
+void malQueryCacheInvalidate(int sim);
+
 int sim_channel_open(uint8_t *dfname, uint8_t *channel_id, uint16_t timeout, uint8_t sim_id);
 int sim_channel_transmit(uint8_t channel_id, uint8_t *apdu, uint16_t apduLen,
                          uint8_t *resp, uint16_t *respLen, uint16_t timeout, uint8_t sim_id);
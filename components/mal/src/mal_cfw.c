@@ -22,6 +22,46 @@
 
 extern bool gSimDropInd[CONFIG_NUMBER_OF_SIM];
 
+#ifndef CONFIG_MAL_CACHE_TTL
+#define CONFIG_MAL_CACHE_TTL (1000)
+#endif
+
+typedef struct
+{
+    int64_t csq_time;
+    int64_t oper_time;
+    int64_t imsi_time;
+    bool csq_valid;
+    bool oper_valid;
+    bool imsi_valid;
+    uint8_t rssi;
+    uint8_t ber;
+    uint8_t oper_id[6];
+    uint8_t oper_mode;
+    char imsi[MAL_IMSI_SIZE];
+} malQueryCache_t;
+
+static malQueryCache_t gMalCache[CONFIG_NUMBER_OF_SIM];
+
+static inline bool prvCacheFresh(bool valid, int64_t time)
+{
+    return valid && (osiUpTime() - time) < CONFIG_MAL_CACHE_TTL;
+}
+
+static unsigned prvSimCfwErrToCme(unsigned result)
+{
+    if (ERR_CFW_INVALID_PARAMETER == result)
+        return ERR_AT_CME_PARAM_INVALID;
+    if (ERR_CME_OPERATION_NOT_ALLOWED == result)
+        return ERR_AT_CME_OPERATION_NOT_ALLOWED;
+    if (ERR_NO_MORE_MEMORY == result)
+        return ERR_AT_CME_NO_MEMORY;
+    if ((ERR_CME_SIM_NOT_INSERTED == result) ||
+        (ERR_CFW_SIM_NOT_INITIATE == result))
+        return ERR_AT_CME_SIM_NOT_INSERTED;
+    return ERR_AT_CME_EXE_NOT_SURPORT;
+}
+
 typedef struct
 {
     unsigned errcode;
@@ -80,18 +120,7 @@ unsigned malSimGetState(int sim, malSimState_t *state, unsigned *remaintries)
     if (result != 0)
     {
         malAbortTrans(trans);
-
-        if (ERR_CFW_INVALID_PARAMETER == result)
-            MAL_TRANS_RETURN_ERR(trans, ERR_AT_CME_PARAM_INVALID);
-        else if (ERR_CME_OPERATION_NOT_ALLOWED == result)
-            MAL_TRANS_RETURN_ERR(trans, ERR_AT_CME_OPERATION_NOT_ALLOWED);
-        else if (ERR_NO_MORE_MEMORY == result)
-            MAL_TRANS_RETURN_ERR(trans, ERR_AT_CME_NO_MEMORY);
-        else if ((ERR_CME_SIM_NOT_INSERTED == result) ||
-                 (ERR_CFW_SIM_NOT_INITIATE == result))
-            MAL_TRANS_RETURN_ERR(trans, ERR_AT_CME_SIM_NOT_INSERTED);
-        else
-            MAL_TRANS_RETURN_ERR(trans, ERR_AT_CME_EXE_NOT_SURPORT);
+        MAL_TRANS_RETURN_ERR(trans, prvSimCfwErrToCme(result));
     }
 
     if (!malTransWait(trans, CONFIG_MAL_GET_SIM_AUTH_TIMEOUT))
@@ -108,6 +137,257 @@ unsigned malSimGetState(int sim, malSimState_t *state, unsigned *remaintries)
     MAL_TRANS_RETURN_ERR(trans, ctx.errcode);
 }
 
+typedef struct
+{
+    unsigned errcode;
+    char imsi[MAL_IMSI_SIZE];
+} malContextImsi_t;
+
+static void prvImsiRspCB(malTransaction_t *trans, const osiEvent_t *event)
+{
+    // EV_CFW_SIM_GET_PROVIDER_ID_RSP
+    malContextImsi_t *ctx = (malContextImsi_t *)malTransContext(trans);
+    const CFW_EVENT *cfw_event = (const CFW_EVENT *)event;
+
+    if (cfw_event->nType == 0)
+    {
+        char *imsi = (char *)cfw_event->nParam1;
+        unsigned len = OSI_MIN(unsigned, cfw_event->nParam2, MAL_IMSI_SIZE - 1);
+        memcpy(ctx->imsi, imsi, len);
+        ctx->imsi[len] = '\0';
+        free(imsi);
+        ctx->errcode = 0;
+    }
+    else
+    {
+        ctx->errcode = atCfwToCmeError(cfw_event->nParam1);
+    }
+
+    malTransFinished(trans);
+}
+
+static bool prvImsiCacheGet(int sim, char *imsi)
+{
+    malQueryCache_t *cache = &gMalCache[sim];
+    uint32_t critical = osiEnterCritical();
+    bool fresh = prvCacheFresh(cache->imsi_valid, cache->imsi_time);
+    if (fresh)
+        memcpy(imsi, cache->imsi, MAL_IMSI_SIZE);
+    osiExitCritical(critical);
+    return fresh;
+}
+
+static void prvImsiCacheSet(int sim, const char *imsi)
+{
+    malQueryCache_t *cache = &gMalCache[sim];
+    uint32_t critical = osiEnterCritical();
+    memcpy(cache->imsi, imsi, MAL_IMSI_SIZE);
+    cache->imsi_time = osiUpTime();
+    cache->imsi_valid = true;
+    osiExitCritical(critical);
+}
+
+unsigned malSimGetImsi(int sim, char imsi[MAL_IMSI_SIZE])
+{
+    if (imsi == NULL)
+        return ERR_AT_CME_PARAM_INVALID;
+
+    if (gSimDropInd[sim])
+        return ERR_AT_CME_SIM_NOT_INSERTED;
+
+    if (prvImsiCacheGet(sim, imsi))
+        return 0;
+
+    malContextImsi_t ctx = {};
+    malTransaction_t *trans = malCreateTrans();
+    if (trans == NULL)
+        return ERR_AT_CME_NO_MEMORY;
+
+    malSetTransContext(trans, &ctx, NULL);
+    malStartUtiTrans(trans, prvImsiRspCB);
+
+    unsigned result = CFW_SimGetProviderId(malTransUti(trans), sim);
+    if (result != 0)
+    {
+        malAbortTrans(trans);
+        MAL_TRANS_RETURN_ERR(trans, prvSimCfwErrToCme(result));
+    }
+
+    if (!malTransWait(trans, CONFIG_MAL_GET_SIM_AUTH_TIMEOUT))
+    {
+        malAbortTrans(trans);
+        MAL_TRANS_RETURN_ERR(trans, ERR_AT_CME_SEND_TIMEOUT);
+    }
+
+    if (ctx.errcode == 0)
+    {
+        prvImsiCacheSet(sim, ctx.imsi);
+        memcpy(imsi, ctx.imsi, MAL_IMSI_SIZE);
+    }
+    MAL_TRANS_RETURN_ERR(trans, ctx.errcode);
+}
+
+unsigned malSimGetInfo(int sim, malSimInfo_t *info)
+{
+    if (info == NULL)
+        return ERR_AT_CME_PARAM_INVALID;
+
+    memset(info, 0, sizeof(*info));
+    if (gSimDropInd[sim])
+    {
+        info->imsi_errcode = ERR_AT_CME_SIM_NOT_INSERTED;
+        return ERR_AT_CME_SIM_NOT_INSERTED;
+    }
+
+    bool imsi_cached = prvImsiCacheGet(sim, info->imsi);
+    malBatch_t *batch = malCreateBatch();
+    if (batch == NULL)
+        return ERR_AT_CME_NO_MEMORY;
+
+    // SIM state and IMSI are requested together, and waited once
+    ateContextReadCPIN_t cpin_ctx = {};
+    malTransaction_t *trans = malBatchCreateTrans(batch);
+    if (trans == NULL)
+    {
+        malTerminateBatch(batch);
+        return ERR_AT_CME_NO_MEMORY;
+    }
+
+    malSetTransContext(trans, &cpin_ctx, NULL);
+    malStartUtiTrans(trans, prvCpinReadRspCB);
+    unsigned result = CFW_SimGetAuthenticationStatus(malTransUti(trans), sim);
+    if (result != 0)
+    {
+        malAbortTrans(trans);
+        cpin_ctx.errcode = prvSimCfwErrToCme(result);
+        malTransFinished(trans);
+    }
+
+    malContextImsi_t imsi_ctx = {};
+    if (!imsi_cached)
+    {
+        trans = malBatchCreateTrans(batch);
+        if (trans == NULL)
+        {
+            malTerminateBatch(batch);
+            return ERR_AT_CME_NO_MEMORY;
+        }
+
+        malSetTransContext(trans, &imsi_ctx, NULL);
+        malStartUtiTrans(trans, prvImsiRspCB);
+        result = CFW_SimGetProviderId(malTransUti(trans), sim);
+        if (result != 0)
+        {
+            malAbortTrans(trans);
+            imsi_ctx.errcode = prvSimCfwErrToCme(result);
+            malTransFinished(trans);
+        }
+    }
+
+    if (!malBatchWait(batch, CONFIG_MAL_GET_SIM_AUTH_TIMEOUT))
+    {
+        malTerminateBatch(batch);
+        return ERR_AT_CME_SEND_TIMEOUT;
+    }
+    malTerminateBatch(batch);
+
+    if (!imsi_cached)
+    {
+        info->imsi_errcode = imsi_ctx.errcode;
+        if (imsi_ctx.errcode == 0)
+        {
+            prvImsiCacheSet(sim, imsi_ctx.imsi);
+            memcpy(info->imsi, imsi_ctx.imsi, MAL_IMSI_SIZE);
+        }
+    }
+
+    if (cpin_ctx.errcode == 0)
+    {
+        info->state = cpin_ctx.state;
+        info->remaintries = cpin_ctx.remainRetries;
+    }
+    return cpin_ctx.errcode;
+}
+
+unsigned malNwGetSignalQuality(int sim, uint8_t *rssi, uint8_t *ber)
+{
+    if (rssi == NULL || ber == NULL)
+        return ERR_AT_CME_PARAM_INVALID;
+
+    malQueryCache_t *cache = &gMalCache[sim];
+    uint32_t critical = osiEnterCritical();
+    bool fresh = prvCacheFresh(cache->csq_valid, cache->csq_time);
+    if (fresh)
+    {
+        *rssi = cache->rssi;
+        *ber = cache->ber;
+    }
+    osiExitCritical(critical);
+    if (fresh)
+        return 0;
+
+    uint8_t level = 99, error = 99;
+    unsigned result = CFW_NwGetSignalQuality(&level, &error, sim);
+    if (result != 0)
+        return atCfwToCmeError(result);
+
+    critical = osiEnterCritical();
+    cache->rssi = level;
+    cache->ber = error;
+    cache->csq_time = osiUpTime();
+    cache->csq_valid = true;
+    osiExitCritical(critical);
+
+    *rssi = level;
+    *ber = error;
+    return 0;
+}
+
+unsigned malNwGetCurrentOperator(int sim, uint8_t oper_id[6], uint8_t *mode)
+{
+    if (oper_id == NULL || mode == NULL)
+        return ERR_AT_CME_PARAM_INVALID;
+
+    malQueryCache_t *cache = &gMalCache[sim];
+    uint32_t critical = osiEnterCritical();
+    bool fresh = prvCacheFresh(cache->oper_valid, cache->oper_time);
+    if (fresh)
+    {
+        memcpy(oper_id, cache->oper_id, 6);
+        *mode = cache->oper_mode;
+    }
+    osiExitCritical(critical);
+    if (fresh)
+        return 0;
+
+    uint8_t id[6] = {};
+    uint8_t oper_mode = 0;
+    unsigned result = CFW_NwGetCurrentOperator(id, &oper_mode, sim);
+    if (result != 0)
+        return atCfwToCmeError(result);
+
+    critical = osiEnterCritical();
+    memcpy(cache->oper_id, id, 6);
+    cache->oper_mode = oper_mode;
+    cache->oper_time = osiUpTime();
+    cache->oper_valid = true;
+    osiExitCritical(critical);
+
+    memcpy(oper_id, id, 6);
+    *mode = oper_mode;
+    return 0;
+}
+
+void malQueryCacheInvalidate(int sim)
+{
+    uint32_t critical = osiEnterCritical();
+    if (sim < 0)
+        memset(gMalCache, 0, sizeof(gMalCache));
+    else if (sim < CONFIG_NUMBER_OF_SIM)
+        memset(&gMalCache[sim], 0, sizeof(gMalCache[sim]));
+    osiExitCritical(critical);
+}
+
 #define SIM_CHANNEL_MAX_NUM 7
 #define CFW_SIM_NUMBER CONFIG_NUMBER_OF_SIM
 
@@ -211,7 +491,7 @@ int sim_channel_open(uint8_t *dfname, uint8_t *channel_id, uint16_t timeout, uin
     ctx.length = ascii2hex((const char *)dfname, strlen((const char *)dfname), ctx.df);
     if (ctx.length == 0)
     {
-        free(trans);
+        malTerminateTrans(trans);
         OSI_LOGI(0, "dfname is illegal!");
         return -1;
     }
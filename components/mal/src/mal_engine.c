@@ -16,9 +16,11 @@
 #include "cfw.h"
 #include "osi_log.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define MAL_THREAD_STACK_SIZE (2048)
 #define MAL_THREAD_EVENT_COUNT (32)
+#define MAL_TRANS_FREE_COUNT (4)
 
 typedef enum
 {
@@ -30,14 +32,27 @@ struct malTransaction
 {
     malTransType_t type;
     uint16_t uti;
+    bool finished;
     void *ctx;
     malContextDelete_t ctx_delete;
     osiSemaphore_t *wait_sema;
+    malBatch_t *batch;
+    malTransaction_t *next; // in free list
+};
+
+struct malBatch
+{
+    malTransaction_t *holder; // only for its semaphore
+    unsigned count;
+    unsigned pending;
+    malTransaction_t *trans[MAL_BATCH_TRANS_COUNT];
 };
 
 typedef struct
 {
     osiThread_t *cb_thread;
+    malTransaction_t *free_list; // terminated transactions with semaphore
+    unsigned free_count;
 } malContext_t;
 
 static malContext_t gMalCtx;
@@ -81,7 +96,29 @@ void malSetTransContext(malTransaction_t *trans, void *ctx, malContextDelete_t d
 
 malTransaction_t *malCreateTrans(void)
 {
-    malTransaction_t *trans = (malTransaction_t *)calloc(1, sizeof(*trans));
+    uint32_t critical = osiEnterCritical();
+    malTransaction_t *trans = gMalCtx.free_list;
+    if (trans != NULL)
+    {
+        gMalCtx.free_list = trans->next;
+        gMalCtx.free_count--;
+    }
+    osiExitCritical(critical);
+
+    if (trans != NULL)
+    {
+        // drop the release from the previous user, which may come
+        // after it is terminated.
+        osiSemaphore_t *wait_sema = trans->wait_sema;
+        while (osiSemaphoreTryAcquire(wait_sema, 0))
+            ;
+
+        memset(trans, 0, sizeof(*trans));
+        trans->wait_sema = wait_sema;
+        return trans;
+    }
+
+    trans = (malTransaction_t *)calloc(1, sizeof(*trans));
     if (trans == NULL)
         return NULL;
 
@@ -118,8 +155,24 @@ void malTerminateTrans(malTransaction_t *trans)
 
     if (trans->ctx_delete != NULL)
         trans->ctx_delete(trans->ctx);
-    osiSemaphoreDelete(trans->wait_sema);
-    free(trans);
+
+    // keep a few in free list, to avoid semaphore create and delete
+    bool cached = false;
+    uint32_t critical = osiEnterCritical();
+    if (gMalCtx.free_count < MAL_TRANS_FREE_COUNT)
+    {
+        trans->next = gMalCtx.free_list;
+        gMalCtx.free_list = trans;
+        gMalCtx.free_count++;
+        cached = true;
+    }
+    osiExitCritical(critical);
+
+    if (!cached)
+    {
+        osiSemaphoreDelete(trans->wait_sema);
+        free(trans);
+    }
 }
 
 uint16_t malTransUti(malTransaction_t *trans)
@@ -132,7 +185,24 @@ void malTransFinished(malTransaction_t *trans)
     if (trans == NULL)
         return;
 
-    osiSemaphoreRelease(trans->wait_sema);
+    malBatch_t *batch = trans->batch;
+    if (batch == NULL)
+    {
+        osiSemaphoreRelease(trans->wait_sema);
+        return;
+    }
+
+    bool done = false;
+    uint32_t critical = osiEnterCritical();
+    if (!trans->finished)
+    {
+        trans->finished = true;
+        done = (--batch->pending == 0);
+    }
+    osiExitCritical(critical);
+
+    if (done)
+        osiSemaphoreRelease(batch->holder->wait_sema);
 }
 
 bool malTransWait(malTransaction_t *trans, unsigned timeout)
@@ -152,3 +222,66 @@ void *malTransContext(malTransaction_t *trans)
 {
     return trans->ctx;
 }
+
+malBatch_t *malCreateBatch(void)
+{
+    malBatch_t *batch = (malBatch_t *)calloc(1, sizeof(*batch));
+    if (batch == NULL)
+        return NULL;
+
+    batch->holder = malCreateTrans();
+    if (batch->holder == NULL)
+    {
+        free(batch);
+        return NULL;
+    }
+    return batch;
+}
+
+malTransaction_t *malBatchCreateTrans(malBatch_t *batch)
+{
+    if (batch == NULL || batch->count >= MAL_BATCH_TRANS_COUNT)
+        return NULL;
+
+    malTransaction_t *trans = malCreateTrans();
+    if (trans == NULL)
+        return NULL;
+
+    trans->batch = batch;
+    batch->trans[batch->count++] = trans;
+
+    uint32_t critical = osiEnterCritical();
+    batch->pending++;
+    osiExitCritical(critical);
+    return trans;
+}
+
+bool malBatchWait(malBatch_t *batch, unsigned timeout)
+{
+    if (batch == NULL)
+        return false;
+
+    uint32_t critical = osiEnterCritical();
+    bool done = (batch->pending == 0);
+    osiExitCritical(critical);
+    if (done)
+        return true;
+
+    return osiSemaphoreTryAcquire(batch->holder->wait_sema, timeout);
+}
+
+void malTerminateBatch(malBatch_t *batch)
+{
+    if (batch == NULL)
+        return;
+
+    for (unsigned n = 0; n < batch->count; n++)
+    {
+        malTransaction_t *trans = batch->trans[n];
+        if (!trans->finished)
+            malAbortTrans(trans);
+        malTerminateTrans(trans);
+    }
+    malTerminateTrans(batch->holder);
+    free(batch);
+}
@@ -23,11 +23,21 @@ OSI_EXTERN_C_BEGIN
  */
 #define MAL_TRANS_RETURN_ERR(trans, err) OSI_DO_WHILE0(malTerminateTrans(trans); return (err);)
 
+/**
+ * \brief maximum transactions in a batch
+ */
+#define MAL_BATCH_TRANS_COUNT (4)
+
 /**
  * \brief opaque data structure for transaction
  */
 typedef struct malTransaction malTransaction_t;
 
+/**
+ * \brief opaque data structure for transaction batch
+ */
+typedef struct malBatch malBatch_t;
+
 /**
  * \brief transaction event callback function prototype
  *
@@ -61,6 +71,9 @@ typedef void (*malContextDelete_t)(void *ctx);
 /**
  * \brief create a transaction
  *
+ * Terminated transactions are kept in a free list, and reused with
+ * their semaphores.
+ *
  * \return
  *      - created transaction
  *      - NULL if out of memory
@@ -172,5 +185,54 @@ uint16_t malTransUti(malTransaction_t *trans);
  */
 void *malTransContext(malTransaction_t *trans);
 
+/**
+ * \brief create a transaction batch
+ *
+ * Batch is used to issue several CFW requests, and wait once for all
+ * of them. Each request is a transaction created by
+ * \p malBatchCreateTrans, and the usage of each transaction is the same
+ * as standalone transaction, except \p malTransWait and
+ * \p malTerminateTrans shouldn't be called for it.
+ *
+ * When CFW API fails, \p malTransFinished should be called for the
+ * transaction, to indicate there is nothing to wait.
+ *
+ * \return
+ *      - created batch
+ *      - NULL if out of memory
+ */
+malBatch_t *malCreateBatch(void);
+
+/**
+ * \brief create a transaction in batch
+ *
+ * \param batch     the batch
+ * \return
+ *      - created transaction
+ *      - NULL if out of memory, or too many transactions
+ */
+malTransaction_t *malBatchCreateTrans(malBatch_t *batch);
+
+/**
+ * \brief wait all transactions in batch finish
+ *
+ * \param batch     the batch
+ * \param timeout   waiting timeout
+ * \return
+ *      - true if all transactions are finished
+ *      - false if waiting timeout
+ */
+bool malBatchWait(malBatch_t *batch, unsigned timeout);
+
+/**
+ * \brief terminate the batch
+ *
+ * Unfinished transactions will be aborted, and all transactions in
+ * the batch will be terminated.
+ *
+ * \param batch     the batch
+ */
+void malTerminateBatch(malBatch_t *batch);
+
 OSI_EXTERN_C_END
 #endif
@@ -15,6 +15,7 @@
 
 #include "osi_compiler.h"
 #include <stdint.h>
+#include <stdbool.h>
 
 OSI_EXTERN_C_BEGIN
 
@@ -33,13 +34,42 @@ typedef struct
 
 /**
  * \brief Cpio stream configure
+ *
+ * In sink mode, \p file_size_max is still checked. It can be set to
+ * UINT32_MAX, for data are not buffered.
  */
 typedef struct
 {
     uint32_t file_size_max;
     uint32_t file_path_max;
+    bool crc_enable; ///< calculate CRC32 of file data, sink mode only
 } cpioStreamCfg_t;
 
+/**
+ * \brief Cpio stream sink
+ *
+ * In sink mode, file data are delivered to the callbacks in pieces, as
+ * they are pushed, rather than buffered as a whole file. So, memory
+ * usage doesn't depend on file size.
+ *
+ * \p data of \p cpioFile_t is always NULL in sink mode. \p name and
+ * \p data_size are valid since \p begin.
+ *
+ * - \p begin: A file header and name are parsed. Return false to skip
+ *   this file, and \p data and \p end won't be called for it.
+ * - \p data: A piece of file data. Return false on error, and the
+ *   remaining data of this file will be skipped.
+ * - \p end: The file ended. \p ok is false when \p data failed, or the
+ *   stream is destroyed before the file is completed. \p crc is the
+ *   CRC32 of file data when \p crc_enable is set, otherwise 0.
+ */
+typedef struct
+{
+    bool (*begin)(void *ctx, const cpioFile_t *file);
+    bool (*data)(void *ctx, const cpioFile_t *file, const void *data, uint32_t size);
+    void (*end)(void *ctx, const cpioFile_t *file, bool ok, uint32_t crc);
+} cpioStreamSink_t;
+
 /**
  * \brief Create a cpio stream
  *
@@ -48,6 +78,20 @@ typedef struct
  */
 cpioStream_t *cpioStreamCreate(const cpioStreamCfg_t *cfg);
 
+/**
+ * \brief Create a cpio stream in sink mode
+ *
+ * Files are delivered to \p sink, and \p cpioStreamPopFile will always
+ * return NULL. All callbacks are called inside \p cpioStreamPushData
+ * or \p cpioStreamDestroy.
+ *
+ * \param cfg   stream configure
+ * \param sink  sink callbacks, \p begin and \p end can be NULL
+ * \param ctx   context for callbacks
+ * \return  cpio stream or NULL
+ */
+cpioStream_t *cpioStreamCreateWithSink(const cpioStreamCfg_t *cfg, const cpioStreamSink_t *sink, void *ctx);
+
 /**
  * \brief Destroy the cpio stream
  * \param stream    the stream
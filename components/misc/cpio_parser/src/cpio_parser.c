@@ -16,6 +16,7 @@
 #include "cpio_parser.h"
 #include "osi_log.h"
 #include "osi_api.h"
+#include "calclib/crc32.h"
 
 #include <stddef.h>
 #include <stdlib.h>
@@ -60,12 +61,17 @@ typedef struct cpio_file
     cpioFile_t file;
     cpioOldBinLE_t head;
     cpioFileParserPhase_t phase;
+    bool discard; // sink mode, file data are not delivered
+    uint32_t crc;
     cpioFileEntry_t entry;
 } cpioFilePriv_t;
 
 struct cpio_stream
 {
     cpioStreamCfg_t cfg;
+    bool sink_mode;
+    cpioStreamSink_t sink;
+    void *sink_ctx;
     cpioFileList_t store_list;
     cpioFileList_t used_list;
     cpioOldBinLE_t process_head;
@@ -91,6 +97,21 @@ cpioStream_t *cpioStreamCreate(const cpioStreamCfg_t *cfg)
     return s;
 }
 
+cpioStream_t *cpioStreamCreateWithSink(const cpioStreamCfg_t *cfg, const cpioStreamSink_t *sink, void *ctx)
+{
+    if (sink == NULL)
+        return NULL;
+
+    cpioStream_t *s = cpioStreamCreate(cfg);
+    if (s == NULL)
+        return NULL;
+
+    s->sink_mode = true;
+    s->sink = *sink;
+    s->sink_ctx = ctx;
+    return s;
+}
+
 void cpioStreamDestroy(cpioStream_t *s)
 {
     if (s == NULL)
@@ -98,6 +119,9 @@ void cpioStreamDestroy(cpioStream_t *s)
 
     if (s->process_file != NULL)
     {
+        cpioFilePriv_t *f = s->process_file;
+        if (s->sink_mode && f->phase == PHASE_DATA && !f->discard && s->sink.end != NULL)
+            s->sink.end(s->sink_ctx, &f->file, false, 0);
         free(s->process_file);
         s->process_file = NULL;
     }
@@ -119,11 +143,74 @@ void cpioStreamDestroy(cpioStream_t *s)
 
 static void prvPushHead(cpioStream_t *s, uint8_t *data, uint32_t len);
 
+static void prvSinkBegin(cpioStream_t *s, cpioFilePriv_t *f)
+{
+    // trailer is the end mark of archive, rather than a file
+    f->discard = (strcmp(CPIO_TRAILER, f->file.name) == 0);
+    if (!f->discard && s->sink.begin != NULL)
+        f->discard = !s->sink.begin(s->sink_ctx, &f->file);
+    f->crc = s->cfg.crc_enable ? crc32Init() : 0;
+}
+
+static void prvSinkData(cpioStream_t *s, cpioFilePriv_t *f, const uint8_t *data, uint32_t len)
+{
+    if (f->discard)
+        return;
+
+    if (s->cfg.crc_enable)
+        f->crc = crc32Update(f->crc, data, len);
+    if (s->sink.data != NULL && !s->sink.data(s->sink_ctx, &f->file, data, len))
+    {
+        OSI_LOGE(0, "cpio sink data fail, file skipped");
+        f->discard = true;
+        if (s->sink.end != NULL)
+            s->sink.end(s->sink_ctx, &f->file, false, 0);
+    }
+}
+
+static void prvFileDone(cpioStream_t *s, cpioFilePriv_t *f)
+{
+    s->process_file = NULL;
+    if (s->sink_mode)
+    {
+        if (!f->discard && s->sink.end != NULL)
+            s->sink.end(s->sink_ctx, &f->file, true, f->crc);
+        free(f);
+    }
+    else if (strcmp(CPIO_TRAILER, f->file.name) == 0)
+    {
+        free(f);
+    }
+    else
+    {
+        TAILQ_INSERT_TAIL(&s->store_list, f, entry);
+        s->file_count += 1;
+    }
+}
+
+static void prvDataPhase(cpioStream_t *s, cpioFilePriv_t *f)
+{
+    f->phase = PHASE_DATA;
+    if (s->sink_mode)
+        prvSinkBegin(s, f);
+}
+
 static void prvPushData(cpioStream_t *s, uint8_t *data, uint32_t len)
 {
     cpioFilePriv_t *f = s->process_file;
-    while (len > 0)
+    for (;;)
     {
+        // checked before data, for empty file
+        if (f->phase == PHASE_DATA && s->process_size == f->head.data_size)
+        {
+            s->process_size = 0;
+            prvFileDone(s, f);
+            break;
+        }
+
+        if (len == 0)
+            break;
+
         if (f->phase == PHASE_NAME)
         {
             uint32_t fnlen = f->head.path_len - s->process_size;
@@ -135,7 +222,11 @@ static void prvPushData(cpioStream_t *s, uint8_t *data, uint32_t len)
             if (s->process_size == f->head.path_len)
             {
                 s->process_size = 0;
-                f->phase = f->head.path_len % 2 ? PHASE_SKIP : PHASE_DATA;
+                f->file.name[f->head.path_len - 1] = '\0';
+                if (f->head.path_len % 2)
+                    f->phase = PHASE_SKIP;
+                else
+                    prvDataPhase(s, f);
             }
         }
         else if (f->phase == PHASE_DATA)
@@ -143,30 +234,17 @@ static void prvPushData(cpioStream_t *s, uint8_t *data, uint32_t len)
             uint32_t datalen = f->head.data_size - s->process_size;
             if (datalen > len)
                 datalen = len;
-            memcpy(f->file.data + s->process_size, data, datalen);
+            if (s->sink_mode)
+                prvSinkData(s, f, data, datalen);
+            else
+                memcpy(f->file.data + s->process_size, data, datalen);
             STREAM_INC(data, len, datalen);
             s->process_size += datalen;
-            if (s->process_size == f->head.data_size)
-            {
-                s->process_size = 0;
-                if (strcmp(CPIO_TRAILER, f->file.name) == 0)
-                {
-                    free(s->process_file);
-                    s->process_file = NULL;
-                }
-                else
-                {
-                    TAILQ_INSERT_TAIL(&s->store_list, f, entry);
-                    s->process_file = NULL;
-                    s->file_count += 1;
-                }
-                break;
-            }
         }
         else if (f->phase == PHASE_SKIP)
         {
             STREAM_INC(data, len, 1);
-            f->phase = PHASE_DATA;
+            prvDataPhase(s, f);
         }
     }
 
@@ -240,14 +318,16 @@ static void prvPushHead(cpioStream_t *s, uint8_t *data, uint32_t len)
             h->data_size = prvMoLeToUint32(h->data_size);
             s->process_size = 0;
             OSI_LOGV(0, "cpio parser got header(%p/%u/%u)", h, h->path_len, h->data_size);
-            if (h->data_size > s->cfg.file_size_max || h->path_len > s->cfg.file_path_max)
+            if (h->data_size > s->cfg.file_size_max || h->path_len > s->cfg.file_path_max || h->path_len == 0)
             {
                 OSI_LOGE(0, "cpio file too large. (%u/%u)", h->path_len, h->data_size);
                 prvSkipFile(s, h, data, &len);
             }
             else
             {
-                const unsigned alloc_size = sizeof(cpioFilePriv_t) + h->data_size + h->path_len;
+                // file data aren't buffered in sink mode
+                const unsigned data_size = s->sink_mode ? 0 : h->data_size;
+                const unsigned alloc_size = sizeof(cpioFilePriv_t) + data_size + h->path_len;
                 cpioFilePriv_t *f = (cpioFilePriv_t *)malloc(alloc_size);
                 if (f == NULL)
                 {
@@ -260,7 +340,9 @@ static void prvPushHead(cpioStream_t *s, uint8_t *data, uint32_t len)
                     f->phase = PHASE_NAME;
                     f->file.data_size = h->data_size;
                     f->file.name = (char *)f + sizeof(cpioFilePriv_t);
-                    f->file.data = (uint8_t *)f->file.name + h->path_len;
+                    f->file.data = s->sink_mode ? NULL : (uint8_t *)f->file.name + h->path_len;
+                    f->discard = false;
+                    f->crc = 0;
                     f->file.mode = h->mode;
                     s->process_file = f;
                     break;
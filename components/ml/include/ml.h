@@ -58,6 +58,35 @@ void mlInit(void);
  */
 void *mlConvertStr(const void *from, int from_size, unsigned from_chset, unsigned to_chset, int *to_size);
 
+/**
+ * convert a string charset to caller buffer
+ *
+ * It is the same as \a mlConvertStr, except the output is written to
+ * caller buffer, and no memory is allocated.
+ *
+ * When \a to_size is not enough, the output is truncated at character
+ * boundary. null character is always inserted if \a to_size is enough
+ * for null character. The return value is the output byte count without
+ * truncation, not including null character. So, the output is truncated
+ * when the return value plus null character size is larger than
+ * \a to_size. \a to can be NULL with \a to_size 0, to get the output
+ * byte count.
+ *
+ * ASCII characters between UTF8, UTF16, ISO8859-1 and CP936 are
+ * converted in bulk.
+ *
+ * @param to            output buffer
+ * @param to_size       output buffer size
+ * @param from          input string
+ * @param from_size     input string byte count, -1 for null terminated
+ * @param from_chset    input string charset
+ * @param to_chset      output string charset
+ * @return
+ *      - -1: invalid parameters
+ *      - output byte count, not including null character
+ */
+int mlConvertStrTo(void *to, int to_size, const void *from, int from_size, unsigned from_chset, unsigned to_chset);
+
 int mlCharCount(const void *s, unsigned chset);
 
 int mlStrBytes(const void *s, unsigned chset);
@@ -18,6 +18,12 @@
 #include <limits.h>
 #include <stdlib.h>
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define ML_CONVERT_STACK_SIZE (128)
+
 typedef struct
 {
     mlCharsetHead_t chsets;
@@ -65,14 +71,16 @@ static bool _charByteCount(const void *s, int size, unsigned chset, int *char_co
     if (size < 0)
         size = INT_MAX;
 
+    const uint8_t *p = (const uint8_t *)s;
     unsigned code_point;
     int chars = 0;
     int bytes = 0;
     while (size > 0)
     {
-        int rsize = ch->read_char(s, size, &code_point);
+        int rsize = ch->read_char(p, size, &code_point);
         if (code_point == 0)
             break;
+        p += rsize;
         size -= rsize;
         bytes += rsize;
         chars++;
@@ -99,46 +107,253 @@ int mlByteCount(const void *s, unsigned chset)
     return bytes;
 }
 
-void *mlConvertStr(const void *from, int from_size, unsigned from_chset, unsigned to_chset, int *pto_size)
+/**
+ * Count of leading characters in [1, 0x7f], for byte encoding.
+ */
+static unsigned _asciiSpan8(const uint8_t *p, unsigned count)
 {
-    if (from == NULL)
-        return NULL;
+    unsigned n = 0;
+#if defined(__ARM_NEON)
+    for (; n + 16 <= count; n += 16)
+    {
+        // (c - 1) < 0x7f for all bytes
+        uint8x16_t bad = vcgeq_u8(vsubq_u8(vld1q_u8(p + n), vdupq_n_u8(1)), vdupq_n_u8(0x7f));
+        uint8x8_t r = vorr_u8(vget_low_u8(bad), vget_high_u8(bad));
+        if (vget_lane_u64(vreinterpret_u64_u8(r), 0) != 0)
+            break;
+    }
+#else
+    for (; n + 4 <= count; n += 4)
+    {
+        // no byte with bit 7, and no zero byte
+        uint32_t w;
+        memcpy(&w, p + n, 4);
+        if (((w | (w - 0x01010101)) & 0x80808080) != 0)
+            break;
+    }
+#endif
+    for (; n < count; n++)
+    {
+        if ((uint8_t)(p[n] - 1) >= 0x7f)
+            break;
+    }
+    return n;
+}
+
+/**
+ * Count of leading characters in [1, 0x7f], for 16 bits encoding.
+ */
+static unsigned _asciiSpan16(const uint8_t *p, unsigned count, bool be)
+{
+    unsigned n = 0;
+#if defined(__ARM_NEON)
+    for (; n + 16 <= count; n += 16)
+    {
+        uint8x16x2_t v = vld2q_u8(p + n * 2);
+        uint8x16_t lo = be ? v.val[1] : v.val[0];
+        uint8x16_t hi = be ? v.val[0] : v.val[1];
+        uint8x16_t bad = vorrq_u8(hi, vcgeq_u8(vsubq_u8(lo, vdupq_n_u8(1)), vdupq_n_u8(0x7f)));
+        uint8x8_t r = vorr_u8(vget_low_u8(bad), vget_high_u8(bad));
+        if (vget_lane_u64(vreinterpret_u64_u8(r), 0) != 0)
+            break;
+    }
+#endif
+    for (; n < count; n++)
+    {
+        uint8_t lo = be ? p[n * 2 + 1] : p[n * 2];
+        uint8_t hi = be ? p[n * 2] : p[n * 2 + 1];
+        if (hi != 0 || (uint8_t)(lo - 1) >= 0x7f)
+            break;
+    }
+    return n;
+}
+
+static void _asciiWiden(uint8_t *to, const uint8_t *from, unsigned count, bool be)
+{
+    unsigned n = 0;
+#if defined(__ARM_NEON)
+    for (; n + 16 <= count; n += 16)
+    {
+        uint8x16x2_t v;
+        v.val[be ? 1 : 0] = vld1q_u8(from + n);
+        v.val[be ? 0 : 1] = vdupq_n_u8(0);
+        vst2q_u8(to + n * 2, v);
+    }
+#endif
+    for (; n < count; n++)
+    {
+        to[n * 2] = be ? 0 : from[n];
+        to[n * 2 + 1] = be ? from[n] : 0;
+    }
+}
+
+static void _asciiNarrow(uint8_t *to, const uint8_t *from, unsigned count, bool be)
+{
+    unsigned n = 0;
+#if defined(__ARM_NEON)
+    for (; n + 16 <= count; n += 16)
+    {
+        uint8x16x2_t v = vld2q_u8(from + n * 2);
+        vst1q_u8(to + n, be ? v.val[1] : v.val[0]);
+    }
+#endif
+    for (; n < count; n++)
+        to[n] = be ? from[n * 2 + 1] : from[n * 2];
+}
+
+/**
+ * Convert leading ASCII characters in bulk. When \a to is NULL, only
+ * the output size is counted.
+ */
+static unsigned _asciiRun(const mlCharset_t *fch, const mlCharset_t *tch,
+                          const uint8_t *from, unsigned from_size,
+                          uint8_t *to, unsigned to_size, unsigned *consumed)
+{
+    *consumed = 0;
+    if (fch->ascii_mode == ML_ASCII_NONE || tch->ascii_mode == ML_ASCII_NONE)
+        return 0;
+
+    unsigned fu = (fch->ascii_mode == ML_ASCII_BYTE) ? 1 : 2;
+    unsigned tu = (tch->ascii_mode == ML_ASCII_BYTE) ? 1 : 2;
+    unsigned count = from_size / fu;
+    if (to != NULL)
+        count = OSI_MIN(unsigned, count, to_size / tu);
+
+    bool fbe = (fch->ascii_mode == ML_ASCII_U16BE);
+    bool tbe = (tch->ascii_mode == ML_ASCII_U16BE);
+    unsigned n = (fu == 1) ? _asciiSpan8(from, count) : _asciiSpan16(from, count, fbe);
+    if (to != NULL)
+    {
+        if (fu == 1 && tu == 1)
+            memcpy(to, from, n);
+        else if (fu == 1)
+            _asciiWiden(to, from, n, tbe);
+        else if (tu == 1)
+            _asciiNarrow(to, from, n, fbe);
+        else if (fbe == tbe)
+            memcpy(to, from, n * 2);
+        else
+        {
+            for (unsigned m = 0; m < n; m++)
+            {
+                to[m * 2] = from[m * 2 + 1];
+                to[m * 2 + 1] = from[m * 2];
+            }
+        }
+    }
+
+    *consumed = n * fu;
+    return n * tu;
+}
+
+/**
+ * Byte count of null terminated string, not including null character.
+ */
+static unsigned _strBytes(const uint8_t *s, const mlCharset_t *ch)
+{
+    if (ch->ascii_mode == ML_ASCII_BYTE)
+        return strlen((const char *)s);
+
+    unsigned n = 0;
+    while (s[n] != 0 || s[n + 1] != 0)
+        n += 2;
+    return n;
+}
+
+int mlConvertStrTo(void *to, int to_size, const void *from, int from_size, unsigned from_chset, unsigned to_chset)
+{
+    if (from == NULL || (to == NULL && to_size > 0))
+        return -1;
 
     mlCharset_t *fch = _findCharset(from_chset);
     mlCharset_t *tch = _findCharset(to_chset);
     if (fch == NULL || tch == NULL)
-        return NULL;
-
-    int char_count, byte_count;
-    if (!_charByteCount(from, from_size, from_chset, &char_count, &byte_count))
-        return NULL;
+        return -1;
 
-    if (from_size < byte_count)
-        from_size = byte_count;
+    // Bulk conversion may read ahead, so the size of null terminated
+    // input should be known. Others are terminated by read_char.
+    if (from_size < 0)
+        from_size = (fch->ascii_mode == ML_ASCII_NONE) ? INT_MAX : _strBytes(from, fch);
 
-    int to_mem_size = (char_count + 1) * tch->max_bytes;
-    void *to = calloc(1, to_mem_size);
-    uint8_t *pt = (uint8_t *)to;
+    // null character is zero of minimal bytes, GSM hasn't null character
+    unsigned null_size = tch->min_bytes;
+    bool full = (to_size < (int)null_size);
+    unsigned left = full ? 0 : to_size - null_size;
     const uint8_t *pf = (const uint8_t *)from;
-    int to_size = 0;
+    uint8_t *pt = (uint8_t *)to;
+    int out_size = 0;
 
-    unsigned codepoint;
     while (from_size > 0)
     {
+        unsigned consumed;
+        unsigned asize = _asciiRun(fch, tch, pf, from_size, full ? NULL : pt, left, &consumed);
+        pf += consumed;
+        from_size -= consumed;
+        out_size += asize;
+        if (!full)
+        {
+            pt += asize;
+            left -= asize;
+        }
+        if (from_size <= 0)
+            break;
+
+        unsigned codepoint;
         int rsize = fch->read_char(pf, from_size, &codepoint);
         pf += rsize;
         from_size -= rsize;
         if (codepoint == 0)
             break;
 
-        int wsize = tch->write_char(pt, INT_MAX, codepoint);
+        unsigned ch = codepoint;
+        int wsize = tch->write_char(NULL, 0, ch);
         if (wsize < 0)
-            wsize = tch->write_char(pt, INT_MAX, tch->invalid_fill_char);
-        to_size += wsize;
-        pt += wsize;
+        {
+            ch = tch->invalid_fill_char;
+            wsize = tch->write_char(NULL, 0, ch);
+        }
+
+        // output is truncated at character boundary
+        if (!full && (unsigned)wsize <= left)
+        {
+            tch->write_char(pt, left, ch);
+            pt += wsize;
+            left -= wsize;
+        }
+        else
+        {
+            full = true;
+        }
+        out_size += wsize;
     }
 
-    tch->write_char(pt, INT_MAX, 0);
+    if (to_size >= (int)null_size)
+        memset(pt, 0, null_size);
+    return out_size;
+}
+
+void *mlConvertStr(const void *from, int from_size, unsigned from_chset, unsigned to_chset, int *pto_size)
+{
+    mlCharset_t *tch = _findCharset(to_chset);
+    if (tch == NULL)
+        return NULL;
+
+    // Short strings are converted once, to stack buffer.
+    uint8_t buf[ML_CONVERT_STACK_SIZE];
+    int to_size = mlConvertStrTo(buf, sizeof(buf), from, from_size, from_chset, to_chset);
+    if (to_size < 0)
+        return NULL;
+
+    int mem_size = to_size + tch->min_bytes;
+    void *to = malloc(mem_size);
+    if (to == NULL)
+        return NULL;
+
+    if (mem_size <= (int)sizeof(buf))
+        memcpy(to, buf, mem_size);
+    else
+        mlConvertStrTo(to, mem_size, from, from_size, from_chset, to_chset);
+
     if (pto_size != NULL)
         *pto_size = to_size;
     return to;
@@ -162,7 +377,7 @@ uint16_t mlGetUnicode(uint16_t from, uint32_t from_chset)
 
 uint16_t mlGetOEM(uint32_t unicd, uint32_t to_chset)
 {
-    unsigned ret;
+    unsigned ret = 0;
 
     mlCharset_t *tch = _findCharset(to_chset);
     if (tch == NULL)
@@ -11,6 +11,7 @@
 */
 
 #include "ml_internal.h"
+#include <stdlib.h>
 
 const uint16_t ML_GB2312ToUnicode0[] = {
     /*0x2121,*/ 0x3000,
@@ -7763,41 +7764,165 @@ not_enough:
     return size;
 }
 
-static int _writeChar(void *out, unsigned size, unsigned val)
+/**
+ * Reverse index from UNICODE to GB2312. The first level is the high byte
+ * of UNICODE, and the second level is sorted low byte of UNICODE in
+ * each high byte.
+ */
+typedef struct
 {
-    uint8_t *pout = (uint8_t *)out;
-    if (val < 0x80)
+    uint16_t start[257]; // entry start of each high byte
+    uint16_t *code;      // GB2312 code, without 0x8080
+    uint8_t *low;        // low byte of UNICODE
+} mlCp936Index_t;
+
+static mlCp936Index_t *gCp936Index;
+
+static mlCp936Index_t *_indexBuild(void)
+{
+    unsigned total = 0;
+    for (int n = 0; n < OSI_ARRAY_SIZE(gb2312_array); n++)
+        total += gb2312_array[n].size;
+
+    mlCp936Index_t *idx = (mlCp936Index_t *)calloc(1, sizeof(mlCp936Index_t) + total * 3);
+    if (idx == NULL)
+        return NULL;
+
+    idx->code = (uint16_t *)((uint8_t *)idx + sizeof(mlCp936Index_t));
+    idx->low = (uint8_t *)(idx->code + total);
+
+    for (int n = 0; n < OSI_ARRAY_SIZE(gb2312_array); n++)
     {
-        if (pout != NULL && size >= 1)
-            *pout = val;
-        return 1;
+        for (int m = 0; m < gb2312_array[n].size; m++)
+        {
+            if (gb2312_array[n].value[m] >= 0x80)
+                idx->start[(gb2312_array[n].value[m] >> 8) + 1]++;
+        }
     }
 
+    uint16_t pos[256];
+    for (int h = 0; h < 256; h++)
+    {
+        idx->start[h + 1] += idx->start[h];
+        pos[h] = idx->start[h];
+    }
+
+    // insertion sort is stable, the first one is used for duplicated,
+    // the same as searching the table
     for (int n = 0; n < OSI_ARRAY_SIZE(gb2312_array); n++)
     {
         for (int m = 0; m < gb2312_array[n].size; m++)
         {
-            if (gb2312_array[n].value[m] == val)
+            uint16_t val = gb2312_array[n].value[m];
+            if (val < 0x80)
+                continue;
+
+            unsigned h = val >> 8;
+            uint8_t l = val & 0xff;
+            unsigned i = pos[h]++;
+            for (; i > idx->start[h] && idx->low[i - 1] > l; i--)
+            {
+                idx->low[i] = idx->low[i - 1];
+                idx->code[i] = idx->code[i - 1];
+            }
+            idx->low[i] = l;
+            idx->code[i] = gb2312_array[n].min + m;
+        }
+    }
+    return idx;
+}
+
+/**
+ * Reverse index is created at the first use.
+ */
+static const mlCp936Index_t *_index(void)
+{
+    mlCp936Index_t *idx = gCp936Index;
+    if (idx != NULL)
+        return idx;
+
+    idx = _indexBuild();
+    if (idx == NULL)
+        return NULL;
+
+    uint32_t critical = osiEnterCritical();
+    if (gCp936Index == NULL)
+    {
+        gCp936Index = idx;
+        idx = NULL;
+    }
+    osiExitCritical(critical);
+
+    free(idx); // created by others
+    return gCp936Index;
+}
+
+static int _findCode(unsigned val)
+{
+    const mlCp936Index_t *idx = _index();
+    if (idx == NULL)
+    {
+        for (int n = 0; n < OSI_ARRAY_SIZE(gb2312_array); n++)
+        {
+            for (int m = 0; m < gb2312_array[n].size; m++)
             {
-                if (pout != NULL && size >= 2)
-                {
-                    uint16_t to = gb2312_array[n].min + m + 0x8080;
-                    *pout++ = (to >> 8) & 0xff;
-                    *pout++ = to & 0xff;
-                }
-                return 2;
+                if (gb2312_array[n].value[m] == val)
+                    return gb2312_array[n].min + m;
             }
         }
+        return -1;
     }
 
+    if (val > 0xffff)
+        return -1;
+
+    // lower bound of low byte
+    uint8_t l = val & 0xff;
+    unsigned lo = idx->start[val >> 8];
+    unsigned hi = idx->start[(val >> 8) + 1];
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+        if (idx->low[mid] < l)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo < idx->start[(val >> 8) + 1] && idx->low[lo] == l)
+        return idx->code[lo];
     return -1;
 }
 
+static int _writeChar(void *out, unsigned size, unsigned val)
+{
+    uint8_t *pout = (uint8_t *)out;
+    if (val < 0x80)
+    {
+        if (pout != NULL && size >= 1)
+            *pout = val;
+        return 1;
+    }
+
+    int code = _findCode(val);
+    if (code < 0)
+        return -1;
+
+    if (pout != NULL && size >= 2)
+    {
+        uint16_t to = code + 0x8080;
+        *pout++ = (to >> 8) & 0xff;
+        *pout++ = to & 0xff;
+    }
+    return 2;
+}
+
 static mlCharset_t cp936Chset = {
     .chset = ML_CP936,
     .min_bytes = 1,
     .max_bytes = 2,
     .invalid_fill_char = '?',
+    .ascii_mode = ML_ASCII_BYTE,
     .read_char = _readChar,
     .write_char = _writeChar,
 };
@@ -11,6 +11,7 @@
 */
 
 #include "ml_internal.h"
+#include <string.h>
 
 // 3GPP 23.038
 
@@ -53,6 +54,9 @@ static const u16map_t gsmExt[] = {
     {0x40, 0x7c},
     {0x65, 0x20ac}};
 
+// GSM basic character of ASCII, 0xff for not in basic table
+static uint8_t gsmFromAscii[128];
+
 static int _readChar(const void *in, unsigned size, unsigned *val)
 {
     const uint8_t *pin = (const uint8_t *)in;
@@ -98,6 +102,13 @@ static int _writeChar(void *out, unsigned size, unsigned val)
     if (val == ESCAPE_CHAR)
         return -1;
 
+    if (val < 0x80 && gsmFromAscii[val] != 0xff)
+    {
+        if (pout != NULL && size >= 1)
+            *pout++ = gsmFromAscii[val];
+        return 1;
+    }
+
     for (int n = 0; n < OSI_ARRAY_SIZE(gsmBasic); n++)
     {
         if (val == gsmBasic[n])
@@ -144,5 +155,13 @@ static mlCharset_t gsmChset = {
 
 void mlAddGsm(void)
 {
+    // the first one is used for duplicated, the same as searching
+    memset(gsmFromAscii, 0xff, sizeof(gsmFromAscii));
+    for (int n = OSI_ARRAY_SIZE(gsmBasic) - 1; n >= 0; n--)
+    {
+        if (gsmBasic[n] < 0x80)
+            gsmFromAscii[gsmBasic[n]] = n;
+    }
+
     mlAddCharset(&gsmChset);
 }
@@ -22,6 +22,17 @@ extern "C" {
 
 #define INVALID_CODE_POINT (0xffffffff)
 
+/**
+ * how ASCII characters are encoded, for bulk conversion of ASCII runs
+ */
+enum
+{
+    ML_ASCII_NONE,  ///< not the same as ASCII
+    ML_ASCII_BYTE,  ///< one byte, the same as ASCII
+    ML_ASCII_U16LE, ///< little endian 16 bits
+    ML_ASCII_U16BE, ///< big endian 16 bits
+};
+
 typedef SLIST_ENTRY(mlCharset) mlCharsetEntry_t;
 typedef SLIST_HEAD(mlCharsetHead, mlCharset) mlCharsetHead_t;
 
@@ -47,6 +58,11 @@ typedef struct mlCharset
      */
     unsigned invalid_fill_char;
 
+    /**
+     * ASCII encoding, ML_ASCII_NONE when unknown
+     */
+    uint8_t ascii_mode;
+
     /**
      * read a character from input
      *
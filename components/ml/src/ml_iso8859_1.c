@@ -43,6 +43,7 @@ static mlCharset_t iso8859_1Chset = {
     .min_bytes = 1,
     .max_bytes = 1,
     .invalid_fill_char = '?',
+    .ascii_mode = ML_ASCII_BYTE,
     .read_char = _readChar,
     .write_char = _writeChar,
 };
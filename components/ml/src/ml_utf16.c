@@ -113,6 +113,7 @@ static mlCharset_t utf16beChset = {
     .min_bytes = 2,
     .max_bytes = 4,
     .invalid_fill_char = '?',
+    .ascii_mode = ML_ASCII_U16BE,
     .read_char = _readCharBE,
     .write_char = _writeCharBE,
 };
@@ -122,6 +123,7 @@ static mlCharset_t utf16leChset = {
     .min_bytes = 2,
     .max_bytes = 4,
     .invalid_fill_char = '?',
+    .ascii_mode = ML_ASCII_U16LE,
     .read_char = _readCharLE,
     .write_char = _writeCharLE,
 };
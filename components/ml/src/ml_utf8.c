@@ -130,6 +130,7 @@ static mlCharset_t utf8Chset = {
     .min_bytes = 1,
     .max_bytes = 4,
     .invalid_fill_char = '?',
+    .ascii_mode = ML_ASCII_BYTE,
     .read_char = _readChar,
     .write_char = _writeChar,
 };
@@ -13,11 +13,19 @@
 #ifndef _FTP_PROTOCOL_H_
 #define _FTP_PROTOCOL_H_
 
+#include "osi_pipe.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 #define FTP_STRING_SIZE 256
 
+/* chunk size of draining the data channel to file or pipe, and the
+ * buffer size of each side of the asynchronous file writer */
+#ifndef FTP_DATA_WINDOW_SIZE
+#define FTP_DATA_WINDOW_SIZE (8 * 1024)
+#endif
+
 #define FTP_RET_SUCCESS 0
 #define FTP_RET_API_ERR -1
 #define FTP_RET_FTP_NOT_INITED -2
@@ -121,6 +129,47 @@ ftp_ret_t FTPLib_size(char *file, uint32_t *size);
 ftp_ret_t FTPLib_getStart(char *file, uint32_t offset, uint32_t size);
 int32_t FTPLib_get(uint8_t *buf, uint32_t buflen);
 ftp_ret_t FTPLib_getStop();
+
+/**
+ * download file to local file system
+ *
+ * Data is drained from the data channel inside ftplib, and written to
+ * \p local through asynchronous file write, so there are no
+ * FTP_MSG_TRANSFER_DATA events. The local file is flushed and closed
+ * before FTP_MSG_GET is reported.
+ *
+ * With \p resume, the download starts from the size of existing local
+ * file by REST, and data is appended. When the local file is already
+ * complete, the server rejects the offset and FTP_RET_CMD_REP_ERR is
+ * reported.
+ *
+ * \param file     remote file path
+ * \param local    local file path
+ * \param resume   continue from the end of existing local file
+ * \return
+ *      - FTP_RET_SUCCESS on success
+ *      - FTP_RET_INTERNAL_ERR on local file error
+ *      - other FTP_RET_xxx on error
+ */
+ftp_ret_t FTPLib_getToFile(char *file, const char *local, bool resume);
+
+/**
+ * download file to pipe
+ *
+ * Data is drained from the data channel inside ftplib, and written to
+ * \p pipe, for example the pipe of audio player. When the pipe is full,
+ * data channel reading is paused, and TCP flow control will throttle
+ * the server. The pipe won't be closed when finished.
+ *
+ * \param file     remote file path
+ * \param offset   start offset of remote file
+ * \param size     download size, 0 for till the end
+ * \param pipe     the pipe, must be valid till FTP_MSG_GET
+ * \return
+ *      - FTP_RET_SUCCESS on success
+ *      - other FTP_RET_xxx on error
+ */
+ftp_ret_t FTPLib_getToPipe(char *file, uint32_t offset, uint32_t size, osiPipe_t *pipe);
 ftp_ret_t FTPLib_putStart(char *file);
 ftp_ret_t FTPLib_put(uint8_t *buf, uint32_t buflen);
 ftp_ret_t FTPLib_putStop();
@@ -20,6 +20,8 @@
 #include "ftp_utils.h"
 #include "ftp_protocol.h"
 #include "ftp_connection.h"
+#include "vfs.h"
+#include "vfs_aio.h"
 
 #define TIMEOUT_RECV_CMD 40
 #define TIMEOUT_RECV_DATA 20
@@ -159,6 +161,26 @@ typedef struct _ftp_putopt_t
     char putpath[FTP_STRING_SIZE];
 } ftp_putopt_t;
 
+typedef enum _ftp_sinkmode_t
+{
+    FTP_SINK_NULL = 0,
+    FTP_SINK_FILE,
+    FTP_SINK_PIPE
+} ftp_sinkmode_t;
+
+/* download destination when data is drained inside ftplib */
+typedef struct _ftp_sink_t
+{
+    ftp_sinkmode_t mode;
+    int fd;
+    vfs_aio_stream_t *stream;
+    osiPipe_t *pipe;
+    uint8_t *buf;
+    uint32_t pending; // available bytes reported by data channel, not read yet
+    bool draining;
+    bool failed;
+} ftp_sink_t;
+
 typedef struct _ftpctx_t
 {
     bool login;
@@ -169,6 +191,7 @@ typedef struct _ftpctx_t
     ftp_loginopt_t loginOpt;
     ftp_getopt_t getOpt;
     ftp_putopt_t putOpt;
+    ftp_sink_t sink;
     ftplib_cb_t callback;
 } ftpctx_t;
 
@@ -255,6 +278,118 @@ static void ftp_set_idle(ftpctx_t *ctx)
     }
 }
 
+static bool ftp_sink_open(ftpctx_t *ctx, ftp_sinkmode_t mode)
+{
+    ftp_sink_t *sink = &ctx->sink;
+
+    sink->buf = (uint8_t *)malloc(FTP_DATA_WINDOW_SIZE);
+    if (sink->buf == NULL)
+        return false;
+
+    sink->mode = mode;
+    sink->pending = 0;
+    sink->draining = false;
+    sink->failed = false;
+    return true;
+}
+
+/* Flush and release the sink, it should be called before the result of GET is reported */
+static void ftp_sink_close(ftpctx_t *ctx)
+{
+    ftp_sink_t *sink = &ctx->sink;
+
+    if (sink->mode == FTP_SINK_NULL)
+        return;
+
+    if (sink->mode == FTP_SINK_FILE)
+    {
+        if (vfs_aio_stream_delete(sink->stream) < 0)
+            sink->failed = true;
+        vfs_close(sink->fd);
+        sink->stream = NULL;
+        sink->fd = -1;
+    }
+
+    if (sink->failed)
+    {
+        FTPLOGI(FTPLOG_LIB, "ftp sink failed, %d bytes received", ctx->getOpt.getsize);
+        setError(FTP_RET_INTERNAL_ERR);
+    }
+
+    free(sink->buf);
+    sink->buf = NULL;
+    sink->pipe = NULL;
+    sink->mode = FTP_SINK_NULL;
+}
+
+static bool ftp_sink_write(ftp_sink_t *sink, const uint8_t *buf, uint32_t len)
+{
+    if (sink->mode == FTP_SINK_FILE)
+        return vfs_aio_stream_write(sink->stream, buf, len) == (ssize_t)len;
+
+    return osiPipeWriteAll(sink->pipe, buf, len, TIMEOUT_RECV_DATA * 1000) == (int)len;
+}
+
+/*
+ * Read the data channel in window size chunks, and write to the sink.
+ * Reading the last available byte will query the socket again, and it
+ * may report more data by nested onRead, which is accumulated to pending.
+ */
+static void ftp_sink_drain(ftpctx_t *ctx, uint32_t avail)
+{
+    ftp_sink_t *sink = &ctx->sink;
+    ftp_getopt_t *opt = &ctx->getOpt;
+
+    sink->pending += avail;
+    if (sink->draining)
+        return;
+
+    sink->draining = true;
+    while (sink->pending > 0 && !opt->getCancel)
+    {
+        uint32_t len = OSI_MIN(uint32_t, sink->pending, FTP_DATA_WINDOW_SIZE);
+        if (opt->req_getsize != 0)
+            len = OSI_MIN(uint32_t, len, opt->req_getsize - opt->getsize);
+
+        uint32_t stale = sink->pending;
+        int32_t bytes = ctx->ftpCon.op->read1(sink->buf, len, FTP_DATA_SOCK);
+        if (bytes < 0)
+            break;
+
+        if (bytes == 0)
+        {
+            // nothing left in socket, keep only data reported by nested onRead
+            sink->pending -= stale;
+            continue;
+        }
+
+        sink->pending -= bytes;
+        opt->getsize += bytes;
+        opt->req_ReadSize += bytes;
+
+        if (!ftp_sink_write(sink, sink->buf, bytes))
+        {
+            FTPLOGI(FTPLOG_LIB, "ftp sink write failed at %d", opt->req_getoffset + opt->getsize);
+            sink->failed = true;
+            opt->getCancel = true;
+            ctx->ftpCon.op->disconnect(FTP_DATA_SOCK);
+            break;
+        }
+
+        if (opt->req_getsize != 0 && opt->getsize >= opt->req_getsize)
+        {
+            opt->getCancel = true;
+            ctx->ftpCon.op->disconnect(FTP_DATA_SOCK);
+            break;
+        }
+    }
+    sink->pending = 0;
+    sink->draining = false;
+
+    if (!opt->getCancel)
+        ctx->ftpCon.op->setTimeout(TIMEOUT_RECV_DATA, FTP_DATA_SOCK);
+}
+
 static void ftp_result_output(ftpctx_t *ctx, uint32_t nEventId, uint32_t nResult, uint32_t nParam1, uint32_t nParam2)
 {
     //FTPLOGI(FTPLOG_LIB, "ftp get result of event[0x%x] with result[%d], param1:%d, param2:%d", nEventId, nResult, nParam1, nParam2);
@@ -941,6 +1076,7 @@ static void ftp_DataTransferFinish(ftpctx_t *ctx)
     ftp_msg_t msg;
 
     msg = ftp_getDataMsg(ctx);
+    ftp_sink_close(ctx);
     ftp_set_idle(ctx);
     ftp_result_output(ctx, msg, gFTPErrCode, 0, 0);
 }
@@ -1222,6 +1358,7 @@ static void ftp_ctrl_onDisconnect(void *context)
     case FTP_REST:
     case FTP_RETR:
     case FTP_STOR:
+        ftp_sink_close(ctx);
         setError(FTP_RET_CMD_BROKEN);
         ftp_result_output(ctx, ftp_getDataMsg(ctx), gFTPErrCode, 0, 0);
         break;
@@ -1483,6 +1620,12 @@ static void ftp_data_onRead(ftp_recv_ret_e ret, void *context, uint8_t *buf, uin
         {
             ctx->ftpCon.op->killTimeout(FTP_DATA_SOCK);
 
+            if (ctx->sink.mode != FTP_SINK_NULL)
+            {
+                ftp_sink_drain(ctx, buflen);
+                return;
+            }
+
             if (ctx->getOpt.req_getsize != 0)
             {
                 uint32_t lastsize = ctx->getOpt.req_getsize - ctx->getOpt.getsize;
@@ -1624,6 +1767,7 @@ bool FTPLib_uninit(void)
     }
 
     op->destroy();
+    ftp_sink_close(gFTPLibCtx);
 
     if (gFTPLibCtx->ftpc.apisem != NULL)
     {
@@ -1882,6 +2026,93 @@ ftp_ret_t FTPLib_getStop()
     return FTP_RET_SUCCESS;
 }
 
+static ftp_ret_t ftp_sink_check(void)
+{
+    if (gFTPLibCtx == NULL)
+    {
+        FTPLOGI(FTPLOG_LIB, "ftplib is not initialized.");
+        return FTP_RET_FTP_NOT_INITED;
+    }
+
+    if (!gFTPLibCtx->login)
+    {
+        FTPLOGI(FTPLOG_LIB, "ftplib didn't login to server yet.");
+        return FTP_RET_FTP_NOT_CONNECTED;
+    }
+
+    if (gFTPLibCtx->state != FTP_IDLE || gFTPLibCtx->dataCmd != FTP_DATA_NULL ||
+        gFTPLibCtx->sink.mode != FTP_SINK_NULL)
+    {
+        FTPLOGI(FTPLOG_LIB, "ftplib is busy.");
+        return FTP_RET_FTP_IS_BUSY;
+    }
+
+    return FTP_RET_SUCCESS;
+}
+
+ftp_ret_t FTPLib_getToFile(char *file, const char *local, bool resume)
+{
+    ftp_ret_t ret;
+
+    if (!file || !local)
+        return FTP_RET_API_ERR;
+
+    ret = ftp_sink_check();
+    if (ret != FTP_RET_SUCCESS)
+        return ret;
+
+    ftp_sink_t *sink = &gFTPLibCtx->sink;
+    int flags = O_WRONLY | O_CREAT | (resume ? 0 : O_TRUNC);
+    sink->fd = vfs_open(local, flags, 0666);
+    if (sink->fd < 0)
+    {
+        FTPLOGI(FTPLOG_LIB, "ftp failed to open local file");
+        return FTP_RET_INTERNAL_ERR;
+    }
+
+    long offset = vfs_lseek(sink->fd, 0, SEEK_END);
+    sink->stream = vfs_aio_stream_create(sink->fd, FTP_DATA_WINDOW_SIZE);
+    if (offset < 0 || sink->stream == NULL || !ftp_sink_open(gFTPLibCtx, FTP_SINK_FILE))
+    {
+        vfs_aio_stream_delete(sink->stream);
+        vfs_close(sink->fd);
+        sink->stream = NULL;
+        sink->fd = -1;
+        return FTP_RET_INTERNAL_ERR;
+    }
+
+    FTPLOGI(FTPLOG_LIB, "ftp get to file from offset %d", offset);
+
+    ret = FTPLib_getStart(file, (uint32_t)offset, 0);
+    if (ret != FTP_RET_SUCCESS)
+        ftp_sink_close(gFTPLibCtx);
+    return ret;
+}
+
+ftp_ret_t FTPLib_getToPipe(char *file, uint32_t offset, uint32_t size, osiPipe_t *pipe)
+{
+    ftp_ret_t ret;
+
+    if (!file || !pipe)
+        return FTP_RET_API_ERR;
+
+    ret = ftp_sink_check();
+    if (ret != FTP_RET_SUCCESS)
+        return ret;
+
+    gFTPLibCtx->sink.pipe = pipe;
+    if (!ftp_sink_open(gFTPLibCtx, FTP_SINK_PIPE))
+    {
+        gFTPLibCtx->sink.pipe = NULL;
+        return FTP_RET_INTERNAL_ERR;
+    }
+
+    ret = FTPLib_getStart(file, offset, size);
+    if (ret != FTP_RET_SUCCESS)
+        ftp_sink_close(gFTPLibCtx);
+    return ret;
+}
+
 ftp_ret_t FTPLib_putStart(char *file)
 {
     if (!file || (strlen(file) == 0) || (strlen(file) > (FTP_STRING_SIZE - 1)))
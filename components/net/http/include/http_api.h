@@ -321,6 +321,14 @@ mUpnpHttpResponse *Http_authorization(Http_info *http_info1);
 char *Normal_Base64(char *input_buffer);
 long cg_http_api_post_contentLen(mUpnpHttpRequest *httpReq, char *ipaddr, int port, bool isSecure);
 mUpnpHttpResponse *cg_http_api_response(mUpnpHttpRequest *httpReq, char *ipaddr, int port, bool isSecure);
+/* Send idempotent requests back to back on one keep-alive connection, return responses read */
+int cg_http_api_pipeline(mUpnpHttpRequest **httpReqs, int count, char *ipaddr, int port, bool isSecure);
+/* Close all idle keep-alive connections */
+void cg_http_api_pool_flush(void);
+/* Building blocks for callers reading the response body by themselves */
+mUpnpSocket *cg_http_api_connect(char *ipaddr, int port, bool isSecure);
+bool cg_http_api_prepare(mUpnpHttpRequest *httpReq, char *ipaddr, int port);
+bool cg_http_api_send(mUpnpHttpRequest *httpReq, mUpnpSocket *g_sock);
 #if defined(MUPNP_USE_OPENSSL)
 bool Https_saveCrttoFile(char *pemData, uint32_t pemLen, uint32_t pemtype);
 bool Https_setCrt(uint32_t pemtype, uint8_t **crtPem);
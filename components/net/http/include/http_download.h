@@ -56,6 +56,7 @@ extern "C" {
 #define AT_HTTP_DOWNLOAD_DELAY 1000
 #define AT_HTTP_GETN_DELAY 1000
 #define AT_HTTP_POSTN_DELAY 1000
+#define CG_HTTP_DOWNLOAD_SEGMENT_MAX 3
 
 /****************************************
 * Function (Http api)
@@ -64,6 +65,12 @@ bool Http_downLoad(Http_info *http_info1);
 
 bool cg_http_api_downLoad(mUpnpHttpRequest *httpReq, char *ipaddr, int port, bool isSecure, Http_info *http_info1);
 
+/* Download url of http_info1 into file path with Range requests. Up to
+   CG_HTTP_DOWNLOAD_SEGMENT_MAX segments are fetched in parallel. Progress
+   is checkpointed in "<path>.dl", and calling it again after failure or
+   power off resumes from the checkpoint. */
+bool Http_downloadFile(Http_info *http_info1, const char *path, unsigned segments);
+
 #ifdef __cplusplus
 }
 #endif
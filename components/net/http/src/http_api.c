@@ -34,6 +34,7 @@
 //#include "at_utils.h"
 #include "vfs.h"
 #include "osi_log.h"
+#include "osi_api.h"
 bool gContentTypeFlag = false;
 bool gApiKeyFlag = false;
 char *vnetregdata = NULL;
@@ -432,6 +433,8 @@ bool RDHttpTerm(Http_info *Http_inf)
 
     mupnp_http_request_delete((Http_inf->cg_http_api)->g_httpReq);
 
+    cg_http_api_pool_flush();
+
     if (Http_inf->body_content != NULL)
     {
         free(Http_inf->body_content);
@@ -788,6 +791,8 @@ bool Term_Http(nHttp_info *nHttp_inf)
 
     mupnp_http_request_delete((nHttp_inf->cg_http_api)->g_httpReq);
 
+    cg_http_api_pool_flush();
+
     if (nHttp_inf->url != NULL)
     {
         free(nHttp_inf->url);
@@ -3173,30 +3178,153 @@ mUpnpHttpResponse *Http_get(Http_info *http_info1)
         return NULL;
     }
 }
-mUpnpHttpResponse *cg_http_api_response(mUpnpHttpRequest *httpReq, char *ipaddr, int port, bool isSecure)
+/****************************************
+* Persistent connection pool
+*
+* Idle keep-alive connections are kept per host:port:scheme, so that
+* consecutive requests to the same server (AT+HTTP* sessions, FOTA
+* range requests) skip DNS, TCP and TLS handshakes.
+****************************************/
+#define CG_HTTP_POOL_SIZE 4
+#define CG_HTTP_POOL_IDLE_TIMEOUT (30 * 1000)
+#define CG_HTTP_POOL_HOST_LEN 128
+
+typedef struct
 {
+    mUpnpSocket *sock; ///< NULL for empty entry
+    char host[CG_HTTP_POOL_HOST_LEN];
+    int port;
+    bool isSecure;
+    int64_t idle_since; ///< osiUpTime when returned to pool
+} cgHttpPoolConn_t;
 
-    char *method, *uri, *version;
-    //char *api_key;
-    mUpnpString *firstLine;
-    mUpnpSocket *g_sock = NULL;
-    mUpnpHttpResponse *response = NULL;
-    bool is_read = false;
+static cgHttpPoolConn_t gHttpPool[CG_HTTP_POOL_SIZE];
+static osiMutex_t *gHttpPoolLock = NULL;
 
-    OSI_LOGI(0x10007610, "Entering cg_http_api_response...\n");
+static void cg_http_pool_lock(void)
+{
+    if (gHttpPoolLock == NULL)
+    {
+        osiMutex_t *lock = osiMutexCreate();
+        uint32_t critical = osiEnterCritical();
+        if (gHttpPoolLock == NULL)
+        {
+            gHttpPoolLock = lock;
+            lock = NULL;
+        }
+        osiExitCritical(critical);
+        if (lock != NULL)
+            osiMutexDelete(lock);
+    }
+    osiMutexLock(gHttpPoolLock);
+}
 
-    if (ipaddr == NULL)
+static void cg_http_pool_unlock(void)
+{
+    osiMutexUnlock(gHttpPoolLock);
+}
+
+static void cg_http_pool_close(mUpnpSocket *sock)
+{
+    if (sock == NULL)
+        return;
+    mupnp_socket_close(sock);
+    mupnp_socket_delete(sock);
+}
+
+/**
+ * Take an idle connection to host:port out of the pool. Expired
+ * connections found on the way are closed.
+ */
+static mUpnpSocket *cg_http_pool_get(const char *host, int port, bool isSecure)
+{
+    mUpnpSocket *expired[CG_HTTP_POOL_SIZE];
+    mUpnpSocket *sock = NULL;
+    int nexpired = 0;
+
+    int64_t now = osiUpTime();
+    cg_http_pool_lock();
+    for (int n = 0; n < CG_HTTP_POOL_SIZE; n++)
     {
-        OSI_LOGI(0x100075fe, "ipaddr is NULL");
-        return NULL;
+        cgHttpPoolConn_t *c = &gHttpPool[n];
+        if (c->sock == NULL)
+            continue;
+
+        if (now - c->idle_since > CG_HTTP_POOL_IDLE_TIMEOUT)
+        {
+            expired[nexpired++] = c->sock;
+            c->sock = NULL;
+        }
+        else if (sock == NULL && c->port == port && c->isSecure == isSecure &&
+                 strcmp(c->host, host) == 0)
+        {
+            sock = c->sock;
+            c->sock = NULL;
+        }
     }
-    mupnp_http_response_clear(httpReq->httpRes);
+    cg_http_pool_unlock();
 
-    mupnp_string_setnvalue((httpReq->httpRes)->content, '\0', 0);
+    for (int n = 0; n < nexpired; n++)
+        cg_http_pool_close(expired[n]);
+    return sock;
+}
 
-    OSI_LOGI(0x10007611, "(HTTP) Posting:\n");
+/**
+ * Return an idle connection to the pool. When the pool is full, the
+ * connection idle for the longest time is closed.
+ */
+static void cg_http_pool_put(mUpnpSocket *sock, const char *host, int port, bool isSecure)
+{
+    if (strlen(host) >= CG_HTTP_POOL_HOST_LEN)
+    {
+        cg_http_pool_close(sock);
+        return;
+    }
 
-    mupnp_http_request_print(httpReq);
+    cg_http_pool_lock();
+    cgHttpPoolConn_t *victim = &gHttpPool[0];
+    for (int n = 0; n < CG_HTTP_POOL_SIZE; n++)
+    {
+        cgHttpPoolConn_t *c = &gHttpPool[n];
+        if (c->sock == NULL)
+        {
+            victim = c;
+            break;
+        }
+        if (c->idle_since < victim->idle_since)
+            victim = c;
+    }
+
+    mUpnpSocket *evicted = victim->sock;
+    victim->sock = sock;
+    strcpy(victim->host, host);
+    victim->port = port;
+    victim->isSecure = isSecure;
+    victim->idle_since = osiUpTime();
+    cg_http_pool_unlock();
+
+    cg_http_pool_close(evicted);
+}
+
+void cg_http_api_pool_flush(void)
+{
+    mUpnpSocket *socks[CG_HTTP_POOL_SIZE];
+
+    cg_http_pool_lock();
+    for (int n = 0; n < CG_HTTP_POOL_SIZE; n++)
+    {
+        socks[n] = gHttpPool[n].sock;
+        gHttpPool[n].sock = NULL;
+    }
+    cg_http_pool_unlock();
+
+    for (int n = 0; n < CG_HTTP_POOL_SIZE; n++)
+        cg_http_pool_close(socks[n]);
+}
+
+mUpnpSocket *cg_http_api_connect(char *ipaddr, int port, bool isSecure)
+{
+    mUpnpSocket *g_sock = NULL;
 
 #if defined(MUPNP_USE_OPENSSL)
     if (isSecure == false)
@@ -3226,50 +3354,182 @@ mUpnpHttpResponse *cg_http_api_response(mUpnpHttpRequest *httpReq, char *ipaddr,
         }
         return NULL;
     }
+    return g_sock;
+}
 
-    mupnp_socket_settimeout(g_sock, mupnp_http_request_gettimeout(httpReq));
+/**
+ * Fill in the headers common to all requests. Connection is asked to be
+ * kept alive, unless the caller set the header explicitly.
+ */
+bool cg_http_api_prepare(mUpnpHttpRequest *httpReq, char *ipaddr, int port)
+{
     mupnp_http_request_sethost(httpReq, ipaddr, port);
     /* add headers here */
     mupnp_http_packet_setheadervalue((mUpnpHttpPacket *)httpReq, CG_HTTP_USERAGENT, mupnp_http_request_getuseragent(httpReq));
-    /* prepare to send firstline */
-    method = mupnp_http_request_getmethod(httpReq);
-    uri = mupnp_http_request_geturi(httpReq);
-    version = mupnp_http_request_getversion(httpReq);
-    //api_key = (char *)mupnp_http_request_getapikey(httpReq);
+    if (mupnp_http_request_getconnection(httpReq) == NULL)
+        mupnp_http_packet_setheadervalue((mUpnpHttpPacket *)httpReq, CG_HTTP_CONNECTION, CG_HTTP_KEEP_ALIVE);
 
-    if (method == NULL || uri == NULL || version == NULL)
+    if (mupnp_http_request_getmethod(httpReq) == NULL ||
+        mupnp_http_request_geturi(httpReq) == NULL ||
+        mupnp_http_request_getversion(httpReq) == NULL)
     {
-        //cg_socket_close(sock);
-        mupnp_socket_delete(g_sock);
-        g_sock = NULL;
         Http_WriteUart("failure, parm error!\n", 22);
-        return NULL;
+        return false;
     }
-    OSI_LOGXI(OSI_LOGPAR_SS, 0x10007612, "uri method get %s %s", uri, method);
+    return true;
+}
+
+bool cg_http_api_send(mUpnpHttpRequest *httpReq, mUpnpSocket *g_sock)
+{
+    mUpnpString *firstLine;
+    size_t sent;
+
+    OSI_LOGXI(OSI_LOGPAR_SS, 0x10007612, "uri method get %s %s", mupnp_http_request_geturi(httpReq), mupnp_http_request_getmethod(httpReq));
     /**** send first line ****/
     firstLine = mupnp_string_new();
-    mupnp_string_addvalue(firstLine, method);
+    mupnp_string_addvalue(firstLine, mupnp_http_request_getmethod(httpReq));
     mupnp_string_addvalue(firstLine, CG_HTTP_SP);
-    mupnp_string_addvalue(firstLine, uri);
+    mupnp_string_addvalue(firstLine, mupnp_http_request_geturi(httpReq));
     mupnp_string_addvalue(firstLine, CG_HTTP_SP);
-    mupnp_string_addvalue(firstLine, version);
+    mupnp_string_addvalue(firstLine, mupnp_http_request_getversion(httpReq));
     mupnp_string_addvalue(firstLine, CG_HTTP_CRLF);
-    mupnp_socket_write(g_sock, mupnp_string_getvalue(firstLine), mupnp_string_length(firstLine));
+    sent = mupnp_socket_write(g_sock, mupnp_string_getvalue(firstLine), mupnp_string_length(firstLine));
     mupnp_string_delete(firstLine);
+    if (sent == 0)
+        return false;
+
     /**** send header and content ****/
     mupnp_http_packet_post((mUpnpHttpPacket *)httpReq, g_sock);
+    return true;
+}
 
-    is_read = mupnp_http_response_read(httpReq->httpRes, g_sock, mupnp_http_request_isheadrequest(httpReq));
-    if (is_read == true)
-        response = httpReq->httpRes;
+/**
+ * Whether the connection can carry another request after this response.
+ * The server must agree to keep it alive, and the body must be delimited
+ * by Content-Length or chunked encoding rather than connection close.
+ */
+static bool cg_http_api_isreusable(mUpnpHttpRequest *httpReq, mUpnpHttpResponse *httpRes)
+{
+    const char *version = mupnp_http_response_getversion(httpRes);
+    const char *connection = mupnp_http_response_getconnection(httpRes);
 
-    mupnp_socket_close(g_sock);
-    mupnp_socket_delete(g_sock);
-    g_sock = NULL;
+    if (mupnp_strcaseeq(version, CG_HTTP_VER11))
+    {
+        if (mupnp_strcaseeq(connection, CG_HTTP_CLOSE))
+            return false;
+    }
+    else if (!mupnp_strcaseeq(connection, CG_HTTP_KEEP_ALIVE))
+    {
+        return false;
+    }
+
+    if (mupnp_http_request_isheadrequest(httpReq))
+        return true;
+    return mupnp_http_packet_getheadervalue((mUpnpHttpPacket *)httpRes, CG_HTTP_CONTENT_LENGTH) != NULL ||
+           mupnp_http_packet_ischunked((mUpnpHttpPacket *)httpRes);
+}
+
+/**
+ * Send the requests on one connection without waiting for responses,
+ * and read the responses in order. A pooled connection is preferred,
+ * and when it turns out dropped by server before any response, the
+ * requests are sent again on a new connection.
+ *
+ * Return the number of responses read, stored in httpRes of each request.
+ */
+static int cg_http_api_exchange(mUpnpHttpRequest **httpReqs, int count, char *ipaddr, int port, bool isSecure)
+{
+    mUpnpSocket *g_sock;
+    bool reused = true;
+    int nread = 0;
+
+    g_sock = cg_http_pool_get(ipaddr, port, isSecure);
+    for (;;)
+    {
+        if (g_sock == NULL)
+        {
+            reused = false;
+            g_sock = cg_http_api_connect(ipaddr, port, isSecure);
+            if (g_sock == NULL)
+                return 0;
+        }
+
+        mupnp_socket_settimeout(g_sock, mupnp_http_request_gettimeout(httpReqs[0]));
+
+        int nsent = 0;
+        while (nsent < count && cg_http_api_send(httpReqs[nsent], g_sock))
+            nsent++;
+
+        nread = 0;
+        while (nread < nsent)
+        {
+            mUpnpHttpRequest *httpReq = httpReqs[nread];
+            if (!mupnp_http_response_read(httpReq->httpRes, g_sock, mupnp_http_request_isheadrequest(httpReq)))
+                break;
+            nread++;
+            if (!cg_http_api_isreusable(httpReq, httpReq->httpRes))
+                break;
+        }
+
+        if (nread > 0 || !reused)
+            break;
+
+        OSI_LOGI(0, "cg_http_api pooled connection dropped, reconnect");
+        cg_http_pool_close(g_sock);
+        g_sock = NULL;
+    }
+
+    if (nread == count && cg_http_api_isreusable(httpReqs[count - 1], httpReqs[count - 1]->httpRes))
+        cg_http_pool_put(g_sock, ipaddr, port, isSecure);
+    else
+        cg_http_pool_close(g_sock);
+    return nread;
+}
+
+mUpnpHttpResponse *cg_http_api_response(mUpnpHttpRequest *httpReq, char *ipaddr, int port, bool isSecure)
+{
+    bool is_read = false;
+
+    OSI_LOGI(0x10007610, "Entering cg_http_api_response...\n");
+
+    if (ipaddr == NULL)
+    {
+        OSI_LOGI(0x100075fe, "ipaddr is NULL");
+        return NULL;
+    }
+    mupnp_http_response_clear(httpReq->httpRes);
+
+    mupnp_string_setnvalue((httpReq->httpRes)->content, '\0', 0);
+
+    OSI_LOGI(0x10007611, "(HTTP) Posting:\n");
+
+    mupnp_http_request_print(httpReq);
+
+    if (!cg_http_api_prepare(httpReq, ipaddr, port))
+        return NULL;
+
+    is_read = (cg_http_api_exchange(&httpReq, 1, ipaddr, port, isSecure) == 1);
 
     OSI_LOGI(0x10007613, "cg_http_api_response read status is %d: Done\n", is_read);
 
-    return response;
+    return is_read ? httpReq->httpRes : NULL;
+}
+
+int cg_http_api_pipeline(mUpnpHttpRequest **httpReqs, int count, char *ipaddr, int port, bool isSecure)
+{
+    if (httpReqs == NULL || count <= 0 || ipaddr == NULL)
+        return 0;
+
+    for (int n = 0; n < count; n++)
+    {
+        mupnp_http_response_clear(httpReqs[n]->httpRes);
+        if (!cg_http_api_prepare(httpReqs[n], ipaddr, port))
+            return 0;
+    }
+
+    int nread = cg_http_api_exchange(httpReqs, count, ipaddr, port, isSecure);
+    OSI_LOGI(0, "cg_http_api_pipeline %d requests, %d responses", count, nread);
+    return nread;
 }
 
 #if defined(MUPNP_USE_OPENSSL)
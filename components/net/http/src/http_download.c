@@ -26,6 +26,10 @@
 #include "http_download.h"
 //#include "at_cmd_http.h"
 #include "string.h"
+#include "vfs.h"
+#include "vfs_aio.h"
+#include "osi_api.h"
+#include <stdio.h>
 
 bool Http_downLoad(Http_info *http_info1)
 {
@@ -192,3 +196,344 @@ bool cg_http_api_downLoad(mUpnpHttpRequest *httpReq, char *ipaddr, int port, boo
     mupnp_log_info("cg_http_api_downLoad: Done\n");
     return true;
 }
+
+/****************************************
+* Resumable download
+****************************************/
+#define CG_HTTP_DOWNLOAD_MAGIC 0x31444c48 // "HDL1"
+#define CG_HTTP_DOWNLOAD_ETAG_LEN 64
+#define CG_HTTP_DOWNLOAD_MIN_SEGMENT (256 * 1024)
+#define CG_HTTP_DOWNLOAD_CHECKPOINT (64 * 1024)
+#define CG_HTTP_DOWNLOAD_RETRY 5
+#define CG_HTTP_DOWNLOAD_READ_SIZE 1024
+#define CG_HTTP_DOWNLOAD_STREAM_SIZE 4096
+#define CG_HTTP_DOWNLOAD_STACK_SIZE (8 * 1024)
+#define CG_HTTP_ACCEPT_RANGES "Accept-Ranges"
+#define CG_HTTP_ETAG "ETag"
+#define CG_HTTP_IF_RANGE "If-Range"
+#define CG_HTTP_RANGE "Range"
+
+typedef struct
+{
+    uint32_t start; ///< first byte of segment
+    uint32_t end;   ///< one past last byte of segment
+    uint32_t done;  ///< bytes from start already in file
+} cgHttpDownloadSegment_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t total;
+    uint32_t count;
+    char etag[CG_HTTP_DOWNLOAD_ETAG_LEN];
+    cgHttpDownloadSegment_t seg[CG_HTTP_DOWNLOAD_SEGMENT_MAX];
+} cgHttpDownloadCheckpoint_t;
+
+typedef struct
+{
+    CgHttpApi *api;
+    const char *path;
+    char ckpt_path[VFS_PATH_MAX + 4];
+    bool resumable;
+    osiMutex_t *lock;
+    osiSemaphore_t *finished;
+    cgHttpDownloadCheckpoint_t ckpt;
+} cgHttpDownload_t;
+
+typedef struct
+{
+    cgHttpDownload_t *dl;
+    unsigned idx;
+} cgHttpDownloadWorker_t;
+
+static void cg_http_download_checkpoint(cgHttpDownload_t *dl, unsigned idx, uint32_t done)
+{
+    osiMutexLock(dl->lock);
+    dl->ckpt.seg[idx].done = done;
+    if (dl->resumable)
+        vfs_sfile_write_behind(dl->ckpt_path, &dl->ckpt, sizeof(dl->ckpt));
+    osiMutexUnlock(dl->lock);
+}
+
+/**
+ * Download the remaining of one segment with a Range request, on its own
+ * connection and file descriptor. Data are written through asynchronous
+ * streaming writer, and progress is checkpointed after data are flushed.
+ * Broken connections are retried from the last byte received.
+ */
+static bool cg_http_download_segment(cgHttpDownload_t *dl, unsigned idx)
+{
+    CgHttpApi *api = dl->api;
+    cgHttpDownloadSegment_t seg = dl->ckpt.seg[idx];
+    uint32_t checkpointed = seg.done;
+    int retry = 0;
+    char range[48];
+    char *buf = NULL;
+    vfs_aio_stream_t *stream = NULL;
+
+    if (seg.done >= seg.end - seg.start)
+        return true;
+
+    int fd = vfs_open(dl->path, O_RDWR);
+    if (fd < 0 || vfs_lseek(fd, seg.start + seg.done, SEEK_SET) < 0)
+        goto fail;
+
+    buf = (char *)malloc(CG_HTTP_DOWNLOAD_READ_SIZE);
+    stream = vfs_aio_stream_create(fd, CG_HTTP_DOWNLOAD_STREAM_SIZE);
+    if (buf == NULL || stream == NULL)
+        goto fail;
+
+    while (seg.done < seg.end - seg.start && retry < CG_HTTP_DOWNLOAD_RETRY)
+    {
+        mUpnpHttpRequest *httpReq = mupnp_http_request_new();
+        mUpnpSocket *g_sock = NULL;
+        uint32_t progress = seg.done;
+
+        if (httpReq == NULL)
+            break;
+
+        mupnp_http_request_setmethod(httpReq, CG_HTTP_GET);
+        mupnp_http_request_seturi(httpReq, api->uri_path);
+        mupnp_http_request_setuseragent(httpReq, mupnp_http_request_getuseragent(api->g_httpReq));
+        mupnp_http_request_settimeout(httpReq, mupnp_http_request_gettimeout(api->g_httpReq));
+        mupnp_http_request_setcontentlength(httpReq, 0);
+        if (dl->resumable)
+        {
+            snprintf(range, sizeof(range), "bytes=%u-%u", (unsigned)(seg.start + seg.done), (unsigned)(seg.end - 1));
+            mupnp_http_packet_setheadervalue((mUpnpHttpPacket *)httpReq, CG_HTTP_RANGE, range);
+            if (dl->ckpt.etag[0] != '\0')
+                mupnp_http_packet_setheadervalue((mUpnpHttpPacket *)httpReq, CG_HTTP_IF_RANGE, dl->ckpt.etag);
+        }
+        mupnp_http_packet_setheadervalue((mUpnpHttpPacket *)httpReq, CG_HTTP_CONNECTION, CG_HTTP_CLOSE);
+
+        if (cg_http_api_prepare(httpReq, api->host, api->port))
+            g_sock = cg_http_api_connect(api->host, api->port, api->is_https);
+
+        if (g_sock != NULL &&
+            cg_http_api_send(httpReq, g_sock) &&
+            mupnp_http_response_read(httpReq->httpRes, g_sock, true))
+        {
+            int status = mupnp_http_response_getstatuscode(httpReq->httpRes);
+            bool accepted = (status == CG_HTTP_STATUS_PARTIAL_CONTENT);
+
+            /* The whole body is acceptable only when nothing is received,
+               and it is the only segment */
+            if (status == CG_HTTP_STATUS_OK && seg.start + seg.done == 0 && dl->ckpt.count == 1)
+                accepted = true;
+
+            if (!accepted)
+            {
+                mupnp_log_info("http download segment %d unexpected status %d\n", idx, status);
+                retry = CG_HTTP_DOWNLOAD_RETRY;
+            }
+
+            while (accepted && seg.done < seg.end - seg.start)
+            {
+                uint32_t remain = seg.end - seg.start - seg.done;
+                ssize_t rlen = mupnp_socket_read(g_sock, buf, OSI_MIN(uint32_t, remain, CG_HTTP_DOWNLOAD_READ_SIZE));
+                if (rlen <= 0)
+                    break;
+
+                if (vfs_aio_stream_write(stream, buf, rlen) != rlen)
+                {
+                    retry = CG_HTTP_DOWNLOAD_RETRY;
+                    break;
+                }
+
+                seg.done += rlen;
+                if (seg.done - checkpointed >= CG_HTTP_DOWNLOAD_CHECKPOINT)
+                {
+                    if (vfs_aio_stream_flush(stream) < 0)
+                    {
+                        retry = CG_HTTP_DOWNLOAD_RETRY;
+                        break;
+                    }
+                    checkpointed = seg.done;
+                    cg_http_download_checkpoint(dl, idx, checkpointed);
+                }
+            }
+        }
+
+        if (g_sock != NULL)
+        {
+            mupnp_socket_close(g_sock);
+            mupnp_socket_delete(g_sock);
+        }
+        mupnp_http_request_delete(httpReq);
+
+        if (seg.done >= seg.end - seg.start)
+            break;
+
+        /* The retry budget is for connections making no progress */
+        retry = (seg.done > progress) ? 0 : retry + 1;
+        if (!dl->resumable)
+            break;
+
+        mupnp_log_info("http download segment %d broken at %u, retry %d\n", idx, seg.start + seg.done, retry);
+        osiThreadSleep(AT_HTTP_DOWNLOAD_DELAY);
+    }
+
+fail:
+    if (stream != NULL && vfs_aio_stream_delete(stream) == 0)
+        checkpointed = seg.done;
+    if (fd >= 0)
+        vfs_close(fd);
+    free(buf);
+
+    cg_http_download_checkpoint(dl, idx, checkpointed);
+    return checkpointed >= seg.end - seg.start;
+}
+
+static void cg_http_download_thread(void *param)
+{
+    cgHttpDownloadWorker_t *w = (cgHttpDownloadWorker_t *)param;
+    cg_http_download_segment(w->dl, w->idx);
+    osiSemaphoreRelease(w->dl->finished);
+    osiThreadExit();
+}
+
+/**
+ * Find the size, range support and validator of the resource by HEAD.
+ */
+static bool cg_http_download_probe(cgHttpDownload_t *dl, cgHttpDownloadCheckpoint_t *probe)
+{
+    CgHttpApi *api = dl->api;
+    mUpnpHttpResponse *httpRes;
+    const char *value;
+
+    mupnp_http_request_setmethod(api->g_httpReq, CG_HTTP_HEAD);
+    mupnp_http_request_seturi(api->g_httpReq, api->uri_path);
+    mupnp_http_request_setcontentlength(api->g_httpReq, 0);
+
+    httpRes = cg_http_api_response(api->g_httpReq, api->host, api->port, api->is_https);
+    if (httpRes == NULL || !mupnp_http_response_issuccessful(httpRes))
+        return false;
+
+    if (mupnp_http_packet_getheadervalue((mUpnpHttpPacket *)httpRes, CG_HTTP_CONTENT_LENGTH) == NULL)
+    {
+        mupnp_log_info("http download without content length is not supported\n");
+        return false;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+    probe->magic = CG_HTTP_DOWNLOAD_MAGIC;
+    probe->total = mupnp_http_packet_getcontentlength((mUpnpHttpPacket *)httpRes);
+
+    /* Weak validator can't be used in If-Range */
+    value = mupnp_http_packet_getheadervalue((mUpnpHttpPacket *)httpRes, CG_HTTP_ETAG);
+    if (value != NULL && strncmp(value, "W/", 2) != 0 && strlen(value) < CG_HTTP_DOWNLOAD_ETAG_LEN)
+        strcpy(probe->etag, value);
+
+    value = mupnp_http_packet_getheadervalue((mUpnpHttpPacket *)httpRes, CG_HTTP_ACCEPT_RANGES);
+    dl->resumable = mupnp_strcaseeq(value, "bytes");
+    return true;
+}
+
+bool Http_downloadFile(Http_info *http_info1, const char *path, unsigned segments)
+{
+    cgHttpDownload_t dl = {};
+    cgHttpDownloadCheckpoint_t probe;
+    cgHttpDownloadWorker_t workers[CG_HTTP_DOWNLOAD_SEGMENT_MAX];
+    unsigned started = 0;
+    bool ok = true;
+
+    if (http_info1 == NULL || path == NULL || strlen(path) >= VFS_PATH_MAX)
+        return false;
+
+    dl.api = http_info1->cg_http_api;
+    dl.path = path;
+    snprintf(dl.ckpt_path, sizeof(dl.ckpt_path), "%s.dl", path);
+
+    if (Http_init(dl.api, http_info1->url) == false)
+    {
+        mupnp_log_info("cg_http_init error ...\n");
+        return false;
+    }
+
+    if (!cg_http_download_probe(&dl, &probe))
+        return false;
+    http_info1->contentLen = probe.total;
+
+    /* Resume only when the checkpoint matches the resource on server */
+    if (dl.resumable &&
+        vfs_sfile_read(dl.ckpt_path, &dl.ckpt, sizeof(dl.ckpt)) == sizeof(dl.ckpt) &&
+        dl.ckpt.magic == CG_HTTP_DOWNLOAD_MAGIC &&
+        dl.ckpt.total == probe.total &&
+        strcmp(dl.ckpt.etag, probe.etag) == 0 &&
+        dl.ckpt.count >= 1 && dl.ckpt.count <= CG_HTTP_DOWNLOAD_SEGMENT_MAX &&
+        vfs_file_size(path) == probe.total)
+    {
+        mupnp_log_info("http download resume %s\n", path);
+    }
+    else
+    {
+        int fd = vfs_open(path, O_CREAT | O_RDWR | O_TRUNC, 0);
+        if (fd < 0)
+            return false;
+
+        if (segments < 1 || !dl.resumable)
+            segments = 1;
+        if (segments > CG_HTTP_DOWNLOAD_SEGMENT_MAX)
+            segments = CG_HTTP_DOWNLOAD_SEGMENT_MAX;
+        if (segments > probe.total / CG_HTTP_DOWNLOAD_MIN_SEGMENT)
+            segments = OSI_MAX(unsigned, 1, probe.total / CG_HTTP_DOWNLOAD_MIN_SEGMENT);
+
+        /* Segments are written at their offsets, so the file is extended
+           to the final size in advance */
+        if (segments > 1 && vfs_ftruncate(fd, probe.total) < 0)
+            segments = 1;
+        vfs_close(fd);
+
+        dl.ckpt = probe;
+        dl.ckpt.count = segments;
+        for (unsigned n = 0; n < segments; n++)
+        {
+            dl.ckpt.seg[n].start = probe.total / segments * n;
+            dl.ckpt.seg[n].end = (n == segments - 1) ? probe.total : probe.total / segments * (n + 1);
+        }
+        if (dl.resumable)
+            vfs_sfile_write(dl.ckpt_path, &dl.ckpt, sizeof(dl.ckpt));
+    }
+
+    dl.lock = osiMutexCreate();
+    dl.finished = osiSemaphoreCreate(CG_HTTP_DOWNLOAD_SEGMENT_MAX, 0);
+    if (dl.lock == NULL || dl.finished == NULL)
+    {
+        ok = false;
+        goto done;
+    }
+
+    for (unsigned n = 1; n < dl.ckpt.count; n++)
+    {
+        workers[n].dl = &dl;
+        workers[n].idx = n;
+        if (osiThreadCreate("httpdl", cg_http_download_thread, &workers[n], OSI_PRIORITY_NORMAL,
+                            CG_HTTP_DOWNLOAD_STACK_SIZE, 4) != NULL)
+            started++;
+        else
+            ok = false;
+    }
+
+    if (!cg_http_download_segment(&dl, 0))
+        ok = false;
+
+    for (unsigned n = 0; n < started; n++)
+        osiSemaphoreAcquire(dl.finished);
+
+    for (unsigned n = 0; n < dl.ckpt.count; n++)
+    {
+        if (dl.ckpt.seg[n].done < dl.ckpt.seg[n].end - dl.ckpt.seg[n].start)
+            ok = false;
+    }
+
+done:
+    if (ok)
+    {
+        vfs_sfile_flush(dl.ckpt_path);
+        vfs_unlink(dl.ckpt_path);
+    }
+    osiSemaphoreDelete(dl.finished);
+    osiMutexDelete(dl.lock);
+    mupnp_log_info("http download %s %s\n", path, ok ? "done" : "incomplete");
+    return ok;
+}
@@ -2,6 +2,7 @@
 #include <https_api.h>
 #include "http_api.h"
 #include "mbedtls/timing.h"
+#include "mbedtls/ssl_client_cache.h"
 #include "osi_log.h"
 
 #if defined(MUPNP_USE_OPENSSL)
@@ -206,6 +207,9 @@ int mupnp_mbedtlssocket_connect(mUpnpSocket *sock, const char *addr, int port)
 
     mbedtls_ssl_set_bio(sock->ssl, &sock->server_fd, mbedtls_net_send, mbedtls_net_recv, mbedtls_net_recv_timeout);
 
+    /* resume the last session to this server when cached */
+    bool resumed = (mbedtls_ssl_client_cache_load(sock->ssl, addr, port) == 0);
+
     /* 
         * 4. Handshake 
         */
@@ -216,11 +220,14 @@ int mupnp_mbedtlssocket_connect(mUpnpSocket *sock, const char *addr, int port)
         if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
         {
             OSI_LOGI(0x100075df, " failed ! mbedtls_ssl_handshake returned %x\n\n", ret);
+            if (resumed)
+                mbedtls_ssl_client_cache_remove(sock->ssl, addr, port);
             return ret;
         }
     }
 
     OSI_LOGI(0x100075e0, " ok\n");
+    mbedtls_ssl_client_cache_save(sock->ssl, addr, port);
 
     /* 
         * 5. Verify the server certificate 
@@ -10,6 +10,8 @@ err_t lwip_mqtt_connect(mqtt_client_t *client, const ip_addr_t *ip_addr, u16_t p
                         const struct mqtt_connect_client_info_t *client_info);
 err_t lwip_mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t dup, u8_t qos, u8_t retain,
                         mqtt_request_cb_t cb, void *arg);
+err_t lwip_mqtt_publish_ref(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos, u8_t retain,
+                            mqtt_request_cb_t cb, void *arg);
 
 err_t lwip_mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos, mqtt_request_cb_t cb, void *arg, u8_t sub);
 
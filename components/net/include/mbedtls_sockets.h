@@ -70,6 +70,8 @@ typedef enum
     TLSSOCK_CFG_TYPE_HTTPS_CTXI,
     TLSSOCK_CFG_TYPE_SMTPS_TYPE,
     TLSSOCK_CFG_TYPE_SMTPS_CTXI,
+    TLSSOCK_CFG_TYPE_MAX_FRAG_LEN, // 512/1024/2048/4096, 0 to not negotiate
+    TLSSOCK_CFG_TYPE_BUF_LEN,      // in content length | (out content length << 16), 0 for maximum
 } TLSSOCK_CFG_TYPE_E;
 
 #define TLSSOCK_AUTH_MODE_NONE 0
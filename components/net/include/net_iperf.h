@@ -0,0 +1,167 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _NET_IPERF_H_
+#define _NET_IPERF_H_
+
+#include "lwip/ip_addr.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Network throughput benchmark
+ *
+ * Active tests are iperf2 compatible, and run on lwIP raw API in TCP/IP
+ * core lock:
+ * - TCP server, by lwiperf, for host "iperf -c <ip>"
+ * - TCP client, for host "iperf -s"
+ * - UDP server, for host "iperf -u -c <ip> -b <rate>"
+ * - UDP client, for host "iperf -u -s"
+ *
+ * Monitor mode doesn't generate traffic. The per path byte counters of
+ * all netifs are sampled in all modes, so the throughput of AT sockets,
+ * PPP dialup, RNDIS tethering and NAT forwarding can be measured in
+ * monitor mode with traffic generated by host.
+ *
+ * Each report carries the CPU load of the TCP/IP thread and the whole
+ * system (by thread CPU statistics), TCP retransmissions and lwIP heap
+ * usage (pbuf included) of the report window.
+ */
+
+#define NET_IPERF_PORT_DEFAULT (5001)
+#define NET_IPERF_LEN_DEFAULT (1460)
+#define NET_IPERF_LEN_MAX (1470)
+#define NET_IPERF_NETIF_MAX (6)
+
+/**
+ * benchmark mode
+ */
+typedef enum
+{
+    NET_IPERF_TCP_SERVER = 1, ///< TCP server by lwiperf
+    NET_IPERF_TCP_CLIENT,     ///< TCP client, send to iperf server
+    NET_IPERF_UDP_SERVER,     ///< UDP server, receive from iperf client
+    NET_IPERF_UDP_CLIENT,     ///< UDP client, send to iperf server
+    NET_IPERF_MONITOR,        ///< sample netif counters only
+} netIperfMode_t;
+
+/**
+ * data path of netif byte counters
+ */
+typedef enum
+{
+    NET_IPERF_PATH_LWIP,  ///< terminated in lwIP, including AT sockets
+    NET_IPERF_PATH_PPP,   ///< PPP dialup
+    NET_IPERF_PATH_RNDIS, ///< RNDIS/ECM tethering
+    NET_IPERF_PATH_COUNT,
+} netIperfPath_t;
+
+/**
+ * report event
+ */
+typedef enum
+{
+    NET_IPERF_EV_INTERVAL, ///< periodic report
+    NET_IPERF_EV_SESSION,  ///< one client session of server mode finished
+    NET_IPERF_EV_END,      ///< benchmark finished, the last report
+} netIperfEvent_t;
+
+/**
+ * benchmark configuration
+ */
+typedef struct
+{
+    netIperfMode_t mode;  ///< benchmark mode
+    ip_addr_t remote;     ///< server address of client modes
+    uint16_t port;        ///< server port, 0 for NET_IPERF_PORT_DEFAULT
+    uint16_t length;      ///< write or datagram size, 0 for NET_IPERF_LEN_DEFAULT
+    uint32_t duration_ms; ///< benchmark duration, 0 for until stopped (not for clients)
+    uint32_t interval_ms; ///< interval report period, 0 for no interval report
+    uint32_t rate_kbps;   ///< sending rate of UDP client
+} netIperfConfig_t;
+
+/**
+ * byte counters of one netif
+ */
+typedef struct
+{
+    char name[6];                        ///< netif name and number, such as "GP1"
+    uint32_t ul[NET_IPERF_PATH_COUNT];   ///< uplink bytes of each path
+    uint32_t dl[NET_IPERF_PATH_COUNT];   ///< downlink bytes of each path
+} netIperfNetifStat_t;
+
+/**
+ * benchmark report
+ *
+ * Interval reports cover the time from the previous interval report. The
+ * end report covers the whole benchmark. Session reports cover the time
+ * from the previous session or the start. In TCP server mode, the test
+ * bytes are only known at session end by lwiperf, and the netif counters
+ * in interval reports should be used instead.
+ */
+typedef struct
+{
+    netIperfEvent_t event; ///< report event
+    int error;             ///< 0 on success, otherwise lwIP err_t
+    uint32_t duration_ms;  ///< report window
+    uint64_t bytes;        ///< test payload bytes, acked bytes for TCP client
+    uint32_t kbps;         ///< test payload throughput
+    uint32_t datagrams;    ///< UDP datagrams
+    uint32_t lost;         ///< UDP lost datagrams
+    uint32_t outorder;     ///< UDP out of order datagrams
+    uint32_t jitter_us;    ///< UDP jitter, RFC 1889
+    uint32_t rexmit;       ///< TCP retransmissions of all connections
+    int net_cpu_permille;  ///< CPU load of TCP/IP thread, -1 if unavailable
+    int cpu_permille;      ///< CPU load of system, -1 if unavailable
+    uint32_t mem_used;     ///< lwIP heap in use, 0 if unavailable
+    uint32_t mem_peak;     ///< lwIP heap high water mark of the benchmark
+    unsigned netif_count;  ///< valid count of netif
+    netIperfNetifStat_t netif[NET_IPERF_NETIF_MAX];
+} netIperfReport_t;
+
+/**
+ * function type of benchmark report
+ *
+ * It is called with TCP/IP core locked, in TCP/IP or net thread. It
+ * should just forward the report to application thread.
+ */
+typedef void (*netIperfReportCb_t)(void *ctx, const netIperfReport_t *report);
+
+/**
+ * start network benchmark
+ *
+ * Only one benchmark can be run at any time. The peak of lwIP memory
+ * budget is reset at start.
+ *
+ * \param cfg       benchmark configuration
+ * \param cb        report callback
+ * \param ctx       report callback context
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, already started, out of memory,
+ *        or failed to bind or connect
+ */
+bool netIperfStart(const netIperfConfig_t *cfg, netIperfReportCb_t cb, void *ctx);
+
+/**
+ * stop network benchmark
+ *
+ * The end report is called inside when benchmark is running.
+ */
+void netIperfStop(void);
+
+/**
+ * whether network benchmark is running
+ */
+bool netIperfIsRunning(void);
+
+#endif
@@ -0,0 +1,156 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _NET_TIME_SYNC_H_
+#define _NET_TIME_SYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Time service
+ *
+ * Samples of UTC time come from NITZ, NTP and GNSS. Each sample carries
+ * its error bound, and the error of system time is estimated as the
+ * error of the last accepted sample, plus the drift error accumulated
+ * since then. A sample is accepted only when it is better than the
+ * estimation, and then system time is stepped to it.
+ *
+ * The drift of system time (the 32K clock, the same as RTC) is measured
+ * from the residual offset between accepted samples, and compensated in
+ * software by relaxed timer, and at \p netTimeSyncEpochTime. The drift
+ * is stored in RTC NV, so it is applied to the power off period at the
+ * next boot.
+ *
+ * NTP is only used when free sources (NITZ, GNSS) can't keep the target
+ * accuracy. Each NTP round queries all servers several times, and only
+ * the sample with minimal round trip is used. The next round is
+ * scheduled at the time the estimated error reaches the target accuracy,
+ * so after the drift is calibrated, the network wakeups for time sync
+ * are rare. The round timer is relaxed, to be merged with other wakeups.
+ */
+
+/** maximum NTP servers */
+#define NET_TIME_SYNC_SERVER_MAX (4)
+
+/** error of NITZ time, it is in second resolution */
+#define NET_TIME_SYNC_NITZ_ERROR (1000)
+
+/** error of GNSS time from NMEA sentence, including output latency */
+#define NET_TIME_SYNC_GNSS_ERROR (500)
+
+/**
+ * time source
+ */
+typedef enum
+{
+    NET_TIME_SOURCE_NONE, ///< not synchronized
+    NET_TIME_SOURCE_NITZ, ///< network identity and time zone
+    NET_TIME_SOURCE_NTP,  ///< NTP round of time service
+    NET_TIME_SOURCE_GNSS, ///< GNSS fix
+} netTimeSource_t;
+
+/**
+ * time service configuration
+ */
+typedef struct
+{
+    const char *servers[NET_TIME_SYNC_SERVER_MAX]; ///< NTP server names or addresses, NULL for unused
+    uint8_t samples;                               ///< NTP requests to each server in a round, 0 for 4
+    uint32_t accuracy_ms;                          ///< target accuracy, 0 for 500ms
+    uint32_t min_interval_s;                       ///< minimal NTP round interval, 0 for 15 minutes
+    uint32_t max_interval_s;                       ///< maximal NTP round interval, 0 for 7 days
+} netTimeSyncConfig_t;
+
+/**
+ * time service status
+ */
+typedef struct
+{
+    netTimeSource_t source;   ///< source of the last accepted sample
+    int64_t sync_uptime;      ///< uptime of the last accepted sample
+    int32_t offset_ms;        ///< step of system time at the last accepted sample
+    int32_t drift_ppb;        ///< compensated drift, positive for slow clock
+    uint32_t drift_error_ppb; ///< error of the drift
+    uint32_t error_ms;        ///< estimated error of system time, UINT32_MAX for unknown
+    uint32_t next_round_s;    ///< delay to the next NTP round
+    uint32_t rounds;          ///< NTP rounds
+    uint32_t failures;        ///< continuous failed NTP rounds
+    uint32_t rtt_ms;          ///< round trip of the sample of the last NTP round
+} netTimeSyncStatus_t;
+
+/**
+ * start time service
+ *
+ * Server strings are not copied, they should be kept valid. The first
+ * NTP round will be started soon.
+ *
+ * \param cfg       time service configuration
+ * \return
+ *      - true on success
+ *      - false on invalid parameter or out of memory
+ */
+bool netTimeSyncStart(const netTimeSyncConfig_t *cfg);
+
+/**
+ * stop time service
+ *
+ * The running NTP round is aborted. The drift compensation is stopped.
+ */
+void netTimeSyncStop(void);
+
+/**
+ * feed a time sample
+ *
+ * It can be called in any thread except ISR. The sample is dropped
+ * silently when it is not better than current estimation, otherwise
+ * system time and RTC are updated in work queue.
+ *
+ * \param source    time source
+ * \param epoch_ms  UTC epoch time of the sample in milliseconds
+ * \param uptime_ms uptime (\p osiUpTime) when the sample is taken
+ * \param error_ms  error bound of the sample
+ * \return
+ *      - true if the sample is handled by time service
+ *      - false if time service is not started, and caller should set
+ *        system time by itself
+ */
+bool netTimeSyncFeed(netTimeSource_t source, int64_t epoch_ms, int64_t uptime_ms, uint32_t error_ms);
+
+/**
+ * start an NTP round now
+ *
+ * \return
+ *      - true if the round is scheduled or already running
+ *      - false if time service is not started
+ */
+bool netTimeSyncRequest(void);
+
+/**
+ * epoch time with drift compensated
+ *
+ * The pending drift compensation is applied to system time, and then
+ * \p osiEpochTime is returned. It is the same as \p osiEpochTime when
+ * time service is not started.
+ *
+ * \return  epoch time in milliseconds
+ */
+int64_t netTimeSyncEpochTime(void);
+
+/**
+ * get time service status
+ *
+ * \param status    output status
+ */
+void netTimeSyncGetStatus(netTimeSyncStatus_t *status);
+
+#endif
@@ -2,6 +2,8 @@
 #define _NETUTILS_H_
 
 #include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "drv_ps_path.h"
 
 struct netif *getGprsNetIf(uint8_t nSim, uint8_t nCid);
 #if IP_NAT
@@ -14,4 +16,43 @@ bool getSimIccid(uint8_t simId, uint8_t *simiccid, uint8_t *len);
 bool getSimImei(uint8_t simId, uint8_t *imei, uint8_t *len);
 bool getSimImsi(uint8_t simId, uint8_t *imsi, uint8_t *len);
 
+/**
+ * read one downlink packet from PS interface into a new pbuf
+ *
+ * The packet is read into the contiguous pbuf payload directly, without
+ * intermediate buffer. When there are no data, or out of memory, it will
+ * return NULL and the remaining packets are kept in PS interface.
+ */
+struct pbuf *netPsIntfReadPbuf(drvPsIntf_t *intf);
+
+/**
+ * maximum packet count of \p netPsIntfReadPbufs in one call
+ */
+#define NET_PS_DL_BATCH (8)
+
+/**
+ * read several downlink packets from PS interface into new pbufs
+ *
+ * It is the same as calling \p netPsIntfReadPbuf repeatedly, until there
+ * are no data or \p count packets are read. It is called once for each
+ * wakeup, and then the packets can be fed into stack in one burst.
+ *
+ * \param intf     PS interface
+ * \param pbufs    array to hold the read pbufs
+ * \param count    array size
+ * \return the count of read packets
+ */
+unsigned netPsIntfReadPbufs(drvPsIntf_t *intf, struct pbuf **pbufs, unsigned count);
+
+/**
+ * write one uplink packet in pbuf to PS interface
+ *
+ * Single pbuf is written directly. PS interface only accepts contiguous
+ * packet, and pbuf chain is gathered into a shared buffer without
+ * dynamic memory allocation.
+ *
+ * \return the same as \p drvPsIntfWrite
+ */
+int netPsIntfWritePbuf(drvPsIntf_t *intf, const struct pbuf *p);
+
 #endif
@@ -120,6 +120,7 @@ typedef struct internal_hooks
     void *(*allocate)(size_t size);
     void (*deallocate)(void *pointer);
     void *(*reallocate)(void *pointer, size_t size);
+    struct arena_block *arena; /* when not NULL, parsed items are carved from the arena */
 } internal_hooks;
 
 #if defined(_MSC_VER)
@@ -142,7 +143,7 @@ static void *internal_realloc(void *pointer, size_t size)
 #define internal_realloc realloc
 #endif
 
-static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc };
+static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc, NULL };
 
 static unsigned char* cJSON_strdup(const unsigned char* string, const internal_hooks * const hooks)
 {
@@ -196,10 +197,98 @@ CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
     }
 }
 
+/* Memory block of cJSON_ParseArena. Following blocks are chained only when the first one is too small. */
+typedef struct arena_block
+{
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+} arena_block;
+
+#define arena_align(size) (((size) + (sizeof(double) - 1)) & ~(sizeof(double) - 1))
+#define ARENA_HEADER_SIZE arena_align(sizeof(arena_block))
+#define ARENA_MIN_BLOCK 256
+
+static arena_block *arena_block_new(size_t size)
+{
+    arena_block *block = (arena_block*)global_hooks.allocate(ARENA_HEADER_SIZE + size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+static void *arena_allocate(arena_block * const arena, size_t size)
+{
+    /* the newest block is always linked right after the first one */
+    arena_block *block = (arena->next != NULL) ? arena->next : arena;
+    unsigned char *pointer = NULL;
+
+    size = arena_align(size);
+    if ((block->size - block->used) < size)
+    {
+        size_t block_size = arena->size / 2;
+        if (block_size < ARENA_MIN_BLOCK)
+        {
+            block_size = ARENA_MIN_BLOCK;
+        }
+        if (block_size < size)
+        {
+            block_size = size;
+        }
+
+        block = arena_block_new(block_size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->next = arena->next;
+        arena->next = block;
+    }
+
+    pointer = (unsigned char*)block + ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+    return pointer;
+}
+
+static void arena_free(arena_block *arena)
+{
+    arena_block *next = NULL;
+    while (arena != NULL)
+    {
+        next = arena->next;
+        global_hooks.deallocate(arena);
+        arena = next;
+    }
+}
+
+static void *hooks_allocate(const internal_hooks * const hooks, size_t size)
+{
+    if (hooks->arena != NULL)
+    {
+        return arena_allocate(hooks->arena, size);
+    }
+    return hooks->allocate(size);
+}
+
+static void hooks_deallocate(const internal_hooks * const hooks, void *pointer)
+{
+    /* memory of an arena is only released with the whole arena */
+    if (hooks->arena == NULL)
+    {
+        hooks->deallocate(pointer);
+    }
+}
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
 {
-    cJSON* node = (cJSON*)hooks->allocate(sizeof(cJSON));
+    cJSON* node = (cJSON*)hooks_allocate(hooks, sizeof(cJSON));
     if (node)
     {
         memset(node, '\0', sizeof(cJSON));
@@ -734,7 +823,7 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
 
         /* This is at most how much we need for the output */
         allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
+        output = (unsigned char*)hooks_allocate(&input_buffer->hooks, allocation_length + sizeof(""));
         if (output == NULL)
         {
             goto fail; /* allocation failure */
@@ -812,7 +901,7 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
 fail:
     if (output != NULL)
     {
-        input_buffer->hooks.deallocate(output);
+        hooks_deallocate(&input_buffer->hooks, output);
     }
 
     if (input_pointer != NULL)
@@ -996,10 +1085,19 @@ static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
     return buffer;
 }
 
+/* Delete a partially parsed structure. Items of an arena are released with the arena. */
+static void parse_delete(cJSON *item, const internal_hooks * const hooks)
+{
+    if (hooks->arena == NULL)
+    {
+        cJSON_Delete(item);
+    }
+}
+
 /* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+static cJSON *parse_with_hooks(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated, const internal_hooks * const hooks)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0, 0 } };
     cJSON *item = NULL;
 
     /* reset error position */
@@ -1014,9 +1112,9 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
     buffer.content = (const unsigned char*)value;
     buffer.length = strlen((const char*)value) + sizeof("");
     buffer.offset = 0;
-    buffer.hooks = global_hooks;
+    buffer.hooks = *hooks;
 
-    item = cJSON_New_Item(&global_hooks);
+    item = cJSON_New_Item(hooks);
     if (item == NULL) /* memory fail */
     {
         goto fail;
@@ -1047,7 +1145,7 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
 fail:
     if (item != NULL)
     {
-        cJSON_Delete(item);
+        parse_delete(item, hooks);
     }
 
     if (value != NULL)
@@ -1076,6 +1174,55 @@ fail:
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    return parse_with_hooks(value, return_parse_end, require_null_terminated, &global_hooks);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseArena(const char *value, size_t size)
+{
+    internal_hooks hooks = global_hooks;
+    cJSON *item = NULL;
+
+    if (value == NULL)
+    {
+        return NULL;
+    }
+
+    if (size == 0)
+    {
+        /* items and strings of usual documents fit in four times of the text */
+        size = (strlen(value) * 4) + sizeof(cJSON);
+    }
+    if (size < arena_align(sizeof(cJSON)))
+    {
+        size = arena_align(sizeof(cJSON));
+    }
+
+    hooks.arena = arena_block_new(size);
+    if (hooks.arena == NULL)
+    {
+        return NULL;
+    }
+
+    /* the root item is the first allocation, right after the arena header */
+    item = parse_with_hooks(value, NULL, false, &hooks);
+    if (item == NULL)
+    {
+        arena_free(hooks.arena);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(void) cJSON_ArenaDelete(cJSON *item)
+{
+    if (item != NULL)
+    {
+        arena_free((arena_block*)(void*)((unsigned char*)item - ARENA_HEADER_SIZE));
+    }
+}
+
 /* Default options for cJSON_Parse */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
 {
@@ -1159,7 +1306,7 @@ CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
 
 CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, 0 } };
 
     if (prebuffer < 0)
     {
@@ -1189,7 +1336,7 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buf, const int len, const cJSON_bool fmt)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0, 0 } };
 
     if ((len < 0) || (buf == NULL))
     {
@@ -1427,7 +1574,7 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        parse_delete(head, &input_buffer->hooks);
     }
 
     return false;
@@ -1598,7 +1745,7 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        parse_delete(head, &input_buffer->hooks);
     }
 
     return false;
@@ -141,6 +141,10 @@ CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value);
 /* ParseWithOpts allows you to require (and check) that the JSON is null terminated, and to retrieve the pointer to the final byte parsed. */
 /* If you supply a ptr in return_parse_end and parsing fails, then return_parse_end will contain a pointer to the error so will match cJSON_GetErrorPtr(). */
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
+/* ParseArena builds the whole tree in one memory block of size bytes (0 to estimate from the text), more blocks are chained only when it is too small. */
+/* The tree is read only: don't add, detach or replace items, and release it with cJSON_ArenaDelete instead of cJSON_Delete. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseArena(const char *value, size_t size);
+CJSON_PUBLIC(void) cJSON_ArenaDelete(cJSON *item);
 
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
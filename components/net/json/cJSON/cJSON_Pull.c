@@ -0,0 +1,438 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "cJSON_Pull.h"
+
+/* define our own boolean type */
+#undef true
+#undef false
+#define true ((cJSON_bool)1)
+#define false ((cJSON_bool)0)
+
+#define pull_can_read(pull, size) (((pull)->offset + (size)) <= (pull)->length)
+#define pull_at(pull) ((pull)->json + (pull)->offset)
+
+static void pull_skip_whitespace(cJSON_Pull * const pull)
+{
+    while ((pull->offset < pull->length) && ((unsigned char)pull->json[pull->offset] <= 32))
+    {
+        pull->offset++;
+    }
+}
+
+static cJSON_PullToken pull_fail(cJSON_Pull * const pull)
+{
+    pull->token = cJSON_Pull_Error;
+    return cJSON_Pull_Error;
+}
+
+/* scan the string literal at offset, content is returned without quotes and escapes are kept */
+static cJSON_bool pull_scan_string(cJSON_Pull * const pull, const char **start, size_t *length)
+{
+    size_t end = pull->offset + 1;
+
+    while ((end < pull->length) && (pull->json[end] != '\"'))
+    {
+        if (pull->json[end] == '\\')
+        {
+            end++;
+        }
+        end++;
+    }
+    if (end >= pull->length)
+    {
+        return false;
+    }
+
+    *start = pull->json + pull->offset + 1;
+    *length = end - pull->offset - 1;
+    pull->offset = end + 1;
+    return true;
+}
+
+/* restore the path of the container at depth */
+static void pull_path_reset(cJSON_Pull * const pull, int depth)
+{
+    pull->path[pull->path_length[depth - 1]] = '\0';
+    if (pull->truncated_depth >= depth)
+    {
+        pull->truncated_depth = 0;
+    }
+}
+
+static void pull_path_append(cJSON_Pull * const pull, const char *segment, size_t length)
+{
+    size_t used = strlen(pull->path);
+
+    if ((used + 1 + length) >= CJSON_PULL_PATH_SIZE)
+    {
+        if (pull->truncated_depth == 0)
+        {
+            pull->truncated_depth = pull->depth;
+        }
+        return;
+    }
+
+    pull->path[used] = '/';
+    memcpy(pull->path + used + 1, segment, length);
+    pull->path[used + 1 + length] = '\0';
+}
+
+static cJSON_PullToken pull_value(cJSON_Pull * const pull)
+{
+    char c = '\0';
+
+    if (!pull_can_read(pull, 1))
+    {
+        return pull_fail(pull);
+    }
+
+    c = pull->json[pull->offset];
+    if ((c == '{') || (c == '['))
+    {
+        if (pull->depth >= CJSON_PULL_MAX_DEPTH)
+        {
+            return pull_fail(pull);
+        }
+        pull->container[pull->depth] = (unsigned char)c;
+        pull->count[pull->depth] = 0;
+        pull->path_length[pull->depth] = strlen(pull->path);
+        pull->depth++;
+        pull->offset++;
+        pull->token = (c == '{') ? cJSON_Pull_ObjectBegin : cJSON_Pull_ArrayBegin;
+        return pull->token;
+    }
+
+    if (c == '\"')
+    {
+        if (!pull_scan_string(pull, &pull->value, &pull->value_length))
+        {
+            return pull_fail(pull);
+        }
+        pull->token = cJSON_Pull_String;
+    }
+    else if (pull_can_read(pull, 4) && (strncmp(pull_at(pull), "true", 4) == 0))
+    {
+        pull->offset += 4;
+        pull->token = cJSON_Pull_True;
+    }
+    else if (pull_can_read(pull, 5) && (strncmp(pull_at(pull), "false", 5) == 0))
+    {
+        pull->offset += 5;
+        pull->token = cJSON_Pull_False;
+    }
+    else if (pull_can_read(pull, 4) && (strncmp(pull_at(pull), "null", 4) == 0))
+    {
+        pull->offset += 4;
+        pull->token = cJSON_Pull_Null;
+    }
+    else if ((c == '-') || ((c >= '0') && (c <= '9')))
+    {
+        pull->value = pull_at(pull);
+        while ((pull->offset < pull->length) && (strchr("0123456789+-eE.", pull->json[pull->offset]) != NULL))
+        {
+            pull->offset++;
+        }
+        pull->value_length = (size_t)(pull_at(pull) - pull->value);
+        pull->token = cJSON_Pull_Number;
+    }
+    else
+    {
+        return pull_fail(pull);
+    }
+
+    if (pull->depth == 0)
+    {
+        pull->done = true;
+    }
+    return pull->token;
+}
+
+CJSON_PUBLIC(void) cJSON_PullInit(cJSON_Pull * const pull, const char *json, size_t length)
+{
+    memset(pull, 0, sizeof(cJSON_Pull));
+    pull->json = json;
+    pull->length = (json != NULL) ? length : 0;
+    pull->token = cJSON_Pull_End;
+}
+
+CJSON_PUBLIC(cJSON_PullToken) cJSON_PullNext(cJSON_Pull * const pull)
+{
+    char index[12];
+    int level = 0;
+    char c = '\0';
+
+    if (pull->token == cJSON_Pull_Error)
+    {
+        return cJSON_Pull_Error;
+    }
+
+    pull->key = NULL;
+    pull->key_length = 0;
+    pull->value = NULL;
+    pull->value_length = 0;
+
+    pull_skip_whitespace(pull);
+    if (pull->depth == 0)
+    {
+        if (pull->done)
+        {
+            pull->token = cJSON_Pull_End;
+            return cJSON_Pull_End;
+        }
+        pull->path[0] = '\0';
+    }
+    else
+    {
+        level = pull->depth - 1;
+        pull_path_reset(pull, pull->depth);
+        if (!pull_can_read(pull, 1))
+        {
+            return pull_fail(pull);
+        }
+
+        c = pull->json[pull->offset];
+        if (c == ((pull->container[level] == '{') ? '}' : ']'))
+        {
+            pull->offset++;
+            pull->depth--;
+            if (pull->depth == 0)
+            {
+                pull->done = true;
+            }
+            pull->path_truncated = (pull->truncated_depth != 0);
+            pull->token = (c == '}') ? cJSON_Pull_ObjectEnd : cJSON_Pull_ArrayEnd;
+            return pull->token;
+        }
+
+        if (pull->count[level] > 0)
+        {
+            if (c != ',')
+            {
+                return pull_fail(pull);
+            }
+            pull->offset++;
+            pull_skip_whitespace(pull);
+        }
+
+        if (pull->container[level] == '{')
+        {
+            if (!pull_can_read(pull, 1) || (pull->json[pull->offset] != '\"')
+                || !pull_scan_string(pull, &pull->key, &pull->key_length))
+            {
+                return pull_fail(pull);
+            }
+            pull_skip_whitespace(pull);
+            if (!pull_can_read(pull, 1) || (pull->json[pull->offset] != ':'))
+            {
+                return pull_fail(pull);
+            }
+            pull->offset++;
+            pull_skip_whitespace(pull);
+            pull_path_append(pull, pull->key, pull->key_length);
+        }
+        else
+        {
+            sprintf(index, "%d", pull->count[level]);
+            pull_path_append(pull, index, strlen(index));
+        }
+        pull->count[level]++;
+    }
+
+    pull->path_truncated = (pull->truncated_depth != 0);
+    return pull_value(pull);
+}
+
+CJSON_PUBLIC(cJSON_PullToken) cJSON_PullSkip(cJSON_Pull * const pull)
+{
+    int depth = pull->depth;
+
+    if ((pull->token != cJSON_Pull_ObjectBegin) && (pull->token != cJSON_Pull_ArrayBegin))
+    {
+        return pull->token;
+    }
+
+    while (pull->depth >= depth)
+    {
+        if (cJSON_PullNext(pull) == cJSON_Pull_Error)
+        {
+            return cJSON_Pull_Error;
+        }
+    }
+    return pull->token;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PullKeyIs(const cJSON_Pull * const pull, const char *key)
+{
+    if ((pull->key == NULL) || (key == NULL))
+    {
+        return false;
+    }
+    return (strlen(key) == pull->key_length) && (strncmp(pull->key, key, pull->key_length) == 0);
+}
+
+static cJSON_bool pull_parse_hex4(const char *input, const char *end, unsigned long *value)
+{
+    int i = 0;
+
+    if ((end - input) < 4)
+    {
+        return false;
+    }
+
+    *value = 0;
+    for (i = 0; i < 4; i++)
+    {
+        char c = input[i];
+        *value <<= 4;
+        if ((c >= '0') && (c <= '9'))
+        {
+            *value += (unsigned long)(c - '0');
+        }
+        else if ((c >= 'A') && (c <= 'F'))
+        {
+            *value += (unsigned long)(10 + c - 'A');
+        }
+        else if ((c >= 'a') && (c <= 'f'))
+        {
+            *value += (unsigned long)(10 + c - 'a');
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+CJSON_PUBLIC(int) cJSON_PullGetString(const cJSON_Pull * const pull, char *buffer, size_t size)
+{
+    const char *input = NULL;
+    const char *end = NULL;
+    size_t used = 0;
+
+    if ((pull->token != cJSON_Pull_String) || (buffer == NULL) || (size == 0))
+    {
+        return -1;
+    }
+
+    end = pull->value + pull->value_length;
+    for (input = pull->value; input < end; input++)
+    {
+        unsigned long codepoint = (unsigned char)*input;
+        size_t utf8_length = 1;
+
+        if (*input == '\\')
+        {
+            if (++input >= end)
+            {
+                return -1;
+            }
+            switch (*input)
+            {
+                case 'b': codepoint = '\b'; break;
+                case 'f': codepoint = '\f'; break;
+                case 'n': codepoint = '\n'; break;
+                case 'r': codepoint = '\r'; break;
+                case 't': codepoint = '\t'; break;
+                case 'u':
+                    if (!pull_parse_hex4(input + 1, end, &codepoint))
+                    {
+                        return -1;
+                    }
+                    input += 4;
+                    /* UTF-16 surrogate pair */
+                    if ((codepoint >= 0xD800) && (codepoint <= 0xDBFF))
+                    {
+                        unsigned long second = 0;
+                        if (((end - input) < 7) || (input[1] != '\\') || (input[2] != 'u')
+                            || !pull_parse_hex4(input + 3, end, &second) || (second < 0xDC00) || (second > 0xDFFF))
+                        {
+                            return -1;
+                        }
+                        input += 6;
+                        codepoint = 0x10000 + (((codepoint & 0x3FF) << 10) | (second & 0x3FF));
+                    }
+                    break;
+                default:
+                    codepoint = (unsigned char)*input;
+                    break;
+            }
+
+            if (codepoint >= 0x10000)
+            {
+                utf8_length = 4;
+            }
+            else if (codepoint >= 0x800)
+            {
+                utf8_length = 3;
+            }
+            else if (codepoint >= 0x80)
+            {
+                utf8_length = 2;
+            }
+        }
+
+        if ((used + utf8_length) >= size)
+        {
+            return -1;
+        }
+
+        if (utf8_length == 1)
+        {
+            buffer[used] = (char)codepoint;
+        }
+        else
+        {
+            static const unsigned char first_byte_mark[5] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0 };
+            size_t i = utf8_length - 1;
+            for (; i > 0; i--)
+            {
+                buffer[used + i] = (char)((codepoint & 0x3F) | 0x80);
+                codepoint >>= 6;
+            }
+            buffer[used] = (char)(codepoint | first_byte_mark[utf8_length]);
+        }
+        used += utf8_length;
+    }
+
+    buffer[used] = '\0';
+    return (int)used;
+}
+
+CJSON_PUBLIC(double) cJSON_PullGetNumber(const cJSON_Pull * const pull)
+{
+    char number[64];
+
+    if ((pull->token != cJSON_Pull_Number) || (pull->value_length >= sizeof(number)))
+    {
+        return 0;
+    }
+
+    memcpy(number, pull->value, pull->value_length);
+    number[pull->value_length] = '\0';
+    return strtod(number, NULL);
+}
@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef cJSON_Pull__h
+#define cJSON_Pull__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cJSON.h"
+
+/* Pull tokenizer: walks a JSON text in place and yields one token per call, without any allocation.
+ * Intended to pick a few fields out of large documents, where building the whole tree is wasteful. */
+
+#define CJSON_PULL_MAX_DEPTH 16
+#define CJSON_PULL_PATH_SIZE 96
+
+typedef enum
+{
+    cJSON_Pull_Error = -1,
+    cJSON_Pull_End = 0, /* the top level value is finished */
+    cJSON_Pull_ObjectBegin,
+    cJSON_Pull_ObjectEnd,
+    cJSON_Pull_ArrayBegin,
+    cJSON_Pull_ArrayEnd,
+    cJSON_Pull_String,
+    cJSON_Pull_Number,
+    cJSON_Pull_True,
+    cJSON_Pull_False,
+    cJSON_Pull_Null
+} cJSON_PullToken;
+
+typedef struct cJSON_Pull
+{
+    const char *json;
+    size_t length;
+    size_t offset;
+    int depth;
+    cJSON_bool done;
+    unsigned char container[CJSON_PULL_MAX_DEPTH];
+    int count[CJSON_PULL_MAX_DEPTH];
+    size_t path_length[CJSON_PULL_MAX_DEPTH];
+    int truncated_depth;
+
+    /* current token */
+    cJSON_PullToken token;
+    /* member name of the value inside an object, NULL inside an array. Not terminated, escapes are not decoded */
+    const char *key;
+    size_t key_length;
+    /* text of a scalar value, without quotes for strings. Not terminated, escapes are not decoded */
+    const char *value;
+    size_t value_length;
+    /* RFC6901 style pointer of the current value (of the container for end tokens), like "/data/items/0/id".
+     * Member names are copied as they are in the text. */
+    char path[CJSON_PULL_PATH_SIZE];
+    cJSON_bool path_truncated;
+} cJSON_Pull;
+
+/* Start tokenizing length bytes of json. The text needn't be null terminated, and must be kept during tokenizing. */
+CJSON_PUBLIC(void) cJSON_PullInit(cJSON_Pull * const pull, const char *json, size_t length);
+/* Advance to the next token. After an error, cJSON_Pull_Error is returned for all calls. */
+CJSON_PUBLIC(cJSON_PullToken) cJSON_PullNext(cJSON_Pull * const pull);
+/* When the current token begins an object or array, skip to its end token. Returns the token after skipping. */
+CJSON_PUBLIC(cJSON_PullToken) cJSON_PullSkip(cJSON_Pull * const pull);
+
+/* Whether the member name of the current value equals to key. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PullKeyIs(const cJSON_Pull * const pull, const char *key);
+/* Decode the current string token into buffer with null terminator, escapes decoded.
+ * Returns the decoded length, or -1 when it isn't a string or buffer is too small. */
+CJSON_PUBLIC(int) cJSON_PullGetString(const cJSON_Pull * const pull, char *buffer, size_t size);
+/* Value of the current number token, 0 for other tokens. */
+CJSON_PUBLIC(double) cJSON_PullGetNumber(const cJSON_Pull * const pull);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
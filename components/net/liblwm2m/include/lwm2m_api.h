@@ -251,6 +251,15 @@ void lwm2mPostEvent(uint8_t ref, uint32_t nEventId, uint32_t nResult, uint32_t n
 
 int8_t lwm2m_new_config_xml(void *file_config, uint16_t size);
 
+// Incremental XML configuration: chunks, for example HTTP body pieces, are parsed as they arrive,
+// and the whole document is never buffered. finish creates the configuration as lwm2m_new_config_xml,
+// and the instance is deleted by finish or delete.
+typedef struct lwm2m_config_xml lwm2m_config_xml_t;
+lwm2m_config_xml_t *lwm2m_config_xml_create(void);
+int8_t lwm2m_config_xml_feed(lwm2m_config_xml_t *xml, const void *data, size_t size);
+int8_t lwm2m_config_xml_finish(lwm2m_config_xml_t *xml);
+void lwm2m_config_xml_delete(lwm2m_config_xml_t *xml);
+
 int8_t lwm2m_new_config(const uint8_t *cmdline);
 
 lwm2m_ret_t lwm2m_free_config(uint8_t ref);
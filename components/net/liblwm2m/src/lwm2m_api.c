@@ -94,90 +94,172 @@ typedef struct
     uint8_t item2;
     uint8_t ishostkey;
     uint8_t isuserdatakey;
+    uint8_t hostlen;
+    uint8_t cmdlinelen;
     uint8_t host[50];
     uint8_t cmdline[100];
 } att_value_t;
 
+struct lwm2m_config_xml
+{
+    XML_Parser parser;
+    att_value_t value;
+};
+
 static void elementStart(void *data, const char *el, const char **attr)
 {
     att_value_t *value = (att_value_t *)data;
-    fprintf(stderr, "el =%s,%s,%s", el, attr[0], attr[1]);
     if (el != NULL && attr[0] != NULL && attr[1] != NULL)
     {
+        fprintf(stderr, "el =%s,%s,%s", el, attr[0], attr[1]);
         if (strcmp(el, "item") == 0 && strcmp(attr[0], "id") == 0 && strcmp(attr[1], "2") == 0)
             value->item2 = 2;
         else if (value->item2 && strcmp(el, "data") == 0 && strcmp(attr[0], "name") == 0)
         {
             if (strcmp(attr[1], "Host") == 0)
+            {
                 value->ishostkey = 1;
+                value->hostlen = 0;
+            }
             else if (strcmp(attr[1], "Userdata") == 0)
+            {
                 value->isuserdatakey = 1;
+                value->cmdlinelen = 0;
+            }
         }
     }
 }
 
-static void attValues(void *data, const XML_Char *s, int len)
+static void elementEnd(void *data, const char *el)
 {
     att_value_t *value = (att_value_t *)data;
-    if (value->ishostkey && len < 50)
+    if (value->ishostkey)
     {
-        memcpy(value->host, s, len);
+        value->host[value->hostlen] = 0;
         value->ishostkey = 0;
         value->item2--;
         fprintf(stderr, "host =%s", value->host);
     }
-    else if (value->isuserdatakey && len < 100)
+    else if (value->isuserdatakey)
     {
-        memcpy(value->cmdline, s, len);
+        value->cmdline[value->cmdlinelen] = 0;
         value->isuserdatakey = 0;
         value->item2--;
         fprintf(stderr, "cmdline =%s", value->cmdline);
     }
 }
 
-int8_t lwm2m_new_config_xml(void *file_config, uint16_t size)
+// text of an element may come in several pieces, when it crosses the fed chunks
+static void attValues(void *data, const XML_Char *s, int len)
 {
-    if (netif_default == NULL)
+    att_value_t *value = (att_value_t *)data;
+    if (value->ishostkey)
+    {
+        int n = OSI_MIN(int, len, (int)sizeof(value->host) - 1 - value->hostlen);
+        memcpy(value->host + value->hostlen, s, n);
+        value->hostlen += n;
+    }
+    else if (value->isuserdatakey)
+    {
+        int n = OSI_MIN(int, len, (int)sizeof(value->cmdline) - 1 - value->cmdlinelen);
+        memcpy(value->cmdline + value->cmdlinelen, s, n);
+        value->cmdlinelen += n;
+    }
+}
+
+lwm2m_config_xml_t *lwm2m_config_xml_create(void)
+{
+    lwm2m_config_xml_t *xml = (lwm2m_config_xml_t *)calloc(1, sizeof(lwm2m_config_xml_t));
+    if (xml == NULL)
+        return NULL;
+
+    xml->parser = XML_ParserCreate(NULL);
+    if (xml->parser == NULL)
+    {
+        free(xml);
+        return NULL;
+    }
+    XML_SetUserData(xml->parser, &xml->value);
+    /* Tell expat to use functions start() and end() each times it encounters
+     * the start or end of an element. */
+    XML_SetElementHandler(xml->parser, elementStart, elementEnd);
+    XML_SetCharacterDataHandler(xml->parser, attValues);
+    return xml;
+}
+
+int8_t lwm2m_config_xml_feed(lwm2m_config_xml_t *xml, const void *data, size_t size)
+{
+    if (xml == NULL || (data == NULL && size != 0))
         return -1;
-    XML_Parser parser = XML_ParserCreate(NULL);
-    if (parser == NULL)
+
+    if (XML_Parse(xml->parser, (const char *)data, (int)size, XML_FALSE) == XML_STATUS_ERROR)
     {
+        fprintf(stderr, "xml error %s at line %d", XML_ErrorString(XML_GetErrorCode(xml->parser)),
+                (int)XML_GetCurrentLineNumber(xml->parser));
         return -1;
     }
+    return 0;
+}
+
+void lwm2m_config_xml_delete(lwm2m_config_xml_t *xml)
+{
+    if (xml == NULL)
+        return;
+    XML_ParserFree(xml->parser);
+    free(xml);
+}
+
+int8_t lwm2m_config_xml_finish(lwm2m_config_xml_t *xml)
+{
+    if (xml == NULL)
+        return -1;
+
     char *port = NULL;
     uint8_t cmdline[256] = {0};
-    att_value_t value = {0};
-    XML_SetUserData(parser, &value);
-    /* Tell expat to use functions start() and end() each times it encounters
-     * the start or end of an element. */
-    XML_SetStartElementHandler(parser, elementStart);
-    XML_SetCharacterDataHandler(parser, attValues);
-    if (XML_Parse(parser, file_config, size, XML_TRUE) == XML_STATUS_ERROR)
+    att_value_t *value = &xml->value;
+    if (netif_default == NULL || XML_Parse(xml->parser, NULL, 0, XML_TRUE) == XML_STATUS_ERROR)
     {
+        lwm2m_config_xml_delete(xml);
         return -1;
     }
-    XML_ParserFree(parser);
-    if (strlen((char *)value.host) != 0)
+
+    if (strlen((char *)value->host) != 0)
     {
-        port = strstr((char *)value.host, ":");
+        port = strstr((char *)value->host, ":");
         if (port != NULL)
         {
-            value.host[port - (char *)value.host] = 0;
+            value->host[port - (char *)value->host] = 0;
             port++;
         }
-        fprintf(stderr, "host =%s,port=%s", value.host, port);
+        fprintf(stderr, "host =%s,port=%s", value->host, port);
     }
-    if (strlen((char *)value.cmdline) != 0)
+    if (strlen((char *)value->cmdline) != 0)
     {
-        fprintf(stderr, "cmdline =%s", value.cmdline);
+        fprintf(stderr, "cmdline =%s", value->cmdline);
     }
     if (port)
-        snprintf((char *)cmdline, 255, "%s -h %s -p %s", value.cmdline, value.host, port);
+        snprintf((char *)cmdline, 255, "%s -h %s -p %s", value->cmdline, value->host, port);
     else
-        snprintf((char *)cmdline, 255, "%s -h %s", value.cmdline, value.host);
+        snprintf((char *)cmdline, 255, "%s -h %s", value->cmdline, value->host);
+    lwm2m_config_xml_delete(xml);
     return lwm2m_new_config(cmdline);
 }
 
+int8_t lwm2m_new_config_xml(void *file_config, uint16_t size)
+{
+    if (netif_default == NULL)
+        return -1;
+    lwm2m_config_xml_t *xml = lwm2m_config_xml_create();
+    if (xml == NULL)
+        return -1;
+    if (lwm2m_config_xml_feed(xml, file_config, size) != 0)
+    {
+        lwm2m_config_xml_delete(xml);
+        return -1;
+    }
+    return lwm2m_config_xml_finish(xml);
+}
+
 int8_t lwm2m_new_config(const uint8_t *cmdline)
 {
     uint8_t ref = 0xff;
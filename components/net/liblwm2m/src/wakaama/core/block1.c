@@ -154,6 +154,137 @@ void free_block1_buffer(lwm2m_block1_data_t * block1Data)
 }
 extern lwm2m_fota_state_t g_fota_state;
 extern bool check_fota_file_sanity();
+extern uint32_t write_fota_upgrade_data(uint32_t block_num, uint8_t block_more, uint8_t * data, uint16_t datalen);
+
+static lwm2m_fota_block_t * prv_fota_block2_find(lwm2m_fota_t * fotaContext, uint32_t offset)
+{
+    int i;
+
+    for (i = 0; i < LWM2M_FOTA_BLOCK2_WINDOW - 1; i++)
+    {
+        if (fotaContext->pending[i].data != NULL && fotaContext->pending[i].offset == offset)
+        {
+            return &fotaContext->pending[i];
+        }
+    }
+    return NULL;
+}
+
+static void prv_fota_block2_drop(lwm2m_fota_t * fotaContext)
+{
+    int i;
+
+    for (i = 0; i < LWM2M_FOTA_BLOCK2_WINDOW - 1; i++)
+    {
+        if (fotaContext->pending[i].data != NULL)
+        {
+            lwm2m_free(fotaContext->pending[i].data);
+            fotaContext->pending[i].data = NULL;
+        }
+    }
+}
+
+static uint8_t prv_fota_block2_stash(lwm2m_fota_t * fotaContext, uint32_t offset, uint8_t * buffer, size_t length, bool blockMore)
+{
+    int i;
+
+    // only blocks inside the request window are kept, others will be requested again
+    if (offset >= fotaContext->block2bufferSize + LWM2M_FOTA_BLOCK2_WINDOW * fotaContext->blockSize)
+        return COAP_IGNORE;
+
+    for (i = 0; i < LWM2M_FOTA_BLOCK2_WINDOW - 1; i++)
+    {
+        lwm2m_fota_block_t * blockP = &fotaContext->pending[i];
+        if (blockP->data == NULL)
+        {
+            blockP->data = (uint8_t *)lwm2m_malloc(length);
+            if (blockP->data == NULL)
+                return COAP_IGNORE;
+            memcpy(blockP->data, buffer, length);
+            blockP->offset = offset;
+            blockP->length = length;
+            blockP->more = blockMore;
+            return COAP_NO_ERROR;
+        }
+    }
+    return COAP_IGNORE;
+}
+
+static uint8_t prv_fota_block2_write(lwm2m_fota_t * fotaContext, uint8_t * buffer, size_t length, bool blockMore)
+{
+    uint8_t coapError;
+
+    coapError = write_fota_upgrade_data(fotaContext->block2bufferSize / fotaContext->blockSize, blockMore, buffer, length);
+    if (coapError == COAP_NO_ERROR)
+    {
+        fotaContext->block2bufferSize += length;
+    }
+    return coapError;
+}
+
+void lwm2m_fota_block2_reset(lwm2m_context_t * contextP)
+{
+    lwm2m_fota_t * fotaContext = &contextP->fota_context;
+
+    prv_fota_block2_drop(fotaContext);
+    fotaContext->block2bufferSize = 0;
+    fotaContext->block2Num = 0;
+    fotaContext->blockSize = 0;
+    fotaContext->reqOffset = 0;
+}
+
+int lwm2m_fota_block2_request(lwm2m_context_t * contextP, void * sessionH, const char * uri, bool restart)
+{
+    lwm2m_fota_t * fotaContext = &contextP->fota_context;
+    size_t endOffset;
+
+    if (fotaContext->blockSize == 0)
+    {
+        fotaContext->blockSize = REST_MAX_CHUNK_SIZE;
+    }
+
+    if (restart)
+    {
+        // responses to the lost requests are ignored with the new token
+        time_t tv_sec = lwm2m_gettime();
+        uint16_t mid = contextP->nextMID;
+
+        fotaContext->token[0] = mid;
+        fotaContext->token[1] = mid >> 8;
+        fotaContext->token[2] = tv_sec;
+        fotaContext->token[3] = tv_sec >> 8;
+        fotaContext->token[4] = tv_sec >> 16;
+        fotaContext->token[5] = tv_sec >> 24;
+        fotaContext->reqOffset = fotaContext->block2bufferSize;
+    }
+    if (fotaContext->reqOffset < fotaContext->block2bufferSize)
+    {
+        fotaContext->reqOffset = fotaContext->block2bufferSize;
+    }
+
+    endOffset = fotaContext->block2bufferSize + LWM2M_FOTA_BLOCK2_WINDOW * fotaContext->blockSize;
+    while (fotaContext->reqOffset < endOffset)
+    {
+        coap_packet_t message[1];
+        uint32_t blockNum = fotaContext->reqOffset / fotaContext->blockSize;
+
+        if (prv_fota_block2_find(fotaContext, fotaContext->reqOffset) == NULL)
+        {
+            coap_init_message(message, COAP_TYPE_CON, COAP_GET, contextP->nextMID++);
+            coap_set_header_uri_path(message, uri);
+            coap_set_header_token(message, fotaContext->token, COAP_TOKEN_LEN);
+            coap_set_header_content_type(message, LWM2M_CONTENT_OPAQUE);
+            coap_set_header_block2(message, blockNum, 0, fotaContext->blockSize);
+
+            LOG_ARG("lwm2m_fota_block2_request block2Num %d blockSize %d", blockNum, fotaContext->blockSize);
+            if (COAP_NO_ERROR != message_send(contextP, message, sessionH))
+                return -1;
+        }
+        fotaContext->reqOffset += fotaContext->blockSize;
+    }
+    return 0;
+}
+
 uint8_t lwm2m_fota_block2_handler(lwm2m_context_t * contextP,
     uint16_t mid,
     uint8_t * buffer,
@@ -165,71 +296,70 @@ uint8_t lwm2m_fota_block2_handler(lwm2m_context_t * contextP,
 {
     uint8_t coapError = NO_ERROR;
     lwm2m_fota_t * fotaContext = &contextP->fota_context;
+    uint8_t * token = NULL;
+    uint32_t offset;
+    uint32_t lastNum;
+    lwm2m_fota_block_t * blockP;
     LOG_ARG("lwm2m_fota_block2_handler block2Num %d blockSize %d blockMore %d g_fota_state %d\r\n",blockNum,blockSize,blockMore,g_fota_state);
     if(g_fota_state != LWM2M_FOTA_STATE_DOWNLOADING)
         return COAP_IGNORE;
-    if(blockNum == 0)
+
+    if(coap_get_header_token(message,(const uint8_t **)(&token)) == 0)
     {
-        uint8_t * token = NULL;
-        if(coap_get_header_token(message,(const uint8_t **)(&token)) == 0)
-        {
-            LOG("lwm2m_fota_block2_handler get token err\r\n");
-            return COAP_IGNORE;
-        }
+        LOG("lwm2m_fota_block2_handler get token err\r\n");
+        return COAP_IGNORE;
+    }
 
-        if(memcmp(fotaContext->token, token, COAP_TOKEN_LEN)!=0)
-        {
-            LOG("lwm2m_fota_block2_handler token err\r\n");
-            return COAP_IGNORE;
-        }
-        coapError = write_fota_upgrade_data(blockNum, blockMore, buffer, length);
-        if(coapError != COAP_NO_ERROR){
-           LOG("lwm2m_fota_block2_handler write_fota_upgrade_data err\r\n");
-           notify_fota_state(LWM2M_FOTA_STATE_IDLE, LWM2M_FOTA_RESULT_NOT_ENOUGH_FLASH, contextP->ref);
-           return COAP_500_INTERNAL_SERVER_ERROR;
-        }
-        fotaContext->block2bufferSize = length;
-        fotaContext->lastmid = mid;
-        fotaContext->block2Num = ++blockNum;
+    if(memcmp(fotaContext->token, token, COAP_TOKEN_LEN)!=0)
+    {
+        LOG("lwm2m_fota_block2_handler token err\r\n");
+        return COAP_IGNORE;
     }
-    else
+
+    if(fotaContext->blockSize == 0 || blockSize < fotaContext->blockSize)
     {
-       if(fotaContext->lastmid != mid)
-       {
-            uint8_t * token = NULL;
-            if(coap_get_header_token(message,(const uint8_t **)&token) == 0)
-            {
-                LOG("lwm2m_fota_block2_handler get token err\r\n");
-                return COAP_IGNORE;
-            }
+        // the server prefers smaller blocks, following requests are issued with its size
+        fotaContext->blockSize = blockSize;
+        fotaContext->reqOffset = fotaContext->block2bufferSize;
+    }
 
-            if(memcmp(fotaContext->token, token, COAP_TOKEN_LEN)!=0)
-            {
-                LOG("lwm2m_fota_block2_handler token err\r\n");
-                return COAP_IGNORE;
-            }
-            coapError = write_fota_upgrade_data(blockNum, blockMore, buffer, length);
-            if(coapError != COAP_NO_ERROR){
-               LOG("lwm2m_fota_block2_handler write_fota_upgrade_data err\r\n");
-               notify_fota_state(LWM2M_FOTA_STATE_IDLE, LWM2M_FOTA_RESULT_NOT_ENOUGH_FLASH, contextP->ref);
-               return COAP_500_INTERNAL_SERVER_ERROR;
-            }
-            fotaContext->block2bufferSize += length;
-            fotaContext->lastmid = mid;
-            fotaContext->block2Num = ++blockNum;
-       }
+    // responses of pipelined requests may be duplicated or reordered, they are ordered by offset
+    offset = blockNum * blockSize;
+    if(offset < fotaContext->block2bufferSize || prv_fota_block2_find(fotaContext, offset) != NULL)
+        return COAP_IGNORE;
+
+    if(offset > fotaContext->block2bufferSize)
+        return prv_fota_block2_stash(fotaContext, offset, buffer, length, blockMore);
+
+    lastNum = fotaContext->block2Num;
+    coapError = prv_fota_block2_write(fotaContext, buffer, length, blockMore);
+    while(coapError == COAP_NO_ERROR && blockMore
+        && (blockP = prv_fota_block2_find(fotaContext, fotaContext->block2bufferSize)) != NULL)
+    {
+        blockMore = blockP->more;
+        coapError = prv_fota_block2_write(fotaContext, blockP->data, blockP->length, blockMore);
+        lwm2m_free(blockP->data);
+        blockP->data = NULL;
     }
+    if(coapError != COAP_NO_ERROR){
+       LOG("lwm2m_fota_block2_handler write_fota_upgrade_data err\r\n");
+       prv_fota_block2_drop(fotaContext);
+       notify_fota_state(LWM2M_FOTA_STATE_IDLE, LWM2M_FOTA_RESULT_NOT_ENOUGH_FLASH, contextP->ref);
+       return COAP_500_INTERNAL_SERVER_ERROR;
+    }
+    fotaContext->lastmid = mid;
+    fotaContext->block2Num = fotaContext->block2bufferSize / fotaContext->blockSize;
 
     if(blockMore)
     {
         lwm2m_start_fota_download(fotaContext->uri, contextP->ref);
-        if(blockNum %10 == 1)
+        if((lastNum + 9) / 10 != (fotaContext->block2Num + 9) / 10)
         {
             notify_fota_state(LWM2M_FOTA_STATE_DOWNLOADING, LWM2M_FOTA_RESULT_INIT, contextP->ref);
         }
     }else
     {
-
+        prv_fota_block2_drop(fotaContext);
         LOG_ARG("lwm2m_fota_block2_handler fota download success size %d\r\n",fotaContext->block2bufferSize);
         if(check_fota_file_sanity())
         {
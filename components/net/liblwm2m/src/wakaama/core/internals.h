@@ -119,6 +119,11 @@
 
 #define LWM2M_DEFAULT_LIFETIME  86400
 
+// Seconds to hold value change notifications, so the changes of the window reach the server together
+#ifndef LWM2M_NOTIFY_COALESCE_WINDOW
+#define LWM2M_NOTIFY_COALESCE_WINDOW  2
+#endif
+
 #ifdef LWM2M_SUPPORT_JSON
 #define REG_LWM2M_RESOURCE_TYPE     ">;rt=\"oma.lwm2m\";ct=11543,"
 #define REG_LWM2M_RESOURCE_TYPE_LEN 25
@@ -196,6 +196,7 @@ void lwm2m_close(lwm2m_context_t * contextP)
     {
         lwm2m_free(contextP->altPath);
     }
+    lwm2m_fota_block2_reset(contextP);
 
 #endif
 
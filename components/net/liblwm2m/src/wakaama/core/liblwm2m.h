@@ -340,6 +340,20 @@ typedef enum
     LWM2M_FOTA_RESULT_UNSUPPORTED_PROTOCOL
 }lwm2m_fota_result_t;
 
+// Number of FOTA Block2 requests kept outstanding
+#ifndef LWM2M_FOTA_BLOCK2_WINDOW
+#define LWM2M_FOTA_BLOCK2_WINDOW 4
+#endif
+
+// FOTA Block2 response received ahead of the write position
+typedef struct
+{
+uint8_t * data;
+uint32_t offset;
+uint16_t length;
+bool more;
+}lwm2m_fota_block_t;
+
 typedef struct _lwm2m_fota_
 {
 size_t block2bufferSize;
@@ -347,6 +361,9 @@ uint32_t block2Num;
 uint16_t lastmid;
 uint8_t token[COAP_TOKEN_LEN];
 uint8_t* uri;
+uint16_t blockSize;     // negotiated Block2 size, 0 before the first request
+size_t reqOffset;       // offset of the next Block2 request
+lwm2m_fota_block_t pending[LWM2M_FOTA_BLOCK2_WINDOW - 1];
 }lwm2m_fota_t;
 
 
@@ -533,6 +550,7 @@ typedef struct _lwm2m_server_
     char *                  location;
     bool                    dirty;
     lwm2m_block1_data_t *   block1Data;   // buffer to handle block1 data, should be replace by a list to support several block1 transfer by server.
+    time_t                  notifyTime;   // end of the window to coalesce notifications to this server, 0 if none
     uint8_t ref;
 } lwm2m_server_t;
 
@@ -771,6 +789,12 @@ int lwm2m_remove_object(lwm2m_context_t * contextP, uint16_t id);
 int lwm2m_update_registration(lwm2m_context_t * contextP, uint16_t shortServerID, bool withObjects);
 
 void lwm2m_resource_value_changed(lwm2m_context_t * contextP, lwm2m_uri_t * uriP);
+
+// restart the FOTA Block2 download from the beginning of the package.
+void lwm2m_fota_block2_reset(lwm2m_context_t * contextP);
+// keep up to LWM2M_FOTA_BLOCK2_WINDOW Block2 requests of the FOTA package outstanding.
+// When restart is true, outstanding requests are considered lost, and the window is requested again with a new token.
+int lwm2m_fota_block2_request(lwm2m_context_t * contextP, void * sessionH, const char * uri, bool restart);
 #endif
 
 #ifdef LWM2M_SERVER_MODE
@@ -753,6 +753,25 @@ void observe_step(lwm2m_context_t * contextP,
                     }
                 }
 
+#if LWM2M_NOTIFY_COALESCE_WINDOW > 0
+                if (notify == true)
+                {
+                    // hold value changes until the window of the server ends, so one radio wakeup carries them all
+                    lwm2m_server_t * serverP = watcherP->server;
+
+                    if (serverP->notifyTime == 0)
+                    {
+                        serverP->notifyTime = currentTime + LWM2M_NOTIFY_COALESCE_WINDOW;
+                    }
+                    if (serverP->notifyTime > currentTime)
+                    {
+                        interval = serverP->notifyTime - currentTime;
+                        if (*timeoutP > interval) *timeoutP = interval;
+                        notify = false;
+                    }
+                }
+#endif
+
                 // Is the Maximum Period reached ?
                 if (notify == false
                  && watcherP->parameters != NULL
@@ -842,6 +861,21 @@ void observe_step(lwm2m_context_t * contextP,
         if (dataP != NULL) lwm2m_data_free(size, dataP);
         if (buffer != NULL) lwm2m_free(buffer);
     }
+
+#if LWM2M_NOTIFY_COALESCE_WINDOW > 0
+    {
+        lwm2m_server_t * serverP;
+
+        // held notifications were sent above, start a new window on the next change
+        for (serverP = contextP->serverList ; serverP != NULL ; serverP = serverP->next)
+        {
+            if (serverP->notifyTime != 0 && serverP->notifyTime <= currentTime)
+            {
+                serverP->notifyTime = 0;
+            }
+        }
+    }
+#endif
 }
 /*
 void notify_value(lwm2m_context_t * contextP,
@@ -639,6 +639,7 @@ extern lwm2m_fota_state_t g_fota_state;
 
 static long s_fota_download_start_time;
 static int s_long_time_download_index = 0;
+static bool s_fota_restart = false;
 
 static int prv_download_fota(char * buffer,
                        void * user_data)
@@ -646,28 +647,10 @@ static int prv_download_fota(char * buffer,
     lwm2m_context_t * lwm2mH = (lwm2m_context_t *)user_data;
     int value[1];
     lwm2m_parse_buffer(buffer,value,1,NULL);
-    uint16_t mid = lwm2mH->nextMID++;
     uint8_t *uri = (uint8_t *)value[0];
-    coap_packet_t message;
-    coap_init_message(&message, COAP_TYPE_CON, COAP_GET, mid);
-    coap_set_header_uri_path(&message, (const char *)uri);
-    // generate a token
-    uint8_t temp_token[COAP_TOKEN_LEN];
-    time_t tv_sec = lwm2m_gettime();
-
-    // initialize first 6 bytes, leave the last 2 random
-    temp_token[0] = mid;
-    temp_token[1] = mid >> 8;
-    temp_token[2] = tv_sec;
-    temp_token[3] = tv_sec >> 8;
-    temp_token[4] = tv_sec >> 16;
-    temp_token[5] = tv_sec >> 24;
-    // use just the provided amount of bytes
-    coap_set_header_token(&message, temp_token, COAP_TOKEN_LEN);
-    size_t allocLen;
-
-    allocLen = coap_serialize_get_size(&message);
-    if (allocLen == 0) return -1;
+    bool restart;
+
+    if(uri == NULL || uri[0] == 0) return -1;
 
     if(lwm2mH->fota_upgrade_observed == NULL || lwm2mH->fota_upgrade_observed->watcherList == NULL)
         return 2;
@@ -676,10 +659,14 @@ static int prv_download_fota(char * buffer,
         return 2;
 
     LOG_ARG("prv_download_fota  block2Num %d long_time_index %d",lwm2mH->fota_context.block2Num,s_long_time_download_index);
+    // blocks written post the download again to refill the window, the timeout in main loop
+    // requests the window again
+    restart = (s_fota_restart || lwm2mH->fota_context.block2Num == 0);
+    s_fota_restart = false;
     if(s_last_fota_num != lwm2mH->fota_context.block2Num)
     {
         s_fota_num_retry = 0;
-    }else
+    }else if(restart)
     {
         s_fota_num_retry++;
     }
@@ -687,22 +674,19 @@ static int prv_download_fota(char * buffer,
     s_fota_download_tv = lwm2m_gettime();
     if(s_long_time_download_index %20 < 15 || lwm2mH->fota_context.block2Num == 0)
     {
-        memcpy(lwm2mH->fota_context.token ,temp_token, COAP_TOKEN_LEN);
         if(lwm2mH->fota_context.uri == NULL)
         {
             lwm2mH->fota_context.uri = lwm2m_malloc(strlen((const char*)uri)+1);
             strcpy((char*)(lwm2mH->fota_context.uri), (const char*)uri);
         }
-        coap_set_header_content_type(&message,LWM2M_CONTENT_OPAQUE);
-        coap_set_header_block2(&message, lwm2mH->fota_context.block2Num, 0, REST_MAX_CHUNK_SIZE);
         lwm2mH->sendflag = 0;
         if(lwm2mH->fota_context.block2Num == 0)
         {
             s_fota_download_start_time = lwm2m_gettime();
         }
 
-        LOG_ARG("message_send COAP_GET lwm2mH->fota_context.block2Num %d",lwm2mH->fota_context.block2Num);
-        message_send(lwm2mH, &message, watcherP->server->sessionH);
+        LOG_ARG("lwm2m_fota_block2_request block2Num %d restart %d",lwm2mH->fota_context.block2Num,restart);
+        lwm2m_fota_block2_request(lwm2mH, watcherP->server->sessionH, (const char *)lwm2mH->fota_context.uri, restart);
     }
     return 1;
 }
@@ -1624,6 +1608,7 @@ int lwm2mclient_main(int argc, char *argv[])
                     if(lwm2mH->fota_context.uri != NULL)
                     {
                         LOG_ARG("LWM2M_FOTA_STATE_DOWNLOADING s_fota_num_retry %d", s_fota_num_retry);
+                        s_fota_restart = true;
                         lwm2m_start_fota_download(lwm2mH->fota_context.uri, lwm2mH->ref);
                         s_fota_download_tv = lwm2m_gettime();
                     }
@@ -196,8 +196,7 @@ static uint8_t prv_firmware_write(uint16_t instanceId,
                 }
 #endif
 #endif
-                lwm2mH->fota_context.block2Num = 0;
-                lwm2mH->fota_context.block2bufferSize = 0;
+                lwm2m_fota_block2_reset(lwm2mH);
                 notify_fota_state(LWM2M_FOTA_STATE_DOWNLOADING, LWM2M_FOTA_RESULT_INIT, lwm2mH->ref);
                 lwm2m_start_fota_download(path, lwm2mH->ref);
             }else
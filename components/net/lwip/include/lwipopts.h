@@ -180,6 +180,7 @@
 #define LWIP_NETCONN 0
 #define LWIP_SOCKET 1
 #define LWIP_DNS 1
+#define DNS_TABLE_SIZE 8
 #define LWIP_RAW 1
 #define LWIP_NETIF_API 0
 #define LWIP_TCPIP_CORE_LOCKING 1
@@ -197,8 +198,18 @@
 #define MEMP_MEM_MALLOC 1
 #endif
 #define MEM_LIBC_MALLOC 1
+#if defined(CONFIG_KERNEL_MEM_BUDGET)
+#include "osi_mem.h"
+#define mem_clib_free(p) osiMemBudgetFree(OSI_MEM_BUDGET_LWIP, p)
+#define mem_clib_malloc(size) osiMemBudgetMalloc(OSI_MEM_BUDGET_LWIP, size)
+#elif defined(CONFIG_KERNEL_SLAB_POOL_SIZE)
+#include "osi_slab.h"
+#define mem_clib_free osiSlabFree
+#define mem_clib_malloc osiSlabMalloc
+#else
 #define mem_clib_free free
 #define mem_clib_malloc malloc
+#endif
 #define mem_clib_calloc
 
 //#define malloc COS_MALLOC
@@ -224,6 +235,7 @@
 #define MEMP_NUM_TCP_PCB MEMP_NUM_NETCONN
 
 #define LWIP_SO_LINGER                  1
+#define LWIP_NETCONN_ZEROCOPY           1
 
 /* Minimal changes to opt.h required for tcp unit tests: */
 #if 0
@@ -239,12 +251,18 @@
 #define TCP_MSS 1500
 #define TCP_WND (16 * TCP_MSS)
 #define TCP_SND_BUF (8 * TCP_MSS)
+#define TCP_SND_BUF_MAX (32 * TCP_MSS)
+#define TCP_SND_QUEUELEN ((4 * (TCP_SND_BUF_MAX) + (TCP_MSS - 1)) / (TCP_MSS))
 #define MEMP_NUM_TCP_SEG TCP_SND_QUEUELEN
 #define LWIP_WND_SCALE 1
-#define TCP_RCV_SCALE 0
+#define TCP_RCV_SCALE 2
+#define TCP_WND_AUTOTUNE 1
+#define TCP_WND_AUTOTUNE_MAX (128 * 1024)
+#define TCP_WND_AUTOTUNE_BUDGET (256 * 1024)
 #define PBUF_POOL_SIZE 40
 #endif
 #define LWIP_STATS 0
+#define TCP_REXMIT_COUNT 1
 #define LWIP_ICMP 1
 
 #define MEM_ALIGNMENT 4
@@ -258,6 +276,10 @@
 /* Minimal changes to opt.h required for etharp unit tests: */
 #define ETHARP_SUPPORT_STATIC_ENTRIES 0
 
+/* MQTT: coalesce small publish, and wider window of QoS 1 in flight */
+#define MQTT_OUTPUT_COALESCE_MS 10
+#define MQTT_REQ_MAX_IN_FLIGHT 16
+
 #define USE_CUSTOMER_THREAD !LWIP_TIMERS
 #define TCPIP_THREAD_STACKSIZE 8192
 #define TCPIP_THREAD_PRIO OSI_PRIORITY_NORMAL
@@ -22,7 +22,9 @@
 
 #define RESOLV_NETWORK_ERROR 0x01
 
-#define LWIP_RAND() ((uint32_t)rand())
+#define LWIP_RAND() sys_rand()
+#define LWIP_HOOK_TCP_ISN(local_ip, local_port, remote_ip, remote_port) \
+    sys_tcp_isn(local_ip, local_port, remote_ip, remote_port)
 
 #ifdef __GNUC__
 #define UNUSED_PARAM __attribute__((unused))
@@ -79,4 +81,6 @@ void sys_timeout(uint32_t msecs, sys_timeout_handler handler, void *arg);
 void sys_untimeout(sys_timeout_handler handler, void *arg);
 void sys_settime(uint32_t sec, uint32_t frac);
 uint32_t sys_get_srand();
+uint32_t sys_rand(void);
+uint32_t sys_tcp_isn(const void *local_ip, uint16_t local_port, const void *remote_ip, uint16_t remote_port);
 #endif
@@ -62,6 +62,7 @@
 
 #include "lwip/api.h"
 #include "lwip/memp.h"
+#include "lwip/mem.h"
 
 #include "lwip/ip.h"
 #include "lwip/raw.h"
@@ -873,6 +874,72 @@ netconn_write_partly(struct netconn *conn, const void *dataptr, size_t size,
   return netconn_write_vectors_partly(conn, &vector, 1, apiflags, bytes_written);
 }
 
+#if LWIP_NETCONN_ZEROCOPY
+/**
+ * @ingroup netconn_tcp
+ * Send data over a TCP netconn without copy.
+ *
+ * TCP segments reference the application buffer, which can also be
+ * memory mapped flash from drvSpiFlashMapAddress. The buffer must be
+ * kept unchanged until \p sent is called.
+ *
+ * When ERR_ARG, ERR_VAL or ERR_MEM is returned for invalid parameters
+ * or tracking memory, nothing is written and \p sent won't be called.
+ * Otherwise \p sent is called exactly once in tcpip thread, even when
+ * the write fails, since part of the data may be queued already: with
+ * ERR_OK after all queued bytes are ACKed, or with the error when the
+ * connection is reset, aborted, or closed before that.
+ *
+ * Closing the netconn with unacked zero copy data resets the
+ * connection, since the pcb can't outlive the application buffer.
+ *
+ * @param conn the TCP netconn over which to send data
+ * @param dataptr pointer to the application buffer that contains the data to send
+ * @param size size of the application data to send
+ * @param apiflags NETCONN_MORE, NETCONN_DONTBLOCK as netconn_write_partly,
+ *        NETCONN_COPY is ignored
+ * @param bytes_written pointer to a location that receives the number of written bytes
+ * @param sent callback when the written bytes are ACKed or dropped
+ * @param arg argument of the callback
+ * @return ERR_OK if data was sent, any other err_t on error
+ */
+err_t
+netconn_write_zerocopy(struct netconn *conn, const void *dataptr, size_t size,
+                       u8_t apiflags, size_t *bytes_written,
+                       netconn_sent_fn sent, void *arg)
+{
+  API_MSG_VAR_DECLARE(msg);
+  struct netconn_zc *zc;
+  size_t written = 0;
+  err_t err;
+
+  LWIP_ERROR("netconn_write_zerocopy: invalid conn", (conn != NULL), return ERR_ARG;);
+  LWIP_ERROR("netconn_write_zerocopy: invalid conn->type", (NETCONNTYPE_GROUP(conn->type) == NETCONN_TCP), return ERR_VAL;);
+  LWIP_ERROR("netconn_write_zerocopy: invalid sent", (sent != NULL), return ERR_ARG;);
+
+  /* allocate before writing, so that written data is always tracked */
+  zc = (struct netconn_zc *)mem_malloc(sizeof(struct netconn_zc));
+  if (zc == NULL) {
+    return ERR_MEM;
+  }
+
+  err = netconn_write_partly(conn, dataptr, size, (u8_t)(apiflags & ~NETCONN_COPY), &written);
+  if (bytes_written != NULL) {
+    *bytes_written = written;
+  }
+
+  zc->sent = sent;
+  zc->arg = arg;
+  API_MSG_VAR_ALLOC(msg);
+  API_MSG_VAR_REF(msg).conn = conn;
+  API_MSG_VAR_REF(msg).msg.zc = zc;
+  netconn_apimsg(lwip_netconn_do_zerocopy, &API_MSG_VAR_REF(msg));
+  API_MSG_VAR_FREE(msg);
+
+  return err;
+}
+#endif /* LWIP_NETCONN_ZEROCOPY */
+
 /**
  * Send vectorized data atomically over a TCP netconn.
  *
@@ -56,10 +56,12 @@ extern void sys_post_DNSevent_to_APP(uint32_t nEventId, uint32_t nParam1, uint32
 #include "lwip/raw.h"
 
 #include "lwip/memp.h"
+#include "lwip/mem.h"
 #include "lwip/igmp.h"
 #include "lwip/dns.h"
 #include "lwip/mld6.h"
 #include "lwip/priv/tcpip_priv.h"
+#include "lwip/priv/tcp_priv.h"
 
 #include <string.h>
 #include <osi_log.h>
@@ -386,6 +388,33 @@ poll_tcp(void *arg, struct tcp_pcb *pcb)
   return ERR_OK;
 }
 
+#if LWIP_NETCONN_ZEROCOPY
+/**
+ * Complete zero copy writes of a TCP netconn.
+ *
+ * @param conn the TCP netconn
+ * @param pcb the pcb of the netconn, or NULL when the pcb is gone
+ * @param err ERR_OK to complete the ACKed writes, or the error to
+ *            complete all writes with when pcb is NULL
+ * @return 1 if there are still writes waiting for ACK, 0 otherwise
+ */
+static u8_t
+netconn_zc_complete(struct netconn *conn, struct tcp_pcb *pcb, err_t err)
+{
+  struct netconn_zc *zc;
+
+  while ((zc = conn->zc_pending) != NULL) {
+    if ((pcb != NULL) && TCP_SEQ_LT(pcb->lastack, zc->seq_end)) {
+      return 1;
+    }
+    conn->zc_pending = zc->next;
+    zc->sent(zc->arg, (pcb != NULL) ? ERR_OK : err);
+    mem_free(zc);
+  }
+  return 0;
+}
+#endif /* LWIP_NETCONN_ZEROCOPY */
+
 /**
  * Sent callback function for TCP netconns.
  * Signals the conn->sem and calls API_EVENT.
@@ -402,6 +431,9 @@ sent_tcp(void *arg, struct tcp_pcb *pcb, u16_t len)
   LWIP_ASSERT("conn != NULL", (conn != NULL));
 
   if (conn) {
+#if LWIP_NETCONN_ZEROCOPY
+    netconn_zc_complete(conn, pcb, ERR_OK);
+#endif /* LWIP_NETCONN_ZEROCOPY */
     if (conn->state == NETCONN_WRITE) {
       lwip_netconn_do_writemore(conn  WRITE_DELAYED);
     } else if (conn->state == NETCONN_CLOSE) {
@@ -453,6 +485,11 @@ err_tcp(void *arg, err_t err)
 
   SYS_ARCH_UNPROTECT(lev);
 
+#if LWIP_NETCONN_ZEROCOPY
+  /* the pcb is gone, and doesn't reference application memory any more */
+  netconn_zc_complete(conn, NULL, err);
+#endif /* LWIP_NETCONN_ZEROCOPY */
+
   /* Notify the user layer about a connection error. Used to signal select. */
   API_EVENT(conn, NETCONN_EVT_ERROR, 0);
   /* Try to release selects pending on 'read' or 'write', too.
@@ -716,6 +753,9 @@ netconn_alloc(enum netconn_type t, netconn_callback callback)
   }
   conn->acked_size = 0;
   conn->sent_size = 0;
+#if LWIP_NETCONN_ZEROCOPY
+  conn->zc_pending = NULL;
+#endif /* LWIP_NETCONN_ZEROCOPY */
   conn->pending_err = ERR_OK;
   conn->type = t;
   conn->pcb.tcp = NULL;
@@ -797,6 +837,9 @@ void
 netconn_free(struct netconn *conn)
 {
   LWIP_ASSERT("PCB must be deallocated outside this function", conn->pcb.tcp == NULL);
+#if LWIP_NETCONN_ZEROCOPY
+  LWIP_ASSERT("zero copy writes must be completed", conn->zc_pending == NULL);
+#endif /* LWIP_NETCONN_ZEROCOPY */
   LWIP_ASSERT("recvmbox must be deallocated before calling this function",
     !sys_mbox_valid(&conn->recvmbox));
 #if LWIP_TCP
@@ -950,6 +993,13 @@ lwip_netconn_do_close_internal(struct netconn *conn  WRITE_DELAYED_PARAM)
   }
   /* Try to close the connection */
   if (shut_close) {
+#if LWIP_NETCONN_ZEROCOPY
+    /* The pcb would keep sending from application memory after the netconn
+       is gone, so reset the connection like SO_LINGER with zero timeout */
+    if (netconn_zc_complete(conn, tpcb, ERR_OK)) {
+      conn->linger = 0;
+    }
+#endif /* LWIP_NETCONN_ZEROCOPY */
 #if LWIP_SO_LINGER
 	OSI_PRINTFI("conn->linger:%d, unsent:%d, unack:%d", conn->linger,conn->pcb.tcp->unsent,conn->pcb.tcp->unacked);
     /* check linger possibilites before calling tcp_close */
@@ -1047,6 +1097,9 @@ lwip_netconn_do_close_internal(struct netconn *conn  WRITE_DELAYED_PARAM)
       if (shut_close) {
         /* Set back some callback pointers as conn is going away */
         conn->pcb.tcp = NULL;
+#if LWIP_NETCONN_ZEROCOPY
+        netconn_zc_complete(conn, NULL, ERR_ABRT);
+#endif /* LWIP_NETCONN_ZEROCOPY */
         /* Trigger select() in socket layer. Make sure everybody notices activity
          on the connection, error first! */
         API_EVENT(conn, NETCONN_EVT_ERROR, 0);
@@ -1803,6 +1856,39 @@ lwip_netconn_do_write(void *m)
   TCPIP_APIMSG_ACK(msg);
 }
 
+#if LWIP_NETCONN_ZEROCOPY
+/**
+ * Track a zero copy write till it is ACKed
+ * Called from netconn_write_zerocopy, after the data is written
+ *
+ * @param m the api_msg pointing to the connection
+ */
+void
+lwip_netconn_do_zerocopy(void *m)
+{
+  struct api_msg *msg = (struct api_msg *)m;
+  struct netconn *conn = msg->conn;
+  struct netconn_zc *zc = msg->msg.zc;
+  struct netconn_zc **pzc;
+
+  msg->err = ERR_OK;
+  if (conn->pcb.tcp == NULL) {
+    /* connection error after written, the data is dropped with the pcb */
+    zc->sent(zc->arg, (conn->pending_err != ERR_OK) ? conn->pending_err : ERR_CLSD);
+    mem_free(zc);
+  } else {
+    /* data written after the write may be included, it is just later */
+    zc->seq_end = conn->pcb.tcp->snd_lbb;
+    zc->next = NULL;
+    for (pzc = &conn->zc_pending; *pzc != NULL; pzc = &(*pzc)->next) {
+    }
+    *pzc = zc;
+    netconn_zc_complete(conn, conn->pcb.tcp, ERR_OK);
+  }
+  TCPIP_APIMSG_ACK(msg);
+}
+#endif /* LWIP_NETCONN_ZEROCOPY */
+
 /**
  * Return a connection's local or remote address
  * Called from netconn_getaddr
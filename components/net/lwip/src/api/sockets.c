@@ -1354,6 +1354,49 @@ lwip_send(int s, const void *data, size_t size, int flags)
   return (err == ERR_OK ? (ssize_t)written : -1);
 }
 
+#if LWIP_NETCONN_ZEROCOPY
+/**
+ * Send on a TCP socket without copy, see netconn_write_zerocopy.
+ *
+ * Return the number of bytes queued, or -1 with errno. Unless it fails
+ * with EBADF, EOPNOTSUPP or ENOMEM before writing, \p sent is called
+ * once in tcpip thread when the data is ACKed or dropped, and the
+ * memory of \p data must be kept till then.
+ */
+ssize_t
+lwip_send_zerocopy(int s, const void *data, size_t size, int flags,
+                   netconn_sent_fn sent, void *arg)
+{
+  struct lwip_sock *sock;
+  err_t err;
+  u8_t write_flags;
+  size_t written;
+
+  LWIP_DEBUGF(SOCKETS_DEBUG, (0x0, "lwip_send_zerocopy(%d, data=%p, size=%ld, flags=0x%x)\n",
+                              s, data, (long int)size, flags));
+
+  sock = get_socket(s);
+  if (!sock) {
+    return -1;
+  }
+
+  if (NETCONNTYPE_GROUP(netconn_type(sock->conn)) != NETCONN_TCP) {
+    sock_set_errno(sock, EOPNOTSUPP);
+    done_socket(sock);
+    return -1;
+  }
+
+  write_flags = ((flags & MSG_MORE)     ? NETCONN_MORE      : 0) |
+                ((flags & MSG_DONTWAIT) ? NETCONN_DONTBLOCK : 0);
+  written = 0;
+  err = netconn_write_zerocopy(sock->conn, data, size, write_flags, &written, sent, arg);
+  LWIP_DEBUGF(SOCKETS_DEBUG, (0x0, "lwip_send_zerocopy(%d) err=%d written=%ld\n", s, err, (long int)written));
+  sock_set_errno(sock, err_to_errno(err));
+  done_socket(sock);
+  return (err == ERR_OK ? (ssize_t)written : -1);
+}
+#endif /* LWIP_NETCONN_ZEROCOPY */
+
 ssize_t
 lwip_sendmsg(int s, const struct msghdr *msg, int flags)
 {
@@ -2525,9 +2568,26 @@ lwip_getsockopt_impl(int s, int level, int optname, void *optval, socklen_t *opt
 #if LWIP_SO_RCVBUF
     case SO_RCVBUF:
       LWIP_SOCKOPT_CHECK_OPTLEN_CONN(sock, *optlen, int);
+#if LWIP_TCP
+      if ((NETCONNTYPE_GROUP(netconn_type(sock->conn)) == NETCONN_TCP) &&
+          (sock->conn->pcb.tcp != NULL) && (sock->conn->pcb.tcp->state != LISTEN)) {
+        *(int *)optval = (int)tcp_get_rcvbuf(sock->conn->pcb.tcp);
+        break;
+      }
+#endif /* LWIP_TCP */
       *(int *)optval = netconn_get_recvbufsize(sock->conn);
       break;
 #endif /* LWIP_SO_RCVBUF */
+#if LWIP_TCP
+    case SO_SNDBUF:
+      LWIP_SOCKOPT_CHECK_OPTLEN_CONN_PCB_TYPE(sock, *optlen, int, NETCONN_TCP);
+      if (sock->conn->pcb.tcp->state == LISTEN) {
+        done_socket(sock);
+        return EINVAL;
+      }
+      *(int *)optval = (int)tcp_get_sndbuf(sock->conn->pcb.tcp);
+      break;
+#endif /* LWIP_TCP */
 #if LWIP_SO_LINGER
     case SO_LINGER:
       {
@@ -2903,9 +2963,30 @@ lwip_setsockopt_impl(int s, int level, int optname, const void *optval, socklen_
 #if LWIP_SO_RCVBUF
     case SO_RCVBUF:
       LWIP_SOCKOPT_CHECK_OPTLEN_CONN(sock, optlen, int);
+#if LWIP_TCP
+      if ((NETCONNTYPE_GROUP(netconn_type(sock->conn)) == NETCONN_TCP) &&
+          (sock->conn->pcb.tcp != NULL) && (sock->conn->pcb.tcp->state != LISTEN)) {
+        if (*(const int*)optval < 0) {
+          done_socket(sock);
+          return EINVAL;
+        }
+        /* TCP receive buffer is bounded by the receive window */
+        tcp_set_rcvbuf(sock->conn->pcb.tcp, (u32_t)*(const int*)optval);
+      }
+#endif /* LWIP_TCP */
       netconn_set_recvbufsize(sock->conn, *(const int*)optval);
       break;
 #endif /* LWIP_SO_RCVBUF */
+#if LWIP_TCP
+    case SO_SNDBUF:
+      LWIP_SOCKOPT_CHECK_OPTLEN_CONN_PCB_TYPE(sock, optlen, int, NETCONN_TCP);
+      if ((sock->conn->pcb.tcp->state == LISTEN) || (*(const int*)optval < 0)) {
+        done_socket(sock);
+        return EINVAL;
+      }
+      tcp_set_sndbuf(sock->conn->pcb.tcp, (u32_t)*(const int*)optval);
+      break;
+#endif /* LWIP_TCP */
 #if LWIP_SO_LINGER
     case SO_LINGER:
       {
@@ -273,6 +273,46 @@ tcpip_input(struct pbuf *p, struct netif *inp)
   return tcpip_inpkt(p, inp, ip_input);
 }
 
+/**
+ * @ingroup lwip_os
+ * Pass a burst of received packets to netif->input. With
+ * LWIP_TCPIP_CORE_LOCKING_INPUT, the core lock is taken once for the burst
+ * rather than once for each packet, and when netif->input is tcpip_input,
+ * the packets are passed to ethernet_input or ip_input directly.
+ *
+ * Packets rejected by netif->input are freed here.
+ *
+ * @param p array of received packets
+ * @param count packet count
+ * @param inp the network interface on which the packets were received
+ */
+void
+tcpip_input_batch(struct pbuf **p, u16_t count, struct netif *inp)
+{
+  u16_t i;
+  netif_input_fn input_fn = inp->input;
+
+#if LWIP_TCPIP_CORE_LOCKING_INPUT
+  if (input_fn == tcpip_input) {
+#if LWIP_ETHERNET
+    if (inp->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET)) {
+      input_fn = ethernet_input;
+    } else
+#endif /* LWIP_ETHERNET */
+    input_fn = ip_input;
+  }
+  LOCK_TCPIP_CORE();
+#endif /* LWIP_TCPIP_CORE_LOCKING_INPUT */
+  for (i = 0; i < count; i++) {
+    if (input_fn(p[i], inp) != ERR_OK) {
+      pbuf_free(p[i]);
+    }
+  }
+#if LWIP_TCPIP_CORE_LOCKING_INPUT
+  UNLOCK_TCPIP_CORE();
+#endif /* LWIP_TCPIP_CORE_LOCKING_INPUT */
+}
+
 /**
  * Call a specific function in the thread context of
  * tcpip_thread for easy access synchronization.
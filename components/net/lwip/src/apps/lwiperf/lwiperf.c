@@ -167,11 +167,8 @@ static void lwiperf_tcp_err(void *arg, err_t err);
 static void
 lwiperf_list_add(lwiperf_state_base_t* item)
 {
-  if (lwiperf_all_connections == NULL) {
-    lwiperf_all_connections = item;
-  } else {
-    item = lwiperf_all_connections;
-  }
+  item->next = lwiperf_all_connections;
+  lwiperf_all_connections = item;
 }
 
 /** Remove an iperf session from the 'active' list */
@@ -185,7 +182,7 @@ lwiperf_list_remove(lwiperf_state_base_t* item)
       if (prev == NULL) {
         lwiperf_all_connections = iter->next;
       } else {
-        prev->next = item;
+        prev->next = iter->next;
       }
       /* @debug: ensure this item is listed only once */
       for (iter = iter->next; iter != NULL; iter = iter->next) {
@@ -238,7 +235,7 @@ lwiperf_tcp_close(lwiperf_state_tcp_t* conn, enum lwiperf_report_type report_typ
   } else {
     /* no conn pcb, this is the server pcb */
     err = tcp_close(conn->server_pcb);
-    LWIP_ASSERT("error", err != ERR_OK);
+    LWIP_ASSERT("error", err == ERR_OK);
   }
   LWIPERF_FREE(lwiperf_state_tcp_t, conn);
 }
@@ -639,21 +636,32 @@ lwiperf_start_tcp_server(const ip_addr_t* local_addr, u16_t local_port,
 void
 lwiperf_abort(void* lwiperf_session)
 {
-  lwiperf_state_base_t* i, *dealloc, *last = NULL;
-
-  for (i = lwiperf_all_connections; i != NULL; ) {
-    if ((i == lwiperf_session) || (i->related_server_state == lwiperf_session)) {
-      dealloc = i;
-      i = i->next;
-      if (last != NULL) {
-        last->next = i;
+  lwiperf_state_base_t* i;
+  lwiperf_state_tcp_t* s = (lwiperf_state_tcp_t*)lwiperf_session;
+
+  if (s == NULL) {
+    return;
+  }
+
+  /* close the sessions of this server first, each close removes itself
+     from the list, so search from the head again */
+  do {
+    for (i = lwiperf_all_connections; i != NULL; i = i->next) {
+      if (i->related_server_state == &s->base) {
+        break;
       }
-      LWIPERF_FREE(lwiperf_state_tcp_t, dealloc); /* @todo: type? */
-    } else {
-      last = i;
-      i = i->next;
     }
-  }
+    if (i != NULL) {
+      lwiperf_tcp_close((lwiperf_state_tcp_t*)i, LWIPERF_TCP_ABORTED_LOCAL);
+    }
+  } while (i != NULL);
+
+  /* the listening pcb, there is nothing to report */
+  lwiperf_list_remove(&s->base);
+  tcp_arg(s->server_pcb, NULL);
+  tcp_accept(s->server_pcb, NULL);
+  tcp_close(s->server_pcb);
+  LWIPERF_FREE(lwiperf_state_tcp_t, s);
 }
 
 #endif /* LWIP_IPV4 && LWIP_TCP && LWIP_CALLBACK_API */
@@ -58,6 +58,7 @@
 #include "lwip/altcp_tcp.h"
 #include "lwip/altcp_tls.h"
 #include <string.h>
+#include <stddef.h>
 
 #if LWIP_TCP && LWIP_CALLBACK_API
 
@@ -124,6 +125,9 @@ enum mqtt_connect_flag {
 // MQTT Protocol Version 3: 3.1  4: 3.1.1
 static u8_t s_protocol_level = 4;
 static void mqtt_cyclic_timer(void *arg);
+#if MQTT_OUTPUT_COALESCE_MS > 0
+static void mqtt_output_flush_timer(void *arg);
+#endif
 
 void mqtt_set_protocol_level(u8_t level) 
 {
@@ -236,17 +240,19 @@ mqtt_ringbuf_len(struct mqtt_ringbuf_t *rb)
 
 /**
  * Try send as many bytes as possible from output ring buffer
- * @param rb Output ring buffer
- * @param tpcb TCP connection handle
+ * @param client MQTT client
  */
 static void
-mqtt_output_send(struct mqtt_ringbuf_t *rb, struct altcp_pcb *tpcb)
+mqtt_output_send(mqtt_client_t *client)
 {
   err_t err;
   u8_t wrap = 0;
+  struct mqtt_ringbuf_t *rb = &client->output;
+  struct altcp_pcb *tpcb = client->conn;
   u16_t ringbuf_lin_len = mqtt_ringbuf_linear_read_length(rb);
-  u16_t send_len = altcp_sndbuf(tpcb);
+  u16_t send_len;
   LWIP_ASSERT("mqtt_output_send: tpcb != NULL", tpcb != NULL);
+  send_len = altcp_sndbuf(tpcb);
 
   if (send_len == 0 || ringbuf_lin_len == 0) {
     return;
@@ -264,6 +270,7 @@ mqtt_output_send(struct mqtt_ringbuf_t *rb, struct altcp_pcb *tpcb)
   err = altcp_write(tpcb, mqtt_ringbuf_get_ptr(rb), send_len, TCP_WRITE_FLAG_COPY | (wrap ? TCP_WRITE_FLAG_MORE : 0));
   if ((err == ERR_OK) && wrap) {
     mqtt_ringbuf_advance_get_idx(rb, send_len);
+    client->tx_seq += send_len;
     /* Use the lesser one of ring buffer linear length and TCP send buffer size */
     send_len = LWIP_MIN(altcp_sndbuf(tpcb), mqtt_ringbuf_linear_read_length(rb));
     err = altcp_write(tpcb, mqtt_ringbuf_get_ptr(rb), send_len, TCP_WRITE_FLAG_COPY);
@@ -271,6 +278,7 @@ mqtt_output_send(struct mqtt_ringbuf_t *rb, struct altcp_pcb *tpcb)
 
   if (err == ERR_OK) {
     mqtt_ringbuf_advance_get_idx(rb, send_len);
+    client->tx_seq += send_len;
     /* Flush */
     altcp_output(tpcb);
   } else {
@@ -278,6 +286,86 @@ mqtt_output_send(struct mqtt_ringbuf_t *rb, struct altcp_pcb *tpcb)
   }
 }
 
+/**
+ * Send output ring buffer, or let small messages wait up to MQTT_OUTPUT_COALESCE_MS
+ * so that following messages are sent in the same TCP segment
+ * @param client MQTT client
+ */
+static void
+mqtt_output_send_coalesced(mqtt_client_t *client)
+{
+#if MQTT_OUTPUT_COALESCE_MS > 0
+  if (client->conn_state == MQTT_CONNECTED &&
+      mqtt_ringbuf_len(&client->output) < LWIP_MIN(TCP_MSS, MQTT_OUTPUT_RINGBUF_SIZE / 2)) {
+    if (!client->flush_pending) {
+      client->flush_pending = 1;
+      sys_timeout(MQTT_OUTPUT_COALESCE_MS, mqtt_output_flush_timer, client);
+    }
+    return;
+  }
+#endif
+  mqtt_output_send(client);
+}
+
+#if MQTT_OUTPUT_COALESCE_MS > 0
+/**
+ * Coalescing timer, send what is left in output ring buffer
+ * @param arg MQTT client
+ */
+static void
+mqtt_output_flush_timer(void *arg)
+{
+  mqtt_client_t *client = (mqtt_client_t *)arg;
+  client->flush_pending = 0;
+  if (client->conn_state == MQTT_CONNECTED) {
+    mqtt_output_send(client);
+  }
+}
+#endif
+
+/**
+ * Write message directly to TCP, after everything in output ring buffer.
+ * Message start is copied, payload is referenced until acknowledged by TCP.
+ * @param client MQTT client
+ * @param hdr Message start
+ * @param hdr_len Length of message start
+ * @param payload Payload, NULL if none
+ * @param payload_len Length of payload
+ * @return ERR_OK if written, ERR_MEM if ring buffer can't be sent or TCP send buffer is short
+ */
+static err_t
+mqtt_output_write(mqtt_client_t *client, const u8_t *hdr, u16_t hdr_len, const void *payload, u16_t payload_len)
+{
+  err_t err;
+  u32_t len = (u32_t)hdr_len + payload_len;
+
+  /* Keep message order, ring buffer must be sent before */
+  mqtt_output_send(client);
+  if (mqtt_ringbuf_len(&client->output) > 0 || altcp_sndbuf(client->conn) < len ||
+      altcp_sndqueuelen(client->conn) + 2 + payload_len / TCP_MSS >= TCP_SND_QUEUELEN) {
+    return ERR_MEM;
+  }
+
+  err = altcp_write(client->conn, hdr, hdr_len, TCP_WRITE_FLAG_COPY | (payload_len > 0 ? TCP_WRITE_FLAG_MORE : 0));
+  if (err != ERR_OK) {
+    return err;
+  }
+  client->tx_seq += hdr_len;
+  if (payload_len > 0) {
+    err = altcp_write(client->conn, payload, payload_len, 0);
+    if (err != ERR_OK) {
+      /* Message is truncated in the stream, server will drop it anyway */
+      LWIP_DEBUGF(MQTT_DEBUG_WARN, (0, "mqtt_output_write: Payload write failed with err %d\n", err));
+      altcp_shutdown(client->conn, 0, 1);
+      return err;
+    }
+    client->tx_seq += payload_len;
+    client->tx_ref_end = client->tx_seq;
+  }
+  altcp_output(client->conn);
+  return ERR_OK;
+}
+
 
 
 /*--------------------------------------------------------------------------------------------------------------------- */
@@ -305,6 +393,11 @@ mqtt_create_request(struct mqtt_request_t *r_objs, u16_t pkt_id, mqtt_request_cb
       r->cb = cb;
       r->arg = arg;
       r->pkt_id = pkt_id;
+      r->msg = NULL;
+      r->msg_len = 0;
+      r->payload = NULL;
+      r->payload_len = 0;
+      r->tx_end = 0;
       break;
     }
   }
@@ -350,10 +443,36 @@ static void
 mqtt_delete_request(struct mqtt_request_t *r)
 {
   if (r != NULL) {
+    if (r->msg != NULL) {
+      mem_free(r->msg);
+      r->msg = NULL;
+    }
+    r->payload = NULL;
     r->next = r;
   }
 }
 
+/**
+ * Unchain request item from request queue
+ * @param tail Pointer to request queue tail pointer
+ * @param r Request item to unchain
+ * @param prev Request item before r, NULL if r is first
+ */
+static void
+mqtt_unchain_request(struct mqtt_request_t **tail, struct mqtt_request_t *r, struct mqtt_request_t *prev)
+{
+  if (prev == NULL) {
+    *tail = r->next;
+  } else {
+    prev->next = r->next;
+  }
+  /* If exists, add remaining timeout time for the request to next */
+  if (r->next != NULL) {
+    r->next->timeout_diff += r->timeout_diff;
+  }
+  r->next = NULL;
+}
+
 /**
  * Remove a request item with a specific packet identifier from request queue
  * @param tail Pointer to request queue tail pointer
@@ -375,19 +494,54 @@ mqtt_take_request(struct mqtt_request_t **tail, u16_t pkt_id)
 
   /* If request was found */
   if (iter != NULL) {
-    /* unchain */
-    if (prev == NULL) {
-      *tail= iter->next;
-    } else {
-      prev->next = iter->next;
+    mqtt_unchain_request(tail, iter, prev);
+  }
+  return iter;
+}
+
+/**
+ * Remove a sent QoS 0 publish request from request queue. Request with
+ * zero-copy payload is sent when TCP has acknowledged the whole payload.
+ * @param client MQTT client
+ * @return Request item if found, NULL if not
+ */
+static struct mqtt_request_t *
+mqtt_take_sent_request(mqtt_client_t *client)
+{
+  struct mqtt_request_t *iter, *prev = NULL;
+  for (iter = client->pend_req_queue; iter != NULL; iter = iter->next) {
+    if (iter->pkt_id == 0 &&
+        (iter->payload == NULL || (s32_t)(iter->tx_end - client->tx_acked) <= 0)) {
+      mqtt_unchain_request(&client->pend_req_queue, iter, prev);
+      return iter;
+    }
+    prev = iter;
+  }
+  return NULL;
+}
+
+/**
+ * Check whether a request with zero-copy payload not yet acknowledged by TCP
+ * will time out
+ * @param client MQTT client
+ * @param t Time to elapse in seconds
+ * @return 1 if such request exists, 0 if not
+ */
+static u8_t
+mqtt_request_ref_stalled(mqtt_client_t *client, u8_t t)
+{
+  struct mqtt_request_t *r;
+  u16_t time = 0;
+  for (r = client->pend_req_queue; r != NULL; r = r->next) {
+    time += r->timeout_diff;
+    if (time > t) {
+      break;
     }
-    /* If exists, add remaining timeout time for the request to next */
-    if (iter->next != NULL) {
-      iter->next->timeout_diff += iter->timeout_diff;
+    if (r->payload != NULL && (s32_t)(r->tx_end - client->tx_acked) > 0) {
+      return 1;
     }
-    iter->next = NULL;
   }
-  return iter;
+  return 0;
 }
 
 /**
@@ -421,19 +575,35 @@ mqtt_request_time_elapsed(struct mqtt_request_t **tail, u8_t t)
 }
 
 /**
- * Free all request items
+ * Free all request items. Publish with stored message is moved to keep
+ * queue when given, callback is called with ERR_CLSD for freed request
+ * with zero-copy payload, so that caller can release the payload.
  * @param tail Pointer to request queue tail pointer
+ * @param keep Pointer to queue tail pointer of kept requests, NULL to free all
  */
 static void
-mqtt_clear_requests(struct mqtt_request_t **tail)
+mqtt_clear_requests(struct mqtt_request_t **tail, struct mqtt_request_t **keep)
 {
   struct mqtt_request_t *iter, *next;
   LWIP_ASSERT("mqtt_clear_requests: tail != NULL", tail != NULL);
-  for (iter = *tail; iter != NULL; iter = next) {
+  iter = *tail;
+  /* Callbacks may add new requests, so detach the queue first */
+  *tail = NULL;
+  for (; iter != NULL; iter = next) {
     next = iter->next;
-    mqtt_delete_request(iter);
+    if (keep != NULL && iter->msg != NULL) {
+      iter->next = NULL;
+      while (*keep != NULL) {
+        keep = &(*keep)->next;
+      }
+      *keep = iter;
+    } else {
+      if (iter->payload != NULL && iter->cb != NULL) {
+        iter->cb(iter->arg, ERR_CLSD);
+      }
+      mqtt_delete_request(iter);
+    }
   }
-  *tail = NULL;
 }
 /**
  * Initialize all request items
@@ -534,35 +704,100 @@ mqtt_output_check_space(struct mqtt_ringbuf_t *rb, u16_t r_length)
   return (total_len <= mqtt_ringbuf_free(rb));
 }
 
+/**
+ * Encode PUBLISH message start to linear buffer, which should have room
+ * for topic length + 8 bytes
+ * @param buf Output buffer
+ * @param topic Publish topic
+ * @param topic_len Length of topic
+ * @param pkt_id Packet identifier, only used for QoS 1 and 2
+ * @param qos MQTT QoS field
+ * @param retain MQTT retain flag
+ * @param r_length Remaining length after fixed header
+ * @return Number of bytes encoded
+ */
+static u16_t
+mqtt_encode_publish(u8_t *buf, const char *topic, u16_t topic_len, u16_t pkt_id, u8_t qos, u8_t retain, u16_t r_length)
+{
+  u16_t n = 0;
+  buf[n++] = (u8_t)((MQTT_MSG_TYPE_PUBLISH << 4) | ((qos & 3) << 1) | (retain & 1));
+  do {
+    buf[n++] = (u8_t)((r_length & 0x7f) | (r_length >= 128 ? 0x80 : 0));
+    r_length >>= 7;
+  } while (r_length > 0);
+  buf[n++] = (u8_t)(topic_len >> 8);
+  buf[n++] = (u8_t)(topic_len & 0xff);
+  memcpy(&buf[n], topic, topic_len);
+  n += topic_len;
+  if (qos > 0) {
+    buf[n++] = (u8_t)(pkt_id >> 8);
+    buf[n++] = (u8_t)(pkt_id & 0xff);
+  }
+  return n;
+}
+
+/**
+ * Send publish kept from previous session again, with DUP flag set
+ * @param client MQTT client
+ */
+static void
+mqtt_resend_requests(mqtt_client_t *client)
+{
+  struct mqtt_request_t *r;
+  while ((r = client->resend_queue) != NULL) {
+    r->msg[0] |= 1 << 3;
+    if (mqtt_output_write(client, r->msg, r->msg_len, r->payload, r->payload_len) != ERR_OK) {
+      /* Try again when TCP has sent some data */
+      break;
+    }
+    if (r->payload != NULL) {
+      r->tx_end = client->tx_seq;
+    }
+    client->resend_queue = r->next;
+    r->next = NULL;
+    mqtt_append_request(&client->pend_req_queue, r);
+  }
+}
+
 
 /**
  * Close connection to server
  * @param client MQTT client
  * @param reason Reason for disconnection
+ * @return ERR_ABRT if TCP connection is aborted, ERR_OK otherwise
  */
-static void
+static err_t
 mqtt_close(mqtt_client_t *client, mqtt_connection_status_t reason)
 {
+  err_t ret = ERR_OK;
   LWIP_ASSERT("mqtt_close: client != NULL", client != NULL);
 
   /* Bring down TCP connection if not already done */
   if (client->conn != NULL) {
-    err_t res;
+    err_t res = ERR_ABRT;
     altcp_recv(client->conn, NULL);
     altcp_err(client->conn,  NULL);
     altcp_sent(client->conn, NULL);
-    res = altcp_close(client->conn);
+    /* Zero-copy payload still referenced by TCP must be dropped before it is released */
+    if ((s32_t)(client->tx_ref_end - client->tx_acked) <= 0) {
+      res = altcp_close(client->conn);
+    }
     if (res != ERR_OK) {
       altcp_abort(client->conn);
+      ret = ERR_ABRT;
       LWIP_DEBUGF(MQTT_DEBUG_TRACE,(0x10007739, "mqtt_close: Close err=%d\n", res));
     }
     client->conn = NULL;
   }
 
-  /* Remove all pending requests */
-  mqtt_clear_requests(&client->pend_req_queue);
+  /* Remove all pending requests, publish with stored message is sent again after reconnect */
+  mqtt_clear_requests(&client->pend_req_queue, &client->resend_queue);
   /* Stop cyclic timer */
   sys_untimeout(mqtt_cyclic_timer, client);
+#if MQTT_OUTPUT_COALESCE_MS > 0
+  sys_untimeout(mqtt_output_flush_timer, client);
+  client->flush_pending = 0;
+#endif
 
   /* Notify upper layer of disconnection if changed state */
   if (client->conn_state != TCP_DISCONNECTED) {
@@ -572,6 +807,7 @@ mqtt_close(mqtt_client_t *client, mqtt_connection_status_t reason)
       client->connect_cb(client, client->connect_arg, reason);
     }
   }
+  return ret;
 }
 
 
@@ -594,6 +830,11 @@ mqtt_cyclic_timer(void *arg)
       mqtt_close(client, MQTT_CONNECT_TIMEOUT);
       restart_timer = 0;
     }
+  } else if (client->conn_state == MQTT_CONNECTED && mqtt_request_ref_stalled(client, MQTT_CYCLIC_TIMER_INTERVAL)) {
+    /* Zero-copy payload can't be released while TCP still references it */
+    LWIP_DEBUGF(MQTT_DEBUG_WARN,(0, "mqtt_cyclic_timer: Zero-copy publish not acknowledged by TCP\n"));
+    mqtt_close(client, MQTT_CONNECT_TIMEOUT);
+    restart_timer = 0;
   } else if (client->conn_state == MQTT_CONNECTED) {
     /* Handle timeout for pending requests */
     mqtt_request_time_elapsed(&client->pend_req_queue, MQTT_CYCLIC_TIMER_INTERVAL);
@@ -645,7 +886,7 @@ pub_ack_rec_rel_response(mqtt_client_t *client, u8_t msg, u16_t pkt_id, u8_t qos
   if (mqtt_output_check_space(&client->output, 2)) {
     mqtt_output_append_fixed_header(&client->output, msg, 0, qos, 0, 2);
     mqtt_output_append_u16(&client->output, pkt_id);
-    mqtt_output_send(&client->output, client->conn);
+    mqtt_output_send(client);
   } else {
     LWIP_DEBUGF(MQTT_DEBUG_TRACE,(0x1000773e, "pub_ack_rec_rel_response: OOM creating response: with pkt_id: %d\n",
                                   pkt_id));
@@ -698,6 +939,8 @@ mqtt_message_received(mqtt_client_t *client, u8_t fixed_hdr_idx, u16_t length, u
         /* Reset cyclic_tick when changing to connected state */
         client->cyclic_tick = 0;
         client->conn_state = MQTT_CONNECTED;
+        /* Unacknowledged QoS 1 publish of previous session goes first */
+        mqtt_resend_requests(client);
         /* Notify upper layer */
         if (client->connect_cb != 0) {
           client->connect_cb(client, client->connect_arg, res);
@@ -903,12 +1146,13 @@ static err_t
 mqtt_tcp_recv_cb(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t err)
 {
   mqtt_client_t *client = (mqtt_client_t *)arg;
+  err_t ret = ERR_OK;
   LWIP_ASSERT("mqtt_tcp_recv_cb: client != NULL", client != NULL);
   LWIP_ASSERT("mqtt_tcp_recv_cb: client->conn == pcb", client->conn == pcb);
 
   if (p == NULL) {
     LWIP_DEBUGF(MQTT_DEBUG_TRACE,(0x1000774e, "mqtt_tcp_recv_cb: Recv pbuf=NULL, remote has closed connection\n"));
-    mqtt_close(client, MQTT_CONNECT_DISCONNECTED);
+    ret = mqtt_close(client, MQTT_CONNECT_DISCONNECTED);
   } else {
     mqtt_connection_status_t res;
     if (err != ERR_OK) {
@@ -923,7 +1167,7 @@ mqtt_tcp_recv_cb(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t err)
     pbuf_free(p);
 
     if (res != MQTT_CONNECT_ACCEPTED) {
-      mqtt_close(client, res);
+      ret = mqtt_close(client, res);
     }
     /* If keep alive functionality is used */
     if (client->keep_alive != 0) {
@@ -932,7 +1176,7 @@ mqtt_tcp_recv_cb(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t err)
     }
 
   }
-  return ERR_OK;
+  return ret;
 }
 
 
@@ -949,8 +1193,8 @@ mqtt_tcp_sent_cb(void *arg, struct altcp_pcb *tpcb, u16_t len)
   mqtt_client_t *client = (mqtt_client_t *)arg;
 
   LWIP_UNUSED_ARG(tpcb);
-  LWIP_UNUSED_ARG(len);
 
+  client->tx_acked += len;
   if (client->conn_state == MQTT_CONNECTED) {
     struct mqtt_request_t *r;
 
@@ -958,7 +1202,7 @@ mqtt_tcp_sent_cb(void *arg, struct altcp_pcb *tpcb, u16_t len)
     client->cyclic_tick = 0;
     client->server_watchdog = 0;
     /* QoS 0 publish has no response from server, so call its callbacks here */
-    while ((r = mqtt_take_request(&client->pend_req_queue, 0)) != NULL) {
+    while ((r = mqtt_take_sent_request(client)) != NULL) {
       LWIP_DEBUGF(MQTT_DEBUG_TRACE,(0x10007750, "mqtt_tcp_sent_cb: Calling QoS 0 publish complete callback\n"));
       if (r->cb != NULL) {
         r->cb(r->arg, ERR_OK);
@@ -966,7 +1210,8 @@ mqtt_tcp_sent_cb(void *arg, struct altcp_pcb *tpcb, u16_t len)
       mqtt_delete_request(r);
     }
     /* Try send any remaining buffers from output queue */
-    mqtt_output_send(&client->output, client->conn);
+    mqtt_output_send(client);
+    mqtt_resend_requests(client);
   }
   return ERR_OK;
 }
@@ -998,9 +1243,11 @@ static err_t
 mqtt_tcp_poll_cb(void *arg, struct altcp_pcb *tpcb)
 {
   mqtt_client_t *client = (mqtt_client_t *)arg;
+  LWIP_UNUSED_ARG(tpcb);
   if (client->conn_state == MQTT_CONNECTED) {
     /* Try send any remaining buffers from output queue */
-    mqtt_output_send(&client->output, tpcb);
+    mqtt_output_send(client);
+    mqtt_resend_requests(client);
   }
   return ERR_OK;
 }
@@ -1038,7 +1285,7 @@ mqtt_tcp_connect_cb(void *arg, struct altcp_pcb *tpcb, err_t err)
   client->cyclic_tick = 0;
 
   /* Start transmission from output queue, connect message is the first one out*/
-  mqtt_output_send(&client->output, client->conn);
+  mqtt_output_send(client);
 
   return ERR_OK;
 }
@@ -1103,8 +1350,25 @@ mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_
   }
 
   if (mqtt_output_check_space(&client->output, remaining_length) == 0) {
-    mqtt_delete_request(r);
-    return ERR_MEM;
+    /* Coalesced output may be waiting, send it to make room */
+    mqtt_output_send(client);
+    if (mqtt_output_check_space(&client->output, remaining_length) == 0) {
+      mqtt_delete_request(r);
+      return ERR_MEM;
+    }
+  }
+  if (qos == 1 && client->keep_session) {
+    /* Keep a copy to send again after reconnect */
+    r->msg = (u8_t *)mem_malloc(topic_len + 8 + payload_length);
+    if (r->msg == NULL) {
+      mqtt_delete_request(r);
+      return ERR_MEM;
+    }
+    r->msg_len = mqtt_encode_publish(r->msg, topic, topic_len, pkt_id, qos, retain, remaining_length);
+    if ((payload != NULL) && (payload_length > 0)) {
+      memcpy(r->msg + r->msg_len, payload, payload_length);
+      r->msg_len += payload_length;
+    }
   }
   /* Append fixed header */
   mqtt_output_append_fixed_header(&client->output, MQTT_MSG_TYPE_PUBLISH, qos == 0 ? 0 : dup, qos, retain, remaining_length);
@@ -1123,7 +1387,90 @@ mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_
   }
 
   mqtt_append_request(&client->pend_req_queue, r);
-  mqtt_output_send(&client->output, client->conn);
+  mqtt_output_send_coalesced(client);
+  return ERR_OK;
+}
+
+/**
+ * @ingroup mqtt
+ * MQTT publish function, payload is not copied.
+ * Payload is referenced by TCP until acknowledged, and must be kept unchanged
+ * until the callback is called. For QoS 0 callback is called when TCP has
+ * acknowledged the payload, and for QoS 1 when PUBACK is received. ERR_CLSD is
+ * passed to callback when connection is closed before that. With persistent
+ * session (clean_session is 0), QoS 1 publish is kept over reconnect instead,
+ * and payload is still referenced.
+ * @param client MQTT client
+ * @param topic Publish topic string
+ * @param payload Data to publish (NULL is allowed)
+ * @param payload_length: Length of payload (0 is allowed)
+ * @param qos Quality of service, 0 or 1
+ * @param retain MQTT retain flag
+ * @param cb Callback to call when payload can be released
+ * @param arg User supplied argument to publish callback
+ * @return ERR_OK if successful
+ *         ERR_CONN if client is not connected
+ *         ERR_MEM if short on memory or TCP send buffer, try again after former publish is complete
+ */
+err_t
+mqtt_publish_ref(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos, u8_t retain,
+                 mqtt_request_cb_t cb, void *arg)
+{
+  struct mqtt_request_t *r;
+  u16_t pkt_id = 0;
+  size_t topic_strlen;
+  size_t total_len;
+  u16_t topic_len;
+  u16_t hdr_len;
+  u8_t *hdr;
+  err_t err;
+
+  LWIP_ASSERT("mqtt_publish_ref: client != NULL", client);
+  LWIP_ASSERT("mqtt_publish_ref: topic != NULL", topic);
+  LWIP_ERROR("mqtt_publish_ref: qos < 2", (qos < 2), return ERR_ARG);
+  LWIP_ERROR("mqtt_publish_ref: MQTT disconnected", (client->conn_state == MQTT_CONNECTED), return ERR_CONN);
+
+  topic_strlen = strlen(topic);
+  LWIP_ERROR("mqtt_publish_ref: topic length overflow", (topic_strlen <= (0xFFFF - 2)), return ERR_ARG);
+  topic_len = (u16_t)topic_strlen;
+  total_len = 2 + topic_len + payload_length + (qos > 0 ? 2 : 0);
+  LWIP_ERROR("mqtt_publish_ref: total length overflow", (total_len <= 0xFFFF), return ERR_ARG);
+  if (payload == NULL) {
+    payload_length = 0;
+  }
+
+  if (qos > 0) {
+    pkt_id = msg_generate_packet_id(client);
+  }
+  r = mqtt_create_request(client->req_list, pkt_id, cb, arg);
+  if (r == NULL) {
+    return ERR_MEM;
+  }
+  hdr = (u8_t *)mem_malloc(topic_len + 8);
+  if (hdr == NULL) {
+    mqtt_delete_request(r);
+    return ERR_MEM;
+  }
+  hdr_len = mqtt_encode_publish(hdr, topic, topic_len, pkt_id, qos, retain, (u16_t)total_len);
+
+  err = mqtt_output_write(client, hdr, hdr_len, payload, payload_length);
+  if (err != ERR_OK) {
+    mem_free(hdr);
+    mqtt_delete_request(r);
+    return err;
+  }
+  if (payload_length > 0) {
+    r->payload = payload;
+    r->payload_len = payload_length;
+    r->tx_end = client->tx_seq;
+  }
+  if (qos == 1 && client->keep_session) {
+    r->msg = hdr;
+    r->msg_len = hdr_len;
+  } else {
+    mem_free(hdr);
+  }
+  mqtt_append_request(&client->pend_req_queue, r);
   return ERR_OK;
 }
 
@@ -1190,7 +1537,7 @@ mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos, mqtt_request_
   }
 
   mqtt_append_request(&client->pend_req_queue, r);
-  mqtt_output_send(&client->output, client->conn);
+  mqtt_output_send(client);
   return ERR_OK;
 }
 
@@ -1232,6 +1579,8 @@ mqtt_client_new(void)
 void
 mqtt_client_free(mqtt_client_t *client)
 {
+  /* Drop publish kept for persistent session */
+  mqtt_clear_requests(&client->resend_queue, NULL);
   mem_free(client);
 }
 
@@ -1268,12 +1617,19 @@ mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *ip_addr, u16_t port,
     return ERR_ISCONN;
   }
 
-  /* Wipe clean */
-  memset(client, 0, sizeof(mqtt_client_t));
+  if (client_info->clean_session == 0 && client->resend_queue != NULL) {
+    /* Wipe clean, except publish kept from previous session */
+    memset(client, 0, offsetof(mqtt_client_t, resend_queue));
+  } else {
+    /* Wipe clean */
+    mqtt_clear_requests(&client->resend_queue, NULL);
+    memset(client, 0, sizeof(mqtt_client_t));
+    mqtt_init_requests(client->req_list);
+  }
   client->connect_arg = arg;
   client->connect_cb = cb;
   client->keep_alive = client_info->keep_alive;
-  mqtt_init_requests(client->req_list);
+  client->keep_session = (client_info->clean_session == 0);
 
   /* Build connect message */
   if (client_info->will_topic != NULL && client_info->will_msg != NULL) {
@@ -1412,6 +1768,10 @@ mqtt_disconnect(mqtt_client_t *client)
   LWIP_ASSERT("mqtt_disconnect: client != NULL", client);
   /* If connection in not already closed */
   if (client->conn_state != TCP_DISCONNECTED) {
+    /* Send what is waiting for coalescing */
+    if (client->conn_state == MQTT_CONNECTED) {
+      mqtt_output_send(client);
+    }
     /* Set conn_state before calling mqtt_close to prevent callback from being called */
     client->conn_state = TCP_DISCONNECTED;
     mqtt_close(client, (mqtt_connection_status_t)0);
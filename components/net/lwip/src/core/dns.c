@@ -125,6 +125,11 @@ static u16_t dns_txid;
 #error DNS_MAX_TTL must be a positive 32-bit value
 #endif
 
+/** DNS negative answer (name or address type doesn't exist) TTL in seconds */
+#ifndef DNS_NEG_TTL
+#define DNS_NEG_TTL               60
+#endif
+
 #if DNS_TABLE_SIZE > 255
 #error DNS_TABLE_SIZE must fit into an u8_t
 #endif
@@ -190,6 +195,18 @@ static u16_t dns_txid;
 #define LWIP_DNS_ISMDNS_ARG(x)
 #endif
 
+/** Query both address types in parallel for LWIP_DNS_ADDRTYPE_IPV4_IPV6 and
+ * LWIP_DNS_ADDRTYPE_IPV6_IPV4. The answer of the preferred type is used, and
+ * the other one when the preferred type fails or is late. The requests are
+ * moved between table entries, so NO_MULTIPLE_OUTSTANDING is needed. */
+#ifndef DNS_PARALLEL_QUERIES
+#if LWIP_IPV4 && LWIP_IPV6 && ((LWIP_DNS_SECURE & LWIP_DNS_SECURE_NO_MULTIPLE_OUTSTANDING) != 0)
+#define DNS_PARALLEL_QUERIES      1
+#else
+#define DNS_PARALLEL_QUERIES      0
+#endif
+#endif
+
 /** DNS query message structure.
     No packing needed: only used locally on the stack. */
 struct dns_query {
@@ -219,19 +236,27 @@ typedef enum {
   DNS_STATE_UNUSED           = 0,
   DNS_STATE_NEW              = 1,
   DNS_STATE_ASKING           = 2,
-  DNS_STATE_DONE             = 3
+  DNS_STATE_DONE             = 3,
+  DNS_STATE_NEGATIVE         = 4
 } dns_state_enum_t;
 
 /** DNS table entry */
 struct dns_table_entry {
-  u32_t ttl;
+  /* sys_now() when the answer expires, for DONE and NEGATIVE */
+  u32_t expire;
   ip_addr_t ipaddr[DNS_MAX_ADDR_ANSWER];
+  /* server answered, the entry is only used with the same server */
+  ip_addr_t server;
   u16_t txid;
   u8_t  state;
   u8_t  server_idx;
   u8_t  tmr;
   u8_t  retries;
   u8_t  seqno;
+  /* entry of the parallel query of the other address type */
+  u8_t  pair_idx;
+  /* negative answer is for the name, rather than the address type */
+  u8_t  nxdomain;
 #if ((LWIP_DNS_SECURE & LWIP_DNS_SECURE_RAND_SRC_PORT) != 0)
   u8_t pcb_idx;
 #endif
@@ -311,6 +336,8 @@ static u8_t                   dns_seqno;
 static struct dns_table_entry dns_table[DNS_TABLE_SIZE];
 static struct dns_req_entry   dns_requests[DNS_MAX_REQUESTS];
 static ip_addr_t              dns_servers[DNS_MAX_SERVERS];
+/* server answered last time, new queries start with it */
+static u8_t                   dns_server_pref;
 
 #if LWIP_IPV4
 const ip_addr_t dns_mquery_v4group = DNS_MQUERY_IPV4_GROUP_INIT;
@@ -454,13 +481,83 @@ dns_tmr(void)
   }
 }
 
-void ttl_timer(void *arg) {
-  struct dns_table_entry *entry = (struct dns_table_entry *)arg;
-  if (entry->state == DNS_STATE_DONE) {
-    entry->state = DNS_STATE_UNUSED;
-    entry->ttl = 0;
+/* Check whether the address is one of the configured servers */
+static u8_t
+dns_server_configured(const ip_addr_t *addr)
+{
+  u8_t i;
+
+  for (i = 0; i < DNS_MAX_SERVERS; i++) {
+    if (!ip_addr_isany_val(dns_servers[i]) && ip_addr_cmp(addr, &dns_servers[i])) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Count of configured servers, at least 1 */
+static u8_t
+dns_num_servers(void)
+{
+  u8_t i;
+  u8_t n = 0;
+
+  for (i = 0; i < DNS_MAX_SERVERS; i++) {
+    if (!ip_addr_isany_val(dns_servers[i])) {
+      n++;
+    }
+  }
+  return (n == 0) ? 1 : n;
+}
+
+/* Next configured server after idx, or idx itself when there is no other */
+static u8_t
+dns_next_server(u8_t idx)
+{
+  u8_t i;
+  u8_t n = idx;
+
+  for (i = 1; i < DNS_MAX_SERVERS; i++) {
+    n = (u8_t)((n + 1) % DNS_MAX_SERVERS);
+    if (!ip_addr_isany_val(dns_servers[n])) {
+      return n;
+    }
+  }
+  return idx;
+}
+
+/**
+ * Check whether a completed entry (positive or negative) can be used: its TTL
+ * is not over, and it is answered by one of the configured servers. Entries
+ * of other networks are kept, and are used again after reconnecting to the
+ * same network.
+ */
+static u8_t
+dns_entry_usable(const struct dns_table_entry *entry)
+{
+  if ((entry->state != DNS_STATE_DONE) && (entry->state != DNS_STATE_NEGATIVE)) {
+    return 0;
+  }
+  if ((s32_t)(entry->expire - sys_now()) <= 0) {
+    return 0;
+  }
+#if LWIP_DNS_SUPPORT_MDNS_QUERIES
+  if (entry->is_mdns) {
+    return 1;
   }
+#endif
+  return dns_server_configured(&entry->server);
+}
+
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+/* Remaining TTL in seconds of a completed entry */
+static u32_t
+dns_entry_ttl(const struct dns_table_entry *entry)
+{
+  s32_t left = (s32_t)(entry->expire - sys_now());
+  return (left > 0) ? (u32_t)left / 1000 : 0;
 }
+#endif
 
 #if DNS_LOCAL_HOSTLIST
 static void
@@ -681,7 +778,8 @@ dns_lookup(const char *name, ip_addr_t *addr LWIP_DNS_ADDRTYPE_ARG(u8_t dns_addr
   for (i = 0; i < DNS_TABLE_SIZE; ++i) {
     if ((dns_table[i].state == DNS_STATE_DONE) &&
         (lwip_strnicmp(name, dns_table[i].name, sizeof(dns_table[i].name)) == 0) &&
-        LWIP_DNS_ADDRTYPE_MATCH_IP(dns_addrtype, dns_table[i].ipaddr[0])) {
+        LWIP_DNS_ADDRTYPE_MATCH_IP(dns_addrtype, dns_table[i].ipaddr[0]) &&
+        dns_entry_usable(&dns_table[i])) {
       LWIP_DEBUGF(DNS_DEBUG, (0x1000790f, "dns_lookup: found = "));
       ip_addr_debug_print(DNS_DEBUG, &(dns_table[i].ipaddr[0]));
       LWIP_DEBUGF(DNS_DEBUG, (0x08000161, "\n"));
@@ -718,12 +816,13 @@ dns_lookupall(const char *name, ip_addr_t *addr LWIP_DNS_ADDRTYPE_ARG(u8_t dns_a
   for (i = 0; i < DNS_TABLE_SIZE; ++i) {
     if ((dns_table[i].state == DNS_STATE_DONE) &&
         (lwip_strnicmp(name, dns_table[i].name, sizeof(dns_table[i].name)) == 0) &&
-        LWIP_DNS_ADDRTYPE_MATCH_IP(dns_addrtype, dns_table[i].ipaddr[0])) {
+        LWIP_DNS_ADDRTYPE_MATCH_IP(dns_addrtype, dns_table[i].ipaddr[0]) &&
+        dns_entry_usable(&dns_table[i])) {
       LWIP_DEBUGF(DNS_DEBUG, (0x1000790f, "dns_lookup: found = "));
       ip_addr_debug_print(DNS_DEBUG, &(dns_table[i].ipaddr[0]));
       LWIP_DEBUGF(DNS_DEBUG, (0x08000161, "\n"));
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS	  
-	  *ttl = dns_table[i].ttl;
+	  *ttl = dns_entry_ttl(&dns_table[i]);
 #endif
       if (addr) {
         for(uint8_t j = 0; j < DNS_MAX_ADDR_ANSWER; j++) {
@@ -738,6 +837,50 @@ dns_lookupall(const char *name, ip_addr_t *addr LWIP_DNS_ADDRTYPE_ARG(u8_t dns_a
   return ERR_ARG;
 }
 
+/**
+ * Look up a hostname in the negative answers: the name doesn't exist, or
+ * it has no address of the requested type. For LWIP_DNS_ADDRTYPE_IPV4_IPV6
+ * and LWIP_DNS_ADDRTYPE_IPV6_IPV4, both types should be negative.
+ *
+ * @param name the hostname to look up
+ * @return 1 if the name is known to be unresolvable, 0 otherwise
+ */
+static u8_t
+dns_lookup_negative(const char *name LWIP_DNS_ADDRTYPE_ARG(u8_t dns_addrtype))
+{
+  u8_t i;
+  u8_t neg4 = 0;
+  u8_t neg6 = 0;
+
+  for (i = 0; i < DNS_TABLE_SIZE; ++i) {
+    struct dns_table_entry *entry = &dns_table[i];
+    if ((entry->state == DNS_STATE_NEGATIVE) &&
+        (lwip_strnicmp(name, entry->name, sizeof(entry->name)) == 0) &&
+        dns_entry_usable(entry)) {
+      if (entry->nxdomain) {
+        return 1;
+      }
+      if (LWIP_DNS_ADDRTYPE_IS_IPV6(entry->reqaddrtype)) {
+        neg6 = 1;
+      } else {
+        neg4 = 1;
+      }
+    }
+  }
+
+#if LWIP_IPV4 && LWIP_IPV6
+  if (dns_addrtype == LWIP_DNS_ADDRTYPE_IPV4) {
+    return neg4;
+  }
+  if (dns_addrtype == LWIP_DNS_ADDRTYPE_IPV6) {
+    return neg6;
+  }
+  return (neg4 && neg6);
+#else /* LWIP_IPV4 && LWIP_IPV6 */
+  return (neg4 || neg6);
+#endif /* LWIP_IPV4 && LWIP_IPV6 */
+}
+
 
 /**
  * Compare the "dotted" name "query" with the encoded name "response"
@@ -947,7 +1090,10 @@ dns_send(u8_t idx)
       LWIP_DEBUGF(DNS_DEBUG,(0,"dns_send:begin dns_pcbs[%d]->netif_idx=%d",pcb_idx,dns_pcbs[pcb_idx]->netif_idx));
 #if ((LWIP_DNS_SECURE & LWIP_DNS_SECURE_NO_MULTIPLE_OUTSTANDING) != 0)
       for (requsest_id = 0; requsest_id < DNS_MAX_REQUESTS; requsest_id++) {
-        if (dns_requests[requsest_id].found && (dns_requests[requsest_id].dns_table_idx == idx)) {
+        /* parallel query has no request, use the request of the pair */
+        if (dns_requests[requsest_id].found &&
+            ((dns_requests[requsest_id].dns_table_idx == idx) ||
+             (dns_table[dns_requests[requsest_id].dns_table_idx].pair_idx == idx))) {
           found =1;
           break;
         }
@@ -1184,6 +1330,131 @@ again:
   return txid;
 }
 
+/**
+ * Cache a negative answer of an entry. The address type becomes the one
+ * just queried.
+ *
+ * @param idx dns table index of the entry
+ * @param nxdomain 1 when the name doesn't exist, 0 when there is no address
+ *        of the queried type
+ */
+static void
+dns_cache_negative(u8_t idx, u8_t nxdomain)
+{
+  struct dns_table_entry *entry = &dns_table[idx];
+
+  entry->state = DNS_STATE_NEGATIVE;
+  entry->nxdomain = nxdomain;
+  entry->expire = sys_now() + DNS_NEG_TTL * 1000;
+  ip_addr_copy(entry->server, dns_servers[entry->server_idx]);
+  LWIP_DNS_SET_ADDRTYPE(entry->reqaddrtype, LWIP_DNS_ADDRTYPE_IS_IPV6(entry->reqaddrtype) ?
+                        LWIP_DNS_ADDRTYPE_IPV6 : LWIP_DNS_ADDRTYPE_IPV4);
+}
+
+/**
+ * Resend the query of an entry to the next server at once, when the current
+ * one can't answer.
+ *
+ * @param idx dns table index of the entry
+ * @return 1 if resent, 0 if there is no other server or retries are used up
+ */
+static u8_t
+dns_retry_next_server(u8_t idx)
+{
+  struct dns_table_entry *entry = &dns_table[idx];
+  u8_t next = dns_next_server(entry->server_idx);
+  err_t err;
+
+#if LWIP_DNS_SUPPORT_MDNS_QUERIES
+  if (entry->is_mdns) {
+    return 0;
+  }
+#endif
+  if ((next == entry->server_idx) ||
+      (++entry->retries >= DNS_MAX_RETRIES * dns_num_servers())) {
+    return 0;
+  }
+
+  entry->server_idx = next;
+  entry->tmr = 1;
+  err = dns_send(idx);
+  if (err != ERR_OK) {
+    LWIP_DEBUGF(DNS_DEBUG | LWIP_DBG_LEVEL_WARNING,(0x10007914, "dns_send returned error: %d\n", err));
+  }
+  return 1;
+}
+
+#if DNS_PARALLEL_QUERIES
+/**
+ * State of the parallel query of the other address type, DNS_STATE_UNUSED
+ * if there is none, or the entry is already reused for other name.
+ *
+ * @param idx dns table index of the preferred query
+ */
+static u8_t
+dns_pair_state(u8_t idx)
+{
+  struct dns_table_entry *entry = &dns_table[idx];
+  struct dns_table_entry *pair;
+
+  if (entry->pair_idx >= DNS_TABLE_SIZE) {
+    return DNS_STATE_UNUSED;
+  }
+  pair = &dns_table[entry->pair_idx];
+  if ((pair->state == DNS_STATE_UNUSED) ||
+      (LWIP_DNS_ADDRTYPE_IS_IPV6(pair->reqaddrtype) == LWIP_DNS_ADDRTYPE_IS_IPV6(entry->reqaddrtype)) ||
+      (lwip_strnicmp(entry->name, pair->name, sizeof(pair->name)) != 0)) {
+    entry->pair_idx = DNS_TABLE_SIZE;
+    return DNS_STATE_UNUSED;
+  }
+  return pair->state;
+}
+
+/**
+ * The preferred query failed or is late: move its requests to the parallel
+ * query. They are called now if the parallel query is completed, or when it
+ * completes. The caller should set the state of the preferred entry, and
+ * check dns_pair_state() before.
+ *
+ * @param idx dns table index of the preferred query
+ */
+static void
+dns_pair_takeover(u8_t idx)
+{
+  u8_t j = dns_table[idx].pair_idx;
+  struct dns_table_entry *pair = &dns_table[j];
+  u8_t r;
+
+  dns_table[idx].pair_idx = DNS_TABLE_SIZE;
+  for (r = 0; r < DNS_MAX_REQUESTS; r++) {
+    if (dns_requests[r].found && (dns_requests[r].dns_table_idx == idx)) {
+      dns_requests[r].dns_table_idx = j;
+    }
+  }
+
+  /* no request is left, it just releases the pcb of the preferred query */
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+  dns_call_found(idx, 0, NULL);
+#else
+  dns_call_found(idx, NULL);
+#endif
+
+  if (pair->state == DNS_STATE_DONE) {
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+    dns_call_found(j, dns_entry_ttl(pair), &pair->ipaddr[0]);
+#else
+    dns_call_found(j, &pair->ipaddr[0]);
+#endif
+  } else if (pair->state == DNS_STATE_NEGATIVE) {
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+    dns_call_found(j, 0, NULL);
+#else
+    dns_call_found(j, NULL);
+#endif
+  }
+}
+#endif /* DNS_PARALLEL_QUERIES */
+
 /**
  * dns_check_entry() - see if entry has not yet been queried and, if so, sends out a query.
  * Check an entry in the dns_table:
@@ -1203,11 +1474,10 @@ dns_check_entry(u8_t i)
 
   switch (entry->state) {
     case DNS_STATE_NEW:
-      /* initialize new entry */
-      sys_untimeout(ttl_timer,entry);
+      /* initialize new entry, start with the server answered last time */
       entry->txid = dns_create_txid();
       entry->state = DNS_STATE_ASKING;
-      entry->server_idx = 0;
+      entry->server_idx = ip_addr_isany_val(dns_servers[dns_server_pref]) ? 0 : dns_server_pref;
       entry->tmr = 1;
       entry->retries = 0;
 
@@ -1218,34 +1488,43 @@ dns_check_entry(u8_t i)
       }
       break;
     case DNS_STATE_ASKING:
-      sys_untimeout(ttl_timer,entry);
       if (--entry->tmr == 0) {
-        if (++entry->retries == DNS_MAX_RETRIES) {
-          if ((entry->server_idx + 1 < DNS_MAX_SERVERS) && !ip_addr_isany_val(dns_servers[entry->server_idx + 1])
-#if LWIP_DNS_SUPPORT_MDNS_QUERIES
-            && !entry->is_mdns
-#endif /* LWIP_DNS_SUPPORT_MDNS_QUERIES */
-            ) {
-            /* change of server */
-            entry->server_idx++;
-            entry->tmr = 1;
-            entry->retries = 0;
-          } else {
-            LWIP_DEBUGF(DNS_DEBUG, (0x10007915, "dns_check_entry: timeout\n"));
-            /* call specified callback function if provided */
+#if DNS_PARALLEL_QUERIES
+        if (dns_pair_state(i) == DNS_STATE_DONE) {
+          /* the other address type is resolved, don't wait the preferred one */
+          entry->state = DNS_STATE_UNUSED;
+          dns_pair_takeover(i);
+          break;
+        }
+#endif /* DNS_PARALLEL_QUERIES */
+        if (++entry->retries >= DNS_MAX_RETRIES * dns_num_servers()) {
+          LWIP_DEBUGF(DNS_DEBUG, (0x10007915, "dns_check_entry: timeout\n"));
+          /* flush this entry */
+          entry->state = DNS_STATE_UNUSED;
+#if DNS_PARALLEL_QUERIES
+          if (dns_pair_state(i) != DNS_STATE_UNUSED) {
+            dns_pair_takeover(i);
+            break;
+          }
+#endif /* DNS_PARALLEL_QUERIES */
+          /* call specified callback function if provided */
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
-			dns_call_found(i, 0, NULL);
+          dns_call_found(i, 0, NULL);
 #else
-            dns_call_found(i, NULL);
+          dns_call_found(i, NULL);
 #endif
-            /* flush this entry */
-            entry->state = DNS_STATE_UNUSED;
-            break;
-          }
-        } else {
-          /* wait longer for the next retry */
-          entry->tmr = entry->retries;
+          break;
+        }
+
+#if LWIP_DNS_SUPPORT_MDNS_QUERIES
+        if (!entry->is_mdns)
+#endif /* LWIP_DNS_SUPPORT_MDNS_QUERIES */
+        {
+          /* change of server on each timeout */
+          entry->server_idx = dns_next_server(entry->server_idx);
         }
+        /* wait longer for the next retry, after all servers are tried */
+        entry->tmr = (u8_t)(1 + (entry->retries - 1) / dns_num_servers());
 
         /* send DNS packet for this entry */
         err = dns_send(i);
@@ -1255,8 +1534,9 @@ dns_check_entry(u8_t i)
       }
       break;
     case DNS_STATE_DONE:
-      /* if the time to live is nul */
-      if ((entry->ttl == 0) || (--entry->ttl == 0)) {
+    case DNS_STATE_NEGATIVE:
+      /* if the time to live is over */
+      if ((s32_t)(entry->expire - sys_now()) <= 0) {
         LWIP_DEBUGF(DNS_DEBUG, (0x10007916, "dns_check_entry: flush\n"));
         /* flush this entry, there cannot be any related pending entries in this state */
         entry->state = DNS_STATE_UNUSED;
@@ -1283,7 +1563,7 @@ dns_check_entries(void)
   
   for (i = 0; i < DNS_TABLE_SIZE; ++i) {
     int status = dns_check_entry(i);
-    if (status != DNS_STATE_UNUSED && status != DNS_STATE_DONE)
+    if (status != DNS_STATE_UNUSED && status != DNS_STATE_DONE && status != DNS_STATE_NEGATIVE)
       isEmpty = 0;
   }
   return isEmpty;
@@ -1304,16 +1584,23 @@ dns_correct_response(u8_t idx, u32_t ttl)
   LWIP_DEBUGF(DNS_DEBUG, (0x08000161, "\n"));
 
   /* read the answer resource record's TTL, and maximize it if needed */
-  entry->ttl = ttl;
-  if (entry->ttl > DNS_MAX_TTL) {
-    entry->ttl = DNS_MAX_TTL;
+  if (ttl > DNS_MAX_TTL) {
+    ttl = DNS_MAX_TTL;
+  }
+  entry->expire = sys_now() + ttl * 1000;
+  ip_addr_copy(entry->server, dns_servers[entry->server_idx]);
+#if LWIP_DNS_SUPPORT_MDNS_QUERIES
+  if (!entry->is_mdns)
+#endif
+  {
+    dns_server_pref = entry->server_idx;
   }
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
   dns_call_found(idx, ttl, &entry->ipaddr[0]);
 #else
   dns_call_found(idx, &entry->ipaddr[0]);
 #endif
-  if (entry->ttl == 0) {
+  if (ttl == 0) {
     /* RFC 883, page 29: "Zero values are
        interpreted to mean that the RR can only be used for the
        transaction in progress, and should not be cached."
@@ -1322,9 +1609,6 @@ dns_correct_response(u8_t idx, u32_t ttl)
     if (entry->state == DNS_STATE_DONE) {
       entry->state = DNS_STATE_UNUSED;
     }
-  } else {
-    sys_untimeout(ttl_timer,entry);
-    sys_timeout(entry->ttl*1000,ttl_timer,entry);
   }
 }
 /**
@@ -1339,7 +1623,7 @@ dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
   struct dns_hdr hdr;
   struct dns_answer ans;
   struct dns_query qry;
-  u16_t answer_ttl = 0;
+  u32_t answer_ttl = DNS_MAX_TTL;
   u16_t nquestions, nanswers, naddr;
 
   LWIP_UNUSED_ARG(arg);
@@ -1383,8 +1667,9 @@ dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
 #endif /* LWIP_DNS_SUPPORT_MDNS_QUERIES */
         {
           /* Check whether response comes from the same network address to which the
-             question was sent. (RFC 5452) */
-          if (!ip_addr_cmp(addr, &dns_servers[entry->server_idx])) {
+             question was sent. (RFC 5452) The query may be sent to all servers
+             already, and the late answer of the previous server is accepted. */
+          if (!dns_server_configured(addr)) {
             struct dns_api_msg *msg = (struct dns_api_msg *)dns_requests[i].arg;
             if (msg!=NULL) {
               u16_t simcid = API_EXPR_DEREF(msg->simcid);
@@ -1428,6 +1713,11 @@ dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
         //if (hdr.flags2 & DNS_FLAG2_ERR_MASK) {
         if ((hdr.flags2 & DNS_FLAG2_ERR_MASK) && ((hdr.flags2 & DNS_FLAG2_ERR_MASK) != DNS_FLAG2_ERR_NAME)) {
           LWIP_DEBUGF(DNS_DEBUG, (0x1000791c, "dns_recv: error in flags\n"));
+          /* server failure or refused, ask the next server without waiting */
+          if (dns_retry_next_server(i)) {
+            pbuf_free(p);
+            return;
+          }
         } else {
           while ((nanswers > 0) && (res_idx < p->tot_len) && naddr < DNS_MAX_ADDR_ANSWER) {
             /* skip answer resource record's host name */
@@ -1455,7 +1745,7 @@ dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
                     goto memerr; /* ignore this packet */
                   }
                   ip_addr_copy_from_ip4(dns_table[i].ipaddr[naddr], ip4addr);
-                  answer_ttl = lwip_ntohl(ans.ttl);
+                  answer_ttl = LWIP_MIN(answer_ttl, lwip_ntohl(ans.ttl));
                   ++naddr;
                 }
               }
@@ -1472,7 +1762,7 @@ dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
                     goto memerr; /* ignore this packet */
                   }
                   ip_addr_copy_from_ip6(dns_table[i].ipaddr[naddr], ip6addr);
-                  answer_ttl = lwip_ntohl(ans.ttl);
+                  answer_ttl = LWIP_MIN(answer_ttl, lwip_ntohl(ans.ttl));
                   ++naddr;
                 }
               }
@@ -1495,6 +1785,27 @@ dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
               dns_correct_response(i, answer_ttl);
               return;
           }
+          if ((hdr.flags2 & DNS_FLAG2_ERR_MASK) == DNS_FLAG2_ERR_NAME) {
+            /* the name doesn't exist, for all address types */
+            LWIP_DEBUGF(DNS_DEBUG, (0, "dns_recv: name not exist"));
+            pbuf_free(p);
+            dns_cache_negative(i, 1);
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+            dns_call_found(i, 0, NULL);
+#else
+            dns_call_found(i, NULL);
+#endif
+            return;
+          }
+#if DNS_PARALLEL_QUERIES
+          if (dns_pair_state(i) != DNS_STATE_UNUSED) {
+            /* no address of the preferred type, use the parallel query */
+            pbuf_free(p);
+            dns_cache_negative(i, 0);
+            dns_pair_takeover(i);
+            return;
+          }
+#endif /* DNS_PARALLEL_QUERIES */
 #if LWIP_IPV4 && LWIP_IPV6
           if ((entry->reqaddrtype == LWIP_DNS_ADDRTYPE_IPV4_IPV6) ||
               (entry->reqaddrtype == LWIP_DNS_ADDRTYPE_IPV6_IPV4)) {
@@ -1515,15 +1826,30 @@ dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
           }
 #endif /* LWIP_IPV4 && LWIP_IPV6 */
           LWIP_DEBUGF(DNS_DEBUG, (0x1000791d, "dns_recv: error in response\n"));
+          /* no address of the requested type */
+          pbuf_free(p);
+          dns_cache_negative(i, 0);
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+          dns_call_found(i, 0, NULL);
+#else
+          dns_call_found(i, NULL);
+#endif
+          return;
         }
         /* call callback to indicate error, clean up memory and return */
         pbuf_free(p);
+        dns_table[i].state = DNS_STATE_UNUSED;
+#if DNS_PARALLEL_QUERIES
+        if (dns_pair_state(i) != DNS_STATE_UNUSED) {
+          dns_pair_takeover(i);
+          return;
+        }
+#endif /* DNS_PARALLEL_QUERIES */
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
 		dns_call_found(i, 0, NULL);
 #else
         dns_call_found(i, NULL);
 #endif
-        dns_table[i].state = DNS_STATE_UNUSED;
         return;
       }
     }
@@ -1535,6 +1861,95 @@ memerr:
   return;
 }
 
+/**
+ * Find a table entry for a new query: an unused one, one not usable any more,
+ * or the oldest completed one.
+ *
+ * @return index of the entry, or DNS_TABLE_SIZE if the table is full
+ */
+static u8_t
+dns_alloc_entry(void)
+{
+  u8_t i;
+  u8_t lseq = 0;
+  u8_t lseqi = DNS_TABLE_SIZE;
+
+  for (i = 0; i < DNS_TABLE_SIZE; ++i) {
+    struct dns_table_entry *entry = &dns_table[i];
+    /* is it an unused entry ? */
+    if (entry->state == DNS_STATE_UNUSED) {
+      return i;
+    }
+    /* check if this is the oldest completed entry */
+    if ((entry->state == DNS_STATE_DONE) || (entry->state == DNS_STATE_NEGATIVE)) {
+      u8_t age = dns_seqno - entry->seqno;
+      if (!dns_entry_usable(entry)) {
+        return i;
+      }
+      if (age > lseq) {
+        lseq = age;
+        lseqi = i;
+      }
+    }
+  }
+  return lseqi;
+}
+
+#if DNS_PARALLEL_QUERIES
+/**
+ * Start the query of the other address type in parallel with the preferred
+ * one. An outstanding query of the same name and type is shared.
+ *
+ * @param idx dns table index of the preferred query
+ */
+static void
+dns_enqueue_pair(u8_t idx)
+{
+  struct dns_table_entry *entry = &dns_table[idx];
+  struct dns_table_entry *pair;
+  u8_t pairtype;
+  u8_t j;
+
+  pairtype = (entry->reqaddrtype == LWIP_DNS_ADDRTYPE_IPV4_IPV6) ?
+             LWIP_DNS_ADDRTYPE_IPV6 : LWIP_DNS_ADDRTYPE_IPV4;
+  for (j = 0; j < DNS_TABLE_SIZE; j++) {
+    pair = &dns_table[j];
+    if ((pair->state == DNS_STATE_ASKING) && (pair->reqaddrtype == pairtype) &&
+        (lwip_strnicmp(entry->name, pair->name, sizeof(pair->name)) == 0)) {
+      entry->pair_idx = j;
+      return;
+    }
+  }
+
+  /* it is fine to fallback to sequential queries without free entry */
+  j = dns_alloc_entry();
+  if (j >= DNS_TABLE_SIZE) {
+    return;
+  }
+
+  pair = &dns_table[j];
+  pair->state = DNS_STATE_NEW;
+  pair->seqno = dns_seqno;
+  pair->reqaddrtype = pairtype;
+  pair->pair_idx = DNS_TABLE_SIZE;
+  MEMCPY(pair->name, entry->name, sizeof(pair->name));
+#if LWIP_DNS_SUPPORT_MDNS_QUERIES
+  pair->is_mdns = entry->is_mdns;
+#endif
+#if ((LWIP_DNS_SECURE & LWIP_DNS_SECURE_RAND_SRC_PORT) != 0)
+  pair->pcb_idx = dns_alloc_pcb();
+  if (pair->pcb_idx >= DNS_MAX_SOURCE_PORTS) {
+    pair->state = DNS_STATE_UNUSED;
+    return;
+  }
+#endif
+  LWIP_DEBUGF(DNS_DEBUG, (0, "dns_enqueue: use DNS entry %hu for parallel query\n", (u16_t)(j)));
+
+  entry->pair_idx = j;
+  dns_check_entry(j);
+}
+#endif /* DNS_PARALLEL_QUERIES */
+
 /**
  * Queues a new hostname to resolve and sends out a DNS query for that hostname
  *
@@ -1555,7 +1970,6 @@ dns_enqueue(const char *name, size_t hostnamelen, dns_found_callback found,
 #endif            
 {
   u8_t i;
-  u8_t lseq, lseqi;
   struct dns_table_entry *entry = NULL;
   size_t namelen;
   struct dns_req_entry* req;
@@ -1595,36 +2009,13 @@ dns_enqueue(const char *name, size_t hostnamelen, dns_found_callback found,
 #endif
 
   /* search an unused entry, or the oldest one */
-  lseq = 0;
-  lseqi = DNS_TABLE_SIZE;
-  for (i = 0; i < DNS_TABLE_SIZE; ++i) {
-    entry = &dns_table[i];
-    /* is it an unused entry ? */
-    if (entry->state == DNS_STATE_UNUSED) {
-      break;
-    }
-    /* check if this is the oldest completed entry */
-    if (entry->state == DNS_STATE_DONE) {
-      u8_t age = dns_seqno - entry->seqno;
-      if (age > lseq) {
-        lseq = age;
-        lseqi = i;
-      }
-    }
-  }
-
-  /* if we don't have found an unused entry, use the oldest completed one */
-  if (i == DNS_TABLE_SIZE) {
-    if ((lseqi >= DNS_TABLE_SIZE) || (dns_table[lseqi].state != DNS_STATE_DONE)) {
-      /* no entry can be used now, table is full */
-      LWIP_DEBUGF(DNS_DEBUG, (0x1000791f, "dns_enqueue: DNS entries table is full\n"));
-      return ERR_MEM;
-    } else {
-      /* use the oldest completed one */
-      i = lseqi;
-      entry = &dns_table[i];
-    }
+  i = dns_alloc_entry();
+  if (i >= DNS_TABLE_SIZE) {
+    /* no entry can be used now, table is full */
+    LWIP_DEBUGF(DNS_DEBUG, (0x1000791f, "dns_enqueue: DNS entries table is full\n"));
+    return ERR_MEM;
   }
+  entry = &dns_table[i];
 
 #if ((LWIP_DNS_SECURE & LWIP_DNS_SECURE_NO_MULTIPLE_OUTSTANDING) != 0)
   /* find a free request entry */
@@ -1652,6 +2043,7 @@ dns_enqueue(const char *name, size_t hostnamelen, dns_found_callback found,
   /* fill the entry */
   entry->state = DNS_STATE_NEW;
   entry->seqno = dns_seqno;
+  entry->pair_idx = DNS_TABLE_SIZE;
   LWIP_DNS_SET_ADDRTYPE(entry->reqaddrtype, dns_addrtype);
   LWIP_DNS_SET_ADDRTYPE(req->reqaddrtype, dns_addrtype);
   req->found = found;
@@ -1682,9 +2074,16 @@ dns_enqueue(const char *name, size_t hostnamelen, dns_found_callback found,
   dns_seqno++;
 
   /* force to send query without waiting timer */
-  if (dns_check_entry(i) != DNS_STATE_UNUSED && timer_stoped) {
-	  timer_stoped = 0;
-	  sys_timeout(DNS_TMR_INTERVAL, cyclic_timer, LWIP_CONST_CAST(void*, &lwip_cyclic_timers[DNS_TMR]));
+  if (dns_check_entry(i) != DNS_STATE_UNUSED) {
+#if DNS_PARALLEL_QUERIES
+    if ((dns_addrtype == LWIP_DNS_ADDRTYPE_IPV4_IPV6) || (dns_addrtype == LWIP_DNS_ADDRTYPE_IPV6_IPV4)) {
+      dns_enqueue_pair(i);
+    }
+#endif /* DNS_PARALLEL_QUERIES */
+    if (timer_stoped) {
+      timer_stoped = 0;
+      sys_timeout(DNS_TMR_INTERVAL, cyclic_timer, LWIP_CONST_CAST(void*, &lwip_cyclic_timers[DNS_TMR]));
+    }
   }
 
   /* dns query is enqueued */
@@ -1788,6 +2187,10 @@ dns_gethostbyname_addrtype(const char *hostname, ip_addr_t *addr, dns_found_call
       return ERR_LOCAL_OK;
     }
   }
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+  /* servers of the PDP are needed to check the cached entries */
+  dns_server_configure(simcid & 0x00ff, (simcid &0xff00)>>8);
+#endif
   /* already have this address cached? */
   if (dns_lookup(hostname, addr LWIP_DNS_ADDRTYPE_ARG(dns_addrtype)) == ERR_OK) {
     LWIP_DEBUGF(DNS_DEBUG, (0,"hostname has cached"));
@@ -1810,9 +2213,18 @@ dns_gethostbyname_addrtype(const char *hostname, ip_addr_t *addr, dns_found_call
 #else /* LWIP_IPV4 && LWIP_IPV6 */
   LWIP_UNUSED_ARG(dns_addrtype);
 #endif /* LWIP_IPV4 && LWIP_IPV6 */
+  /* known to be unresolvable, fail at once like a failed query */
+  if (dns_lookup_negative(hostname LWIP_DNS_ADDRTYPE_ARG(dns_addrtype))) {
+    LWIP_DEBUGF(DNS_DEBUG, (0,"hostname has negative cache"));
+    if (found != NULL) {
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
-  dns_server_configure(simcid & 0x00ff, (simcid &0xff00)>>8);
+      found(hostname, 0, NULL, callback_arg);
+#else
+      found(hostname, NULL, callback_arg);
 #endif
+    }
+    return ERR_INPROGRESS;
+  }
 #if LWIP_DNS_SUPPORT_MDNS_QUERIES
   if (strstr(hostname, ".local") == &hostname[hostnamelen] - 6) {
     is_mdns = 1;
@@ -1899,6 +2311,10 @@ dns_getallhostbyname_addrtype(const char *hostname, ip_addr_t *addr, dns_found_c
       return ERR_LOCAL_OK;
     }
   }
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
+  /* servers of the PDP are needed to check the cached entries */
+  dns_server_configure(simcid & 0x00ff, (simcid &0xff00)>>8);
+#endif
   /* already have this address cached? */
  #ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
  if (dns_lookupall(hostname, ttl, addr LWIP_DNS_ADDRTYPE_ARG(dns_addrtype)) == ERR_OK)
@@ -1932,9 +2348,18 @@ dns_getallhostbyname_addrtype(const char *hostname, ip_addr_t *addr, dns_found_c
   LWIP_UNUSED_ARG(dns_addrtype);
 #endif /* LWIP_IPV4 && LWIP_IPV6 */
 
+  /* known to be unresolvable, fail at once like a failed query */
+  if (dns_lookup_negative(hostname LWIP_DNS_ADDRTYPE_ARG(dns_addrtype))) {
+    LWIP_DEBUGF(DNS_DEBUG, (0,"hostname has negative cache"));
+    if (found != NULL) {
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_DNS
-  dns_server_configure(simcid & 0x00ff, (simcid &0xff00)>>8);
+      found(hostname, 0, NULL, callback_arg);
+#else
+      found(hostname, NULL, callback_arg);
 #endif
+    }
+    return ERR_INPROGRESS;
+  }
 
 #if LWIP_DNS_SUPPORT_MDNS_QUERIES
   if (strstr(hostname, ".local") == &hostname[hostnamelen] - 6) {
@@ -1964,6 +2389,11 @@ dns_getallhostbyname_addrtype(const char *hostname, ip_addr_t *addr, dns_found_c
 #endif
 }
 
+/**
+ * Flush the cached entries which can't be used any more. Entries answered
+ * by the configured servers are kept, so the cache survives reconnecting to
+ * the same network. Entries of other networks are checked at lookup also.
+ */
 void
 dns_clean_entries(void)
 {
@@ -1971,7 +2401,8 @@ dns_clean_entries(void)
 
   for (i = 0; i < DNS_TABLE_SIZE; ++i) {
     struct dns_table_entry *entry = &dns_table[i];
-    if (entry->state == DNS_STATE_DONE) {
+    if (((entry->state == DNS_STATE_DONE) || (entry->state == DNS_STATE_NEGATIVE)) &&
+        !dns_entry_usable(entry)) {
         entry->state = DNS_STATE_UNUSED;
     }
   }
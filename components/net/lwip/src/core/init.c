@@ -147,11 +147,23 @@ PACK_STRUCT_END
 #if (LWIP_TCP && ((TCP_WND >> TCP_RCV_SCALE) == 0))
   #error "TCP_WND is too small for the configured LWIP_WND_SCALE (results in zero window)!"
 #endif
+#if (LWIP_TCP && TCP_WND_AUTOTUNE && (TCP_WND_AUTOTUNE_MAX > (0xFFFFU << TCP_RCV_SCALE)))
+  #error "TCP_WND_AUTOTUNE_MAX is bigger than the configured LWIP_WND_SCALE allows!"
+#endif
 #else /* LWIP_WND_SCALE */
 #if (LWIP_TCP && (TCP_WND > 0xffff))
   #error "If you want to use TCP, TCP_WND must fit in an u16_t, so, you have to reduce it in your lwipopts.h (or enable window scaling)"
 #endif
+#if (LWIP_TCP && TCP_WND_AUTOTUNE)
+  #error "TCP_WND_AUTOTUNE requires LWIP_WND_SCALE"
+#endif
 #endif /* LWIP_WND_SCALE */
+#if (LWIP_NETCONN_ZEROCOPY && !LWIP_SO_LINGER)
+  #error "LWIP_NETCONN_ZEROCOPY requires LWIP_SO_LINGER"
+#endif
+#if (LWIP_TCP && (TCP_SND_BUF_MAX < TCP_SND_BUF))
+  #error "TCP_SND_BUF_MAX must be at least TCP_SND_BUF"
+#endif
 #if (LWIP_TCP && (TCP_SND_QUEUELEN > 0xffff))
   #error "If you want to use TCP, TCP_SND_QUEUELEN must fit in an u16_t, so, you have to reduce it in your lwipopts.h"
 #endif
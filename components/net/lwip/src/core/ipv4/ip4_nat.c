@@ -117,7 +117,6 @@
 #define NAT_DEBUG      LWIP_DBG_OFF
 #endif
 
-#define LWIP_NAT_TTL_INFINITE                    (INT_MAX)
 #define LWIP_NAT_DEFAULT_TTL_SECONDS             (128)
 #define LWIP_NAT_FORWARD_HEADER_SIZE_MIN         (sizeof(struct eth_hdr))
 
@@ -128,9 +127,11 @@
 #define LWIP_NAT_DEFAULT_TCP_SOURCE_PORT         (20000)
 #define LWIP_NAT_DEFAULT_UDP_SOURCE_PORT         (40000)
 
-#define IPNAT_ENTRY_RESET(x) do { \
-  (x)->ttl = 0; \
-} while(0)
+#define LWIP_NAT_HASH_BUCKETS_ICMP               (32)
+#define LWIP_NAT_HASH_BUCKETS_TCP                (256)
+#define LWIP_NAT_HASH_BUCKETS_UDP                (256)
+
+#define LWIP_NAT_INDEX_NONE                      (0xffff)
 
 typedef struct ip4_nat_conf
 {
@@ -140,10 +141,14 @@ typedef struct ip4_nat_conf
 
 typedef struct ip4_nat_entry_common
 {
-  s32_t           ttl; /* @todo: do we really need this to be signed?? */
+  u32_t           expire; /* ip4_nat_now when the entry expires, 0 for free entry */
   ip4_addr_t       source;
   ip4_addr_t       dest;
   ip4_nat_conf_t   *cfg;
+  u16_t           hnext;    /* next entry in the same hash bucket */
+  u16_t           hbucket;  /* hash bucket of the entry */
+  u16_t           lru_prev; /* previous entry in LRU list */
+  u16_t           lru_next; /* next entry in LRU list, or in free list */
 } ip4_nat_entry_common_t;
 
 typedef struct ip4_nat_entries_icmp
@@ -177,12 +182,49 @@ typedef union u_nat_entry
   ip4_nat_entries_udp_t  *udp;
 } nat_entry_t;
 
+/** State table of one protocol.
+ *
+ * Entries in use are linked in hash buckets, and in a LRU list with the
+ * least recently used entry at head. All entries share the same ttl, so
+ * the LRU list is also sorted by expire time, and the timer only needs
+ * to check the head. Free entries are linked in free list by 'lru_next'.
+ */
+typedef struct ip4_nat_table
+{
+  u8_t           *entries;
+  u16_t           entry_size;
+  u16_t           size;
+  u16_t          *buckets;
+  u16_t           bucket_mask;
+  u16_t           free_head;
+  u16_t           free_tail;
+  u16_t           lru_head;
+  u16_t           lru_tail;
+} ip4_nat_table_t;
+
 static uint32_t sNATCfg = 0;
 
 static ip4_nat_conf_t *ip4_nat_cfg = NULL;
+static u32_t ip4_nat_now = 0;
 static ip4_nat_entries_icmp_t ip4_nat_icmp_table[LWIP_NAT_DEFAULT_STATE_TABLES_ICMP];
 static ip4_nat_entries_tcp_t ip4_nat_tcp_table[LWIP_NAT_DEFAULT_STATE_TABLES_TCP];
 static ip4_nat_entries_udp_t ip4_nat_udp_table[LWIP_NAT_DEFAULT_STATE_TABLES_UDP];
+static u16_t ip4_nat_icmp_buckets[LWIP_NAT_HASH_BUCKETS_ICMP];
+static u16_t ip4_nat_tcp_buckets[LWIP_NAT_HASH_BUCKETS_TCP];
+static u16_t ip4_nat_udp_buckets[LWIP_NAT_HASH_BUCKETS_UDP];
+
+static ip4_nat_table_t ip4_nat_icmp_states = {
+  (u8_t *)ip4_nat_icmp_table, sizeof(ip4_nat_entries_icmp_t), LWIP_NAT_DEFAULT_STATE_TABLES_ICMP,
+  ip4_nat_icmp_buckets, LWIP_NAT_HASH_BUCKETS_ICMP - 1,
+};
+static ip4_nat_table_t ip4_nat_tcp_states = {
+  (u8_t *)ip4_nat_tcp_table, sizeof(ip4_nat_entries_tcp_t), LWIP_NAT_DEFAULT_STATE_TABLES_TCP,
+  ip4_nat_tcp_buckets, LWIP_NAT_HASH_BUCKETS_TCP - 1,
+};
+static ip4_nat_table_t ip4_nat_udp_states = {
+  (u8_t *)ip4_nat_udp_table, sizeof(ip4_nat_entries_udp_t), LWIP_NAT_DEFAULT_STATE_TABLES_UDP,
+  ip4_nat_udp_buckets, LWIP_NAT_HASH_BUCKETS_UDP - 1,
+};
 
 /* ----------------------- Static functions (COMMON) --------------------*/
 static void     ip4_nat_chksum_adjust(u8_t *chksum, const u8_t *optr, s16_t olen, const u8_t *nptr, s16_t nlen);
@@ -242,6 +284,187 @@ bool get_nat_enabled(uint8_t nSimId, uint8_t nCid)
     return false;
 }
 
+/** Get the state table entry at index */
+static ip4_nat_entry_common_t *
+ip4_nat_entry_at(const ip4_nat_table_t *t, u16_t idx)
+{
+  return (ip4_nat_entry_common_t *)(t->entries + (size_t)idx * t->entry_size);
+}
+
+/** Get the index of state table entry */
+static u16_t
+ip4_nat_entry_index(const ip4_nat_table_t *t, const ip4_nat_entry_common_t *nat_entry)
+{
+  return (u16_t)(((const u8_t *)nat_entry - t->entries) / t->entry_size);
+}
+
+/** Hash bucket of state table key */
+static u16_t
+ip4_nat_hash(const ip4_nat_table_t *t, u32_t a, u32_t b, u32_t c)
+{
+  u32_t h = a ^ (b * 0x9e3779b1UL) ^ (c * 0x85ebca77UL);
+  h ^= h >> 16;
+  h *= 0x7feb352dUL;
+  h ^= h >> 15;
+  return (u16_t)(h & t->bucket_mask);
+}
+
+/** Initialize a state table, and put all entries into free list */
+static void
+ip4_nat_table_init(ip4_nat_table_t *t)
+{
+  u16_t i;
+
+  for (i = 0; i <= t->bucket_mask; i++) {
+    t->buckets[i] = LWIP_NAT_INDEX_NONE;
+  }
+  for (i = 0; i < t->size; i++) {
+    ip4_nat_entry_common_t *nat_entry = ip4_nat_entry_at(t, i);
+    nat_entry->expire = 0;
+    nat_entry->hnext = LWIP_NAT_INDEX_NONE;
+    nat_entry->lru_prev = LWIP_NAT_INDEX_NONE;
+    nat_entry->lru_next = (i + 1 < t->size) ? (u16_t)(i + 1) : LWIP_NAT_INDEX_NONE;
+  }
+  t->free_head = 0;
+  t->free_tail = t->size - 1;
+  t->lru_head = LWIP_NAT_INDEX_NONE;
+  t->lru_tail = LWIP_NAT_INDEX_NONE;
+}
+
+/** Append an entry to the tail of LRU list */
+static void
+ip4_nat_lru_append(ip4_nat_table_t *t, ip4_nat_entry_common_t *nat_entry, u16_t idx)
+{
+  nat_entry->lru_prev = t->lru_tail;
+  nat_entry->lru_next = LWIP_NAT_INDEX_NONE;
+  if (t->lru_tail == LWIP_NAT_INDEX_NONE) {
+    t->lru_head = idx;
+  } else {
+    ip4_nat_entry_at(t, t->lru_tail)->lru_next = idx;
+  }
+  t->lru_tail = idx;
+}
+
+/** Remove an entry from LRU list */
+static void
+ip4_nat_lru_unlink(ip4_nat_table_t *t, ip4_nat_entry_common_t *nat_entry)
+{
+  if (nat_entry->lru_prev == LWIP_NAT_INDEX_NONE) {
+    t->lru_head = nat_entry->lru_next;
+  } else {
+    ip4_nat_entry_at(t, nat_entry->lru_prev)->lru_next = nat_entry->lru_next;
+  }
+  if (nat_entry->lru_next == LWIP_NAT_INDEX_NONE) {
+    t->lru_tail = nat_entry->lru_prev;
+  } else {
+    ip4_nat_entry_at(t, nat_entry->lru_next)->lru_prev = nat_entry->lru_prev;
+  }
+}
+
+/** Allocate an entry from free list, initialize the common parts and
+ * link it to hash bucket and the tail of LRU list.
+ *
+ * @param t state table
+ * @param nat_config NAT config entry
+ * @param iphdr IP header from which to initialize the entry
+ * @param bucket hash bucket of the entry
+ * @return the allocated entry, or NULL if the table is full
+ */
+static ip4_nat_entry_common_t *
+ip4_nat_entry_alloc(ip4_nat_table_t *t, ip4_nat_conf_t *nat_config,
+                    const struct ip_hdr *iphdr, u16_t bucket)
+{
+  u16_t idx = t->free_head;
+  ip4_nat_entry_common_t *nat_entry;
+
+  if (idx == LWIP_NAT_INDEX_NONE) {
+    return NULL;
+  }
+  nat_entry = ip4_nat_entry_at(t, idx);
+  t->free_head = nat_entry->lru_next;
+  if (t->free_head == LWIP_NAT_INDEX_NONE) {
+    t->free_tail = LWIP_NAT_INDEX_NONE;
+  }
+
+  ip4_nat_cmn_init(nat_config, iphdr, nat_entry);
+  nat_entry->hbucket = bucket;
+  nat_entry->hnext = t->buckets[bucket];
+  t->buckets[bucket] = idx;
+  ip4_nat_lru_append(t, nat_entry, idx);
+  return nat_entry;
+}
+
+/** Reset ttl of an entry, and move it to the tail of LRU list */
+static void
+ip4_nat_entry_refresh(ip4_nat_table_t *t, ip4_nat_entry_common_t *nat_entry)
+{
+  u16_t idx = ip4_nat_entry_index(t, nat_entry);
+
+  nat_entry->expire = ip4_nat_now + LWIP_NAT_DEFAULT_TTL_SECONDS;
+  if (t->lru_tail != idx) {
+    ip4_nat_lru_unlink(t, nat_entry);
+    ip4_nat_lru_append(t, nat_entry, idx);
+  }
+}
+
+/** Remove an entry from hash bucket and LRU list, and put it at the tail
+ * of free list. So the NAT port of the entry is reused as late as possible.
+ */
+static void
+ip4_nat_entry_free(ip4_nat_table_t *t, ip4_nat_entry_common_t *nat_entry)
+{
+  u16_t idx = ip4_nat_entry_index(t, nat_entry);
+  u16_t *pidx = &t->buckets[nat_entry->hbucket];
+
+  while (*pidx != LWIP_NAT_INDEX_NONE) {
+    if (*pidx == idx) {
+      *pidx = nat_entry->hnext;
+      break;
+    }
+    pidx = &ip4_nat_entry_at(t, *pidx)->hnext;
+  }
+  ip4_nat_lru_unlink(t, nat_entry);
+
+  nat_entry->expire = 0;
+  nat_entry->hnext = LWIP_NAT_INDEX_NONE;
+  nat_entry->lru_prev = LWIP_NAT_INDEX_NONE;
+  nat_entry->lru_next = LWIP_NAT_INDEX_NONE;
+  if (t->free_tail == LWIP_NAT_INDEX_NONE) {
+    t->free_head = idx;
+  } else {
+    ip4_nat_entry_at(t, t->free_tail)->lru_next = idx;
+  }
+  t->free_tail = idx;
+}
+
+/** Free expired entries from the head of LRU list */
+static void
+ip4_nat_table_expire(ip4_nat_table_t *t)
+{
+  while (t->lru_head != LWIP_NAT_INDEX_NONE) {
+    ip4_nat_entry_common_t *nat_entry = ip4_nat_entry_at(t, t->lru_head);
+    if (nat_entry->expire > ip4_nat_now) {
+      break;
+    }
+    ip4_nat_entry_free(t, nat_entry);
+  }
+}
+
+/** Free all entries of a NAT config entry */
+static void
+ip4_nat_table_reset(ip4_nat_table_t *t, const ip4_nat_conf_t *cfg)
+{
+  u16_t idx = t->lru_head;
+
+  while (idx != LWIP_NAT_INDEX_NONE) {
+    ip4_nat_entry_common_t *nat_entry = ip4_nat_entry_at(t, idx);
+    idx = nat_entry->lru_next;
+    if (nat_entry->cfg == cfg) {
+      ip4_nat_entry_free(t, nat_entry);
+    }
+  }
+}
+
 /**
  * Timer callback function that calls ip4_nat_tmr() and reschedules itself.
  *
@@ -261,20 +484,11 @@ nat_timer(void *arg)
 void
 ip4_nat_init(void)
 {
-  int i;
   SYS_ARCH_DECL_PROTECT(lev);
 
-  /* @todo: this can be omitted since we trust static variables
-            to be initialized to zero */
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_ICMP; i++) {
-    IPNAT_ENTRY_RESET(&ip4_nat_icmp_table[i].common);
-  }
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_TCP; i++) {
-    IPNAT_ENTRY_RESET(&ip4_nat_tcp_table[i].common);
-  }
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_UDP; i++) {
-    IPNAT_ENTRY_RESET(&ip4_nat_udp_table[i].common);
-  }
+  ip4_nat_table_init(&ip4_nat_icmp_states);
+  ip4_nat_table_init(&ip4_nat_tcp_states);
+  ip4_nat_table_init(&ip4_nat_udp_states);
 
   /* we must lock scheduler to protect following code */
   SYS_ARCH_PROTECT(lev);
@@ -378,32 +592,16 @@ ip4_nat_remove(const ip4_nat_entry_t *remove_entry)
 }
 
 /** Reset a NAT configured entry to be reused.
- * Effectively calls IPNAT_ENTRY_RESET() on 'cfg'.
+ * Frees all state table entries of 'cfg'.
  *
  * @param cfg NAT entry to reset
  */
 static void
 ip4_nat_reset_state(ip4_nat_conf_t *cfg)
 {
-  int i;
-
-  /* @todo: optimize this!!!
-     why do we search for it anyway, if we have the pointer??? */
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_ICMP; i++) {
-    if(ip4_nat_icmp_table[i].common.cfg == cfg) {
-      IPNAT_ENTRY_RESET(&ip4_nat_icmp_table[i].common);
-    }
-  }
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_TCP; i++) {
-    if(ip4_nat_tcp_table[i].common.cfg == cfg) {
-      IPNAT_ENTRY_RESET(&ip4_nat_tcp_table[i].common);
-    }
-  }
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_UDP; i++) {
-    if(ip4_nat_udp_table[i].common.cfg == cfg) {
-      IPNAT_ENTRY_RESET(&ip4_nat_udp_table[i].common);
-    }
-  }
+  ip4_nat_table_reset(&ip4_nat_icmp_states, cfg);
+  ip4_nat_table_reset(&ip4_nat_tcp_states, cfg);
+  ip4_nat_table_reset(&ip4_nat_udp_states, cfg);
 }
 
 /** Check if this packet should be routed or should be translated
@@ -493,7 +691,7 @@ ip4_nat_input(struct pbuf *p)
   nat_entry_t           nat_entry;
   err_t                 err;
   u8_t                  consumed = 0;
-  int                   i;
+  u16_t                 i;
   struct pbuf          *q = NULL;
 
   nat_entry.cmn = NULL;
@@ -509,7 +707,7 @@ ip4_nat_input(struct pbuf *p)
         nat_entry.tcp = ip4_nat_tcp_lookup_incoming(iphdr, tcphdr);
         if (nat_entry.tcp != NULL) {
           /* Refresh TCP entry */
-          nat_entry.tcp->common.ttl = LWIP_NAT_DEFAULT_TTL_SECONDS;
+          ip4_nat_entry_refresh(&ip4_nat_tcp_states, nat_entry.cmn);
           tcphdr->dest = nat_entry.tcp->sport;
           /* Adjust TCP checksum for changed destination port */
           ip4_nat_chksum_adjust((u8_t *)&(tcphdr->chksum),
@@ -536,7 +734,7 @@ ip4_nat_input(struct pbuf *p)
         nat_entry.udp = ip4_nat_udp_lookup_incoming(iphdr, udphdr);
         if (nat_entry.udp != NULL) {
           /* Refresh UDP entry */
-          nat_entry.udp->common.ttl = LWIP_NAT_DEFAULT_TTL_SECONDS;
+          ip4_nat_entry_refresh(&ip4_nat_udp_states, nat_entry.cmn);
           udphdr->dest = nat_entry.udp->sport;
           /* Adjust UDP checksum for changed destination port */
           ip4_nat_chksum_adjust((u8_t *)&(udphdr->chksum),
@@ -560,15 +758,15 @@ ip4_nat_input(struct pbuf *p)
           p->tot_len));
       } else {
         if (ICMP_ER == ICMPH_TYPE(icmphdr)) {
-          for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_ICMP; i++) {
-            nat_entry.icmp = &ip4_nat_icmp_table[i];
-            if ((nat_entry.icmp->common.ttl) &&
-                (iphdr->src.addr == nat_entry.icmp->common.dest.addr) &&
-                (nat_entry.icmp->id == icmphdr->id) &&
-                (nat_entry.icmp->seqno == icmphdr->seqno)) {
+          i = ip4_nat_hash(&ip4_nat_icmp_states, iphdr->src.addr, icmphdr->id, icmphdr->seqno);
+          for (i = ip4_nat_icmp_buckets[i]; i != LWIP_NAT_INDEX_NONE; i = ip4_nat_icmp_table[i].common.hnext) {
+            if ((iphdr->src.addr == ip4_nat_icmp_table[i].common.dest.addr) &&
+                (ip4_nat_icmp_table[i].id == icmphdr->id) &&
+                (ip4_nat_icmp_table[i].seqno == icmphdr->seqno)) {
+              nat_entry.icmp = &ip4_nat_icmp_table[i];
               ip4_nat_dbg_dump_icmp_nat_entry("found existing nat entry: ", nat_entry.icmp);
               consumed = 1;
-              IPNAT_ENTRY_RESET(nat_entry.cmn);
+              ip4_nat_entry_free(&ip4_nat_icmp_states, nat_entry.cmn);
               break;
             }
           }
@@ -653,43 +851,18 @@ ip4_nat_input(struct pbuf *p)
   return consumed;
 }
 
-/** Check if one NAT entry timed out */
-static void
-ip4_nat_check_timeout(ip4_nat_entry_common_t *nat_entry)
-{
-  if(nat_entry->ttl > 0) {
-    if(nat_entry->ttl != LWIP_NAT_TTL_INFINITE) {
-      /* this is not a 'no-timeout' entry */
-      if(nat_entry->ttl > LWIP_NAT_TMR_INTERVAL_SEC) {
-        nat_entry->ttl -= LWIP_NAT_TMR_INTERVAL_SEC;
-      } else {
-        nat_entry->ttl = 0;
-        nat_entry->dest.addr = 0;
-        nat_entry->source.addr = 0;
-      }
-    }
-  }
-}
-
 /** The NAT timer function, to be called at an interval of
  * LWIP_NAT_TMR_INTERVAL_SEC seconds.
  */
 void
 ip4_nat_tmr(void)
 {
-  int i;
-
   LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_tmr: removing old entries\n"));
 
-  for(i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_ICMP; i++) {
-    ip4_nat_check_timeout((ip4_nat_entry_common_t *) & ip4_nat_icmp_table[i]);
-  }
-  for(i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_TCP; i++) {
-    ip4_nat_check_timeout((ip4_nat_entry_common_t *) & ip4_nat_tcp_table[i]);
-  }
-  for(i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_UDP; i++) {
-    ip4_nat_check_timeout((ip4_nat_entry_common_t *) & ip4_nat_udp_table[i]);
-  }
+  ip4_nat_now += LWIP_NAT_TMR_INTERVAL_SEC;
+  ip4_nat_table_expire(&ip4_nat_icmp_states);
+  ip4_nat_table_expire(&ip4_nat_tcp_states);
+  ip4_nat_table_expire(&ip4_nat_udp_states);
 }
 
 /** Check if we want to perform NAT with this packet. If so, send it out on
@@ -710,7 +883,6 @@ ip4_nat_out(struct pbuf *p)
   struct udp_hdr       *udphdr;
   ip4_nat_conf_t        *nat_config;
   nat_entry_t           nat_entry;
-  int             i;
 
   nat_entry.cmn = NULL;
 
@@ -747,7 +919,7 @@ ip4_nat_out(struct pbuf *p)
           nat_entry.tcp = ip4_nat_tcp_lookup_outgoing(nat_config, iphdr, tcphdr, 1);
           if (nat_entry.tcp != NULL) {
             /* Reset ttl*/
-            nat_entry.tcp->common.ttl = LWIP_NAT_DEFAULT_TTL_SECONDS;
+            ip4_nat_entry_refresh(&ip4_nat_tcp_states, nat_entry.cmn);
             /* Adjust TCP checksum for changing source port */
             tcphdr->src = nat_entry.tcp->nport;
             ip4_nat_chksum_adjust((u8_t *)&(tcphdr->chksum),
@@ -770,7 +942,7 @@ ip4_nat_out(struct pbuf *p)
           nat_entry.udp = ip4_nat_udp_lookup_outgoing(nat_config, iphdr, udphdr, 1);
           if (nat_entry.udp != NULL) {
              /* Reset ttl*/
-            nat_entry.udp->common.ttl = LWIP_NAT_DEFAULT_TTL_SECONDS;
+            ip4_nat_entry_refresh(&ip4_nat_udp_states, nat_entry.cmn);
             /* Adjust UDP checksum for changing source port */
             udphdr->src = nat_entry.udp->nport;
             ip4_nat_chksum_adjust((u8_t *)&(udphdr->chksum),
@@ -792,17 +964,13 @@ ip4_nat_out(struct pbuf *p)
             (0x0, "ip4_nat_out: short icmp echo packet (%hu bytes) discarded\n", p->tot_len));
         } else {
           if (ICMPH_TYPE(icmphdr) == ICMP_ECHO) {
-            for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_ICMP; i++) {
-              if (!ip4_nat_icmp_table[i].common.ttl) {
-                nat_entry.icmp = &ip4_nat_icmp_table[i];
-                /* Reset ttl*/
-                nat_entry.icmp->common.ttl = LWIP_NAT_DEFAULT_TTL_SECONDS;
-                ip4_nat_cmn_init(nat_config, iphdr, nat_entry.cmn);
-                nat_entry.icmp->id = icmphdr->id;
-                nat_entry.icmp->seqno = icmphdr->seqno;
-                ip4_nat_dbg_dump_icmp_nat_entry(" ip4_nat_out: created new NAT entry ", nat_entry.icmp);
-                break;
-              }
+            /* hashed by the key of echo reply */
+            u16_t bucket = ip4_nat_hash(&ip4_nat_icmp_states, iphdr->dest.addr, icmphdr->id, icmphdr->seqno);
+            nat_entry.cmn = ip4_nat_entry_alloc(&ip4_nat_icmp_states, nat_config, iphdr, bucket);
+            if (nat_entry.cmn != NULL) {
+              nat_entry.icmp->id = icmphdr->id;
+              nat_entry.icmp->seqno = icmphdr->seqno;
+              ip4_nat_dbg_dump_icmp_nat_entry(" ip4_nat_out: created new NAT entry ", nat_entry.icmp);
             }
             if (NULL == nat_entry.icmp)
             {
@@ -862,7 +1030,7 @@ ip4_nat_cmn_init(ip4_nat_conf_t *nat_config, const struct ip_hdr *iphdr, ip4_nat
   nat_entry->cfg = nat_config;
   ip4_addr_set(&nat_entry->dest, &iphdr->dest);
   ip4_addr_set(&nat_entry->source, &iphdr->src);
-  nat_entry->ttl = LWIP_NAT_DEFAULT_TTL_SECONDS;
+  nat_entry->expire = ip4_nat_now + LWIP_NAT_DEFAULT_TTL_SECONDS;
 }
 
 /**
@@ -878,20 +1046,19 @@ ip4_nat_cmn_init(ip4_nat_conf_t *nat_config, const struct ip_hdr *iphdr, ip4_nat
 static ip4_nat_entries_udp_t *
 ip4_nat_udp_lookup_incoming(const struct ip_hdr *iphdr, const struct udp_hdr *udphdr)
 {
-  int i;
   ip4_nat_entries_udp_t *nat_entry = NULL;
-
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_UDP; i++) {
-    if (ip4_nat_udp_table[i].common.ttl) {
-      if ((iphdr->src.addr == ip4_nat_udp_table[i].common.dest.addr) &&
-          (udphdr->src == ip4_nat_udp_table[i].dport) &&
-          (udphdr->dest == ip4_nat_udp_table[i].nport)) {
-        nat_entry = &ip4_nat_udp_table[i];
-        LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_udp_lookup_incoming: i %d\n", i));
-        ip4_nat_dbg_dump_udp_nat_entry("ip4_nat_udp_lookup_incoming: found existing nat entry: ",
-                                      nat_entry);
-        break;
-      }
+  /* NAT port is allocated by entry index, so the entry is found directly */
+  u16_t i = (u16_t)(ntohs(udphdr->dest) - LWIP_NAT_DEFAULT_UDP_SOURCE_PORT);
+
+  if (i < LWIP_NAT_DEFAULT_STATE_TABLES_UDP) {
+    if ((ip4_nat_udp_table[i].common.expire != 0) &&
+        (iphdr->src.addr == ip4_nat_udp_table[i].common.dest.addr) &&
+        (udphdr->src == ip4_nat_udp_table[i].dport) &&
+        (udphdr->dest == ip4_nat_udp_table[i].nport)) {
+      nat_entry = &ip4_nat_udp_table[i];
+      LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_udp_lookup_incoming: i %d\n", i));
+      ip4_nat_dbg_dump_udp_nat_entry("ip4_nat_udp_lookup_incoming: found existing nat entry: ",
+                                    nat_entry);
     }
   }
   return nat_entry;
@@ -910,36 +1077,32 @@ static ip4_nat_entries_udp_t *
 ip4_nat_udp_lookup_outgoing(ip4_nat_conf_t *nat_config, const struct ip_hdr *iphdr,
                            const struct udp_hdr *udphdr, u8_t allocate)
 {
-  int i;
+  u16_t i;
   nat_entry_t nat_entry;
-  int last_free = -1;
+  u16_t bucket = ip4_nat_hash(&ip4_nat_udp_states, iphdr->src.addr, iphdr->dest.addr,
+                              ((u32_t)udphdr->src << 16) | udphdr->dest);
 
   nat_entry.cmn = NULL;
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_UDP; i++) {
-    if (ip4_nat_udp_table[i].common.ttl) {
-      if ((iphdr->src.addr == ip4_nat_udp_table[i].common.source.addr) &&
-          (iphdr->dest.addr == ip4_nat_udp_table[i].common.dest.addr) &&
-          (udphdr->src == ip4_nat_udp_table[i].sport) &&
-          (udphdr->dest == ip4_nat_udp_table[i].dport)) {
-        nat_entry.udp = &ip4_nat_udp_table[i];
-        LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_udp_lookup_outgoing: i %d\n", i));
-        ip4_nat_dbg_dump_udp_nat_entry("ip4_nat_udp_lookup_outgoing: found existing nat entry: ",
-                                      nat_entry.udp);
-        break;
-      }
-    } else {
-        if(last_free == -1)
-            last_free = i;
+  for (i = ip4_nat_udp_buckets[bucket]; i != LWIP_NAT_INDEX_NONE; i = ip4_nat_udp_table[i].common.hnext) {
+    if ((iphdr->src.addr == ip4_nat_udp_table[i].common.source.addr) &&
+        (iphdr->dest.addr == ip4_nat_udp_table[i].common.dest.addr) &&
+        (udphdr->src == ip4_nat_udp_table[i].sport) &&
+        (udphdr->dest == ip4_nat_udp_table[i].dport)) {
+      nat_entry.udp = &ip4_nat_udp_table[i];
+      LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_udp_lookup_outgoing: i %d\n", i));
+      ip4_nat_dbg_dump_udp_nat_entry("ip4_nat_udp_lookup_outgoing: found existing nat entry: ",
+                                    nat_entry.udp);
+      break;
     }
   }
   if (nat_entry.cmn == NULL) {
     if (allocate) {
-      if (last_free != -1) {
-        nat_entry.udp = &ip4_nat_udp_table[last_free];
-        nat_entry.udp->nport = htons((u16_t) (LWIP_NAT_DEFAULT_UDP_SOURCE_PORT + last_free));
+      nat_entry.cmn = ip4_nat_entry_alloc(&ip4_nat_udp_states, nat_config, iphdr, bucket);
+      if (nat_entry.cmn != NULL) {
+        i = ip4_nat_entry_index(&ip4_nat_udp_states, nat_entry.cmn);
+        nat_entry.udp->nport = htons((u16_t) (LWIP_NAT_DEFAULT_UDP_SOURCE_PORT + i));
         nat_entry.udp->sport = udphdr->src;
         nat_entry.udp->dport = udphdr->dest;
-        ip4_nat_cmn_init(nat_config, iphdr, nat_entry.cmn);
 
         ip4_nat_dbg_dump_udp_nat_entry("ip4_nat_udp_lookup_outgoing: created new nat entry: ",
                                       nat_entry.udp);
@@ -963,20 +1126,19 @@ ip4_nat_udp_lookup_outgoing(ip4_nat_conf_t *nat_config, const struct ip_hdr *iph
 static ip4_nat_entries_tcp_t *
 ip4_nat_tcp_lookup_incoming(const struct ip_hdr *iphdr, const struct tcp_hdr *tcphdr)
 {
-  int i;
   ip4_nat_entries_tcp_t *nat_entry = NULL;
-
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_TCP; i++) {
-    if (ip4_nat_tcp_table[i].common.ttl) {
-      if ((iphdr->src.addr == ip4_nat_tcp_table[i].common.dest.addr) &&
-          (tcphdr->src == ip4_nat_tcp_table[i].dport) &&
-          (tcphdr->dest == ip4_nat_tcp_table[i].nport)) {
-        nat_entry = &ip4_nat_tcp_table[i];
-        LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_tcp_lookup_incoming: i %d\n", i));
-        ip4_nat_dbg_dump_tcp_nat_entry("ip4_nat_tcp_lookup_incoming: found existing nat entry: ",
-                                      nat_entry);
-        break;
-      }
+  /* NAT port is allocated by entry index, so the entry is found directly */
+  u16_t i = (u16_t)(ntohs(tcphdr->dest) - LWIP_NAT_DEFAULT_TCP_SOURCE_PORT);
+
+  if (i < LWIP_NAT_DEFAULT_STATE_TABLES_TCP) {
+    if ((ip4_nat_tcp_table[i].common.expire != 0) &&
+        (iphdr->src.addr == ip4_nat_tcp_table[i].common.dest.addr) &&
+        (tcphdr->src == ip4_nat_tcp_table[i].dport) &&
+        (tcphdr->dest == ip4_nat_tcp_table[i].nport)) {
+      nat_entry = &ip4_nat_tcp_table[i];
+      LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_tcp_lookup_incoming: i %d\n", i));
+      ip4_nat_dbg_dump_tcp_nat_entry("ip4_nat_tcp_lookup_incoming: found existing nat entry: ",
+                                    nat_entry);
     }
   }
   return nat_entry;
@@ -995,36 +1157,32 @@ static ip4_nat_entries_tcp_t *
 ip4_nat_tcp_lookup_outgoing(ip4_nat_conf_t *nat_config, const struct ip_hdr *iphdr,
                            const struct tcp_hdr *tcphdr, u8_t allocate)
 {
-  int i;
+  u16_t i;
   nat_entry_t nat_entry;
-  int last_free = -1;
+  u16_t bucket = ip4_nat_hash(&ip4_nat_tcp_states, iphdr->src.addr, iphdr->dest.addr,
+                              ((u32_t)tcphdr->src << 16) | tcphdr->dest);
 
   nat_entry.cmn = NULL;
-  for (i = 0; i < LWIP_NAT_DEFAULT_STATE_TABLES_TCP; i++) {
-    if (ip4_nat_tcp_table[i].common.ttl) {
-      if ((iphdr->src.addr == ip4_nat_tcp_table[i].common.source.addr) &&
-          (iphdr->dest.addr == ip4_nat_tcp_table[i].common.dest.addr) &&
-          (tcphdr->src == ip4_nat_tcp_table[i].sport) &&
-          (tcphdr->dest == ip4_nat_tcp_table[i].dport)) {
-        nat_entry.tcp = &ip4_nat_tcp_table[i];
-        LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_tcp_lookup_outgoing: i %d\n", i));
-        ip4_nat_dbg_dump_tcp_nat_entry("ip4_nat_tcp_lookup_outgoing: found existing nat entry: ",
-                                      nat_entry.tcp);
-        break;
-      }
-    } else {
-        if(last_free == -1)
-            last_free = i;
+  for (i = ip4_nat_tcp_buckets[bucket]; i != LWIP_NAT_INDEX_NONE; i = ip4_nat_tcp_table[i].common.hnext) {
+    if ((iphdr->src.addr == ip4_nat_tcp_table[i].common.source.addr) &&
+        (iphdr->dest.addr == ip4_nat_tcp_table[i].common.dest.addr) &&
+        (tcphdr->src == ip4_nat_tcp_table[i].sport) &&
+        (tcphdr->dest == ip4_nat_tcp_table[i].dport)) {
+      nat_entry.tcp = &ip4_nat_tcp_table[i];
+      LWIP_DEBUGF(NAT_DEBUG, (0x0, "ip4_nat_tcp_lookup_outgoing: i %d\n", i));
+      ip4_nat_dbg_dump_tcp_nat_entry("ip4_nat_tcp_lookup_outgoing: found existing nat entry: ",
+                                    nat_entry.tcp);
+      break;
     }
   }
   if (nat_entry.cmn == NULL) {
     if (allocate) {
-      if (last_free != -1) {
-        nat_entry.tcp = &ip4_nat_tcp_table[last_free];
-        nat_entry.tcp->nport = htons((u16_t) (LWIP_NAT_DEFAULT_TCP_SOURCE_PORT + last_free));
+      nat_entry.cmn = ip4_nat_entry_alloc(&ip4_nat_tcp_states, nat_config, iphdr, bucket);
+      if (nat_entry.cmn != NULL) {
+        i = ip4_nat_entry_index(&ip4_nat_tcp_states, nat_entry.cmn);
+        nat_entry.tcp->nport = htons((u16_t) (LWIP_NAT_DEFAULT_TCP_SOURCE_PORT + i));
         nat_entry.tcp->sport = tcphdr->src;
         nat_entry.tcp->dport = tcphdr->dest;
-        ip4_nat_cmn_init(nat_config, iphdr, nat_entry.cmn);
 
         ip4_nat_dbg_dump_tcp_nat_entry("ip4_nat_tcp_lookup_outgoing: created new nat entry: ",
                                       nat_entry.tcp);
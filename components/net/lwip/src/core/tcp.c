@@ -113,6 +113,15 @@ static u16_t tcp_port = TCP_LOCAL_PORT_RANGE_START;
 
 /* Incremented every coarse grained timer shot (typically every 500 ms). */
 u32_t tcp_ticks;
+
+#if TCP_WND_AUTOTUNE
+/** Receive window growth of all connections by autotuning */
+static u32_t tcp_rcv_wnd_autotuned;
+#endif /* TCP_WND_AUTOTUNE */
+#if TCP_REXMIT_COUNT
+/** Retransmissions of all connections */
+u32_t tcp_rexmit_count;
+#endif /* TCP_REXMIT_COUNT */
 static const u8_t tcp_backoff[13] =
     { 1, 2, 3, 4, 5, 6, 7, 7, 7, 7, 7, 7, 7};
  /* Times per slowtmr hits */
@@ -842,6 +851,64 @@ tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb)
   }
 }
 
+#if TCP_WND_AUTOTUNE
+/**
+ * Return the receive window growth of a pcb to the autotuning budget.
+ */
+static void
+tcp_rcv_wnd_uncharge(struct tcp_pcb *pcb)
+{
+  tcp_rcv_wnd_autotuned -= pcb->rcv_wnd_charged;
+  pcb->rcv_wnd_charged = 0;
+}
+
+/**
+ * Autotune the receive window, called after application read data.
+ *
+ * A round ends when one window of data is received and read. When the
+ * peer is limited by the window, the round time is about one RTT, and
+ * doesn't increase with the window. So the window is doubled when the
+ * round time is no more than 1.5 times of the shortest round.
+ */
+static void
+tcp_rcv_wnd_autotune(struct tcp_pcb *pcb)
+{
+  u32_t now, round;
+  tcpwnd_size_t grow;
+
+  if (!(pcb->flags & TF_WND_SCALE) || (pcb->flags & TF_RCVBUF)) {
+    return;
+  }
+
+  now = sys_now();
+  if (pcb->rcv_round_start != 0) {
+    if (TCP_SEQ_LT(pcb->rcv_nxt - pcb->rcv_wnd_max + pcb->rcv_wnd, pcb->rcv_round_seq)) {
+      return;
+    }
+    round = now - pcb->rcv_round_start;
+    if (pcb->rcv_round_min == 0 || round < pcb->rcv_round_min) {
+      pcb->rcv_round_min = round;
+    }
+    if (round * 2 <= pcb->rcv_round_min * 3) {
+      grow = LWIP_MIN(pcb->rcv_wnd_max, TCP_WND_AUTOTUNE_MAX - LWIP_MIN(pcb->rcv_wnd_max, TCP_WND_AUTOTUNE_MAX));
+      grow = (tcpwnd_size_t)LWIP_MIN(grow, TCP_WND_AUTOTUNE_BUDGET - tcp_rcv_wnd_autotuned);
+      if (grow >= pcb->mss) {
+        pcb->rcv_wnd_max += grow;
+        pcb->rcv_wnd += grow;
+        pcb->rcv_wnd_charged += grow;
+        tcp_rcv_wnd_autotuned += grow;
+        LWIP_DEBUGF(TCP_WND_DEBUG, (0x0, "tcp_rcv_wnd_autotune: round %lu ms, wnd %lu\n",
+                    round, (u32_t)pcb->rcv_wnd_max));
+      }
+    }
+  }
+
+  /* the next round ends when the whole window is read */
+  pcb->rcv_round_seq = pcb->rcv_nxt + pcb->rcv_wnd;
+  pcb->rcv_round_start = now;
+}
+#endif /* TCP_WND_AUTOTUNE */
+
 /**
  * @ingroup tcp_raw
  * This function should be called by the application when it has
@@ -875,6 +942,10 @@ tcp_recved(struct tcp_pcb *pcb, u16_t len)
     }
   }
 
+#if TCP_WND_AUTOTUNE
+  tcp_rcv_wnd_autotune(pcb);
+#endif /* TCP_WND_AUTOTUNE */
+
   wnd_inflation = tcp_update_rcv_ann_wnd(pcb);
 
   /* If the change in the right edge of window is significant (default
@@ -890,6 +961,68 @@ tcp_recved(struct tcp_pcb *pcb, u16_t len)
          len, pcb->rcv_wnd, (u32_t)(TCP_WND_MAX(pcb) - pcb->rcv_wnd)));
 }
 
+/**
+ * @ingroup tcp_raw
+ * Set the receive window limit of a connection, and disable autotuning
+ * of the receive window. It is used by SO_RCVBUF. The window is limited
+ * to 0xFFFF when the peer doesn't agree on window scaling.
+ *
+ * @param pcb the tcp_pcb, not in LISTEN state
+ * @param size receive window limit in bytes
+ */
+void
+tcp_set_rcvbuf(struct tcp_pcb *pcb, u32_t size)
+{
+  LWIP_ASSERT("don't call tcp_set_rcvbuf for listen-pcbs",
+    pcb->state != LISTEN);
+
+  size = LWIP_MIN(LWIP_MAX(size, 2 * TCP_MSS), TCP_WND_LIMIT);
+#if TCP_WND_AUTOTUNE
+  tcp_rcv_wnd_uncharge(pcb);
+#endif /* TCP_WND_AUTOTUNE */
+  pcb->flags |= TF_RCVBUF;
+
+  if (pcb->state == CLOSED) {
+    /* tcp_connect will initialize the window */
+    pcb->rcv_wnd_max = (tcpwnd_size_t)size;
+    return;
+  }
+
+  if (size > pcb->rcv_wnd_max) {
+    pcb->rcv_wnd += (tcpwnd_size_t)(size - pcb->rcv_wnd_max);
+  } else {
+    pcb->rcv_wnd -= LWIP_MIN(pcb->rcv_wnd, (tcpwnd_size_t)(pcb->rcv_wnd_max - size));
+  }
+  pcb->rcv_wnd_max = (tcpwnd_size_t)size;
+  if (pcb->rcv_wnd > TCP_WND_MAX(pcb)) {
+    pcb->rcv_wnd = TCP_WND_MAX(pcb);
+  }
+  tcp_update_rcv_ann_wnd(pcb);
+}
+
+/**
+ * @ingroup tcp_raw
+ * Set the sender buffer space of a connection. It is used by SO_SNDBUF.
+ * The buffer space won't be less than data queued and not acked.
+ *
+ * @param pcb the tcp_pcb, not in LISTEN state
+ * @param size sender buffer space in bytes, up to TCP_SND_BUF_MAX
+ */
+void
+tcp_set_sndbuf(struct tcp_pcb *pcb, u32_t size)
+{
+  tcpwnd_size_t used;
+
+  LWIP_ASSERT("don't call tcp_set_sndbuf for listen-pcbs",
+    pcb->state != LISTEN);
+
+  used = pcb->snd_buf_max - pcb->snd_buf;
+  size = LWIP_MIN(LWIP_MAX(size, 2 * TCP_MSS), TCP_SND_BUF_MAX);
+  size = LWIP_MAX(size, used);
+  pcb->snd_buf_max = (tcpwnd_size_t)size;
+  pcb->snd_buf = (tcpwnd_size_t)(size - used);
+}
+
 /**
  * Allocate a new local TCP port.
  *
@@ -1019,7 +1152,7 @@ tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port,
   pcb->snd_lbb = iss - 1;
   /* Start with a window that does not need scaling. When window scaling is
      enabled and used, the window is enlarged when both sides agree on scaling. */
-  pcb->rcv_wnd = pcb->rcv_ann_wnd = TCPWND_MIN16(TCP_WND);
+  pcb->rcv_wnd = pcb->rcv_ann_wnd = TCPWND_MIN16(pcb->rcv_wnd_max);
   pcb->rcv_ann_right_edge = pcb->rcv_nxt;
   pcb->snd_wnd = TCP_WND;
   /* As initial send MSS, we use TCP_MSS but limit it to 536.
@@ -1702,9 +1835,10 @@ tcp_alloc(u8_t prio)
     /* zero out the whole pcb, so there is no need to initialize members to zero */
     memset(pcb, 0, sizeof(struct tcp_pcb));
     pcb->prio = prio;
-    pcb->snd_buf = TCP_SND_BUF;
+    pcb->snd_buf = pcb->snd_buf_max = TCP_SND_BUF;
     /* Start with a window that does not need scaling. When window scaling is
        enabled and used, the window is enlarged when both sides agree on scaling. */
+    pcb->rcv_wnd_max = TCP_WND;
     pcb->rcv_wnd = pcb->rcv_ann_wnd = TCPWND_MIN16(TCP_WND);
     pcb->ttl = TCP_TTL;
     /* As initial send MSS, we use TCP_MSS but limit it to 536.
@@ -1920,6 +2054,9 @@ tcp_pcb_purge(struct tcp_pcb *pcb)
     LWIP_DEBUGF(TCP_DEBUG, (0x0810131b, "tcp_pcb_purge\n"));
 
     tcp_backlog_accepted(pcb);
+#if TCP_WND_AUTOTUNE
+    tcp_rcv_wnd_uncharge(pcb);
+#endif /* TCP_WND_AUTOTUNE */
 
     if (pcb->refused_data != NULL) {
       LWIP_DEBUGF(TCP_DEBUG, (0x10007883, "tcp_pcb_purge: data left on ->refused_data\n"));
@@ -2171,6 +2308,18 @@ tcp_tcp_get_tcp_addrinfo(struct tcp_pcb *pcb, int local, ip_addr_t *addr, u16_t
   return ERR_VAL;
 }
 
+#if TCP_REXMIT_COUNT
+/**
+ * Get retransmission count of all connections since boot. It wraps around,
+ * and the difference of two readings is the count between them.
+ */
+u32_t
+tcp_get_rexmit_count(void)
+{
+  return tcp_rexmit_count;
+}
+#endif /* TCP_REXMIT_COUNT */
+
 #if TCP_DEBUG || TCP_INPUT_DEBUG || TCP_OUTPUT_DEBUG
 /**
  * Print a tcp header for debugging purposes.
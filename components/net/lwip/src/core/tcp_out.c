@@ -1451,6 +1451,9 @@ tcp_rexmit_rto(struct tcp_pcb *pcb)
 
   /* Don't take any RTT measurements after retransmitting. */
   pcb->rttest = 0;
+#if TCP_REXMIT_COUNT
+  tcp_rexmit_count++;
+#endif /* TCP_REXMIT_COUNT */
 
   /* Do the actual retransmission */
   tcp_output(pcb);
@@ -1501,6 +1504,9 @@ tcp_rexmit(struct tcp_pcb *pcb)
 
   /* Do the actual retransmission. */
   MIB2_STATS_INC(mib2.tcpretranssegs);
+#if TCP_REXMIT_COUNT
+  tcp_rexmit_count++;
+#endif /* TCP_REXMIT_COUNT */
   /* No need to call tcp_output: we are always called from tcp_input()
      and thus tcp_output directly returns. */
 }
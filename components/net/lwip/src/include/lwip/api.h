@@ -205,10 +205,17 @@ struct udp_pcb;
 struct raw_pcb;
 struct netconn;
 struct api_msg;
+struct netconn_zc;
 
 /** A callback prototype to inform about events for a netconn */
 typedef void (* netconn_callback)(struct netconn *, enum netconn_evt, u16_t len);
 
+#if LWIP_NETCONN_ZEROCOPY
+/** A callback prototype to inform that zero copy data is ACKed (err == ERR_OK),
+ * or is dropped due to connection error. It is called in tcpip thread. */
+typedef void (* netconn_sent_fn)(void *arg, err_t err);
+#endif /* LWIP_NETCONN_ZEROCOPY */
+
 /** A netconn descriptor */
 struct netconn {
   /** type of the netconn (TCP, UDP or RAW) */
@@ -275,6 +282,10 @@ struct netconn {
   netconn_callback callback;
   u32_t sent_size;
   u32_t acked_size;
+#if LWIP_NETCONN_ZEROCOPY
+  /** zero copy writes waiting for ACK, in sequence order */
+  struct netconn_zc *zc_pending;
+#endif /* LWIP_NETCONN_ZEROCOPY */
 };
 
 /** This vector type is passed to @ref netconn_write_vectors_partly to send
@@ -337,6 +348,11 @@ err_t   netconn_write_vectors_partly(struct netconn *conn, struct netvector *vec
 /** @ingroup netconn_tcp */
 #define netconn_write(conn, dataptr, size, apiflags) \
           netconn_write_partly(conn, dataptr, size, apiflags, NULL)
+#if LWIP_NETCONN_ZEROCOPY
+err_t   netconn_write_zerocopy(struct netconn *conn, const void *dataptr, size_t size,
+                               u8_t apiflags, size_t *bytes_written,
+                               netconn_sent_fn sent, void *arg);
+#endif /* LWIP_NETCONN_ZEROCOPY */
 err_t   netconn_close(struct netconn *conn);
 err_t   netconn_shutdown(struct netconn *conn, u8_t shut_rx, u8_t shut_tx);
 
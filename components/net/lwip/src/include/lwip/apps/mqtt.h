@@ -169,7 +169,8 @@ typedef void (*mqtt_incoming_publish_cb_t)(void *arg, const char *topic, u32_t t
  * @param arg Pointer to user data supplied when invoking request
  * @param err ERR_OK on success
  *            ERR_TIMEOUT if no response was received within timeout,
- *            ERR_ABRT if (un)subscribe was denied
+ *            ERR_ABRT if (un)subscribe was denied,
+ *            ERR_CLSD if connection is closed before zero-copy publish completes
  */
 typedef void (*mqtt_request_cb_t)(void *arg, err_t err);
 
@@ -206,6 +207,10 @@ err_t mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos, mqtt_re
 err_t mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t dup, u8_t qos, u8_t retain,
                                     mqtt_request_cb_t cb, void *arg);
 
+/** Publish data to topic, payload is referenced until callback */
+err_t mqtt_publish_ref(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos, u8_t retain,
+                       mqtt_request_cb_t cb, void *arg);
+
 void mqtt_set_protocol_level(u8_t level);
 
 #ifdef __cplusplus
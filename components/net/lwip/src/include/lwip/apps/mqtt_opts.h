@@ -56,6 +56,15 @@ extern "C" {
 #define MQTT_OUTPUT_RINGBUF_SIZE 256
 #endif
 
+/**
+ * Milliseconds a publish may wait in output ring-buffer, so that small publish
+ * messages are sent together in one TCP segment. 0 to send each publish at once.
+ * Output is sent without waiting when TCP_MSS or half of ring-buffer is filled.
+ */
+#ifndef MQTT_OUTPUT_COALESCE_MS
+#define MQTT_OUTPUT_COALESCE_MS 0
+#endif
+
 /**
  * Number of bytes in receive buffer, must be at least the size of the longest incoming topic + 8
  * If one wants to avoid fragmented incoming publish, set length to max incoming topic length + max payload length + 8
@@ -53,6 +53,14 @@ struct mqtt_request_t
   /** Callback to upper layer */
   mqtt_request_cb_t cb;
   void *arg;
+  /** Stored publish message to send again after reconnect, NULL if not stored */
+  u8_t *msg;
+  /** Zero-copy publish payload owned by caller, NULL if none */
+  const void *payload;
+  /** Output sequence at the end of zero-copy payload */
+  u32_t tx_end;
+  u16_t msg_len;
+  u16_t payload_len;
   /** MQTT packet identifier */
   u16_t pkt_id;
   /** Expire time relative to element before this  */
@@ -73,19 +81,20 @@ struct mqtt_client_s
   u16_t cyclic_tick;
   u16_t keep_alive;
   u16_t server_watchdog;
-  /** Packet identifier generator*/
-  u16_t pkt_id_seq;
   /** Packet identifier of pending incoming publish */
   u16_t inpub_pkt_id;
   /** Connection state */
   u8_t conn_state;
+  /** Session is kept over reconnect, clean_session is 0 */
+  u8_t keep_session;
+  /** Coalescing timer is running */
+  u8_t flush_pending;
   struct altcp_pcb *conn;
   /** Connection callback */
   void *connect_arg;
   mqtt_connection_cb_t connect_cb;
   /** Pending requests to server */
   struct mqtt_request_t *pend_req_queue;
-  struct mqtt_request_t req_list[MQTT_REQ_MAX_IN_FLIGHT];
   void *inpub_arg;
   /** Incoming data callback */
   mqtt_incoming_data_cb_t data_cb;
@@ -95,6 +104,16 @@ struct mqtt_client_s
   u8_t rx_buffer[MQTT_VAR_HEADER_BUFFER_LEN];
   /** Output ring-buffer */
   struct mqtt_ringbuf_t output;
+  /** Bytes written to and acknowledged by TCP, and written up to the end of last zero-copy payload */
+  u32_t tx_seq;
+  u32_t tx_acked;
+  u32_t tx_ref_end;
+  /* Session state below is kept over reconnect when clean_session is 0 */
+  /** Publish from previous session to send again */
+  struct mqtt_request_t *resend_queue;
+  /** Packet identifier generator*/
+  u16_t pkt_id_seq;
+  struct mqtt_request_t req_list[MQTT_REQ_MAX_IN_FLIGHT];
 };
 
 #ifdef __cplusplus
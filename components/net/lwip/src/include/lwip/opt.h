@@ -1245,6 +1245,15 @@
 #define TCP_SND_BUF                     (2 * TCP_MSS)
 #endif
 
+/**
+ * TCP_SND_BUF_MAX: Maximum TCP sender buffer space (bytes) which can be set
+ * by SO_SNDBUF. TCP_SND_BUF is the default of each connection. It should
+ * not exceed what TCP_SND_QUEUELEN can hold.
+ */
+#if !defined TCP_SND_BUF_MAX || defined __DOXYGEN__
+#define TCP_SND_BUF_MAX                 (TCP_SND_BUF)
+#endif
+
 /**
  * TCP_SND_QUEUELEN: TCP sender buffer space (pbufs). This must be at least
  * as much as (2 * TCP_SND_BUF/TCP_MSS) for things to work.
@@ -1371,6 +1380,46 @@
 #define TCP_RCV_SCALE                   0
 #endif
 
+/**
+ * TCP_WND_AUTOTUNE==1: Enable receive window autotuning. The receive window
+ * of each connection starts from TCP_WND. The window is doubled when one
+ * window of data is received and read by application in no more than 1.5
+ * times of the shortest such round, that is, the peer is limited by the
+ * window rather than the link. Connections with SO_RCVBUF are not tuned.
+ * Requires LWIP_WND_SCALE, and the window is tuned only when the peer
+ * agrees on window scaling.
+ */
+#if !defined TCP_WND_AUTOTUNE || defined __DOXYGEN__
+#define TCP_WND_AUTOTUNE                0
+#endif
+
+/**
+ * TCP_WND_AUTOTUNE_MAX: Maximum receive window of one connection by
+ * autotuning. It should not exceed (0xFFFF << TCP_RCV_SCALE).
+ */
+#if !defined TCP_WND_AUTOTUNE_MAX || defined __DOXYGEN__
+#define TCP_WND_AUTOTUNE_MAX            (0xFFFFU << TCP_RCV_SCALE)
+#endif
+
+/**
+ * TCP_WND_AUTOTUNE_BUDGET: The total receive window growth (bytes) beyond
+ * TCP_WND of all connections by autotuning. Received data are buffered
+ * until application reads them, and the window is the bound of the buffer.
+ */
+#if !defined TCP_WND_AUTOTUNE_BUDGET || defined __DOXYGEN__
+#define TCP_WND_AUTOTUNE_BUDGET         (2 * TCP_WND_AUTOTUNE_MAX)
+#endif
+
+/**
+ * TCP_REXMIT_COUNT==1: Count retransmissions of all connections (RTO and
+ * fast retransmit), and read it by tcp_get_rexmit_count(). Unlike TCP_STATS,
+ * it doesn't depend on LWIP_STATS, and can be used for throughput
+ * benchmarks.
+ */
+#if !defined TCP_REXMIT_COUNT || defined __DOXYGEN__
+#define TCP_REXMIT_COUNT                0
+#endif
+
 /** LWIP_ALTCP==1: enable the altcp API
  * altcp is an abstraction layer that prevents applications linking against the
  * tcp.h functions but provides the same functionality. It is used to e.g. add
@@ -1809,6 +1858,16 @@
 #if !defined LWIP_NETCONN_FULLDUPLEX || defined __DOXYGEN__
 #define LWIP_NETCONN_FULLDUPLEX         0
 #endif
+
+/** LWIP_NETCONN_ZEROCOPY==1: Enable netconn_write_zerocopy() and
+ * lwip_send_zerocopy(). TCP segments reference the application memory
+ * (PBUF_ROM), and a callback tells the application when the data is
+ * ACKed and the memory can be reused. Requires LWIP_SO_LINGER, which is
+ * used to reset the connection when it is closed with unacked data.
+ */
+#if !defined LWIP_NETCONN_ZEROCOPY || defined __DOXYGEN__
+#define LWIP_NETCONN_ZEROCOPY           0
+#endif
 /**
  * @}
  */
@@ -71,6 +71,17 @@ extern "C" {
 #define NETCONN_SHUT_WR   2
 #define NETCONN_SHUT_RDWR (NETCONN_SHUT_RD | NETCONN_SHUT_WR)
 
+#if LWIP_NETCONN_ZEROCOPY
+/** A zero copy write waiting for ACK */
+struct netconn_zc {
+  struct netconn_zc *next;
+  /** sequence number after the last byte of the write */
+  u32_t seq_end;
+  netconn_sent_fn sent;
+  void *arg;
+};
+#endif /* LWIP_NETCONN_ZEROCOPY */
+
 /* IP addresses and port numbers are expected to be in
  * the same byte order as in the corresponding pcb.
  */
@@ -147,6 +158,10 @@ struct api_msg {
       u8_t backlog;
     } lb;
 #endif /* TCP_LISTEN_BACKLOG */
+#if LWIP_NETCONN_ZEROCOPY
+    /** used for lwip_netconn_do_zerocopy */
+    struct netconn_zc *zc;
+#endif /* LWIP_NETCONN_ZEROCOPY */
   } msg;
 #if LWIP_NETCONN_SEM_PER_THREAD
   sys_sem_t* op_completed_sem;
@@ -208,6 +223,9 @@ void lwip_netconn_do_recv            (void *m);
 void lwip_netconn_do_accepted        (void *m);
 #endif /* TCP_LISTEN_BACKLOG */
 void lwip_netconn_do_write           (void *m);
+#if LWIP_NETCONN_ZEROCOPY
+void lwip_netconn_do_zerocopy        (void *m);
+#endif /* LWIP_NETCONN_ZEROCOPY */
 void lwip_netconn_do_getaddr         (void *m);
 void lwip_netconn_do_close           (void *m);
 void lwip_netconn_do_shutdown        (void *m);
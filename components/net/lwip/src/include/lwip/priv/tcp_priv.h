@@ -317,6 +317,9 @@ struct tcp_seg {
 extern struct tcp_pcb *tcp_input_pcb;
 extern u32_t tcp_ticks;
 extern u8_t tcp_active_pcbs_changed;
+#if TCP_REXMIT_COUNT
+extern u32_t tcp_rexmit_count;
+#endif /* TCP_REXMIT_COUNT */
 
 /* The TCP PCB lists. */
 union tcp_listen_pcbs_t { /* List of all TCP PCBs in LISTEN state. */
@@ -220,7 +220,7 @@ struct ifreq {
 #define SO_DONTLINGER   ((int)(~SO_LINGER))
 #define SO_OOBINLINE    0x0100 /* Unimplemented: leave received OOB data in line */
 #define SO_REUSEPORT    0x0200 /* Unimplemented: allow local address & port reuse */
-#define SO_SNDBUF       0x1001 /* Unimplemented: send buffer size */
+#define SO_SNDBUF       0x1001 /* send buffer size, TCP only */
 #define SO_RCVBUF       0x1002 /* receive buffer size */
 #define SO_SNDLOWAT     0x1003 /* Unimplemented: send low-water mark */
 #define SO_RCVLOWAT     0x1004 /* Unimplemented: receive low-water mark */
@@ -565,6 +565,11 @@ ssize_t lwip_recvfrom(int s, void *mem, size_t len, int flags,
 ssize_t lwip_recvmsg(int s, struct msghdr *message, int flags);
 ssize_t lwip_send(int s, const void *dataptr, size_t size, int flags);
 ssize_t lwip_sendmsg(int s, const struct msghdr *message, int flags);
+#if LWIP_NETCONN_ZEROCOPY
+/* sent has the type of netconn_sent_fn */
+ssize_t lwip_send_zerocopy(int s, const void *dataptr, size_t size, int flags,
+                           void (*sent)(void *arg, err_t err), void *arg);
+#endif /* LWIP_NETCONN_ZEROCOPY */
 ssize_t lwip_sendto(int s, const void *dataptr, size_t size, int flags,
     const struct sockaddr *to, socklen_t tolen);
 int lwip_socket(int domain, int type, int protocol);
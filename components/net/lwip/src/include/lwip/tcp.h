@@ -136,12 +136,14 @@ typedef err_t (*tcp_connected_fn)(void *arg, struct tcp_pcb *tpcb, err_t err);
 #define RCV_WND_SCALE(pcb, wnd) (((wnd) >> (pcb)->rcv_scale))
 #define SND_WND_SCALE(pcb, wnd) (((wnd) << (pcb)->snd_scale))
 #define TCPWND16(x)             ((u16_t)LWIP_MIN((x), 0xFFFF))
-#define TCP_WND_MAX(pcb)        ((tcpwnd_size_t)(((pcb)->flags & TF_WND_SCALE) ? TCP_WND : TCPWND16(TCP_WND)))
+#define TCP_WND_MAX(pcb)        ((tcpwnd_size_t)(((pcb)->flags & TF_WND_SCALE) ? (pcb)->rcv_wnd_max : TCPWND16((pcb)->rcv_wnd_max)))
+#define TCP_WND_LIMIT           (0xFFFFU << TCP_RCV_SCALE)
 #else
 #define RCV_WND_SCALE(pcb, wnd) (wnd)
 #define SND_WND_SCALE(pcb, wnd) (wnd)
 #define TCPWND16(x)             (x)
-#define TCP_WND_MAX(pcb)        TCP_WND
+#define TCP_WND_MAX(pcb)        ((pcb)->rcv_wnd_max)
+#define TCP_WND_LIMIT           0xFFFFU
 #endif
 
 #if LWIP_WND_SCALE || TCP_LISTEN_BACKLOG || LWIP_TCP_TIMESTAMPS
@@ -210,6 +212,7 @@ struct tcp_pcb {
 #define TF_TIMESTAMP   0x0400U   /* Timestamp option enabled */
 #endif
 #define TF_RTO         0x0800U /* RTO timer has fired, in-flight data moved to unsent and being retransmitted */
+#define TF_RCVBUF      0x1000U /* Receive window is set by SO_RCVBUF, and not autotuned */
 
   /* the rest of the fields are in host byte order
      as we have to do some math with them */
@@ -224,6 +227,13 @@ struct tcp_pcb {
   u32_t rcv_nxt;   /* next seqno expected */
   tcpwnd_size_t rcv_wnd;   /* receiver window available */
   tcpwnd_size_t rcv_ann_wnd; /* receiver window to announce */
+  tcpwnd_size_t rcv_wnd_max; /* receiver window limit, TCP_WND by default */
+#if TCP_WND_AUTOTUNE
+  tcpwnd_size_t rcv_wnd_charged; /* window growth charged to TCP_WND_AUTOTUNE_BUDGET */
+  u32_t rcv_round_seq;   /* rcv_nxt to end the autotuning round */
+  u32_t rcv_round_start; /* sys_now() at the start of the round, 0 for not started */
+  u32_t rcv_round_min;   /* shortest round time in ms */
+#endif /* TCP_WND_AUTOTUNE */
   u32_t rcv_ann_right_edge; /* announced right edge of window */
 
   /* Retransmission timer. */
@@ -259,6 +269,7 @@ struct tcp_pcb {
   tcpwnd_size_t snd_wnd_max; /* the maximum sender window announced by the remote host */
 
   tcpwnd_size_t snd_buf;   /* Available buffer space for sending (in bytes). */
+  tcpwnd_size_t snd_buf_max; /* Sender buffer space, TCP_SND_BUF by default */
 #define TCP_SNDQUEUELEN_OVERFLOW (0xffffU-3)
   u16_t snd_queuelen; /* Number of pbufs currently in the send buffer. */
 
@@ -364,6 +375,8 @@ void             tcp_poll    (struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interv
 #endif /* LWIP_TCP_TIMESTAMPS */
 /** @ingroup tcp_raw */
 #define          tcp_sndbuf(pcb)          (TCPWND16((pcb)->snd_buf))
+#define          tcp_get_rcvbuf(pcb)      ((pcb)->rcv_wnd_max)
+#define          tcp_get_sndbuf(pcb)      ((pcb)->snd_buf_max)
 /** @ingroup tcp_raw */
 #define          tcp_sndqueuelen(pcb)     ((pcb)->snd_queuelen)
 /** @ingroup tcp_raw */
@@ -387,6 +400,8 @@ void             tcp_backlog_accepted(struct tcp_pcb* pcb);
 #define          tcp_accepted(pcb) /* compatibility define, not needed any more */
 
 void             tcp_recved  (struct tcp_pcb *pcb, u16_t len);
+void             tcp_set_rcvbuf(struct tcp_pcb *pcb, u32_t size);
+void             tcp_set_sndbuf(struct tcp_pcb *pcb, u32_t size);
 err_t            tcp_bind    (struct tcp_pcb *pcb, const ip_addr_t *ipaddr,
                               u16_t port);
 void             tcp_bind_netif(struct tcp_pcb *pcb, const struct netif *netif);
@@ -411,6 +426,10 @@ err_t            tcp_output  (struct tcp_pcb *pcb);
 
 err_t            tcp_tcp_get_tcp_addrinfo(struct tcp_pcb *pcb, int local, ip_addr_t *addr, u16_t *port);
 
+#if TCP_REXMIT_COUNT
+u32_t            tcp_get_rexmit_count(void);
+#endif /* TCP_REXMIT_COUNT */
+
 #define tcp_dbg_get_tcp_state(pcb) ((pcb)->state)
 
 /* for compatibility with older implementation */
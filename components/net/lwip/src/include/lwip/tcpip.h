@@ -76,6 +76,7 @@ void   tcpip_init(tcpip_init_done_fn tcpip_init_done, void *arg);
 
 err_t  tcpip_inpkt(struct pbuf *p, struct netif *inp, netif_input_fn input_fn);
 err_t  tcpip_input(struct pbuf *p, struct netif *inp);
+void   tcpip_input_batch(struct pbuf **p, u16_t count, struct netif *inp);
 
 err_t  tcpip_callback_with_block(tcpip_callback_fn function, void *ctx, u8_t block);
 /**
@@ -75,6 +75,7 @@ static void pppos_input_callback(void *arg);
 static void pppos_input_free_current_packet(pppos_pcb *pppos);
 static void pppos_input_drop(pppos_pcb *pppos);
 static err_t pppos_output_append(pppos_pcb *pppos, err_t err, struct pbuf *nb, u8_t c, u8_t accm, u16_t *fcs);
+static err_t pppos_output_data(pppos_pcb *pppos, err_t err, struct pbuf *nb, const u8_t *s, u16_t n, u16_t *fcs);
 static err_t pppos_output_last(pppos_pcb *pppos, err_t err, struct pbuf *nb, u16_t *fcs);
 
 /* Callbacks structure for PPP core */
@@ -134,6 +135,45 @@ static const u16_t fcstab[256] = {
   0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
 };
 #define PPP_FCS(fcs, c) (((fcs) >> 8) ^ fcstab[((fcs) ^ (c)) & 0xff])
+
+/*
+ * FCS of two octets at once, fcstab2[x] = (fcstab[x] >> 8) ^ fcstab[fcstab[x] & 0xff]
+ */
+static const u16_t fcstab2[256] = {
+  0x0000, 0x19d8, 0x33b0, 0x2a68, 0x6760, 0x7eb8, 0x54d0, 0x4d08,
+  0xcec0, 0xd718, 0xfd70, 0xe4a8, 0xa9a0, 0xb078, 0x9a10, 0x83c8,
+  0x9591, 0x8c49, 0xa621, 0xbff9, 0xf2f1, 0xeb29, 0xc141, 0xd899,
+  0x5b51, 0x4289, 0x68e1, 0x7139, 0x3c31, 0x25e9, 0x0f81, 0x1659,
+  0x2333, 0x3aeb, 0x1083, 0x095b, 0x4453, 0x5d8b, 0x77e3, 0x6e3b,
+  0xedf3, 0xf42b, 0xde43, 0xc79b, 0x8a93, 0x934b, 0xb923, 0xa0fb,
+  0xb6a2, 0xaf7a, 0x8512, 0x9cca, 0xd1c2, 0xc81a, 0xe272, 0xfbaa,
+  0x7862, 0x61ba, 0x4bd2, 0x520a, 0x1f02, 0x06da, 0x2cb2, 0x356a,
+  0x4666, 0x5fbe, 0x75d6, 0x6c0e, 0x2106, 0x38de, 0x12b6, 0x0b6e,
+  0x88a6, 0x917e, 0xbb16, 0xa2ce, 0xefc6, 0xf61e, 0xdc76, 0xc5ae,
+  0xd3f7, 0xca2f, 0xe047, 0xf99f, 0xb497, 0xad4f, 0x8727, 0x9eff,
+  0x1d37, 0x04ef, 0x2e87, 0x375f, 0x7a57, 0x638f, 0x49e7, 0x503f,
+  0x6555, 0x7c8d, 0x56e5, 0x4f3d, 0x0235, 0x1bed, 0x3185, 0x285d,
+  0xab95, 0xb24d, 0x9825, 0x81fd, 0xccf5, 0xd52d, 0xff45, 0xe69d,
+  0xf0c4, 0xe91c, 0xc374, 0xdaac, 0x97a4, 0x8e7c, 0xa414, 0xbdcc,
+  0x3e04, 0x27dc, 0x0db4, 0x146c, 0x5964, 0x40bc, 0x6ad4, 0x730c,
+  0x8ccc, 0x9514, 0xbf7c, 0xa6a4, 0xebac, 0xf274, 0xd81c, 0xc1c4,
+  0x420c, 0x5bd4, 0x71bc, 0x6864, 0x256c, 0x3cb4, 0x16dc, 0x0f04,
+  0x195d, 0x0085, 0x2aed, 0x3335, 0x7e3d, 0x67e5, 0x4d8d, 0x5455,
+  0xd79d, 0xce45, 0xe42d, 0xfdf5, 0xb0fd, 0xa925, 0x834d, 0x9a95,
+  0xafff, 0xb627, 0x9c4f, 0x8597, 0xc89f, 0xd147, 0xfb2f, 0xe2f7,
+  0x613f, 0x78e7, 0x528f, 0x4b57, 0x065f, 0x1f87, 0x35ef, 0x2c37,
+  0x3a6e, 0x23b6, 0x09de, 0x1006, 0x5d0e, 0x44d6, 0x6ebe, 0x7766,
+  0xf4ae, 0xed76, 0xc71e, 0xdec6, 0x93ce, 0x8a16, 0xa07e, 0xb9a6,
+  0xcaaa, 0xd372, 0xf91a, 0xe0c2, 0xadca, 0xb412, 0x9e7a, 0x87a2,
+  0x046a, 0x1db2, 0x37da, 0x2e02, 0x630a, 0x7ad2, 0x50ba, 0x4962,
+  0x5f3b, 0x46e3, 0x6c8b, 0x7553, 0x385b, 0x2183, 0x0beb, 0x1233,
+  0x91fb, 0x8823, 0xa24b, 0xbb93, 0xf69b, 0xef43, 0xc52b, 0xdcf3,
+  0xe999, 0xf041, 0xda29, 0xc3f1, 0x8ef9, 0x9721, 0xbd49, 0xa491,
+  0x2759, 0x3e81, 0x14e9, 0x0d31, 0x4039, 0x59e1, 0x7389, 0x6a51,
+  0x7c08, 0x65d0, 0x4fb8, 0x5660, 0x1b68, 0x02b0, 0x28d8, 0x3100,
+  0xb2c8, 0xab10, 0x8178, 0x98a0, 0xd5a8, 0xcc70, 0xe618, 0xffc0
+};
+#define PPP_FCS2(fcs, c0, c1) (fcstab2[((fcs) ^ (c0)) & 0xff] ^ fcstab[(((fcs) >> 8) ^ (c1)) & 0xff])
 #else /* PPP_FCS_TABLE */
 /* The HDLC polynomial: X**0 + X**5 + X**12 + X**16 (0x8408) */
 #define PPP_FCS_POLYNOMIAL 0x8408
@@ -157,6 +197,23 @@ ppp_get_fcs(u8_t byte)
 #define PPP_INITFCS     0xffff  /* Initial FCS value */
 #define PPP_GOODFCS     0xf0b8  /* Good final FCS value */
 
+/*
+ * pppos_fcs_run - update FCS over a run of octets.
+ */
+static u16_t
+pppos_fcs_run(u16_t fcs, const u8_t *s, u16_t n)
+{
+#if PPP_FCS_TABLE
+  for (; n >= 2; n -= 2, s += 2) {
+    fcs = PPP_FCS2(fcs, s[0], s[1]);
+  }
+#endif /* PPP_FCS_TABLE */
+  while (n-- > 0) {
+    fcs = PPP_FCS(fcs, *s++);
+  }
+  return fcs;
+}
+
 #if PPP_INPROC_IRQ_SAFE
 #define PPPOS_DECL_PROTECT(lev) SYS_ARCH_DECL_PROTECT(lev)
 #define PPPOS_PROTECT(lev) SYS_ARCH_PROTECT(lev)
@@ -232,9 +289,7 @@ pppos_write(ppp_pcb *ppp, void *ctx, struct pbuf *p)
   fcs_out = PPP_INITFCS;
   s = (u8_t*)p->payload;
   n = p->len;
-  while (n-- > 0) {
-    err = pppos_output_append(pppos, err,  nb, *s++, 1, &fcs_out);
-  }
+  err = pppos_output_data(pppos, err, nb, s, n, &fcs_out);
 
   err = pppos_output_last(pppos, err, nb, &fcs_out);
   if (err == ERR_OK) {
@@ -287,12 +342,7 @@ pppos_netif_output(ppp_pcb *ppp, void *ctx, struct pbuf *pb, u16_t protocol)
 
   /* Load packet. */
   for(p = pb; p; p = p->next) {
-    u16_t n = p->len;
-    u8_t *s = (u8_t*)p->payload;
-
-    while (n-- > 0) {
-      err = pppos_output_append(pppos, err,  nb, *s++, 1, &fcs_out);
-    }
+    err = pppos_output_data(pppos, err, nb, (u8_t*)p->payload, p->len, &fcs_out);
   }
 
   err = pppos_output_last(pppos, err, nb, &fcs_out);
@@ -478,7 +528,32 @@ pppos_input(ppp_pcb *ppp, u8_t *s, int l)
   PPPOS_DECL_PROTECT(lev);
 
   //PPPDEBUG(LOG_DEBUG, ("pppos_input[%d]: got %d bytes\n", ppp->netif->num, l));
-  while (l-- > 0) {
+  while (l > 0) {
+    /* Fast path: inside packet data, copy a run of octets which need no
+     * unescaping into the current pbuf at once. */
+    if (pppos->in_state == PDDATA && !pppos->in_escaped && pppos->in_tail != NULL) {
+      u16_t room = PBUF_POOL_BUFSIZE - pppos->in_tail->len;
+      u16_t run = 0;
+      PPPOS_PROTECT(lev);
+      if (!pppos->open) {
+        PPPOS_UNPROTECT(lev);
+        return;
+      }
+      while (run < room && run < l && !ESCAPE_P(pppos->in_accm, s[run])) {
+        run++;
+      }
+      PPPOS_UNPROTECT(lev);
+      if (run > 0) {
+        MEMCPY((u8_t*)pppos->in_tail->payload + pppos->in_tail->len, s, run);
+        pppos->in_tail->len += run;
+        pppos->in_fcs = pppos_fcs_run(pppos->in_fcs, s, run);
+        s += run;
+        l -= run;
+        continue;
+      }
+    }
+
+    l--;
     cur_char = *s++;
 
     PPPOS_PROTECT(lev);
@@ -847,6 +922,54 @@ pppos_output_append(pppos_pcb *pppos, err_t err, struct pbuf *nb, u8_t c, u8_t a
   return ERR_OK;
 }
 
+/*
+ * pppos_output_data - append a run of data with FCS and escaping.
+ * Octets which need no escaping are copied in bulk, and the output is
+ * identical to calling pppos_output_append for each octet.
+ */
+static err_t
+pppos_output_data(pppos_pcb *pppos, err_t err, struct pbuf *nb, const u8_t *s, u16_t n, u16_t *fcs)
+{
+  if (err != ERR_OK) {
+    return err;
+  }
+
+  *fcs = pppos_fcs_run(*fcs, s, n);
+  while (n > 0) {
+    u8_t *d;
+    u16_t room;
+    u16_t run = 0;
+
+    /* Keep room for an escaped octet, same as pppos_output_append */
+    if ((PBUF_POOL_BUFSIZE - nb->len) < 2) {
+      u32_t l = pppos->output_cb(pppos->ppp, (u8_t*)nb->payload, nb->len, pppos->ppp->ctx_cb);
+      if (l != nb->len) {
+        return ERR_IF;
+      }
+      nb->len = 0;
+    }
+
+    d = (u8_t*)nb->payload + nb->len;
+    room = PBUF_POOL_BUFSIZE - nb->len;
+    while (run < room && run < n && !ESCAPE_P(pppos->out_accm, s[run])) {
+      run++;
+    }
+    if (run > 0) {
+      MEMCPY(d, s, run);
+      nb->len += run;
+      s += run;
+      n -= run;
+    } else {
+      d[0] = PPP_ESCAPE;
+      d[1] = *s++ ^ PPP_TRANS;
+      nb->len += 2;
+      n--;
+    }
+  }
+
+  return ERR_OK;
+}
+
 static err_t
 pppos_output_last(pppos_pcb *pppos, err_t err, struct pbuf *nb, u16_t *fcs)
 {
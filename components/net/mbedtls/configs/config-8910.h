@@ -0,0 +1,74 @@
+/**
+ * \file config-8910.h
+ *
+ * \brief Performance overlay for 8910 (Cortex-A5), on top of config.h
+ */
+/*
+ * This file is included at the end of config.h through
+ * MBEDTLS_USER_CONFIG_FILE, and tunes the TLS handshake time on 8910:
+ * - ARMv7 multiply-accumulate assembly for bignum
+ * - MPI and ECP window sizes
+ * - fixed-point comb table for the base point, computed once and shared
+ *   among all handshakes
+ * - platform entropy and session cache
+ * - TLS record buffers resized at runtime
+ *
+ * Features (ciphersuites, curves) are not changed here.
+ */
+
+#ifndef MBEDTLS_CONFIG_8910_H
+#define MBEDTLS_CONFIG_8910_H
+
+/*
+ * bn_mul.h uses UMAAL on ARMv7 with DSP extension. It is only enabled
+ * for optimized builds (__OPTIMIZE__), as r7 is used by the assembly.
+ */
+#define MBEDTLS_HAVE_ASM
+
+/*
+ * Sliding window for RSA exponentiation. The table is (1 << (w - 1))
+ * MPIs: 3 means 4 MPIs, 1KB for RSA-2048, with ~5% more
+ * multiplications than 6 (32 MPIs, 8KB).
+ */
+#undef MBEDTLS_MPI_WINDOW_SIZE
+#define MBEDTLS_MPI_WINDOW_SIZE 3
+
+/*
+ * Comb window for ECC. The table for P-256 base point is 16 points,
+ * ~1.5KB. Window 6 only helps for P-384 and above.
+ */
+#undef MBEDTLS_ECP_WINDOW_SIZE
+#define MBEDTLS_ECP_WINDOW_SIZE 5
+
+#undef MBEDTLS_ECP_FIXED_POINT_OPTIM
+#define MBEDTLS_ECP_FIXED_POINT_OPTIM 1
+
+/*
+ * Keep the base point table of each curve after the first computation.
+ * Each TLS handshake loads a fresh group, and without the cache the table
+ * is computed again, which costs more than the ECDHE multiplication
+ * itself. It is ~1.5KB heap for each used curve, and never freed.
+ */
+#define MBEDTLS_ECP_FIXED_POINT_CACHE
+
+/*
+ * Entropy from the shared DRBG of driver (drvRngRandom), which is seeded
+ * by the hardware TRNG. It replaces the rand() based source.
+ */
+#define MBEDTLS_ENTROPY_HARDWARE_ALT
+
+/*
+ * Keep resumable TLS client sessions over PSM sleep, so the first
+ * connection after wakeup is an abbreviated handshake.
+ */
+#define MBEDTLS_SSL_CLIENT_CACHE_PSM
+
+/*
+ * Each TLS context allocated 2 x 16KB record buffers for its lifetime.
+ * They are sized per connection (mbedtls_ssl_conf_content_len), shrunk to
+ * the negotiated max fragment length, and shrunk when idle. The input
+ * buffer still grows to 16KB for servers ignoring max fragment length.
+ */
+#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+
+#endif /* MBEDTLS_CONFIG_8910_H */
@@ -95,6 +95,10 @@ typedef struct mbedtls_aes_context
                                      <li>Simplifying key expansion in the 256-bit
                                          case by generating an extra round key.
                                          </li></ul> */
+#if defined(MBEDTLS_AES_HW_ACCEL)
+    unsigned int hw_keybits;    /*!< Key size for AES engine, 0 if not supported. */
+    unsigned char hw_key[16];   /*!< Raw key for AES engine. */
+#endif
 }
 mbedtls_aes_context;
 
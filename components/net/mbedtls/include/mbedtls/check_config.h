@@ -546,6 +546,19 @@
 #error "MBEDTLS_SSL_TLS_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH) && \
+    ( !defined(MBEDTLS_SSL_TLS_C) || defined(MBEDTLS_ZLIB_SUPPORT) )
+#error "MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_CLIENT_CACHE_C) && !defined(MBEDTLS_SSL_CLI_C)
+#error "MBEDTLS_SSL_CLIENT_CACHE_C defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_SSL_CLIENT_CACHE_PSM) && !defined(MBEDTLS_SSL_CLIENT_CACHE_C)
+#error "MBEDTLS_SSL_CLIENT_CACHE_PSM defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_SSL_SRV_C) && !defined(MBEDTLS_SSL_TLS_C)
 #error "MBEDTLS_SSL_SRV_C defined, but not all prerequisites"
 #endif
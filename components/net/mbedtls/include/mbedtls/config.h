@@ -1372,6 +1372,24 @@
  */
 #define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
 
+/**
+ * \def MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+ *
+ * Resize the TLS record buffers at runtime.
+ *
+ * The buffers are allocated with the content length set by
+ * mbedtls_ssl_conf_content_len(), shrunk to the negotiated max fragment
+ * length after handshake, and shrunk to MBEDTLS_SSL_IDLE_CONTENT_LEN by
+ * mbedtls_ssl_shrink_buffers(). The input buffer grows on demand up to
+ * MBEDTLS_SSL_IN_CONTENT_LEN, so peers without max fragment length support
+ * still work. DTLS buffers are not resized.
+ *
+ * Requires: MBEDTLS_SSL_TLS_C, and MBEDTLS_ZLIB_SUPPORT disabled
+ *
+ * Uncomment this macro to resize the record buffers at runtime
+ */
+//#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+
 /**
  * \def MBEDTLS_SSL_PROTO_SSL3
  *
@@ -2455,6 +2473,21 @@
  */
 //#define MBEDTLS_PADLOCK_C
 
+/**
+ * \def MBEDTLS_AES_HW_ACCEL
+ *
+ * Enable AES engine of the chip for large AES-128 buffers.
+ *
+ * Module:  library/mbed_aes.c
+ * Caller:  library/mbed_aes.c
+ *          library/gcm.c
+ *
+ * This modules uses drvAesCrypt* for CBC decryption, CTR and GCM.
+ * Software implementation is used for small buffers, other key sizes,
+ * or when the engine is used by another context.
+ */
+#define MBEDTLS_AES_HW_ACCEL
+
 /**
  * \def MBEDTLS_PEM_PARSE_C
  *
@@ -2705,6 +2738,31 @@
  */
 #define MBEDTLS_SSL_CACHE_C
 
+/**
+ * \def MBEDTLS_SSL_CLIENT_CACHE_C
+ *
+ * Enable the session cache shared by all SSL client connections. Sessions
+ * are found by server "host:port", and reconnections can resume the
+ * session with session id or ticket.
+ *
+ * Module:  library/ssl_client_cache.c
+ * Caller:
+ *
+ * Requires: MBEDTLS_SSL_CLI_C
+ */
+#define MBEDTLS_SSL_CLIENT_CACHE_C
+
+/**
+ * \def MBEDTLS_SSL_CLIENT_CACHE_PSM
+ *
+ * Save the client session cache in PSM data at PSM sleep, and restore it
+ * at PSM wakeup. Note that the master secrets of the cached sessions are
+ * saved in PSM data.
+ *
+ * Requires: MBEDTLS_SSL_CLIENT_CACHE_C
+ */
+//#define MBEDTLS_SSL_CLIENT_CACHE_PSM
+
 /**
  * \def MBEDTLS_SSL_COOKIE_C
  *
@@ -2976,6 +3034,7 @@
 //#define MBEDTLS_ECP_MAX_BITS             521 /**< Maximum bit size of groups */
 //#define MBEDTLS_ECP_WINDOW_SIZE            6 /**< Maximum window size used */
 //#define MBEDTLS_ECP_FIXED_POINT_OPTIM      1 /**< Enable fixed-point speed-up */
+//#define MBEDTLS_ECP_FIXED_POINT_CACHE        /**< Share fixed-point tables among groups of the same curve */
 
 /* Entropy options */
 //#define MBEDTLS_ENTROPY_MAX_SOURCES                20 /**< Maximum number of sources supported */
@@ -3018,6 +3077,9 @@
 /* SSL Cache options */
 //#define MBEDTLS_SSL_CACHE_DEFAULT_TIMEOUT       86400 /**< 1 day  */
 //#define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES      50 /**< Maximum entries in cache */
+//#define MBEDTLS_SSL_CLIENT_CACHE_DEFAULT_TIMEOUT 3600 /**< 1 hour */
+//#define MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES        4 /**< Maximum entries in client cache */
+//#define MBEDTLS_SSL_CLIENT_CACHE_MAX_TICKET_LEN   512 /**< Larger tickets are not cached */
 
 /* SSL options */
 
@@ -3065,6 +3127,13 @@
  */
 //#define MBEDTLS_SSL_OUT_CONTENT_LEN             16384
 
+/** \def MBEDTLS_SSL_IDLE_CONTENT_LEN
+ *
+ * Content length of the TLS record buffers after
+ * mbedtls_ssl_shrink_buffers(), see MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH.
+ */
+//#define MBEDTLS_SSL_IDLE_CONTENT_LEN              512
+
 /** \def MBEDTLS_SSL_DTLS_MAX_BUFFERING
  *
  * Maximum number of heap-allocated bytes for the purpose of
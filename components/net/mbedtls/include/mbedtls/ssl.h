@@ -249,6 +249,14 @@
 #define MBEDTLS_SSL_OUT_CONTENT_LEN MBEDTLS_SSL_MAX_CONTENT_LEN
 #endif
 
+/*
+ * Content length of the record buffers of idle connections, see
+ * mbedtls_ssl_shrink_buffers()
+ */
+#if !defined(MBEDTLS_SSL_IDLE_CONTENT_LEN)
+#define MBEDTLS_SSL_IDLE_CONTENT_LEN 512
+#endif
+
 /*
  * Maximum number of heap-allocated bytes for the purpose of
  * DTLS handshake message reassembly and future message buffering.
@@ -952,6 +960,13 @@ struct mbedtls_ssl_config
 
     uint32_t read_timeout;          /*!< timeout for mbedtls_ssl_read (ms)  */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t in_content_len;          /*!< incoming record buffer content
+                                         length, 0 for the maximum          */
+    size_t out_content_len;         /*!< outgoing record buffer content
+                                         length, 0 for the maximum          */
+#endif
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     uint32_t hs_timeout_min;        /*!< initial value of the handshake
                                          retransmission timeout (ms)        */
@@ -1084,6 +1099,9 @@ struct mbedtls_ssl_context
      * Record layer (incoming data)
      */
     unsigned char *in_buf;      /*!< input buffer                     */
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t in_buf_len;          /*!< current size of the input buffer */
+#endif
     unsigned char *in_ctr;      /*!< 64-bit incoming message counter
                                      TLS: maintained by us
                                      DTLS: read from peer             */
@@ -1122,6 +1140,9 @@ struct mbedtls_ssl_context
      * Record layer (outgoing data)
      */
     unsigned char *out_buf;     /*!< output buffer                    */
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t out_buf_len;         /*!< current size of the output buffer */
+#endif
     unsigned char *out_ctr;     /*!< 64-bit outgoing message counter  */
     unsigned char *out_hdr;     /*!< start of record header           */
     unsigned char *out_len;     /*!< two-bytes message length field   */
@@ -2560,6 +2581,34 @@ void mbedtls_ssl_conf_cert_req_ca_list( mbedtls_ssl_config *conf,
 int mbedtls_ssl_conf_max_frag_len( mbedtls_ssl_config *conf, unsigned char mfl_code );
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+/**
+ * \brief          Set the content length of the record buffers
+ *                 (Default: MBEDTLS_SSL_IN_CONTENT_LEN and
+ *                 MBEDTLS_SSL_OUT_CONTENT_LEN)
+ *
+ * \note           The input buffer is allocated with \p in_len, and grows
+ *                 up to MBEDTLS_SSL_IN_CONTENT_LEN when the peer sends a
+ *                 larger record. When a max fragment length is negotiated,
+ *                 the peer won't send records larger than it.
+ *
+ * \note           The output buffer is allocated with \p out_len. Outgoing
+ *                 application data is split into records of \p out_len,
+ *                 and each outgoing handshake message should fit in it.
+ *
+ * \note           Both buffers are shrunk to the negotiated max fragment
+ *                 length after handshake. This is ignored for DTLS.
+ *
+ * \param conf     SSL configuration
+ * \param in_len   input buffer content length, 0 for the default
+ * \param out_len  output buffer content length, 0 for the default
+ *
+ * \return         0 if successful or MBEDTLS_ERR_SSL_BAD_INPUT_DATA
+ */
+int mbedtls_ssl_conf_content_len( mbedtls_ssl_config *conf,
+                                  size_t in_len, size_t out_len );
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
 /**
  * \brief          Activate negotiation of truncated HMAC
@@ -2868,6 +2917,27 @@ size_t mbedtls_ssl_get_max_frag_len( const mbedtls_ssl_context *ssl );
  */
 int mbedtls_ssl_get_max_out_record_payload( const mbedtls_ssl_context *ssl );
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+/**
+ * \brief          Shrink the record buffers of an idle connection to
+ *                 MBEDTLS_SSL_IDLE_CONTENT_LEN
+ *
+ *                 It can be called when there is no more data to read and
+ *                 write, for example when the application is waiting for
+ *                 the socket to be readable. The buffers grow again on next
+ *                 \c mbedtls_ssl_read() and \c mbedtls_ssl_write().
+ *
+ * \note           Nothing is done before handshake is over, or when
+ *                 there are pending records in the buffers.
+ *
+ * \param ssl      SSL context
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_ALLOC_FAILED. On
+ *                 failure the buffers are unchanged and usable.
+ */
+int mbedtls_ssl_shrink_buffers( mbedtls_ssl_context *ssl );
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 /**
  * \brief          Return the peer certificate from the current connection
@@ -0,0 +1,131 @@
+/**
+ * \file ssl_client_cache.h
+ *
+ * \brief SSL client session cache, shared by all client connections
+ */
+/*
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ */
+#ifndef MBEDTLS_SSL_CLIENT_CACHE_H
+#define MBEDTLS_SSL_CLIENT_CACHE_H
+
+#include "ssl.h"
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#if !defined(MBEDTLS_SSL_CLIENT_CACHE_DEFAULT_TIMEOUT)
+#define MBEDTLS_SSL_CLIENT_CACHE_DEFAULT_TIMEOUT    3600   /*!< 1 hour */
+#endif
+
+#if !defined(MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES)
+#define MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES           4   /*!< Maximum entries in cache */
+#endif
+
+#if !defined(MBEDTLS_SSL_CLIENT_CACHE_MAX_TICKET_LEN)
+#define MBEDTLS_SSL_CLIENT_CACHE_MAX_TICKET_LEN      512   /*!< Larger tickets are not cached */
+#endif
+
+#if !defined(MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN)
+#define MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN              96   /*!< Maximum "host:port/sni" length */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          Set the cached session of the server to SSL context
+ *
+ *                 The session is found by "host:port", and the server
+ *                 name set by \c mbedtls_ssl_set_hostname() when it is
+ *                 different from \p host. It should be called after
+ *                 \c mbedtls_ssl_setup() and \c mbedtls_ssl_set_hostname(),
+ *                 and before \c mbedtls_ssl_handshake(). It does nothing
+ *                 after handshake started.
+ *
+ *                 When the server refuses to resume the session, the
+ *                 handshake falls back to full handshake silently.
+ *
+ * \param ssl      SSL context
+ * \param host     server host name or address
+ * \param port     server port, 0 when it is already part of \p host
+ *
+ * \return         0 if the session is set, 1 if not cached,
+ *                 or error code of \c mbedtls_ssl_set_session()
+ */
+int mbedtls_ssl_client_cache_load( mbedtls_ssl_context *ssl,
+                                   const char *host, unsigned short port );
+
+/**
+ * \brief          Save the session of SSL context to the cache
+ *
+ *                 It should be called after handshake succeeded. The peer
+ *                 certificate is not saved, and the resumed session has
+ *                 no peer certificate.
+ *
+ * \param ssl      SSL context
+ * \param host     server host name or address
+ * \param port     server port, 0 when it is already part of \p host
+ *
+ * \return         0 on success, or MBEDTLS_ERR_SSL_BAD_INPUT_DATA
+ */
+int mbedtls_ssl_client_cache_save( const mbedtls_ssl_context *ssl,
+                                   const char *host, unsigned short port );
+
+/**
+ * \brief          Remove the cached session of the server
+ *
+ *                 It should be called when handshake failed with a cached
+ *                 session, to avoid trying it again.
+ *
+ * \param ssl      SSL context
+ * \param host     server host name or address
+ * \param port     server port, 0 when it is already part of \p host
+ */
+void mbedtls_ssl_client_cache_remove( const mbedtls_ssl_context *ssl,
+                                      const char *host, unsigned short port );
+
+/**
+ * \brief          Set the cache timeout
+ *                 (Default: MBEDTLS_SSL_CLIENT_CACHE_DEFAULT_TIMEOUT)
+ *
+ *                 A timeout of 0 disables the cache. The ticket lifetime
+ *                 hint of the server is applied also.
+ *
+ * \param timeout  cache entry timeout in seconds
+ */
+void mbedtls_ssl_client_cache_set_timeout( unsigned timeout );
+
+/**
+ * \brief          Remove all cached sessions
+ */
+void mbedtls_ssl_client_cache_clear( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ssl_client_cache.h */
@@ -719,6 +719,37 @@ static inline size_t mbedtls_ssl_hs_hdr_len( const mbedtls_ssl_context *ssl )
     return( 4 );
 }
 
+/*
+ * Current size of the record buffers, and the record content they can hold.
+ * With MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH, they may be smaller than
+ * MBEDTLS_SSL_{IN,OUT}_BUFFER_LEN, and they are changed at runtime.
+ */
+static inline size_t mbedtls_ssl_get_input_buflen( const mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    return( ssl->in_buf_len );
+#else
+    ((void) ssl);
+    return( MBEDTLS_SSL_IN_BUFFER_LEN );
+#endif
+}
+
+static inline size_t mbedtls_ssl_get_output_buflen( const mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    return( ssl->out_buf_len );
+#else
+    ((void) ssl);
+    return( MBEDTLS_SSL_OUT_BUFFER_LEN );
+#endif
+}
+
+static inline size_t mbedtls_ssl_get_output_content_len( const mbedtls_ssl_context *ssl )
+{
+    return( mbedtls_ssl_get_output_buflen( ssl ) -
+            ( MBEDTLS_SSL_OUT_BUFFER_LEN - MBEDTLS_SSL_OUT_CONTENT_LEN ) );
+}
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
 void mbedtls_ssl_send_flight_completed( mbedtls_ssl_context *ssl );
 void mbedtls_ssl_recv_flight_completed( mbedtls_ssl_context *ssl );
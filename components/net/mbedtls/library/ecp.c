@@ -1883,6 +1883,128 @@ static unsigned char ecp_pick_window_size( const mbedtls_ecp_group *grp,
     return( w );
 }
 
+#if defined(MBEDTLS_ECP_FIXED_POINT_CACHE) && MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+#define ECP_COMB_CACHE
+
+#define ECP_COMB_CACHE_MAX  4
+
+/*
+ * Process wide cache of the pre-computed tables for the base point.
+ *
+ * TLS loads the group for each handshake, and the table for the base
+ * point would be computed again for each handshake. A published entry
+ * is never modified nor freed, so it can be read without lock.
+ */
+typedef struct
+{
+    mbedtls_ecp_group_id id;
+    unsigned char T_size;
+    mbedtls_ecp_point *T;
+} ecp_comb_cache_t;
+
+static ecp_comb_cache_t *ecp_comb_cache[ECP_COMB_CACHE_MAX];
+
+static const ecp_comb_cache_t *ecp_comb_cache_find( mbedtls_ecp_group_id id,
+                                                    unsigned char T_size )
+{
+    size_t i;
+    const ecp_comb_cache_t *c;
+
+    for( i = 0; i < ECP_COMB_CACHE_MAX; i++ )
+    {
+        c = ecp_comb_cache[i];
+        if( c != NULL && c->id == id && c->T_size == T_size )
+            return( c );
+    }
+
+    return( NULL );
+}
+
+/*
+ * Copy the cached table to T, T_ok is set when found.
+ */
+static int ecp_comb_cache_get( const mbedtls_ecp_group *grp,
+                               mbedtls_ecp_point T[], unsigned char T_size,
+                               unsigned char *T_ok )
+{
+    int ret = 0;
+    unsigned char i;
+    const ecp_comb_cache_t *c;
+
+    if( grp->id == MBEDTLS_ECP_DP_NONE ||
+        ( c = ecp_comb_cache_find( grp->id, T_size ) ) == NULL )
+        return( 0 );
+
+    for( i = 0; i < T_size; i++ )
+        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &T[i], &c->T[i] ) );
+
+    *T_ok = 1;
+
+cleanup:
+    return( ret );
+}
+
+static void ecp_comb_cache_free( ecp_comb_cache_t *c )
+{
+    unsigned char i;
+
+    for( i = 0; i < c->T_size; i++ )
+        mbedtls_ecp_point_free( &c->T[i] );
+    mbedtls_free( c->T );
+    mbedtls_free( c );
+}
+
+/*
+ * Publish a copy of the table. It is just an optimization, and errors
+ * are ignored.
+ */
+static void ecp_comb_cache_put( const mbedtls_ecp_group *grp,
+                                const mbedtls_ecp_point T[], unsigned char T_size )
+{
+    size_t i;
+    ecp_comb_cache_t *c;
+
+    if( grp->id == MBEDTLS_ECP_DP_NONE ||
+        ecp_comb_cache_find( grp->id, T_size ) != NULL )
+        return;
+
+    if( ( c = mbedtls_calloc( 1, sizeof( ecp_comb_cache_t ) ) ) == NULL )
+        return;
+
+    if( ( c->T = mbedtls_calloc( T_size, sizeof( mbedtls_ecp_point ) ) ) == NULL )
+    {
+        mbedtls_free( c );
+        return;
+    }
+
+    c->id = grp->id;
+    c->T_size = T_size;
+    for( i = 0; i < T_size; i++ )
+        mbedtls_ecp_point_init( &c->T[i] );
+
+    for( i = 0; i < T_size; i++ )
+    {
+        if( mbedtls_ecp_copy( &c->T[i], &T[i] ) != 0 )
+        {
+            ecp_comb_cache_free( c );
+            return;
+        }
+    }
+
+    for( i = 0; i < ECP_COMB_CACHE_MAX; i++ )
+    {
+        if( __sync_bool_compare_and_swap( &ecp_comb_cache[i], NULL, c ) )
+            return;
+
+        /* published by another thread meanwhile */
+        if( ecp_comb_cache[i]->id == c->id && ecp_comb_cache[i]->T_size == T_size )
+            break;
+    }
+
+    ecp_comb_cache_free( c );
+}
+#endif /* MBEDTLS_ECP_FIXED_POINT_CACHE */
+
 /*
  * Multiplication using the comb method - for curves in short Weierstrass form
  *
@@ -1958,6 +2080,20 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
             mbedtls_ecp_point_init( &T[i] );
 
         T_ok = 0;
+
+#if defined(ECP_COMB_CACHE)
+        /* Pre-computed table: is it cached by another group? */
+        if( p_eq_g )
+        {
+            MBEDTLS_MPI_CHK( ecp_comb_cache_get( grp, T, T_size, &T_ok ) );
+
+            if( T_ok )
+            {
+                grp->T = T;
+                grp->T_size = T_size;
+            }
+        }
+#endif
     }
 
     /* Compute table (or finish computing it) if not done already */
@@ -1971,6 +2107,10 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
              * the pointer to use for calling the next function more easily */
             grp->T = T;
             grp->T_size = T_size;
+
+#if defined(ECP_COMB_CACHE)
+            ecp_comb_cache_put( grp, T, T_size );
+#endif
         }
     }
 
@@ -128,7 +128,7 @@ void mbedtls_entropy_init( mbedtls_entropy_context *ctx )
                                 MBEDTLS_ENTROPY_MIN_HARDCLOCK,
                                 MBEDTLS_ENTROPY_SOURCE_WEAK );
 #endif
-#if defined(CONFIG_MBEDTLS_REDUCE_MEMORY)
+#if defined(CONFIG_MBEDTLS_REDUCE_MEMORY) && !defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
     mbedtls_entropy_add_source( ctx, mbedtls_random_poll, NULL,
                                 32,
                                 MBEDTLS_ENTROPY_SOURCE_STRONG);
@@ -46,6 +46,9 @@
 #if defined(MBEDTLS_ENTROPY_NV_SEED)
 #include "mbedtls/platform.h"
 #endif
+#if defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
+#include "drv_rng.h"
+#endif
 
 #if !defined(MBEDTLS_NO_PLATFORM_ENTROPY)
 
@@ -215,6 +218,25 @@ int mbedtls_null_entropy_poll( void *data,
 }
 #endif
 
+#if defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
+/*
+ * The shared DRBG of driver, which is seeded by the hardware TRNG. TRNG
+ * itself is too slow to seed each context.
+ */
+int mbedtls_hardware_poll( void *data,
+                           unsigned char *output, size_t len, size_t *olen )
+{
+    ((void) data);
+    *olen = 0;
+
+    if( !drvRngRandom( output, len ) )
+        return( MBEDTLS_ERR_ENTROPY_SOURCE_FAILED );
+
+    *olen = len;
+    return( 0 );
+}
+#endif /* MBEDTLS_ENTROPY_HARDWARE_ALT */
+
 #if defined(MBEDTLS_TIMING_C)
 int mbedtls_hardclock_poll( void *data,
                     unsigned char *output, size_t len, size_t *olen )
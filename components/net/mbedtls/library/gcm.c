@@ -46,6 +46,11 @@
 #include "mbedtls/aesni.h"
 #endif
 
+#if defined(MBEDTLS_AES_HW_ACCEL)
+#include "mbedtls/aes.h"
+#include "drv_aes.h"
+#endif
+
 #if defined(MBEDTLS_SELF_TEST) && defined(MBEDTLS_AES_C)
 #include "mbedtls/aes.h"
 #include "mbedtls/platform.h"
@@ -344,6 +349,101 @@ int mbedtls_gcm_starts( mbedtls_gcm_context *ctx,
     return( 0 );
 }
 
+#if defined(MBEDTLS_AES_HW_ACCEL)
+/*
+ * The AES context when the AES engine can be used for this GCM context
+ */
+static const mbedtls_aes_context *gcm_hw_aes( const mbedtls_gcm_context *ctx )
+{
+    const mbedtls_aes_context *aes;
+
+    if( mbedtls_cipher_get_type( &ctx->cipher_ctx ) != MBEDTLS_CIPHER_AES_128_ECB )
+        return( NULL );
+
+    aes = (const mbedtls_aes_context *) ctx->cipher_ctx.cipher_ctx;
+    return( aes->hw_keybits == 128 ? aes : NULL );
+}
+
+static void gcm_hash_blocks( mbedtls_gcm_context *ctx, size_t length,
+                             const unsigned char *p )
+{
+    size_t i;
+
+    for( ; length > 0; length -= 16, p += 16 )
+    {
+        for( i = 0; i < 16; i++ )
+            ctx->buf[i] ^= p[i];
+
+        gcm_mult( ctx, ctx->buf, ctx->buf );
+    }
+}
+
+/*
+ * Encrypt or decrypt whole blocks by the AES engine in one go, and
+ * GHASH the cipher text. The 32 bits counter shall not wrap, so that
+ * the 128 bits counter of the engine is the same.
+ */
+static int gcm_update_hw( mbedtls_gcm_context *ctx, size_t length,
+                          const unsigned char *input, unsigned char *output )
+{
+    int ret;
+    size_t i, olen = 0;
+    unsigned char ectr[16];
+    unsigned char counter[16];
+    const mbedtls_aes_context *aes = gcm_hw_aes( ctx );
+    uint32_t y = ( (uint32_t) ctx->y[12] << 24 ) | ( (uint32_t) ctx->y[13] << 16 ) |
+                 ( (uint32_t) ctx->y[14] <<  8 ) | ( (uint32_t) ctx->y[15]       );
+    uint32_t blocks = (uint32_t) ( length / 16 );
+
+    if( aes == NULL || blocks == 0 || (uint32_t) ( y + blocks ) < y )
+        return( 0 );
+
+    length = (size_t) blocks * 16;
+
+    /* Cipher text may be overwritten when decrypt in place */
+    if( ctx->mode == MBEDTLS_GCM_DECRYPT )
+        gcm_hash_blocks( ctx, length, input );
+
+    memcpy( counter, ctx->y, 16 );
+    for( i = 16; i > 12; i-- )
+        if( ++counter[i - 1] != 0 )
+            break;
+
+    if( !drvAesCryptCtr( aes->hw_key, counter, input, output, length ) )
+    {
+        /* Fall back to software, GHASH is done already for decryption */
+        for( i = 0; i < length; i += 16 )
+        {
+            size_t j;
+
+            for( j = 16; j > 12; j-- )
+                if( ++ctx->y[j - 1] != 0 )
+                    break;
+
+            if( ( ret = mbedtls_cipher_update( &ctx->cipher_ctx, ctx->y, 16,
+                                               ectr, &olen ) ) != 0 )
+                return( ret );
+
+            for( j = 0; j < 16; j++ )
+                output[i + j] = ectr[j] ^ input[i + j];
+        }
+    }
+    else
+    {
+        y += blocks;
+        ctx->y[12] = (unsigned char)( y >> 24 );
+        ctx->y[13] = (unsigned char)( y >> 16 );
+        ctx->y[14] = (unsigned char)( y >>  8 );
+        ctx->y[15] = (unsigned char)( y       );
+    }
+
+    if( ctx->mode == MBEDTLS_GCM_ENCRYPT )
+        gcm_hash_blocks( ctx, length, output );
+
+    return( (int) length );
+}
+#endif /* MBEDTLS_AES_HW_ACCEL */
+
 int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
                 size_t length,
                 const unsigned char *input,
@@ -370,6 +470,16 @@ int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
     ctx->len += length;
 
     p = input;
+
+#if defined(MBEDTLS_AES_HW_ACCEL)
+    if( ( ret = gcm_update_hw( ctx, length, input, output ) ) < 0 )
+        return( ret );
+
+    length -= ret;
+    p += ret;
+    out_p += ret;
+#endif
+
     while( length > 0 )
     {
         use_len = ( length < 16 ) ? length : 16;
@@ -44,6 +44,9 @@
 #if defined(MBEDTLS_AESNI_C)
 #include "mbedtls/aesni.h"
 #endif
+#if defined(MBEDTLS_AES_HW_ACCEL)
+#include "drv_aes.h"
+#endif
 
 #if defined(MBEDTLS_SELF_TEST)
 #if defined(MBEDTLS_PLATFORM_C)
@@ -563,6 +566,16 @@ int mbedtls_aes_setkey_enc( mbedtls_aes_context *ctx, const unsigned char *key,
         default : return( MBEDTLS_ERR_AES_INVALID_KEY_LENGTH );
     }
 
+#if defined(MBEDTLS_AES_HW_ACCEL)
+    /* The AES engine supports only 128 bits key */
+    ctx->hw_keybits = 0;
+    if( keybits == 128 )
+    {
+        memcpy( ctx->hw_key, key, 16 );
+        ctx->hw_keybits = 128;
+    }
+#endif
+
 #if defined(MBEDTLS_PADLOCK_C) && defined(MBEDTLS_PADLOCK_ALIGN16)
     if( aes_padlock_ace == -1 )
         aes_padlock_ace = mbedtls_padlock_has_support( MBEDTLS_PADLOCK_ACE );
@@ -680,6 +693,11 @@ int mbedtls_aes_setkey_dec( mbedtls_aes_context *ctx, const unsigned char *key,
 
     ctx->nr = cty.nr;
 
+#if defined(MBEDTLS_AES_HW_ACCEL)
+    ctx->hw_keybits = cty.hw_keybits;
+    memcpy( ctx->hw_key, cty.hw_key, sizeof( ctx->hw_key ) );
+#endif
+
 #if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
     if( mbedtls_aesni_has_support( MBEDTLS_AESNI_AES ) )
     {
@@ -1033,6 +1051,14 @@ int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
     }
 #endif
 
+#if defined(MBEDTLS_AES_HW_ACCEL)
+    // The AES engine may be busy or the data is too small, and then
+    // fall back to software
+    if( mode == MBEDTLS_AES_DECRYPT && ctx->hw_keybits == 128 &&
+        drvAesCryptCbcDecrypt( ctx->hw_key, iv, input, output, length ) )
+        return( 0 );
+#endif
+
     if( mode == MBEDTLS_AES_DECRYPT )
     {
         while( length > 0 )
@@ -1361,6 +1387,22 @@ int mbedtls_aes_crypt_ctr( mbedtls_aes_context *ctx,
     if ( n > 0x0F )
         return( MBEDTLS_ERR_AES_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_AES_HW_ACCEL)
+    // Whole blocks by the AES engine, the remained bytes by software
+    if( n == 0 && ctx->hw_keybits == 128 )
+    {
+        size_t bulk = length & ~( (size_t) 0x0F );
+
+        if( bulk > 0 &&
+            drvAesCryptCtr( ctx->hw_key, nonce_counter, input, output, bulk ) )
+        {
+            input  += bulk;
+            output += bulk;
+            length -= bulk;
+        }
+    }
+#endif
+
     while( length-- )
     {
         if( n == 0 ) {
@@ -0,0 +1,506 @@
+/*
+ *  SSL client session cache
+ *
+ *  Copyright (C) 2006-2015, ARM Limited, All Rights Reserved
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ */
+/*
+ * The session cache for SSL clients, shared by all client connections in
+ * the process (ssl sockets, HTTP, MQTT). Sessions are found by
+ * "host:port/sni", so a reconnection after network change can resume the
+ * session (with session id or ticket), and save a full handshake.
+ *
+ * Peer certificate isn't cached, to save memory. Optionally, the cache is
+ * saved in PSM data at PSM sleep, and restored at PSM wakeup.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SSL_CLIENT_CACHE_C)
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#endif
+
+#include "mbedtls/ssl_client_cache.h"
+#include "mbedtls/platform_util.h"
+#include "osi_api.h"
+#include "osi_mem.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SSL_CLIENT_CACHE_PSM_MAGIC  0x53534c43  /* 'SSLC' */
+
+/*
+ * Cached session, without pointers. It is the record in PSM data also.
+ */
+typedef struct
+{
+    char key[MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN];
+    int64_t timestamp;
+    int32_t ciphersuite;
+    uint32_t verify_result;
+    uint32_t ticket_lifetime;
+    uint16_t ticket_len;
+    uint8_t compression;
+    uint8_t id_len;
+    uint8_t id[32];
+    uint8_t master[48];
+    uint8_t mfl_code;
+    uint8_t trunc_hmac;
+    uint8_t encrypt_then_mac;
+} ssl_client_cache_record;
+
+typedef struct
+{
+    ssl_client_cache_record rec;
+    unsigned char *ticket;
+} ssl_client_cache_entry;
+
+typedef struct
+{
+    osiMutex_t *lock;
+    unsigned timeout;
+    ssl_client_cache_entry entries[MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES];
+} ssl_client_cache_context;
+
+static ssl_client_cache_context ssl_client_cache = {
+    .timeout = MBEDTLS_SSL_CLIENT_CACHE_DEFAULT_TIMEOUT,
+};
+
+static void ssl_client_cache_entry_free( ssl_client_cache_entry *entry )
+{
+    if( entry->ticket != NULL )
+    {
+        mbedtls_platform_zeroize( entry->ticket, entry->rec.ticket_len );
+        mbedtls_free( entry->ticket );
+    }
+    mbedtls_platform_zeroize( entry, sizeof( ssl_client_cache_entry ) );
+}
+
+static int ssl_client_cache_expired( const ssl_client_cache_entry *entry,
+                                     int64_t now )
+{
+    int64_t age = now - entry->rec.timestamp;
+
+    /* epoch time may jump backward at network time sync */
+    if( age < 0 || age >= (int64_t) ssl_client_cache.timeout )
+        return( 1 );
+
+    if( entry->rec.ticket_len != 0 && entry->rec.ticket_lifetime != 0 &&
+        age >= (int64_t) entry->rec.ticket_lifetime )
+        return( 1 );
+
+    return( 0 );
+}
+
+/*
+ * Key is "host:port", and "/sni" is appended when SNI is different
+ * from host. Return 0 when the key is too long.
+ */
+static int ssl_client_cache_key( const mbedtls_ssl_context *ssl,
+                                 const char *host, unsigned short port,
+                                 char key[MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN] )
+{
+    const char *sni = NULL;
+    int len;
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if( ssl != NULL && ssl->hostname != NULL &&
+        strcmp( ssl->hostname, host ) != 0 )
+        sni = ssl->hostname;
+#else
+    ((void) ssl);
+#endif
+
+    if( port != 0 )
+        len = snprintf( key, MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN, "%s:%u%s%s",
+                        host, (unsigned) port, sni ? "/" : "", sni ? sni : "" );
+    else
+        len = snprintf( key, MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN, "%s%s%s",
+                        host, sni ? "/" : "", sni ? sni : "" );
+
+    return( len > 0 && len < MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN );
+}
+
+static ssl_client_cache_entry *ssl_client_cache_find( const char *key )
+{
+    size_t i;
+
+    for( i = 0; i < MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES; i++ )
+    {
+        ssl_client_cache_entry *entry = &ssl_client_cache.entries[i];
+        if( entry->rec.key[0] != '\0' && strcmp( entry->rec.key, key ) == 0 )
+            return( entry );
+    }
+
+    return( NULL );
+}
+
+/*
+ * Find the entry for key, or a free entry, or the oldest entry
+ */
+static ssl_client_cache_entry *ssl_client_cache_alloc( const char *key )
+{
+    size_t i;
+    ssl_client_cache_entry *oldest = NULL;
+
+    for( i = 0; i < MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES; i++ )
+    {
+        ssl_client_cache_entry *entry = &ssl_client_cache.entries[i];
+        if( entry->rec.key[0] == '\0' || strcmp( entry->rec.key, key ) == 0 )
+            return( entry );
+
+        if( oldest == NULL || entry->rec.timestamp < oldest->rec.timestamp )
+            oldest = entry;
+    }
+
+    return( oldest );
+}
+
+#if defined(MBEDTLS_SSL_CLIENT_CACHE_PSM)
+static void ssl_client_cache_psm_save( void *ctx, osiShutdownMode_t mode )
+{
+    size_t i, size;
+    unsigned char *buf, *p;
+    uint32_t count = 0;
+    int64_t now = osiEpochSecond();
+
+    ((void) ctx);
+    if( mode != OSI_SHUTDOWN_PSM_SLEEP )
+        return;
+
+    osiMutexLock( ssl_client_cache.lock );
+
+    size = 2 * sizeof( uint32_t );
+    for( i = 0; i < MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES; i++ )
+    {
+        ssl_client_cache_entry *entry = &ssl_client_cache.entries[i];
+        if( entry->rec.key[0] != '\0' && !ssl_client_cache_expired( entry, now ) )
+            size += sizeof( ssl_client_cache_record ) + entry->rec.ticket_len;
+    }
+
+    if( ( buf = mbedtls_calloc( 1, size ) ) == NULL )
+        goto exit;
+
+    p = buf + 2 * sizeof( uint32_t );
+    for( i = 0; i < MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES; i++ )
+    {
+        ssl_client_cache_entry *entry = &ssl_client_cache.entries[i];
+        if( entry->rec.key[0] == '\0' || ssl_client_cache_expired( entry, now ) )
+            continue;
+
+        memcpy( p, &entry->rec, sizeof( ssl_client_cache_record ) );
+        p += sizeof( ssl_client_cache_record );
+        if( entry->rec.ticket_len != 0 )
+            memcpy( p, entry->ticket, entry->rec.ticket_len );
+        p += entry->rec.ticket_len;
+        count++;
+    }
+
+    ((uint32_t *) buf)[0] = SSL_CLIENT_CACHE_PSM_MAGIC;
+    ((uint32_t *) buf)[1] = count;
+    osiPsmDataSave( OSI_PSMDATA_OWNER_TLS, buf, size );
+
+    mbedtls_platform_zeroize( buf, size );
+    mbedtls_free( buf );
+
+exit:
+    osiMutexUnlock( ssl_client_cache.lock );
+}
+
+static void ssl_client_cache_psm_restore( void )
+{
+    int size;
+    uint32_t n, count;
+    unsigned char *buf, *p, *end;
+
+    if( osiGetBootMode() != OSI_BOOTMODE_PSM_RESTORE )
+        return;
+
+    size = osiPsmDataRestore( OSI_PSMDATA_OWNER_TLS, NULL, 0 );
+    if( size < (int) ( 2 * sizeof( uint32_t ) ) )
+        return;
+
+    if( ( buf = mbedtls_calloc( 1, size ) ) == NULL )
+        return;
+
+    if( osiPsmDataRestore( OSI_PSMDATA_OWNER_TLS, buf, size ) != size ||
+        ((uint32_t *) buf)[0] != SSL_CLIENT_CACHE_PSM_MAGIC )
+        goto exit;
+
+    count = ((uint32_t *) buf)[1];
+    p = buf + 2 * sizeof( uint32_t );
+    end = buf + size;
+    for( n = 0; n < count && n < MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES; n++ )
+    {
+        ssl_client_cache_entry *entry = &ssl_client_cache.entries[n];
+
+        if( (size_t) ( end - p ) < sizeof( ssl_client_cache_record ) )
+            break;
+        memcpy( &entry->rec, p, sizeof( ssl_client_cache_record ) );
+        p += sizeof( ssl_client_cache_record );
+
+        entry->rec.key[MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN - 1] = '\0';
+        if( (size_t) ( end - p ) < entry->rec.ticket_len ||
+            entry->rec.ticket_len > MBEDTLS_SSL_CLIENT_CACHE_MAX_TICKET_LEN )
+        {
+            ssl_client_cache_entry_free( entry );
+            break;
+        }
+
+        if( entry->rec.ticket_len != 0 )
+        {
+            if( ( entry->ticket = mbedtls_calloc( 1, entry->rec.ticket_len ) ) == NULL )
+            {
+                ssl_client_cache_entry_free( entry );
+                break;
+            }
+            memcpy( entry->ticket, p, entry->rec.ticket_len );
+            p += entry->rec.ticket_len;
+        }
+    }
+
+exit:
+    mbedtls_platform_zeroize( buf, size );
+    mbedtls_free( buf );
+}
+#endif /* MBEDTLS_SSL_CLIENT_CACHE_PSM */
+
+/*
+ * Tickets are dropped on memory pressure, in system work queue.
+ */
+static void ssl_client_cache_pressure( void *ctx )
+{
+    ((void) ctx);
+    mbedtls_ssl_client_cache_clear();
+}
+
+/*
+ * Create the lock at first use, and restore PSM data by the creator.
+ */
+static osiMutex_t *ssl_client_cache_lock( void )
+{
+    osiMutex_t *lock = ssl_client_cache.lock;
+
+    if( lock == NULL )
+    {
+        if( ( lock = osiMutexCreate() ) == NULL )
+            return( NULL );
+
+        osiMutexLock( lock );
+        if( !__sync_bool_compare_and_swap( &ssl_client_cache.lock, NULL, lock ) )
+        {
+            osiMutexUnlock( lock );
+            osiMutexDelete( lock );
+            lock = ssl_client_cache.lock;
+        }
+        else
+        {
+#if defined(MBEDTLS_SSL_CLIENT_CACHE_PSM)
+            ssl_client_cache_psm_restore();
+            osiRegisterShutdownCallback( ssl_client_cache_psm_save, NULL );
+#endif
+            osiMemPressureRegister( ssl_client_cache_pressure, NULL );
+            return( lock );
+        }
+    }
+
+    osiMutexLock( lock );
+    return( lock );
+}
+
+int mbedtls_ssl_client_cache_load( mbedtls_ssl_context *ssl,
+                                   const char *host, unsigned short port )
+{
+    int ret = 1;
+    char key[MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN];
+    mbedtls_ssl_session session;
+    ssl_client_cache_entry *entry;
+    osiMutex_t *lock;
+
+    /* only before handshake started */
+    if( ssl == NULL || host == NULL ||
+        ssl->state != MBEDTLS_SSL_HELLO_REQUEST ||
+        !ssl_client_cache_key( ssl, host, port, key ) )
+        return( 1 );
+
+    if( ( lock = ssl_client_cache_lock() ) == NULL )
+        return( 1 );
+
+    entry = ssl_client_cache_find( key );
+    if( entry == NULL )
+        goto exit;
+
+    if( ssl_client_cache_expired( entry, osiEpochSecond() ) )
+    {
+        ssl_client_cache_entry_free( entry );
+        goto exit;
+    }
+
+    /* mbedtls_ssl_set_session makes a deep copy */
+    memset( &session, 0, sizeof( mbedtls_ssl_session ) );
+    session.ciphersuite = entry->rec.ciphersuite;
+    session.compression = entry->rec.compression;
+    session.id_len = entry->rec.id_len;
+    memcpy( session.id, entry->rec.id, sizeof( session.id ) );
+    memcpy( session.master, entry->rec.master, sizeof( session.master ) );
+    session.verify_result = entry->rec.verify_result;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    session.ticket = entry->ticket;
+    session.ticket_len = entry->rec.ticket_len;
+    session.ticket_lifetime = entry->rec.ticket_lifetime;
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    session.mfl_code = entry->rec.mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    session.trunc_hmac = entry->rec.trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    session.encrypt_then_mac = entry->rec.encrypt_then_mac;
+#endif
+
+    ret = mbedtls_ssl_set_session( ssl, &session );
+    mbedtls_platform_zeroize( &session, sizeof( mbedtls_ssl_session ) );
+
+exit:
+    osiMutexUnlock( lock );
+    return( ret );
+}
+
+int mbedtls_ssl_client_cache_save( const mbedtls_ssl_context *ssl,
+                                   const char *host, unsigned short port )
+{
+    char key[MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN];
+    const mbedtls_ssl_session *session;
+    ssl_client_cache_entry *entry;
+    unsigned char *ticket = NULL;
+    size_t ticket_len = 0;
+    osiMutex_t *lock;
+
+    if( ssl == NULL || host == NULL || ssl->session == NULL ||
+        ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    session = ssl->session;
+    if( !ssl_client_cache_key( ssl, host, port, key ) ||
+        session->id_len > sizeof( session->id ) )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    if( session->ticket != NULL &&
+        session->ticket_len <= MBEDTLS_SSL_CLIENT_CACHE_MAX_TICKET_LEN )
+    {
+        if( ( ticket = mbedtls_calloc( 1, session->ticket_len ) ) == NULL )
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        memcpy( ticket, session->ticket, session->ticket_len );
+        ticket_len = session->ticket_len;
+    }
+#endif
+
+    /* Nothing to resume with */
+    if( ticket == NULL && session->id_len == 0 )
+    {
+        mbedtls_ssl_client_cache_remove( ssl, host, port );
+        return( 0 );
+    }
+
+    if( ( lock = ssl_client_cache_lock() ) == NULL )
+    {
+        mbedtls_free( ticket );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    entry = ssl_client_cache_alloc( key );
+    ssl_client_cache_entry_free( entry );
+
+    memcpy( entry->rec.key, key, sizeof( key ) );
+    entry->rec.timestamp = osiEpochSecond();
+    entry->rec.ciphersuite = session->ciphersuite;
+    entry->rec.compression = (uint8_t) session->compression;
+    entry->rec.id_len = (uint8_t) session->id_len;
+    memcpy( entry->rec.id, session->id, sizeof( entry->rec.id ) );
+    memcpy( entry->rec.master, session->master, sizeof( entry->rec.master ) );
+    entry->rec.verify_result = session->verify_result;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    entry->rec.ticket_lifetime = session->ticket_lifetime;
+#endif
+    entry->rec.ticket_len = (uint16_t) ticket_len;
+    entry->ticket = ticket;
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    entry->rec.mfl_code = session->mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    entry->rec.trunc_hmac = (uint8_t) session->trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    entry->rec.encrypt_then_mac = (uint8_t) session->encrypt_then_mac;
+#endif
+
+    osiMutexUnlock( lock );
+    return( 0 );
+}
+
+void mbedtls_ssl_client_cache_remove( const mbedtls_ssl_context *ssl,
+                                      const char *host, unsigned short port )
+{
+    char key[MBEDTLS_SSL_CLIENT_CACHE_KEY_LEN];
+    ssl_client_cache_entry *entry;
+    osiMutex_t *lock;
+
+    if( host == NULL || !ssl_client_cache_key( ssl, host, port, key ) )
+        return;
+
+    if( ( lock = ssl_client_cache_lock() ) == NULL )
+        return;
+
+    if( ( entry = ssl_client_cache_find( key ) ) != NULL )
+        ssl_client_cache_entry_free( entry );
+
+    osiMutexUnlock( lock );
+}
+
+void mbedtls_ssl_client_cache_set_timeout( unsigned timeout )
+{
+    ssl_client_cache.timeout = timeout;
+}
+
+void mbedtls_ssl_client_cache_clear( void )
+{
+    size_t i;
+    osiMutex_t *lock;
+
+    if( ( lock = ssl_client_cache_lock() ) == NULL )
+        return;
+
+    for( i = 0; i < MBEDTLS_SSL_CLIENT_CACHE_MAX_ENTRIES; i++ )
+        ssl_client_cache_entry_free( &ssl_client_cache.entries[i] );
+
+    osiMutexUnlock( lock );
+}
+
+#endif /* MBEDTLS_SSL_CLIENT_CACHE_C */
@@ -270,6 +270,226 @@ static unsigned int ssl_mfl_code_to_length( int mfl )
 }
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+/*
+ * Record buffer sizes: the buffers are allocated with the configured content
+ * length, shrunk to the negotiated max fragment length after handshake, and
+ * shrunk further when idle on request. The input buffer grows on demand for
+ * larger records, and the output buffer grows before handshake and write.
+ *
+ * Only TLS buffers are resized, DTLS buffers are always of maximum size.
+ */
+#define SSL_IN_BUFFER_OVERHEAD  ( MBEDTLS_SSL_IN_BUFFER_LEN - MBEDTLS_SSL_IN_CONTENT_LEN )
+#define SSL_OUT_BUFFER_OVERHEAD ( MBEDTLS_SSL_OUT_BUFFER_LEN - MBEDTLS_SSL_OUT_CONTENT_LEN )
+
+static int ssl_buffers_resizable( const mbedtls_ssl_context *ssl )
+{
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+        return( 0 );
+#else
+    ((void) ssl);
+#endif
+    return( 1 );
+}
+
+/*
+ * Content length of the record buffers in normal operation, the configured
+ * length limited by the negotiated max fragment length
+ */
+static size_t ssl_target_content_len( const mbedtls_ssl_context *ssl,
+                                      size_t conf_len, size_t max_len )
+{
+    size_t len = ( conf_len != 0 && conf_len < max_len ) ? conf_len : max_len;
+
+    if( ! ssl_buffers_resizable( ssl ) )
+        return( max_len );
+
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER &&
+        ssl->session != NULL &&
+        ssl->session->mfl_code != MBEDTLS_SSL_MAX_FRAG_LEN_NONE &&
+        ssl_mfl_code_to_length( ssl->session->mfl_code ) < len )
+    {
+        len = ssl_mfl_code_to_length( ssl->session->mfl_code );
+    }
+#endif
+
+    return( len );
+}
+
+static size_t ssl_target_in_buf_len( const mbedtls_ssl_context *ssl )
+{
+    return( SSL_IN_BUFFER_OVERHEAD +
+            ssl_target_content_len( ssl, ssl->conf->in_content_len,
+                                    MBEDTLS_SSL_IN_CONTENT_LEN ) );
+}
+
+static size_t ssl_target_out_buf_len( const mbedtls_ssl_context *ssl )
+{
+    return( SSL_OUT_BUFFER_OVERHEAD +
+            ssl_target_content_len( ssl, ssl->conf->out_content_len,
+                                    MBEDTLS_SSL_OUT_CONTENT_LEN ) );
+}
+
+/*
+ * Move the record buffer to a new allocation of len bytes. The first
+ * min( old, new ) bytes are kept, and the callers make sure that all
+ * buffered data are inside.
+ */
+static unsigned char *ssl_realloc_buffer( const mbedtls_ssl_context *ssl,
+                                          unsigned char *buf,
+                                          size_t old_len, size_t len )
+{
+    unsigned char *new_buf;
+
+    new_buf = mbedtls_calloc( 1, len );
+    if( new_buf == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", len ) );
+        return( NULL );
+    }
+
+    memcpy( new_buf, buf, old_len < len ? old_len : len );
+    mbedtls_platform_zeroize( buf, old_len );
+    mbedtls_free( buf );
+
+    return( new_buf );
+}
+
+static int ssl_resize_in_buf( mbedtls_ssl_context *ssl, size_t len )
+{
+    unsigned char *buf;
+    size_t ctr_offset, hdr_offset, len_offset, iv_offset, msg_offset;
+    size_t offt_offset = 0;
+
+    if( len == ssl->in_buf_len )
+        return( 0 );
+
+    ctr_offset = ssl->in_ctr - ssl->in_buf;
+    hdr_offset = ssl->in_hdr - ssl->in_buf;
+    len_offset = ssl->in_len - ssl->in_buf;
+    iv_offset  = ssl->in_iv  - ssl->in_buf;
+    msg_offset = ssl->in_msg - ssl->in_buf;
+    if( ssl->in_offt != NULL )
+        offt_offset = ssl->in_offt - ssl->in_buf;
+
+    buf = ssl_realloc_buffer( ssl, ssl->in_buf, ssl->in_buf_len, len );
+    if( buf == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "input buffer resized %d -> %d",
+                                ssl->in_buf_len, len ) );
+
+    ssl->in_buf     = buf;
+    ssl->in_buf_len = len;
+    ssl->in_ctr     = buf + ctr_offset;
+    ssl->in_hdr     = buf + hdr_offset;
+    ssl->in_len     = buf + len_offset;
+    ssl->in_iv      = buf + iv_offset;
+    ssl->in_msg     = buf + msg_offset;
+    if( ssl->in_offt != NULL )
+        ssl->in_offt = buf + offt_offset;
+
+    return( 0 );
+}
+
+static int ssl_resize_out_buf( mbedtls_ssl_context *ssl, size_t len )
+{
+    unsigned char *buf;
+    size_t ctr_offset, hdr_offset, len_offset, iv_offset, msg_offset;
+
+    if( len == ssl->out_buf_len )
+        return( 0 );
+
+    ctr_offset = ssl->out_ctr - ssl->out_buf;
+    hdr_offset = ssl->out_hdr - ssl->out_buf;
+    len_offset = ssl->out_len - ssl->out_buf;
+    iv_offset  = ssl->out_iv  - ssl->out_buf;
+    msg_offset = ssl->out_msg - ssl->out_buf;
+
+    buf = ssl_realloc_buffer( ssl, ssl->out_buf, ssl->out_buf_len, len );
+    if( buf == NULL )
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+
+    MBEDTLS_SSL_DEBUG_MSG( 3, ( "output buffer resized %d -> %d",
+                                ssl->out_buf_len, len ) );
+
+    ssl->out_buf     = buf;
+    ssl->out_buf_len = len;
+    ssl->out_ctr     = buf + ctr_offset;
+    ssl->out_hdr     = buf + hdr_offset;
+    ssl->out_len     = buf + len_offset;
+    ssl->out_iv      = buf + iv_offset;
+    ssl->out_msg     = buf + msg_offset;
+
+    return( 0 );
+}
+
+/*
+ * Make room for need bytes in the input buffer. When growing, grow to the
+ * target length at least, to avoid growing for each record.
+ */
+static int ssl_grow_in_buf( mbedtls_ssl_context *ssl, size_t need )
+{
+    size_t len;
+
+    if( need <= ssl->in_buf_len )
+        return( 0 );
+
+    len = ssl_target_in_buf_len( ssl );
+    if( len < need )
+        len = MBEDTLS_SSL_IN_BUFFER_LEN;
+
+    return( ssl_resize_in_buf( ssl, len ) );
+}
+
+static int ssl_grow_out_buf( mbedtls_ssl_context *ssl )
+{
+    size_t len = ssl_target_out_buf_len( ssl );
+
+    if( len <= ssl->out_buf_len )
+        return( 0 );
+
+    return( ssl_resize_out_buf( ssl, len ) );
+}
+
+/*
+ * Shrink the buffers when nothing is buffered, that is no unread record or
+ * application data, no remaining handshake message of the current record,
+ * and no unsent data. Only the sequence number before the record header
+ * is kept.
+ */
+static int ssl_shrink_buffers( mbedtls_ssl_context *ssl,
+                               size_t in_len, size_t out_len )
+{
+    int ret;
+
+    if( ! ssl_buffers_resizable( ssl ) ||
+        ssl->in_left != 0 || ssl->in_offt != NULL ||
+        ssl->keep_current_message != 0 ||
+        ( ssl->in_hslen != 0 && ssl->in_hslen < ssl->in_msglen ) ||
+        ssl->out_left != 0 )
+    {
+        return( 0 );
+    }
+
+    if( in_len < ssl->in_buf_len &&
+        ( ret = ssl_resize_in_buf( ssl, in_len ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    if( out_len < ssl->out_buf_len &&
+        ( ret = ssl_resize_out_buf( ssl, out_len ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 #if defined(MBEDTLS_SSL_CLI_C)
 static int ssl_session_copy( mbedtls_ssl_session *dst, const mbedtls_ssl_session *src )
 {
@@ -2547,6 +2767,12 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    if( ( ret = ssl_grow_in_buf( ssl,
+                    (size_t)( ssl->in_hdr - ssl->in_buf ) + nb_want ) ) != 0 )
+        return( ret );
+#endif
+
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
     {
@@ -3226,12 +3452,12 @@ int mbedtls_ssl_write_handshake_msg( mbedtls_ssl_context *ssl )
      *
      * Note: We deliberately do not check for the MTU or MFL here.
      */
-    if( ssl->out_msglen > MBEDTLS_SSL_OUT_CONTENT_LEN )
+    if( ssl->out_msglen > mbedtls_ssl_get_output_content_len( ssl ) )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "Record too large: "
                                     "size %u, maximum %u",
                                     (unsigned) ssl->out_msglen,
-                                    (unsigned) MBEDTLS_SSL_OUT_CONTENT_LEN ) );
+                                    (unsigned) mbedtls_ssl_get_output_content_len( ssl ) ) );
         return( MBEDTLS_ERR_SSL_INTERNAL_ERROR );
     }
 
@@ -5392,10 +5618,10 @@ int mbedtls_ssl_write_certificate( mbedtls_ssl_context *ssl )
     while( crt != NULL )
     {
         n = crt->raw.len;
-        if( n > MBEDTLS_SSL_OUT_CONTENT_LEN - 3 - i )
+        if( n > mbedtls_ssl_get_output_content_len( ssl ) - 3 - i )
         {
             MBEDTLS_SSL_DEBUG_MSG( 1, ( "certificate too large, %d > %d",
-                           i + 3 + n, MBEDTLS_SSL_OUT_CONTENT_LEN ) );
+                           i + 3 + n, mbedtls_ssl_get_output_content_len( ssl ) ) );
             return( MBEDTLS_ERR_SSL_CERTIFICATE_TOO_LARGE );
         }
 
@@ -6385,6 +6611,17 @@ void mbedtls_ssl_handshake_wrapup( mbedtls_ssl_context *ssl )
 
     ssl->state++;
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    /* Records are not larger than the negotiated max fragment length now,
+     * a failure is not fatal as the buffers are still usable */
+    if( ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER &&
+        ssl_shrink_buffers( ssl, ssl_target_in_buf_len( ssl ),
+                            ssl_target_out_buf_len( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "shrink buffers failed" ) );
+    }
+#endif
+
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "<= handshake wrapup" ) );
 }
 
@@ -6866,6 +7103,8 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
                        const mbedtls_ssl_config *conf )
 {
     int ret;
+    size_t in_buf_len = MBEDTLS_SSL_IN_BUFFER_LEN;
+    size_t out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
 
     ssl->conf = conf;
 
@@ -6876,21 +7115,32 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
     /* Set to NULL in case of an error condition */
     ssl->out_buf = NULL;
 
-    ssl->in_buf = mbedtls_calloc( 1, MBEDTLS_SSL_IN_BUFFER_LEN );
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    in_buf_len = ssl_target_in_buf_len( ssl );
+    out_buf_len = ssl_target_out_buf_len( ssl );
+#endif
+
+    ssl->in_buf = mbedtls_calloc( 1, in_buf_len );
     if( ssl->in_buf == NULL )
     {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", MBEDTLS_SSL_IN_BUFFER_LEN) );
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", in_buf_len ) );
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto error;
     }
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    ssl->in_buf_len = in_buf_len;
+#endif
 
-    ssl->out_buf = mbedtls_calloc( 1, MBEDTLS_SSL_OUT_BUFFER_LEN );
+    ssl->out_buf = mbedtls_calloc( 1, out_buf_len );
     if( ssl->out_buf == NULL )
     {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", MBEDTLS_SSL_OUT_BUFFER_LEN) );
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", out_buf_len ) );
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto error;
     }
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    ssl->out_buf_len = out_buf_len;
+#endif
 
     ssl_reset_in_out_pointers( ssl );
 
@@ -6988,14 +7238,14 @@ static int ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
     ssl->session_in = NULL;
     ssl->session_out = NULL;
 
-    memset( ssl->out_buf, 0, MBEDTLS_SSL_OUT_BUFFER_LEN );
+    memset( ssl->out_buf, 0, mbedtls_ssl_get_output_buflen( ssl ) );
 
 #if defined(MBEDTLS_SSL_DTLS_CLIENT_PORT_REUSE) && defined(MBEDTLS_SSL_SRV_C)
     if( partial == 0 )
 #endif /* MBEDTLS_SSL_DTLS_CLIENT_PORT_REUSE && MBEDTLS_SSL_SRV_C */
     {
         ssl->in_left = 0;
-        memset( ssl->in_buf, 0, MBEDTLS_SSL_IN_BUFFER_LEN );
+        memset( ssl->in_buf, 0, mbedtls_ssl_get_input_buflen( ssl ) );
     }
 
 #if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
@@ -7636,6 +7886,25 @@ void mbedtls_ssl_conf_arc4_support( mbedtls_ssl_config *conf, char arc4 )
 #endif
 
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+int mbedtls_ssl_conf_content_len( mbedtls_ssl_config *conf,
+                                  size_t in_len, size_t out_len )
+{
+    if( in_len > MBEDTLS_SSL_IN_CONTENT_LEN ||
+        out_len > MBEDTLS_SSL_OUT_CONTENT_LEN ||
+        ( in_len != 0 && in_len < MBEDTLS_SSL_IDLE_CONTENT_LEN ) ||
+        ( out_len != 0 && out_len < MBEDTLS_SSL_IDLE_CONTENT_LEN ) )
+    {
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    conf->in_content_len = in_len;
+    conf->out_content_len = out_len;
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 int mbedtls_ssl_conf_max_frag_len( mbedtls_ssl_config *conf, unsigned char mfl_code )
 {
     if( mfl_code >= MBEDTLS_SSL_MAX_FRAG_LEN_INVALID ||
@@ -7978,7 +8247,11 @@ static size_t ssl_get_current_mtu( const mbedtls_ssl_context *ssl )
 
 int mbedtls_ssl_get_max_out_record_payload( const mbedtls_ssl_context *ssl )
 {
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t max_len = ssl_target_out_buf_len( ssl ) - SSL_OUT_BUFFER_OVERHEAD;
+#else
     size_t max_len = MBEDTLS_SSL_OUT_CONTENT_LEN;
+#endif
 
 #if !defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) && \
     !defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -8021,6 +8294,21 @@ int mbedtls_ssl_get_max_out_record_payload( const mbedtls_ssl_context *ssl )
     return( (int) max_len );
 }
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+int mbedtls_ssl_shrink_buffers( mbedtls_ssl_context *ssl )
+{
+    if( ssl == NULL || ssl->conf == NULL || ssl->in_buf == NULL ||
+        ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        return( 0 );
+    }
+
+    return( ssl_shrink_buffers( ssl,
+                SSL_IN_BUFFER_OVERHEAD + MBEDTLS_SSL_IDLE_CONTENT_LEN,
+                SSL_OUT_BUFFER_OVERHEAD + MBEDTLS_SSL_IDLE_CONTENT_LEN ) );
+}
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert( const mbedtls_ssl_context *ssl )
 {
@@ -8056,6 +8344,12 @@ int mbedtls_ssl_handshake_step( mbedtls_ssl_context *ssl )
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    if( ( ret = ssl_grow_out_buf( ssl ) ) != 0 )
+        return( ret );
+    ret = MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+#endif
+
 #if defined(MBEDTLS_SSL_CLI_C)
     if( ssl->conf->endpoint == MBEDTLS_SSL_IS_CLIENT )
         ret = mbedtls_ssl_handshake_client_step( ssl );
@@ -8623,6 +8917,11 @@ static int ssl_write_real( mbedtls_ssl_context *ssl,
          * copy the data into the internal buffers and setup the data structure
          * to keep track of partial writes
          */
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+        if( ( ret = ssl_grow_out_buf( ssl ) ) != 0 )
+            return( ret );
+#endif
+
         ssl->out_msglen  = len;
         ssl->out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
         memcpy( ssl->out_msg, buf, len );
@@ -8938,13 +9237,13 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
 
     if( ssl->out_buf != NULL )
     {
-        mbedtls_platform_zeroize( ssl->out_buf, MBEDTLS_SSL_OUT_BUFFER_LEN );
+        mbedtls_platform_zeroize( ssl->out_buf, mbedtls_ssl_get_output_buflen( ssl ) );
         mbedtls_free( ssl->out_buf );
     }
 
     if( ssl->in_buf != NULL )
     {
-        mbedtls_platform_zeroize( ssl->in_buf, MBEDTLS_SSL_IN_BUFFER_LEN );
+        mbedtls_platform_zeroize( ssl->in_buf, mbedtls_ssl_get_input_buflen( ssl ) );
         mbedtls_free( ssl->in_buf );
     }
 
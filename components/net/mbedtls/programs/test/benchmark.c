@@ -340,6 +340,21 @@ int main( int argc, char *argv[] )
 
     mbedtls_printf( "\n" );
 
+#if defined(MBEDTLS_HAVE_ASM)
+    mbedtls_printf( "  MBEDTLS_HAVE_ASM\n" );
+#endif
+#if defined(MBEDTLS_BIGNUM_C)
+    mbedtls_printf( "  MBEDTLS_MPI_WINDOW_SIZE %d\n", MBEDTLS_MPI_WINDOW_SIZE );
+#endif
+#if defined(MBEDTLS_ECP_C)
+    mbedtls_printf( "  MBEDTLS_ECP_WINDOW_SIZE %d\n", MBEDTLS_ECP_WINDOW_SIZE );
+    mbedtls_printf( "  MBEDTLS_ECP_FIXED_POINT_OPTIM %d\n", MBEDTLS_ECP_FIXED_POINT_OPTIM );
+#if defined(MBEDTLS_ECP_FIXED_POINT_CACHE)
+    mbedtls_printf( "  MBEDTLS_ECP_FIXED_POINT_CACHE\n" );
+#endif
+#endif
+    mbedtls_printf( "\n" );
+
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     mbedtls_memory_buffer_alloc_init( alloc_buf, sizeof( alloc_buf ) );
 #endif
@@ -904,6 +919,33 @@ int main( int argc, char *argv[] )
             mbedtls_ecdh_free( &ecdh );
         }
 
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+        /*
+         * Each TLS handshake loads a new group, so the base point table
+         * is not reused unless MBEDTLS_ECP_FIXED_POINT_CACHE is enabled.
+         */
+        mbedtls_mpi_init( &z );
+        mbedtls_ecdh_init( &ecdh );
+
+        if( mbedtls_ecp_group_load( &ecdh.grp, MBEDTLS_ECP_DP_SECP256R1 ) != 0 ||
+            mbedtls_ecdh_gen_public( &ecdh.grp, &ecdh.d, &ecdh.Qp, myrand, NULL ) != 0 )
+        {
+            mbedtls_exit( 1 );
+        }
+
+        TIME_PUBLIC( "ECDHE-secp256r1 reload", "handshake",
+                mbedtls_ecp_group_free( &ecdh.grp );
+                mbedtls_ecp_group_init( &ecdh.grp );
+                ret |= mbedtls_ecp_group_load( &ecdh.grp, MBEDTLS_ECP_DP_SECP256R1 );
+                ret |= mbedtls_ecdh_gen_public( &ecdh.grp, &ecdh.d, &ecdh.Q,
+                                        myrand, NULL );
+                ret |= mbedtls_ecdh_compute_shared( &ecdh.grp, &z, &ecdh.Qp, &ecdh.d,
+                                            myrand, NULL ) );
+
+        mbedtls_ecdh_free( &ecdh );
+        mbedtls_mpi_free( &z );
+#endif
+
         /* Montgomery curves need to be handled separately */
         for ( curve_info = montgomery_curve_list;
               curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
@@ -423,7 +423,15 @@ ssize_t mupnp_http_packet_read_chunk(mUpnpHttpPacket *httpPkt, mUpnpSocket *sock
         return 0;
     conLen = mupnp_strhex2long(lineBuf);
     if (conLen < 1)
+    {
+        /* Last chunk, skip trailers up to the empty line so that the
+           connection is left at the start of next response */
+        do
+        {
+            readLen = mupnp_socket_readline(sock, lineBuf, lineBufSize);
+        } while (readLen > 0 && lineBuf[0] != '\r' && lineBuf[0] != '\n');
         return 0;
+    }
 
     content = (char *)malloc(conLen + 1);
 
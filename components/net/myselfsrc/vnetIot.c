@@ -1,4 +1,5 @@
 #include "cJSON.h"
+#include "cJSON_Pull.h"
 #include "netutils.h"
 #include "mupnp/util/string.h"
 #include "http_api.h"
@@ -60,29 +61,43 @@ static void parseJson(char *pMsg, reg_ctrl_t *reg_ctrl)
         OSI_LOGI(0, "parseJson: pMsg is NULL!!!\n");
         return;
     }
-    cJSON *pJson = cJSON_Parse(pMsg);
-    if (NULL == pJson)
+    OSI_LOGXI(OSI_LOGPAR_S, 0, "parseJson: %s\n", pMsg);
+
+    // only two top level members are needed, walk the text instead of building the tree
+    cJSON_Pull pull;
+    cJSON_PullToken token;
+    char value[32];
+
+    cJSON_PullInit(&pull, pMsg, strlen(pMsg));
+    if (cJSON_PullNext(&pull) != cJSON_Pull_ObjectBegin)
     {
         OSI_LOGI(0, "parseJson: pJson is NULL!!!\n");
         return;
     }
-    char *regdatajs = cJSON_PrintUnformatted(pJson);
-    OSI_LOGXI(OSI_LOGPAR_S, 0, "parseJson: %s\n", regdatajs);	
 
-    cJSON *pSub = cJSON_GetObjectItem(pJson, "resultCode");
-    if (NULL != pSub)
+    while ((token = cJSON_PullNext(&pull)) > cJSON_Pull_End && pull.depth > 0)
     {
-        OSI_LOGXI(OSI_LOGPAR_S, 0, "resultCode: %s\n", pSub->valuestring);
-        reg_ctrl->resultCode = atoi(pSub->valuestring);
-    }
-
-    pSub = cJSON_GetObjectItem(pJson, "resultDesc");
-    if (NULL != pSub)
-    {
-        OSI_LOGXI(OSI_LOGPAR_S, 0, "resultDesc: %s\n", pSub->valuestring);
-        strncpy((char *)reg_ctrl->resultDesc,pSub->valuestring,10);
+        if (token == cJSON_Pull_ObjectBegin || token == cJSON_Pull_ArrayBegin)
+        {
+            cJSON_PullSkip(&pull);
+        }
+        else if (cJSON_PullKeyIs(&pull, "resultCode"))
+        {
+            if (token == cJSON_Pull_Number)
+                reg_ctrl->resultCode = (uint8_t)cJSON_PullGetNumber(&pull);
+            else if (cJSON_PullGetString(&pull, value, sizeof(value)) >= 0)
+                reg_ctrl->resultCode = atoi(value);
+            OSI_LOGI(0, "resultCode: %d\n", reg_ctrl->resultCode);
+        }
+        else if (cJSON_PullKeyIs(&pull, "resultDesc"))
+        {
+            if (cJSON_PullGetString(&pull, value, sizeof(value)) >= 0)
+            {
+                OSI_LOGXI(OSI_LOGPAR_S, 0, "resultDesc: %s\n", value);
+                strncpy((char *)reg_ctrl->resultDesc, value, 10);
+            }
+        }
     }
-     free(regdatajs);
 }
 
 OSI_UNUSED static int OutputTime(char *rsp, struct tm *tm)
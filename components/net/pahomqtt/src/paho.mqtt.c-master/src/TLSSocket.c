@@ -32,6 +32,7 @@
 #include "MQTTClient.h"
 #include "MQTTProtocolOut.h"
 #include "TLSSocket.h"
+#include "mbedtls/ssl_client_cache.h"
 /*zyzyzy 20180929 #include "Log.h"*/
 /*zyzyzy 20180929 #include "StackTrace.h"*/
 #include "Socket.h"
@@ -301,15 +302,22 @@ int SSLSocket_setSocketForSSL(networkHandles *net, MQTTClient_SSLOptions *opts,
 int SSLSocket_connect(SSL *ssl, int sock, const char *hostname, int verify, int (*cb)(const char *str, size_t len, void *u), void *u)
 {
     int rc = -1;
+    int resumed;
+
+    /* hostname is the server URI, with port */
+    resumed = (mbedtls_ssl_client_cache_load(ssl, hostname, 0) == 0);
 
     while ((rc = mbedtls_ssl_handshake(ssl)) != 0)
     {
         if (rc != MBEDTLS_ERR_SSL_WANT_READ && rc != MBEDTLS_ERR_SSL_WANT_WRITE)
         {
             COS_LOGI(0, " failed ! mbedtls_ssl_handshake returned -%x\n\n", -rc);
+            if (resumed)
+                mbedtls_ssl_client_cache_remove(ssl, hostname, 0);
             return rc;
         }
     }
+    mbedtls_ssl_client_cache_save(ssl, hostname, 0);
     return 1;
 }
 
@@ -49,6 +49,16 @@ lwip_do_mqtt_publish(void *arg)
     sys_sem_signal(msg->sem);
 }
 
+static void
+lwip_do_mqtt_publish_ref(void *arg)
+{
+    struct mqtt_api_msg *msg = (struct mqtt_api_msg *)arg;
+
+    *(msg->err) = mqtt_publish_ref(msg->client, msg->topic, msg->payload, msg->payload_length, msg->qos,
+                                   msg->retain, msg->request_cb, msg->arg);
+    sys_sem_signal(msg->sem);
+}
+
 static void
 lwip_do_mqtt_sub_unsub(void *arg)
 {
@@ -152,6 +162,40 @@ err_t lwip_mqtt_publish(mqtt_client_t *client, const char *topic, const void *pa
     return err;
 }
 
+err_t lwip_mqtt_publish_ref(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos, u8_t retain,
+                            mqtt_request_cb_t cb, void *arg)
+{
+    struct mqtt_api_msg msg = {0};
+    err_t err;
+    err_t cberr;
+    sys_sem_t sem;
+
+    msg.err = &err;
+    msg.sem = &sem;
+    msg.client = client;
+    msg.topic = topic;
+    msg.payload = payload;
+    msg.payload_length = payload_length;
+    msg.qos = qos;
+    msg.retain = retain;
+    msg.request_cb = cb;
+    msg.arg = arg;
+    err = sys_sem_new(msg.sem, 0);
+    if (err != ERR_OK)
+    {
+        return err;
+    }
+    cberr = tcpip_callback(lwip_do_mqtt_publish_ref, &msg);
+    if (cberr != ERR_OK)
+    {
+        sys_sem_free(msg.sem);
+        return cberr;
+    }
+    sys_sem_wait(msg.sem);
+    sys_sem_free(msg.sem);
+    return err;
+}
+
 err_t lwip_mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos, mqtt_request_cb_t cb, void *arg, u8_t sub)
 {
     struct mqtt_api_msg msg = {0};
@@ -19,6 +19,7 @@
 #include "at_engine.h"
 #include "drv_rtc.h"
 #include "drv_rng.h"
+#include "drv_aes.h"
 
 #define NET_ENGINE_EVENT_QUEUE_SIZE 32
 
@@ -36,6 +37,55 @@ uint32_t sys_get_srand()
     return srand;
 }
 
+uint32_t sys_rand(void)
+{
+    uint32_t r;
+    if (!drvRngRandom(&r, sizeof(r)))
+        r = (uint32_t)rand();
+    return r;
+}
+
+static uint32_t prvIpAddrFold(const ip_addr_t *addr)
+{
+    uint32_t words[(sizeof(ip_addr_t) + 3) / 4] = {};
+    uint32_t fold = 0;
+
+    memcpy(words, addr, sizeof(ip_addr_t));
+    for (unsigned n = 0; n < OSI_ARRAY_SIZE(words); n++)
+        fold ^= words[n];
+    return fold;
+}
+
+/**
+ * TCP initial sequence number of RFC 6528, ISN = M + F(4-tuple, secret).
+ * M is the 4us timer, and F is AES-128 with a random secret key. It is
+ * only called in tcpip thread.
+ */
+uint32_t sys_tcp_isn(const void *local_ip, uint16_t local_port, const void *remote_ip, uint16_t remote_port)
+{
+    static uint8_t secret[16];
+    static bool secret_ready = false;
+    uint32_t block[4];
+
+    if (!secret_ready)
+    {
+        if (!drvRngRandom(secret, sizeof(secret)))
+        {
+            for (unsigned n = 0; n < sizeof(secret); n++)
+                secret[n] = (uint8_t)rand();
+        }
+        secret_ready = true;
+    }
+
+    block[0] = prvIpAddrFold((const ip_addr_t *)local_ip);
+    block[1] = prvIpAddrFold((const ip_addr_t *)remote_ip);
+    block[2] = ((uint32_t)local_port << 16) | remote_port;
+    block[3] = 0;
+    aesEncryptObj(block, sizeof(block), secret);
+
+    return block[0] + (uint32_t)(osiUpTimeUS() / 4);
+}
+
 err_t sys_sem_new(sys_sem_t *sem, u8_t count)
 {
     if (NULL == sem)
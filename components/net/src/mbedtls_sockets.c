@@ -1,5 +1,6 @@
 
 #include "mbedtls_sockets.h"
+#include "mbedtls/ssl_client_cache.h"
 #include "osi_log.h"
 /*******************************************************************************
 **  MACRO
@@ -17,6 +18,11 @@
 
 #define BUF_SIZE 1024
 
+/* Ask servers for 4KB records by default, so the record buffers of each
+ * connection are 2 x 4KB instead of 2 x 16KB after handshake. */
+#define TLSSOCK_DEFAULT_FRAG_LEN 4096
+#define TLSSOCK_DEFAULT_CONTENT_LEN 4096
+
 /*******************************************************************************
 **  Type definition
 ********************************************************************************/
@@ -26,7 +32,6 @@
 *******************************************************************************/
 static osiThread_t *s_tlssock_task_id = NULL;
 static TLSSOCK_CONTEXT *g_tlssock_context[TLSSOCK_HANDLE_MAX_NUM];
-static mbedtls_ssl_session s_savedSession;
 
 const char *pers = "rda_sock";
 static osiSemaphore_t *s_tlssock_sema[TLSSOCK_HANDLE_MAX_NUM] = {NULL};
@@ -433,7 +438,6 @@ void mbedtlsSocket_Init(void)
         s_read_sema = NULL;
     }
     s_read_sema = osiSemaphoreCreate(1, 1);
-    memset(&s_savedSession, 0, sizeof(mbedtls_ssl_session));
     mbedtls_debug_set_threshold(3);
 
     s_tlssock_task_id = osiThreadCreate("AT TLS Task", Mbedsocket_TaskEntry, NULL,
@@ -637,6 +641,11 @@ static void Mbedsocket_InternalRead(TLSSOCK_HANDLE handle)
 
         if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
         {
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+            // nothing more to read, release the record buffers until next data
+            if (ret == MBEDTLS_ERR_SSL_WANT_READ)
+                mbedtls_ssl_shrink_buffers(&(tlssock_ptr->ssl));
+#endif
             return;
         }
 
@@ -683,6 +692,38 @@ static void Mbedsocket_InternalRead(TLSSOCK_HANDLE handle)
     MBEDSOCKET_TRACE("release s_read_sema");
 }
 
+static int32_t tlssock_frag_len(TLSSOCK_CONTEXT *tlssock_ptr, uint32_t len)
+{
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    unsigned char mfl_code;
+
+    switch (len)
+    {
+    case 0:
+        mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+        break;
+    case 512:
+        mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+        break;
+    case 1024:
+        mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+        break;
+    case 2048:
+        mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+        break;
+    case 4096:
+        mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+        break;
+    default:
+        return -1;
+    }
+
+    return (mbedtls_ssl_conf_max_frag_len(&(tlssock_ptr->conf), mfl_code) == 0) ? 0 : -1;
+#else
+    return (len == 0) ? 0 : -1;
+#endif
+}
+
 static int32_t tls_init(TLSSOCK_HANDLE handle, HANDLE notify_task)
 {
     TLSSOCK_CONTEXT *tlssock_ptr = (TLSSOCK_CONTEXT *)handle;
@@ -791,6 +832,12 @@ static int32_t tls_init(TLSSOCK_HANDLE handle, HANDLE notify_task)
         * but makes interop easier in this simplified example */
     mbedtls_ssl_conf_authmode(&(tlssock_ptr->conf), MBEDTLS_SSL_VERIFY_OPTIONAL);
 
+    tlssock_frag_len(tlssock_ptr, TLSSOCK_DEFAULT_FRAG_LEN);
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    mbedtls_ssl_conf_content_len(&(tlssock_ptr->conf), TLSSOCK_DEFAULT_CONTENT_LEN,
+                                 TLSSOCK_DEFAULT_CONTENT_LEN);
+#endif
+
     tlssock_ptr->notify_task = notify_task;
     tlssock_ptr->report_flag = 0;
     tlssock_ptr->nCid = TLSSOCK_INVALID_CID;
@@ -869,15 +916,21 @@ int32_t mbedtls_connect(TLSSOCK_HANDLE handle)
     TLSSOCK_CONTEXT *tlssock_ptr = (TLSSOCK_CONTEXT *)handle;
     uint32_t flags;
     mbedtls_net_context *ctx;
+    in_addr s_ip;
+    char host[16];
+    bool resumed = false;
 
     ctx = &(tlssock_ptr->server_fd);
+    s_ip.s_addr = tlssock_ptr->fip;
+    strncpy(host, inet_ntoa(s_ip), sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
 
     //mbedtls_net_set_block(ctx);
     mbedtls_net_set_block(ctx);
 
     /** 2. Setup stuff **/
 #if defined(MBEDTLS_SSL_SESSION_TICKETS)
-    mbedtls_ssl_conf_session_tickets(&(tlssock_ptr->conf), MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+    mbedtls_ssl_conf_session_tickets(&(tlssock_ptr->conf), MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
 #endif
     mbedtls_ssl_conf_ca_chain(&(tlssock_ptr->conf), &(tlssock_ptr->cacert), NULL);
     mbedtls_ssl_conf_rng(&(tlssock_ptr->conf), mbedtls_ctr_drbg_random, &(tlssock_ptr->ctr_drbg));
@@ -901,10 +954,12 @@ int32_t mbedtls_connect(TLSSOCK_HANDLE handle)
     mbedtls_ssl_set_bio(&(tlssock_ptr->ssl), &(tlssock_ptr->server_fd),
                         mbedtls_net_send, mbedtls_net_recv, mbedtls_rda_recv_timeout);
 
-    /*if ((ret = mbedtls_ssl_set_session(&(tlssock_ptr->ssl), &s_savedSession)) != 0)
+    // try to resume the last session to this server, it isn't an error if failed
+    if (mbedtls_ssl_client_cache_load(&(tlssock_ptr->ssl), host, tlssock_ptr->fport) == 0)
     {
-        MBEDSOCKET_TRACE(" failed\n  ! mbedtls_ssl_conf_session returned %d\n\n", ret);
-    }*/
+        MBEDSOCKET_TRACE("TlsSock: resume cached session\r\n");
+        resumed = true;
+    }
 
     /** 3. Handshake **/
     MBEDSOCKET_TRACE("TlsSock: Performing the SSL/TLS handshake...\r\n");
@@ -914,6 +969,8 @@ int32_t mbedtls_connect(TLSSOCK_HANDLE handle)
         if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
         {
             MBEDSOCKET_TRACE("TlsSock: failed --- mbedtls_ssl_handshake returned -0x%x", -ret);
+            if (resumed)
+                mbedtls_ssl_client_cache_remove(&(tlssock_ptr->ssl), host, tlssock_ptr->fport);
 
             goto exit;
         }
@@ -940,11 +997,7 @@ int32_t mbedtls_connect(TLSSOCK_HANDLE handle)
         MBEDSOCKET_TRACE("TlsSock: Verifying peer X.509 certificate ok\n");
     }
 
-    /*if ((ret = mbedtls_ssl_get_session(&(tlssock_ptr->ssl), &s_savedSession)) != 0)
-    {
-        MBEDSOCKET_TRACE(" failed\n  ! mbedtls_ssl_get_session returned -0x%x\n\n", -ret);
-        goto exit;
-    }*/
+    mbedtls_ssl_client_cache_save(&(tlssock_ptr->ssl), host, tlssock_ptr->fport);
 
     mbedtls_ssl_conf_read_timeout(&(tlssock_ptr->conf), MBEDTLS_READ_TIMEOUT);
     tlssock_ptr->state = TLSSOCK_STATE_CONNECTED;
@@ -1275,6 +1328,18 @@ int32_t mbedtlsSocket_Cfg(TLSSOCK_HANDLE handle, TLSSOCK_CFG_TYPE_E type, uint32
         {
             MBEDSOCKET_TRACE("TLSSOCK_CFG_TYPE_CLI_CERT: failed --- mbedtls_x509_crt_parse returned -0x%lx", -ret);
         }
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+        else
+        {
+            // the certificate message should fit in output buffer
+            const mbedtls_x509_crt *crt;
+            size_t chain_len = 0;
+            for (crt = &(tlssock_ptr->clicert); crt != NULL; crt = crt->next)
+                chain_len += crt->raw.len + 3;
+            if (chain_len + 7 > tlssock_ptr->conf.out_content_len)
+                mbedtls_ssl_conf_content_len(&(tlssock_ptr->conf), tlssock_ptr->conf.in_content_len, 0);
+        }
+#endif
         break;
     case TLSSOCK_CFG_TYPE_CLI_KEY:
         pCrt = (TLSSOCK_CRT_T *)param;
@@ -1286,6 +1351,16 @@ int32_t mbedtlsSocket_Cfg(TLSSOCK_HANDLE handle, TLSSOCK_CFG_TYPE_E type, uint32
             MBEDSOCKET_TRACE("TLSSOCK_CFG_TYPE_CLI_KEY: failed --- mbedtls_pk_parse_key returned -0x%lx", -ret);
         }
         break;
+    case TLSSOCK_CFG_TYPE_MAX_FRAG_LEN:
+        ret = tlssock_frag_len(tlssock_ptr, param);
+        break;
+    case TLSSOCK_CFG_TYPE_BUF_LEN:
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+        if (mbedtls_ssl_conf_content_len(&(tlssock_ptr->conf), param & 0x0000FFFF,
+                                         (param & 0xFFFF0000) >> 16) != 0)
+            ret = -1;
+#endif
+        break;
     case TLSSOCK_CFG_TYPE_IGNORE_RTC_TIME:
     case TLSSOCK_CFG_TYPE_HTTPS:
     case TLSSOCK_CFG_TYPE_HTTPS_CTXI:
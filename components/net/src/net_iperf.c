@@ -0,0 +1,762 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "net_iperf.h"
+#include "kernel_config.h"
+#include "osi_api.h"
+#include "osi_api_inside.h"
+#include "osi_log.h"
+#include "osi_mem.h"
+#include "osi_profile.h"
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+#include "lwip/tcpip.h"
+#include "lwip/timeouts.h"
+#include "lwip/apps/lwiperf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NET_IPERF_UDP_TICK (10)          // UDP client pacing period in ms
+#define NET_IPERF_UDP_BURST (32)         // maximum datagrams in one pacing tick
+#define NET_IPERF_UDP_FIN_RETRY (10)     // the same as iperf2 client
+#define NET_IPERF_UDP_FIN_INTERVAL (250) // the same as iperf2 client
+#define NET_IPERF_HEADER_VERSION1 (0x80000000)
+#define NET_IPERF_THREAD_NONE (~0U)
+
+// iperf2 UDP datagram header, network byte order
+typedef struct
+{
+    int32_t id;
+    uint32_t tv_sec;
+    uint32_t tv_usec;
+} netIperfUdpHdr_t;
+
+// iperf2 server report, after UDP datagram header, network byte order
+typedef struct
+{
+    int32_t flags;
+    int32_t total_len1;
+    int32_t total_len2;
+    int32_t stop_sec;
+    int32_t stop_usec;
+    int32_t error_cnt;
+    int32_t outorder_cnt;
+    int32_t datagrams;
+    int32_t jitter1;
+    int32_t jitter2;
+} netIperfServerHdr_t;
+
+#define NET_IPERF_UDP_LEN_MIN (sizeof(netIperfUdpHdr_t) + sizeof(netIperfServerHdr_t))
+
+// counters at the start of report window
+typedef struct
+{
+    int64_t time;
+    uint64_t bytes;
+    uint32_t datagrams;
+    uint32_t lost;
+    uint32_t outorder;
+    uint32_t rexmit;
+    uint64_t net_run_us;
+    uint64_t idle_run_us;
+    unsigned netif_count;
+    netIperfNetifStat_t netif[NET_IPERF_NETIF_MAX];
+} netIperfSnap_t;
+
+typedef struct
+{
+    netIperfConfig_t cfg;
+    netIperfReportCb_t cb;
+    void *cb_ctx;
+    int64_t end_time;
+    int error;
+
+    void *lwiperf;
+    struct tcp_pcb *tpcb;
+    struct udp_pcb *upcb;
+
+    uint64_t bytes;
+    uint32_t datagrams;
+    uint32_t lost;
+    uint32_t outorder;
+    uint32_t jitter_us;
+
+    int64_t udp_start_us;
+    int32_t udp_id;
+    unsigned udp_fin_count;
+    bool udp_active;
+    int32_t udp_last_id;
+    int64_t udp_last_transit;
+    int64_t udp_jitter16;
+    bool udp_fin_valid;
+    netIperfServerHdr_t udp_fin;
+
+    unsigned net_thread;
+    unsigned idle_thread;
+    netIperfSnap_t start;
+    netIperfSnap_t window;
+    netIperfSnap_t session;
+    netIperfSnap_t now;
+    netIperfReport_t report;
+} netIperfContext_t;
+
+static netIperfContext_t *gNetIperf = NULL;
+static uint8_t gNetIperfTxBuf[NET_IPERF_LEN_MAX];
+
+static void prvTick(void *arg);
+static void prvUdpSendTick(void *arg);
+static void prvUdpFin(void *arg);
+
+static void prvTxBufInit(void)
+{
+    // leading zeros is iperf2 client header without flags, so the server
+    // won't start reverse test
+    unsigned hdr = sizeof(netIperfUdpHdr_t) + 24;
+    memset(gNetIperfTxBuf, 0, hdr);
+    for (unsigned n = hdr; n < NET_IPERF_LEN_MAX; n++)
+        gNetIperfTxBuf[n] = '0' + (n % 10);
+}
+
+static unsigned prvThreadNumber(const char *name)
+{
+    unsigned count = osiThreadCount();
+    osiThreadStatus_t *status = (osiThreadStatus_t *)malloc(count * sizeof(osiThreadStatus_t));
+    if (status == NULL)
+        return NET_IPERF_THREAD_NONE;
+
+    unsigned number = NET_IPERF_THREAD_NONE;
+    int num = osiThreadGetAllStatus(status, count);
+    for (int n = 0; n < num; n++)
+    {
+        if (status[n].name != NULL && strcmp(status[n].name, name) == 0)
+        {
+            number = status[n].thread_number;
+            break;
+        }
+    }
+    free(status);
+    return number;
+}
+
+static uint64_t prvThreadRunTime(unsigned number)
+{
+    osiThreadCpuStat_t stat;
+    if (number == NET_IPERF_THREAD_NONE || !osiThreadCpuStat(number, &stat, false))
+        return 0;
+    return stat.run_time_us;
+}
+
+static unsigned prvNetifSample(netIperfNetifStat_t *stats)
+{
+    unsigned count = 0;
+    struct netif *netif;
+    NETIF_FOREACH(netif)
+    {
+        if (count >= NET_IPERF_NETIF_MAX)
+            break;
+
+        netIperfNetifStat_t *s = &stats[count++];
+        snprintf(s->name, sizeof(s->name), "%c%c%u", netif->name[0], netif->name[1], netif->num);
+        s->ul[NET_IPERF_PATH_LWIP] = netif->u32LwipULSize;
+        s->dl[NET_IPERF_PATH_LWIP] = netif->u32LwipDLSize;
+        s->ul[NET_IPERF_PATH_PPP] = netif->u32PPPULSize;
+        s->dl[NET_IPERF_PATH_PPP] = netif->u32PPPDLSize;
+        s->ul[NET_IPERF_PATH_RNDIS] = netif->u32RndisULSize;
+        s->dl[NET_IPERF_PATH_RNDIS] = netif->u32RndisDLSize;
+    }
+    return count;
+}
+
+static void prvSnap(netIperfContext_t *d, netIperfSnap_t *s)
+{
+    s->time = osiUpTime();
+    s->bytes = d->bytes;
+    s->datagrams = d->datagrams;
+    s->lost = d->lost;
+    s->outorder = d->outorder;
+#if TCP_REXMIT_COUNT
+    s->rexmit = tcp_get_rexmit_count();
+#else
+    s->rexmit = 0;
+#endif
+    s->net_run_us = prvThreadRunTime(d->net_thread);
+    s->idle_run_us = prvThreadRunTime(d->idle_thread);
+    s->netif_count = prvNetifSample(s->netif);
+}
+
+static int prvPermille(unsigned number, uint64_t run_us, uint32_t ms)
+{
+    if (number == NET_IPERF_THREAD_NONE || ms == 0)
+        return -1;
+
+    uint64_t permille = run_us / ms; // us per ms is permille
+    return (permille > 1000) ? 1000 : (int)permille;
+}
+
+// fill report with the counters from base to now, and d->now is updated
+static void prvReportFill(netIperfContext_t *d, netIperfEvent_t event, const netIperfSnap_t *base)
+{
+    netIperfSnap_t *now = &d->now;
+    netIperfReport_t *r = &d->report;
+
+    prvSnap(d, now);
+    memset(r, 0, sizeof(*r));
+    r->event = event;
+    r->error = d->error;
+    r->duration_ms = (uint32_t)(now->time - base->time);
+    r->bytes = now->bytes - base->bytes;
+    r->kbps = (r->duration_ms == 0) ? 0 : (uint32_t)(r->bytes * 8 / r->duration_ms);
+    r->datagrams = now->datagrams - base->datagrams;
+    r->lost = now->lost - base->lost;
+    r->outorder = now->outorder - base->outorder;
+    r->jitter_us = d->jitter_us;
+    r->rexmit = now->rexmit - base->rexmit;
+    r->net_cpu_permille = prvPermille(d->net_thread, now->net_run_us - base->net_run_us, r->duration_ms);
+    r->cpu_permille = prvPermille(d->idle_thread, now->idle_run_us - base->idle_run_us, r->duration_ms);
+    if (r->cpu_permille >= 0)
+        r->cpu_permille = 1000 - r->cpu_permille;
+
+#ifdef CONFIG_KERNEL_MEM_BUDGET
+    osiMemBudgetStat_t mstat;
+    if (osiMemBudgetStat(OSI_MEM_BUDGET_LWIP, &mstat))
+    {
+        r->mem_used = mstat.used;
+        r->mem_peak = mstat.peak;
+    }
+#endif
+
+    // netif not found in base is created in the window, and its counters
+    // start from 0
+    r->netif_count = now->netif_count;
+    for (unsigned n = 0; n < now->netif_count; n++)
+    {
+        const netIperfNetifStat_t *s = &now->netif[n];
+        const netIperfNetifStat_t *b = NULL;
+        for (unsigned m = 0; m < base->netif_count; m++)
+        {
+            if (strcmp(base->netif[m].name, s->name) == 0)
+            {
+                b = &base->netif[m];
+                break;
+            }
+        }
+
+        netIperfNetifStat_t *o = &r->netif[n];
+        memcpy(o->name, s->name, sizeof(o->name));
+        for (unsigned p = 0; p < NET_IPERF_PATH_COUNT; p++)
+        {
+            o->ul[p] = s->ul[p] - ((b == NULL) ? 0 : b->ul[p]);
+            o->dl[p] = s->dl[p] - ((b == NULL) ? 0 : b->dl[p]);
+        }
+    }
+}
+
+static void prvReportSend(netIperfContext_t *d)
+{
+    OSI_LOGI(0, "iperf report %d: %u ms, %u kbps, cpu %d/%d, rexmit %u",
+             d->report.event, d->report.duration_ms, d->report.kbps,
+             d->report.net_cpu_permille, d->report.cpu_permille, d->report.rexmit);
+    if (d->cb != NULL)
+        d->cb(d->cb_ctx, &d->report);
+}
+
+static void prvTickStart(netIperfContext_t *d)
+{
+    int64_t now = osiUpTime();
+    uint32_t ms = d->cfg.interval_ms;
+    if (d->end_time != 0)
+    {
+        int64_t remained = d->end_time - now;
+        if (remained < 0)
+            remained = 0;
+        if (ms == 0 || ms > remained)
+            ms = (uint32_t)remained;
+    }
+    else if (ms == 0)
+    {
+        return;
+    }
+
+    sys_timeout(ms, prvTick, d);
+}
+
+// it will return ERR_ABRT when the TCP pcb is aborted, and it should
+// be returned by TCP callback
+static err_t prvEnd(netIperfContext_t *d, int error)
+{
+    err_t res = ERR_OK;
+
+    sys_untimeout(prvTick, d);
+    sys_untimeout(prvUdpSendTick, d);
+    sys_untimeout(prvUdpFin, d);
+
+    if (d->lwiperf != NULL)
+    {
+        // lwiperf will report the aborted sessions
+        void *lwiperf = d->lwiperf;
+        d->lwiperf = NULL;
+        lwiperf_abort(lwiperf);
+    }
+
+    if (d->tpcb != NULL)
+    {
+        struct tcp_pcb *pcb = d->tpcb;
+        d->tpcb = NULL;
+        tcp_arg(pcb, NULL);
+        tcp_sent(pcb, NULL);
+        tcp_recv(pcb, NULL);
+        tcp_err(pcb, NULL);
+        if (tcp_close(pcb) != ERR_OK)
+        {
+            tcp_abort(pcb);
+            res = ERR_ABRT;
+        }
+    }
+
+    if (d->upcb != NULL)
+    {
+        udp_remove(d->upcb);
+        d->upcb = NULL;
+    }
+
+    if (d->error == 0)
+        d->error = error;
+
+    prvReportFill(d, NET_IPERF_EV_END, &d->start);
+    prvReportSend(d);
+
+    gNetIperf = NULL;
+    free(d);
+    return res;
+}
+
+static void prvLwiperfReport(void *arg, enum lwiperf_report_type report_type,
+                             const ip_addr_t *local_addr, u16_t local_port,
+                             const ip_addr_t *remote_addr, u16_t remote_port,
+                             u32_t bytes_transferred, u32_t ms_duration,
+                             u32_t bandwidth_kbitpsec)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+    if (d != gNetIperf)
+        return;
+
+    d->bytes += bytes_transferred;
+    prvReportFill(d, NET_IPERF_EV_SESSION, &d->session);
+    d->report.error = (report_type == LWIPERF_TCP_DONE_SERVER) ? ERR_OK : ERR_ABRT;
+    d->report.kbps = bandwidth_kbitpsec;
+    prvReportSend(d);
+    d->session = d->now;
+}
+
+static void prvTcpSendMore(netIperfContext_t *d)
+{
+    struct tcp_pcb *pcb = d->tpcb;
+    for (;;)
+    {
+        u16_t len = (u16_t)LWIP_MIN(tcp_sndbuf(pcb), d->cfg.length);
+        if (len == 0 || tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN - 1)
+            break;
+
+        // the buffer is static and never changed, no need to copy
+        if (tcp_write(pcb, gNetIperfTxBuf, len, TCP_WRITE_FLAG_MORE) != ERR_OK)
+            break;
+    }
+    tcp_output(pcb);
+}
+
+static err_t prvTcpSent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+    d->bytes += len;
+    prvTcpSendMore(d);
+    return ERR_OK;
+}
+
+static err_t prvTcpRecv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+    if (p == NULL)
+        return prvEnd(d, ERR_CLSD);
+
+    // iperf server won't send data, just drop it
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void prvTcpErr(void *arg, err_t err)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+    d->tpcb = NULL; // already freed
+    prvEnd(d, err);
+}
+
+static err_t prvTcpConnected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+    prvTcpSendMore(d);
+    return ERR_OK;
+}
+
+static err_t prvUdpSendDatagram(netIperfContext_t *d, int32_t id)
+{
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, sizeof(netIperfUdpHdr_t), PBUF_RAM);
+    if (p == NULL)
+        return ERR_MEM;
+
+    struct pbuf *q = pbuf_alloc(PBUF_RAW, d->cfg.length - sizeof(netIperfUdpHdr_t), PBUF_ROM);
+    if (q == NULL)
+    {
+        pbuf_free(p);
+        return ERR_MEM;
+    }
+    q->payload = gNetIperfTxBuf + sizeof(netIperfUdpHdr_t);
+    pbuf_cat(p, q);
+
+    // only the difference of timestamps is used by server
+    int64_t up = osiUpTimeUS();
+    netIperfUdpHdr_t *hdr = (netIperfUdpHdr_t *)p->payload;
+    hdr->id = (int32_t)lwip_htonl((u32_t)id);
+    hdr->tv_sec = lwip_htonl((u32_t)(up / 1000000));
+    hdr->tv_usec = lwip_htonl((u32_t)(up % 1000000));
+
+    err_t err = udp_send(d->upcb, p);
+    pbuf_free(p);
+    return err;
+}
+
+static void prvUdpSendTick(void *arg)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+
+    // kbps * us / 8000 is bytes
+    int64_t elapsed = osiUpTimeUS() - d->udp_start_us;
+    uint64_t allowed = (uint64_t)elapsed * d->cfg.rate_kbps / 8000;
+    for (unsigned n = 0; n < NET_IPERF_UDP_BURST; n++)
+    {
+        if (d->bytes + d->cfg.length > allowed)
+            break;
+        if (prvUdpSendDatagram(d, d->udp_id) != ERR_OK)
+            break;
+
+        d->udp_id++;
+        d->datagrams++;
+        d->bytes += d->cfg.length;
+    }
+
+    sys_timeout(NET_IPERF_UDP_TICK, prvUdpSendTick, d);
+}
+
+static void prvUdpFin(void *arg)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+
+    // results without server report are still valid for sending side
+    if (d->udp_fin_count++ >= NET_IPERF_UDP_FIN_RETRY)
+    {
+        prvEnd(d, ERR_TIMEOUT);
+        return;
+    }
+
+    prvUdpSendDatagram(d, -d->udp_id);
+    sys_timeout(NET_IPERF_UDP_FIN_INTERVAL, prvUdpFin, d);
+}
+
+static void prvUdpClientRecv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                             const ip_addr_t *addr, u16_t port)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+    netIperfUdpHdr_t hdr;
+    netIperfServerHdr_t srv;
+
+    if (d->udp_fin_count == 0 ||
+        pbuf_copy_partial(p, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+        pbuf_copy_partial(p, &srv, sizeof(srv), sizeof(hdr)) != sizeof(srv) ||
+        (int32_t)lwip_ntohl((u32_t)hdr.id) >= 0 ||
+        (lwip_ntohl((u32_t)srv.flags) & NET_IPERF_HEADER_VERSION1) == 0)
+    {
+        pbuf_free(p);
+        return;
+    }
+    pbuf_free(p);
+
+    d->lost = lwip_ntohl((u32_t)srv.error_cnt);
+    d->outorder = lwip_ntohl((u32_t)srv.outorder_cnt);
+    d->jitter_us = lwip_ntohl((u32_t)srv.jitter1) * 1000000 + lwip_ntohl((u32_t)srv.jitter2);
+    prvEnd(d, ERR_OK);
+}
+
+static void prvUdpServerReply(netIperfContext_t *d, const netIperfUdpHdr_t *hdr,
+                              const ip_addr_t *addr, u16_t port)
+{
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, NET_IPERF_UDP_LEN_MIN, PBUF_RAM);
+    if (p == NULL)
+        return;
+
+    memcpy(p->payload, hdr, sizeof(*hdr));
+    memcpy((uint8_t *)p->payload + sizeof(*hdr), &d->udp_fin, sizeof(d->udp_fin));
+    udp_sendto(d->upcb, p, addr, port);
+    pbuf_free(p);
+}
+
+static void prvUdpServerRecv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                             const ip_addr_t *addr, u16_t port)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+    netIperfUdpHdr_t hdr;
+
+    int64_t arrival = osiUpTimeUS();
+    u16_t len = p->tot_len;
+    if (pbuf_copy_partial(p, &hdr, sizeof(hdr), 0) != sizeof(hdr))
+    {
+        pbuf_free(p);
+        return;
+    }
+    pbuf_free(p);
+
+    int32_t id = (int32_t)lwip_ntohl((u32_t)hdr.id);
+    if (id < 0)
+    {
+        if (d->udp_active)
+        {
+            prvReportFill(d, NET_IPERF_EV_SESSION, &d->session);
+
+            const netIperfReport_t *r = &d->report;
+            netIperfServerHdr_t *srv = &d->udp_fin;
+            srv->flags = (int32_t)lwip_htonl(NET_IPERF_HEADER_VERSION1);
+            srv->total_len1 = (int32_t)lwip_htonl((u32_t)(r->bytes >> 32));
+            srv->total_len2 = (int32_t)lwip_htonl((u32_t)r->bytes);
+            srv->stop_sec = (int32_t)lwip_htonl(r->duration_ms / 1000);
+            srv->stop_usec = (int32_t)lwip_htonl((r->duration_ms % 1000) * 1000);
+            srv->error_cnt = (int32_t)lwip_htonl(r->lost);
+            srv->outorder_cnt = (int32_t)lwip_htonl(r->outorder);
+            srv->datagrams = (int32_t)lwip_htonl(r->datagrams + r->lost);
+            srv->jitter1 = (int32_t)lwip_htonl(r->jitter_us / 1000000);
+            srv->jitter2 = (int32_t)lwip_htonl(r->jitter_us % 1000000);
+            d->udp_fin_valid = true;
+            d->udp_active = false;
+
+            prvReportSend(d);
+            d->session = d->now;
+        }
+
+        // client will resend the final datagram when the report is lost
+        if (d->udp_fin_valid)
+            prvUdpServerReply(d, &hdr, addr, port);
+        return;
+    }
+
+    if (!d->udp_active)
+    {
+        prvSnap(d, &d->session);
+        d->udp_active = true;
+        d->udp_last_id = -1;
+        d->udp_jitter16 = 0;
+        d->jitter_us = 0;
+    }
+
+    // jitter by RFC 1889, J += (|D| - J) / 16, and 16 * J is kept
+    int64_t sent = (int64_t)lwip_ntohl(hdr.tv_sec) * 1000000 + lwip_ntohl(hdr.tv_usec);
+    int64_t transit = arrival - sent;
+    if (d->udp_last_id >= 0)
+    {
+        int64_t delta = transit - d->udp_last_transit;
+        if (delta < 0)
+            delta = -delta;
+        d->udp_jitter16 += delta - (d->udp_jitter16 + 8) / 16;
+        d->jitter_us = (uint32_t)(d->udp_jitter16 / 16);
+    }
+    d->udp_last_transit = transit;
+
+    // loss and out of order, the same as iperf2 server
+    if (id != d->udp_last_id + 1)
+    {
+        if (id < d->udp_last_id + 1)
+            d->outorder++;
+        else
+            d->lost += id - d->udp_last_id - 1;
+    }
+    if (id > d->udp_last_id)
+        d->udp_last_id = id;
+
+    d->datagrams++;
+    d->bytes += len;
+}
+
+static void prvTick(void *arg)
+{
+    netIperfContext_t *d = (netIperfContext_t *)arg;
+
+    if (d->end_time != 0 && osiUpTime() >= d->end_time)
+    {
+        if (d->cfg.mode != NET_IPERF_UDP_CLIENT)
+        {
+            prvEnd(d, ERR_OK);
+            return;
+        }
+
+        // stop sending, and wait server report
+        sys_untimeout(prvUdpSendTick, d);
+        d->end_time = 0;
+        prvUdpFin(d);
+        return;
+    }
+
+    if (d->cfg.interval_ms != 0)
+    {
+        prvReportFill(d, NET_IPERF_EV_INTERVAL, &d->window);
+        prvReportSend(d);
+        d->window = d->now;
+    }
+    prvTickStart(d);
+}
+
+static bool prvStartLocked(netIperfContext_t *d)
+{
+    const netIperfConfig_t *cfg = &d->cfg;
+    err_t err;
+
+    switch (cfg->mode)
+    {
+    case NET_IPERF_TCP_SERVER:
+        d->lwiperf = lwiperf_start_tcp_server(IP_ADDR_ANY, cfg->port, prvLwiperfReport, d);
+        return d->lwiperf != NULL;
+
+    case NET_IPERF_TCP_CLIENT:
+        d->tpcb = tcp_new_ip_type(IP_GET_TYPE(&cfg->remote));
+        if (d->tpcb == NULL)
+            return false;
+
+        tcp_arg(d->tpcb, d);
+        tcp_sent(d->tpcb, prvTcpSent);
+        tcp_recv(d->tpcb, prvTcpRecv);
+        tcp_err(d->tpcb, prvTcpErr);
+        err = tcp_connect(d->tpcb, &cfg->remote, cfg->port, prvTcpConnected);
+        if (err != ERR_OK)
+        {
+            tcp_abort(d->tpcb);
+            d->tpcb = NULL;
+            return false;
+        }
+        return true;
+
+    case NET_IPERF_UDP_SERVER:
+    case NET_IPERF_UDP_CLIENT:
+        d->upcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+        if (d->upcb == NULL)
+            return false;
+
+        if (cfg->mode == NET_IPERF_UDP_SERVER)
+        {
+            err = udp_bind(d->upcb, IP_ANY_TYPE, cfg->port);
+            udp_recv(d->upcb, prvUdpServerRecv, d);
+        }
+        else
+        {
+            err = udp_connect(d->upcb, &cfg->remote, cfg->port);
+            udp_recv(d->upcb, prvUdpClientRecv, d);
+        }
+
+        if (err != ERR_OK)
+        {
+            udp_remove(d->upcb);
+            d->upcb = NULL;
+            return false;
+        }
+
+        if (cfg->mode == NET_IPERF_UDP_CLIENT)
+        {
+            d->udp_start_us = osiUpTimeUS();
+            sys_timeout(NET_IPERF_UDP_TICK, prvUdpSendTick, d);
+        }
+        return true;
+
+    case NET_IPERF_MONITOR:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool netIperfStart(const netIperfConfig_t *cfg, netIperfReportCb_t cb, void *ctx)
+{
+    if (cfg == NULL)
+        return false;
+
+    bool client = (cfg->mode == NET_IPERF_TCP_CLIENT || cfg->mode == NET_IPERF_UDP_CLIENT);
+    bool udp = (cfg->mode == NET_IPERF_UDP_SERVER || cfg->mode == NET_IPERF_UDP_CLIENT);
+    uint16_t length = (cfg->length == 0) ? NET_IPERF_LEN_DEFAULT : cfg->length;
+    if (cfg->mode < NET_IPERF_TCP_SERVER || cfg->mode > NET_IPERF_MONITOR)
+        return false;
+    if (client && (cfg->duration_ms == 0 || ip_addr_isany(&cfg->remote)))
+        return false;
+    if (cfg->mode == NET_IPERF_UDP_CLIENT && cfg->rate_kbps == 0)
+        return false;
+    if (length > NET_IPERF_LEN_MAX || (udp && length < NET_IPERF_UDP_LEN_MIN))
+        return false;
+
+    netIperfContext_t *d = (netIperfContext_t *)calloc(1, sizeof(netIperfContext_t));
+    if (d == NULL)
+        return false;
+
+    d->cfg = *cfg;
+    d->cfg.length = length;
+    if (d->cfg.port == 0)
+        d->cfg.port = NET_IPERF_PORT_DEFAULT;
+    d->cb = cb;
+    d->cb_ctx = ctx;
+    d->net_thread = prvThreadNumber(TCPIP_THREAD_NAME);
+    d->idle_thread = prvThreadNumber("IDLE");
+    prvTxBufInit();
+
+#ifdef CONFIG_KERNEL_MEM_BUDGET
+    osiMemBudgetResetPeak(OSI_MEM_BUDGET_LWIP);
+#endif
+
+    LOCK_TCPIP_CORE();
+    if (gNetIperf != NULL || !prvStartLocked(d))
+    {
+        UNLOCK_TCPIP_CORE();
+        OSI_LOGE(0, "iperf start failed, mode %d", cfg->mode);
+        free(d);
+        return false;
+    }
+
+    gNetIperf = d;
+    if (cfg->duration_ms != 0)
+        d->end_time = osiUpTime() + cfg->duration_ms;
+    prvSnap(d, &d->start);
+    d->window = d->start;
+    d->session = d->start;
+    prvTickStart(d);
+    UNLOCK_TCPIP_CORE();
+
+    OSI_LOGI(0, "iperf started, mode %d, port %d", cfg->mode, d->cfg.port);
+    return true;
+}
+
+void netIperfStop(void)
+{
+    LOCK_TCPIP_CORE();
+    if (gNetIperf != NULL)
+        prvEnd(gNetIperf, ERR_OK);
+    UNLOCK_TCPIP_CORE();
+}
+
+bool netIperfIsRunning(void)
+{
+    return gNetIperf != NULL;
+}
@@ -0,0 +1,715 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "net_time_sync.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "drv_rtc.h"
+#include "lwip/udp.h"
+#include "lwip/dns.h"
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+#include "lwip/tcpip.h"
+#include "lwip/timeouts.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define NET_TIME_SAMPLES_DEFAULT (4)
+#define NET_TIME_ACCURACY_DEFAULT (500)                  // ms
+#define NET_TIME_MIN_INTERVAL_DEFAULT (15 * 60)          // s
+#define NET_TIME_MAX_INTERVAL_DEFAULT (7 * 24 * 60 * 60) // s
+#define NET_TIME_RETRY_BASE (60)                         // s, the first retry after failed round
+#define NET_TIME_FIRST_ROUND_DELAY (5000)                // ms
+#define NET_TIME_APPLY_PERIOD (10 * 60 * 1000)           // ms, drift compensation when awake
+#define NET_TIME_RTC_UPDATE_STEP (1000)                  // ms, accumulated compensation to update RTC
+#define NET_TIME_DRIFT_MAX (200000)                      // ppb
+#define NET_TIME_DRIFT_ERROR_INIT (50000)                // ppb, 32K crystal tolerance
+#define NET_TIME_DRIFT_ERROR_MIN (1000)                  // ppb, temperature variation
+#define NET_TIME_BOOT_GAP_MAX (365 * 24 * 60 * 60)       // s
+#define NET_TIME_DNS_TIMEOUT (10000)                     // ms
+#define NET_TIME_NTP_TIMEOUT (2000)                      // ms
+#define NET_TIME_NTP_GAP (500)                           // ms, between requests to the same server
+#define NET_TIME_NTP_PORT (123)
+#define NET_TIME_NTP_PACKET_SIZE (48)
+#define NET_TIME_NTP_UNIX_OFFSET (2208988800ULL) // 1900 to 1970 in seconds
+#define NET_TIME_ERROR_UNKNOWN (UINT32_MAX)
+
+typedef struct
+{
+    netTimeSource_t source;
+    int64_t epoch; // ms
+    int64_t uptime;
+    uint32_t error;
+} netTimeSample_t;
+
+typedef struct
+{
+    bool started;
+    netTimeSyncConfig_t cfg;
+    unsigned server_count;
+    osiMutex_t *lock;
+    osiWork_t *work;       // handle fed sample, compensate drift and schedule
+    osiWork_t *round_work; // start NTP round in TCP/IP thread
+    osiTimer_t *apply_timer;
+    osiTimer_t *round_timer;
+
+    // discipline, protected by lock
+    bool pending_valid;
+    netTimeSample_t pending;
+    bool ref_valid;
+    netTimeSample_t ref;
+    int32_t offset;
+    int32_t drift_ppb;
+    uint32_t drift_error_ppb;
+    int64_t apply_uptime;
+    int64_t apply_remain;   // ms * ppb, not applied yet
+    int64_t rtc_pending;    // ms, applied but not updated to RTC
+    bool reschedule;
+    int64_t next_round;     // uptime
+    uint32_t rounds;
+    uint32_t failures;
+    uint32_t rtt;
+
+    // NTP round, in TCP/IP thread
+    bool round_active;
+    bool round_ok;
+    struct udp_pcb *pcb;
+    unsigned server;
+    unsigned sample;
+    unsigned timeouts;
+    bool dns_waiting;
+    bool ntp_waiting;
+    ip_addr_t addr;
+    uint8_t tx_stamp[8];
+    int64_t tx_us;
+    netTimeSample_t best;
+    uint32_t best_rtt;
+} netTimeSyncContext_t;
+
+static netTimeSyncContext_t gNetTimeSync;
+
+static void prvServerStart(netTimeSyncContext_t *d);
+static void prvQuerySend(void *arg);
+static void prvQueryTimeout(void *arg);
+static void prvDnsTimeout(void *arg);
+
+static uint32_t prvGetBe32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void prvPutBe32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// NTP timestamp to epoch in us, era 1 is selected for seconds with MSB 0
+static int64_t prvNtpToEpochUs(const uint8_t *p)
+{
+    uint64_t sec = prvGetBe32(p);
+    uint64_t frac = prvGetBe32(p + 4);
+    if ((sec & 0x80000000U) == 0)
+        sec += 0x100000000ULL;
+    return (int64_t)(sec - NET_TIME_NTP_UNIX_OFFSET) * 1000000 + (int64_t)((frac * 1000000) >> 32);
+}
+
+// NTP short format (16.16 seconds) to ms
+static uint32_t prvNtpShortToMs(const uint8_t *p)
+{
+    return (uint32_t)(((uint64_t)prvGetBe32(p) * 1000) >> 16);
+}
+
+/**
+ * Estimated error of system time at uptime, called with lock.
+ */
+static uint32_t prvErrorAt(netTimeSyncContext_t *d, int64_t uptime)
+{
+    if (!d->ref_valid)
+        return NET_TIME_ERROR_UNKNOWN;
+
+    int64_t span = uptime > d->ref.uptime ? uptime - d->ref.uptime : 0;
+    int64_t error = d->ref.error + (span * d->drift_error_ppb + 999999999) / 1000000000;
+    return error >= NET_TIME_ERROR_UNKNOWN ? NET_TIME_ERROR_UNKNOWN - 1 : (uint32_t)error;
+}
+
+/**
+ * Apply drift compensation from the last apply to now, called with
+ * lock. RTC is updated in work queue only.
+ */
+static void prvApplyDrift(netTimeSyncContext_t *d, bool update_rtc)
+{
+    int64_t now = osiUpTime();
+    int64_t acc = (now - d->apply_uptime) * d->drift_ppb + d->apply_remain;
+    int64_t comp = acc / 1000000000;
+    d->apply_uptime = now;
+    d->apply_remain = acc - comp * 1000000000;
+
+    if (comp != 0)
+    {
+        osiSetEpochTime(osiEpochTime() + comp);
+        d->rtc_pending += comp < 0 ? -comp : comp;
+    }
+
+    if (update_rtc && d->rtc_pending >= NET_TIME_RTC_UPDATE_STEP)
+    {
+        d->rtc_pending = 0;
+        drvRtcUpdateTime();
+    }
+}
+
+/**
+ * Update drift estimation by residual offset between accepted samples,
+ * as a scalar Kalman filter. Called with lock.
+ */
+static void prvDriftUpdate(netTimeSyncContext_t *d, const netTimeSample_t *s, int64_t offset)
+{
+    int64_t span = s->uptime - d->ref.uptime;
+    if (span <= 0)
+        return;
+
+    // offset inconsistent with estimation, time may be set by others
+    uint32_t expected = prvErrorAt(d, s->uptime);
+    if (llabs(offset) > (int64_t)expected + s->error)
+        return;
+
+    double meas = (double)offset * 1e9 / span;
+    double meas_error = (double)(s->error + d->ref.error) * 1e9 / span;
+    double prior = d->drift_error_ppb;
+    if (meas_error >= prior)
+        return;
+
+    double gain = prior * prior / (prior * prior + meas_error * meas_error);
+    double drift = d->drift_ppb + gain * meas;
+    double error = prior * meas_error / sqrt(prior * prior + meas_error * meas_error);
+
+    if (drift > NET_TIME_DRIFT_MAX)
+        drift = NET_TIME_DRIFT_MAX;
+    if (drift < -NET_TIME_DRIFT_MAX)
+        drift = -NET_TIME_DRIFT_MAX;
+    if (error < NET_TIME_DRIFT_ERROR_MIN)
+        error = NET_TIME_DRIFT_ERROR_MIN;
+
+    d->drift_ppb = (int32_t)drift;
+    d->drift_error_ppb = (uint32_t)error;
+    OSI_LOGI(0, "time sync drift %d ppb error %u ppb, residual %d ppb in %u s",
+             d->drift_ppb, d->drift_error_ppb, (int)meas, (unsigned)(span / 1000));
+    drvRtcSetDrift(d->drift_ppb, d->drift_error_ppb);
+}
+
+/**
+ * Step system time to the accepted sample, called with lock.
+ */
+static void prvAccept(netTimeSyncContext_t *d, const netTimeSample_t *s)
+{
+    prvApplyDrift(d, false);
+
+    int64_t offset = s->epoch - osiUpTimeToEpoch(s->uptime);
+    if (d->ref_valid)
+        prvDriftUpdate(d, s, offset);
+
+    osiSetEpochTime(osiEpochTime() + offset);
+    drvRtcUpdateTime();
+    d->rtc_pending = 0;
+
+    OSI_LOGI(0, "time sync source %d offset %d ms error %u ms",
+             s->source, (int)offset, s->error);
+    d->offset = (int32_t)offset;
+    d->ref = *s;
+    d->ref_valid = true;
+    d->reschedule = true;
+}
+
+/**
+ * Delay of the next NTP round in ms, called with lock.
+ */
+static uint32_t prvRoundDelay(netTimeSyncContext_t *d)
+{
+    int64_t min_ms = (int64_t)d->cfg.min_interval_s * 1000;
+    int64_t max_ms = (int64_t)d->cfg.max_interval_s * 1000;
+    int64_t delay;
+
+    if (d->failures > 0)
+    {
+        unsigned shift = OSI_MIN(unsigned, d->failures - 1, 16);
+        delay = OSI_MIN(int64_t, (int64_t)NET_TIME_RETRY_BASE * 1000 << shift, min_ms * 4);
+    }
+    else if (!d->ref_valid || d->ref.error >= d->cfg.accuracy_ms)
+    {
+        delay = min_ms;
+    }
+    else
+    {
+        // the time when estimated error reaches the target accuracy
+        int64_t reach = d->ref.uptime + (int64_t)(d->cfg.accuracy_ms - d->ref.error) * 1000000000 / d->drift_error_ppb;
+        delay = reach - osiUpTime();
+        delay = OSI_MAX(int64_t, delay, min_ms);
+    }
+
+    delay = OSI_MIN(int64_t, delay, max_ms);
+    return (uint32_t)delay;
+}
+
+static void prvWork(void *param)
+{
+    netTimeSyncContext_t *d = (netTimeSyncContext_t *)param;
+
+    osiMutexLock(d->lock);
+    if (!d->started)
+    {
+        osiMutexUnlock(d->lock);
+        return;
+    }
+
+    if (d->pending_valid)
+    {
+        d->pending_valid = false;
+        netTimeSample_t s = d->pending;
+        if (s.error < prvErrorAt(d, s.uptime))
+            prvAccept(d, &s);
+    }
+
+    prvApplyDrift(d, true);
+    osiTimerStartRelaxed(d->apply_timer, NET_TIME_APPLY_PERIOD, OSI_WAIT_FOREVER);
+
+    if (d->reschedule)
+    {
+        d->reschedule = false;
+        uint32_t delay = prvRoundDelay(d);
+        d->next_round = osiUpTime() + delay;
+        osiTimerStartRelaxed(d->round_timer, delay, delay / 4);
+        OSI_LOGI(0, "time sync next round in %u s", delay / 1000);
+    }
+    osiMutexUnlock(d->lock);
+}
+
+static void prvRoundCleanup(netTimeSyncContext_t *d)
+{
+    sys_untimeout(prvQuerySend, d);
+    sys_untimeout(prvQueryTimeout, d);
+    sys_untimeout(prvDnsTimeout, d);
+    if (d->pcb != NULL)
+        udp_remove(d->pcb);
+    d->pcb = NULL;
+    d->round_active = false;
+    d->dns_waiting = false;
+    d->ntp_waiting = false;
+}
+
+/**
+ * NTP round is finished, called in TCP/IP thread.
+ */
+static void prvRoundEnd(netTimeSyncContext_t *d)
+{
+    prvRoundCleanup(d);
+
+    osiMutexLock(d->lock);
+    d->rounds++;
+    d->failures = d->round_ok ? 0 : d->failures + 1;
+    if (d->round_ok)
+    {
+        d->rtt = d->best_rtt;
+        if (!d->pending_valid || d->best.error < d->pending.error)
+        {
+            d->pending = d->best;
+            d->pending_valid = true;
+        }
+    }
+    d->reschedule = true;
+    osiMutexUnlock(d->lock);
+
+    OSI_LOGI(0, "time sync round %s, rtt %u ms", d->round_ok ? "ok" : "failed",
+             d->round_ok ? d->best_rtt : 0);
+    osiWorkEnqueue(d->work, osiSysWorkQueueLowPriority());
+}
+
+static void prvNextServer(netTimeSyncContext_t *d)
+{
+    d->server++;
+    d->sample = 0;
+    d->timeouts = 0;
+    prvServerStart(d);
+}
+
+static void prvQueryNext(netTimeSyncContext_t *d)
+{
+    // skip the server after 2 continuous timeouts
+    if (++d->sample >= d->cfg.samples || d->timeouts >= 2)
+        prvNextServer(d);
+    else
+        sys_timeout(NET_TIME_NTP_GAP, prvQuerySend, d);
+}
+
+static void prvQueryTimeout(void *arg)
+{
+    netTimeSyncContext_t *d = (netTimeSyncContext_t *)arg;
+    if (!d->ntp_waiting)
+        return;
+
+    d->ntp_waiting = false;
+    d->timeouts++;
+    prvQueryNext(d);
+}
+
+static void prvQuerySend(void *arg)
+{
+    netTimeSyncContext_t *d = (netTimeSyncContext_t *)arg;
+
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, NET_TIME_NTP_PACKET_SIZE, PBUF_RAM);
+    if (p == NULL)
+    {
+        prvNextServer(d);
+        return;
+    }
+
+    // transmit timestamp is echoed by server as originate timestamp, and
+    // random fraction bits make it a cookie
+    uint8_t *req = (uint8_t *)p->payload;
+    int64_t now = osiEpochTime();
+    memset(req, 0, NET_TIME_NTP_PACKET_SIZE);
+    req[0] = (4 << 3) | 3; // version 4, client mode
+    prvPutBe32(&req[40], (uint32_t)(now / 1000 + NET_TIME_NTP_UNIX_OFFSET));
+    prvPutBe32(&req[44], (uint32_t)rand());
+    memcpy(d->tx_stamp, &req[40], 8);
+
+    d->tx_us = osiUpTimeUS();
+    err_t err = udp_sendto(d->pcb, p, &d->addr, NET_TIME_NTP_PORT);
+    pbuf_free(p);
+    if (err != ERR_OK)
+    {
+        prvNextServer(d);
+        return;
+    }
+
+    d->ntp_waiting = true;
+    sys_timeout(NET_TIME_NTP_TIMEOUT, prvQueryTimeout, d);
+}
+
+static void prvNtpRecv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                       const ip_addr_t *addr, u16_t port)
+{
+    netTimeSyncContext_t *d = (netTimeSyncContext_t *)arg;
+    int64_t rx_us = osiUpTimeUS();
+    uint8_t rsp[NET_TIME_NTP_PACKET_SIZE];
+
+    bool valid = d->ntp_waiting && ip_addr_cmp(addr, &d->addr) &&
+                 port == NET_TIME_NTP_PORT &&
+                 pbuf_copy_partial(p, rsp, sizeof(rsp), 0) == sizeof(rsp);
+    pbuf_free(p);
+    if (!valid)
+        return;
+
+    unsigned leap = rsp[0] >> 6;
+    unsigned mode = rsp[0] & 7;
+    unsigned stratum = rsp[1];
+    if (leap == 3 || mode != 4 || stratum == 0 || stratum > 15 ||
+        memcmp(&rsp[24], d->tx_stamp, 8) != 0)
+        return; // kiss-o'-death, unsynchronized or not our request
+
+    sys_untimeout(prvQueryTimeout, d);
+    d->ntp_waiting = false;
+    d->timeouts = 0;
+
+    int64_t t2 = prvNtpToEpochUs(&rsp[32]);
+    int64_t t3 = prvNtpToEpochUs(&rsp[40]);
+    int64_t rtt = (rx_us - d->tx_us) - (t3 - t2);
+    if (rtt < 0)
+        rtt = 0;
+
+    uint32_t rtt_ms = (uint32_t)((rtt + 999) / 1000);
+    if (!d->round_ok || rtt_ms < d->best_rtt)
+    {
+        // the sample with minimal round trip has the minimal error
+        d->round_ok = true;
+        d->best_rtt = rtt_ms;
+        d->best.source = NET_TIME_SOURCE_NTP;
+        d->best.epoch = (t2 + t3) / 2000;
+        d->best.uptime = (d->tx_us + rx_us) / 2000;
+        d->best.error = rtt_ms / 2 + prvNtpShortToMs(&rsp[4]) / 2 + prvNtpShortToMs(&rsp[8]) + 1;
+    }
+    prvQueryNext(d);
+}
+
+static void prvDnsTimeout(void *arg)
+{
+    netTimeSyncContext_t *d = (netTimeSyncContext_t *)arg;
+    if (!d->dns_waiting)
+        return;
+
+    d->dns_waiting = false;
+    prvNextServer(d);
+}
+
+static void prvDnsFound(const char *name, const ip_addr_t *ipaddr, void *arg)
+{
+    netTimeSyncContext_t *d = (netTimeSyncContext_t *)arg;
+    if (!d->dns_waiting || d->server >= d->server_count ||
+        strcmp(name, d->cfg.servers[d->server]) != 0)
+        return;
+
+    sys_untimeout(prvDnsTimeout, d);
+    d->dns_waiting = false;
+    if (ipaddr == NULL)
+    {
+        prvNextServer(d);
+        return;
+    }
+
+    ip_addr_copy(d->addr, *ipaddr);
+    prvQuerySend(d);
+}
+
+static void prvServerStart(netTimeSyncContext_t *d)
+{
+    for (; d->server < d->server_count; d->server++)
+    {
+        err_t err = dns_gethostbyname(d->cfg.servers[d->server], &d->addr, prvDnsFound, d);
+        if (err == ERR_OK)
+        {
+            prvQuerySend(d);
+            return;
+        }
+        if (err == ERR_INPROGRESS)
+        {
+            d->dns_waiting = true;
+            sys_timeout(NET_TIME_DNS_TIMEOUT, prvDnsTimeout, d);
+            return;
+        }
+    }
+
+    prvRoundEnd(d);
+}
+
+static void prvRoundStart(void *arg)
+{
+    netTimeSyncContext_t *d = (netTimeSyncContext_t *)arg;
+    if (d->round_active || !d->started)
+        return;
+
+    d->round_active = true;
+    d->round_ok = false;
+    d->server = 0;
+    d->sample = 0;
+    d->timeouts = 0;
+
+    if (netif_default == NULL || !netif_is_up(netif_default))
+    {
+        prvRoundEnd(d);
+        return;
+    }
+
+    d->pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (d->pcb == NULL)
+    {
+        prvRoundEnd(d);
+        return;
+    }
+
+    udp_recv(d->pcb, prvNtpRecv, d);
+    prvServerStart(d);
+}
+
+static void prvRoundWork(void *param)
+{
+    tcpip_callback(prvRoundStart, param);
+}
+
+/**
+ * Compensate the drift from the last RTC update, including power off
+ * period. Called with lock.
+ */
+static void prvBootCompensate(netTimeSyncContext_t *d)
+{
+    int32_t drift_ppb;
+    uint32_t error_ppb;
+    int64_t update_time;
+
+    d->drift_ppb = 0;
+    d->drift_error_ppb = NET_TIME_DRIFT_ERROR_INIT;
+    if (!drvRtcGetDrift(&drift_ppb, &error_ppb, &update_time))
+        return;
+
+    d->drift_ppb = drift_ppb;
+    d->drift_error_ppb = OSI_MAX(uint32_t, error_ppb, NET_TIME_DRIFT_ERROR_MIN);
+
+    int64_t gap = osiEpochSecond() - update_time;
+    if (update_time == 0 || gap <= 0 || gap > NET_TIME_BOOT_GAP_MAX)
+        return;
+
+    int64_t comp = gap * 1000 * drift_ppb / 1000000000;
+    OSI_LOGI(0, "time sync boot compensation %d ms in %u s", (int)comp, (unsigned)gap);
+    if (comp != 0)
+    {
+        osiSetEpochTime(osiEpochTime() + comp);
+        d->rtc_pending += comp < 0 ? -comp : comp;
+    }
+}
+
+bool netTimeSyncStart(const netTimeSyncConfig_t *cfg)
+{
+    netTimeSyncContext_t *d = &gNetTimeSync;
+    if (cfg == NULL)
+        return false;
+
+    unsigned count = 0;
+    while (count < NET_TIME_SYNC_SERVER_MAX && cfg->servers[count] != NULL)
+        count++;
+    if (count == 0)
+        return false;
+
+    if (d->lock == NULL)
+    {
+        d->lock = osiMutexCreate();
+        d->work = osiWorkCreate(prvWork, NULL, d);
+        d->round_work = osiWorkCreate(prvRoundWork, NULL, d);
+        if (d->lock == NULL || d->work == NULL || d->round_work == NULL)
+            return false;
+
+        d->apply_timer = osiTimerCreateWork(d->work, osiSysWorkQueueLowPriority());
+        d->round_timer = osiTimerCreateWork(d->round_work, osiSysWorkQueueLowPriority());
+        if (d->apply_timer == NULL || d->round_timer == NULL)
+            return false;
+    }
+
+    netTimeSyncStop();
+
+    osiMutexLock(d->lock);
+    d->cfg = *cfg;
+    d->server_count = count;
+    if (d->cfg.samples == 0)
+        d->cfg.samples = NET_TIME_SAMPLES_DEFAULT;
+    if (d->cfg.accuracy_ms == 0)
+        d->cfg.accuracy_ms = NET_TIME_ACCURACY_DEFAULT;
+    if (d->cfg.min_interval_s == 0)
+        d->cfg.min_interval_s = NET_TIME_MIN_INTERVAL_DEFAULT;
+    if (d->cfg.max_interval_s == 0)
+        d->cfg.max_interval_s = NET_TIME_MAX_INTERVAL_DEFAULT;
+    d->cfg.max_interval_s = OSI_MAX(uint32_t, d->cfg.max_interval_s, d->cfg.min_interval_s);
+
+    d->pending_valid = false;
+    d->ref_valid = false;
+    d->offset = 0;
+    d->apply_uptime = osiUpTime();
+    d->apply_remain = 0;
+    d->rtc_pending = 0;
+    d->rounds = 0;
+    d->failures = 0;
+    d->rtt = 0;
+    prvBootCompensate(d);
+
+    d->started = true;
+    d->reschedule = false;
+    d->next_round = osiUpTime() + NET_TIME_FIRST_ROUND_DELAY;
+    osiTimerStartRelaxed(d->round_timer, NET_TIME_FIRST_ROUND_DELAY, 0);
+    osiMutexUnlock(d->lock);
+
+    osiWorkEnqueue(d->work, osiSysWorkQueueLowPriority());
+    return true;
+}
+
+void netTimeSyncStop(void)
+{
+    netTimeSyncContext_t *d = &gNetTimeSync;
+    if (d->lock == NULL)
+        return;
+
+    osiMutexLock(d->lock);
+    d->started = false;
+    osiTimerStop(d->round_timer);
+    osiTimerStop(d->apply_timer);
+    osiMutexUnlock(d->lock);
+
+    LOCK_TCPIP_CORE();
+    if (d->round_active)
+        prvRoundCleanup(d);
+    UNLOCK_TCPIP_CORE();
+}
+
+bool netTimeSyncFeed(netTimeSource_t source, int64_t epoch_ms, int64_t uptime_ms, uint32_t error_ms)
+{
+    netTimeSyncContext_t *d = &gNetTimeSync;
+    if (d->lock == NULL)
+        return false;
+
+    osiMutexLock(d->lock);
+    bool started = d->started;
+    bool better = started && error_ms < prvErrorAt(d, uptime_ms) &&
+                  (!d->pending_valid || error_ms < d->pending.error);
+    if (better)
+    {
+        d->pending.source = source;
+        d->pending.epoch = epoch_ms;
+        d->pending.uptime = uptime_ms;
+        d->pending.error = error_ms;
+        d->pending_valid = true;
+    }
+    osiMutexUnlock(d->lock);
+
+    if (better)
+        osiWorkEnqueue(d->work, osiSysWorkQueueLowPriority());
+    return started;
+}
+
+bool netTimeSyncRequest(void)
+{
+    netTimeSyncContext_t *d = &gNetTimeSync;
+    if (d->lock == NULL || !d->started)
+        return false;
+
+    return osiWorkEnqueue(d->round_work, osiSysWorkQueueLowPriority());
+}
+
+int64_t netTimeSyncEpochTime(void)
+{
+    netTimeSyncContext_t *d = &gNetTimeSync;
+    if (d->lock == NULL)
+        return osiEpochTime();
+
+    osiMutexLock(d->lock);
+    if (d->started)
+        prvApplyDrift(d, false);
+    int64_t epoch = osiEpochTime();
+    osiMutexUnlock(d->lock);
+    return epoch;
+}
+
+void netTimeSyncGetStatus(netTimeSyncStatus_t *status)
+{
+    netTimeSyncContext_t *d = &gNetTimeSync;
+    if (status == NULL)
+        return;
+
+    memset(status, 0, sizeof(*status));
+    status->error_ms = NET_TIME_ERROR_UNKNOWN;
+    if (d->lock == NULL)
+        return;
+
+    osiMutexLock(d->lock);
+    int64_t now = osiUpTime();
+    if (d->ref_valid)
+    {
+        status->source = d->ref.source;
+        status->sync_uptime = d->ref.uptime;
+    }
+    status->offset_ms = d->offset;
+    status->drift_ppb = d->drift_ppb;
+    status->drift_error_ppb = d->drift_error_ppb;
+    status->error_ms = prvErrorAt(d, now);
+    status->next_round_s = (d->started && d->next_round > now) ? (d->next_round - now) / 1000 : 0;
+    status->rounds = d->rounds;
+    status->failures = d->failures;
+    status->rtt_ms = d->rtt;
+    osiMutexUnlock(d->lock);
+}
@@ -57,7 +57,7 @@ extern struct pbuf *Dhcp6_Info_req_reply(struct netif *netif, struct pbuf *pb);
 extern bool isRAPackage(struct pbuf *pb);
 extern void RA_reply(struct pbuf *pb);
 
-static bool prvNdevLanDataToPs(netSession_t *session, const void *data, size_t size);
+static bool prvNdevLanDataToPs(netSession_t *session, drvEther_t *ether, drvEthPacket_t *pkt, size_t size);
 static netSession_t *prvNdevLanSessionCreate(uint8_t sim, uint8_t cid);
 #if IP_NAT_INTERNAL_FORWARD
 netSession_t *prvNdevLanOnly_SessionCreate(uint8_t sim, uint8_t cid);
@@ -110,7 +110,7 @@ static void prvEthLanUploadDataCB(drvEthPacket_t *pkt, uint32_t size, void *ctx)
     }
     else
     {
-        prvNdevLanDataToPs(session, pkt->data, size - ETH_HLEN);
+        prvNdevLanDataToPs(session, nc->ether, pkt, size - ETH_HLEN);
     }
 }
 
@@ -168,7 +168,52 @@ wan_to_netdev_lan_datainput(struct pbuf *p, struct netif *nif)
     return 0;
 }
 
-static bool prvNdevLanDataToPs(netSession_t *session, const void *data, size_t size)
+#if LWIP_SUPPORT_CUSTOM_PBUF
+typedef struct
+{
+    struct pbuf_custom pc;
+    drvEther_t *ether;
+    void *hold;
+} ndevRxPbuf_t;
+
+static void prvNdevLanRxPbufFree(struct pbuf *p)
+{
+    ndevRxPbuf_t *rp = (ndevRxPbuf_t *)p;
+    drvEtherRxRelease(rp->ether, rp->hold);
+    free(rp);
+}
+
+/**
+ * Create PBUF_REF pbuf on the ether rx buffer, and the rx buffer is held
+ * until the pbuf is freed. Return NULL when the rx buffer can't be held,
+ * and the data should be copied.
+ */
+static struct pbuf *prvNdevLanRxPbufRef(drvEther_t *ether, drvEthPacket_t *pkt, size_t size)
+{
+    ndevRxPbuf_t *rp = (ndevRxPbuf_t *)malloc(sizeof(ndevRxPbuf_t));
+    if (rp == NULL)
+        return NULL;
+
+    rp->ether = ether;
+    rp->hold = drvEtherRxHold(ether, pkt);
+    if (rp->hold == NULL)
+    {
+        free(rp);
+        return NULL;
+    }
+
+    rp->pc.custom_free_function = prvNdevLanRxPbufFree;
+    struct pbuf *p = pbuf_alloced_custom(PBUF_RAW, size, PBUF_REF, &rp->pc, pkt->data, size);
+    if (p == NULL)
+    {
+        drvEtherRxRelease(ether, rp->hold);
+        free(rp);
+    }
+    return p;
+}
+#endif
+
+static bool prvNdevLanDataToPs(netSession_t *session, drvEther_t *ether, drvEthPacket_t *pkt, size_t size)
 {
     struct netif *inp_netif = session->dev_netif;
     if (inp_netif == NULL)
@@ -177,29 +222,18 @@ static bool prvNdevLanDataToPs(netSession_t *session, const void *data, size_t s
     if (size <= 0)
         return false;
 
-    struct pbuf *p, *q, *dhcpv6_reply = NULL;
-    int offset = 0;
-    uint8_t *pData = (uint8_t *)data;
-    p = (struct pbuf *)pbuf_alloc(PBUF_RAW, size, PBUF_POOL);
+    struct pbuf *p = NULL, *dhcpv6_reply = NULL;
+#if LWIP_SUPPORT_CUSTOM_PBUF
+    p = prvNdevLanRxPbufRef(ether, pkt, size);
+#endif
+    if (p == NULL)
+    {
+        p = (struct pbuf *)pbuf_alloc(PBUF_RAW, size, PBUF_POOL);
+        if (p != NULL)
+            pbuf_take(p, pkt->data, size);
+    }
     if (p != NULL)
     {
-        if (size > p->len)
-        {
-            for (q = p; size > q->len; q = q->next)
-            {
-                memcpy(q->payload, &(pData[offset]), q->len);
-                size -= q->len;
-                offset += q->len;
-            }
-            if (size != 0)
-            {
-                memcpy(q->payload, &(pData[offset]), size);
-            }
-        }
-        else
-        {
-            memcpy(p->payload, &(pData[offset]), size);
-        }
 #if LWIP_IPV6
         if (IP_HDR_GET_VERSION(p->payload) == 6)
         {
@@ -20,6 +20,7 @@
 
 #include "drv_ps_path.h"
 #include "netif_ppp.h"
+#include "netutils.h"
 #include "at_cfw.h"
 #include "quec_led_task.h"
 
@@ -49,132 +50,46 @@ static void gprs_data_ipc_to_lwip(void *ctx)
     struct netif *inp_netif = (struct netif *)ctx;
     if (inp_netif == NULL)
         return;
-    struct pbuf *p, *q;
-    OSI_LOGI(0x10007538, "gprs_data_ipc_to_lwip");
-    uint8_t *pData = malloc(1600);
-    if (pData == NULL)
-        return;
-    int len = 0;
-    int readLen = 0;
-    int offset = 0;
-    do
+    struct pbuf *pbufs[NET_PS_DL_BATCH];
+    unsigned count;
+    OSI_LOGD(0x10007538, "gprs_data_ipc_to_lwip");
+    while ((count = netPsIntfReadPbufs(inp_netif->pspathIntf, pbufs, NET_PS_DL_BATCH)) != 0)
     {
-        OSI_LOGI(0x10007539, "drvPsIntfRead in");
-        readLen = drvPsIntfRead(inp_netif->pspathIntf, pData, 1600);
-        len = readLen;
-        OSI_LOGI(0x1000753a, "drvPsIntfRead out %d", len);
-        if (len > 0)
-        {
-            sys_arch_dump(pData, len);
-        }
-        if (inp_netif != NULL && len > 0)
+        for (unsigned n = 0; n < count; n++)
         {
-            p = (struct pbuf *)pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
-            offset = 0;
-            if (p != NULL)
-            {
-                if (len > p->len)
-                {
-                    for (q = p; len > q->len; q = q->next)
-                    {
-                        memcpy(q->payload, &(pData[offset]), q->len);
-                        len -= q->len;
-                        offset += q->len;
-                    }
-                    if (len != 0)
-                    {
-                        memcpy(q->payload, &(pData[offset]), len);
-                    }
-                }
-                else
-                {
-                    memcpy(p->payload, &(pData[offset]), len);
-                }
-                inp_netif->input(p, inp_netif);
-                inp_netif->u32LwipDLSize += readLen;
+            int readLen = pbufs[n]->tot_len;
+            sys_arch_dump(pbufs[n]->payload, readLen);
+            inp_netif->u32LwipDLSize += readLen;
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_NW
-                quec_data_transmit_event_send(0, readLen);
+            quec_data_transmit_event_send(0, readLen);
 #endif
-            }
         }
-    } while (readLen > 0);
-    free(pData);
+        tcpip_input_batch(pbufs, count, inp_netif);
+    }
 }
 
 void lwip_pspathDataInput(void *ctx, drvPsIntf_t *p)
 {
-    OSI_LOGI(0x1000753b, "lwip_pspathDataInput osiThreadCallback in ");
+    OSI_LOGD(0x1000753b, "lwip_pspathDataInput osiThreadCallback in ");
     osiThreadCallback(netGetTaskID(), gprs_data_ipc_to_lwip, (void *)ctx);
-    OSI_LOGI(0x1000753c, "lwip_pspathDataInput osiThreadCallback out");
+    OSI_LOGD(0x1000753c, "lwip_pspathDataInput osiThreadCallback out");
 }
 
 static err_t data_output(struct netif *netif, struct pbuf *p,
                          ip_addr_t *ipaddr)
 {
-    uint16_t offset = 0;
-    struct pbuf *q = NULL;
-
-#if 1
-    OSI_LOGI(0x1000753d, "data_output ---------tot_len=%d, flags=0x%x---------", p->tot_len, p->flags);
-
-    uint8_t *pData = malloc(p->tot_len);
-    if (pData == NULL)
-    {
-        return !ERR_OK;
-    }
-
-    for (q = p; q != NULL; q = q->next)
-    {
-        memcpy(&pData[offset], q->payload, q->len);
-        offset += q->len;
-    }
-
-    sys_arch_dump(pData, p->tot_len);
-
-    OSI_LOGI(0x1000753e, "drvPsIntfWrite--in---");
+    OSI_LOGD(0x1000753d, "data_output ---------tot_len=%d, flags=0x%x---------", p->tot_len, p->flags);
 
     extern bool ATGprsGetDPSDFlag(CFW_SIM_ID nSim);
 #define GET_SIM(sim_cid) (((sim_cid) >> 4) & 0xf)
 
     if (!ATGprsGetDPSDFlag(GET_SIM(netif->sim_cid)))
-        drvPsIntfWrite((drvPsIntf_t *)netif->pspathIntf, pData, p->tot_len);
+        netPsIntfWritePbuf((drvPsIntf_t *)netif->pspathIntf, p);
 
-    OSI_LOGI(0x1000753f, "drvPsIntfWrite--out---");
     netif->u32LwipULSize += p->tot_len;
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_NW
     quec_data_transmit_event_send(p->tot_len, 0);
 #endif
-    free(pData);
-#endif
-
-#if 0
-    CFW_GPRS_DATA *pGprsData = NULL;
-
-    OSI_LOGI(0x1000753d, "data_output ---------tot_len=%d, flags=0x%x---------", p->tot_len, p->flags);
-
-    pGprsData = malloc(sizeof(CFW_GPRS_DATA) + p->tot_len);
-    if (pGprsData == NULL)
-    {
-        return !ERR_OK;
-    }
-
-    pGprsData->nDataLength = p->tot_len;
-
-    for (q = p; q != NULL; q = q->next)
-    {
-        memcpy(&pGprsData->pData[offset], q->payload, q->len);
-        offset += q->len;
-    }
-
-    sys_arch_dump(pGprsData->pData, pGprsData->nDataLength);
-
-    CFW_GprsSendData(netif->sim_cid & 0x0f, pGprsData, 0, (netif->sim_cid & 0xf0) >> 4);
-
-    free(pGprsData);
-#endif
-
-    OSI_LOGI(0x10007540, "data_output--return in netif_gprs---");
-
     return ERR_OK;
 }
 
@@ -84,7 +84,7 @@ static err_t nat_lan_lwip_data_output(struct netif *netif, struct pbuf *p,
             struct netif *Wannetif = netif_get_by_cid_type(netif->sim_cid, NETIF_LINK_MODE_NAT_WAN);
             if (Wannetif)
             {
-                OSI_LOGI(0x0, "nat_lan_lwip_data_output IPV6 to Wan netif");
+                OSI_LOGD(0x0, "nat_lan_lwip_data_output IPV6 to Wan netif");
 #if LWIP_TCPIP_CORE_LOCKING
                 LOCK_TCPIP_CORE();
 #endif
@@ -106,7 +106,7 @@ static err_t nat_lan_lwip_data_output(struct netif *netif, struct pbuf *p,
 #if LWIP_TCPIP_CORE_LOCKING
             UNLOCK_TCPIP_CORE();
 #endif
-            OSI_LOGI(0x0, "nat_lan_lwip_data_output %d", taken);
+            OSI_LOGD(0x0, "nat_lan_lwip_data_output %d", taken);
         }
         netif->u32LwipULSize += p->tot_len;
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_NW
@@ -47,156 +47,99 @@ static void gprs_data_ipc_to_lwip_nat_wan(void *ctx)
     struct netif *inp_netif = (struct netif *)ctx;
     if (inp_netif == NULL)
         return;
-    struct pbuf *p, *q;
-    OSI_LOGI(0x10007538, "gprs_data_ipc_to_lwip");
-    uint8_t *pData = malloc(1600);
-    if (pData == NULL)
-        return;
-    int len = 0;
-    int readLen = 0;
-    int offset = 0;
-    do
+    struct pbuf *pbufs[NET_PS_DL_BATCH];
+    unsigned count;
+    OSI_LOGD(0x10007538, "gprs_data_ipc_to_lwip");
+    while ((count = netPsIntfReadPbufs(inp_netif->pspathIntf, pbufs, NET_PS_DL_BATCH)) != 0)
     {
-        OSI_LOGI(0x10007539, "drvPsIntfRead in");
-        readLen = drvPsIntfRead(inp_netif->pspathIntf, pData, 1600);
-#ifdef CONFIG_NET_TRACE_IP_PACKET
-        uint8_t *ipdata = pData;
-        uint16_t identify = (ipdata[4] << 8) + ipdata[5];
-        OSI_LOGI(0x0, "Wan DL read from IPC thread identify %04x", identify);
+        // core lock is recursive, take it once for the burst
+#if LWIP_TCPIP_CORE_LOCKING
+        LOCK_TCPIP_CORE();
 #endif
-        len = readLen;
-        OSI_LOGI(0x1000753a, "drvPsIntfRead out %d", len);
-        if (len > 0)
+        for (unsigned n = 0; n < count; n++)
         {
-            sys_arch_dump(pData, len);
-        }
-        if (inp_netif != NULL && len > 0)
-        {
-            p = (struct pbuf *)pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
-            offset = 0;
-            if (p != NULL)
-            {
-                if (len > p->len)
+            struct pbuf *p = pbufs[n];
+            int readLen = p->tot_len;
+#ifdef CONFIG_NET_TRACE_IP_PACKET
+            uint8_t *ipdata = p->payload;
+            uint16_t identify = (ipdata[4] << 8) + ipdata[5];
+            OSI_LOGD(0x0, "Wan DL read from IPC thread identify %04x", identify);
+#endif
+            sys_arch_dump(p->payload, readLen);
+#if LWIP_IPV6
+            if (IP_HDR_GET_VERSION(p->payload) == 6)
+            { //find lan netif with same SimCid and same IPV6 addr to send
+                struct netif *netif;
+                u8_t sim_cid = inp_netif->sim_cid;
+                u8_t taken = 0;
+                NETIF_FOREACH(netif)
                 {
-                    for (q = p; len > q->len; q = q->next)
+                    if (sim_cid == netif->sim_cid && (NETIF_LINK_MODE_NAT_LWIP_LAN == netif->link_mode || NETIF_LINK_MODE_NAT_PPP_LAN == netif->link_mode || NETIF_LINK_MODE_NAT_NETDEV_LAN == netif->link_mode))
                     {
-                        memcpy(q->payload, &(pData[offset]), q->len);
-                        len -= q->len;
-                        offset += q->len;
-                    }
-                    if (len != 0)
-                    {
-                        memcpy(q->payload, &(pData[offset]), len);
+                        struct ip6_hdr *ip6hdr = p->payload;
+                        ip6_addr_t current_iphdr_dest;
+                        ip6_addr_t *current_netif_addr;
+                        ip6_addr_copy_from_packed(current_iphdr_dest, ip6hdr->dest);
+                        current_netif_addr = (ip6_addr_t *)netif_ip6_addr(netif, 0);
+                        if (current_netif_addr->addr[2] == current_iphdr_dest.addr[2] && current_netif_addr->addr[3] == current_iphdr_dest.addr[3])
+                        {
+                            OSI_LOGD(0x0, "gprs_data_ipc_to_lwip_nat_wan IPV6 to Lan netif");
+                            netif->input(p, netif);
+                            taken = 1;
+                            break;
+                        }
                     }
                 }
-                else
+                if (taken == 0)
                 {
-                    memcpy(p->payload, &(pData[offset]), len);
-                }
-#if LWIP_IPV6
-                if (IP_HDR_GET_VERSION(p->payload) == 6)
-                { //find lan netif with same SimCid and same IPV6 addr to send
-                    struct netif *netif;
-                    u8_t sim_cid = inp_netif->sim_cid;
-                    u8_t taken = 0;
                     NETIF_FOREACH(netif)
                     {
                         if (sim_cid == netif->sim_cid && (NETIF_LINK_MODE_NAT_LWIP_LAN == netif->link_mode || NETIF_LINK_MODE_NAT_PPP_LAN == netif->link_mode || NETIF_LINK_MODE_NAT_NETDEV_LAN == netif->link_mode))
                         {
-                            struct ip6_hdr *ip6hdr = p->payload;
-                            ip6_addr_t current_iphdr_dest;
-                            ip6_addr_t *current_netif_addr;
-                            ip6_addr_copy_from_packed(current_iphdr_dest, ip6hdr->dest);
-                            current_netif_addr = (ip6_addr_t *)netif_ip6_addr(netif, 0);
-                            if (current_netif_addr->addr[2] == current_iphdr_dest.addr[2] && current_netif_addr->addr[3] == current_iphdr_dest.addr[3])
-                            {
-                                OSI_LOGI(0x0, "gprs_data_ipc_to_lwip_nat_wan IPV6 to Lan netif");
-                                netif->input(p, netif);
-                                taken = 1;
-                                break;
-                            }
-                        }
-                    }
-                    if (taken == 0)
-                    {
-                        NETIF_FOREACH(netif)
-                        {
-                            if (sim_cid == netif->sim_cid && (NETIF_LINK_MODE_NAT_LWIP_LAN == netif->link_mode || NETIF_LINK_MODE_NAT_PPP_LAN == netif->link_mode || NETIF_LINK_MODE_NAT_NETDEV_LAN == netif->link_mode))
-                            {
-                                OSI_LOGI(0x0, "gprs_data_ipc_to_lwip_nat_wan brodcast IPV6 to Lan netif");
-                                pbuf_ref(p);
-                                netif->input(p, netif);
-                            }
+                            OSI_LOGD(0x0, "gprs_data_ipc_to_lwip_nat_wan brodcast IPV6 to Lan netif");
+                            pbuf_ref(p);
+                            netif->input(p, netif);
                         }
-                        inp_netif->input(p, inp_netif);
                     }
+                    inp_netif->input(p, inp_netif);
                 }
-                else
-#endif
-                {
-                    u8_t taken = 0;
-#if LWIP_TCPIP_CORE_LOCKING
-                    LOCK_TCPIP_CORE();
-#endif
-                    taken = ip4_nat_input(p);
-#if LWIP_TCPIP_CORE_LOCKING
-                    UNLOCK_TCPIP_CORE();
+            }
+            else
 #endif
-                    if (taken == 0)
-                        inp_netif->input(p, inp_netif);
-                }
-                inp_netif->u32LwipDLSize += readLen;
+            {
+                u8_t taken = 0;
+                taken = ip4_nat_input(p);
+                if (taken == 0)
+                    inp_netif->input(p, inp_netif);
+            }
+            inp_netif->u32LwipDLSize += readLen;
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_NW
-                quec_data_transmit_event_send(0, readLen);
+            quec_data_transmit_event_send(0, readLen);
 #endif
-            }
         }
-    } while (readLen > 0);
-    free(pData);
+#if LWIP_TCPIP_CORE_LOCKING
+        UNLOCK_TCPIP_CORE();
+#endif
+    }
 }
 
 void lwip_nat_wan_pspathDataInput(void *ctx, drvPsIntf_t *p)
 {
-    OSI_LOGI(0x0, "lwip_nat_wan_pspathDataInput osiThreadCallback in ");
+    OSI_LOGD(0x0, "lwip_nat_wan_pspathDataInput osiThreadCallback in ");
     osiThreadCallback(netGetTaskID(), gprs_data_ipc_to_lwip_nat_wan, (void *)ctx);
-    OSI_LOGI(0x0, "lwip_nat_wan_pspathDataInput osiThreadCallback out");
+    OSI_LOGD(0x0, "lwip_nat_wan_pspathDataInput osiThreadCallback out");
 }
 
 static err_t nat_wan_data_output(struct netif *netif, struct pbuf *p,
                                  ip_addr_t *ipaddr)
 {
-    uint16_t offset = 0;
-    struct pbuf *q = NULL;
-
-#if 1
-    OSI_LOGI(0x1000753d, "data_output ---------tot_len=%d, flags=0x%x---------", p->tot_len, p->flags);
-
-    uint8_t *pData = malloc(p->tot_len);
-    if (pData == NULL)
-    {
-        return !ERR_OK;
-    }
-
-    for (q = p; q != NULL; q = q->next)
-    {
-        memcpy(&pData[offset], q->payload, q->len);
-        offset += q->len;
-    }
-
-    sys_arch_dump(pData, p->tot_len);
+    OSI_LOGD(0x1000753d, "data_output ---------tot_len=%d, flags=0x%x---------", p->tot_len, p->flags);
 
-    OSI_LOGI(0x1000753e, "drvPsIntfWrite--in---");
-    drvPsIntfWrite((drvPsIntf_t *)netif->pspathIntf, pData, p->tot_len);
-    OSI_LOGI(0x1000753f, "drvPsIntfWrite--out---");
+    netPsIntfWritePbuf((drvPsIntf_t *)netif->pspathIntf, p);
     netif->u32LwipULSize += p->tot_len;
 #ifdef CONFIG_QUEC_PROJECT_FEATURE_NW
     quec_data_transmit_event_send(p->tot_len, 0);
 #endif
-    free(pData);
-#endif
-
-    OSI_LOGI(0x10007540, "data_output--return in netif_gprs---");
-
     return ERR_OK;
 }
 
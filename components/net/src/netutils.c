@@ -4,7 +4,15 @@
 #include "cfw.h"
 #include "cfw_errorcode.h"
 
+#include "osi_api.h"
 #include "osi_log.h"
+
+#define NET_PS_DL_PACKET_MAX (1600)
+#define NET_PS_UL_PACKET_MAX (1600)
+
+static osiMutex_t *gNetPsUlLock = NULL;
+static uint8_t gNetPsUlBuf[NET_PS_UL_PACKET_MAX];
+
 #if IP_NAT
 extern bool get_nat_enabled(uint8_t nSimId, uint8_t nCid);
 #endif
@@ -37,6 +45,84 @@ struct netif *getGprsWanNetIf(uint8_t nSim, uint8_t nCid)
 }
 #endif
 
+struct pbuf *netPsIntfReadPbuf(drvPsIntf_t *intf)
+{
+    int avail = drvPsIntfReadAvail(intf);
+    if (avail <= 0)
+        return NULL;
+
+    // available size may be the total size of pending packets, and it is
+    // large enough for the next packet anyway. Payload of PBUF_RAM can't
+    // be shrunk with libc malloc, so avoid to always allocate the maximum.
+    u16_t size = OSI_MIN(int, avail, NET_PS_DL_PACKET_MAX);
+    struct pbuf *p = pbuf_alloc(PBUF_RAW, size, PBUF_RAM);
+    if (p == NULL)
+        return NULL;
+
+    int len = drvPsIntfRead(intf, p->payload, size);
+    if (len < 0 && size < NET_PS_DL_PACKET_MAX)
+    {
+        pbuf_free(p);
+        p = pbuf_alloc(PBUF_RAW, NET_PS_DL_PACKET_MAX, PBUF_RAM);
+        if (p == NULL)
+            return NULL;
+        len = drvPsIntfRead(intf, p->payload, NET_PS_DL_PACKET_MAX);
+    }
+
+    if (len <= 0)
+    {
+        pbuf_free(p);
+        return NULL;
+    }
+
+    pbuf_realloc(p, len);
+    return p;
+}
+
+unsigned netPsIntfReadPbufs(drvPsIntf_t *intf, struct pbuf **pbufs, unsigned count)
+{
+    unsigned n = 0;
+    while (n < count)
+    {
+        struct pbuf *p = netPsIntfReadPbuf(intf);
+        if (p == NULL)
+            break;
+        pbufs[n++] = p;
+    }
+    return n;
+}
+
+int netPsIntfWritePbuf(drvPsIntf_t *intf, const struct pbuf *p)
+{
+    if (p->len == p->tot_len)
+        return drvPsIntfWrite(intf, p->payload, p->tot_len);
+
+    if (p->tot_len > NET_PS_UL_PACKET_MAX)
+        return -1;
+
+    // uplink may be called from threads other than tcpip thread
+    if (gNetPsUlLock == NULL)
+    {
+        osiMutex_t *lock = osiMutexCreate();
+        uint32_t critical = osiEnterCritical();
+        if (gNetPsUlLock == NULL)
+        {
+            gNetPsUlLock = lock;
+            lock = NULL;
+        }
+        osiExitCritical(critical);
+        osiMutexDelete(lock);
+        if (gNetPsUlLock == NULL)
+            return -1;
+    }
+
+    osiMutexLock(gNetPsUlLock);
+    pbuf_copy_partial(p, gNetPsUlBuf, p->tot_len, 0);
+    int res = drvPsIntfWrite(intf, gNetPsUlBuf, p->tot_len);
+    osiMutexUnlock(gNetPsUlLock);
+    return res;
+}
+
 struct netif *getEtherNetIf(uint8_t nCid)
 {
     if (nCid != 0x11)
@@ -62,6 +62,7 @@ typedef TAILQ_ENTRY(ppp_buf) ppp_buf_iter_t;
 typedef TAILQ_HEAD(ppp_buf_head, ppp_buf) ppp_buf_head_t;
 #define MAX_PPP_DL_LIT_PACK_NUM 256
 #define MAX_PPP_DL_BIG_PACK_NUM 128
+#define PPP_BUF_POOL_NUM 64 // free ppp_buf_t kept for reuse
 static int sPPPDLitPackNum = 0;
 static int sPPPDBigPackNum = 0;
 typedef struct ppp_buf
@@ -71,6 +72,8 @@ typedef struct ppp_buf
 } ppp_buf_t;
 #endif
 
+#define PPP_DL_BATCH_SIZE (4 * 1024) // DL frames combined into one serial write
+
 extern bool isRAPackage(struct pbuf *pb);
 extern void RA_reply(struct pbuf *pb);
 extern void pppDhcp6_Info_req_reply(struct netif *netif, struct pbuf *pb);
@@ -95,13 +98,41 @@ struct pppSession
     int cgact_activated;
     int uti_attact;
     int retrycnt_attact;
+    uint8_t *dl_batch;             // DL output batch buffer, kept for the session
+    uint32_t dl_batch_len;         // bytes in DL output batch buffer
+    osiThread_t *dl_batch_thread;  // thread batching DL output, NULL if not batching
 #if IP_NAT
     ppp_buf_head_t buffer_list;
+    ppp_buf_head_t free_buf_list;
+    int free_buf_count;
     ip4_nat_entry_t ppp_nat_entry;
     osiTimer_t *dl_read_notify_timer;
 #endif
 };
 
+// Frames output by the DL read loop are combined, and written to serial
+// in large pieces rather than one write for each pbuf of each frame.
+static void _pppDlBatchBegin(pppSession_t *ppp)
+{
+    if (ppp->dl_batch == NULL)
+        ppp->dl_batch = (uint8_t *)malloc(PPP_DL_BATCH_SIZE);
+    if (ppp->dl_batch != NULL)
+        ppp->dl_batch_thread = osiThreadCurrent();
+}
+
+static void _pppDlBatchFlush(pppSession_t *ppp)
+{
+    if (ppp->dl_batch_len > 0 && ppp->output_cb != NULL)
+        ppp->output_cb(ppp->output_cb_ctx, ppp->dl_batch, ppp->dl_batch_len);
+    ppp->dl_batch_len = 0;
+}
+
+static void _pppDlBatchEnd(pppSession_t *ppp)
+{
+    _pppDlBatchFlush(ppp);
+    ppp->dl_batch_thread = NULL;
+}
+
 #if IP_NAT
 static void _ppp_read_notify_timeout(void *ctx)
 {
@@ -148,6 +179,7 @@ static void _ppp_lan_data_pull(void *ctx)
     }
 
     ppp_buf_t *ppp_buf;
+    _pppDlBatchBegin(pppSession);
     while ((ppp_buf = TAILQ_FIRST(&(pppSession->buffer_list))) != NULL)
     {
         struct pbuf *p = ppp_buf->buf;
@@ -155,6 +187,15 @@ static void _ppp_lan_data_pull(void *ctx)
         LOCK_TCPIP_CORE();
 #endif
         TAILQ_REMOVE(&(pppSession->buffer_list), ppp_buf, iter);
+        if (pppSession->free_buf_count < PPP_BUF_POOL_NUM)
+        {
+            TAILQ_INSERT_HEAD(&(pppSession->free_buf_list), ppp_buf, iter);
+            pppSession->free_buf_count++;
+        }
+        else
+        {
+            free(ppp_buf);
+        }
         if (p->tot_len < 160)
         {
             sPPPDLitPackNum--;
@@ -170,7 +211,6 @@ static void _ppp_lan_data_pull(void *ctx)
 #if LWIP_TCPIP_CORE_LOCKING
         UNLOCK_TCPIP_CORE();
 #endif
-        free(ppp_buf);
 
 #if LWIP_IPV6
         if (IP_HDR_GET_VERSION(p->payload) == 6)
@@ -196,6 +236,7 @@ static void _ppp_lan_data_pull(void *ctx)
             }
         }
     }
+    _pppDlBatchEnd(pppSession);
 }
 
 err_t wan_to_ppp_lan_datainput(struct pbuf *p, struct netif *inp)
@@ -242,7 +283,25 @@ err_t wan_to_ppp_lan_datainput(struct pbuf *p, struct netif *inp)
         return -1;
     }
 
-    ppp_buf_t *ppp_buf = (ppp_buf_t *)malloc(sizeof(ppp_buf_t));
+    ppp_buf_t *ppp_buf = TAILQ_FIRST(&(pppSession->free_buf_list));
+    if (ppp_buf != NULL)
+    {
+        TAILQ_REMOVE(&(pppSession->free_buf_list), ppp_buf, iter);
+        pppSession->free_buf_count--;
+    }
+    else
+    {
+        ppp_buf = (ppp_buf_t *)malloc(sizeof(ppp_buf_t));
+        if (ppp_buf == NULL)
+        {
+            OSI_LOGI(0x0, "wan_to_ppp_lan_datainput alloc fail, drop it");
+            pbuf_free(p);
+#if LWIP_TCPIP_CORE_LOCKING
+            UNLOCK_TCPIP_CORE();
+#endif
+            return -1;
+        }
+    }
     ppp_buf->buf = p;
     if (p->tot_len < 160)
     {
@@ -403,6 +462,7 @@ static void _psIntfRead(void *ctx)
         return;
     }
 
+    _pppDlBatchBegin(pppSession);
     for (;;)
     {
         int rsize = drvPsIntfRead(nif->pspathIntf, p->payload, PBUF_POOL_BUFSIZE);
@@ -449,6 +509,7 @@ static void _psIntfRead(void *ctx)
         }
     }
 
+    _pppDlBatchEnd(pppSession);
     pbuf_free(p);
 }
 
@@ -542,8 +603,22 @@ static u32_t pppos_output_cb(ppp_pcb *pcb, u8_t *data, u32_t len, void *ctx)
     //OSI_LOGI(0x10005632, "PPP dl output len/%d lcp_fsm/%d lpcp_fsm/%d",
     //         len, pcb->lcp_fsm.state, pcb->ipcp_fsm.state);
 
-    if (ppp->output_cb != NULL)
-        ppp->output_cb(ppp->output_cb_ctx, data, len);
+    if (ppp->output_cb == NULL)
+        return len;
+
+    // Output from other threads is not batched, and is written directly
+    if (ppp->dl_batch_thread != NULL && ppp->dl_batch_thread == osiThreadCurrent())
+    {
+        if (ppp->dl_batch_len + len > PPP_DL_BATCH_SIZE)
+            _pppDlBatchFlush(ppp);
+        if (len <= PPP_DL_BATCH_SIZE)
+        {
+            memcpy(ppp->dl_batch + ppp->dl_batch_len, data, len);
+            ppp->dl_batch_len += len;
+            return len;
+        }
+    }
+    ppp->output_cb(ppp->output_cb_ctx, data, len);
     return len;
 }
 
@@ -691,6 +766,8 @@ static void _pppAuthActDone(pppSession_t *ppp, int _iActiavedbyPPP)
         ppp->dl_read_notify = osiNotifyCreate(ppp->dl_thread, _ppp_lan_data_pull, netif);
         ppp->dl_read_notify_timer = osiTimerCreate(ppp->dl_thread, _ppp_read_notify_timeout, netif);
         TAILQ_INIT(&(ppp->buffer_list));
+        TAILQ_INIT(&(ppp->free_buf_list));
+        ppp->free_buf_count = 0;
 
 #if IP_NAT_INTERNAL_FORWARD
         if (lan_addNATEntry(plan, pwan) == true)
@@ -1233,6 +1310,10 @@ static int _pppStop(pppSession_t *ppp)
         //osiThreadCallback(netGetTaskID(), _freeppppcb, (void *)ppp->pcb);
         ppp->pcb = NULL;
     }
+    free(ppp->dl_batch);
+    ppp->dl_batch = NULL;
+    ppp->dl_batch_len = 0;
+    ppp->dl_batch_thread = NULL;
 #if IP_NAT
     if (get_nat_enabled(ppp->sim, ppp->cid) == false)
     {
@@ -1504,6 +1585,12 @@ bool pppSessionDelete(pppSession_t *ppp)
                 pbuf_free(p);
                 free(ppp_buf);
             }
+            while ((ppp_buf = TAILQ_FIRST(&(ppp->free_buf_list))) != NULL)
+            {
+                TAILQ_REMOVE(&(ppp->free_buf_list), ppp_buf, iter);
+                free(ppp_buf);
+            }
+            ppp->free_buf_count = 0;
             sPPPDLitPackNum = 0;
             sPPPDBigPackNum = 0;
             osiTimerDelete(ppp->dl_read_notify_timer);
@@ -125,7 +125,8 @@ typedef struct
 /**
  * \brief initialize nvm
  *
- * It should be called before any nv access.
+ * It should be called before any nv access. The transaction of
+ * \p nvmWriteItems interrupted by power loss is completed here.
  */
 void nvmInit(void);
 
@@ -152,6 +153,27 @@ void nvmInit(void);
  */
 int nvmReadItem(uint16_t nvid, void *buf, unsigned size);
 
+/**
+ * \brief read multiple nv items to buffers
+ *
+ * It is the same as calling \p nvmReadItem for each nv item. The cache
+ * lock is held once for all items, and the file of each nv item not
+ * in cache is opened only once.
+ *
+ * When \p bufs[n] is NULL or \p sizes[n] is 0, the size of the nv item
+ * will be stored in \p results[n].
+ *
+ * \param nvids     nv ID array
+ * \param bufs      buffer array for nv items read
+ * \param sizes     buffer size array
+ * \param results   array for return value of each nv item, can be NULL
+ * \param count     nv item count
+ * \return
+ *      - count of nv items read successfully
+ *      - -1 on invalid parameter
+ */
+int nvmReadItems(const uint16_t *nvids, void *const *bufs, const unsigned *sizes, int *results, unsigned count);
+
 /**
  * \brief write nv item from buffer
  *
@@ -169,6 +191,10 @@ int nvmReadItem(uint16_t nvid, void *buf, unsigned size);
  * The content will be checked before write. When the exist contents is
  * the same, no operation will be taken and is regarded as success.
  *
+ * The running data file is stored with CRC, which is checked at read.
+ * When the CRC is broken, the running data file is ignored, and the nv
+ * item is read from the file for fixed data.
+ *
  * \param nvid      nv ID
  * \param buf       buffer for nv item write
  * \param size      buffer size
@@ -179,6 +205,30 @@ int nvmReadItem(uint16_t nvid, void *buf, unsigned size);
  */
 int nvmWriteItem(uint16_t nvid, const void *buf, unsigned size);
 
+/**
+ * \brief write multiple cp nv items as one transaction
+ *
+ * After power loss, either all or none of the nv items are changed.
+ * The items are written to a journal file first, and then each nv
+ * item is written synchronously. When the system is restarted in the
+ * middle, the journal is replayed at \p nvmInit.
+ *
+ * Only cp nv with running data file can be written by this, and the
+ * size of each nv item should be less than 64KB.
+ *
+ * When it fails after the journal is written, the journal is kept, and
+ * the nv items will be written at next boot.
+ *
+ * \param nvids     nv ID array
+ * \param bufs      buffer array for nv items write
+ * \param sizes     buffer size array
+ * \param count     nv item count
+ * \return
+ *      - count of nv items changed
+ *      - -1 on fail
+ */
+int nvmWriteItems(const uint16_t *nvids, const void *const *bufs, const unsigned *sizes, unsigned count);
+
 /**
  * \brief read nv item to buffer, not considering running data
  *
@@ -15,6 +15,7 @@
 
 #include "nvm.h"
 #include "vfs.h"
+#include "osi_api.h"
 #include "osi_log.h"
 #include "nvm_config.h"
 #include "hal_shmem_region.h"
@@ -24,6 +25,8 @@
 #include <string.h>
 
 #define NV_FULL_NAME_MAX (40)
+#define NV_CACHE_ITEM_SIZE_MAX (4096)
+#define NV_CACHE_SIZE_MAX (32 * 1024)
 
 #define FACTORYNV_DIR CONFIG_FS_FACTORY_MOUNT_POINT
 #define MODEMNV_DIR CONFIG_FS_MODEM_MOUNT_POINT "/nvm"
@@ -31,6 +34,10 @@
 
 #define PHASECHECK_FNAME FACTORYNV_DIR "/phasecheck.bin"
 #define NVDIRECT_FNAME FACTORYNV_DIR "/imei.bin"
+#define JOURNAL_FNAME RUNNINGNV_DIR "/nv_journal.bin"
+
+#define NV_TRAILER_MAGIC OSI_MAKE_TAG('N', 'V', 'C', '1')
+#define NV_JOURNAL_MAGIC OSI_MAKE_TAG('N', 'V', 'J', '1')
 
 enum
 {
@@ -83,6 +90,63 @@ typedef struct
     const char *running_dname; ///< directory name for runningnv, NULL for not writable
 } nvDescription_t;
 
+/**
+ * Running nv files end with this trailer, and the CRC is checked at
+ * read. Files without the trailer are written by old versions or PC
+ * tools, and they are used as is. A running file with broken CRC is
+ * ignored, the same as it doesn't exist, and the fixed data is used.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t crc; ///< CRC of the content before the trailer
+} nvItemTrailer_t;
+
+/**
+ * Journal of \p nvmWriteItems. Items follow the header, and each item
+ * is \p nvJournalItem_t followed by data padded to 4 bytes. It is a
+ * safe file, so it is either complete or not exist after power loss.
+ * When it exists at \p nvmInit, the items are written again.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t count;
+    uint32_t size; ///< size of items after the header
+    uint32_t crc;  ///< CRC of items after the header
+} nvJournalHeader_t;
+
+typedef struct
+{
+    uint16_t nvid;
+    uint16_t reserved;
+    uint32_t size;
+} nvJournalItem_t;
+
+typedef struct nvCacheItem
+{
+    struct nvCacheItem *next;
+    uint16_t nvid;
+    unsigned size;
+    uint8_t data[];
+} nvCacheItem_t;
+
+/**
+ * Running nv data cache, for \p nvmReadItem. Items are listed in most
+ * recently used order, and the total size is limited. Cache is
+ * disabled before \p nvmInit, when \p lock is NULL.
+ */
+typedef struct
+{
+    osiMutex_t *lock;
+    nvCacheItem_t *head;
+    unsigned total;
+} nvCache_t;
+
+static nvCache_t gNvCache;
+
+static void prvJournalReplay(void);
+
 static const nvDescription_t gNvDesc[] = {
     {NVID_IMEI1, NULL, FACTORYNV_DIR, NULL},
     {NVID_IMEI2, NULL, FACTORYNV_DIR, NULL},
@@ -138,6 +202,12 @@ void nvmInit(void)
     // Make directory if not exists. So, the return value doesn't matter.
     vfs_mkpath(MODEMNV_DIR, 0);
     vfs_mkpath(RUNNINGNV_DIR, 0);
+
+    // complete the transaction interrupted by power loss
+    prvJournalReplay();
+
+    if (gNvCache.lock == NULL)
+        gNvCache.lock = osiMutexCreate();
 }
 
 int nvmGetIdFromFileName(const char *fname)
@@ -165,25 +235,91 @@ static const nvDescription_t *prvGetDescById(uint16_t nvid)
     return NULL;
 }
 
-static const char *prvReadFileName(char *fname, uint16_t nvid, bool force_fixed)
+static const char *prvFileName(char *fname, const char *dname, const char *name)
+{
+    strcpy(fname, dname);
+    strcat(fname, "/");
+    strcat(fname, name);
+    return fname;
+}
+
+// Return content size without trailer, or -1 on broken CRC.
+static int prvCheckTrailer(const uint8_t *data, unsigned size)
+{
+    if (size < sizeof(nvItemTrailer_t))
+        return size;
+
+    nvItemTrailer_t trailer;
+    unsigned content = size - sizeof(nvItemTrailer_t);
+    memcpy(&trailer, data + content, sizeof(trailer));
+    if (trailer.magic != NV_TRAILER_MAGIC)
+        return size;
+
+    return (crc32Calc(data, content) == trailer.crc) ? (int)content : -1;
+}
+
+// Load nv file and check CRC. The returned buffer should be freed by
+// caller, and \p size is the content size without trailer.
+static void *prvLoadFile(const char *fname, unsigned *size)
+{
+    int fd = vfs_open(fname, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    uint8_t *data = NULL;
+    if (vfs_fstat(fd, &st) >= 0)
+        data = (uint8_t *)malloc(st.st_size + 1); // not NULL for empty file
+
+    if (data != NULL && vfs_read(fd, data, st.st_size) != st.st_size)
+    {
+        free(data);
+        data = NULL;
+    }
+    vfs_close(fd);
+
+    if (data == NULL)
+        return NULL;
+
+    int res = prvCheckTrailer(data, st.st_size);
+    if (res < 0)
+    {
+        OSI_LOGXE(OSI_LOGPAR_S, 0, "nvm %s crc mismatch, ignored", fname);
+        free(data);
+        return NULL;
+    }
+
+    *size = res;
+    return data;
+}
+
+// Load running nv, and fall back to fixed nv when running nv doesn't
+// exist or is broken.
+static void *prvLoadItem(uint16_t nvid, bool force_fixed, unsigned *size)
 {
     const nvDescription_t *desc = prvGetDescById(nvid);
-    if (desc == NULL)
+    if (desc == NULL || desc->fname == NULL)
         return NULL;
 
+    char fname[NV_FULL_NAME_MAX];
     if (!force_fixed && desc->running_dname != NULL)
     {
-        strcpy(fname, desc->running_dname);
-        strcat(fname, "/");
-        strcat(fname, desc->fname);
-        if (vfs_sfile_size(fname) >= 0)
-            return fname;
+        void *data = prvLoadFile(prvFileName(fname, desc->running_dname, desc->fname), size);
+        if (data != NULL)
+            return data;
     }
 
-    strcpy(fname, desc->dname);
-    strcat(fname, "/");
-    strcat(fname, desc->fname);
-    return (vfs_sfile_size(fname) >= 0) ? fname : NULL;
+    return prvLoadFile(prvFileName(fname, desc->dname, desc->fname), size);
+}
+
+static int prvCopyData(const void *data, unsigned data_size, void *buf, unsigned size)
+{
+    if (buf == NULL || size == 0)
+        return data_size;
+
+    unsigned len = OSI_MIN(unsigned, size, data_size);
+    memcpy(buf, data, len);
+    return len;
 }
 
 static const char *prvWriteFileName(char *fname, uint16_t nvid, bool force_fixed)
@@ -256,20 +392,169 @@ static int prvReadItem(uint16_t nvid, void *buf, unsigned size, bool force_fixed
         break;
     }
 
-    char fname_buf[NV_FULL_NAME_MAX];
-    const char *fname = prvReadFileName(fname_buf, nvid, force_fixed);
-    if (fname == NULL)
+    // the whole file is loaded even for size query, to check CRC
+    unsigned data_size;
+    void *data = prvLoadItem(nvid, force_fixed, &data_size);
+    if (data == NULL)
         return -1;
 
-    if (buf == NULL || size == 0)
-        return vfs_sfile_size(fname);
+    int res = prvCopyData(data, data_size, buf, size);
+    free(data);
+    return res;
+}
+
+static bool prvIsNvDirect(uint16_t nvid)
+{
+    return nvid == NVID_IMEI1 || nvid == NVID_IMEI2 ||
+           nvid == NVID_IMEI3 || nvid == NVID_IMEI4;
+}
 
-    return vfs_sfile_read(fname, buf, size);
+// Find cached item, and move it to the head. Caller should hold the lock.
+static nvCacheItem_t *prvCacheFind(uint16_t nvid)
+{
+    nvCache_t *p = &gNvCache;
+    for (nvCacheItem_t **pitem = &p->head; *pitem != NULL; pitem = &(*pitem)->next)
+    {
+        nvCacheItem_t *item = *pitem;
+        if (item->nvid == nvid)
+        {
+            *pitem = item->next;
+            item->next = p->head;
+            p->head = item;
+            return item;
+        }
+    }
+    return NULL;
+}
+
+static void prvCacheRemove(uint16_t nvid)
+{
+    nvCache_t *p = &gNvCache;
+    for (nvCacheItem_t **pitem = &p->head; *pitem != NULL; pitem = &(*pitem)->next)
+    {
+        nvCacheItem_t *item = *pitem;
+        if (item->nvid == nvid)
+        {
+            *pitem = item->next;
+            p->total -= item->size;
+            free(item);
+            return;
+        }
+    }
+}
+
+static void prvCacheClear(void)
+{
+    nvCache_t *p = &gNvCache;
+    while (p->head != NULL)
+    {
+        nvCacheItem_t *item = p->head;
+        p->head = item->next;
+        free(item);
+    }
+    p->total = 0;
+}
+
+// Allocate cache item, least recently used items will be dropped when
+// the total size exceeds. Return NULL if the item is too large.
+static nvCacheItem_t *prvCacheAlloc(uint16_t nvid, unsigned size)
+{
+    nvCache_t *p = &gNvCache;
+    if (size > NV_CACHE_ITEM_SIZE_MAX)
+        return NULL;
+
+    while (p->head != NULL && p->total + size > NV_CACHE_SIZE_MAX)
+    {
+        nvCacheItem_t **pitem = &p->head;
+        while ((*pitem)->next != NULL)
+            pitem = &(*pitem)->next;
+
+        p->total -= (*pitem)->size;
+        free(*pitem);
+        *pitem = NULL;
+    }
+
+    nvCacheItem_t *item = (nvCacheItem_t *)malloc(sizeof(nvCacheItem_t) + size);
+    if (item == NULL)
+        return NULL;
+
+    item->nvid = nvid;
+    item->size = size;
+    return item;
+}
+
+static void prvCacheInsert(nvCacheItem_t *item)
+{
+    nvCache_t *p = &gNvCache;
+    item->next = p->head;
+    p->head = item;
+    p->total += item->size;
+}
+
+// Read running nv item through cache. Caller should hold the lock.
+static int prvReadItemCached(uint16_t nvid, void *buf, unsigned size)
+{
+    if (prvIsNvDirect(nvid))
+        return prvReadItem(nvid, buf, size, false);
+
+    nvCacheItem_t *item = prvCacheFind(nvid);
+    if (item != NULL)
+        return prvCopyData(item->data, item->size, buf, size);
+
+    // the file is loaded once, for both cache fill and the read
+    unsigned data_size;
+    void *data = prvLoadItem(nvid, false, &data_size);
+    if (data == NULL)
+        return -1;
+
+    int res = prvCopyData(data, data_size, buf, size);
+    item = prvCacheAlloc(nvid, data_size);
+    if (item != NULL)
+    {
+        memcpy(item->data, data, data_size);
+        prvCacheInsert(item);
+    }
+
+    free(data);
+    return res;
 }
 
 int nvmReadItem(uint16_t nvid, void *buf, unsigned size)
 {
-    return prvReadItem(nvid, buf, size, false);
+    nvCache_t *p = &gNvCache;
+    if (p->lock == NULL)
+        return prvReadItem(nvid, buf, size, false);
+
+    osiMutexLock(p->lock);
+    int res = prvReadItemCached(nvid, buf, size);
+    osiMutexUnlock(p->lock);
+    return res;
+}
+
+int nvmReadItems(const uint16_t *nvids, void *const *bufs, const unsigned *sizes, int *results, unsigned count)
+{
+    nvCache_t *p = &gNvCache;
+    if (nvids == NULL || bufs == NULL || sizes == NULL)
+        return -1;
+
+    int succ = 0;
+    if (p->lock != NULL)
+        osiMutexLock(p->lock);
+
+    for (unsigned n = 0; n < count; n++)
+    {
+        int res = (p->lock == NULL)
+                      ? prvReadItem(nvids[n], bufs[n], sizes[n], false)
+                      : prvReadItemCached(nvids[n], bufs[n], sizes[n]);
+        if (results != NULL)
+            results[n] = res;
+        if (res >= 0)
+            succ++;
+    }
+
+    if (p->lock != NULL)
+        osiMutexUnlock(p->lock);
+    return succ;
 }
 
 int nvmReadFixedItem(uint16_t nvid, void *buf, unsigned size)
@@ -277,7 +562,7 @@ int nvmReadFixedItem(uint16_t nvid, void *buf, unsigned size)
     return prvReadItem(nvid, buf, size, true);
 }
 
-static int prvWriteItem(uint16_t nvid, const void *buf, unsigned size, bool force_fixed)
+static int prvWriteItem(uint16_t nvid, const void *buf, unsigned size, bool force_fixed, bool behind)
 {
     if (buf == NULL || size == 0)
         return -1;
@@ -306,43 +591,261 @@ static int prvWriteItem(uint16_t nvid, const void *buf, unsigned size, bool forc
     if (fname == NULL)
         return -1;
 
+    // running nv is written with CRC trailer, fixed nv is kept as is
+    const nvDescription_t *desc = prvGetDescById(nvid);
+    bool running = !force_fixed && desc->running_dname != NULL;
+    unsigned file_size = running ? size + sizeof(nvItemTrailer_t) : size;
+    uint8_t *data = (uint8_t *)malloc(file_size);
+    if (data == NULL)
+        return -1;
+
+    memcpy(data, buf, size);
+    if (running)
+    {
+        nvItemTrailer_t trailer = {NV_TRAILER_MAGIC, crc32Calc(buf, size)};
+        memcpy(data + size, &trailer, sizeof(trailer));
+    }
+
     // check whether exist content matches
-    if (vfs_sfile_size(fname) == size)
+    int res = -1;
+    if (vfs_sfile_size(fname) == file_size)
     {
-        void *existed = malloc(size);
+        void *existed = malloc(file_size);
         if (existed == NULL)
-            return -1;
+            goto out;
 
-        bool matches = (vfs_sfile_read(fname, existed, size) == size) &&
-                       (memcmp(existed, buf, size) == 0);
+        bool matches = (vfs_sfile_read(fname, existed, file_size) == file_size) &&
+                       (memcmp(existed, data, file_size) == 0);
         free(existed);
 
         if (matches)
-            return 0;
+        {
+            res = 0;
+            goto out;
+        }
     }
 
+    // running nv is written behind, to coalesce bursts of writes
     OSI_LOGD(0, "nvm write nvid %d, size %d", nvid, size);
-    return vfs_sfile_write(fname, buf, size);
+    if (behind)
+        res = vfs_sfile_write_behind(fname, data, file_size);
+    else
+        res = vfs_sfile_write(fname, data, file_size);
+    if (res >= 0)
+        res = size;
+
+out:
+    free(data);
+    return res;
+}
+
+// Items will be written by the journal, check them before the journal
+// is written.
+static bool prvJournalItemValid(uint16_t nvid, const void *buf, unsigned size)
+{
+    const nvDescription_t *desc = prvGetDescById(nvid);
+    return desc != NULL && desc->fname != NULL && desc->running_dname != NULL &&
+           buf != NULL && size > 0 && size <= UINT16_MAX;
+}
+
+static void prvJournalReplay(void)
+{
+    ssize_t size = vfs_sfile_size(JOURNAL_FNAME);
+    if (size < 0)
+        return;
+
+    uint8_t *journal = (uint8_t *)malloc(size + 1);
+    if (journal == NULL)
+        return;
+
+    nvJournalHeader_t *header = (nvJournalHeader_t *)journal;
+    if (vfs_sfile_read(JOURNAL_FNAME, journal, size) != size ||
+        (size_t)size < sizeof(nvJournalHeader_t) ||
+        header->magic != NV_JOURNAL_MAGIC ||
+        header->size != size - sizeof(nvJournalHeader_t) ||
+        header->crc != crc32Calc(journal + sizeof(nvJournalHeader_t), header->size))
+    {
+        OSI_LOGE(0, "nvm journal invalid, size %d", size);
+        goto out;
+    }
+
+    OSI_LOGI(0, "nvm journal replay, count %d", header->count);
+
+    uint8_t *p = journal + sizeof(nvJournalHeader_t);
+    uint8_t *end = journal + size;
+    for (unsigned n = 0; n < header->count; n++)
+    {
+        nvJournalItem_t item;
+        if (p + sizeof(item) > end)
+            break;
+
+        memcpy(&item, p, sizeof(item));
+        p += sizeof(item);
+        if (item.size > (size_t)(end - p))
+            break;
+
+        if (prvJournalItemValid(item.nvid, p, item.size))
+            prvWriteItem(item.nvid, p, item.size, false, false);
+        p += OSI_ALIGN_UP(item.size, 4);
+    }
+
+out:
+    free(journal);
+    vfs_unlink(JOURNAL_FNAME);
 }
 
 int nvmWriteItem(uint16_t nvid, const void *buf, unsigned size)
 {
-    return prvWriteItem(nvid, buf, size, false);
+    nvCache_t *p = &gNvCache;
+    if (p->lock == NULL || prvIsNvDirect(nvid))
+        return prvWriteItem(nvid, buf, size, false, true);
+
+    osiMutexLock(p->lock);
+
+    // no need to read the file when the cached content matches
+    nvCacheItem_t *item = prvCacheFind(nvid);
+    if (item != NULL && buf != NULL && item->size == size &&
+        memcmp(item->data, buf, size) == 0)
+    {
+        osiMutexUnlock(p->lock);
+        return 0;
+    }
+
+    // write through, cache is updated only on success
+    prvCacheRemove(nvid);
+    int res = prvWriteItem(nvid, buf, size, false, true);
+    if (res >= 0)
+    {
+        item = prvCacheAlloc(nvid, size);
+        if (item != NULL)
+        {
+            memcpy(item->data, buf, size);
+            prvCacheInsert(item);
+        }
+    }
+
+    osiMutexUnlock(p->lock);
+    return res;
+}
+
+int nvmWriteItems(const uint16_t *nvids, const void *const *bufs, const unsigned *sizes, unsigned count)
+{
+    nvCache_t *p = &gNvCache;
+    if (nvids == NULL || bufs == NULL || sizes == NULL || count == 0)
+        return -1;
+
+    unsigned items_size = 0;
+    for (unsigned n = 0; n < count; n++)
+    {
+        if (!prvJournalItemValid(nvids[n], bufs[n], sizes[n]))
+            return -1;
+        items_size += sizeof(nvJournalItem_t) + OSI_ALIGN_UP(sizes[n], 4);
+    }
+
+    uint8_t *journal = (uint8_t *)calloc(1, sizeof(nvJournalHeader_t) + items_size);
+    if (journal == NULL)
+        return -1;
+
+    uint8_t *ptr = journal + sizeof(nvJournalHeader_t);
+    for (unsigned n = 0; n < count; n++)
+    {
+        nvJournalItem_t item = {nvids[n], 0, sizes[n]};
+        memcpy(ptr, &item, sizeof(item));
+        memcpy(ptr + sizeof(item), bufs[n], sizes[n]);
+        ptr += sizeof(item) + OSI_ALIGN_UP(sizes[n], 4);
+    }
+
+    nvJournalHeader_t *header = (nvJournalHeader_t *)journal;
+    header->magic = NV_JOURNAL_MAGIC;
+    header->count = count;
+    header->size = items_size;
+    header->crc = crc32Calc(journal + sizeof(nvJournalHeader_t), items_size);
+
+    if (p->lock != NULL)
+        osiMutexLock(p->lock);
+
+    // Items are written synchronously after the journal. When it fails in
+    // the middle, the journal is kept and the items will be written again
+    // at next boot.
+    int res = -1;
+    if (vfs_sfile_write(JOURNAL_FNAME, journal, sizeof(nvJournalHeader_t) + items_size) < 0)
+        goto out;
+
+    int changed = 0;
+    for (unsigned n = 0; n < count; n++)
+    {
+        prvCacheRemove(nvids[n]);
+        int written = prvWriteItem(nvids[n], bufs[n], sizes[n], false, false);
+        if (written < 0)
+        {
+            OSI_LOGE(0, "nvm journal write nvid %d failed", nvids[n]);
+            goto out;
+        }
+        if (written > 0)
+            changed++;
+    }
+
+    vfs_unlink(JOURNAL_FNAME);
+    res = changed;
+
+    if (p->lock != NULL)
+    {
+        for (unsigned n = 0; n < count; n++)
+        {
+            nvCacheItem_t *item = prvCacheAlloc(nvids[n], sizes[n]);
+            if (item != NULL)
+            {
+                memcpy(item->data, bufs[n], sizes[n]);
+                prvCacheInsert(item);
+            }
+        }
+    }
+
+out:
+    if (p->lock != NULL)
+        osiMutexUnlock(p->lock);
+    free(journal);
+    return res;
 }
 
 int nvmWriteFixedItem(uint16_t nvid, const void *buf, unsigned size)
 {
-    return prvWriteItem(nvid, buf, size, true);
+    nvCache_t *p = &gNvCache;
+    if (p->lock == NULL)
+        return prvWriteItem(nvid, buf, size, true, false);
+
+    // running data may not exist, drop the cached item
+    osiMutexLock(p->lock);
+    prvCacheRemove(nvid);
+    int res = prvWriteItem(nvid, buf, size, true, false);
+    osiMutexUnlock(p->lock);
+    return res;
 }
 
 void nvmClearRunning(void)
 {
+    nvCache_t *p = &gNvCache;
+    if (p->lock != NULL)
+        osiMutexLock(p->lock);
+
+    prvCacheClear();
     vfs_rmchildren(RUNNINGNV_DIR);
+
+    if (p->lock != NULL)
+        osiMutexUnlock(p->lock);
 }
 
 void nvmClearFactory(void)
 {
+    nvCache_t *p = &gNvCache;
+    if (p->lock != NULL)
+        osiMutexLock(p->lock);
+
+    prvCacheClear();
     vfs_rmchildren(FACTORYNV_DIR);
+
+    if (p->lock != NULL)
+        osiMutexUnlock(p->lock);
 }
 
 bool nvmReadPhasecheck(phaseCheckHead_t *chk)
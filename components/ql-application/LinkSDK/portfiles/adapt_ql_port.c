@@ -59,14 +59,32 @@
 #endif
 
 #ifdef CORE_SYSDEP_MBEDTLS_ENABLED
+/*
+ * TLS configuration, with parsed certificates and the last session.
+ *
+ * It is allocated at the first connect, and kept in cache after
+ * disconnect. Reconnect with the same credential takes it from the cache,
+ * so certificates are not parsed again, and the session can be resumed.
+ * A configuration is used by one connection at a time.
+ */
 typedef struct {
-    mbedtls_net_context          net_ctx;
-    mbedtls_ssl_context          ssl_ctx;
     mbedtls_ssl_config           ssl_config;
-    mbedtls_timing_delay_context timer_delay_ctx;
     mbedtls_x509_crt             x509_server_cert;
     mbedtls_x509_crt             x509_client_cert;
     mbedtls_pk_context           x509_client_pk;
+    mbedtls_ssl_session          session;
+    uint8_t                      session_valid;
+    char                        *session_host;
+    uint16_t                     session_port;
+    core_sysdep_socket_type_t    socket_type;
+    aiot_sysdep_network_cred_t   cred;
+} core_sysdep_tls_conf_t;
+
+typedef struct {
+    mbedtls_net_context          net_ctx;
+    mbedtls_ssl_context          ssl_ctx;
+    mbedtls_timing_delay_context timer_delay_ctx;
+    core_sysdep_tls_conf_t      *conf;
 } core_sysdep_mbedtls_t;
 #endif
 
@@ -86,67 +104,134 @@ typedef struct {
 } core_network_handle_t;
 
 #ifdef CORE_SYSDEP_MBEDTLS_ENABLED
-#define MBEDTLS_MEM_INFO_MAGIC  (0x12345678)
+#if defined(MBEDTLS_PLATFORM_MEMORY) && \
+   (!defined(MBEDTLS_PLATFORM_FREE_MACRO) || defined(MBEDTLS_PLATFORM_CALLOC_MACRO))
+#define CORE_SYSDEP_TLS_POOL_ENABLED
+#endif
+
+#ifdef CORE_SYSDEP_TLS_POOL_ENABLED
+/*
+ *  TLS内存池
+ *
+ *  握手过程中mbedtls会频繁申请/释放大量小内存(大数, ASN.1解析等),
+ *  这些申请由固定大小的内存块池提供, 避免堆碎片; 超过块大小或内存池用尽时, 从堆申请
+ *
+ *  mbedtls_platform_set_calloc_free 是全局设置, 其它模块不能再安装自己的分配函数
+ */
+#ifndef CORE_SYSDEP_TLS_POOL_SMALL_SIZE
+#define CORE_SYSDEP_TLS_POOL_SMALL_SIZE     (64)
+#endif
+#ifndef CORE_SYSDEP_TLS_POOL_SMALL_COUNT
+#define CORE_SYSDEP_TLS_POOL_SMALL_COUNT    (96)
+#endif
+#ifndef CORE_SYSDEP_TLS_POOL_LARGE_SIZE
+#define CORE_SYSDEP_TLS_POOL_LARGE_SIZE     (320)
+#endif
+#ifndef CORE_SYSDEP_TLS_POOL_LARGE_COUNT
+#define CORE_SYSDEP_TLS_POOL_LARGE_COUNT    (24)
+#endif
+
+typedef struct {
+    uint8_t  *base;
+    uint32_t *used_map;
+    uint32_t  block_size;
+    uint32_t  block_count;
+} core_sysdep_tls_pool_t;
+
+static uint32_t g_tls_pool_small_mem[CORE_SYSDEP_TLS_POOL_SMALL_COUNT * CORE_SYSDEP_TLS_POOL_SMALL_SIZE / 4];
+static uint32_t g_tls_pool_small_map[(CORE_SYSDEP_TLS_POOL_SMALL_COUNT + 31) / 32];
+static uint32_t g_tls_pool_large_mem[CORE_SYSDEP_TLS_POOL_LARGE_COUNT * CORE_SYSDEP_TLS_POOL_LARGE_SIZE / 4];
+static uint32_t g_tls_pool_large_map[(CORE_SYSDEP_TLS_POOL_LARGE_COUNT + 31) / 32];
+
+static core_sysdep_tls_pool_t g_tls_pool[] = {
+    {(uint8_t *)g_tls_pool_small_mem, g_tls_pool_small_map, CORE_SYSDEP_TLS_POOL_SMALL_SIZE, CORE_SYSDEP_TLS_POOL_SMALL_COUNT},
+    {(uint8_t *)g_tls_pool_large_mem, g_tls_pool_large_map, CORE_SYSDEP_TLS_POOL_LARGE_SIZE, CORE_SYSDEP_TLS_POOL_LARGE_COUNT},
+};
 
+/* bytes of pool blocks in use, and its peak */
 static unsigned int g_mbedtls_total_mem_used = 0;
 static unsigned int g_mbedtls_max_mem_used = 0;
+static unsigned int g_mbedtls_heap_alloc_count = 0;
+static uint8_t g_mbedtls_pool_installed = 0;
 
+static void *_core_tls_pool_alloc(core_sysdep_tls_pool_t *pool)
+{
+    uint32_t idx = 0, bit = 0, critical = 0;
+    void *buf = NULL;
 
+    critical = ql_rtos_enter_critical();
+    for (idx = 0; idx < (pool->block_count + 31) / 32; idx++) {
+        if (pool->used_map[idx] == 0xFFFFFFFF) {
+            continue;
+        }
+        bit = idx * 32 + __builtin_ctz(~pool->used_map[idx]);
+        if (bit >= pool->block_count) {
+            break;
+        }
+        pool->used_map[idx] |= (1u << (bit % 32));
+        buf = pool->base + bit * pool->block_size;
+        g_mbedtls_total_mem_used += pool->block_size;
+        if (g_mbedtls_total_mem_used > g_mbedtls_max_mem_used) {
+            g_mbedtls_max_mem_used = g_mbedtls_total_mem_used;
+        }
+        break;
+    }
+    ql_rtos_exit_critical(critical);
 
-typedef struct {
-    int magic;
-    int size;
-} mbedtls_mem_info_t;
+    return buf;
+}
 
-/*
 static void *_core_mbedtls_calloc(size_t n, size_t size)
 {
-    unsigned char *buf = NULL;
-    mbedtls_mem_info_t *mem_info = NULL;
-
-    if (n == 0 || size == 0) {
-        return NULL;
-    }
+    uint32_t idx = 0;
+    void *buf = NULL;
 
-    buf = (unsigned char *)malloc(n * size + sizeof(mbedtls_mem_info_t));
-    if (NULL == buf) {
+    if (n == 0 || size == 0 || n > SIZE_MAX / size) {
         return NULL;
-    } else {
-        memset(buf, 0, n * size + sizeof(mbedtls_mem_info_t));
     }
 
-    mem_info = (mbedtls_mem_info_t *)buf;
-    mem_info->magic = MBEDTLS_MEM_INFO_MAGIC;
-    mem_info->size = n * size;
-    buf += sizeof(mbedtls_mem_info_t);
-
-    g_mbedtls_total_mem_used += mem_info->size;
-    if (g_mbedtls_total_mem_used > g_mbedtls_max_mem_used) {
-        g_mbedtls_max_mem_used = g_mbedtls_total_mem_used;
+    for (idx = 0; idx < sizeof(g_tls_pool) / sizeof(g_tls_pool[0]); idx++) {
+        if (n * size <= g_tls_pool[idx].block_size) {
+            buf = _core_tls_pool_alloc(&g_tls_pool[idx]);
+            if (buf != NULL) {
+                memset(buf, 0, n * size);
+                return buf;
+            }
+        }
     }
 
-    return buf;
+    g_mbedtls_heap_alloc_count++;
+    return calloc(n, size);
 }
 
-
 static void _core_mbedtls_free(void *ptr)
 {
-    mbedtls_mem_info_t *mem_info = NULL;
+    uint32_t idx = 0, bit = 0, critical = 0;
+    core_sysdep_tls_pool_t *pool = NULL;
+
     if (NULL == ptr) {
         return;
     }
 
-    mem_info = (mbedtls_mem_info_t *)((unsigned char *)ptr - sizeof(mbedtls_mem_info_t));
-    if (mem_info->magic != MBEDTLS_MEM_INFO_MAGIC) {
-        return;
+    for (idx = 0; idx < sizeof(g_tls_pool) / sizeof(g_tls_pool[0]); idx++) {
+        pool = &g_tls_pool[idx];
+        if ((uint8_t *)ptr >= pool->base && (uint8_t *)ptr < pool->base + pool->block_size * pool->block_count) {
+            bit = ((uint8_t *)ptr - pool->base) / pool->block_size;
+            critical = ql_rtos_enter_critical();
+            pool->used_map[bit / 32] &= ~(1u << (bit % 32));
+            g_mbedtls_total_mem_used -= pool->block_size;
+            ql_rtos_exit_critical(critical);
+            return;
+        }
     }
 
-    g_mbedtls_total_mem_used -= mem_info->size;
-
-    free(mem_info);
+    /* not from pool, including the memory allocated before the pool is installed */
+    free(ptr);
 }
-*/
+#endif
 
+/* the idle TLS configuration kept for reconnect */
+static core_sysdep_tls_conf_t *g_tls_conf_cache = NULL;
 #endif
 
 
@@ -558,146 +643,299 @@ static int my_verify(void *data, mbedtls_x509_crt *crt,
     return (0);
 }
 
-static int32_t _core_sysdep_network_mbedtls_establish(core_network_handle_t *network_handle)
+static void _core_sysdep_tls_conf_free(core_sysdep_tls_conf_t *conf)
+{
+    if (conf == NULL) {
+        return;
+    }
+
+    mbedtls_ssl_session_free(&conf->session);
+    mbedtls_x509_crt_free(&conf->x509_server_cert);
+    mbedtls_x509_crt_free(&conf->x509_client_cert);
+    mbedtls_pk_free(&conf->x509_client_pk);
+    mbedtls_ssl_config_free(&conf->ssl_config);
+    if (conf->session_host != NULL) {
+        free(conf->session_host);
+    }
+    free(conf);
+}
+
+/* certificates are in static storage (see aiot_sysdep_network_cred_t), so they are compared by address */
+static uint8_t _core_sysdep_tls_conf_match(core_sysdep_tls_conf_t *conf, core_network_handle_t *network_handle)
+{
+    aiot_sysdep_network_cred_t *cred = network_handle->cred;
+
+    return (conf->socket_type == network_handle->socket_type &&
+            conf->cred.option == cred->option &&
+            conf->cred.max_tls_fragment == cred->max_tls_fragment &&
+            conf->cred.x509_server_cert == cred->x509_server_cert &&
+            conf->cred.x509_server_cert_len == cred->x509_server_cert_len &&
+            conf->cred.x509_client_cert == cred->x509_client_cert &&
+            conf->cred.x509_client_cert_len == cred->x509_client_cert_len &&
+            conf->cred.x509_client_privkey == cred->x509_client_privkey &&
+            conf->cred.x509_client_privkey_len == cred->x509_client_privkey_len);
+}
+
+static core_sysdep_tls_conf_t *_core_sysdep_tls_conf_take(core_network_handle_t *network_handle)
+{
+    core_sysdep_tls_conf_t *conf = NULL;
+    uint32_t critical = 0;
+
+    /* PSK is kept in ssl_config, configuration with PSK is not cached */
+    if (network_handle->cred->option != AIOT_SYSDEP_NETWORK_CRED_SVRCERT_CA) {
+        return NULL;
+    }
+
+    critical = ql_rtos_enter_critical();
+    if (g_tls_conf_cache != NULL && _core_sysdep_tls_conf_match(g_tls_conf_cache, network_handle)) {
+        conf = g_tls_conf_cache;
+        g_tls_conf_cache = NULL;
+    }
+    ql_rtos_exit_critical(critical);
+
+    return conf;
+}
+
+static void _core_sysdep_tls_conf_release(core_network_handle_t *network_handle)
+{
+    core_sysdep_tls_conf_t *conf = network_handle->mbedtls.conf, *prev = NULL;
+    uint32_t critical = 0;
+
+    if (conf == NULL) {
+        return;
+    }
+    network_handle->mbedtls.conf = NULL;
+
+    /* the last released one is kept, and the previous one is freed */
+    if (conf->cred.option == AIOT_SYSDEP_NETWORK_CRED_SVRCERT_CA) {
+        critical = ql_rtos_enter_critical();
+        prev = g_tls_conf_cache;
+        g_tls_conf_cache = conf;
+        ql_rtos_exit_critical(critical);
+        conf = prev;
+    }
+
+    _core_sysdep_tls_conf_free(conf);
+}
+
+static int32_t _core_sysdep_tls_conf_create(core_network_handle_t *network_handle, core_sysdep_tls_conf_t **conf_out)
 {
     int32_t res = 0;
-    char port_str[6] = {0};
-#if defined(MBEDTLS_DEBUG_C)
-    mbedtls_debug_set_threshold(4);
-#endif /* #if defined(MBEDTLS_DEBUG_C) */
-    mbedtls_net_init(&network_handle->mbedtls.net_ctx);
-    mbedtls_ssl_init(&network_handle->mbedtls.ssl_ctx);
-    mbedtls_ssl_config_init(&network_handle->mbedtls.ssl_config);
-//    mbedtls_platform_set_calloc_free(_core_mbedtls_calloc, _core_mbedtls_free);
-    g_mbedtls_total_mem_used = g_mbedtls_max_mem_used = 0;
+    core_sysdep_tls_conf_t *conf = NULL;
 
-    if (network_handle->cred->max_tls_fragment == 0) {
-        QL_ADAPT_LOG("invalid max_tls_fragment parameter\n");
-        return STATE_PORT_TLS_INVALID_MAX_FRAGMENT;
+    conf = malloc(sizeof(core_sysdep_tls_conf_t));
+    if (conf == NULL) {
+        return STATE_PORT_MALLOC_FAILED;
     }
-    QL_ADAPT_LOG("establish mbedtls connection with server(host='%s', port=[%u], profile_idx=[%d])\n", network_handle->host, network_handle->port,network_handle->profile_idx);
+    memset(conf, 0, sizeof(core_sysdep_tls_conf_t));
 
-    _port_uint2str(network_handle->port, port_str);
+    mbedtls_ssl_config_init(&conf->ssl_config);
+    mbedtls_x509_crt_init(&conf->x509_server_cert);
+    mbedtls_x509_crt_init(&conf->x509_client_cert);
+    mbedtls_pk_init(&conf->x509_client_pk);
+    mbedtls_ssl_session_init(&conf->session);
+    conf->socket_type = network_handle->socket_type;
+    memcpy(&conf->cred, network_handle->cred, sizeof(aiot_sysdep_network_cred_t));
 
     if (network_handle->cred->max_tls_fragment <= 512) {
-        res = mbedtls_ssl_conf_max_frag_len(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_512);
+        res = mbedtls_ssl_conf_max_frag_len(&conf->ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_512);
     } else if (network_handle->cred->max_tls_fragment <= 1024) {
-        res = mbedtls_ssl_conf_max_frag_len(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_1024);
+        res = mbedtls_ssl_conf_max_frag_len(&conf->ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_1024);
     } else if (network_handle->cred->max_tls_fragment <= 2048) {
-        res = mbedtls_ssl_conf_max_frag_len(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_2048);
+        res = mbedtls_ssl_conf_max_frag_len(&conf->ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_2048);
     } else if (network_handle->cred->max_tls_fragment <= 4096) {
-        res = mbedtls_ssl_conf_max_frag_len(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_4096);
+        res = mbedtls_ssl_conf_max_frag_len(&conf->ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_4096);
     } else {
-        res = mbedtls_ssl_conf_max_frag_len(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_NONE);
+        res = mbedtls_ssl_conf_max_frag_len(&conf->ssl_config, MBEDTLS_SSL_MAX_FRAG_LEN_NONE);
     }
 
     if (res < 0) {
         QL_ADAPT_LOG("mbedtls_ssl_conf_max_frag_len error, res: -0x%04X\n", -res);
-        return res;
-    }
-
-    if (network_handle->socket_type == CORE_SYSDEP_SOCKET_TCP_CLIENT) {
-        res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
-                AF_UNSPEC, SOCK_STREAM, IPPROTO_TCP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
-    } else if (network_handle->socket_type == CORE_SYSDEP_SOCKET_UDP_CLIENT) {
-        res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
-                AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
-    }
-
-    if (res == STATE_PORT_NETWORK_DNS_FAILED && (strlen(network_handle->backup_ip) > 0)) {
-        QL_ADAPT_LOG("using backup ip: %s\n", network_handle->backup_ip);
-        if (network_handle->socket_type == CORE_SYSDEP_SOCKET_TCP_CLIENT) {
-            res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
-                    AF_UNSPEC, SOCK_STREAM, IPPROTO_TCP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
-        } else if (network_handle->socket_type == CORE_SYSDEP_SOCKET_UDP_CLIENT) {
-            res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
-                    AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
-        }
-    }
-
-    if (res < STATE_SUCCESS) {
-        return res;
+        goto failed;
     }
 
     if (network_handle->socket_type == CORE_SYSDEP_SOCKET_TCP_CLIENT) {
-        res = mbedtls_ssl_config_defaults(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_IS_CLIENT,
+        res = mbedtls_ssl_config_defaults(&conf->ssl_config, MBEDTLS_SSL_IS_CLIENT,
                                         MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
     } else if (network_handle->socket_type == CORE_SYSDEP_SOCKET_UDP_CLIENT) {
-        res = mbedtls_ssl_config_defaults(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_IS_CLIENT,
+        res = mbedtls_ssl_config_defaults(&conf->ssl_config, MBEDTLS_SSL_IS_CLIENT,
                                         MBEDTLS_SSL_TRANSPORT_DATAGRAM, MBEDTLS_SSL_PRESET_DEFAULT);
     }
 
     if (res < 0) {
         QL_ADAPT_LOG("mbedtls_ssl_config_defaults error, res: -0x%04X\n", -res);
-        return res;
+        goto failed;
     }
 
-    mbedtls_ssl_conf_max_version(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_MAJOR_VERSION_3,
+    mbedtls_ssl_conf_max_version(&conf->ssl_config, MBEDTLS_SSL_MAJOR_VERSION_3,
                                  MBEDTLS_SSL_MINOR_VERSION_3);
-    mbedtls_ssl_conf_min_version(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_MAJOR_VERSION_3,
+    mbedtls_ssl_conf_min_version(&conf->ssl_config, MBEDTLS_SSL_MAJOR_VERSION_3,
                                  MBEDTLS_SSL_MINOR_VERSION_3);
-    mbedtls_ssl_conf_handshake_timeout(&network_handle->mbedtls.ssl_config,(MBEDTLS_SSL_DTLS_TIMEOUT_DFL_MIN * 2),
+    mbedtls_ssl_conf_handshake_timeout(&conf->ssl_config,(MBEDTLS_SSL_DTLS_TIMEOUT_DFL_MIN * 2),
                                 (MBEDTLS_SSL_DTLS_TIMEOUT_DFL_MIN * 2 * 4));
-    mbedtls_ssl_conf_rng(&network_handle->mbedtls.ssl_config, _mbedtls_random, NULL);
-    mbedtls_ssl_conf_dbg(&network_handle->mbedtls.ssl_config, _mbedtls_debug, "[MBEDTLS]");
-    mbedtls_ssl_conf_verify(&network_handle->mbedtls.ssl_config, my_verify, NULL);
+    mbedtls_ssl_conf_rng(&conf->ssl_config, _mbedtls_random, NULL);
+    mbedtls_ssl_conf_dbg(&conf->ssl_config, _mbedtls_debug, "[MBEDTLS]");
+    mbedtls_ssl_conf_verify(&conf->ssl_config, my_verify, NULL);
+    mbedtls_ssl_conf_authmode(&conf->ssl_config, MBEDTLS_SSL_VERIFY_OPTIONAL);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&conf->ssl_config, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
 
     if (network_handle->cred->option == AIOT_SYSDEP_NETWORK_CRED_SVRCERT_CA) {
         if (network_handle->cred->x509_server_cert == NULL && network_handle->cred->x509_server_cert_len == 0) {
             QL_ADAPT_LOG("invalid x509 server cert\n");
-            return STATE_PORT_TLS_INVALID_SERVER_CERT;
+            res = STATE_PORT_TLS_INVALID_SERVER_CERT;
+            goto failed;
         }
-        mbedtls_x509_crt_init(&network_handle->mbedtls.x509_server_cert);
 
-        res = mbedtls_x509_crt_parse(&network_handle->mbedtls.x509_server_cert,
+        res = mbedtls_x509_crt_parse(&conf->x509_server_cert,
                                      (const unsigned char *)network_handle->cred->x509_server_cert, (size_t)network_handle->cred->x509_server_cert_len + 1);
         if (res < 0) {
             QL_ADAPT_LOG("mbedtls_x509_crt_parse server cert error, res: -0x%04X\n", -res);
-            return STATE_PORT_TLS_INVALID_SERVER_CERT;
+            res = STATE_PORT_TLS_INVALID_SERVER_CERT;
+            goto failed;
         }
 
         if (network_handle->cred->x509_client_cert != NULL && network_handle->cred->x509_client_cert_len > 0 &&
             network_handle->cred->x509_client_privkey != NULL && network_handle->cred->x509_client_privkey_len > 0) {
-            mbedtls_x509_crt_init(&network_handle->mbedtls.x509_client_cert);
-            mbedtls_pk_init(&network_handle->mbedtls.x509_client_pk);
-            res = mbedtls_x509_crt_parse(&network_handle->mbedtls.x509_client_cert,
+            res = mbedtls_x509_crt_parse(&conf->x509_client_cert,
                                          (const unsigned char *)network_handle->cred->x509_client_cert, (size_t)network_handle->cred->x509_client_cert_len + 1);
             if (res < 0) {
                 QL_ADAPT_LOG("mbedtls_x509_crt_parse client cert error, res: -0x%04X\n", -res);
-                return STATE_PORT_TLS_INVALID_CLIENT_CERT;
+                res = STATE_PORT_TLS_INVALID_CLIENT_CERT;
+                goto failed;
             }
-            res = mbedtls_pk_parse_key(&network_handle->mbedtls.x509_client_pk,
+            res = mbedtls_pk_parse_key(&conf->x509_client_pk,
                                        (const unsigned char *)network_handle->cred->x509_client_privkey,
                                        (size_t)network_handle->cred->x509_client_privkey_len + 1, NULL, 0);
             if (res < 0) {
                 QL_ADAPT_LOG("mbedtls_pk_parse_key client pk error, res: -0x%04X\n", -res);
-                return STATE_PORT_TLS_INVALID_CLIENT_KEY;
+                res = STATE_PORT_TLS_INVALID_CLIENT_KEY;
+                goto failed;
             }
-            res = mbedtls_ssl_conf_own_cert(&network_handle->mbedtls.ssl_config, &network_handle->mbedtls.x509_client_cert,
-                                            &network_handle->mbedtls.x509_client_pk);
+            res = mbedtls_ssl_conf_own_cert(&conf->ssl_config, &conf->x509_client_cert, &conf->x509_client_pk);
             if (res < 0) {
                 QL_ADAPT_LOG("mbedtls_ssl_conf_own_cert error, res: -0x%04X\n", -res);
-                return STATE_PORT_TLS_INVALID_CLIENT_CERT;
+                res = STATE_PORT_TLS_INVALID_CLIENT_CERT;
+                goto failed;
             }
         }
-        mbedtls_ssl_conf_ca_chain(&network_handle->mbedtls.ssl_config, &network_handle->mbedtls.x509_server_cert, NULL);
+        mbedtls_ssl_conf_ca_chain(&conf->ssl_config, &conf->x509_server_cert, NULL);
     } else if (network_handle->cred->option == AIOT_SYSDEP_NETWORK_CRED_SVRCERT_PSK) {
         static const int ciphersuites[1] = {MBEDTLS_TLS_PSK_WITH_AES_128_CBC_SHA};
-        res = mbedtls_ssl_conf_psk(&network_handle->mbedtls.ssl_config,
+        res = mbedtls_ssl_conf_psk(&conf->ssl_config,
                                    (const unsigned char *)network_handle->psk.psk, (size_t)strlen(network_handle->psk.psk),
                                    (const unsigned char *)network_handle->psk.psk_id, (size_t)strlen(network_handle->psk.psk_id));
         if (res < 0) {
             QL_ADAPT_LOG("mbedtls_ssl_conf_psk error, res = -0x%04X\n", -res);
-            return STATE_PORT_TLS_CONFIG_PSK_FAILED;
+            res = STATE_PORT_TLS_CONFIG_PSK_FAILED;
+            goto failed;
         }
 
-        mbedtls_ssl_conf_ciphersuites(&network_handle->mbedtls.ssl_config, ciphersuites);
+        mbedtls_ssl_conf_ciphersuites(&conf->ssl_config, ciphersuites);
     } else {
         QL_ADAPT_LOG("unsupported security option\n");
-        return STATE_PORT_TLS_INVALID_CRED_OPTION;
+        res = STATE_PORT_TLS_INVALID_CRED_OPTION;
+        goto failed;
+    }
+
+    *conf_out = conf;
+    return 0;
+
+failed:
+    _core_sysdep_tls_conf_free(conf);
+    return res;
+}
+
+static uint8_t _core_sysdep_tls_session_match(core_sysdep_tls_conf_t *conf, core_network_handle_t *network_handle)
+{
+    return (conf->session_valid && conf->session_host != NULL &&
+            conf->session_port == network_handle->port &&
+            strcmp(conf->session_host, network_handle->host) == 0);
+}
+
+static void _core_sysdep_tls_session_save(core_sysdep_tls_conf_t *conf, core_network_handle_t *network_handle)
+{
+    conf->session_valid = 0;
+    if (conf->session_host != NULL && strcmp(conf->session_host, network_handle->host) != 0) {
+        free(conf->session_host);
+        conf->session_host = NULL;
+    }
+    if (conf->session_host == NULL) {
+        conf->session_host = malloc(strlen(network_handle->host) + 1);
+        if (conf->session_host == NULL) {
+            return;
+        }
+        memcpy(conf->session_host, network_handle->host, strlen(network_handle->host) + 1);
     }
+    conf->session_port = network_handle->port;
 
-    res = mbedtls_ssl_setup(&network_handle->mbedtls.ssl_ctx, &network_handle->mbedtls.ssl_config);
+    /* previous session is freed inside */
+    if (mbedtls_ssl_get_session(&network_handle->mbedtls.ssl_ctx, &conf->session) == 0) {
+        conf->session_valid = 1;
+    }
+}
+
+static int32_t _core_sysdep_network_mbedtls_establish(core_network_handle_t *network_handle)
+{
+    int32_t res = 0;
+    char port_str[6] = {0};
+    core_sysdep_tls_conf_t *conf = NULL;
+#if defined(MBEDTLS_DEBUG_C)
+    mbedtls_debug_set_threshold(4);
+#endif /* #if defined(MBEDTLS_DEBUG_C) */
+    mbedtls_net_init(&network_handle->mbedtls.net_ctx);
+    mbedtls_ssl_init(&network_handle->mbedtls.ssl_ctx);
+#ifdef CORE_SYSDEP_TLS_POOL_ENABLED
+    if (g_mbedtls_pool_installed == 0) {
+        mbedtls_platform_set_calloc_free(_core_mbedtls_calloc, _core_mbedtls_free);
+        g_mbedtls_pool_installed = 1;
+    }
+#endif
+
+    if (network_handle->cred->max_tls_fragment == 0) {
+        QL_ADAPT_LOG("invalid max_tls_fragment parameter\n");
+        return STATE_PORT_TLS_INVALID_MAX_FRAGMENT;
+    }
+    QL_ADAPT_LOG("establish mbedtls connection with server(host='%s', port=[%u], profile_idx=[%d])\n", network_handle->host, network_handle->port,network_handle->profile_idx);
+
+    _port_uint2str(network_handle->port, port_str);
+
+    if (network_handle->socket_type == CORE_SYSDEP_SOCKET_TCP_CLIENT) {
+        res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
+                AF_UNSPEC, SOCK_STREAM, IPPROTO_TCP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
+    } else if (network_handle->socket_type == CORE_SYSDEP_SOCKET_UDP_CLIENT) {
+        res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
+                AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
+    }
+
+    if (res == STATE_PORT_NETWORK_DNS_FAILED && (strlen(network_handle->backup_ip) > 0)) {
+        QL_ADAPT_LOG("using backup ip: %s\n", network_handle->backup_ip);
+        if (network_handle->socket_type == CORE_SYSDEP_SOCKET_TCP_CLIENT) {
+            res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
+                    AF_UNSPEC, SOCK_STREAM, IPPROTO_TCP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
+        } else if (network_handle->socket_type == CORE_SYSDEP_SOCKET_UDP_CLIENT) {
+            res = _core_sysdep_network_connect(network_handle->profile_idx, network_handle->host, network_handle->port,
+                    AF_UNSPEC, SOCK_DGRAM, IPPROTO_UDP, network_handle->connect_timeout_ms, &network_handle->mbedtls.net_ctx.fd);
+        }
+    }
+
+    if (res < STATE_SUCCESS) {
+        return res;
+    }
+
+    conf = _core_sysdep_tls_conf_take(network_handle);
+    if (conf == NULL) {
+        res = _core_sysdep_tls_conf_create(network_handle, &conf);
+        if (res < 0) {
+            return res;
+        }
+    } else {
+        QL_ADAPT_LOG("reuse cached tls config\n");
+    }
+    network_handle->mbedtls.conf = conf;
+
+    res = mbedtls_ssl_setup(&network_handle->mbedtls.ssl_ctx, &conf->ssl_config);
     if (res < 0) {
         QL_ADAPT_LOG("mbedtls_ssl_setup error, res: -0x%04X\n", -res);
         return res;
@@ -717,13 +955,20 @@ static int32_t _core_sysdep_network_mbedtls_establish(core_network_handle_t *net
     }
     mbedtls_ssl_set_bio(&network_handle->mbedtls.ssl_ctx, &network_handle->mbedtls.net_ctx, mbedtls_net_send,
                         mbedtls_net_recv, mbedtls_net_recv_timeout);
-    mbedtls_ssl_conf_read_timeout(&network_handle->mbedtls.ssl_config, network_handle->connect_timeout_ms);
+    mbedtls_ssl_conf_read_timeout(&conf->ssl_config, network_handle->connect_timeout_ms);
 
-	mbedtls_ssl_conf_authmode(&network_handle->mbedtls.ssl_config, MBEDTLS_SSL_VERIFY_OPTIONAL);
+    /* abbreviated handshake with the last session, it falls back to full handshake when server rejects */
+    if (_core_sysdep_tls_session_match(conf, network_handle)) {
+        res = mbedtls_ssl_set_session(&network_handle->mbedtls.ssl_ctx, &conf->session);
+        if (res < 0) {
+            QL_ADAPT_LOG("mbedtls_ssl_set_session error, res: -0x%04X\n", -res);
+        }
+    }
 
     while ((res = mbedtls_ssl_handshake(&network_handle->mbedtls.ssl_ctx)) != 0) {
         if ((res != MBEDTLS_ERR_SSL_WANT_READ) && (res != MBEDTLS_ERR_SSL_WANT_WRITE)) {
             QL_ADAPT_LOG("mbedtls_ssl_handshake error, res: -0x%04X\n", -res);
+            conf->session_valid = 0;
             if (res == MBEDTLS_ERR_SSL_INVALID_RECORD) {
                 res = STATE_PORT_TLS_INVALID_RECORD;
             } else {
@@ -739,9 +984,15 @@ static int32_t _core_sysdep_network_mbedtls_establish(core_network_handle_t *net
         return res;
     }
 
-    QL_ADAPT_LOG("success to establish mbedtls connection, fd = %d(cost %d bytes in total, max used %d bytes)\n",
+    _core_sysdep_tls_session_save(conf, network_handle);
+
+#ifdef CORE_SYSDEP_TLS_POOL_ENABLED
+    QL_ADAPT_LOG("success to establish mbedtls connection, fd = %d(pool %d bytes in use, max used %d bytes, %d heap allocs)\n",
            (int)network_handle->mbedtls.net_ctx.fd,
-           g_mbedtls_total_mem_used, g_mbedtls_max_mem_used);
+           g_mbedtls_total_mem_used, g_mbedtls_max_mem_used, g_mbedtls_heap_alloc_count);
+#else
+    QL_ADAPT_LOG("success to establish mbedtls connection, fd = %d\n", (int)network_handle->mbedtls.net_ctx.fd);
+#endif
 
     return 0;
 }
@@ -812,9 +1063,6 @@ static int32_t _core_sysdep_network_tcp_recv(core_network_handle_t *network_hand
     fd_set recv_sets;
     struct timeval timestart, timenow, timeselect;
 
-    FD_ZERO(&recv_sets);
-    FD_SET(network_handle->fd, &recv_sets);
-
     /* Start Time */
     gettimeofday(&timestart, NULL);
     timestart_ms = timestart.tv_sec * 1000 + timestart.tv_usec / 1000;
@@ -829,10 +1077,34 @@ static int32_t _core_sysdep_network_tcp_recv(core_network_handle_t *network_hand
             break;
         }
 
+        /* data already queued in lwIP is read without select */
+        recv_res = recv(network_handle->fd, buffer + recv_bytes, len - recv_bytes, MSG_DONTWAIT);
+        if (recv_res > 0) {
+            recv_bytes += recv_res;
+            /* QL_ADAPT_LOG("recv_bytes: %d, len: %d\n",recv_bytes,len); */
+            if (recv_bytes == len) {
+                break;
+            }
+            continue;
+        } else if (recv_res == 0) {
+            QL_ADAPT_LOG("_core_sysdep_network_tcp_recv, nwk connection closed\n");
+            return STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED;
+        }
+
+        res = lwip_get_error(network_handle->fd);
+        if (res == EINTR) {
+            continue;
+        } else if (res != EWOULDBLOCK && res != EAGAIN) {
+            QL_ADAPT_LOG("_core_sysdep_network_tcp_recv, errno: %d\n", res);
+            return STATE_PORT_NETWORK_RECV_FAILED;
+        }
+
         timeselect_ms = timeout_ms - (timenow_ms - timestart_ms);
         timeselect.tv_sec = timeselect_ms / 1000;
         timeselect.tv_usec = timeselect_ms % 1000 * 1000;
 
+        FD_ZERO(&recv_sets);
+        FD_SET(network_handle->fd, &recv_sets);
         res = select(network_handle->fd + 1, &recv_sets, NULL, NULL, &timeselect);
         if (res == 0) {
             /* QL_ADAPT_LOG("_core_sysdep_network_tcp_recv, nwk select timeout\n"); */
@@ -841,27 +1113,6 @@ static int32_t _core_sysdep_network_tcp_recv(core_network_handle_t *network_hand
             QL_ADAPT_LOG("_core_sysdep_network_tcp_recv, errno: %d\n", lwip_get_error(network_handle->fd));
           //  perror("_core_sysdep_network_tcp_recv, nwk select failed: ");
             return STATE_PORT_NETWORK_SELECT_FAILED;
-        } else {
-            if (FD_ISSET(network_handle->fd, &recv_sets)) {
-                recv_res = recv(network_handle->fd, buffer + recv_bytes, len - recv_bytes, 0);
-                if (recv_res == 0) {
-                    QL_ADAPT_LOG("_core_sysdep_network_tcp_recv, nwk connection closed\n");
-                    return STATE_PORT_NETWORK_RECV_CONNECTION_CLOSED;
-                } else if (recv_res < 0) {
-                    QL_ADAPT_LOG("_core_sysdep_network_tcp_recv, errno: %d\n", lwip_get_error(network_handle->fd));
-                 //   perror("_core_sysdep_network_tcp_recv, nwk recv error: ");
-                    if (lwip_get_error(network_handle->fd) == EINTR) {
-                        continue;
-                    }
-                    return STATE_PORT_NETWORK_RECV_FAILED;
-                } else {
-                    recv_bytes += recv_res;
-                    /* QL_ADAPT_LOG("recv_bytes: %d, len: %d\n",recv_bytes,len); */
-                    if (recv_bytes == len) {
-                        break;
-                    }
-                }
-            }
         }
     } while (((timenow_ms - timestart_ms) < timeout_ms) && (recv_bytes < len));
 
@@ -913,7 +1164,7 @@ static int32_t _core_sysdep_network_mbedtls_recv(core_network_handle_t *network_
     int res = 0;
     int32_t recv_bytes = 0;
 
-    mbedtls_ssl_conf_read_timeout(&network_handle->mbedtls.ssl_config, timeout_ms);
+    mbedtls_ssl_conf_read_timeout(&network_handle->mbedtls.conf->ssl_config, timeout_ms);
     do {
         res = mbedtls_ssl_read(&network_handle->mbedtls.ssl_ctx, buffer + recv_bytes, len - recv_bytes);
         if (res < 0) {
@@ -1231,14 +1482,8 @@ static void _core_sysdep_network_mbedtls_disconnect(core_network_handle_t *netwo
 {
     mbedtls_ssl_close_notify(&network_handle->mbedtls.ssl_ctx);
     mbedtls_net_free(&network_handle->mbedtls.net_ctx);
-    if (network_handle->cred->option == AIOT_SYSDEP_NETWORK_CRED_SVRCERT_CA) {
-        mbedtls_x509_crt_free(&network_handle->mbedtls.x509_server_cert);
-        mbedtls_x509_crt_free(&network_handle->mbedtls.x509_client_cert);
-        mbedtls_pk_free(&network_handle->mbedtls.x509_client_pk);
-    }
     mbedtls_ssl_free(&network_handle->mbedtls.ssl_ctx);
-    mbedtls_ssl_config_free(&network_handle->mbedtls.ssl_config);
-    g_mbedtls_total_mem_used = g_mbedtls_max_mem_used = 0;
+    _core_sysdep_tls_conf_release(network_handle);
 }
 #endif
 
@@ -9,91 +9,123 @@
 #include "ql_api_osi.h"
 #include "lvgl.h"
 
-#define TOUCH_QUEUE_SIZE      (20)
-ql_queue_t touch_data_queue = NULL;
+#include "osi_api.h"
+
+/* power of 2, only press/release transitions are queued */
+#define TOUCH_QUEUE_SIZE      (8)
+
+typedef struct {
+    lv_indev_data_t events[TOUCH_QUEUE_SIZE];
+    unsigned head;   //next to pop
+    unsigned tail;   //next to push
+    lv_indev_data_t last;   //last popped, returned when queue is empty
+} touch_queue_t;
+
+static touch_queue_t touch_queue;
+static osiWork_t *touch_read_work = NULL;
 
 
 ctp_funcs_t *ctp_func;
 
 
 
-static void ic_lvgl_queue_touch_event(lv_indev_data_t *event)
+/**
+ * Queue touch event, called in work queue thread.
+ *
+ * When the latest queued event is pressed, and the new event is also
+ * pressed, it is a move and the point is updated in place. So, LVGL
+ * always gets the latest point, and never lags behind the finger.
+ */
+static void ic_lvgl_queue_touch_event(const lv_indev_data_t *event)
 {
-    if (touch_data_queue != NULL && event) {
-        if(ql_rtos_queue_release(touch_data_queue, sizeof(lv_indev_data_t), (uint8_t *)event, 0) != QL_OSI_SUCCESS){
-                CTP_LOG("queue touch event fail"); 
-        }
+    uint32_t critical = ql_rtos_enter_critical();
+    unsigned count = touch_queue.tail - touch_queue.head;
+    lv_indev_data_t *latest = &touch_queue.events[(touch_queue.tail - 1) % TOUCH_QUEUE_SIZE];
+
+    if (count > 0 && latest->state == LV_INDEV_STATE_PR && event->state == LV_INDEV_STATE_PR) {
+        latest->point = event->point;
+    } else if (count > 0 && latest->state == event->state) {
+        //repeated release, nothing changed
+    } else {
+        if (count >= TOUCH_QUEUE_SIZE)
+            touch_queue.head++;   //drop the oldest transition
+        touch_queue.events[touch_queue.tail++ % TOUCH_QUEUE_SIZE] = *event;
     }
+    ql_rtos_exit_critical(critical);
 }
 
 static bool ic_lvgl_pop_touch_event(lv_indev_data_t *event)
 {
-    if (touch_data_queue != NULL && event) {
-        if(ql_rtos_queue_wait(touch_data_queue, (uint8_t *)event, sizeof(lv_indev_data_t), 0) == QL_OSI_SUCCESS){
-            return true;
-        }else{
-            //CTP_LOG("touch queue empty");
-            return false; 
-        }
+    bool popped = false;
+    uint32_t critical = ql_rtos_enter_critical();
+
+    if (touch_queue.tail != touch_queue.head) {
+        *event = touch_queue.events[touch_queue.head++ % TOUCH_QUEUE_SIZE];
+        popped = true;
     }
+    ql_rtos_exit_critical(critical);
+    return popped;
 }
 
+static bool ic_lvgl_touch_event_pending(void)
+{
+    uint32_t critical = ql_rtos_enter_critical();
+    bool pending = (touch_queue.tail != touch_queue.head);
+    ql_rtos_exit_critical(critical);
+    return pending;
+}
 
-static void ctp_interrupt_callback(void *ctx)
+/**
+ * Read touch IC in work queue thread. I2C transactions and trace are
+ * not suitable for interrupt.
+ */
+static void ctp_read_work_entry(void *ctx)
 {
     multi_touch_event_t tp_event = {0};
-    lv_indev_data_t lv_tp_event;
-    static ctp_pen_state_enum_t pre_state = PEN_UP;
-    ctp_pen_state_enum_t current_state;
+    lv_indev_data_t lv_tp_event = {0};
 
-    CTP_LOG("ctp_interrupt_callback");
-    if(ctp_func){
-        ctp_func->read(&tp_event);
-        CTP_LOG("tp_event, timestamp:%d, event:%s, x:%d, y:%d", 
-                tp_event.time_stamp, tp_event.model?"DOWN":"UP", tp_event.points[0].x, tp_event.points[0].y);
-        if(tp_event.model){
-            current_state = PEN_DOWN;
-        }else{
-            current_state = PEN_UP;
-        }
+    if (ctp_func == NULL)
+        return;
 
-        //if(current_state == pre_state) return;
+    ctp_func->read(&tp_event);
+    CTP_LOG("tp_event, timestamp:%d, event:%s, x:%d, y:%d",
+            tp_event.time_stamp, tp_event.model?"DOWN":"UP", tp_event.points[0].x, tp_event.points[0].y);
 
-        pre_state = current_state;
-
-        //send touch event to touch queue
-        lv_tp_event.point.x = tp_event.points[0].x;
-        lv_tp_event.point.y = tp_event.points[0].y;
-        lv_tp_event.state = current_state==PEN_DOWN?LV_INDEV_STATE_PR:LV_INDEV_STATE_REL;
-
-        ic_lvgl_queue_touch_event(&lv_tp_event);
+    //send touch event to touch queue
+    lv_tp_event.point.x = tp_event.points[0].x;
+    lv_tp_event.point.y = tp_event.points[0].y;
+    lv_tp_event.state = tp_event.model ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+    ic_lvgl_queue_touch_event(&lv_tp_event);
+}
 
-    }
+static void ctp_interrupt_callback(void *ctx)
+{
+    //interrupts before the work is executed are merged into one read
+    osiWorkEnqueue(touch_read_work, osiSysWorkQueueHighPriority());
 }
 
+/**
+ * The return value is "continue reading" of LVGL. Queued transitions
+ * are drained in one LVGL read period.
+ */
 static bool ic_lv_touch_screen_read_cb(lv_indev_drv_t * drv, lv_indev_data_t*data)
 {
-    static lv_indev_drv_t last_data = {0};
-
-    memcpy(data, &last_data, sizeof(lv_indev_data_t));
-    if(ic_lvgl_pop_touch_event(&last_data)){
-        CTP_LOG("%d, %d, state:%d", data->point.x, data->point.y, data->state);
-        return true;
-    }else{
-        //memset(&last_data, 0, sizeof(lv_indev_data_t));
-        return false;
+    if (ic_lvgl_pop_touch_event(&touch_queue.last)) {
+        CTP_LOG("%d, %d, state:%d", touch_queue.last.point.x, touch_queue.last.point.y, touch_queue.last.state);
     }
 
-    return false;
+    memcpy(data, &touch_queue.last, sizeof(lv_indev_data_t));
+    return ic_lvgl_touch_event_pending();
 }
 
 bool ctp_init(void)
 {
     CTP_LOG("ctp_init");
 
-    //create a queue for touch data
-    if(ql_rtos_queue_create(&touch_data_queue, sizeof(lv_indev_data_t), TOUCH_QUEUE_SIZE) != QL_OSI_SUCCESS){
-        CTP_LOG("create touch queue fail");
+    //create work to read touch data
+    touch_read_work = osiWorkCreate(ctp_read_work_entry, NULL, NULL);
+    if(touch_read_work == NULL){
+        CTP_LOG("create touch work fail");
         return false;
     }
 
@@ -34,7 +34,7 @@ WHEN              WHO         WHAT, WHERE, WHY
 #include "ql_log.h"
 #include "ql_api_camera.h"
 #include "ql_api_decoder.h"
-#include "ql_lcd.h"
+#include "decoder_scan.h"
 
 /*===========================================================================
  * Macro Definition
@@ -63,40 +63,38 @@ WHEN              WHO         WHAT, WHERE, WHY
 /*===========================================================================
  * Functions
  ===========================================================================*/
+static void ql_decoder_demo_result_cb(const unsigned char *result, void *ctx)
+{
+    QL_DECODER_LOG("Get QR code decode result %s", result);
+}
+
 void ql_decoder_demo_thread(void *param)
 {
-    uint16_t *pcamData =NULL;
-    int iret = 0;
-    unsigned char result[128] = {0};
     ql_cam_drv_s cam;
+    ql_decoder_scan_cfg_s cfg = {0};
+    ql_decoder_scan_stat_s stat;
     ql_CamInit(320, 240);
     ql_CamGetSensorInfo(&cam);
     ql_CamPowerOn();
     ql_qr_decoder_init();
-    if(ql_lcd_init() == QL_LCD_SUCCESS)
-        ql_lcd_display_on();
-    ql_CamPreview();
+
+    cfg.width = cam.img_width;
+    cfg.height = cam.img_height;
+    cfg.fmt = QL_DECODER_SCAN_YUV422;
+    cfg.luma_offset = 0;
+    cfg.downscale = false;
+    cfg.cb = ql_decoder_demo_result_cb;
+    if (!ql_decoder_scan_start(&cfg))
+    {
+        QL_DECODER_LOG("QR code scan start failed");
+        ql_rtos_task_delete(NULL);
+    }
+
     while(1)
     {
-        //ql_CamCaptureImage(&pcamData);
-        ql_camPrint(pcamData);
-        iret = ql_qr_image_decoder(pcamData, cam.img_width, cam.img_height);
-
-        if(iret == QL_DECODER_SUCCESS)
-		{
-			iret = ql_qr_get_decoder_result(result);
-			if(iret == QL_DECODER_SUCCESS)
-			{   
-				QL_DECODER_LOG("Get QR code decode result %s", result);
-			}
-			else		
-			{
-				QL_DECODER_LOG("QR code decode get result failed");
-			}
-		}
-		else
-			QL_DECODER_LOG("QR code decode failed");
-        ql_rtos_task_sleep_ms(200);
+        ql_rtos_task_sleep_ms(5000);
+        ql_decoder_scan_get_stat(&stat);
+        QL_DECODER_LOG("QR code scan frames %d dropped %d decoded %d", stat.frames, stat.dropped, stat.decoded);
     }
 }
 
@@ -0,0 +1,324 @@
+/**  @file
+  decoder_scan.c
+
+  @brief
+  This file is QR code scanning pipeline on camera stream .
+
+*/
+
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+
+/*===========================================================================
+ * include files
+ ===========================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "decoder_scan.h"
+#include "osi_api.h"
+#include "image_sensor.h"
+#include "ql_log.h"
+#include "ql_api_decoder.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define QL_DECODER_SCAN_NEON
+#endif
+
+/*===========================================================================
+ * Macro Definition
+ ===========================================================================*/
+#define QL_DECODER_SCAN_LOG_LEVEL           QL_LOG_LEVEL_INFO
+#define QL_DECODER_SCAN_LOG(msg, ...)       QL_LOG(QL_DECODER_SCAN_LOG_LEVEL, "ql_DECODERSCAN", msg, ##__VA_ARGS__)
+
+#define QL_DECODER_SCAN_STACK_SIZE          (10*1024)
+#define QL_DECODER_SCAN_PRIO                OSI_PRIORITY_NORMAL
+
+/*===========================================================================
+ * Struct
+ ===========================================================================*/
+
+typedef struct
+{
+    ql_decoder_scan_cfg_s cfg;
+    osiWorkQueue_t *wq;
+    osiWork_t *work;
+    uint16_t *image;            // gray image for decoder
+    uint16_t img_width;
+    uint16_t img_height;
+    volatile bool busy;         // decoder is working on image
+    ql_decoder_scan_stat_s stat;
+    unsigned char result[QL_DECODER_SCAN_RESULT_MAX];
+} ql_decoder_scan_ctx_t;
+
+/*===========================================================================
+ * Variate
+ ===========================================================================*/
+static ql_decoder_scan_ctx_t *g_decoder_scan = NULL;
+
+/*===========================================================================
+ * Functions
+ ===========================================================================*/
+
+/*
+ * Decoder image keeps the camera YUV422 layout, and luma is put into
+ * both bytes of each pixel. So it is a gray image no matter which byte
+ * the decoder takes as luma.
+ */
+static inline uint16_t ql_decoder_gray_pixel(unsigned y)
+{
+    return (uint16_t)(y | (y << 8));
+}
+
+static inline unsigned ql_decoder_rgb_luma(uint16_t p)
+{
+    unsigned r = p >> 11, g = (p >> 5) & 0x3f, b = p & 0x1f;
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    return (77 * r + 150 * g + 29 * b) >> 8;
+}
+
+#ifdef QL_DECODER_SCAN_NEON
+static inline uint16x8_t ql_decoder_rgb_luma_neon(uint16x8_t p)
+{
+    uint16x8_t r = vshrq_n_u16(p, 11);
+    uint16x8_t g = vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3f));
+    uint16x8_t b = vandq_u16(p, vdupq_n_u16(0x1f));
+    r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+    g = vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4));
+    b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+    uint16x8_t y = vmulq_n_u16(r, 77);
+    y = vmlaq_n_u16(y, g, 150);
+    y = vmlaq_n_u16(y, b, 29);
+    return vshrq_n_u16(y, 8);
+}
+#endif
+
+static void ql_decoder_yuv_to_gray(uint16_t *dst, const uint8_t *src, unsigned width, unsigned lo)
+{
+    unsigned x = 0;
+#ifdef QL_DECODER_SCAN_NEON
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x2_t v = vld2q_u8(src + x * 2);
+        uint8x16_t y = lo ? v.val[1] : v.val[0];
+        uint8x16x2_t o = {{y, y}};
+        vst2q_u8((uint8_t *)(dst + x), o);
+    }
+#endif
+    for (; x < width; x++)
+        dst[x] = ql_decoder_gray_pixel(src[x * 2 + lo]);
+}
+
+static void ql_decoder_yuv_to_gray_2x(uint16_t *dst, const uint8_t *r0, const uint8_t *r1,
+                                      unsigned out_width, unsigned lo)
+{
+    unsigned x = 0;
+#ifdef QL_DECODER_SCAN_NEON
+    for (; x + 16 <= out_width; x += 16)
+    {
+        const uint8_t *s0 = r0 + x * 4;
+        const uint8_t *s1 = r1 + x * 4;
+        uint8x16x2_t a = vld2q_u8(s0);
+        uint8x16x2_t b = vld2q_u8(s0 + 32);
+        uint8x16x2_t c = vld2q_u8(s1);
+        uint8x16x2_t d = vld2q_u8(s1 + 32);
+        uint16x8_t sa = vaddq_u16(vpaddlq_u8(lo ? a.val[1] : a.val[0]), vpaddlq_u8(lo ? c.val[1] : c.val[0]));
+        uint16x8_t sb = vaddq_u16(vpaddlq_u8(lo ? b.val[1] : b.val[0]), vpaddlq_u8(lo ? d.val[1] : d.val[0]));
+        uint8x16_t y = vcombine_u8(vrshrn_n_u16(sa, 2), vrshrn_n_u16(sb, 2));
+        uint8x16x2_t o = {{y, y}};
+        vst2q_u8((uint8_t *)(dst + x), o);
+    }
+#endif
+    for (; x < out_width; x++)
+    {
+        unsigned sum = r0[x * 4 + lo] + r0[x * 4 + 2 + lo] + r1[x * 4 + lo] + r1[x * 4 + 2 + lo];
+        dst[x] = ql_decoder_gray_pixel((sum + 2) >> 2);
+    }
+}
+
+static void ql_decoder_rgb_to_gray(uint16_t *dst, const uint16_t *src, unsigned width)
+{
+    unsigned x = 0;
+#ifdef QL_DECODER_SCAN_NEON
+    for (; x + 8 <= width; x += 8)
+    {
+        uint8x8_t y = vmovn_u16(ql_decoder_rgb_luma_neon(vld1q_u16(src + x)));
+        uint8x8x2_t o = {{y, y}};
+        vst2_u8((uint8_t *)(dst + x), o);
+    }
+#endif
+    for (; x < width; x++)
+        dst[x] = ql_decoder_gray_pixel(ql_decoder_rgb_luma(src[x]));
+}
+
+static void ql_decoder_rgb_to_gray_2x(uint16_t *dst, const uint16_t *r0, const uint16_t *r1, unsigned out_width)
+{
+    unsigned x = 0;
+#ifdef QL_DECODER_SCAN_NEON
+    for (; x + 8 <= out_width; x += 8)
+    {
+        uint16x8x2_t a = vld2q_u16(r0 + x * 2);
+        uint16x8x2_t c = vld2q_u16(r1 + x * 2);
+        uint16x8_t sum = vaddq_u16(ql_decoder_rgb_luma_neon(a.val[0]), ql_decoder_rgb_luma_neon(a.val[1]));
+        sum = vaddq_u16(sum, ql_decoder_rgb_luma_neon(c.val[0]));
+        sum = vaddq_u16(sum, ql_decoder_rgb_luma_neon(c.val[1]));
+        uint8x8_t y = vrshrn_n_u16(sum, 2);
+        uint8x8x2_t o = {{y, y}};
+        vst2_u8((uint8_t *)(dst + x), o);
+    }
+#endif
+    for (; x < out_width; x++)
+    {
+        unsigned sum = ql_decoder_rgb_luma(r0[x * 2]) + ql_decoder_rgb_luma(r0[x * 2 + 1]) +
+                       ql_decoder_rgb_luma(r1[x * 2]) + ql_decoder_rgb_luma(r1[x * 2 + 1]);
+        dst[x] = ql_decoder_gray_pixel((sum + 2) >> 2);
+    }
+}
+
+static void ql_decoder_scan_convert(ql_decoder_scan_ctx_t *s, const uint16_t *frame)
+{
+    const ql_decoder_scan_cfg_s *cfg = &s->cfg;
+    unsigned lo = cfg->luma_offset ? 1 : 0;
+    for (unsigned y = 0; y < s->img_height; y++)
+    {
+        uint16_t *dst = s->image + y * s->img_width;
+        if (cfg->downscale)
+        {
+            const uint16_t *r0 = frame + (y * 2) * cfg->width;
+            const uint16_t *r1 = r0 + cfg->width;
+            if (cfg->fmt == QL_DECODER_SCAN_RGB565)
+                ql_decoder_rgb_to_gray_2x(dst, r0, r1, s->img_width);
+            else
+                ql_decoder_yuv_to_gray_2x(dst, (const uint8_t *)r0, (const uint8_t *)r1, s->img_width, lo);
+        }
+        else
+        {
+            const uint16_t *src = frame + y * cfg->width;
+            if (cfg->fmt == QL_DECODER_SCAN_RGB565)
+                ql_decoder_rgb_to_gray(dst, src, s->img_width);
+            else
+                ql_decoder_yuv_to_gray(dst, (const uint8_t *)src, s->img_width, lo);
+        }
+    }
+}
+
+static void ql_decoder_scan_work(void *param)
+{
+    ql_decoder_scan_ctx_t *s = (ql_decoder_scan_ctx_t *)param;
+    if (ql_qr_image_decoder(s->image, s->img_width, s->img_height) == QL_DECODER_SUCCESS &&
+        ql_qr_get_decoder_result(s->result) == QL_DECODER_SUCCESS)
+    {
+        s->stat.decoded++;
+        if (s->cfg.cb != NULL)
+            s->cfg.cb(s->result, s->cfg.cb_ctx);
+    }
+    s->busy = false;
+}
+
+/*
+ * Called in camera stream thread. The camera frame buffer is given back
+ * to camera after return, so the frame is converted here, and decoded in
+ * decoder work queue.
+ */
+static void ql_decoder_scan_frame_cb(const drvCamFrame_t *frame, void *ctx)
+{
+    ql_decoder_scan_ctx_t *s = (ql_decoder_scan_ctx_t *)ctx;
+    s->stat.frames++;
+    if (s->busy)
+    {
+        s->stat.dropped++;
+        return;
+    }
+
+    ql_decoder_scan_convert(s, frame->buf);
+    s->busy = true;
+    osiWorkEnqueue(s->work, s->wq);
+}
+
+static void ql_decoder_scan_destroy(ql_decoder_scan_ctx_t *s)
+{
+    osiWorkDelete(s->work);
+    osiWorkQueueDelete(s->wq);
+    free(s->image);
+    free(s);
+}
+
+bool ql_decoder_scan_start(const ql_decoder_scan_cfg_s *cfg)
+{
+    if (g_decoder_scan != NULL || cfg == NULL || cfg->width < 2 || cfg->height < 2)
+        return false;
+
+    ql_decoder_scan_ctx_t *s = (ql_decoder_scan_ctx_t *)calloc(1, sizeof(ql_decoder_scan_ctx_t));
+    if (s == NULL)
+        return false;
+
+    unsigned div = cfg->downscale ? 2 : 1;
+    s->cfg = *cfg;
+    s->img_width = cfg->width / div;
+    s->img_height = cfg->height / div;
+    s->image = (uint16_t *)malloc(s->img_width * s->img_height * sizeof(uint16_t));
+    s->wq = osiWorkQueueCreate("qr_scan", 1, QL_DECODER_SCAN_PRIO, QL_DECODER_SCAN_STACK_SIZE);
+    s->work = osiWorkCreate(ql_decoder_scan_work, NULL, s);
+    if (s->image == NULL || s->wq == NULL || s->work == NULL)
+    {
+        QL_DECODER_SCAN_LOG("QR scan create failed");
+        ql_decoder_scan_destroy(s);
+        return false;
+    }
+
+    g_decoder_scan = s;
+    if (!drvCamStartStream(ql_decoder_scan_frame_cb, s))
+    {
+        QL_DECODER_SCAN_LOG("QR scan camera stream start failed");
+        g_decoder_scan = NULL;
+        ql_decoder_scan_destroy(s);
+        return false;
+    }
+
+    QL_DECODER_SCAN_LOG("QR scan start %dx%d", s->img_width, s->img_height);
+    return true;
+}
+
+void ql_decoder_scan_stop(void)
+{
+    ql_decoder_scan_ctx_t *s = g_decoder_scan;
+    if (s == NULL)
+        return;
+
+    drvCamStopStream();
+    osiWorkWaitFinish(s->work, OSI_WAIT_FOREVER);
+    g_decoder_scan = NULL;
+
+    QL_DECODER_SCAN_LOG("QR scan stop, frames %d dropped %d decoded %d",
+                        s->stat.frames, s->stat.dropped, s->stat.decoded);
+    ql_decoder_scan_destroy(s);
+}
+
+void ql_decoder_scan_get_stat(ql_decoder_scan_stat_s *stat)
+{
+    ql_decoder_scan_ctx_t *s = g_decoder_scan;
+    if (stat == NULL)
+        return;
+
+    if (s == NULL)
+        memset(stat, 0, sizeof(*stat));
+    else
+        *stat = s->stat;
+}
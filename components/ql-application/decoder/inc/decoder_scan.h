@@ -0,0 +1,127 @@
+/**  @file
+  decoder_scan.h
+
+  @brief
+  This file is QR code scanning pipeline on camera stream .
+
+*/
+
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+
+#ifndef _DECODERSCAN_H
+#define _DECODERSCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ * Macro Definition
+ ===========================================================================*/
+
+#define QL_DECODER_SCAN_RESULT_MAX     (128)
+
+/*===========================================================================
+ * Enum
+ ===========================================================================*/
+
+typedef enum
+{
+    QL_DECODER_SCAN_YUV422,     // camera YUV422, 16 bits each pixel
+    QL_DECODER_SCAN_RGB565,
+} ql_decoder_scan_fmt_e;
+
+/*===========================================================================
+ * Struct
+ ===========================================================================*/
+
+/*
+ * Scan result callback, called in decoder work queue.
+ */
+typedef void (*ql_decoder_scan_cb_t)(const unsigned char *result, void *ctx);
+
+typedef struct
+{
+    uint16_t width;             // camera frame width
+    uint16_t height;            // camera frame height
+    ql_decoder_scan_fmt_e fmt;  // camera frame format
+    uint8_t luma_offset;        // byte offset of Y in YUV422 pixel, 0 or 1
+    bool downscale;             // decode on 2x downscaled image
+    ql_decoder_scan_cb_t cb;    // scan result callback
+    void *cb_ctx;               // scan result callback context
+} ql_decoder_scan_cfg_s;
+
+typedef struct
+{
+    uint32_t frames;            // frames from camera stream
+    uint32_t dropped;           // frames dropped when decoder is busy
+    uint32_t decoded;           // frames decoded successfully
+} ql_decoder_scan_stat_s;
+
+/*===========================================================================
+ * Functions
+ ===========================================================================*/
+
+/*****************************************************************
+* Function: ql_decoder_scan_start
+*
+* Description: start QR code scanning on camera stream
+*
+* The camera frame is converted to a gray image in camera stream thread,
+* optionally 2x downscaled, and decoded in decoder work queue. When the
+* decoder is busy, the camera frame is dropped, and camera stream and
+* preview won't be blocked.
+*
+* Camera should be powered on, and decoder should be initialized.
+*
+* Parameters:
+*   cfg         [in]    scan configuration
+*
+* Return:
+* 	true on success
+*
+*****************************************************************/
+bool ql_decoder_scan_start(const ql_decoder_scan_cfg_s *cfg);
+
+/*****************************************************************
+* Function: ql_decoder_scan_stop
+*
+* Description: stop QR code scanning, and camera stream
+*
+*****************************************************************/
+void ql_decoder_scan_stop(void);
+
+/*****************************************************************
+* Function: ql_decoder_scan_get_stat
+*
+* Description: get scanning statistics
+*
+* Parameters:
+*   stat        [out]   scanning statistics
+*
+*****************************************************************/
+void ql_decoder_scan_get_stat(ql_decoder_scan_stat_s *stat);
+
+#ifdef __cplusplus
+    } /*"C" */
+#endif
+
+#endif /* _DECODERSCAN_H */
+
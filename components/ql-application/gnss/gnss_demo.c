@@ -26,8 +26,11 @@ WHEN              WHO         WHAT, WHERE, WHY
 #include "ql_log.h"
 
 #include "gnss_demo.h"
+#include "nmea_stream.h"
 
 #include "ql_uart.h"
+#include "osi_api.h"
+#include "net_time_sync.h"
 /*===========================================================================
  * Macro Definition
  ===========================================================================*/
@@ -62,18 +65,57 @@ void ql_gnss_notify_cb(uint32 ind_type, ql_uart_port_number_e port, uint32 size)
     }
 }
 
+static void ql_gnss_nmea_cb(const nmea_sentence_t *sentence, void *ctx)
+{
+    ql_gnss_data_t *gps_data = (ql_gnss_data_t *)ctx;
+
+    if (sentence->type == NMEA_UNKNOWN)
+    {
+        /* response of ql_gnss_device_info_get */
+        if (sentence->word.len == 7 && memcmp(sentence->word.ptr, "PDTINFO", 7) == 0 && sentence->field_count > 0)
+        {
+            const nmea_span_t *first = &sentence->fields[0];
+            const nmea_span_t *last = &sentence->fields[sentence->field_count - 1];
+            int len = jmin((int)sizeof(device_info) - 1, (int)(last->ptr + last->len - first->ptr));
+
+            memcpy(device_info, first->ptr, len);
+            device_info[len] = '\0';
+            nmea_dbg_log("gnss device info get success\r\n");
+        }
+        return;
+    }
+
+    if (nmea_stream_value_update(sentence, gps_data) != 0)
+    {
+        QL_GNSSDEMO_LOG("nmea_value_update error. \r\n");
+        return;
+    }
+
+    /* time of valid fix is fed to time service, it is dropped there
+       when current time is already accurate enough */
+    if (sentence->type == NMEA_RMC && gps_data->valid)
+    {
+        struct tm tm = gps_data->time;
+        tm.tm_mon -= 1; /* nmea month is 1-12 */
+        netTimeSyncFeed(NET_TIME_SOURCE_GNSS, (int64_t)mktime(&tm) * 1000,
+                        osiUpTime(), NET_TIME_SYNC_GNSS_ERROR);
+    }
+}
+
 static void ql_gnss_demo_thread(void *param)
 {
     
     QL_GNSSDEMO_LOG("gnss demo thread enter, param 0x%x", param);
     ql_event_t event;
     int ret=0;
-    static int total_bytes = 0;
-	static char buffer[1024]={0};
-	unsigned char nmea_buff[256];
-	char *start, *end;
-    struct nmea_s *nmea = NULL;
-    unsigned char *recbuff=NULL;
+    static unsigned char recbuff[QUEC_GPS_RECBUF_LEN_MAX];
+    static nmea_stream_t nmea_stream;
+
+    /* GSV isn't used by nmea_stream_value_update, skip it without parsing */
+    nmea_stream_init(&nmea_stream,
+                     NMEA_STREAM_TYPE_BIT(NMEA_RMC) | NMEA_STREAM_TYPE_BIT(NMEA_GGA) |
+                     NMEA_STREAM_TYPE_BIT(NMEA_GSA) | NMEA_STREAM_TYPE_BIT(NMEA_UNKNOWN),
+                     ql_gnss_nmea_cb, &g_gps_data);
     
     /* open GNSS */
     ret = ql_gnss_switch(GNSS_ENABLE);
@@ -102,83 +144,24 @@ static void ql_gnss_demo_thread(void *param)
         }
         if( event.id == QUEC_UART_RX_RECV_DATA_IND )
         {
-        	recbuff=calloc(1,QUEC_GPS_RECBUF_LEN_MAX);
-            if(NULL==recbuff)
-        	{
-        		QL_GNSSDEMO_LOG("malloc err\r\n");
-        		break; 
-        	}   
-            if(ql_gnss_nmea_get( event.param1,recbuff, event.param2)<0)
-            {
-                break; 
-            }  
-            memcpy(buffer+total_bytes, recbuff, event.param2);
-            if(NULL != recbuff)
+            uint32 remain = event.param2;
+
+            /* sentences are tokenized in recbuff, only the unfinished
+               tail is kept in nmea_stream */
+            while (remain > 0)
             {
-                free(recbuff);
-                recbuff=NULL;
+                uint32 size = jmin(remain, sizeof(recbuff));
+
+                if(ql_gnss_nmea_get(event.param1, recbuff, size)<0)
+                {
+                    goto exit;
+                }
+                nmea_stream_feed(&nmea_stream, (const char *)recbuff, size);
+                remain -= size;
             }
-           if(event.param2>0)
-           {
-             total_bytes += event.param2;
-             if (total_bytes > sizeof(buffer)-150) 
-             {
-               total_bytes = 0;
-               QL_GNSSDEMO_LOG("nmea data Overflow\r\n");
-               break;
-             }           
-             end=buffer;
-               while(1)
-               {  
-                   start = memchr(end, '$', total_bytes-(end-buffer));
-                   if (NULL == start) {
-                       total_bytes = 0;
-                        break;
-                   }
-                   end = memchr(start, NMEA_END_CHAR_1, total_bytes-(start-buffer));
-                   if (NULL==end || NMEA_END_CHAR_2 != *(++end)) {
-                      if (buffer != memmove(buffer, start, total_bytes-(start-buffer))) {
-                      total_bytes = 0;
-                    }   
-                      total_bytes = total_bytes-(start-buffer);
-                      break;
-                   }
-                   memset(nmea_buff, 0, sizeof(nmea_buff));
-                   memcpy(nmea_buff, start, jmin(sizeof(nmea_buff)-1, end-start-1));
-                   QL_GNSSDEMO_LOG("%s\r\n", nmea_buff);       
-                   /* nmea string parse */
-                   nmea = nmea_parse(start, end-start+1, 1);
-                   if (nmea)
-                   {
-                           ret=nmea_value_update(nmea, &g_gps_data);
-                           if(ret)
-                           {
-                               QL_GNSSDEMO_LOG("nmea_value_update error. \r\n");
-                               QL_GNSSDEMO_LOG("GSV: %s", nmea_buff);
-                           }
-                           if (nmea->data) {
-                               free(nmea->data);
-                               nmea->data = NULL;
-                           }
-                           free(nmea);
-                           nmea = NULL; 
-                   }
-                   if(end==buffer+total_bytes)
-                   {
-                      total_bytes=0;
-                      break; 
-                   }
-                    end=end+1;
-               }
-             }
-           }
-       }
-exit:
-    if(NULL != recbuff)
-    {
-        free(recbuff);
-        recbuff=NULL;
+        }
     }
+exit:
     ql_gnss_switch(GNSS_DISABLE);
     QL_GNSSDEMO_LOG("gnss demo thread exit, param 0x%x", param);
     ql_rtos_task_delete(NULL);
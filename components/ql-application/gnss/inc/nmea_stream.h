@@ -0,0 +1,130 @@
+/*=================================================================
+
+						EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN			  WHO		  WHAT, WHERE, WHY
+------------	 -------	 -------------------------------------------------------------------------------
+
+=================================================================*/
+
+
+#ifndef _NMEA_STREAM_H
+#define _NMEA_STREAM_H
+
+#include "ql_gnss.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===========================================================================
+ * Macro Definition
+ ===========================================================================*/
+/* longest sentence kept across two feeds, including "$" and "\r\n" */
+#define NMEA_STREAM_LINE_MAX        (128)
+/* maximum fields of one sentence, GSV has 20 */
+#define NMEA_STREAM_FIELD_MAX       (24)
+
+/* bit of sentence type in filter */
+#define NMEA_STREAM_TYPE_BIT(type)  (1u << (type))
+#define NMEA_STREAM_TYPE_ALL        (0xffffffffu)
+
+/*===========================================================================
+ * Struct
+ ===========================================================================*/
+/**
+ * span of characters inside the fed data, not null terminated
+ */
+typedef struct
+{
+    const char *ptr;
+    int len;
+} nmea_span_t;
+
+/**
+ * tokenized sentence
+ *
+ * All spans point to the data passed to nmea_stream_feed, or to the
+ * line buffer of the stream when the sentence crosses two feeds. They
+ * are only valid inside the callback.
+ */
+typedef struct
+{
+    nmea_type type;
+    satellite_type sat_type;
+    /* address field without "$", such as "GNRMC" or "PDTINFO" */
+    nmea_span_t word;
+    /* fields after address field, checksum excluded */
+    int field_count;
+    nmea_span_t fields[NMEA_STREAM_FIELD_MAX];
+} nmea_sentence_t;
+
+typedef void (*nmea_stream_cb_t)(const nmea_sentence_t *sentence, void *ctx);
+
+typedef struct
+{
+    uint32 filter;
+    nmea_stream_cb_t cb;
+    void *ctx;
+    /* tail of the sentence not finished in last feed */
+    int line_len;
+    char line[NMEA_STREAM_LINE_MAX];
+    /* statistics */
+    uint32 sentences;
+    uint32 filtered;
+    uint32 checksum_err;
+    uint32 format_err;
+} nmea_stream_t;
+
+/*===========================================================================
+ * Functions declaration
+ ===========================================================================*/
+/**
+ * initialize NMEA stream tokenizer
+ *
+ * filter is the bit mask of NMEA_STREAM_TYPE_BIT(type). Sentences with
+ * type not in filter are skipped before checksum and tokenizing. For
+ * proprietary sentences, such as $PDTINFO, NMEA_UNKNOWN should be set.
+ */
+void nmea_stream_init(nmea_stream_t *stream, uint32 filter, nmea_stream_cb_t cb, void *ctx);
+
+/**
+ * feed received data
+ *
+ * Data are tokenized in place, without copy, except the unfinished
+ * sentence at the end. For ring buffer, each continuous span can be
+ * fed separately. Sentences with mismatched checksum are dropped.
+ */
+void nmea_stream_feed(nmea_stream_t *stream, const char *data, int len);
+
+/**
+ * drop the unfinished sentence
+ */
+void nmea_stream_reset(nmea_stream_t *stream);
+
+/**
+ * convert field to integer, 0 for empty field
+ */
+int nmea_span_to_int(nmea_span_t span);
+
+/**
+ * convert field to double, 0 for empty field
+ */
+double nmea_span_to_double(nmea_span_t span);
+
+/**
+ * update gnss data from RMC, GGA and GSA, other types are ignored
+ *
+ * Return 0 on success, -1 on invalid sentence.
+ */
+int nmea_stream_value_update(const nmea_sentence_t *sentence, ql_gnss_data_t *gps_data);
+
+#ifdef __cplusplus
+} /*"C" */
+#endif
+
+#endif /* _NMEA_STREAM_H */
+
@@ -0,0 +1,435 @@
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+
+
+/*===========================================================================
+ * include files
+ ===========================================================================*/
+#include <string.h>
+
+#include "nmea_stream.h"
+
+/*===========================================================================
+ * Functions
+ ===========================================================================*/
+static nmea_type _nmea_word_type(const char *word, int len)
+{
+    static const struct
+    {
+        char name[4];
+        nmea_type type;
+    } types[] = {
+        {"RMC", NMEA_RMC},
+        {"GGA", NMEA_GGA},
+        {"GSA", NMEA_GSA},
+        {"GSV", NMEA_GSV},
+        {"VTG", NMEA_VTG},
+        {"TXT", NMEA_TXT},
+    };
+    int i;
+
+    /* 2 characters talker and 3 characters sentence type */
+    if (NMEA_PREFIX_LENGTH != len) {
+        return NMEA_UNKNOWN;
+    }
+
+    for (i = 0; i < ARRAY_LENGTH(types); i++) {
+        if (0 == memcmp(word + 2, types[i].name, 3)) {
+            return types[i].type;
+        }
+    }
+    return NMEA_UNKNOWN;
+}
+
+static satellite_type _nmea_word_satellite(const char *word, int len)
+{
+    if (len < 2) {
+        return SAT_UNKNOWN;
+    }
+
+    if (0 == memcmp(word, "GP", 2)) {
+        return SAT_GPS;
+    } else if (0 == memcmp(word, "GL", 2)) {
+        return SAT_GLONASS;
+    } else if (0 == memcmp(word, "GA", 2)) {
+        return SAT_GALILEO;
+    } else if (0 == memcmp(word, "GB", 2) || 0 == memcmp(word, "BD", 2)) {
+        return SAT_BDS;
+    } else if (0 == memcmp(word, "GN", 2)) {
+        return SAT_MULSYS;
+    }
+    return SAT_UNKNOWN;
+}
+
+static int _nmea_hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Handle one sentence, starts with '$' and ends with '\n'.
+ *
+ * Type filter is checked before checksum and tokenizing, so skipped
+ * sentences cost only the scan of the address field.
+ */
+static void _nmea_stream_sentence(nmea_stream_t *stream, const char *line, int len)
+{
+    nmea_sentence_t sentence;
+    const char *end = line + len - 1;
+    const char *body_end;
+    const char *p;
+
+    if (end > line && NMEA_END_CHAR_1 == end[-1]) {
+        end--;
+    }
+
+    /* address field */
+    p = line + 1;
+    while (p < end && ',' != *p && '*' != *p) {
+        p++;
+    }
+    sentence.word.ptr = line + 1;
+    sentence.word.len = p - (line + 1);
+    if (sentence.word.len < 2) {
+        stream->format_err++;
+        return;
+    }
+
+    sentence.type = _nmea_word_type(sentence.word.ptr, sentence.word.len);
+    if (0 == (stream->filter & NMEA_STREAM_TYPE_BIT(sentence.type))) {
+        stream->filtered++;
+        return;
+    }
+
+    /* checksum is optional, and it is checked when exists */
+    body_end = end;
+    if (end - line >= 4 && '*' == end[-3]) {
+        int hi = _nmea_hex_value(end[-2]);
+        int lo = _nmea_hex_value(end[-1]);
+        unsigned char chk = 0;
+        const char *c;
+
+        if (hi < 0 || lo < 0) {
+            stream->format_err++;
+            return;
+        }
+
+        body_end = end - 3;
+        for (c = line + 1; c < body_end; c++) {
+            chk ^= (unsigned char)*c;
+        }
+        if (chk != ((hi << 4) | lo)) {
+            stream->checksum_err++;
+            return;
+        }
+    }
+
+    /* fields, extra fields are ignored */
+    sentence.field_count = 0;
+    if (p < body_end && ',' == *p) {
+        p++;
+        for (;;) {
+            const char *comma = memchr(p, ',', body_end - p);
+
+            if (NULL == comma) {
+                comma = body_end;
+            }
+            if (sentence.field_count < NMEA_STREAM_FIELD_MAX) {
+                sentence.fields[sentence.field_count].ptr = p;
+                sentence.fields[sentence.field_count].len = comma - p;
+                sentence.field_count++;
+            }
+            if (comma >= body_end) {
+                break;
+            }
+            p = comma + 1;
+        }
+    }
+
+    sentence.sat_type = _nmea_word_satellite(sentence.word.ptr, sentence.word.len);
+    stream->sentences++;
+    if (NULL != stream->cb) {
+        stream->cb(&sentence, stream->ctx);
+    }
+}
+
+void nmea_stream_init(nmea_stream_t *stream, uint32 filter, nmea_stream_cb_t cb, void *ctx)
+{
+    if (NULL == stream) {
+        return;
+    }
+
+    memset(stream, 0, sizeof(nmea_stream_t));
+    stream->filter = filter;
+    stream->cb = cb;
+    stream->ctx = ctx;
+}
+
+void nmea_stream_reset(nmea_stream_t *stream)
+{
+    if (NULL != stream) {
+        stream->line_len = 0;
+    }
+}
+
+void nmea_stream_feed(nmea_stream_t *stream, const char *data, int len)
+{
+    const char *p = data;
+    const char *end = data + len;
+
+    if (NULL == stream || NULL == data || len <= 0) {
+        return;
+    }
+
+    while (p < end) {
+        if (stream->line_len > 0) {
+            /* continue the sentence of last feed */
+            const char *eol = memchr(p, NMEA_END_CHAR_2, end - p);
+            const char *chunk_end = (NULL != eol) ? eol + 1 : end;
+            const char *restart = memchr(p, '$', chunk_end - p);
+            int size;
+
+            if (NULL != restart) {
+                /* last sentence is truncated */
+                stream->format_err++;
+                stream->line_len = 0;
+                p = restart;
+                continue;
+            }
+
+            size = chunk_end - p;
+            if (stream->line_len + size > NMEA_STREAM_LINE_MAX) {
+                stream->format_err++;
+                stream->line_len = 0;
+                p = chunk_end;
+                continue;
+            }
+
+            memcpy(stream->line + stream->line_len, p, size);
+            stream->line_len += size;
+            p = chunk_end;
+            if (NULL != eol) {
+                _nmea_stream_sentence(stream, stream->line, stream->line_len);
+                stream->line_len = 0;
+            }
+        } else {
+            const char *start = memchr(p, '$', end - p);
+            const char *eol;
+            const char *restart;
+
+            if (NULL == start) {
+                break;
+            }
+
+            eol = memchr(start, NMEA_END_CHAR_2, end - start);
+            if (NULL == eol) {
+                /* unfinished, keep it for next feed */
+                if (end - start > NMEA_STREAM_LINE_MAX) {
+                    stream->format_err++;
+                } else {
+                    memcpy(stream->line, start, end - start);
+                    stream->line_len = end - start;
+                }
+                break;
+            }
+
+            restart = memchr(start + 1, '$', eol - start - 1);
+            if (NULL != restart) {
+                /* this sentence is truncated */
+                stream->format_err++;
+                p = restart;
+                continue;
+            }
+
+            /* the whole sentence is in data, no copy */
+            _nmea_stream_sentence(stream, start, eol + 1 - start);
+            p = eol + 1;
+        }
+    }
+}
+
+int nmea_span_to_int(nmea_span_t span)
+{
+    const char *p = span.ptr;
+    const char *end = span.ptr + span.len;
+    int negative = 0;
+    int value = 0;
+
+    if (p < end && ('-' == *p || '+' == *p)) {
+        negative = ('-' == *p);
+        p++;
+    }
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    return negative ? -value : value;
+}
+
+double nmea_span_to_double(nmea_span_t span)
+{
+    const char *p = span.ptr;
+    const char *end = span.ptr + span.len;
+    int negative = 0;
+    double value = 0;
+    double scale = 1;
+
+    if (p < end && ('-' == *p || '+' == *p)) {
+        negative = ('-' == *p);
+        p++;
+    }
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    if (p < end && '.' == *p) {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            scale *= 10;
+            p++;
+        }
+    }
+    value /= scale;
+    return negative ? -value : value;
+}
+
+static nmea_span_t _nmea_field(const nmea_sentence_t *sentence, int index)
+{
+    nmea_span_t empty = {NULL, 0};
+
+    if (index >= sentence->field_count) {
+        return empty;
+    }
+    return sentence->fields[index];
+}
+
+static int _nmea_digits2(const char *p)
+{
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+/**
+ * Parse position of ddmm.mmmm and cardinal direction into degrees.
+ * Empty fields are 0 and unknown direction, the same as nmea_parse.
+ */
+static int _nmea_position(nmea_span_t value, nmea_span_t cardinal, double *degrees, unsigned char *dir)
+{
+    double v;
+    int d;
+
+    *degrees = 0;
+    *dir = NMEA_CARDINAL_DIR_UNKNOWN;
+    if (value.len > 0) {
+        if (NULL == memchr(value.ptr, '.', value.len)) {
+            return -1;
+        }
+        v = nmea_span_to_double(value);
+        d = (int)(v / 100);
+        *degrees = d + (v - d * 100) / 60;
+    }
+
+    if (cardinal.len > 0) {
+        switch (cardinal.ptr[0]) {
+        case NMEA_CARDINAL_DIR_NORTH:
+        case NMEA_CARDINAL_DIR_EAST:
+        case NMEA_CARDINAL_DIR_SOUTH:
+        case NMEA_CARDINAL_DIR_WEST:
+            *dir = cardinal.ptr[0];
+            break;
+        default:
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int nmea_stream_value_update(const nmea_sentence_t *sentence, ql_gnss_data_t *gps_data)
+{
+    if (NULL == sentence || NULL == gps_data) {
+        return -1;
+    }
+
+    switch (sentence->type) {
+    case NMEA_RMC: {
+        nmea_span_t status = _nmea_field(sentence, NMEA_GPRMC_STATUS);
+        nmea_span_t time = _nmea_field(sentence, NMEA_GPRMC_TIME);
+        nmea_span_t date = _nmea_field(sentence, NMEA_GPRMC_DATE);
+        double longitude, latitude;
+        unsigned char longitude_cardinal, latitude_cardinal;
+        struct tm tm;
+
+        if (0 != _nmea_position(_nmea_field(sentence, NMEA_GPRMC_LATITUDE),
+                                _nmea_field(sentence, NMEA_GPRMC_LATITUDE_CARDINAL),
+                                &latitude, &latitude_cardinal) ||
+            0 != _nmea_position(_nmea_field(sentence, NMEA_GPRMC_LONGITUDE),
+                                _nmea_field(sentence, NMEA_GPRMC_LONGITUDE_CARDINAL),
+                                &longitude, &longitude_cardinal)) {
+            return -1;
+        }
+
+        /* hhmmss[.ss] and ddmmyy */
+        memset(&tm, 0, sizeof(tm));
+        if (time.len >= NMEA_TIME_FORMAT_LEN) {
+            tm.tm_hour = _nmea_digits2(time.ptr);
+            tm.tm_min = _nmea_digits2(time.ptr + 2);
+            tm.tm_sec = _nmea_digits2(time.ptr + 4);
+        }
+        if (date.len >= NMEA_DATE_FORMAT_LEN) {
+            tm.tm_mday = _nmea_digits2(date.ptr);
+            tm.tm_mon = _nmea_digits2(date.ptr + 2);
+            tm.tm_year = _nmea_digits2(date.ptr + 4);
+            /* the same as strptime "%y" */
+            if (tm.tm_year < 69) {
+                tm.tm_year += 100;
+            }
+        }
+
+        gps_data->valid = (status.len > 0 && 'A' == status.ptr[0]);
+        gps_data->longitude = longitude;
+        gps_data->longitude_cardinal = longitude_cardinal;
+        gps_data->latitude = latitude;
+        gps_data->latitude_cardinal = latitude_cardinal;
+        gps_data->heading = nmea_span_to_double(_nmea_field(sentence, NMEA_GPRMC_COURSE));
+        gps_data->gps_speed = nmea_span_to_double(_nmea_field(sentence, NMEA_GPRMC_SPEED)) * KNOTS_CONVERSION_FACTOR;
+        gps_data->time = tm;
+    } break;
+
+    case NMEA_GGA:
+        gps_data->UTC = nmea_span_to_int(_nmea_field(sentence, NMEA_GPGGA_UTC));
+        gps_data->altitude = nmea_span_to_double(_nmea_field(sentence, NMEA_GPGGA_ALTITUDE));
+        gps_data->satellites_num = nmea_span_to_int(_nmea_field(sentence, NMEA_GPGGA_SATELLITES_TRACKED));
+        break;
+
+    case NMEA_GSA:
+        gps_data->navmode = nmea_span_to_int(_nmea_field(sentence, NMEA_GPGSA_NAVMODE));
+        gps_data->hdop = nmea_span_to_double(_nmea_field(sentence, NMEA_GPGSA_HDOP));
+        gps_data->pdop = nmea_span_to_double(_nmea_field(sentence, NMEA_GPGSA_PDOP));
+        break;
+
+    default:
+        break;
+    }
+    return 0;
+}
+
@@ -26,6 +26,7 @@ WHEN              WHO         WHAT, WHERE, WHY
 #include "gpio_int_demo.h"
 #include "datacall_demo.h"
 #include "osi_demo.h"
+#include "perf_bench.h"
 #include "ql_dev_demo.h"
 #include "adc_demo.h"
 #include "led_cfg_demo.h"
@@ -187,6 +188,7 @@ static void ql_init_demo_thread(void *param)
     //ql_nw_app_init();
     //ql_datacall_app_init();
 	//ql_osi_demo_init();
+	//ql_perf_bench_app_init();
 
 #ifdef QL_APP_FEATURE_FILE
 	//ql_fs_demo_init();
@@ -0,0 +1,155 @@
+/**  @file
+  lbs_cache.h
+
+  @brief
+  This file provides the client side LBS location cache.
+
+*/
+
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+
+#ifndef LBS_CACHE_H
+#define LBS_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ql_lbs_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*========================================================================
+ *  Marco Definition
+ *========================================================================*/
+
+/*
+ * Each LBS query is a data call and a server round trip. A device which
+ * doesn't move sees the same cells and Wi-Fi APs, and gets the same
+ * location. The cache keeps recent results by fingerprint:
+ * - cell keys: MCC, MNC, LAC/TAC and cell ID of each cell. cell_info[0]
+ *   is regarded as the serving cell
+ * - Wi-Fi keys: BSSIDs of the strongest LBS_CACHE_WIFI_NUM APs
+ *
+ * A query hits the cache when the serving cell is the same, and the
+ * similarity (common keys in percent of all keys of both fingerprints)
+ * reaches the configured threshold. Identical fingerprints are found
+ * by hash first. Entries expire after TTL.
+ *
+ * Settings are stored in NV file LBS_CACHE_NVM_CFG. Entries are kept
+ * in RAM only.
+ */
+
+#define LBS_CACHE_NVM_CFG             "lbs_cache_cfg.nv"
+#define LBS_CACHE_ENTRY_NUM           8     // cached locations
+#define LBS_CACHE_WIFI_NUM            3     // strongest Wi-Fi APs in fingerprint
+#define LBS_CACHE_DEFAULT_TTL         600   // seconds
+#define LBS_CACHE_DEFAULT_SIMILARITY  60    // percent
+
+/*========================================================================
+ *  Struct Definition
+ *========================================================================*/
+
+typedef struct
+{
+	bool     enable;
+	uint8_t  similarity;    // minimal similarity in percent to hit, 1-100
+	uint32_t ttl;           // entry lifetime in seconds
+} lbs_cache_cfg_s;
+
+typedef struct
+{
+	bool               hit;                      // result is from cache
+	int                pos_num;
+	lbs_postion_info_t pos_info[LBS_MAX_POS_NUM];
+} lbs_cache_result_s;
+
+/*========================================================================
+ *  function Definition
+ *========================================================================*/
+
+/*****************************************************************
+* Function: lbs_cache_init
+*
+* Description:
+* 	Initialize the cache, and load settings from NV. Default settings
+* 	are used when NV is not found.
+*
+* Return:
+* 	0 on success, -1 on fail
+*
+*****************************************************************/
+int lbs_cache_init(void);
+
+/*****************************************************************
+* Function: lbs_cache_get_cfg
+*
+* Description:
+* 	Get current settings.
+*
+*****************************************************************/
+void lbs_cache_get_cfg(lbs_cache_cfg_s *cfg);
+
+/*****************************************************************
+* Function: lbs_cache_set_cfg
+*
+* Description:
+* 	Change settings, and save them to NV. Cached entries are dropped
+* 	when the cache is disabled.
+*
+* Return:
+* 	0 on success, -1 on invalid settings or NV write fail
+*
+*****************************************************************/
+int lbs_cache_set_cfg(const lbs_cache_cfg_s *cfg);
+
+/*****************************************************************
+* Function: lbs_cache_invalidate
+*
+* Description:
+* 	Drop all cached entries.
+*
+*****************************************************************/
+void lbs_cache_invalidate(void);
+
+/*****************************************************************
+* Function: lbs_cache_get_position
+*
+* Description:
+* 	Look up the cache by the cells and Wi-Fi APs in user_opts. On hit,
+* 	cached is filled and there are no request. Otherwise, it is the
+* 	same as ql_lbs_get_position, and successful result will be added
+* 	to the cache before cb is called.
+*
+* Parameters:
+* 	host	     [in] 	server address
+*	user_opts    [in] 	LBS request options
+*   cb           [in]   LBS result callback, not called on hit
+*   cached       [out]  cached->hit and the cached result
+*   err_code     [out]  lbs_result_code_e
+*
+* Return:
+* 	LBS client handle, 0 on hit or fail
+*
+*****************************************************************/
+lbs_client_hndl lbs_cache_get_position(char *host, lbs_option_t *user_opts, ql_lbs_response_callback cb, void *arg, lbs_cache_result_s *cached, int *err_code);
+
+#ifdef __cplusplus
+} /*"C" */
+#endif
+
+#endif /* LBS_CACHE_H */
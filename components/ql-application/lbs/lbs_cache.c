@@ -0,0 +1,429 @@
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "ql_api_common.h"
+#include "ql_api_osi.h"
+#include "ql_fs.h"
+#include "ql_log.h"
+#include "osi_api.h"
+#include "lbs_cache.h"
+
+#define LBS_CACHE_LOG_LEVEL           QL_LOG_LEVEL_INFO
+#define LBS_CACHE_LOG(msg, ...)       QL_LOG(LBS_CACHE_LOG_LEVEL, "lbs_cache", msg, ##__VA_ARGS__)
+
+#define LBS_CACHE_KEY_NUM             (LBS_MAX_CELL_NUM + LBS_CACHE_WIFI_NUM)
+#define LBS_CACHE_PENDING_NUM         4     // requests waiting result
+
+typedef struct
+{
+	uint32_t hash;                          // hash of all keys, for identical match
+	uint8_t cell_num;
+	uint8_t wifi_num;
+	uint32_t keys[LBS_CACHE_KEY_NUM];       // cell keys, then Wi-Fi keys
+} lbs_cache_fp_s;
+
+typedef struct
+{
+	bool valid;
+	int64_t time;                           // uptime of the result, ms
+	int64_t used;                           // uptime of the last hit, ms
+	lbs_cache_fp_s fp;
+	int pos_num;
+	lbs_postion_info_t pos_info[LBS_MAX_POS_NUM];
+} lbs_cache_entry_s;
+
+typedef struct
+{
+	bool used;
+	lbs_client_hndl hndl;                   // 0 before ql_lbs_get_position returns
+	ql_lbs_response_callback cb;
+	lbs_cache_fp_s fp;
+} lbs_cache_pending_s;
+
+typedef struct
+{
+	ql_mutex_t lock;                        // protect entries and pending
+	ql_mutex_t start_lock;                  // serialize requests, only one pending is without handle
+	lbs_cache_cfg_s cfg;
+	lbs_cache_entry_s entries[LBS_CACHE_ENTRY_NUM];
+	lbs_cache_pending_s pending[LBS_CACHE_PENDING_NUM];
+	uint32_t hits;
+	uint32_t misses;
+} lbs_cache_ctx_s;
+
+static lbs_cache_ctx_s lbs_cache;
+
+/*========================================================================
+ *  Fingerprint
+ *========================================================================*/
+
+// FNV-1a
+static uint32_t lbs_cache_hash(uint32_t hash, const void *data, unsigned size)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	for(unsigned n = 0; n < size; n++)
+	{
+		hash ^= p[n];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static uint32_t lbs_cache_cell_key(const lbs_cell_info_t *cell)
+{
+	uint32_t id[4] = {cell->mcc, cell->mnc, (uint32_t)cell->lac_id, (uint32_t)cell->cell_id};
+	return lbs_cache_hash(2166136261u, id, sizeof(id));
+}
+
+// BSSID string in any case, with or without separators
+static uint32_t lbs_cache_wifi_key(const lbs_wifi_mac_info_t *wifi)
+{
+	uint8_t addr[6] = {0};
+	unsigned digits = 0;
+	for(unsigned n = 0; n < sizeof(wifi->wifi_mac) && wifi->wifi_mac[n] != '\0' && digits < 12; n++)
+	{
+		char c = wifi->wifi_mac[n];
+		uint8_t v;
+		if(c >= '0' && c <= '9')
+			v = c - '0';
+		else if(c >= 'a' && c <= 'f')
+			v = c - 'a' + 10;
+		else if(c >= 'A' && c <= 'F')
+			v = c - 'A' + 10;
+		else
+			continue;
+
+		addr[digits / 2] = (addr[digits / 2] << 4) | v;
+		digits++;
+	}
+	return lbs_cache_hash(2166136261u ^ 0x5a, addr, sizeof(addr));
+}
+
+static void lbs_cache_sort_keys(uint32_t *keys, unsigned num)
+{
+	for(unsigned i = 1; i < num; i++)
+	{
+		uint32_t k = keys[i];
+		unsigned j = i;
+		for(; j > 0 && keys[j - 1] > k; j--)
+			keys[j] = keys[j - 1];
+		keys[j] = k;
+	}
+}
+
+/*
+ * Serving cell key is the first. Neighbour cell keys and Wi-Fi keys are
+ * sorted, so that the hash doesn't depend on report order.
+ */
+static void lbs_cache_make_fp(const lbs_option_t *opts, lbs_cache_fp_s *fp)
+{
+	memset(fp, 0, sizeof(*fp));
+
+	int cell_num = (opts->cell_info == NULL) ? 0 : opts->cell_num;
+	if(cell_num > LBS_MAX_CELL_NUM)
+		cell_num = LBS_MAX_CELL_NUM;
+	for(int n = 0; n < cell_num; n++)
+		fp->keys[fp->cell_num++] = lbs_cache_cell_key(&opts->cell_info[n]);
+	if(fp->cell_num > 1)
+		lbs_cache_sort_keys(&fp->keys[1], fp->cell_num - 1);
+
+	// pick the strongest APs
+	int wifi_num = (opts->wifi_info == NULL) ? 0 : opts->wifi_num;
+	bool picked[LBS_MAX_WIFI_NUM] = {false};
+	if(wifi_num > LBS_MAX_WIFI_NUM)
+		wifi_num = LBS_MAX_WIFI_NUM;
+	while(fp->wifi_num < LBS_CACHE_WIFI_NUM)
+	{
+		int best = -1;
+		for(int n = 0; n < wifi_num; n++)
+		{
+			if(!picked[n] && (best < 0 || opts->wifi_info[n].wifi_rssi > opts->wifi_info[best].wifi_rssi))
+				best = n;
+		}
+		if(best < 0)
+			break;
+
+		picked[best] = true;
+		fp->keys[fp->cell_num + fp->wifi_num++] = lbs_cache_wifi_key(&opts->wifi_info[best]);
+	}
+	lbs_cache_sort_keys(&fp->keys[fp->cell_num], fp->wifi_num);
+
+	fp->hash = lbs_cache_hash(2166136261u, fp->keys, (fp->cell_num + fp->wifi_num) * sizeof(uint32_t));
+}
+
+static bool lbs_cache_fp_equal(const lbs_cache_fp_s *a, const lbs_cache_fp_s *b)
+{
+	return a->hash == b->hash && a->cell_num == b->cell_num && a->wifi_num == b->wifi_num &&
+		memcmp(a->keys, b->keys, (a->cell_num + a->wifi_num) * sizeof(uint32_t)) == 0;
+}
+
+static unsigned lbs_cache_common(const uint32_t *a, unsigned an, const uint32_t *b, unsigned bn)
+{
+	unsigned common = 0;
+	for(unsigned i = 0; i < an; i++)
+	{
+		for(unsigned j = 0; j < bn; j++)
+		{
+			if(a[i] == b[j]){
+				common++;
+				break;
+			}
+		}
+	}
+	return common;
+}
+
+// common keys in percent of all keys, 0 when serving cells are different
+static unsigned lbs_cache_similarity(const lbs_cache_fp_s *a, const lbs_cache_fp_s *b)
+{
+	if(a->cell_num != 0 && b->cell_num != 0 && a->keys[0] != b->keys[0])
+		return 0;
+	if((a->cell_num == 0) != (b->cell_num == 0))
+		return 0;
+
+	unsigned common = lbs_cache_common(a->keys, a->cell_num, b->keys, b->cell_num) +
+		lbs_cache_common(&a->keys[a->cell_num], a->wifi_num, &b->keys[b->cell_num], b->wifi_num);
+	unsigned all = a->cell_num + a->wifi_num + b->cell_num + b->wifi_num - common;
+	return (all == 0) ? 0 : common * 100 / all;
+}
+
+/*========================================================================
+ *  Entries, called with lock
+ *========================================================================*/
+
+static bool lbs_cache_expired(const lbs_cache_entry_s *e, int64_t now)
+{
+	return now - e->time >= (int64_t)lbs_cache.cfg.ttl * 1000;
+}
+
+static lbs_cache_entry_s *lbs_cache_lookup(const lbs_cache_fp_s *fp, int64_t now)
+{
+	lbs_cache_entry_s *best = NULL;
+	unsigned best_sim = 0;
+	for(unsigned n = 0; n < LBS_CACHE_ENTRY_NUM; n++)
+	{
+		lbs_cache_entry_s *e = &lbs_cache.entries[n];
+		if(!e->valid)
+			continue;
+		if(lbs_cache_expired(e, now)){
+			e->valid = false;
+			continue;
+		}
+
+		if(lbs_cache_fp_equal(&e->fp, fp))
+			return e;
+
+		unsigned sim = lbs_cache_similarity(&e->fp, fp);
+		if(sim >= lbs_cache.cfg.similarity && sim > best_sim){
+			best = e;
+			best_sim = sim;
+		}
+	}
+	return best;
+}
+
+static void lbs_cache_store(const lbs_cache_fp_s *fp, int pos_num, const lbs_postion_info_t *pos_info, int64_t now)
+{
+	lbs_cache_entry_s *slot = NULL;
+	for(unsigned n = 0; n < LBS_CACHE_ENTRY_NUM; n++)
+	{
+		lbs_cache_entry_s *e = &lbs_cache.entries[n];
+		if(e->valid && lbs_cache_fp_equal(&e->fp, fp)){
+			slot = e;
+			break;
+		}
+		// replace the least recently used one
+		if(slot == NULL || (slot->valid && (!e->valid || e->used < slot->used)))
+			slot = e;
+	}
+
+	if(pos_num > LBS_MAX_POS_NUM)
+		pos_num = LBS_MAX_POS_NUM;
+	slot->valid = true;
+	slot->time = now;
+	slot->used = now;
+	slot->fp = *fp;
+	slot->pos_num = pos_num;
+	memcpy(slot->pos_info, pos_info, pos_num * sizeof(lbs_postion_info_t));
+}
+
+static lbs_cache_pending_s *lbs_cache_find_pending(lbs_client_hndl hndl)
+{
+	for(unsigned n = 0; n < LBS_CACHE_PENDING_NUM; n++)
+	{
+		if(lbs_cache.pending[n].used && lbs_cache.pending[n].hndl == hndl)
+			return &lbs_cache.pending[n];
+	}
+	return NULL;
+}
+
+/*========================================================================
+ *  Request
+ *========================================================================*/
+
+static void lbs_cache_response_cb(lbs_client_hndl hndl, int result, int pos_num, lbs_postion_info_t *pos_info, char *date)
+{
+	ql_lbs_response_callback cb = NULL;
+
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	// result may come before ql_lbs_get_position returns the handle
+	lbs_cache_pending_s *p = lbs_cache_find_pending(hndl);
+	if(p == NULL)
+		p = lbs_cache_find_pending(0);
+	if(p != NULL){
+		cb = p->cb;
+		if(result == LBS_RES_OK && pos_num > 0 && pos_info != NULL && lbs_cache.cfg.enable)
+			lbs_cache_store(&p->fp, pos_num, pos_info, osiUpTime());
+		p->used = false;
+	}
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+
+	if(cb != NULL)
+		cb(hndl, result, pos_num, pos_info, date);
+}
+
+/*========================================================================
+ *  API
+ *========================================================================*/
+
+int lbs_cache_init(void)
+{
+	if(lbs_cache.lock == NULL){
+		if(ql_rtos_mutex_create(&lbs_cache.lock) != QL_OSI_SUCCESS)
+			return -1;
+		if(ql_rtos_mutex_create(&lbs_cache.start_lock) != QL_OSI_SUCCESS)
+			return -1;
+	}
+
+	lbs_cache_cfg_s cfg;
+	if(ql_nvm_fread(LBS_CACHE_NVM_CFG, &cfg, sizeof(cfg), 1) != sizeof(cfg) ||
+		cfg.similarity == 0 || cfg.similarity > 100 || cfg.ttl == 0){
+		cfg.enable = true;
+		cfg.similarity = LBS_CACHE_DEFAULT_SIMILARITY;
+		cfg.ttl = LBS_CACHE_DEFAULT_TTL;
+	}
+
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	lbs_cache.cfg = cfg;
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+	LBS_CACHE_LOG("lbs cache: enable %d, similarity %d, ttl %u", cfg.enable, cfg.similarity, cfg.ttl);
+	return 0;
+}
+
+void lbs_cache_get_cfg(lbs_cache_cfg_s *cfg)
+{
+	if(cfg == NULL || lbs_cache.lock == NULL)
+		return;
+
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	*cfg = lbs_cache.cfg;
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+}
+
+int lbs_cache_set_cfg(const lbs_cache_cfg_s *cfg)
+{
+	if(cfg == NULL || lbs_cache.lock == NULL)
+		return -1;
+	if(cfg->similarity == 0 || cfg->similarity > 100 || cfg->ttl == 0)
+		return -1;
+
+	lbs_cache_cfg_s saved = *cfg;
+	if(ql_nvm_fwrite(LBS_CACHE_NVM_CFG, &saved, sizeof(saved), 1) != sizeof(saved))
+		return -1;
+
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	lbs_cache.cfg = saved;
+	if(!saved.enable)
+		memset(lbs_cache.entries, 0, sizeof(lbs_cache.entries));
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+	return 0;
+}
+
+void lbs_cache_invalidate(void)
+{
+	if(lbs_cache.lock == NULL)
+		return;
+
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	memset(lbs_cache.entries, 0, sizeof(lbs_cache.entries));
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+}
+
+lbs_client_hndl lbs_cache_get_position(char *host, lbs_option_t *user_opts, ql_lbs_response_callback cb, void *arg, lbs_cache_result_s *cached, int *err_code)
+{
+	if(cached == NULL || user_opts == NULL || lbs_cache.lock == NULL){
+		if(err_code != NULL)
+			*err_code = LBS_RES_PARAM_FORMAT_FAIL;
+		return 0;
+	}
+
+	lbs_cache_fp_s fp;
+	lbs_cache_make_fp(user_opts, &fp);
+	memset(cached, 0, sizeof(*cached));
+
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	int64_t now = osiUpTime();
+	lbs_cache_entry_s *e = lbs_cache.cfg.enable ? lbs_cache_lookup(&fp, now) : NULL;
+	if(e != NULL){
+		e->used = now;
+		cached->hit = true;
+		cached->pos_num = e->pos_num;
+		memcpy(cached->pos_info, e->pos_info, e->pos_num * sizeof(lbs_postion_info_t));
+		lbs_cache.hits++;
+		LBS_CACHE_LOG("lbs cache: hit %08x, age %d s, %u/%u", fp.hash, (int)((now - e->time) / 1000),
+			lbs_cache.hits, lbs_cache.hits + lbs_cache.misses);
+		ql_rtos_mutex_unlock(lbs_cache.lock);
+		if(err_code != NULL)
+			*err_code = LBS_RES_OK;
+		return 0;
+	}
+	lbs_cache.misses++;
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+
+	ql_rtos_mutex_lock(lbs_cache.start_lock, QL_WAIT_FOREVER);
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	lbs_cache_pending_s *p = NULL;
+	for(unsigned n = 0; p == NULL && n < LBS_CACHE_PENDING_NUM; n++)
+	{
+		if(!lbs_cache.pending[n].used)
+			p = &lbs_cache.pending[n];
+	}
+	if(p != NULL){
+		p->used = true;
+		p->hndl = 0;
+		p->cb = cb;
+		p->fp = fp;
+	}
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+
+	// when there are too many pending requests, the result isn't cached
+	lbs_client_hndl hndl = ql_lbs_get_position(host, user_opts, (p != NULL) ? lbs_cache_response_cb : cb, arg, err_code);
+
+	ql_rtos_mutex_lock(lbs_cache.lock, QL_WAIT_FOREVER);
+	// p may be released already in callback
+	if(p != NULL && p->used && p->hndl == 0){
+		if(hndl != 0)
+			p->hndl = hndl;
+		else
+			p->used = false;
+	}
+	ql_rtos_mutex_unlock(lbs_cache.lock);
+	ql_rtos_mutex_unlock(lbs_cache.start_lock);
+	return hndl;
+}
@@ -28,6 +28,7 @@ WHEN              WHO         WHAT, WHERE, WHY
 #include "ql_log.h"
 #include "ql_api_datacall.h"
 #include "ql_lbs_client.h"
+#include "lbs_cache.h"
 
 #define QL_LBS_LOG_LEVEL	            QL_LOG_LEVEL_INFO
 #define QL_LBS_LOG(msg, ...)			QL_LOG(QL_LBS_LOG_LEVEL, "ql_LBS_DEMO", msg, ##__VA_ARGS__)
@@ -105,6 +106,7 @@ static void lbs_app_thread(void * arg)
 	QL_LBS_LOG("wait for network register done");
 
 	ql_rtos_semaphore_create(&lbs_semp, 0);
+	lbs_cache_init();
 	while((ret = ql_network_register_wait(nSim, 120)) != 0 && i < 10){
     	i++;
 		ql_rtos_task_sleep_s(1);
@@ -148,6 +150,7 @@ static void lbs_app_thread(void * arg)
 	
 	while(run_num <= 100){
 		lbs_option_t  user_option;
+		lbs_cache_result_s cached;
 		int error_num = 0;
 		QL_LBS_LOG("==============lbs_test[%d]================\n",run_num);
 
@@ -204,9 +207,13 @@ static void lbs_app_thread(void * arg)
 		user_option.cell_num = 1;
 		user_option.cell_info = &lbs_cell_info[0];
 
-		lbs_cli = ql_lbs_get_position("www.queclocator.com", &user_option, lbs_result_cb, NULL, &error_num);
+		lbs_cli = lbs_cache_get_position("www.queclocator.com", &user_option, lbs_result_cb, NULL, &cached, &error_num);
 		
-		if(lbs_cli != 0){
+		if(cached.hit){
+			for(i = 0; i < cached.pos_num; i++){
+				QL_LBS_LOG("Cached location[%d]: %f, %f, %d\n", i, cached.pos_info[i].longitude, cached.pos_info[i].latitude, cached.pos_info[i].accuracy);
+			}
+		}else if(lbs_cli != 0){
 			ql_rtos_semaphore_wait(lbs_semp, QL_WAIT_FOREVER);
 		}else{
 			QL_LBS_LOG("lbs failed");
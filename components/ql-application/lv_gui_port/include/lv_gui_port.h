@@ -0,0 +1,364 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+
+#ifndef _LV_GUI_PORT_H_
+#define _LV_GUI_PORT_H_
+
+#include "osi_api.h"
+#include "drv_lcd_v2.h"
+
+OSI_EXTERN_C_BEGIN
+
+/**
+ * \brief littlevgl version neutral port
+ *
+ * It is shared by littlevgl 6 (lvgl_lib) and littlevgl 7 (lvgl7_lib),
+ * and littlevgl headers aren't included. It owns:
+ * - gui thread, and task timer started at the next task deadline
+ * - display buffers, and LCD flush with application layers
+ * - keypad event FIFO filled in ISR
+ * - screen power, back light, and inactive screen off
+ *
+ * lv_gui_main.c of each version is an adapter, registering littlevgl
+ * display and input drivers on top of this. Pixels are RGB565, which is
+ * \p LV_COLOR_DEPTH of both versions.
+ *
+ * Unless noted, APIs should be called in gui thread.
+ */
+
+/** overlays available to application, the top most one is littlevgl */
+#define LV_GUI_PORT_OVERLAY_COUNT (DRV_LCD_OVERLAY_COUNT - 1)
+
+/** task handler return value, when there are no tasks to be run */
+#define LV_GUI_PORT_NO_TASK (0xffffffff)
+
+/** value in key map for keys not mapped */
+#define LV_GUI_PORT_KEY_NONE (0xff)
+
+/**
+ * \brief adapter callbacks, called in gui thread
+ */
+typedef struct
+{
+    /** initialize littlevgl and devices, and create gui */
+    void (*init)(void *param);
+    /** run littlevgl task handler, return ms to the next run */
+    uint32_t (*run)(void *param);
+    /** whether animating or refreshing, and frames should be in time */
+    bool (*busy)(void *param);
+    /** whether animating, for \p lvGuiPortSetAnimationInactive */
+    bool (*animating)(void *param);
+    /** ms since the last user activity */
+    uint32_t (*inactive_time)(void *param);
+    /** turn off screen at inactive timeout */
+    void (*screen_off)(void *param);
+    /** parameter of callbacks */
+    void *param;
+} lvGuiPortOps_t;
+
+/**
+ * \brief display buffers and panel information
+ */
+typedef struct
+{
+    uint16_t width;    ///< panel width
+    uint16_t height;   ///< panel height
+    uint16_t lines;    ///< lines of each display buffer
+    bool vsync;        ///< flush synced to LCD FMARK
+    uint32_t frame_us; ///< panel frame period
+    uint16_t *buf1;    ///< display buffer
+    uint16_t *buf2;    ///< the second display buffer, NULL for single buffer
+} lvGuiPortDisp_t;
+
+/**
+ * \brief function prototype of flush done
+ *
+ * It is called in ISR for asynchronous flush, otherwise inside
+ * \p lvGuiPortDispFlush.
+ */
+typedef void (*lvGuiPortFlushDone_t)(void *param);
+
+/**
+ * \brief key event read by \p lvGuiPortKeypadRead
+ */
+typedef struct
+{
+    uint8_t key;  ///< mapped key, LV_GUI_PORT_KEY_NONE for not mapped
+    bool pressed; ///< pressed or released
+} lvGuiPortKey_t;
+
+/**
+ * \brief port statistics
+ *
+ * Time are in microseconds, and accumulated since the last reset.
+ */
+typedef struct
+{
+    uint32_t flush_count;        ///< count of flush to LCD
+    uint32_t flush_bytes;        ///< bytes of littlevgl layer flushed to LCD
+    uint32_t wait_us;            ///< time blocked in waiting GOUDA
+    uint32_t key_count;          ///< count of key events read
+    uint32_t key_latency_us;     ///< time from keypad ISR to read
+    uint32_t key_latency_max_us; ///< maximum time from keypad ISR to read
+    uint32_t key_dropped;        ///< count of key events dropped on full FIFO
+} lvGuiPortStat_t;
+
+/**
+ * \brief start gui thread
+ *
+ * \p ops->init is called in gui thread, and then task timer is started.
+ * \p ops should be kept valid.
+ *
+ * It can be called in any thread.
+ *
+ * \param ops       adapter callbacks
+ * \return
+ *      - true on success
+ *      - false on invalid parameter or out of memory
+ */
+bool lvGuiPortStart(const lvGuiPortOps_t *ops);
+
+/**
+ * \brief get gui thread
+ *
+ * It can be called in any thread.
+ *
+ * \return
+ *      - gui thread
+ */
+osiThread_t *lvGuiPortThread(void);
+
+/**
+ * \brief suspend or resume littlevgl task handler
+ *
+ * When suspended, task timer is stopped, and task handler isn't executed
+ * after events. It is for always-on display, when littlevgl isn't
+ * running. At resume, task handler will be executed soon.
+ *
+ * \param suspend   true to suspend, false to resume
+ */
+void lvGuiPortSuspend(bool suspend);
+
+/**
+ * \brief open LCD, and allocate display buffers
+ *
+ * Buffer lines are \p CONFIG_LV_GUI_DISP_BUF_LINES, and two buffers are
+ * allocated with \p CONFIG_LV_GUI_DISP_DOUBLE_BUF. In vsync mode, single
+ * full screen buffer is used for one transfer per frame.
+ *
+ * \param key_color     RGB565 of littlevgl transparent color
+ * \param disp          output display information
+ * \return
+ *      - true on success
+ *      - false on LCD or memory failure
+ */
+bool lvGuiPortDispInit(uint16_t key_color, lvGuiPortDisp_t *disp);
+
+/**
+ * \brief get LCD instance
+ *
+ * \return
+ *      - LCD instance, NULL before \p lvGuiPortDispInit
+ */
+drvLcd_t *lvGuiPortLcd(void);
+
+/**
+ * \brief flush littlevgl layer to LCD
+ *
+ * Application overlays and video layer are blended under littlevgl
+ * layer. In vsync mode or with double buffers, flush is asynchronous and
+ * the other buffer can be rendered during transfer. When screen is off,
+ * it is dropped and \p done is called immediately.
+ *
+ * \param roi       screen area
+ * \param buf       RGB565 pixels of \p roi, stride is width of \p roi
+ * \param done      flush done callback
+ * \param param     parameter of \p done
+ */
+void lvGuiPortDispFlush(const drvLcdArea_t *roi, const void *buf, lvGuiPortFlushDone_t done, void *param);
+
+/**
+ * \brief write pixels to LCD synchronously, without other layers
+ *
+ * It doesn't check screen state, and it is for always-on display.
+ *
+ * \param roi       screen area
+ * \param buf       RGB565 pixels of \p roi, stride is width of \p roi
+ * \return
+ *      - true on success
+ *      - false on fail
+ */
+bool lvGuiPortDispWrite(const drvLcdArea_t *roi, const void *buf);
+
+/**
+ * \brief wait the last asynchronous flush done
+ */
+void lvGuiPortDispWaitDone(void);
+
+/**
+ * \brief get application overlay
+ *
+ * \param n         overlay index, [0, LV_GUI_PORT_OVERLAY_COUNT)
+ * \return
+ *      - overlay configuration, NULL on invalid parameter
+ */
+const drvLcdOverlay_t *lvGuiPortGetOverlay(unsigned n);
+
+/**
+ * \brief set application overlay
+ *
+ * It only changes the configuration used in later flushes, and the
+ * caller should invalidate the areas.
+ *
+ * \param n         overlay index, [0, LV_GUI_PORT_OVERLAY_COUNT)
+ * \param ovl       overlay configuration, NULL to disable
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool lvGuiPortSetOverlay(unsigned n, const drvLcdOverlay_t *ovl);
+
+/**
+ * \brief get application video layer
+ *
+ * \return
+ *      - video layer configuration
+ */
+const drvLcdVideoLayer_t *lvGuiPortGetVideoLayer(void);
+
+/**
+ * \brief set application video layer
+ *
+ * \param vl        video layer configuration, NULL to disable
+ */
+void lvGuiPortSetVideoLayer(const drvLcdVideoLayer_t *vl);
+
+/**
+ * \brief start keypad, key events will be queued in FIFO
+ *
+ * \p notify is called in gui thread, when FIFO changed from empty to non
+ * empty. Then littlevgl keypad read task should be resumed, and read till
+ * FIFO empty.
+ *
+ * \param keymap    littlevgl key of each keyMap_t, 0 for not mapped
+ * \param notify    callback when there are key events
+ * \param param     parameter of \p notify
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool lvGuiPortKeypadInit(const uint8_t *keymap, osiCallback_t notify, void *param);
+
+/**
+ * \brief read one key event from FIFO
+ *
+ * Without new event, \p key is filled with the last key. Then littlevgl
+ * can detect long press and repeat on it.
+ *
+ * \param key       output key event
+ * \return
+ *      - true if a new event is read
+ *      - false if FIFO is empty
+ */
+bool lvGuiPortKeypadRead(lvGuiPortKey_t *key);
+
+/**
+ * \brief whether there are key events in FIFO
+ *
+ * \return
+ *      - true if there are key events in FIFO
+ */
+bool lvGuiPortKeypadPending(void);
+
+/**
+ * \brief whether screen is on
+ *
+ * \return
+ *      - true if screen is on
+ */
+bool lvGuiPortScreenIsOn(void);
+
+/**
+ * \brief mark screen on, and wakeup LCD
+ *
+ * Back light isn't turned on, and it should be turned on by
+ * \p lvGuiPortBackLightOn after the screen is redrawn.
+ *
+ * \param wakeup    whether to wakeup LCD from sleep
+ */
+void lvGuiPortScreenOn(bool wakeup);
+
+/**
+ * \brief mark screen off, flush will be dropped
+ *
+ * \param sleep     whether to turn off back light and enter LCD sleep
+ */
+void lvGuiPortScreenOff(bool sleep);
+
+/**
+ * \brief turn on back light with fade in
+ */
+void lvGuiPortBackLightOn(void);
+
+/**
+ * \brief request screen on, refer to \p lvGuiRequestSceenOn
+ *
+ * \param id        application id, [0, 31]
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool lvGuiPortRequestScreenOn(uint8_t id);
+
+/**
+ * \brief release screen on request
+ *
+ * \param id        application id, [0, 31]
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool lvGuiPortReleaseScreenOn(uint8_t id);
+
+/**
+ * \brief set screen off timeout at inactive, 0 for never timeout
+ *
+ * \param timeout   inactive screen off timeout
+ */
+void lvGuiPortSetInactiveTimeout(unsigned timeout);
+
+/**
+ * \brief set whether animation is regarded as inactive
+ *
+ * \param inactive  animation will be regarded as inactive
+ */
+void lvGuiPortSetAnimationInactive(bool inactive);
+
+/**
+ * \brief get port statistics
+ *
+ * It can be called in any thread.
+ *
+ * \param stat      output statistics
+ */
+void lvGuiPortGetStat(lvGuiPortStat_t *stat);
+
+/**
+ * \brief reset port statistics
+ *
+ * It can be called in any thread.
+ */
+void lvGuiPortResetStat(void);
+
+OSI_EXTERN_C_END
+#endif
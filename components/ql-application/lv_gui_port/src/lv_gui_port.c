@@ -0,0 +1,560 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "lv_gui_port.h"
+#include "lv_gui_config.h"
+#include "drv_backlight.h"
+#include "drv_names.h"
+#include "drv_keypad.h"
+#include "osi_log.h"
+#include <string.h>
+#include <stdlib.h>
+
+// depth of key event FIFO, power of 2
+#define LV_GUI_KEY_FIFO_DEPTH (16)
+
+// backlight level and fade in time at screen on
+#define LV_GUI_BACKLIGHT_LEVEL (128)
+#define LV_GUI_BACKLIGHT_FADE_MS (200)
+
+typedef struct
+{
+    uint8_t key;    // keyMap_t
+    uint8_t state;  // keyState_t
+    uint32_t up_us; // up time in ISR
+} lvGuiKeyEvent_t;
+
+typedef struct
+{
+    bool screen_on;            // state of screen on
+    bool anim_inactive;        // property of whether animation is regarded as inactive
+    bool suspended;            // task handler suspended
+    bool vsync;                // flush synced to LCD FMARK
+    bool async;                // flush is asynchronous
+    uint16_t key_color;        // littlevgl transparent color
+    const lvGuiPortOps_t *ops; // adapter callbacks
+    drvLcd_t *lcd;             // LCD instance
+    osiThread_t *thread;       // gui thread
+    osiTimer_t *task_timer;    // timer to trigger task handler
+    drvLcdVideoLayer_t vl;     // extern video layer
+    drvLcdOverlay_t ovl[LV_GUI_PORT_OVERLAY_COUNT]; // extern overlays
+    const uint8_t *keymap;     // littlevgl key of keyMap_t
+    osiCallback_t key_notify;  // callback when FIFO becomes non empty
+    void *key_notify_param;    // parameter of key_notify
+    uint8_t last_key;          // last key read
+    keyState_t last_key_state; // last key state read
+    volatile uint32_t key_head; // key FIFO write count, only changed in ISR
+    volatile uint32_t key_tail; // key FIFO read count, only changed in gui thread
+    lvGuiKeyEvent_t key_fifo[LV_GUI_KEY_FIFO_DEPTH]; // key events from ISR
+    uint32_t screen_on_users;  // screen on user bitmap
+    uint32_t inactive_timeout; // property of inactive timeout
+    lvGuiPortStat_t stat;      // statistics
+    uint32_t stat_wait_base;   // GOUDA waiting time at statistics reset
+} lvGuiPortContext_t;
+
+static lvGuiPortContext_t gLvGuiPortCtx;
+
+/**
+ * ms to inactive timeout, LV_GUI_PORT_NO_TASK for not applicable
+ */
+static uint32_t prvInactiveRemain(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (d->screen_on_users != 0 || d->inactive_timeout == 0)
+        return LV_GUI_PORT_NO_TASK;
+    if (!d->anim_inactive && d->ops->animating(d->ops->param))
+        return LV_GUI_PORT_NO_TASK;
+
+    uint32_t inactive = d->ops->inactive_time(d->ops->param);
+    return (inactive > d->inactive_timeout) ? 0 : d->inactive_timeout - inactive;
+}
+
+/**
+ * run littlevgl task handler, and start task timer at the next deadline
+ *
+ * It is executed after each event of gui thread. Task timer is only
+ * started for the next task deadline, or inactive timeout.
+ */
+static void prvRunTasks(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    uint32_t next_run = d->ops->run(d->ops->param);
+
+    // inactive timeout is checked after each event, wakeup for it
+    if (d->screen_on)
+    {
+        uint32_t remain = prvInactiveRemain();
+        if (remain != LV_GUI_PORT_NO_TASK)
+            next_run = OSI_MIN(uint32_t, next_run, remain + 1);
+    }
+
+    if (next_run == LV_GUI_PORT_NO_TASK)
+    {
+        osiTimerStop(d->task_timer);
+        return;
+    }
+
+    // Frames should be in time when animating or refreshing, and don't
+    // wakeup system only for gui when screen is off.
+    uint32_t relaxed_ms = CONFIG_LV_GUI_TASK_RELAXED_MS;
+    if (!d->screen_on)
+        relaxed_ms = OSI_DELAY_MAX;
+    else if (d->ops->busy(d->ops->param))
+        relaxed_ms = 0;
+
+    osiTimerStartRelaxed(d->task_timer, next_run, relaxed_ms);
+}
+
+/**
+ * task timer callback, just to wakeup gui thread
+ */
+static void prvTaskTimeout(void *param)
+{
+}
+
+/**
+ * gui thread entry
+ */
+static void prvThreadEntry(void *param)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    d->thread = osiThreadCurrent();
+    d->task_timer = osiTimerCreate(d->thread, prvTaskTimeout, NULL);
+
+    d->ops->init(d->ops->param);
+
+    osiTimerStart(d->task_timer, 0);
+    for (;;)
+    {
+        osiEvent_t event;
+        event.id = OSI_EVENT_ID_NONE;
+
+        osiEventWait(d->thread, &event);
+        if (event.id == OSI_EVENT_ID_QUIT)
+            break;
+
+        if (d->screen_on && prvInactiveRemain() == 0)
+        {
+            OSI_LOGI(0, "inactive timeout, screen off");
+            d->ops->screen_off(d->ops->param);
+        }
+
+        if (d->suspended)
+            continue;
+
+        prvRunTasks();
+    }
+
+    osiThreadExit();
+}
+
+bool lvGuiPortStart(const lvGuiPortOps_t *ops)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (ops == NULL || ops->init == NULL || ops->run == NULL ||
+        ops->busy == NULL || ops->animating == NULL ||
+        ops->inactive_time == NULL || ops->screen_off == NULL)
+        return false;
+
+    d->ops = ops;
+    d->screen_on = true;
+    d->anim_inactive = false;
+    d->suspended = false;
+    d->last_key = LV_GUI_PORT_KEY_NONE;
+    d->last_key_state = KEY_STATE_RELEASE;
+    d->key_head = 0;
+    d->key_tail = 0;
+    d->screen_on_users = 0;
+    d->inactive_timeout = CONFIG_LV_GUI_SCREEN_OFF_TIMEOUT;
+    lvGuiPortResetStat();
+
+    d->thread = osiThreadCreate("lvgl", prvThreadEntry, NULL,
+                                OSI_PRIORITY_NORMAL,
+                                CONFIG_LV_GUI_THREAD_STACK_SIZE,
+                                CONFIG_LV_GUI_THREAD_EVENT_COUNT);
+    return d->thread != NULL;
+}
+
+osiThread_t *lvGuiPortThread(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    return d->thread;
+}
+
+void lvGuiPortSuspend(bool suspend)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    d->suspended = suspend;
+    if (suspend)
+        osiTimerStop(d->task_timer);
+    else
+        osiTimerStart(d->task_timer, 0);
+}
+
+bool lvGuiPortDispInit(uint16_t key_color, lvGuiPortDisp_t *disp)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    d->lcd = drvLcdGetByname(DRV_NAME_LCD1);
+    if (d->lcd == NULL)
+        return false;
+
+    if (!drvLcdOpenV2(d->lcd))
+        return false;
+
+    drvLcdSetDirection(d->lcd, DRV_LCD_DIR_NORMAL);
+
+    drvLcdPanelInfo_t panel_info;
+    if (!drvLcdGetPanelInfo(d->lcd, &panel_info))
+        return false;
+
+    // In vsync mode, the display buffer should hold the whole screen for
+    // one transfer per frame.
+    unsigned lines = CONFIG_LV_GUI_DISP_BUF_LINES;
+    d->vsync = panel_info.fmark_enabled;
+    if (d->vsync || lines == 0 || lines > panel_info.height)
+        lines = panel_info.height;
+
+    unsigned size = panel_info.width * lines * sizeof(uint16_t);
+    uint16_t *buf1 = (uint16_t *)malloc(size);
+    if (buf1 == NULL)
+        return false;
+
+    uint16_t *buf2 = NULL;
+#ifdef CONFIG_LV_GUI_DISP_DOUBLE_BUF
+    // Two screen size buffers will make littlevgl busy wait transfer done.
+    // And it is not needed in vsync mode, refresh starts after transfer.
+    if (!d->vsync)
+    {
+        buf2 = (uint16_t *)malloc(size);
+        if (buf2 == NULL)
+        {
+            free(buf1);
+            return false;
+        }
+    }
+    d->async = true;
+#else
+    d->async = d->vsync;
+#endif
+
+    d->key_color = key_color;
+    disp->width = panel_info.width;
+    disp->height = panel_info.height;
+    disp->lines = lines;
+    disp->vsync = d->vsync;
+    disp->frame_us = panel_info.frame_us;
+    disp->buf1 = buf1;
+    disp->buf2 = buf2;
+
+    OSI_LOGI(0, "lvgl display buffer lines %d, vsync %d", lines, d->vsync);
+    return true;
+}
+
+drvLcd_t *lvGuiPortLcd(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    return d->lcd;
+}
+
+void lvGuiPortDispFlush(const drvLcdArea_t *roi, const void *buf, lvGuiPortFlushDone_t done, void *param)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (!d->screen_on)
+    {
+        done(param);
+        return;
+    }
+
+    d->stat.flush_count++;
+    d->stat.flush_bytes += roi->w * roi->h * sizeof(uint16_t);
+
+    drvLcdLayers_t layers = {
+        .vl = &d->vl,
+        .layer_roi = *roi,
+        .screen_roi = *roi,
+    };
+
+    // transparent color takes effect only when there are layers under
+    bool key_en = d->vl.enabled;
+    for (unsigned n = 0; n < LV_GUI_PORT_OVERLAY_COUNT; n++)
+    {
+        layers.ovl[n] = &d->ovl[n];
+        key_en = key_en || d->ovl[n].enabled;
+    }
+
+    drvLcdOverlay_t ovl = {
+        .buf = (void *)buf,
+        .enabled = true,
+        .in_fmt = DRV_LCD_IN_FMT_RGB565,
+        .alpha = 255,
+        .key_en = key_en,
+        .key_color = d->key_color,
+        .stride = roi->w,
+        .out = *roi,
+    };
+    layers.ovl[LV_GUI_PORT_OVERLAY_COUNT] = &ovl;
+
+    if (d->async)
+    {
+        // Flush done will be notified in GOUDA ISR. The other buffer can
+        // be rendered during data transfer, and gui thread won't be
+        // blocked till FMARK in vsync mode.
+        if (!drvLcdFlushAsync(d->lcd, &layers, done, param))
+            done(param);
+        return;
+    }
+
+    drvLcdFlush(d->lcd, &layers, true);
+    done(param);
+}
+
+bool lvGuiPortDispWrite(const drvLcdArea_t *roi, const void *buf)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    drvLcdOverlay_t ovl = {
+        .buf = (void *)buf,
+        .enabled = true,
+        .in_fmt = DRV_LCD_IN_FMT_RGB565,
+        .alpha = 255,
+        .stride = roi->w,
+        .out = *roi,
+    };
+    drvLcdLayers_t layers = {
+        .layer_roi = *roi,
+        .screen_roi = *roi,
+    };
+    layers.ovl[LV_GUI_PORT_OVERLAY_COUNT] = &ovl;
+
+    return drvLcdFlush(d->lcd, &layers, true);
+}
+
+void lvGuiPortDispWaitDone(void)
+{
+    drvLcdWaitTransferDone();
+}
+
+const drvLcdOverlay_t *lvGuiPortGetOverlay(unsigned n)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (n >= LV_GUI_PORT_OVERLAY_COUNT)
+        return NULL;
+    return &d->ovl[n];
+}
+
+bool lvGuiPortSetOverlay(unsigned n, const drvLcdOverlay_t *ovl)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (n >= LV_GUI_PORT_OVERLAY_COUNT)
+        return false;
+
+    if (ovl == NULL)
+        memset(&d->ovl[n], 0, sizeof(drvLcdOverlay_t));
+    else
+        d->ovl[n] = *ovl;
+    return true;
+}
+
+const drvLcdVideoLayer_t *lvGuiPortGetVideoLayer(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    return &d->vl;
+}
+
+void lvGuiPortSetVideoLayer(const drvLcdVideoLayer_t *vl)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (vl == NULL)
+        memset(&d->vl, 0, sizeof(drvLcdVideoLayer_t));
+    else
+        d->vl = *vl;
+}
+
+/**
+ * callback of keypad driver, called in ISR
+ *
+ * Key events are queued in a single producer (ISR) and single consumer
+ * (gui thread) FIFO, so fast key sequences are not coalesced. Gui thread
+ * is notified only when the FIFO was empty, the read task will drain it.
+ */
+static void prvKeypadCallback(keyMap_t key, keyState_t evt, void *p)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    uint32_t head = d->key_head;
+    uint32_t tail = d->key_tail;
+    if (head - tail >= LV_GUI_KEY_FIFO_DEPTH)
+    {
+        d->stat.key_dropped++;
+        return;
+    }
+
+    lvGuiKeyEvent_t *e = &d->key_fifo[head % LV_GUI_KEY_FIFO_DEPTH];
+    e->key = key;
+    e->state = evt;
+    e->up_us = (uint32_t)osiUpTimeUS();
+    OSI_BARRIER();
+    d->key_head = head + 1;
+
+    if (head == tail)
+        osiThreadCallback(d->thread, d->key_notify, d->key_notify_param);
+}
+
+bool lvGuiPortKeypadInit(const uint8_t *keymap, osiCallback_t notify, void *param)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (keymap == NULL || notify == NULL)
+        return false;
+
+    d->keymap = keymap;
+    d->key_notify = notify;
+    d->key_notify_param = param;
+
+    drvKeypadInit(); // permit multiple calls
+    drvKeypadSetCB(prvKeypadCallback, KEY_STATE_PRESS | KEY_STATE_RELEASE, NULL);
+    return true;
+}
+
+bool lvGuiPortKeypadRead(lvGuiPortKey_t *key)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    bool read = false;
+    uint32_t tail = d->key_tail;
+    if (tail != d->key_head)
+    {
+        const lvGuiKeyEvent_t *e = &d->key_fifo[tail % LV_GUI_KEY_FIFO_DEPTH];
+        keyMap_t k = e->key;
+        keyState_t state = e->state;
+        uint32_t latency_us = (uint32_t)osiUpTimeUS() - e->up_us;
+        OSI_BARRIER();
+        d->key_tail = tail + 1;
+
+        d->last_key = (k < KEY_MAP_MAX_COUNT && d->keymap[k] != 0) ? d->keymap[k] : LV_GUI_PORT_KEY_NONE;
+        d->last_key_state = state;
+
+        d->stat.key_count++;
+        d->stat.key_latency_us += latency_us;
+        d->stat.key_latency_max_us = OSI_MAX(uint32_t, d->stat.key_latency_max_us, latency_us);
+        read = true;
+    }
+
+    key->key = d->last_key;
+    key->pressed = (d->last_key_state & KEY_STATE_RELEASE) == 0;
+    return read;
+}
+
+bool lvGuiPortKeypadPending(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    return d->key_tail != d->key_head;
+}
+
+bool lvGuiPortScreenIsOn(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    return d->screen_on;
+}
+
+void lvGuiPortScreenOn(bool wakeup)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (wakeup)
+        drvLcdWakeup(d->lcd);
+    d->screen_on = true;
+}
+
+void lvGuiPortScreenOff(bool sleep)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    d->screen_on = false;
+    if (sleep)
+    {
+        drvBackLightClose();
+        drvLcdSleep(d->lcd);
+    }
+}
+
+void lvGuiPortBackLightOn(void)
+{
+    drvBackLightOpen(0);
+    drvBackLightFade(LV_GUI_BACKLIGHT_LEVEL, LV_GUI_BACKLIGHT_FADE_MS, DRV_BACKLIGHT_CURVE_EASE_OUT);
+}
+
+bool lvGuiPortRequestScreenOn(uint8_t id)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (id > 31)
+        return false;
+
+    d->screen_on_users |= (1 << id);
+    return true;
+}
+
+bool lvGuiPortReleaseScreenOn(uint8_t id)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    if (id > 31)
+        return false;
+
+    d->screen_on_users &= ~(1 << id);
+    return true;
+}
+
+void lvGuiPortSetInactiveTimeout(unsigned timeout)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    d->inactive_timeout = timeout;
+}
+
+void lvGuiPortSetAnimationInactive(bool inactive)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+    d->anim_inactive = inactive;
+}
+
+void lvGuiPortGetStat(lvGuiPortStat_t *stat)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    uint32_t critical = osiEnterCritical();
+    *stat = d->stat;
+    stat->wait_us = drvLcdGetWaitTime() - d->stat_wait_base;
+    osiExitCritical(critical);
+}
+
+void lvGuiPortResetStat(void)
+{
+    lvGuiPortContext_t *d = &gLvGuiPortCtx;
+
+    uint32_t critical = osiEnterCritical();
+    memset(&d->stat, 0, sizeof(d->stat));
+    d->stat_wait_base = drvLcdGetWaitTime();
+    osiExitCritical(critical);
+}
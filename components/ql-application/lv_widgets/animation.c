@@ -10,144 +10,168 @@
 
 #include "animation.h"
 
+/*
+ A move is an lv_anim of the offset along the move direction, so it is
+ driven by time rather than by steps, and runs in the anim task right
+ before the display refresh. At each frame, the union of old and new
+ areas of the group is invalidated once, the invalidation of each obj
+ then falls in it and is dropped by lv_refr.
+ */
 
+static obj_move_anim_t* moving_anims[ANIM_MOVE_MAX_NUM];
 
-//obj move task
-static void iclv_obj_move_task(lv_task_t* task)
+
+static bool move_is_vertical(obj_move_anim_t* anim)
 {
-    obj_move_anim_t* anim = (obj_move_anim_t*)task->user_data;
-    static lv_point_t offset = {0};
-    int i = 0;
+    return anim->direct == TOUCH_MOVE_DIRECT_UP || anim->direct == TOUCH_MOVE_DIRECT_DOWN;
+}
 
-    //LOGI("iclv_obj_move_task, direct:%d, action:%d\n",
-    //     anim->direct, anim->action);
+static lv_coord_t move_get_start(obj_move_anim_t* anim)
+{
+    return move_is_vertical(anim) ? anim->offset.y : anim->offset.x;
+}
 
-    switch (anim->direct) {
-    case TOUCH_MOVE_DIRECT_DOWN:
-        if (offset.y == 0) {
-            offset.y = anim->offset.y;
-        }
+static lv_coord_t move_get_end(obj_move_anim_t* anim)
+{
+    if (anim->action != TOUCH_ANIM_ACTION_FORWARD) return 0;
 
-        if (anim->action == TOUCH_ANIM_ACTION_BACKWARD) {
-            offset.y -= anim->v_step;
-            if (offset.y < 0) offset.y = 0;
+    if (anim->direct == TOUCH_MOVE_DIRECT_UP || anim->direct == TOUCH_MOVE_DIRECT_LEFT)
+        return -anim->distance;
 
-            if (offset.y == 0) {                
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
+    return anim->distance;
+}
+
+static void move_objs_set_offset(obj_move_anim_t* anim, lv_coord_t offset)
+{
+    lv_coord_t x = move_is_vertical(anim) ? 0 : offset;
+    lv_coord_t y = move_is_vertical(anim) ? offset : 0;
+    lv_obj_t* parent = lv_obj_get_parent(anim->objgrp.objs[0].obj);
+    lv_area_t area;
+    bool has_area = false;
+    int i = 0;
+
+    //union of old and new areas of the objs on the same parent
+    for (i = 0; i < anim->objgrp.num && parent; i++) {
+        lv_obj_t* obj = anim->objgrp.objs[i].obj;
+        lv_coord_t dx = anim->objgrp.objs[i].origin_pos.x + x - lv_obj_get_x(obj);
+        lv_coord_t dy = anim->objgrp.objs[i].origin_pos.y + y - lv_obj_get_y(obj);
+        lv_area_t cur;
+        lv_area_t moved;
+
+        if (lv_obj_get_parent(obj) != parent) continue;
+
+        lv_obj_get_coords(obj, &cur);
+        moved.x1 = cur.x1 + dx;
+        moved.y1 = cur.y1 + dy;
+        moved.x2 = cur.x2 + dx;
+        moved.y2 = cur.y2 + dy;
+
+        if (!has_area) {
+            lv_area_copy(&area, &cur);
+            has_area = true;
         }
-        else if (anim->action == TOUCH_ANIM_ACTION_FORWARD) {
-            offset.y += anim->v_step;
-            if (offset.y > anim->distance) offset.y = anim->distance;
-
-            if (offset.y == anim->distance) {              
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
+        else {
+            _lv_area_join(&area, &area, &cur);
         }
+        _lv_area_join(&area, &area, &moved);
+    }
 
-        break;
+    if (has_area) lv_obj_invalidate_area(parent, &area);
 
-    case TOUCH_MOVE_DIRECT_UP:
-        if (offset.y == 0) {
-            offset.y = anim->offset.y;
-        }
+    for (i = 0; i < anim->objgrp.num; i++) {
+        lv_obj_set_pos(anim->objgrp.objs[i].obj, anim->objgrp.objs[i].origin_pos.x + x, anim->objgrp.objs[i].origin_pos.y + y);
+    }
+}
 
-        if (anim->action == TOUCH_ANIM_ACTION_BACKWARD) {
-            offset.y += anim->v_step;
-            if (offset.y > 0) offset.y = 0;
+static void move_del(obj_move_anim_t* anim)
+{
+    int i = 0;
 
-            if (offset.y == 0) {             
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
-        }
-        else if (anim->action == TOUCH_ANIM_ACTION_FORWARD) {
-            offset.y -= anim->v_step;
-            if (offset.y < -anim->distance) offset.y = -anim->distance;
-            
-            if (offset.y == -anim->distance) {             
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
-        }
-        break;
+    for (i = 0; i < ANIM_MOVE_MAX_NUM; i++) {
+        if (moving_anims[i] == anim) moving_anims[i] = NULL;
+    }
+}
 
-    case TOUCH_MOVE_DIRECT_LEFT:
-        if (offset.x == 0) {
-            offset.x = anim->offset.x;
-        }
+static void move_anim_exec(lv_anim_t* a, lv_anim_value_t v)
+{
+    move_objs_set_offset((obj_move_anim_t*)a->var, v);
+}
 
-        if (anim->action == TOUCH_ANIM_ACTION_BACKWARD) {
-            offset.x += anim->h_step;
-            if (offset.x > 0) offset.x = 0;
+static void move_anim_ready(lv_anim_t* a)
+{
+    obj_move_anim_t* anim = (obj_move_anim_t*)a->var;
 
-            if (offset.x == 0) {
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
-        }
-        else if (anim->action == TOUCH_ANIM_ACTION_FORWARD) {
-            offset.x -= anim->h_step;
-            if (offset.x < -anim->distance) offset.x = -anim->distance;
-
-            if (offset.x == -anim->distance) {             
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
-        }
-        break;
+    move_del(anim);
+    if (anim->finish_cb) anim->finish_cb();
+}
 
-    case TOUCH_MOVE_DIRECT_RIGHT:
-        if (offset.x == 0) {
-            offset.x = anim->offset.x;
-        }
+static void move_finish(obj_move_anim_t* anim)
+{
+    move_del(anim);
+    move_objs_set_offset(anim, move_get_end(anim));
+    if (anim->finish_cb) anim->finish_cb();
+}
 
-        if (anim->action == TOUCH_ANIM_ACTION_BACKWARD) {
-            offset.x -= anim->h_step;
-            if (offset.x < 0) offset.x = 0;
+void ic_start_move_objs(obj_move_anim_t *anim)
+{
+    lv_anim_path_t path;
+    lv_coord_t start, end;
+    uint32_t time;
+    lv_anim_t a;
+    int i = 0;
 
-            if (offset.x == 0) {                
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
-        }
-        else if (anim->action == TOUCH_ANIM_ACTION_FORWARD) {
-            offset.x += anim->h_step;
-            if (offset.x > anim->distance) offset.x = anim->distance;
-
-            if (offset.x == anim->distance) {     
-                lv_task_del(task);
-                if(anim->finish_cb) anim->finish_cb();
-            }
-        }
-        break;
-    default:
-        break;
-    }
+    if (!anim || anim->objgrp.num == 0) return;
 
-    LOGI("offset.x:%d, offset.y:%d\n", offset.x, offset.y);
+    anim->is_moving = 1;
 
-    for (i = 0; i < anim->objgrp.num; i++) {
-        lv_obj_set_pos(anim->objgrp.objs[i].obj, anim->objgrp.objs[i].origin_pos.x + offset.x, anim->objgrp.objs[i].origin_pos.y + offset.y);
-    }
+    start = move_get_start(anim);
+    end = move_get_end(anim);
+    time = anim->distance ? (uint32_t)anim->time * LV_MATH_ABS(end - start) / anim->distance : 0;
 
-    if (offset.x == -anim->distance || offset.x == anim->distance) {
-        offset.x = 0;
-    }
+    //restart the move, or no place for it
+    lv_anim_del(anim, (lv_anim_exec_xcb_t)move_anim_exec);
+    move_del(anim);
+    for (i = 0; i < ANIM_MOVE_MAX_NUM && moving_anims[i]; i++);
 
-    if (offset.y == -anim->distance || offset.y == anim->distance) {
-        offset.y = 0;
+    if (time == 0 || i == ANIM_MOVE_MAX_NUM) {
+        move_finish(anim);
+        return;
     }
-   
+    moving_anims[i] = anim;
+
+    lv_anim_path_init(&path);
+    lv_anim_path_set_cb(&path, lv_anim_path_ease_out);
+
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, anim);
+    lv_anim_set_custom_exec_cb(&a, move_anim_exec);
+    lv_anim_set_values(&a, start, end);
+    lv_anim_set_time(&a, time);
+    lv_anim_set_path(&a, &path);
+    lv_anim_set_ready_cb(&a, move_anim_ready);
+    lv_anim_start(&a);
 }
 
-void ic_start_move_objs(obj_move_anim_t *anim)
+void ic_stop_move_objs(obj_move_anim_t *anim)
 {
+    int i = 0;
+
     if (!anim) return;
 
-    lv_task_t *_task = lv_task_create(iclv_obj_move_task, anim->interval, LV_TASK_PRIO_HIGH, anim);
-    anim->is_moving = 1;
+    for (i = 0; i < ANIM_MOVE_MAX_NUM; i++) {
+        if (moving_anims[i] == anim) break;
+    }
+    if (i == ANIM_MOVE_MAX_NUM) return;
+
+    lv_anim_del(anim, (lv_anim_exec_xcb_t)move_anim_exec);
+    move_finish(anim);
 }
 
+void ic_stop_all_move_objs(void)
+{
+    int i = 0;
+
+    for (i = 0; i < ANIM_MOVE_MAX_NUM; i++) {
+        if (moving_anims[i]) ic_stop_move_objs(moving_anims[i]);
+    }
+}
@@ -10,6 +10,7 @@
 #include "ic_widgets_inc.h"
 
 #define    ANIM_OBJGRP_MAX_NUM     (5)
+#define    ANIM_MOVE_MAX_NUM       (4)     //moves running at the same time
 #define MAINSCREEN_PULL_FAST_TIME  (300)   //ms
 
 typedef enum {
@@ -44,11 +45,9 @@ typedef struct {
     touch_direct_enum           direct;
     touch_anim_action_enum      action;
     lv_point_t                  offset;
-    uint16_t                    h_step;
-    uint16_t                    v_step;
     uint16_t                    distance;    //move distance
 
-    uint16_t                   interval;  //step inteval ms
+    uint16_t                    time;      //ms to move the whole distance, eased out
 
     obj_group_t objgrp;
 
@@ -60,4 +59,14 @@ typedef struct {
 
 void ic_start_move_objs(obj_move_anim_t* anim);
 
+/**
+ stop a move, objs are put at the end of the move and finish_cb is called
+ */
+void ic_stop_move_objs(obj_move_anim_t* anim);
+
+/**
+ stop all moves, called when a screen exits so no move runs on a hidden screen
+ */
+void ic_stop_all_move_objs(void);
+
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "image_id_list.h"
 
+#ifndef IC_IMAGE_PACK
 const void* g_image_resource_list[IMAGE_ID_NUM] = {
     &IMG_CLOCKFACE_ANALOG1_MINUTE,
     &IMG_CLOCKFACE_ANALOG1_HOUR,
@@ -141,3 +142,4 @@ const void* g_image_resource_list[IMAGE_ID_NUM] = {
     &IMG_CALL_OUT,
     &IMG_CALL_SELECT,
 };
+#endif
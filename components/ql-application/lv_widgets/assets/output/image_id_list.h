@@ -3,6 +3,7 @@
 #ifndef __IMAGE_ID_LIST_H__
 #define __IMAGE_ID_LIST_H__
 
+#include "image_config.h"
 #include "image_declare.h"
 
 typedef enum {
@@ -151,6 +152,8 @@ typedef struct {
     int img_ptr;
 }image_list_item_t;
 
+#ifndef IC_IMAGE_PACK
 extern const void* g_image_resource_list[IMAGE_ID_NUM]; 
+#endif
 
 #endif
\ No newline at end of file
@@ -264,6 +264,35 @@ static void clockface_get_analog_clock_angle(uint16_t *hour_hand_counter,
 }
 
 
+/**
+* set the image of a time digit, only when the digit is changed. So the
+* unchanged digits won't be invalidated at each update.
+*/
+static void clockface_set_time_img(clockface_obj_t *clock, lv_obj_t *obj, const image_id_enum *ids, ic_time_img_t type)
+{
+    if (obj == NULL || clock->time_img[type] == ids[type])
+        return;
+
+    clock->time_img[type] = ids[type];
+    lv_img_set_src(obj, iclv_get_image_by_id(ids[type]));
+}
+
+/**
+* battery level image, set only when the level image is changed. Percent
+* changes are delivered by data provider, and most of them are in a level.
+*/
+static void clockface_battery_changed(ic_data_enum field, int32_t value, void *user_data)
+{
+    clockface_obj_t *clock = (clockface_obj_t *)user_data;
+    image_id_enum id = IMG_IDLE_BATTERY0_ID + (value >= 100 ? 4 : value / 20);
+
+    if (clock->battery == NULL || value < 0 || clock->battery_img == id)
+        return;
+
+    clock->battery_img = id;
+    lv_img_set_src(clock->battery, iclv_get_image_by_id(id));
+}
+
 void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 {
     //assert(parent);
@@ -271,6 +300,20 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 
     clockface_ctx = clockface;
 
+    //read time once for all digits, new objects always get the image
+    image_id_enum time_ids[IC_TIME_IMG_NUM];
+    int t;
+
+    for (t = 0; t < IC_TIME_IMG_NUM; t++)
+        clockface->time_img[t] = IMAGE_ID_NUM;
+    clockface->battery = NULL;
+    clockface->battery_img = IMG_IDLE_BATTERY0_ID;
+    memset(&clockface->hour_hand, 0, sizeof(ic_hand_t));
+    memset(&clockface->min_hand, 0, sizeof(ic_hand_t));
+    memset(&clockface->sec_hand, 0, sizeof(ic_hand_t));
+    if (clockface->desc->type != CLOCK_ANALOG)
+        iclv_time_get_image_ids(clockface->desc->clock_num, time_ids);
+
 #if 0
     lv_obj_t* bg = NULL;
 
@@ -319,6 +362,8 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 
     if (clockface->desc->bg.type == CF_IMAGE_LV_IMG) {  //internal image
         lv_img_set_src(bg, clockface->desc->bg.img.img_src);
+        //background is drawn at each refresh, keep it decoded
+        lv_img_cache_pin(clockface->desc->bg.img.img_src, true);
     }
     else if (clockface->desc->bg.type == CF_IMAGE_LV_IMG_SEQ) { // lv internal seq
         lv_img_set_src(bg, clockface->desc->bg.img.seq.begin_img);
@@ -335,8 +380,9 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
         //invoke gif decoder
     }
     else if (clockface->desc->bg.type == CF_IMAGE_FS_IMG) { // lv img file
-        //show image from file lv_img_set_src(img, "S:folder1/my_img.bin")
-
+        //image in clockface package, or file path like "U:folder1/my_img.bin"
+        lv_img_set_src(bg, clockface->desc->bg.img.img_src);
+        lv_img_cache_pin(clockface->desc->bg.img.img_src, true);
     }
     else if (clockface->desc->bg.type == CF_IMAGE_FS_IMG_SEQ) { // lv img file seq
         //animator
@@ -387,56 +433,27 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 		clockface->day_l = day_l;
 		clockface->weekday = weekday;
 
-        //TODO: img src from fs, png raw file decoder
-        if (clockface->desc->analog.hour.img.type == CF_IMAGE_LV_IMG) {
-            lv_img_set_src(hour, clockface->desc->analog.hour.img.img_src);
-            lv_img_set_src(min, clockface->desc->analog.minute.img.img_src);
-
-            if (clockface->desc->analog.second.exist) {
-                lv_img_set_src(sec, clockface->desc->analog.second.img.img_src);
-            }
-        }
-        else if (clockface->desc->analog.hour.img.type == CF_IMAGE_FS_IMG) { //image in filssystem
-
-        }
-
         //center point
         if (clockface->desc->analog.has_position) {
             center_x = clockface->desc->analog.center.x;
             center_y = clockface->desc->analog.center.y;
         }
-       
-         //hour
-            uint16_t width = lv_obj_get_width(hour);
-            uint16_t height = lv_obj_get_height(hour);
-            lv_obj_set_pos(hour, center_x - width / 2, center_y - height / 2);
-
-            //min
-            width = lv_obj_get_width(min);
-            height = lv_obj_get_height(min);
-            lv_obj_set_pos(min, center_x - width / 2, center_y - height / 2);
-
-            //sec
-            if (clockface->desc->analog.second.exist) {
-                width = lv_obj_get_width(sec);
-                height = lv_obj_get_height(sec);
-                lv_obj_set_pos(sec, center_x - width / 2, center_y - height / 2);
-            }
-       
 
+        //TODO: png raw file decoder
+        if (clockface->desc->analog.hour.img.type == CF_IMAGE_LV_IMG ||
+                clockface->desc->analog.hour.img.type == CF_IMAGE_FS_IMG) { //image in firmware or clockface package
+            //hands are drawn from cached sprites of each angle step, rotating the image
+            //by lv_img_set_angle at each refresh costs too much cpu time
+            ic_hand_init(&clockface->hour_hand, hour, clockface->desc->analog.hour.img.img_src, center_x, center_y);
+            ic_hand_set_angle(&clockface->hour_hand, hour_angle);
 
-        //these apis will cost too much cpu time, the performance is largely down      
-        //this badly slowdown the obj moving, consider use canvs and just draw last snapshot
-        //of this obj when it`s moving
-        lv_img_set_angle(hour, hour_angle);
-        lv_img_set_antialias(hour, true);
+            ic_hand_init(&clockface->min_hand, min, clockface->desc->analog.minute.img.img_src, center_x, center_y);
+            ic_hand_set_angle(&clockface->min_hand, min_angle);
 
-        lv_img_set_angle(min, min_angle);
-        lv_img_set_antialias(min, true);
-
-        if (clockface->desc->analog.second.exist) {
-            lv_img_set_angle(sec, sec_angle);
-            lv_img_set_antialias(sec, true);
+            if (clockface->desc->analog.second.exist) {
+                ic_hand_init(&clockface->sec_hand, sec, clockface->desc->analog.second.img.img_src, center_x, center_y);
+                ic_hand_set_angle(&clockface->sec_hand, sec_angle);
+            }
         }
 
     }
@@ -459,15 +476,15 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 		if(clockface->desc->clock_num == 0)//第一个表盘
 		{
 			lv_obj_set_pos(hour_h, clockface->desc->digital.hour.pos1.x,clockface->desc->digital.hour.pos1.y);
-			lv_img_set_src(hour_h, iclv_get_image_by_id(iclv_time_get_image_id(0,0)));
+			clockface_set_time_img(clockface, hour_h, time_ids, IC_TIME_IMG_HOUR_H);
 			lv_obj_set_pos(hour_l, clockface->desc->digital.hour.pos2.x,clockface->desc->digital.hour.pos2.y);
-			lv_img_set_src(hour_l, iclv_get_image_by_id(iclv_time_get_image_id(1,0)));
+			clockface_set_time_img(clockface, hour_l, time_ids, IC_TIME_IMG_HOUR_L);
 
 			//分钟的显示
 			lv_obj_set_pos(min_h, clockface->desc->digital.minute.pos1.x,clockface->desc->digital.minute.pos1.y);
-			lv_img_set_src(min_h, iclv_get_image_by_id(iclv_time_get_image_id(2,0)));
+			clockface_set_time_img(clockface, min_h, time_ids, IC_TIME_IMG_MIN_H);
 			lv_obj_set_pos(min_l, clockface->desc->digital.minute.pos2.x,clockface->desc->digital.minute.pos2.y);
-			lv_img_set_src(min_l, iclv_get_image_by_id(iclv_time_get_image_id(3,0)));
+			clockface_set_time_img(clockface, min_l, time_ids, IC_TIME_IMG_MIN_L);
 
 			//斜杠
 			lv_obj_t* slash = lv_img_create(bg, NULL);
@@ -477,15 +494,15 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 		else if(clockface->desc->clock_num == 1)//第二个表盘
 		{
 			lv_obj_set_pos(hour_h, clockface->desc->digital.hour.pos1.x,clockface->desc->digital.hour.pos1.y);
-			lv_img_set_src(hour_h, iclv_get_image_by_id(iclv_time_get_image_id(0,1)));
+			clockface_set_time_img(clockface, hour_h, time_ids, IC_TIME_IMG_HOUR_H);
 			lv_obj_set_pos(hour_l, clockface->desc->digital.hour.pos2.x,clockface->desc->digital.hour.pos2.y);
-			lv_img_set_src(hour_l, iclv_get_image_by_id(iclv_time_get_image_id(1,1)));
+			clockface_set_time_img(clockface, hour_l, time_ids, IC_TIME_IMG_HOUR_L);
 
 			//分钟的显示
 			lv_obj_set_pos(min_h, clockface->desc->digital.minute.pos1.x,clockface->desc->digital.minute.pos1.y);
-			lv_img_set_src(min_h, iclv_get_image_by_id(iclv_time_get_image_id(2,1)));
+			clockface_set_time_img(clockface, min_h, time_ids, IC_TIME_IMG_MIN_H);
 			lv_obj_set_pos(min_l, clockface->desc->digital.minute.pos2.x,clockface->desc->digital.minute.pos2.y);
-			lv_img_set_src(min_l, iclv_get_image_by_id(iclv_time_get_image_id(3,1)));
+			clockface_set_time_img(clockface, min_l, time_ids, IC_TIME_IMG_MIN_L);
 
 			//斜杠
 			lv_obj_t* slash = lv_img_create(bg, NULL);
@@ -495,15 +512,15 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 		else //第三个表盘
 		{
 			lv_obj_set_pos(hour_h, clockface->desc->digital.hour.pos1.x,clockface->desc->digital.hour.pos1.y);
-			lv_img_set_src(hour_h, iclv_get_image_by_id(iclv_time_get_image_id(0,2)));
+			clockface_set_time_img(clockface, hour_h, time_ids, IC_TIME_IMG_HOUR_H);
 			lv_obj_set_pos(hour_l, clockface->desc->digital.hour.pos2.x,clockface->desc->digital.hour.pos2.y);
-			lv_img_set_src(hour_l, iclv_get_image_by_id(iclv_time_get_image_id(1,2)));
+			clockface_set_time_img(clockface, hour_l, time_ids, IC_TIME_IMG_HOUR_L);
 
 			//分钟的显示
 			lv_obj_set_pos(min_h, clockface->desc->digital.minute.pos1.x,clockface->desc->digital.minute.pos1.y);
-			lv_img_set_src(min_h, iclv_get_image_by_id(iclv_time_get_image_id(2,2)));
+			clockface_set_time_img(clockface, min_h, time_ids, IC_TIME_IMG_MIN_H);
 			lv_obj_set_pos(min_l, clockface->desc->digital.minute.pos2.x,clockface->desc->digital.minute.pos2.y);
-			lv_img_set_src(min_l, iclv_get_image_by_id(iclv_time_get_image_id(3,2)));
+			clockface_set_time_img(clockface, min_l, time_ids, IC_TIME_IMG_MIN_L);
 
 			//斜杠和冒号
 			lv_obj_t* colon = lv_img_create(bg, NULL);//冒号
@@ -538,27 +555,10 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 
 					clockface->mon = month_h;
 					clockface->mon_l = month_l;
-					if(clockface->desc->clock_num == 0)
-					{
-						lv_obj_set_pos(month_h, clockface->desc->holders[0].pos.x,clockface->desc->holders[0].pos.y);
-						lv_img_set_src(month_h, iclv_get_image_by_id(iclv_time_get_image_id(4,0)));
-						lv_obj_set_pos(month_l, clockface->desc->holders[1].pos.x,clockface->desc->holders[1].pos.y);
-						lv_img_set_src(month_l, iclv_get_image_by_id(iclv_time_get_image_id(5,0)));
-					}
-					else if(clockface->desc->clock_num == 1)
-					{
-						lv_obj_set_pos(month_h, clockface->desc->holders[0].pos.x,clockface->desc->holders[0].pos.y);
-						lv_img_set_src(month_h, iclv_get_image_by_id(iclv_time_get_image_id(4,1)));
-						lv_obj_set_pos(month_l, clockface->desc->holders[1].pos.x,clockface->desc->holders[1].pos.y);
-						lv_img_set_src(month_l, iclv_get_image_by_id(iclv_time_get_image_id(5,1)));
-					}
-					else
-					{
-						lv_obj_set_pos(month_h, clockface->desc->holders[0].pos.x,clockface->desc->holders[0].pos.y);
-						lv_img_set_src(month_h, iclv_get_image_by_id(iclv_time_get_image_id(4,2)));
-						lv_obj_set_pos(month_l, clockface->desc->holders[1].pos.x,clockface->desc->holders[1].pos.y);
-						lv_img_set_src(month_l, iclv_get_image_by_id(iclv_time_get_image_id(5,2)));
-					}
+					lv_obj_set_pos(month_h, clockface->desc->holders[0].pos.x,clockface->desc->holders[0].pos.y);
+					clockface_set_time_img(clockface, month_h, time_ids, IC_TIME_IMG_MON_H);
+					lv_obj_set_pos(month_l, clockface->desc->holders[1].pos.x,clockface->desc->holders[1].pos.y);
+					clockface_set_time_img(clockface, month_l, time_ids, IC_TIME_IMG_MON_L);
 
 				}
 	            break;
@@ -571,27 +571,10 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 
 					clockface->day = day_h;
 					clockface->day_l = day_l;
-					if(clockface->desc->clock_num == 0)
-					{
-						lv_obj_set_pos(day_h, clockface->desc->holders[2].pos.x,clockface->desc->holders[2].pos.y);
-						lv_img_set_src(day_h, iclv_get_image_by_id(iclv_time_get_image_id(6,0)));
-						lv_obj_set_pos(day_l, clockface->desc->holders[3].pos.x,clockface->desc->holders[3].pos.y);
-						lv_img_set_src(day_l, iclv_get_image_by_id(iclv_time_get_image_id(7,0)));
-					}
-					else if(clockface->desc->clock_num == 1)
-					{
-						lv_obj_set_pos(day_h, clockface->desc->holders[2].pos.x,clockface->desc->holders[2].pos.y);
-						lv_img_set_src(day_h, iclv_get_image_by_id(iclv_time_get_image_id(6,1)));
-						lv_obj_set_pos(day_l, clockface->desc->holders[3].pos.x,clockface->desc->holders[3].pos.y);
-						lv_img_set_src(day_l, iclv_get_image_by_id(iclv_time_get_image_id(7,1)));
-					}
-					else 
-					{
-						lv_obj_set_pos(day_h, clockface->desc->holders[2].pos.x,clockface->desc->holders[2].pos.y);
-						lv_img_set_src(day_h, iclv_get_image_by_id(iclv_time_get_image_id(6,2)));
-						lv_obj_set_pos(day_l, clockface->desc->holders[3].pos.x,clockface->desc->holders[3].pos.y);
-						lv_img_set_src(day_l, iclv_get_image_by_id(iclv_time_get_image_id(7,2)));
-					}
+					lv_obj_set_pos(day_h, clockface->desc->holders[2].pos.x,clockface->desc->holders[2].pos.y);
+					clockface_set_time_img(clockface, day_h, time_ids, IC_TIME_IMG_DAY_H);
+					lv_obj_set_pos(day_l, clockface->desc->holders[3].pos.x,clockface->desc->holders[3].pos.y);
+					clockface_set_time_img(clockface, day_l, time_ids, IC_TIME_IMG_DAY_L);
 				}
 	            break;
 		
@@ -602,18 +585,7 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 
 					clockface->weekday = weekday;
 					lv_obj_set_pos(weekday, clockface->desc->holders[4].pos.x,clockface->desc->holders[4].pos.y);
-					if(clockface->desc->clock_num == 0)
-					{
-						lv_img_set_src(weekday, iclv_get_image_by_id(iclv_time_get_image_id(8,0)));
-					}
-					else if(clockface->desc->clock_num == 1)
-					{
-						lv_img_set_src(weekday, iclv_get_image_by_id(iclv_time_get_image_id(8,1)));
-					}
-					else 
-					{
-						lv_img_set_src(weekday, iclv_get_image_by_id(iclv_time_get_image_id(8,2)));
-					}	
+					clockface_set_time_img(clockface, weekday, time_ids, IC_TIME_IMG_WEEK);
 				}
 	            break;
 	        
@@ -660,6 +632,7 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 					clockface->battery = battery;
 					lv_obj_set_pos(battery, clockface->desc->holders[5].pos.x,clockface->desc->holders[5].pos.y);
 					lv_img_set_src(battery, iclv_get_image_by_id(IMG_IDLE_BATTERY0_ID));
+					ic_data_subscribe(IC_DATA_BATTERY, clockface_battery_changed, clockface);
 				}
 	            break;
 				
@@ -704,8 +677,16 @@ void ic_clockface_create(clockface_obj_t* clockface, lv_obj_t* parent)
 
 void ic_clockface_delete(clockface_obj_t *clock)
 {
-    //delete lv obj first
+    ic_data_unsubscribe(IC_DATA_BATTERY, clockface_battery_changed, clock);
+
+    //release hand sprites, then delete lv obj
+    ic_hand_deinit(&clock->hour_hand);
+    ic_hand_deinit(&clock->min_hand);
+    ic_hand_deinit(&clock->sec_hand);
+    if (clock->desc->bg.type == CF_IMAGE_LV_IMG || clock->desc->bg.type == CF_IMAGE_FS_IMG)
+        lv_img_cache_pin(clock->desc->bg.img.img_src, false);
     lv_obj_del(clock->bg);
+    ic_hand_cache_clean();
 
     //free clockface_obj_t
    // lv_mem_free(clock);
@@ -714,48 +695,33 @@ void ic_clockface_delete(clockface_obj_t *clock)
 void ic_clockface_update(clockface_obj_t *clock)
 {
 #if 1
+    //read time once for all digits
+    image_id_enum time_ids[IC_TIME_IMG_NUM];
+
+    if (clock->desc->type != CLOCK_ANALOG)
+        iclv_time_get_image_ids(clock->desc->clock_num, time_ids);
+
     //update time
     if (clock->desc->type == CLOCK_ANALOG || clock->desc->type == CLOCK_BOTH) 
 	{  //analog time
         uint16_t hour_angle = 0, min_angle, sec_angle = 0;
         clockface_get_analog_clock_angle(&hour_angle, &min_angle, &sec_angle);
-        lv_img_set_angle(clock->hour, hour_angle);
-        lv_img_set_angle(clock->min, min_angle);
+        ic_hand_set_angle(&clock->hour_hand, hour_angle);
+        ic_hand_set_angle(&clock->min_hand, min_angle);
         if (clock->desc->analog.second.exist) 
 		{
-            lv_img_set_angle(clock->sec, sec_angle);
+            ic_hand_set_angle(&clock->sec_hand, sec_angle);
         }
     }
     else if (clock->desc->type == CLOCK_DIGITAL || clock->desc->type == CLOCK_BOTH)//digital time 
 	{ 
 		//小时的显示
-		if(clock->desc->clock_num == 0)
-		{
-			lv_img_set_src(clock->hour, iclv_get_image_by_id(iclv_time_get_image_id(0,0)));
-			lv_img_set_src(clock->hour_l, iclv_get_image_by_id(iclv_time_get_image_id(1,0)));
-
-			//分钟的显示
-			lv_img_set_src(clock->min, iclv_get_image_by_id(iclv_time_get_image_id(2,0)));
-			lv_img_set_src(clock->min_l, iclv_get_image_by_id(iclv_time_get_image_id(3,0)));
-		}
-		else if(clock->desc->clock_num == 1)
-		{
-			lv_img_set_src(clock->hour, iclv_get_image_by_id(iclv_time_get_image_id(0,1)));
-			lv_img_set_src(clock->hour_l, iclv_get_image_by_id(iclv_time_get_image_id(1,1)));
+		clockface_set_time_img(clock, clock->hour, time_ids, IC_TIME_IMG_HOUR_H);
+		clockface_set_time_img(clock, clock->hour_l, time_ids, IC_TIME_IMG_HOUR_L);
 
-			//分钟的显示
-			lv_img_set_src(clock->min, iclv_get_image_by_id(iclv_time_get_image_id(2,1)));
-			lv_img_set_src(clock->min_l, iclv_get_image_by_id(iclv_time_get_image_id(3,1)));
-		}
-		else 
-		{
-			lv_img_set_src(clock->hour, iclv_get_image_by_id(iclv_time_get_image_id(0,2)));
-			lv_img_set_src(clock->hour_l, iclv_get_image_by_id(iclv_time_get_image_id(1,2)));
-
-			//分钟的显示
-			lv_img_set_src(clock->min, iclv_get_image_by_id(iclv_time_get_image_id(2,2)));
-			lv_img_set_src(clock->min_l, iclv_get_image_by_id(iclv_time_get_image_id(3,2)));
-		}
+		//分钟的显示
+		clockface_set_time_img(clock, clock->min, time_ids, IC_TIME_IMG_MIN_H);
+		clockface_set_time_img(clock, clock->min_l, time_ids, IC_TIME_IMG_MIN_L);
     }
 
     //update holders
@@ -768,21 +734,8 @@ void ic_clockface_update(clockface_obj_t *clock)
         case CLOCKFACE_HOLDER_MONTH:
 			if(clock->desc->type == CLOCK_DIGITAL)
 			{
-				if(clock->desc->clock_num == 0)
-				{
-					lv_img_set_src(clock->mon, iclv_get_image_by_id(iclv_time_get_image_id(4,0)));
-					lv_img_set_src(clock->mon_l, iclv_get_image_by_id(iclv_time_get_image_id(5,0)));
-				}
-				else if(clock->desc->clock_num == 1)
-				{
-					lv_img_set_src(clock->mon, iclv_get_image_by_id(iclv_time_get_image_id(4,1)));
-					lv_img_set_src(clock->mon_l, iclv_get_image_by_id(iclv_time_get_image_id(5,1)));
-				}
-				else
-				{
-					lv_img_set_src(clock->mon, iclv_get_image_by_id(iclv_time_get_image_id(4,2)));
-					lv_img_set_src(clock->mon_l, iclv_get_image_by_id(iclv_time_get_image_id(5,2)));
-				}
+				clockface_set_time_img(clock, clock->mon, time_ids, IC_TIME_IMG_MON_H);
+				clockface_set_time_img(clock, clock->mon_l, time_ids, IC_TIME_IMG_MON_L);
 			}
 		
             break;
@@ -790,21 +743,8 @@ void ic_clockface_update(clockface_obj_t *clock)
         case CLOCKFACE_HOLDER_DAY:
 			if(clock->desc->type == CLOCK_DIGITAL)
 			{
-				if(clock->desc->clock_num == 0)
-				{
-					lv_img_set_src(clock->day, iclv_get_image_by_id(iclv_time_get_image_id(6,0)));
-					lv_img_set_src(clock->day_l, iclv_get_image_by_id(iclv_time_get_image_id(7,0)));
-				}
-				else if(clock->desc->clock_num == 1)
-				{
-					lv_img_set_src(clock->day, iclv_get_image_by_id(iclv_time_get_image_id(6,1)));
-					lv_img_set_src(clock->day_l, iclv_get_image_by_id(iclv_time_get_image_id(7,1)));
-				}
-				else 
-				{
-					lv_img_set_src(clock->day, iclv_get_image_by_id(iclv_time_get_image_id(6,2)));
-					lv_img_set_src(clock->day_l, iclv_get_image_by_id(iclv_time_get_image_id(7,2)));
-				}
+				clockface_set_time_img(clock, clock->day, time_ids, IC_TIME_IMG_DAY_H);
+				clockface_set_time_img(clock, clock->day_l, time_ids, IC_TIME_IMG_DAY_L);
 			}
             break;
 
@@ -812,18 +752,7 @@ void ic_clockface_update(clockface_obj_t *clock)
         case CLOCKFACE_HOLDER_WEEK:
 			if(clock->desc->type == CLOCK_DIGITAL)
 			{
-				if(clock->desc->clock_num == 0)
-				{
-					lv_img_set_src(clock->weekday, iclv_get_image_by_id(iclv_time_get_image_id(8,0)));
-				}
-				else if(clock->desc->clock_num == 1)
-				{
-					lv_img_set_src(clock->weekday, iclv_get_image_by_id(iclv_time_get_image_id(8,1)));
-				}
-				else 
-				{
-					lv_img_set_src(clock->weekday, iclv_get_image_by_id(iclv_time_get_image_id(8,2)));
-				}			
+				clockface_set_time_img(clock, clock->weekday, time_ids, IC_TIME_IMG_WEEK);
 			}
             break;
 
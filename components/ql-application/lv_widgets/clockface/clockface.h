@@ -8,6 +8,8 @@
 #endif
 
 #include "clockface_struct.h"
+#include "image_resource.h"
+#include "clockface_hand.h"
 
 typedef struct
 {
@@ -25,6 +27,11 @@ typedef struct
 	lv_obj_t *day_l;
 	lv_obj_t *weekday;
 	lv_obj_t *battery;
+    image_id_enum battery_img; //image id of battery level shown
+    image_id_enum time_img[IC_TIME_IMG_NUM]; //image ids shown by digits
+    ic_hand_t hour_hand;
+    ic_hand_t min_hand;
+    ic_hand_t sec_hand;
     clockface_t *desc;
 }clockface_obj_t;
 
@@ -0,0 +1,364 @@
+/**
+* @FileName:   clockface_hand.c
+* @Descripton: analog hands drawn from pre-rotated sprites
+*
+* Rotating a hand with lv_img_set_angle goes through the software transform
+* with anti-aliasing at every refresh, over the whole rotated area of the
+* hand image, that is the main cpu load of analog clockfaces. Here a sprite
+* is rendered once for an angle step, cropped to the visible pixels, and
+* shown by the lv_img without angle. So a hand refresh is a blit of a small
+* area, and the sprite is reused when the hand comes back to the step.
+*/
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+
+#include "ic_widgets_inc.h"
+
+#include "clockface_hand.h"
+
+#ifdef IC_CLOCKFACE_HAND_CACHE
+
+typedef struct
+{
+    const lv_img_dsc_t *src;  //hand image, NULL for a free slot
+    uint16_t step;            //angle step
+    uint16_t ref;             //hands showing it, can't be dropped while shown
+    uint32_t used;            //stamp of last use, for LRU
+    uint32_t size;            //size of pixels
+    lv_point_t ofs;           //top left of sprite, relative to pivot
+    lv_img_dsc_t img;
+}hand_sprite_t;
+
+static hand_sprite_t g_hand_sprite[IC_CLOCKFACE_HAND_CACHE_NUM];
+static uint32_t g_hand_cache_size; //size of all sprites
+static uint32_t g_hand_stamp;
+
+static void hand_sprite_drop(hand_sprite_t *sprite)
+{
+    g_hand_cache_size -= sprite->size;
+    lv_mem_free((void *)sprite->img.data);
+    memset(sprite, 0, sizeof(hand_sprite_t));
+}
+
+/**
+* get a free slot with room of size, drop least recently used sprites when full
+*/
+static hand_sprite_t *hand_sprite_alloc(uint32_t size)
+{
+    if (size > IC_CLOCKFACE_HAND_CACHE_SIZE)
+        return NULL;
+
+    for (;;) {
+        hand_sprite_t *free_slot = NULL;
+        hand_sprite_t *lru = NULL;
+        int i;
+
+        for (i = 0; i < IC_CLOCKFACE_HAND_CACHE_NUM; i++) {
+            hand_sprite_t *sprite = &g_hand_sprite[i];
+
+            if (sprite->src == NULL) {
+                if (free_slot == NULL)
+                    free_slot = sprite;
+            }
+            else if (sprite->ref == 0 && (lru == NULL || sprite->used < lru->used)) {
+                lru = sprite;
+            }
+        }
+
+        if (free_slot != NULL && g_hand_cache_size + size <= IC_CLOCKFACE_HAND_CACHE_SIZE)
+            return free_slot;
+        if (lru == NULL)
+            return NULL; //all shown
+
+        hand_sprite_drop(lru);
+    }
+}
+
+/**
+* render a hand image rotated by a step, cropped to visible pixels
+*/
+/**
+* get pixels of a hand image, which is decoded into a temporary buffer when
+* its pixels are not in memory, like images in clockface package
+*/
+static const uint8_t *hand_src_pixels(const lv_img_dsc_t *src, lv_img_cf_t *cf, uint8_t **tmp)
+{
+    lv_img_decoder_dsc_t dec;
+    const uint8_t *pixels = NULL;
+
+    *tmp = NULL;
+    *cf = src->header.cf;
+    if (src->header.cf < LV_IMG_CF_USER_ENCODED_0)
+        return src->data;
+
+    if (lv_img_decoder_open(&dec, src, LV_COLOR_BLACK) != LV_RES_OK)
+        return NULL;
+
+    *cf = dec.header.cf;
+    if (dec.img_data != NULL) {
+        pixels = dec.img_data;
+    }
+    else {
+        uint32_t line = (uint32_t)dec.header.w * (lv_img_cf_get_px_size(dec.header.cf) >> 3);
+        lv_coord_t y;
+
+        *tmp = lv_mem_alloc(line * dec.header.h);
+        if (*tmp != NULL) {
+            for (y = 0; y < dec.header.h; y++) {
+                if (lv_img_decoder_read_line(&dec, 0, y, dec.header.w, *tmp + line * y) != LV_RES_OK)
+                    break;
+            }
+            if (y == dec.header.h) {
+                pixels = *tmp;
+            }
+            else {
+                lv_mem_free(*tmp);
+                *tmp = NULL;
+            }
+        }
+    }
+
+    lv_img_decoder_close(&dec);
+    return pixels;
+}
+
+static hand_sprite_t *hand_sprite_render(const lv_img_dsc_t *src, uint16_t step)
+{
+    lv_coord_t w = src->header.w;
+    lv_coord_t h = src->header.h;
+    lv_point_t pivot = {w / 2, h / 2};
+    lv_img_transform_dsc_t trans;
+    lv_area_t area, bbox;
+    lv_coord_t x, y;
+    lv_img_cf_t cf;
+    uint8_t *tmp;
+    const uint8_t *pixels = hand_src_pixels(src, &cf, &tmp);
+    hand_sprite_t *sprite = NULL;
+
+    if (pixels == NULL) {
+        LOGE("hand image can't be decoded\n");
+        return NULL;
+    }
+
+    _lv_img_buf_get_transformed_area(&area, w, h, step * (3600 / IC_CLOCKFACE_HAND_STEPS), LV_IMG_ZOOM_NONE, &pivot);
+
+    memset(&trans, 0, sizeof(trans));
+    trans.cfg.src = pixels;
+    trans.cfg.src_w = w;
+    trans.cfg.src_h = h;
+    trans.cfg.cf = cf;
+    trans.cfg.pivot_x = pivot.x;
+    trans.cfg.pivot_y = pivot.y;
+    trans.cfg.angle = step * (3600 / IC_CLOCKFACE_HAND_STEPS);
+    trans.cfg.zoom = LV_IMG_ZOOM_NONE;
+    trans.cfg.color = LV_COLOR_BLACK;
+    trans.cfg.antialias = false;
+    _lv_img_buf_transform_init(&trans);
+
+    //find the visible pixels without anti-aliasing, it adds 1 pixel at most
+    bbox.x1 = area.x2 + 1;
+    bbox.y1 = area.y2 + 1;
+    bbox.x2 = area.x1 - 1;
+    bbox.y2 = area.y1 - 1;
+    for (y = area.y1; y <= area.y2; y++) {
+        for (x = area.x1; x <= area.x2; x++) {
+            if (!_lv_img_buf_transform(&trans, x, y) || trans.res.opa <= LV_OPA_MIN)
+                continue;
+
+            if (x < bbox.x1) bbox.x1 = x;
+            if (x > bbox.x2) bbox.x2 = x;
+            if (y < bbox.y1) bbox.y1 = y;
+            if (y > bbox.y2) bbox.y2 = y;
+        }
+    }
+    if (bbox.x1 > bbox.x2) { //transparent hand, keep 1 pixel at the pivot
+        bbox.x1 = bbox.x2 = pivot.x;
+        bbox.y1 = bbox.y2 = pivot.y;
+    }
+    else {
+        bbox.x1 = LV_MATH_MAX(bbox.x1 - 1, area.x1);
+        bbox.y1 = LV_MATH_MAX(bbox.y1 - 1, area.y1);
+        bbox.x2 = LV_MATH_MIN(bbox.x2 + 1, area.x2);
+        bbox.y2 = LV_MATH_MIN(bbox.y2 + 1, area.y2);
+    }
+
+    lv_coord_t sw = lv_area_get_width(&bbox);
+    lv_coord_t sh = lv_area_get_height(&bbox);
+    uint32_t size = lv_img_buf_get_img_size(sw, sh, LV_IMG_CF_TRUE_COLOR_ALPHA);
+    uint8_t *data = NULL;
+
+    sprite = hand_sprite_alloc(size);
+    if (sprite == NULL || (data = lv_mem_alloc(size)) == NULL) {
+        LOGE("hand sprite %dx%d no memory\n", sw, sh);
+        sprite = NULL;
+        goto out;
+    }
+
+    //render with anti-aliasing as lv_img does
+    trans.cfg.antialias = true;
+    _lv_img_buf_transform_init(&trans);
+
+    uint8_t *px = data;
+    for (y = bbox.y1; y <= bbox.y2; y++) {
+        for (x = bbox.x1; x <= bbox.x2; x++) {
+            if (_lv_img_buf_transform(&trans, x, y)) {
+                memcpy(px, &trans.res.color, LV_IMG_PX_SIZE_ALPHA_BYTE - 1);
+                px[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = trans.res.opa;
+            }
+            else {
+                memset(px, 0, LV_IMG_PX_SIZE_ALPHA_BYTE);
+            }
+            px += LV_IMG_PX_SIZE_ALPHA_BYTE;
+        }
+    }
+
+    sprite->src = src;
+    sprite->step = step;
+    sprite->size = size;
+    sprite->ofs.x = bbox.x1 - pivot.x;
+    sprite->ofs.y = bbox.y1 - pivot.y;
+    sprite->img.header.always_zero = 0;
+    sprite->img.header.w = sw;
+    sprite->img.header.h = sh;
+    sprite->img.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    sprite->img.data_size = size;
+    sprite->img.data = data;
+    g_hand_cache_size += size;
+
+out:
+    if (tmp != NULL)
+        lv_mem_free(tmp);
+    return sprite;
+}
+
+static hand_sprite_t *hand_sprite_get(const lv_img_dsc_t *src, uint16_t step)
+{
+    hand_sprite_t *sprite = NULL;
+    int i;
+
+    for (i = 0; i < IC_CLOCKFACE_HAND_CACHE_NUM; i++) {
+        if (g_hand_sprite[i].src == src && g_hand_sprite[i].step == step) {
+            sprite = &g_hand_sprite[i];
+            break;
+        }
+    }
+
+    if (sprite == NULL)
+        sprite = hand_sprite_render(src, step);
+    if (sprite != NULL)
+        sprite->used = ++g_hand_stamp;
+
+    return sprite;
+}
+
+/**
+* show a hand by lv_img transform, when there is no sprite for it
+*/
+static void hand_show_transform(ic_hand_t *hand, uint16_t angle)
+{
+    if (hand->sprite != NULL || lv_img_get_src(hand->obj) != hand->src) {
+        lv_img_set_src(hand->obj, hand->src);
+        lv_obj_set_pos(hand->obj, hand->center.x - hand->src->header.w / 2,
+                hand->center.y - hand->src->header.h / 2);
+        lv_img_set_antialias(hand->obj, true);
+    }
+    lv_img_set_angle(hand->obj, angle);
+}
+
+static void hand_sprite_put(ic_hand_t *hand)
+{
+    hand_sprite_t *sprite = hand->sprite;
+
+    if (sprite != NULL) {
+        sprite->ref--;
+        hand->sprite = NULL;
+    }
+}
+
+void ic_hand_init(ic_hand_t *hand, lv_obj_t *obj, const lv_img_dsc_t *src, lv_coord_t x, lv_coord_t y)
+{
+    hand->obj = obj;
+    hand->src = src;
+    hand->center.x = x;
+    hand->center.y = y;
+    hand->sprite = NULL;
+}
+
+void ic_hand_set_angle(ic_hand_t *hand, uint16_t angle)
+{
+    uint16_t step = (angle % 3600) / (3600 / IC_CLOCKFACE_HAND_STEPS);
+    hand_sprite_t *sprite = hand->sprite;
+
+    if (hand->obj == NULL || hand->src == NULL)
+        return;
+    if (sprite != NULL && sprite->step == step)
+        return;
+
+    sprite = hand_sprite_get(hand->src, step);
+    if (sprite == NULL) {
+        hand_show_transform(hand, angle);
+        hand_sprite_put(hand);
+        return;
+    }
+
+    //the old sprite is kept until the new one is set to lv_img
+    sprite->ref++;
+    if (hand->sprite == NULL)
+        lv_img_set_angle(hand->obj, 0);
+    lv_img_set_src(hand->obj, &sprite->img);
+    lv_obj_set_pos(hand->obj, hand->center.x + sprite->ofs.x, hand->center.y + sprite->ofs.y);
+    hand_sprite_put(hand);
+    hand->sprite = sprite;
+}
+
+void ic_hand_deinit(ic_hand_t *hand)
+{
+    hand_sprite_put(hand);
+    hand->obj = NULL;
+}
+
+void ic_hand_cache_clean(void)
+{
+    int i;
+
+    for (i = 0; i < IC_CLOCKFACE_HAND_CACHE_NUM; i++) {
+        if (g_hand_sprite[i].src != NULL && g_hand_sprite[i].ref == 0)
+            hand_sprite_drop(&g_hand_sprite[i]);
+    }
+}
+
+#else /* IC_CLOCKFACE_HAND_CACHE */
+
+void ic_hand_init(ic_hand_t *hand, lv_obj_t *obj, const lv_img_dsc_t *src, lv_coord_t x, lv_coord_t y)
+{
+    hand->obj = obj;
+    hand->src = src;
+    hand->center.x = x;
+    hand->center.y = y;
+    hand->sprite = NULL;
+
+    lv_img_set_src(obj, src);
+    lv_obj_set_pos(obj, x - src->header.w / 2, y - src->header.h / 2);
+    lv_img_set_antialias(obj, true);
+}
+
+void ic_hand_set_angle(ic_hand_t *hand, uint16_t angle)
+{
+    if (hand->obj == NULL || hand->src == NULL)
+        return;
+
+    //this api will cost too much cpu time
+    lv_img_set_angle(hand->obj, angle);
+}
+
+void ic_hand_deinit(ic_hand_t *hand)
+{
+    hand->obj = NULL;
+}
+
+void ic_hand_cache_clean(void)
+{
+}
+
+#endif /* IC_CLOCKFACE_HAND_CACHE */
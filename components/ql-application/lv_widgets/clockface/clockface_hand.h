@@ -0,0 +1,50 @@
+#ifndef __CLOCKFACE_HAND_H__
+#define __CLOCKFACE_HAND_H__
+
+#ifdef PLATFORM_EC600
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+#include "clockface_config.h"
+
+/**
+* An analog hand. The hand image is vertical with the pivot at its center,
+* the same as lv_img_set_angle used by clockface.
+*/
+typedef struct
+{
+    lv_obj_t *obj;            //lv_img to show the hand
+    const lv_img_dsc_t *src;  //hand image
+    lv_point_t center;        //pivot position on parent
+    void *sprite;             //shown sprite, NULL when not from cache
+}ic_hand_t;
+
+/**
+* bind a hand to an lv_img, the hand is not shown until ic_hand_set_angle
+* @param hand the hand
+* @param obj an lv_img
+* @param src hand image
+* @param x, y pivot position on parent of obj
+*/
+extern void ic_hand_init(ic_hand_t *hand, lv_obj_t *obj, const lv_img_dsc_t *src, lv_coord_t x, lv_coord_t y);
+
+/**
+* rotate a hand, only the old and new bounding boxes are invalidated
+* @param hand the hand
+* @param angle angle in 0.1 degree, as lv_img_set_angle
+*/
+extern void ic_hand_set_angle(ic_hand_t *hand, uint16_t angle);
+
+/**
+* release the sprite of a hand, call it before obj of the hand is deleted
+*/
+extern void ic_hand_deinit(ic_hand_t *hand);
+
+/**
+* drop all sprites not shown by any hand
+*/
+extern void ic_hand_cache_clean(void);
+
+#endif
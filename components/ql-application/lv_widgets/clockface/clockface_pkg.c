@@ -0,0 +1,285 @@
+/**
+* @FileName:   clockface_pkg.c
+* @Descripton: clockface package in file system
+*
+* Images of a package are lv_img_dsc_t of LV_IMG_CF_USER_ENCODED_0, the
+* built-in decoder refuses them, and the package decoder reads their rows
+* from the package file by read_line. The package file is kept open while
+* the package is loaded, so drawing an image doesn't open the file.
+*/
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+
+#include "ic_widgets_inc.h"
+
+#include "clockface_pkg.h"
+#include "image_pack.h"
+
+#ifdef IC_CLOCKFACE_PKG
+
+#define CF_PKG_IMG_CF   LV_IMG_CF_USER_ENCODED_0
+
+struct cf_pkg;
+
+typedef struct
+{
+    lv_img_dsc_t dsc;     //header.cf is CF_PKG_IMG_CF, data is unused
+    struct cf_pkg *pkg;
+    uint32_t offset;      //payload offset in package
+    lv_img_cf_t cf;       //color format of payload
+}cf_pkg_img_t;
+
+typedef struct cf_pkg
+{
+    clockface_t desc;     //first, desc is the handle of package
+    lv_fs_file_t file;
+    uint32_t count;
+    cf_pkg_img_t img[];
+}cf_pkg_t;
+
+static lv_img_decoder_t *g_cf_pkg_decoder;
+
+static uint8_t cf_pkg_px_size(lv_img_cf_t cf)
+{
+    return lv_img_cf_get_px_size(cf) >> 3;
+}
+
+static cf_pkg_img_t *cf_pkg_get_img(const void *src)
+{
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE)
+        return NULL;
+    if (((const lv_img_dsc_t *)src)->header.cf != CF_PKG_IMG_CF)
+        return NULL;
+    return (cf_pkg_img_t *)src;
+}
+
+/*******************************************************
+ *
+ * image decoder, pixels are read from file row by row
+ ******************************************************/
+static lv_res_t cf_pkg_decoder_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header)
+{
+    cf_pkg_img_t *img = cf_pkg_get_img(src);
+
+    if (img == NULL)
+        return LV_RES_INV;
+
+    header->always_zero = 0;
+    header->w = img->dsc.header.w;
+    header->h = img->dsc.header.h;
+    header->cf = img->cf;
+    return LV_RES_OK;
+}
+
+static lv_res_t cf_pkg_decoder_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    cf_pkg_img_t *img = cf_pkg_get_img(dsc->src);
+
+    if (img == NULL)
+        return LV_RES_INV;
+
+    dsc->header.cf = img->cf;
+    dsc->img_data = NULL; //read_line is used
+    dsc->user_data = img;
+    return LV_RES_OK;
+}
+
+static lv_res_t cf_pkg_decoder_read_line(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc,
+        lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t *buf)
+{
+    cf_pkg_img_t *img = (cf_pkg_img_t *)dsc->user_data;
+    uint8_t px_size = cf_pkg_px_size(img->cf);
+    uint32_t pos = img->offset + ((uint32_t)y * img->dsc.header.w + x) * px_size;
+    uint32_t size = (uint32_t)len * px_size;
+    uint32_t rn = 0;
+
+    if (lv_fs_seek(&img->pkg->file, pos) != LV_FS_RES_OK)
+        return LV_RES_INV;
+    if (lv_fs_read(&img->pkg->file, buf, size, &rn) != LV_FS_RES_OK || rn != size)
+        return LV_RES_INV;
+
+    return LV_RES_OK;
+}
+
+static void cf_pkg_decoder_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc)
+{
+    dsc->user_data = NULL;
+}
+
+static bool cf_pkg_decoder_init(void)
+{
+    if (g_cf_pkg_decoder != NULL)
+        return true;
+
+    g_cf_pkg_decoder = lv_img_decoder_create();
+    if (g_cf_pkg_decoder == NULL)
+        return false;
+
+    lv_img_decoder_set_info_cb(g_cf_pkg_decoder, cf_pkg_decoder_info);
+    lv_img_decoder_set_open_cb(g_cf_pkg_decoder, cf_pkg_decoder_open);
+    lv_img_decoder_set_read_line_cb(g_cf_pkg_decoder, cf_pkg_decoder_read_line);
+    lv_img_decoder_set_close_cb(g_cf_pkg_decoder, cf_pkg_decoder_close);
+    return true;
+}
+
+/*******************************************************
+ *
+ * package loader
+ ******************************************************/
+static bool cf_pkg_read(lv_fs_file_t *file, void *buf, uint32_t size)
+{
+    uint32_t rn = 0;
+
+    return lv_fs_read(file, buf, size, &rn) == LV_FS_RES_OK && rn == size;
+}
+
+static void *cf_pkg_img_src(cf_pkg_t *pkg, uint16_t index)
+{
+    if (index == CF_PKG_IMG_NONE || index >= pkg->count)
+        return NULL;
+    return &pkg->img[index];
+}
+
+static bool cf_pkg_set_img(cf_pkg_t *pkg, lv_image_res_t *res, uint16_t index)
+{
+    res->type = CF_IMAGE_FS_IMG;
+    res->img_src = cf_pkg_img_src(pkg, index);
+    return res->img_src != NULL;
+}
+
+/******************************************************************************
+ *  Function    -  ic_clockface_pkg_load
+ *
+ *  Purpose     -  load clockface descriptor from package file
+ *
+ *  Description -  Only the descriptor and image entries are read, images
+ *                 are read when drawn. The package is checked against its
+ *                 file size, so a partial download is refused.
+ *
+ ******************************************************************************/
+clockface_t *ic_clockface_pkg_load(const char *path)
+{
+    lv_fs_file_t file;
+    cf_pkg_header_t hdr;
+    cf_pkg_face_t face;
+    uint32_t file_size = 0;
+    cf_pkg_t *pkg = NULL;
+    clockface_t *desc;
+    uint32_t i;
+
+    if (!cf_pkg_decoder_init())
+        return NULL;
+
+    if (lv_fs_open(&file, path, LV_FS_MODE_RD) != LV_FS_RES_OK) {
+        LOGI("no clockface package %s\n", path);
+        return NULL;
+    }
+
+    if (!cf_pkg_read(&file, &hdr, sizeof(hdr)) || hdr.magic != CF_PKG_MAGIC ||
+            hdr.version != CF_PKG_VERSION || hdr.count == 0 || hdr.count >= CF_PKG_IMG_NONE ||
+            lv_fs_size(&file, &file_size) != LV_FS_RES_OK || file_size < hdr.size) {
+        LOGE("invalid clockface package %s\n", path);
+        goto fail;
+    }
+
+    if (!cf_pkg_read(&file, &face, sizeof(face)) || face.type != CLOCK_ANALOG) {
+        LOGE("clockface package %s type not supported\n", path);
+        goto fail;
+    }
+
+    pkg = lv_mem_alloc(sizeof(cf_pkg_t) + hdr.count * sizeof(cf_pkg_img_t));
+    if (pkg == NULL)
+        goto fail;
+    memset(pkg, 0, sizeof(cf_pkg_t) + hdr.count * sizeof(cf_pkg_img_t));
+    pkg->count = hdr.count;
+
+    for (i = 0; i < hdr.count; i++) {
+        image_pack_entry_t entry;
+        lv_img_header_t header;
+        cf_pkg_img_t *img = &pkg->img[i];
+
+        if (!cf_pkg_read(&file, &entry, sizeof(entry)))
+            goto fail;
+
+        memcpy(&header, &entry.header, sizeof(header));
+        if (header.cf != LV_IMG_CF_TRUE_COLOR && header.cf != LV_IMG_CF_TRUE_COLOR_ALPHA &&
+                header.cf != LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED) {
+            LOGE("clockface package image %d cf %d not supported\n", i, header.cf);
+            goto fail;
+        }
+        if (entry.offset > hdr.size || entry.size > hdr.size - entry.offset ||
+                entry.size < (uint32_t)header.w * header.h * cf_pkg_px_size(header.cf)) {
+            LOGE("clockface package image %d out of range\n", i);
+            goto fail;
+        }
+
+        img->dsc.header.always_zero = 0;
+        img->dsc.header.w = header.w;
+        img->dsc.header.h = header.h;
+        img->dsc.header.cf = CF_PKG_IMG_CF;
+        img->dsc.data_size = entry.size;
+        img->dsc.data = NULL;
+        img->pkg = pkg;
+        img->offset = entry.offset;
+        img->cf = header.cf;
+    }
+
+    //descriptor, the same as builtin clockface with images in file
+    desc = &pkg->desc;
+
+    desc->domain = CLOCKFACE_DOMAIN_ICC;
+    desc->version = hdr.version;
+    desc->type = CLOCK_ANALOG;
+
+    if (face.bg == CF_PKG_IMG_NONE) {
+        desc->bg.type = CF_IMAGE_NONE;
+    }
+    else {
+        desc->bg.type = CF_IMAGE_FS_IMG;
+        if (!cf_pkg_set_img(pkg, &desc->bg.img, face.bg))
+            goto fail;
+    }
+    desc->bg.pos = face.bg_pos;
+
+    desc->analog.has_position = 1;
+    desc->analog.center = face.center;
+    desc->analog.hour.exist = 1;
+    desc->analog.minute.exist = 1;
+    if (!cf_pkg_set_img(pkg, &desc->analog.hour.img, face.hour) ||
+            !cf_pkg_set_img(pkg, &desc->analog.minute.img, face.minute))
+        goto fail;
+    if (face.second != CF_PKG_IMG_NONE) {
+        desc->analog.second.exist = 1;
+        if (!cf_pkg_set_img(pkg, &desc->analog.second.img, face.second))
+            goto fail;
+    }
+
+    pkg->file = file;
+    LOGI("clockface package %s loaded, %d images\n", path, hdr.count);
+    return desc;
+
+fail:
+    lv_fs_close(&file);
+    if (pkg != NULL)
+        lv_mem_free(pkg);
+    return NULL;
+}
+
+void ic_clockface_pkg_unload(clockface_t *desc)
+{
+    cf_pkg_t *pkg = (cf_pkg_t *)desc;
+    uint32_t i;
+
+    if (pkg == NULL)
+        return;
+
+    //drop decoded images in cache before they are freed
+    for (i = 0; i < pkg->count; i++)
+        lv_img_cache_invalidate_src(&pkg->img[i]);
+
+    lv_fs_close(&pkg->file);
+    lv_mem_free(pkg);
+}
+
+#endif /* IC_CLOCKFACE_PKG */
@@ -0,0 +1,60 @@
+#ifndef __CLOCKFACE_PKG_H__
+#define __CLOCKFACE_PKG_H__
+
+#include "stdint.h"
+
+#include "clockface.h"
+
+/*
+ * Clockface package, a clockface descriptor and its images in one file,
+ * generated by "image_gen.py -f clockface", little endian:
+ *
+ *   cf_pkg_header_t
+ *   cf_pkg_face_t
+ *   image_pack_entry_t[count], the same entry as image pack
+ *   payloads, each starts at CF_PKG_ALIGN
+ *
+ * Payload is the pixels of LVGL binary image without the 4 bytes header.
+ * Only true_color, true_color_alpha and true_color_chroma are supported,
+ * so a row can be read from file directly.
+ *
+ * Images are not loaded into RAM, they are decoded row by row from the
+ * file when drawn. So the RAM of a clockface is a few rows, whatever the
+ * size of the screen.
+ */
+#define CF_PKG_MAGIC        0x4b504643 // "CFPK"
+#define CF_PKG_VERSION      1
+#define CF_PKG_ALIGN        4
+#define CF_PKG_IMG_NONE     0xffff     // no image
+
+typedef struct {
+    uint32_t magic;   // CF_PKG_MAGIC
+    uint32_t version; // CF_PKG_VERSION
+    uint32_t count;   // image count
+    uint32_t size;    // whole package size, including header
+} cf_pkg_header_t;
+
+typedef struct {
+    uint8_t type;        // clock_type_enum, only CLOCK_ANALOG now
+    uint8_t reserved[3];
+    uint16_t bg;         // background image index, CF_PKG_IMG_NONE for black
+    uint16_t hour;       // hand image index
+    uint16_t minute;     // hand image index
+    uint16_t second;     // hand image index, CF_PKG_IMG_NONE for no second hand
+    position_t bg_pos;   // background position
+    position_t center;   // hand pivot position
+} cf_pkg_face_t;
+
+/**
+* load a clockface package
+* @param path lvgl file path, like "U:clockface.cfp"
+* @return clockface descriptor for ic_clockface_create, NULL on failure
+*/
+extern clockface_t *ic_clockface_pkg_load(const char *path);
+
+/**
+* unload a clockface package, after the clockface is deleted
+*/
+extern void ic_clockface_pkg_unload(clockface_t *desc);
+
+#endif
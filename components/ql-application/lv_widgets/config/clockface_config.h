@@ -0,0 +1,37 @@
+#ifndef __CLOCKFACE_CONFIG_H__
+#define __CLOCKFACE_CONFIG_H__
+
+/*
+ * Draw analog hands from pre-rotated sprites, rather than rotating the hand
+ * image with lv_img_set_angle at each refresh. A sprite is rendered once for
+ * an angle step on demand, and kept in the hand cache, so the refresh of a
+ * hand is a plain blit of its bounding box.
+ *
+ * Undefine it to fall back to LVGL image transform.
+ */
+#define IC_CLOCKFACE_HAND_CACHE
+
+/*
+ * Angle steps of a hand on the dial, 60 steps is 6 degrees per step, which
+ * matches the resolution of clockface_get_analog_clock_angle.
+ */
+#define IC_CLOCKFACE_HAND_STEPS       (60)
+
+/*
+ * Memory and slots of the hand cache. The least recently used sprite is
+ * dropped when it is full. Make it large enough to hold all steps of the
+ * second hand, otherwise each second a sprite is rendered again.
+ */
+#define IC_CLOCKFACE_HAND_CACHE_SIZE  (512 * 1024)
+#define IC_CLOCKFACE_HAND_CACHE_NUM   (IC_CLOCKFACE_HAND_STEPS + 8)
+
+/*
+ * Clockface package in file system, generated by "image_gen.py -f
+ * clockface". When the package exists at IC_CLOCKFACE_PKG_PATH, it is shown
+ * rather than the builtin clockfaces, so a clockface can be installed by
+ * downloading the file, without firmware upgrade.
+ */
+#define IC_CLOCKFACE_PKG
+#define IC_CLOCKFACE_PKG_PATH         "U:clockface.cfp"
+
+#endif
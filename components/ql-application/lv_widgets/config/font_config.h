@@ -0,0 +1,35 @@
+#ifndef __FONT_CONFIG_H__
+#define __FONT_CONFIG_H__
+
+/*
+ * Cache glyph bitmaps of compressed fonts. Each glyph draw of a compressed
+ * lv_font_fmt_txt font decompresses its RLE bitmap again, and a screen of
+ * CJK text draws hundreds of them at each refresh. Glyphs are kept in an
+ * LRU per font, so a large CJK font doesn't evict the glyphs of others.
+ *
+ * Undefine it to decompress at each draw as before.
+ */
+#define IC_FONT_GLYPH_CACHE
+
+/*
+ * Memory of the glyph cache of a font, and the fonts with glyph cache.
+ * A 16px glyph in 4 bpp is 128 bytes, so 64KB holds 500 CJK glyphs.
+ */
+#define IC_FONT_GLYPH_CACHE_SIZE      (64 * 1024)
+#define IC_FONT_GLYPH_CACHE_NUM       (4)
+
+/*
+ * CJK font in file system, "lv_font_conv --format bin" with compression,
+ * loaded by lv_font_load when the locale is used. It takes the place of the
+ * builtin fonts of the locale, which have no CJK glyphs. So fonts can be
+ * changed without firmware upgrade, and glyphs stay compressed in RAM.
+ */
+#define IC_FONT_CJK_PATH              "U:font_cjk.bin"
+
+/*
+ * Preload glyphs of the most common characters of the locale into the glyph
+ * cache at locale change, so the first screens of text are not slow.
+ */
+#define IC_FONT_PRELOAD
+
+#endif
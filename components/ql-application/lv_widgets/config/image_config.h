@@ -0,0 +1,23 @@
+#ifndef __IMAGE_CONFIG_H__
+#define __IMAGE_CONFIG_H__
+
+/*
+ * Load images from the image pack in flash, rather than C arrays linked
+ * into firmware. The pack is generated by "image_gen.py -f pack" from the
+ * same csv file, and downloaded to IC_IMAGE_PACK_FLASH_ADDRESS on its own.
+ * Then clockfaces can be changed without relinking firmware.
+ *
+ * The pack is accessed in place through XIP, so it is only for target.
+ */
+#if defined(PLATFORM_EC600)
+//#define IC_IMAGE_PACK
+#endif
+
+/*
+ * Reserved flash for image pack, the tail of loadable app image region by
+ * default. Make sure it doesn't overlap with the app image.
+ */
+#define IC_IMAGE_PACK_FLASH_SIZE     (0x100000)
+#define IC_IMAGE_PACK_FLASH_ADDRESS  (CONFIG_APPIMG_FLASH_ADDRESS + CONFIG_APPIMG_FLASH_SIZE - IC_IMAGE_PACK_FLASH_SIZE)
+
+#endif
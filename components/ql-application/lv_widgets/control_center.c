@@ -228,7 +228,7 @@ lv_obj_t* ic_control_center_create(lv_obj_t* parent, lv_style_t* style)
     lv_obj_add_style(date, LV_OBJ_PART_MAIN, &date_style);
     lv_obj_align(date, NULL, LV_ALIGN_IN_TOP_MID, 0, 10);
 
-    lv_label_set_text(date, _("12/17"));
+    lv_label_set_text(date, _i(LV_I18N_ID_12_17));
 
     //week area
     lv_obj_t* week = lv_label_create(controller, NULL);
@@ -244,7 +244,7 @@ lv_obj_t* ic_control_center_create(lv_obj_t* parent, lv_style_t* style)
     lv_obj_add_style(week, LV_OBJ_PART_MAIN, &week_style);
     lv_obj_align(week, NULL, LV_ALIGN_IN_TOP_MID, 0, 52);
 
-    lv_label_set_text(week, _("Tue"));
+    lv_label_set_text(week, _i(LV_I18N_ID_TUE));
     
     //infos
 
@@ -269,7 +269,7 @@ lv_obj_t* ic_infocard_create(lv_obj_t* parent, lv_style_t* style)
     lv_style_set_border_width(&title_style, LV_STATE_DEFAULT, 0);
 
     screen_title_bar_desc_t title_desc;
-    title_desc.title = _("Info Cards");
+    title_desc.title = _i(LV_I18N_ID_INFO_CARDS);
     title_desc.title_style = &title_style;
     ic_watch_create_title_bar(card, &title_desc);
 
@@ -293,7 +293,7 @@ lv_obj_t* ic_infocard_create(lv_obj_t* parent, lv_style_t* style)
 
     card_desc_t card_desc;
     card_desc.style = &card_style;
-    card_desc.title = _("Alarm");
+    card_desc.title = _i(LV_I18N_ID_ALARM);
     
     lv_obj_t* alarm = ic_create_card(card_grp, &card_desc);
     
@@ -303,7 +303,7 @@ lv_obj_t* ic_infocard_create(lv_obj_t* parent, lv_style_t* style)
 
     card_desc_t sp_desc;
     sp_desc.style = &card_style;
-    sp_desc.title = _("Sport");
+    sp_desc.title = _i(LV_I18N_ID_SPORT);
 
     lv_obj_t* sport = ic_create_card(card_grp, &sp_desc);
 
@@ -314,7 +314,7 @@ lv_obj_t* ic_infocard_create(lv_obj_t* parent, lv_style_t* style)
 
     card_desc_t ex_desc1;
     ex_desc1.style = &card_style;
-    ex_desc1.title = _("example1");
+    ex_desc1.title = _i(LV_I18N_ID_EXAMPLE1);
 
     lv_obj_t* example1 = ic_create_card(card_grp, &ex_desc1);
 
@@ -325,7 +325,7 @@ lv_obj_t* ic_infocard_create(lv_obj_t* parent, lv_style_t* style)
 
     card_desc_t ex_desc2;
     ex_desc2.style = &card_style;
-    ex_desc2.title = _("example2");
+    ex_desc2.title = _i(LV_I18N_ID_EXAMPLE2);
 
     lv_obj_t* example2 = ic_create_card(card_grp, &ex_desc2);
 
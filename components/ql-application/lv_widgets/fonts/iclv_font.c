@@ -7,15 +7,34 @@
 */
 #include "ic_widgets_inc.h"
 
+#include "iclv_font_cache.h"
+
 typedef struct {
    char *locale;
    lv_font_t * fonts[IC_FONT_NUM];
+   const char *path;        //font in file system for all sizes, NULL for none
+   const char *preload;     //common characters of the locale, glyphs are preloaded
 }ic_locale_font_t;
 
 
 //font declauration
 LV_FONT_DECLARE(opposans_14);
 
+#if defined(IC_LANGUAGE_CHINESE_SM)
+//the most common simplified chinese characters, in frequency order
+static const char ic_font_preload_zh_cn[] =
+    "的一是不了在人有我他这个们中来上大为和国地到以说时要就出会可"
+    "也你对生能而子那得于着下自之年过发后作里用道行所然家种事成方"
+    "多经么去法学如都同现当没动面起看定天分还进好小部其些主样理心"
+    "她本前开但因只从想实日军者意无力它与长把机十民第公此已工使情"
+    "明性知全三又关点正业外将两高间由问很最重并物手应战向头文体政"
+    "美相见被利什二等产或新己制身果加西斯月话合回特代内信表化老给"
+    "世位次度门任常先海通教儿原东声提立及比员解水名真论处走义各入"
+    "几口认条平系气题活尔更别打女变四神总何电数安少报才结反受目太"
+    "量再感建务做接必场件计管期市直德资命山金指克许统区保至队形社"
+    "便空决治展马科司五基眼书非则听白却界达光放强即像难且权思王象";
+#endif
+
 static const ic_locale_font_t ic_font_list[] = 
 {
     //default language
@@ -28,6 +47,8 @@ static const ic_locale_font_t ic_font_list[] =
             &opposans_14,         //IC_FONT_MEDIUM
             &opposans_14,         //IC_FONT_SMALL
         },
+        NULL,
+        NULL,
     },
 
 #if defined(IC_LANGUAGE_CHINESE_SM)
@@ -40,20 +61,95 @@ static const ic_locale_font_t ic_font_list[] =
             &opposans_14,         //IC_FONT_MEDIUM
             &opposans_14,         //IC_FONT_SMALL
         },
+#ifdef IC_FONT_CJK_PATH
+        IC_FONT_CJK_PATH,
+#else
+        NULL,
+#endif
+        ic_font_preload_zh_cn,
     },
 #endif
 };
 
-lv_font_t * ic_font_get(ic_font_enum id)
+#define IC_FONT_LOCALE_NUM  (sizeof(ic_font_list)/sizeof(ic_locale_font_t))
+
+//fonts loaded from file system, NULL when not loaded
+static lv_font_t *ic_font_loaded[IC_FONT_LOCALE_NUM];
+static bool ic_font_load_tried[IC_FONT_LOCALE_NUM];
+
+static int ic_font_locale_index(void)
 {
-    char *locale =  lv_i18n_get_current_locale();
-    int i =0;
+    const char *locale = lv_i18n_get_current_locale();
+    int i = 0;
 
-    for(i = 0; i < sizeof(ic_font_list)/sizeof(ic_locale_font_t); i++){
+    for(i = 0; locale != NULL && i < IC_FONT_LOCALE_NUM; i++){
         if(strcmp(locale, ic_font_list[i].locale) == 0){
-            return ic_font_list[i].fonts[id];
+            return i;
         }
     }
 
-    return ic_font_list[0].fonts[id];
+    return 0;
+}
+
+lv_font_t * ic_font_get(ic_font_enum id)
+{
+    int i = ic_font_locale_index();
+
+    if(ic_font_loaded[i] != NULL)
+        return ic_font_loaded[i];
+
+    return ic_font_list[i].fonts[id];
+}
+
+/******************************************************************************
+ *  Function    -  ic_font_init
+ *
+ *  Purpose     -  attach glyph caches to builtin fonts, and prepare fonts
+ *                 of the current locale
+ *
+ ******************************************************************************/
+void ic_font_init(void)
+{
+    int i, j;
+
+    //attach skips fonts not compressed, or already attached
+    for(i = 0; i < IC_FONT_LOCALE_NUM; i++){
+        for(j = 0; j < IC_FONT_NUM; j++){
+            ic_font_cache_attach(ic_font_list[i].fonts[j], IC_FONT_GLYPH_CACHE_SIZE);
+        }
+    }
+
+    ic_font_locale_changed();
+}
+
+/******************************************************************************
+ *  Function    -  ic_font_locale_changed
+ *
+ *  Purpose     -  load the font in file system of the current locale, and
+ *                 preload glyphs of its common characters
+ *
+ *  Description -  The font is loaded at the first use of the locale, and
+ *                 kept, since styles of created objects may refer to it.
+ *
+ ******************************************************************************/
+void ic_font_locale_changed(void)
+{
+    int i = ic_font_locale_index();
+
+    if(ic_font_list[i].path != NULL && !ic_font_load_tried[i]){
+        ic_font_load_tried[i] = true;
+        ic_font_loaded[i] = lv_font_load(ic_font_list[i].path);
+        if(ic_font_loaded[i] == NULL){
+            LOGI("no font %s for %s\n", ic_font_list[i].path, ic_font_list[i].locale);
+        }
+        else{
+            ic_font_cache_attach(ic_font_loaded[i], IC_FONT_GLYPH_CACHE_SIZE);
+        }
+    }
+
+#ifdef IC_FONT_PRELOAD
+    if(ic_font_list[i].preload != NULL){
+        ic_font_cache_preload(ic_font_get(IC_FONT_SMALL), ic_font_list[i].preload);
+    }
+#endif
 }
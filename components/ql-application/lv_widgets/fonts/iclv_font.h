@@ -21,4 +21,9 @@ typedef enum{
 }ic_font_enum;
 
 extern lv_font_t * ic_font_get(ic_font_enum id);
+
+//attach glyph caches and prepare fonts of the current locale, call it after file system is ready
+extern void ic_font_init(void);
+//load font and preload glyphs of the current locale, call it after lv_i18n_set_locale
+extern void ic_font_locale_changed(void);
 #endif
@@ -0,0 +1,247 @@
+/**
+* @FileName:   iclv_font_cache.c
+* @Descripton: glyph bitmap cache of compressed fonts
+*
+* get_glyph_bitmap of a font is wrapped. A decompressed bitmap is copied
+* into a glyph entry, found by letter in a hash table, and the least
+* recently drawn glyph is dropped when the memory of the font is used up.
+*/
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+
+#include "ic_widgets_inc.h"
+
+#include "iclv_font_cache.h"
+
+#ifdef IC_FONT_GLYPH_CACHE
+
+#define FONT_CACHE_HASH_NUM   (64)    //power of 2
+
+typedef const uint8_t *(*font_get_bitmap_cb_t)(const lv_font_t *, uint32_t);
+
+typedef struct glyph_entry
+{
+    struct glyph_entry *hash_next;
+    struct glyph_entry *prev;         //LRU list, head is the most recent
+    struct glyph_entry *next;
+    uint32_t letter;
+    uint32_t size;                    //bitmap size
+    uint8_t bitmap[];
+}glyph_entry_t;
+
+typedef struct
+{
+    lv_font_t *font;                  //NULL for a free cache
+    font_get_bitmap_cb_t get_bitmap;  //get_glyph_bitmap of the font
+    uint32_t size;                    //memory limit
+    uint32_t used;                    //memory of all entries
+    glyph_entry_t lru;                //list head, lru.prev is the least recent
+    glyph_entry_t *hash[FONT_CACHE_HASH_NUM];
+}font_cache_t;
+
+static font_cache_t g_font_cache[IC_FONT_GLYPH_CACHE_NUM];
+
+static font_cache_t *font_cache_find(const lv_font_t *font)
+{
+    uint32_t i;
+
+    for (i = 0; i < IC_FONT_GLYPH_CACHE_NUM; i++) {
+        if (g_font_cache[i].font == font)
+            return &g_font_cache[i];
+    }
+    return NULL;
+}
+
+static glyph_entry_t **font_cache_slot(font_cache_t *cache, uint32_t letter)
+{
+    return &cache->hash[letter & (FONT_CACHE_HASH_NUM - 1)];
+}
+
+static void font_cache_lru_unlink(glyph_entry_t *entry)
+{
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+}
+
+static void font_cache_lru_push(font_cache_t *cache, glyph_entry_t *entry)
+{
+    entry->prev = &cache->lru;
+    entry->next = cache->lru.next;
+    cache->lru.next->prev = entry;
+    cache->lru.next = entry;
+}
+
+static void font_cache_drop(font_cache_t *cache, glyph_entry_t *entry)
+{
+    glyph_entry_t **p = font_cache_slot(cache, entry->letter);
+
+    while (*p != entry)
+        p = &(*p)->hash_next;
+    *p = entry->hash_next;
+
+    font_cache_lru_unlink(entry);
+    cache->used -= sizeof(glyph_entry_t) + entry->size;
+    lv_mem_free(entry);
+}
+
+/*Size of decompressed bitmap, the same as lv_font_get_bitmap_fmt_txt, 3 bpp is stored in 4 bpp*/
+static uint32_t font_cache_bitmap_size(const lv_font_t *font, uint32_t letter)
+{
+    lv_font_glyph_dsc_t dsc;
+    uint32_t bpp;
+
+    if (!font->get_glyph_dsc(font, &dsc, letter, 0))
+        return 0;
+
+    bpp = dsc.bpp == 3 ? 4 : dsc.bpp;
+    return ((uint32_t)dsc.box_w * dsc.box_h * bpp + 7) >> 3;
+}
+
+static glyph_entry_t *font_cache_get(font_cache_t *cache, uint32_t letter, bool evict)
+{
+    glyph_entry_t *entry;
+    const uint8_t *bitmap;
+    uint32_t size;
+
+    for (entry = *font_cache_slot(cache, letter); entry != NULL; entry = entry->hash_next) {
+        if (entry->letter == letter) {
+            font_cache_lru_unlink(entry);
+            font_cache_lru_push(cache, entry);
+            return entry;
+        }
+    }
+
+    size = font_cache_bitmap_size(cache->font, letter);
+    if (size == 0 || sizeof(glyph_entry_t) + size > cache->size)
+        return NULL;
+
+    while (cache->used + sizeof(glyph_entry_t) + size > cache->size) {
+        if (!evict)
+            return NULL;
+        font_cache_drop(cache, cache->lru.prev);
+    }
+
+    //the decompressed bitmap is valid till the next call only
+    bitmap = cache->get_bitmap(cache->font, letter);
+    if (bitmap == NULL)
+        return NULL;
+
+    entry = lv_mem_alloc(sizeof(glyph_entry_t) + size);
+    if (entry == NULL)
+        return NULL;
+
+    entry->letter = letter;
+    entry->size = size;
+    memcpy(entry->bitmap, bitmap, size);
+    entry->hash_next = *font_cache_slot(cache, letter);
+    *font_cache_slot(cache, letter) = entry;
+    font_cache_lru_push(cache, entry);
+    cache->used += sizeof(glyph_entry_t) + size;
+    return entry;
+}
+
+static const uint8_t *font_cache_get_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    font_cache_t *cache = font_cache_find(font);
+    glyph_entry_t *entry;
+
+    if (cache == NULL)
+        return NULL;
+
+    //tab is drawn as space, the same as lv_font_get_bitmap_fmt_txt
+    if (letter == '\t')
+        letter = ' ';
+
+    entry = font_cache_get(cache, letter, true);
+    if (entry == NULL)
+        return cache->get_bitmap(font, letter);
+
+    return entry->bitmap;
+}
+
+bool ic_font_cache_attach(lv_font_t *font, uint32_t size)
+{
+    const lv_font_fmt_txt_dsc_t *fdsc;
+    font_cache_t *cache;
+
+    if (font == NULL || font->get_glyph_bitmap != lv_font_get_bitmap_fmt_txt)
+        return false;
+
+    fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+    if (fdsc->bitmap_format == LV_FONT_FMT_TXT_PLAIN)
+        return false;
+
+    cache = font_cache_find(NULL);
+    if (cache == NULL) {
+        LOGE("no free font cache\n");
+        return false;
+    }
+
+    memset(cache, 0, sizeof(font_cache_t));
+    cache->font = font;
+    cache->get_bitmap = font->get_glyph_bitmap;
+    cache->size = size;
+    cache->lru.prev = &cache->lru;
+    cache->lru.next = &cache->lru;
+    font->get_glyph_bitmap = font_cache_get_bitmap;
+    return true;
+}
+
+void ic_font_cache_detach(lv_font_t *font)
+{
+    font_cache_t *cache;
+
+    if (font == NULL)
+        return;
+
+    cache = font_cache_find(font);
+    if (cache == NULL)
+        return;
+
+    while (cache->lru.next != &cache->lru)
+        font_cache_drop(cache, cache->lru.next);
+
+    font->get_glyph_bitmap = cache->get_bitmap;
+    cache->font = NULL;
+}
+
+uint32_t ic_font_cache_preload(lv_font_t *font, const char *txt)
+{
+    font_cache_t *cache = font_cache_find(font);
+    uint32_t i = 0;
+    uint32_t count = 0;
+
+    if (cache == NULL || txt == NULL)
+        return 0;
+
+    while (txt[i] != '\0') {
+        uint32_t letter = _lv_txt_encoded_next(txt, &i);
+
+        if (font_cache_get(cache, letter, false) != NULL)
+            count++;
+        else if (cache->used + sizeof(glyph_entry_t) >= cache->size)
+            break;
+    }
+
+    LOGI("font cache preload %d glyphs, %d bytes\n", count, cache->used);
+    return count;
+}
+
+#else
+
+bool ic_font_cache_attach(lv_font_t *font, uint32_t size)
+{
+    return false;
+}
+
+void ic_font_cache_detach(lv_font_t *font)
+{
+}
+
+uint32_t ic_font_cache_preload(lv_font_t *font, const char *txt)
+{
+    return 0;
+}
+
+#endif /* IC_FONT_GLYPH_CACHE */
@@ -0,0 +1,34 @@
+#ifndef __ICLV_FONT_CACHE_H__
+#define __ICLV_FONT_CACHE_H__
+
+#ifdef PLATFORM_EC600
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+#include "font_config.h"
+
+/**
+* cache glyph bitmaps of a font, get_glyph_bitmap of the font is replaced
+* @param font a compressed lv_font_fmt_txt font, plain fonts need no cache
+* @param size memory of the cache in bytes
+* @return true if the cache is attached
+*/
+extern bool ic_font_cache_attach(lv_font_t *font, uint32_t size);
+
+/**
+* drop the cache of a font and restore its get_glyph_bitmap, call it before
+* a loaded font is freed
+*/
+extern void ic_font_cache_detach(lv_font_t *font);
+
+/**
+* put glyphs of text into the cache, no glyph is evicted for them
+* @param font a font with cache
+* @param txt utf-8 text
+* @return count of glyphs put into the cache
+*/
+extern uint32_t ic_font_cache_preload(lv_font_t *font, const char *txt);
+
+#endif
@@ -8,4 +8,8 @@
 #define  __IC_HAL_H__
 
 #include "ic_hal_rtc.h"
+#include "ic_hal_fs.h"
+#include "ic_hal_aod.h"
+#include "ic_hal_mem.h"
+#include "ic_hal_sys.h"
 #endif
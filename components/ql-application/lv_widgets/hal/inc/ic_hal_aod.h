@@ -0,0 +1,25 @@
+/// @file ic_hal_aod.h
+/// @Synopsis: always-on display in screen off, drawn while lvgl is suspended
+/// @version V1.0
+
+#ifndef __IC_HAL_AOD_H__
+#define  __IC_HAL_AOD_H__
+
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+}ic_hal_aod_area_t;
+
+//draw by ic_hal_aod_flush, the screen is black when full, return ms to the next draw
+typedef uint32_t(* ic_hal_aod_draw_cb_t) (void *user_data, bool full);
+
+//show the area by draw_cb rather than turn off screen, draw_cb NULL to disable
+extern bool ic_hal_aod_set(const ic_hal_aod_area_t *area, ic_hal_aod_draw_cb_t draw_cb, void *user_data);
+
+//write RGB565 pixels of area to screen, only in draw_cb, buf can be reused at return
+extern bool ic_hal_aod_flush(const ic_hal_aod_area_t *area, const uint16_t *buf);
+
+#endif
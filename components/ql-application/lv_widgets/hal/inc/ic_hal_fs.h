@@ -0,0 +1,15 @@
+/// @file ic_hal_fs.h
+/// @Synopsis: file system of lvgl, for images and clockfaces in files
+/// @version V1.0
+
+#ifndef __IC_HAL_FS_H__
+#define  __IC_HAL_FS_H__
+
+//lvgl drive letters, path is like "U:clockface.cfp"
+#define IC_HAL_FS_UFS     'U'    //internal flash file system
+#define IC_HAL_FS_SD      'S'    //sd card
+
+//register file system drivers to lvgl, call it after lv_init
+extern bool ic_hal_fs_init(void);
+
+#endif
@@ -0,0 +1,19 @@
+/// @file ic_hal_mem.h
+/// @Synopsis: lvgl memory accounting of each screen
+/// @version V1.0
+
+#ifndef __IC_HAL_MEM_H__
+#define  __IC_HAL_MEM_H__
+
+//lvgl memory allocated later is accounted to arena, 0 for none, return the previous arena
+extern uint32_t ic_hal_mem_arena_set(uint32_t arena);
+
+//lvgl memory accounted to arena and not freed yet, 0 if not supported
+extern uint32_t ic_hal_mem_arena_used(uint32_t arena);
+
+typedef void(* ic_hal_mem_pressure_cb_t) (void);
+
+//cb is called in gui thread when system memory is low, caches should be dropped
+extern bool ic_hal_mem_pressure_register(ic_hal_mem_pressure_cb_t cb);
+
+#endif
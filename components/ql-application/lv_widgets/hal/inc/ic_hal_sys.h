@@ -0,0 +1,20 @@
+/// @file ic_hal_sys.h
+/// @Synopsis: gui thread, critical section and data sources of widgets
+/// @version V1.0
+
+#ifndef __IC_HAL_SYS_H__
+#define  __IC_HAL_SYS_H__
+
+typedef void(* ic_hal_call_cb_t) (void *user_data);
+
+//run cb in gui thread later, can be called in any thread
+extern bool ic_hal_gui_call(ic_hal_call_cb_t cb, void *user_data);
+
+//short critical section for data shared with other threads
+extern uint32_t ic_hal_enter_critical(void);
+extern void ic_hal_exit_critical(uint32_t critical);
+
+//start platform sources, such as battery and signal, publishing to ic_data only
+extern bool ic_hal_data_source_start(void);
+
+#endif
@@ -0,0 +1,49 @@
+/// @file ic_hal_aod.c
+/// @Synopsis:  always-on display adaptor for lvgl gui of 8910
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "ic_hal_aod.h"
+#include "lv_gui_main.h"
+
+/*******************************************************
+ *
+ * always-on display layer
+ ******************************************************/
+static void ic_hal_aod_to_lcd(const ic_hal_aod_area_t *area, drvLcdArea_t *roi)
+{
+    roi->x = area->x;
+    roi->y = area->y;
+    roi->w = area->w;
+    roi->h = area->h;
+}
+
+bool ic_hal_aod_set(const ic_hal_aod_area_t *area, ic_hal_aod_draw_cb_t draw_cb, void *user_data)
+{
+    drvLcdArea_t roi;
+
+    if (draw_cb == NULL) {
+        lvGuiSetAod(NULL, NULL, NULL);
+        return true;
+    }
+
+    if (area == NULL)
+        return false;
+
+    ic_hal_aod_to_lcd(area, &roi);
+    lvGuiSetAod(&roi, draw_cb, user_data);
+    return true;
+}
+
+bool ic_hal_aod_flush(const ic_hal_aod_area_t *area, const uint16_t *buf)
+{
+    drvLcdArea_t roi;
+
+    ic_hal_aod_to_lcd(area, &roi);
+    return lvGuiAodFlush(&roi, buf);
+}
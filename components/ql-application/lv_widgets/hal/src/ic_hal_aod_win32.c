@@ -0,0 +1,25 @@
+/// @file ic_hal_aod_win32.c
+/// @Synopsis:  always-on display adaptor for win32, screen is never turned off
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "ic_hal_aod.h"
+
+/*******************************************************
+ *
+ * always-on display layer
+ ******************************************************/
+bool ic_hal_aod_set(const ic_hal_aod_area_t *area, ic_hal_aod_draw_cb_t draw_cb, void *user_data)
+{
+    return false;
+}
+
+bool ic_hal_aod_flush(const ic_hal_aod_area_t *area, const uint16_t *buf)
+{
+    return false;
+}
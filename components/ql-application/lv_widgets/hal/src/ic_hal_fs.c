@@ -0,0 +1,148 @@
+/// @file ic_hal_fs.c
+/// @Synopsis:  lvgl file system adaptor for ql_fs
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "lvgl.h"
+
+#include "ic_hal_fs.h"
+#include "ql_fs.h"
+
+#define IC_HAL_FS_PATH_SIZE  (128)
+
+typedef struct
+{
+    QFILE fd;
+}ic_hal_file_t;
+
+/*******************************************************
+ *
+ * lvgl file system driver layer
+ ******************************************************/
+static lv_fs_res_t ic_hal_fs_open(lv_fs_drv_t *drv, void *file_p, const char *path, lv_fs_mode_t mode)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+    char name[IC_HAL_FS_PATH_SIZE];
+    const char *flag;
+
+    if (mode == LV_FS_MODE_WR)
+        flag = "wb";
+    else if (mode == (LV_FS_MODE_WR | LV_FS_MODE_RD))
+        flag = "rb+";
+    else
+        flag = "rb";
+
+    //lvgl drive letter to ql_fs disk name
+    snprintf(name, sizeof(name), "%s:%s", drv->letter == IC_HAL_FS_SD ? "SD" : "UFS", path);
+
+    file->fd = ql_fopen(name, flag);
+    if (file->fd <= 0)
+        return LV_FS_RES_NOT_EX;
+
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_close(lv_fs_drv_t *drv, void *file_p)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+
+    return ql_fclose(file->fd) == QL_FILE_OK ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+}
+
+static lv_fs_res_t ic_hal_fs_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+    int ret = ql_fread(buf, 1, btr, file->fd);
+
+    if (ret < 0) {
+        *br = 0;
+        return LV_FS_RES_HW_ERR;
+    }
+
+    *br = ret;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_write(lv_fs_drv_t *drv, void *file_p, const void *buf, uint32_t btw, uint32_t *bw)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+    int ret = ql_fwrite((void *)buf, 1, btw, file->fd);
+
+    if (ret < 0) {
+        *bw = 0;
+        return LV_FS_RES_HW_ERR;
+    }
+
+    *bw = ret;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+
+    return ql_fseek(file->fd, pos, QL_SEEK_SET) >= 0 ? LV_FS_RES_OK : LV_FS_RES_HW_ERR;
+}
+
+static lv_fs_res_t ic_hal_fs_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+    int ret = ql_ftell(file->fd);
+
+    if (ret < 0)
+        return LV_FS_RES_HW_ERR;
+
+    *pos_p = ret;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_size(lv_fs_drv_t *drv, void *file_p, uint32_t *size_p)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+    int ret = ql_fsize(file->fd);
+
+    if (ret < 0)
+        return LV_FS_RES_HW_ERR;
+
+    *size_p = ret;
+    return LV_FS_RES_OK;
+}
+
+static void ic_hal_fs_register(lv_fs_drv_t *drv, char letter)
+{
+    lv_fs_drv_init(drv);
+
+    drv->letter = letter;
+    drv->file_size = sizeof(ic_hal_file_t);
+    drv->open_cb = ic_hal_fs_open;
+    drv->close_cb = ic_hal_fs_close;
+    drv->read_cb = ic_hal_fs_read;
+    drv->write_cb = ic_hal_fs_write;
+    drv->seek_cb = ic_hal_fs_seek;
+    drv->tell_cb = ic_hal_fs_tell;
+    drv->size_cb = ic_hal_fs_size;
+
+    lv_fs_drv_register(drv);
+}
+
+bool ic_hal_fs_init(void)
+{
+    //lvgl keeps the pointer of driver
+    static lv_fs_drv_t ufs_drv;
+    static lv_fs_drv_t sd_drv;
+    static bool inited = false;
+
+    if (inited)
+        return true;
+
+    ic_hal_fs_register(&ufs_drv, IC_HAL_FS_UFS);
+    ic_hal_fs_register(&sd_drv, IC_HAL_FS_SD);
+    inited = true;
+
+    return true;
+}
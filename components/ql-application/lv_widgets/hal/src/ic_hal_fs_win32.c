@@ -0,0 +1,124 @@
+/// @file ic_hal_fs_win32.c
+/// @Synopsis:  lvgl file system adaptor for win32, all drives are the working directory
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "lvgl/lvgl.h"
+
+#include "ic_hal_fs.h"
+
+typedef struct
+{
+    FILE *fp;
+}ic_hal_file_t;
+
+/*******************************************************
+ *
+ * lvgl file system driver layer
+ ******************************************************/
+static lv_fs_res_t ic_hal_fs_open(lv_fs_drv_t *drv, void *file_p, const char *path, lv_fs_mode_t mode)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+    const char *flag;
+
+    if (mode == LV_FS_MODE_WR)
+        flag = "wb";
+    else if (mode == (LV_FS_MODE_WR | LV_FS_MODE_RD))
+        flag = "rb+";
+    else
+        flag = "rb";
+
+    file->fp = fopen(path, flag);
+    if (file->fp == NULL)
+        return LV_FS_RES_NOT_EX;
+
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_close(lv_fs_drv_t *drv, void *file_p)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+
+    fclose(file->fp);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+
+    *br = fread(buf, 1, btr, file->fp);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_write(lv_fs_drv_t *drv, void *file_p, const void *buf, uint32_t btw, uint32_t *bw)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+
+    *bw = fwrite(buf, 1, btw, file->fp);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+
+    return fseek(file->fp, pos, SEEK_SET) == 0 ? LV_FS_RES_OK : LV_FS_RES_HW_ERR;
+}
+
+static lv_fs_res_t ic_hal_fs_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+
+    *pos_p = ftell(file->fp);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t ic_hal_fs_size(lv_fs_drv_t *drv, void *file_p, uint32_t *size_p)
+{
+    ic_hal_file_t *file = (ic_hal_file_t *)file_p;
+    long pos = ftell(file->fp);
+
+    fseek(file->fp, 0, SEEK_END);
+    *size_p = ftell(file->fp);
+    fseek(file->fp, pos, SEEK_SET);
+    return LV_FS_RES_OK;
+}
+
+static void ic_hal_fs_register(lv_fs_drv_t *drv, char letter)
+{
+    lv_fs_drv_init(drv);
+
+    drv->letter = letter;
+    drv->file_size = sizeof(ic_hal_file_t);
+    drv->open_cb = ic_hal_fs_open;
+    drv->close_cb = ic_hal_fs_close;
+    drv->read_cb = ic_hal_fs_read;
+    drv->write_cb = ic_hal_fs_write;
+    drv->seek_cb = ic_hal_fs_seek;
+    drv->tell_cb = ic_hal_fs_tell;
+    drv->size_cb = ic_hal_fs_size;
+
+    lv_fs_drv_register(drv);
+}
+
+bool ic_hal_fs_init(void)
+{
+    static lv_fs_drv_t ufs_drv;
+    static lv_fs_drv_t sd_drv;
+    static bool inited = false;
+
+    if (inited)
+        return true;
+
+    ic_hal_fs_register(&ufs_drv, IC_HAL_FS_UFS);
+    ic_hal_fs_register(&sd_drv, IC_HAL_FS_SD);
+    inited = true;
+
+    return true;
+}
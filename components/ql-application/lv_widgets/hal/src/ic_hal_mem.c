@@ -0,0 +1,44 @@
+/// @file ic_hal_mem.c
+/// @Synopsis:  lvgl memory adaptor for lvgl gui of 8910
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "ic_hal_mem.h"
+#include "ic_hal_sys.h"
+#include "lv_gui_mem.h"
+#include "osi_mem.h"
+
+/*******************************************************
+ *
+ * memory layer
+ ******************************************************/
+uint32_t ic_hal_mem_arena_set(uint32_t arena)
+{
+    return lvGuiMemSetArena(arena);
+}
+
+uint32_t ic_hal_mem_arena_used(uint32_t arena)
+{
+    return lvGuiMemArenaUsed(arena);
+}
+
+static void ic_hal_mem_pressure_gui(void *user_data)
+{
+    ((ic_hal_mem_pressure_cb_t)user_data)();
+}
+
+//called in system work queue
+static void ic_hal_mem_pressure(void *ctx)
+{
+    ic_hal_gui_call(ic_hal_mem_pressure_gui, ctx);
+}
+
+bool ic_hal_mem_pressure_register(ic_hal_mem_pressure_cb_t cb)
+{
+    return osiMemPressureRegister(ic_hal_mem_pressure, (void *)cb);
+}
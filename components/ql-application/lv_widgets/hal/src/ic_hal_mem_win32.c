@@ -0,0 +1,30 @@
+/// @file ic_hal_mem_win32.c
+/// @Synopsis:  lvgl memory adaptor for win32, malloc is used without accounting
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "ic_hal_mem.h"
+
+/*******************************************************
+ *
+ * memory layer
+ ******************************************************/
+uint32_t ic_hal_mem_arena_set(uint32_t arena)
+{
+    return 0;
+}
+
+uint32_t ic_hal_mem_arena_used(uint32_t arena)
+{
+    return 0;
+}
+
+bool ic_hal_mem_pressure_register(ic_hal_mem_pressure_cb_t cb)
+{
+    return false;
+}
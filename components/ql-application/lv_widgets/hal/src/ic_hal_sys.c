@@ -0,0 +1,79 @@
+/// @file ic_hal_sys.c
+/// @Synopsis:  gui thread and data sources adaptor for lvgl gui of 8910
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "ic_hal_sys.h"
+#include "ic_data_provider.h"
+#include "lv_gui_main.h"
+#include "ql_power.h"
+#include "ql_api_nw.h"
+
+#define IC_HAL_SOURCE_PERIOD    (30 * 1000)   //ms, sample period of battery and signal
+
+static osiTimer_t *source_timer;
+
+/*******************************************************
+ *
+ * gui thread and critical section
+ ******************************************************/
+bool ic_hal_gui_call(ic_hal_call_cb_t cb, void *user_data)
+{
+    if (cb == NULL)
+        return false;
+
+    lvGuiThreadCallback((osiCallback_t)cb, user_data);
+    return true;
+}
+
+uint32_t ic_hal_enter_critical(void)
+{
+    return osiEnterCritical();
+}
+
+void ic_hal_exit_critical(uint32_t critical)
+{
+    osiExitCritical(critical);
+}
+
+/*******************************************************
+ *
+ * data sources, values are only delivered to widgets when changed
+ ******************************************************/
+static int32_t ic_hal_signal_bars(int rssi)
+{
+    if (rssi == 99 || rssi < 2) return 0;   //99 is unknown
+    if (rssi < 10) return 1;
+    if (rssi < 15) return 2;
+    if (rssi < 20) return 3;
+    return 4;
+}
+
+static void ic_hal_source_sample(void *param)
+{
+    uint32_t level = 0;
+    ql_nw_signal_strength_info_s signal = {0};
+
+    if (ql_get_battery_level(&level) == QL_CHARGE_SUCCESS)
+        ic_data_publish(IC_DATA_BATTERY, level > 100 ? 100 : level);
+    if (ql_nw_get_signal_strength(0, &signal) == QL_NW_SUCCESS)
+        ic_data_publish(IC_DATA_SIGNAL, ic_hal_signal_bars(signal.rssi));
+}
+
+bool ic_hal_data_source_start(void)
+{
+    if (source_timer == NULL)
+        source_timer = osiTimerCreate(lvGuiGetThread(), ic_hal_source_sample, NULL);
+    if (source_timer == NULL)
+        return false;
+
+    ic_hal_source_sample(NULL);
+
+    //relaxed timer doesn't wake up system, sample at the next wakeup is enough
+    return osiTimerStartPeriodicRelaxed(source_timer, IC_HAL_SOURCE_PERIOD, OSI_WAIT_FOREVER);
+}
@@ -0,0 +1,46 @@
+/// @file ic_hal_sys_win32.c
+/// @Synopsis:  gui thread and data sources adaptor for win32, everything runs in gui thread
+/// @version V1.0
+
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "ic_hal_sys.h"
+#include "ic_data_provider.h"
+
+/*******************************************************
+ *
+ * gui thread and critical section
+ ******************************************************/
+bool ic_hal_gui_call(ic_hal_call_cb_t cb, void *user_data)
+{
+    if (cb == NULL)
+        return false;
+
+    cb(user_data);
+    return true;
+}
+
+uint32_t ic_hal_enter_critical(void)
+{
+    return 0;
+}
+
+void ic_hal_exit_critical(uint32_t critical)
+{
+}
+
+/*******************************************************
+ *
+ * data sources, fixed values in simulator
+ ******************************************************/
+bool ic_hal_data_source_start(void)
+{
+    ic_data_publish(IC_DATA_BATTERY, 100);
+    ic_data_publish(IC_DATA_SIGNAL, 4);
+    ic_data_publish(IC_DATA_BT, IC_DATA_BT_OFF);
+    return true;
+}
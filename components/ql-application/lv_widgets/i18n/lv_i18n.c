@@ -17,19 +17,7 @@ static inline uint32_t op_w(uint32_t val) { UNUSED(val); return 0; }
 static inline uint32_t op_f(uint32_t val) { UNUSED(val); return 0; }
 static inline uint32_t op_t(uint32_t val) { UNUSED(val); return 0; }
 
-static lv_i18n_phrase_t en_us_singulars[] = {
-    {"12/17", "12/17"},
-    {"Tue", "Tue"},
-    {"Info Cards", "Info Cards"},
-    {"Alarm", "Alarm"},
-    {"Sport", "Sport"},
-    {"example1", "example1"},
-    {"example2", "example2"},
-    {"16:25", "16:25"},
-    {NULL, NULL} // End mark
-};
-
-
+// Phrases are generated to lv_i18n_table.c by "i18n_gen.py -F translations.csv"
 
 static uint8_t en_us_plural_fn(int32_t num)
 {
@@ -43,25 +31,11 @@ static uint8_t en_us_plural_fn(int32_t num)
 
 static const lv_i18n_lang_t en_us_lang = {
     .locale_name = "en-US",
-    .singulars = en_us_singulars,
+    .table = lv_i18n_en_us_table,
 
     .locale_plural_fn = en_us_plural_fn
 };
 
-static lv_i18n_phrase_t zh_cn_singulars[] = {
-    {"12/17", "12/17"},
-    {"Tue", "周二"},
-    {"Info Cards", "卡片中心"},
-    {"Alarm", "闹钟"},
-    {"Sport", "运动"},
-    {"example1", "实例1"},
-    {"example2", "实例2"},
-    {"16:25", "16:25"},
-    {NULL, NULL} // End mark
-};
-
-
-
 static uint8_t zh_cn_plural_fn(int32_t num)
 {
 
@@ -72,7 +46,7 @@ static uint8_t zh_cn_plural_fn(int32_t num)
 
 static const lv_i18n_lang_t zh_cn_lang = {
     .locale_name = "zh-CN",
-    .singulars = zh_cn_singulars,
+    .table = lv_i18n_zh_cn_table,
 
     .locale_plural_fn = zh_cn_plural_fn
 };
@@ -136,6 +110,35 @@ int lv_i18n_set_locale(const char * l_name)
 }
 
 
+/**
+ * Find the generated ID of a message ID. The hash seed is chosen by
+ * i18n_gen.py so that each msg_id has its own slot, only one string is
+ * compared to reject a msg_id out of the table.
+ */
+static int32_t __lv_i18n_find_id(const char * msg_id)
+{
+    const uint8_t * c = (const uint8_t *)msg_id;
+    uint32_t h = LV_I18N_HASH_SEED;
+    uint16_t slot;
+
+    while(*c) {
+        h ^= *c++;
+        h *= 16777619;
+    }
+
+    slot = lv_i18n_hash_slots[h & (LV_I18N_HASH_SIZE - 1)];
+    if(slot == 0) return -1;
+    if(strcmp(lv_i18n_msg_ids[slot - 1], msg_id) != 0) return -1;
+
+    return slot - 1;
+}
+
+static const char * __lv_i18n_get_text_table(const lv_i18n_lang_t * lang, lv_i18n_id_t id)
+{
+    if(lang->table == NULL) return NULL;
+    return lang->table[id];
+}
+
 static const char * __lv_i18n_get_text_core(lv_i18n_phrase_t * trans, const char * msg_id)
 {
     uint16_t i;
@@ -161,6 +164,13 @@ const char * lv_i18n_get_text(const char * msg_id)
 
     const lv_i18n_lang_t * lang = current_lang;
     const void * txt;
+    int32_t id = __lv_i18n_find_id(msg_id);
+
+    // Generated phrase
+    if(id >= 0) {
+        txt = lv_i18n_get_text_id((lv_i18n_id_t)id);
+        if(txt != lv_i18n_msg_ids[id]) return txt;
+    }
 
     // Search in current locale
     if(lang->singulars != NULL) {
@@ -181,6 +191,30 @@ const char * lv_i18n_get_text(const char * msg_id)
     return msg_id;
 }
 
+/**
+ * Get the translation from a message ID of the generated table
+ * @param id message ID, LV_I18N_ID_xxx
+ * @return the translation of `id` on the set local
+ */
+const char * lv_i18n_get_text_id(lv_i18n_id_t id)
+{
+    const char * txt;
+
+    if(id >= LV_I18N_ID_NUM) return "";
+    if(current_lang == NULL) return lv_i18n_msg_ids[id];
+
+    txt = __lv_i18n_get_text_table(current_lang, id);
+    if(txt != NULL) return txt;
+
+    // Try to fallback
+    if(current_lang != current_lang_pack[0]) {
+        txt = __lv_i18n_get_text_table(current_lang_pack[0], id);
+        if(txt != NULL) return txt;
+    }
+
+    return lv_i18n_msg_ids[id];
+}
+
 /**
  * Get the translation from a message ID and apply the language's plural rule to get correct form
  * @param msg_id message ID
@@ -8,6 +8,8 @@ extern "C" {
 #include <stdint.h>
 #include <string.h>
 
+#include "lv_i18n_table.h"
+
 typedef enum {
     LV_I18N_PLURAL_TYPE_ZERO,
     LV_I18N_PLURAL_TYPE_ONE,
@@ -25,7 +27,8 @@ typedef struct {
 
 typedef struct {
     const char * locale_name;
-    lv_i18n_phrase_t * singulars;
+    const char * const * table;          // translations indexed by lv_i18n_id_t, from i18n_gen.py
+    lv_i18n_phrase_t * singulars;        // phrases not in table, searched by msg_id
     lv_i18n_phrase_t * plurals[_LV_I18N_PLURAL_TYPE_NUM];
     uint8_t (*locale_plural_fn)(int32_t num);
 } lv_i18n_lang_t;
@@ -56,6 +59,13 @@ int lv_i18n_set_locale(const char * l_name);
  */
 const char * lv_i18n_get_text(const char * msg_id);
 
+/**
+ * Get the translation from a message ID of the generated table, no string is compared
+ * @param id message ID, LV_I18N_ID_xxx
+ * @return the translation of `id` on the set local
+ */
+const char * lv_i18n_get_text_id(lv_i18n_id_t id);
+
 /**
  * Get the translation from a message ID and apply the language's plural rule to get correct form
  * @param msg_id message ID
@@ -75,6 +85,7 @@ void __lv_i18n_reset(void);
 
 
 #define _(text) lv_i18n_get_text(text)
+#define _i(id) lv_i18n_get_text_id(id)
 #define _p(text, num) lv_i18n_get_text_plural(text, num)
 
 
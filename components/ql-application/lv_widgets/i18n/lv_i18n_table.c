@@ -0,0 +1,44 @@
+/*THIS FILE is auto generated by script, Don not modify it*/
+
+#include "lv_i18n_table.h"
+
+const char * const lv_i18n_msg_ids[LV_I18N_ID_NUM] = {
+    "12/17",
+    "Tue",
+    "Info Cards",
+    "Alarm",
+    "Sport",
+    "example1",
+    "example2",
+    "16:25",
+};
+
+// id + 1 of the msg_id hashed to a slot, 0 for none
+const uint16_t lv_i18n_hash_slots[LV_I18N_HASH_SIZE] = {
+    7, 4, 0, 0, 0, 0, 2, 3,
+    0, 6, 8, 0, 1, 0, 5, 0,
+};
+
+// en-US, NULL for no translation
+const char * const lv_i18n_en_us_table[LV_I18N_ID_NUM] = {
+    "12/17",
+    "Tue",
+    "Info Cards",
+    "Alarm",
+    "Sport",
+    "example1",
+    "example2",
+    "16:25",
+};
+
+// zh-CN, NULL for no translation
+const char * const lv_i18n_zh_cn_table[LV_I18N_ID_NUM] = {
+    "12/17",
+    "周二",
+    "卡片中心",
+    "闹钟",
+    "运动",
+    "实例1",
+    "实例2",
+    "16:25",
+};
@@ -0,0 +1,28 @@
+/*THIS FILE is auto generated by script, Don not modify it*/
+
+#ifndef __LV_I18N_TABLE_H__
+#define __LV_I18N_TABLE_H__
+
+#include <stdint.h>
+
+typedef enum {
+    LV_I18N_ID_12_17, // 12/17
+    LV_I18N_ID_TUE, // Tue
+    LV_I18N_ID_INFO_CARDS, // Info Cards
+    LV_I18N_ID_ALARM, // Alarm
+    LV_I18N_ID_SPORT, // Sport
+    LV_I18N_ID_EXAMPLE1, // example1
+    LV_I18N_ID_EXAMPLE2, // example2
+    LV_I18N_ID_16_25, // 16:25
+    LV_I18N_ID_NUM,
+}lv_i18n_id_t;
+
+#define LV_I18N_HASH_SEED  0x811c9dcc
+#define LV_I18N_HASH_SIZE  16
+
+extern const char * const lv_i18n_msg_ids[LV_I18N_ID_NUM];
+extern const uint16_t lv_i18n_hash_slots[LV_I18N_HASH_SIZE];
+extern const char * const lv_i18n_en_us_table[LV_I18N_ID_NUM];
+extern const char * const lv_i18n_zh_cn_table[LV_I18N_ID_NUM];
+
+#endif
@@ -0,0 +1,236 @@
+/**
+* @FileName:   ic_data_provider.c
+* @Descripton: data providers of watch face, change driven delivery to widgets
+*/
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+#include "stdio.h"
+#include "stdlib.h"
+
+#include "ic_widgets_inc.h"
+#include "ic_data_provider.h"
+
+#define DATA_TIME_INTERVAL     (1000)   //ms of a second
+
+typedef struct {
+    ic_data_cb_t cb;
+    void *user_data;
+}data_subscriber_t;
+
+typedef struct {
+    int32_t value;          //latest published, shared with producers
+    int32_t delivered;      //latest delivered to subscribers
+    uint32_t rate_limit;    //minimal ms between deliveries
+    uint32_t last_tick;     //tick of the last delivery
+    data_subscriber_t subs[IC_DATA_MAX_SUBSCRIBER];
+}data_field_t;
+
+typedef struct {
+    data_field_t fields[IC_DATA_NUM];
+    bool scheduled;         //delivery is scheduled in gui thread, shared with producers
+    lv_task_t *limit_task;  //delivery at the end of a rate limit interval
+    lv_task_t *time_task;   //producer of time fields
+}data_provider_t;
+
+static data_provider_t data_ctx;
+
+//default rate limits, sensors may report much more often than a watch face needs
+static const uint32_t data_rate_limit[IC_DATA_NUM] = {
+    [IC_DATA_BATTERY] = 60 * 1000,
+    [IC_DATA_STEPS]   = 10 * 1000,
+    [IC_DATA_SIGNAL]  = 5 * 1000,
+};
+
+static void data_notify(ic_data_enum field, int32_t value)
+{
+    data_subscriber_t *subs = data_ctx.fields[field].subs;
+
+    //callback may unsubscribe, slots are cleared but not moved
+    for (int i = 0; i < IC_DATA_MAX_SUBSCRIBER; i++) {
+        if (subs[i].cb != NULL)
+            subs[i].cb(field, value, subs[i].user_data);
+    }
+}
+
+static void data_deliver(void *param)
+{
+    uint32_t wait = UINT32_MAX;
+    uint32_t critical = ic_hal_enter_critical();
+    data_ctx.scheduled = false;
+    ic_hal_exit_critical(critical);
+
+    for (int f = 0; f < IC_DATA_NUM; f++) {
+        data_field_t *field = &data_ctx.fields[f];
+
+        critical = ic_hal_enter_critical();
+        int32_t value = field->value;
+        ic_hal_exit_critical(critical);
+
+        if (value == field->delivered)
+            continue;
+
+        //changes in the interval are merged, the latest is delivered at the end
+        if (field->rate_limit != 0 && field->delivered != IC_DATA_VALUE_NONE) {
+            uint32_t elapsed = lv_tick_elaps(field->last_tick);
+            if (elapsed < field->rate_limit) {
+                if (field->rate_limit - elapsed < wait)
+                    wait = field->rate_limit - elapsed;
+                continue;
+            }
+        }
+
+        field->delivered = value;
+        field->last_tick = lv_tick_get();
+        data_notify((ic_data_enum)f, value);
+    }
+
+    if (wait != UINT32_MAX) {
+        lv_task_set_period(data_ctx.limit_task, wait);
+        lv_task_reset(data_ctx.limit_task);
+        lv_task_set_prio(data_ctx.limit_task, LV_TASK_PRIO_MID);
+    }
+}
+
+static void data_limit_task(lv_task_t *task)
+{
+    lv_task_set_prio(task, LV_TASK_PRIO_OFF);
+    data_deliver(NULL);
+}
+
+static bool data_has_subscriber(ic_data_enum field)
+{
+    for (int i = 0; i < IC_DATA_MAX_SUBSCRIBER; i++) {
+        if (data_ctx.fields[field].subs[i].cb != NULL)
+            return true;
+    }
+    return false;
+}
+
+/*Wakeup at the next second boundary, or the next minute boundary when there are no second subscribers*/
+static void data_time_task(lv_task_t *task)
+{
+    bool second = data_has_subscriber(IC_DATA_SECOND);
+
+    if (!second && !data_has_subscriber(IC_DATA_MINUTE)) {
+        lv_task_set_prio(task, LV_TASK_PRIO_OFF);
+        return;
+    }
+
+    ic_hal_rtc_t rtc = {0}; /*msec is not provided by all platforms*/
+    if (!ic_hal_rtc_get_time(&rtc) || rtc.hour >= 24 || rtc.min >= 60 || rtc.sec >= 60 || rtc.msec >= 1000) {
+        lv_task_set_period(task, DATA_TIME_INTERVAL);
+        return;
+    }
+
+    ic_data_publish(IC_DATA_MINUTE, rtc.hour * 60 + rtc.min);
+    ic_data_publish(IC_DATA_SECOND, (rtc.hour * 60 + rtc.min) * 60 + rtc.sec);
+
+    uint32_t period = DATA_TIME_INTERVAL - rtc.msec;
+    if (!second) period += (59 - rtc.sec) * DATA_TIME_INTERVAL;
+    lv_task_set_period(task, period);
+}
+
+void ic_data_time_refresh(void)
+{
+    lv_task_set_prio(data_ctx.time_task, LV_TASK_PRIO_HIGHEST);
+    lv_task_ready(data_ctx.time_task);
+}
+
+void ic_data_init(void)
+{
+    if (data_ctx.time_task != NULL)
+        return;
+
+    for (int f = 0; f < IC_DATA_NUM; f++) {
+        data_ctx.fields[f].value = IC_DATA_VALUE_NONE;
+        data_ctx.fields[f].delivered = IC_DATA_VALUE_NONE;
+        data_ctx.fields[f].rate_limit = data_rate_limit[f];
+    }
+
+    data_ctx.limit_task = lv_task_create(data_limit_task, DATA_TIME_INTERVAL, LV_TASK_PRIO_OFF, NULL);
+    data_ctx.time_task = lv_task_create(data_time_task, DATA_TIME_INTERVAL, LV_TASK_PRIO_OFF, NULL);
+
+    //platform sources of battery, signal and so on
+    ic_hal_data_source_start();
+}
+
+bool ic_data_subscribe(ic_data_enum field, ic_data_cb_t cb, void *user_data)
+{
+    data_subscriber_t *subs;
+
+    if (field >= IC_DATA_NUM || cb == NULL)
+        return false;
+
+    subs = data_ctx.fields[field].subs;
+    for (int i = 0; i < IC_DATA_MAX_SUBSCRIBER; i++) {
+        if (subs[i].cb != NULL)
+            continue;
+
+        subs[i].cb = cb;
+        subs[i].user_data = user_data;
+
+        if (data_ctx.fields[field].delivered != IC_DATA_VALUE_NONE)
+            cb(field, data_ctx.fields[field].delivered, user_data);
+        if (field == IC_DATA_SECOND || field == IC_DATA_MINUTE)
+            ic_data_time_refresh();
+        return true;
+    }
+
+    LOGE("too many subscribers of data %d\n", field);
+    return false;
+}
+
+void ic_data_unsubscribe(ic_data_enum field, ic_data_cb_t cb, void *user_data)
+{
+    data_subscriber_t *subs;
+
+    if (field >= IC_DATA_NUM)
+        return;
+
+    //the time task will find out at its next run, and pause itself or slow down
+    subs = data_ctx.fields[field].subs;
+    for (int i = 0; i < IC_DATA_MAX_SUBSCRIBER; i++) {
+        if (subs[i].cb == cb && subs[i].user_data == user_data) {
+            subs[i].cb = NULL;
+            subs[i].user_data = NULL;
+        }
+    }
+}
+
+void ic_data_set_rate_limit(ic_data_enum field, uint32_t ms)
+{
+    if (field < IC_DATA_NUM)
+        data_ctx.fields[field].rate_limit = ms;
+}
+
+void ic_data_publish(ic_data_enum field, int32_t value)
+{
+    bool kick = false;
+
+    if (field >= IC_DATA_NUM || value == IC_DATA_VALUE_NONE)
+        return;
+
+    //compared with the last published value rather than the delivered one, so
+    //a value changed back before delivery still gets a delivery scheduled
+    uint32_t critical = ic_hal_enter_critical();
+    if (data_ctx.fields[field].value != value) {
+        data_ctx.fields[field].value = value;
+        kick = !data_ctx.scheduled;
+        data_ctx.scheduled = true;
+    }
+    ic_hal_exit_critical(critical);
+
+    if (kick && !ic_hal_gui_call(data_deliver, NULL)) {
+        critical = ic_hal_enter_critical();
+        data_ctx.scheduled = false;
+        ic_hal_exit_critical(critical);
+    }
+}
+
+int32_t ic_data_get(ic_data_enum field)
+{
+    if (field >= IC_DATA_NUM)
+        return IC_DATA_VALUE_NONE;
+    return data_ctx.fields[field].value;
+}
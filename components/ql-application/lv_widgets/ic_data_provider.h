@@ -0,0 +1,65 @@
+/**
+* @FileName:   ic_data_provider.h
+* @Descripton: data providers of watch face, values are pushed to widgets only when changed
+*/
+
+#include "ic_widgets_inc.h"
+
+#ifndef __IC_DATA_PROVIDER_H__
+#define  __IC_DATA_PROVIDER_H__
+
+/**
+* Each field has one value. Producers publish the value in any thread, and
+* subscribers are called in gui thread only when the value is different from
+* the last delivered one. So widgets update only the objects of the changed
+* field, and nothing is invalidated when nothing is changed.
+*
+* A field can have a rate limit, changes in the interval are merged, and
+* only the latest value is delivered at the end of the interval.
+*
+* Time fields are produced here by a lv_task woken at the next second or
+* minute boundary, and it is paused when there are no time subscribers.
+*/
+#define IC_DATA_MAX_SUBSCRIBER   (4)           //subscribers of each field
+
+typedef enum {
+    IC_DATA_SECOND,     //second of the day, hour * 3600 + min * 60 + sec
+    IC_DATA_MINUTE,     //minute of the day, hour * 60 + min, also changed at date change
+    IC_DATA_BATTERY,    //battery level in percent, 0-100
+    IC_DATA_STEPS,      //steps of today
+    IC_DATA_SIGNAL,     //signal bars, 0-4
+    IC_DATA_BT,         //ic_data_bt_enum
+    IC_DATA_NUM
+}ic_data_enum;
+
+typedef enum {
+    IC_DATA_BT_OFF,
+    IC_DATA_BT_ON,
+    IC_DATA_BT_CONNECTED,
+}ic_data_bt_enum;
+
+#define IC_DATA_VALUE_NONE       (INT32_MIN)   //value not published yet
+
+//called in gui thread, at subscribe when the value is known, then at each change
+typedef void (*ic_data_cb_t)(ic_data_enum field, int32_t value, void *user_data);
+
+//initialize in gui thread before any subscribe or publish
+extern void ic_data_init(void);
+
+//subscribe in gui thread, cb is called at once when the value is known
+extern bool ic_data_subscribe(ic_data_enum field, ic_data_cb_t cb, void *user_data);
+extern void ic_data_unsubscribe(ic_data_enum field, ic_data_cb_t cb, void *user_data);
+
+//minimal interval between deliveries of a field in ms, 0 for no limit
+extern void ic_data_set_rate_limit(ic_data_enum field, uint32_t ms);
+
+//publish a value, can be called in any thread
+extern void ic_data_publish(ic_data_enum field, int32_t value);
+
+//the latest published value, IC_DATA_VALUE_NONE when not published
+extern int32_t ic_data_get(ic_data_enum field);
+
+//re-read time at once, such as time is set or wakeup from screen off
+extern void ic_data_time_refresh(void);
+
+#endif
@@ -0,0 +1,208 @@
+/**
+* @FileName:   ic_vlist.c
+* @Descripton: virtual list, rows are recycled when scrolled
+*
+* The scrollable of the page is as high as all items, and a ring of rows
+* covers the page height plus one row. Item i is shown by row i % row_num,
+* so when scrolled by one row, only the row moved from one end to the
+* other is bound again.
+*/
+#include "stdint.h"
+#include "stdbool.h"
+#include <string.h>
+
+#include "ic_widgets_inc.h"
+
+#include "ic_vlist.h"
+
+typedef struct
+{
+    lv_page_ext_t page;       //ancestor, first
+    lv_coord_t row_h;
+    ic_vlist_bind_cb_t bind_cb;
+    uint16_t count;
+    uint16_t row_num;
+    lv_obj_t **rows;
+    int32_t *index;           //item of each row
+}ic_vlist_ext_t;
+
+static lv_signal_cb_t ancestor_signal;
+static lv_signal_cb_t ancestor_scrl_signal;
+
+static void vlist_update(lv_obj_t *vlist, bool force)
+{
+    ic_vlist_ext_t *ext = lv_obj_get_ext_attr(vlist);
+    lv_obj_t *scrl = lv_page_get_scrollable(vlist);
+    lv_coord_t y = -lv_obj_get_y(scrl);
+    uint32_t first = y > 0 ? y / ext->row_h : 0;
+    uint32_t i;
+
+    for (i = first; i < first + ext->row_num; i++) {
+        uint16_t slot = i % ext->row_num;
+        lv_obj_t *row = ext->rows[slot];
+
+        if (i >= ext->count) {
+            ext->index[slot] = IC_VLIST_INDEX_NONE;
+            lv_obj_set_hidden(row, true);
+            continue;
+        }
+
+        if (!force && ext->index[slot] == (int32_t)i)
+            continue;
+
+        ext->index[slot] = i;
+        lv_obj_set_y(row, i * ext->row_h);
+        ext->bind_cb(row, i);
+        lv_obj_set_hidden(row, false);
+    }
+}
+
+static void vlist_set_row_width(lv_obj_t *vlist, lv_coord_t w)
+{
+    ic_vlist_ext_t *ext = lv_obj_get_ext_attr(vlist);
+    uint16_t i;
+
+    for (i = 0; i < ext->row_num; i++)
+        lv_obj_set_width(ext->rows[i], w);
+}
+
+static lv_res_t vlist_scrl_signal(lv_obj_t *scrl, lv_signal_t sign, void *param)
+{
+    lv_res_t res = ancestor_scrl_signal(scrl, sign, param);
+
+    if (res != LV_RES_OK)
+        return res;
+
+    if (sign == LV_SIGNAL_COORD_CHG) {
+        lv_obj_t *vlist = lv_obj_get_parent(scrl);
+
+        //rows follow the width of the page, it changes with the page style
+        if (lv_area_get_width(param) != lv_obj_get_width(scrl))
+            vlist_set_row_width(vlist, lv_obj_get_width(scrl));
+
+        //scrolled, or moved back by the page
+        vlist_update(vlist, false);
+    }
+
+    return LV_RES_OK;
+}
+
+static lv_res_t vlist_signal(lv_obj_t *vlist, lv_signal_t sign, void *param)
+{
+    ic_vlist_ext_t *ext = lv_obj_get_ext_attr(vlist);
+
+    if (sign == LV_SIGNAL_CLEANUP) {
+        lv_mem_free(ext->rows);
+        lv_mem_free(ext->index);
+        ext->rows = NULL;
+        ext->index = NULL;
+    }
+
+    return ancestor_signal(vlist, sign, param);
+}
+
+lv_obj_t *ic_vlist_create(lv_obj_t *parent, const ic_vlist_desc_t *desc)
+{
+    lv_obj_t *vlist;
+    lv_obj_t *scrl;
+    ic_vlist_ext_t *ext;
+    uint16_t i;
+
+    if (desc == NULL || desc->row_h <= 0 || desc->create_cb == NULL || desc->bind_cb == NULL)
+        return NULL;
+
+    vlist = lv_page_create(parent, NULL);
+    if (vlist == NULL)
+        return NULL;
+
+    ext = lv_obj_allocate_ext_attr(vlist, sizeof(ic_vlist_ext_t));
+    if (ext == NULL) {
+        lv_obj_del(vlist);
+        return NULL;
+    }
+
+    ext->row_h = desc->row_h;
+    ext->bind_cb = desc->bind_cb;
+    ext->count = 0;
+    ext->row_num = desc->h / desc->row_h + 2;
+    ext->rows = lv_mem_alloc(ext->row_num * sizeof(lv_obj_t *));
+    ext->index = lv_mem_alloc(ext->row_num * sizeof(int32_t));
+
+    if (ancestor_signal == NULL)
+        ancestor_signal = lv_obj_get_signal_cb(vlist);
+    lv_obj_set_signal_cb(vlist, vlist_signal);
+
+    if (ext->rows == NULL || ext->index == NULL) {
+        LOGE("vlist alloc %d rows fail\n", ext->row_num);
+        lv_obj_del(vlist);
+        return NULL;
+    }
+
+    lv_obj_set_size(vlist, desc->w, desc->h);
+    lv_page_set_scrl_layout(vlist, LV_LAYOUT_OFF);
+    lv_page_set_scrollable_fit2(vlist, LV_FIT_PARENT, LV_FIT_NONE);
+
+    scrl = lv_page_get_scrollable(vlist);
+    lv_obj_set_height(scrl, 0);
+
+    for (i = 0; i < ext->row_num; i++) {
+        lv_obj_t *row = desc->create_cb(scrl);
+
+        lv_obj_set_pos(row, 0, 0);
+        lv_obj_set_size(row, lv_obj_get_width(scrl), desc->row_h);
+        lv_obj_set_hidden(row, true);
+        lv_page_glue_obj(row, true);
+
+        ext->rows[i] = row;
+        ext->index[i] = IC_VLIST_INDEX_NONE;
+    }
+
+    if (ancestor_scrl_signal == NULL)
+        ancestor_scrl_signal = lv_obj_get_signal_cb(scrl);
+    lv_obj_set_signal_cb(scrl, vlist_scrl_signal);
+
+    return vlist;
+}
+
+void ic_vlist_set_count(lv_obj_t *vlist, uint16_t count)
+{
+    ic_vlist_ext_t *ext = lv_obj_get_ext_attr(vlist);
+    lv_obj_t *scrl = lv_page_get_scrollable(vlist);
+    lv_coord_t h = count * ext->row_h;
+    lv_coord_t min_y = lv_obj_get_height(vlist) - h;
+
+    ext->count = count;
+    lv_obj_set_height(scrl, h);
+
+    //keep the last item at the bottom when the list gets shorter
+    if (min_y > 0)
+        min_y = 0;
+    if (lv_obj_get_y(scrl) < min_y)
+        lv_obj_set_y(scrl, min_y);
+
+    vlist_update(vlist, true);
+}
+
+void ic_vlist_refresh(lv_obj_t *vlist)
+{
+    vlist_update(vlist, true);
+}
+
+int32_t ic_vlist_get_index(const lv_obj_t *row)
+{
+    lv_obj_t *scrl = lv_obj_get_parent(row);
+    lv_obj_t *vlist = scrl ? lv_obj_get_parent(scrl) : NULL;
+    ic_vlist_ext_t *ext;
+    uint16_t i;
+
+    if (vlist == NULL || lv_obj_get_signal_cb(vlist) != vlist_signal)
+        return IC_VLIST_INDEX_NONE;
+
+    ext = lv_obj_get_ext_attr(vlist);
+    for (i = 0; i < ext->row_num; i++) {
+        if (ext->rows[i] == row)
+            return ext->index[i];
+    }
+
+    return IC_VLIST_INDEX_NONE;
+}
@@ -0,0 +1,66 @@
+#ifndef __IC_VLIST_H__
+#define __IC_VLIST_H__
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#ifdef PLATFORM_EC600
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+/**
+ Virtual list, an lv_page of fixed height rows. Only the rows in view are
+ created, and they are bound to another item when scrolled out of view, so
+ the objects of a list don't grow with the item count.
+ */
+#define IC_VLIST_INDEX_NONE     (-1)
+
+/**
+* create the objects of a row, the row is positioned by the list
+* @param parent scrollable of the list
+* @return the row
+*/
+typedef lv_obj_t *(*ic_vlist_create_cb_t)(lv_obj_t *parent);
+
+/**
+* show an item on a row
+* @param row row created by ic_vlist_create_cb_t
+* @param index item index
+*/
+typedef void (*ic_vlist_bind_cb_t)(lv_obj_t *row, uint16_t index);
+
+typedef struct {
+    lv_coord_t w;
+    lv_coord_t h;
+    lv_coord_t row_h;                 //height of a row
+    ic_vlist_create_cb_t create_cb;
+    ic_vlist_bind_cb_t bind_cb;
+}ic_vlist_desc_t;
+
+/**
+* create a virtual list, empty until ic_vlist_set_count
+* @param parent parent of the list, NULL for a screen
+* @param desc list descriptor
+* @return the list, an lv_page
+*/
+extern lv_obj_t *ic_vlist_create(lv_obj_t *parent, const ic_vlist_desc_t *desc);
+
+/**
+* set the item count, the rows in view are bound again
+*/
+extern void ic_vlist_set_count(lv_obj_t *vlist, uint16_t count);
+
+/**
+* bind the rows in view again, after the items are changed
+*/
+extern void ic_vlist_refresh(lv_obj_t *vlist);
+
+/**
+* get the item index of a row, for the event callback of a row
+* @return item index, IC_VLIST_INDEX_NONE if the row is not bound
+*/
+extern int32_t ic_vlist_get_index(const lv_obj_t *row);
+
+#endif
@@ -55,11 +55,13 @@
 #include "ic_hal.h"
 #include "ic_obj_message.h"
 #include "title_bar.h"
+#include "ic_vlist.h"
 #include "animation.h"
 #include "language_config.h"
 #include "lv_i18n.h"
 #include "iclv_font.h"
 #include "screen_manager.h"
+#include "ic_data_provider.h"
 
 #define IC_CANVAS_WIDTH LV_HOR_RES_MAX
 #define IC_CANVAS_HEIGHT LV_VER_RES_MAX
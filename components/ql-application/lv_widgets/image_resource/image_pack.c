@@ -0,0 +1,81 @@
+/** 
+* @FileName:   image_pack.c
+* @Descripton: images in flash image pack
+*/
+
+#include "ic_widgets_inc.h"
+
+#ifdef IC_IMAGE_PACK
+
+#include "image_pack.h"
+#include "drv_spi_flash.h"
+#include "hal_chip.h"
+#include "hal_config.h"
+
+static lv_img_dsc_t g_image_pack_list[IMAGE_ID_NUM];
+
+/******************************************************************************
+ *  Function    -  iclv_image_pack_init
+ * 
+ *  Purpose     -  map image pack in flash
+ * 
+ *  Description -  Pixels are accessed through XIP without copy. Only the
+ *                 image descriptors are in RAM. When the pack is invalid
+ *                 or mismatch with image_id_enum, all images are NULL.
+ * 
+ ******************************************************************************/
+bool iclv_image_pack_init(void)
+{
+    memset(g_image_pack_list, 0, sizeof(g_image_pack_list));
+
+    drvSpiFlash_t *flash = drvSpiFlashOpen(HAL_FLASH_DEVICE_NAME(IC_IMAGE_PACK_FLASH_ADDRESS));
+    if (flash == NULL)
+        return false;
+
+    const uint8_t *pack = (const uint8_t *)drvSpiFlashMapAddress(flash, HAL_FLASH_OFFSET(IC_IMAGE_PACK_FLASH_ADDRESS));
+    if (pack == NULL)
+        return false;
+
+    const image_pack_header_t *hdr = (const image_pack_header_t *)pack;
+    if (hdr->magic != IMAGE_PACK_MAGIC || hdr->version != IMAGE_PACK_VERSION ||
+        hdr->count != IMAGE_ID_NUM || hdr->size > IC_IMAGE_PACK_FLASH_SIZE)
+    {
+        LOGE("invalid image pack magic 0x%x count %d size %d", hdr->magic, hdr->count, hdr->size);
+        return false;
+    }
+
+    const image_pack_entry_t *entry = (const image_pack_entry_t *)(hdr + 1);
+    for (unsigned n = 0; n < IMAGE_ID_NUM; n++, entry++)
+    {
+        if (entry->offset % IMAGE_PACK_ALIGN != 0 || entry->offset > hdr->size ||
+            entry->size > hdr->size - entry->offset)
+        {
+            LOGE("invalid image pack entry %d", n);
+            memset(g_image_pack_list, 0, sizeof(g_image_pack_list));
+            return false;
+        }
+
+        memcpy(&g_image_pack_list[n].header, &entry->header, sizeof(lv_img_header_t));
+        g_image_pack_list[n].data_size = entry->size;
+        g_image_pack_list[n].data = pack + entry->offset;
+    }
+
+    LOGI("image pack %d images, %d bytes", hdr->count, hdr->size);
+    return true;
+}
+
+/******************************************************************************
+ *  Function    -  iclv_get_image_by_id
+ * 
+ *  Purpose     -  get image source of lv_img_set_src
+ * 
+ ******************************************************************************/
+const void* iclv_get_image_by_id(image_id_enum id)
+{
+    if (id >= IMAGE_ID_NUM || g_image_pack_list[id].data == NULL)
+        return NULL;
+
+    return &g_image_pack_list[id];
+}
+
+#endif
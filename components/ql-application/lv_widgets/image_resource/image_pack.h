@@ -0,0 +1,33 @@
+#ifndef __IC_IMAGE_PACK_H__
+#define __IC_IMAGE_PACK_H__
+
+#include "stdint.h"
+
+/*
+ * Image pack layout, generated by "image_gen.py -f pack", little endian:
+ *
+ *   image_pack_header_t
+ *   image_pack_entry_t[count], in the order of image_id_enum
+ *   payloads, each starts at IMAGE_PACK_ALIGN
+ *
+ * Payload is the pixels of LVGL binary image without the 4 bytes header,
+ * RGB565 for true_color, and RGB565 + A8 for true_color_alpha.
+ */
+#define IMAGE_PACK_MAGIC    0x4b504d49 // "IMPK"
+#define IMAGE_PACK_VERSION  1
+#define IMAGE_PACK_ALIGN    32 // cache line size
+
+typedef struct {
+    uint32_t magic;   // IMAGE_PACK_MAGIC
+    uint32_t version; // IMAGE_PACK_VERSION
+    uint32_t count;   // image count, should be IMAGE_ID_NUM
+    uint32_t size;    // whole pack size, including header
+} image_pack_header_t;
+
+typedef struct {
+    uint32_t header;  // lv_img_header_t of the image
+    uint32_t offset;  // payload offset from the start of pack
+    uint32_t size;    // payload size
+} image_pack_entry_t;
+
+#endif
@@ -10,5 +10,30 @@
 
 #include "ic_widgets_inc.h"
 
+//count of digital clockfaces with time digit images
+#define IC_CLOCK_NUM 3
+
+//time digit images, index of iclv_time_get_image_ids
+typedef enum {
+    IC_TIME_IMG_HOUR_H,
+    IC_TIME_IMG_HOUR_L,
+    IC_TIME_IMG_MIN_H,
+    IC_TIME_IMG_MIN_L,
+    IC_TIME_IMG_MON_H,
+    IC_TIME_IMG_MON_L,
+    IC_TIME_IMG_DAY_H,
+    IC_TIME_IMG_DAY_L,
+    IC_TIME_IMG_WEEK,
+    IC_TIME_IMG_NUM,
+} ic_time_img_t;
+
+void iclv_time_get_image_ids(uint8_t num, image_id_enum ids[IC_TIME_IMG_NUM]);
+image_id_enum iclv_time_get_image_id(uint8_t type,uint8_t num);
+
+#ifdef IC_IMAGE_PACK
+bool iclv_image_pack_init(void);
+const void* iclv_get_image_by_id(image_id_enum id);
+#else
 #define iclv_get_image_by_id(id) g_image_resource_list[id]
 #endif
+#endif
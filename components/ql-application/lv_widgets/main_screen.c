@@ -6,9 +6,14 @@
 * @Descripton: watch clockface enterys
 */
 #include "clockface/clockface.h"
+#include "clockface/clockface_pkg.h"
+#include "ic_mainmenu_phonebook.h"
 
 #include "main_screen.h"
 #include "ic_widgets_inc.h"
+#if defined(PLATFORM_EC600)
+#include "lv_jpeg.h"
+#endif
 
 
 
@@ -21,31 +26,134 @@ extern "C" {
 
 static mainscreen_obj_t mainscreen_obj;
 
-#define MAINSCREEN_ANIM_INTERVAL   (15)    //ms
-
-#define MAINSCREEN_ANIM_HOR_STEP   (LV_HOR_RES_MAX/5)
-#define MAINSCREEN_ANIM_VER_STEP   (LV_VER_RES_MAX/10)
+#define MAINSCREEN_ANIM_TIME       (150)   //ms to slide a whole screen
 extern const clockface_t clock_table[];
 
-static void clock_update_task(lv_task_t * task)
+/*Seconds only when the second hand is shown, otherwise the clock is changed once a minute*/
+static ic_data_enum clock_time_field(clockface_obj_t * clock)
 {
-  /*Use the user_data*/
-  clockface_obj_t * clock = (clockface_obj_t *)task->user_data;
+  bool has_second = (clock->desc->type == CLOCK_ANALOG || clock->desc->type == CLOCK_BOTH) &&
+                    clock->desc->analog.second.exist;
+
+  return has_second ? IC_DATA_SECOND : IC_DATA_MINUTE;
+}
 
-  if (mainscreen_obj.focused_obj != mainscreen_obj.clock.bg) return;
+static void clock_time_changed(ic_data_enum field, int32_t value, void *user_data)
+{
+  clockface_obj_t * clock = (clockface_obj_t *)user_data;
 
-  LOGI("clock_update_task\n");
+  LOGI("clock_time_changed\n");
   ic_clockface_update(clock);
 }
 
+/*Not subscribed when the clock is not shown, so nothing wakes up for it*/
 static void pause_clock_task(void)
 {
-    lv_task_set_cb(mainscreen_obj.clockupdate_task, NULL);
+    if (!mainscreen_obj.clock_subscribed)
+        return;
+
+    ic_data_unsubscribe(clock_time_field(&mainscreen_obj.clock), clock_time_changed, &mainscreen_obj.clock);
+    mainscreen_obj.clock_subscribed = false;
 }
 
+/*Subscribe when the clock is focused, it is updated at once by the known time*/
 static void resume_clock_task(void)
 {
-    lv_task_set_cb(mainscreen_obj.clockupdate_task, clock_update_task);
+    if (mainscreen_obj.clock_subscribed || mainscreen_obj.focused_obj != mainscreen_obj.clock.bg)
+        return;
+
+    mainscreen_obj.clock_subscribed = ic_data_subscribe(clock_time_field(&mainscreen_obj.clock), clock_time_changed, &mainscreen_obj.clock);
+}
+
+/*******************************************************
+ *
+ * always-on display in screen off, HH:MM as 7 segments digits drawn into
+ * a digit size buffer, lvgl is suspended and only changed digits are written
+ ******************************************************/
+#define AOD_DIGIT_W     (LV_HOR_RES_MAX / 6)   //4 digits and colon take 5 digits width
+#define AOD_DIGIT_H     (AOD_DIGIT_W * 9 / 5)
+#define AOD_SEG         (AOD_DIGIT_W / 5)      //segment thickness
+#define AOD_GAP         (AOD_DIGIT_W / 5)      //space between digits and colon
+#define AOD_COLOR       (0xffff)  //white, the same in panel 8 colors idle mode
+#define AOD_WIDTH       (4 * AOD_DIGIT_W + 4 * AOD_GAP + AOD_SEG)
+#define AOD_X           ((LV_HOR_RES_MAX - AOD_WIDTH) / 2)
+#define AOD_Y           ((LV_VER_RES_MAX - AOD_DIGIT_H) / 2)
+#define AOD_SEG_MID     ((AOD_DIGIT_H - AOD_SEG) / 2)
+#define AOD_SEG_V       (AOD_SEG_MID - AOD_SEG)   //vertical segment length
+
+typedef struct {
+  uint8_t x, y, w, h;
+}aod_rect_t;
+
+/*segments a to g in a digit*/
+static const aod_rect_t aod_segs[7] = {
+  {AOD_SEG, 0, AOD_DIGIT_W - 2 * AOD_SEG, AOD_SEG},
+  {AOD_DIGIT_W - AOD_SEG, AOD_SEG, AOD_SEG, AOD_SEG_V},
+  {AOD_DIGIT_W - AOD_SEG, AOD_SEG_MID + AOD_SEG, AOD_SEG, AOD_SEG_V},
+  {AOD_SEG, AOD_DIGIT_H - AOD_SEG, AOD_DIGIT_W - 2 * AOD_SEG, AOD_SEG},
+  {0, AOD_SEG_MID + AOD_SEG, AOD_SEG, AOD_SEG_V},
+  {0, AOD_SEG, AOD_SEG, AOD_SEG_V},
+  {AOD_SEG, AOD_SEG_MID, AOD_DIGIT_W - 2 * AOD_SEG, AOD_SEG},
+};
+
+/*bit n is segment n of aod_segs*/
+static const uint8_t aod_digit_segs[10] = {
+  0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 0x7f, 0x6f,
+};
+
+static uint16_t aod_buf[AOD_DIGIT_W * AOD_DIGIT_H];
+static uint8_t aod_digits[4];
+
+static void aod_fill(uint16_t stride, const aod_rect_t *rect)
+{
+  for (uint16_t y = rect->y; y < rect->y + rect->h; y++) {
+    uint16_t *p = &aod_buf[y * stride + rect->x];
+    for (uint16_t x = 0; x < rect->w; x++) p[x] = AOD_COLOR;
+  }
+}
+
+static void aod_draw_digit(uint8_t index, uint8_t digit)
+{
+  /*colon takes a segment width after the hour digits*/
+  uint16_t x = AOD_X + index * (AOD_DIGIT_W + AOD_GAP);
+  if (index >= 2) x += AOD_SEG + AOD_GAP;
+
+  ic_hal_aod_area_t area = {x, AOD_Y, AOD_DIGIT_W, AOD_DIGIT_H};
+
+  memset(aod_buf, 0, sizeof(aod_buf));
+  for (uint8_t n = 0; n < 7; n++) {
+    if (aod_digit_segs[digit] & (1 << n)) aod_fill(AOD_DIGIT_W, &aod_segs[n]);
+  }
+  ic_hal_aod_flush(&area, aod_buf);
+}
+
+static void aod_draw_colon(void)
+{
+  ic_hal_aod_area_t area = {AOD_X + 2 * (AOD_DIGIT_W + AOD_GAP), AOD_Y, AOD_SEG, AOD_DIGIT_H};
+  aod_rect_t dot = {0, AOD_DIGIT_H / 3 - AOD_SEG / 2, AOD_SEG, AOD_SEG};
+
+  memset(aod_buf, 0, AOD_SEG * AOD_DIGIT_H * sizeof(uint16_t));
+  aod_fill(AOD_SEG, &dot);
+  dot.y = AOD_DIGIT_H * 2 / 3 - AOD_SEG / 2;
+  aod_fill(AOD_SEG, &dot);
+  ic_hal_aod_flush(&area, aod_buf);
+}
+
+/*Called once a minute with lvgl suspended, lvgl objects can't be used here*/
+static uint32_t main_screen_aod_draw(void *user_data, bool full)
+{
+  ic_hal_rtc_t rtc = {0};
+  if (!ic_hal_rtc_get_time(&rtc) || rtc.sec >= 60 || rtc.msec >= 1000) return 60 * CLOCK_UPDATE_INTERVAL;
+
+  uint8_t digits[4] = {rtc.hour / 10, rtc.hour % 10, rtc.min / 10, rtc.min % 10};
+
+  if (full) aod_draw_colon();
+  for (uint8_t n = 0; n < 4; n++) {
+    if (full || digits[n] != aod_digits[n]) aod_draw_digit(n, digits[n]);
+    aod_digits[n] = digits[n];
+  }
+
+  return (60 - rtc.sec) * CLOCK_UPDATE_INTERVAL - rtc.msec;
 }
 
 static void touch_animation_finish_cb(void) {
@@ -559,12 +667,16 @@ static void main_screen_init(void *arg)
 	{
 		mainscreen_obj.clock.desc = &clock_table[2];
 	}
-	
+
+#ifdef IC_CLOCKFACE_PKG
+    //installed clockface package takes the place of builtin clockface
+    clockface_t *pkg = ic_clockface_pkg_load(IC_CLOCKFACE_PKG_PATH);
+    if (pkg != NULL)
+        mainscreen_obj.clock.desc = pkg;
+#endif
  
     ic_clockface_create(&mainscreen_obj.clock, mainscreen_obj.root);
 
-    mainscreen_obj.clockupdate_task = lv_task_create(clock_update_task, CLOCK_UPDATE_INTERVAL, LV_TASK_PRIO_HIGHEST, &mainscreen_obj.clock);
-
     /**
       Create the quick control center, it`s a drawer style screen, show by pull down at clockface screen
     */
@@ -595,19 +707,25 @@ static void main_screen_init(void *arg)
      */
     mainscreen_obj.mainmenu = ic_mainmenu_create(mainscreen_obj.root, &mainscreen_obj.style);
 
+    //主菜单点击进入的屏幕，空闲时预创建
+    ic_select_phonebook_or_dial_preload();
+
     /**
       Event callback
     */
     lv_obj_set_event_cb(mainscreen_obj.root, main_screen_event_cb);
 
 
-    mainscreen_obj.anim_para.h_step = MAINSCREEN_ANIM_HOR_STEP;
-    mainscreen_obj.anim_para.v_step = MAINSCREEN_ANIM_VER_STEP;
-    mainscreen_obj.anim_para.interval = MAINSCREEN_ANIM_INTERVAL;
+    mainscreen_obj.anim_para.time = MAINSCREEN_ANIM_TIME;
     mainscreen_obj.anim_para.finish_cb = touch_animation_finish_cb;
 
     mainscreen_obj.focused_obj = mainscreen_obj.clock.bg;
+    mainscreen_obj.clock_subscribed = false;
+    resume_clock_task();
 
+    /*Show the time in screen off, the band of digits only in panel partial mode*/
+    ic_hal_aod_area_t aod_area = {0, AOD_Y, LV_HOR_RES_MAX, AOD_DIGIT_H};
+    ic_hal_aod_set(&aod_area, main_screen_aod_draw, NULL);
 }
 
 
@@ -615,21 +733,24 @@ static void main_screen_deinit(void* arg)
 {
     ic_screen_t* screen = (ic_screen_t*)arg;
 
-    lv_obj_del((lv_obj_t*)screen->data);
+    ic_hal_aod_set(NULL, NULL, NULL);
 
-    lv_task_del(mainscreen_obj.clockupdate_task);
+    pause_clock_task();
+    ic_clockface_delete(&mainscreen_obj.clock);
+
+    lv_obj_del((lv_obj_t*)screen->data);
 }
 
 static void main_screen_exit(void* arg)
 {
-    lv_task_set_cb(mainscreen_obj.clockupdate_task, NULL);
+    pause_clock_task();
 }
 
 static void main_screen_entry(void* arg)
 {
     ic_screen_t* screen = (ic_screen_t*)arg;
     lv_scr_load((lv_obj_t*)screen->data);
-    lv_task_set_cb(mainscreen_obj.clockupdate_task, clock_update_task);
+    resume_clock_task();
 }
 
 void main_screen_1(void)
@@ -658,12 +779,30 @@ void main_screen(void) {
     //init png decode 
     //lv_png_init();
 
+#if defined(PLATFORM_EC600)
+    //init jpeg decode, photos and wallpapers are decoded by libjpeg-turbo
+    lv_jpeg_init();
+#endif
+
+#ifdef IC_IMAGE_PACK
+    iclv_image_pack_init();
+#endif
+
+    //images and clockface packages in file system
+    ic_hal_fs_init();
+
     //i18n init
     lv_i18n_init(lv_i18n_language_pack);
 
     //default langauge
     lv_i18n_set_locale("zh-CN");
 
+    //glyph caches, and fonts of the locale in file system
+    ic_font_init();
+
+    //time, battery and other values pushed to widgets when changed
+    ic_data_init();
+
     main_screen_1();
 }
 #ifdef __cplusplus
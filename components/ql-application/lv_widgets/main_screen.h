@@ -23,7 +23,7 @@ typedef struct {
 
     lv_style_t style;
 
-    lv_task_t* clockupdate_task;
+    bool clock_subscribed;      //clock subscribed to time, only when it is shown
 
     obj_move_anim_t anim_para;
 }mainscreen_obj_t;
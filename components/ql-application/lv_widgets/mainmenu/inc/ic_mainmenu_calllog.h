@@ -25,5 +25,7 @@
  *
  ******************************************************************************/
 #define CALL_RECORDS_MAX  200  //通话记录最多两百条
+#define CALLLOG_ROW_HEIGHT  66  //通话记录列表的行高
+#define CALLLOG_ROW_PAD     10  //行内边距
 
 #endif
\ No newline at end of file
@@ -19,10 +19,21 @@
 #include "ic_widgets_inc.h"
 
 
+/******************************************************************************
+ * define str
+ * 
+ *
+ ******************************************************************************/
+#define PB_LIST_ROW_HEIGHT  66  //通讯录列表的行高
+#define PB_LIST_ROW_PAD     10  //行内边距
+#define PB_LIST_ICON_SIZE   46  //头像大小
+
+
 /******************************************************************************
  * local function
  * 
  *
  ******************************************************************************/
 void ic_select_phonebook_or_dial_create(void);
+void ic_select_phonebook_or_dial_preload(void);
 #endif
\ No newline at end of file
@@ -21,6 +21,7 @@
  *
  ******************************************************************************/
 static ic_call_phone_str call_information[200] = {0};//通话信息
+static lv_style_t calllog_information_list_child;//通话记录行的风格
 
 
 
@@ -287,7 +288,12 @@ static void calllog_screen_event_cb(lv_obj_t* obj, lv_event_t event)
 
 	    case LV_EVENT_CLICKED:
 	        LOGI("clicked\n");
-			calllog_information_screen_create(lv_list_get_btn_text(obj));
+			{
+				int32_t index = ic_vlist_get_index(obj);
+
+				if (index != IC_VLIST_INDEX_NONE)
+					calllog_information_screen_create(call_information[index].number);
+			}
 	        break;
 
 	    case LV_EVENT_LONG_PRESSED:
@@ -398,12 +404,65 @@ static void ic_update_number_information()
 	}
 }
 
+/******************************************************************************
+ *  Function    -  recent_callog_row_create
+ * 
+ *  Purpose     -  创建通话记录的一行
+ * 
+ *  Description -  行由虚拟列表创建和回收，内容在recent_callog_row_bind里设置
+ * 
+ ******************************************************************************/
+static lv_obj_t *recent_callog_row_create(lv_obj_t *parent)
+{
+	lv_obj_t *row = lv_btn_create(parent, NULL);
+	lv_btn_set_layout(row, LV_LAYOUT_OFF);
+	lv_obj_add_style(row, LV_BTN_PART_MAIN, &calllog_information_list_child);
+	lv_obj_set_event_cb(row, calllog_screen_event_cb);
+
+	//头像，号码，通话类型，按创建顺序取出
+	lv_obj_t *icon = lv_img_create(row, NULL);
+	lv_img_set_src(icon, iclv_get_image_by_id(IMG_RECORD_MOTHER_ID));
+	lv_obj_align(icon, NULL, LV_ALIGN_IN_LEFT_MID, CALLLOG_ROW_PAD, 0);
+
+	lv_obj_t *number = lv_label_create(row, NULL);
+	lv_label_set_long_mode(number, LV_LABEL_LONG_CROP);
+	lv_obj_set_width(number, LV_HOR_RES - 2 * lv_obj_get_width(icon) - 4 * CALLLOG_ROW_PAD);
+	lv_obj_align(number, icon, LV_ALIGN_OUT_RIGHT_MID, CALLLOG_ROW_PAD, 0);
+
+	lv_img_create(row, NULL);
+
+	return row;
+}
+
+static void recent_callog_row_bind(lv_obj_t *row, uint16_t index)
+{
+	lv_obj_t *icon = lv_obj_get_child_back(row, NULL);
+	lv_obj_t *number = lv_obj_get_child_back(row, icon);
+	lv_obj_t *out_or_in = lv_obj_get_child_back(row, number);
+
+	lv_label_set_text(number, call_information[index].number);
+
+	if(call_information[index].call_type2 == 1)//拨出
+	{
+		lv_img_set_src(out_or_in, iclv_get_image_by_id(IMG_CALL_OUT_ID));
+	}
+	else if(call_information[index].call_type == 1)//未接
+	{
+		lv_img_set_src(out_or_in, iclv_get_image_by_id(IMG_CALL_MISS_ID));
+	}
+	else //打进已接
+	{
+		lv_img_set_src(out_or_in, iclv_get_image_by_id(IMG_CALL_IN_ID));
+	}
+	lv_obj_align(out_or_in, NULL, LV_ALIGN_IN_RIGHT_MID, -CALLLOG_ROW_PAD, 0);
+}
+
 /******************************************************************************
  *  Function    -  recent_callog_init
  * 
  *  Purpose     -  最近通话界面
  * 
- *  Description -   
+ *  Description -  通话记录最多CALL_RECORDS_MAX条，用虚拟列表只创建可见的行
  * 
  * modification history
  * ----------------------------------------
@@ -413,30 +472,13 @@ static void ic_update_number_information()
 static void recent_callog_init(void *arg)
 {
 	ic_screen_t* screen = (ic_screen_t*)arg;
-
-	//添加列表
-	lv_obj_t* calllog_list = lv_list_create(NULL, NULL);
-	screen->data = calllog_list;
+	ic_vlist_desc_t desc;
 
 	//更新最新的通话记录
 	ic_update_number_information();
-	
-	//添加列表的风格
-	static lv_style_t calllog_information_list;
-	lv_obj_set_size(calllog_list, LV_HOR_RES, LV_VER_RES);
-	lv_style_init(&calllog_information_list);
-	lv_style_set_radius(&calllog_information_list, LV_STATE_DEFAULT, 0);
-	lv_style_set_bg_color(&calllog_information_list, LV_STATE_DEFAULT, LV_COLOR_BLACK);
-	lv_style_set_bg_grad_color(&calllog_information_list, LV_STATE_DEFAULT, LV_COLOR_BLACK);
-	lv_style_set_bg_grad_dir(&calllog_information_list, LV_STATE_DEFAULT, LV_GRAD_DIR_VER);
-	lv_style_set_bg_opa(&calllog_information_list, LV_STATE_DEFAULT, LV_OPA_COVER);
-	lv_style_set_border_width(&calllog_information_list, LV_STATE_DEFAULT, 0);
-	lv_style_set_border_color(&calllog_information_list, LV_STATE_DEFAULT, LV_COLOR_BLACK);	//添加边界框
-	lv_obj_add_style(calllog_list, LV_OBJ_PART_MAIN, &calllog_information_list);
-    lv_list_set_scrollbar_mode(calllog_list, LV_SCROLLBAR_MODE_OFF);//不显示滚动条
-	
+
 	//添加按键的风格	
-	static lv_style_t calllog_information_list_child;
+	lv_style_reset(&calllog_information_list_child);
 	lv_style_init(&calllog_information_list_child);
 	lv_style_set_radius(&calllog_information_list_child, LV_STATE_DEFAULT, 0);
 	lv_style_set_bg_color(&calllog_information_list_child, LV_STATE_DEFAULT, LV_COLOR_BLACK);
@@ -456,36 +498,36 @@ static void recent_callog_init(void *arg)
 	//按键下按选择框的颜色
 	lv_style_set_outline_color(&calllog_information_list_child, LV_STATE_FOCUSED, LV_COLOR_BLACK);
 
-
-	uint8_t count = ic_get_callog_total();
-	
-	for(uint8_t i = 0;i < count; i++)
-	{
-		//添加按键
-		lv_obj_t * call_total = lv_list_add_btn(calllog_list, iclv_get_image_by_id(IMG_RECORD_MOTHER_ID), call_information[i].number);
-		lv_obj_add_style(call_total, LV_BTN_PART_MAIN, &calllog_information_list_child);
-		lv_obj_set_event_cb(call_total, calllog_screen_event_cb);
-
-		//创建在按键上，然后静置布局，不然移不动
-		lv_obj_t * out_or_in = lv_img_create(call_total,NULL);
-		lv_btn_set_layout(call_total, LV_LAYOUT_OFF);
-		lv_obj_align(out_or_in, NULL, LV_ALIGN_IN_TOP_RIGHT, 40, 30);
-
-
-		if(call_information[i].call_type2 == 1)//拨出
-		{
-			lv_img_set_src(out_or_in, iclv_get_image_by_id(IMG_CALL_OUT_ID));
-		}
-		else if(call_information[i].call_type == 1)//未接
-		{
-			lv_img_set_src(out_or_in, iclv_get_image_by_id(IMG_CALL_MISS_ID));
-		}
-		else //打进已接
-		{
-			lv_img_set_src(out_or_in, iclv_get_image_by_id(IMG_CALL_IN_ID));
-		}
+	//添加列表
+	desc.w = LV_HOR_RES;
+	desc.h = LV_VER_RES;
+	desc.row_h = CALLLOG_ROW_HEIGHT;
+	desc.create_cb = recent_callog_row_create;
+	desc.bind_cb = recent_callog_row_bind;
+	lv_obj_t* calllog_list = ic_vlist_create(NULL, &desc);
+	if (!calllog_list) {
+		LOGE("create calllog list fail\n");
+		calllog_list = lv_obj_create(NULL, NULL);
 	}
+	screen->data = calllog_list;
+
+	//添加列表的风格
+	static lv_style_t calllog_information_list;
+	lv_style_init(&calllog_information_list);
+	lv_style_set_radius(&calllog_information_list, LV_STATE_DEFAULT, 0);
+	lv_style_set_bg_color(&calllog_information_list, LV_STATE_DEFAULT, LV_COLOR_BLACK);
+	lv_style_set_bg_grad_color(&calllog_information_list, LV_STATE_DEFAULT, LV_COLOR_BLACK);
+	lv_style_set_bg_grad_dir(&calllog_information_list, LV_STATE_DEFAULT, LV_GRAD_DIR_VER);
+	lv_style_set_bg_opa(&calllog_information_list, LV_STATE_DEFAULT, LV_OPA_COVER);
+	lv_style_set_border_width(&calllog_information_list, LV_STATE_DEFAULT, 0);
+	lv_style_set_border_color(&calllog_information_list, LV_STATE_DEFAULT, LV_COLOR_BLACK);	//添加边界框
+	lv_style_set_pad_all(&calllog_information_list, LV_STATE_DEFAULT, 0);
+	lv_obj_add_style(calllog_list, LV_OBJ_PART_MAIN, &calllog_information_list);
+	lv_obj_add_style(calllog_list, LV_PAGE_PART_SCROLLABLE, &calllog_information_list);
+	lv_page_set_scrollbar_mode(calllog_list, LV_SCROLLBAR_MODE_OFF);//不显示滚动条
 
+	//只创建可见的行，滚动时回收
+	ic_vlist_set_count(calllog_list, ic_get_callog_total());
 }
 
 static void recent_callog_deinit(void* arg)
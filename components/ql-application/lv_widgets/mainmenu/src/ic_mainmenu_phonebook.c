@@ -21,6 +21,19 @@
  ******************************************************************************/
 static lv_obj_t* select1 = NULL;
 static lv_obj_t* select2 = NULL;
+static lv_style_t pb_list_style;//通讯录行的风格
+
+//通讯录成员
+static const struct {
+	image_id_enum img_id;
+	const char *name;
+} pb_list_items[] = {
+	{IMG_RECORD_MOTHER_ID,      "mother"},
+	{IMG_RECORD_FATHER_ID,      "father"},
+	{IMG_RECORD_TEACHER_ID,     "teacher"},
+	{IMG_RECORD_GRANDMOTHER_ID, "grandmother"},
+	{IMG_RECORD_GRANDFATHER_ID, "grandfather"},
+};
 
 /******************************************************************************
  * external function
@@ -174,25 +187,40 @@ static void pb_screen_event_cb(lv_obj_t* obj, lv_event_t event)
     }
 }
 
+static lv_obj_t *pb_list_row_create(lv_obj_t *parent)
+{
+	lv_obj_t *row = lv_btn_create(parent, NULL);
+	lv_btn_set_layout(row, LV_LAYOUT_OFF);
+	lv_obj_add_style(row, LV_BTN_PART_MAIN, &pb_list_style);
+	lv_obj_set_event_cb(row, pb_screen_event_cb);
+
+	//头像，名字，按创建顺序取出
+	lv_obj_t *icon = lv_img_create(row, NULL);
+	lv_obj_t *name = lv_label_create(row, NULL);
+	lv_obj_set_pos(icon, PB_LIST_ROW_PAD, (PB_LIST_ROW_HEIGHT - PB_LIST_ICON_SIZE) / 2);
+	lv_obj_set_pos(name, 2 * PB_LIST_ROW_PAD + PB_LIST_ICON_SIZE, 0);
+
+	return row;
+}
+
+static void pb_list_row_bind(lv_obj_t *row, uint16_t index)
+{
+	lv_obj_t *icon = lv_obj_get_child_back(row, NULL);
+	lv_obj_t *name = lv_obj_get_child_back(row, icon);
+
+	lv_img_set_src(icon, iclv_get_image_by_id(pb_list_items[index].img_id));
+	lv_label_set_text(name, pb_list_items[index].name);
+	lv_obj_set_y(name, (PB_LIST_ROW_HEIGHT - lv_obj_get_height(name)) / 2);
+}
+
 static void pb_list_init(void *arg)
 {
 	ic_screen_t* screen = (ic_screen_t*)arg;
-	lv_obj_t* pb_list = lv_list_create(NULL, NULL);
+	ic_vlist_desc_t desc;
 	static lv_style_t pb_list_bg;//must static type
-	lv_style_init(&pb_list_bg);
-	screen->data = pb_list;
-
-	//添加窗口的风格
-	lv_obj_set_size(pb_list,LV_HOR_RES,LV_VER_RES);
-	lv_style_set_radius(&pb_list_bg, LV_STATE_DEFAULT, 0);
-	lv_style_set_bg_color(&pb_list_bg, LV_STATE_DEFAULT, LV_COLOR_BLACK);
-	lv_style_set_border_color(&pb_list_bg, LV_STATE_DEFAULT, LV_COLOR_BLACK);	//添加边界框
-	lv_style_set_border_width(&pb_list_bg, LV_STATE_DEFAULT, 0);
-	lv_list_set_scrollbar_mode(pb_list, LV_SCROLLBAR_MODE_OFF);//不显示滚动条
-	lv_obj_add_style(pb_list, LV_OBJ_PART_MAIN, &pb_list_bg);
 
 	//按键
-	static lv_style_t pb_list_style;
+	lv_style_reset(&pb_list_style);
 	lv_style_init(&pb_list_style);
 	lv_style_set_radius(&pb_list_style, LV_STATE_DEFAULT, 0);
 	lv_style_set_bg_color(&pb_list_style, LV_STATE_DEFAULT, LV_COLOR_BLACK);
@@ -213,27 +241,32 @@ static void pb_list_init(void *arg)
 	//按键下按选择框的颜色
 	lv_style_set_outline_color(&pb_list_style, LV_STATE_FOCUSED, LV_COLOR_BLACK);
 
-	//添加列表成员
-	lv_obj_t* mother_btn = lv_list_add_btn(pb_list, iclv_get_image_by_id(IMG_RECORD_MOTHER_ID), "mother");
-	lv_obj_add_style(mother_btn, LV_BTN_PART_MAIN, &pb_list_style);
-	lv_obj_set_event_cb(mother_btn, pb_screen_event_cb);
+	//列表只创建可见的行
+	desc.w = LV_HOR_RES;
+	desc.h = LV_VER_RES;
+	desc.row_h = PB_LIST_ROW_HEIGHT;
+	desc.create_cb = pb_list_row_create;
+	desc.bind_cb = pb_list_row_bind;
+	lv_obj_t* pb_list = ic_vlist_create(NULL, &desc);
+	if (!pb_list) {
+		LOGE("create pb list fail\n");
+		pb_list = lv_obj_create(NULL, NULL);
+	}
+	screen->data = pb_list;
 
-	lv_obj_t* father_btn = lv_list_add_btn(pb_list, iclv_get_image_by_id(IMG_RECORD_FATHER_ID), "father");
-	lv_obj_add_style(father_btn, LV_BTN_PART_MAIN, &pb_list_style);
-	lv_obj_set_event_cb(father_btn, pb_screen_event_cb);
-	
-	lv_obj_t* teacher_btn = lv_list_add_btn(pb_list, iclv_get_image_by_id(IMG_RECORD_TEACHER_ID), "teacher");
-	lv_obj_add_style(teacher_btn, LV_BTN_PART_MAIN, &pb_list_style);
-	lv_obj_set_event_cb(teacher_btn, pb_screen_event_cb);
-	
-	lv_obj_t* grandmother_btn = lv_list_add_btn(pb_list, iclv_get_image_by_id(IMG_RECORD_GRANDMOTHER_ID), "grandmother");
-	lv_obj_add_style(grandmother_btn, LV_BTN_PART_MAIN, &pb_list_style);
-	lv_obj_set_event_cb(grandmother_btn, pb_screen_event_cb);
+	//添加窗口的风格
+	lv_style_init(&pb_list_bg);
+	lv_style_set_radius(&pb_list_bg, LV_STATE_DEFAULT, 0);
+	lv_style_set_bg_color(&pb_list_bg, LV_STATE_DEFAULT, LV_COLOR_BLACK);
+	lv_style_set_border_color(&pb_list_bg, LV_STATE_DEFAULT, LV_COLOR_BLACK);	//添加边界框
+	lv_style_set_border_width(&pb_list_bg, LV_STATE_DEFAULT, 0);
+	lv_style_set_pad_all(&pb_list_bg, LV_STATE_DEFAULT, 0);
+	lv_page_set_scrollbar_mode(pb_list, LV_SCROLLBAR_MODE_OFF);//不显示滚动条
+	lv_obj_add_style(pb_list, LV_OBJ_PART_MAIN, &pb_list_bg);
+	lv_obj_add_style(pb_list, LV_PAGE_PART_SCROLLABLE, &pb_list_bg);
 
-	lv_obj_t* grandfather_btn = lv_list_add_btn(pb_list, iclv_get_image_by_id(IMG_RECORD_GRANDFATHER_ID), "grandfather");
-	lv_obj_add_style(grandfather_btn, LV_BTN_PART_MAIN, &pb_list_style);
-	lv_obj_set_event_cb(grandfather_btn, pb_screen_event_cb);
-	
+	//添加列表成员
+	ic_vlist_set_count(pb_list, sizeof(pb_list_items) / sizeof(pb_list_items[0]));
 }
 
 static void pb_list_deinit(void* arg)
@@ -502,14 +535,38 @@ static void phonebook_or_dial_entry(void* arg)
     lv_scr_load((lv_obj_t*)screen->data);
 }
 
+static void phonebook_or_dial_get_cb(screen_callback_t *cb)
+{
+    cb->init = phonebook_or_dial_init;
+    cb->deinit = phonebook_or_dial_deinit;
+    cb->entry = phonebook_or_dial_entry;
+    cb->exit = phonebook_or_dial_exit;
+}
+
+/******************************************************************************
+ *  Function    -  ic_select_phonebook_or_dial_preload
+ * 
+ *  Purpose     -  空闲时预创建选择屏幕
+ * 
+ *  Description -  屏幕内容是静态的，退出后保留在屏幕缓存里，主菜单点击时
+ *                 不用重新创建
+ * 
+ ******************************************************************************/
+void ic_select_phonebook_or_dial_preload(void)
+{
+	screen_callback_t cb;
+
+    phonebook_or_dial_get_cb(&cb);
+
+    ic_screen_set_cache(SCREEN_SELECT_PHOBEBOOK_OR_DIAL, true);
+    ic_screen_preload(SCREEN_SELECT_PHOBEBOOK_OR_DIAL, &cb);
+}
+
 void ic_select_phonebook_or_dial_create(void)
 {
 	screen_callback_t cb;
 
-    cb.init = phonebook_or_dial_init;
-    cb.deinit = phonebook_or_dial_deinit;
-    cb.entry = phonebook_or_dial_entry;
-    cb.exit = phonebook_or_dial_exit;
+    phonebook_or_dial_get_cb(&cb);
 
 
 	if(!ic_screen_create(SCREEN_SELECT_PHOBEBOOK_OR_DIAL, &cb)) 
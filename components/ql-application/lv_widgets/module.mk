@@ -11,14 +11,20 @@ C_FILES += $(IC_LV_WIDGETS_SRC)/infocard_center.c
 C_FILES += $(IC_LV_WIDGETS_SRC)/message_center.c
 C_FILES += $(IC_LV_WIDGETS_SRC)/mainmenu.c
 C_FILES += $(IC_LV_WIDGETS_SRC)/title_bar.c
+C_FILES += $(IC_LV_WIDGETS_SRC)/ic_vlist.c
 C_FILES += $(IC_LV_WIDGETS_SRC)/main_screen.c
+C_FILES += $(IC_LV_WIDGETS_SRC)/ic_data_provider.c
 C_FILES += $(IC_LV_WIDGETS_SRC)/clockface/clockface.c
+C_FILES += $(IC_LV_WIDGETS_SRC)/clockface/clockface_hand.c
+C_FILES += $(IC_LV_WIDGETS_SRC)/clockface/clockface_pkg.c
 
 #i18n
 C_FILES += $(IC_LV_WIDGETS_SRC)/i18n/lv_i18n.c
+C_FILES += $(IC_LV_WIDGETS_SRC)/i18n/lv_i18n_table.c
 
 #fonts
 C_FILES += $(IC_LV_WIDGETS_SRC)/fonts/iclv_font.c
+C_FILES += $(IC_LV_WIDGETS_SRC)/fonts/iclv_font_cache.c
 C_FILES += $(IC_LV_WIDGETS_SRC)/fonts/opposans_14.c
 
 ###################################################
@@ -19,37 +19,256 @@
 #define  FREE_API           free
 #endif
 
+#define SCREEN_INDEX_COUNT  (SCREEN_INDEX_NUM - SCREEN_INDEX_IDLE)
+
 static screen_list_t screen_stack;
+static screen_list_t *screen_top;       //栈顶，即当前屏幕
+static int screen_depth;
+
+//缓存链表，头部是最近使用的
+static screen_list_t screen_cache;
+static uint32_t screen_cache_size;
+static bool screen_cacheable[SCREEN_INDEX_COUNT];
+static bool screen_pressure_registered;
 
 
 static screen_list_t* ic_screen_get_current(void)
 {
-    int i;
-    screen_list_t *node = screen_stack.next;
-    screen_list_t *prev = &screen_stack;
-
-    for(i = 0; i < MAX_SCREEN_HISTORY; i++){
-        if(!node){
-           if(prev == &screen_stack){
-                return NULL;
-           }
-          
-           break;
-        }
+    return screen_top;
+}
 
-        prev = node;
-        node = node->next;
+//每个屏幕一个lvgl内存统计分区，0是不属于屏幕的内存
+static uint32_t screen_arena(screen_list_t *node)
+{
+    return node ? node->screen.index - SCREEN_INDEX_IDLE + 1 : 0;
+}
+
+static void screen_push(screen_list_t *node)
+{
+    screen_list_t *prev = screen_top ? screen_top : &screen_stack;
+
+    node->next = NULL;
+    node->prev = prev;
+    prev->next = node;
+
+    screen_top = node;
+    screen_depth++;
+
+    //屏幕运行期间分配的lvgl内存记到栈顶屏幕
+    ic_hal_mem_arena_set(screen_arena(screen_top));
+}
+
+static void screen_unlink(screen_list_t *node)
+{
+    if (node == screen_top) {
+        screen_top = node->prev == &screen_stack ? NULL : node->prev;
+        ic_hal_mem_arena_set(screen_arena(screen_top));
+    }
+
+    node->prev->next = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+
+    node->next = NULL;
+    node->prev = NULL;
+    screen_depth--;
+}
+
+//退出屏幕，先结束正在执行的移动动画
+static void screen_exit(screen_list_t *node)
+{
+    ic_stop_all_move_objs();
+    node->screen.cb.exit(&node->screen);
+}
+
+/*******************************************************
+ *
+ * screen cache
+ ******************************************************/
+static void screen_destroy(screen_list_t *node)
+{
+    uint32_t used;
+
+    if (node->preload) {
+        lv_task_del(node->preload);
+    }
+    else if (node->screen.cb.deinit) {
+        node->screen.cb.deinit(&node->screen);
+    }
+
+    //deinit后仍未释放的内存，可能是泄漏，也可能是屏幕运行时创建的全局对象
+    used = ic_hal_mem_arena_used(screen_arena(node));
+    if (used)
+        LOGI("screen %d deinit, %d bytes left\n", node->screen.index, used);
+
+    FREE_API(node);
+}
+
+static void screen_cache_unlink(screen_list_t *node)
+{
+    screen_cache_size -= node->cost;
+
+    node->prev->next = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+//删除最久未用的屏幕，直到满足内存预算
+static void screen_cache_trim(void)
+{
+    while (screen_cache_size > SCREEN_CACHE_SIZE && screen_cache.next) {
+        screen_list_t *node = screen_cache.next;
+
+        while (node->next)
+            node = node->next;
+
+        LOGI("screen %d dropped from cache\n", node->screen.index);
+        screen_cache_unlink(node);
+        screen_destroy(node);
+    }
+}
+
+static void screen_cache_add(screen_list_t *node)
+{
+    //预创建任务未执行时，屏幕还没有对象
+    if (node->preload || !node->screen.data) {
+        node->cost = 0;
+    }
+    else {
+        node->cost = ic_hal_mem_arena_used(screen_arena(node));
+
+        //不支持内存统计时按对象数估算
+        if (node->cost == 0)
+            node->cost = (lv_obj_count_children_recursive((lv_obj_t *)node->screen.data) + 1) * SCREEN_CACHE_OBJ_SIZE;
+    }
+
+    node->prev = &screen_cache;
+    node->next = screen_cache.next;
+    if (screen_cache.next)
+        screen_cache.next->prev = node;
+    screen_cache.next = node;
+
+    screen_cache_size += node->cost;
+    screen_cache_trim();
+}
+
+static screen_list_t *screen_cache_find(screen_index_enum screen_index)
+{
+    screen_list_t *node;
+
+    for (node = screen_cache.next; node; node = node->next) {
+        if (node->screen.index == screen_index)
+            return node;
+    }
+
+    return NULL;
+}
+
+//屏幕离开栈，可缓存的屏幕放入缓存，否则删除
+static void screen_release(screen_list_t *node)
+{
+    if (screen_cacheable[node->screen.index - SCREEN_INDEX_IDLE]) {
+        screen_cache_add(node);
+        return;
+    }
+
+    screen_destroy(node);
+}
+
+static void screen_preload_task(lv_task_t *task)
+{
+    screen_list_t *node = (screen_list_t *)task->user_data;
+    uint32_t arena;
+
+    //只执行一次，任务由lvgl删除
+    node->preload = NULL;
+
+    screen_cache_unlink(node);
+    arena = ic_hal_mem_arena_set(screen_arena(node));
+    if (node->screen.cb.init)
+        node->screen.cb.init(&node->screen);
+    ic_hal_mem_arena_set(arena);
+
+    LOGI("screen %d preloaded\n", node->screen.index);
+    screen_cache_add(node);
+}
+
+//系统内存不足时清空缓存，在gui线程调用
+static void screen_cache_pressure(void)
+{
+    if (screen_cache.next) {
+        LOGI("memory pressure, screen cache %d bytes dropped\n", screen_cache_size);
+        ic_screen_cache_clean();
+    }
+}
+
+void ic_screen_set_cache(screen_index_enum screen_index, bool enable)
+{
+    if (screen_index < SCREEN_INDEX_IDLE || screen_index >= SCREEN_INDEX_NUM)
+        return;
+
+    screen_cacheable[screen_index - SCREEN_INDEX_IDLE] = enable;
+
+    if (enable && !screen_pressure_registered)
+        screen_pressure_registered = ic_hal_mem_pressure_register(screen_cache_pressure);
+}
+
+bool ic_screen_preload(screen_index_enum screen_index, screen_callback_t *cb)
+{
+    screen_list_t *node;
+
+    if (!cb || screen_index < SCREEN_INDEX_IDLE || screen_index >= SCREEN_INDEX_NUM)
+        return false;
+    if (!screen_cacheable[screen_index - SCREEN_INDEX_IDLE])
+        return false;
+
+    //已经在栈或缓存里
+    if (screen_cache_find(screen_index))
+        return true;
+    for (node = screen_stack.next; node; node = node->next) {
+        if (node->screen.index == screen_index)
+            return true;
     }
 
-    return prev;
+    node = MALLOC_API(sizeof(screen_list_t));
+    if (!node)
+        return false;
+    memset(node, 0, sizeof(screen_list_t));
+
+    node->screen.cb = *cb;
+    node->screen.index = screen_index;
+    node->preload = lv_task_create(screen_preload_task, SCREEN_PRELOAD_DELAY, LV_TASK_PRIO_LOWEST, node);
+    if (!node->preload) {
+        FREE_API(node);
+        return false;
+    }
+    lv_task_set_repeat_count(node->preload, 1);
+
+    screen_cache_add(node);
+    return true;
 }
 
+void ic_screen_cache_clean(void)
+{
+    while (screen_cache.next) {
+        screen_list_t *node = screen_cache.next;
+
+        screen_cache_unlink(node);
+        screen_destroy(node);
+    }
+}
+
+/*******************************************************
+ *
+ * screen stack
+ ******************************************************/
 bool ic_screen_create(screen_index_enum screen_index,
         screen_callback_t *cb)
 {
-    int i = 0;
     screen_list_t *node = screen_stack.next;
-    screen_list_t *prev = &screen_stack;
     screen_list_t* current = ic_screen_get_current();
 
     if(!cb 
@@ -59,44 +278,68 @@ bool ic_screen_create(screen_index_enum screen_index,
     }
 
     //退出当前屏幕
-    if (current)current->screen.cb.exit(&current->screen);
-
-    for(i = 0; i < MAX_SCREEN_HISTORY; i++){
-        if(!node){
-            node = MALLOC_API(sizeof(screen_list_t));
-            node->next = NULL;
-            node->prev = prev;
-            prev->next = node;
-
-            node->screen.cb.init =      cb->init;
-            node->screen.cb.deinit =    cb->deinit;
-            node->screen.cb.entry =     cb->entry;
-            node->screen.cb.exit =      cb->exit;
-            node->screen.index = screen_index;
-
-            if(cb->init)cb->init(&node->screen);
+    if (current)screen_exit(current);
 
+    //如果当前要创建的屏幕已经存在，则返回
+    while (node) {
+        if (node->screen.index == screen_index) {
             return true;
         }
+        node = node->next;
+    }
 
-        //如果当前要创建的屏幕已经存在，则返回
-        if (node->screen.index == screen_index) {
-            return true;
+    if (screen_depth >= MAX_SCREEN_HISTORY) {
+        return false;
+    }
+
+    //缓存的屏幕直接使用，不重新创建
+    node = screen_cache_find(screen_index);
+    if (node) {
+        screen_cache_unlink(node);
+        node->screen.cb = *cb;
+        screen_push(node);
+
+        if (node->preload) {
+            lv_task_del(node->preload);
+            node->preload = NULL;
+            if(cb->init)cb->init(&node->screen);
         }
 
-        prev = node;
-        node = node->next;
+        return true;
+    }
 
-        
+    node = MALLOC_API(sizeof(screen_list_t));
+    if (!node) {
+        return false;
     }
+    memset(node, 0, sizeof(screen_list_t));
 
-    return false;
+    node->screen.cb.init =      cb->init;
+    node->screen.cb.deinit =    cb->deinit;
+    node->screen.cb.entry =     cb->entry;
+    node->screen.cb.exit =      cb->exit;
+    node->screen.index = screen_index;
+
+    screen_push(node);
+
+    if(cb->init)cb->init(&node->screen);
+
+    return true;
 }
 
-bool ic_screen_entry(screen_index_enum screen_index)
+//清除last后面的节点
+static void screen_truncate(screen_list_t *last)
 {
-    int i = 0;
+    while (last->next) {
+        screen_list_t *node = last->next;
+
+        screen_unlink(node);
+        screen_release(node);
+    }
+}
 
+bool ic_screen_entry(screen_index_enum screen_index)
+{
     screen_list_t *head = screen_stack.next;
     screen_list_t *node = head;
     screen_list_t* current = ic_screen_get_current();
@@ -107,43 +350,23 @@ bool ic_screen_entry(screen_index_enum screen_index)
     }
 
     //退出当前屏幕
-    if(current)current->screen.cb.exit(&current->screen);
+    if(current)screen_exit(current);
 
     //如目标屏幕是idle或者主菜单，清除链表后面的节点
     if(screen_index == SCREEN_INDEX_IDLE){
         //进屏
         head->screen.cb.entry(&head->screen);
 
-        //设置为尾节点
-        node = head->next;
-        head->next =NULL;
-
-        //清除后续节点
-        while(node){
-            node->screen.cb.deinit(&node->screen);
-            screen_list_t* temp = node->next;
-            FREE_API(node);
-            node = temp;
-        }
+        //设置为尾节点，清除后续节点
+        screen_truncate(head);
 
        return true;
     }else if(screen_index == SCREEN_INDEX_MAINMENU){
         //进屏
         head->next->screen.cb.entry(&head->next->screen);
 
-        //设置为尾节点
-        node = head->next->next; 
-        head->next->next = NULL; 
-
-        //清除后续节点
-        while(node){
-            node->screen.cb.deinit(&node->screen);
-            screen_list_t* temp = node->next;
-            
-            FREE_API(node);
-
-            node = temp;
-        }
+        //设置为尾节点，清除后续节点
+        screen_truncate(head->next);
 
        return true;
     }
@@ -154,15 +377,9 @@ bool ic_screen_entry(screen_index_enum screen_index)
             node->screen.cb.entry(&node->screen);
 
             if (node->next) {
-                //取出当前节点
-                node->prev->next = node->next;
-                node->next->prev = node->prev;
-
-                //放到尾部
-                current = ic_screen_get_current();
-                current->next = node;
-                node->prev = current;
-                node->next = NULL;
+                //取出当前节点，放到尾部
+                screen_unlink(node);
+                screen_push(node);
             }
             
             return true;
@@ -177,31 +394,24 @@ bool ic_screen_entry(screen_index_enum screen_index)
 
 bool ic_screen_goback(void)
 {
-    int i;
-    screen_list_t *node = screen_stack.next;
-    screen_list_t *prev = NULL;
     screen_list_t* current = ic_screen_get_current();
 
     if(current){
+        screen_list_t *prev = current->prev;
+
         if(current->screen.index == SCREEN_INDEX_IDLE){ //当前屏幕已经是root screen（idle），无法返回上级
             return false;
         } 
 
         //执行当前屏幕exit
-        current->screen.cb.exit(&current->screen);
-
-        //deinit
-        current->screen.cb.deinit(&current->screen);
+        screen_exit(current);
 
+        //从链表中去除当前节点，deinit或者缓存
+        screen_unlink(current);
+        screen_release(current);
 
         //进入上级屏幕
-        current->prev->screen.cb.entry(&current->prev->screen);
-
-        //从链表中去除当前节点
-        current->prev->next = NULL;
-
-        //detete
-        FREE_API(current);
+        prev->screen.cb.entry(&prev->screen);
 
         return true;
     }
@@ -217,29 +427,24 @@ bool ic_screen_close_active(void)
 bool ic_screen_goto_idle(void)
 {
     screen_list_t *head = screen_stack.next;
-    screen_list_t *node = head;
     screen_list_t* current = ic_screen_get_current();
 
-    //退出当前屏幕
-    if(current)current->screen.cb.exit(&current->screen);
+    //idle屏幕还在，不重新创建，清除后续节点后进屏
+    if (head && head->screen.index == SCREEN_INDEX_IDLE) {
+        return ic_screen_entry(SCREEN_INDEX_IDLE);
+    }
 
-    //进屏
-    //head->screen.cb.entry(&head->screen);
+    //退出当前屏幕
+    if(current)screen_exit(current);
 
-    //设置为尾节点
-    node = head;
+    //清除全部节点
+    while(screen_stack.next){
+        screen_list_t *node = screen_stack.next;
 
-    //清除后续节点
-    while(node){
-        node->screen.cb.deinit(&node->screen);
-        screen_list_t *temp = node->next;
-        FREE_API(node);
-
-        node = temp;
+        screen_unlink(node);
+        screen_release(node);
     }
 
-    screen_stack.next = NULL;
-
     main_screen_1();
 
     return true;
@@ -13,6 +13,11 @@
 
 #define MAX_SCREEN_HISTORY    (10)
 
+//屏幕缓存：允许缓存的屏幕退出后不删除，隐藏保留其对象树，再次进入时不用重新创建
+#define SCREEN_CACHE_SIZE     (64 * 1024)    //缓存屏幕的内存预算，超出时删除最久未用的屏幕
+#define SCREEN_CACHE_OBJ_SIZE (160)          //估算的单个lv对象内存，用于计算屏幕占用
+#define SCREEN_PRELOAD_DELAY  (300)          //预创建屏幕延时(ms)，在空闲时创建
+
 typedef void (*pFUN_screen)(void *obj);
 
 typedef struct {
@@ -49,6 +54,8 @@ struct screen_node{
     ic_screen_t screen;
     struct screen_node *next;
     struct screen_node *prev;
+    uint32_t cost;              //缓存时估算的内存占用
+    lv_task_t *preload;         //未执行的预创建任务
 };
 
 typedef struct screen_node screen_list_t;
@@ -62,6 +69,13 @@ extern bool ic_screen_goback(void);
 extern bool ic_screen_close_active(void);
 extern bool ic_screen_goto_idle(void);
 extern bool ic_screen_entry(screen_index_enum screen_index);
+
+//设置屏幕是否可缓存，屏幕内容要在entry里更新，否则再次进入时显示旧内容
+extern void ic_screen_set_cache(screen_index_enum screen_index, bool enable);
+//空闲时预创建可缓存的屏幕，放入缓存，之后ic_screen_create直接使用
+extern bool ic_screen_preload(screen_index_enum screen_index, screen_callback_t *cb);
+//删除全部缓存的屏幕
+extern void ic_screen_cache_clean(void);
 #endif
 
 
@@ -33,7 +33,7 @@ lv_obj_t *ic_watch_create_title_bar(lv_obj_t* parent, screen_title_bar_desc_t* d
     lv_obj_set_pos(title, 0, 0);
 
 
-    lv_label_set_text(time, _("16:25"));
+    lv_label_set_text(time, _i(LV_I18N_ID_16_25));
     lv_label_set_align(time, LV_LABEL_ALIGN_RIGHT);
     lv_obj_align(time, NULL, LV_ALIGN_IN_TOP_RIGHT, 0, 0);
 
@@ -40,6 +40,11 @@ WHEN              WHO         WHAT, WHERE, WHY
 #define QL_Lvgl_TASK_STACK_SIZE  1024*4
 #define QL_Lvgl_TASK_PRIO        APP_PRIORITY_NORMAL
 #define QL_LVGL_TASK_EVENT_CNT   5
+#define QL_LVGL_FLUSH_TASK_STACK_SIZE  1024
+#define QL_LVGL_FLUSH_TASK_PRIO        APP_PRIORITY_ABOVE_NORMAL
+#ifndef CONFIG_LV_GUI_DISP_BUF_LINES
+#define CONFIG_LV_GUI_DISP_BUF_LINES   0
+#endif
 #define FALSE    0
 #define TRUE     1
 #if !defined(require_action)
@@ -66,6 +71,9 @@ typedef struct
     ql_timer_t task_timer;          // timer to trigger task handler
     lv_disp_buf_t disp_buf;         // display buffer
     lv_disp_t *disp;                // display device    
+    ql_task_t flush_task;           // task to write display buffer to LCD
+    ql_queue_t flush_queue;         // flush requests from gui thread
+    ql_sem_t flush_done_sema;       // released at each flush done
     lv_indev_t *keypad;             // keypad device
     ql_keymap_e last_key;           // last key from ISR
     ql_keystate_e last_key_state;   // last key state from ISR    
@@ -79,6 +87,13 @@ typedef struct
  uint8_t lv_key;
 } lvGuiKeypadMap_t;
 
+typedef struct
+{
+    lv_disp_drv_t *disp;            // display driver to be notified
+    lv_color_t *color_p;            // pixels of the area
+    lv_area_t area;                 // area to be written
+} lvglFlushReq_t;
+
 
 uint32_t g_lcd_width = CONFIG_LV_GUI_HOR_RES;
 uint32_t g_lcd_height = CONFIG_LV_GUI_VER_RES;
@@ -114,18 +129,97 @@ static const lvGuiKeypadMap_t gLvKeyMap[] = {
 /*===========================================================================
  * Functions
  ===========================================================================*/
+/**
+* flush task entry, write display buffer to LCD out of gui thread
+*/
+static void prvDispFlushThread(void *param)
+{
+    lvglContext_t *d = &gLvCtx;
+    lvglFlushReq_t req;
+
+    for (;;)
+    {
+        if (ql_rtos_queue_wait(d->flush_queue, (uint8 *)&req, sizeof(req), QL_WAIT_FOREVER) != QL_OSI_SUCCESS)
+            continue;
+
+        ql_lcd_write((uint16_t*)req.color_p, req.area.x1, req.area.y1, req.area.x2, req.area.y2);
+
+        lv_disp_flush_ready(req.disp);
+        ql_rtos_semaphore_release(d->flush_done_sema);
+    }
+}
+
 /**
 * display device flush_cb
+*
+* When flush task is available, the area is handed over to flush task, and
+* gui thread can render next area into the other buffer during LCD writing.
 */
 static void prvDispFlush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
 {
-    QL_LVGLDEMO_LOG("disp flush %d/%d/%d/%d", area->x1, area->y1, area->x2, area->y2);
+    lvglContext_t *d = &gLvCtx;
+
+    if (d->flush_task != NULL)
+    {
+        lvglFlushReq_t req = {
+            .disp = disp,
+            .color_p = color_p,
+            .area = *area,
+        };
+
+        if (ql_rtos_queue_release(d->flush_queue, sizeof(req), (uint8 *)&req, QL_NO_WAIT) == QL_OSI_SUCCESS)
+            return;
+    }
 
     ql_lcd_write((uint16_t*)color_p, area->x1 , area->y1, area->x2 , area->y2);
 
     lv_disp_flush_ready(disp);
 }
 
+#ifdef QL_APP_FEATURE_LVGL_V7
+/**
+* display device wait_cb, called when gui thread waits for flush done
+*/
+static void prvDispWait(lv_disp_drv_t *disp)
+{
+    lvglContext_t *d = &gLvCtx;
+
+    // timeout to tolerate semaphore released by previous flush
+    ql_rtos_semaphore_wait(d->flush_done_sema, 5);
+}
+#endif
+
+/**
+* create flush task, and LCD writing will be performed in flush task
+*/
+static bool prvLvInitFlushTask(void)
+{
+    lvglContext_t *d = &gLvCtx;
+
+    if (ql_rtos_queue_create(&d->flush_queue, sizeof(lvglFlushReq_t), 1) != QL_OSI_SUCCESS)
+        goto failed;
+
+    if (ql_rtos_semaphore_create(&d->flush_done_sema, 0) != QL_OSI_SUCCESS)
+        goto failed;
+
+    if (ql_rtos_task_create(&d->flush_task, QL_LVGL_FLUSH_TASK_STACK_SIZE, QL_LVGL_FLUSH_TASK_PRIO,
+                            "QLVGLFLUSH", prvDispFlushThread, NULL, QL_LVGL_TASK_EVENT_CNT) != QL_OSI_SUCCESS)
+        goto failed;
+
+    return true;
+
+failed:
+    QL_LVGLDEMO_LOG("lvgl flush task init failed");
+    if (d->flush_done_sema != NULL)
+        ql_rtos_semaphore_delete(d->flush_done_sema);
+    if (d->flush_queue != NULL)
+        ql_rtos_queue_delete(d->flush_queue);
+    d->flush_task = NULL;
+    d->flush_done_sema = NULL;
+    d->flush_queue = NULL;
+    return false;
+}
+
 /**
 * initialize LCD display device
 */
@@ -133,16 +227,29 @@ static bool prvLvInitLcd(void)
 {
     lvglContext_t *d = &gLvCtx;
 
-    unsigned pixel_cnt = g_lcd_width * g_lcd_height;
-    lv_color_t *buf = (lv_color_t *)malloc(pixel_cnt * sizeof(lv_color_t));
-    if (buf == NULL)
+    unsigned lines = CONFIG_LV_GUI_DISP_BUF_LINES;
+    if (lines == 0 || lines > g_lcd_height)
+        lines = g_lcd_height;
+
+    unsigned pixel_cnt = g_lcd_width * lines;
+    lv_color_t *buf1 = (lv_color_t *)malloc(pixel_cnt * sizeof(lv_color_t));
+    if (buf1 == NULL)
         return false;
 
-    lv_disp_buf_init(&(d->disp_buf), buf, buf, pixel_cnt);
+    // the second buffer is rendered while the first one is written, it is
+    // only useful when LCD writing is performed in flush task
+    lv_color_t *buf2 = NULL;
+    if (prvLvInitFlushTask())
+        buf2 = (lv_color_t *)malloc(pixel_cnt * sizeof(lv_color_t));
+
+    lv_disp_buf_init(&(d->disp_buf), buf1, buf2, pixel_cnt);
     
     lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
     disp_drv.flush_cb = prvDispFlush;
+#ifdef QL_APP_FEATURE_LVGL_V7
+    disp_drv.wait_cb = prvDispWait;
+#endif
     disp_drv.buffer = &(d->disp_buf);
 
     lv_disp_drv_register(&disp_drv); // pointer copy; 
@@ -14,6 +14,7 @@
 #define _LV_GUI_MAIN_H_
 
 #include "osi_api.h"
+#include "drv_lcd_v2.h"
 #include "lv_gui_config.h"
 
 OSI_EXTERN_C_BEGIN
@@ -23,6 +24,45 @@ OSI_EXTERN_C_BEGIN
  */
 struct _lv_indev_t;
 
+/**
+ * \brief count of hardware overlays available to application
+ *
+ * GOUDA overlay 0 and 1 are available to application, and they are blended
+ * under littlevgl. The top most overlay is used by littlevgl.
+ */
+#define LV_GUI_OVERLAY_COUNT (DRV_LCD_OVERLAY_COUNT - 1)
+
+/**
+ * \brief count of profiled draw types: rectangle, image, label and arc
+ */
+#define LV_GUI_DRAW_TYPE_COUNT (4)
+
+/**
+ * \brief littlevgl render statistics
+ *
+ * All time are in microseconds, and accumulated since the last reset.
+ * Draw time is exclusive, that is, the time of rectangles drawn inside
+ * an arc is counted as rectangle only.
+ */
+typedef struct
+{
+    uint32_t frame_count;                          ///< count of refresh with invalidated areas
+    uint32_t area_count;                           ///< count of invalidated areas after merge
+    uint32_t refr_us;                              ///< time in display refresh
+    uint32_t refr_max_us;                          ///< maximum time of one refresh
+    uint32_t draw_us[LV_GUI_DRAW_TYPE_COUNT];      ///< time in rectangle, image, label and arc drawing
+    uint32_t wait_us;                              ///< time blocked in waiting GOUDA
+    uint32_t flush_count;                          ///< count of flush to LCD
+    uint32_t flush_bytes;                          ///< bytes of littlevgl layer flushed to LCD
+    uint32_t img_cache_hit;                        ///< count of images found in image cache
+    uint32_t img_cache_miss;                       ///< count of images decoded at draw
+    uint32_t img_open_ms;                          ///< time in image decoding, in milliseconds
+    uint32_t key_count;                            ///< count of key events read by littlevgl
+    uint32_t key_latency_us;                       ///< time from keypad ISR to littlevgl read
+    uint32_t key_latency_max_us;                   ///< maximum time from keypad ISR to littlevgl read
+    uint32_t key_dropped;                          ///< count of key events dropped on full queue
+} lvGuiPerf_t;
+
 /**
  * \brief function prototype for gui creation
  */
@@ -71,6 +111,16 @@ struct _lv_indev_t *lvGuiGetKeyPad(void);
  */
 void lvGuiThreadCallback(osiCallback_t cb, void *param);
 
+/**
+ * \brief execute a callback in gui thread, and wait it return
+ *
+ * When called in gui thread, the callback is executed directly.
+ *
+ * \param cb            callback function
+ * \param param         callback parameter
+ */
+void lvGuiThreadCallbackSync(osiCallback_t cb, void *param);
+
 /**
  * \brief send event to gui thread
  */
@@ -121,6 +171,52 @@ void lvGuiScreenOn(void);
  */
 void lvGuiScreenOff(void);
 
+/**
+ * \brief function prototype to draw always-on display
+ *
+ * It is called in gui thread, and littlevgl isn't running. It should
+ * draw by \p lvGuiAodFlush, and littlevgl objects shouldn't be used.
+ *
+ * \param param         parameter of \p lvGuiSetAod
+ * \param full          true at enter, the screen is black and should be
+ *                      drawn fully. Otherwise only changes are needed
+ * \return
+ *      - delay in ms to the next draw
+ */
+typedef uint32_t (*lvGuiAodDraw_t)(void *param, bool full);
+
+/**
+ * \brief set always-on display for screen off
+ *
+ * When set, \p lvGuiScreenOff enters always-on display rather than LCD
+ * sleep. The screen is cleared to black, LCD enters low power mode with
+ * rows of \p area in partial mode, and \p draw is called at enter and
+ * then at the delay it returns. Between the draws gui thread is blocked,
+ * and GOUDA is closed.
+ *
+ * It should be called in gui thread. When \p draw is NULL in always-on
+ * display, the screen is turned off.
+ *
+ * \param area          area to be shown, others are black
+ * \param draw          draw function, NULL to disable always-on display
+ * \param param         parameter of \p draw
+ */
+void lvGuiSetAod(const drvLcdArea_t *area, lvGuiAodDraw_t draw, void *param);
+
+/**
+ * \brief write pixels to screen in always-on display
+ *
+ * It should be called inside \p lvGuiAodDraw_t, and it returns after the
+ * transfer. So \p buf can be reused at return.
+ *
+ * \param roi           screen area
+ * \param buf           RGB565 pixels of \p roi, stride is width of \p roi
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, or not in always-on display
+ */
+bool lvGuiAodFlush(const drvLcdArea_t *roi, const void *buf);
+
 /**
  * \brief set screen off timeout at inactive
  *
@@ -143,5 +239,56 @@ void lvGuiSetInactiveTimeout(unsigned timeout);
  */
 void lvGuiSetAnimationInactive(bool inactive);
 
+/**
+ * \brief set application hardware overlay
+ *
+ * The overlay will be blended by GOUDA at data transfer, under littlevgl
+ * display. The pixels of littlevgl display in \p LV_COLOR_TRANSP are
+ * transparent, and the overlay will be shown there. It is suitable for
+ * static background (such as clockface background) or camera preview,
+ * and littlevgl needn't to render them.
+ *
+ * The overlay configuration will be copied. However, the buffer pointed by
+ * \p ovl->buf will be accessed at each flush, and it should be valid until
+ * the overlay is disabled. After the buffer content is changed, call this
+ * again to update the screen.
+ *
+ * It should be called in gui thread. The old and new overlay areas will be
+ * invalidated.
+ *
+ * \param n         overlay index, [0, LV_GUI_OVERLAY_COUNT)
+ * \param ovl       overlay configuration, NULL to disable the overlay
+ * \return
+ *      - true on success
+ *      - false on invalid parameter
+ */
+bool lvGuiSetOverlay(unsigned n, const drvLcdOverlay_t *ovl);
+
+/**
+ * \brief set application hardware video layer
+ *
+ * It is similar to \p lvGuiSetOverlay, and YUV input and scaling of video
+ * layer can be used, such as camera preview.
+ *
+ * \param vl        video layer configuration, NULL to disable video layer
+ */
+void lvGuiSetVideoLayer(const drvLcdVideoLayer_t *vl);
+
+/**
+ * \brief get littlevgl render statistics
+ *
+ * Time blocked in waiting GOUDA is from LCD driver, and includes waiting
+ * from other GOUDA users, such as camera preview.
+ * Image cache statistics are from littlevgl image cache.
+ *
+ * \param perf      output statistics
+ */
+void lvGuiGetPerf(lvGuiPerf_t *perf);
+
+/**
+ * \brief reset littlevgl render statistics
+ */
+void lvGuiResetPerf(void);
+
 OSI_EXTERN_C_END
 #endif
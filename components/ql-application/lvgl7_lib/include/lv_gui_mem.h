@@ -0,0 +1,102 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _LV_GUI_MEM_H_
+#define _LV_GUI_MEM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lv_gui_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief count of memory arenas, arena 0 is for memory not belonging to
+ *        any application screen
+ */
+#define LV_GUI_MEM_ARENA_COUNT (32)
+
+/**
+ * \brief littlevgl memory statistics
+ */
+typedef struct
+{
+    uint32_t pool_size;      ///< size of littlevgl memory pool
+    uint32_t pool_avail;     ///< available size of littlevgl memory pool
+    uint32_t pool_max_block; ///< maximum allocatable block size in pool
+    uint32_t used;           ///< allocated size, including system heap
+    uint32_t max_used;       ///< peak of allocated size
+    uint32_t heap_used;      ///< allocated size from system heap, when pool is full
+    uint32_t alloc_count;    ///< count of allocated blocks
+} lvGuiMemStat_t;
+
+/**
+ * \brief allocate memory for littlevgl
+ *
+ * It is the memory allocator of littlevgl, \p lv_mem_alloc. Memory is
+ * allocated from a dedicated block pool, with fixed size children for
+ * small objects, style lists and linked list nodes. System heap is used
+ * only when the pool is exhausted.
+ *
+ * The allocated memory is accounted to the current arena, and to memory
+ * budget \p OSI_MEM_BUDGET_LVGL. Allocation over the hard limit fails,
+ * and image cache is dropped when the soft limit is crossed.
+ *
+ * \param size      size to be allocated
+ * \return
+ *      - allocated memory pointer on success
+ *      - NULL at failure
+ */
+void *lvGuiMemAlloc(size_t size);
+
+/**
+ * \brief free memory allocated by \p lvGuiMemAlloc
+ *
+ * \param ptr       memory pointer, NULL is ignored
+ */
+void lvGuiMemFree(void *ptr);
+
+/**
+ * \brief set the current memory arena
+ *
+ * Following allocations are accounted to \p arena, until it is changed.
+ * Memory is freed by each owner as before, and arena is only for
+ * accounting. Invalid \p arena is regarded as 0.
+ *
+ * \param arena     arena index, [0, LV_GUI_MEM_ARENA_COUNT)
+ * \return
+ *      - the previous arena
+ */
+unsigned lvGuiMemSetArena(unsigned arena);
+
+/**
+ * \brief get allocated size accounted to the arena
+ *
+ * \param arena     arena index, [0, LV_GUI_MEM_ARENA_COUNT)
+ * \return
+ *      - allocated size of the arena, 0 on invalid parameter
+ */
+uint32_t lvGuiMemArenaUsed(unsigned arena);
+
+/**
+ * \brief get littlevgl memory statistics
+ *
+ * \param stat      output statistics
+ */
+void lvGuiMemGetStat(lvGuiMemStat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -51,6 +51,11 @@
  * Can be changed in the display driver (`lv_disp_drv_t`).*/
 #define LV_DISP_DEF_REFR_PERIOD      30      /*[ms]*/
 
+/* Invalid areas which don't overlap are joined if the joined area is larger
+ * by at most this many pixels. It's about the cost of refreshing one more area
+ * (looking for its top object, setting up the flush).*/
+#define LV_REFR_JOIN_OVERHEAD        1024    /*[px]*/
+
 /* Dot Per Inch: used to initialize default sizes.
  * E.g. a button with width = LV_DPI / 2 -> half inch wide
  * (Not so important, you can adjust it to modify default sizes and spaces)*/
@@ -93,9 +98,9 @@ typedef int16_t lv_coord_t;
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #  define LV_MEM_AUTO_DEFRAG  1
 #else       /*LV_MEM_CUSTOM*/
-#  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
-#  define LV_MEM_CUSTOM_ALLOC   malloc       /*Wrapper to malloc*/
-#  define LV_MEM_CUSTOM_FREE    free         /*Wrapper to free*/
+#  define LV_MEM_CUSTOM_INCLUDE "lv_gui_mem.h"   /*Header for the dynamic memory function*/
+#  define LV_MEM_CUSTOM_ALLOC   lvGuiMemAlloc    /*Dedicated pool, system heap when it is full*/
+#  define LV_MEM_CUSTOM_FREE    lvGuiMemFree     /*Wrapper to free*/
 #endif     /*LV_MEM_CUSTOM*/
 
 /* Use the standard memcpy and memset instead of LVGL's own functions.
@@ -154,14 +159,30 @@ typedef void * lv_anim_user_data_t;
 
 #endif
 
+/* Draw the rounded corners of rectangles from buffered coverage, without masks,
+ * if there are no other masks.
+ * LV_RECT_CORNER_CACHE_SIZE is the max. radius to buffer.
+ * A buffered corner has radius^2 RAM cost*/
+#define LV_RECT_CORNER_CACHE_SIZE   64
+#if LV_RECT_CORNER_CACHE_SIZE
+/*Number of buffered corners. The least recently used one is replaced*/
+#define LV_RECT_CORNER_CACHE_NUM    4
+#endif
+
 /* 1: Enable shadow drawing on rectangles*/
 #define LV_USE_SHADOW           1
 #if LV_USE_SHADOW
 /* Allow buffering some shadow calculation
  * LV_SHADOW_CACHE_SIZE is the max. shadow size to buffer,
  * where shadow size is `shadow_width + radius`
- * Caching has LV_SHADOW_CACHE_SIZE^2 RAM cost*/
-#define LV_SHADOW_CACHE_SIZE    0
+ * A buffered shadow has shadow size^2 RAM cost*/
+#define LV_SHADOW_CACHE_SIZE    64
+#if LV_SHADOW_CACHE_SIZE
+/*Number of buffered shadows. The least recently used one is replaced*/
+#define LV_SHADOW_CACHE_NUM     8
+/*Max. RAM of the buffered shadows in bytes. 0: limit the number only*/
+#define LV_SHADOW_CACHE_MEM_SIZE    (16U * 1024U)
+#endif
 #endif
 
 /*1: enable outline drawing on rectangles*/
@@ -179,6 +200,10 @@ typedef void * lv_anim_user_data_t;
 /* 1: Use the `opa_scale` style property to set the opacity of an object and its children at once*/
 #define LV_USE_OPA_SCALE        1
 
+/* 1: Cache the resolved values of the most used style properties (background, border, radius,
+ * text, image recolor) in the style lists. Faster drawing for about 20 bytes per style list*/
+#define LV_STYLE_CACHE_VALUES   1
+
 /* 1: Use image zoom and rotation*/
 #define LV_USE_IMG_TRANSFORM    1
 
@@ -208,6 +233,20 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 /*1: Use VG-Lite for CPU offload on NXP RTxxx platforms */
 #define LV_USE_GPU_NXP_VG_LITE   0
 
+/*1: Use GOUDA for CPU off-load of large fills and opaque copies on 8910 */
+#define LV_USE_GPU_8910_GOUDA    1
+/*Smallest area (in pixels) handed over to GOUDA. Smaller areas are rendered by the CPU*/
+#define LV_GPU_8910_GOUDA_SIZE_LIMIT 2048
+
+/*1: Use NEON kernels for RGB565 fills and image blending in software rendering */
+#if defined(CONFIG_LV_GUI_DRAW_NEON) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#define LV_USE_DRAW_NEON         1
+#else
+#define LV_USE_DRAW_NEON         0
+#endif
+/*1: Blend every line by software too and assert the NEON result is the same. For test builds only*/
+#define LV_DRAW_NEON_CHECK       0
+
 /* 1: Enable file system (might be required for images */
 #define LV_USE_FILESYSTEM       1
 #if LV_USE_FILESYSTEM
@@ -221,6 +260,10 @@ typedef void * lv_fs_drv_user_data_t;
 /*1: Show CPU usage and FPS count in the right bottom corner*/
 #define LV_USE_PERF_MONITOR     0
 
+/*1: Call the callback set by `lv_draw_prof_set_cb` at entry and exit of
+ * rectangle, image, label and arc drawing*/
+#define LV_USE_DRAW_PROF        1
+
 /*1: Use the functions and types from the older API if possible */
 #define LV_USE_API_EXTENSION_V6  1
 #define LV_USE_API_EXTENSION_V7  1
@@ -235,13 +278,24 @@ typedef void * lv_fs_drv_user_data_t;
 /* 1: Enable alpha indexed images */
 #define LV_IMG_CF_ALPHA         1
 
+/* Indexed and alpha indexed images are decoded to true color with alpha when opened,
+ * if they need at most this many bytes. Decoded images are drawn at once instead of
+ * line by line, and can be zoomed and rotated. The decoded image is kept in the image cache.
+ * 0: always read line by line*/
+#define LV_IMG_DECODE_FULL_MAX  (8U * 1024U)
+
 /* Default image cache size. Image caching keeps the images opened.
  * If only the built-in image formats are used there is no real advantage of caching.
  * (I.e. no new image decoder is added)
  * With complex image decoders (e.g. PNG or JPG) caching can save the continuous open/decode of images.
  * However the opened images might consume additional RAM.
  * Set it to 0 to disable caching */
-#define LV_IMG_CACHE_DEF_SIZE       1
+#define LV_IMG_CACHE_DEF_SIZE       8
+
+/* Memory budget of the decoded images in the cache in bytes.
+ * The least recently used images are closed when it is exceeded.
+ * Set it to 0 to limit the count of images only */
+#define LV_IMG_CACHE_MEM_SIZE       (48U * 1024U)
 
 /*Declare the type of the user data of image decoder (can be e.g. `void *`, `int`, `struct`)*/
 typedef void * lv_img_decoder_user_data_t;
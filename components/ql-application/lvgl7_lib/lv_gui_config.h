@@ -35,6 +35,61 @@
  */
 #define CONFIG_LV_GUI_VER_RES 128
 
+/**
+ * LittlevGL GUI display buffer size in lines, 0 for full screen
+ */
+#define CONFIG_LV_GUI_DISP_BUF_LINES 40
+
+/**
+ * whether to use two display buffers
+ *
+ * When enabled, LittlevGL can render into one buffer while the other one
+ * is being transferred to LCD.
+ */
+#define CONFIG_LV_GUI_DISP_DOUBLE_BUF
+
+/**
+ * size of littlevgl memory pool
+ *
+ * littlevgl objects, styles and texts are allocated from this pool, rather
+ * than the system heap shared with network and TLS. System heap is used
+ * when the pool is exhausted.
+ */
+#define CONFIG_LV_GUI_MEM_POOL_SIZE (64 * 1024)
+
+/**
+ * whether to use NEON kernels in littlevgl software rendering
+ *
+ * Solid, opacity and masked fills and image blending of RGB565 are done
+ * 8 pixels at once. It takes effect only when compiled with NEON.
+ */
+#define CONFIG_LV_GUI_DRAW_NEON
+
+/**
+ * relaxed timeout of gui task timer in ms, when nothing is animating
+ *
+ * The gui timer can be delayed in sleep, to be merged with other wakeups.
+ * Animation frames are always in time.
+ */
+#define CONFIG_LV_GUI_TASK_RELAXED_MS 100
+
+/**
+ * relaxed timeout of always-on display timer in ms
+ *
+ * The always-on display is drawn once per minute in screen off, and the
+ * wakeup can be merged with others within this delay.
+ */
+#define CONFIG_LV_GUI_AOD_RELAXED_MS 1000
+
+/**
+ * whether to show render statistics at the top of screen, for debug
+ *
+ * Frame rate, refresh time, GOUDA waiting time and flush throughput of
+ * the last second are shown. The statistics label itself is redrawn
+ * every second.
+ */
+/* #undef CONFIG_LV_GUI_PERF_MONITOR */
+
 /**
  * Screen off timeout
  */
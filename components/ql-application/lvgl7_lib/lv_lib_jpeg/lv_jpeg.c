@@ -0,0 +1,525 @@
+/**
+ * @file lv_jpeg.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#if 1
+#include <lvgl.h>
+#else
+#include <lvgl/lvgl.h>
+#endif
+
+#include "lv_jpeg.h"
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include "jpeglib.h"
+#include "jerror.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define JPEG_FILE_BUF_SIZE  512
+
+/*Width and height are 11 bits in the image header*/
+#define JPEG_SIZE_MAX       2047
+
+/*Row pointers passed to libjpeg at once, not less than an MCU row*/
+#define JPEG_ROWS_MAX       16
+
+/*Decoded pixels are in the color format of the display*/
+#if LV_COLOR_DEPTH == 16
+#define JPEG_OUT_COLOR_SPACE JCS_RGB565
+#elif LV_COLOR_DEPTH == 32
+#define JPEG_OUT_COLOR_SPACE JCS_EXT_BGRA
+#else
+#error "lv_jpeg: LV_COLOR_DEPTH 16 or 32 is required"
+#endif
+
+#if JPEG_LIB_VERSION >= 70
+#define JPEG_MIN_DCT_SCALED_SIZE(cinfo) ((cinfo)->min_DCT_v_scaled_size)
+#else
+#define JPEG_MIN_DCT_SCALED_SIZE(cinfo) ((cinfo)->min_DCT_scaled_size)
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/*libjpeg error manager, errors return to the decoder function by longjmp*/
+typedef struct {
+    struct jpeg_error_mgr pub;
+    jmp_buf jmp;
+} jpeg_error_t;
+
+/*libjpeg source manager of a file*/
+typedef struct {
+    struct jpeg_source_mgr pub;
+    lv_fs_file_t file;
+    uint8_t buf[JPEG_FILE_BUF_SIZE];
+} jpeg_file_src_t;
+
+/**
+ * JPEG decoder. Large images are decoded by MCU rows into `rows`, and
+ * libjpeg restarts from the first row when an upper row is requested.
+ */
+typedef struct {
+    struct jpeg_decompress_struct cinfo;
+    jpeg_error_t err;
+    const uint8_t * mem;        /*JPEG in a C array, NULL for a file*/
+    uint32_t mem_size;
+    jpeg_file_src_t * fsrc;
+    uint8_t started;            /*Decompression is started*/
+    uint8_t denom;              /*DCT scaling, 1/denom*/
+    uint32_t w;                 /*Size of the scaled image*/
+    uint32_t h;
+    uint8_t * rows;             /*Decoded MCU row*/
+    uint32_t row_max;           /*Lines of an MCU row*/
+    uint32_t row_first;         /*Index of the first line in `rows`*/
+    uint32_t row_cnt;           /*Decoded lines in `rows`*/
+} jpeg_stream_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_res_t decoder_info(struct _lv_img_decoder * decoder, const void * src, lv_img_header_t * header);
+static lv_res_t decoder_open(lv_img_decoder_t * dec, lv_img_decoder_dsc_t * dsc);
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc,
+                                  lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf);
+static void decoder_close(lv_img_decoder_t * dec, lv_img_decoder_dsc_t * dsc);
+
+static jpeg_stream_t * stream_create(const void * src, lv_img_src_t src_type);
+static void stream_header(jpeg_stream_t * s);
+static void stream_start(jpeg_stream_t * s);
+static uint32_t stream_read(jpeg_stream_t * s, uint8_t * buf, uint32_t lines);
+static void stream_stop(jpeg_stream_t * s);
+static void stream_close(jpeg_stream_t * s);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_coord_t target_w;
+static lv_coord_t target_h;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Register the JPEG decoder functions in LittlevGL
+ */
+void lv_jpeg_init(void)
+{
+    lv_img_decoder_t * dec = lv_img_decoder_create();
+    lv_img_decoder_set_info_cb(dec, decoder_info);
+    lv_img_decoder_set_open_cb(dec, decoder_open);
+    lv_img_decoder_set_read_line_cb(dec, decoder_read_line);
+    lv_img_decoder_set_close_cb(dec, decoder_close);
+}
+
+/**
+ * Set the size the following JPEG images are shown in
+ */
+void lv_jpeg_set_target_size(lv_coord_t w, lv_coord_t h)
+{
+    target_w = w;
+    target_h = h;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static bool is_jpeg_src(const void * src, lv_img_src_t src_type)
+{
+    if(src_type == LV_IMG_SRC_FILE) {
+        const char * ext = lv_fs_get_ext(src);      /*Check the extension*/
+        return !strcmp(ext, "jpg") || !strcmp(ext, "JPG") || !strcmp(ext, "jpeg") || !strcmp(ext, "JPEG");
+    }
+
+    if(src_type == LV_IMG_SRC_VARIABLE) {
+        const lv_img_dsc_t * img_dsc = src;         /*Check the SOI marker*/
+        return img_dsc->header.cf == LV_IMG_CF_RAW && img_dsc->data_size >= 3 &&
+               img_dsc->data[0] == 0xFF && img_dsc->data[1] == 0xD8 && img_dsc->data[2] == 0xFF;
+    }
+
+    return false;
+}
+
+/**
+ * Get info about a JPEG image, the size is after DCT scaling
+ * @param src can be file name or pointer to a C array
+ * @param header store the info here
+ * @return LV_RES_OK: no error; LV_RES_INV: can't get the info
+ */
+static lv_res_t decoder_info(struct _lv_img_decoder * decoder, const void * src, lv_img_header_t * header)
+{
+    (void) decoder; /*Unused*/
+    lv_img_src_t src_type = lv_img_src_get_type(src);          /*Get the source type*/
+
+    if(!is_jpeg_src(src, src_type)) return LV_RES_INV;
+
+    jpeg_stream_t * s = stream_create(src, src_type);
+    if(s == NULL) return LV_RES_INV;
+
+    if(setjmp(s->err.jmp)) {
+        stream_close(s);
+        return LV_RES_INV;
+    }
+
+    stream_header(s);
+
+    header->always_zero = 0;
+    header->cf = LV_IMG_CF_RAW;
+    header->w = (lv_coord_t)s->w;
+    header->h = (lv_coord_t)s->h;
+
+    stream_close(s);
+    return LV_RES_OK;
+}
+
+/**
+ * Open a JPEG image and return the decided image
+ * Small images are decoded fully into the color format of the display.
+ * Images larger than `LV_JPEG_DECODE_FULL_MAX` are decoded by MCU rows in `read_line`.
+ * @param src can be file name or pointer to a C array
+ * @param style style of the image object (unused now but certain formats might use it)
+ * @return pointer to the decoded image or  `LV_IMG_DECODER_OPEN_FAIL` if failed
+ */
+static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
+{
+    (void) decoder; /*Unused*/
+
+    if(!is_jpeg_src(dsc->src, dsc->src_type)) return LV_RES_INV;
+
+    jpeg_stream_t * s = stream_create(dsc->src, dsc->src_type);
+    if(s == NULL) return LV_RES_INV;
+
+    uint8_t * volatile img_data = NULL;
+    if(setjmp(s->err.jmp)) {
+        lv_mem_free(img_data);
+        stream_close(s);
+        return LV_RES_INV;
+    }
+
+    stream_header(s);
+
+    uint32_t line_size = s->w * sizeof(lv_color_t);
+    if(line_size * s->h > LV_JPEG_DECODE_FULL_MAX) {
+        /*Keep the decoder, decompression is started at the first read_line*/
+        dsc->user_data = s;
+        dsc->img_data = NULL;
+        return LV_RES_OK;
+    }
+
+    img_data = lv_mem_alloc(line_size * s->h);
+    if(img_data == NULL) {
+        stream_close(s);
+        return LV_RES_INV;
+    }
+
+    stream_start(s);
+    uint32_t y = 0;
+    while(y < s->h) {
+        uint32_t n = stream_read(s, img_data + y * line_size, s->h - y);
+        if(n == 0) longjmp(s->err.jmp, 1);
+        y += n;
+    }
+
+    stream_close(s);
+    dsc->img_data = img_data;
+    return LV_RES_OK;     /*The image is fully decoded. Return with its pointer*/
+}
+
+/**
+ * Decode a line of a large image. A whole MCU row is decoded into the row
+ * buffer, so the following lines and other parts of the line are copied.
+ * Decompression is stopped after the last row, to free libjpeg buffers.
+ */
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc,
+                                  lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf)
+{
+    (void) decoder; /*Unused*/
+    jpeg_stream_t * s = dsc->user_data;
+
+    if(s == NULL || y < 0 || (uint32_t)y >= s->h || x < 0 || (uint32_t)(x + len) > s->w) return LV_RES_INV;
+
+    if(setjmp(s->err.jmp)) {
+        stream_stop(s);
+        s->row_cnt = 0;
+        return LV_RES_INV;
+    }
+
+    uint32_t line_size = s->w * sizeof(lv_color_t);
+    while((uint32_t)y < s->row_first || (uint32_t)y >= s->row_first + s->row_cnt) {
+        if(!s->started || (uint32_t)y < s->row_first) {
+            stream_stop(s);
+            stream_header(s);
+            stream_start(s);
+        }
+
+        if(s->rows == NULL) {
+            s->rows = lv_mem_alloc(line_size * s->row_max);
+            if(s->rows == NULL) longjmp(s->err.jmp, 1);
+        }
+
+        s->row_first = s->cinfo.output_scanline;
+        s->row_cnt = 0;
+        while(s->row_cnt < s->row_max && s->cinfo.output_scanline < s->h) {
+            uint32_t n = stream_read(s, s->rows + s->row_cnt * line_size, s->row_max - s->row_cnt);
+            if(n == 0) longjmp(s->err.jmp, 1);
+            s->row_cnt += n;
+        }
+
+        if(s->cinfo.output_scanline >= s->h) stream_stop(s);
+    }
+
+    memcpy(buf, s->rows + (y - s->row_first) * line_size + x * sizeof(lv_color_t), len * sizeof(lv_color_t));
+    return LV_RES_OK;
+}
+
+/**
+ * Free the allocated resources
+ */
+static void decoder_close(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
+{
+    (void) decoder; /*Unused*/
+    if(dsc->img_data) lv_mem_free((uint8_t *)dsc->img_data);
+    if(dsc->user_data) stream_close(dsc->user_data);
+}
+
+/*=====================
+ * libjpeg managers
+ *====================*/
+
+static void error_exit(j_common_ptr cinfo)
+{
+    jpeg_error_t * err = (jpeg_error_t *)cinfo->err;
+    (*cinfo->err->output_message)(cinfo);
+    longjmp(err->jmp, 1);
+}
+
+static void output_message(j_common_ptr cinfo)
+{
+    char msg[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, msg);
+    LV_LOG_WARN("lv_jpeg: %s", msg);
+}
+
+static void file_init_source(j_decompress_ptr cinfo)
+{
+    (void) cinfo; /*Unused*/
+}
+
+static boolean file_fill_input_buffer(j_decompress_ptr cinfo)
+{
+    jpeg_file_src_t * fsrc = (jpeg_file_src_t *)cinfo->src;
+    uint32_t rn = 0;
+
+    if(lv_fs_read(&fsrc->file, fsrc->buf, JPEG_FILE_BUF_SIZE, &rn) != LV_FS_RES_OK) rn = 0;
+
+    /*Insert a fake EOI marker at the end, the same as jdatasrc.c*/
+    if(rn == 0) {
+        WARNMS(cinfo, JWRN_JPEG_EOF);
+        fsrc->buf[0] = 0xFF;
+        fsrc->buf[1] = JPEG_EOI;
+        rn = 2;
+    }
+
+    fsrc->pub.next_input_byte = fsrc->buf;
+    fsrc->pub.bytes_in_buffer = rn;
+    return TRUE;
+}
+
+static void file_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+    jpeg_file_src_t * fsrc = (jpeg_file_src_t *)cinfo->src;
+    uint32_t pos;
+
+    if(num_bytes <= 0) return;
+
+    if((size_t)num_bytes <= fsrc->pub.bytes_in_buffer) {
+        fsrc->pub.next_input_byte += num_bytes;
+        fsrc->pub.bytes_in_buffer -= num_bytes;
+        return;
+    }
+
+    /*Seek over the data out of the read buffer*/
+    num_bytes -= fsrc->pub.bytes_in_buffer;
+    fsrc->pub.bytes_in_buffer = 0;
+    if(lv_fs_tell(&fsrc->file, &pos) != LV_FS_RES_OK ||
+       lv_fs_seek(&fsrc->file, pos + num_bytes) != LV_FS_RES_OK) {
+        ERREXIT(cinfo, JERR_FILE_READ);
+    }
+}
+
+static void file_term_source(j_decompress_ptr cinfo)
+{
+    (void) cinfo; /*Unused*/
+}
+
+/*=====================
+ * Stream
+ *====================*/
+
+/**
+ * Choose DCT scaling. The image is scaled down while the scaled image still
+ * covers the target size, or it is too large for the image header.
+ */
+static uint8_t stream_get_denom(uint32_t w, uint32_t h)
+{
+    uint32_t tw = target_w > 0 ? (uint32_t)target_w : (uint32_t)lv_disp_get_hor_res(NULL);
+    uint32_t th = target_h > 0 ? (uint32_t)target_h : (uint32_t)lv_disp_get_ver_res(NULL);
+    uint8_t denom = 1;
+
+    while(denom < 8) {
+        uint32_t next = denom * 2;
+        bool cover = (w + next - 1) / next >= tw && (h + next - 1) / next >= th;
+        bool too_large = (w + denom - 1) / denom > JPEG_SIZE_MAX || (h + denom - 1) / denom > JPEG_SIZE_MAX;
+        if(!cover && !too_large) break;
+        denom = next;
+    }
+    return denom;
+}
+
+static jpeg_stream_t * stream_create(const void * src, lv_img_src_t src_type)
+{
+    jpeg_stream_t * s = lv_mem_alloc(sizeof(jpeg_stream_t));
+    if(s == NULL) return NULL;
+    _lv_memset_00(s, sizeof(jpeg_stream_t));
+
+    if(src_type == LV_IMG_SRC_VARIABLE) {
+        const lv_img_dsc_t * img_dsc = src;
+        s->mem = img_dsc->data;
+        s->mem_size = img_dsc->data_size;
+    }
+    else {
+        s->fsrc = lv_mem_alloc(sizeof(jpeg_file_src_t));
+        if(s->fsrc == NULL) {
+            lv_mem_free(s);
+            return NULL;
+        }
+        _lv_memset_00(s->fsrc, sizeof(jpeg_file_src_t));
+        if(lv_fs_open(&s->fsrc->file, src, LV_FS_MODE_RD) != LV_FS_RES_OK) {
+            lv_mem_free(s->fsrc);
+            lv_mem_free(s);
+            return NULL;
+        }
+        s->fsrc->pub.init_source = file_init_source;
+        s->fsrc->pub.fill_input_buffer = file_fill_input_buffer;
+        s->fsrc->pub.skip_input_data = file_skip_input_data;
+        s->fsrc->pub.resync_to_restart = jpeg_resync_to_restart;
+        s->fsrc->pub.term_source = file_term_source;
+    }
+
+    s->cinfo.err = jpeg_std_error(&s->err.pub);
+    s->err.pub.error_exit = error_exit;
+    s->err.pub.output_message = output_message;
+    if(setjmp(s->err.jmp)) {
+        stream_close(s);
+        return NULL;
+    }
+    jpeg_create_decompress(&s->cinfo);
+    return s;
+}
+
+/**
+ * Read the header from the start of the source, and set the output
+ * parameters. It is called inside setjmp of the caller.
+ */
+static void stream_header(jpeg_stream_t * s)
+{
+    struct jpeg_decompress_struct * cinfo = &s->cinfo;
+
+    if(s->mem) {
+        jpeg_mem_src(cinfo, s->mem, s->mem_size);
+    }
+    else {
+        if(lv_fs_seek(&s->fsrc->file, 0) != LV_FS_RES_OK) ERREXIT(cinfo, JERR_FILE_READ);
+        s->fsrc->pub.next_input_byte = NULL;
+        s->fsrc->pub.bytes_in_buffer = 0;
+        cinfo->src = &s->fsrc->pub;
+    }
+
+    jpeg_read_header(cinfo, TRUE);
+
+    if(s->denom == 0) s->denom = stream_get_denom(cinfo->image_width, cinfo->image_height);
+
+    cinfo->out_color_space = JPEG_OUT_COLOR_SPACE;
+    cinfo->scale_num = 1;
+    cinfo->scale_denom = s->denom;
+    cinfo->dct_method = JDCT_IFAST;
+    cinfo->dither_mode = JDITHER_NONE;
+    cinfo->do_fancy_upsampling = FALSE;
+    jpeg_calc_output_dimensions(cinfo);
+
+    if(cinfo->output_width > JPEG_SIZE_MAX || cinfo->output_height > JPEG_SIZE_MAX) {
+        ERREXIT1(cinfo, JERR_IMAGE_TOO_BIG, JPEG_SIZE_MAX);
+    }
+
+    s->w = cinfo->output_width;
+    s->h = cinfo->output_height;
+    s->row_max = cinfo->max_v_samp_factor * JPEG_MIN_DCT_SCALED_SIZE(cinfo);
+    if(s->row_max == 0 || s->row_max > JPEG_ROWS_MAX) s->row_max = JPEG_ROWS_MAX;
+}
+
+static void stream_start(jpeg_stream_t * s)
+{
+    jpeg_start_decompress(&s->cinfo);
+    s->started = 1;
+}
+
+/**
+ * Decode at most `lines` lines into `buf`, the stride is the image width.
+ * It is called inside setjmp of the caller.
+ * @return count of decoded lines
+ */
+static uint32_t stream_read(jpeg_stream_t * s, uint8_t * buf, uint32_t lines)
+{
+    JSAMPROW row[JPEG_ROWS_MAX];
+    uint32_t line_size = s->w * sizeof(lv_color_t);
+    uint32_t i;
+
+    if(lines > JPEG_ROWS_MAX) lines = JPEG_ROWS_MAX;
+    for(i = 0; i < lines; i++) row[i] = buf + i * line_size;
+
+    uint32_t n = jpeg_read_scanlines(&s->cinfo, row, lines);
+
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP
+    uint32_t px_cnt = n * s->w;
+    for(i = 0; i < px_cnt; i++) {
+        uint8_t c = buf[i * 2];
+        buf[i * 2] = buf[i * 2 + 1];
+        buf[i * 2 + 1] = c;
+    }
+#endif
+    return n;
+}
+
+/**
+ * Stop decompression and free libjpeg image buffers, the header should be
+ * read again to restart.
+ */
+static void stream_stop(jpeg_stream_t * s)
+{
+    jpeg_abort_decompress(&s->cinfo);
+    s->started = 0;
+}
+
+static void stream_close(jpeg_stream_t * s)
+{
+    jpeg_destroy_decompress(&s->cinfo);
+    if(s->fsrc) {
+        lv_fs_close(&s->fsrc->file);
+        lv_mem_free(s->fsrc);
+    }
+    lv_mem_free(s->rows);
+    lv_mem_free(s);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file lv_jpeg.h
+ *
+ */
+
+#ifndef LV_JPEG_H
+#define LV_JPEG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#if 1
+#include <lvgl.h>
+#else
+#include <lvgl/lvgl.h>
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Images decoded to more bytes than this are decoded by MCU rows at drawing, without a frame buffer*/
+#ifndef LV_JPEG_DECODE_FULL_MAX
+#define LV_JPEG_DECODE_FULL_MAX (64U * 1024U)
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Register the JPEG decoder functions in LittlevGL
+ */
+void lv_jpeg_init(void);
+
+/**
+ * Set the size the following JPEG images are shown in.
+ * An image is decoded with DCT scaling of 1/2, 1/4 or 1/8, when the scaled
+ * image still covers the size. The size is used when the image source is
+ * set, so it should be set before `lv_img_set_src`, and a source should
+ * always be shown in the same size.
+ * @param w width, 0 for the horizontal resolution of the default display
+ * @param h height, 0 for the vertical resolution of the default display
+ */
+void lv_jpeg_set_target_size(lv_coord_t w, lv_coord_t h);
+
+/**********************
+ *      MACROS
+ **********************/
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LV_JPEG_H*/
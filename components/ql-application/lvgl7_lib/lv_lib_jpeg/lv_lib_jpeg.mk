@@ -0,0 +1,3 @@
+LV_LIB_JPEG_DIR_NAME ?= lv_lib_jpeg
+
+CSRCS += $(wildcard $(LVGL_DIR)/$(LV_LIB_JPEG_DIR_NAME)/*.c)
@@ -16,26 +16,133 @@
 #include "lodepng.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 /*********************
  *      DEFINES
  *********************/
+/*The same allocator as lodepng, images decoded by lodepng are freed in `decoder_close`*/
+#if defined(_MSC_VER)
+#define PNG_MALLOC(size)    malloc(size)
+#define PNG_FREE(ptr)       free(ptr)
+#else
+#define PNG_MALLOC(size)    lv_mem_alloc(size)
+#define PNG_FREE(ptr)       lv_mem_free(ptr)
+#endif
+
+/*Size of the read buffer of file sources*/
+#define PNG_FILE_BUF_SIZE   512
+
+/*Width and height are 11 bits in `lv_img_header_t`*/
+#define PNG_SIZE_MAX        2047
+
+#define PNG_CHUNK_TYPE(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+/*Deflate block type when the next block header should be read*/
+#define PNG_BLOCK_NONE      0xff
 
 /**********************
  *      TYPEDEFS
  **********************/
 
+/*Canonical Huffman code, symbols sorted by code length*/
+typedef struct {
+    uint16_t count[16];
+    uint16_t symbol[288];
+} png_huffman_t;
+
+/**
+ * Streaming PNG decoder. IDAT is inflated through a deflate window and
+ * unfiltered row by row, so only the window and two rows are needed.
+ */
+typedef struct {
+    /*Source*/
+    const uint8_t * mem;        /*PNG in a C array, NULL for a file*/
+    uint32_t mem_size;
+    uint32_t mem_pos;
+#if LV_PNG_USE_LV_FILESYSTEM
+    lv_fs_file_t file;
+#else
+    FILE * file;
+#endif
+    uint8_t * fbuf;             /*Read buffer of file*/
+    uint32_t fbuf_len;
+    uint32_t fbuf_pos;
+    uint32_t file_pos;          /*File position of the read buffer end*/
+    uint32_t idat_pos;          /*Source position of the first IDAT data*/
+    uint32_t idat_len;          /*Length of the first IDAT chunk*/
+    uint32_t chunk_left;        /*Remaining data of the current IDAT chunk*/
+
+    /*Bit reader and inflate*/
+    uint32_t bitbuf;
+    uint8_t bitcnt;
+    uint8_t error;
+    uint8_t last_block;
+    uint8_t block_type;
+    uint32_t stored_left;       /*Remaining bytes of a stored block*/
+    uint16_t copy_len;          /*Remaining bytes of a match*/
+    uint16_t copy_dist;
+    uint8_t * window;
+    uint32_t window_size;
+    uint32_t window_pos;
+    uint32_t total_out;
+    png_huffman_t lencode;
+    png_huffman_t distcode;
+
+    /*Image*/
+    uint32_t w;
+    uint32_t h;
+    uint8_t depth;
+    uint8_t color_type;
+    uint8_t interlace;
+    uint8_t alpha;              /*Has alpha channel or tRNS*/
+    uint8_t filter_bpp;         /*Bytes of a complete pixel for unfiltering, at least 1*/
+    uint32_t row_bytes;         /*Bytes of a row without the filter type byte*/
+    uint16_t trns[3];           /*Transparent gray or RGB sample*/
+    uint8_t trns_set;
+    uint16_t palette_size;
+    uint8_t palette[256][4];    /*RGBA*/
+    uint8_t * prev_row;         /*The last decoded row, with the filter type byte*/
+    uint8_t * cur_row;
+    uint32_t next_row;          /*Index of the next row to decode*/
+} png_stream_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static lv_res_t decoder_info(struct _lv_img_decoder * decoder, const void * src, lv_img_header_t * header);
 static lv_res_t decoder_open(lv_img_decoder_t * dec, lv_img_decoder_dsc_t * dsc);
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc,
+                                  lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf);
 static void decoder_close(lv_img_decoder_t * dec, lv_img_decoder_dsc_t * dsc);
+static lv_res_t decode_lodepng(lv_img_decoder_dsc_t * dsc);
 static void convert_color_depth(uint8_t * img, uint32_t px_cnt);
 
+static png_stream_t * stream_open(const void * src, lv_img_src_t src_type);
+static lv_res_t stream_start(png_stream_t * s);
+static lv_res_t stream_decode_row(png_stream_t * s);
+static void stream_convert_row(png_stream_t * s, uint32_t x, uint32_t len, uint8_t * out);
+static void stream_close(png_stream_t * s);
+
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const uint16_t len_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t len_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
 
 /**********************
  *      MACROS
@@ -53,6 +160,7 @@ void lv_png_init(void)
     lv_img_decoder_t * dec = lv_img_decoder_create();
     lv_img_decoder_set_info_cb(dec, decoder_info);
     lv_img_decoder_set_open_cb(dec, decoder_open);
+    lv_img_decoder_set_read_line_cb(dec, decoder_read_line);
     lv_img_decoder_set_close_cb(dec, decoder_close);
 }
 
@@ -60,6 +168,26 @@ void lv_png_init(void)
  *   STATIC FUNCTIONS
  **********************/
 
+static bool is_png_src(const void * src, lv_img_src_t src_type)
+{
+    if(src_type == LV_IMG_SRC_FILE) {
+        const char * fn = src;
+        size_t fn_len = strlen(fn);
+        return fn_len >= 3 && !strcmp(&fn[fn_len - 3], "png");      /*Check the extension*/
+    }
+
+    return src_type == LV_IMG_SRC_VARIABLE;
+}
+
+/**
+ * Get the color format of the decoded image.
+ * Interlaced images are decoded by lodepng to ARGB8888 and converted with alpha.
+ */
+static lv_img_cf_t stream_get_cf(const png_stream_t * s)
+{
+    return (s->alpha || s->interlace) ? LV_IMG_CF_RAW_ALPHA : LV_IMG_CF_RAW;
+}
+
 /**
  * Get info about a PNG image
  * @param src can be file name or pointer to a C array
@@ -69,129 +197,112 @@ void lv_png_init(void)
 static lv_res_t decoder_info(struct _lv_img_decoder * decoder, const void * src, lv_img_header_t * header)
 {
     (void) decoder; /*Unused*/
-     lv_img_src_t src_type = lv_img_src_get_type(src);          /*Get the source type*/
-
-     /*If it's a PNG file...*/
-     if(src_type == LV_IMG_SRC_FILE) {
-         const char * fn = src;
-         if(!strcmp(&fn[strlen(fn) - 3], "png")) {              /*Check the extension*/
-
-             /* Read the width and height from the file. They have a constant location:
-              * [16..23]: width
-              * [24..27]: height
-              */
-             uint32_t size[2];
-#if LV_PNG_USE_LV_FILESYSTEM
-             lv_fs_file_t f;
-             lv_fs_res_t res = lv_fs_open(&f, fn, LV_FS_MODE_RD);
-             if(res != LV_FS_RES_OK) return -1;
-             lv_fs_seek(&f, 16);
-             uint32_t rn;
-             lv_fs_read(&f, &size, 8, &rn);
-             if(rn != 8) return LV_RES_INV;
-             lv_fs_close(&f);
-#else
-             FILE* file;
-             file = fopen(fn, "rb" );
-             if(!file) return LV_RES_INV;
-             fseek(file, 16, SEEK_SET);
-             size_t rn = fread(size, 1 , 8, file);
-             fclose(file);
-             if(rn != 8) return LV_RES_INV;
-#endif
-             /*Save the data in the header*/
-             header->always_zero = 0;
-             header->cf = LV_IMG_CF_RAW_ALPHA;
-             /*The width and height are stored in Big endian format so convert them to little endian*/
-             header->w = (lv_coord_t) ((size[0] & 0xff000000) >> 24) +  ((size[0] & 0x00ff0000) >> 8);
-             header->h = (lv_coord_t) ((size[1] & 0xff000000) >> 24) +  ((size[1] & 0x00ff0000) >> 8);
+    lv_img_src_t src_type = lv_img_src_get_type(src);          /*Get the source type*/
 
-             return LV_RES_OK;
-         }
-     }
-     /*If it's a PNG file in a  C array...*/
-     else if(src_type == LV_IMG_SRC_VARIABLE) {
-         const lv_img_dsc_t * img_dsc = src;
-         header->always_zero = 0;
-         header->cf = img_dsc->header.cf;       /*Save the color format*/
-         header->w = img_dsc->header.w;         /*Save the color width*/
-         header->h = img_dsc->header.h;         /*Save the color height*/
-         return LV_RES_OK;
-     }
+    if(!is_png_src(src, src_type)) return LV_RES_INV;
 
-     return LV_RES_INV;         /*If didn't succeeded earlier then it's an error*/
-}
+    /*Chunks before IDAT are parsed, for the size and whether there is alpha*/
+    png_stream_t * s = stream_open(src, src_type);
+    if(s == NULL) return LV_RES_INV;
 
+    header->always_zero = 0;
+    header->cf = stream_get_cf(s);
+    header->w = (lv_coord_t)s->w;
+    header->h = (lv_coord_t)s->h;
+
+    stream_close(s);
+    return LV_RES_OK;
+}
 
 /**
  * Open a PNG image and return the decided image
+ * Small images are decoded fully into the color format of the display.
+ * Images larger than `LV_PNG_DECODE_FULL_MAX` are decoded line by line in `read_line`.
  * @param src can be file name or pointer to a C array
  * @param style style of the image object (unused now but certain formats might use it)
  * @return pointer to the decoded image or  `LV_IMG_DECODER_OPEN_FAIL` if failed
  */
 static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
 {
-
     (void) decoder; /*Unused*/
-    uint32_t error;                 /*For the return values of PNG decoder functions*/
 
-    uint8_t * img_data = NULL;
-
-    /*If it's a PNG file...*/
-    if(dsc->src_type == LV_IMG_SRC_FILE) {
-        const char * fn = dsc->src;
+    if(!is_png_src(dsc->src, dsc->src_type)) return LV_RES_INV;
 
-        if(!strcmp(&fn[strlen(fn) - 3], "png")) {              /*Check the extension*/
+    png_stream_t * s = stream_open(dsc->src, dsc->src_type);
+    if(s == NULL) return LV_RES_INV;
 
-            /*Load the PNG file into buffer. It's still compressed (not decoded)*/
-            unsigned char * png_data;      /*Pointer to the loaded data. Same as the original file just loaded into the RAM*/
-            size_t png_data_size;          /*Size of `png_data` in bytes*/
+    /*Adam7 can't be decoded row by row*/
+    if(s->interlace) {
+        stream_close(s);
+        return decode_lodepng(dsc);
+    }
 
-            error = lodepng_load_file(&png_data, &png_data_size, fn);   /*Load the file*/
-            if(error) {
-                printf("error %u: %s\n", error, lodepng_error_text(error));
-                return LV_RES_INV;
-            }
+    uint32_t px_size = s->alpha ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t);
+    uint32_t line_size = s->w * px_size;
 
-            /*Decode the PNG image*/
-            uint32_t png_width;             /*Will be the width of the decoded image*/
-            uint32_t png_height;            /*Will be the width of the decoded image*/
+    if(line_size * s->h > LV_PNG_DECODE_FULL_MAX) {
+        /*Keep the stream, the window is allocated at the first read_line*/
+        dsc->user_data = s;
+        dsc->img_data = NULL;
+        return LV_RES_OK;
+    }
 
-            /*Decode the loaded image in ARGB8888 */
-            error = lodepng_decode32(&img_data, &png_width, &png_height, png_data, png_data_size);
-            free(png_data); /*Free the loaded file*/
-            if(error) {
-                printf("error %u: %s\n", error, lodepng_error_text(error));
-                return LV_RES_INV;
-            }
+    uint8_t * img_data = PNG_MALLOC(line_size * s->h);
+    if(img_data == NULL || stream_start(s) != LV_RES_OK) {
+        PNG_FREE(img_data);
+        stream_close(s);
+        return LV_RES_INV;
+    }
 
-            /*Convert the image to the system's color depth*/
-            convert_color_depth(img_data,  png_width * png_height);
-            dsc->img_data = img_data;
-            return LV_RES_OK;     /*The image is fully decoded. Return with its pointer*/
+    uint32_t y;
+    for(y = 0; y < s->h; y++) {
+        if(stream_decode_row(s) != LV_RES_OK) {
+            PNG_FREE(img_data);
+            stream_close(s);
+            return LV_RES_INV;
         }
+        stream_convert_row(s, 0, s->w, img_data + y * line_size);
     }
-    /*If it's a PNG file in a  C array...*/
-    else if(dsc->src_type == LV_IMG_SRC_VARIABLE) {
-        const lv_img_dsc_t * img_dsc = dsc->src;
-        uint32_t png_width;             /*No used, just required by he decoder*/
-        uint32_t png_height;            /*No used, just required by he decoder*/
 
-        /*Decode the image in ARGB8888 */
-        error = lodepng_decode32(&img_data, &png_width, &png_height, img_dsc->data, img_dsc->data_size);
+    stream_close(s);
+    dsc->img_data = img_data;
+    return LV_RES_OK;     /*The image is fully decoded. Return with its pointer*/
+}
 
-        if(error) {
-            return LV_RES_INV;
-        }
+/**
+ * Decode a line of a large image. Rows are decoded in order, and the
+ * stream restarts from the first row when an upper row is requested.
+ * The deflate window is freed after the last row.
+ */
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc,
+                                  lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf)
+{
+    (void) decoder; /*Unused*/
+    png_stream_t * s = dsc->user_data;
+
+    if(s == NULL || y < 0 || (uint32_t)y >= s->h || x < 0 || (uint32_t)(x + len) > s->w) return LV_RES_INV;
 
-        /*Convert the image to the system's color depth*/
-        convert_color_depth(img_data,  png_width * png_height);
+    /*The row is decoded already*/
+    if((uint32_t)y + 1 == s->next_row) {
+        stream_convert_row(s, x, len, buf);
+        return LV_RES_OK;
+    }
+
+    if(s->window == NULL || (uint32_t)y < s->next_row) {
+        if(stream_start(s) != LV_RES_OK) return LV_RES_INV;
+    }
 
-        dsc->img_data = img_data;
-        return LV_RES_OK;     /*Return with its pointer*/
+    while(s->next_row <= (uint32_t)y) {
+        if(stream_decode_row(s) != LV_RES_OK) return LV_RES_INV;
     }
 
-    return LV_RES_INV;    /*If not returned earlier then it failed*/
+    stream_convert_row(s, x, len, buf);
+
+    if(s->next_row == s->h) {
+        PNG_FREE(s->window);
+        s->window = NULL;
+    }
+    return LV_RES_OK;
 }
 
 /**
@@ -200,7 +311,55 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
 static void decoder_close(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
 {
     (void) decoder; /*Unused*/
-    if(dsc->img_data) free((uint8_t *)dsc->img_data);
+    if(dsc->img_data) PNG_FREE((uint8_t *)dsc->img_data);
+    if(dsc->user_data) stream_close(dsc->user_data);
+}
+
+/**
+ * Decode an image by lodepng to ARGB8888, and convert it in place. Used for interlaced images.
+ */
+static lv_res_t decode_lodepng(lv_img_decoder_dsc_t * dsc)
+{
+    uint32_t error;                 /*For the return values of PNG decoder functions*/
+    uint8_t * img_data = NULL;
+    uint32_t png_width;             /*Will be the width of the decoded image*/
+    uint32_t png_height;            /*Will be the width of the decoded image*/
+
+    /*If it's a PNG file...*/
+    if(dsc->src_type == LV_IMG_SRC_FILE) {
+        const char * fn = dsc->src;
+
+        /*Load the PNG file into buffer. It's still compressed (not decoded)*/
+        unsigned char * png_data;      /*Pointer to the loaded data. Same as the original file just loaded into the RAM*/
+        size_t png_data_size;          /*Size of `png_data` in bytes*/
+
+        error = lodepng_load_file(&png_data, &png_data_size, fn);   /*Load the file*/
+        if(error) {
+            printf("error %u: %s\n", error, lodepng_error_text(error));
+            return LV_RES_INV;
+        }
+
+        /*Decode the loaded image in ARGB8888 */
+        error = lodepng_decode32(&img_data, &png_width, &png_height, png_data, png_data_size);
+        PNG_FREE(png_data); /*Free the loaded file*/
+    }
+    /*If it's a PNG file in a  C array...*/
+    else {
+        const lv_img_dsc_t * img_dsc = dsc->src;
+
+        /*Decode the image in ARGB8888 */
+        error = lodepng_decode32(&img_data, &png_width, &png_height, img_dsc->data, img_dsc->data_size);
+    }
+
+    if(error) {
+        printf("error %u: %s\n", error, lodepng_error_text(error));
+        return LV_RES_INV;
+    }
+
+    /*Convert the image to the system's color depth*/
+    convert_color_depth(img_data,  png_width * png_height);
+    dsc->img_data = img_data;
+    return LV_RES_OK;     /*Return with its pointer*/
 }
 
 /**
@@ -242,5 +401,680 @@ static void convert_color_depth(uint8_t * img, uint32_t px_cnt)
 #endif
 }
 
+/*=====================
+ * Source
+ *====================*/
+
+static lv_res_t src_fill(png_stream_t * s)
+{
+#if LV_PNG_USE_LV_FILESYSTEM
+    uint32_t rn = 0;
+    if(lv_fs_read(&s->file, s->fbuf, PNG_FILE_BUF_SIZE, &rn) != LV_FS_RES_OK) rn = 0;
+#else
+    uint32_t rn = fread(s->fbuf, 1, PNG_FILE_BUF_SIZE, s->file);
+#endif
+    s->fbuf_len = rn;
+    s->fbuf_pos = 0;
+    s->file_pos += rn;
+    return rn == 0 ? LV_RES_INV : LV_RES_OK;
+}
+
+static int src_byte(png_stream_t * s)
+{
+    if(s->mem) {
+        if(s->mem_pos >= s->mem_size) return -1;
+        return s->mem[s->mem_pos++];
+    }
+
+    if(s->fbuf_pos >= s->fbuf_len && src_fill(s) != LV_RES_OK) return -1;
+    return s->fbuf[s->fbuf_pos++];
+}
+
+static lv_res_t src_read(png_stream_t * s, uint8_t * buf, uint32_t len)
+{
+    uint32_t i;
+    for(i = 0; i < len; i++) {
+        int b = src_byte(s);
+        if(b < 0) return LV_RES_INV;
+        buf[i] = (uint8_t)b;
+    }
+    return LV_RES_OK;
+}
+
+static lv_res_t src_read_u32(png_stream_t * s, uint32_t * v)
+{
+    uint8_t b[4];
+    if(src_read(s, b, 4) != LV_RES_OK) return LV_RES_INV;
+    *v = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+    return LV_RES_OK;
+}
+
+static uint32_t src_tell(png_stream_t * s)
+{
+    if(s->mem) return s->mem_pos;
+    return s->file_pos - s->fbuf_len + s->fbuf_pos;
+}
+
+static lv_res_t src_seek(png_stream_t * s, uint32_t pos)
+{
+    if(s->mem) {
+        if(pos > s->mem_size) return LV_RES_INV;
+        s->mem_pos = pos;
+        return LV_RES_OK;
+    }
+
+    /*Inside the read buffer*/
+    if(pos <= s->file_pos && pos >= s->file_pos - s->fbuf_len) {
+        s->fbuf_pos = pos - (s->file_pos - s->fbuf_len);
+        return LV_RES_OK;
+    }
+
+#if LV_PNG_USE_LV_FILESYSTEM
+    if(lv_fs_seek(&s->file, pos) != LV_FS_RES_OK) return LV_RES_INV;
+#else
+    if(fseek(s->file, pos, SEEK_SET) != 0) return LV_RES_INV;
+#endif
+    s->file_pos = pos;
+    s->fbuf_len = 0;
+    s->fbuf_pos = 0;
+    return LV_RES_OK;
+}
+
+static lv_res_t src_skip(png_stream_t * s, uint32_t len)
+{
+    return src_seek(s, src_tell(s) + len);
+}
+
+/*=====================
+ * Inflate
+ *====================*/
+
+/**
+ * Get the next byte of IDAT data, across IDAT chunks
+ */
+static int idat_byte(png_stream_t * s)
+{
+    while(s->chunk_left == 0) {
+        uint32_t len;
+        uint32_t type;
+
+        /*Skip CRC of the last chunk, and read the next chunk header*/
+        if(src_skip(s, 4) != LV_RES_OK) return -1;
+        if(src_read_u32(s, &len) != LV_RES_OK || src_read_u32(s, &type) != LV_RES_OK) return -1;
+        if(type != PNG_CHUNK_TYPE('I', 'D', 'A', 'T')) return -1;
+        s->chunk_left = len;
+    }
+
+    s->chunk_left--;
+    return src_byte(s);
+}
+
+static uint32_t inflate_bits(png_stream_t * s, uint8_t need)
+{
+    while(s->bitcnt < need) {
+        int b = idat_byte(s);
+        if(b < 0) {
+            s->error = 1;
+            return 0;
+        }
+        s->bitbuf |= (uint32_t)b << s->bitcnt;
+        s->bitcnt += 8;
+    }
+
+    uint32_t val = s->bitbuf & ((1UL << need) - 1);
+    s->bitbuf >>= need;
+    s->bitcnt -= need;
+    return val;
+}
+
+static int inflate_decode(png_stream_t * s, const png_huffman_t * h)
+{
+    int code = 0;   /*Bits of the code read so far*/
+    int first = 0;  /*First code of the length*/
+    int index = 0;  /*Index of the first code of the length in symbol table*/
+    int len;
+
+    for(len = 1; len < 16; len++) {
+        code |= (int)inflate_bits(s, 1);
+        if(s->error) return -1;
+
+        int count = h->count[len];
+        if(code - count < first) return h->symbol[index + (code - first)];
+
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+
+    return -1;  /*Ran out of codes*/
+}
+
+/**
+ * Build a canonical Huffman code from code lengths
+ * @return LV_RES_INV on over-subscribed lengths
+ */
+static lv_res_t inflate_construct(png_huffman_t * h, const uint8_t * length, uint16_t n)
+{
+    uint16_t offs[16];
+    uint16_t symbol;
+    uint16_t len;
+    int left;
+
+    _lv_memset_00(h->count, sizeof(h->count));
+    for(symbol = 0; symbol < n; symbol++) h->count[length[symbol]]++;
+
+    left = 1;
+    for(len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h->count[len];
+        if(left < 0) return LV_RES_INV;
+    }
+
+    offs[1] = 0;
+    for(len = 1; len < 15; len++) offs[len + 1] = offs[len] + h->count[len];
+
+    for(symbol = 0; symbol < n; symbol++) {
+        if(length[symbol] != 0) h->symbol[offs[length[symbol]]++] = symbol;
+    }
+
+    return LV_RES_OK;
+}
+
+static lv_res_t inflate_fixed(png_stream_t * s)
+{
+    uint8_t lengths[288];
+    uint16_t i;
+
+    for(i = 0; i < 144; i++) lengths[i] = 8;
+    for(; i < 256; i++) lengths[i] = 9;
+    for(; i < 280; i++) lengths[i] = 7;
+    for(; i < 288; i++) lengths[i] = 8;
+    inflate_construct(&s->lencode, lengths, 288);
+
+    for(i = 0; i < 30; i++) lengths[i] = 5;
+    inflate_construct(&s->distcode, lengths, 30);
+    return LV_RES_OK;
+}
+
+static lv_res_t inflate_dynamic(png_stream_t * s)
+{
+    static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    uint8_t lengths[288 + 30];
+    uint16_t nlen = inflate_bits(s, 5) + 257;
+    uint16_t ndist = inflate_bits(s, 5) + 1;
+    uint16_t ncode = inflate_bits(s, 4) + 4;
+    uint16_t i;
+
+    if(s->error || nlen > 286 || ndist > 30) return LV_RES_INV;
+
+    /*Code length code, decoded with lencode temporarily*/
+    _lv_memset_00(lengths, 19);
+    for(i = 0; i < ncode; i++) lengths[order[i]] = inflate_bits(s, 3);
+    if(s->error || inflate_construct(&s->lencode, lengths, 19) != LV_RES_OK) return LV_RES_INV;
+
+    i = 0;
+    while(i < nlen + ndist) {
+        int symbol = inflate_decode(s, &s->lencode);
+        if(symbol < 0) return LV_RES_INV;
+
+        if(symbol < 16) {
+            lengths[i++] = symbol;
+            continue;
+        }
+
+        uint8_t len = 0;
+        uint16_t repeat;
+        if(symbol == 16) {
+            if(i == 0) return LV_RES_INV;
+            len = lengths[i - 1];
+            repeat = 3 + inflate_bits(s, 2);
+        }
+        else if(symbol == 17) {
+            repeat = 3 + inflate_bits(s, 3);
+        }
+        else {
+            repeat = 11 + inflate_bits(s, 7);
+        }
+
+        if(s->error || i + repeat > nlen + ndist) return LV_RES_INV;
+        while(repeat--) lengths[i++] = len;
+    }
+
+    /*End of block code is required*/
+    if(lengths[256] == 0) return LV_RES_INV;
+
+    if(inflate_construct(&s->lencode, lengths, nlen) != LV_RES_OK) return LV_RES_INV;
+    if(inflate_construct(&s->distcode, lengths + nlen, ndist) != LV_RES_OK) return LV_RES_INV;
+    return LV_RES_OK;
+}
+
+static inline void inflate_put(png_stream_t * s, uint8_t * out, uint32_t * n, uint8_t c)
+{
+    out[(*n)++] = c;
+    s->window[s->window_pos] = c;
+    s->window_pos = (s->window_pos + 1) & (s->window_size - 1);
+    s->total_out++;
+}
+
+/**
+ * Inflate exactly `len` bytes. It can pause inside any block, and continue at the next call.
+ */
+static lv_res_t inflate_read(png_stream_t * s, uint8_t * out, uint32_t len)
+{
+    uint32_t n = 0;
+
+    while(n < len) {
+        /*Continue a match*/
+        if(s->copy_len) {
+            uint8_t c = s->window[(s->window_pos - s->copy_dist) & (s->window_size - 1)];
+            inflate_put(s, out, &n, c);
+            s->copy_len--;
+            continue;
+        }
+
+        if(s->block_type == PNG_BLOCK_NONE) {
+            if(s->last_block) return LV_RES_INV;    /*Less data than the image*/
+
+            s->last_block = inflate_bits(s, 1);
+            s->block_type = inflate_bits(s, 2);
+            if(s->error) return LV_RES_INV;
+
+            if(s->block_type == 0) {
+                /*Stored block starts at byte boundary*/
+                s->bitbuf = 0;
+                s->bitcnt = 0;
+                uint32_t stored_len = inflate_bits(s, 16);
+                uint32_t stored_nlen = inflate_bits(s, 16);
+                if(s->error || stored_len != (~stored_nlen & 0xffff)) return LV_RES_INV;
+                s->stored_left = stored_len;
+            }
+            else if(s->block_type == 1) {
+                inflate_fixed(s);
+            }
+            else if(s->block_type == 2) {
+                if(inflate_dynamic(s) != LV_RES_OK) return LV_RES_INV;
+            }
+            else {
+                return LV_RES_INV;
+            }
+            continue;
+        }
+
+        if(s->block_type == 0) {
+            if(s->stored_left == 0) {
+                s->block_type = PNG_BLOCK_NONE;
+                continue;
+            }
+            int b = idat_byte(s);
+            if(b < 0) return LV_RES_INV;
+            inflate_put(s, out, &n, (uint8_t)b);
+            s->stored_left--;
+            continue;
+        }
+
+        int symbol = inflate_decode(s, &s->lencode);
+        if(symbol < 0) return LV_RES_INV;
+
+        if(symbol < 256) {
+            inflate_put(s, out, &n, (uint8_t)symbol);
+        }
+        else if(symbol == 256) {
+            s->block_type = PNG_BLOCK_NONE;
+        }
+        else {
+            symbol -= 257;
+            if(symbol >= 29) return LV_RES_INV;
+            uint16_t copy_len = len_base[symbol] + inflate_bits(s, len_extra[symbol]);
+
+            symbol = inflate_decode(s, &s->distcode);
+            if(symbol < 0 || symbol >= 30) return LV_RES_INV;
+            uint32_t dist = dist_base[symbol] + inflate_bits(s, dist_extra[symbol]);
+
+            if(s->error || dist > s->window_size || dist > s->total_out) return LV_RES_INV;
+            s->copy_len = copy_len;
+            s->copy_dist = dist;
+        }
+    }
+
+    return LV_RES_OK;
+}
+
+/*=====================
+ * Stream
+ *====================*/
+
+/**
+ * Open the source and parse chunks before the first IDAT
+ */
+static png_stream_t * stream_open(const void * src, lv_img_src_t src_type)
+{
+    static const uint8_t signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    uint8_t buf[13];
+
+    png_stream_t * s = PNG_MALLOC(sizeof(png_stream_t));
+    if(s == NULL) return NULL;
+    _lv_memset_00(s, sizeof(png_stream_t));
+
+    if(src_type == LV_IMG_SRC_VARIABLE) {
+        const lv_img_dsc_t * img_dsc = src;
+        s->mem = img_dsc->data;
+        s->mem_size = img_dsc->data_size;
+    }
+    else {
+        s->fbuf = PNG_MALLOC(PNG_FILE_BUF_SIZE);
+        if(s->fbuf == NULL) {
+            PNG_FREE(s);
+            return NULL;
+        }
+#if LV_PNG_USE_LV_FILESYSTEM
+        if(lv_fs_open(&s->file, src, LV_FS_MODE_RD) != LV_FS_RES_OK) {
+            PNG_FREE(s->fbuf);
+            PNG_FREE(s);
+            return NULL;
+        }
+#else
+        s->file = fopen(src, "rb");
+        if(s->file == NULL) {
+            PNG_FREE(s->fbuf);
+            PNG_FREE(s);
+            return NULL;
+        }
+#endif
+    }
+
+    if(src_read(s, buf, 8) != LV_RES_OK || memcmp(buf, signature, 8) != 0) goto fail;
+
+    bool ihdr = false;
+    while(1) {
+        uint32_t len;
+        uint32_t type;
+        if(src_read_u32(s, &len) != LV_RES_OK || src_read_u32(s, &type) != LV_RES_OK) goto fail;
+
+        if(type == PNG_CHUNK_TYPE('I', 'H', 'D', 'R')) {
+            if(len != 13 || src_read(s, buf, 13) != LV_RES_OK) goto fail;
+            s->w = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3];
+            s->h = ((uint32_t)buf[4] << 24) | ((uint32_t)buf[5] << 16) | ((uint32_t)buf[6] << 8) | buf[7];
+            s->depth = buf[8];
+            s->color_type = buf[9];
+            s->interlace = buf[12];
+            if(buf[10] != 0 || buf[11] != 0 || buf[12] > 1) goto fail;     /*Compression and filter method*/
+            ihdr = true;
+        }
+        else if(type == PNG_CHUNK_TYPE('P', 'L', 'T', 'E')) {
+            uint16_t i;
+            if(len % 3 != 0 || len > 256 * 3) goto fail;
+            s->palette_size = len / 3;
+            for(i = 0; i < s->palette_size; i++) {
+                if(src_read(s, s->palette[i], 3) != LV_RES_OK) goto fail;
+                s->palette[i][3] = 0xff;
+            }
+        }
+        else if(type == PNG_CHUNK_TYPE('t', 'R', 'N', 'S')) {
+            uint32_t i;
+            if(s->color_type == 3) {
+                if(len > s->palette_size) goto fail;
+                for(i = 0; i < len; i++) {
+                    if(src_read(s, &s->palette[i][3], 1) != LV_RES_OK) goto fail;
+                }
+            }
+            else {
+                uint32_t n = s->color_type == 0 ? 1 : 3;
+                if(len != n * 2 || src_read(s, buf, len) != LV_RES_OK) goto fail;
+                for(i = 0; i < n; i++) s->trns[i] = ((uint16_t)buf[i * 2] << 8) | buf[i * 2 + 1];
+                s->trns_set = 1;
+            }
+            s->alpha = 1;
+        }
+        else if(type == PNG_CHUNK_TYPE('I', 'D', 'A', 'T')) {
+            s->idat_pos = src_tell(s);
+            s->idat_len = len;
+            break;
+        }
+        else if(type == PNG_CHUNK_TYPE('I', 'E', 'N', 'D')) {
+            goto fail;
+        }
+        else {
+            if(src_skip(s, len) != LV_RES_OK) goto fail;
+        }
+
+        if(src_skip(s, 4) != LV_RES_OK) goto fail;     /*CRC*/
+    }
+
+    if(!ihdr || s->w == 0 || s->h == 0 || s->w > PNG_SIZE_MAX || s->h > PNG_SIZE_MAX) goto fail;
+
+    uint8_t channels;
+    switch(s->color_type) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; s->alpha = 1; break;
+        case 6: channels = 4; s->alpha = 1; break;
+        default: goto fail;
+    }
+
+    if(s->color_type == 3 ? (s->depth > 8 || s->palette_size == 0) : (s->color_type != 0 && s->depth < 8)) goto fail;
+    if(s->depth != 1 && s->depth != 2 && s->depth != 4 && s->depth != 8 && s->depth != 16) goto fail;
+
+    uint32_t px_bits = channels * s->depth;
+    s->row_bytes = (s->w * px_bits + 7) >> 3;
+    s->filter_bpp = px_bits < 8 ? 1 : px_bits >> 3;
+    return s;
+
+fail:
+    stream_close(s);
+    return NULL;
+}
+
+/**
+ * Start to decode from the first row. The window and rows are allocated at the first call.
+ */
+static lv_res_t stream_start(png_stream_t * s)
+{
+    if(s->cur_row == NULL) {
+        s->cur_row = PNG_MALLOC(s->row_bytes + 1);
+        s->prev_row = PNG_MALLOC(s->row_bytes + 1);
+        if(s->cur_row == NULL || s->prev_row == NULL) return LV_RES_INV;
+    }
+
+    if(src_seek(s, s->idat_pos) != LV_RES_OK) return LV_RES_INV;
+    s->chunk_left = s->idat_len;
+    s->bitbuf = 0;
+    s->bitcnt = 0;
+    s->error = 0;
+    s->last_block = 0;
+    s->block_type = PNG_BLOCK_NONE;
+    s->copy_len = 0;
+    s->total_out = 0;
+    s->window_pos = 0;
+    s->next_row = 0;
 
+    /*zlib header, the window size is from CINFO*/
+    int cmf = idat_byte(s);
+    int flg = idat_byte(s);
+    if(cmf < 0 || flg < 0 || (cmf & 0x0f) != 8 || (cmf >> 4) > 7 || (cmf * 256 + flg) % 31 != 0 || (flg & 0x20)) {
+        return LV_RES_INV;
+    }
 
+    uint32_t window_size = 1UL << ((cmf >> 4) + 8);
+    if(s->window != NULL && s->window_size != window_size) {
+        PNG_FREE(s->window);
+        s->window = NULL;
+    }
+    if(s->window == NULL) {
+        s->window = PNG_MALLOC(window_size);
+        if(s->window == NULL) return LV_RES_INV;
+    }
+    s->window_size = window_size;
+
+    /*The row before the first is zero for unfiltering*/
+    _lv_memset_00(s->prev_row, s->row_bytes + 1);
+    return LV_RES_OK;
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    int16_t p = (int16_t)a + b - c;
+    int16_t pa = LV_MATH_ABS(p - a);
+    int16_t pb = LV_MATH_ABS(p - b);
+    int16_t pc = LV_MATH_ABS(p - c);
+
+    if(pa <= pb && pa <= pc) return a;
+    if(pb <= pc) return b;
+    return c;
+}
+
+/**
+ * Inflate and unfilter the next row into `prev_row`
+ */
+static lv_res_t stream_decode_row(png_stream_t * s)
+{
+    uint8_t * cur = s->cur_row;
+    uint8_t * prev = s->prev_row;
+    uint32_t bpp = s->filter_bpp;
+    uint32_t i;
+
+    if(s->next_row >= s->h || inflate_read(s, cur, s->row_bytes + 1) != LV_RES_OK) return LV_RES_INV;
+
+    /*Skip the filter type byte*/
+    uint8_t filter = cur[0];
+    uint8_t * r = cur + 1;
+    uint8_t * p = prev + 1;
+
+    switch(filter) {
+        case 0:
+            break;
+        case 1:
+            for(i = bpp; i < s->row_bytes; i++) r[i] += r[i - bpp];
+            break;
+        case 2:
+            for(i = 0; i < s->row_bytes; i++) r[i] += p[i];
+            break;
+        case 3:
+            for(i = 0; i < bpp; i++) r[i] += p[i] >> 1;
+            for(; i < s->row_bytes; i++) r[i] += (r[i - bpp] + p[i]) >> 1;
+            break;
+        case 4:
+            for(i = 0; i < bpp; i++) r[i] += p[i];
+            for(; i < s->row_bytes; i++) r[i] += paeth(r[i - bpp], p[i], p[i - bpp]);
+            break;
+        default:
+            return LV_RES_INV;
+    }
+
+    s->prev_row = cur;
+    s->cur_row = prev;
+    s->next_row++;
+    return LV_RES_OK;
+}
+
+/**
+ * Get a sample of the last decoded row, at the original bit depth
+ */
+static uint16_t stream_sample(const png_stream_t * s, const uint8_t * row, uint32_t idx)
+{
+    switch(s->depth) {
+        case 16:
+            return ((uint16_t)row[idx * 2] << 8) | row[idx * 2 + 1];
+        case 8:
+            return row[idx];
+        default: {
+                uint32_t bit = idx * s->depth;
+                uint8_t shift = 8 - s->depth - (bit & 7);
+                return (row[bit >> 3] >> shift) & ((1 << s->depth) - 1);
+            }
+    }
+}
+
+/*Scale a sample to 8 bit*/
+static uint8_t stream_sample8(const png_stream_t * s, uint16_t v)
+{
+    switch(s->depth) {
+        case 16:
+            return v >> 8;
+        case 8:
+            return v;
+        default:
+            return v * 255 / ((1 << s->depth) - 1);
+    }
+}
+
+/**
+ * Convert pixels of the last decoded row to the color format of the display,
+ * with an alpha byte if the image has alpha
+ */
+static void stream_convert_row(png_stream_t * s, uint32_t x, uint32_t len, uint8_t * out)
+{
+    const uint8_t * row = s->prev_row + 1;
+    uint32_t end = x + len;
+    uint8_t r, g, b, a;
+
+    for(; x < end; x++) {
+        a = 0xff;
+        switch(s->color_type) {
+            case 0: {
+                    uint16_t v = stream_sample(s, row, x);
+                    r = g = b = stream_sample8(s, v);
+                    if(s->trns_set && v == s->trns[0]) a = 0;
+                    break;
+                }
+            case 2: {
+                    uint16_t vr = stream_sample(s, row, x * 3);
+                    uint16_t vg = stream_sample(s, row, x * 3 + 1);
+                    uint16_t vb = stream_sample(s, row, x * 3 + 2);
+                    r = stream_sample8(s, vr);
+                    g = stream_sample8(s, vg);
+                    b = stream_sample8(s, vb);
+                    if(s->trns_set && vr == s->trns[0] && vg == s->trns[1] && vb == s->trns[2]) a = 0;
+                    break;
+                }
+            case 3: {
+                    uint16_t idx = stream_sample(s, row, x);
+                    if(idx >= s->palette_size) idx = 0;
+                    r = s->palette[idx][0];
+                    g = s->palette[idx][1];
+                    b = s->palette[idx][2];
+                    a = s->palette[idx][3];
+                    break;
+                }
+            case 4:
+                r = g = b = stream_sample8(s, stream_sample(s, row, x * 2));
+                a = stream_sample8(s, stream_sample(s, row, x * 2 + 1));
+                break;
+            default:
+                r = stream_sample8(s, stream_sample(s, row, x * 4));
+                g = stream_sample8(s, stream_sample(s, row, x * 4 + 1));
+                b = stream_sample8(s, stream_sample(s, row, x * 4 + 2));
+                a = stream_sample8(s, stream_sample(s, row, x * 4 + 3));
+                break;
+        }
+
+        lv_color_t c = LV_COLOR_MAKE(r, g, b);
+#if LV_COLOR_DEPTH == 32
+        c.ch.alpha = a;
+        _lv_memcpy_small(out, &c, sizeof(lv_color_t));
+        out += sizeof(lv_color_t);
+#else
+        _lv_memcpy_small(out, &c, sizeof(lv_color_t));
+        out += sizeof(lv_color_t);
+        if(s->alpha) *out++ = a;
+#endif
+    }
+}
+
+static void stream_close(png_stream_t * s)
+{
+    if(s->mem == NULL) {
+#if LV_PNG_USE_LV_FILESYSTEM
+        lv_fs_close(&s->file);
+#else
+        if(s->file) fclose(s->file);
+#endif
+    }
+
+    PNG_FREE(s->fbuf);
+    PNG_FREE(s->window);
+    PNG_FREE(s->cur_row);
+    PNG_FREE(s->prev_row);
+    PNG_FREE(s);
+}
@@ -17,6 +17,10 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+/*Images decoded to more bytes than this are decoded line by line at drawing, without a frame buffer*/
+#ifndef LV_PNG_DECODE_FULL_MAX
+#define LV_PNG_DECODE_FULL_MAX (64U * 1024U)
+#endif
 
 /**********************
  *      TYPEDEFS
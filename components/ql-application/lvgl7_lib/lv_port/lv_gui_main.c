@@ -13,176 +13,377 @@
 // #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
 
 #include "lv_gui_main.h"
+#include "lv_gui_port.h"
 #include "drv_lcd_v2.h"
-#include "drv_names.h"
 #include "drv_keypad.h"
 #include "lvgl.h"
 #include "osi_api.h"
 #include "osi_log.h"
+#include "osi_profile.h"
+#include "quec_proj_config.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_LVGL
+#include "at_command.h"
+#include "at_response.h"
+#endif
+
+// nested depth of profiled draw functions, deeper ones are counted to parent
+#define LV_GUI_DRAW_DEPTH (4)
+
 typedef struct
 {
-    bool screen_on;            // state of screen on
-    bool keypad_pending;       // keypad pending, set in ISR, clear in thread
-    bool anim_inactive;        // property of whether animation is regarded as inactive
-    drvLcd_t *lcd;             // LCD instance
-    osiThread_t *thread;       // gui thread
-    osiTimer_t *task_timer;    // timer to trigger task handler
-    drvLcdVideoLayer_t vl;     // extern video layer
+    bool vsync;                // refresh synced to LCD FMARK
+    bool aod;                  // in always-on display
+    lvGuiCreate_t create;      // gui creation function
+    osiTimer_t *aod_timer;     // timer to draw always-on display
+    drvLcdArea_t aod_area;     // area of always-on display
+    lvGuiAodDraw_t aod_draw;   // draw function of always-on display
+    void *aod_param;           // parameter of aod_draw
     lv_disp_buf_t disp_buf;    // display buffer
     lv_disp_t *disp;           // display device
     lv_indev_t *keypad;        // keypad device
-    keyMap_t last_key;         // last key from ISR
-    keyState_t last_key_state; // last key state from ISR
-    uint32_t screen_on_users;  // screen on user bitmap
-    uint32_t inactive_timeout; // property of inactive timeout
+    lvGuiPerf_t perf;          // render statistics
+    uint32_t draw_start;       // start time of the current draw segment
+    uint8_t draw_depth;        // nested depth of draw functions
+    lv_draw_prof_type_t draw_stack[LV_GUI_DRAW_DEPTH]; // nested draw types
 } lvGuiContext_t;
 
-typedef struct
-{
-    uint8_t keypad;
-    uint8_t lv_key;
-} lvGuiKeypadMap_t;
-
-static const lvGuiKeypadMap_t gLvKeyMap[] = {
-    {KEY_MAP_POWER, 0xf0},
-    {KEY_MAP_SIM1, 0xf1},
-    {KEY_MAP_SIM2, 0xf2},
-    {KEY_MAP_0, '0'},
-    {KEY_MAP_1, '1'},
-    {KEY_MAP_2, '2'},
-    {KEY_MAP_3, '3'},
-    {KEY_MAP_4, '4'},
-    {KEY_MAP_5, '5'},
-    {KEY_MAP_6, '6'},
-    {KEY_MAP_7, '7'},
-    {KEY_MAP_8, '8'},
-    {KEY_MAP_9, '9'},
-    {KEY_MAP_STAR, '*'},
-    {KEY_MAP_SHARP, '#'},
-    {KEY_MAP_OK, LV_KEY_ENTER},
-    {KEY_MAP_LEFT, LV_KEY_LEFT},
-    {KEY_MAP_RIGHT, LV_KEY_RIGHT},
-    {KEY_MAP_UP, LV_KEY_UP},
-    {KEY_MAP_DOWN, LV_KEY_DOWN},
-    {KEY_MAP_SOFT_L, LV_KEY_PREV},
-    {KEY_MAP_SOFT_R, LV_KEY_NEXT},
+// littlevgl key of each keypad key, indexed by keyMap_t. 0 is not mapped.
+static const uint8_t gLvKeyMap[KEY_MAP_MAX_COUNT] = {
+    [KEY_MAP_POWER] = 0xf0,
+    [KEY_MAP_SIM1] = 0xf1,
+    [KEY_MAP_SIM2] = 0xf2,
+    [KEY_MAP_0] = '0',
+    [KEY_MAP_1] = '1',
+    [KEY_MAP_2] = '2',
+    [KEY_MAP_3] = '3',
+    [KEY_MAP_4] = '4',
+    [KEY_MAP_5] = '5',
+    [KEY_MAP_6] = '6',
+    [KEY_MAP_7] = '7',
+    [KEY_MAP_8] = '8',
+    [KEY_MAP_9] = '9',
+    [KEY_MAP_STAR] = '*',
+    [KEY_MAP_SHARP] = '#',
+    [KEY_MAP_OK] = LV_KEY_ENTER,
+    [KEY_MAP_LEFT] = LV_KEY_LEFT,
+    [KEY_MAP_RIGHT] = LV_KEY_RIGHT,
+    [KEY_MAP_UP] = LV_KEY_UP,
+    [KEY_MAP_DOWN] = LV_KEY_DOWN,
+    [KEY_MAP_SOFT_L] = LV_KEY_PREV,
+    [KEY_MAP_SOFT_R] = LV_KEY_NEXT,
 };
 
 static lvGuiContext_t gLvGuiCtx;
 
 /**
  * flush display forcedly
+ *
+ * The display buffer may only cover part of the screen, so the whole
+ * screen is invalidated and redrawn.
  */
 static void prvDispForceFlush(void)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
+
+    lv_obj_invalidate(lv_disp_get_scr_act(d->disp));
+    lv_refr_now(d->disp);
+    lvGuiPortDispWaitDone();
+}
+
+/**
+ * start display refresh after the last transfer of a frame, called in gui thread
+ *
+ * GOUDA starts transfer at FMARK. So, the end of transfer is a fixed
+ * point of the panel frame, and the next frame can be rendered before
+ * the next FMARK. Task handler is executed after each event.
+ */
+static void prvDispVsync(void *param)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+    lv_task_ready(d->disp->refr_task);
+}
+
+/**
+ * LCD transfer done callback, called in ISR
+ */
+static void prvDispFlushDone(void *param)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+    lv_disp_drv_t *disp_drv = (lv_disp_drv_t *)param;
+
+    // it will be cleared in lv_disp_flush_ready
+    bool last = lv_disp_flush_is_last(disp_drv);
+    lv_disp_flush_ready(disp_drv);
+    if (d->vsync && last)
+        osiThreadCallback(lvGuiPortThread(), prvDispVsync, NULL);
+}
+
+/**
+ * display device flush_cb
+ */
+static void prvDispFlush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
+{
     drvLcdArea_t roi = {
-        .x = 0,
-        .y = 0,
-        .w = d->disp->driver.hor_res,
-        .h = d->disp->driver.ver_res,
+        .x = area->x1,
+        .y = area->y1,
+        .w = lv_area_get_width(area),
+        .h = lv_area_get_height(area),
     };
 
-    drvLcdOverlay_t ovl = {
-        .buf = d->disp_buf.buf1,
-        .enabled = true,
-        .in_fmt = DRV_LCD_IN_FMT_RGB565,
-        .alpha = 255,
-        .key_en = LV_INDEXED_CHROMA,
-        .key_color = lv_color_to16(LV_COLOR_TRANSP),
-        .stride = roi.w,
-        .out = roi,
-    };
-    drvLcdLayers_t layers = {
-        .vl = &d->vl,
-        .ovl = {NULL, NULL, &ovl},
-        .layer_roi = roi,
-        .screen_roi = roi,
-    };
+    lvGuiPortDispFlush(&roi, color_p, prvDispFlushDone, disp_drv);
+}
 
-    drvLcdFlush(d->lcd, &layers, true);
+/**
+ * merge adjacent invalidated areas
+ *
+ * LittlevGL only joins overlapped areas. Areas sharing an edge, such as
+ * the neighbor digits of a clock, are merged here when the joined area
+ * contains no extra pixels. Then they are rendered and written to LCD as
+ * one GOUDA ROI, rather than multiple small transfers.
+ */
+static void prvDispMergeInvAreas(lv_disp_t *disp)
+{
+    bool merged;
+    do
+    {
+        merged = false;
+        for (unsigned i = 0; i < disp->inv_p; i++)
+        {
+            if (disp->inv_area_joined[i])
+                continue;
+
+            for (unsigned j = i + 1; j < disp->inv_p; j++)
+            {
+                if (disp->inv_area_joined[j])
+                    continue;
+
+                lv_area_t joined;
+                _lv_area_join(&joined, &disp->inv_areas[i], &disp->inv_areas[j]);
+                if (lv_area_get_size(&joined) > (lv_area_get_size(&disp->inv_areas[i]) +
+                                                 lv_area_get_size(&disp->inv_areas[j])))
+                    continue;
+
+                lv_area_copy(&disp->inv_areas[i], &joined);
+                disp->inv_area_joined[j] = 1;
+                merged = true;
+            }
+        }
+    } while (merged);
 }
 
+/**
+ * join all invalidated areas into one
+ *
+ * GOUDA waits FMARK for each transfer in vsync mode. Extra pixels are
+ * rendered to make one frame one transfer.
+ */
+static void prvDispJoinInvAreas(lv_disp_t *disp)
+{
+    lv_area_t *joined = NULL;
+    for (unsigned i = 0; i < disp->inv_p; i++)
+    {
+        if (disp->inv_area_joined[i])
+            continue;
+
+        if (joined == NULL)
+        {
+            joined = &disp->inv_areas[i];
+            continue;
+        }
+
+        _lv_area_join(joined, joined, &disp->inv_areas[i]);
+        disp->inv_area_joined[i] = 1;
+    }
+}
 
 /**
- * initialize LCD display device
+ * display refresh task, replace the default one of LittlevGL
  */
-static bool prvLvInitLcd(void)
+static void prvDispRefrTask(lv_task_t *task)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
+    lv_disp_t *disp = (lv_disp_t *)task->user_data;
 
-    d->lcd = drvLcdGetByname(DRV_NAME_LCD1);
-    if (d->lcd == NULL)
-        return false;
+    if (d->vsync)
+        prvDispJoinInvAreas(disp);
+    else
+        prvDispMergeInvAreas(disp);
 
-    if (!drvLcdOpenV2(d->lcd))
-        return false;
+    unsigned area_count = 0;
+    for (unsigned n = 0; n < disp->inv_p; n++)
+    {
+        if (!disp->inv_area_joined[n])
+            area_count++;
+    }
 
-    drvLcdSetDirection(d->lcd, DRV_LCD_DIR_NORMAL);
+    osiProfileEnter(PROFCODE_GUI_REFR);
+    uint32_t start = (uint32_t)osiUpTimeUS();
+    _lv_disp_refr_task(task);
+    uint32_t refr_us = (uint32_t)osiUpTimeUS() - start;
+    osiProfileExit(PROFCODE_GUI_REFR);
 
-    drvLcdPanelInfo_t panel_info;
-    if (!drvLcdGetPanelInfo(d->lcd, &panel_info))
-        return false;
+    if (area_count != 0)
+    {
+        d->perf.frame_count++;
+        d->perf.area_count += area_count;
+        d->perf.refr_us += refr_us;
+        d->perf.refr_max_us = OSI_MAX(uint32_t, d->perf.refr_max_us, refr_us);
+    }
+}
+
+#if LV_USE_DRAW_PROF
+/**
+ * draw profile callback
+ *
+ * Time is counted to the innermost draw function. So, rectangles drawn
+ * inside an arc won't be counted twice.
+ */
+static void prvDrawProf(lv_draw_prof_type_t type, bool enter)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
 
-    unsigned pixel_cnt = panel_info.width * panel_info.height;
-    lv_color_t *buf = (lv_color_t *)malloc(pixel_cnt * sizeof(lv_color_t));
-    if (buf == NULL)
+    if (type >= LV_GUI_DRAW_TYPE_COUNT)
+        return;
+
+    uint32_t now = (uint32_t)osiUpTimeUS();
+    if (d->draw_depth > 0)
+    {
+        unsigned top = OSI_MIN(unsigned, d->draw_depth, LV_GUI_DRAW_DEPTH) - 1;
+        d->perf.draw_us[d->draw_stack[top]] += now - d->draw_start;
+    }
+    d->draw_start = now;
+
+    if (enter)
+    {
+        osiProfileEnter(PROFCODE_GUI_DRAW_RECT + type);
+        if (d->draw_depth < LV_GUI_DRAW_DEPTH)
+            d->draw_stack[d->draw_depth] = type;
+        d->draw_depth++;
+    }
+    else
+    {
+        if (d->draw_depth > 0)
+            d->draw_depth--;
+        osiProfileExit(PROFCODE_GUI_DRAW_RECT + type);
+    }
+}
+#endif
+
+#ifdef CONFIG_LV_GUI_PERF_MONITOR
+/**
+ * update render statistics label, once per second
+ */
+static void prvPerfMonitorTask(lv_task_t *task)
+{
+    static lvGuiPerf_t last;
+    lv_obj_t *label = (lv_obj_t *)task->user_data;
+
+    lvGuiPerf_t perf;
+    lvGuiGetPerf(&perf);
+
+    uint32_t frames = perf.frame_count - last.frame_count;
+    uint32_t refr_us = perf.refr_us - last.refr_us;
+    char text[96];
+    snprintf(text, sizeof(text), "%u FPS %u us\nwait %u us %u KB/s\nimg miss %u %u ms",
+             (unsigned)frames,
+             (unsigned)(frames == 0 ? 0 : refr_us / frames),
+             (unsigned)(perf.wait_us - last.wait_us),
+             (unsigned)((perf.flush_bytes - last.flush_bytes) / 1024),
+             (unsigned)(perf.img_cache_miss - last.img_cache_miss),
+             (unsigned)(perf.img_open_ms - last.img_open_ms));
+    lv_label_set_text(label, text);
+    last = perf;
+}
+
+/**
+ * create render statistics label on system layer
+ */
+static void prvPerfMonitorCreate(void)
+{
+    lv_obj_t *label = lv_label_create(lv_layer_sys(), NULL);
+    lv_obj_set_style_local_bg_opa(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_50);
+    lv_obj_set_style_local_bg_color(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_BLACK);
+    lv_obj_set_style_local_text_color(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_WHITE);
+    lv_label_set_text(label, "");
+    lv_obj_align(label, NULL, LV_ALIGN_IN_TOP_LEFT, 0, 0);
+    lv_task_create(prvPerfMonitorTask, 1000, LV_TASK_PRIO_LOWEST, label);
+}
+#endif
+
+/**
+ * initialize LCD display device
+ */
+static bool prvLvInitLcd(void)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+
+    lvGuiPortDisp_t info;
+    if (!lvGuiPortDispInit(lv_color_to16(LV_COLOR_TRANSP), &info))
         return false;
 
-    lv_disp_buf_init(&d->disp_buf, buf, buf, pixel_cnt);
+    d->vsync = info.vsync;
+    lv_disp_buf_init(&d->disp_buf, info.buf1, info.buf2, info.width * info.lines);
 
     lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
     disp_drv.flush_cb = prvDispFlush;
     disp_drv.buffer = &d->disp_buf;
     d->disp = lv_disp_drv_register(&disp_drv); // pointer copy
+    if (d->disp == NULL)
+        return false;
+
+    lv_task_set_cb(d->disp->refr_task, prvDispRefrTask);
+#if LV_USE_DRAW_PROF
+    lv_draw_prof_set_cb(prvDrawProf);
+#endif
+    if (d->vsync)
+        lv_task_set_period(d->disp->refr_task, OSI_MAX(unsigned, 1, info.frame_us / 1000));
     return true;
 }
 
 /**
- * callback of keypad driver, called in ISR
+ * resume keypad read task, called in gui thread
  */
-static void prvKeypadCallback(keyMap_t key, keyState_t evt, void *p)
+static void prvKeypadResume(void *param)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    d->last_key = key;
-    d->last_key_state = evt;
-    d->keypad_pending = true;
+    // littlevgl isn't running in always-on display
+    if (d->aod)
+        lvGuiScreenOn();
+
+    lv_task_set_prio(d->keypad->driver.read_task, LV_TASK_PRIO_HIGH);
+    lv_task_ready(d->keypad->driver.read_task);
 }
 
 /**
  * keypad device read_cb
+ *
+ * One key event is read each time, and littlevgl will call it again
+ * when there are more events in FIFO.
  */
 static bool prvLvKeypadRead(lv_indev_drv_t *kp, lv_indev_data_t *data)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
+    lvGuiPortKey_t key;
+    if (lvGuiPortKeypadRead(&key))
+        lvGuiScreenOn();
 
-    uint32_t critical = osiEnterCritical();
-    keyMap_t last_key = d->last_key;
-    keyState_t last_key_state = d->last_key_state;
-    bool keypad_pending = d->keypad_pending;
-    d->keypad_pending = false;
-    osiExitCritical(critical);
+    // Without new event, the last key is reported, and littlevgl detects
+    // long press and repeat on it.
+    data->key = key.key;
+    data->state = key.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
 
-    if (keypad_pending)
-    {
-        data->state = (last_key_state & KEY_STATE_RELEASE) ? LV_INDEV_STATE_REL : LV_INDEV_STATE_PR;
-        data->key = 0xff;
-        for (unsigned n = 0; n < OSI_ARRAY_SIZE(gLvKeyMap); n++)
-        {
-            if (gLvKeyMap[n].keypad == last_key)
-            {
-                data->key = gLvKeyMap[n].lv_key;
-                break;
-            }
-        }
+    if (lvGuiPortKeypadPending())
+        return true;
 
-        lvGuiScreenOn();
-    }
+    // Keypad is interrupt driven. When keys are released, it is not
+    // needed to poll keypad, and the read task will be resumed by port.
+    if (!key.pressed)
+        lv_task_set_prio(kp->read_task, LV_TASK_PRIO_OFF);
 
     // no more to be read
     return false;
@@ -201,80 +402,142 @@ static bool prvLvInitKeypad(void)
     kp_drv.read_cb = prvLvKeypadRead;
     d->keypad = lv_indev_drv_register(&kp_drv); // pointer copy
 
-    drvKeypadInit(); // permit multiple calls
-    drvKeypadSetCB(prvKeypadCallback, KEY_STATE_PRESS | KEY_STATE_RELEASE, NULL);
-    return true;
+    return lvGuiPortKeypadInit(gLvKeyMap, prvKeypadResume, NULL);
+}
+
+/**
+ * run littlevgl task handler, return ms to the next task deadline
+ *
+ * LittlevGL turns off the refresh task when nothing is invalidated, and
+ * the animation task when nothing is animating. Together with keypad read
+ * task, the task timer is only started for application tasks on a static
+ * screen.
+ */
+static uint32_t prvLvRun(void *param)
+{
+    uint32_t next_run = lv_task_handler();
+    return (next_run == LV_NO_TASK_READY) ? LV_GUI_PORT_NO_TASK : next_run;
 }
 
 /**
- * run littlevgl task handler
+ * whether frames should be in time
  */
-static void prvLvTaskHandler(void)
+static bool prvLvBusy(void *param)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
+    return lv_anim_count_running() != 0 || d->disp->inv_p != 0;
+}
 
-    lv_task_handler();
+/**
+ * whether animating
+ */
+static bool prvLvAnimating(void *param)
+{
+    return lv_anim_count_running() != 0;
+}
 
-    //unsigned next_run = lv_task_get_tick_next_run();
-    osiTimerStartRelaxed(d->task_timer, next_run, OSI_WAIT_FOREVER);
+/**
+ * time since the last user activity
+ */
+static uint32_t prvLvInactiveTime(void *param)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+    return lv_disp_get_inactive_time(d->disp);
+}
 
-    //lv_refr_now(d->disp);
+/**
+ * screen off at inactive timeout
+ */
+static void prvLvScreenOff(void *param)
+{
+    lvGuiScreenOff();
 }
 
 /**
- * whether inactive timeout
+ * draw always-on display, and start timer for the next draw
  */
-static bool prvIsInactiveTimeout(void)
+static void prvAodDraw(bool full)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    if (d->screen_on_users != 0)
-        return false;
-    if (d->inactive_timeout == 0)
-        return false;
-    if (!d->anim_inactive && lv_anim_count_running())
-        return false;
-    return lv_disp_get_inactive_time(d->disp) > d->inactive_timeout;
+    uint32_t next_ms = d->aod_draw(d->aod_param, full);
+    osiTimerStartRelaxed(d->aod_timer, next_ms, CONFIG_LV_GUI_AOD_RELAXED_MS);
+}
+
+/**
+ * always-on display timer callback, called in gui thread
+ */
+static void prvAodTimeout(void *param)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+
+    if (d->aod)
+        prvAodDraw(false);
+}
+
+/**
+ * enter always-on display from screen on
+ *
+ * The whole screen is cleared before the LCD enters low power mode, then
+ * only the area of always-on display is written by the draw function.
+ * Task timer is stopped, and task handler isn't executed till exit.
+ */
+static void prvAodEnter(void)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+
+    lvGuiPortDispWaitDone();
+    drvLcdFill(lvGuiPortLcd(), 0, NULL, true);
+    drvLcdEnterLowPower(lvGuiPortLcd(), &d->aod_area);
+    lvGuiPortSuspend(true);
+    d->aod = true;
+    prvAodDraw(true);
 }
 
 /**
- * gui thread entry
+ * exit always-on display
  */
-static void prvLvThreadEntry(void *param)
+static void prvAodExit(void)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
-    d->thread = osiThreadCurrent();
-    d->task_timer = osiTimerCreate(d->thread, (osiCallback_t)prvLvTaskHandler, NULL);
+
+    osiTimerStop(d->aod_timer);
+    drvLcdExitLowPower(lvGuiPortLcd());
+    d->aod = false;
+    lvGuiPortSuspend(false);
+}
+
+/**
+ * initialize littlevgl in gui thread
+ */
+static void prvLvInit(void *param)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+    d->aod_timer = osiTimerCreate(lvGuiPortThread(), prvAodTimeout, NULL);
 
     lv_init();
     prvLvInitLcd();
     prvLvInitKeypad();
+    lvGuiResetPerf();
+#ifdef CONFIG_LV_GUI_PERF_MONITOR
+    prvPerfMonitorCreate();
+#endif
 
-    lvGuiCreate_t create = (lvGuiCreate_t)param;
-    if (create != NULL)
-        create();
+    if (d->create != NULL)
+        d->create();
 
-    osiTimerStart(d->task_timer, 0);
     lv_disp_trig_activity(d->disp);
-    for (;;)
-    {
-        osiEvent_t event;
-        event.id = OSI_EVENT_ID_NONE;
-
-        osiEventWait(d->thread, &event);
-        if (event.id == OSI_EVENT_ID_QUIT)
-            break;
-
-        if (d->screen_on && prvIsInactiveTimeout())
-        {
-            OSI_LOGI(0, "inactive timeout, screen off");
-            lvGuiScreenOff();
-        }
-    }
-
-    osiThreadExit();
 }
 
+static const lvGuiPortOps_t gLvGuiPortOps = {
+    .init = prvLvInit,
+    .run = prvLvRun,
+    .busy = prvLvBusy,
+    .animating = prvLvAnimating,
+    .inactive_time = prvLvInactiveTime,
+    .screen_off = prvLvScreenOff,
+};
+
 /**
  * start gui based on littlevgl
  */
@@ -282,18 +545,11 @@ void lvGuiInit(lvGuiCreate_t create)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    d->screen_on = true;
-    d->keypad_pending = false;
-    d->anim_inactive = false;
-    d->last_key = 0xff;
-    d->last_key_state = KEY_STATE_RELEASE;
-    d->screen_on_users = 0;
-    d->inactive_timeout = CONFIG_LV_GUI_SCREEN_OFF_TIMEOUT;
-
-    d->thread = osiThreadCreate("lvgl", prvLvThreadEntry, create,
-                                OSI_PRIORITY_NORMAL,
-                                CONFIG_LV_GUI_THREAD_STACK_SIZE,
-                                CONFIG_LV_GUI_THREAD_EVENT_COUNT);
+    d->vsync = false;
+    d->aod = false;
+    d->aod_draw = NULL;
+    d->create = create;
+    lvGuiPortStart(&gLvGuiPortOps);
 }
 
 /**
@@ -301,8 +557,7 @@ void lvGuiInit(lvGuiCreate_t create)
  */
 osiThread_t *lvGuiGetThread(void)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    return d->thread;
+    return lvGuiPortThread();
 }
 
 /**
@@ -319,8 +574,15 @@ lv_indev_t *lvGuiGetKeyPad(void)
  */
 void lvGuiThreadCallback(osiCallback_t cb, void *param)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    osiThreadCallback(d->thread, cb, param);
+    osiThreadCallback(lvGuiPortThread(), cb, param);
+}
+
+/**
+ * execute a callback in gui thread, and wait it return
+ */
+void lvGuiThreadCallbackSync(osiCallback_t cb, void *param)
+{
+    osiThreadCallbackSync(lvGuiPortThread(), cb, param);
 }
 
 /**
@@ -328,8 +590,7 @@ void lvGuiThreadCallback(osiCallback_t cb, void *param)
  */
 void lvGuiSendEvent(const osiEvent_t *evt)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    osiEventSend(d->thread, evt);
+    osiEventSend(lvGuiPortThread(), evt);
 }
 
 /**
@@ -337,14 +598,7 @@ void lvGuiSendEvent(const osiEvent_t *evt)
  */
 bool lvGuiRequestSceenOn(uint8_t id)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-
-    if (id > 31)
-        return false;
-
-    unsigned mask = (1 << id);
-    d->screen_on_users |= mask;
-    return true;
+    return lvGuiPortRequestScreenOn(id);
 }
 
 /**
@@ -352,14 +606,7 @@ bool lvGuiRequestSceenOn(uint8_t id)
  */
 bool lvGuiReleaseScreenOn(uint8_t id)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-
-    if (id > 31)
-        return false;
-
-    unsigned mask = (1 << id);
-    d->screen_on_users &= ~mask;
-    return true;
+    return lvGuiPortReleaseScreenOn(id);
 }
 
 /**
@@ -369,13 +616,20 @@ void lvGuiScreenOff(void)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    if (!d->screen_on)
+    if (!lvGuiPortScreenIsOn())
+        return;
+
+    if (d->aod_draw != NULL)
+    {
+        // back light is kept, or the always-on display can't be seen
+        OSI_LOGI(0, "screen off, always-on display");
+        lvGuiPortScreenOff(false);
+        prvAodEnter();
         return;
+    }
 
     OSI_LOGI(0, "screen off");
-    drvLcdSetBackLightEnable(d->lcd, false);
-    drvLcdSleep(d->lcd);
-    d->screen_on = false;
+    lvGuiPortScreenOff(true);
 }
 
 /**
@@ -385,30 +639,206 @@ void lvGuiScreenOn(void)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    if (d->screen_on)
+    if (lvGuiPortScreenIsOn())
         return;
 
     OSI_LOGI(0, "screen on");
-    drvLcdWakeup(d->lcd);
+    bool aod = d->aod;
+    if (aod)
+        prvAodExit();
+    lvGuiPortScreenOn(!aod); // flush is dropped when screen is off
     prvDispForceFlush();
-    drvLcdSetBackLightEnable(d->lcd, true);
-    d->screen_on = true;
+    lvGuiPortBackLightOn();
+}
+
+/**
+ * set always-on display for screen off
+ */
+void lvGuiSetAod(const drvLcdArea_t *area, lvGuiAodDraw_t draw, void *param)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+
+    if (draw != NULL)
+        d->aod_area = *area;
+    d->aod_draw = draw;
+    d->aod_param = param;
+
+    if (d->aod && draw == NULL)
+    {
+        OSI_LOGI(0, "always-on display off");
+        osiTimerStop(d->aod_timer);
+        lvGuiPortScreenOff(true);
+        d->aod = false;
+        lvGuiPortSuspend(false); // no more to be skipped in gui thread
+    }
+}
+
+/**
+ * write pixels to screen in always-on display
+ */
+bool lvGuiAodFlush(const drvLcdArea_t *roi, const void *buf)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+
+    if (!d->aod || roi == NULL || buf == NULL || drvLcdAreaIsNul(roi))
+        return false;
+
+    // GOUDA is opened for this transfer only
+    return lvGuiPortDispWrite(roi, buf);
 }
 
 /**
  * set screen off timeout at inactive
  */
 void lvGuiSetInactiveTimeout(unsigned timeout)
+{
+    lvGuiPortSetInactiveTimeout(timeout);
+}
+
+/**
+ * invalidate the area of extern layer
+ */
+static void prvInvalidateLayerArea(bool enabled, const drvLcdArea_t *out)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
-    d->inactive_timeout = timeout;
+
+    if (!enabled || drvLcdAreaIsNul(out))
+        return;
+
+    lv_area_t area = {
+        .x1 = out->x,
+        .y1 = out->y,
+        .x2 = drvLcdAreaEndX(out),
+        .y2 = drvLcdAreaEndY(out),
+    };
+    _lv_inv_area(d->disp, &area);
+}
+
+/**
+ * set application hardware overlay
+ */
+bool lvGuiSetOverlay(unsigned n, const drvLcdOverlay_t *ovl)
+{
+    const drvLcdOverlay_t *cur = lvGuiPortGetOverlay(n);
+    if (cur == NULL)
+        return false;
+
+    prvInvalidateLayerArea(cur->enabled, &cur->out);
+    lvGuiPortSetOverlay(n, ovl);
+    prvInvalidateLayerArea(cur->enabled, &cur->out);
+    return true;
+}
+
+/**
+ * set application hardware video layer
+ */
+void lvGuiSetVideoLayer(const drvLcdVideoLayer_t *vl)
+{
+    const drvLcdVideoLayer_t *cur = lvGuiPortGetVideoLayer();
+
+    prvInvalidateLayerArea(cur->enabled, &cur->out);
+    lvGuiPortSetVideoLayer(vl);
+    prvInvalidateLayerArea(cur->enabled, &cur->out);
 }
 
 /**
  * set whether animation is regarded as inactive
  */
 void lvGuiSetAnimationInactive(bool inactive)
+{
+    lvGuiPortSetAnimationInactive(inactive);
+}
+
+/**
+ * get littlevgl render statistics
+ */
+void lvGuiGetPerf(lvGuiPerf_t *perf)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+
+    lvGuiPortStat_t stat;
+    lvGuiPortGetStat(&stat);
+
+    lv_img_cache_stat_t img_stat;
+    uint32_t critical = osiEnterCritical();
+    *perf = d->perf;
+    lv_img_cache_get_stat(&img_stat);
+    osiExitCritical(critical);
+
+    perf->wait_us = stat.wait_us;
+    perf->flush_count = stat.flush_count;
+    perf->flush_bytes = stat.flush_bytes;
+    perf->key_count = stat.key_count;
+    perf->key_latency_us = stat.key_latency_us;
+    perf->key_latency_max_us = stat.key_latency_max_us;
+    perf->key_dropped = stat.key_dropped;
+    perf->img_cache_hit = img_stat.hit_cnt;
+    perf->img_cache_miss = img_stat.miss_cnt;
+    perf->img_open_ms = img_stat.open_time;
+}
+
+/**
+ * reset littlevgl render statistics
+ */
+void lvGuiResetPerf(void)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
-    d->anim_inactive = inactive;
+
+    uint32_t critical = osiEnterCritical();
+    memset(&d->perf, 0, sizeof(d->perf));
+    lv_img_cache_reset_stat();
+    osiExitCritical(critical);
+    lvGuiPortResetStat();
+}
+
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_LVGL
+/**
+ * AT+QLVPERF: show or reset littlevgl render statistics
+ */
+void atCmdHandleQLVPERF(atCommand_t *cmd)
+{
+    if (cmd->type == AT_CMD_SET)
+    {
+        // AT+QLVPERF=<reset>
+        bool paramok = true;
+        unsigned reset = atParamUintInRange(cmd->params[0], 0, 1, &paramok);
+        if (!paramok || cmd->param_count > 1)
+            RETURN_CME_ERR(cmd->engine, ERR_AT_CME_PARAM_INVALID);
+
+        if (reset)
+            lvGuiResetPerf();
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_EXE || cmd->type == AT_CMD_READ)
+    {
+        lvGuiPerf_t perf;
+        lvGuiGetPerf(&perf);
+
+        // +QLVPERF: <frames>,<areas>,<refr_us>,<refr_max_us>,<rect_us>,<img_us>,
+        //           <label_us>,<arc_us>,<wait_us>,<flushes>,<flush_bytes>,
+        //           <img_hits>,<img_misses>,<img_open_ms>,
+        //           <keys>,<key_latency_us>,<key_latency_max_us>,<keys_dropped>
+        char rsp[240];
+        snprintf(rsp, sizeof(rsp), "+QLVPERF: %u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u",
+                 (unsigned)perf.frame_count, (unsigned)perf.area_count,
+                 (unsigned)perf.refr_us, (unsigned)perf.refr_max_us,
+                 (unsigned)perf.draw_us[LV_DRAW_PROF_RECT], (unsigned)perf.draw_us[LV_DRAW_PROF_IMG],
+                 (unsigned)perf.draw_us[LV_DRAW_PROF_LABEL], (unsigned)perf.draw_us[LV_DRAW_PROF_ARC],
+                 (unsigned)perf.wait_us, (unsigned)perf.flush_count, (unsigned)perf.flush_bytes,
+                 (unsigned)perf.img_cache_hit, (unsigned)perf.img_cache_miss, (unsigned)perf.img_open_ms,
+                 (unsigned)perf.key_count, (unsigned)perf.key_latency_us,
+                 (unsigned)perf.key_latency_max_us, (unsigned)perf.key_dropped);
+        atCmdRespInfoText(cmd->engine, rsp);
+        atCmdRespOK(cmd->engine);
+    }
+    else if (cmd->type == AT_CMD_TEST)
+    {
+        atCmdRespInfoText(cmd->engine, "+QLVPERF: (0,1)");
+        atCmdRespOK(cmd->engine);
+    }
+    else
+    {
+        atCmdRespCmeError(cmd->engine, ERR_AT_CME_OPERATION_NOT_SUPPORTED);
+    }
 }
+#endif
@@ -0,0 +1,229 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
+
+#include "lv_gui_mem.h"
+#include "lv_gui_main.h"
+#include "lvgl.h"
+#include "osi_api.h"
+#include "osi_mem.h"
+#include "osi_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// block counts and sizes of fixed pool children, including block header
+// and littlevgl header. They are for style lists, linked list nodes and
+// label texts, most objects and object extensions.
+#define LV_GUI_MEM_CLASS_32_COUNT (128)
+#define LV_GUI_MEM_CLASS_64_COUNT (128)
+#define LV_GUI_MEM_CLASS_128_COUNT (64)
+
+/**
+ * header of each block, 8 bytes to keep alignment of malloc
+ */
+typedef struct
+{
+    uint16_t arena; // arena accounted to
+    uint16_t heap;  // allocated from system heap
+    uint32_t size;  // requested size
+} lvGuiMemHeader_t;
+
+typedef struct
+{
+    bool inited;                                   // pool is initialized, or failed
+    bool shrink_pending;                           // image cache shrink is posted to gui thread
+    unsigned arena;                                // current arena
+    osiMemPool_t *pool;                            // littlevgl block pool
+    uint32_t used;                                 // allocated size
+    uint32_t max_used;                             // peak of allocated size
+    uint32_t heap_used;                            // allocated size from system heap
+    uint32_t alloc_count;                          // count of allocated blocks
+    uint32_t arena_used[LV_GUI_MEM_ARENA_COUNT];   // allocated size of each arena
+} lvGuiMemContext_t;
+
+static lvGuiMemContext_t gLvGuiMemCtx;
+static uint8_t gLvGuiMemBuf[CONFIG_LV_GUI_MEM_POOL_SIZE] OSI_ALIGNED(16);
+
+/**
+ * drop decoded images in image cache, called in gui thread
+ */
+static void prvMemShrink(void *param)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+
+    d->shrink_pending = false;
+    lv_img_cache_invalidate_src(NULL);
+    OSI_LOGI(0, "lvgl memory pressure, image cache dropped, used/%d", d->used);
+}
+
+/**
+ * memory budget pressure callback, called in allocating thread
+ *
+ * Image cache can't be dropped inside allocation, which may be called
+ * from image decoder. So it is deferred to gui thread.
+ */
+static void prvMemPressure(void *ctx, osiMemBudgetId_t id, size_t need)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+
+    if (d->shrink_pending || lvGuiGetThread() == NULL)
+        return;
+
+    d->shrink_pending = true;
+    lvGuiThreadCallback(prvMemShrink, NULL);
+}
+
+/**
+ * system memory pressure callback, called in system work queue
+ */
+static void prvHeapPressure(void *ctx)
+{
+    prvMemPressure(ctx, OSI_MEM_BUDGET_LVGL, 0);
+}
+
+/**
+ * create the block pool at the first allocation, before lv_init
+ */
+static void prvMemInit(void)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+
+    d->inited = true;
+    osiMemBudgetSetCallback(OSI_MEM_BUDGET_LVGL, prvMemPressure, NULL);
+    d->pool = osiBlockPoolInit(gLvGuiMemBuf, sizeof(gLvGuiMemBuf),
+                               LV_GUI_MEM_CLASS_32_COUNT, 32,
+                               LV_GUI_MEM_CLASS_64_COUNT, 64,
+                               LV_GUI_MEM_CLASS_128_COUNT, 128,
+                               0);
+    if (d->pool == NULL)
+        OSI_LOGE(0, "lvgl memory pool init failed");
+
+    // image cache is dropped on system memory pressure also
+    osiMemReportSetPool(OSI_MEM_BUDGET_LVGL, d->pool);
+    osiMemPressureRegister(prvHeapPressure, NULL);
+}
+
+/**
+ * allocate memory for littlevgl
+ */
+void *lvGuiMemAlloc(size_t size)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+    lvGuiMemHeader_t *h = NULL;
+    bool heap = false;
+
+    if (!d->inited)
+        prvMemInit();
+
+    if (!osiMemBudgetCharge(OSI_MEM_BUDGET_LVGL, size))
+        return NULL;
+
+    if (d->pool != NULL)
+        h = (lvGuiMemHeader_t *)osiPoolMalloc(d->pool, size + sizeof(lvGuiMemHeader_t));
+
+    if (h == NULL)
+    {
+        h = (lvGuiMemHeader_t *)malloc(size + sizeof(lvGuiMemHeader_t));
+        if (h == NULL)
+        {
+            osiMemBudgetUncharge(OSI_MEM_BUDGET_LVGL, size);
+            return NULL;
+        }
+        heap = true;
+    }
+
+    // littlevgl is called in gui thread only, no protection for counters
+    h->arena = d->arena;
+    h->heap = heap ? 1 : 0;
+    h->size = size;
+
+    d->used += size;
+    if (d->used > d->max_used)
+        d->max_used = d->used;
+    if (heap)
+        d->heap_used += size;
+    d->arena_used[h->arena] += size;
+    d->alloc_count++;
+    return h + 1;
+}
+
+/**
+ * free memory allocated by lvGuiMemAlloc
+ */
+void lvGuiMemFree(void *ptr)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+
+    if (ptr == NULL)
+        return;
+
+    lvGuiMemHeader_t *h = (lvGuiMemHeader_t *)ptr - 1;
+    osiMemBudgetUncharge(OSI_MEM_BUDGET_LVGL, h->size);
+    d->used -= h->size;
+    d->arena_used[h->arena] -= h->size;
+    d->alloc_count--;
+
+    if (h->heap)
+    {
+        d->heap_used -= h->size;
+        free(h);
+    }
+    else
+    {
+        osiFree(h);
+    }
+}
+
+/**
+ * set the current memory arena
+ */
+unsigned lvGuiMemSetArena(unsigned arena)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+    unsigned prev = d->arena;
+
+    d->arena = arena < LV_GUI_MEM_ARENA_COUNT ? arena : 0;
+    return prev;
+}
+
+/**
+ * get allocated size accounted to the arena
+ */
+uint32_t lvGuiMemArenaUsed(unsigned arena)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+
+    if (arena >= LV_GUI_MEM_ARENA_COUNT)
+        return 0;
+    return d->arena_used[arena];
+}
+
+/**
+ * get littlevgl memory statistics
+ */
+void lvGuiMemGetStat(lvGuiMemStat_t *stat)
+{
+    lvGuiMemContext_t *d = &gLvGuiMemCtx;
+    osiMemPoolStat_t pool_stat = {};
+
+    if (d->pool != NULL)
+        osiMemPoolStat(d->pool, &pool_stat);
+
+    stat->pool_size = pool_stat.size;
+    stat->pool_avail = pool_stat.avail_size;
+    stat->pool_max_block = pool_stat.max_block_size;
+    stat->used = d->used;
+    stat->max_used = d->max_used;
+    stat->heap_used = d->heap_used;
+    stat->alloc_count = d->alloc_count;
+}
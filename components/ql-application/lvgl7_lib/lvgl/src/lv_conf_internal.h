@@ -134,6 +134,17 @@
 #  endif
 #endif
 
+/* Invalid areas which don't overlap are joined if the joined area is larger
+ * by at most this many pixels. It's about the cost of refreshing one more area
+ * (looking for its top object, setting up the flush).*/
+#ifndef LV_REFR_JOIN_OVERHEAD
+#  ifdef CONFIG_LV_REFR_JOIN_OVERHEAD
+#    define LV_REFR_JOIN_OVERHEAD CONFIG_LV_REFR_JOIN_OVERHEAD
+#  else
+#    define  LV_REFR_JOIN_OVERHEAD        0    /*[px]*/
+#  endif
+#endif
+
 /* Dot Per Inch: used to initialize default sizes.
  * E.g. a button with width = LV_DPI / 2 -> half inch wide
  * (Not so important, you can adjust it to modify default sizes and spaces)*/
@@ -385,6 +396,28 @@
 
 #endif
 
+/* Draw the rounded corners of rectangles from buffered coverage, without masks,
+ * if there are no other masks.
+ * LV_RECT_CORNER_CACHE_SIZE is the max. radius to buffer.
+ * A buffered corner has radius^2 RAM cost*/
+#ifndef LV_RECT_CORNER_CACHE_SIZE
+#  ifdef CONFIG_LV_RECT_CORNER_CACHE_SIZE
+#    define LV_RECT_CORNER_CACHE_SIZE CONFIG_LV_RECT_CORNER_CACHE_SIZE
+#  else
+#    define  LV_RECT_CORNER_CACHE_SIZE   0
+#  endif
+#endif
+#if LV_RECT_CORNER_CACHE_SIZE
+/*Number of buffered corners. The least recently used one is replaced*/
+#ifndef LV_RECT_CORNER_CACHE_NUM
+#  ifdef CONFIG_LV_RECT_CORNER_CACHE_NUM
+#    define LV_RECT_CORNER_CACHE_NUM CONFIG_LV_RECT_CORNER_CACHE_NUM
+#  else
+#    define  LV_RECT_CORNER_CACHE_NUM    1
+#  endif
+#endif
+#endif
+
 /* 1: Enable shadow drawing on rectangles*/
 #ifndef LV_USE_SHADOW
 #  ifdef CONFIG_LV_USE_SHADOW
@@ -397,7 +430,7 @@
 /* Allow buffering some shadow calculation
  * LV_SHADOW_CACHE_SIZE is the max. shadow size to buffer,
  * where shadow size is `shadow_width + radius`
- * Caching has LV_SHADOW_CACHE_SIZE^2 RAM cost*/
+ * A buffered shadow has shadow size^2 RAM cost*/
 #ifndef LV_SHADOW_CACHE_SIZE
 #  ifdef CONFIG_LV_SHADOW_CACHE_SIZE
 #    define LV_SHADOW_CACHE_SIZE CONFIG_LV_SHADOW_CACHE_SIZE
@@ -405,6 +438,24 @@
 #    define  LV_SHADOW_CACHE_SIZE    0
 #  endif
 #endif
+#if LV_SHADOW_CACHE_SIZE
+/*Number of buffered shadows. The least recently used one is replaced*/
+#ifndef LV_SHADOW_CACHE_NUM
+#  ifdef CONFIG_LV_SHADOW_CACHE_NUM
+#    define LV_SHADOW_CACHE_NUM CONFIG_LV_SHADOW_CACHE_NUM
+#  else
+#    define  LV_SHADOW_CACHE_NUM     1
+#  endif
+#endif
+/*Max. RAM of the buffered shadows in bytes. 0: limit the number only*/
+#ifndef LV_SHADOW_CACHE_MEM_SIZE
+#  ifdef CONFIG_LV_SHADOW_CACHE_MEM_SIZE
+#    define LV_SHADOW_CACHE_MEM_SIZE CONFIG_LV_SHADOW_CACHE_MEM_SIZE
+#  else
+#    define  LV_SHADOW_CACHE_MEM_SIZE    0
+#  endif
+#endif
+#endif
 #endif
 
 /*1: enable outline drawing on rectangles*/
@@ -452,6 +503,16 @@
 #  endif
 #endif
 
+/* 1: Cache the resolved values of the most used style properties (background, border, radius,
+ * text, image recolor) in the style lists. Faster drawing for about 20 bytes per style list*/
+#ifndef LV_STYLE_CACHE_VALUES
+#  ifdef CONFIG_LV_STYLE_CACHE_VALUES
+#    define LV_STYLE_CACHE_VALUES CONFIG_LV_STYLE_CACHE_VALUES
+#  else
+#    define  LV_STYLE_CACHE_VALUES   0
+#  endif
+#endif
+
 /* 1: Use image zoom and rotation*/
 #ifndef LV_USE_IMG_TRANSFORM
 #  ifdef CONFIG_LV_USE_IMG_TRANSFORM
@@ -528,6 +589,40 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #  endif
 #endif
 
+/*1: Use GOUDA for CPU off-load of large fills and opaque copies on 8910 */
+#ifndef LV_USE_GPU_8910_GOUDA
+#  ifdef CONFIG_LV_USE_GPU_8910_GOUDA
+#    define LV_USE_GPU_8910_GOUDA CONFIG_LV_USE_GPU_8910_GOUDA
+#  else
+#    define  LV_USE_GPU_8910_GOUDA    0
+#  endif
+#endif
+/*Smallest area (in pixels) handed over to GOUDA. Smaller areas are rendered by the CPU*/
+#ifndef LV_GPU_8910_GOUDA_SIZE_LIMIT
+#  ifdef CONFIG_LV_GPU_8910_GOUDA_SIZE_LIMIT
+#    define LV_GPU_8910_GOUDA_SIZE_LIMIT CONFIG_LV_GPU_8910_GOUDA_SIZE_LIMIT
+#  else
+#    define  LV_GPU_8910_GOUDA_SIZE_LIMIT 2048
+#  endif
+#endif
+
+/*1: Use NEON kernels for RGB565 fills and image blending in software rendering */
+#ifndef LV_USE_DRAW_NEON
+#  ifdef CONFIG_LV_USE_DRAW_NEON
+#    define LV_USE_DRAW_NEON CONFIG_LV_USE_DRAW_NEON
+#  else
+#    define  LV_USE_DRAW_NEON         0
+#  endif
+#endif
+/*1: Blend every line by software too and assert the NEON result is the same. For test builds only*/
+#ifndef LV_DRAW_NEON_CHECK
+#  ifdef CONFIG_LV_DRAW_NEON_CHECK
+#    define LV_DRAW_NEON_CHECK CONFIG_LV_DRAW_NEON_CHECK
+#  else
+#    define  LV_DRAW_NEON_CHECK       0
+#  endif
+#endif
+
 /* 1: Enable file system (might be required for images */
 #ifndef LV_USE_FILESYSTEM
 #  ifdef CONFIG_LV_USE_FILESYSTEM
@@ -558,6 +653,16 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #  endif
 #endif
 
+/*1: Call the callback set by `lv_draw_prof_set_cb` at entry and exit of
+ * rectangle, image, label and arc drawing*/
+#ifndef LV_USE_DRAW_PROF
+#  ifdef CONFIG_LV_USE_DRAW_PROF
+#    define LV_USE_DRAW_PROF CONFIG_LV_USE_DRAW_PROF
+#  else
+#    define  LV_USE_DRAW_PROF        0
+#  endif
+#endif
+
 /*1: Use the functions and types from the older API if possible */
 #ifndef LV_USE_API_EXTENSION_V6
 #  ifdef CONFIG_LV_USE_API_EXTENSION_V6
@@ -596,6 +701,18 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #  endif
 #endif
 
+/* Indexed and alpha indexed images are decoded to true color with alpha when opened,
+ * if they need at most this many bytes. Decoded images are drawn at once instead of
+ * line by line, and can be zoomed and rotated. The decoded image is kept in the image cache.
+ * 0: always read line by line*/
+#ifndef LV_IMG_DECODE_FULL_MAX
+#  ifdef CONFIG_LV_IMG_DECODE_FULL_MAX
+#    define LV_IMG_DECODE_FULL_MAX CONFIG_LV_IMG_DECODE_FULL_MAX
+#  else
+#    define  LV_IMG_DECODE_FULL_MAX  0
+#  endif
+#endif
+
 /* Default image cache size. Image caching keeps the images opened.
  * If only the built-in image formats are used there is no real advantage of caching.
  * (I.e. no new image decoder is added)
@@ -610,6 +727,17 @@ e.g. "stm32f769xx.h" or "stm32f429xx.h" */
 #  endif
 #endif
 
+/* Memory budget of the decoded images in the cache in bytes.
+ * The least recently used images are closed when it is exceeded.
+ * Set it to 0 to limit the count of images only */
+#ifndef LV_IMG_CACHE_MEM_SIZE
+#  ifdef CONFIG_LV_IMG_CACHE_MEM_SIZE
+#    define LV_IMG_CACHE_MEM_SIZE CONFIG_LV_IMG_CACHE_MEM_SIZE
+#  else
+#    define  LV_IMG_CACHE_MEM_SIZE       0
+#  endif
+#endif
+
 /*Declare the type of the user data of image decoder (can be e.g. `void *`, `int`, `struct`)*/
 
 /*=====================
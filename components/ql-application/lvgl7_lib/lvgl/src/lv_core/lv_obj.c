@@ -139,6 +139,8 @@ static void fade_in_anim_ready(lv_anim_t * a);
 #endif
 static void lv_event_mark_deleted(lv_obj_t * obj);
 static bool obj_valid_child(const lv_obj_t * parent, const lv_obj_t * obj_to_find);
+static bool obj_area_is_covered(const lv_obj_t * obj, const lv_area_t * area);
+static bool obj_covers_area(lv_obj_t * obj, const lv_area_t * area);
 static void lv_obj_del_async_cb(void * obj);
 static void obj_del_core(lv_obj_t * obj);
 static void update_style_cache(lv_obj_t * obj, uint8_t part, uint16_t prop);
@@ -552,6 +554,9 @@ void lv_obj_invalidate_area(const lv_obj_t * obj, const lv_area_t * area)
     lv_area_copy(&area_tmp, area);
     bool visible = lv_obj_area_is_visible(obj, &area_tmp);
 
+    /*Nothing to redraw if an opaque younger sibling (of the object or a parent) is drawn over the area*/
+    if(visible && obj_area_is_covered(obj, &area_tmp)) visible = false;
+
     if(visible) _lv_inv_area(lv_obj_get_disp(obj), &area_tmp);
 }
 
@@ -704,6 +709,9 @@ void lv_obj_set_parent(lv_obj_t * obj, lv_obj_t * parent)
     /*Notify the new parent about the child*/
     parent->signal_cb(parent, LV_SIGNAL_CHILD_CHG, obj);
 
+    /*The inherited style properties come from the new parent*/
+    invalidate_style_cache(obj, LV_OBJ_PART_ALL, LV_STYLE_PROP_ALL);
+
     lv_obj_invalidate(obj);
 }
 
@@ -1731,6 +1739,8 @@ void lv_obj_set_state(lv_obj_t * obj, lv_state_t new_state)
     obj->state = new_state;
 
     if(cmp_res == STYLE_COMPARE_SAME) {
+        /*Nothing to redraw, but properties which aren't drawn now (e.g. the color of a transparent text) might be changed*/
+        invalidate_style_cache(obj, LV_OBJ_PART_ALL, LV_STYLE_PROP_ALL);
         return;
     }
 
@@ -2584,6 +2594,15 @@ lv_style_int_t _lv_obj_get_style_int(const lv_obj_t * obj, uint8_t part, lv_styl
         if(!list->ignore_cache && list->style_cnt > 0) {
             if(!list->valid_cache) update_style_cache((lv_obj_t *)parent, part, prop  & (~LV_STYLE_STATE_MASK));
 
+#if LV_STYLE_CACHE_VALUES
+            switch(prop  & (~LV_STYLE_STATE_MASK)) {
+                case LV_STYLE_RADIUS:
+                    return list->cache.radius;
+                case LV_STYLE_BORDER_WIDTH:
+                    return list->cache.border_width;
+            }
+#endif
+
             bool def = false;
             switch(prop  & (~LV_STYLE_STATE_MASK)) {
                 case LV_STYLE_CLIP_CORNER:
@@ -2713,6 +2732,22 @@ lv_color_t _lv_obj_get_style_color(const lv_obj_t * obj, uint8_t part, lv_style_
     while(parent) {
         lv_style_list_t * list = lv_obj_get_style_list(parent, part);
 
+#if LV_STYLE_CACHE_VALUES
+        if(!list->ignore_cache && list->style_cnt > 0) {
+            if(!list->valid_cache) update_style_cache((lv_obj_t *)parent, part, prop  & (~LV_STYLE_STATE_MASK));
+            switch(prop  & (~LV_STYLE_STATE_MASK)) {
+                case LV_STYLE_BG_COLOR:
+                    return list->cache.bg_color;
+                case LV_STYLE_BORDER_COLOR:
+                    return list->cache.border_color;
+                case LV_STYLE_TEXT_COLOR:
+                    return list->cache.text_color;
+                case LV_STYLE_IMAGE_RECOLOR:
+                    return list->cache.image_recolor;
+            }
+        }
+#endif
+
         lv_state_t state = lv_obj_get_state(parent, part);
         prop = (uint16_t)prop_ori + ((uint16_t)state << LV_STYLE_STATE_POS);
 
@@ -2771,6 +2806,20 @@ lv_opa_t _lv_obj_get_style_opa(const lv_obj_t * obj, uint8_t part, lv_style_prop
 
         if(!list->ignore_cache && list->style_cnt > 0) {
             if(!list->valid_cache) update_style_cache((lv_obj_t *)parent, part, prop  & (~LV_STYLE_STATE_MASK));
+
+#if LV_STYLE_CACHE_VALUES
+            switch(prop & (~LV_STYLE_STATE_MASK)) {
+                case LV_STYLE_BG_OPA:
+                    return list->cache.bg_opa;
+                case LV_STYLE_BORDER_OPA:
+                    return list->cache.border_opa;
+                case LV_STYLE_TEXT_OPA:
+                    return list->cache.text_opa;
+                case LV_STYLE_IMAGE_RECOLOR_OPA:
+                    return list->cache.image_recolor_opa;
+            }
+#endif
+
             bool def = false;
             switch(prop & (~LV_STYLE_STATE_MASK)) {
                 case LV_STYLE_OPA_SCALE:
@@ -2849,6 +2898,11 @@ const void * _lv_obj_get_style_ptr(const lv_obj_t * obj, uint8_t part, lv_style_
 
         if(!list->ignore_cache && list->style_cnt > 0) {
             if(!list->valid_cache) update_style_cache((lv_obj_t *)parent, part, prop  & (~LV_STYLE_STATE_MASK));
+
+#if LV_STYLE_CACHE_VALUES
+            if((prop  & (~LV_STYLE_STATE_MASK)) == LV_STYLE_TEXT_FONT) return list->cache.text_font;
+#endif
+
             bool def = false;
             switch(prop  & (~LV_STYLE_STATE_MASK)) {
                 case LV_STYLE_VALUE_STR:
@@ -4421,6 +4475,7 @@ static void trans_del(lv_obj_t * obj, uint8_t part, lv_style_property_t prop, lv
             lv_style_list_t * list = lv_obj_get_style_list(tr->obj, tr->part);
             lv_style_t * style_trans = _lv_style_list_get_transition_style(list);
             lv_style_remove_prop(style_trans, tr->prop);
+            invalidate_style_cache(tr->obj, tr->part, tr->prop);
 
             lv_anim_del(tr, NULL);
             _lv_ll_remove(&LV_GC_ROOT(_lv_obj_style_trans_ll), tr);
@@ -4515,6 +4570,7 @@ static void trans_anim_ready_cb(lv_anim_t * a)
         lv_style_list_t * list = lv_obj_get_style_list(tr->obj, tr->part);
         lv_style_t * style_trans = _lv_style_list_get_transition_style(list);
         lv_style_remove_prop(style_trans, tr->prop);
+        invalidate_style_cache(tr->obj, tr->part, tr->prop);
     }
 
     _lv_ll_remove(&LV_GC_ROOT(_lv_obj_style_trans_ll), tr);
@@ -4529,6 +4585,7 @@ static void opa_scale_anim(lv_obj_t * obj, lv_anim_value_t v)
 static void fade_in_anim_ready(lv_anim_t * a)
 {
     lv_style_remove_prop(lv_obj_get_local_style(a->var, LV_OBJ_PART_MAIN), LV_STYLE_OPA_SCALE);
+    invalidate_style_cache(a->var, LV_OBJ_PART_MAIN, LV_STYLE_OPA_SCALE);
 }
 
 #endif
@@ -4558,6 +4615,63 @@ static bool obj_valid_child(const lv_obj_t * parent, const lv_obj_t * obj_to_fin
     return false;
 }
 
+/**
+ * Tell whether an area of an object is fully covered by objects drawn over it.
+ * The younger siblings of the object and of its parents are checked, the same way
+ * `lv_refr` looks for the top object to start the drawing from.
+ * @param obj pointer to an object
+ * @param area the area to check, already truncated to the object and its parents
+ * @return true: the area is hidden by an opaque object, redrawing it wouldn't change anything
+ */
+static bool obj_area_is_covered(const lv_obj_t * obj, const lv_area_t * area)
+{
+    const lv_obj_t * border_p = obj;
+    lv_obj_t * par = lv_obj_get_parent(obj);
+
+    /*Screens are not checked, they are drawn in their own order*/
+    while(par != NULL) {
+        lv_obj_t * i = _lv_ll_get_prev(&par->child_ll, border_p);
+        while(i != NULL) {
+            if(obj_covers_area(i, area)) return true;
+            i = _lv_ll_get_prev(&par->child_ll, i);
+        }
+
+        border_p = par;
+        par = lv_obj_get_parent(par);
+    }
+
+    return false;
+}
+
+/**
+ * Tell whether an object or one of its children fully covers an area
+ * @param obj pointer to an object
+ * @param area the area to check
+ * @return true: `area` is covered
+ */
+static bool obj_covers_area(lv_obj_t * obj, const lv_area_t * area)
+{
+    if(obj->hidden || _lv_area_is_in(area, &obj->coords, 0) == false) return false;
+
+    lv_design_res_t design_res = obj->design_cb(obj, area, LV_DESIGN_COVER_CHK);
+    if(design_res == LV_DESIGN_RES_MASKED) return false;
+
+#if LV_USE_OPA_SCALE
+    if(design_res == LV_DESIGN_RES_COVER && lv_obj_get_style_opa_scale(obj, LV_OBJ_PART_MAIN) != LV_OPA_COVER) {
+        design_res = LV_DESIGN_RES_NOT_COVER;
+    }
+#endif
+
+    if(design_res == LV_DESIGN_RES_COVER) return true;
+
+    lv_obj_t * child;
+    _LV_LL_READ(obj->child_ll, child) {
+        if(obj_covers_area(child, area)) return true;
+    }
+
+    return false;
+}
+
 static bool style_prop_is_cacheble(lv_style_property_t prop)
 {
 
@@ -4599,6 +4713,14 @@ static bool style_prop_is_cacheble(lv_style_property_t prop)
         case LV_STYLE_SHADOW_BLEND_MODE:
         case LV_STYLE_TEXT_BLEND_MODE:
         case LV_STYLE_VALUE_BLEND_MODE:
+#if LV_STYLE_CACHE_VALUES
+        case LV_STYLE_BG_COLOR:
+        case LV_STYLE_BORDER_COLOR:
+        case LV_STYLE_BORDER_OPA:
+        case LV_STYLE_TEXT_COLOR:
+        case LV_STYLE_TEXT_OPA:
+        case LV_STYLE_IMAGE_RECOLOR:
+#endif
             return true;
             break;
         default:
@@ -4688,6 +4810,20 @@ static void update_style_cache(lv_obj_t * obj, uint8_t part, uint16_t prop)
         list->blend_mode_all_normal = 0;
     }
 #endif
+
+#if LV_STYLE_CACHE_VALUES
+    list->cache.bg_color = lv_obj_get_style_bg_color(obj, part);
+    list->cache.bg_opa = bg_opa;
+    list->cache.border_color = lv_obj_get_style_border_color(obj, part);
+    list->cache.border_opa = lv_obj_get_style_border_opa(obj, part);
+    list->cache.border_width = lv_obj_get_style_border_width(obj, part);
+    list->cache.radius = lv_obj_get_style_radius(obj, part);
+    list->cache.text_font = lv_obj_get_style_text_font(obj, part);
+    list->cache.text_color = lv_obj_get_style_text_color(obj, part);
+    list->cache.text_opa = lv_obj_get_style_text_opa(obj, part);
+    list->cache.image_recolor = lv_obj_get_style_image_recolor(obj, part);
+    list->cache.image_recolor_opa = lv_obj_get_style_image_recolor_opa(obj, part);
+#endif
     list->ignore_cache = ignore_cache_ori;
     list->valid_cache = 1;
 }
@@ -4718,6 +4854,15 @@ static void update_style_cache_children(lv_obj_t * obj)
             list->text_space_zero = 0;
         }
 
+#if LV_STYLE_CACHE_VALUES
+        /*The inherited properties*/
+        list->cache.text_font = lv_obj_get_style_text_font(obj, part);
+        list->cache.text_color = lv_obj_get_style_text_color(obj, part);
+        list->cache.text_opa = lv_obj_get_style_text_opa(obj, part);
+        list->cache.image_recolor = lv_obj_get_style_image_recolor(obj, part);
+        list->cache.image_recolor_opa = lv_obj_get_style_image_recolor_opa(obj, part);
+#endif
+
         list->ignore_cache = ignore_cache_ori;
     }
 
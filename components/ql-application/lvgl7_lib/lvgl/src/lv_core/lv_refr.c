@@ -54,6 +54,7 @@ static void lv_refr_vdb_flush(void);
  **********************/
 static uint32_t px_num;
 static lv_disp_t * disp_refr; /*Display being refreshed*/
+static lv_obj_t * inv_top[LV_INV_BUF_SIZE]; /*The top object of the invalid areas while joining them*/
 #if LV_USE_PERF_MONITOR
     static uint32_t fps_sum_cnt;
     static uint32_t fps_sum_all;
@@ -337,40 +338,71 @@ uint32_t lv_refr_get_fps_avg(void)
  **********************/
 
 /**
- * Join the areas which has got common parts
+ * Join the areas which has got common parts.
+ * Other areas are joined too if the joined area is larger by at most `LV_REFR_JOIN_OVERHEAD`
+ * pixels and it still has the same top object, so joining doesn't redraw more covered objects.
  */
 static void lv_refr_join_area(void)
 {
     uint32_t join_from;
     uint32_t join_in;
     lv_area_t joined_area;
-    for(join_in = 0; join_in < disp_refr->inv_p; join_in++) {
-        if(disp_refr->inv_area_joined[join_in] != 0) continue;
-
-        /*Check all areas to join them in 'join_in'*/
-        for(join_from = 0; join_from < disp_refr->inv_p; join_from++) {
-            /*Handle only unjoined areas and ignore itself*/
-            if(disp_refr->inv_area_joined[join_from] != 0 || join_in == join_from) {
-                continue;
-            }
+    lv_obj_t * scr = lv_disp_get_scr_act(disp_refr);
 
-            /*Check if the areas are on each other*/
-            if(_lv_area_is_on(&disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]) == false) {
-                continue;
-            }
+    /*While a screen is changed both screens are drawn, join only the common parts then*/
+    bool cost_join = disp_refr->prev_scr == NULL && scr != NULL;
+
+    if(cost_join) {
+        for(join_in = 0; join_in < disp_refr->inv_p; join_in++) {
+            inv_top[join_in] = lv_refr_get_top_obj(&disp_refr->inv_areas[join_in], scr);
+        }
+    }
+
+    /*A joined area can be joined again with the areas checked before it*/
+    bool joined;
+    do {
+        joined = false;
+        for(join_in = 0; join_in < disp_refr->inv_p; join_in++) {
+            if(disp_refr->inv_area_joined[join_in] != 0) continue;
+
+            /*Check all areas to join them in 'join_in'*/
+            for(join_from = 0; join_from < disp_refr->inv_p; join_from++) {
+                /*Handle only unjoined areas and ignore itself*/
+                if(disp_refr->inv_area_joined[join_from] != 0 || join_in == join_from) {
+                    continue;
+                }
 
-            _lv_area_join(&joined_area, &disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]);
+                _lv_area_join(&joined_area, &disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]);
+
+                uint32_t joined_size = lv_area_get_size(&joined_area);
+                uint32_t size_sum = lv_area_get_size(&disp_refr->inv_areas[join_in]) +
+                                    lv_area_get_size(&disp_refr->inv_areas[join_from]);
+                lv_obj_t * joined_top = NULL;
+
+                /*Join two area on each other only if the joined area size is smaller*/
+                if(_lv_area_is_on(&disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]) &&
+                   joined_size < size_sum) {
+                    if(cost_join) joined_top = lv_refr_get_top_obj(&joined_area, scr);
+                }
+                /*Join other areas if it's cheaper than refreshing them one by one*/
+                else if(cost_join && joined_size <= size_sum + LV_REFR_JOIN_OVERHEAD &&
+                        inv_top[join_in] == inv_top[join_from]) {
+                    joined_top = lv_refr_get_top_obj(&joined_area, scr);
+                    if(joined_top != inv_top[join_in]) continue;
+                }
+                else {
+                    continue;
+                }
 
-            /*Join two area only if the joined area size is smaller*/
-            if(lv_area_get_size(&joined_area) < (lv_area_get_size(&disp_refr->inv_areas[join_in]) +
-                                                 lv_area_get_size(&disp_refr->inv_areas[join_from]))) {
                 lv_area_copy(&disp_refr->inv_areas[join_in], &joined_area);
+                if(cost_join) inv_top[join_in] = joined_top;
 
                 /*Mark 'join_form' is joined into 'join_in'*/
                 disp_refr->inv_area_joined[join_from] = 1;
+                joined = true;
             }
         }
-    }
+    } while(joined);
 }
 
 /**
@@ -217,6 +217,23 @@ typedef struct {
 
 typedef int16_t lv_style_int_t;
 
+#if LV_STYLE_CACHE_VALUES
+/*Resolved values of the most used properties in the current state (with inheritance and transitions)*/
+typedef struct {
+    const void * text_font;
+    lv_color_t bg_color;
+    lv_color_t border_color;
+    lv_color_t text_color;
+    lv_color_t image_recolor;
+    lv_style_int_t radius;
+    lv_style_int_t border_width;
+    lv_opa_t bg_opa;
+    lv_opa_t border_opa;
+    lv_opa_t text_opa;
+    lv_opa_t image_recolor_opa;
+} lv_style_cache_t;
+#endif
+
 typedef struct {
     lv_style_t ** style_list;
 #if LV_USE_ASSERT_STYLE
@@ -253,6 +270,10 @@ typedef struct {
     uint32_t text_space_zero : 1;
     uint32_t text_decor_none : 1;
     uint32_t text_font_normal : 1;
+
+#if LV_STYLE_CACHE_VALUES
+    lv_style_cache_t cache;     /*Valid only with `valid_cache`*/
+#endif
 } lv_style_list_t;
 
 /**********************
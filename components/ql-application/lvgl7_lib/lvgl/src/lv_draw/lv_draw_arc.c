@@ -7,6 +7,7 @@
  *      INCLUDES
  *********************/
 #include "lv_draw_arc.h"
+#include "lv_draw_prof.h"
 #include "lv_draw_rect.h"
 #include "lv_draw_mask.h"
 #include "../lv_misc/lv_math.h"
@@ -37,6 +38,8 @@ typedef struct {
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void draw_arc(lv_coord_t center_x, lv_coord_t center_y, uint16_t radius,  uint16_t start_angle, uint16_t end_angle,
+                     const lv_area_t * clip_area, const lv_draw_line_dsc_t * dsc);
 static void draw_quarter_0(quarter_draw_dsc_t * q);
 static void draw_quarter_1(quarter_draw_dsc_t * q);
 static void draw_quarter_2(quarter_draw_dsc_t * q);
@@ -68,6 +71,15 @@ static void get_rounded_area(int16_t angle, lv_coord_t radius, uint8_t thickness
  */
 void lv_draw_arc(lv_coord_t center_x, lv_coord_t center_y, uint16_t radius,  uint16_t start_angle, uint16_t end_angle,
                  const lv_area_t * clip_area, const lv_draw_line_dsc_t * dsc)
+{
+    LV_DRAW_PROF_ENTER(LV_DRAW_PROF_ARC);
+    draw_arc(center_x, center_y, radius, start_angle, end_angle, clip_area, dsc);
+    LV_DRAW_PROF_EXIT(LV_DRAW_PROF_ARC);
+}
+
+/*Draw without profile, see `lv_draw_arc`*/
+static void draw_arc(lv_coord_t center_x, lv_coord_t center_y, uint16_t radius,  uint16_t start_angle, uint16_t end_angle,
+                     const lv_area_t * clip_area, const lv_draw_line_dsc_t * dsc)
 {
     if(dsc->opa <= LV_OPA_MIN) return;
     if(dsc->width == 0) return;
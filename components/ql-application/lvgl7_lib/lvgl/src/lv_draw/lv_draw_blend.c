@@ -12,12 +12,15 @@
 #include "../lv_hal/lv_hal_disp.h"
 #include "../lv_core/lv_refr.h"
 
+#include "lv_draw_blend_neon.h"
 #if LV_USE_GPU_NXP_PXP
     #include "../lv_gpu/lv_gpu_nxp_pxp.h"
 #elif LV_USE_GPU_NXP_VG_LITE
     #include "../lv_gpu/lv_gpu_nxp_vglite.h"
 #elif LV_USE_GPU_STM32_DMA2D
     #include "../lv_gpu/lv_gpu_stm32_dma2d.h"
+#elif LV_USE_GPU_8910_GOUDA
+    #include "../lv_gpu/lv_gpu_8910_gouda.h"
 #endif
 
 /*********************
@@ -348,11 +351,22 @@ LV_ATTRIBUTE_FAST_MEM static void fill_normal(const lv_area_t * disp_area, lv_co
                 lv_gpu_stm32_dma2d_fill(disp_buf_first, disp_w, color, draw_area_w, draw_area_h);
                 return;
             }
+#elif LV_USE_GPU_8910_GOUDA
+            if(lv_area_get_size(draw_area) >= LV_GPU_8910_GOUDA_SIZE_LIMIT) {
+                if(lv_gpu_8910_gouda_fill(disp_buf_first, disp_w, color, draw_area_w, draw_area_h) == LV_RES_OK) {
+                    return;
+                }
+                /* Fall down to SW render when GOUDA is busy */
+            }
 #elif LV_USE_GPU
             if(disp->driver.gpu_fill_cb && lv_area_get_size(draw_area) > GPU_SIZE_LIMIT) {
                 disp->driver.gpu_fill_cb(&disp->driver, disp_buf, disp_w, draw_area, color);
                 return;
             }
+#endif
+#if LV_USE_DRAW_NEON
+            _lv_blend_neon_fill(disp_buf_first, disp_w, draw_area_w, draw_area_h, color);
+            return;
 #endif
             /*Software rendering*/
             for(y = 0; y < draw_area_h; y++) {
@@ -404,6 +418,10 @@ LV_ATTRIBUTE_FAST_MEM static void fill_normal(const lv_area_t * disp_area, lv_co
 
                 return;
             }
+#endif
+#if LV_USE_DRAW_NEON
+            _lv_blend_neon_fill_opa(disp_buf_first, disp_w, draw_area_w, draw_area_h, color, opa);
+            return;
 #endif
             lv_color_t last_dest_color = LV_COLOR_BLACK;
             lv_color_t last_res_color = lv_color_mix(color, last_dest_color, opa);
@@ -443,6 +461,10 @@ LV_ATTRIBUTE_FAST_MEM static void fill_normal(const lv_area_t * disp_area, lv_co
             return;
         }
 #endif
+#if LV_USE_DRAW_NEON
+        _lv_blend_neon_fill_mask(disp_buf_first, disp_w, draw_area_w, draw_area_h, color, opa, mask);
+        return;
+#endif
 
         /*Buffer the result color to avoid recalculating the same color*/
         lv_color_t last_dest_color;
@@ -788,6 +810,14 @@ LV_ATTRIBUTE_FAST_MEM static void map_normal(const lv_area_t * disp_area, lv_col
                 lv_gpu_stm32_dma2d_copy(disp_buf_first, disp_w, map_buf_first, map_w, draw_area_w, draw_area_h);
                 return;
             }
+#elif LV_USE_GPU_8910_GOUDA
+            if(lv_area_get_size(draw_area) >= LV_GPU_8910_GOUDA_SIZE_LIMIT) {
+                if(lv_gpu_8910_gouda_copy(disp_buf_first, disp_w, map_buf_first, map_w, draw_area_w,
+                                          draw_area_h) == LV_RES_OK) {
+                    return;
+                }
+                /* Fall down to SW render when GOUDA is busy */
+            }
 #endif
 
             /*Software rendering*/
@@ -839,6 +869,10 @@ LV_ATTRIBUTE_FAST_MEM static void map_normal(const lv_area_t * disp_area, lv_col
                 return;
             }
 #endif
+#if LV_USE_DRAW_NEON
+            _lv_blend_neon_map_opa(disp_buf_first, disp_w, map_buf_first, map_w, draw_area_w, draw_area_h, opa);
+            return;
+#endif
 
             /*Software rendering*/
 
@@ -862,6 +896,10 @@ LV_ATTRIBUTE_FAST_MEM static void map_normal(const lv_area_t * disp_area, lv_col
     }
     /*Masked*/
     else {
+#if LV_USE_DRAW_NEON
+        _lv_blend_neon_map_mask(disp_buf_first, disp_w, map_buf_first, map_w, draw_area_w, draw_area_h, opa, mask);
+        return;
+#endif
         /*Only the mask matters*/
         if(opa > LV_OPA_MAX) {
             /*Go to the first pixel of the row */
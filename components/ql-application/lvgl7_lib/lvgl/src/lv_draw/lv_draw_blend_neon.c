@@ -0,0 +1,296 @@
+/**
+ * @file lv_draw_blend_neon.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_draw_blend_neon.h"
+
+#if LV_USE_DRAW_NEON
+
+#include <arm_neon.h>
+#include "../lv_misc/lv_log.h"
+#include "../lv_misc/lv_debug.h"
+#include "../lv_misc/lv_mem.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#if LV_COLOR_DEPTH != 16 || LV_COLOR_16_SWAP || LV_COLOR_SCREEN_TRANSP
+    /*The kernels work on RGB565 in the native byte order without alpha*/
+    #error "Can't use NEON blending with other than LV_COLOR_DEPTH 16, LV_COLOR_16_SWAP 0 and LV_COLOR_SCREEN_TRANSP 0"
+#endif
+
+/*Pixels in a NEON register*/
+#define NEON_PX_CNT     8
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/*A line to blend, a color or an image mixed over the buffer by opacity and mask*/
+typedef struct {
+    const lv_color_t * map;     /*Pixels to mix, NULL to mix `color`*/
+    lv_color_t color;
+    lv_opa_t opa;
+    const lv_opa_t * mask;      /*Opacity of each pixel, NULL for `opa` only*/
+    lv_opa_t mask_max;          /*Mask values from this use `opa` as it is, when `opa` doesn't cover*/
+} blend_line_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void blend_line(lv_color_t * buf, int32_t w, const blend_line_t * line);
+static void blend_line_sw(lv_color_t * buf, int32_t w, const blend_line_t * line);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+#if LV_DRAW_NEON_CHECK
+static lv_color_t check_buf[LV_HOR_RES_MAX];
+#endif
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Fill an area with a color
+ */
+void _lv_blend_neon_fill(lv_color_t * buf, int32_t buf_w, int32_t fill_w, int32_t fill_h, lv_color_t color)
+{
+    uint16x8_t c = vdupq_n_u16(color.full);
+    int32_t y;
+
+    for(y = 0; y < fill_h; y++) {
+        uint16_t * p = (uint16_t *)buf;
+        int32_t x = 0;
+        for(; x <= fill_w - NEON_PX_CNT * 2; x += NEON_PX_CNT * 2) {
+            vst1q_u16(p + x, c);
+            vst1q_u16(p + x + NEON_PX_CNT, c);
+        }
+        for(; x <= fill_w - NEON_PX_CNT; x += NEON_PX_CNT) {
+            vst1q_u16(p + x, c);
+        }
+        for(; x < fill_w; x++) {
+            buf[x] = color;
+        }
+        buf += buf_w;
+    }
+}
+
+/**
+ * Mix a color over an area with an opacity
+ */
+void _lv_blend_neon_fill_opa(lv_color_t * buf, int32_t buf_w, int32_t fill_w, int32_t fill_h, lv_color_t color,
+                             lv_opa_t opa)
+{
+    blend_line_t line = {.map = NULL, .color = color, .opa = opa, .mask = NULL};
+    int32_t y;
+
+    for(y = 0; y < fill_h; y++) {
+        blend_line(buf, fill_w, &line);
+        buf += buf_w;
+    }
+}
+
+/**
+ * Mix a color over an area through a mask
+ */
+void _lv_blend_neon_fill_mask(lv_color_t * buf, int32_t buf_w, int32_t fill_w, int32_t fill_h, lv_color_t color,
+                              lv_opa_t opa, const lv_opa_t * mask)
+{
+    /*The same as `fill_normal`: only a fully covering mask value uses `opa` as it is*/
+    blend_line_t line = {.map = NULL, .color = color, .opa = opa, .mask = mask, .mask_max = LV_OPA_COVER};
+    int32_t y;
+
+    for(y = 0; y < fill_h; y++) {
+        blend_line(buf, fill_w, &line);
+        buf += buf_w;
+        line.mask += fill_w;
+    }
+}
+
+/**
+ * Mix an image over an area with an opacity
+ */
+void _lv_blend_neon_map_opa(lv_color_t * buf, int32_t buf_w, const lv_color_t * map, int32_t map_w,
+                            int32_t copy_w, int32_t copy_h, lv_opa_t opa)
+{
+    blend_line_t line = {.map = map, .opa = opa, .mask = NULL};
+    int32_t y;
+
+    for(y = 0; y < copy_h; y++) {
+        blend_line(buf, copy_w, &line);
+        buf += buf_w;
+        line.map += map_w;
+    }
+}
+
+/**
+ * Mix an image over an area through a mask
+ */
+void _lv_blend_neon_map_mask(lv_color_t * buf, int32_t buf_w, const lv_color_t * map, int32_t map_w,
+                             int32_t copy_w, int32_t copy_h, lv_opa_t opa, const lv_opa_t * mask)
+{
+    /*The same as `map_normal`: mask values from LV_OPA_MAX use `opa` as it is*/
+    blend_line_t line = {.map = map, .opa = opa, .mask = mask, .mask_max = LV_OPA_MAX};
+    int32_t y;
+
+    for(y = 0; y < copy_h; y++) {
+        blend_line(buf, copy_w, &line);
+        buf += buf_w;
+        line.map += map_w;
+        line.mask += copy_w;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Get the opacity of a pixel, the same as the software rendering.
+ * Mixing by 0 or 255 keeps the buffer or gives the color exactly, so every pixel can be mixed.
+ */
+static inline lv_opa_t line_px_opa(const blend_line_t * line, int32_t x)
+{
+    if(line->mask == NULL) return line->opa;
+
+    lv_opa_t m = line->mask[x];
+    if(line->opa > LV_OPA_MAX) return m;
+    return m >= line->mask_max ? line->opa : (lv_opa_t)(((uint32_t)m * line->opa) >> 8);
+}
+
+/**
+ * Blend a line by software, for the pixels after the last complete register
+ */
+static void blend_line_sw(lv_color_t * buf, int32_t w, const blend_line_t * line)
+{
+    int32_t x;
+    for(x = 0; x < w; x++) {
+        lv_color_t c = line->map ? line->map[x] : line->color;
+        buf[x] = lv_color_mix(c, buf[x], line_px_opa(line, x));
+    }
+}
+
+/**
+ * Divide by 255 with rounding, the same as `LV_MATH_UDIV255(x + LV_COLOR_MIX_ROUND_OFS)`.
+ * (t + (t >> 8) + 1) >> 8 is exact for t < 65535.
+ */
+static inline uint16x8_t neon_div255(uint16x8_t x)
+{
+    uint16x8_t t = vaddq_u16(x, vdupq_n_u16(LV_COLOR_MIX_ROUND_OFS));
+    t = vsraq_n_u16(t, t, 8);
+    return vshrq_n_u16(vaddq_u16(t, vdupq_n_u16(1)), 8);
+}
+
+/**
+ * Mix 8 RGB565 pixels, the same as `lv_color_mix(c, bg, opa)`
+ */
+static inline uint16x8_t neon_mix(uint16x8_t c, uint16x8_t bg, uint8x8_t opa)
+{
+    uint16x8_t a = vmovl_u8(opa);
+    uint16x8_t a_inv = vsubq_u16(vdupq_n_u16(255), a);
+    uint16x8_t g_mask = vdupq_n_u16(0x3F);
+    uint16x8_t b_mask = vdupq_n_u16(0x1F);
+
+    uint16x8_t r = vmulq_u16(vshrq_n_u16(c, 11), a);
+    uint16x8_t g = vmulq_u16(vandq_u16(vshrq_n_u16(c, 5), g_mask), a);
+    uint16x8_t b = vmulq_u16(vandq_u16(c, b_mask), a);
+
+    r = vmlaq_u16(r, vshrq_n_u16(bg, 11), a_inv);
+    g = vmlaq_u16(g, vandq_u16(vshrq_n_u16(bg, 5), g_mask), a_inv);
+    b = vmlaq_u16(b, vandq_u16(bg, b_mask), a_inv);
+
+    r = neon_div255(r);
+    g = neon_div255(g);
+    b = neon_div255(b);
+
+    return vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b);
+}
+
+/**
+ * Blend a line by NEON, 8 pixels at once. Pixels with transparent or
+ * covering mask are skipped or copied by 8, as anti-aliased edges are
+ * mostly such.
+ */
+static void blend_line_neon(lv_color_t * buf, int32_t w, const blend_line_t * line)
+{
+    uint16_t * p = (uint16_t *)buf;
+    const uint16_t * map = (const uint16_t *)line->map;
+    uint16x8_t color = vdupq_n_u16(line->color.full);
+    uint8x8_t opa = vdup_n_u8(line->opa);
+    uint8x8_t mask_max = vdup_n_u8(line->mask_max);
+    bool mask_only = line->opa > LV_OPA_MAX;
+    int32_t x;
+
+    for(x = 0; x <= w - NEON_PX_CNT; x += NEON_PX_CNT) {
+        uint8x8_t a = opa;
+
+        if(line->mask) {
+            uint8x8_t m = vld1_u8(line->mask + x);
+            uint64_t m64 = vget_lane_u64(vreinterpret_u64_u8(m), 0);
+
+            if(m64 == 0) continue;
+            if(m64 == UINT64_MAX && mask_only) {
+                vst1q_u16(p + x, map ? vld1q_u16(map + x) : color);
+                continue;
+            }
+
+            if(mask_only) {
+                a = m;
+            }
+            else {
+                uint8x8_t m_opa = vshrn_n_u16(vmull_u8(m, opa), 8);
+                a = vbsl_u8(vcge_u8(m, mask_max), opa, m_opa);
+            }
+        }
+
+        uint16x8_t c = map ? vld1q_u16(map + x) : color;
+        vst1q_u16(p + x, neon_mix(c, vld1q_u16(p + x), a));
+    }
+
+    if(x < w) {
+        blend_line_t tail = *line;
+        if(tail.map) tail.map += x;
+        if(tail.mask) tail.mask += x;
+        blend_line_sw(buf + x, w - x, &tail);
+    }
+}
+
+/**
+ * Blend a line. With `LV_DRAW_NEON_CHECK` the line is blended by software
+ * too, and the results are compared.
+ */
+static void blend_line(lv_color_t * buf, int32_t w, const blend_line_t * line)
+{
+#if LV_DRAW_NEON_CHECK
+    if(w <= LV_HOR_RES_MAX) {
+        _lv_memcpy(check_buf, buf, w * sizeof(lv_color_t));
+        blend_line_sw(check_buf, w, line);
+        blend_line_neon(buf, w, line);
+
+        int32_t x;
+        for(x = 0; x < w; x++) {
+            if(check_buf[x].full != buf[x].full) {
+                LV_LOG_ERROR("NEON blend differs from software");
+                LV_DEBUG_ASSERT(false, "NEON blend differs from software at x", x);
+                break;
+            }
+        }
+        return;
+    }
+#endif
+
+    blend_line_neon(buf, w, line);
+}
+
+#endif /*LV_USE_DRAW_NEON*/
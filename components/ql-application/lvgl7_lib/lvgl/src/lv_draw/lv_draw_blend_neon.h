@@ -0,0 +1,106 @@
+/**
+ * @file lv_draw_blend_neon.h
+ *
+ */
+
+#ifndef LV_DRAW_BLEND_NEON_H
+#define LV_DRAW_BLEND_NEON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lv_misc/lv_color.h"
+#include "../lv_misc/lv_types.h"
+
+#if LV_USE_DRAW_NEON
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Fill an area with a color
+ * @param buf first pixel to fill
+ * @param buf_w width of the buffer in pixels, it is the offset to the next line
+ * @param fill_w width to fill in pixels (<= buf_w)
+ * @param fill_h height to fill in pixels
+ * @param color fill color
+ */
+void _lv_blend_neon_fill(lv_color_t * buf, int32_t buf_w, int32_t fill_w, int32_t fill_h, lv_color_t color);
+
+/**
+ * Mix a color over an area with an opacity, the same as `lv_color_mix` on every pixel
+ * @param buf first pixel to fill
+ * @param buf_w width of the buffer in pixels, it is the offset to the next line
+ * @param fill_w width to fill in pixels (<= buf_w)
+ * @param fill_h height to fill in pixels
+ * @param color fill color
+ * @param opa opacity of the color
+ */
+void _lv_blend_neon_fill_opa(lv_color_t * buf, int32_t buf_w, int32_t fill_w, int32_t fill_h, lv_color_t color,
+                             lv_opa_t opa);
+
+/**
+ * Mix a color over an area through a mask, the same as the software masked fill
+ * @param buf first pixel to fill
+ * @param buf_w width of the buffer in pixels, it is the offset to the next line
+ * @param fill_w width to fill in pixels (<= buf_w)
+ * @param fill_h height to fill in pixels
+ * @param color fill color
+ * @param opa opacity of the color, above `LV_OPA_MAX` only the mask matters
+ * @param mask opacity of each pixel, `fill_w` values per line
+ */
+void _lv_blend_neon_fill_mask(lv_color_t * buf, int32_t buf_w, int32_t fill_w, int32_t fill_h, lv_color_t color,
+                              lv_opa_t opa, const lv_opa_t * mask);
+
+/**
+ * Mix an image over an area with an opacity, the same as `lv_color_mix` on every pixel
+ * @param buf first pixel to draw
+ * @param buf_w width of the buffer in pixels, it is the offset to the next line
+ * @param map first pixel of the image to draw
+ * @param map_w width of the image in pixels, it is the offset to the next line
+ * @param copy_w width to draw in pixels (<= buf_w, map_w)
+ * @param copy_h height to draw in pixels
+ * @param opa opacity of the image
+ */
+void _lv_blend_neon_map_opa(lv_color_t * buf, int32_t buf_w, const lv_color_t * map, int32_t map_w,
+                            int32_t copy_w, int32_t copy_h, lv_opa_t opa);
+
+/**
+ * Mix an image over an area through a mask, the same as the software masked copy.
+ * Alpha and chroma keyed images are drawn this way, with the mask built from the image.
+ * @param buf first pixel to draw
+ * @param buf_w width of the buffer in pixels, it is the offset to the next line
+ * @param map first pixel of the image to draw
+ * @param map_w width of the image in pixels, it is the offset to the next line
+ * @param copy_w width to draw in pixels (<= buf_w, map_w)
+ * @param copy_h height to draw in pixels
+ * @param opa opacity of the image, above `LV_OPA_MAX` only the mask matters
+ * @param mask opacity of each pixel, `copy_w` values per line
+ */
+void _lv_blend_neon_map_mask(lv_color_t * buf, int32_t buf_w, const lv_color_t * map, int32_t map_w,
+                             int32_t copy_w, int32_t copy_h, lv_opa_t opa, const lv_opa_t * mask);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif  /*LV_USE_DRAW_NEON*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LV_DRAW_BLEND_NEON_H*/
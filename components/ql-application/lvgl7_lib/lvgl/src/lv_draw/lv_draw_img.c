@@ -7,6 +7,7 @@
  *      INCLUDES
  *********************/
 #include "lv_draw_img.h"
+#include "lv_draw_prof.h"
 #include "lv_img_cache.h"
 #include "../lv_hal/lv_hal_disp.h"
 #include "../lv_misc/lv_log.h"
@@ -30,6 +31,7 @@
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void draw_img(const lv_area_t * coords, const lv_area_t * mask, const void * src, const lv_draw_img_dsc_t * dsc);
 LV_ATTRIBUTE_FAST_MEM static lv_res_t lv_img_draw_core(const lv_area_t * coords, const lv_area_t * clip_area,
                                                        const void * src,
                                                        const lv_draw_img_dsc_t * draw_dsc);
@@ -72,6 +74,14 @@ void lv_draw_img_dsc_init(lv_draw_img_dsc_t * dsc)
  * @param dsc pointer to an initialized `lv_draw_img_dsc_t` variable
  */
 void lv_draw_img(const lv_area_t * coords, const lv_area_t * mask, const void * src, const lv_draw_img_dsc_t * dsc)
+{
+    LV_DRAW_PROF_ENTER(LV_DRAW_PROF_IMG);
+    draw_img(coords, mask, src, dsc);
+    LV_DRAW_PROF_EXIT(LV_DRAW_PROF_IMG);
+}
+
+/*Draw without profile, see `lv_draw_img`*/
+static void draw_img(const lv_area_t * coords, const lv_area_t * mask, const void * src, const lv_draw_img_dsc_t * dsc)
 {
     if(src == NULL) {
         LV_LOG_WARN("Image draw: src is NULL");
@@ -7,6 +7,7 @@
  *      INCLUDES
  *********************/
 #include "lv_draw_label.h"
+#include "lv_draw_prof.h"
 #include "../lv_misc/lv_math.h"
 #include "../lv_hal/lv_hal_disp.h"
 #include "../lv_core/lv_refr.h"
@@ -32,6 +33,10 @@ typedef uint8_t cmd_state_t;
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+LV_ATTRIBUTE_FAST_MEM static void draw_label(const lv_area_t * coords, const lv_area_t * mask,
+                                             const lv_draw_label_dsc_t * dsc,
+                                             const char * txt,
+                                             lv_draw_label_hint_t * hint);
 LV_ATTRIBUTE_FAST_MEM static void lv_draw_letter(const lv_point_t * pos_p, const lv_area_t * clip_area,
                                                  const lv_font_t * font_p,
                                                  uint32_t letter, lv_color_t color, lv_opa_t opa, lv_blend_mode_t blend_mode);
@@ -116,6 +121,17 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_label(const lv_area_t * coords, const lv_area
                                          const char * txt,
                                          lv_draw_label_hint_t * hint)
 {
+    LV_DRAW_PROF_ENTER(LV_DRAW_PROF_LABEL);
+    draw_label(coords, mask, dsc, txt, hint);
+    LV_DRAW_PROF_EXIT(LV_DRAW_PROF_LABEL);
+}
+
+/*Draw without profile, see `lv_draw_label`*/
+LV_ATTRIBUTE_FAST_MEM static void draw_label(const lv_area_t * coords, const lv_area_t * mask,
+                                             const lv_draw_label_dsc_t * dsc,
+                                             const char * txt,
+                                             lv_draw_label_hint_t * hint)
+{
 
     if(dsc->opa <= LV_OPA_MIN) return;
     const lv_font_t * font = dsc->font;
@@ -0,0 +1,61 @@
+/**
+ * @file lv_draw_prof.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_draw_prof.h"
+
+#if LV_USE_DRAW_PROF
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_draw_prof_cb_t prof_cb;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Set the callback to profile draw functions
+ * @param cb the callback, NULL to disable the profiling
+ */
+void lv_draw_prof_set_cb(lv_draw_prof_cb_t cb)
+{
+    prof_cb = cb;
+}
+
+/**
+ * Notify the profile callback. Used by the draw functions.
+ * @param type draw type
+ * @param enter true at entry, false at exit
+ */
+void _lv_draw_prof(lv_draw_prof_type_t type, bool enter)
+{
+    if(prof_cb) prof_cb(type, enter);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#endif /*LV_USE_DRAW_PROF*/
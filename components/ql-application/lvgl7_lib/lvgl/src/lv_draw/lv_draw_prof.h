@@ -0,0 +1,77 @@
+/**
+ * @file lv_draw_prof.h
+ *
+ */
+
+#ifndef LV_DRAW_PROF_H
+#define LV_DRAW_PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lv_conf_internal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+enum {
+    LV_DRAW_PROF_RECT,
+    LV_DRAW_PROF_IMG,
+    LV_DRAW_PROF_LABEL,
+    LV_DRAW_PROF_ARC,
+    _LV_DRAW_PROF_NUM,
+};
+typedef uint8_t lv_draw_prof_type_t;
+
+/**
+ * Called at entry (`enter == true`) and exit of a draw function.
+ * Draw functions can be nested, e.g. an arc is drawn with rectangles.
+ */
+typedef void (*lv_draw_prof_cb_t)(lv_draw_prof_type_t type, bool enter);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Set the callback to profile draw functions
+ * @param cb the callback, NULL to disable the profiling
+ */
+void lv_draw_prof_set_cb(lv_draw_prof_cb_t cb);
+
+/**
+ * Notify the profile callback. Used by the draw functions.
+ * @param type draw type
+ * @param enter true at entry, false at exit
+ */
+void _lv_draw_prof(lv_draw_prof_type_t type, bool enter);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#if LV_USE_DRAW_PROF
+#define LV_DRAW_PROF_ENTER(type) _lv_draw_prof(type, true)
+#define LV_DRAW_PROF_EXIT(type) _lv_draw_prof(type, false)
+#else
+#define LV_DRAW_PROF_ENTER(type)
+#define LV_DRAW_PROF_EXIT(type)
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LV_DRAW_PROF_H*/
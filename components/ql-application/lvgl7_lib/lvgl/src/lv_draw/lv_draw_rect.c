@@ -7,12 +7,14 @@
  *      INCLUDES
  *********************/
 #include "lv_draw_rect.h"
+#include "lv_draw_prof.h"
 #include "lv_draw_blend.h"
 #include "lv_draw_mask.h"
 #include "../lv_misc/lv_math.h"
 #include "../lv_misc/lv_txt_ap.h"
 #include "../lv_core/lv_refr.h"
 #include "../lv_misc/lv_debug.h"
+#include "../lv_misc/lv_mem.h"
 
 /*********************
  *      DEFINES
@@ -24,14 +26,42 @@
 /**********************
  *      TYPEDEFS
  **********************/
+#if LV_RECT_CORNER_CACHE_SIZE
+/*Anti-aliased coverage of a rounded corner. It depends only on the radius*/
+typedef struct {
+    lv_opa_t * buf;     /*`r^2` opacity values of the top left corner, NULL: the entry is empty*/
+    uint32_t last_use;
+    lv_coord_t r;
+} corner_cache_entry_t;
+#endif
+
+#if LV_USE_SHADOW && LV_SHADOW_CACHE_SIZE
+/*A blurred shadow corner. It depends only on the shadow width, the radius and
+ *the size of the shadow rectangle, and the size only up to `2 * (sw + r)`*/
+typedef struct {
+    lv_opa_t * buf;     /*`(sw + r)^2` opacity values, NULL: the entry is empty*/
+    uint32_t last_use;
+    lv_coord_t sw;
+    lv_coord_t r;
+    lv_coord_t w;
+    lv_coord_t h;
+} sh_cache_entry_t;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void draw_rect(const lv_area_t * coords, const lv_area_t * clip, const lv_draw_rect_dsc_t * dsc);
 LV_ATTRIBUTE_FAST_MEM static void draw_bg(const lv_area_t * coords, const lv_area_t * clip,
                                           const lv_draw_rect_dsc_t * dsc);
 LV_ATTRIBUTE_FAST_MEM static void draw_border(const lv_area_t * coords, const lv_area_t * clip,
                                               const lv_draw_rect_dsc_t * dsc);
+#if LV_RECT_CORNER_CACHE_SIZE
+LV_ATTRIBUTE_FAST_MEM static bool draw_bg_corner_cached(const lv_area_t * coords_bg, const lv_area_t * clip,
+                                                        const lv_draw_rect_dsc_t * dsc, lv_grad_dir_t grad_dir,
+                                                        lv_coord_t r, lv_opa_t opa);
+static const lv_opa_t * corner_cache_get(lv_coord_t r);
+#endif
 
 #if LV_USE_OUTLINE
     static void draw_outline(const lv_area_t * coords, const lv_area_t * clip, const lv_draw_rect_dsc_t * dsc);
@@ -42,6 +72,10 @@ LV_ATTRIBUTE_FAST_MEM static void draw_shadow(const lv_area_t * coords, const lv
 LV_ATTRIBUTE_FAST_MEM static void shadow_draw_corner_buf(const lv_area_t * coords,  uint16_t * sh_buf, lv_coord_t s,
                                                          lv_coord_t r);
 LV_ATTRIBUTE_FAST_MEM static void shadow_blur_corner(lv_coord_t size, lv_coord_t sw, uint16_t * sh_ups_buf);
+#if LV_SHADOW_CACHE_SIZE
+    static const lv_opa_t * shadow_cache_get(lv_coord_t sw, lv_coord_t r, lv_coord_t w, lv_coord_t h);
+    static void shadow_cache_add(lv_coord_t sw, lv_coord_t r, lv_coord_t w, lv_coord_t h, const lv_opa_t * sh_buf);
+#endif
 #endif
 
 #if LV_USE_PATTERN
@@ -58,10 +92,14 @@ LV_ATTRIBUTE_FAST_MEM static inline lv_color_t grad_get(const lv_draw_rect_dsc_t
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if LV_RECT_CORNER_CACHE_SIZE
+    static corner_cache_entry_t corner_cache[LV_RECT_CORNER_CACHE_NUM];
+    static uint32_t corner_cache_use_cnt;
+#endif
 #if LV_USE_SHADOW && LV_SHADOW_CACHE_SIZE
-    static uint8_t sh_cache[LV_SHADOW_CACHE_SIZE * LV_SHADOW_CACHE_SIZE];
-    static int32_t sh_cache_size = -1;
-    static int32_t sh_cache_r = -1;
+    static sh_cache_entry_t sh_cache[LV_SHADOW_CACHE_NUM];
+    static uint32_t sh_cache_mem;
+    static uint32_t sh_cache_use_cnt;
 #endif
 
 /**********************
@@ -101,6 +139,14 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_rect_dsc_init(lv_draw_rect_dsc_t * dsc)
  * @param dsc pointer to an initialized `lv_draw_rect_dsc_t` variable
  */
 void lv_draw_rect(const lv_area_t * coords, const lv_area_t * clip, const lv_draw_rect_dsc_t * dsc)
+{
+    LV_DRAW_PROF_ENTER(LV_DRAW_PROF_RECT);
+    draw_rect(coords, clip, dsc);
+    LV_DRAW_PROF_EXIT(LV_DRAW_PROF_RECT);
+}
+
+/*Draw without profile, see `lv_draw_rect`*/
+static void draw_rect(const lv_area_t * coords, const lv_area_t * clip, const lv_draw_rect_dsc_t * dsc)
 {
     if(lv_area_get_height(coords) < 1 || lv_area_get_width(coords) < 1) return;
 #if LV_USE_SHADOW
@@ -232,6 +278,12 @@ LV_ATTRIBUTE_FAST_MEM static void draw_bg(const lv_area_t * coords, const lv_are
                        dsc->bg_color, NULL, LV_DRAW_MASK_RES_FULL_COVER, opa,
                        dsc->bg_blend_mode);
     }
+#if LV_RECT_CORNER_CACHE_SIZE
+    /*Rounded rectangle without other masks: draw the corners from the buffered coverage*/
+    else if(simple_mode && rout > 0 && rout <= LV_RECT_CORNER_CACHE_SIZE &&
+            draw_bg_corner_cached(&coords_bg, clip, dsc, grad_dir, rout, opa)) {
+    }
+#endif
     /*More complex case: there is a radius, gradient or other mask.*/
     else {
         lv_draw_mask_radius_param_t mask_rout_param;
@@ -383,6 +435,116 @@ LV_ATTRIBUTE_FAST_MEM static void draw_bg(const lv_area_t * coords, const lv_are
 
 }
 
+#if LV_RECT_CORNER_CACHE_SIZE
+/**
+ * Draw the background of a rounded rectangle if there are no other masks.
+ * The straight parts are filled, and only the corners are blended with the coverage of the corner.
+ * The result is the same as drawing with a radius mask.
+ * @param coords_bg the background area
+ * @param clip the clip area
+ * @param dsc the descriptor of the rectangle
+ * @param grad_dir `LV_GRAD_DIR_NONE` or `LV_GRAD_DIR_VER`
+ * @param r radius, at most the half of the shorter side
+ * @param opa opacity of the background
+ * @return false: the corner couldn't be buffered, nothing was drawn
+ */
+LV_ATTRIBUTE_FAST_MEM static bool draw_bg_corner_cached(const lv_area_t * coords_bg, const lv_area_t * clip,
+                                                        const lv_draw_rect_dsc_t * dsc, lv_grad_dir_t grad_dir,
+                                                        lv_coord_t r, lv_opa_t opa)
+{
+    lv_area_t draw_area;
+    if(_lv_area_intersect(&draw_area, coords_bg, clip) == false) return true;
+
+    const lv_opa_t * corner = corner_cache_get(r);
+    if(corner == NULL) return false;
+
+    lv_opa_t * mask_buf = _lv_mem_buf_get(r);
+    lv_area_t fill_area;
+
+    /*Without gradient fill the straight parts at once*/
+    if(grad_dir == LV_GRAD_DIR_NONE) {
+        fill_area.x1 = coords_bg->x1;
+        fill_area.x2 = coords_bg->x2;
+        fill_area.y1 = coords_bg->y1 + r;
+        fill_area.y2 = coords_bg->y2 - r;
+        _lv_blend_fill(clip, &fill_area, dsc->bg_color, NULL, LV_DRAW_MASK_RES_FULL_COVER, opa, dsc->bg_blend_mode);
+
+        fill_area.x1 = coords_bg->x1 + r;
+        fill_area.x2 = coords_bg->x2 - r;
+        fill_area.y1 = coords_bg->y1;
+        fill_area.y2 = coords_bg->y1 + r - 1;
+        _lv_blend_fill(clip, &fill_area, dsc->bg_color, NULL, LV_DRAW_MASK_RES_FULL_COVER, opa, dsc->bg_blend_mode);
+
+        fill_area.y1 = coords_bg->y2 - r + 1;
+        fill_area.y2 = coords_bg->y2;
+        _lv_blend_fill(clip, &fill_area, dsc->bg_color, NULL, LV_DRAW_MASK_RES_FULL_COVER, opa, dsc->bg_blend_mode);
+    }
+
+    lv_color_t color = dsc->bg_color;
+    lv_coord_t y;
+    for(y = draw_area.y1; y <= draw_area.y2; y++) {
+        /*Row of the corner, the bottom corners are the mirror of the top ones*/
+        int32_t row;
+        if(y < coords_bg->y1 + r) row = y - coords_bg->y1;
+        else if(y > coords_bg->y2 - r) row = coords_bg->y2 - y;
+        else row = -1;
+
+        if(row < 0 && grad_dir == LV_GRAD_DIR_NONE) {
+            /*Skip the already filled middle rows*/
+            y = coords_bg->y2 - r;
+            continue;
+        }
+
+        fill_area.y1 = y;
+        fill_area.y2 = y;
+
+        if(grad_dir == LV_GRAD_DIR_VER) {
+            color = grad_get(dsc, lv_area_get_height(coords_bg), y - coords_bg->y1);
+
+            fill_area.x1 = row < 0 ? coords_bg->x1 : coords_bg->x1 + r;
+            fill_area.x2 = row < 0 ? coords_bg->x2 : coords_bg->x2 - r;
+            _lv_blend_fill(clip, &fill_area, color, NULL, LV_DRAW_MASK_RES_FULL_COVER, opa, dsc->bg_blend_mode);
+            if(row < 0) continue;
+        }
+
+        const lv_opa_t * cov = &corner[row * r];
+        lv_coord_t i;
+
+        /*Left corner. The mask is mixed with the opacity the same way as by `lv_draw_mask_apply`*/
+        fill_area.x1 = coords_bg->x1;
+        fill_area.x2 = coords_bg->x1 + r - 1;
+        if(fill_area.x2 >= clip->x1) {
+            for(i = 0; i < r; i++) {
+                lv_opa_t m = cov[i];
+                mask_buf[i] = m >= LV_OPA_MAX ? opa : m <= LV_OPA_MIN ? 0 : LV_MATH_UDIV255(opa * m);
+            }
+            int32_t mask_ofs = clip->x1 - fill_area.x1;
+            if(mask_ofs < 0) mask_ofs = 0;
+            _lv_blend_fill(clip, &fill_area, color, mask_buf + mask_ofs, LV_DRAW_MASK_RES_CHANGED, LV_OPA_COVER,
+                           dsc->bg_blend_mode);
+        }
+
+        /*Right corner, mirrored*/
+        fill_area.x1 = coords_bg->x2 - r + 1;
+        fill_area.x2 = coords_bg->x2;
+        if(fill_area.x1 <= clip->x2) {
+            for(i = 0; i < r; i++) {
+                lv_opa_t m = cov[r - 1 - i];
+                mask_buf[i] = m >= LV_OPA_MAX ? opa : m <= LV_OPA_MIN ? 0 : LV_MATH_UDIV255(opa * m);
+            }
+            int32_t mask_ofs = clip->x1 - fill_area.x1;
+            if(mask_ofs < 0) mask_ofs = 0;
+            _lv_blend_fill(clip, &fill_area, color, mask_buf + mask_ofs, LV_DRAW_MASK_RES_CHANGED, LV_OPA_COVER,
+                           dsc->bg_blend_mode);
+        }
+    }
+
+    _lv_mem_buf_release(mask_buf);
+
+    return true;
+}
+#endif
+
 LV_ATTRIBUTE_FAST_MEM static void draw_border(const lv_area_t * coords, const lv_area_t * clip,
                                               const lv_draw_rect_dsc_t * dsc)
 {
@@ -591,22 +753,22 @@ LV_ATTRIBUTE_FAST_MEM static void draw_shadow(const lv_area_t * coords, const lv
     lv_opa_t * sh_buf;
 
 #if LV_SHADOW_CACHE_SIZE
-    if(sh_cache_size == corner_size && sh_cache_r == r_sh) {
+    /*Larger rectangles have the same corner*/
+    lv_coord_t sh_w = LV_MATH_MIN(lv_area_get_width(&sh_rect_area), 2 * corner_size);
+    lv_coord_t sh_h = LV_MATH_MIN(lv_area_get_height(&sh_rect_area), 2 * corner_size);
+    const lv_opa_t * sh_cached = shadow_cache_get(sw, r_sh, sh_w, sh_h);
+    if(sh_cached) {
         /*Use the cache if available*/
         sh_buf = _lv_mem_buf_get(corner_size * corner_size);
-        _lv_memcpy(sh_buf, sh_cache, corner_size * corner_size);
+        _lv_memcpy(sh_buf, sh_cached, corner_size * corner_size);
     }
     else {
         /*A larger buffer is required for calculation */
         sh_buf = _lv_mem_buf_get(corner_size * corner_size * sizeof(uint16_t));
         shadow_draw_corner_buf(&sh_rect_area, (uint16_t *)sh_buf, dsc->shadow_width, r_sh);
 
-        /*Cache the corner if it fits into the cache size*/
-        if(corner_size * corner_size < sizeof(sh_cache)) {
-            _lv_memcpy(sh_cache, sh_buf, corner_size * corner_size);
-            sh_cache_size = corner_size;
-            sh_cache_r = r_sh;
-        }
+        /*Cache the corner if it's not too large*/
+        if(corner_size <= LV_SHADOW_CACHE_SIZE) shadow_cache_add(sw, r_sh, sh_w, sh_h, sh_buf);
     }
 #else
     sh_buf = _lv_mem_buf_get(corner_size * corner_size * sizeof(uint16_t));
@@ -1145,6 +1307,138 @@ LV_ATTRIBUTE_FAST_MEM static void shadow_blur_corner(lv_coord_t size, lv_coord_t
     _lv_mem_buf_release(sh_ups_blur_buf);
 }
 
+#if LV_SHADOW_CACHE_SIZE
+
+/**
+ * Get a shadow corner from the cache
+ * @param sw shadow width
+ * @param r radius
+ * @param w width of the shadow rectangle, up to `2 * (sw + r)`
+ * @param h height of the shadow rectangle, up to `2 * (sw + r)`
+ * @return the cached corner or NULL if not cached
+ */
+static const lv_opa_t * shadow_cache_get(lv_coord_t sw, lv_coord_t r, lv_coord_t w, lv_coord_t h)
+{
+    uint32_t i;
+    for(i = 0; i < LV_SHADOW_CACHE_NUM; i++) {
+        sh_cache_entry_t * e = &sh_cache[i];
+        if(e->buf && e->sw == sw && e->r == r && e->w == w && e->h == h) {
+            sh_cache_use_cnt++;
+            e->last_use = sh_cache_use_cnt;
+            return e->buf;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Add a shadow corner to the cache. The least recently used corners are freed
+ * if there is no empty entry or the corners would be larger than `LV_SHADOW_CACHE_MEM_SIZE`
+ * @param sw shadow width
+ * @param r radius
+ * @param w width of the shadow rectangle, up to `2 * (sw + r)`
+ * @param h height of the shadow rectangle, up to `2 * (sw + r)`
+ * @param sh_buf the corner to copy
+ */
+static void shadow_cache_add(lv_coord_t sw, lv_coord_t r, lv_coord_t w, lv_coord_t h, const lv_opa_t * sh_buf)
+{
+    uint32_t size = (uint32_t)(sw + r) * (sw + r);
+    uint32_t mem_max = LV_SHADOW_CACHE_MEM_SIZE ? LV_SHADOW_CACHE_MEM_SIZE : UINT32_MAX;
+    if(size > mem_max) return;
+
+    sh_cache_entry_t * e;
+    while(1) {
+        /*Find an empty entry and the least recently used one*/
+        sh_cache_entry_t * lru = NULL;
+        uint32_t i;
+        e = NULL;
+        for(i = 0; i < LV_SHADOW_CACHE_NUM; i++) {
+            sh_cache_entry_t * e_act = &sh_cache[i];
+            if(e_act->buf == NULL) {
+                if(e == NULL) e = e_act;
+            }
+            else if(lru == NULL || e_act->last_use < lru->last_use) {
+                lru = e_act;
+            }
+        }
+
+        if(e && sh_cache_mem + size <= mem_max) break;
+
+        /*Free the least recently used corner*/
+        if(lru == NULL) return;
+        sh_cache_mem -= (uint32_t)(lru->sw + lru->r) * (lru->sw + lru->r);
+        lv_mem_free(lru->buf);
+        lru->buf = NULL;
+    }
+
+    e->buf = lv_mem_alloc(size);
+    if(e->buf == NULL) return;
+
+    _lv_memcpy(e->buf, sh_buf, size);
+    sh_cache_mem += size;
+    sh_cache_use_cnt++;
+    e->last_use = sh_cache_use_cnt;
+    e->sw = sw;
+    e->r = r;
+    e->w = w;
+    e->h = h;
+}
+
+#endif /*LV_SHADOW_CACHE_SIZE*/
+
+#if LV_RECT_CORNER_CACHE_SIZE
+/**
+ * Get the coverage of a rounded corner from the cache. Not buffered corners are
+ * calculated with a radius mask and replace the least recently used one.
+ * @param r radius, at most `LV_RECT_CORNER_CACHE_SIZE`
+ * @return `r^2` opacity values of the top left corner or NULL if there is no memory
+ */
+static const lv_opa_t * corner_cache_get(lv_coord_t r)
+{
+    corner_cache_entry_t * e = NULL;
+    uint32_t i;
+    for(i = 0; i < LV_RECT_CORNER_CACHE_NUM; i++) {
+        corner_cache_entry_t * e_act = &corner_cache[i];
+        if(e_act->buf && e_act->r == r) {
+            corner_cache_use_cnt++;
+            e_act->last_use = corner_cache_use_cnt;
+            return e_act->buf;
+        }
+
+        /*Remember an empty or the least recently used entry*/
+        if(e == NULL || (e->buf && (e_act->buf == NULL || e_act->last_use < e->last_use))) e = e_act;
+    }
+
+    if(e->buf) lv_mem_free(e->buf);
+    e->buf = lv_mem_alloc((uint32_t)r * r);
+    if(e->buf == NULL) return NULL;
+
+    /*Apply a radius mask on the top left corner of a circle*/
+    lv_area_t a;
+    a.x1 = 0;
+    a.y1 = 0;
+    a.x2 = 2 * r - 1;
+    a.y2 = 2 * r - 1;
+    lv_draw_mask_radius_param_t param;
+    lv_draw_mask_radius_init(&param, &a, r, false);
+
+    lv_coord_t y;
+    for(y = 0; y < r; y++) {
+        lv_opa_t * cov = &e->buf[y * r];
+        _lv_memset_ff(cov, r);
+        lv_draw_mask_res_t res = param.dsc.cb(cov, 0, y, r, &param);
+        if(res == LV_DRAW_MASK_RES_TRANSP) _lv_memset_00(cov, r);
+    }
+
+    corner_cache_use_cnt++;
+    e->last_use = corner_cache_use_cnt;
+    e->r = r;
+
+    return e->buf;
+}
+#endif /*LV_RECT_CORNER_CACHE_SIZE*/
+
 #endif
 
 #if LV_USE_OUTLINE
@@ -19,15 +19,6 @@
 /*********************
  *      DEFINES
  *********************/
-/*Decrement life with this value on every open*/
-#define LV_IMG_CACHE_AGING 1
-
-/*Boost life by this factor (multiply time_to_open with this value)*/
-#define LV_IMG_CACHE_LIFE_GAIN 1
-
-/*Don't let life to be greater than this limit because it would require a lot of time to
- * "die" from very high values */
-#define LV_IMG_CACHE_LIFE_LIMIT 1000
 
 /**********************
  *      TYPEDEFS
@@ -38,6 +29,11 @@
  **********************/
 #if LV_IMG_CACHE_DEF_SIZE == 0
     static lv_img_cache_entry_t cache_temp;
+#else
+    static bool entry_match(const lv_img_cache_entry_t * entry, const void * src);
+    static void entry_close(lv_img_cache_entry_t * entry);
+    static uint32_t entry_mem_size(const lv_img_cache_entry_t * entry);
+    static lv_img_cache_entry_t * entry_get_lru(const lv_img_cache_entry_t * except, bool empty);
 #endif
 
 /**********************
@@ -45,7 +41,9 @@
  **********************/
 #if LV_IMG_CACHE_DEF_SIZE
     static uint16_t entry_cnt;
+    static uint32_t use_cnt;
 #endif
+static lv_img_cache_stat_t cache_stat;
 
 /**********************
  *      MACROS
@@ -58,7 +56,8 @@
 /**
  * Open an image using the image decoder interface and cache it.
  * The image will be left open meaning if the image decoder open callback allocated memory then it will remain.
- * The image is closed if a new image is opened and the new image takes its place in the cache.
+ * The image is closed if a new image is opened and the new image takes its place in the cache,
+ * or the memory of cached images exceeds `LV_IMG_CACHE_MEM_SIZE`.
  * @param src source of the image. Path to file or pointer to an `lv_img_dsc_t` variable
  * @param color color The color of the image with `LV_IMG_CF_ALPHA_...`
  * @return pointer to the cache entry or NULL if can open the image
@@ -76,50 +75,34 @@ lv_img_cache_entry_t * _lv_img_cache_open(const void * src, lv_color_t color)
 
     lv_img_cache_entry_t * cache = LV_GC_ROOT(_lv_img_cache_array);
 
-    /*Decrement all lifes. Make the entries older*/
     uint16_t i;
     for(i = 0; i < entry_cnt; i++) {
-        if(cache[i].life > INT32_MIN + LV_IMG_CACHE_AGING) {
-            cache[i].life -= LV_IMG_CACHE_AGING;
-        }
-    }
-
-    for(i = 0; i < entry_cnt; i++) {
-        bool match = false;
-        lv_img_src_t src_type = lv_img_src_get_type(cache[i].dec_dsc.src);
-        if(src_type == LV_IMG_SRC_VARIABLE) {
-            if(cache[i].dec_dsc.src == src && cache[i].dec_dsc.color.full == color.full) match = true;
-        }
-        else if(src_type == LV_IMG_SRC_FILE) {
-            if(strcmp(cache[i].dec_dsc.src, src) == 0) match = true;
-        }
-
-        if(match) {
-            /* If opened increment its life.
-             * Image difficult to open should live longer to keep avoid frequent their recaching.
-             * Therefore increase `life` with `time_to_open`*/
+        if(entry_match(&cache[i], src) && cache[i].dec_dsc.color.full == color.full) {
             cached_src = &cache[i];
-            cached_src->life += cached_src->dec_dsc.time_to_open * LV_IMG_CACHE_LIFE_GAIN;
-            if(cached_src->life > LV_IMG_CACHE_LIFE_LIMIT) cached_src->life = LV_IMG_CACHE_LIFE_LIMIT;
-            LV_LOG_TRACE("image draw: image found in the cache");
             break;
         }
     }
 
-    /*The image is not cached then cache it now*/
-    if(cached_src) return cached_src;
+    use_cnt++;
 
-    /*Find an entry to reuse. Select the entry with the least life*/
-    cached_src = &cache[0];
-    for(i = 1; i < entry_cnt; i++) {
-        if(cache[i].life < cached_src->life) {
-            cached_src = &cache[i];
-        }
+    if(cached_src) {
+        cached_src->last_use = use_cnt;
+        cache_stat.hit_cnt++;
+        LV_LOG_TRACE("image draw: image found in the cache");
+        return cached_src;
+    }
+
+    /*The image is not cached then cache it now. Prefer an empty entry, else reuse the least recently used one*/
+    cached_src = entry_get_lru(NULL, true);
+    if(cached_src == NULL) {
+        LV_LOG_WARN("lv_img_cache_open: all entries are pinned");
+        return NULL;
     }
 
     /*Close the decoder to reuse if it was opened (has a valid source)*/
     if(cached_src->dec_dsc.src) {
-        lv_img_decoder_close(&cached_src->dec_dsc);
+        entry_close(cached_src);
+        cache_stat.evict_cnt++;
         LV_LOG_INFO("image draw: cache miss, close and reuse an entry");
     }
     else {
@@ -129,6 +112,8 @@ lv_img_cache_entry_t * _lv_img_cache_open(const void * src, lv_color_t color)
 #else
     cached_src = &cache_temp;
 #endif
+    cache_stat.miss_cnt++;
+
     /*Open the image and measure the time to open*/
     uint32_t t_start;
     t_start                          = lv_tick_get();
@@ -139,18 +124,36 @@ lv_img_cache_entry_t * _lv_img_cache_open(const void * src, lv_color_t color)
         lv_img_decoder_close(&cached_src->dec_dsc);
         _lv_memset_00(&cached_src->dec_dsc, sizeof(lv_img_decoder_dsc_t));
         _lv_memset_00(cached_src, sizeof(lv_img_cache_entry_t));
-        cached_src->life = INT32_MIN; /*Make the empty entry very "weak" to force its use  */
         return NULL;
     }
 
-    cached_src->life = 0;
-
     /*If `time_to_open` was not set in the open function set it here*/
     if(cached_src->dec_dsc.time_to_open == 0) {
         cached_src->dec_dsc.time_to_open = lv_tick_elaps(t_start);
     }
 
     if(cached_src->dec_dsc.time_to_open == 0) cached_src->dec_dsc.time_to_open = 1;
+    cache_stat.open_time += cached_src->dec_dsc.time_to_open;
+
+#if LV_IMG_CACHE_DEF_SIZE
+    cached_src->last_use = use_cnt;
+    cached_src->pinned   = 0;
+    cached_src->mem_size = entry_mem_size(cached_src);
+    cache_stat.mem_size += cached_src->mem_size;
+    cache_stat.entry_cnt++;
+
+#if LV_IMG_CACHE_MEM_SIZE
+    /*Close the least recently used images to keep the memory budget. The new image itself is always kept*/
+    while(cache_stat.mem_size > LV_IMG_CACHE_MEM_SIZE) {
+        lv_img_cache_entry_t * lru = entry_get_lru(cached_src, false);
+        if(lru == NULL) break;
+
+        entry_close(lru);
+        cache_stat.evict_cnt++;
+        LV_LOG_INFO("image draw: close an entry for the memory budget");
+    }
+#endif
+#endif
 
     return cached_src;
 }
@@ -194,6 +197,7 @@ void lv_img_cache_set_size(uint16_t new_entry_cnt)
 /**
  * Invalidate an image source in the cache.
  * Useful if the image source is updated therefore it needs to be cached again.
+ * Pinned images are invalidated too.
  * @param src an image source path to a file or pointer to an `lv_img_dsc_t` variable.
  */
 void lv_img_cache_invalidate_src(const void * src)
@@ -205,16 +209,158 @@ void lv_img_cache_invalidate_src(const void * src)
     for(i = 0; i < entry_cnt; i++) {
         if(cache[i].dec_dsc.src == src || src == NULL) {
             if(cache[i].dec_dsc.src != NULL) {
-                lv_img_decoder_close(&cache[i].dec_dsc);
+                entry_close(&cache[i]);
             }
+        }
+    }
+#else
+    LV_UNUSED(src);
+#endif
+}
 
-            _lv_memset_00(&cache[i].dec_dsc, sizeof(lv_img_decoder_dsc_t));
-            _lv_memset_00(&cache[i], sizeof(lv_img_cache_entry_t));
+/**
+ * Pin or unpin an image in the cache.
+ * A pinned image is kept opened, e.g. the background of a clockface which is drawn on every refresh.
+ * The image is opened and cached if it isn't yet. At least one entry is left unpinned.
+ * @param src an image source path to a file or pointer to an `lv_img_dsc_t` variable.
+ * @param pin true to pin, false to unpin
+ * @return LV_RES_OK: pinned or unpinned; LV_RES_INV: the image can't be opened, or no entry to pin
+ */
+lv_res_t lv_img_cache_pin(const void * src, bool pin)
+{
+#if LV_IMG_CACHE_DEF_SIZE
+    lv_img_cache_entry_t * cache = LV_GC_ROOT(_lv_img_cache_array);
+    lv_img_cache_entry_t * entry = NULL;
+    uint16_t pinned_cnt = 0;
+
+    if(src == NULL) return LV_RES_INV;
+
+    uint16_t i;
+    for(i = 0; i < entry_cnt; i++) {
+        if(cache[i].pinned) pinned_cnt++;
+        if(entry == NULL && entry_match(&cache[i], src)) entry = &cache[i];
+    }
+
+    if(!pin) {
+        /*The same source may be cached with different colors*/
+        for(i = 0; i < entry_cnt; i++) {
+            if(entry_match(&cache[i], src)) cache[i].pinned = 0;
         }
+        return LV_RES_OK;
     }
+
+    if(entry && entry->pinned) return LV_RES_OK;
+    if(pinned_cnt + 1 >= entry_cnt) {
+        LV_LOG_WARN("lv_img_cache_pin: at least one entry should be unpinned");
+        return LV_RES_INV;
+    }
+
+    if(entry == NULL) entry = _lv_img_cache_open(src, LV_COLOR_BLACK);
+    if(entry == NULL) return LV_RES_INV;
+
+    entry->pinned = 1;
+    return LV_RES_OK;
+#else
+    LV_UNUSED(src);
+    LV_UNUSED(pin);
+    return LV_RES_INV;
 #endif
 }
 
+/**
+ * Get the statistics of the image cache
+ * @param stat pointer to a variable to store the statistics
+ */
+void lv_img_cache_get_stat(lv_img_cache_stat_t * stat)
+{
+    *stat = cache_stat;
+}
+
+/**
+ * Reset the accumulated counters of the image cache
+ */
+void lv_img_cache_reset_stat(void)
+{
+    cache_stat.hit_cnt   = 0;
+    cache_stat.miss_cnt  = 0;
+    cache_stat.evict_cnt = 0;
+    cache_stat.open_time = 0;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
+
+#if LV_IMG_CACHE_DEF_SIZE
+static bool entry_match(const lv_img_cache_entry_t * entry, const void * src)
+{
+    if(entry->dec_dsc.src == NULL) return false;
+
+    lv_img_src_t src_type = lv_img_src_get_type(entry->dec_dsc.src);
+    if(src_type == LV_IMG_SRC_VARIABLE) {
+        return entry->dec_dsc.src == src;
+    }
+    else if(src_type == LV_IMG_SRC_FILE) {
+        return lv_img_src_get_type(src) == LV_IMG_SRC_FILE && strcmp(entry->dec_dsc.src, src) == 0;
+    }
+
+    return false;
+}
+
+/**
+ * Close the decoder of an entry and make it empty.
+ * The decoder's close callback frees the decoded image.
+ */
+static void entry_close(lv_img_cache_entry_t * entry)
+{
+    lv_img_decoder_close(&entry->dec_dsc);
+
+    cache_stat.mem_size -= entry->mem_size;
+    cache_stat.entry_cnt--;
+
+    _lv_memset_00(&entry->dec_dsc, sizeof(lv_img_decoder_dsc_t));
+    _lv_memset_00(entry, sizeof(lv_img_cache_entry_t));
+}
+
+/**
+ * Estimate the memory allocated by the decoder
+ */
+static uint32_t entry_mem_size(const lv_img_cache_entry_t * entry)
+{
+    const lv_img_decoder_dsc_t * dsc = &entry->dec_dsc;
+
+    /*Decoders which read line by line, or built-in images used in place*/
+    if(dsc->img_data == NULL) return 0;
+    if(dsc->src_type == LV_IMG_SRC_VARIABLE && dsc->img_data == ((const lv_img_dsc_t *)dsc->src)->data) return 0;
+
+    /*Raw formats are decoded by external decoders into true color, e.g. PNG*/
+    uint32_t px_size = lv_img_cf_get_px_size(dsc->header.cf);
+    if(dsc->header.cf == LV_IMG_CF_RAW_ALPHA) px_size = LV_IMG_PX_SIZE_ALPHA_BYTE << 3;
+    else if(px_size == 0) px_size = LV_COLOR_SIZE;
+
+    return ((dsc->header.w * px_size + 7) >> 3) * dsc->header.h;
+}
+
+/**
+ * Get an empty entry, or the least recently used entry which isn't pinned
+ * @param except the entry not to be returned, or NULL
+ * @param empty true to return an empty entry first, false to skip empty entries
+ */
+static lv_img_cache_entry_t * entry_get_lru(const lv_img_cache_entry_t * except, bool empty)
+{
+    lv_img_cache_entry_t * cache = LV_GC_ROOT(_lv_img_cache_array);
+    lv_img_cache_entry_t * lru = NULL;
+
+    uint16_t i;
+    for(i = 0; i < entry_cnt; i++) {
+        if(&cache[i] == except || cache[i].pinned) continue;
+        if(cache[i].dec_dsc.src == NULL) {
+            if(empty) return &cache[i];
+            continue;
+        }
+        if(lru == NULL || cache[i].last_use < lru->last_use) lru = &cache[i];
+    }
+
+    return lru;
+}
+#endif
@@ -31,12 +31,29 @@ extern "C" {
 typedef struct {
     lv_img_decoder_dsc_t dec_dsc; /**< Image information */
 
-    /** Count the cache entries's life. Add `time_tio_open` to `life` when the entry is used.
-     * Decrement all lifes by one every in every ::lv_img_cache_open.
-     * If life == 0 the entry can be reused */
-    int32_t life;
+    /** The open count of the cache at the last use of the entry.
+     * The unpinned entry with the least value is reused first */
+    uint32_t last_use;
+
+    /** Memory allocated by the decoder for the decoded image, estimated from the header */
+    uint32_t mem_size;
+
+    /** Pinned entries are never reused, until unpinned or invalidated */
+    uint8_t pinned;
 } lv_img_cache_entry_t;
 
+/**
+ * Statistics of the image cache, accumulated since the last reset
+ */
+typedef struct {
+    uint32_t hit_cnt;   /**< Count of opens found in the cache*/
+    uint32_t miss_cnt;  /**< Count of opens decoded by the decoder*/
+    uint32_t evict_cnt; /**< Count of entries closed to reuse or to keep the memory budget*/
+    uint32_t open_time; /**< Time in decoder open at misses, in ms*/
+    uint32_t mem_size;  /**< Memory of the cached images now*/
+    uint16_t entry_cnt; /**< Count of the cached images now*/
+} lv_img_cache_stat_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -66,6 +83,27 @@ void lv_img_cache_set_size(uint16_t new_slot_num);
  */
 void lv_img_cache_invalidate_src(const void * src);
 
+/**
+ * Pin or unpin an image in the cache.
+ * A pinned image is kept opened, e.g. the background of a clockface which is drawn on every refresh.
+ * The image is opened and cached if it isn't yet. At least one entry is left unpinned.
+ * @param src an image source path to a file or pointer to an `lv_img_dsc_t` variable.
+ * @param pin true to pin, false to unpin
+ * @return LV_RES_OK: pinned or unpinned; LV_RES_INV: the image can't be opened, or no entry to pin
+ */
+lv_res_t lv_img_cache_pin(const void * src, bool pin);
+
+/**
+ * Get the statistics of the image cache
+ * @param stat pointer to a variable to store the statistics
+ */
+void lv_img_cache_get_stat(lv_img_cache_stat_t * stat);
+
+/**
+ * Reset the accumulated counters of the image cache
+ */
+void lv_img_cache_reset_stat(void);
+
 /**********************
  *      MACROS
  **********************/
@@ -32,6 +32,7 @@ typedef struct {
 #endif
     lv_color_t * palette;
     lv_opa_t * opa;
+    uint8_t * img_buf;      /*The whole decoded image or NULL*/
 } lv_img_decoder_built_in_data_t;
 
 /**********************
@@ -43,6 +44,9 @@ static lv_res_t lv_img_decoder_built_in_line_alpha(lv_img_decoder_dsc_t * dsc, l
                                                    lv_coord_t len, uint8_t * buf);
 static lv_res_t lv_img_decoder_built_in_line_indexed(lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y,
                                                      lv_coord_t len, uint8_t * buf);
+#if LV_IMG_DECODE_FULL_MAX
+    static void lv_img_decoder_built_in_decode_full(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc);
+#endif
 
 /**********************
  *  STATIC VARIABLES
@@ -440,6 +444,9 @@ lv_res_t lv_img_decoder_built_in_open(lv_img_decoder_t * decoder, lv_img_decoder
         }
 
         dsc->img_data = NULL;
+#if LV_IMG_DECODE_FULL_MAX
+        lv_img_decoder_built_in_decode_full(decoder, dsc);
+#endif
         return LV_RES_OK;
 #else
         LV_LOG_WARN("Indexed (palette) images are not enabled in lv_conf.h. See LV_IMG_CF_INDEXED");
@@ -451,6 +458,9 @@ lv_res_t lv_img_decoder_built_in_open(lv_img_decoder_t * decoder, lv_img_decoder
             cf == LV_IMG_CF_ALPHA_8BIT) {
 #if LV_IMG_CF_ALPHA
         dsc->img_data = NULL;
+#if LV_IMG_DECODE_FULL_MAX
+        lv_img_decoder_built_in_decode_full(decoder, dsc);
+#endif
         return LV_RES_OK; /*Nothing to process*/
 #else
         LV_LOG_WARN("Alpha indexed images are not enabled in lv_conf.h. See LV_IMG_CF_ALPHA");
@@ -529,6 +539,7 @@ void lv_img_decoder_built_in_close(lv_img_decoder_t * decoder, lv_img_decoder_ds
 #endif
         if(user_data->palette) lv_mem_free(user_data->palette);
         if(user_data->opa) lv_mem_free(user_data->opa);
+        if(user_data->img_buf) lv_mem_free(user_data->img_buf);
 
         lv_mem_free(user_data);
 
@@ -540,6 +551,45 @@ void lv_img_decoder_built_in_close(lv_img_decoder_t * decoder, lv_img_decoder_ds
  *   STATIC FUNCTIONS
  **********************/
 
+#if LV_IMG_DECODE_FULL_MAX
+/**
+ * Decode a small indexed or alpha indexed image to true color with alpha, the same
+ * pixels as reading it line by line. Nothing happens if the image is too large or
+ * there is no memory, and the image will be read line by line.
+ * @param decoder pointer to the decoder the function associated with
+ * @param dsc pointer to an opened decoder descriptor
+ */
+static void lv_img_decoder_built_in_decode_full(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
+{
+    uint32_t line_size = (uint32_t)dsc->header.w * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    uint32_t size = line_size * dsc->header.h;
+    if(size == 0 || size > LV_IMG_DECODE_FULL_MAX) return;
+
+    if(dsc->user_data == NULL) {
+        dsc->user_data = lv_mem_alloc(sizeof(lv_img_decoder_built_in_data_t));
+        if(dsc->user_data == NULL) return;
+        _lv_memset_00(dsc->user_data, sizeof(lv_img_decoder_built_in_data_t));
+    }
+
+    lv_img_decoder_built_in_data_t * user_data = dsc->user_data;
+    user_data->img_buf = lv_mem_alloc(size);
+    if(user_data->img_buf == NULL) return;
+
+    lv_coord_t y;
+    for(y = 0; y < dsc->header.h; y++) {
+        lv_res_t res = lv_img_decoder_built_in_read_line(decoder, dsc, 0, y, dsc->header.w,
+                                                         &user_data->img_buf[y * line_size]);
+        if(res != LV_RES_OK) {
+            lv_mem_free(user_data->img_buf);
+            user_data->img_buf = NULL;
+            return;
+        }
+    }
+
+    dsc->img_data = user_data->img_buf;
+}
+#endif
+
 static lv_res_t lv_img_decoder_built_in_line_true_color(lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y,
                                                         lv_coord_t len, uint8_t * buf)
 {
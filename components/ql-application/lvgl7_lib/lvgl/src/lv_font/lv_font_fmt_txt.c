@@ -37,6 +37,7 @@ typedef enum {
  *  STATIC PROTOTYPES
  **********************/
 static uint32_t get_glyph_dsc_id(const lv_font_t * font, uint32_t letter);
+static int32_t find_cmap(const lv_font_fmt_txt_dsc_t * fdsc, uint32_t letter);
 static int8_t get_kern_value(const lv_font_t * font, uint32_t gid_left, uint32_t gid_right);
 static int32_t unicode_list_compare(const void * ref, const void * element);
 static int32_t kern_pair_8_compare(const void * ref, const void * element);
@@ -212,12 +213,11 @@ static uint32_t get_glyph_dsc_id(const lv_font_t * font, uint32_t letter)
     /*Check the cache first*/
     if(letter == fdsc->last_letter) return fdsc->last_glyph_id;
 
-    uint16_t i;
-    for(i = 0; i < fdsc->cmap_num; i++) {
+    int32_t i = find_cmap(fdsc, letter);
+    if(i >= 0) {
 
         /*Relative code point*/
         uint32_t rcp = letter - fdsc->cmaps[i].range_start;
-        if(rcp > fdsc->cmaps[i].range_length) continue;
         uint32_t glyph_id = 0;
         if(fdsc->cmaps[i].type == LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY) {
             glyph_id = fdsc->cmaps[i].glyph_id_start + rcp;
@@ -245,7 +245,7 @@ static uint32_t get_glyph_dsc_id(const lv_font_t * font, uint32_t letter)
             if(p) {
                 lv_uintptr_t ofs = (lv_uintptr_t)(p - (uint8_t *) fdsc->cmaps[i].unicode_list);
                 ofs = ofs >> 1;     /*The list stores `uint16_t` so the get the index divide by 2*/
-                const uint8_t * gid_ofs_16 = fdsc->cmaps[i].glyph_id_ofs_list;
+                const uint16_t * gid_ofs_16 = fdsc->cmaps[i].glyph_id_ofs_list;
                 glyph_id = fdsc->cmaps[i].glyph_id_start + gid_ofs_16[ofs];
             }
         }
@@ -262,6 +262,34 @@ static uint32_t get_glyph_dsc_id(const lv_font_t * font, uint32_t letter)
 
 }
 
+/**
+ * Find the cmap containing a letter.
+ * The cmaps generated by lv_font_conv are ordered by `range_start` and don't overlap,
+ * so a binary search is done first. It keeps the lookup fast in CJK fonts with hundreds of cmaps.
+ * @param fdsc pointer to font descriptor
+ * @param letter an UNICODE letter code
+ * @return index of the cmap or -1 if not found
+ */
+static int32_t find_cmap(const lv_font_fmt_txt_dsc_t * fdsc, uint32_t letter)
+{
+    int32_t low = 0;
+    int32_t high = (int32_t)fdsc->cmap_num - 1;
+    while(low <= high) {
+        int32_t mid = (low + high) >> 1;
+        if(letter < fdsc->cmaps[mid].range_start) high = mid - 1;
+        else if(letter - fdsc->cmaps[mid].range_start > fdsc->cmaps[mid].range_length) low = mid + 1;
+        else return mid;
+    }
+
+    /*Not found, the cmaps may be not ordered in a hand written font*/
+    int32_t i;
+    for(i = 0; i < fdsc->cmap_num; i++) {
+        if(letter - fdsc->cmaps[i].range_start <= fdsc->cmaps[i].range_length) return i;
+    }
+
+    return -1;
+}
+
 static int8_t get_kern_value(const lv_font_t * font, uint32_t gid_left, uint32_t gid_right)
 {
     lv_font_fmt_txt_dsc_t * fdsc = (lv_font_fmt_txt_dsc_t *) font->dsc;
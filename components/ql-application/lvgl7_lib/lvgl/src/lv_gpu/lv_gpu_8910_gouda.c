@@ -0,0 +1,117 @@
+/**
+ * @file lv_gpu_8910_gouda.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_gpu_8910_gouda.h"
+
+#if LV_USE_GPU_8910_GOUDA
+
+#include "drv_lcd_v2.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#if LV_COLOR_DEPTH != 16 || LV_COLOR_16_SWAP
+    /*GOUDA only outputs RGB565 in little endian to memory*/
+    #error "Can't use GOUDA with other than LV_COLOR_DEPTH 16 and LV_COLOR_16_SWAP 0"
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_res_t blend(drvLcdLayers_t * layers, lv_color_t * buf, lv_coord_t buf_w, lv_coord_t w, lv_coord_t h);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Fill an area in the buffer with a color
+ * @param buf a buffer which should be filled
+ * @param buf_w width of the buffer in pixels
+ * @param color fill color
+ * @param fill_w width to fill in pixels (<= buf_w)
+ * @param fill_h height to fill in pixels
+ * @return LV_RES_OK: filled by GOUDA; LV_RES_INV: GOUDA is busy, the caller should fill by software
+ * @note `buf_w - fill_w` is offset to the next line after fill
+ */
+lv_res_t lv_gpu_8910_gouda_fill(lv_color_t * buf, lv_coord_t buf_w, lv_color_t color, lv_coord_t fill_w,
+                                lv_coord_t fill_h)
+{
+    /*No layers, GOUDA fills the ROI with the background color*/
+    drvLcdLayers_t layers = {
+        .bg_color = color.full,
+    };
+
+    return blend(&layers, buf, buf_w, fill_w, fill_h);
+}
+
+/**
+ * Copy a map (typically RGB image) to a buffer
+ * @param buf a buffer where map should be copied
+ * @param buf_w width of the buffer in pixels
+ * @param map an "image" to copy
+ * @param map_w width of the map in pixels
+ * @param copy_w width of the area to copy in pixels (<= buf_w)
+ * @param copy_h height of the area to copy in pixels
+ * @return LV_RES_OK: copied by GOUDA; LV_RES_INV: GOUDA is busy, the caller should copy by software
+ * @note `map_w - fill_w` is offset to the next line after copy
+ */
+lv_res_t lv_gpu_8910_gouda_copy(lv_color_t * buf, lv_coord_t buf_w, const lv_color_t * map, lv_coord_t map_w,
+                                lv_coord_t copy_w, lv_coord_t copy_h)
+{
+    /*GOUDA won't write to the map, the cast is only to match the layer definition*/
+    drvLcdOverlay_t ovl = {
+        .buf = (void *)map,
+        .enabled = true,
+        .in_fmt = DRV_LCD_IN_FMT_RGB565,
+        .alpha = 255,
+        .key_en = false,
+        .stride = map_w,
+        .out = {0, 0, copy_w, copy_h},
+    };
+
+    drvLcdLayers_t layers = {
+        .ovl = {&ovl},
+    };
+
+    return blend(&layers, buf, buf_w, copy_w, copy_h);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static lv_res_t blend(drvLcdLayers_t * layers, lv_color_t * buf, lv_coord_t buf_w, lv_coord_t w, lv_coord_t h)
+{
+    /* GOUDA is shared with the LCD flush. Waiting for the flush of the other
+     * display buffer would cost more than rendering by software.*/
+    if(drvLcdIsBusy()) return LV_RES_INV;
+
+    drvLcdArea_t roi = {0, 0, w, h};
+    layers->layer_roi = roi;
+    layers->screen_roi = roi;
+
+    if(!drvLcdBlend(layers, buf, buf_w)) return LV_RES_INV;
+
+    return LV_RES_OK;
+}
+
+#endif /*LV_USE_GPU_8910_GOUDA*/
@@ -0,0 +1,67 @@
+/**
+ * @file lv_gpu_8910_gouda.h
+ *
+ */
+
+#ifndef LV_GPU_8910_GOUDA_H
+#define LV_GPU_8910_GOUDA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../lv_misc/lv_area.h"
+#include "../lv_misc/lv_color.h"
+#include "../lv_misc/lv_types.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Fill an area in the buffer with a color
+ * @param buf a buffer which should be filled
+ * @param buf_w width of the buffer in pixels
+ * @param color fill color
+ * @param fill_w width to fill in pixels (<= buf_w)
+ * @param fill_h height to fill in pixels
+ * @return LV_RES_OK: filled by GOUDA; LV_RES_INV: GOUDA is busy, the caller should fill by software
+ * @note `buf_w - fill_w` is offset to the next line after fill
+ */
+lv_res_t lv_gpu_8910_gouda_fill(lv_color_t * buf, lv_coord_t buf_w, lv_color_t color, lv_coord_t fill_w,
+                                lv_coord_t fill_h);
+
+/**
+ * Copy a map (typically RGB image) to a buffer
+ * @param buf a buffer where map should be copied
+ * @param buf_w width of the buffer in pixels
+ * @param map an "image" to copy
+ * @param map_w width of the map in pixels
+ * @param copy_w width of the area to copy in pixels (<= buf_w)
+ * @param copy_h height of the area to copy in pixels
+ * @return LV_RES_OK: copied by GOUDA; LV_RES_INV: GOUDA is busy, the caller should copy by software
+ * @note `map_w - fill_w` is offset to the next line after copy
+ */
+lv_res_t lv_gpu_8910_gouda_copy(lv_color_t * buf, lv_coord_t buf_w, const lv_color_t * map, lv_coord_t map_w,
+                                lv_coord_t copy_w, lv_coord_t copy_h);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LV_GPU_8910_GOUDA_H*/
@@ -35,6 +35,27 @@
  */
 #define CONFIG_LV_GUI_VER_RES 128
 
+/**
+ * LittlevGL GUI display buffer size in lines, 0 for full screen
+ */
+#define CONFIG_LV_GUI_DISP_BUF_LINES 40
+
+/**
+ * whether to use two display buffers
+ *
+ * When enabled, LittlevGL can render into one buffer while the other one
+ * is being transferred to LCD.
+ */
+#define CONFIG_LV_GUI_DISP_DOUBLE_BUF
+
+/**
+ * relaxed timeout of gui task timer in ms, when nothing is animating
+ *
+ * The gui timer can be delayed in sleep, to be merged with other wakeups.
+ * Animation frames are always in time.
+ */
+#define CONFIG_LV_GUI_TASK_RELAXED_MS 100
+
 /**
  * Screen off timeout
  */
@@ -10,11 +10,12 @@
  * without further testing or modification.
  */
 
+
 // #define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_DEBUG
 
 #include "lv_gui_main.h"
+#include "lv_gui_port.h"
 #include "drv_lcd_v2.h"
-#include "drv_names.h"
 #include "drv_keypad.h"
 #include "lvgl.h"
 #include "osi_api.h"
@@ -24,88 +25,77 @@
 
 typedef struct
 {
-    bool screen_on;            // state of screen on
-    bool keypad_pending;       // keypad pending, set in ISR, clear in thread
-    bool anim_inactive;        // property of whether animation is regarded as inactive
-    drvLcd_t *lcd;             // LCD instance
-    osiThread_t *thread;       // gui thread
-    osiTimer_t *task_timer;    // timer to trigger task handler
-    drvLcdVideoLayer_t vl;     // extern video layer
-    lv_disp_buf_t disp_buf;    // display buffer
-    lv_disp_t *disp;           // display device
-    lv_indev_t *keypad;        // keypad device
-    keyMap_t last_key;         // last key from ISR
-    keyState_t last_key_state; // last key state from ISR
-    uint32_t screen_on_users;  // screen on user bitmap
-    uint32_t inactive_timeout; // property of inactive timeout
+    lvGuiCreate_t create;   // gui creation function
+    lv_disp_buf_t disp_buf; // display buffer
+    lv_disp_t *disp;        // display device
+    lv_indev_t *keypad;     // keypad device
 } lvGuiContext_t;
 
-typedef struct
-{
-    uint8_t keypad;
-    uint8_t lv_key;
-} lvGuiKeypadMap_t;
-
-static const lvGuiKeypadMap_t gLvKeyMap[] = {
-    {KEY_MAP_POWER, 0xf0},
-    {KEY_MAP_SIM1, 0xf1},
-    {KEY_MAP_SIM2, 0xf2},
-    {KEY_MAP_0, '0'},
-    {KEY_MAP_1, '1'},
-    {KEY_MAP_2, '2'},
-    {KEY_MAP_3, '3'},
-    {KEY_MAP_4, '4'},
-    {KEY_MAP_5, '5'},
-    {KEY_MAP_6, '6'},
-    {KEY_MAP_7, '7'},
-    {KEY_MAP_8, '8'},
-    {KEY_MAP_9, '9'},
-    {KEY_MAP_STAR, '*'},
-    {KEY_MAP_SHARP, '#'},
-    {KEY_MAP_OK, LV_KEY_ENTER},
-    {KEY_MAP_LEFT, LV_KEY_LEFT},
-    {KEY_MAP_RIGHT, LV_KEY_RIGHT},
-    {KEY_MAP_UP, LV_KEY_UP},
-    {KEY_MAP_DOWN, LV_KEY_DOWN},
-    {KEY_MAP_SOFT_L, LV_KEY_PREV},
-    {KEY_MAP_SOFT_R, LV_KEY_NEXT},
+// littlevgl key of each keypad key, indexed by keyMap_t. 0 is not mapped.
+static const uint8_t gLvKeyMap[KEY_MAP_MAX_COUNT] = {
+    [KEY_MAP_POWER] = 0xf0,
+    [KEY_MAP_SIM1] = 0xf1,
+    [KEY_MAP_SIM2] = 0xf2,
+    [KEY_MAP_0] = '0',
+    [KEY_MAP_1] = '1',
+    [KEY_MAP_2] = '2',
+    [KEY_MAP_3] = '3',
+    [KEY_MAP_4] = '4',
+    [KEY_MAP_5] = '5',
+    [KEY_MAP_6] = '6',
+    [KEY_MAP_7] = '7',
+    [KEY_MAP_8] = '8',
+    [KEY_MAP_9] = '9',
+    [KEY_MAP_STAR] = '*',
+    [KEY_MAP_SHARP] = '#',
+    [KEY_MAP_OK] = LV_KEY_ENTER,
+    [KEY_MAP_LEFT] = LV_KEY_LEFT,
+    [KEY_MAP_RIGHT] = LV_KEY_RIGHT,
+    [KEY_MAP_UP] = LV_KEY_UP,
+    [KEY_MAP_DOWN] = LV_KEY_DOWN,
+    [KEY_MAP_SOFT_L] = LV_KEY_PREV,
+    [KEY_MAP_SOFT_R] = LV_KEY_NEXT,
 };
 
 static lvGuiContext_t gLvGuiCtx;
 
 /**
  * flush display forcedly
+ *
+ * The display buffer may only cover part of the screen, so the whole
+ * screen is invalidated and redrawn.
  */
 static void prvDispForceFlush(void)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
-    drvLcdArea_t roi = {
-        .x = 0,
-        .y = 0,
-        .w = d->disp->driver.hor_res,
-        .h = d->disp->driver.ver_res,
-    };
 
-    drvLcdOverlay_t ovl = {
-        .buf = d->disp_buf.buf1,
-        .enabled = true,
-        .in_fmt = DRV_LCD_IN_FMT_RGB565,
-        .alpha = 255,
-        .key_en = LV_INDEXED_CHROMA,
-        .key_color = lv_color_to16(LV_COLOR_TRANSP),
-        .stride = roi.w,
-        .out = roi,
-    };
-    drvLcdLayers_t layers = {
-        .vl = &d->vl,
-        .ovl = {NULL, NULL, &ovl},
-        .layer_roi = roi,
-        .screen_roi = roi,
-    };
+    lv_obj_invalidate(lv_disp_get_scr_act(d->disp));
+    lv_refr_now(d->disp);
+    lvGuiPortDispWaitDone();
+}
 
-    drvLcdFlush(d->lcd, &layers, true);
+/**
+ * LCD transfer done callback, called in ISR or inside flush
+ */
+static void prvDispFlushDone(void *param)
+{
+    lv_disp_flush_ready((lv_disp_drv_t *)param);
 }
 
+/**
+ * display device flush_cb
+ */
+static void prvDispFlush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    drvLcdArea_t roi = {
+        .x = area->x1,
+        .y = area->y1,
+        .w = lv_area_get_width(area),
+        .h = lv_area_get_height(area),
+    };
+
+    lvGuiPortDispFlush(&roi, color_p, prvDispFlushDone, disp_drv);
+}
 
 /**
  * initialize LCD display device
@@ -114,75 +104,60 @@ static bool prvLvInitLcd(void)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    d->lcd = drvLcdGetByname(DRV_NAME_LCD1);
-    if (d->lcd == NULL)
+    lvGuiPortDisp_t info;
+    if (!lvGuiPortDispInit(lv_color_to16(LV_COLOR_TRANSP), &info))
         return false;
 
-    if (!drvLcdOpenV2(d->lcd))
-        return false;
-
-    drvLcdSetDirection(d->lcd, DRV_LCD_DIR_NORMAL);
-
-    drvLcdPanelInfo_t panel_info;
-    if (!drvLcdGetPanelInfo(d->lcd, &panel_info))
-        return false;
-
-    unsigned pixel_cnt = panel_info.width * panel_info.height;
-    lv_color_t *buf = (lv_color_t *)malloc(pixel_cnt * sizeof(lv_color_t));
-    if (buf == NULL)
-        return false;
-
-    lv_disp_buf_init(&d->disp_buf, buf, buf, pixel_cnt);
+    lv_disp_buf_init(&d->disp_buf, info.buf1, info.buf2, info.width * info.lines);
 
     lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
     disp_drv.flush_cb = prvDispFlush;
     disp_drv.buffer = &d->disp_buf;
     d->disp = lv_disp_drv_register(&disp_drv); // pointer copy
+    if (d->disp == NULL)
+        return false;
+
+    if (info.vsync)
+        lv_task_set_period(d->disp->refr_task, OSI_MAX(unsigned, 1, info.frame_us / 1000));
     return true;
 }
 
 /**
- * callback of keypad driver, called in ISR
+ * resume keypad read task, called in gui thread
  */
-static void prvKeypadCallback(keyMap_t key, keyState_t evt, void *p)
+static void prvKeypadResume(void *param)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    d->last_key = key;
-    d->last_key_state = evt;
-    d->keypad_pending = true;
+    lv_task_set_prio(d->keypad->driver.read_task, LV_TASK_PRIO_HIGH);
+    lv_task_ready(d->keypad->driver.read_task);
 }
 
 /**
  * keypad device read_cb
+ *
+ * One key event is read each time, and littlevgl will call it again
+ * when there are more events in FIFO.
  */
 static bool prvLvKeypadRead(lv_indev_drv_t *kp, lv_indev_data_t *data)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
+    lvGuiPortKey_t key;
+    if (lvGuiPortKeypadRead(&key))
+        lvGuiScreenOn();
 
-    uint32_t critical = osiEnterCritical();
-    keyMap_t last_key = d->last_key;
-    keyState_t last_key_state = d->last_key_state;
-    bool keypad_pending = d->keypad_pending;
-    d->keypad_pending = false;
-    osiExitCritical(critical);
-
-    if (keypad_pending)
-    {
-        data->state = (last_key_state & KEY_STATE_RELEASE) ? LV_INDEV_STATE_REL : LV_INDEV_STATE_PR;
-        data->key = 0xff;
-        for (unsigned n = 0; n < OSI_ARRAY_SIZE(gLvKeyMap); n++)
-        {
-            if (gLvKeyMap[n].keypad == last_key)
-            {
-                data->key = gLvKeyMap[n].lv_key;
-                break;
-            }
-        }
+    // Without new event, the last key is reported, and littlevgl detects
+    // long press and repeat on it.
+    data->key = key.key;
+    data->state = key.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
 
-        lvGuiScreenOn();
-    }
+    if (lvGuiPortKeypadPending())
+        return true;
+
+    // Keypad is interrupt driven. When keys are released, it is not
+    // needed to poll keypad, and the read task will be resumed by port.
+    if (!key.pressed)
+        lv_task_set_prio(kp->read_task, LV_TASK_PRIO_OFF);
 
     // no more to be read
     return false;
@@ -201,98 +176,81 @@ static bool prvLvInitKeypad(void)
     kp_drv.read_cb = prvLvKeypadRead;
     d->keypad = lv_indev_drv_register(&kp_drv); // pointer copy
 
-    drvKeypadInit(); // permit multiple calls
-    drvKeypadSetCB(prvKeypadCallback, KEY_STATE_PRESS | KEY_STATE_RELEASE, NULL);
-    return true;
+    return lvGuiPortKeypadInit(gLvKeyMap, prvKeypadResume, NULL);
 }
 
 /**
- * @brief 执行 LVGL 的任务处理函数
- *
- * 本函数作为 LVGL 的主任务循环回调，用于处理 GUI 动画、事件、绘制刷新等内部事务。
- * 通常由定时器周期性触发。
- *
- * 主要逻辑包括：
- * - 调用 `lv_task_handler()` 处理 LVGL 核心任务
- * - 获取下次运行时间，并通过 `osiTimerStartRelaxed` 启动下一次任务调度
- * - 调用 `lv_refr_now()` 立即刷新显示屏（可选操作，用于强制刷新）
- *
- * @note 本函数通常运行于 GUI 主线程或 GUI 定时任务上下文中。
+ * run littlevgl task handler, return ms to the next task deadline
  */
-static void prvLvTaskHandler(void)
+static uint32_t prvLvRun(void *param)
 {
-    // 获取全局 GUI 上下文结构体，用于访问定时器和显示句柄
-    lvGuiContext_t *d = &gLvGuiCtx;
-
-    // 执行 LittlevGL 的任务处理器
-    // 用于处理事件派发、控件动画、输入设备等核心操作
     lv_task_handler();
 
-    // 获取下次调度运行所需等待的 tick 数（单位：ms）
-    // LVGL 会根据内部任务队列动态计算调度周期
-    unsigned next_run = lv_task_get_tick_next_run();
+    // INT32_MAX is returned when all tasks are turned off
+    uint32_t next_run = lv_task_get_tick_next_run();
+    return (next_run == INT32_MAX) ? LV_GUI_PORT_NO_TASK : next_run;
+}
 
-    // 启动一个 OSI 软定时器，用于延迟 next_run 毫秒后再次调用本任务
-    // OSI_WAIT_FOREVER 参数表示任务在内核调度中无需主动超时退出
-    osiTimerStartRelaxed(d->task_timer, next_run, OSI_WAIT_FOREVER);
-    // 强制立即刷新屏幕（仅当需要实时显示更新时调用，LVGL 会避免重复刷）
-    lv_refr_now(d->disp);
+/**
+ * whether frames should be in time
+ */
+static bool prvLvBusy(void *param)
+{
+    lvGuiContext_t *d = &gLvGuiCtx;
+    return lv_anim_count_running() != 0 || d->disp->inv_p != 0;
+}
+
+/**
+ * whether animating
+ */
+static bool prvLvAnimating(void *param)
+{
+    return lv_anim_count_running() != 0;
 }
 
 /**
- * whether inactive timeout
+ * time since the last user activity
  */
-static bool prvIsInactiveTimeout(void)
+static uint32_t prvLvInactiveTime(void *param)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
+    return lv_disp_get_inactive_time(d->disp);
+}
 
-    if (d->screen_on_users != 0)
-        return false;
-    if (d->inactive_timeout == 0)
-        return false;
-    if (!d->anim_inactive && lv_anim_count_running())
-        return false;
-    return lv_disp_get_inactive_time(d->disp) > d->inactive_timeout;
+/**
+ * screen off at inactive timeout
+ */
+static void prvLvScreenOff(void *param)
+{
+    lvGuiScreenOff();
 }
 
 /**
- * gui thread entry
+ * initialize littlevgl in gui thread
  */
-static void prvLvThreadEntry(void *param)
+static void prvLvInit(void *param)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
-    d->thread = osiThreadCurrent();
-    d->task_timer = osiTimerCreate(d->thread, (osiCallback_t)prvLvTaskHandler, NULL);
 
     lv_init();
     prvLvInitLcd();
     prvLvInitKeypad();
 
-    lvGuiCreate_t create = (lvGuiCreate_t)param;
-    if (create != NULL)
-        create();
+    if (d->create != NULL)
+        d->create();
 
-    osiTimerStart(d->task_timer, 0);
     lv_disp_trig_activity(d->disp);
-    for (;;)
-    {
-        osiEvent_t event;
-        event.id = OSI_EVENT_ID_NONE;
-
-        osiEventWait(d->thread, &event);
-        if (event.id == OSI_EVENT_ID_QUIT)
-            break;
-
-        if (d->screen_on && prvIsInactiveTimeout())
-        {
-            OSI_LOGI(0, "inactive timeout, screen off");
-            lvGuiScreenOff();
-        }
-    }
-
-    osiThreadExit();
 }
 
+static const lvGuiPortOps_t gLvGuiPortOps = {
+    .init = prvLvInit,
+    .run = prvLvRun,
+    .busy = prvLvBusy,
+    .animating = prvLvAnimating,
+    .inactive_time = prvLvInactiveTime,
+    .screen_off = prvLvScreenOff,
+};
+
 /**
  * start gui based on littlevgl
  */
@@ -300,18 +258,8 @@ void lvGuiInit(lvGuiCreate_t create)
 {
     lvGuiContext_t *d = &gLvGuiCtx;
 
-    d->screen_on = true;
-    d->keypad_pending = false;
-    d->anim_inactive = false;
-    d->last_key = 0xff;
-    d->last_key_state = KEY_STATE_RELEASE;
-    d->screen_on_users = 0;
-    d->inactive_timeout = CONFIG_LV_GUI_SCREEN_OFF_TIMEOUT;
-
-    d->thread = osiThreadCreate("lvgl", prvLvThreadEntry, create,
-                                OSI_PRIORITY_NORMAL,
-                                CONFIG_LV_GUI_THREAD_STACK_SIZE,
-                                CONFIG_LV_GUI_THREAD_EVENT_COUNT);
+    d->create = create;
+    lvGuiPortStart(&gLvGuiPortOps);
 }
 
 /**
@@ -319,8 +267,7 @@ void lvGuiInit(lvGuiCreate_t create)
  */
 osiThread_t *lvGuiGetThread(void)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    return d->thread;
+    return lvGuiPortThread();
 }
 
 /**
@@ -337,8 +284,7 @@ lv_indev_t *lvGuiGetKeyPad(void)
  */
 void lvGuiThreadCallback(osiCallback_t cb, void *param)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    osiThreadCallback(d->thread, cb, param);
+    osiThreadCallback(lvGuiPortThread(), cb, param);
 }
 
 /**
@@ -346,8 +292,7 @@ void lvGuiThreadCallback(osiCallback_t cb, void *param)
  */
 void lvGuiSendEvent(const osiEvent_t *evt)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    osiEventSend(d->thread, evt);
+    osiEventSend(lvGuiPortThread(), evt);
 }
 
 /**
@@ -355,14 +300,7 @@ void lvGuiSendEvent(const osiEvent_t *evt)
  */
 bool lvGuiRequestSceenOn(uint8_t id)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-
-    if (id > 31)
-        return false;
-
-    unsigned mask = (1 << id);
-    d->screen_on_users |= mask;
-    return true;
+    return lvGuiPortRequestScreenOn(id);
 }
 
 /**
@@ -370,14 +308,7 @@ bool lvGuiRequestSceenOn(uint8_t id)
  */
 bool lvGuiReleaseScreenOn(uint8_t id)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-
-    if (id > 31)
-        return false;
-
-    unsigned mask = (1 << id);
-    d->screen_on_users &= ~mask;
-    return true;
+    return lvGuiPortReleaseScreenOn(id);
 }
 
 /**
@@ -385,15 +316,11 @@ bool lvGuiReleaseScreenOn(uint8_t id)
  */
 void lvGuiScreenOff(void)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-
-    if (!d->screen_on)
+    if (!lvGuiPortScreenIsOn())
         return;
 
     OSI_LOGI(0, "screen off");
-    drvLcdSetBackLightEnable(d->lcd, false);
-    drvLcdSleep(d->lcd);
-    d->screen_on = false;
+    lvGuiPortScreenOff(true);
 }
 
 /**
@@ -401,16 +328,13 @@ void lvGuiScreenOff(void)
  */
 void lvGuiScreenOn(void)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-
-    if (d->screen_on)
+    if (lvGuiPortScreenIsOn())
         return;
 
     OSI_LOGI(0, "screen on");
-    drvLcdWakeup(d->lcd);
+    lvGuiPortScreenOn(true); // flush is dropped when screen is off
     prvDispForceFlush();
-    drvLcdSetBackLightEnable(d->lcd, true);
-    d->screen_on = true;
+    lvGuiPortBackLightOn();
 }
 
 /**
@@ -418,8 +342,7 @@ void lvGuiScreenOn(void)
  */
 void lvGuiSetInactiveTimeout(unsigned timeout)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    d->inactive_timeout = timeout;
+    lvGuiPortSetInactiveTimeout(timeout);
 }
 
 /**
@@ -427,6 +350,5 @@ void lvGuiSetInactiveTimeout(unsigned timeout)
  */
 void lvGuiSetAnimationInactive(bool inactive)
 {
-    lvGuiContext_t *d = &gLvGuiCtx;
-    d->anim_inactive = inactive;
+    lvGuiPortSetAnimationInactive(inactive);
 }
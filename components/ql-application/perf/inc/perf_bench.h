@@ -0,0 +1,90 @@
+/**  @file
+  perf_bench.h
+
+  @brief
+  This file provides the definitions for the performance benchmark suite,
+  and declares the API functions.
+
+*/
+
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+
+#ifndef PERF_BENCH_H
+#define PERF_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*========================================================================
+ *  Marco Definition
+ *========================================================================*/
+
+/*
+ * The suite runs all benchmarks in one task, one after another, and
+ * writes one JSON report to PERF_BENCH_REPORT_FILE:
+ *
+ * {"suite":"perf_bench","format":1,"fw":"<firmware version>",
+ *  "results":[{"name":"kernel.mutex","value":123,"unit":"ns"},...]}
+ *
+ * Each result is also printed to log as one line. Names are stable
+ * across releases, so reports of two firmware versions can be compared
+ * by name. Benchmarks of disabled features are not in the report.
+ */
+
+#define PERF_BENCH_REPORT_FILE        "UFS:perf_report.json"
+#define PERF_BENCH_MAX_RESULTS        48
+#define PERF_BENCH_TASK_STACK_SIZE    (8 * 1024)
+#define PERF_BENCH_TASK_PRIO          APP_PRIORITY_NORMAL
+
+#define PERF_BENCH_FS_FILE            "UFS:perf_bench.bin"
+#define PERF_BENCH_FS_SIZE            (256 * 1024)
+#define PERF_BENCH_FS_CHUNK           (4 * 1024)
+
+#define PERF_BENCH_NET_PORT           5001
+#define PERF_BENCH_TCP_SIZE           (1024 * 1024)
+#define PERF_BENCH_UDP_COUNT          1000
+#define PERF_BENCH_UDP_SIZE           1024
+
+#define PERF_BENCH_LCD_WIDTH          240
+#define PERF_BENCH_LCD_HEIGHT         320
+#define PERF_BENCH_LCD_FRAMES         20
+
+#define PERF_BENCH_AT_COUNT           20
+
+/*========================================================================
+ *  function Definition
+ *========================================================================*/
+
+/*****************************************************************
+* Function: ql_perf_bench_app_init
+*
+* Description:
+* 	Create the benchmark task. The report is written when all
+* 	benchmarks are finished.
+*
+*****************************************************************/
+void ql_perf_bench_app_init(void);
+
+#ifdef __cplusplus
+} /*"C" */
+#endif
+
+#endif /* PERF_BENCH_H */
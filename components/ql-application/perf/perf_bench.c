@@ -0,0 +1,678 @@
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "ql_app_feature_config.h"
+#include "ql_api_common.h"
+#include "ql_api_osi.h"
+#include "ql_api_dev.h"
+#include "ql_fs.h"
+#include "ql_log.h"
+#include "osi_api.h"
+#include "sockets.h"
+#ifdef QL_APP_FEATURE_LCD
+#include "ql_lcd.h"
+#endif
+#ifdef QL_APP_FEATURE_VIRT_AT
+#include "ql_api_virt_at.h"
+#endif
+#include "perf_bench.h"
+
+#define PERF_BENCH_LOG_LEVEL          QL_LOG_LEVEL_INFO
+#define PERF_BENCH_LOG(msg, ...)      QL_LOG(PERF_BENCH_LOG_LEVEL, "perf_bench", msg, ##__VA_ARGS__)
+
+#define PERF_BENCH_KERNEL_LOOPS       10000
+#define PERF_BENCH_PINGPONG_LOOPS     1000
+#define PERF_BENCH_MEM_SIZE           (64 * 1024)
+#define PERF_BENCH_MEM_LOOPS          64
+#define PERF_BENCH_FS_RANDOM_READS    64
+#define PERF_BENCH_REPORT_SIZE        (4 * 1024)
+
+#define PERF_BENCH_EVENT_PING         0x7001
+#define PERF_BENCH_EVENT_QUIT         0x7002
+
+typedef struct
+{
+	const char *name;
+	uint32_t value;
+	const char *unit;
+} perf_bench_result_s;
+
+typedef struct
+{
+	ql_task_t task;                         // benchmark task
+	ql_task_t peer;                         // peer task of ping-pong and servers
+	ql_sem_t ping;
+	ql_sem_t pong;
+	int server_fd;
+	uint32_t server_bytes;                  // bytes received by server
+	uint32_t server_packets;
+	int result_num;
+	perf_bench_result_s results[PERF_BENCH_MAX_RESULTS];
+} perf_bench_ctx_s;
+
+static perf_bench_ctx_s perf_bench_ctx;
+
+static void perf_bench_add(const char *name, uint32_t value, const char *unit)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+
+	PERF_BENCH_LOG("{\"name\":\"%s\",\"value\":%u,\"unit\":\"%s\"}", name, value, unit);
+	if (ctx->result_num < PERF_BENCH_MAX_RESULTS)
+	{
+		perf_bench_result_s *r = &ctx->results[ctx->result_num++];
+		r->name = name;
+		r->value = value;
+		r->unit = unit;
+	}
+}
+
+static uint32_t perf_bench_ns_per_op(int64_t start_us, unsigned loops)
+{
+	return (uint32_t)((osiUpTimeUS() - start_us) * 1000 / loops);
+}
+
+static uint32_t perf_bench_kbps(int64_t start_us, uint64_t bytes)
+{
+	int64_t us = osiUpTimeUS() - start_us;
+	return (us <= 0) ? 0 : (uint32_t)(bytes * 1000000 / 1024 / us);
+}
+
+/*========================================================================
+ *  kernel primitives and memory
+ *========================================================================*/
+
+static void perf_bench_sem_peer(void *param)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+
+	for (unsigned n = 0; n < PERF_BENCH_PINGPONG_LOOPS; n++)
+	{
+		ql_rtos_semaphore_wait(ctx->ping, QL_WAIT_FOREVER);
+		ql_rtos_semaphore_release(ctx->pong);
+	}
+	ql_rtos_task_delete(NULL);
+}
+
+static void perf_bench_event_peer(void *param)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	ql_event_t event = {0};
+
+	for (;;)
+	{
+		if (ql_event_wait(&event, QL_WAIT_FOREVER) != QL_OSI_SUCCESS)
+			continue;
+		if (event.id == PERF_BENCH_EVENT_QUIT)
+			break;
+		ql_rtos_event_send(ctx->task, &event);
+	}
+	ql_rtos_task_delete(NULL);
+}
+
+static void perf_bench_kernel(void)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	ql_mutex_t mutex = NULL;
+	ql_sem_t sem = NULL;
+	int64_t start;
+
+	if (ql_rtos_mutex_create(&mutex) == QL_OSI_SUCCESS)
+	{
+		start = osiUpTimeUS();
+		for (unsigned n = 0; n < PERF_BENCH_KERNEL_LOOPS; n++)
+		{
+			ql_rtos_mutex_lock(mutex, QL_WAIT_FOREVER);
+			ql_rtos_mutex_unlock(mutex);
+		}
+		perf_bench_add("kernel.mutex", perf_bench_ns_per_op(start, PERF_BENCH_KERNEL_LOOPS), "ns");
+		ql_rtos_mutex_delete(mutex);
+	}
+
+	if (ql_rtos_semaphore_create(&sem, 0) == QL_OSI_SUCCESS)
+	{
+		start = osiUpTimeUS();
+		for (unsigned n = 0; n < PERF_BENCH_KERNEL_LOOPS; n++)
+		{
+			ql_rtos_semaphore_release(sem);
+			ql_rtos_semaphore_wait(sem, QL_WAIT_FOREVER);
+		}
+		perf_bench_add("kernel.sem", perf_bench_ns_per_op(start, PERF_BENCH_KERNEL_LOOPS), "ns");
+		ql_rtos_semaphore_delete(sem);
+	}
+
+	start = osiUpTimeUS();
+	for (unsigned n = 0; n < PERF_BENCH_KERNEL_LOOPS; n++)
+	{
+		void *p = malloc(64);
+		free(p);
+	}
+	perf_bench_add("kernel.malloc_free_64", perf_bench_ns_per_op(start, PERF_BENCH_KERNEL_LOOPS), "ns");
+
+	// two context switches each round trip
+	if (ql_rtos_semaphore_create(&ctx->ping, 0) == QL_OSI_SUCCESS &&
+		ql_rtos_semaphore_create(&ctx->pong, 0) == QL_OSI_SUCCESS &&
+		ql_rtos_task_create(&ctx->peer, 1024, PERF_BENCH_TASK_PRIO, "perf_sem", perf_bench_sem_peer, NULL, 1) == QL_OSI_SUCCESS)
+	{
+		start = osiUpTimeUS();
+		for (unsigned n = 0; n < PERF_BENCH_PINGPONG_LOOPS; n++)
+		{
+			ql_rtos_semaphore_release(ctx->ping);
+			ql_rtos_semaphore_wait(ctx->pong, QL_WAIT_FOREVER);
+		}
+		perf_bench_add("kernel.sem_pingpong", perf_bench_ns_per_op(start, PERF_BENCH_PINGPONG_LOOPS), "ns");
+	}
+	if (ctx->ping != NULL)
+		ql_rtos_semaphore_delete(ctx->ping);
+	if (ctx->pong != NULL)
+		ql_rtos_semaphore_delete(ctx->pong);
+	ctx->ping = ctx->pong = NULL;
+
+	if (ql_rtos_task_create(&ctx->peer, 1024, PERF_BENCH_TASK_PRIO, "perf_evt", perf_bench_event_peer, NULL, 4) == QL_OSI_SUCCESS)
+	{
+		ql_event_t event = {0};
+		unsigned done = 0;
+
+		start = osiUpTimeUS();
+		for (; done < PERF_BENCH_PINGPONG_LOOPS; done++)
+		{
+			event.id = PERF_BENCH_EVENT_PING;
+			if (ql_rtos_event_send(ctx->peer, &event) != QL_OSI_SUCCESS ||
+				ql_event_wait(&event, 1000) != QL_OSI_SUCCESS)
+				break;
+		}
+		if (done == PERF_BENCH_PINGPONG_LOOPS)
+			perf_bench_add("kernel.event_pingpong", perf_bench_ns_per_op(start, PERF_BENCH_PINGPONG_LOOPS), "ns");
+
+		event.id = PERF_BENCH_EVENT_QUIT;
+		ql_rtos_event_send(ctx->peer, &event);
+	}
+}
+
+static void perf_bench_mem(void)
+{
+	uint8_t *src = malloc(PERF_BENCH_MEM_SIZE);
+	uint8_t *dst = malloc(PERF_BENCH_MEM_SIZE);
+	int64_t start;
+
+	if (src == NULL || dst == NULL)
+	{
+		PERF_BENCH_LOG("mem no memory");
+		goto exit;
+	}
+
+	memset(src, 0x5a, PERF_BENCH_MEM_SIZE);
+	start = osiUpTimeUS();
+	for (unsigned n = 0; n < PERF_BENCH_MEM_LOOPS; n++)
+		memcpy(dst, src, PERF_BENCH_MEM_SIZE);
+	perf_bench_add("mem.memcpy_64k", perf_bench_kbps(start, (uint64_t)PERF_BENCH_MEM_SIZE * PERF_BENCH_MEM_LOOPS), "KB/s");
+
+	// small copies are dominated by call and setup cost
+	start = osiUpTimeUS();
+	for (unsigned n = 0; n < PERF_BENCH_KERNEL_LOOPS; n++)
+		memcpy(dst + (n & 7), src, 64);
+	perf_bench_add("mem.memcpy_64", perf_bench_ns_per_op(start, PERF_BENCH_KERNEL_LOOPS), "ns");
+
+	start = osiUpTimeUS();
+	for (unsigned n = 0; n < PERF_BENCH_MEM_LOOPS; n++)
+		memset(dst, n, PERF_BENCH_MEM_SIZE);
+	perf_bench_add("mem.memset_64k", perf_bench_kbps(start, (uint64_t)PERF_BENCH_MEM_SIZE * PERF_BENCH_MEM_LOOPS), "KB/s");
+
+	start = osiUpTimeUS();
+	for (unsigned n = 0; n < PERF_BENCH_MEM_LOOPS; n++)
+		memmove(dst + 1, dst, PERF_BENCH_MEM_SIZE - 1);
+	perf_bench_add("mem.memmove_64k", perf_bench_kbps(start, (uint64_t)PERF_BENCH_MEM_SIZE * PERF_BENCH_MEM_LOOPS), "KB/s");
+
+exit:
+	free(src);
+	free(dst);
+}
+
+/*========================================================================
+ *  file system
+ *========================================================================*/
+
+#ifdef QL_APP_FEATURE_FILE
+static void perf_bench_fs(void)
+{
+	uint8_t *buf = malloc(PERF_BENCH_FS_CHUNK);
+	QFILE fd = -1;
+	int64_t start;
+	unsigned n;
+
+	if (buf == NULL)
+		return;
+	memset(buf, 0xa5, PERF_BENCH_FS_CHUNK);
+
+	fd = ql_fopen(PERF_BENCH_FS_FILE, "wb+");
+	if (fd < 0)
+	{
+		PERF_BENCH_LOG("fs open failed %d", fd);
+		goto exit;
+	}
+
+	start = osiUpTimeUS();
+	for (n = 0; n < PERF_BENCH_FS_SIZE / PERF_BENCH_FS_CHUNK; n++)
+	{
+		if (ql_fwrite(buf, PERF_BENCH_FS_CHUNK, 1, fd) != PERF_BENCH_FS_CHUNK)
+			break;
+	}
+	ql_fclose(fd);
+	if (n != PERF_BENCH_FS_SIZE / PERF_BENCH_FS_CHUNK)
+	{
+		PERF_BENCH_LOG("fs write failed at %d", n);
+		goto exit_remove;
+	}
+	// close is included, data are flushed at close
+	perf_bench_add("fs.seq_write", perf_bench_kbps(start, PERF_BENCH_FS_SIZE), "KB/s");
+
+	fd = ql_fopen(PERF_BENCH_FS_FILE, "rb");
+	if (fd < 0)
+		goto exit_remove;
+
+	start = osiUpTimeUS();
+	for (n = 0; n < PERF_BENCH_FS_SIZE / PERF_BENCH_FS_CHUNK; n++)
+	{
+		if (ql_fread(buf, PERF_BENCH_FS_CHUNK, 1, fd) != PERF_BENCH_FS_CHUNK)
+			break;
+	}
+	if (n == PERF_BENCH_FS_SIZE / PERF_BENCH_FS_CHUNK)
+		perf_bench_add("fs.seq_read", perf_bench_kbps(start, PERF_BENCH_FS_SIZE), "KB/s");
+
+	// fixed seed, the same offsets in every run
+	srand(1);
+	start = osiUpTimeUS();
+	for (n = 0; n < PERF_BENCH_FS_RANDOM_READS; n++)
+	{
+		long offset = (rand() % (PERF_BENCH_FS_SIZE / 512)) * 512;
+		if (offset > PERF_BENCH_FS_SIZE - PERF_BENCH_FS_CHUNK)
+			offset = PERF_BENCH_FS_SIZE - PERF_BENCH_FS_CHUNK;
+		if (ql_fseek(fd, offset, QL_SEEK_SET) < 0 ||
+			ql_fread(buf, PERF_BENCH_FS_CHUNK, 1, fd) != PERF_BENCH_FS_CHUNK)
+			break;
+	}
+	if (n == PERF_BENCH_FS_RANDOM_READS)
+		perf_bench_add("fs.random_read_4k", perf_bench_ns_per_op(start, PERF_BENCH_FS_RANDOM_READS) / 1000, "us");
+	ql_fclose(fd);
+
+exit_remove:
+	ql_remove(PERF_BENCH_FS_FILE);
+exit:
+	free(buf);
+}
+#endif
+
+/*========================================================================
+ *  network loopback
+ *========================================================================*/
+
+static int perf_bench_socket(int type)
+{
+	struct sockaddr_in addr;
+	int fd = socket(AF_INET, type, 0);
+
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(PERF_BENCH_NET_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int perf_bench_connect(int type)
+{
+	struct sockaddr_in addr;
+	int fd = socket(AF_INET, type, 0);
+
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(PERF_BENCH_NET_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static void perf_bench_tcp_server(void *param)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	uint8_t *buf = malloc(PERF_BENCH_FS_CHUNK);
+	int fd = accept(ctx->server_fd, NULL, NULL);
+
+	if (fd >= 0 && buf != NULL)
+	{
+		int len;
+		while ((len = recv(fd, buf, PERF_BENCH_FS_CHUNK, 0)) > 0)
+			ctx->server_bytes += len;
+	}
+	if (fd >= 0)
+		close(fd);
+	free(buf);
+	ql_rtos_semaphore_release(ctx->pong);
+	ql_rtos_task_delete(NULL);
+}
+
+static void perf_bench_udp_server(void *param)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	uint8_t *buf = malloc(PERF_BENCH_UDP_SIZE);
+	struct timeval tv = {.tv_sec = 1};
+
+	setsockopt(ctx->server_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	ql_rtos_semaphore_release(ctx->ping);
+	while (buf != NULL && ctx->server_packets < PERF_BENCH_UDP_COUNT)
+	{
+		int len = recv(ctx->server_fd, buf, PERF_BENCH_UDP_SIZE, 0);
+		if (len <= 0)
+			break; // timeout, the rest are lost
+		ctx->server_bytes += len;
+		ctx->server_packets++;
+	}
+	free(buf);
+	ql_rtos_semaphore_release(ctx->pong);
+	ql_rtos_task_delete(NULL);
+}
+
+static void perf_bench_net(void)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	uint8_t *buf = malloc(PERF_BENCH_FS_CHUNK);
+	int64_t start;
+	int fd;
+
+	if (buf == NULL ||
+		ql_rtos_semaphore_create(&ctx->ping, 0) != QL_OSI_SUCCESS ||
+		ql_rtos_semaphore_create(&ctx->pong, 0) != QL_OSI_SUCCESS)
+		goto exit;
+	memset(buf, 0x3c, PERF_BENCH_FS_CHUNK);
+
+	// TCP: client sends, server task receives until close
+	ctx->server_bytes = 0;
+	ctx->server_fd = perf_bench_socket(SOCK_STREAM);
+	if (ctx->server_fd >= 0 && listen(ctx->server_fd, 1) == 0 &&
+		ql_rtos_task_create(&ctx->peer, 2048, PERF_BENCH_TASK_PRIO, "perf_tcp", perf_bench_tcp_server, NULL, 1) == QL_OSI_SUCCESS)
+	{
+		fd = perf_bench_connect(SOCK_STREAM);
+		start = osiUpTimeUS();
+		for (uint32_t sent = 0; fd >= 0 && sent < PERF_BENCH_TCP_SIZE;)
+		{
+			int len = send(fd, buf, PERF_BENCH_FS_CHUNK, 0);
+			if (len <= 0)
+				break;
+			sent += len;
+		}
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		else
+		{
+			close(ctx->server_fd); // wake up accept
+			ctx->server_fd = -1;
+		}
+
+		ql_rtos_semaphore_wait(ctx->pong, QL_WAIT_FOREVER);
+		if (ctx->server_bytes >= PERF_BENCH_TCP_SIZE)
+			perf_bench_add("net.tcp_loopback", perf_bench_kbps(start, ctx->server_bytes), "KB/s");
+	}
+	if (ctx->server_fd >= 0)
+		close(ctx->server_fd);
+
+	// UDP: report goodput and loss, loopback can drop on full mailbox
+	ctx->server_bytes = 0;
+	ctx->server_packets = 0;
+	ctx->server_fd = perf_bench_socket(SOCK_DGRAM);
+	if (ctx->server_fd >= 0 &&
+		ql_rtos_task_create(&ctx->peer, 2048, PERF_BENCH_TASK_PRIO, "perf_udp", perf_bench_udp_server, NULL, 1) == QL_OSI_SUCCESS)
+	{
+		ql_rtos_semaphore_wait(ctx->ping, QL_WAIT_FOREVER);
+		fd = perf_bench_connect(SOCK_DGRAM);
+		start = osiUpTimeUS();
+		for (unsigned n = 0; fd >= 0 && n < PERF_BENCH_UDP_COUNT; n++)
+		{
+			if (send(fd, buf, PERF_BENCH_UDP_SIZE, 0) <= 0)
+				ql_rtos_task_sleep_ms(1);
+		}
+		ql_rtos_semaphore_wait(ctx->pong, QL_WAIT_FOREVER);
+		if (fd >= 0)
+		{
+			perf_bench_add("net.udp_loopback", perf_bench_kbps(start, ctx->server_bytes), "KB/s");
+			perf_bench_add("net.udp_loss", (PERF_BENCH_UDP_COUNT - ctx->server_packets) * 100 / PERF_BENCH_UDP_COUNT, "%");
+			close(fd);
+		}
+	}
+	if (ctx->server_fd >= 0)
+		close(ctx->server_fd);
+
+exit:
+	if (ctx->ping != NULL)
+		ql_rtos_semaphore_delete(ctx->ping);
+	if (ctx->pong != NULL)
+		ql_rtos_semaphore_delete(ctx->pong);
+	ctx->ping = ctx->pong = NULL;
+	free(buf);
+}
+
+/*========================================================================
+ *  LCD flush
+ *========================================================================*/
+
+#ifdef QL_APP_FEATURE_LCD
+static void perf_bench_lcd(void)
+{
+	uint16_t *frame = malloc(PERF_BENCH_LCD_WIDTH * PERF_BENCH_LCD_HEIGHT * sizeof(uint16_t));
+	int64_t start;
+	unsigned n;
+
+	if (frame == NULL || ql_lcd_init() != QL_LCD_SUCCESS)
+	{
+		PERF_BENCH_LOG("lcd not available");
+		goto exit;
+	}
+	ql_lcd_display_on();
+
+	start = osiUpTimeUS();
+	for (n = 0; n < PERF_BENCH_LCD_FRAMES; n++)
+	{
+		// different content each frame, so nothing can be skipped
+		for (unsigned i = 0; i < PERF_BENCH_LCD_WIDTH * PERF_BENCH_LCD_HEIGHT; i++)
+			frame[i] = (uint16_t)(i + n * 0x0821);
+		if (ql_lcd_write(frame, 0, 0, PERF_BENCH_LCD_WIDTH - 1, PERF_BENCH_LCD_HEIGHT - 1) != QL_LCD_SUCCESS)
+			break;
+	}
+	if (n == PERF_BENCH_LCD_FRAMES)
+		perf_bench_add("lcd.flush_fps", (uint32_t)(PERF_BENCH_LCD_FRAMES * 1000000LL / (osiUpTimeUS() - start)), "fps");
+
+exit:
+	free(frame);
+}
+#endif
+
+/*========================================================================
+ *  AT round trip
+ *========================================================================*/
+
+#ifdef QL_APP_FEATURE_VIRT_AT
+static char perf_bench_at_rsp[64];
+static unsigned perf_bench_at_len;
+
+static void perf_bench_at_cb(uint32 ind_type, uint32 size)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	unsigned char buf[64];
+
+	if (ind_type != QUEC_VIRT_AT_RX_RECV_DATA_IND)
+		return;
+
+	while (size > 0)
+	{
+		unsigned len = (size < sizeof(buf)) ? size : sizeof(buf);
+		ql_virt_at_read(QL_VIRT_AT_PORT_9, buf, len);
+		size -= len;
+
+		// keep the tail, "OK" may be split
+		for (unsigned i = 0; i < len; i++)
+		{
+			if (perf_bench_at_len >= sizeof(perf_bench_at_rsp) - 1)
+			{
+				memmove(perf_bench_at_rsp, perf_bench_at_rsp + 32, perf_bench_at_len - 32);
+				perf_bench_at_len -= 32;
+			}
+			perf_bench_at_rsp[perf_bench_at_len++] = buf[i];
+		}
+		perf_bench_at_rsp[perf_bench_at_len] = '\0';
+	}
+
+	if (strstr(perf_bench_at_rsp, "OK\r\n") != NULL)
+	{
+		perf_bench_at_len = 0;
+		perf_bench_at_rsp[0] = '\0';
+		ql_rtos_semaphore_release(ctx->pong);
+	}
+}
+
+static void perf_bench_at(void)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	uint32_t max_us = 0;
+	int64_t total_us = 0;
+	unsigned n;
+
+	if (ql_rtos_semaphore_create(&ctx->pong, 0) != QL_OSI_SUCCESS)
+		return;
+	if (ql_virt_at_open(QL_VIRT_AT_PORT_9, perf_bench_at_cb) != QL_VIRT_AT_SUCCESS)
+	{
+		PERF_BENCH_LOG("virt at open failed");
+		goto exit;
+	}
+
+	for (n = 0; n < PERF_BENCH_AT_COUNT; n++)
+	{
+		int64_t start = osiUpTimeUS();
+		ql_virt_at_write(QL_VIRT_AT_PORT_9, (unsigned char *)"AT\r\n", 4);
+		if (ql_rtos_semaphore_wait(ctx->pong, 1000) != QL_OSI_SUCCESS)
+			break;
+
+		uint32_t us = (uint32_t)(osiUpTimeUS() - start);
+		total_us += us;
+		if (us > max_us)
+			max_us = us;
+	}
+	if (n == PERF_BENCH_AT_COUNT)
+	{
+		perf_bench_add("at.roundtrip_avg", (uint32_t)(total_us / PERF_BENCH_AT_COUNT), "us");
+		perf_bench_add("at.roundtrip_max", max_us, "us");
+	}
+	ql_virt_at_close(QL_VIRT_AT_PORT_9);
+
+exit:
+	ql_rtos_semaphore_delete(ctx->pong);
+	ctx->pong = NULL;
+}
+#endif
+
+/*========================================================================
+ *  report
+ *========================================================================*/
+
+static void perf_bench_report(void)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	char *report = malloc(PERF_BENCH_REPORT_SIZE);
+	char fw[64] = "";
+	int len;
+
+	if (report == NULL)
+		return;
+
+	ql_dev_get_firmware_version(fw, sizeof(fw));
+	len = snprintf(report, PERF_BENCH_REPORT_SIZE,
+				   "{\"suite\":\"perf_bench\",\"format\":1,\"fw\":\"%s\",\"results\":[", fw);
+	for (int n = 0; n < ctx->result_num && len < PERF_BENCH_REPORT_SIZE; n++)
+	{
+		perf_bench_result_s *r = &ctx->results[n];
+		len += snprintf(report + len, PERF_BENCH_REPORT_SIZE - len,
+						"%s{\"name\":\"%s\",\"value\":%u,\"unit\":\"%s\"}",
+						(n == 0) ? "" : ",", r->name, (unsigned)r->value, r->unit);
+	}
+	if (len < PERF_BENCH_REPORT_SIZE)
+		len += snprintf(report + len, PERF_BENCH_REPORT_SIZE - len, "]}\n");
+
+	if (len >= PERF_BENCH_REPORT_SIZE)
+	{
+		PERF_BENCH_LOG("report truncated");
+		len = PERF_BENCH_REPORT_SIZE - 1;
+	}
+
+	QFILE fd = ql_fopen(PERF_BENCH_REPORT_FILE, "wb+");
+	if (fd >= 0)
+	{
+		ql_fwrite(report, len, 1, fd);
+		ql_fclose(fd);
+	}
+	PERF_BENCH_LOG("report %s, %d results, fd %d", PERF_BENCH_REPORT_FILE, ctx->result_num, fd);
+	free(report);
+}
+
+static void perf_bench_thread(void *param)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+	int64_t start = osiUpTimeUS();
+
+	ctx->result_num = 0;
+	perf_bench_kernel();
+	perf_bench_mem();
+#ifdef QL_APP_FEATURE_FILE
+	perf_bench_fs();
+#endif
+	perf_bench_net();
+#ifdef QL_APP_FEATURE_LCD
+	perf_bench_lcd();
+#endif
+#ifdef QL_APP_FEATURE_VIRT_AT
+	perf_bench_at();
+#endif
+	perf_bench_report();
+
+	PERF_BENCH_LOG("finished in %d ms", (int)((osiUpTimeUS() - start) / 1000));
+	ql_rtos_task_delete(NULL);
+}
+
+void ql_perf_bench_app_init(void)
+{
+	perf_bench_ctx_s *ctx = &perf_bench_ctx;
+
+	QlOSStatus err = ql_rtos_task_create(&ctx->task, PERF_BENCH_TASK_STACK_SIZE, PERF_BENCH_TASK_PRIO, "perf_bench", perf_bench_thread, NULL, 4);
+	if (err != QL_OSI_SUCCESS)
+	{
+		PERF_BENCH_LOG("perf bench task create failed");
+	}
+}
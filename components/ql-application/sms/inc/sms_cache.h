@@ -0,0 +1,208 @@
+/**  @file
+  sms_cache.h
+
+  @brief
+  This file provides the SMS storage metadata cache and paged list API.
+
+*/
+
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+
+#ifndef SMS_CACHE_H
+#define SMS_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ql_api_sms.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*========================================================================
+ *  Marco Definition
+ *========================================================================*/
+
+/*
+ * Reading a message from SIM takes tens of milliseconds, and listing an
+ * inbox reads every slot. The cache lists the storage once in PDU format,
+ * and keeps the metadata of each slot: status, sender, timestamp, a text
+ * preview and the concatenation reference. UI can list merged messages
+ * by pages from the cache without storage access.
+ *
+ * The cache is kept current by:
+ * - QL_SMS_NEW_MSG_IND: the new index is read at the next query
+ * - sms_cache_read_msg/sms_cache_delete_msg: wrappers of ql_sms_read_msg
+ *   and ql_sms_delete_msg, to update status and remove slots
+ * - SIM change: ICCID is checked at the first page, and the cache is
+ *   reloaded when changed
+ *
+ * The storage is the one selected by ql_sms_set_storage as mem1, and new
+ * messages are expected in the same storage. Call sms_cache_invalidate
+ * after the storage is changed, or the storage is changed by others such
+ * as AT commands.
+ */
+
+#define SMS_CACHE_ADDR_LEN            24    // sender buffer size, including '\0'
+#define SMS_CACHE_PREVIEW_LEN         48    // UTF-8 preview buffer size, including '\0'
+#define SMS_CACHE_MAX_SLOTS           255   // index is uint8_t in ql_sms APIs
+
+/*========================================================================
+ *  Struct Definition
+ *========================================================================*/
+
+typedef struct
+{
+	uint8_t year;     // years since 2000
+	uint8_t month;
+	uint8_t day;
+	uint8_t hour;
+	uint8_t minute;
+	uint8_t second;
+	int8_t  tz;       // time zone in quarter hours
+} sms_cache_time_s;
+
+/*
+ * One message of the list. Parts of a concatenated message are merged
+ * into one item.
+ */
+typedef struct
+{
+	uint8_t index;                          // index of the first present part
+	uint8_t status;                         // ql_sms_status_e, QL_SMS_UNREAD when any part is unread
+	uint8_t parts;                          // count of present parts
+	uint8_t total;                          // count of expected parts, 1 for single message
+	sms_cache_time_s time;                  // service center time stamp of the first present part
+	char sender[SMS_CACHE_ADDR_LEN];        // sender or recipient
+	char preview[SMS_CACHE_PREVIEW_LEN];    // UTF-8 text head of the first present part
+} sms_cache_item_s;
+
+typedef struct
+{
+	uint16_t used;        // used slots
+	uint16_t total;       // total slots of the storage, 0 when unknown
+	uint16_t unread;      // unread slots
+	uint16_t messages;    // merged messages
+} sms_cache_count_s;
+
+/*========================================================================
+ *  function Definition
+ *========================================================================*/
+
+/*****************************************************************
+* Function: sms_cache_init
+*
+* Description:
+* 	Initialize the cache, and register SMS callback. Events are forwarded
+* 	to user_cb, except list events of the cache itself.
+* 	ql_sms_callback_register shouldn't be called after this.
+*
+* Parameters:
+* 	user_cb       [in]  user SMS callback, can be NULL
+*
+* Return:ql_sms_errcode_e
+*
+*****************************************************************/
+ql_sms_errcode_e sms_cache_init(ql_sms_event_handler_t user_cb);
+
+/*****************************************************************
+* Function: sms_cache_invalidate
+*
+* Description:
+* 	Drop the cache. It will be loaded again at the next query.
+* 	It can be called in any task.
+*
+*****************************************************************/
+void sms_cache_invalidate(void);
+
+/*****************************************************************
+* Function: sms_cache_list
+*
+* Description:
+* 	Get a page of merged messages, newest first. The cache is loaded or
+* 	updated when needed, so the first call can be slow. It should be
+* 	called after SMS init, and not in SMS callback.
+*
+* Parameters:
+* 	status        [in]  QL_SMS_ALL, or only messages in this status
+* 	offset        [in]  first item of the page
+* 	items         [out] page items
+* 	count         [in]  maximum items of the page
+* 	total         [out] total items in this status, can be NULL
+*
+* Return:
+* 	count of items filled, negative on error
+*
+*****************************************************************/
+int sms_cache_list(ql_sms_status_e status, uint16_t offset, sms_cache_item_s *items, uint16_t count, uint16_t *total);
+
+/*****************************************************************
+* Function: sms_cache_get_parts
+*
+* Description:
+* 	Get storage indexes of all present parts of a merged message, in
+* 	part order. They can be used to read or delete the whole message.
+*
+* Parameters:
+* 	index         [in]  index of any part
+* 	indexes       [out] storage indexes
+* 	max           [in]  size of indexes
+*
+* Return:
+* 	count of parts, 0 when index is not in cache
+*
+*****************************************************************/
+int sms_cache_get_parts(uint8_t index, uint8_t *indexes, uint8_t max);
+
+/*****************************************************************
+* Function: sms_cache_get_count
+*
+* Description:
+* 	Get slot counts from the cache, loaded when needed.
+*
+* Parameters:
+* 	count         [out] slot counts
+*
+* Return:ql_sms_errcode_e
+*
+*****************************************************************/
+ql_sms_errcode_e sms_cache_get_count(sms_cache_count_s *count);
+
+/*****************************************************************
+* Function: sms_cache_read_msg
+*
+* Description:
+* 	ql_sms_read_msg, and the cached status of an unread message is
+* 	changed to read.
+*
+*****************************************************************/
+ql_sms_errcode_e sms_cache_read_msg(uint8_t index, char *buf, uint16_t buf_len, ql_sms_format_e format);
+
+/*****************************************************************
+* Function: sms_cache_delete_msg
+*
+* Description:
+* 	ql_sms_delete_msg, and the slot is removed from the cache.
+*
+*****************************************************************/
+ql_sms_errcode_e sms_cache_delete_msg(uint8_t index);
+
+#ifdef __cplusplus
+} /*"C" */
+#endif
+
+#endif /* SMS_CACHE_H */
@@ -0,0 +1,841 @@
+/*================================================================
+  Copyright (c) 2020 Quectel Wireless Solution, Co., Ltd.  All Rights Reserved.
+  Quectel Wireless Solution Proprietary and Confidential.
+=================================================================*/
+/*=================================================================
+
+                        EDIT HISTORY FOR MODULE
+
+This section contains comments describing changes made to the module.
+Notice that changes are listed in reverse chronological order.
+
+WHEN              WHO         WHAT, WHERE, WHY
+------------     -------     -------------------------------------------------------------------------------
+
+=================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "ql_api_common.h"
+#include "ql_api_osi.h"
+#include "ql_api_sms.h"
+#include "ql_api_sim.h"
+#include "ql_log.h"
+#include "sms_cache.h"
+
+#define SMS_CACHE_LIST_TIMEOUT        30000 // ms, list of a full SIM storage
+#define SMS_CACHE_PDU_MAX             180   // SCA and TPDU octets
+#define SMS_CACHE_READ_BUF_LEN        512   // buffer of PDU read
+#define SMS_CACHE_ICCID_LEN           24
+
+typedef struct
+{
+	uint8_t index;
+	uint8_t status;                         // ql_sms_status_e
+	uint8_t total;                          // concatenated parts, 0 or 1 for single message
+	uint8_t seq;                            // part number, from 1
+	uint16_t ref;                           // concatenation reference
+	sms_cache_time_s time;
+	char sender[SMS_CACHE_ADDR_LEN];
+	char preview[SMS_CACHE_PREVIEW_LEN];
+} sms_cache_slot_s;
+
+// merged message, members are order[start, start + parts)
+typedef struct
+{
+	uint8_t start;
+	uint8_t parts;
+	uint8_t status;
+	uint8_t total;
+} sms_cache_group_s;
+
+typedef struct
+{
+	ql_mutex_t lock;                        // protect the cache, except list indications in loading
+	ql_sem_t list_sem;                      // list end of loading
+	ql_sms_event_handler_t user_cb;
+	volatile bool valid;                    // cache is loaded, cleared by invalidate
+	volatile bool listing;                  // list is started by cache
+	bool dirty;                             // groups should be rebuilt
+	uint16_t total_slots;
+	uint16_t slot_count;
+	uint16_t group_count;
+	uint32_t pending[(SMS_CACHE_MAX_SLOTS + 32) / 32]; // new message indexes, not read
+	char iccid[SMS_CACHE_ICCID_LEN];
+	sms_cache_slot_s *slots[SMS_CACHE_MAX_SLOTS + 1]; // indexed by storage index
+	uint8_t order[SMS_CACHE_MAX_SLOTS + 1];   // storage indexes, members of groups are adjacent
+	sms_cache_group_s groups[SMS_CACHE_MAX_SLOTS + 1]; // newest first
+} sms_cache_ctx_s;
+
+static sms_cache_ctx_s sms_cache;
+
+/*========================================================================
+ *  PDU decoding
+ *========================================================================*/
+
+// GSM 7 bit default alphabet, 3GPP TS 23.038
+static const uint16_t sms_gsm7_ucs[128] = {
+	0x0040, 0x00a3, 0x0024, 0x00a5, 0x00e8, 0x00e9, 0x00f9, 0x00ec,
+	0x00f2, 0x00c7, 0x000a, 0x00d8, 0x00f8, 0x000d, 0x00c5, 0x00e5,
+	0x0394, 0x005f, 0x03a6, 0x0393, 0x039b, 0x03a9, 0x03a0, 0x03a8,
+	0x03a3, 0x0398, 0x039e, 0x001b, 0x00c6, 0x00e6, 0x00df, 0x00c9,
+	0x0020, 0x0021, 0x0022, 0x0023, 0x00a4, 0x0025, 0x0026, 0x0027,
+	0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+	0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+	0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+	0x00a1, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+	0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+	0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+	0x0058, 0x0059, 0x005a, 0x00c4, 0x00d6, 0x00d1, 0x00dc, 0x00a7,
+	0x00bf, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067,
+	0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+	0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077,
+	0x0078, 0x0079, 0x007a, 0x00e4, 0x00f6, 0x00f1, 0x00fc, 0x00e0,
+};
+
+static uint16_t sms_gsm7_ext_ucs(uint8_t c)
+{
+	switch(c)
+	{
+		case 0x0a: return 0x000c;
+		case 0x14: return '^';
+		case 0x28: return '{';
+		case 0x29: return '}';
+		case 0x2f: return '\\';
+		case 0x3c: return '[';
+		case 0x3d: return '~';
+		case 0x3e: return ']';
+		case 0x40: return '|';
+		case 0x65: return 0x20ac;
+		default: return ' ';
+	}
+}
+
+// output writer of UTF-8, truncated at character boundary
+typedef struct
+{
+	char *buf;
+	unsigned size;
+	unsigned len;
+	bool full;
+} sms_utf8_writer_s;
+
+static void sms_utf8_put(sms_utf8_writer_s *w, uint32_t ucs)
+{
+	char tmp[4];
+	unsigned n;
+
+	if(w->full)
+		return;
+
+	// preview is one line
+	if(ucs == '\r' || ucs == '\n' || ucs == 0x0c)
+		ucs = ' ';
+
+	if(ucs < 0x80){
+		tmp[0] = (char)ucs;
+		n = 1;
+	}else if(ucs < 0x800){
+		tmp[0] = (char)(0xc0 | (ucs >> 6));
+		tmp[1] = (char)(0x80 | (ucs & 0x3f));
+		n = 2;
+	}else if(ucs < 0x10000){
+		tmp[0] = (char)(0xe0 | (ucs >> 12));
+		tmp[1] = (char)(0x80 | ((ucs >> 6) & 0x3f));
+		tmp[2] = (char)(0x80 | (ucs & 0x3f));
+		n = 3;
+	}else{
+		tmp[0] = (char)(0xf0 | (ucs >> 18));
+		tmp[1] = (char)(0x80 | ((ucs >> 12) & 0x3f));
+		tmp[2] = (char)(0x80 | ((ucs >> 6) & 0x3f));
+		tmp[3] = (char)(0x80 | (ucs & 0x3f));
+		n = 4;
+	}
+
+	if(w->len + n >= w->size){
+		w->full = true;
+		return;
+	}
+	memcpy(w->buf + w->len, tmp, n);
+	w->len += n;
+	w->buf[w->len] = '\0';
+}
+
+static uint8_t sms_septet_get(const uint8_t *data, unsigned data_len, unsigned n)
+{
+	unsigned bit = n * 7;
+	unsigned byte = bit / 8;
+	unsigned shift = bit % 8;
+	unsigned v = (byte < data_len) ? (data[byte] >> shift) : 0;
+	if(shift > 1 && byte + 1 < data_len)
+		v |= data[byte + 1] << (8 - shift);
+	return v & 0x7f;
+}
+
+// decode septets [start, start + count) of GSM 7 bit packed data
+static void sms_gsm7_decode(sms_utf8_writer_s *w, const uint8_t *data, unsigned data_len, unsigned start, unsigned count)
+{
+	bool esc = false;
+	for(unsigned n = start; n < start + count && (n * 7) / 8 < data_len && !w->full; n++)
+	{
+		uint8_t c = sms_septet_get(data, data_len, n);
+		if(esc){
+			sms_utf8_put(w, sms_gsm7_ext_ucs(c));
+			esc = false;
+		}else if(c == 0x1b){
+			esc = true;
+		}else{
+			sms_utf8_put(w, sms_gsm7_ucs[c]);
+		}
+	}
+}
+
+static void sms_ucs2_decode(sms_utf8_writer_s *w, const uint8_t *data, unsigned len)
+{
+	for(unsigned n = 0; n + 1 < len && !w->full; n += 2)
+	{
+		uint32_t ucs = (data[n] << 8) | data[n + 1];
+		if(ucs >= 0xd800 && ucs < 0xdc00 && n + 3 < len){
+			uint32_t lo = (data[n + 2] << 8) | data[n + 3];
+			if(lo >= 0xdc00 && lo < 0xe000){
+				ucs = 0x10000 + ((ucs - 0xd800) << 10) + (lo - 0xdc00);
+				n += 2;
+			}
+		}
+		sms_utf8_put(w, ucs);
+	}
+}
+
+static int sms_hex_value(char c)
+{
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+/*
+ * PDU string may be prefixed with a +CMGL/+CMGR header line, and the
+ * PDU is the last line.
+ */
+static unsigned sms_pdu_from_hex(const char *str, uint8_t *pdu, unsigned size)
+{
+	const char *p = strrchr(str, '\n');
+	p = (p == NULL) ? str : p + 1;
+
+	unsigned len = 0;
+	while(len < size)
+	{
+		int hi = sms_hex_value(p[0]);
+		int lo = (hi < 0) ? -1 : sms_hex_value(p[1]);
+		if(lo < 0)
+			break;
+		pdu[len++] = (uint8_t)((hi << 4) | lo);
+		p += 2;
+	}
+	return len;
+}
+
+static uint8_t sms_bcd_swap(uint8_t b)
+{
+	return (b & 0x0f) * 10 + (b >> 4);
+}
+
+// address field at pdu[*pos], pos is updated
+static bool sms_pdu_address(const uint8_t *pdu, unsigned len, unsigned *pos, char *out, unsigned size)
+{
+	unsigned p = *pos;
+	if(p + 2 > len)
+		return false;
+
+	unsigned digits = pdu[p];
+	uint8_t toa = pdu[p + 1];
+	unsigned octets = (digits + 1) / 2;
+	p += 2;
+	if(p + octets > len)
+		return false;
+
+	out[0] = '\0';
+	if((toa & 0x70) == 0x50){
+		// alphanumeric, GSM 7 bit packed
+		sms_utf8_writer_s w = {out, size, 0, false};
+		sms_gsm7_decode(&w, &pdu[p], octets, 0, digits * 4 / 7);
+	}else{
+		static const char bcd[] = "0123456789*#abc";
+		unsigned n = 0;
+		if((toa & 0x70) == 0x10 && n + 1 < size)
+			out[n++] = '+';
+		for(unsigned i = 0; i < digits && n + 1 < size; i++)
+		{
+			uint8_t d = (i & 1) ? (pdu[p + i / 2] >> 4) : (pdu[p + i / 2] & 0x0f);
+			if(d == 0x0f)
+				break;
+			out[n++] = bcd[d];
+		}
+		out[n] = '\0';
+	}
+
+	*pos = p + octets;
+	return true;
+}
+
+// 0: GSM 7 bit, 1: 8 bit data, 2: UCS2
+static unsigned sms_dcs_alphabet(uint8_t dcs)
+{
+	if((dcs & 0x80) == 0x00)
+		return ((dcs >> 2) & 3) == 3 ? 0 : (dcs >> 2) & 3;
+	if((dcs & 0xf0) == 0xf0)
+		return (dcs & 0x04) ? 1 : 0;
+	if((dcs & 0xf0) == 0xe0)
+		return 2;
+	return 0;
+}
+
+/*
+ * Parse SMS-DELIVER or SMS-SUBMIT PDU with SCA. Only metadata and the
+ * preview are kept.
+ */
+static bool sms_pdu_parse(const char *str, sms_cache_slot_s *slot)
+{
+	uint8_t pdu[SMS_CACHE_PDU_MAX];
+	unsigned len = sms_pdu_from_hex(str, pdu, sizeof(pdu));
+	if(len < 1 || len < 2u + pdu[0])
+		return false;
+
+	unsigned p = 1 + pdu[0];
+	uint8_t fo = pdu[p++];
+	uint8_t mti = fo & 0x03;
+	memset(&slot->time, 0, sizeof(slot->time));
+
+	if(mti == 0){
+		// SMS-DELIVER
+		if(!sms_pdu_address(pdu, len, &p, slot->sender, sizeof(slot->sender)))
+			return false;
+	}else if(mti == 1){
+		// SMS-SUBMIT: MR, DA
+		p++;
+		if(!sms_pdu_address(pdu, len, &p, slot->sender, sizeof(slot->sender)))
+			return false;
+	}else{
+		return false;
+	}
+
+	if(p + 2 > len)
+		return false;
+	uint8_t dcs = pdu[p + 1];
+	p += 2;
+
+	if(mti == 0){
+		if(p + 7 > len)
+			return false;
+		slot->time.year = sms_bcd_swap(pdu[p]);
+		slot->time.month = sms_bcd_swap(pdu[p + 1]);
+		slot->time.day = sms_bcd_swap(pdu[p + 2]);
+		slot->time.hour = sms_bcd_swap(pdu[p + 3]);
+		slot->time.minute = sms_bcd_swap(pdu[p + 4]);
+		slot->time.second = sms_bcd_swap(pdu[p + 5]);
+		slot->time.tz = (int8_t)sms_bcd_swap(pdu[p + 6] & 0xf7);
+		if(pdu[p + 6] & 0x08)
+			slot->time.tz = -slot->time.tz;
+		p += 7;
+	}else{
+		// validity period format
+		unsigned vpf = (fo >> 3) & 0x03;
+		p += (vpf == 2) ? 1 : (vpf == 0) ? 0 : 7;
+	}
+
+	if(p + 1 > len)
+		return false;
+	unsigned udl = pdu[p++];
+	const uint8_t *ud = &pdu[p];
+	unsigned ud_len = len - p;
+
+	slot->total = 0;
+	slot->seq = 0;
+	slot->ref = 0;
+
+	unsigned hdr_len = 0;
+	if((fo & 0x40) && ud_len > 0){
+		hdr_len = ud[0] + 1;
+		for(unsigned i = 1; i + 1 < hdr_len && i + 1 < ud_len;)
+		{
+			uint8_t iei = ud[i];
+			uint8_t iel = ud[i + 1];
+			const uint8_t *ie = &ud[i + 2];
+			if(i + 2 + iel > ud_len)
+				break;
+			if(iei == 0x00 && iel == 3){
+				slot->ref = ie[0];
+				slot->total = ie[1];
+				slot->seq = ie[2];
+			}else if(iei == 0x08 && iel == 4){
+				slot->ref = (ie[0] << 8) | ie[1];
+				slot->total = ie[2];
+				slot->seq = ie[3];
+			}
+			i += 2 + iel;
+		}
+		if(hdr_len > ud_len)
+			hdr_len = ud_len;
+	}
+
+	slot->preview[0] = '\0';
+	sms_utf8_writer_s w = {slot->preview, sizeof(slot->preview), 0, false};
+	unsigned alphabet = sms_dcs_alphabet(dcs);
+	if(alphabet == 0){
+		// header is padded to septet boundary
+		unsigned hdr_septets = (hdr_len * 8 + 6) / 7;
+		if(udl > hdr_septets)
+			sms_gsm7_decode(&w, ud, ud_len, hdr_septets, udl - hdr_septets);
+	}else if(alphabet == 2){
+		unsigned n = (udl < ud_len) ? udl : ud_len;
+		if(n > hdr_len)
+			sms_ucs2_decode(&w, ud + hdr_len, n - hdr_len);
+	}
+	return true;
+}
+
+/*========================================================================
+ *  Cache
+ *========================================================================*/
+
+static void sms_cache_put_slot(uint8_t index, uint8_t status, const char *pdu)
+{
+	sms_cache_slot_s *slot = sms_cache.slots[index];
+	bool is_new = (slot == NULL);
+	if(is_new){
+		slot = (sms_cache_slot_s *)malloc(sizeof(sms_cache_slot_s));
+		if(slot == NULL)
+			return;
+	}
+
+	if(!sms_pdu_parse(pdu, slot)){
+		QL_SMS_LOG("sms cache: index %d parse fail", index);
+		if(is_new)
+			free(slot);
+		return;
+	}
+
+	slot->index = index;
+	slot->status = status;
+	if(is_new){
+		sms_cache.slots[index] = slot;
+		sms_cache.slot_count++;
+	}
+	sms_cache.dirty = true;
+}
+
+static void sms_cache_remove_slot(uint8_t index)
+{
+	if(sms_cache.slots[index] == NULL)
+		return;
+
+	free(sms_cache.slots[index]);
+	sms_cache.slots[index] = NULL;
+	sms_cache.slot_count--;
+	sms_cache.dirty = true;
+}
+
+static void sms_cache_clear(void)
+{
+	for(unsigned n = 0; n <= SMS_CACHE_MAX_SLOTS; n++)
+	{
+		free(sms_cache.slots[n]);
+		sms_cache.slots[n] = NULL;
+	}
+	sms_cache.slot_count = 0;
+	sms_cache.group_count = 0;
+	sms_cache.dirty = true;
+}
+
+static void sms_cache_get_iccid(char *iccid)
+{
+	memset(iccid, 0, SMS_CACHE_ICCID_LEN);
+	if(ql_sim_get_iccid(0, iccid, SMS_CACHE_ICCID_LEN) != QL_SIM_SUCCESS)
+		iccid[0] = '\0';
+}
+
+/*
+ * List the whole storage in PDU format, called with lock. List
+ * indications are handled in SMS callback, while this is waiting.
+ */
+static ql_sms_errcode_e sms_cache_load(void)
+{
+	sms_cache_clear();
+
+	uint32_t critical = ql_rtos_enter_critical();
+	memset(sms_cache.pending, 0, sizeof(sms_cache.pending));
+	sms_cache.valid = true;
+	ql_rtos_exit_critical(critical);
+
+	sms_cache_get_iccid(sms_cache.iccid);
+
+	ql_sms_stor_info_s stor_info;
+	sms_cache.total_slots = 0;
+	if(ql_sms_get_storage_info(&stor_info) == QL_SMS_SUCCESS)
+		sms_cache.total_slots = (stor_info.newSmsStorId == ME) ? stor_info.totalSlotME : stor_info.totalSlotSM;
+
+	// drop stale list end
+	while(ql_rtos_semaphore_wait(sms_cache.list_sem, QL_NO_WAIT) == QL_OSI_SUCCESS)
+		;
+
+	sms_cache.listing = true;
+	ql_sms_errcode_e err = ql_sms_read_msg_list(PDU);
+	if(err == QL_SMS_SUCCESS && ql_rtos_semaphore_wait(sms_cache.list_sem, SMS_CACHE_LIST_TIMEOUT) != QL_OSI_SUCCESS)
+		err = QL_SMS_SEM_TIMEOUT_ERR;
+	sms_cache.listing = false;
+
+	if(err != QL_SMS_SUCCESS){
+		QL_SMS_LOG("sms cache: load fail 0x%x", err);
+		sms_cache.valid = false;
+		return err;
+	}
+
+	QL_SMS_LOG("sms cache: loaded %d/%d", sms_cache.slot_count, sms_cache.total_slots);
+	return QL_SMS_SUCCESS;
+}
+
+/*
+ * Read new messages indicated after load, called with lock. New
+ * messages are unread, though reading them may change the storage
+ * status.
+ */
+static void sms_cache_read_pending(void)
+{
+	char *buf = NULL;
+
+	for(unsigned n = 0; n <= SMS_CACHE_MAX_SLOTS; n++)
+	{
+		uint32_t mask = 1u << (n % 32);
+		uint32_t critical = ql_rtos_enter_critical();
+		bool pending = (sms_cache.pending[n / 32] & mask) != 0;
+		sms_cache.pending[n / 32] &= ~mask;
+		ql_rtos_exit_critical(critical);
+		if(!pending)
+			continue;
+
+		if(buf == NULL && (buf = (char *)malloc(SMS_CACHE_READ_BUF_LEN)) == NULL)
+		{
+			// read at next query
+			sms_cache.valid = false;
+			return;
+		}
+
+		memset(buf, 0, SMS_CACHE_READ_BUF_LEN);
+		if(ql_sms_read_msg((uint8_t)n, buf, SMS_CACHE_READ_BUF_LEN, PDU) == QL_SMS_SUCCESS)
+			sms_cache_put_slot((uint8_t)n, QL_SMS_UNREAD, buf);
+	}
+	free(buf);
+}
+
+/*
+ * Load or update the cache, called with lock. ICCID is checked only when
+ * check_sim is true, at the first page of list.
+ */
+static ql_sms_errcode_e sms_cache_update(bool check_sim)
+{
+	if(sms_cache.valid && check_sim){
+		char iccid[SMS_CACHE_ICCID_LEN];
+		sms_cache_get_iccid(iccid);
+		if(strcmp(iccid, sms_cache.iccid) != 0){
+			QL_SMS_LOG("sms cache: SIM changed");
+			sms_cache.valid = false;
+		}
+	}
+
+	if(!sms_cache.valid){
+		ql_sms_errcode_e err = sms_cache_load();
+		if(err != QL_SMS_SUCCESS)
+			return err;
+	}
+
+	sms_cache_read_pending();
+	return QL_SMS_SUCCESS;
+}
+
+static bool sms_slot_is_concat(const sms_cache_slot_s *s)
+{
+	return s->total > 1;
+}
+
+// parts of the same message are adjacent, in part order
+static int sms_part_compare(const void *a, const void *b)
+{
+	const sms_cache_slot_s *sa = sms_cache.slots[*(const uint8_t *)a];
+	const sms_cache_slot_s *sb = sms_cache.slots[*(const uint8_t *)b];
+
+	if(sms_slot_is_concat(sa) != sms_slot_is_concat(sb))
+		return sms_slot_is_concat(sa) ? 1 : -1;
+	if(sms_slot_is_concat(sa)){
+		int r = strcmp(sa->sender, sb->sender);
+		if(r != 0)
+			return r;
+		if(sa->ref != sb->ref)
+			return (sa->ref < sb->ref) ? -1 : 1;
+		if(sa->total != sb->total)
+			return (sa->total < sb->total) ? -1 : 1;
+		if(sa->seq != sb->seq)
+			return (sa->seq < sb->seq) ? -1 : 1;
+	}
+	return (sa->index < sb->index) ? -1 : (sa->index > sb->index);
+}
+
+static bool sms_part_same_message(const sms_cache_slot_s *sa, const sms_cache_slot_s *sb)
+{
+	return sms_slot_is_concat(sa) && sms_slot_is_concat(sb) &&
+		sa->ref == sb->ref && sa->total == sb->total &&
+		strcmp(sa->sender, sb->sender) == 0;
+}
+
+static uint64_t sms_time_key(const sms_cache_time_s *t)
+{
+	return ((uint64_t)t->year << 40) | ((uint64_t)t->month << 32) | ((uint32_t)t->day << 24) |
+		((uint32_t)t->hour << 16) | ((uint32_t)t->minute << 8) | t->second;
+}
+
+// newest first, and larger index first for the same time
+static int sms_group_compare(const void *a, const void *b)
+{
+	const sms_cache_slot_s *sa = sms_cache.slots[sms_cache.order[((const sms_cache_group_s *)a)->start]];
+	const sms_cache_slot_s *sb = sms_cache.slots[sms_cache.order[((const sms_cache_group_s *)b)->start]];
+	uint64_t ta = sms_time_key(&sa->time);
+	uint64_t tb = sms_time_key(&sb->time);
+
+	if(ta != tb)
+		return (ta > tb) ? -1 : 1;
+	return (sa->index > sb->index) ? -1 : (sa->index < sb->index);
+}
+
+static void sms_cache_rebuild(void)
+{
+	if(!sms_cache.dirty)
+		return;
+
+	unsigned count = 0;
+	for(unsigned n = 0; n <= SMS_CACHE_MAX_SLOTS; n++)
+	{
+		if(sms_cache.slots[n] != NULL)
+			sms_cache.order[count++] = (uint8_t)n;
+	}
+	qsort(sms_cache.order, count, sizeof(uint8_t), sms_part_compare);
+
+	unsigned groups = 0;
+	for(unsigned n = 0; n < count; n++)
+	{
+		const sms_cache_slot_s *s = sms_cache.slots[sms_cache.order[n]];
+		sms_cache_group_s *g = (groups > 0) ? &sms_cache.groups[groups - 1] : NULL;
+		if(g != NULL && sms_part_same_message(sms_cache.slots[sms_cache.order[g->start]], s)){
+			g->parts++;
+			if(s->status == QL_SMS_UNREAD)
+				g->status = QL_SMS_UNREAD;
+			continue;
+		}
+
+		g = &sms_cache.groups[groups++];
+		g->start = (uint8_t)n;
+		g->parts = 1;
+		g->status = s->status;
+		g->total = sms_slot_is_concat(s) ? s->total : 1;
+	}
+	qsort(sms_cache.groups, groups, sizeof(sms_cache_group_s), sms_group_compare);
+
+	sms_cache.group_count = groups;
+	sms_cache.dirty = false;
+}
+
+static bool sms_status_match(ql_sms_status_e status, uint8_t s)
+{
+	return status == QL_SMS_ALL || status == s;
+}
+
+/*========================================================================
+ *  SMS callback
+ *========================================================================*/
+
+static void sms_cache_event_callback(int event_id, void *ctx)
+{
+	switch(event_id)
+	{
+		case QL_SMS_INIT_OK_IND:
+			// storage may be changed, such as SIM hot plug
+			sms_cache.valid = false;
+			break;
+		case QL_SMS_NEW_MSG_IND:
+		{
+			uint16_t index = *(uint16_t *)ctx;
+			if(index <= SMS_CACHE_MAX_SLOTS){
+				uint32_t critical = ql_rtos_enter_critical();
+				sms_cache.pending[index / 32] |= 1u << (index % 32);
+				ql_rtos_exit_critical(critical);
+			}
+			break;
+		}
+		case QL_SMS_LIST_IND:
+			if(sms_cache.listing){
+				ql_sms_msg_s *msg = (ql_sms_msg_s *)ctx;
+				if(msg != NULL && msg->buf != NULL)
+					sms_cache_put_slot(msg->index, msg->status, msg->buf);
+				return;
+			}
+			break;
+		case QL_SMS_LIST_END_IND:
+			if(sms_cache.listing){
+				ql_rtos_semaphore_release(sms_cache.list_sem);
+				return;
+			}
+			break;
+		default:
+			break;
+	}
+
+	if(sms_cache.user_cb != NULL)
+		sms_cache.user_cb(event_id, ctx);
+}
+
+/*========================================================================
+ *  API
+ *========================================================================*/
+
+ql_sms_errcode_e sms_cache_init(ql_sms_event_handler_t user_cb)
+{
+	if(sms_cache.lock == NULL){
+		if(ql_rtos_mutex_create(&sms_cache.lock) != QL_OSI_SUCCESS)
+			return QL_SMS_NO_MEMORY_ERR;
+		if(ql_rtos_semaphore_create(&sms_cache.list_sem, 0) != QL_OSI_SUCCESS)
+			return QL_SMS_SEM_CREATE_ERR;
+	}
+
+	sms_cache.user_cb = user_cb;
+	sms_cache.valid = false;
+	ql_sms_callback_register(sms_cache_event_callback);
+	return QL_SMS_SUCCESS;
+}
+
+void sms_cache_invalidate(void)
+{
+	sms_cache.valid = false;
+}
+
+int sms_cache_list(ql_sms_status_e status, uint16_t offset, sms_cache_item_s *items, uint16_t count, uint16_t *total)
+{
+	if(sms_cache.lock == NULL)
+		return -QL_SMS_NOT_INIT_ERR;
+	if(items == NULL && count > 0)
+		return -QL_SMS_PARA_ERR;
+
+	ql_rtos_mutex_lock(sms_cache.lock, QL_WAIT_FOREVER);
+	ql_sms_errcode_e err = sms_cache_update(offset == 0);
+	if(err != QL_SMS_SUCCESS){
+		ql_rtos_mutex_unlock(sms_cache.lock);
+		return -err;
+	}
+	sms_cache_rebuild();
+
+	unsigned matched = 0;
+	unsigned filled = 0;
+	for(unsigned n = 0; n < sms_cache.group_count; n++)
+	{
+		const sms_cache_group_s *g = &sms_cache.groups[n];
+		if(!sms_status_match(status, g->status))
+			continue;
+
+		if(matched++ < offset || filled >= count)
+			continue;
+
+		const sms_cache_slot_s *s = sms_cache.slots[sms_cache.order[g->start]];
+		sms_cache_item_s *item = &items[filled++];
+		item->index = s->index;
+		item->status = g->status;
+		item->parts = g->parts;
+		item->total = g->total;
+		item->time = s->time;
+		memcpy(item->sender, s->sender, sizeof(item->sender));
+		memcpy(item->preview, s->preview, sizeof(item->preview));
+	}
+	ql_rtos_mutex_unlock(sms_cache.lock);
+
+	if(total != NULL)
+		*total = (uint16_t)matched;
+	return (int)filled;
+}
+
+int sms_cache_get_parts(uint8_t index, uint8_t *indexes, uint8_t max)
+{
+	if(sms_cache.lock == NULL || indexes == NULL)
+		return 0;
+
+	int count = 0;
+	ql_rtos_mutex_lock(sms_cache.lock, QL_WAIT_FOREVER);
+	if(sms_cache_update(false) == QL_SMS_SUCCESS){
+		sms_cache_rebuild();
+		for(unsigned n = 0; n < sms_cache.group_count && count == 0; n++)
+		{
+			const sms_cache_group_s *g = &sms_cache.groups[n];
+			for(unsigned i = 0; i < g->parts; i++)
+			{
+				if(sms_cache.order[g->start + i] != index)
+					continue;
+
+				for(unsigned j = 0; j < g->parts && j < max; j++)
+					indexes[count++] = sms_cache.order[g->start + j];
+				break;
+			}
+		}
+	}
+	ql_rtos_mutex_unlock(sms_cache.lock);
+	return count;
+}
+
+ql_sms_errcode_e sms_cache_get_count(sms_cache_count_s *count)
+{
+	if(sms_cache.lock == NULL)
+		return QL_SMS_NOT_INIT_ERR;
+	if(count == NULL)
+		return QL_SMS_PARA_ERR;
+
+	ql_rtos_mutex_lock(sms_cache.lock, QL_WAIT_FOREVER);
+	ql_sms_errcode_e err = sms_cache_update(false);
+	if(err == QL_SMS_SUCCESS){
+		sms_cache_rebuild();
+		count->used = sms_cache.slot_count;
+		count->total = sms_cache.total_slots;
+		count->messages = sms_cache.group_count;
+		count->unread = 0;
+		for(unsigned n = 0; n <= SMS_CACHE_MAX_SLOTS; n++)
+		{
+			if(sms_cache.slots[n] != NULL && sms_cache.slots[n]->status == QL_SMS_UNREAD)
+				count->unread++;
+		}
+	}
+	ql_rtos_mutex_unlock(sms_cache.lock);
+	return err;
+}
+
+ql_sms_errcode_e sms_cache_read_msg(uint8_t index, char *buf, uint16_t buf_len, ql_sms_format_e format)
+{
+	ql_sms_errcode_e err = ql_sms_read_msg(index, buf, buf_len, format);
+	if(err != QL_SMS_SUCCESS || sms_cache.lock == NULL)
+		return err;
+
+	ql_rtos_mutex_lock(sms_cache.lock, QL_WAIT_FOREVER);
+	sms_cache_slot_s *slot = sms_cache.slots[index];
+	if(slot != NULL && slot->status == QL_SMS_UNREAD){
+		slot->status = QL_SMS_READ;
+		sms_cache.dirty = true;
+	}
+	ql_rtos_mutex_unlock(sms_cache.lock);
+	return err;
+}
+
+ql_sms_errcode_e sms_cache_delete_msg(uint8_t index)
+{
+	ql_sms_errcode_e err = ql_sms_delete_msg(index);
+	if(err != QL_SMS_SUCCESS || sms_cache.lock == NULL)
+		return err;
+
+	ql_rtos_mutex_lock(sms_cache.lock, QL_WAIT_FOREVER);
+	sms_cache_remove_slot(index);
+	ql_rtos_mutex_unlock(sms_cache.lock);
+	return err;
+}
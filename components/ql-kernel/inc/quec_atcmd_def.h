@@ -474,6 +474,11 @@ O0,			    atCmdHandleO,					0
 #endif /*CONFIG_QUEC_PROJECT_FEATURE_GNSS_AT*/
 #endif
 
+//********************** LVGL at cmd ***********************/
+#ifdef CONFIG_QUEC_PROJECT_FEATURE_LVGL
++QLVPERF,       atCmdHandleQLVPERF,     0       // LittlevGL render profiling
+#endif /*CONFIG_QUEC_PROJECT_FEATURE_LVGL*/
+
 
 #endif /* QUEC_ATCMD_DEF_H */
 
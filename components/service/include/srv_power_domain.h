@@ -0,0 +1,131 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _SRV_POWER_DOMAIN_H_
+#define _SRV_POWER_DOMAIN_H_
+
+#include "osi_compiler.h"
+
+OSI_EXTERN_C_BEGIN
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief peripheral power domain registry
+ *
+ * Drivers register power domains (such as panel, touch, codec and
+ * GNSS), with power on/off callbacks, dependencies and idle timeout.
+ * Consumers acquire a domain by \p srvPowerDomainGet before using it,
+ * and release it by \p srvPowerDomainPut. The registry counts the
+ * consumers:
+ * - At the first acquire, dependencies are acquired, and then the
+ *   domain is powered on. So, dependencies are always powered on
+ *   before the domain.
+ * - After the last release, the domain is powered off after idle
+ *   timeout, and then its dependencies are released.
+ *
+ * Idle timeout doesn't wake up the system. Instead, when system is
+ * going to suspend (all wake locks are released), the pending idle
+ * domains are powered off immediately. So, there are no rails and
+ * clocks left on during sleep, and no extra wakeup for power off.
+ * \p srvPowerDomainFlushIdle can be called at screen off for the same
+ * purpose.
+ *
+ * Callbacks are called in the thread calling \p srvPowerDomainGet, or
+ * the system low priority work queue, with the registry locked. They
+ * can block (such as I2C access), but shouldn't call registry APIs.
+ */
+
+/** maximum registered power domains */
+#define SRV_POWER_DOMAIN_COUNT (16)
+
+/** maximum dependencies of each power domain */
+#define SRV_POWER_DOMAIN_DEPEND_COUNT (4)
+
+/**
+ * \brief power domain descriptor
+ *
+ * The descriptor is not copied, it should be kept valid after
+ * registration.
+ */
+typedef struct
+{
+    uint32_t id;                                      ///< unique id, such as OSI_MAKE_TAG
+    const char *name;                                 ///< name for trace, constant string
+    uint32_t idle_timeout;                            ///< power off delay in ms after last release
+    uint32_t depends[SRV_POWER_DOMAIN_DEPEND_COUNT]; ///< ids of dependencies, 0 for unused
+    bool (*power_on)(void *ctx);                      ///< power on, return false on fail
+    void (*power_off)(void *ctx);                     ///< power off
+    void *ctx;                                        ///< context of callbacks
+} srvPowerDomainOps_t;
+
+/**
+ * \brief initialize power domain registry
+ */
+void srvPowerDomainInit(void);
+
+/**
+ * \brief register power domain
+ *
+ * The domain is regarded as powered off after registration.
+ * Dependencies can be registered later. Dependencies not registered at
+ * acquire are ignored.
+ *
+ * \param ops       power domain descriptor
+ * \return
+ *      - true on success
+ *      - false on invalid parameter, duplicated id or too many domains
+ */
+bool srvPowerDomainRegister(const srvPowerDomainOps_t *ops);
+
+/**
+ * \brief acquire power domain
+ *
+ * \param id        power domain id
+ * \return
+ *      - true if the domain is powered on
+ *      - false if not registered, or power on failed
+ */
+bool srvPowerDomainGet(uint32_t id);
+
+/**
+ * \brief release power domain
+ *
+ * It should be paired with successful \p srvPowerDomainGet.
+ *
+ * \param id        power domain id
+ */
+void srvPowerDomainPut(uint32_t id);
+
+/**
+ * \brief whether power domain is powered on
+ *
+ * \param id        power domain id
+ * \return
+ *      - true if the domain is powered on
+ */
+bool srvPowerDomainIsOn(uint32_t id);
+
+/**
+ * \brief power off all released domains without waiting idle timeout
+ */
+void srvPowerDomainFlushIdle(void);
+
+/**
+ * \brief output power domain information to trace
+ */
+void srvPowerDomainDump(void);
+
+OSI_EXTERN_C_END
+
+#endif
@@ -33,6 +33,15 @@ typedef void (*srvPmPonFunc_t)(void *arg);
  */
 typedef void (*srvPmChargerNotfiy_t)(bool on, void *ctx);
 
+/**
+ * \brief function type for event `SRVPM_EV_BATTERY_LEVEL`
+ *
+ * \param level     battery level in percent
+ * \param vbat      filtered battery voltage in mV
+ * \param ctx       caller context
+ */
+typedef void (*srvPmBatteryNotify_t)(uint8_t level, uint16_t vbat, void *ctx);
+
 /**
  * \brief EVENTs defination
  */
@@ -40,6 +49,8 @@ typedef enum
 {
     // use callback `srvPmChargerNotfiy_t`
     SRVPM_EV_CHR_HOTPLUG = 0,
+    // use callback `srvPmBatteryNotify_t`, called when battery level changed
+    SRVPM_EV_BATTERY_LEVEL,
 
     SRVPM_EV_COUNT,
 } srvPmEv_t;
@@ -89,6 +100,17 @@ srvPmEvToken_t *srvPmAddEvNotify(srvPmEv_t ev, void *func, void *ctx);
  */
 void srvPmRemoveEvNotify(srvPmEvToken_t *token);
 
+/**
+ * \brief battery level
+ *
+ * The level is estimated from filtered battery voltage by open circuit
+ * voltage table. It only decreases when discharging, and only increases
+ * when charging, by at most 1% each sample.
+ *
+ * \return     battery level in percent
+ */
+uint8_t srvPmBatteryLevel(void);
+
 OSI_EXTERN_C_END
 
 #endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _SRV_SETTING_STORE_H_
+#define _SRV_SETTING_STORE_H_
+
+#include "osi_compiler.h"
+
+OSI_EXTERN_C_BEGIN
+
+#include "srv_config.h"
+#include "pb_util.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief protobuf settings store
+ *
+ * Settings are stored in one file, as a log of records. Each record is
+ * a CRC protected fragment of protobuf message. By protobuf merge
+ * semantics, the concatenation of records is the message with the
+ * latest value of each field. So, changing one field only appends the
+ * encoded field, rather than rewriting the whole file.
+ *
+ * When the log is larger than the compact size, the whole message will
+ * be written as a new file with one record, and replace the old file.
+ *
+ * The file content is kept in memory after open, and mapped by
+ * \p vfs_mmap directly when supported (read only in this case). Fields
+ * can be read from the content without decoding the whole message.
+ *
+ * Repeated fields are merged by concatenation. So, repeated fields
+ * can't be updated by \p srvSettingStoreUpdate, and
+ * \p srvSettingStoreSave should be used.
+ *
+ * When a record is corrupted, such as power loss during append, the
+ * record and later ones will be discarded at open.
+ */
+
+/** opaque data struct of settings store */
+typedef struct srvSettingStore srvSettingStore_t;
+
+/**
+ * \brief open settings store
+ *
+ * When the file doesn't exist, an empty store is opened, and the file
+ * will be created at the first save or update.
+ *
+ * \param path          file path
+ * \param compact_size  log size to trigger compaction
+ * \return
+ *      - settings store
+ *      - NULL on out of memory
+ */
+srvSettingStore_t *srvSettingStoreOpen(const char *path, unsigned compact_size);
+
+/**
+ * \brief close settings store
+ *
+ * \param st        settings store, NULL is ignored
+ */
+void srvSettingStoreClose(srvSettingStore_t *st);
+
+/**
+ * \brief whether the settings store is empty
+ *
+ * \param st        settings store
+ * \return
+ *      - true if there are no valid records
+ */
+bool srvSettingStoreIsEmpty(srvSettingStore_t *st);
+
+/**
+ * \brief decode the whole message
+ *
+ * \p pbs will be initialized with default values of \p fields, and
+ * merged with all records.
+ *
+ * \param st        settings store
+ * \param fields    PB fields
+ * \param pbs       PB struct
+ * \return
+ *      - true on success
+ *      - false on decode error
+ */
+bool srvSettingStoreDecode(srvSettingStore_t *st, const pb_field_t *fields, void *pbs);
+
+/**
+ * \brief read the latest value of a varint field
+ *
+ * It is for int32, uint32, bool and enum. For sint32, the value is
+ * zigzag encoded.
+ *
+ * \param st        settings store
+ * \param tag       field tag
+ * \param value     output value
+ * \return
+ *      - true on success
+ *      - false if not found, or wire type mismatch
+ */
+bool srvSettingStoreGetVarint(srvSettingStore_t *st, uint32_t tag, uint32_t *value);
+
+/**
+ * \brief get the latest value of a length delimited field
+ *
+ * It is for string, bytes and sub-message. The returned pointer points
+ * to the store content, without copy. The pointer is valid till the
+ * next \p srvSettingStoreUpdate, \p srvSettingStoreSave or close.
+ * String is not null terminated.
+ *
+ * \param st        settings store
+ * \param tag       field tag
+ * \param size      output value size
+ * \return
+ *      - value pointer
+ *      - NULL if not found, or wire type mismatch
+ */
+const void *srvSettingStoreGetBytes(srvSettingStore_t *st, uint32_t tag, size_t *size);
+
+/**
+ * \brief save the whole message
+ *
+ * The file is rewritten with one record.
+ *
+ * \param st        settings store
+ * \param fields    PB fields
+ * \param pbs       PB struct
+ * \return
+ *      - true on success
+ *      - false on encode or file error
+ */
+bool srvSettingStoreSave(srvSettingStore_t *st, const pb_field_t *fields, void *pbs);
+
+/**
+ * \brief update one field
+ *
+ * \p pbs should be the whole message with current values, and only the
+ * field of \p tag is appended to the log. When compaction is triggered,
+ * the whole message is saved.
+ *
+ * \param st        settings store
+ * \param fields    PB fields
+ * \param pbs       PB struct
+ * \param tag       field tag, not a repeated field
+ * \return
+ *      - true on success
+ *      - false on encode or file error
+ */
+bool srvSettingStoreUpdate(srvSettingStore_t *st, const pb_field_t *fields, void *pbs, uint32_t tag);
+
+OSI_EXTERN_C_END
+
+#endif
@@ -0,0 +1,127 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _SRV_SNAPSHOT_H_
+#define _SRV_SNAPSHOT_H_
+
+#include "osi_compiler.h"
+
+OSI_EXTERN_C_BEGIN
+
+#include "srv_config.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief state snapshot for PSM fast resume
+ *
+ * Components register compact state serializers. At entering PSM, the
+ * state of all registered components are serialized into one PSM data
+ * blob, which is kept in retained memory or flash by kernel. At wakeup
+ * from PSM, the state is restored at registration, and components can
+ * skip the cold initialization (such as network attach, re-reading
+ * configuration files).
+ *
+ * Each record is protected by CRC, and tagged by component id and
+ * version. A record with mismatched CRC is discarded, and the version
+ * is passed to \p restore to let component decide compatibility.
+ *
+ * It is based on \p osiPsmDataSave and \p osiPsmDataRestore, with owner
+ * \p OSI_PSMDATA_OWNER_SNAPSHOT.
+ */
+
+/** maximum registered components */
+#define SRV_SNAPSHOT_COUNT (16)
+
+/**
+ * \brief save function type
+ *
+ * It will be called in shutdown callback, with interrupt disabled. So,
+ * it should be fast and shouldn't wait.
+ *
+ * \param ctx       context of registration
+ * \param buf       output buffer, NULL to get the size
+ * \param size      output buffer size
+ * \return
+ *      - serialized size
+ *      - 0 for nothing to be saved
+ *      - -1 on error
+ */
+typedef int (*srvSnapshotSave_t)(void *ctx, void *buf, unsigned size);
+
+/**
+ * \brief restore function type
+ *
+ * \param ctx       context of registration
+ * \param buf       saved data
+ * \param size      saved data size
+ * \param version   version at save
+ * \return
+ *      - true if state is restored
+ *      - false if the data is rejected, and component shall cold init
+ */
+typedef bool (*srvSnapshotRestore_t)(void *ctx, const void *buf, unsigned size, unsigned version);
+
+/**
+ * \brief component snapshot descriptor
+ *
+ * The descriptor is not copied, it should be kept valid after
+ * registration.
+ */
+typedef struct
+{
+    uint32_t id;                  ///< unique id, such as OSI_MAKE_TAG
+    const char *name;             ///< name for trace, constant string
+    uint16_t version;             ///< version of serialized data
+    srvSnapshotSave_t save;       ///< save function
+    srvSnapshotRestore_t restore; ///< restore function
+    void *ctx;                    ///< context of save and restore
+} srvSnapshotOps_t;
+
+/**
+ * \brief initialize snapshot service
+ *
+ * At PSM wakeup, the saved snapshot will be loaded. It should be called
+ * after \p osiPsmRestore, and before any component registration.
+ */
+void srvSnapshotInit(void);
+
+/**
+ * \brief register component snapshot
+ *
+ * When there are saved record with the same id, \p restore will be
+ * called before return.
+ *
+ * \param ops       snapshot descriptor
+ * \return
+ *      - true if the state is restored from snapshot
+ *      - false if not restored, component shall cold init
+ */
+bool srvSnapshotRegister(const srvSnapshotOps_t *ops);
+
+/**
+ * \brief finish restore
+ *
+ * Memory of the loaded snapshot will be freed. After that, components
+ * registered later won't be restored.
+ */
+void srvSnapshotRestoreDone(void);
+
+/**
+ * \brief output snapshot information to trace
+ */
+void srvSnapshotDump(void);
+
+OSI_EXTERN_C_END
+
+#endif
@@ -48,5 +48,67 @@ bool srvBtTraceInit(void);
  */
 bool srvFstraceInit(unsigned option);
 
+/**
+ * \brief directory of on-device log ring files
+ *
+ * Log ring files are in this directory, and can be uploaded as normal
+ * files, such as by FTP or HTTP. \p srvLogRingFlush should be called
+ * before upload.
+ */
+#define SRV_LOG_RING_DIR "/logring"
+
+/**
+ * \brief initialize on-device log ring
+ *
+ * After initialized, application traces of selected tags are compressed
+ * in RAM, and committed to files under \p SRV_LOG_RING_DIR periodically.
+ * It works even there are no host to capture trace.
+ *
+ * It is only available when \p CONFIG_SRV_LOG_RING_ENABLE is defined.
+ *
+ * \return
+ *      - true on success
+ *      - false on out of memory
+ */
+bool srvLogRingInit(void);
+
+/**
+ * \brief add a trace tag into log ring
+ *
+ * When no tags are added, traces of all tags are kept in log ring.
+ *
+ * \param tag trace tag, such as \p LOG_TAG_NET
+ * \return
+ *      - true on success
+ *      - false if log ring isn't initialized, or too many tags
+ */
+bool srvLogRingAddTag(unsigned tag);
+
+/**
+ * \brief commit pending traces of log ring to files
+ *
+ * It will wait the commit finish.
+ *
+ * \return
+ *      - true on success
+ *      - false if log ring isn't initialized, or timeout
+ */
+bool srvLogRingFlush(void);
+
+/**
+ * \brief read log ring files
+ *
+ * The files are regarded as one stream, the oldest file first. Files only
+ * contain whole blocks, so the stream can be decoded after concatenation.
+ *
+ * \param offset offset in the stream
+ * \param buf output buffer
+ * \param size output buffer size
+ * \return
+ *      - read bytes, 0 at the end of stream
+ *      - -1 if log ring isn't initialized, or invalid parameters
+ */
+int srvLogRingRead(unsigned offset, void *buf, unsigned size);
+
 OSI_EXTERN_C_END
 #endif
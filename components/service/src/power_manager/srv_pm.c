@@ -64,10 +64,28 @@ struct srv_pm
     uint32_t vbat_total;
     uint16_t vbat_realtime[8];
     uint8_t vbat_idx;
+    uint16_t vbat_filtered;   // mV
+    int32_t vbat_drop_rate;   // uV/s, positive for discharging
+    int64_t vbat_time;        // uptime of last sample
+    bool vbat_reset;          // restart filter at next sample
+    uint8_t battery_level;    // percent
     bool running;
 };
 
-static const uint32_t kMonitorBatteryInterval = 5000; // ms
+#ifdef CONFIG_SRV_POWER_OFF_VOLTAGE
+#define SRV_PM_VBAT_EMPTY CONFIG_SRV_POWER_OFF_VOLTAGE
+#else
+#define SRV_PM_VBAT_EMPTY (3400)
+#endif
+
+static const uint32_t kMonBatteryIntervalMin = 2000;     // ms, near threshold
+static const uint32_t kMonBatteryIntervalCharge = 5000;  // ms
+static const uint32_t kMonBatteryIntervalMax = 60000;    // ms, slow discharging
+static const uint32_t kMonBatteryNearThreshold = 100;    // mV
+static const uint16_t kVbatMaxStep = 50;                 // mV per sample
+// open circuit voltage (mV) at 0%, 10%, ... 100%
+static const uint16_t kBatteryOcv[] = {3400, 3680, 3740, 3770, 3800, 3840,
+                                       3890, 3960, 4040, 4100, 4180};
 #ifndef CONFIG_QUEC_PROJECT_FEATURE_PWK
 static const uint32_t kKeyLongPressDuration = 2500;   // ms
 #else
@@ -80,6 +98,11 @@ static void prvChargeWork(void *param)
 {
     srvPm_t *p = (srvPm_t *)param;
     const srvPmStatus_t *status = &p->status[p->pm_state];
+
+    // voltage steps at charger plug, sample now and restart the filter
+    p->vbat_reset = true;
+    osiTimerStop(p->mon_battery_timer);
+    osiWorkEnqueue(p->mon_battery_work, p->wq);
     if (p->pm_state == PM_POWER_ON)
     {
         srvPmEvToken_t *t;
@@ -165,16 +188,102 @@ static void prvPkNotifyCB(keyMap_t id, keyState_t state, void *param)
     }
 }
 
+static uint8_t prvOcvToLevel(uint16_t vbat)
+{
+    const unsigned count = OSI_ARRAY_SIZE(kBatteryOcv);
+    if (vbat <= kBatteryOcv[0])
+        return 0;
+    if (vbat >= kBatteryOcv[count - 1])
+        return 100;
+
+    unsigned n = 1;
+    while (vbat > kBatteryOcv[n])
+        n++;
+    unsigned lo = kBatteryOcv[n - 1], hi = kBatteryOcv[n];
+    return (n - 1) * 10 + (vbat - lo) * 10 / (hi - lo);
+}
+
+static void prvBatteryFilter(srvPm_t *p, uint16_t vol, bool charging)
+{
+    const int64_t now = osiUpTime();
+    if (p->vbat_reset)
+    {
+        p->vbat_reset = false;
+        p->vbat_filtered = vol;
+        p->vbat_drop_rate = 0;
+        p->vbat_time = now;
+        return;
+    }
+
+    // slew limit against load transient (such as RF TX burst), and IIR
+    int delta = (int)vol - (int)p->vbat_filtered;
+    delta = OSI_MAX(int, -kVbatMaxStep, OSI_MIN(int, kVbatMaxStep, delta));
+    const uint16_t prev = p->vbat_filtered;
+    p->vbat_filtered += delta / 4;
+
+    const int64_t elapsed = now - p->vbat_time;
+    p->vbat_time = now;
+    if (!charging && elapsed > 0)
+    {
+        int32_t rate = (int32_t)(((int64_t)prev - p->vbat_filtered) * 1000000 / elapsed);
+        p->vbat_drop_rate = (p->vbat_drop_rate * 3 + rate) / 4;
+    }
+
+    // level only moves in the direction of charging state, 1% at most
+    const uint8_t level = prvOcvToLevel(p->vbat_filtered);
+    if (charging && level > p->battery_level)
+        p->battery_level++;
+    else if (!charging && level < p->battery_level)
+        p->battery_level--;
+    else
+        return;
+
+    srvPmEvToken_t *t;
+    LIST_FOREACH(t, &p->ev_head[SRVPM_EV_BATTERY_LEVEL], iter)
+    {
+        if (t->func)
+            ((srvPmBatteryNotify_t)(t->func))(p->battery_level, p->vbat_filtered, t->param);
+    }
+}
+
+static void prvMonBatteryStart(srvPm_t *p, uint32_t average, bool charging)
+{
+    uint32_t interval = kMonBatteryIntervalMax;
+    uint32_t relax = OSI_WAIT_FOREVER;
+    if (charging)
+    {
+        interval = kMonBatteryIntervalCharge;
+    }
+    else if (average < SRV_PM_VBAT_EMPTY + kMonBatteryNearThreshold)
+    {
+        // wakeup from sleep is needed to check power off threshold
+        interval = kMonBatteryIntervalMin;
+        relax = interval;
+    }
+    else if (p->vbat_drop_rate > 0)
+    {
+        // about 8 samples before reaching the threshold
+        uint64_t margin = average - SRV_PM_VBAT_EMPTY;
+        uint64_t ms = margin * 125000 / p->vbat_drop_rate;
+        interval = OSI_MAX(uint32_t, kMonBatteryIntervalMin, OSI_MIN(uint64_t, kMonBatteryIntervalMax, ms));
+    }
+
+    osiTimerStartRelaxed(p->mon_battery_timer, interval, relax);
+}
+
 static void prvMonBatteryWork(void *param)
 {
     srvPm_t *p = (srvPm_t *)param;
     const uint16_t vol = drvChargerGetVbatRT();
     const uint8_t cnt = OSI_ARRAY_SIZE(p->vbat_realtime);
     const uint8_t idx = (p->vbat_idx++) % OSI_ARRAY_SIZE(p->vbat_realtime);
+    const bool charging = p->status[p->pm_state].charge_attached;
     p->vbat_total = p->vbat_total + vol - p->vbat_realtime[idx];
     p->vbat_realtime[idx] = vol;
     const uint32_t average = p->vbat_total / cnt;
-    OSI_LOGI(0, "pm monitor battery %u/%u", vol, average);
+    prvBatteryFilter(p, vol, charging);
+    OSI_LOGI(0, "pm monitor battery %u/%u/%u level %u", vol, average, p->vbat_filtered, p->battery_level);
+    prvMonBatteryStart(p, average, charging);
     if (p->pm_state == PM_POWER_ON)
     {
 #ifndef CONFIG_QUEC_PROJECT_FEATURE
@@ -335,6 +444,9 @@ void srvPmRunInitCheck(srvPm_t *p)
         p->vbat_total += p->vbat_realtime[i];
     }
     const uint32_t vbat_average = p->vbat_total / OSI_ARRAY_SIZE(p->vbat_realtime);
+    p->vbat_filtered = vbat_average;
+    p->vbat_time = osiUpTime();
+    p->battery_level = prvOcvToLevel(vbat_average);
     if (state == PM_POWER_ON)
     {
         OSI_LOGI(0, "pm start battery voltage %u", vbat_average);
@@ -359,7 +471,7 @@ void srvPmRunInitCheck(srvPm_t *p)
     {
         p->status[state].v = status.v;
         drvChargerSetCB(prvChargeIsrCB, p);
-        osiTimerStartPeriodicRelaxed(p->mon_battery_timer, kMonitorBatteryInterval, OSI_WAIT_FOREVER);
+        prvMonBatteryStart(p, vbat_average, status.charge_attached);
     }
 
     prvSetState_(p, state, true);
@@ -381,6 +493,11 @@ srvPmEvToken_t *srvPmAddEventCB(srvPm_t *p, srvPmEv_t ev, void *func, void *ctx)
     return t;
 }
 
+uint8_t srvPmGetBatteryLevel(srvPm_t *p)
+{
+    return p->battery_level;
+}
+
 void srvPmRmEventCB(srvPm_t *p, srvPmEvToken_t *token)
 {
     if (token != NULL)
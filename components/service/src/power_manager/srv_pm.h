@@ -44,6 +44,8 @@ srvPmEvToken_t *srvPmAddEventCB(srvPm_t *pm, srvPmEv_t ev, void *func, void *ctx
 
 void srvPmRmEventCB(srvPm_t *pm, srvPmEvToken_t *token);
 
+uint8_t srvPmGetBatteryLevel(srvPm_t *pm);
+
 OSI_EXTERN_C_END
 
 #endif
\ No newline at end of file
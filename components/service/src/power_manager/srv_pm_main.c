@@ -45,6 +45,11 @@ srvPmEvToken_t *srvPmAddEvNotify(srvPmEv_t ev, void *func, void *arg)
     return srvPmAddEventCB(gSrvPm, ev, func, arg);
 }
 
+uint8_t srvPmBatteryLevel(void)
+{
+    return srvPmGetBatteryLevel(gSrvPm);
+}
+
 void srvPmRemoveEvNotify(srvPmEvToken_t *token)
 {
     srvPmRmEventCB(gSrvPm, token);
@@ -0,0 +1,323 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#define OSI_LOCAL_LOG_TAG OSI_MAKE_LOG_TAG('S', 'R', 'P', 'D')
+
+#include "srv_power_domain.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include <string.h>
+
+#define POWER_DOMAIN_PM_TAG OSI_MAKE_TAG('S', 'R', 'P', 'D')
+
+typedef struct
+{
+    const srvPowerDomainOps_t *ops;
+    unsigned refcount;
+    bool on;
+    bool idle_pending; // released, and waiting idle timeout
+    osiWork_t *idle_work;
+    osiTimer_t *idle_timer;
+} srvPowerDomain_t;
+
+typedef struct
+{
+    osiMutex_t *lock;
+    osiPmSource_t *pm_source;
+    osiWork_t *flush_work;
+    srvPowerDomain_t domains[SRV_POWER_DOMAIN_COUNT];
+    unsigned count;
+    unsigned idle_pending;
+} srvPowerDomainContext_t;
+
+static srvPowerDomainContext_t gPdCtx;
+
+static void prvPut(srvPowerDomain_t *pd);
+
+static srvPowerDomain_t *prvFind(uint32_t id)
+{
+    for (unsigned n = 0; n < gPdCtx.count; n++)
+    {
+        if (gPdCtx.domains[n].ops->id == id)
+            return &gPdCtx.domains[n];
+    }
+    return NULL;
+}
+
+/**
+ * Wake lock is held only when there are idle pending domains, so that
+ * \p prepare will be called before suspend.
+ */
+static void prvSetIdlePending(srvPowerDomain_t *pd, bool pending)
+{
+    if (pd->idle_pending == pending)
+        return;
+
+    pd->idle_pending = pending;
+    if (pending)
+    {
+        if (gPdCtx.idle_pending++ == 0)
+            osiPmWakeLock(gPdCtx.pm_source);
+    }
+    else
+    {
+        if (--gPdCtx.idle_pending == 0)
+            osiPmWakeUnlock(gPdCtx.pm_source);
+    }
+}
+
+static void prvPowerOff(srvPowerDomain_t *pd)
+{
+    const srvPowerDomainOps_t *ops = pd->ops;
+
+    osiTimerStop(pd->idle_timer);
+    prvSetIdlePending(pd, false);
+    if (!pd->on)
+        return;
+
+    OSI_LOGD(0, "power domain %4c off", ops->id);
+    if (ops->power_off != NULL)
+        ops->power_off(ops->ctx);
+    pd->on = false;
+
+    // release dependencies after the domain is powered off
+    for (unsigned n = SRV_POWER_DOMAIN_DEPEND_COUNT; n > 0; n--)
+    {
+        srvPowerDomain_t *dep = prvFind(ops->depends[n - 1]);
+        if (ops->depends[n - 1] != 0 && dep != NULL)
+            prvPut(dep);
+    }
+}
+
+static bool prvGet(srvPowerDomain_t *pd, unsigned depth)
+{
+    const srvPowerDomainOps_t *ops = pd->ops;
+
+    // dependency loop
+    if (depth > SRV_POWER_DOMAIN_COUNT)
+        return false;
+
+    if (pd->refcount++ > 0)
+        return true;
+
+    osiTimerStop(pd->idle_timer);
+    prvSetIdlePending(pd, false);
+    if (pd->on)
+        return true;
+
+    // acquire dependencies before the domain is powered on
+    unsigned acquired = 0;
+    for (; acquired < SRV_POWER_DOMAIN_DEPEND_COUNT; acquired++)
+    {
+        if (ops->depends[acquired] == 0)
+            continue;
+
+        srvPowerDomain_t *dep = prvFind(ops->depends[acquired]);
+        if (dep != NULL && !prvGet(dep, depth + 1))
+            break;
+    }
+
+    bool ok = (acquired == SRV_POWER_DOMAIN_DEPEND_COUNT);
+    if (ok)
+    {
+        OSI_LOGD(0, "power domain %4c on", ops->id);
+        ok = (ops->power_on == NULL) || ops->power_on(ops->ctx);
+    }
+
+    if (!ok)
+    {
+        OSI_LOGE(0, "power domain %4c on failed", ops->id);
+        while (acquired > 0)
+        {
+            acquired--;
+            srvPowerDomain_t *dep = prvFind(ops->depends[acquired]);
+            if (ops->depends[acquired] != 0 && dep != NULL)
+                prvPut(dep);
+        }
+        pd->refcount--;
+        return false;
+    }
+
+    pd->on = true;
+    return true;
+}
+
+static void prvPut(srvPowerDomain_t *pd)
+{
+    if (pd->refcount == 0)
+    {
+        OSI_LOGE(0, "power domain %4c unbalanced put", pd->ops->id);
+        return;
+    }
+
+    if (--pd->refcount > 0 || !pd->on)
+        return;
+
+    if (pd->ops->idle_timeout == 0)
+    {
+        prvPowerOff(pd);
+    }
+    else
+    {
+        prvSetIdlePending(pd, true);
+        osiTimerStartRelaxed(pd->idle_timer, pd->ops->idle_timeout, OSI_WAIT_FOREVER);
+    }
+}
+
+static void prvFlushIdle(void)
+{
+    for (unsigned n = 0; n < gPdCtx.count; n++)
+    {
+        srvPowerDomain_t *pd = &gPdCtx.domains[n];
+        if (pd->idle_pending && pd->refcount == 0)
+            prvPowerOff(pd);
+    }
+}
+
+static void prvIdleWork(void *param)
+{
+    srvPowerDomain_t *pd = (srvPowerDomain_t *)param;
+
+    osiMutexLock(gPdCtx.lock);
+    if (pd->idle_pending && pd->refcount == 0)
+        prvPowerOff(pd);
+    osiMutexUnlock(gPdCtx.lock);
+}
+
+static void prvFlushWork(void *param)
+{
+    osiMutexLock(gPdCtx.lock);
+    prvFlushIdle();
+    osiMutexUnlock(gPdCtx.lock);
+}
+
+/**
+ * Called with interrupt disabled, at suspend check. Power off can't be
+ * done here, and this suspend is rejected. After the flush work, the
+ * wake lock will be released.
+ */
+static bool prvPmPrepare(void *ctx)
+{
+    if (gPdCtx.idle_pending == 0)
+        return true;
+
+    osiWorkEnqueue(gPdCtx.flush_work, osiSysWorkQueueLowPriority());
+    return false;
+}
+
+static const osiPmSourceOps_t gPdPmOps = {
+    .prepare = prvPmPrepare,
+};
+
+void srvPowerDomainInit(void)
+{
+    if (gPdCtx.lock != NULL)
+        return;
+
+    gPdCtx.lock = osiMutexCreate();
+    gPdCtx.flush_work = osiWorkCreate(prvFlushWork, NULL, NULL);
+    gPdCtx.pm_source = osiPmSourceCreate(POWER_DOMAIN_PM_TAG, &gPdPmOps, NULL);
+}
+
+bool srvPowerDomainRegister(const srvPowerDomainOps_t *ops)
+{
+    if (ops == NULL || ops->id == 0 || gPdCtx.lock == NULL)
+        return false;
+
+    bool ok = false;
+    osiMutexLock(gPdCtx.lock);
+    if (gPdCtx.count < SRV_POWER_DOMAIN_COUNT && prvFind(ops->id) == NULL)
+    {
+        srvPowerDomain_t *pd = &gPdCtx.domains[gPdCtx.count];
+        memset(pd, 0, sizeof(*pd));
+        pd->ops = ops;
+        pd->idle_work = osiWorkCreate(prvIdleWork, NULL, pd);
+        pd->idle_timer = osiTimerCreateWork(pd->idle_work, osiSysWorkQueueLowPriority());
+        if (pd->idle_work != NULL && pd->idle_timer != NULL)
+        {
+            gPdCtx.count++;
+            ok = true;
+        }
+        else
+        {
+            if (pd->idle_timer != NULL)
+                osiTimerDelete(pd->idle_timer);
+            osiWorkDelete(pd->idle_work);
+        }
+    }
+    osiMutexUnlock(gPdCtx.lock);
+
+    if (!ok)
+        OSI_LOGE(0, "power domain %4c register failed", ops->id);
+    return ok;
+}
+
+bool srvPowerDomainGet(uint32_t id)
+{
+    if (gPdCtx.lock == NULL)
+        return false;
+
+    osiMutexLock(gPdCtx.lock);
+    srvPowerDomain_t *pd = prvFind(id);
+    bool ok = (pd != NULL) && prvGet(pd, 0);
+    osiMutexUnlock(gPdCtx.lock);
+    return ok;
+}
+
+void srvPowerDomainPut(uint32_t id)
+{
+    if (gPdCtx.lock == NULL)
+        return;
+
+    osiMutexLock(gPdCtx.lock);
+    srvPowerDomain_t *pd = prvFind(id);
+    if (pd != NULL)
+        prvPut(pd);
+    osiMutexUnlock(gPdCtx.lock);
+}
+
+bool srvPowerDomainIsOn(uint32_t id)
+{
+    if (gPdCtx.lock == NULL)
+        return false;
+
+    osiMutexLock(gPdCtx.lock);
+    srvPowerDomain_t *pd = prvFind(id);
+    bool on = (pd != NULL) && pd->on;
+    osiMutexUnlock(gPdCtx.lock);
+    return on;
+}
+
+void srvPowerDomainFlushIdle(void)
+{
+    if (gPdCtx.lock == NULL)
+        return;
+
+    osiMutexLock(gPdCtx.lock);
+    prvFlushIdle();
+    osiMutexUnlock(gPdCtx.lock);
+}
+
+void srvPowerDomainDump(void)
+{
+    if (gPdCtx.lock == NULL)
+        return;
+
+    osiMutexLock(gPdCtx.lock);
+    for (unsigned n = 0; n < gPdCtx.count; n++)
+    {
+        srvPowerDomain_t *pd = &gPdCtx.domains[n];
+        OSI_LOGI(0, "power domain %4c on/%d ref/%d idle/%d", pd->ops->id,
+                 pd->on, pd->refcount, pd->idle_pending);
+    }
+    osiMutexUnlock(gPdCtx.lock);
+}
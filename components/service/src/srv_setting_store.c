@@ -0,0 +1,428 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "srv_setting_store.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "calclib/crc32.h"
+#include "vfs.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#define RECORD_MAGIC (0x5353) // 'SS'
+#define RECORD_SIZE_MAX (0xffff)
+
+// Records are not aligned in file, and it is accessed by memcpy.
+typedef struct
+{
+    uint16_t magic;
+    uint16_t size; // data size, not including this header
+    uint32_t crc;  // crc of data
+} srvSettingRecord_t;
+
+struct srvSettingStore
+{
+    char *path;
+    osiMutex_t *lock;
+    unsigned compact_size;
+    bool mapped;         // data is mapped by vfs_mmap, read only
+    const uint8_t *data; // file content, valid records only
+    unsigned size;
+    unsigned capacity; // allocated size of data, not mapped
+};
+
+// Stream over the payload of all records, skipping record headers.
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    unsigned left; // left payload in current record
+} srvSettingStream_t;
+
+static inline unsigned prvRecordPayloadSize(const uint8_t *p)
+{
+    srvSettingRecord_t rec;
+    memcpy(&rec, p, sizeof(rec));
+    return rec.size;
+}
+
+/**
+ * Size of valid records at the beginning.
+ */
+static unsigned prvValidSize(const uint8_t *data, unsigned size)
+{
+    unsigned pos = 0;
+    while (size - pos >= sizeof(srvSettingRecord_t))
+    {
+        srvSettingRecord_t rec;
+        memcpy(&rec, data + pos, sizeof(rec));
+        if (rec.magic != RECORD_MAGIC ||
+            size - pos - sizeof(srvSettingRecord_t) < rec.size ||
+            crc32Calc(data + pos + sizeof(rec), rec.size) != rec.crc)
+            break;
+        pos += sizeof(rec) + rec.size;
+    }
+    return pos;
+}
+
+static void prvRecordHeader(uint8_t *p, const void *data, unsigned size)
+{
+    srvSettingRecord_t rec = {
+        .magic = RECORD_MAGIC,
+        .size = size,
+        .crc = crc32Calc(data, size),
+    };
+    memcpy(p, &rec, sizeof(rec));
+}
+
+static bool prvStreamRead(pb_istream_t *stream, pb_byte_t *buf, size_t count)
+{
+    srvSettingStream_t *s = (srvSettingStream_t *)stream->state;
+    while (count > 0)
+    {
+        if (s->left == 0)
+        {
+            if (s->end - s->p < (int)sizeof(srvSettingRecord_t))
+                return false;
+            s->left = prvRecordPayloadSize(s->p);
+            s->p += sizeof(srvSettingRecord_t);
+            continue;
+        }
+
+        unsigned n = OSI_MIN(unsigned, count, s->left);
+        if (buf != NULL)
+        {
+            memcpy(buf, s->p, n);
+            buf += n;
+        }
+        s->p += n;
+        s->left -= n;
+        count -= n;
+    }
+    return true;
+}
+
+/**
+ * Find the latest occurrence of the field. The returned stream is the
+ * field value, to the end of the record.
+ */
+static bool prvFindField(srvSettingStore_t *st, uint32_t tag, pb_wire_type_t *wire_type, pb_istream_t *value)
+{
+    bool found = false;
+    unsigned pos = 0;
+    while (pos < st->size)
+    {
+        unsigned rsize = prvRecordPayloadSize(st->data + pos);
+        pb_istream_t is = pb_istream_from_buffer(st->data + pos + sizeof(srvSettingRecord_t), rsize);
+        for (;;)
+        {
+            pb_wire_type_t wt;
+            uint32_t t;
+            bool eof;
+            if (!pb_decode_tag(&is, &wt, &t, &eof))
+                break;
+            if (t == tag)
+            {
+                *wire_type = wt;
+                *value = is;
+                found = true;
+            }
+            if (!pb_skip_field(&is, wt))
+                break;
+        }
+        pos += sizeof(srvSettingRecord_t) + rsize;
+    }
+    return found;
+}
+
+/**
+ * Replace file and memory content, with one record of encoded message.
+ */
+static bool prvSaveLocked(srvSettingStore_t *st, const pb_field_t *fields, void *pbs)
+{
+    int pb_size = pbEncodeToMem(fields, pbs, NULL, 0);
+    if (pb_size < 0 || pb_size > RECORD_SIZE_MAX)
+        return false;
+
+    unsigned size = sizeof(srvSettingRecord_t) + pb_size;
+    uint8_t *data = (uint8_t *)malloc(size);
+    if (data == NULL)
+        return false;
+
+    uint8_t *payload = data + sizeof(srvSettingRecord_t);
+    if (pbEncodeToMem(fields, pbs, payload, pb_size) != pb_size)
+        goto failed;
+    prvRecordHeader(data, payload, pb_size);
+
+    // write to temporal file and rename, the original file will be kept
+    // on power loss
+    char tmp_path[VFS_PATH_MAX];
+    if (strlen(st->path) + 4 >= VFS_PATH_MAX)
+        goto failed;
+    strcpy(tmp_path, st->path);
+    strcat(tmp_path, ".tmp");
+    if (vfs_file_write(tmp_path, data, size) != (ssize_t)size)
+        goto failed_unlink;
+    if (vfs_rename(tmp_path, st->path) != 0)
+        goto failed_unlink;
+
+    free((void *)st->data);
+    st->data = data;
+    st->size = size;
+    st->capacity = size;
+    return true;
+
+failed_unlink:
+    vfs_unlink(tmp_path);
+failed:
+    OSI_LOGXE(OSI_LOGPAR_SI, 0, "setting store %s save failed size/%d", st->path, pb_size);
+    free(data);
+    return false;
+}
+
+/**
+ * Append one record to file and memory content.
+ */
+static bool prvAppendLocked(srvSettingStore_t *st, const void *payload, unsigned size)
+{
+    unsigned total = sizeof(srvSettingRecord_t) + size;
+    if (st->size + total > st->capacity)
+    {
+        unsigned capacity = OSI_MAX(unsigned, st->size + total, st->capacity * 2);
+        uint8_t *data = (uint8_t *)realloc((void *)st->data, capacity);
+        if (data == NULL)
+            return false;
+        st->data = data;
+        st->capacity = capacity;
+    }
+
+    uint8_t *rec = (uint8_t *)st->data + st->size;
+    memcpy(rec + sizeof(srvSettingRecord_t), payload, size);
+    prvRecordHeader(rec, payload, size);
+
+    int fd = vfs_open(st->path, O_WRONLY | O_CREAT | O_APPEND, 0);
+    if (fd < 0)
+        return false;
+
+    bool ok = (vfs_write(fd, rec, total) == (ssize_t)total);
+    vfs_close(fd);
+
+    // drop the partial record, or later appends can't be read
+    if (ok)
+        st->size += total;
+    else
+        vfs_truncate(st->path, st->size);
+    return ok;
+}
+
+srvSettingStore_t *srvSettingStoreOpen(const char *path, unsigned compact_size)
+{
+    if (path == NULL)
+        return NULL;
+
+    unsigned path_len = strlen(path) + 1;
+    srvSettingStore_t *st = (srvSettingStore_t *)calloc(1, sizeof(srvSettingStore_t) + path_len);
+    if (st == NULL)
+        return NULL;
+
+    st->path = (char *)st + sizeof(srvSettingStore_t);
+    memcpy(st->path, path, path_len);
+    st->compact_size = compact_size;
+    st->lock = osiMutexCreate();
+    if (st->lock == NULL)
+        goto failed;
+
+    size_t map_size = 0;
+    const uint8_t *map = (const uint8_t *)vfs_mmap(path, &map_size);
+    if (map != NULL)
+    {
+        st->mapped = true;
+        st->data = map;
+        st->size = prvValidSize(map, map_size);
+        return st;
+    }
+
+    ssize_t file_size = vfs_file_size(path);
+    if (file_size <= 0)
+        return st;
+
+    uint8_t *data = (uint8_t *)malloc(file_size);
+    if (data == NULL)
+        goto failed;
+
+    if (vfs_file_read(path, data, file_size) != file_size)
+    {
+        free(data);
+        return st;
+    }
+
+    st->data = data;
+    st->capacity = file_size;
+    st->size = prvValidSize(data, file_size);
+    if (st->size != file_size)
+    {
+        OSI_LOGXW(OSI_LOGPAR_SII, 0, "setting store %s discard %d/%d", path, file_size - st->size, file_size);
+        vfs_truncate(path, st->size);
+    }
+    return st;
+
+failed:
+    osiMutexDelete(st->lock);
+    free(st);
+    return NULL;
+}
+
+void srvSettingStoreClose(srvSettingStore_t *st)
+{
+    if (st == NULL)
+        return;
+
+    if (!st->mapped)
+        free((void *)st->data);
+    osiMutexDelete(st->lock);
+    free(st);
+}
+
+bool srvSettingStoreIsEmpty(srvSettingStore_t *st)
+{
+    return st->size == 0;
+}
+
+bool srvSettingStoreDecode(srvSettingStore_t *st, const pb_field_t *fields, void *pbs)
+{
+    osiMutexLock(st->lock);
+
+    // decode the concatenation of records as one message, so required
+    // fields can be in any record
+    srvSettingStream_t ss = {
+        .p = st->data,
+        .end = st->data + st->size,
+        .left = 0,
+    };
+    unsigned pb_size = 0;
+    for (unsigned pos = 0; pos < st->size;)
+    {
+        unsigned rsize = prvRecordPayloadSize(st->data + pos);
+        pb_size += rsize;
+        pos += sizeof(srvSettingRecord_t) + rsize;
+    }
+
+    pb_istream_t is = {
+        .callback = prvStreamRead,
+        .state = &ss,
+        .bytes_left = pb_size,
+    };
+    bool ok = pb_decode(&is, fields, pbs);
+    osiMutexUnlock(st->lock);
+    return ok;
+}
+
+bool srvSettingStoreGetVarint(srvSettingStore_t *st, uint32_t tag, uint32_t *value)
+{
+    osiMutexLock(st->lock);
+
+    pb_wire_type_t wt;
+    pb_istream_t is;
+    bool ok = (prvFindField(st, tag, &wt, &is) &&
+               wt == PB_WT_VARINT &&
+               pb_decode_varint32(&is, value));
+    osiMutexUnlock(st->lock);
+    return ok;
+}
+
+const void *srvSettingStoreGetBytes(srvSettingStore_t *st, uint32_t tag, size_t *size)
+{
+    osiMutexLock(st->lock);
+
+    pb_wire_type_t wt;
+    pb_istream_t is;
+    uint32_t len;
+    const void *value = NULL;
+    if (prvFindField(st, tag, &wt, &is) &&
+        wt == PB_WT_STRING &&
+        pb_decode_varint32(&is, &len) &&
+        len <= is.bytes_left)
+    {
+        // buffer stream state is the current read pointer
+        value = is.state;
+        if (size != NULL)
+            *size = len;
+    }
+    osiMutexUnlock(st->lock);
+    return value;
+}
+
+bool srvSettingStoreSave(srvSettingStore_t *st, const pb_field_t *fields, void *pbs)
+{
+    if (st->mapped)
+        return false;
+
+    osiMutexLock(st->lock);
+    bool ok = prvSaveLocked(st, fields, pbs);
+    osiMutexUnlock(st->lock);
+    return ok;
+}
+
+bool srvSettingStoreUpdate(srvSettingStore_t *st, const pb_field_t *fields, void *pbs, uint32_t tag)
+{
+    if (st->mapped)
+        return false;
+
+    int pb_size = pbEncodeToMem(fields, pbs, NULL, 0);
+    if (pb_size < 0)
+        return false;
+
+    uint8_t *encoded = (uint8_t *)malloc(pb_size);
+    if (encoded == NULL)
+        return false;
+
+    osiMutexLock(st->lock);
+    bool ok = false;
+    if (pbEncodeToMem(fields, pbs, encoded, pb_size) != pb_size)
+        goto done;
+
+    // extract encoded field, including the tag
+    pb_istream_t is = pb_istream_from_buffer(encoded, pb_size);
+    const uint8_t *field = NULL;
+    unsigned field_size = 0;
+    for (;;)
+    {
+        const uint8_t *start = (const uint8_t *)is.state;
+        pb_wire_type_t wt;
+        uint32_t t;
+        bool eof;
+        if (!pb_decode_tag(&is, &wt, &t, &eof))
+            break;
+        if (!pb_skip_field(&is, wt))
+            goto done;
+        if (t == tag)
+        {
+            field = start;
+            field_size = (const uint8_t *)is.state - start;
+            break;
+        }
+    }
+
+    // the whole message is saved at compaction, or the field is absent
+    // in encoded message (such as optional field is cleared)
+    if (field == NULL || st->size == 0 ||
+        st->size + sizeof(srvSettingRecord_t) + field_size > st->compact_size)
+        ok = prvSaveLocked(st, fields, pbs);
+    else
+        ok = prvAppendLocked(st, field, field_size);
+
+done:
+    osiMutexUnlock(st->lock);
+    free(encoded);
+    return ok;
+}
@@ -0,0 +1,253 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "srv_snapshot.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "calclib/crc32.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_MAGIC OSI_MAKE_TAG('S', 'N', 'A', 'P')
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t count; // record count
+    uint32_t size;  // total size, including this header
+} srvSnapshotHeader_t;
+
+typedef struct
+{
+    uint32_t id;
+    uint16_t version;
+    uint16_t size; // data size, not including this header and padding
+    uint32_t crc;  // crc of data
+} srvSnapshotRecord_t;
+
+typedef struct
+{
+    const srvSnapshotOps_t *ops[SRV_SNAPSHOT_COUNT];
+    unsigned count;
+    void *loaded; // loaded snapshot at PSM wakeup
+    unsigned loaded_size;
+    unsigned restored; // count of restored components
+    unsigned save_size;
+    unsigned save_us;
+} srvSnapshotContext_t;
+
+static srvSnapshotContext_t gSnapshotCtx;
+
+static inline unsigned prvRecordSize(unsigned size)
+{
+    return sizeof(srvSnapshotRecord_t) + OSI_ALIGN_UP(size, 4);
+}
+
+/**
+ * Find record in loaded snapshot, all records are already validated.
+ */
+static const srvSnapshotRecord_t *prvFindRecord(uint32_t id)
+{
+    const srvSnapshotHeader_t *header = (const srvSnapshotHeader_t *)gSnapshotCtx.loaded;
+    if (header == NULL)
+        return NULL;
+
+    const uint8_t *p = (const uint8_t *)header + sizeof(srvSnapshotHeader_t);
+    for (unsigned n = 0; n < header->count; n++)
+    {
+        const srvSnapshotRecord_t *rec = (const srvSnapshotRecord_t *)p;
+        if (rec->id == id)
+            return rec;
+        p += prvRecordSize(rec->size);
+    }
+    return NULL;
+}
+
+/**
+ * Validate the whole snapshot, it is all or nothing. Corrupted record
+ * may be caused by corrupted size, and later records can't be trusted.
+ */
+static bool prvSnapshotValid(const void *data, unsigned size)
+{
+    const srvSnapshotHeader_t *header = (const srvSnapshotHeader_t *)data;
+    if (size < sizeof(srvSnapshotHeader_t) ||
+        header->magic != SNAPSHOT_MAGIC || header->size != size)
+        return false;
+
+    const uint8_t *p = (const uint8_t *)data + sizeof(srvSnapshotHeader_t);
+    const uint8_t *end = (const uint8_t *)data + size;
+    for (unsigned n = 0; n < header->count; n++)
+    {
+        const srvSnapshotRecord_t *rec = (const srvSnapshotRecord_t *)p;
+        if (end - p < (int)sizeof(srvSnapshotRecord_t) ||
+            end - p < (int)prvRecordSize(rec->size))
+            return false;
+        if (crc32Calc(p + sizeof(srvSnapshotRecord_t), rec->size) != rec->crc)
+            return false;
+        p += prvRecordSize(rec->size);
+    }
+    return p == end;
+}
+
+static void prvSnapshotSave(void)
+{
+    int64_t start = osiUpTimeUS();
+    int sizes[SRV_SNAPSHOT_COUNT];
+    unsigned total = sizeof(srvSnapshotHeader_t);
+    for (unsigned n = 0; n < gSnapshotCtx.count; n++)
+    {
+        const srvSnapshotOps_t *ops = gSnapshotCtx.ops[n];
+        sizes[n] = ops->save(ops->ctx, NULL, 0);
+        if (sizes[n] > UINT16_MAX)
+            sizes[n] = -1;
+        if (sizes[n] > 0)
+            total += prvRecordSize(sizes[n]);
+    }
+
+    uint8_t *buf = (uint8_t *)calloc(1, total);
+    if (buf == NULL)
+        return;
+
+    srvSnapshotHeader_t *header = (srvSnapshotHeader_t *)buf;
+    uint8_t *p = buf + sizeof(srvSnapshotHeader_t);
+    for (unsigned n = 0; n < gSnapshotCtx.count; n++)
+    {
+        const srvSnapshotOps_t *ops = gSnapshotCtx.ops[n];
+        if (sizes[n] <= 0)
+            continue;
+
+        srvSnapshotRecord_t *rec = (srvSnapshotRecord_t *)p;
+        uint8_t *data = p + sizeof(srvSnapshotRecord_t);
+        int size = ops->save(ops->ctx, data, sizes[n]);
+        if (size <= 0 || size > sizes[n])
+        {
+            OSI_LOGXE(OSI_LOGPAR_SI, 0, "snapshot %s save failed %d", ops->name, size);
+            continue;
+        }
+
+        rec->id = ops->id;
+        rec->version = ops->version;
+        rec->size = size;
+        rec->crc = crc32Calc(data, size);
+        header->count++;
+        p += prvRecordSize(size);
+    }
+
+    header->magic = SNAPSHOT_MAGIC;
+    header->size = p - buf;
+    if (!osiPsmDataSave(OSI_PSMDATA_OWNER_SNAPSHOT, buf, header->size))
+        OSI_LOGE(0, "snapshot psm save failed size/%d", header->size);
+
+    gSnapshotCtx.save_size = header->size;
+    gSnapshotCtx.save_us = osiUpTimeUS() - start;
+    OSI_LOGI(0, "snapshot saved count/%d size/%d time/%dus", header->count,
+             gSnapshotCtx.save_size, gSnapshotCtx.save_us);
+    free(buf);
+}
+
+static void prvShutdownCb(void *ctx, osiShutdownMode_t mode)
+{
+    if (mode == OSI_SHUTDOWN_PSM_SLEEP)
+        prvSnapshotSave();
+}
+
+void srvSnapshotInit(void)
+{
+    if (osiGetBootMode() == OSI_BOOTMODE_PSM_RESTORE)
+    {
+        int psm_size = osiPsmDataRestore(OSI_PSMDATA_OWNER_SNAPSHOT, NULL, 0);
+        if (psm_size > 0)
+        {
+            void *buf = malloc(psm_size);
+            if (buf != NULL)
+            {
+                osiPsmDataRestore(OSI_PSMDATA_OWNER_SNAPSHOT, buf, psm_size);
+                if (prvSnapshotValid(buf, psm_size))
+                {
+                    gSnapshotCtx.loaded = buf;
+                    gSnapshotCtx.loaded_size = psm_size;
+                }
+                else
+                {
+                    OSI_LOGE(0, "snapshot psm restore invalid size/%d", psm_size);
+                    free(buf);
+                }
+            }
+        }
+        else
+        {
+            OSI_LOGW(0, "snapshot psm restore data not exist");
+        }
+    }
+
+    osiRegisterShutdownCallback(prvShutdownCb, NULL);
+}
+
+bool srvSnapshotRegister(const srvSnapshotOps_t *ops)
+{
+    if (ops == NULL || ops->save == NULL || ops->restore == NULL)
+        return false;
+
+    uint32_t critical = osiEnterCritical();
+    bool registered = false;
+    for (unsigned n = 0; n < gSnapshotCtx.count; n++)
+    {
+        if (gSnapshotCtx.ops[n]->id == ops->id)
+            registered = true;
+    }
+    bool ok = !registered && gSnapshotCtx.count < SRV_SNAPSHOT_COUNT;
+    if (ok)
+        gSnapshotCtx.ops[gSnapshotCtx.count++] = ops;
+    osiExitCritical(critical);
+
+    if (!ok)
+    {
+        OSI_LOGXE(OSI_LOGPAR_S, 0, "snapshot %s register failed", ops->name);
+        return false;
+    }
+
+    const srvSnapshotRecord_t *rec = prvFindRecord(ops->id);
+    if (rec == NULL)
+        return false;
+
+    int64_t start = osiUpTimeUS();
+    const uint8_t *data = (const uint8_t *)rec + sizeof(srvSnapshotRecord_t);
+    bool restored = ops->restore(ops->ctx, data, rec->size, rec->version);
+    OSI_LOGXI(OSI_LOGPAR_SIII, 0, "snapshot %s restore %d size/%d time/%dus",
+              ops->name, restored, rec->size, (int)(osiUpTimeUS() - start));
+    if (restored)
+        gSnapshotCtx.restored++;
+    return restored;
+}
+
+void srvSnapshotRestoreDone(void)
+{
+    uint32_t critical = osiEnterCritical();
+    void *loaded = gSnapshotCtx.loaded;
+    gSnapshotCtx.loaded = NULL;
+    osiExitCritical(critical);
+
+    free(loaded);
+}
+
+void srvSnapshotDump(void)
+{
+    for (unsigned n = 0; n < gSnapshotCtx.count; n++)
+    {
+        const srvSnapshotOps_t *ops = gSnapshotCtx.ops[n];
+        OSI_LOGXI(OSI_LOGPAR_SII, 0, "snapshot %s id/0x%x version/%d",
+                  ops->name, ops->id, ops->version);
+    }
+    OSI_LOGI(0, "snapshot registered/%d restored/%d loaded/%d", gSnapshotCtx.count,
+             gSnapshotCtx.restored, gSnapshotCtx.loaded_size);
+    OSI_LOGI(0, "snapshot last save size/%d time/%dus", gSnapshotCtx.save_size, gSnapshotCtx.save_us);
+}
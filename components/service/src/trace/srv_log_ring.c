@@ -0,0 +1,573 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#define OSI_LOCAL_LOG_TAG OSI_MAKE_LOG_TAG('L', 'R', 'N', 'G')
+#define OSI_LOCAL_LOG_LEVEL OSI_LOG_LEVEL_INFO
+
+/**
+ * \brief on-device log ring
+ *
+ * Application traces of selected tags are kept on device, for the case
+ * there are no host to capture trace when incident occurs.
+ *
+ * Trace records are copied into RAM staging blocks in trace sink. It is
+ * called inside critical section, so there are only memcpy. There are 2
+ * staging blocks, and a full block is compressed in log ring thread while
+ * the other is filled. When both are full, records are dropped.
+ *
+ * Compressed blocks are kept in RAM ring, and committed to file system
+ * periodically. The RAM ring is larger than the data between commits in
+ * normal case, and the oldest blocks will be dropped when it is full.
+ *
+ * Files are written in rotation, and each file is appended until it
+ * exceeds size limit. So, file system writes are in large pieces with low
+ * rate, and the erase are spread to all files.
+ *
+ * Block format (little endian):
+ * - block header, \p srvLogRingBlockHeader_t
+ * - block data, LZ4 block format or stored, \p data_size bytes
+ *
+ * Block raw data is a list of records:
+ * - uint32_t: up time in milliseconds
+ * - uint32_t: trace tag, the same as \p osiTraceSink_t
+ * - uint16_t: record data size
+ * - record data, the same as \p osiTraceSink_t
+ *
+ * tools/logring_decode.py can decode the files.
+ */
+
+#include "srv_trace.h"
+#include "srv_config.h"
+#include "osi_api.h"
+#include "osi_log.h"
+#include "osi_fifo.h"
+#include "vfs.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef CONFIG_SRV_LOG_RING_ENABLE
+
+#define LOGRING_BLOCK_SIZE (4096)
+#define LOGRING_RING_SIZE (32 * 1024)
+#define LOGRING_TAG_MAX (16)
+#define LOGRING_FILE_COUNT (4)
+#define LOGRING_FILE_SIZE_MAX (64 * 1024)
+#define LOGRING_COMMIT_INTERVAL (60 * 1000)
+#define LOGRING_FLUSH_TIMEOUT (5000)
+#define LOGRING_THREAD_PRIORITY OSI_PRIORITY_BELOW_NORMAL
+#define LOGRING_THREAD_STACK_SIZE (2048)
+#define LOGRING_FNAME_PATTERN SRV_LOG_RING_DIR "/logring-%d.bin"
+#define LOGRING_FNAME_MAX (48)
+
+#define LOGRING_BLOCK_MAGIC (0x524c) // LR
+#define LOGRING_BLOCK_STORED (0)
+#define LOGRING_BLOCK_LZ4 (1)
+#define LOGRING_RECORD_HEADER_SIZE (10)
+
+#define LZ4_HASH_LOG (10)
+#define LZ4_MIN_MATCH (4)
+#define LZ4_MFLIMIT (12)
+#define LZ4_LAST_LITERALS (5)
+#define LZ4_BOUND(n) ((n) + (n) / 255 + 16)
+
+typedef struct
+{
+    uint16_t magic;     // LOGRING_BLOCK_MAGIC
+    uint8_t flags;      // LOGRING_BLOCK_STORED or LOGRING_BLOCK_LZ4
+    uint8_t reserved;   //
+    uint32_t seq;       // block sequence
+    uint32_t epoch;     // epoch second at block compressed
+    uint32_t uptime;    // up time in milliseconds at block compressed
+    uint16_t raw_size;  // raw data size
+    uint16_t data_size; // block data size
+} srvLogRingBlockHeader_t;
+
+typedef struct
+{
+    unsigned size; // used size
+    bool full;     // waiting to be compressed
+    uint8_t data[LOGRING_BLOCK_SIZE];
+} srvLogRingStage_t;
+
+typedef struct
+{
+    osiWorkQueue_t *wq;          // log ring thread
+    osiWork_t *compress_work;    // compress full staging blocks
+    osiWork_t *commit_work;      // compress and commit to file system
+    osiTimer_t *commit_timer;    // periodic commit
+    osiMutex_t *file_lock;       // file access
+    unsigned tags[LOGRING_TAG_MAX]; // selected tags, without level
+    unsigned tag_count;          // selected tag count, 0 for all
+    srvLogRingStage_t stage[2];  // staging blocks
+    unsigned active;             // staging block index to be filled
+    osiFifo_t ring;              // compressed blocks
+    uint32_t seq;                // next block sequence
+    int fd;                      // current file descriptor
+    int file_index;              // current file index
+    int file_size;               // current file size
+    uint32_t dropped_records;    // records dropped at both staging full
+    uint32_t dropped_blocks;     // blocks dropped at RAM ring full
+    uint16_t hash[1 << LZ4_HASH_LOG];
+    uint8_t comp[sizeof(srvLogRingBlockHeader_t) + LZ4_BOUND(LOGRING_BLOCK_SIZE)];
+    uint8_t ring_mem[LOGRING_RING_SIZE];
+} srvLogRingContext_t;
+
+static srvLogRingContext_t *gLogRingCtx = NULL;
+
+static inline uint32_t prvRead32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+/**
+ * LZ4 length extension bytes
+ */
+static uint8_t *prvLz4PutLength(uint8_t *op, unsigned len)
+{
+    for (; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = len;
+    return op;
+}
+
+static uint8_t *prvLz4PutSequence(uint8_t *op, const uint8_t *lit, unsigned lit_len,
+                                  unsigned offset, unsigned match_len)
+{
+    uint8_t *token = op++;
+    *token = OSI_MIN(unsigned, lit_len, 15) << 4;
+    if (lit_len >= 15)
+        op = prvLz4PutLength(op, lit_len - 15);
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (offset == 0) // last literals
+        return op;
+
+    *op++ = offset & 0xff;
+    *op++ = offset >> 8;
+    match_len -= LZ4_MIN_MATCH;
+    *token |= OSI_MIN(unsigned, match_len, 15);
+    if (match_len >= 15)
+        op = prvLz4PutLength(op, match_len - 15);
+    return op;
+}
+
+/**
+ * LZ4 block compression, greedy with single hash table. The output is
+ * valid LZ4 block, and \p dst should be at least \p LZ4_BOUND(size).
+ */
+static unsigned prvLz4Compress(uint16_t *hash, const uint8_t *src, unsigned size, uint8_t *dst)
+{
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *end = src + size;
+    uint8_t *op = dst;
+
+    memset(hash, 0, sizeof(uint16_t) << LZ4_HASH_LOG);
+    if (size > LZ4_MFLIMIT)
+    {
+        const uint8_t *mflimit = end - LZ4_MFLIMIT;
+        const uint8_t *matchlimit = end - LZ4_LAST_LITERALS;
+        while (ip < mflimit)
+        {
+            uint32_t seq = prvRead32(ip);
+            unsigned h = (seq * 2654435761U) >> (32 - LZ4_HASH_LOG);
+            const uint8_t *ref = src + hash[h];
+            hash[h] = ip - src;
+            if (ref >= ip || prvRead32(ref) != seq)
+            {
+                ip++;
+                continue;
+            }
+
+            const uint8_t *mp = ip + LZ4_MIN_MATCH;
+            const uint8_t *rp = ref + LZ4_MIN_MATCH;
+            while (mp < matchlimit && *mp == *rp)
+            {
+                mp++;
+                rp++;
+            }
+
+            op = prvLz4PutSequence(op, anchor, ip - anchor, ip - ref, mp - ip);
+            ip = anchor = mp;
+        }
+    }
+
+    op = prvLz4PutSequence(op, anchor, end - anchor, 0, 0);
+    return op - dst;
+}
+
+static bool prvLogRingTagSelected(srvLogRingContext_t *d, unsigned tag)
+{
+    if (d->tag_count == 0)
+        return true;
+
+    tag &= 0x0fffffff;
+    for (unsigned n = 0; n < d->tag_count; n++)
+    {
+        if (d->tags[n] == tag)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Trace sink, called inside critical section
+ */
+static void prvLogRingSink(void *param, unsigned tag, const osiBuffer_t *bufs, unsigned count)
+{
+    srvLogRingContext_t *d = (srvLogRingContext_t *)param;
+    if (!prvLogRingTagSelected(d, tag))
+        return;
+
+    unsigned dsize = 0;
+    for (unsigned n = 0; n < count; n++)
+        dsize += bufs[n].size;
+
+    unsigned rsize = LOGRING_RECORD_HEADER_SIZE + dsize;
+    if (rsize > LOGRING_BLOCK_SIZE)
+    {
+        d->dropped_records++;
+        return;
+    }
+
+    srvLogRingStage_t *s = &d->stage[d->active];
+    if (s->full || s->size + rsize > LOGRING_BLOCK_SIZE)
+    {
+        if (!s->full)
+        {
+            s->full = true;
+            osiWorkEnqueue(d->compress_work, d->wq);
+        }
+
+        srvLogRingStage_t *next = &d->stage[d->active ^ 1];
+        if (next->full)
+        {
+            d->dropped_records++;
+            return;
+        }
+
+        d->active ^= 1;
+        s = next;
+    }
+
+    uint8_t *p = &s->data[s->size];
+    uint32_t tick = (uint32_t)osiUpTime();
+    uint16_t size16 = dsize;
+    memcpy(p, &tick, 4);
+    memcpy(p + 4, &tag, 4);
+    memcpy(p + 8, &size16, 2);
+    p += LOGRING_RECORD_HEADER_SIZE;
+    for (unsigned n = 0; n < count; n++)
+    {
+        memcpy(p, (const void *)bufs[n].ptr, bufs[n].size);
+        p += bufs[n].size;
+    }
+    s->size += rsize;
+}
+
+/**
+ * Put a block into RAM ring, the oldest blocks will be dropped when
+ * there are no enough space.
+ */
+static void prvLogRingPutBlock(srvLogRingContext_t *d, const void *block, unsigned size)
+{
+    while (osiFifoSpace(&d->ring) < size)
+    {
+        srvLogRingBlockHeader_t header;
+        osiFifoPeek(&d->ring, &header, sizeof(header));
+        osiFifoSkipBytes(&d->ring, sizeof(header) + header.data_size);
+        d->dropped_blocks++;
+    }
+    osiFifoPut(&d->ring, block, size);
+}
+
+/**
+ * Compress full staging blocks into RAM ring
+ */
+static void prvLogRingCompress(void *param)
+{
+    srvLogRingContext_t *d = (srvLogRingContext_t *)param;
+
+    for (unsigned n = 0; n < 2; n++)
+    {
+        srvLogRingStage_t *s = &d->stage[(d->active + 1 + n) % 2];
+        if (!s->full)
+            continue;
+
+        srvLogRingBlockHeader_t *header = (srvLogRingBlockHeader_t *)d->comp;
+        uint8_t *data = d->comp + sizeof(srvLogRingBlockHeader_t);
+        unsigned data_size = prvLz4Compress(d->hash, s->data, s->size, data);
+
+        header->magic = LOGRING_BLOCK_MAGIC;
+        header->flags = LOGRING_BLOCK_LZ4;
+        header->reserved = 0;
+        header->seq = d->seq++;
+        header->epoch = (uint32_t)osiEpochSecond();
+        header->uptime = (uint32_t)osiUpTime();
+        header->raw_size = s->size;
+        if (data_size >= s->size)
+        {
+            header->flags = LOGRING_BLOCK_STORED;
+            data_size = s->size;
+            memcpy(data, s->data, data_size);
+        }
+        header->data_size = data_size;
+
+        prvLogRingPutBlock(d, d->comp, sizeof(srvLogRingBlockHeader_t) + data_size);
+
+        unsigned critical = osiEnterCritical();
+        s->size = 0;
+        s->full = false;
+        osiExitCritical(critical);
+    }
+}
+
+static void prvLogRingFileName(char *path, int index)
+{
+    sprintf(path, LOGRING_FNAME_PATTERN, index);
+}
+
+/**
+ * Scan blocks of the file, return the end of the last valid block. The
+ * next sequence is updated.
+ */
+static int prvLogRingScanFile(srvLogRingContext_t *d, int fd)
+{
+    int pos = 0;
+    srvLogRingBlockHeader_t header;
+    while (vfs_read(fd, &header, sizeof(header)) == sizeof(header))
+    {
+        if (header.magic != LOGRING_BLOCK_MAGIC || header.data_size > LZ4_BOUND(LOGRING_BLOCK_SIZE))
+            break;
+
+        int next = pos + sizeof(header) + header.data_size;
+        if (vfs_lseek(fd, next, SEEK_SET) != next)
+            break;
+
+        pos = next;
+        d->seq = header.seq + 1;
+    }
+    return pos;
+}
+
+/**
+ * Open the file with the latest blocks, and continue to append it.
+ */
+static void prvLogRingOpenLatest(srvLogRingContext_t *d)
+{
+    char path[LOGRING_FNAME_MAX];
+    uint32_t latest_seq = 0;
+
+    d->file_index = 0;
+    for (int n = 0; n < LOGRING_FILE_COUNT; n++)
+    {
+        srvLogRingBlockHeader_t header;
+        prvLogRingFileName(path, n);
+        if (vfs_file_read(path, &header, sizeof(header)) != sizeof(header) ||
+            header.magic != LOGRING_BLOCK_MAGIC)
+            continue;
+
+        if (header.seq >= latest_seq)
+        {
+            latest_seq = header.seq;
+            d->file_index = n;
+        }
+    }
+
+    prvLogRingFileName(path, d->file_index);
+    if (vfs_mkfilepath(path, 0) != 0)
+        return;
+
+    d->fd = vfs_open(path, O_RDWR | O_CREAT);
+    if (d->fd < 0)
+        return;
+
+    // drop the partial block at power off
+    d->file_size = prvLogRingScanFile(d, d->fd);
+    vfs_ftruncate(d->fd, d->file_size);
+    vfs_lseek(d->fd, d->file_size, SEEK_SET);
+}
+
+/**
+ * Close current file, and truncate the next one in rotation.
+ */
+static bool prvLogRingRotate(srvLogRingContext_t *d)
+{
+    char path[LOGRING_FNAME_MAX];
+
+    if (d->fd >= 0)
+        vfs_close(d->fd);
+
+    d->file_index = (d->file_index + 1) % LOGRING_FILE_COUNT;
+    d->file_size = 0;
+    prvLogRingFileName(path, d->file_index);
+    d->fd = vfs_open(path, O_RDWR | O_CREAT | O_TRUNC);
+    return d->fd >= 0;
+}
+
+/**
+ * Compress pending records, and write all blocks in RAM ring to file
+ * system. Blocks are written as a whole, and won't cross files.
+ */
+static void prvLogRingCommit(void *param)
+{
+    srvLogRingContext_t *d = (srvLogRingContext_t *)param;
+
+    unsigned critical = osiEnterCritical();
+    srvLogRingStage_t *s = &d->stage[d->active];
+    if (!s->full && s->size > 0)
+    {
+        s->full = true;
+        d->active ^= 1;
+    }
+    osiExitCritical(critical);
+
+    prvLogRingCompress(d);
+
+    osiMutexLock(d->file_lock);
+    if (d->fd < 0)
+        prvLogRingOpenLatest(d);
+
+    bool written = false;
+    while (d->fd >= 0 && !osiFifoIsEmpty(&d->ring))
+    {
+        srvLogRingBlockHeader_t header;
+        osiFifoPeek(&d->ring, &header, sizeof(header));
+        unsigned size = sizeof(header) + header.data_size;
+        if (d->file_size + size > LOGRING_FILE_SIZE_MAX && !prvLogRingRotate(d))
+            break;
+
+        osiFifoPeek(&d->ring, d->comp, size);
+        if (vfs_write(d->fd, d->comp, size) != (ssize_t)size)
+            break;
+
+        osiFifoSkipBytes(&d->ring, size);
+        d->file_size += size;
+        written = true;
+    }
+
+    if (written)
+        vfs_fsync(d->fd);
+    osiMutexUnlock(d->file_lock);
+
+    if (d->dropped_records != 0 || d->dropped_blocks != 0)
+        OSI_LOGW(0, "log ring dropped records/%d blocks/%d", d->dropped_records, d->dropped_blocks);
+}
+
+bool srvLogRingAddTag(unsigned tag)
+{
+    srvLogRingContext_t *d = gLogRingCtx;
+    if (d == NULL)
+        return false;
+
+    tag &= 0x0fffffff;
+    bool ok = false;
+    unsigned critical = osiEnterCritical();
+    for (unsigned n = 0; n < d->tag_count; n++)
+    {
+        if (d->tags[n] == tag)
+            ok = true;
+    }
+    if (!ok && d->tag_count < LOGRING_TAG_MAX)
+    {
+        d->tags[d->tag_count++] = tag;
+        ok = true;
+    }
+    osiExitCritical(critical);
+    return ok;
+}
+
+bool srvLogRingFlush(void)
+{
+    srvLogRingContext_t *d = gLogRingCtx;
+    if (d == NULL)
+        return false;
+
+    osiWorkEnqueue(d->commit_work, d->wq);
+    return osiWorkWaitFinish(d->commit_work, LOGRING_FLUSH_TIMEOUT);
+}
+
+int srvLogRingRead(unsigned offset, void *buf, unsigned size)
+{
+    srvLogRingContext_t *d = gLogRingCtx;
+    if (d == NULL || (buf == NULL && size > 0))
+        return -1;
+
+    char path[LOGRING_FNAME_MAX];
+    int bytes = 0;
+
+    // oldest file first, the current file is the last
+    osiMutexLock(d->file_lock);
+    if (d->fd < 0)
+        prvLogRingOpenLatest(d);
+
+    for (int n = 1; n <= LOGRING_FILE_COUNT && size > 0; n++)
+    {
+        prvLogRingFileName(path, (d->file_index + n) % LOGRING_FILE_COUNT);
+        int fsize = vfs_file_size(path);
+        if (fsize <= 0)
+            continue;
+
+        if (offset >= (unsigned)fsize)
+        {
+            offset -= fsize;
+            continue;
+        }
+
+        int fd = vfs_open(path, O_RDONLY);
+        if (fd < 0)
+            break;
+
+        unsigned rsize = OSI_MIN(unsigned, size, fsize - offset);
+        int rbytes = -1;
+        if (vfs_lseek(fd, offset, SEEK_SET) == (long)offset)
+            rbytes = vfs_read(fd, buf, rsize);
+        vfs_close(fd);
+        if (rbytes <= 0)
+            break;
+
+        bytes += rbytes;
+        buf = (char *)buf + rbytes;
+        size -= rbytes;
+        offset = 0;
+    }
+    osiMutexUnlock(d->file_lock);
+    return bytes;
+}
+
+bool srvLogRingInit(void)
+{
+    if (gLogRingCtx != NULL)
+        return true;
+
+    srvLogRingContext_t *d = (srvLogRingContext_t *)calloc(1, sizeof(srvLogRingContext_t));
+    if (d == NULL)
+        return false;
+
+    d->fd = -1;
+    osiFifoInit(&d->ring, d->ring_mem, LOGRING_RING_SIZE);
+    d->file_lock = osiMutexCreate();
+    d->wq = osiWorkQueueCreate("logring", 1, LOGRING_THREAD_PRIORITY, LOGRING_THREAD_STACK_SIZE);
+    d->compress_work = osiWorkCreate(prvLogRingCompress, NULL, d);
+    d->commit_work = osiWorkCreate(prvLogRingCommit, NULL, d);
+    d->commit_timer = osiTimerCreateWork(d->commit_work, d->wq);
+    gLogRingCtx = d;
+    osiTimerStartPeriodicRelaxed(d->commit_timer, LOGRING_COMMIT_INTERVAL, OSI_DELAY_MAX);
+    osiTraceSetSink(prvLogRingSink, d);
+    return true;
+}
+
+#endif // CONFIG_SRV_LOG_RING_ENABLE
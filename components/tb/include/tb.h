@@ -79,6 +79,10 @@ extern "C" {
 #define TB_SMS_MSG_CONTENT_LEN_MAX 140
 #define TB_SMS_CONCAT_SMS_COUNT_MAX 5
 
+#define TB_WAN_STATUS_SUBSCRIBER_MAX 4
+#define TB_WAN_STATUS_CHANGED_SIGNAL (1 << 0)
+#define TB_WAN_STATUS_CHANGED_NETWORK (1 << 1)
+
 //enum
 typedef enum tb_wan_notify_type_enum
 {
@@ -224,6 +228,16 @@ typedef struct
     int rscp;
 } tb_wan_signal_info_s;
 
+//change thresholds of wan status subscription, 0/false to ignore
+typedef struct
+{
+    int rssi_delta;  //notify when rssi changes by at least this value
+    int rsrp_delta;  //notify when rsrp changes by at least this value, in dB
+    int rsrq_delta;  //notify when rsrq changes by at least this value
+    bool signal_bar; //notify when signal bar changes
+    bool network;    //notify when any field of network info changes
+} tb_wan_status_threshold_s;
+
 typedef struct
 {
     char config_name[TB_PROFILE_PARA_LEN];
@@ -333,6 +347,9 @@ typedef struct
 
 //type
 typedef void (*tb_wan_network_info_cb)(tb_wan_notify_type_e type, const char *value);
+//called in cfw event thread, shouldn't block. changed is TB_WAN_STATUS_CHANGED_XXX
+typedef void (*tb_wan_status_cb)(uint32_t changed, const tb_wan_network_info_s *network_info,
+                                 const tb_wan_signal_info_s *signal_info, void *ctx);
 typedef void (*tb_data_callback_fun)(tb_data_profile_id cid, tb_data_dial_status status);
 typedef void (*tb_sim_callback_fun)(tb_sim_status type);
 typedef void (*tb_sms_callback_fun)(tb_sms_status type, int value);
@@ -348,6 +365,8 @@ extern int tb_wan_reg_callback(tb_wan_network_info_cb wan_network_info_func);
 extern int tb_wan_get_network_type(char *type, int size);
 extern int tb_wan_get_network_info(tb_wan_network_info_s *network_info);
 extern int tb_wan_get_signal_info(tb_wan_signal_info_s *signal_info);
+extern int tb_wan_subscribe_status(const tb_wan_status_threshold_s *threshold, tb_wan_status_cb cb, void *ctx);
+extern int tb_wan_unsubscribe_status(tb_wan_status_cb cb, void *ctx);
 extern int tb_data_reg_callback(tb_data_callback_fun fun);
 extern int tb_data_wan_disconnect(tb_data_profile_id cid);
 extern int tb_data_get_dial_status(tb_data_profile_id cid, tb_data_dial_status *istatus);
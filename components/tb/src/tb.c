@@ -65,6 +65,13 @@ char g_tb_own_num[41] = {
 static uint8_t g_SMS_Unread_Msg = 0;
 static uint8_t gConnectingFlag = 0;
 
+static tb_WanSnapshot g_tb_wan_snapshot = {
+    0,
+};
+static tb_WanSubscriber g_tb_wan_subscribers[TB_WAN_STATUS_SUBSCRIBER_MAX] = {
+    0,
+};
+
 OSI_WEAK const char *AT_GMI_ID = GMI_ID;
 OSI_WEAK const char *AT_GMM_ID = GMM_ID;
 OSI_WEAK const char *AT_GMR_ID = GMR_ID;
@@ -150,9 +157,8 @@ int tb_wan_get_network_type(char *type, int size)
     }
 }
 
-int tb_wan_get_network_info(tb_wan_network_info_s *network_info)
+static int tb_wan_query_network_info(uint8_t nSim, tb_wan_network_info_s *network_info)
 {
-    uint8_t nSim = 0;
     uint8_t mode;
     uint8_t OperatorId[6];
     uint8_t nIMSI[15] = {
@@ -192,6 +198,7 @@ int tb_wan_get_network_info(tb_wan_network_info_s *network_info)
         free(pNetinfo);
         return TB_FAILURE;
     }
+    memset(network_info, 0, sizeof(tb_wan_network_info_s));
 
     OSI_LOGI(0, "tb_wan_get_network_info");
 
@@ -300,9 +307,8 @@ int tb_wan_get_network_info(tb_wan_network_info_s *network_info)
     return TB_SUCCESS;
 }
 
-int tb_wan_get_signal_info(tb_wan_signal_info_s *signal_info)
+static int tb_wan_query_signal_info(uint8_t nSim, tb_wan_signal_info_s *signal_info)
 {
-    uint8_t nSim = 0;
     uint8_t nRat = CFW_NWGetStackRat(nSim);
     CFW_NW_QUAL_INFO QualInfo = {0};
     OSI_LOGI(0, "tb_wan_get_signal_info");
@@ -311,6 +317,7 @@ int tb_wan_get_signal_info(tb_wan_signal_info_s *signal_info)
         OSI_LOGI(0, "tb_wan_get_signal_info,signal_info NULL");
         return TB_FAILURE;
     }
+    memset(signal_info, 0, sizeof(tb_wan_signal_info_s));
 
     if (CFW_NwGetQualReport(&QualInfo, nSim) != 0)
     {
@@ -340,6 +347,231 @@ int tb_wan_get_signal_info(tb_wan_signal_info_s *signal_info)
     return TB_SUCCESS;
 }
 
+static void tb_wan_snapshot_read(tb_WanSnapshot *snapshot)
+{
+    uint32_t seq;
+
+    do
+    {
+        seq = g_tb_wan_snapshot.seq;
+        OSI_DMB();
+        snapshot->network_valid = g_tb_wan_snapshot.network_valid;
+        snapshot->signal_valid = g_tb_wan_snapshot.signal_valid;
+        snapshot->network_info = g_tb_wan_snapshot.network_info;
+        snapshot->signal_info = g_tb_wan_snapshot.signal_info;
+        OSI_DMB();
+    } while ((seq & 1) != 0 || seq != g_tb_wan_snapshot.seq);
+}
+
+static void tb_wan_snapshot_write(const tb_wan_network_info_s *network_info, const tb_wan_signal_info_s *signal_info)
+{
+    uint32_t critical = osiEnterCritical();
+
+    g_tb_wan_snapshot.seq++;
+    OSI_DMB();
+    if (network_info != NULL)
+    {
+        g_tb_wan_snapshot.network_info = *network_info;
+        g_tb_wan_snapshot.network_valid = true;
+    }
+    if (signal_info != NULL)
+    {
+        g_tb_wan_snapshot.signal_info = *signal_info;
+        g_tb_wan_snapshot.signal_valid = true;
+    }
+    OSI_DMB();
+    g_tb_wan_snapshot.seq++;
+
+    osiExitCritical(critical);
+}
+
+static bool tb_wan_signal_exceed(const tb_wan_status_threshold_s *threshold,
+                                 const tb_wan_signal_info_s *prev, const tb_wan_signal_info_s *cur)
+{
+    if (threshold->signal_bar && prev->signal_bar != cur->signal_bar)
+        return true;
+    if (threshold->rssi_delta > 0 && abs(cur->rssi - prev->rssi) >= threshold->rssi_delta)
+        return true;
+    if (threshold->rsrp_delta > 0 && abs(cur->rsrp - prev->rsrp) >= threshold->rsrp_delta)
+        return true;
+    if (threshold->rsrq_delta > 0 && abs(cur->rsrq - prev->rsrq) >= threshold->rsrq_delta)
+        return true;
+    return false;
+}
+
+static void tb_wan_notify_subscribers(uint32_t changed, const tb_wan_network_info_s *network_info,
+                                      const tb_wan_signal_info_s *signal_info)
+{
+    for (int n = 0; n < TB_WAN_STATUS_SUBSCRIBER_MAX; n++)
+    {
+        tb_WanSubscriber *sub = &g_tb_wan_subscribers[n];
+        tb_WanSubscriber copy;
+        uint32_t notify = 0;
+
+        uint32_t critical = osiEnterCritical();
+        copy = *sub;
+        osiExitCritical(critical);
+        if (copy.cb == NULL)
+            continue;
+
+        if ((changed & TB_WAN_STATUS_CHANGED_NETWORK) && copy.threshold.network)
+            notify |= TB_WAN_STATUS_CHANGED_NETWORK;
+
+        // compared with the signal at last notification, so that slow drift is notified
+        if ((changed & TB_WAN_STATUS_CHANGED_SIGNAL) &&
+            (!copy.notified_valid || tb_wan_signal_exceed(&copy.threshold, &copy.notified_signal, signal_info)))
+        {
+            notify |= TB_WAN_STATUS_CHANGED_SIGNAL;
+            critical = osiEnterCritical();
+            if (sub->cb == copy.cb && sub->ctx == copy.ctx)
+            {
+                sub->notified_signal = *signal_info;
+                sub->notified_valid = true;
+            }
+            osiExitCritical(critical);
+        }
+
+        if (notify != 0)
+            copy.cb(notify, network_info, signal_info, copy.ctx);
+    }
+}
+
+static void tb_wan_refresh_status(uint8_t nSim, bool refresh_network)
+{
+    tb_WanSnapshot snapshot;
+    tb_wan_network_info_s network_info;
+    tb_wan_signal_info_s signal_info;
+    uint32_t changed = 0;
+
+    // snapshot is for the SIM used by tb_wan_get_xxx
+    if (nSim != 0)
+        return;
+
+    tb_wan_snapshot_read(&snapshot);
+    if (refresh_network && tb_wan_query_network_info(nSim, &network_info) == TB_SUCCESS)
+    {
+        if (!snapshot.network_valid || memcmp(&snapshot.network_info, &network_info, sizeof(network_info)) != 0)
+            changed |= TB_WAN_STATUS_CHANGED_NETWORK;
+        tb_wan_snapshot_write(&network_info, NULL);
+    }
+    else
+    {
+        network_info = snapshot.network_info;
+    }
+
+    if (tb_wan_query_signal_info(nSim, &signal_info) == TB_SUCCESS)
+    {
+        if (!snapshot.signal_valid || memcmp(&snapshot.signal_info, &signal_info, sizeof(signal_info)) != 0)
+            changed |= TB_WAN_STATUS_CHANGED_SIGNAL;
+        tb_wan_snapshot_write(NULL, &signal_info);
+    }
+    else
+    {
+        signal_info = snapshot.signal_info;
+    }
+
+    if (changed != 0)
+        tb_wan_notify_subscribers(changed, &network_info, &signal_info);
+}
+
+int tb_wan_get_network_info(tb_wan_network_info_s *network_info)
+{
+    tb_WanSnapshot snapshot;
+
+    if (network_info == NULL)
+    {
+        return TB_FAILURE;
+    }
+
+    tb_wan_snapshot_read(&snapshot);
+    if (snapshot.network_valid)
+    {
+        *network_info = snapshot.network_info;
+        return TB_SUCCESS;
+    }
+
+    // no indication yet
+    if (tb_wan_query_network_info(0, network_info) != TB_SUCCESS)
+    {
+        return TB_FAILURE;
+    }
+    tb_wan_snapshot_write(network_info, NULL);
+    return TB_SUCCESS;
+}
+
+int tb_wan_get_signal_info(tb_wan_signal_info_s *signal_info)
+{
+    tb_WanSnapshot snapshot;
+
+    if (signal_info == NULL)
+    {
+        return TB_FAILURE;
+    }
+
+    tb_wan_snapshot_read(&snapshot);
+    if (snapshot.signal_valid)
+    {
+        *signal_info = snapshot.signal_info;
+        return TB_SUCCESS;
+    }
+
+    // no indication yet
+    if (tb_wan_query_signal_info(0, signal_info) != TB_SUCCESS)
+    {
+        return TB_FAILURE;
+    }
+    tb_wan_snapshot_write(NULL, signal_info);
+    return TB_SUCCESS;
+}
+
+int tb_wan_subscribe_status(const tb_wan_status_threshold_s *threshold, tb_wan_status_cb cb, void *ctx)
+{
+    int result = TB_FAILURE;
+
+    OSI_LOGI(0, "tb_wan_subscribe_status, cb is 0x%x", cb);
+    if (threshold == NULL || cb == NULL)
+    {
+        return TB_FAILURE;
+    }
+
+    uint32_t critical = osiEnterCritical();
+    for (int n = 0; n < TB_WAN_STATUS_SUBSCRIBER_MAX; n++)
+    {
+        tb_WanSubscriber *sub = &g_tb_wan_subscribers[n];
+        if (sub->cb == NULL)
+        {
+            sub->threshold = *threshold;
+            sub->notified_valid = false;
+            sub->ctx = ctx;
+            sub->cb = cb;
+            result = TB_SUCCESS;
+            break;
+        }
+    }
+    osiExitCritical(critical);
+    return result;
+}
+
+int tb_wan_unsubscribe_status(tb_wan_status_cb cb, void *ctx)
+{
+    int result = TB_FAILURE;
+
+    OSI_LOGI(0, "tb_wan_unsubscribe_status, cb is 0x%x", cb);
+    uint32_t critical = osiEnterCritical();
+    for (int n = 0; n < TB_WAN_STATUS_SUBSCRIBER_MAX; n++)
+    {
+        tb_WanSubscriber *sub = &g_tb_wan_subscribers[n];
+        if (sub->cb == cb && sub->ctx == ctx)
+        {
+            memset(sub, 0, sizeof(tb_WanSubscriber));
+            result = TB_SUCCESS;
+            break;
+        }
+    }
+    osiExitCritical(critical);
+    return result;
+}
+
 int tb_data_reg_callback(tb_data_callback_fun fun)
 {
     OSI_LOGI(0, "tb_data_reg_callback");
@@ -1628,6 +1860,8 @@ static int tb_handle_nw_signal_quality_ind(const CFW_EVENT *cfw_event)
 
         g_tb_wan_network_info_cb(TB_WAN_NOTIFY_TYPE_SIG_BAR, (const char *)sSignalBar);
     }
+
+    tb_wan_refresh_status(nSim, false);
     return TB_SUCCESS;
 }
 
@@ -1790,6 +2024,8 @@ static int tb_handle_nw_status_ind(const CFW_EVENT *cfw_event)
             g_tb_wan_network_info_cb(TB_WAN_NOTIFY_TYPE_CELL_ID_INFO, (const char *)sCellId);
         }
     }
+
+    tb_wan_refresh_status(nSim, true);
     return TB_SUCCESS;
 }
 static void tb_handle_Gprs_Act_Rsp(void *ctx, const osiEvent_t *event)
@@ -1850,6 +2086,8 @@ static int tb_handle_Gprs_Active_Ind(const CFW_EVENT *cfw_event)
         return TB_SUCCESS;
     }
 
+    g_tb_data_dial_status[cfw_event->nParam1 - 1] = TB_DIAL_STATUS_CONNECTED;
+
     if (g_tb_data_callback_fun != NULL)
     {
         g_tb_data_callback_fun(cfw_event->nParam1, TB_DIAL_STATUS_CONNECTED);
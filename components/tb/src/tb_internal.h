@@ -33,9 +33,29 @@ typedef struct
     time_t saved_time;
 } tb_DataStatistics;
 
+//written from cfw indications, readers retry when seq is changed during copy
+typedef struct
+{
+    volatile uint32_t seq;
+    bool network_valid;
+    bool signal_valid;
+    tb_wan_network_info_s network_info;
+    tb_wan_signal_info_s signal_info;
+} tb_WanSnapshot;
+
+typedef struct
+{
+    tb_wan_status_cb cb;
+    void *ctx;
+    tb_wan_status_threshold_s threshold;
+    bool notified_valid;
+    tb_wan_signal_info_s notified_signal; //signal at last notification
+} tb_WanSubscriber;
+
 static int tb_get_signal_bar_gsm(uint8_t nCsq);
 static int tb_get_signal_bar_lte(uint8_t nRscp);
 static int tb_handle_nw_signal_quality_ind(const CFW_EVENT *cfw_event);
+static void tb_wan_refresh_status(uint8_t nSim, bool refresh_network);
 static void tb_IMSItoHomePlmn(uint8_t *InPut, uint8_t *OutPut, uint8_t *OutLen);
 static void tb_handle_Gprs_Act_Rsp(void *ctx, const osiEvent_t *event);
 static int tb_handle_Gprs_Active_Ind(const CFW_EVENT *cfw_event);
@@ -53,6 +53,10 @@ void ttsEngineIntfDelete(ttsEngineIntf_t *d);
  * data. When \p ttsOutputPcmData returns false, it shall return false
  * immediately.
  *
+ * TTS player splits text at sentence or phrase boundaries, and calls this
+ * for each chunk with the same instance. So, \p text may be not NUL
+ * terminated, and \p size should be respected.
+ *
  * \param d     TTS engine interface instance, must be valid
  * \param text  text in UTF-8
  * \param size  text size, NUL terminated length will be used when <= 0
@@ -27,6 +27,8 @@
 #define TTS_PIPE_SIZE (2048)
 #define TTS_WRITE_PIPE_TMEOUT (500)
 #define TTS_THREAD_PRIORITY (OSI_PRIORITY_ABOVE_NORMAL)
+#define TTS_CHUNK_MIN (16)
+#define TTS_CHUNK_MAX (256)
 
 typedef struct
 {
@@ -35,30 +37,128 @@ typedef struct
     osiWork_t *play_work;
     osiMutex_t *lock;
     auPlayer_t *player;
+    bool player_started;
     void *playtext;
+    int playsize;
+    unsigned encoding;
 } ttsContext_t;
 
 static ttsContext_t gTtsCtx;
 
 static void prvttsPlayerDelete(ttsContext_t *d);
 
+/**
+ * Whether there is a boundary after the character at text[pos], and
+ * return the character size. Sentence boundary is always accepted, and
+ * phrase boundary is accepted when \p phrase is true. ASCII punctuation
+ * should be followed by space, to avoid splitting numbers.
+ */
+static bool prvIsBoundary(const uint8_t *text, int pos, int size, bool phrase, int *csize)
+{
+    uint8_t c = text[pos];
+    if (c < 0x80)
+    {
+        *csize = 1;
+        bool spaced = (pos + 1 >= size || text[pos + 1] == ' ' || text[pos + 1] == '\n');
+        if (c == '\n' || ((c == '.' || c == '!' || c == '?' || c == ';') && spaced))
+            return true;
+        return phrase && (c == ',' || c == ':') && spaced;
+    }
+
+    *csize = (c >= 0xf0) ? 4 : (c >= 0xe0) ? 3 : (c >= 0xc0) ? 2 : 1;
+    if (*csize != 3 || pos + 3 > size)
+        return false;
+
+    // full width punctuation, in UTF-8
+    unsigned u = (c << 16) | (text[pos + 1] << 8) | text[pos + 2];
+    if (u == 0xe38082 || u == 0xefbc81 || u == 0xefbc9f || u == 0xefbc9b) // U+3002 U+FF01 U+FF1F U+FF1B
+        return true;
+    return phrase && (u == 0xefbc8c || u == 0xe38081 || u == 0xefbc9a); // U+FF0C U+3001 U+FF1A
+}
+
+/**
+ * Size of the next chunk to be synthesized from text[pos]. The first
+ * chunk can end at phrase boundary, to start playback as early as
+ * possible. Chunk won't split UTF-8 character.
+ */
+static int prvNextChunk(const uint8_t *text, int pos, int size, bool first)
+{
+    int end = pos;
+    int last_space = -1;
+    while (end < size)
+    {
+        int csize;
+        bool boundary = prvIsBoundary(text, end, size, first, &csize);
+        if (end + csize - pos > TTS_CHUNK_MAX)
+            break;
+
+        if (text[end] == ' ')
+            last_space = end + 1;
+        end += csize;
+        if (boundary && end - pos >= TTS_CHUNK_MIN)
+            return end - pos;
+    }
+
+    if (end < size && last_space > pos)
+        end = last_space;
+    if (end == pos) // broken UTF-8 at the end
+        end = size;
+    return end - pos;
+}
+
+static bool prvPlayerStartPipe(ttsContext_t *d)
+{
+    auFrame_t frame = {
+        .sample_format = AUSAMPLE_FORMAT_S16,
+        .channel_count = 1,
+        .sample_rate = CONFIG_TTS_PCM_SAMPLE_RATE,
+    };
+    auDecoderParamSet_t params[2] = {{AU_DEC_PARAM_FORMAT, &frame}, {0}};
+    return auPlayerStartPipe(d->player, AUSTREAM_FORMAT_PCM, params, d->pipe);
+}
+
 static void prvPlay(void *param)
 {
     ttsContext_t *d = (ttsContext_t *)param;
 
+    // conversion is done here rather than in caller
+    if (d->encoding != ML_UTF8)
+    {
+        void *utf8 = mlConvertStr(d->playtext, d->playsize, d->encoding, ML_UTF8, NULL);
+        if (utf8 == NULL)
+        {
+            OSI_LOGE(0, "tts text convert failed");
+            prvttsPlayerDelete(d);
+            return;
+        }
+        free(d->playtext);
+        d->playtext = utf8;
+        d->playsize = strlen(utf8);
+    }
+
     ttsEngineIntf_t *impl = ttsEngineIntfCreate();
     if (impl == NULL)
         goto failed_nomem;
 
-    if (!ttsEngineIntfSynthText(impl, d->playtext, -1))
+    // synthesize chunk by chunk, and the player is started at the first
+    // pcm output of the first chunk
+    const uint8_t *text = (const uint8_t *)d->playtext;
+    for (int pos = 0; pos < d->playsize;)
     {
-        OSI_LOGE(0, "tts synth failed, stop pipe");
-        osiPipeStop(d->pipe);
-        goto failed;
+        int size = prvNextChunk(text, pos, d->playsize, pos == 0);
+        OSI_LOGD(0, "tts synth chunk pos/%d size/%d", pos, size);
+        if (!ttsEngineIntfSynthText(impl, &text[pos], size))
+        {
+            OSI_LOGE(0, "tts synth failed, stop pipe");
+            osiPipeStop(d->pipe);
+            goto failed;
+        }
+        pos += size;
     }
 
     osiPipeSetEof(d->pipe);
-    auPlayerWaitFinish(d->player, OSI_WAIT_FOREVER);
+    if (d->player_started)
+        auPlayerWaitFinish(d->player, OSI_WAIT_FOREVER);
     osiPipeStop(d->pipe);
     ttsEngineIntfDelete(impl);
     prvttsPlayerDelete(d);
@@ -84,6 +184,7 @@ static void prvttsPlayerDelete(ttsContext_t *d)
     free(d->playtext);
     osiWorkDelete(d->play_work);
     d->player = NULL;
+    d->player_started = false;
     d->pipe = NULL;
     d->playtext = NULL;
     d->play_work = NULL;
@@ -103,21 +204,15 @@ static bool prvttsPlayerStart(ttsContext_t *d, const void *text, int size, unsig
     if (size < 0)
         size = strlen((const char *)text);
 
-    if (encoding == ML_UTF8)
-    {
-        d->playtext = (char *)calloc(1, size + 1);
-        if (d->playtext == NULL)
-            goto failed_nomem;
+    // 4 bytes NUL for UTF-16 or UCS-2 text
+    d->playtext = (char *)calloc(1, size + 4);
+    if (d->playtext == NULL)
+        goto failed_nomem;
 
-        memcpy(d->playtext, text, size);
-    }
-    else
-    {
-        d->playtext = (char *)mlConvertStr(text, size, encoding, ML_UTF8, NULL);
-        if (d->playtext == NULL)
-            goto failed_nomem;
-    }
-    OSI_LOGI(0, "tts play size/%d encoding/%d utf8/%d", size, encoding, strlen(d->playtext));
+    memcpy(d->playtext, text, size);
+    d->playsize = size;
+    d->encoding = encoding;
+    OSI_LOGI(0, "tts play size/%d encoding/%d", size, encoding);
 
     d->pipe = osiPipeCreate(TTS_PIPE_SIZE);
     if (d->pipe == NULL)
@@ -131,16 +226,6 @@ static bool prvttsPlayerStart(ttsContext_t *d, const void *text, int size, unsig
     if (d->play_work == NULL)
         goto failed_nomem;
 
-    auFrame_t frame = {
-        .sample_format = AUSAMPLE_FORMAT_S16,
-        .channel_count = 1,
-        .sample_rate = CONFIG_TTS_PCM_SAMPLE_RATE,
-    };
-    auDecoderParamSet_t params[2] = {{AU_DEC_PARAM_FORMAT, &frame}, {0}};
-
-    if (!auPlayerStartPipe(d->player, AUSTREAM_FORMAT_PCM, params, d->pipe))
-        goto failed;
-
     osiWorkEnqueue(d->play_work, d->wq);
     osiMutexUnlock(d->lock);
     return true;
@@ -150,11 +235,6 @@ failed_nomem:
     osiMutexUnlock(d->lock);
     prvttsPlayerDelete(d);
     return false;
-failed:
-    OSI_LOGE(0, "prvttsPlayerStart failed");
-    osiMutexUnlock(d->lock);
-    prvttsPlayerDelete(d);
-    return false;
 }
 
 void ttsPlayerInit(void)
@@ -207,6 +287,16 @@ bool ttsOutputPcmData(const void *data, unsigned size)
     if (d->pipe == NULL)
         return false;
 
+    if (!d->player_started && size > 0)
+    {
+        if (!prvPlayerStartPipe(d))
+        {
+            OSI_LOGE(0, "tts player start failed");
+            return false;
+        }
+        d->player_started = true;
+    }
+
     int written = osiPipeWriteAll(d->pipe, data, size, TTS_WRITE_PIPE_TMEOUT);
     OSI_LOGI(0, "pcm write size/%d written/%d", size, written);
     return (written == size);
@@ -0,0 +1,123 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _UNITY_BENCH_H_
+#define _UNITY_BENCH_H_
+
+#include "osi_compiler.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+OSI_EXTERN_C_BEGIN
+
+/**
+ * maximum measured iterations of one benchmark
+ */
+#define UNITY_BENCH_SAMPLE_MAX (128)
+
+/**
+ * benchmark context, used by \p TEST_BENCH
+ *
+ * Each iteration is measured by hardware tick. The fields shouldn't be
+ * accessed directly.
+ */
+typedef struct
+{
+    const char *name;
+    unsigned iterations;
+    unsigned done;
+    uint32_t bytes;
+    uint32_t start;
+    bool running;
+    uint32_t samples[UNITY_BENCH_SAMPLE_MAX];
+} unityBench_t;
+
+/**
+ * benchmark result
+ */
+typedef struct
+{
+    unsigned iterations; ///< measured iterations
+    uint32_t min_ns;     ///< minimal time of one iteration
+    uint32_t median_ns;  ///< median time of one iteration
+    uint32_t max_ns;     ///< maximum time of one iteration
+    uint32_t kbps;       ///< kilo bytes (1000) per second by median, 0 if bytes is 0
+} unityBenchResult_t;
+
+/**
+ * repeat the following statement or block, and report time
+ *
+ * Example:
+ * \code{.cpp}
+ * TEST(kernel, memcpy)
+ * {
+ *     TEST_BENCH("memcpy_4k", 64, 4096)
+ *     {
+ *         memcpy(dst, src, 4096);
+ *     }
+ * }
+ * \endcode
+ *
+ * After all iterations, a line is output through unity output:
+ * \code
+ * BENCH:memcpy_4k:iter=64:min_ns=...:med_ns=...:max_ns=...:kbps=...
+ * \endcode
+ *
+ * The line format is stable, and it is for host scripts to compare
+ * results among versions. \p break inside the body will stop the
+ * benchmark without report.
+ *
+ * \param name          benchmark name, constant string without ':'
+ * \param iterations    iteration count, at most \p UNITY_BENCH_SAMPLE_MAX
+ * \param bytes         processed bytes of each iteration, 0 for unknown
+ */
+#define TEST_BENCH(name, iterations, bytes)                                             \
+    for (unityBench_t _unity_bench, *_unity_bench_p =                                 \
+                                        (unityBenchStart(&_unity_bench, name,           \
+                                                         iterations, bytes),            \
+                                         &_unity_bench);                                \
+         unityBenchNext(_unity_bench_p);)
+
+/**
+ * \brief start benchmark
+ *
+ * \param bench         benchmark context
+ * \param name          benchmark name
+ * \param iterations    iteration count
+ * \param bytes         processed bytes of each iteration
+ */
+void unityBenchStart(unityBench_t *bench, const char *name, unsigned iterations, uint32_t bytes);
+
+/**
+ * \brief finish previous iteration, and start next iteration
+ *
+ * When all iterations are finished, the result is reported.
+ *
+ * \param bench         benchmark context
+ * \return
+ *      - true if next iteration is started
+ *      - false if all iterations are finished
+ */
+bool unityBenchNext(unityBench_t *bench);
+
+/**
+ * \brief calculate result of finished iterations
+ *
+ * The samples are sorted in place.
+ *
+ * \param bench         benchmark context
+ * \param result        output result
+ */
+void unityBenchCalc(unityBench_t *bench, unityBenchResult_t *result);
+
+OSI_EXTERN_C_END
+#endif
@@ -0,0 +1,104 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#include "unity_bench.h"
+#include "unity.h"
+#include "osi_api.h"
+#include "osi_api_inside.h"
+#include "kernel_config.h"
+#include <stdio.h>
+
+#define BENCH_LINE_SIZE (160)
+
+static uint32_t prvTickToNs(uint32_t tick)
+{
+    return (uint32_t)((uint64_t)tick * 1000000000ULL / CONFIG_KERNEL_HWTICK_FREQ);
+}
+
+void unityBenchStart(unityBench_t *bench, const char *name, unsigned iterations, uint32_t bytes)
+{
+    bench->name = name;
+    bench->iterations = (iterations > UNITY_BENCH_SAMPLE_MAX) ? UNITY_BENCH_SAMPLE_MAX : iterations;
+    bench->done = 0;
+    bench->bytes = bytes;
+    bench->start = 0;
+    bench->running = false;
+}
+
+void unityBenchCalc(unityBench_t *bench, unityBenchResult_t *result)
+{
+    unsigned count = bench->done;
+    uint32_t *samples = bench->samples;
+
+    // insertion sort, samples are few
+    for (unsigned n = 1; n < count; n++)
+    {
+        uint32_t val = samples[n];
+        unsigned m = n;
+        for (; m > 0 && samples[m - 1] > val; m--)
+            samples[m] = samples[m - 1];
+        samples[m] = val;
+    }
+
+    result->iterations = count;
+    result->min_ns = 0;
+    result->median_ns = 0;
+    result->max_ns = 0;
+    result->kbps = 0;
+    if (count == 0)
+        return;
+
+    uint32_t median = samples[count / 2];
+    result->min_ns = prvTickToNs(samples[0]);
+    result->median_ns = prvTickToNs(median);
+    result->max_ns = prvTickToNs(samples[count - 1]);
+    if (bench->bytes != 0)
+    {
+        // median less than 1 tick is regarded as 1 tick
+        uint64_t kbps = (uint64_t)bench->bytes * (CONFIG_KERNEL_HWTICK_FREQ / 1000) / (median == 0 ? 1 : median);
+        result->kbps = (kbps > UINT32_MAX) ? UINT32_MAX : (uint32_t)kbps;
+    }
+}
+
+static void prvBenchReport(unityBench_t *bench)
+{
+    unityBenchResult_t r;
+    unityBenchCalc(bench, &r);
+
+    char line[BENCH_LINE_SIZE];
+    snprintf(line, sizeof(line), "BENCH:%s:iter=%u:min_ns=%lu:med_ns=%lu:max_ns=%lu:kbps=%lu",
+             bench->name, r.iterations, (unsigned long)r.min_ns, (unsigned long)r.median_ns,
+             (unsigned long)r.max_ns, (unsigned long)r.kbps);
+    UnityPrint(line);
+    UNITY_PRINT_EOL();
+}
+
+bool unityBenchNext(unityBench_t *bench)
+{
+    // tick is read at first to exclude the overhead
+    uint32_t now = osiUpHWTick32();
+    if (bench->running)
+    {
+        bench->samples[bench->done++] = now - bench->start;
+        bench->running = false;
+    }
+
+    if (bench->done >= bench->iterations)
+    {
+        prvBenchReport(bench);
+        return false;
+    }
+
+    bench->running = true;
+    bench->start = osiUpHWTick32();
+    return true;
+}
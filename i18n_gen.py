@@ -0,0 +1,124 @@
+#!/usr/bin/python
+
+# _*_ coding: utf-8 _*_
+# @FileName:   i18n_gen.py
+# @Software:   VSCode
+# @Descripton: Script to generate lv_i18n phrase tables from csv file
+#
+# The csv file has a header row "msg_id,<locale>,<locale>...", the first
+# locale is the default one. Each phrase gets an id of lv_i18n_id_t, and a
+# translation table of a locale is indexed by the id, so _i(id) is an array
+# access. _(text) finds the id by a perfect hash of the text, the seed is
+# searched here so that every msg_id has its own slot.
+
+import csv
+import io
+import os
+import os.path
+import re
+import sys
+from optparse import OptionParser
+
+HASH_SEED_START=0x811c9dc5
+
+def Hash(seed, text):
+    h = seed
+    for c in bytearray(text.encode("utf-8")):
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+def IdName(msg_id):
+    return "LV_I18N_ID_" + re.sub(r"[^0-9A-Za-z]+", "_", msg_id).strip("_").upper()
+
+def LocaleName(locale):
+    return re.sub(r"[^0-9A-Za-z]+", "_", locale).lower()
+
+def CString(text):
+    return "\"" + text.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n") + "\""
+
+def FindSeed(msg_ids):
+    size = 1
+    while size < 2 * len(msg_ids):
+        size *= 2
+
+    while True:
+        for seed in range(HASH_SEED_START, HASH_SEED_START + 10000):
+            slots = set(Hash(seed, m) & (size - 1) for m in msg_ids)
+            if len(slots) == len(msg_ids):
+                return seed, size
+        size *= 2
+
+def Main():
+    parser = OptionParser()
+    parser.add_option('-o', dest = 'outDir',
+                      type = 'string',
+                      help = 'file out dir')
+    parser.add_option('-F', dest = 'csvFile',
+                      type = 'string',
+                      help = 'phrases desc file')
+
+    (options, args) = parser.parse_args()
+    if (options.outDir == None or options.csvFile == None):
+            print (parser.usage)
+            exit(0)
+
+    reader = csv.reader(io.open(options.csvFile, "r", encoding = "utf-8"))
+    header = next(reader)
+    locales = header[1:]
+    phrases = [row for row in reader if len(row) > 0 and row[0] != ""]
+
+    msg_ids = [row[0] for row in phrases]
+    names = [IdName(m) for m in msg_ids]
+    for i in range(len(names)):
+        if (names.index(names[i]) != i):
+            print ("msg_id \"%s\" and \"%s\" get the same id %s" % (msg_ids[names.index(names[i])], msg_ids[i], names[i]))
+            exit(1)
+
+    seed, size = FindSeed(msg_ids)
+    slots = [0] * size
+    for i in range(len(msg_ids)):
+        slots[Hash(seed, msg_ids[i]) & (size - 1)] = i + 1
+
+    h_file = io.open(os.path.join(options.outDir, "lv_i18n_table.h"), "w", encoding = "utf-8")
+    h_file.write(u"/*THIS FILE is auto generated by script, Don not modify it*/\n\n")
+    h_file.write(u"#ifndef __LV_I18N_TABLE_H__\n")
+    h_file.write(u"#define __LV_I18N_TABLE_H__\n\n")
+    h_file.write(u"#include <stdint.h>\n\n")
+    h_file.write(u"typedef enum {\n")
+    for i in range(len(names)):
+        h_file.write(u"    %s, // %s\n" % (names[i], msg_ids[i]))
+    h_file.write(u"    LV_I18N_ID_NUM,\n")
+    h_file.write(u"}lv_i18n_id_t;\n\n")
+    h_file.write(u"#define LV_I18N_HASH_SEED  0x%08x\n" % seed)
+    h_file.write(u"#define LV_I18N_HASH_SIZE  %d\n\n" % size)
+    h_file.write(u"extern const char * const lv_i18n_msg_ids[LV_I18N_ID_NUM];\n")
+    h_file.write(u"extern const uint16_t lv_i18n_hash_slots[LV_I18N_HASH_SIZE];\n")
+    for locale in locales:
+        h_file.write(u"extern const char * const lv_i18n_%s_table[LV_I18N_ID_NUM];\n" % LocaleName(locale))
+    h_file.write(u"\n#endif\n")
+    h_file.close()
+
+    c_file = io.open(os.path.join(options.outDir, "lv_i18n_table.c"), "w", encoding = "utf-8")
+    c_file.write(u"/*THIS FILE is auto generated by script, Don not modify it*/\n\n")
+    c_file.write(u"#include \"lv_i18n_table.h\"\n\n")
+    c_file.write(u"const char * const lv_i18n_msg_ids[LV_I18N_ID_NUM] = {\n")
+    for m in msg_ids:
+        c_file.write(u"    %s,\n" % CString(m))
+    c_file.write(u"};\n\n")
+    c_file.write(u"// id + 1 of the msg_id hashed to a slot, 0 for none\n")
+    c_file.write(u"const uint16_t lv_i18n_hash_slots[LV_I18N_HASH_SIZE] = {\n")
+    for i in range(0, size, 8):
+        c_file.write(u"    " + u" ".join(u"%d," % s for s in slots[i:i + 8]) + u"\n")
+    c_file.write(u"};\n")
+    for l in range(len(locales)):
+        c_file.write(u"\n// %s, NULL for no translation\n" % locales[l])
+        c_file.write(u"const char * const lv_i18n_%s_table[LV_I18N_ID_NUM] = {\n" % LocaleName(locales[l]))
+        for row in phrases:
+            text = row[l + 1] if len(row) > l + 1 else ""
+            c_file.write(u"    %s,\n" % (CString(text) if text != "" else u"NULL"))
+        c_file.write(u"};\n")
+    c_file.close()
+
+if __name__ == "__main__":
+    Main()
@@ -19,13 +19,256 @@ import csv
 import os
 import os.path
 import random
+import struct
 import sys
+import zlib
 from os import path
 from optparse import OptionParser
 
 php_path=r".\\tools\\php\\php.exe "
 lvglUtilPath=r".\\tools\\lvgl\\lv_utils\\img_conv_core.php"
 
+# image pack layout, see image_resource/image_pack.h
+IMAGE_PACK_MAGIC=0x4b504d49
+IMAGE_PACK_VERSION=1
+IMAGE_PACK_ALIGN=32
+
+def WritePack(packFile, images):
+    entrySize = 12
+    offset = 16 + entrySize * len(images)
+    entries = b""
+    payloads = b""
+    for header, data in images:
+        pad = (-offset) % IMAGE_PACK_ALIGN
+        payloads += b"\xff" * pad
+        offset += pad
+        entries += struct.pack("<III", header, offset, len(data))
+        payloads += data
+        offset += len(data)
+
+    f = open(packFile, "wb")
+    f.write(struct.pack("<IIII", IMAGE_PACK_MAGIC, IMAGE_PACK_VERSION, len(images), offset))
+    f.write(entries)
+    f.write(payloads)
+    f.close()
+
+# LVGL color formats, see lv_img_buf.h
+LV_IMG_CF = {"true_color": 4, "true_color_alpha": 5, "true_color_chroma": 6,
+             "indexed_1": 7, "indexed_2": 8, "indexed_4": 9, "indexed_8": 10,
+             "alpha_1": 11, "alpha_2": 12, "alpha_4": 13, "alpha_8": 14}
+
+# Read a PNG as rows of (r, g, b, a) pixels. Only what the UI images use is
+# supported: 8 bit gray, RGB(A) and 1..8 bit palette, not interlaced.
+# Returns None for other PNG files, they are converted by the php script.
+def ReadPng(pngFile):
+    data = open(pngFile, "rb").read()
+    if (data[0:8] != b"\x89PNG\r\n\x1a\n"):
+        return None
+
+    pos = 8
+    idat = b""
+    palette = []
+    trns = b""
+    while (pos < len(data)):
+        length, tag = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if (tag == b"IHDR"):
+            w, h, depth, colorType, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif (tag == b"PLTE"):
+            palette = [tuple(bytearray(chunk[i:i + 3])) for i in range(0, len(chunk), 3)]
+        elif (tag == b"tRNS"):
+            trns = bytearray(chunk)
+        elif (tag == b"IDAT"):
+            idat += chunk
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(colorType)
+    if (channels == None or interlace != 0 or (depth != 8 and colorType != 3)):
+        return None
+
+    raw = bytearray(zlib.decompress(idat))
+    bpp = max(1, channels * depth // 8)
+    stride = (w * channels * depth + 7) // 8
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for y in range(h):
+        filterType = raw[pos]
+        line = raw[pos + 1:pos + 1 + stride]
+        pos += 1 + stride
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if (filterType == 1):
+                line[i] = (line[i] + a) & 0xff
+            elif (filterType == 2):
+                line[i] = (line[i] + b) & 0xff
+            elif (filterType == 3):
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xff
+            elif (filterType == 4):
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[i] = (line[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xff
+        prev = line
+
+        row = []
+        for x in range(w):
+            if (colorType == 3):
+                bit = x * depth
+                idx = (line[bit >> 3] >> (8 - depth - (bit & 7))) & ((1 << depth) - 1)
+                alpha = trns[idx] if idx < len(trns) else 0xff
+                row.append(palette[idx] + (alpha,))
+            elif (colorType == 0):
+                row.append((line[x],) * 3 + (0xff,))
+            elif (colorType == 4):
+                row.append((line[2 * x],) * 3 + (line[2 * x + 1],))
+            elif (colorType == 2):
+                row.append(tuple(line[3 * x:3 * x + 3]) + (0xff,))
+            else:
+                row.append(tuple(line[4 * x:4 * x + 4]))
+        rows.append(row)
+
+    return rows
+
+# Pick the smallest color format that keeps the image: indexed if there are
+# at most 256 colors, else true color. Alpha only formats need recolor by the
+# user of the image, so they are used only if asked for in the csv file.
+def AutoColorFormat(rows):
+    h = len(rows)
+    w = len(rows[0])
+    colors = set()
+    opaque = True
+    for row in rows:
+        for r, g, b, a in row:
+            colors.add((r, g, b, a) if a else (0, 0, 0, 0))
+            opaque = opaque and a == 0xff
+
+    cf = "true_color" if opaque else "true_color_alpha"
+    size = w * h * (2 if opaque else 3)
+    for bits in [1, 2, 4, 8]:
+        indexedSize = 4 * (1 << bits) + (w * bits + 7) // 8 * h
+        if (len(colors) <= (1 << bits) and indexedSize < size):
+            return "indexed_%d" % bits
+    return cf
+
+# Convert the image to an indexed or alpha only format, the same data as the
+# php script would give. Returns the LVGL image payload without header.
+def ConvertPng(rows, cf):
+    bits = int(cf.split("_")[1])
+    data = b""
+    if (cf.startswith("indexed")):
+        palette = []
+        for row in rows:
+            for px in row:
+                px = px if px[3] else (0, 0, 0, 0)
+                if (px not in palette):
+                    palette.append(px)
+        if (len(palette) > (1 << bits)):
+            raise Exception(cf + ": too many colors " + str(len(palette)))
+        palette += [(0, 0, 0, 0)] * ((1 << bits) - len(palette))
+        # lv_color32_t: blue, green, red, alpha
+        for r, g, b, a in palette:
+            data += struct.pack("BBBB", b, g, r, a)
+        index = dict((px, i) for i, px in enumerate(palette))
+        values = [[index[px if px[3] else (0, 0, 0, 0)] for px in row] for row in rows]
+    else:
+        # the LVGL opacity of value v is v * 255 / (2^bits - 1)
+        vmax = (1 << bits) - 1
+        values = [[(px[3] * vmax + 127) // 255 for px in row] for row in rows]
+
+    # rows start on byte boundary, the first pixel is in the most significant bits
+    for row in values:
+        line = bytearray((len(row) * bits + 7) // 8)
+        for x, v in enumerate(row):
+            bit = x * bits
+            line[bit >> 3] |= v << (8 - bits - (bit & 7))
+        data += bytes(line)
+
+    return data
+
+def ImageHeader(cf, w, h):
+    return LV_IMG_CF[cf] | (w << 10) | (h << 21)
+
+def WriteCArray(outDir, name, cf, w, h, data):
+    f = open(os.path.join(outDir, name + ".c"), "w")
+    f.write("#if defined(PLATFORM_EC600)\n")
+    f.write("    #include \"lvgl.h\"\n")
+    f.write("    #else\n")
+    f.write("    #include \"lvgl/lvgl.h\"\n")
+    f.write("    #endif\n\n")
+    f.write("#ifndef LV_ATTRIBUTE_MEM_ALIGN\n")
+    f.write("#define LV_ATTRIBUTE_MEM_ALIGN\n")
+    f.write("#endif\n\n")
+    f.write("#ifndef LV_ATTRIBUTE_IMG_" + name + "\n")
+    f.write("#define LV_ATTRIBUTE_IMG_" + name + "\n")
+    f.write("#endif\n\n")
+    f.write("const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_IMG_" + name + " uint8_t " + name + "_map[] = {\n")
+    pos = 0
+    if (cf.startswith("indexed")):
+        bits = int(cf.split("_")[1])
+        for i in range(1 << bits):
+            f.write("  " + ", ".join("0x%02x" % c for c in bytearray(data[4 * i:4 * i + 4])) +
+                    ", \t/*Color of index " + str(i) + "*/\n")
+        pos = 4 << bits
+    stride = (len(data) - pos) // h
+    for y in range(h):
+        f.write("  " + ", ".join("0x%02x" % c for c in bytearray(data[pos:pos + stride])) + ", \n")
+        pos += stride
+    f.write("};\n\n")
+    f.write("const lv_img_dsc_t " + name + " = {\n")
+    f.write("  .header.always_zero = 0,\n")
+    f.write("  .header.w = " + str(w) + ",\n")
+    f.write("  .header.h = " + str(h) + ",\n")
+    f.write("  .data_size = " + str(len(data)) + ",\n")
+    f.write("  .header.cf = LV_IMG_CF_" + cf.upper() + "BIT,\n")
+    f.write("  .data = " + name + "_map,\n")
+    f.write("};\n")
+    f.close()
+
+# clockface package layout, see clockface/clockface_pkg.h
+CF_PKG_MAGIC=0x4b504643
+CF_PKG_VERSION=1
+CF_PKG_ALIGN=4
+CF_PKG_IMG_NONE=0xffff
+CLOCK_ANALOG=0
+
+# face is the json descriptor, images are referred by name in csv file:
+# {"bg": "name", "bg_pos": [0, 0], "center": [120, 120],
+#  "hour": "name", "minute": "name", "second": "name"}
+def WriteClockface(pkgFile, face, names, images):
+    def Index(key, required):
+        if (key not in face):
+            if (required):
+                raise Exception("clockface: no " + key)
+            return CF_PKG_IMG_NONE
+        return names.index(face[key])
+
+    bgPos = face.get("bg_pos", [0, 0])
+    center = face["center"]
+    desc = struct.pack("<B3xHHHHHHHH", CLOCK_ANALOG,
+                       Index("bg", False), Index("hour", True), Index("minute", True), Index("second", False),
+                       bgPos[0], bgPos[1], center[0], center[1])
+
+    entrySize = 12
+    offset = 16 + len(desc) + entrySize * len(images)
+    entries = b""
+    payloads = b""
+    for header, data in images:
+        pad = (-offset) % CF_PKG_ALIGN
+        payloads += b"\x00" * pad
+        offset += pad
+        entries += struct.pack("<III", header, offset, len(data))
+        payloads += data
+        offset += len(data)
+
+    f = open(pkgFile, "wb")
+    f.write(struct.pack("<IIII", CF_PKG_MAGIC, CF_PKG_VERSION, len(images), offset))
+    f.write(desc)
+    f.write(entries)
+    f.write(payloads)
+    f.close()
+
 def Main():
     outDir=None
     csvFile=None
@@ -44,11 +287,14 @@ def Main():
                       help = 'images desc file')
     parser.add_option("-c", "--cf",
                       dest = "cf",
-                      help = "color format: true_color, true_color_alpha, true_color_chroma, indexed_1, indexed_2, indexed_4, indexed_8, alpha_1, alpha_2, alpha_4, alpha_8, raw, raw_alpha, raw_chroma")
+                      help = "color format: auto, true_color, true_color_alpha, true_color_chroma, indexed_1, indexed_2, indexed_4, indexed_8, alpha_1, alpha_2, alpha_4, alpha_8, raw, raw_alpha, raw_chroma. The 3rd column of the csv file overrides it")
 
     parser.add_option("-f", "--format",
                       dest = "format",
-                      help = "output file format: c_array, bin_332, bin_565, bin_565_swap, bin_888")
+                      help = "output file format: c_array, bin_332, bin_565, bin_565_swap, bin_888, pack, clockface")
+    parser.add_option('-j', dest = 'faceFile',
+                      type = 'string',
+                      help = 'clockface json descriptor, for clockface format')
 
     (options, args) = parser.parse_args()
     if (options.outDir == None):
@@ -63,13 +309,13 @@ def Main():
     else:
             csvFile = options.csvFile
 
-    if (options.format == None or options.format not in ["c_array", "bin_332", "bin_565", "bin_565_swap", "bin_888"]):
+    if (options.format == None or options.format not in ["c_array", "bin_332", "bin_565", "bin_565_swap", "bin_888", "pack", "clockface"]):
             print (parser.usage)
             exit(0)
     else:
         Iformat = options.format
 
-    if (options.cf == None or options.cf not in ["true_color", "true_color_alpha", "true_color_chroma", "indexed_1", "indexed_2", "indexed_4", "indexed_8", "alpha_1", "alpha_2", "alpha_4", "alpha_8", "raw", "raw_alpha", "raw_chroma"]):
+    if (options.cf == None or options.cf not in ["auto", "true_color", "true_color_alpha", "true_color_chroma", "indexed_1", "indexed_2", "indexed_4", "indexed_8", "alpha_1", "alpha_2", "alpha_4", "alpha_8", "raw", "raw_alpha", "raw_chroma"]):
             print (parser.usage)
             exit(0)
     else:
@@ -79,11 +325,28 @@ def Main():
     list_c_file = None
     list_h_file = None
     declare_h_file=None
+    pack_images = []
+
+    # pack: one image_pack.bin with RGB565 payloads for XIP. The id list
+    # is still generated, and must match the pack in flash.
+    listGen = options.format in ["c_array", "pack"]
+    if (options.format == "pack"):
+        Iformat = "bin_565"
+
+    # clockface: one clockface.cfp with the json descriptor and images of
+    # the csv file, to be installed in file system
+    pack_names = []
+    if (options.format == "clockface"):
+        if (options.faceFile == None):
+            print (parser.usage)
+            exit(0)
+        Iformat = "bin_565"
 
-    if (options.format == "c_array"):
+    if (listGen):
         list_c_file = open(outDir+"/image_id_list.c", "w")
         list_c_file.write("/*THIS FILE is auto generated by script, Don not modify it*/\n\n")
         list_c_file.write("#include \"image_id_list.h\"\n\n")
+        list_c_file.write("#ifndef IC_IMAGE_PACK\n")
         list_c_file.write("const void* g_image_resource_list[IMAGE_ID_NUM] = {\n")
 
 
@@ -92,6 +355,7 @@ def Main():
         list_h_file.write("/*THIS FILE is auto generated by script, Don not modify it*/\n\n")
         list_h_file.write("#ifndef __IMAGE_ID_LIST_H__\n")
         list_h_file.write("#define __IMAGE_ID_LIST_H__\n\n")
+        list_h_file.write("#include \"image_config.h\"\n")
         list_h_file.write("#include \"image_declare.h\"\n\n")
         list_h_file.write("typedef enum {\n")
 
@@ -114,20 +378,56 @@ def Main():
     for row in reader:
         print(row)
 
-        #convert "name=icon&img=bunny.png&format=c_array&cf=true_color_alpha"
-        cmd = php_path + lvglUtilPath+ " \"dith=1&name="+row[0]+"&img="+row[1]+"&format="+Iformat+"&cf="+cf+"&outDir="+outDir+"\""
-        print(cmd)
-        os.system(cmd)
-
-        if (options.format == "c_array"):
+        # auto: the smallest format, but clockface packages support only true color
+        rowCf = row[2] if (len(row) > 2 and row[2] != "") else cf
+        pixels = None
+        if (rowCf == "auto" or rowCf.startswith("indexed") or rowCf.startswith("alpha")):
+            pixels = ReadPng(row[1])
+        if (rowCf == "auto"):
+            rowCf = AutoColorFormat(pixels) if pixels else "true_color_alpha"
+            if (options.format == "clockface" and rowCf.startswith("indexed")):
+                rowCf = "true_color_alpha"
+        print(row[0] + ": " + rowCf)
+
+        if (pixels and (rowCf.startswith("indexed") or rowCf.startswith("alpha"))):
+            w = len(pixels[0])
+            h = len(pixels)
+            data = ConvertPng(pixels, rowCf)
+            if (options.format in ["pack", "clockface"]):
+                pack_images.append((ImageHeader(rowCf, w, h), data))
+                pack_names.append(row[0])
+            else:
+                WriteCArray(outDir, row[0], rowCf, w, h, data)
+        else:
+            #convert "name=icon&img=bunny.png&format=c_array&cf=true_color_alpha"
+            cmd = php_path + lvglUtilPath+ " \"dith=1&name="+row[0]+"&img="+row[1]+"&format="+Iformat+"&cf="+rowCf+"&outDir="+outDir+"\""
+            print(cmd)
+            os.system(cmd)
+
+            if (options.format in ["pack", "clockface"]):
+                binFile = os.path.join(outDir, row[0]+".bin")
+                data = open(binFile, "rb").read()
+                os.remove(binFile)
+                pack_images.append((struct.unpack("<I", data[0:4])[0], data[4:]))
+                pack_names.append(row[0])
+
+        if (listGen):
             list_h_file.write("    "+row[0]+"_ID,\n")
             list_c_file.write("    &"+row[0]+",\n")
             #LV_IMG_DECLARE(analog_clock1_bg);
             declare_h_file.write("LV_IMG_DECLARE("+row[0]+");\n")
 
 
-    if (options.format == "c_array"):
+    if (options.format == "pack"):
+        WritePack(os.path.join(outDir, "image_pack.bin"), pack_images)
+
+    if (options.format == "clockface"):
+        face = json.load(open(options.faceFile, "r"))
+        WriteClockface(os.path.join(outDir, "clockface.cfp"), face, pack_names, pack_images)
+
+    if (listGen):
         list_c_file.write("};\n")
+        list_c_file.write("#endif\n")
 
         list_h_file.write("    IMAGE_ID_NUM,\n")
         list_h_file.write("}image_id_enum;\n\n")
@@ -137,7 +437,9 @@ def Main():
         list_h_file.write("}image_list_item_t;\n\n")
 
 
-        list_h_file.write("extern const void* g_image_resource_list[IMAGE_ID_NUM]; \n\n")
+        list_h_file.write("#ifndef IC_IMAGE_PACK\n")
+        list_h_file.write("extern const void* g_image_resource_list[IMAGE_ID_NUM]; \n")
+        list_h_file.write("#endif\n\n")
 
         list_h_file.write("#endif")
 
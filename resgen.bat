@@ -11,4 +11,8 @@
 
 @echo off
 
-py image_gen.py -o .\\components\\ql-application\\lv_widgets\\assets\\output\\ -F .\\components\\ql-application\\lv_widgets\\assets\\images\\image_res.csv -c true_color_alpha -f c_array
+:: "resgen.bat pack" generates image_pack.bin for IC_IMAGE_PACK, rather than C arrays
+set format=c_array
+if "%1"=="pack" set format=pack
+
+py image_gen.py -o .\\components\\ql-application\\lv_widgets\\assets\\output\\ -F .\\components\\ql-application\\lv_widgets\\assets\\images\\image_res.csv -c auto -f %format%
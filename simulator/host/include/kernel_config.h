@@ -0,0 +1,36 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _KERNEL_CONFIG_H_
+#define _KERNEL_CONFIG_H_
+
+#include "hal_config.h"
+
+// host build configuration, the values follow target defaults
+
+#define CONFIG_KERNEL_TICK_HZ 1000
+
+/**
+ * hardware tick is microsecond on host
+ */
+#define CONFIG_KERNEL_HWTICK_FREQ 1000000
+
+#define CONFIG_KERNEL_OSTICK_RELAXED_TIME 0
+
+#define CONFIG_KERNEL_ASSERT_ENABLED
+
+#define CONFIG_KERNEL_MIN_UTC_SECOND 946684800LL
+#define CONFIG_KERNEL_MAX_UTC_SECOND 4102444800LL
+
+#define CONFIG_KERNEL_HOST
+
+#endif
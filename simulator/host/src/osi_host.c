@@ -0,0 +1,617 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// POSIX port of OSI thread, event, semaphore, mutex, critical section,
+// time and trace, for running portable modules on host. It is not
+// cycle accurate, and ISR contexts don't exist on host.
+
+#include "osi_host.h"
+#include "osi_api.h"
+#include "osi_api_inside.h"
+#include "osi_log.h"
+#include <pthread.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOST_EVENT_QUEUE_DEPTH (64)
+#define HOST_THREAD_NAME_LEN (16)
+
+typedef struct
+{
+    osiEvent_t event;
+    osiCallback_t cb; // not NULL for callback
+    void *cb_ctx;
+} hostEventItem_t;
+
+struct osiThread
+{
+    pthread_t tid;
+    char name[HOST_THREAD_NAME_LEN];
+    osiThreadEntry_t entry;
+    void *argument;
+    uint32_t priority;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned rd;
+    unsigned wr;
+    unsigned depth;
+    hostEventItem_t *events;
+};
+
+struct osiSemaphore
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max_count;
+};
+
+struct osiMutex
+{
+    pthread_mutex_t lock;
+};
+
+bool gTraceEnabled = true;
+
+static pthread_mutex_t gCriticalLock;
+static pthread_once_t gCriticalOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t gThreadKey;
+static pthread_once_t gThreadKeyOnce = PTHREAD_ONCE_INIT;
+static int64_t gUpTimeBaseUS = -1;
+
+static int64_t prvMonoUS(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void osiHostDeadline(struct timespec *ts, uint32_t ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000)
+    {
+        ts->tv_sec += 1;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+void osiHostCondInit(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void prvCriticalInit(void)
+{
+    // critical section can be nested
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&gCriticalLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+uint32_t osiEnterCritical(void)
+{
+    pthread_once(&gCriticalOnce, prvCriticalInit);
+    pthread_mutex_lock(&gCriticalLock);
+    return 0;
+}
+
+void osiExitCritical(uint32_t critical)
+{
+    pthread_mutex_unlock(&gCriticalLock);
+}
+
+static void prvThreadKeyCreate(void)
+{
+    pthread_key_create(&gThreadKey, NULL);
+}
+
+static osiThread_t *prvThreadAlloc(const char *name, uint32_t event_count)
+{
+    osiThread_t *thread = (osiThread_t *)calloc(1, sizeof(osiThread_t));
+    if (thread == NULL)
+        return NULL;
+
+    if (event_count == 0)
+        event_count = HOST_EVENT_QUEUE_DEPTH;
+    thread->events = (hostEventItem_t *)calloc(event_count, sizeof(hostEventItem_t));
+    if (thread->events == NULL)
+    {
+        free(thread);
+        return NULL;
+    }
+
+    thread->depth = event_count;
+    snprintf(thread->name, sizeof(thread->name), "%s", name == NULL ? "" : name);
+    pthread_mutex_init(&thread->lock, NULL);
+    osiHostCondInit(&thread->cond);
+    return thread;
+}
+
+static void *prvThreadEntry(void *param)
+{
+    osiThread_t *thread = (osiThread_t *)param;
+    pthread_setspecific(gThreadKey, thread);
+    thread->entry(thread->argument);
+    return NULL;
+}
+
+osiThread_t *osiThreadCreate(const char *name, osiThreadEntry_t entry, void *argument,
+                             uint32_t priority, uint32_t stack_size,
+                             uint32_t event_count)
+{
+    pthread_once(&gThreadKeyOnce, prvThreadKeyCreate);
+    if (entry == NULL)
+        return NULL;
+
+    osiThread_t *thread = prvThreadAlloc(name, event_count);
+    if (thread == NULL)
+        return NULL;
+
+    thread->entry = entry;
+    thread->argument = argument;
+    thread->priority = priority;
+
+    // stack size on target is too small for host libc
+    if (pthread_create(&thread->tid, NULL, prvThreadEntry, thread) != 0)
+    {
+        free(thread->events);
+        free(thread);
+        return NULL;
+    }
+
+    pthread_detach(thread->tid);
+    return thread;
+}
+
+osiThread_t *osiThreadCreateWithStack(const char *name, osiThreadEntry_t entry, void *argument,
+                                      uint32_t priority, void *stack, uint32_t stack_size,
+                                      uint32_t event_count)
+{
+    return osiThreadCreate(name, entry, argument, priority, stack_size, event_count);
+}
+
+osiThread_t *osiThreadCurrent(void)
+{
+    pthread_once(&gThreadKeyOnce, prvThreadKeyCreate);
+    osiThread_t *thread = (osiThread_t *)pthread_getspecific(gThreadKey);
+    if (thread != NULL)
+        return thread;
+
+    // threads not created by osiThreadCreate, such as main
+    thread = prvThreadAlloc("host", 0);
+    if (thread == NULL)
+        return NULL;
+
+    thread->tid = pthread_self();
+    pthread_setspecific(gThreadKey, thread);
+    return thread;
+}
+
+uint32_t osiThreadPriority(osiThread_t *thread)
+{
+    return (thread == NULL) ? 0 : thread->priority;
+}
+
+bool osiThreadSetPriority(osiThread_t *thread, uint32_t priority)
+{
+    if (thread == NULL)
+        return false;
+    thread->priority = priority;
+    return true;
+}
+
+void osiThreadYield(void)
+{
+    sched_yield();
+}
+
+void osiThreadSleep(uint32_t ms)
+{
+    usleep((useconds_t)ms * 1000);
+}
+
+void osiThreadSleepUS(uint32_t us)
+{
+    usleep(us);
+}
+
+void osiThreadSleepRelaxed(uint32_t ms, uint32_t relax_ms)
+{
+    osiThreadSleep(ms);
+}
+
+void osiThreadExit(void)
+{
+    osiThread_t *thread = (osiThread_t *)pthread_getspecific(gThreadKey);
+    if (thread != NULL && thread->entry != NULL)
+    {
+        pthread_setspecific(gThreadKey, NULL);
+        pthread_mutex_destroy(&thread->lock);
+        pthread_cond_destroy(&thread->cond);
+        free(thread->events);
+        free(thread);
+    }
+    pthread_exit(NULL);
+}
+
+static bool prvEventPut(osiThread_t *thread, const hostEventItem_t *item, uint32_t timeout)
+{
+    if (thread == NULL)
+        return false;
+
+    struct timespec ts;
+    if (timeout != OSI_WAIT_FOREVER)
+        osiHostDeadline(&ts, timeout);
+
+    pthread_mutex_lock(&thread->lock);
+    while (thread->wr - thread->rd >= thread->depth)
+    {
+        int res = (timeout == OSI_WAIT_FOREVER)
+                      ? pthread_cond_wait(&thread->cond, &thread->lock)
+                      : pthread_cond_timedwait(&thread->cond, &thread->lock, &ts);
+        if (res == ETIMEDOUT)
+        {
+            pthread_mutex_unlock(&thread->lock);
+            return false;
+        }
+    }
+
+    thread->events[thread->wr++ % thread->depth] = *item;
+    pthread_cond_broadcast(&thread->cond);
+    pthread_mutex_unlock(&thread->lock);
+    return true;
+}
+
+bool osiEventSend(osiThread_t *thread, const osiEvent_t *event)
+{
+    if (event == NULL)
+        return false;
+
+    hostEventItem_t item = {.event = *event};
+    return prvEventPut(thread, &item, OSI_WAIT_FOREVER);
+}
+
+bool osiEventTrySend(osiThread_t *thread, const osiEvent_t *event, uint32_t timeout)
+{
+    if (event == NULL)
+        return false;
+
+    hostEventItem_t item = {.event = *event};
+    return prvEventPut(thread, &item, timeout);
+}
+
+bool osiThreadCallback(osiThread_t *thread, osiCallback_t cb, void *cb_ctx)
+{
+    if (cb == NULL)
+        return false;
+
+    hostEventItem_t item = {.cb = cb, .cb_ctx = cb_ctx};
+    return prvEventPut(thread, &item, OSI_WAIT_FOREVER);
+}
+
+bool osiEventTryWait(osiThread_t *thread, osiEvent_t *event, uint32_t timeout)
+{
+    if (thread == NULL || event == NULL)
+        return false;
+
+    struct timespec ts;
+    if (timeout != OSI_WAIT_FOREVER)
+        osiHostDeadline(&ts, timeout);
+
+    pthread_mutex_lock(&thread->lock);
+    while (thread->wr == thread->rd)
+    {
+        int res = (timeout == OSI_WAIT_FOREVER)
+                      ? pthread_cond_wait(&thread->cond, &thread->lock)
+                      : pthread_cond_timedwait(&thread->cond, &thread->lock, &ts);
+        if (res == ETIMEDOUT)
+        {
+            pthread_mutex_unlock(&thread->lock);
+            return false;
+        }
+    }
+
+    hostEventItem_t item = thread->events[thread->rd++ % thread->depth];
+    pthread_cond_broadcast(&thread->cond);
+    pthread_mutex_unlock(&thread->lock);
+
+    // callback is executed inside, the same as target
+    if (item.cb != NULL)
+    {
+        item.cb(item.cb_ctx);
+        event->id = OSI_EVENT_ID_NONE;
+        event->param1 = event->param2 = event->param3 = 0;
+    }
+    else
+    {
+        *event = item.event;
+    }
+    return true;
+}
+
+bool osiEventWait(osiThread_t *thread, osiEvent_t *event)
+{
+    return osiEventTryWait(thread, event, OSI_WAIT_FOREVER);
+}
+
+uint32_t osiEventPendingCount(osiThread_t *thread)
+{
+    if (thread == NULL)
+        return 0;
+
+    pthread_mutex_lock(&thread->lock);
+    uint32_t count = thread->wr - thread->rd;
+    pthread_mutex_unlock(&thread->lock);
+    return count;
+}
+
+bool osiEventPending(osiThread_t *thread)
+{
+    return osiEventPendingCount(thread) > 0;
+}
+
+uint32_t osiEventSpaceCount(osiThread_t *thread)
+{
+    if (thread == NULL)
+        return 0;
+    return thread->depth - osiEventPendingCount(thread);
+}
+
+osiSemaphore_t *osiSemaphoreCreate(uint32_t max_count, uint32_t init_count)
+{
+    if (max_count == 0 || init_count > max_count)
+        return NULL;
+
+    osiSemaphore_t *sema = (osiSemaphore_t *)calloc(1, sizeof(osiSemaphore_t));
+    if (sema == NULL)
+        return NULL;
+
+    pthread_mutex_init(&sema->lock, NULL);
+    osiHostCondInit(&sema->cond);
+    sema->count = init_count;
+    sema->max_count = max_count;
+    return sema;
+}
+
+void osiSemaphoreDelete(osiSemaphore_t *sema)
+{
+    if (sema == NULL)
+        return;
+
+    pthread_mutex_destroy(&sema->lock);
+    pthread_cond_destroy(&sema->cond);
+    free(sema);
+}
+
+bool osiSemaphoreTryAcquire(osiSemaphore_t *sema, uint32_t timeout)
+{
+    if (sema == NULL)
+        return false;
+
+    struct timespec ts;
+    if (timeout != OSI_WAIT_FOREVER)
+        osiHostDeadline(&ts, timeout);
+
+    pthread_mutex_lock(&sema->lock);
+    while (sema->count == 0)
+    {
+        int res = (timeout == OSI_WAIT_FOREVER)
+                      ? pthread_cond_wait(&sema->cond, &sema->lock)
+                      : pthread_cond_timedwait(&sema->cond, &sema->lock, &ts);
+        if (res == ETIMEDOUT)
+        {
+            pthread_mutex_unlock(&sema->lock);
+            return false;
+        }
+    }
+
+    sema->count--;
+    pthread_mutex_unlock(&sema->lock);
+    return true;
+}
+
+bool osiSemaphoreAcquire(osiSemaphore_t *sema)
+{
+    return osiSemaphoreTryAcquire(sema, OSI_WAIT_FOREVER);
+}
+
+void osiSemaphoreRelease(osiSemaphore_t *sema)
+{
+    if (sema == NULL)
+        return;
+
+    pthread_mutex_lock(&sema->lock);
+    if (sema->count < sema->max_count)
+        sema->count++;
+    pthread_cond_signal(&sema->cond);
+    pthread_mutex_unlock(&sema->lock);
+}
+
+osiMutex_t *osiMutexCreate(void)
+{
+    osiMutex_t *mutex = (osiMutex_t *)calloc(1, sizeof(osiMutex_t));
+    if (mutex == NULL)
+        return NULL;
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return mutex;
+}
+
+void osiMutexDelete(osiMutex_t *mutex)
+{
+    if (mutex == NULL)
+        return;
+
+    pthread_mutex_destroy(&mutex->lock);
+    free(mutex);
+}
+
+void osiMutexLock(osiMutex_t *mutex)
+{
+    if (mutex != NULL)
+        pthread_mutex_lock(&mutex->lock);
+}
+
+bool osiMutexTryLock(osiMutex_t *mutex, uint32_t timeout)
+{
+    if (mutex == NULL)
+        return false;
+
+    if (timeout == OSI_WAIT_FOREVER)
+        return pthread_mutex_lock(&mutex->lock) == 0;
+    if (timeout == 0)
+        return pthread_mutex_trylock(&mutex->lock) == 0;
+
+    // timed lock uses realtime clock
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout / 1000;
+    ts.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000;
+    }
+    return pthread_mutex_timedlock(&mutex->lock, &ts) == 0;
+}
+
+void osiMutexUnlock(osiMutex_t *mutex)
+{
+    if (mutex != NULL)
+        pthread_mutex_unlock(&mutex->lock);
+}
+
+int64_t osiUpTimeUS(void)
+{
+    int64_t now = prvMonoUS();
+    if (gUpTimeBaseUS < 0)
+    {
+        uint32_t critical = osiEnterCritical();
+        if (gUpTimeBaseUS < 0)
+            gUpTimeBaseUS = now;
+        osiExitCritical(critical);
+    }
+    return now - gUpTimeBaseUS;
+}
+
+int64_t osiUpTime(void)
+{
+    return osiUpTimeUS() / 1000;
+}
+
+int64_t osiUpHWTick(void)
+{
+    return osiUpTimeUS();
+}
+
+uint32_t osiUpHWTick32(void)
+{
+    return (uint32_t)osiUpTimeUS();
+}
+
+void osiElapsedTimerStart(osiElapsedTimer_t *timer)
+{
+    if (timer != NULL)
+        *timer = osiUpHWTick32();
+}
+
+uint32_t osiElapsedTime(osiElapsedTimer_t *timer)
+{
+    if (timer == NULL)
+        return 0;
+    return (osiUpHWTick32() - *timer) / 1000;
+}
+
+uint32_t osiElapsedTimeUS(osiElapsedTimer_t *timer)
+{
+    if (timer == NULL)
+        return 0;
+    return osiUpHWTick32() - *timer;
+}
+
+void osiDelayUS(uint32_t us)
+{
+    int64_t end = prvMonoUS() + us;
+    while (prvMonoUS() < end)
+        ;
+}
+
+void osiPanic(void)
+{
+    fprintf(stderr, "osiPanic\n");
+    abort();
+}
+
+void osiPanicAt(void *address)
+{
+    fprintf(stderr, "osiPanic at %p\n", address);
+    abort();
+}
+
+static const char *prvTagName(unsigned tag, char name[5])
+{
+    // OSI_MAKE_LOG_TAG packs 4 7-bits characters
+    for (unsigned n = 0; n < 4; n++)
+    {
+        char c = (tag >> (n * 7)) & 0x7f;
+        name[n] = (c >= ' ') ? c : ' ';
+    }
+    name[4] = '\0';
+    return name;
+}
+
+// Trace format is for host tools, and parameters may be not printf
+// compatible. So, only format and integer parameters are printed.
+void osiTraceBasic(unsigned tag, unsigned nargs, const char *fmt, ...)
+{
+    if (!gTraceEnabled)
+        return;
+
+    char name[5];
+    char line[256];
+    int len = snprintf(line, sizeof(line), "[%s] %s", prvTagName(tag, name), fmt);
+
+    va_list ap;
+    va_start(ap, fmt);
+    for (unsigned n = 0; n < nargs && len > 0 && len < (int)sizeof(line); n++)
+        len += snprintf(line + len, sizeof(line) - len, " 0x%x", va_arg(ap, unsigned));
+    va_end(ap);
+
+    fprintf(stderr, "%s\n", line);
+}
+
+void osiTraceEx(unsigned tag, unsigned partype, const char *fmt, ...)
+{
+    if (!gTraceEnabled)
+        return;
+
+    char name[5];
+    fprintf(stderr, "[%s] %s\n", prvTagName(tag, name), fmt);
+}
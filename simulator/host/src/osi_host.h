@@ -0,0 +1,30 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+#ifndef _OSI_HOST_H_
+#define _OSI_HOST_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * \brief monotonic deadline after \p ms, for pthread_cond_timedwait
+ */
+void osiHostDeadline(struct timespec *ts, uint32_t ms);
+
+/**
+ * \brief initialize condition variable with monotonic clock
+ */
+void osiHostCondInit(pthread_cond_t *cond);
+
+#endif
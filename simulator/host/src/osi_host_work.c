@@ -0,0 +1,615 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// POSIX port of OSI work, work queue and timer. Each work queue has its
+// own threads, and all timers are managed by one service thread.
+
+#include "osi_host.h"
+#include "osi_api.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/queue.h>
+
+#define HOST_WQ_THREAD_MAX (4)
+
+typedef TAILQ_HEAD(osiWorkHead, osiWork) osiWorkHead_t;
+
+struct osiWork
+{
+    osiCallback_t run;
+    osiCallback_t complete;
+    void *ctx;
+    osiWorkQueue_t *wq; // queued work queue, NULL if not queued
+    bool running;
+    bool delete_pending;
+    int64_t queued_us;
+    TAILQ_ENTRY(osiWork) iter;
+};
+
+struct osiWorkQueue
+{
+    pthread_cond_t cond;
+    osiWorkHead_t works;
+    bool quit;
+    size_t thread_count;
+    pthread_t threads[HOST_WQ_THREAD_MAX];
+    osiWorkQueueStat_t stat;
+};
+
+typedef enum
+{
+    HOST_TIMER_CALLBACK,
+    HOST_TIMER_WORK,
+    HOST_TIMER_EVENT,
+} hostTimerType_t;
+
+struct osiTimer
+{
+    hostTimerType_t type;
+    osiThread_t *thread;
+    osiCallback_t cb;
+    void *ctx;
+    osiWork_t *work;
+    osiWorkQueue_t *wq;
+    uint32_t timerid;
+    bool running;
+    bool periodic;
+    bool delete_pending;
+    int64_t expire_us;
+    int64_t period_us;
+    TAILQ_ENTRY(osiTimer) iter;
+};
+
+typedef TAILQ_HEAD(osiTimerHead, osiTimer) osiTimerHead_t;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    osiTimerHead_t timers; // sorted by expiration
+    osiTimer_t *firing;    // timer with callback running in service
+} hostTimerContext_t;
+
+// single lock for all works, work may be moved among work queues
+static pthread_mutex_t gWorkLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gWorkFinishCond;
+static pthread_once_t gWorkOnce = PTHREAD_ONCE_INIT;
+static __thread osiWork_t *gCurrentWork;
+
+static osiWorkQueue_t *gWqHigh;
+static osiWorkQueue_t *gWqLow;
+static osiWorkQueue_t *gWqFileWrite;
+static pthread_once_t gSysWqOnce = PTHREAD_ONCE_INIT;
+
+static hostTimerContext_t gTimerCtx;
+static pthread_once_t gTimerOnce = PTHREAD_ONCE_INIT;
+
+static void prvWorkInit(void)
+{
+    osiHostCondInit(&gWorkFinishCond);
+}
+
+osiWork_t *osiWorkCreate(osiCallback_t run, osiCallback_t complete, void *ctx)
+{
+    pthread_once(&gWorkOnce, prvWorkInit);
+    if (run == NULL)
+        return NULL;
+
+    osiWork_t *work = (osiWork_t *)calloc(1, sizeof(osiWork_t));
+    if (work == NULL)
+        return NULL;
+
+    work->run = run;
+    work->complete = complete;
+    work->ctx = ctx;
+    return work;
+}
+
+static void prvWorkDequeue(osiWork_t *work)
+{
+    if (work->wq != NULL)
+    {
+        TAILQ_REMOVE(&work->wq->works, work, iter);
+        work->wq = NULL;
+    }
+}
+
+void osiWorkDelete(osiWork_t *work)
+{
+    if (work == NULL)
+        return;
+
+    pthread_mutex_lock(&gWorkLock);
+    prvWorkDequeue(work);
+    if (work->running && gCurrentWork == work)
+    {
+        // deleted in its own callback, freed after callback
+        work->delete_pending = true;
+        pthread_mutex_unlock(&gWorkLock);
+        return;
+    }
+
+    while (work->running)
+        pthread_cond_wait(&gWorkFinishCond, &gWorkLock);
+    pthread_cond_broadcast(&gWorkFinishCond);
+    pthread_mutex_unlock(&gWorkLock);
+    free(work);
+}
+
+bool osiWorkResetCallback(osiWork_t *work, osiCallback_t run, osiCallback_t complete, void *ctx)
+{
+    if (work == NULL || run == NULL)
+        return false;
+
+    pthread_mutex_lock(&gWorkLock);
+    bool ok = (work->wq == NULL && !work->running);
+    if (ok)
+    {
+        work->run = run;
+        work->complete = complete;
+        work->ctx = ctx;
+    }
+    pthread_mutex_unlock(&gWorkLock);
+    return ok;
+}
+
+static bool prvWorkEnqueue(osiWork_t *work, osiWorkQueue_t *wq, bool last)
+{
+    if (work == NULL || wq == NULL)
+        return false;
+
+    pthread_mutex_lock(&gWorkLock);
+    if (work->wq != wq || last)
+    {
+        prvWorkDequeue(work);
+        TAILQ_INSERT_TAIL(&wq->works, work, iter);
+        work->wq = wq;
+        work->queued_us = osiUpTimeUS();
+        wq->stat.enqueued++;
+        pthread_cond_signal(&wq->cond);
+    }
+    pthread_mutex_unlock(&gWorkLock);
+    return true;
+}
+
+bool osiWorkEnqueue(osiWork_t *work, osiWorkQueue_t *wq)
+{
+    return prvWorkEnqueue(work, wq, false);
+}
+
+bool osiWorkEnqueueLast(osiWork_t *work, osiWorkQueue_t *wq)
+{
+    return prvWorkEnqueue(work, wq, true);
+}
+
+void osiWorkCancel(osiWork_t *work)
+{
+    if (work == NULL)
+        return;
+
+    pthread_mutex_lock(&gWorkLock);
+    prvWorkDequeue(work);
+    pthread_cond_broadcast(&gWorkFinishCond);
+    pthread_mutex_unlock(&gWorkLock);
+}
+
+bool osiWorkWaitFinish(osiWork_t *work, unsigned timeout)
+{
+    if (work == NULL)
+        return false;
+
+    struct timespec ts;
+    if (timeout != OSI_WAIT_FOREVER)
+        osiHostDeadline(&ts, timeout);
+
+    pthread_mutex_lock(&gWorkLock);
+    bool finished = true;
+    while (work->wq != NULL || work->running)
+    {
+        int res = (timeout == OSI_WAIT_FOREVER)
+                      ? pthread_cond_wait(&gWorkFinishCond, &gWorkLock)
+                      : pthread_cond_timedwait(&gWorkFinishCond, &gWorkLock, &ts);
+        if (res == ETIMEDOUT)
+        {
+            finished = (work->wq == NULL && !work->running);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&gWorkLock);
+    return finished;
+}
+
+static void *prvWorkQueueEntry(void *param)
+{
+    osiWorkQueue_t *wq = (osiWorkQueue_t *)param;
+
+    pthread_mutex_lock(&gWorkLock);
+    while (!wq->quit)
+    {
+        osiWork_t *work = TAILQ_FIRST(&wq->works);
+        if (work == NULL)
+        {
+            pthread_cond_wait(&wq->cond, &gWorkLock);
+            continue;
+        }
+
+        prvWorkDequeue(work);
+        work->running = true;
+        gCurrentWork = work;
+        int64_t start_us = osiUpTimeUS();
+        uint32_t latency_us = (uint32_t)(start_us - work->queued_us);
+        if (latency_us > wq->stat.max_latency_us)
+            wq->stat.max_latency_us = latency_us;
+
+        osiCallback_t run = work->run;
+        osiCallback_t complete = work->complete;
+        void *ctx = work->ctx;
+        pthread_mutex_unlock(&gWorkLock);
+
+        run(ctx);
+        if (complete != NULL)
+            complete(ctx);
+
+        pthread_mutex_lock(&gWorkLock);
+        uint32_t run_us = (uint32_t)(osiUpTimeUS() - start_us);
+        if (run_us > wq->stat.max_run_us)
+            wq->stat.max_run_us = run_us;
+        wq->stat.executed++;
+
+        gCurrentWork = NULL;
+        work->running = false;
+        if (work->delete_pending)
+        {
+            prvWorkDequeue(work);
+            free(work);
+        }
+        pthread_cond_broadcast(&gWorkFinishCond);
+    }
+    pthread_mutex_unlock(&gWorkLock);
+    return NULL;
+}
+
+osiWorkQueue_t *osiWorkQueueCreate(const char *name, size_t thread_count, uint32_t priority, uint32_t stack_size)
+{
+    pthread_once(&gWorkOnce, prvWorkInit);
+    if (thread_count == 0 || thread_count > HOST_WQ_THREAD_MAX)
+        return NULL;
+
+    osiWorkQueue_t *wq = (osiWorkQueue_t *)calloc(1, sizeof(osiWorkQueue_t));
+    if (wq == NULL)
+        return NULL;
+
+    osiHostCondInit(&wq->cond);
+    TAILQ_INIT(&wq->works);
+    for (size_t n = 0; n < thread_count; n++)
+    {
+        if (pthread_create(&wq->threads[n], NULL, prvWorkQueueEntry, wq) != 0)
+        {
+            osiWorkQueueDelete(wq);
+            return NULL;
+        }
+        wq->thread_count++;
+    }
+    return wq;
+}
+
+void osiWorkQueueDelete(osiWorkQueue_t *wq)
+{
+    if (wq == NULL)
+        return;
+
+    pthread_mutex_lock(&gWorkLock);
+    wq->quit = true;
+    pthread_cond_broadcast(&wq->cond);
+    pthread_mutex_unlock(&gWorkLock);
+
+    for (size_t n = 0; n < wq->thread_count; n++)
+        pthread_join(wq->threads[n], NULL);
+
+    pthread_mutex_lock(&gWorkLock);
+    osiWork_t *work;
+    while ((work = TAILQ_FIRST(&wq->works)) != NULL)
+        prvWorkDequeue(work);
+    pthread_cond_broadcast(&gWorkFinishCond);
+    pthread_mutex_unlock(&gWorkLock);
+
+    pthread_cond_destroy(&wq->cond);
+    free(wq);
+}
+
+bool osiWorkQueueGetStat(osiWorkQueue_t *wq, osiWorkQueueStat_t *stat, bool reset)
+{
+    if (wq == NULL || stat == NULL)
+        return false;
+
+    pthread_mutex_lock(&gWorkLock);
+    *stat = wq->stat;
+    if (reset)
+        memset(&wq->stat, 0, sizeof(wq->stat));
+    pthread_mutex_unlock(&gWorkLock);
+    return true;
+}
+
+static void prvSysWorkQueueInit(void)
+{
+    gWqHigh = osiWorkQueueCreate("wq_hi", 1, OSI_PRIORITY_HIGH, 0);
+    gWqLow = osiWorkQueueCreate("wq_lo", 1, OSI_PRIORITY_LOW, 0);
+    gWqFileWrite = osiWorkQueueCreate("wq_fs", 1, OSI_PRIORITY_BELOW_NORMAL, 0);
+}
+
+osiWorkQueue_t *osiSysWorkQueueHighPriority(void)
+{
+    pthread_once(&gSysWqOnce, prvSysWorkQueueInit);
+    return gWqHigh;
+}
+
+osiWorkQueue_t *osiSysWorkQueueLowPriority(void)
+{
+    pthread_once(&gSysWqOnce, prvSysWorkQueueInit);
+    return gWqLow;
+}
+
+osiWorkQueue_t *osiSysWorkQueueFileWrite(void)
+{
+    pthread_once(&gSysWqOnce, prvSysWorkQueueInit);
+    return gWqFileWrite;
+}
+
+static void prvTimerRemove(osiTimer_t *timer)
+{
+    if (timer->running)
+    {
+        TAILQ_REMOVE(&gTimerCtx.timers, timer, iter);
+        timer->running = false;
+    }
+}
+
+static void prvTimerInsert(osiTimer_t *timer)
+{
+    osiTimer_t *p;
+    TAILQ_FOREACH(p, &gTimerCtx.timers, iter)
+    {
+        if (p->expire_us > timer->expire_us)
+            break;
+    }
+
+    if (p == NULL)
+        TAILQ_INSERT_TAIL(&gTimerCtx.timers, timer, iter);
+    else
+        TAILQ_INSERT_BEFORE(p, timer, iter);
+    timer->running = true;
+    pthread_cond_signal(&gTimerCtx.cond);
+}
+
+static void *prvTimerEntry(void *param)
+{
+    hostTimerContext_t *d = &gTimerCtx;
+
+    pthread_mutex_lock(&d->lock);
+    for (;;)
+    {
+        osiTimer_t *timer = TAILQ_FIRST(&d->timers);
+        if (timer == NULL)
+        {
+            pthread_cond_wait(&d->cond, &d->lock);
+            continue;
+        }
+
+        int64_t now = osiUpTimeUS();
+        if (timer->expire_us > now)
+        {
+            uint32_t ms = (uint32_t)((timer->expire_us - now + 999) / 1000);
+            struct timespec ts;
+            osiHostDeadline(&ts, ms);
+            pthread_cond_timedwait(&d->cond, &d->lock, &ts);
+            continue;
+        }
+
+        prvTimerRemove(timer);
+        if (timer->periodic)
+        {
+            timer->expire_us += timer->period_us;
+            prvTimerInsert(timer);
+        }
+
+        if (timer->type == HOST_TIMER_WORK)
+        {
+            osiWorkEnqueue(timer->work, timer->wq);
+        }
+        else if (timer->type == HOST_TIMER_EVENT)
+        {
+            osiEvent_t event = {.id = timer->timerid};
+            osiEventTrySend(timer->thread, &event, 0);
+        }
+        else if (timer->thread != NULL && timer->thread != OSI_TIMER_IN_SERVICE)
+        {
+            osiThreadCallback(timer->thread, timer->cb, timer->ctx);
+        }
+        else
+        {
+            // callback in service thread, and timer can't be freed now
+            osiCallback_t cb = timer->cb;
+            void *ctx = timer->ctx;
+            d->firing = timer;
+            pthread_mutex_unlock(&d->lock);
+            cb(ctx);
+            pthread_mutex_lock(&d->lock);
+            d->firing = NULL;
+            if (timer->delete_pending)
+                free(timer);
+            pthread_cond_broadcast(&d->cond);
+        }
+    }
+    pthread_mutex_unlock(&d->lock);
+    return NULL;
+}
+
+static void prvTimerInit(void)
+{
+    hostTimerContext_t *d = &gTimerCtx;
+    pthread_mutex_init(&d->lock, NULL);
+    osiHostCondInit(&d->cond);
+    TAILQ_INIT(&d->timers);
+    pthread_create(&d->thread, NULL, prvTimerEntry, NULL);
+    pthread_detach(d->thread);
+}
+
+static osiTimer_t *prvTimerCreate(hostTimerType_t type)
+{
+    pthread_once(&gTimerOnce, prvTimerInit);
+    osiTimer_t *timer = (osiTimer_t *)calloc(1, sizeof(osiTimer_t));
+    if (timer != NULL)
+        timer->type = type;
+    return timer;
+}
+
+osiTimer_t *osiTimerCreate(osiThread_t *thread, osiCallback_t cb, void *ctx)
+{
+    if (cb == NULL)
+        return NULL;
+
+    osiTimer_t *timer = prvTimerCreate(HOST_TIMER_CALLBACK);
+    if (timer == NULL)
+        return NULL;
+
+    timer->thread = thread;
+    timer->cb = cb;
+    timer->ctx = ctx;
+    return timer;
+}
+
+osiTimer_t *osiTimerCreateWork(osiWork_t *work, osiWorkQueue_t *wq)
+{
+    if (work == NULL || wq == NULL)
+        return NULL;
+
+    osiTimer_t *timer = prvTimerCreate(HOST_TIMER_WORK);
+    if (timer == NULL)
+        return NULL;
+
+    timer->work = work;
+    timer->wq = wq;
+    return timer;
+}
+
+osiTimer_t *osiTimerEventCreate(osiThread_t *thread, uint32_t timerid)
+{
+    if (thread == NULL)
+        return NULL;
+
+    osiTimer_t *timer = prvTimerCreate(HOST_TIMER_EVENT);
+    if (timer == NULL)
+        return NULL;
+
+    timer->thread = thread;
+    timer->timerid = timerid;
+    return timer;
+}
+
+void osiTimerDelete(osiTimer_t *timer)
+{
+    if (timer == NULL)
+        return;
+
+    hostTimerContext_t *d = &gTimerCtx;
+    pthread_mutex_lock(&d->lock);
+    prvTimerRemove(timer);
+    if (d->firing == timer && pthread_equal(pthread_self(), d->thread))
+    {
+        // deleted in its own callback, freed after callback
+        timer->delete_pending = true;
+        pthread_mutex_unlock(&d->lock);
+        return;
+    }
+
+    while (d->firing == timer)
+        pthread_cond_wait(&d->cond, &d->lock);
+    pthread_mutex_unlock(&d->lock);
+    free(timer);
+}
+
+static bool prvTimerStart(osiTimer_t *timer, int64_t us, bool periodic)
+{
+    if (timer == NULL)
+        return false;
+
+    hostTimerContext_t *d = &gTimerCtx;
+    pthread_mutex_lock(&d->lock);
+    prvTimerRemove(timer);
+    timer->periodic = periodic;
+    timer->period_us = us;
+    timer->expire_us = osiUpTimeUS() + us;
+    prvTimerInsert(timer);
+    pthread_mutex_unlock(&d->lock);
+    return true;
+}
+
+bool osiTimerStart(osiTimer_t *timer, uint32_t ms)
+{
+    return prvTimerStart(timer, (int64_t)ms * 1000, false);
+}
+
+// relaxed time is for sleep, and there is no sleep on host
+bool osiTimerStartRelaxed(osiTimer_t *timer, uint32_t ms, uint32_t relax_ms)
+{
+    return prvTimerStart(timer, (int64_t)ms * 1000, false);
+}
+
+bool osiTimerStartMicrosecond(osiTimer_t *timer, uint32_t us)
+{
+    return prvTimerStart(timer, us, false);
+}
+
+bool osiTimerStartPeriodic(osiTimer_t *timer, uint32_t ms)
+{
+    return prvTimerStart(timer, (int64_t)ms * 1000, true);
+}
+
+bool osiTimerStartPeriodicRelaxed(osiTimer_t *timer, uint32_t ms, uint32_t relaxed_ms)
+{
+    return prvTimerStart(timer, (int64_t)ms * 1000, true);
+}
+
+bool osiTimerStop(osiTimer_t *timer)
+{
+    if (timer == NULL)
+        return false;
+
+    pthread_mutex_lock(&gTimerCtx.lock);
+    prvTimerRemove(timer);
+    pthread_mutex_unlock(&gTimerCtx.lock);
+    return true;
+}
+
+bool osiTimerIsRunning(osiTimer_t *timer)
+{
+    if (timer == NULL)
+        return false;
+
+    pthread_mutex_lock(&gTimerCtx.lock);
+    bool running = timer->running;
+    pthread_mutex_unlock(&gTimerCtx.lock);
+    return running;
+}
+
+int64_t osiTimerRemaining(osiTimer_t *timer)
+{
+    if (timer == NULL)
+        return 0;
+
+    pthread_mutex_lock(&gTimerCtx.lock);
+    int64_t remaining = timer->running ? (timer->expire_us - osiUpTimeUS()) / 1000 : 0;
+    pthread_mutex_unlock(&gTimerCtx.lock);
+    return remaining < 0 ? 0 : remaining;
+}
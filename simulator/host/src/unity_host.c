@@ -0,0 +1,41 @@
+/* Copyright (C) 2018 RDA Technologies Limited and/or its affiliates("RDA").
+ * All rights reserved.
+ *
+ * This software is supplied "AS IS" without any warranties.
+ * RDA assumes no responsibility or liability for the use of the software,
+ * conveys no license or title under any patent, copyright, or mask work
+ * right to the product. RDA reserves the right to make changes in the
+ * software without notification.  RDA also make no representation or
+ * warranty that such application will be suitable for the specified use
+ * without further testing or modification.
+ */
+
+// unity output and entry on host. Test executables only need to define
+// UnityRunAllTests.
+
+#include "unity_fixture.h"
+#include <stdio.h>
+
+void UnityOutputChar(int c)
+{
+    putchar(c);
+}
+
+void UnityOutputFlush(void)
+{
+    fflush(stdout);
+}
+
+void UnityOutputStart(void)
+{
+}
+
+void UnityOutputComplete(void)
+{
+    fflush(stdout);
+}
+
+int main(int argc, const char *argv[])
+{
+    return UnityMain(argc, argv, UnityRunAllTests);
+}
@@ -24,6 +24,7 @@
 #include "lvgl/lvgl.h"
 #include "lv_examples/lv_examples.h"
 #include "lv_drivers/win32drv/win32drv.h"
+#include "lv_sim_bench.h"
 
 //#include "ic_widgets_inc.h"
 //#include "main_screen.h"
@@ -33,8 +34,11 @@
 #pragma warning(pop)
 #endif
 
-int main()
+int main(int argc, char *argv[])
 {
+    lv_sim_bench_cfg_t bench_cfg;
+    bool bench = lv_sim_bench_parse_args(argc, argv, &bench_cfg);
+
     lv_init();
 
     if (!lv_win32_init(
@@ -47,11 +51,17 @@ int main()
         return -1;
     }
 
+    lv_sim_bench_install(&bench_cfg);
+
     //incar entry
     extern void main_screen(void);
     main_screen();
 	ic_main_entry();
 
+    // scripted scenarios, timing written to json file
+    if (bench)
+        return lv_sim_bench_run(&bench_cfg);
+
     /*
      * Demos, benchmarks, and tests.
      *
@@ -93,7 +103,7 @@ int main()
 
     while (!lv_win32_quit_signal)
     {
-        lv_task_handler();
+        lv_sim_bench_task_handler();
         Sleep(10);
     }
 
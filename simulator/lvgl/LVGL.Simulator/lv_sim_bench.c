@@ -0,0 +1,387 @@
+/*
+ * PROJECT:   LVGL ported to Windows Desktop
+ * FILE:      lv_sim_bench.c
+ * PURPOSE:   Scripted rendering benchmark for watch screens
+ *
+ * LICENSE:   The MIT License
+ */
+
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _MSC_VER >= 1200
+ // Disable compilation warnings.
+#pragma warning(push)
+// nonstandard extension used : bit field types other than int
+#pragma warning(disable:4214)
+// 'conversion' conversion from 'type1' to 'type2', possible loss of data
+#pragma warning(disable:4244)
+#endif
+
+#include "lvgl/lvgl.h"
+#include "lv_drivers/win32drv/win32drv.h"
+
+#if _MSC_VER >= 1200
+// Restore compilation warnings.
+#pragma warning(pop)
+#endif
+
+#include "lv_sim_bench.h"
+
+/* Input step, coordinates are in percent of resolution. Position moves
+ * linearly from (x0, y0) to (x1, y1) in ms. */
+typedef struct
+{
+    uint32_t ms;
+    bool pressed;
+    uint8_t x0, y0;
+    uint8_t x1, y1;
+} bench_step_t;
+
+typedef struct
+{
+    const char *name;
+    void (*setup)(void);
+    const bench_step_t *steps;
+    uint32_t step_count;
+} bench_scenario_t;
+
+typedef struct
+{
+    uint32_t t_ms;
+    uint32_t task_us;  /* whole lv_task_handler */
+    uint32_t flush_us; /* inside flush_cb, copy to window */
+    uint32_t flushes;  /* flush count, one per rendered area chunk */
+    uint32_t px;       /* rendered pixels */
+} bench_frame_t;
+
+typedef struct
+{
+    LARGE_INTEGER freq;
+    uint32_t cpu_scale;
+    void (*flush_cb)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *);
+
+    /* current lv_task_handler */
+    uint32_t flush_us;
+    uint32_t flushes;
+    uint32_t px;
+    bool rendered;
+
+    /* scripted input */
+    bool pressed;
+    lv_point_t point;
+
+    /* recording */
+    bool recording;
+    uint32_t start_ms;
+    uint32_t frame_count;
+    bench_frame_t *frames;
+
+    /* overlay */
+    lv_obj_t *overlay;
+    uint32_t overlay_ms;
+    uint32_t overlay_frames;
+    uint32_t overlay_task_us;
+    uint32_t overlay_max_us;
+} bench_context_t;
+
+static bench_context_t g_bench;
+
+static uint32_t bench_now_us(void)
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (uint32_t)(now.QuadPart * 1000000 / g_bench.freq.QuadPart);
+}
+
+static void bench_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    uint32_t start = bench_now_us();
+    g_bench.flush_cb(disp_drv, area, color_p);
+    g_bench.flush_us += bench_now_us() - start;
+    g_bench.flushes++;
+}
+
+static void bench_monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px)
+{
+    g_bench.px += px;
+    g_bench.rendered = true;
+}
+
+static bool bench_input_read(lv_indev_drv_t *drv, lv_indev_data_t *data)
+{
+    data->point = g_bench.point;
+    data->state = g_bench.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+    return false;
+}
+
+static void bench_overlay_update(uint32_t task_us)
+{
+    if (g_bench.overlay == NULL || !g_bench.rendered)
+        return;
+
+    g_bench.overlay_frames++;
+    g_bench.overlay_task_us += task_us;
+    if (task_us > g_bench.overlay_max_us)
+        g_bench.overlay_max_us = task_us;
+
+    /* updated every second, to limit its own rendering */
+    uint32_t now = lv_tick_get();
+    if (now - g_bench.overlay_ms < 1000)
+        return;
+
+    lv_label_set_text_fmt(g_bench.overlay, "%u fps %u/%u ms",
+                          (unsigned)g_bench.overlay_frames,
+                          (unsigned)(g_bench.overlay_task_us * g_bench.cpu_scale / g_bench.overlay_frames / 1000),
+                          (unsigned)(g_bench.overlay_max_us * g_bench.cpu_scale / 1000));
+    g_bench.overlay_ms = now;
+    g_bench.overlay_frames = 0;
+    g_bench.overlay_task_us = 0;
+    g_bench.overlay_max_us = 0;
+}
+
+void lv_sim_bench_task_handler(void)
+{
+    g_bench.flush_us = 0;
+    g_bench.flushes = 0;
+    g_bench.px = 0;
+    g_bench.rendered = false;
+
+    uint32_t start = bench_now_us();
+    lv_task_handler();
+    uint32_t task_us = bench_now_us() - start;
+
+    if (g_bench.recording && g_bench.rendered && g_bench.frame_count < LV_SIM_BENCH_FRAME_MAX)
+    {
+        bench_frame_t *frame = &g_bench.frames[g_bench.frame_count++];
+        frame->t_ms = lv_tick_get() - g_bench.start_ms;
+        frame->task_us = task_us;
+        frame->flush_us = g_bench.flush_us;
+        frame->flushes = g_bench.flushes;
+        frame->px = g_bench.px;
+    }
+
+    bench_overlay_update(task_us);
+
+    /* Slowdown, so that time based animations drop frames as on target.
+     * Flush is excluded, since window copy is not the target cost. */
+    if (g_bench.cpu_scale > 1)
+    {
+        uint32_t busy_us = task_us - g_bench.flush_us;
+        Sleep(busy_us * (g_bench.cpu_scale - 1) / 1000);
+    }
+}
+
+bool lv_sim_bench_parse_args(int argc, char *argv[], lv_sim_bench_cfg_t *cfg)
+{
+    cfg->output = NULL;
+    cfg->scenario = NULL;
+    cfg->cpu_scale = 1;
+
+    for (int n = 1; n < argc; n++)
+    {
+        if (strcmp(argv[n], "--bench") == 0 && n + 1 < argc)
+        {
+            cfg->output = argv[++n];
+            if (cfg->cpu_scale == 1)
+                cfg->cpu_scale = LV_SIM_BENCH_CPU_SCALE_DEFAULT;
+        }
+        else if (strcmp(argv[n], "--scenario") == 0 && n + 1 < argc)
+        {
+            cfg->scenario = argv[++n];
+        }
+        else if (strcmp(argv[n], "--cpu-scale") == 0 && n + 1 < argc)
+        {
+            int scale = atoi(argv[++n]);
+            cfg->cpu_scale = (scale > 1) ? (uint32_t)scale : 1;
+        }
+    }
+    return cfg->output != NULL;
+}
+
+void lv_sim_bench_install(const lv_sim_bench_cfg_t *cfg)
+{
+    QueryPerformanceFrequency(&g_bench.freq);
+    g_bench.cpu_scale = cfg->cpu_scale;
+
+    lv_disp_t *disp = lv_disp_get_default();
+    g_bench.flush_cb = disp->driver.flush_cb;
+    disp->driver.flush_cb = bench_flush_cb;
+    disp->driver.monitor_cb = bench_monitor_cb;
+
+    /* scripted pointer, in addition to mouse */
+    lv_indev_drv_t indev_drv;
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type = LV_INDEV_TYPE_POINTER;
+    indev_drv.read_cb = bench_input_read;
+    lv_indev_drv_register(&indev_drv);
+
+    /* overlay is not shown in benchmark, to avoid its own cost */
+    if (cfg->output == NULL)
+    {
+        g_bench.overlay = lv_label_create(lv_layer_top(), NULL);
+        lv_obj_set_style_local_text_color(g_bench.overlay, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_YELLOW);
+        lv_obj_set_style_local_bg_opa(g_bench.overlay, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_50);
+        lv_obj_set_style_local_bg_color(g_bench.overlay, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_BLACK);
+        lv_label_set_text(g_bench.overlay, "");
+        lv_obj_align(g_bench.overlay, NULL, LV_ALIGN_IN_BOTTOM_LEFT, 0, 0);
+    }
+}
+
+static const bench_step_t g_clockface_steps[] = {
+    {3000, false, 50, 50, 50, 50},
+};
+
+static const bench_step_t g_menu_steps[] = {
+    {300, true, 90, 50, 10, 50}, /* swipe to main menu */
+    {600, false, 10, 50, 10, 50},
+    {400, true, 50, 85, 50, 15},
+    {300, false, 50, 15, 50, 15},
+    {400, true, 50, 85, 50, 15},
+    {300, false, 50, 15, 50, 15},
+    {400, true, 50, 15, 50, 85},
+    {800, false, 50, 85, 50, 85},
+};
+
+static const bench_step_t g_calllog_steps[] = {
+    {500, false, 50, 50, 50, 50},
+    {400, true, 50, 85, 50, 15},
+    {300, false, 50, 15, 50, 15},
+    {400, true, 50, 85, 50, 15},
+    {300, false, 50, 15, 50, 15},
+    {400, true, 50, 15, 50, 85},
+    {800, false, 50, 85, 50, 85},
+};
+
+static void bench_calllog_setup(void)
+{
+    extern void ic_recent_callog_create(void);
+    ic_recent_callog_create();
+}
+
+static const bench_scenario_t g_scenarios[] = {
+    {"clockface", NULL, g_clockface_steps, sizeof(g_clockface_steps) / sizeof(g_clockface_steps[0])},
+    {"menu_scroll", NULL, g_menu_steps, sizeof(g_menu_steps) / sizeof(g_menu_steps[0])},
+    {"calllog_list", bench_calllog_setup, g_calllog_steps, sizeof(g_calllog_steps) / sizeof(g_calllog_steps[0])},
+};
+
+static void bench_run_steps(const bench_scenario_t *scenario)
+{
+    lv_coord_t w = lv_disp_get_hor_res(NULL);
+    lv_coord_t h = lv_disp_get_ver_res(NULL);
+
+    for (uint32_t n = 0; n < scenario->step_count && !lv_win32_quit_signal; n++)
+    {
+        const bench_step_t *step = &scenario->steps[n];
+        uint32_t start = lv_tick_get();
+        for (;;)
+        {
+            uint32_t elapsed = lv_tick_elaps(start);
+            if (elapsed > step->ms)
+                elapsed = step->ms;
+
+            int32_t x = step->x0 + ((int32_t)step->x1 - step->x0) * (int32_t)elapsed / (int32_t)step->ms;
+            int32_t y = step->y0 + ((int32_t)step->y1 - step->y0) * (int32_t)elapsed / (int32_t)step->ms;
+            g_bench.point.x = (lv_coord_t)(x * (w - 1) / 100);
+            g_bench.point.y = (lv_coord_t)(y * (h - 1) / 100);
+            g_bench.pressed = step->pressed;
+
+            lv_sim_bench_task_handler();
+            if (elapsed >= step->ms)
+                break;
+            Sleep(1);
+        }
+    }
+    g_bench.pressed = false;
+}
+
+static int bench_compare_u32(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+static void bench_write_scenario(FILE *fp, const bench_scenario_t *scenario, bool first)
+{
+    uint32_t count = g_bench.frame_count;
+    uint32_t *render = (uint32_t *)malloc((count + 1) * sizeof(uint32_t));
+    uint64_t px_total = 0;
+    for (uint32_t n = 0; n < count; n++)
+    {
+        render[n] = g_bench.frames[n].task_us - g_bench.frames[n].flush_us;
+        px_total += g_bench.frames[n].px;
+    }
+    qsort(render, count, sizeof(uint32_t), bench_compare_u32);
+
+    fprintf(fp, "%s\n    {\n      \"name\": \"%s\",\n", first ? "" : ",", scenario->name);
+    fprintf(fp, "      \"summary\": {\"frames\": %u, \"render_us_min\": %u, \"render_us_p50\": %u, "
+                "\"render_us_p90\": %u, \"render_us_max\": %u, \"px_avg\": %u},\n",
+            (unsigned)count,
+            (unsigned)(count ? render[0] : 0),
+            (unsigned)(count ? render[count / 2] : 0),
+            (unsigned)(count ? render[count * 9 / 10] : 0),
+            (unsigned)(count ? render[count - 1] : 0),
+            (unsigned)(count ? px_total / count : 0));
+    fprintf(fp, "      \"frames\": [");
+    for (uint32_t n = 0; n < count; n++)
+    {
+        const bench_frame_t *f = &g_bench.frames[n];
+        fprintf(fp, "%s\n        {\"t_ms\": %u, \"render_us\": %u, \"flush_us\": %u, \"flushes\": %u, \"px\": %u}",
+                n == 0 ? "" : ",", (unsigned)f->t_ms, (unsigned)(f->task_us - f->flush_us),
+                (unsigned)f->flush_us, (unsigned)f->flushes, (unsigned)f->px);
+    }
+    fprintf(fp, "\n      ]\n    }");
+    free(render);
+}
+
+int lv_sim_bench_run(const lv_sim_bench_cfg_t *cfg)
+{
+    FILE *fp = fopen(cfg->output, "w");
+    if (fp == NULL)
+        return -1;
+
+    g_bench.frames = (bench_frame_t *)calloc(LV_SIM_BENCH_FRAME_MAX, sizeof(bench_frame_t));
+    if (g_bench.frames == NULL)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    /* Render time is measured on host, and not scaled. cpu_scale is
+     * recorded for comparison among runs with the same setting. */
+    fprintf(fp, "{\n  \"hor_res\": %d,\n  \"ver_res\": %d,\n  \"color_depth\": %d,\n  \"cpu_scale\": %u,\n  \"scenarios\": [",
+            (int)lv_disp_get_hor_res(NULL), (int)lv_disp_get_ver_res(NULL), LV_COLOR_DEPTH, (unsigned)cfg->cpu_scale);
+
+    bool first = true;
+    for (uint32_t n = 0; n < sizeof(g_scenarios) / sizeof(g_scenarios[0]); n++)
+    {
+        const bench_scenario_t *scenario = &g_scenarios[n];
+        if (cfg->scenario != NULL && strcmp(cfg->scenario, scenario->name) != 0)
+            continue;
+
+        if (scenario->setup != NULL)
+            scenario->setup();
+
+        /* settle screen creation, and redraw everything for first frame */
+        lv_sim_bench_task_handler();
+        lv_obj_invalidate(lv_scr_act());
+
+        g_bench.frame_count = 0;
+        g_bench.start_ms = lv_tick_get();
+        g_bench.recording = true;
+        bench_run_steps(scenario);
+        g_bench.recording = false;
+
+        bench_write_scenario(fp, scenario, first);
+        first = false;
+    }
+
+    fprintf(fp, "\n  ]\n}\n");
+    fclose(fp);
+    free(g_bench.frames);
+    g_bench.frames = NULL;
+    return 0;
+}
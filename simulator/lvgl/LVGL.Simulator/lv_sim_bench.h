@@ -0,0 +1,64 @@
+/*
+ * PROJECT:   LVGL ported to Windows Desktop
+ * FILE:      lv_sim_bench.h
+ * PURPOSE:   Scripted rendering benchmark for watch screens
+ *
+ * LICENSE:   The MIT License
+ */
+
+#ifndef LV_SIM_BENCH_H
+#define LV_SIM_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Default slowdown of the simulator, to approximate Cortex-A5 target on
+ * a desktop CPU. It is a rough factor, and only the relative costs are
+ * meaningful.
+ */
+#define LV_SIM_BENCH_CPU_SCALE_DEFAULT 10
+
+/* maximum recorded frames of each scenario */
+#define LV_SIM_BENCH_FRAME_MAX 1024
+
+typedef struct
+{
+    const char *output;    /* JSON output path */
+    const char *scenario;  /* only run this scenario, NULL for all */
+    uint32_t cpu_scale;    /* slowdown factor, 1 for no slowdown */
+} lv_sim_bench_cfg_t;
+
+/*
+ * Parse benchmark options from command line:
+ *
+ *   --bench <output.json>     run benchmark and write result
+ *   --scenario <name>         run only one scenario
+ *   --cpu-scale <n>           slowdown factor, also without --bench
+ *
+ * Return true when --bench is specified.
+ */
+bool lv_sim_bench_parse_args(int argc, char *argv[], lv_sim_bench_cfg_t *cfg);
+
+/*
+ * Install frame timing hooks on the default display. It should be called
+ * after display driver is registered. Without benchmark, frame rate and
+ * average/maximum render time are shown in an overlay on top layer.
+ */
+void lv_sim_bench_install(const lv_sim_bench_cfg_t *cfg);
+
+/*
+ * Call lv_task_handler once, with frame timing and CPU slowdown. It
+ * replaces lv_task_handler in the main loop.
+ */
+void lv_sim_bench_task_handler(void);
+
+/*
+ * Run all scenarios with scripted input, and write JSON result. Main
+ * screen should be created before.
+ *
+ * Return 0 on success.
+ */
+int lv_sim_bench_run(const lv_sim_bench_cfg_t *cfg);
+
+#endif /* LV_SIM_BENCH_H */
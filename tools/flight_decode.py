@@ -0,0 +1,109 @@
+#!/usr/bin/python
+
+# _*_ coding: utf-8 _*_
+# @FileName:   flight_decode.py
+# @Descripton: Decode flight recorder events in blue screen core
+#
+# Flight recorder is enabled by CONFIG_KERNEL_FLIGHT_REC_COUNT, and the
+# latest events are saved in blue screen core by CONFIG_BSCORE_FLIGHT_SIZE.
+# The input is the raw blue screen core memory (starts with tag BSCR), or
+# the raw output of osiFlightGetLatest with option --raw.
+
+import struct
+import sys
+from optparse import OptionParser
+
+# blue screen core, see hal_blue_screen_imp.h
+BSCORE_TAG = 0x52435342  # BSCR
+BSCORE_SECT_COREEND = 0
+BSCORE_SECT_FLIGHT = 6
+
+# flight recorder event types, see osi_profile.h
+FLIGHT_THREAD = 1
+FLIGHT_IRQ_ENTER = 2
+FLIGHT_IRQ_EXIT = 3
+FLIGHT_WORK = 4
+FLIGHT_TIMER = 5
+FLIGHT_PANIC = 6
+FLIGHT_MARK = 0x80
+FLIGHT_NAMES = {FLIGHT_THREAD: "thread", FLIGHT_IRQ_ENTER: "irq_enter",
+                FLIGHT_IRQ_EXIT: "irq_exit", FLIGHT_WORK: "work",
+                FLIGHT_TIMER: "timer", FLIGHT_PANIC: "panic", FLIGHT_MARK: "mark"}
+
+# Find flight recorder section payload in blue screen core
+def FindFlightSection(data):
+    tag, size, crc = struct.unpack("<III", data[:12])
+    if tag != BSCORE_TAG:
+        return None
+    pos = 12
+    end = min(size, len(data))
+    while pos + 8 <= end:
+        stype, ssize = struct.unpack("<II", data[pos:pos + 8])
+        if stype == BSCORE_SECT_COREEND or ssize < 8:
+            break
+        if stype == BSCORE_SECT_FLIGHT:
+            return data[pos + 8:pos + ssize]
+        pos += (ssize + 3) & ~3
+    return None
+
+# Decode payload of osiFlightGetLatest, as (freq, total, records). Each
+# record is (tick, type, arg0, arg1).
+def DecodeFlight(payload):
+    freq, total = struct.unpack("<II", payload[:8])
+    records = []
+    for pos in range(8, len(payload) - 11, 12):
+        tick, word, arg1 = struct.unpack("<III", payload[pos:pos + 12])
+        records.append((tick, word >> 24, word & 0xffffff, arg1))
+    return (freq, total, records)
+
+def FormatRecord(rec, threadNames):
+    tick, type, arg0, arg1 = rec
+    name = FLIGHT_NAMES.get(type, "0x%02x" % type)
+    if type == FLIGHT_THREAD:
+        return "%s %s" % (name, threadNames.get(arg0, "%d" % arg0))
+    if type in (FLIGHT_IRQ_ENTER, FLIGHT_IRQ_EXIT):
+        return "%s %d" % (name, arg0)
+    if type in (FLIGHT_WORK, FLIGHT_TIMER, FLIGHT_PANIC):
+        return "%s 0x%08x" % (name, arg1)
+    return "%s %d 0x%08x" % (name, arg0, arg1)
+
+def main(argv):
+    parser = OptionParser(usage="usage: %prog [options] bscore")
+    parser.add_option("--raw", dest="raw", action="store_true", default=False,
+                      help="input is raw output of osiFlightGetLatest")
+    parser.add_option("-t", "--thread", dest="threads", action="append", default=[],
+                      help="thread name, as <thread number>=<name>, can be repeated")
+    (options, args) = parser.parse_args(argv)
+    if len(args) != 1:
+        parser.print_help()
+        return 1
+
+    threadNames = {}
+    for t in options.threads:
+        id, name = t.split("=", 1)
+        threadNames[int(id, 0)] = name
+
+    f = open(args[0], "rb")
+    data = bytearray(f.read())
+    f.close()
+
+    payload = data if options.raw else FindFlightSection(data)
+    if payload is None or len(payload) < 8:
+        print("flight recorder not found")
+        return 1
+
+    freq, total, records = DecodeFlight(payload)
+    if not records:
+        print("no flight recorder events")
+        return 0
+
+    # time is relative to the last event, tick is 32 bits and may wrap
+    last = records[-1][0]
+    for rec in records:
+        us = -((last - rec[0]) & 0xffffffff) * 1000000.0 / freq
+        print("%14.1f  %s" % (us, FormatRecord(rec, threadNames)))
+    print("%d events, %d in total" % (len(records), total))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,134 @@
+#!/usr/bin/python
+
+# _*_ coding: utf-8 _*_
+# @FileName:   logring_decode.py
+# @Descripton: Decode on-device log ring files
+#
+# On-device log ring is enabled by CONFIG_SRV_LOG_RING_ENABLE. The input is
+# the concatenation of log ring files (oldest first), such as uploaded
+# files, or the data read by diag command LOG_READ_RING.
+
+import struct
+import sys
+from optparse import OptionParser
+
+# block header, see srv_log_ring.c
+BLOCK_MAGIC = 0x524c
+BLOCK_STORED = 0
+BLOCK_LZ4 = 1
+BLOCK_HEADER_SIZE = 20
+RECORD_HEADER_SIZE = 10
+TAG_FMTID_FLAG = 1 << 31
+LEVEL_NAMES = "NEWIDV"
+
+def Lz4Decompress(src):
+    dst = bytearray()
+    pos = 0
+    while pos < len(src):
+        token = src[pos]
+        pos += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[pos]
+                pos += 1
+                lit += b
+                if b != 255:
+                    break
+        dst += src[pos:pos + lit]
+        pos += lit
+        if pos >= len(src):
+            break
+
+        offset = src[pos] | (src[pos + 1] << 8)
+        pos += 2
+        mlen = token & 15
+        if mlen == 15:
+            while True:
+                b = src[pos]
+                pos += 1
+                mlen += b
+                if b != 255:
+                    break
+        mlen += 4
+        for n in range(mlen):
+            dst.append(dst[-offset])
+    return dst
+
+# Decode blocks, as list of (seq, epoch, uptime, raw data)
+def DecodeBlocks(data):
+    blocks = []
+    pos = 0
+    while pos + BLOCK_HEADER_SIZE <= len(data):
+        magic, flags, _, seq, epoch, uptime, raw_size, data_size = \
+            struct.unpack("<HBBIIIHH", data[pos:pos + BLOCK_HEADER_SIZE])
+        if magic != BLOCK_MAGIC:
+            break
+        body = data[pos + BLOCK_HEADER_SIZE:pos + BLOCK_HEADER_SIZE + data_size]
+        raw = Lz4Decompress(body) if flags == BLOCK_LZ4 else body
+        if len(raw) != raw_size:
+            print("block %d size mismatch" % seq)
+        blocks.append((seq, epoch, uptime, raw))
+        pos += BLOCK_HEADER_SIZE + data_size
+    return blocks
+
+def FormatTag(tag):
+    name = ""
+    for n in range(4):
+        ch = (tag >> (n * 7)) & 0x7f
+        name += chr(ch) if 32 < ch < 127 else "."
+    level = (tag >> 28) & 7
+    return "%s/%s" % (name, LEVEL_NAMES[level] if level < len(LEVEL_NAMES) else "?")
+
+def FormatRecord(tag, rdata):
+    if tag & TAG_FMTID_FLAG:
+        fmt = "fmtid 0x%08x" % struct.unpack("<I", rdata[:4])[0]
+        params = rdata[4:]
+    else:
+        end = rdata.find(b"\0")
+        if end < 0:
+            end = len(rdata)
+        fmt = '"%s"' % rdata[:end].decode("latin-1")
+        params = rdata[(end + 4) & ~3:]
+
+    words = ["0x%x" % struct.unpack("<I", params[n:n + 4])[0]
+             for n in range(0, len(params) - 3, 4)]
+    return "%s %s %s" % (FormatTag(tag & ~TAG_FMTID_FLAG), fmt, " ".join(words))
+
+def main(argv):
+    parser = OptionParser(usage="usage: %prog [options] logring")
+    parser.add_option("--blocks", dest="blocks", action="store_true", default=False,
+                      help="show block information only")
+    (options, args) = parser.parse_args(argv)
+    if len(args) != 1:
+        parser.print_help()
+        return 1
+
+    f = open(args[0], "rb")
+    data = bytearray(f.read())
+    f.close()
+
+    blocks = DecodeBlocks(data)
+    if not blocks:
+        print("no log ring blocks")
+        return 1
+
+    records = 0
+    for seq, epoch, uptime, raw in blocks:
+        print("block %d epoch %d uptime %d size %d" % (seq, epoch, uptime, len(raw)))
+        if options.blocks:
+            continue
+
+        pos = 0
+        while pos + RECORD_HEADER_SIZE <= len(raw):
+            tick, tag, size = struct.unpack("<IIH", raw[pos:pos + RECORD_HEADER_SIZE])
+            rdata = raw[pos + RECORD_HEADER_SIZE:pos + RECORD_HEADER_SIZE + size]
+            print("%10d  %s" % (tick, FormatRecord(tag, rdata)))
+            pos += RECORD_HEADER_SIZE + size
+            records += 1
+
+    print("%d blocks, %d records" % (len(blocks), records))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,174 @@
+#!/usr/bin/python
+
+# _*_ coding: utf-8 _*_
+# @FileName:   profile_stream.py
+# @Descripton: Convert streamed profile data in trace capture to Chrome trace JSON
+#
+# Profile streaming is started by osiProfileStreamStart, or host command
+# HOST_SYSCMD_PROFILESTREAM. The capture is the raw byte stream of the
+# trace port, and the output can be opened in chrome://tracing or Perfetto.
+
+import json
+import struct
+import sys
+from optparse import OptionParser
+
+# host packet: sync 0xAD, frame length (big endian 16 bits), flow ID, frame
+HOST_SYNC = 0xad
+PROFILE_STREAM_FLOWID = 0x71
+
+# profile codes, see osi_profile.h
+PROFCODE_EXIT_FLAG = 0x8000
+PROFCODE_IRQ_START = 0x3f00
+PROFCODE_IRQ_END = 0x3f7f
+PROFCODE_THREAD_START = 0x3f80
+PROFCODE_THREAD_END = 0x3fdf
+PROFCODE_NAMES = {0x2f02: "blue_screen", 0x2f58: "panic", 0x3703: "light_sleep",
+                  0x3702: "deep_sleep", 0x3704: "suspend", 0x3705: "flash_erase",
+                  0x3706: "flash_program", 0x3707: "wcn_sleep", 0x3708: "lcd_wait",
+                  0x3709: "gui_refr", 0x370a: "gui_draw_rect", 0x370b: "gui_draw_img",
+                  0x370c: "gui_draw_label", 0x370d: "gui_draw_arc"}
+
+# Chrome trace tracks
+TID_THREAD = 1
+TID_IRQ = 2
+TID_CODE = 3
+
+# Split the capture to host packets of profile streaming, as
+# (start word, tick frequency, words). Bytes out of sync are skipped.
+def ReadPackets(data):
+    packets = []
+    pos = 0
+    while pos + 4 <= len(data):
+        if data[pos] != HOST_SYNC:
+            pos += 1
+            continue
+        flen = (data[pos + 1] << 8) | data[pos + 2]
+        flowid = data[pos + 3]
+        if pos + 4 + flen > len(data):
+            break
+        if flowid == PROFILE_STREAM_FLOWID and flen >= 8 and flen % 4 == 0:
+            frame = data[pos + 4:pos + 4 + flen]
+            start, freq = struct.unpack("<II", frame[:8])
+            words = struct.unpack("<%dI" % ((flen - 8) // 4), frame[8:])
+            packets.append((start, freq, words))
+        pos += 4 + flen
+    return packets
+
+# Convert packets to Chrome trace events. Profile word is (tick << 16) | code,
+# and code 0 carries the high bits of a large tick delta of the next word.
+# At lost words, open slices are closed, and tick continues with the
+# wrapped delta, as the real elapsed time is unknown.
+class ProfileConverter:
+    def __init__(self, threadNames):
+        self.threadNames = threadNames
+        self.events = []
+        self.lost = 0
+        self.expect = None
+        self.tick = None
+        self.deltaHi = 0
+        self.thread = None
+        self.open = {}
+
+    def Restart(self):
+        self.Close()
+        self.deltaHi = 0
+
+    def Close(self):
+        if self.tick is None:
+            return
+        if self.thread is not None:
+            self.Event("E", TID_THREAD, self.ThreadName(self.thread))
+        for code in list(self.open):
+            self.Event("E", self.open[code], self.CodeName(code))
+        self.thread = None
+        self.open = {}
+
+    def ThreadName(self, id):
+        return self.threadNames.get(id, "thread %d" % id)
+
+    def CodeName(self, code):
+        if PROFCODE_IRQ_START <= code <= PROFCODE_IRQ_END:
+            return "irq %d" % (code - PROFCODE_IRQ_START)
+        return PROFCODE_NAMES.get(code, "0x%04x" % code)
+
+    def Event(self, ph, tid, name):
+        self.events.append({"name": name, "ph": ph, "pid": 1, "tid": tid,
+                            "ts": self.tick * 1000000.0 / self.freq})
+
+    def Word(self, word):
+        low = word >> 16
+        code = word & 0xffff
+        if code == 0:
+            self.deltaHi = low
+            return
+
+        if self.tick is None:
+            self.tick = low
+        else:
+            self.tick += (self.deltaHi << 16) + ((low - self.tick) & 0xffff)
+        self.deltaHi = 0
+
+        exit = (code & PROFCODE_EXIT_FLAG) != 0
+        code &= ~PROFCODE_EXIT_FLAG
+        if PROFCODE_THREAD_START <= code <= PROFCODE_THREAD_END:
+            if self.thread is not None:
+                self.Event("E", TID_THREAD, self.ThreadName(self.thread))
+            self.thread = code - PROFCODE_THREAD_START
+            self.Event("B", TID_THREAD, self.ThreadName(self.thread))
+        elif exit:
+            if code in self.open:
+                self.Event("E", self.open.pop(code), self.CodeName(code))
+        else:
+            tid = TID_IRQ if PROFCODE_IRQ_START <= code <= PROFCODE_IRQ_END else TID_CODE
+            if code in self.open:
+                self.Event("E", self.open[code], self.CodeName(code))
+            self.open[code] = tid
+            self.Event("B", tid, self.CodeName(code))
+
+    def Packet(self, start, freq, words):
+        self.freq = freq
+        if self.expect is not None and start != self.expect:
+            self.lost += (start - self.expect) & 0xffffffff
+            self.Restart()
+        for word in words:
+            self.Word(word)
+        self.expect = (start + len(words)) & 0xffffffff
+
+    def Output(self):
+        self.Close()
+        meta = [{"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}}
+                for tid, name in ((TID_THREAD, "threads"), (TID_IRQ, "irq"), (TID_CODE, "profile codes"))]
+        return {"traceEvents": meta + self.events, "displayTimeUnit": "ms"}
+
+def main(argv):
+    parser = OptionParser(usage="usage: %prog [options] capture output.json")
+    parser.add_option("-t", "--thread", dest="threads", action="append", default=[],
+                      help="thread name, as <thread number>=<name>, can be repeated")
+    (options, args) = parser.parse_args(argv)
+    if len(args) != 2:
+        parser.print_help()
+        return 1
+
+    threadNames = {}
+    for t in options.threads:
+        id, name = t.split("=", 1)
+        threadNames[int(id, 0)] = name
+
+    f = open(args[0], "rb")
+    data = bytearray(f.read())
+    f.close()
+
+    conv = ProfileConverter(threadNames)
+    packets = ReadPackets(data)
+    for start, freq, words in packets:
+        conv.Packet(start, freq, words)
+
+    f = open(args[1], "w")
+    json.dump(conv.Output(), f)
+    f.close()
+    print("%d packets, %d events, %d profile words lost" % (len(packets), len(conv.events), conv.lost))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
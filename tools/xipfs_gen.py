@@ -0,0 +1,119 @@
+#!/usr/bin/python
+
+# _*_ coding: utf-8 _*_
+# @FileName:   xipfs_gen.py
+# @Descripton: Generate XIPFS image from a directory
+#
+# XIPFS is a read only file system with contiguous files, and the image
+# is mounted by xipfsVfsMount from the flash XIP window. The format is
+# described in components/fs/include/xipfs_vfs.h.
+#
+# Files matching --lzma patterns are compressed by "dtools lzmare2", and
+# they are decompressed by hardware at read. The compressed one is only
+# used when it is smaller.
+
+import fnmatch
+import os
+import shlex
+import struct
+import subprocess
+import sys
+import tempfile
+from optparse import OptionParser
+
+XIPFS_MAGIC = 0x46504958  # XIPF
+XIPFS_VERSION = 1
+XIPFS_ALIGN = 32
+XIPFS_NAME_MAX = 56
+HEADER_SIZE = 16
+ENTRY_SIZE = XIPFS_NAME_MAX + 8
+XIPFS_FLAG_LZMA = 1
+
+
+def Align(n):
+    return (n + XIPFS_ALIGN - 1) & ~(XIPFS_ALIGN - 1)
+
+
+def CollectFiles(root):
+    files = []
+    for dirpath, dirnames, filenames in os.walk(root):
+        for fname in filenames:
+            path = os.path.join(dirpath, fname)
+            name = os.path.relpath(path, root).replace(os.sep, "/")
+            if len(name.encode("utf-8")) >= XIPFS_NAME_MAX:
+                raise ValueError("name too long: %s" % name)
+            files.append((name.encode("utf-8"), path))
+
+    # same order as strcmp, for bsearch in target
+    files.sort(key=lambda f: f[0])
+    return files
+
+
+def Compress(path, tool):
+    fd, out = tempfile.mkstemp(suffix=".lzmar")
+    os.close(fd)
+    try:
+        subprocess.check_call(shlex.split(tool) + [path, out])
+        f = open(out, "rb")
+        data = f.read()
+        f.close()
+    finally:
+        os.remove(out)
+    return data
+
+
+def GenImage(root, patterns, tool):
+    files = CollectFiles(root)
+    offset = Align(HEADER_SIZE + ENTRY_SIZE * len(files))
+    entries = bytearray()
+    body = bytearray()
+    for name, path in files:
+        f = open(path, "rb")
+        data = f.read()
+        f.close()
+
+        size = len(data)
+        flags = 0
+        if any(fnmatch.fnmatch(name.decode("utf-8"), p) for p in patterns):
+            cdata = Compress(path, tool)
+            if len(cdata) < size:
+                data = cdata
+                flags = XIPFS_FLAG_LZMA
+
+        entries += struct.pack("<%dsII" % XIPFS_NAME_MAX, name, (offset + len(body)) | flags, size)
+        body += data
+        body += b"\0" * (Align(len(body)) - len(body))
+
+    head = struct.pack("<IIII", XIPFS_MAGIC, XIPFS_VERSION, len(files), offset + len(body))
+    image = bytearray(head) + entries
+    image += b"\0" * (offset - len(image))
+    return image + body, len(files)
+
+
+def main(argv):
+    parser = OptionParser(usage="usage: %prog [options] dir image")
+    parser.add_option("--max-size", dest="maxsize", default="0",
+                      help="fail when image size exceeds it, 0 for no limit")
+    parser.add_option("--lzma", dest="lzma", action="append", default=[],
+                      help="compress files matching the pattern, can be repeated")
+    parser.add_option("--lzma-tool", dest="tool", default="dtools lzmare2",
+                      help="compress command, called with input and output file")
+    (options, args) = parser.parse_args(argv)
+    if len(args) != 2:
+        parser.print_help()
+        return 1
+
+    image, count = GenImage(args[0], options.lzma, options.tool)
+    maxsize = int(options.maxsize, 0)
+    if maxsize != 0 and len(image) > maxsize:
+        print("image size %d exceeds %d" % (len(image), maxsize))
+        return 1
+
+    f = open(args[1], "wb")
+    f.write(image)
+    f.close()
+    print("%d files, image size %d" % (count, len(image)))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))